@@ -0,0 +1,227 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * AsyncLogDestination.cpp
+ * A LogDestination that writes from a background thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <sstream>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+
+namespace ola {
+
+using ola::thread::ConditionVariable;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using std::string;
+
+/**
+ * @cond HIDDEN_SYMBOLS
+ *
+ * The ring is a bounded multi producer queue. Each entry has a sequence
+ * number: an entry is free for the producer that claims position p when its
+ * sequence is p, and ready for the writer when it's p + 1. Producers claim a
+ * position with a compare and swap, so they never block each other.
+ */
+struct AsyncLogDestination::Entry {
+  uint32_t sequence;
+  log_level level;
+  unsigned int length;
+  char data[MAX_LINE_LENGTH];
+};
+
+
+class AsyncLogDestination::WriterThread : public ola::thread::Thread {
+ public:
+  explicit WriterThread(AsyncLogDestination *destination)
+      : Thread(Thread::Options("ola-log-writer")),
+        m_destination(destination),
+        m_terminate(false) {
+  }
+
+  void Terminate() {
+    {
+      MutexLocker locker(&m_mutex);
+      m_terminate = true;
+    }
+    m_condition.Signal();
+  }
+
+  /*
+   * Held while entries are taken from the ring, so that Flush() can be called
+   * from other threads.
+   */
+  Mutex *WriterLock() { return &m_writer_lock; }
+
+ protected:
+  void *Run() {
+    Clock clock;
+    MutexLocker locker(&m_mutex);
+    while (!m_terminate) {
+      TimeStamp wake_up;
+      clock.CurrentTime(&wake_up);
+      wake_up += TimeInterval(0, DRAIN_INTERVAL_US);
+      m_condition.TimedWait(&m_mutex, wake_up);
+      MutexLocker writer_locker(&m_writer_lock);
+      m_destination->Drain();
+    }
+    return NULL;
+  }
+
+ private:
+  AsyncLogDestination *m_destination;
+  Mutex m_mutex;
+  Mutex m_writer_lock;
+  ConditionVariable m_condition;
+  bool m_terminate;
+
+  static const unsigned int DRAIN_INTERVAL_US = 50000;
+};
+/**@endcond*/
+
+
+AsyncLogDestination::AsyncLogDestination(LogDestination *destination,
+                                         unsigned int capacity)
+    : m_destination(destination),
+      m_entries(NULL),
+      m_mask(Capacity(capacity) - 1),
+      m_enqueue_position(0),
+      m_dequeue_position(0),
+      m_pending_drops(0),
+      m_dropped(0),
+      m_thread(NULL) {
+  m_entries = new Entry[m_mask + 1];
+  for (uint32_t i = 0; i <= m_mask; i++) {
+    m_entries[i].sequence = i;
+  }
+  m_thread = new WriterThread(this);
+  m_thread->Start();
+}
+
+
+AsyncLogDestination::~AsyncLogDestination() {
+  m_thread->Terminate();
+  m_thread->Join();
+  delete m_thread;
+  Drain();
+  delete[] m_entries;
+}
+
+
+void AsyncLogDestination::Write(log_level level, const string &log_line) {
+  if (level == OLA_LOG_FATAL) {
+    MutexLocker locker(m_thread->WriterLock());
+    Drain();
+    m_destination->Write(level, log_line);
+    return;
+  }
+
+  uint32_t position = __atomic_load_n(&m_enqueue_position, __ATOMIC_RELAXED);
+  Entry *entry;
+  while (true) {
+    entry = &m_entries[position & m_mask];
+    const uint32_t sequence = __atomic_load_n(&entry->sequence,
+                                              __ATOMIC_ACQUIRE);
+    const int32_t difference = static_cast<int32_t>(sequence - position);
+    if (difference == 0) {
+      if (__atomic_compare_exchange_n(&m_enqueue_position, &position,
+                                      position + 1, true, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        break;
+      }
+      // The failed compare and swap loaded the new position.
+    } else if (difference < 0) {
+      // The ring is full.
+      __atomic_add_fetch(&m_pending_drops, 1, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&m_dropped, 1, __ATOMIC_RELAXED);
+      return;
+    } else {
+      position = __atomic_load_n(&m_enqueue_position, __ATOMIC_RELAXED);
+    }
+  }
+
+  entry->level = level;
+  if (log_line.size() <= MAX_LINE_LENGTH) {
+    entry->length = log_line.size();
+    memcpy(entry->data, log_line.data(), entry->length);
+  } else {
+    entry->length = MAX_LINE_LENGTH;
+    memcpy(entry->data, log_line.data(), MAX_LINE_LENGTH - 1);
+    entry->data[MAX_LINE_LENGTH - 1] = '\n';
+  }
+  __atomic_store_n(&entry->sequence, position + 1, __ATOMIC_RELEASE);
+}
+
+
+void AsyncLogDestination::Flush() {
+  MutexLocker locker(m_thread->WriterLock());
+  Drain();
+}
+
+
+uint64_t AsyncLogDestination::Dropped() const {
+  return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * Write out the ready entries. This must be called with the writer lock held,
+ * or once the writer thread has stopped.
+ */
+void AsyncLogDestination::Drain() {
+  const uint32_t drops = __atomic_exchange_n(&m_pending_drops, 0,
+                                             __ATOMIC_RELAXED);
+  if (drops) {
+    std::ostringstream str;
+    str << "Dropped " << drops << " log messages, the queue was full\n";
+    m_destination->Write(OLA_LOG_WARN, str.str());
+  }
+
+  string line;
+  while (true) {
+    Entry *entry = &m_entries[m_dequeue_position & m_mask];
+    const uint32_t sequence = __atomic_load_n(&entry->sequence,
+                                              __ATOMIC_ACQUIRE);
+    if (sequence != m_dequeue_position + 1) {
+      return;
+    }
+    line.assign(entry->data, entry->length);
+    const log_level level = entry->level;
+    // Release the entry before writing, so the producers can reuse it.
+    __atomic_store_n(&entry->sequence, m_dequeue_position + m_mask + 1,
+                     __ATOMIC_RELEASE);
+    m_dequeue_position++;
+    m_destination->Write(level, line);
+  }
+}
+
+
+uint32_t AsyncLogDestination::Capacity(unsigned int capacity) {
+  uint32_t rounded = 2;
+  while (rounded < capacity && rounded < (1u << 20)) {
+    rounded <<= 1;
+  }
+  return rounded;
+}
+}  // namespace ola
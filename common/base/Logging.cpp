@@ -28,6 +28,8 @@
  * @}
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 #ifdef _WIN32
 #define VC_EXTRALEAN
@@ -48,6 +50,9 @@
 DEFINE_s_int8(log_level, l, ola::OLA_LOG_WARN, "Set the logging level 0 .. 4.");
 /**@private*/
 DEFINE_default_bool(syslog, false, "Send to syslog rather than stderr.");
+/**@private*/
+DEFINE_default_bool(log_async, false,
+                    "Write log messages from a background thread.");
 
 namespace ola {
 
@@ -110,7 +115,19 @@ bool InitLoggingFromFlags() {
       break;
   }
 
-  return InitLogging(log_level, output);
+  if (!InitLogging(log_level, output)) {
+    return false;
+  }
+  if (FLAGS_log_async && log_target) {
+    log_target = new AsyncLogDestination(log_target);
+    static bool registered_flush = false;
+    if (!registered_flush) {
+      // Don't lose the queued messages when the program exits.
+      atexit(FlushLogs);
+      registered_flush = true;
+    }
+  }
+  return true;
 }
 
 
@@ -145,13 +162,32 @@ void InitLogging(log_level level, LogDestination *destination) {
   log_target = destination;
 }
 
+
+void FlushLogs() {
+  if (log_target) {
+    log_target->Flush();
+  }
+}
+
 /**@}*/
 /**@cond HIDDEN_SYMBOLS*/
 LogLine::LogLine(const char *file,
                  int line,
                  log_level level):
   m_level(level),
-  m_stream(ostringstream::out) {
+  m_stream(ostringstream::out),
+  m_suppressed(0) {
+    m_stream << file << ":" << line << ": ";
+    m_prefix_length = m_stream.str().length();
+}
+
+LogLine::LogLine(const char *file,
+                 int line,
+                 log_level level,
+                 unsigned int suppressed):
+  m_level(level),
+  m_stream(ostringstream::out),
+  m_suppressed(suppressed) {
     m_stream << file << ":" << line << ": ";
     m_prefix_length = m_stream.str().length();
 }
@@ -169,12 +205,46 @@ void LogLine::Write() {
 
   string line = m_stream.str();
 
-  if (line.at(line.length() - 1) != '\n')
-    line.append("\n");
+  if (line.at(line.length() - 1) == '\n')
+    line.erase(line.length() - 1);
+
+  if (m_suppressed) {
+    ostringstream suppressed;
+    suppressed << " (" << m_suppressed << " similar messages suppressed)";
+    line.append(suppressed.str());
+  }
+  line.append("\n");
 
   if (log_target)
     log_target->Write(m_level, line);
 }
+
+LogRateLimiter::LogRateLimiter(unsigned int max_per_second)
+    : m_max_per_second(max_per_second),
+      m_window(0),
+      m_count(0),
+      m_suppressed(0) {
+}
+
+bool LogRateLimiter::Allow() {
+  // A one second window is accurate enough for this, and time() is cheap.
+  const int64_t now = time(NULL);
+  int64_t window = __atomic_load_n(&m_window, __ATOMIC_RELAXED);
+  if (now != window &&
+      __atomic_compare_exchange_n(&m_window, &window, now, false,
+                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&m_count, 0, __ATOMIC_RELAXED);
+  }
+  if (__atomic_add_fetch(&m_count, 1, __ATOMIC_RELAXED) <= m_max_per_second) {
+    return true;
+  }
+  __atomic_add_fetch(&m_suppressed, 1, __ATOMIC_RELAXED);
+  return false;
+}
+
+unsigned int LogRateLimiter::TakeSuppressed() {
+  return __atomic_exchange_n(&m_suppressed, 0, __ATOMIC_RELAXED);
+}
 /**@endcond*/
 
 /**
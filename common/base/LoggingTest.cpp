@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <time.h>
 #include <deque>
 #include <string>
 #include <utility>
@@ -39,10 +40,16 @@ using ola::log_level;
 class LoggingTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(LoggingTest);
   CPPUNIT_TEST(testLogging);
+  CPPUNIT_TEST(testSuppressedMessages);
+  CPPUNIT_TEST(testRateLimiter);
+  CPPUNIT_TEST(testAsyncLogging);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testLogging();
+    void testSuppressedMessages();
+    void testRateLimiter();
+    void testAsyncLogging();
 };
 
 
@@ -125,3 +132,80 @@ void LoggingTest::testLogging() {
   OLA_FATAL << "fatal";
   OLA_ASSERT_EQ(destination->LinesRemaining(), 0);
 }
+
+
+/*
+ * Check the suppressed count is added to the message.
+ */
+void LoggingTest::testSuppressedMessages() {
+  MockLogDestination *destination = new MockLogDestination();
+  InitLogging(ola::OLA_LOG_WARN, destination);
+  destination->AddExpected(ola::OLA_LOG_WARN,
+                           " warn (3 similar messages suppressed)\n");
+  ola::LogLine(__FILE__, __LINE__, ola::OLA_LOG_WARN, 3).stream() << "warn";
+  destination->AddExpected(ola::OLA_LOG_WARN, " warn\n");
+  ola::LogLine(__FILE__, __LINE__, ola::OLA_LOG_WARN, 0).stream() << "warn";
+  OLA_ASSERT_EQ(destination->LinesRemaining(), 0);
+
+  // The first message from a call site is always logged.
+  destination->AddExpected(ola::OLA_LOG_WARN, " limited\n");
+  OLA_WARN_RATE_LIMITED(1) << "limited";
+  OLA_ASSERT_EQ(destination->LinesRemaining(), 0);
+  InitLogging(ola::OLA_LOG_WARN, NULL);
+}
+
+
+/*
+ * Check the LogRateLimiter.
+ */
+void LoggingTest::testRateLimiter() {
+  // Retry if the second changed part way through.
+  while (true) {
+    ola::LogRateLimiter limiter(3);
+    const time_t start = time(NULL);
+    bool allowed[5];
+    for (unsigned int i = 0; i < 5; i++) {
+      allowed[i] = limiter.Allow();
+    }
+    const unsigned int suppressed = limiter.TakeSuppressed();
+    if (time(NULL) != start) {
+      continue;
+    }
+    OLA_ASSERT_TRUE(allowed[0]);
+    OLA_ASSERT_TRUE(allowed[1]);
+    OLA_ASSERT_TRUE(allowed[2]);
+    OLA_ASSERT_FALSE(allowed[3]);
+    OLA_ASSERT_FALSE(allowed[4]);
+    OLA_ASSERT_EQ(2u, suppressed);
+    OLA_ASSERT_EQ(0u, limiter.TakeSuppressed());
+    break;
+  }
+}
+
+
+/*
+ * Check the AsyncLogDestination writes everything, in order.
+ */
+void LoggingTest::testAsyncLogging() {
+  MockLogDestination *mock = new MockLogDestination();
+  ola::AsyncLogDestination *destination = new ola::AsyncLogDestination(mock,
+                                                                       4);
+  InitLogging(ola::OLA_LOG_DEBUG, destination);
+  mock->AddExpected(ola::OLA_LOG_DEBUG, " debug\n");
+  mock->AddExpected(ola::OLA_LOG_INFO, " info\n");
+  mock->AddExpected(ola::OLA_LOG_WARN, " warn\n");
+  OLA_DEBUG << "debug";
+  OLA_INFO << "info";
+  OLA_WARN << "warn";
+  destination->Flush();
+  OLA_ASSERT_EQ(mock->LinesRemaining(), 0);
+
+  // Fatal messages are written straight away, after the queued ones.
+  mock->AddExpected(ola::OLA_LOG_WARN, " warn\n");
+  mock->AddExpected(ola::OLA_LOG_FATAL, " fatal\n");
+  OLA_WARN << "warn";
+  OLA_FATAL << "fatal";
+  OLA_ASSERT_EQ(mock->LinesRemaining(), 0);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), destination->Dropped());
+  InitLogging(ola::OLA_LOG_DEBUG, NULL);
+}
@@ -1,6 +1,7 @@
 # LIBRARIES
 ##################################################
 common_libolacommon_la_SOURCES += \
+    common/base/AsyncLogDestination.cpp \
     common/base/Credentials.cpp \
     common/base/Env.cpp \
     common/base/Flags.cpp \
@@ -0,0 +1,80 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * BinaryFrame.cpp
+ * A binary format for DMX frames.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Constants.h>
+#include <ola/dmx/BinaryFrame.h>
+
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+using std::string;
+using std::vector;
+
+bool BinaryFrame::ParseHeader(const uint8_t *header,
+                              unsigned int *universe,
+                              unsigned int *slot_count) {
+  *universe = (static_cast<unsigned int>(header[0]) << 24) |
+              (static_cast<unsigned int>(header[1]) << 16) |
+              (static_cast<unsigned int>(header[2]) << 8) |
+              header[3];
+  *slot_count = (static_cast<unsigned int>(header[4]) << 8) | header[5];
+  return *slot_count <= DMX_UNIVERSE_SIZE;
+}
+
+bool BinaryFrame::Parse(const uint8_t *data,
+                        unsigned int length,
+                        vector<BinaryFrame> *frames) {
+  const uint8_t *end = data + length;
+  while (data != end) {
+    unsigned int universe, slot_count;
+    if (static_cast<unsigned int>(end - data) < HEADER_SIZE ||
+        !ParseHeader(data, &universe, &slot_count)) {
+      return false;
+    }
+    data += HEADER_SIZE;
+    if (static_cast<unsigned int>(end - data) < slot_count) {
+      return false;
+    }
+    frames->push_back(BinaryFrame(universe, DmxBuffer(data, slot_count)));
+    data += slot_count;
+  }
+  return true;
+}
+
+void BinaryFrame::Write(unsigned int universe,
+                        const DmxBuffer &buffer,
+                        string *output) {
+  const unsigned int slot_count = buffer.Size();
+  const char header[HEADER_SIZE] = {
+    static_cast<char>(universe >> 24),
+    static_cast<char>(universe >> 16),
+    static_cast<char>(universe >> 8),
+    static_cast<char>(universe),
+    static_cast<char>(slot_count >> 8),
+    static_cast<char>(slot_count),
+  };
+  output->append(header, sizeof(header));
+  output->append(reinterpret_cast<const char*>(buffer.GetRaw()), slot_count);
+}
+}  // namespace dmx
+}  // namespace ola
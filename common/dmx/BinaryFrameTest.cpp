@@ -0,0 +1,108 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * BinaryFrameTest.cpp
+ * Test fixture for the BinaryFrame class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/BinaryFrame.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::BinaryFrame;
+using std::string;
+using std::vector;
+
+class BinaryFrameTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(BinaryFrameTest);
+  CPPUNIT_TEST(testRoundTrip);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testRoundTrip();
+  void testInvalid();
+
+ private:
+  bool Parse(const string &input, vector<BinaryFrame> *frames) {
+    return BinaryFrame::Parse(reinterpret_cast<const uint8_t*>(input.data()),
+                              input.size(), frames);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BinaryFrameTest);
+
+
+/*
+ * Check frames can be written and parsed back.
+ */
+void BinaryFrameTest::testRoundTrip() {
+  DmxBuffer first, second, empty;
+  first.SetFromString("1,2,3");
+  second.SetRangeToValue(0, 255, ola::DMX_UNIVERSE_SIZE);
+
+  string output;
+  BinaryFrame::Write(1, first, &output);
+  const uint8_t expected[] = {0, 0, 0, 1, 0, 3, 1, 2, 3};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                         reinterpret_cast<const uint8_t*>(output.data()),
+                         output.size());
+
+  BinaryFrame::Write(0x12345678, second, &output);
+  BinaryFrame::Write(2, empty, &output);
+
+  vector<BinaryFrame> frames;
+  OLA_ASSERT_TRUE(Parse(output, &frames));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), frames.size());
+  OLA_ASSERT_EQ(1u, frames[0].universe);
+  OLA_ASSERT_TRUE(first == frames[0].data);
+  OLA_ASSERT_EQ(0x12345678u, frames[1].universe);
+  OLA_ASSERT_TRUE(second == frames[1].data);
+  OLA_ASSERT_EQ(2u, frames[2].universe);
+  OLA_ASSERT_EQ(0u, frames[2].data.Size());
+}
+
+
+/*
+ * Check truncated and oversized frames are rejected.
+ */
+void BinaryFrameTest::testInvalid() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  string output;
+  BinaryFrame::Write(1, buffer, &output);
+
+  vector<BinaryFrame> frames;
+  OLA_ASSERT_FALSE(Parse(output.substr(0, 4), &frames));
+  OLA_ASSERT_FALSE(Parse(output.substr(0, output.size() - 1), &frames));
+
+  const uint8_t too_large[] = {0, 0, 0, 1, 0x02, 0x01};
+  unsigned int universe, slot_count;
+  OLA_ASSERT_FALSE(BinaryFrame::ParseHeader(too_large, &universe,
+                                            &slot_count));
+  OLA_ASSERT_EQ(513u, slot_count);
+
+  // Nothing is valid too.
+  OLA_ASSERT_TRUE(Parse("", &frames));
+}
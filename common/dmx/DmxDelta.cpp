@@ -0,0 +1,130 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxDelta.cpp
+ * Delta encoding for the DmxData sent over the RPC connection.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/dmx/DmxDelta.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "ola/Constants.h"
+
+namespace ola {
+namespace dmx {
+
+using ola::proto::DmxData;
+using ola::proto::DmxSlotRange;
+using std::vector;
+
+namespace {
+// Runs of unchanged slots shorter than this are included in a range rather
+// than starting a new one.
+const unsigned int MERGE_GAP = 4;
+// The approximate encoded size of a range, excluding the slot data.
+const unsigned int RANGE_OVERHEAD = 6;
+}  // namespace
+
+bool EncodeDmxData(const DmxBuffer &previous, const DmxBuffer &frame,
+                   DmxData *data) {
+  data->clear_delta_length();
+  data->clear_changed_slots();
+
+  const unsigned int size = frame.Size();
+  if (!previous.Size() || !size) {
+    data->set_data(frame.Get());
+    return false;
+  }
+
+  vector<DmxBuffer::SlotRange> ranges;
+  frame.Diff(previous, &ranges, MERGE_GAP);
+
+  const uint8_t *new_slots = frame.GetRaw();
+  unsigned int encoded_size = 0;
+  vector<DmxBuffer::SlotRange>::const_iterator iter = ranges.begin();
+  for (; iter != ranges.end(); ++iter) {
+    encoded_size += iter->length + RANGE_OVERHEAD;
+    if (encoded_size >= size) {
+      data->clear_changed_slots();
+      data->set_data(frame.Get());
+      return false;
+    }
+
+    DmxSlotRange *range = data->add_changed_slots();
+    range->set_offset(iter->offset);
+    range->set_data(reinterpret_cast<const char*>(new_slots + iter->offset),
+                    iter->length);
+  }
+
+  data->set_data("");
+  data->set_delta_length(size);
+  return true;
+}
+
+bool DecodeDmxData(const DmxBuffer &previous, const DmxData &data,
+                   DmxBuffer *frame) {
+  if (!data.has_delta_length()) {
+    return frame->Set(data.data());
+  }
+
+  const int length = data.delta_length();
+  if (length < 0 || length > static_cast<int>(DMX_UNIVERSE_SIZE)) {
+    return false;
+  }
+
+  const unsigned int size = static_cast<unsigned int>(length);
+  for (int i = 0; i < data.changed_slots_size(); i++) {
+    const DmxSlotRange &range = data.changed_slots(i);
+    if (range.offset() < 0 ||
+        static_cast<unsigned int>(range.offset()) + range.data().size() >
+            size) {
+      return false;
+    }
+  }
+
+  if (&previous == frame && previous.Size() == size) {
+    // Decoding in place, only the changed slots need to be copied.
+    for (int i = 0; i < data.changed_slots_size(); i++) {
+      const DmxSlotRange &range = data.changed_slots(i);
+      frame->SetRange(range.offset(),
+                      reinterpret_cast<const uint8_t*>(range.data().data()),
+                      range.data().size());
+    }
+    return true;
+  }
+
+  // Slots beyond the end of the previous frame start at 0.
+  uint8_t slots[DMX_UNIVERSE_SIZE];
+  memset(slots, 0, sizeof(slots));
+  if (previous.Size()) {
+    memcpy(slots, previous.GetRaw(), std::min(size, previous.Size()));
+  }
+
+  for (int i = 0; i < data.changed_slots_size(); i++) {
+    const DmxSlotRange &range = data.changed_slots(i);
+    const std::string &range_data = range.data();
+    memcpy(slots + range.offset(), range_data.data(), range_data.size());
+  }
+  return frame->Set(slots, size);
+}
+}  // namespace dmx
+}  // namespace ola
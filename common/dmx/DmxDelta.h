@@ -0,0 +1,63 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxDelta.h
+ * Delta encoding for the DmxData sent over the RPC connection.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_DMX_DMXDELTA_H_
+#define COMMON_DMX_DMXDELTA_H_
+
+#include <ola/DmxBuffer.h>
+
+namespace ola {
+namespace proto {
+class DmxData;
+}
+
+namespace dmx {
+
+/**
+ * @brief Set the frame in a DmxData message, delta encoding it if that's
+ *   smaller.
+ * @param previous the previous frame sent for the universe, may be empty.
+ * @param frame the frame to send.
+ * @param[out] data the DmxData to fill in. Either the data field is set to the
+ *   full frame, or the delta fields are set.
+ * @returns true if the frame was delta encoded, false if the full frame was
+ *   used.
+ *
+ * Changed slots separated by only a few unchanged slots are sent as a single
+ * range, since each range has a few bytes of overhead.
+ */
+bool EncodeDmxData(const DmxBuffer &previous, const DmxBuffer &frame,
+                   ola::proto::DmxData *data);
+
+/**
+ * @brief Get the frame from a DmxData message, applying any delta.
+ * @param previous the previous frame received for the universe.
+ * @param data the DmxData message.
+ * @param[out] frame the new frame.
+ * @returns false if the delta was invalid, true otherwise.
+ *
+ * previous and frame may be the same buffer. If the frame size is unchanged
+ * the delta is then applied in place, copying only the changed slots.
+ */
+bool DecodeDmxData(const DmxBuffer &previous, const ola::proto::DmxData &data,
+                   DmxBuffer *frame);
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_DMXDELTA_H_
@@ -0,0 +1,192 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxDeltaTest.cpp
+ * Test fixture for the DmxData delta encoding.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "common/dmx/DmxDelta.h"
+#include "common/protocol/Ola.pb.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::DecodeDmxData;
+using ola::dmx::EncodeDmxData;
+using ola::proto::DmxData;
+using std::string;
+
+class DmxDeltaTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DmxDeltaTest);
+  CPPUNIT_TEST(testFullFrames);
+  CPPUNIT_TEST(testDelta);
+  CPPUNIT_TEST(testLengthChange);
+  CPPUNIT_TEST(testInvalidDelta);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testFullFrames();
+  void testDelta();
+  void testLengthChange();
+  void testInvalidDelta();
+
+ private:
+  void CheckRoundTrip(const DmxBuffer &previous, const DmxBuffer &frame,
+                      bool expect_delta);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DmxDeltaTest);
+
+void DmxDeltaTest::CheckRoundTrip(const DmxBuffer &previous,
+                                  const DmxBuffer &frame,
+                                  bool expect_delta) {
+  DmxData data;
+  data.set_universe(1);
+  OLA_ASSERT_EQ(expect_delta, EncodeDmxData(previous, frame, &data));
+  OLA_ASSERT_EQ(expect_delta, data.has_delta_length());
+
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(DecodeDmxData(previous, data, &output));
+  OLA_ASSERT_TRUE(frame == output);
+
+  // Decoding in place should give the same result.
+  DmxBuffer in_place;
+  in_place.Set(previous.GetRaw(), previous.Size());
+  OLA_ASSERT_TRUE(DecodeDmxData(in_place, data, &in_place));
+  OLA_ASSERT_TRUE(frame == in_place);
+}
+
+/*
+ * Check full frames are used when there's nothing to diff against, or the
+ * delta wouldn't be smaller.
+ */
+void DmxDeltaTest::testFullFrames() {
+  DmxBuffer empty;
+  DmxBuffer frame;
+  frame.SetRangeToValue(0, 10, ola::DMX_UNIVERSE_SIZE);
+  CheckRoundTrip(empty, frame, false);
+
+  DmxBuffer inverted;
+  inverted.SetRangeToValue(0, 245, ola::DMX_UNIVERSE_SIZE);
+  CheckRoundTrip(frame, inverted, false);
+
+  // alternate slots change, which would need a range every slot if they
+  // weren't merged.
+  DmxBuffer alternate(frame);
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i += 2) {
+    alternate.SetChannel(i, 0);
+  }
+  CheckRoundTrip(frame, alternate, false);
+}
+
+/*
+ * Check a frame with a few changed slots is delta encoded.
+ */
+void DmxDeltaTest::testDelta() {
+  DmxBuffer previous;
+  previous.Blackout();
+  DmxBuffer frame(previous);
+  frame.SetChannel(0, 255);
+  frame.SetChannel(2, 128);
+  frame.SetChannel(100, 1);
+  frame.SetChannel(511, 2);
+
+  DmxData data;
+  OLA_ASSERT_TRUE(EncodeDmxData(previous, frame, &data));
+  OLA_ASSERT_EQ(string(""), data.data());
+  OLA_ASSERT_EQ(static_cast<int>(ola::DMX_UNIVERSE_SIZE),
+                data.delta_length());
+  // The first two changes are merged.
+  OLA_ASSERT_EQ(3, data.changed_slots_size());
+  OLA_ASSERT_EQ(0, data.changed_slots(0).offset());
+  OLA_ASSERT_EQ(static_cast<size_t>(3), data.changed_slots(0).data().size());
+  OLA_ASSERT_EQ(100, data.changed_slots(1).offset());
+  OLA_ASSERT_EQ(511, data.changed_slots(2).offset());
+
+  CheckRoundTrip(previous, frame, true);
+
+  // No changes at all.
+  data.Clear();
+  OLA_ASSERT_TRUE(EncodeDmxData(frame, frame, &data));
+  OLA_ASSERT_EQ(0, data.changed_slots_size());
+  CheckRoundTrip(frame, frame, true);
+
+  // Re-encoding a full frame into a message clears the delta fields.
+  DmxBuffer empty;
+  OLA_ASSERT_FALSE(EncodeDmxData(empty, frame, &data));
+  OLA_ASSERT_FALSE(data.has_delta_length());
+  OLA_ASSERT_EQ(0, data.changed_slots_size());
+}
+
+/*
+ * Check frames can grow and shrink.
+ */
+void DmxDeltaTest::testLengthChange() {
+  DmxBuffer previous;
+  previous.SetRangeToValue(0, 20, 400);
+  DmxBuffer longer(previous);
+  longer.SetRangeToValue(400, 0, 112);
+  longer.SetChannel(500, 1);
+  CheckRoundTrip(previous, longer, true);
+
+  DmxBuffer shorter;
+  shorter.SetRangeToValue(0, 20, 300);
+  CheckRoundTrip(previous, shorter, true);
+}
+
+/*
+ * Check invalid deltas are rejected.
+ */
+void DmxDeltaTest::testInvalidDelta() {
+  DmxBuffer previous;
+  previous.Blackout();
+  DmxBuffer output;
+
+  DmxData data;
+  data.set_universe(1);
+  data.set_data("");
+  data.set_delta_length(ola::DMX_UNIVERSE_SIZE + 1);
+  OLA_ASSERT_FALSE(DecodeDmxData(previous, data, &output));
+
+  data.set_delta_length(10);
+  ola::proto::DmxSlotRange *range = data.add_changed_slots();
+  range->set_offset(8);
+  range->set_data("abc");
+  OLA_ASSERT_FALSE(DecodeDmxData(previous, data, &output));
+
+  range->set_offset(-1);
+  OLA_ASSERT_FALSE(DecodeDmxData(previous, data, &output));
+
+  // An invalid delta leaves the buffer untouched when decoding in place.
+  DmxBuffer in_place;
+  in_place.SetRangeToValue(0, 1, 10);
+  ola::proto::DmxSlotRange *valid_range = data.add_changed_slots();
+  valid_range->set_offset(0);
+  valid_range->set_data("x");
+  OLA_ASSERT_FALSE(DecodeDmxData(in_place, data, &in_place));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), in_place.Get(0));
+  data.mutable_changed_slots()->RemoveLast();
+
+  range->set_offset(7);
+  OLA_ASSERT_TRUE(DecodeDmxData(previous, data, &output));
+  OLA_ASSERT_EQ(10u, output.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>('c'), output.Get(9));
+}
@@ -1,11 +1,48 @@
 # LIBRARIES
 ##################################################
-common_libolacommon_la_SOURCES += common/dmx/RunLengthEncoder.cpp
+common_libolacommon_la_SOURCES += \
+    common/dmx/BinaryFrame.cpp \
+    common/dmx/DmxDelta.cpp \
+    common/dmx/DmxDelta.h \
+    common/dmx/PcapWriter.cpp \
+    common/dmx/RunLengthEncoder.cpp \
+    common/dmx/SharedDmxRegion.cpp \
+    common/dmx/SharedDmxRegion.h
 
 # TESTS
 ##################################################
-test_programs += common/dmx/RunLengthEncoderTester
+test_programs += \
+    common/dmx/BinaryFrameTester \
+    common/dmx/DmxDeltaTester \
+    common/dmx/PcapWriterTester \
+    common/dmx/RunLengthEncoderTester \
+    common/dmx/SharedDmxRegionTester
+
+common_dmx_BinaryFrameTester_SOURCES = common/dmx/BinaryFrameTest.cpp
+common_dmx_BinaryFrameTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_BinaryFrameTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_DmxDeltaTester_SOURCES = common/dmx/DmxDeltaTest.cpp
+common_dmx_DmxDeltaTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
+common_dmx_DmxDeltaTester_LDADD = $(COMMON_TESTING_LIBS) \
+                                  $(libprotobuf_LIBS)
+
+common_dmx_PcapWriterTester_SOURCES = common/dmx/PcapWriterTest.cpp
+common_dmx_PcapWriterTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_PcapWriterTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_dmx_RunLengthEncoderTester_SOURCES = common/dmx/RunLengthEncoderTest.cpp
 common_dmx_RunLengthEncoderTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_dmx_RunLengthEncoderTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_dmx_SharedDmxRegionTester_SOURCES = common/dmx/SharedDmxRegionTest.cpp
+common_dmx_SharedDmxRegionTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_dmx_SharedDmxRegionTester_LDADD = $(COMMON_TESTING_LIBS)
+
+# BENCHMARKS
+##################################################
+benchmark_programs += common/dmx/RunLengthEncoderBenchmark
+
+common_dmx_RunLengthEncoderBenchmark_SOURCES = \
+    common/dmx/RunLengthEncoderBenchmark.cpp
+common_dmx_RunLengthEncoderBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS)
@@ -0,0 +1,348 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PcapWriter.cpp
+ * Writes DMX512 and RDM frames to a pcapng capture file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/dmx/PcapWriter.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+
+namespace ola {
+namespace dmx {
+
+using ola::thread::ConditionVariable;
+using ola::thread::Mutex;
+using std::string;
+
+namespace {
+
+// See https://www.ietf.org/archive/id/draft-ietf-opsawg-pcapng-01.html
+const uint32_t SECTION_HEADER_BLOCK = 0x0A0D0D0A;
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 0x00000001;
+const uint32_t ENHANCED_PACKET_BLOCK = 0x00000006;
+const uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+
+const uint16_t OPT_ENDOFOPT = 0;
+const uint16_t OPT_IF_NAME = 2;
+const uint16_t OPT_IF_TSRESOL = 9;
+// Timestamps are in units of 10^-9 seconds.
+const uint8_t NANOSECOND_RESOLUTION = 9;
+
+// The fixed part of an enhanced packet block, including the trailing length.
+const unsigned int PACKET_BLOCK_OVERHEAD = 32;
+
+unsigned int Padding(unsigned int length) {
+  return (4 - (length & 3)) & 3;
+}
+}  // namespace
+
+/**
+ * @cond HIDDEN_SYMBOLS
+ *
+ * The writer thread takes buffers from the pending queue, writes them out and
+ * puts them on the free list to be reused.
+ */
+class PcapWriter::WriterThread : public ola::thread::Thread {
+ public:
+  explicit WriterThread(int fd)
+      : Thread(Thread::Options("ola-pcap-writer")),
+        m_fd(fd),
+        m_terminate(false),
+        m_write_failed(false) {
+  }
+
+  ~WriterThread() {
+    close(m_fd);
+    std::vector<Buffer*>::iterator iter = m_free.begin();
+    for (; iter != m_free.end(); ++iter) {
+      delete *iter;
+    }
+  }
+
+  /*
+   * Queue a buffer to be written.
+   * @returns an empty buffer to use next, or NULL if there are too many
+   *   buffers waiting, in which case the buffer isn't taken.
+   */
+  Buffer *Swap(Buffer *buffer) {
+    Buffer *next = NULL;
+    m_mutex.Lock();
+    if (m_pending.size() < MAX_PENDING_BUFFERS) {
+      m_pending.push_back(buffer);
+      if (m_free.empty()) {
+        next = new Buffer();
+        next->reserve(BUFFER_SIZE);
+      } else {
+        next = m_free.back();
+        m_free.pop_back();
+      }
+    }
+    m_mutex.Unlock();
+    if (next) {
+      m_condition.Signal();
+    }
+    return next;
+  }
+
+  /*
+   * Queue the last buffer and stop once everything has been written.
+   */
+  void Terminate(Buffer *buffer) {
+    m_mutex.Lock();
+    m_pending.push_back(buffer);
+    m_terminate = true;
+    m_mutex.Unlock();
+    m_condition.Signal();
+  }
+
+ protected:
+  void *Run() {
+    m_mutex.Lock();
+    while (true) {
+      while (m_pending.empty() && !m_terminate) {
+        m_condition.Wait(&m_mutex);
+      }
+      if (m_pending.empty()) {
+        break;
+      }
+      Buffer *buffer = m_pending.front();
+      m_pending.pop_front();
+      m_mutex.Unlock();
+
+      Write(*buffer);
+      buffer->clear();
+
+      m_mutex.Lock();
+      m_free.push_back(buffer);
+    }
+    m_mutex.Unlock();
+    return NULL;
+  }
+
+ private:
+  const int m_fd;
+  Mutex m_mutex;
+  ConditionVariable m_condition;
+  std::deque<Buffer*> m_pending;
+  std::vector<Buffer*> m_free;
+  bool m_terminate;
+  bool m_write_failed;  // only used by the writer thread
+
+  void Write(const Buffer &buffer) {
+    const uint8_t *data = buffer.empty() ? NULL : &buffer[0];
+    size_t remaining = buffer.size();
+    while (remaining && !m_write_failed) {
+      ssize_t written = write(m_fd, data, remaining);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        OLA_WARN << "Failed to write capture: " << strerror(errno);
+        m_write_failed = true;
+        return;
+      }
+      data += written;
+      remaining -= written;
+    }
+  }
+};
+/**@endcond*/
+
+
+PcapWriter* PcapWriter::Open(const string &path) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd < 0) {
+    OLA_WARN << "open(" << path << ") failed: " << strerror(errno);
+    return NULL;
+  }
+  return new PcapWriter(fd);
+}
+
+
+PcapWriter::PcapWriter(int fd)
+    : m_thread(new WriterThread(fd)),
+      m_buffer(new Buffer()),
+      m_interface_count(0),
+      m_frames_written(0),
+      m_frames_dropped(0) {
+  m_buffer->reserve(BUFFER_SIZE);
+  WriteSectionHeader();
+  m_thread->Start();
+}
+
+
+PcapWriter::~PcapWriter() {
+  m_thread->Terminate(m_buffer);
+  m_thread->Join();
+  delete m_thread;
+  if (m_frames_dropped) {
+    OLA_WARN << "Dropped " << m_frames_dropped << " of "
+             << m_frames_written + m_frames_dropped << " captured frames";
+  }
+}
+
+
+unsigned int PcapWriter::AddInterface(LinkType link_type,
+                                      const string &name) {
+  const unsigned int name_length = name.size();
+  // The fixed fields, the name, resolution and end options, and the trailing
+  // length.
+  const unsigned int block_length =
+      16 + (4 + name_length + Padding(name_length)) + 8 + 4 + 4;
+
+  // The description is needed to read the frames that follow, so it's always
+  // buffered, even if that takes the buffer past BUFFER_SIZE.
+  AppendUInt32(INTERFACE_DESCRIPTION_BLOCK);
+  AppendUInt32(block_length);
+  AppendUInt16(link_type);
+  AppendUInt16(0);  // reserved
+  AppendUInt32(0);  // no snap length
+  AppendOption(OPT_IF_NAME, reinterpret_cast<const uint8_t*>(name.data()),
+               name_length);
+  AppendOption(OPT_IF_TSRESOL, &NANOSECOND_RESOLUTION,
+               sizeof(NANOSECOND_RESOLUTION));
+  AppendOption(OPT_ENDOFOPT, NULL, 0);
+  AppendUInt32(block_length);
+  return m_interface_count++;
+}
+
+
+bool PcapWriter::WriteFrame(unsigned int interface_id,
+                            const TimeStamp &time,
+                            uint8_t start_code,
+                            const uint8_t *slots,
+                            unsigned int slot_count) {
+  const unsigned int frame_length = slot_count + 1;
+  const unsigned int block_length =
+      PACKET_BLOCK_OVERHEAD + frame_length + Padding(frame_length);
+  if (!Reserve(block_length)) {
+    m_frames_dropped++;
+    return false;
+  }
+
+  const uint64_t timestamp = (
+      static_cast<uint64_t>(time.Seconds()) * 1000000000ull +
+      static_cast<uint64_t>(time.MicroSeconds()) * 1000);
+  AppendUInt32(ENHANCED_PACKET_BLOCK);
+  AppendUInt32(block_length);
+  AppendUInt32(interface_id);
+  AppendUInt32(static_cast<uint32_t>(timestamp >> 32));
+  AppendUInt32(static_cast<uint32_t>(timestamp));
+  AppendUInt32(frame_length);
+  AppendUInt32(frame_length);
+  m_buffer->push_back(start_code);
+  AppendData(slots, slot_count);
+  AppendPadding(Padding(frame_length));
+  AppendUInt32(block_length);
+  m_frames_written++;
+
+  if (!m_last_flush.IsSet()) {
+    m_last_flush = time;
+  } else if ((time - m_last_flush).InMilliSeconds() >=
+             static_cast<int64_t>(FLUSH_INTERVAL_MS)) {
+    Flush();
+    m_last_flush = time;
+  }
+  return true;
+}
+
+
+void PcapWriter::Flush() {
+  if (m_buffer->empty()) {
+    return;
+  }
+  Buffer *next = m_thread->Swap(m_buffer);
+  if (next) {
+    m_buffer = next;
+  }
+}
+
+
+/*
+ * Make sure there's space for a block, flushing the buffer if needed.
+ * @returns false if the buffer is full and can't be flushed.
+ */
+bool PcapWriter::Reserve(unsigned int size) {
+  if (m_buffer->size() + size <= BUFFER_SIZE) {
+    return true;
+  }
+  Flush();
+  return m_buffer->size() + size <= BUFFER_SIZE;
+}
+
+
+/*
+ * The blocks are written in host byte order, readers use the byte order magic
+ * in the section header to tell which order that was.
+ */
+void PcapWriter::AppendUInt16(uint16_t value) {
+  AppendData(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+
+void PcapWriter::AppendUInt32(uint32_t value) {
+  AppendData(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+
+void PcapWriter::AppendData(const uint8_t *data, unsigned int length) {
+  m_buffer->insert(m_buffer->end(), data, data + length);
+}
+
+
+void PcapWriter::AppendPadding(unsigned int length) {
+  m_buffer->insert(m_buffer->end(), length, 0);
+}
+
+
+void PcapWriter::AppendOption(uint16_t code, const uint8_t *data,
+                              unsigned int length) {
+  AppendUInt16(code);
+  AppendUInt16(length);
+  AppendData(data, length);
+  AppendPadding(Padding(length));
+}
+
+
+void PcapWriter::WriteSectionHeader() {
+  const uint32_t block_length = 28;
+  AppendUInt32(SECTION_HEADER_BLOCK);
+  AppendUInt32(block_length);
+  AppendUInt32(BYTE_ORDER_MAGIC);
+  AppendUInt16(1);  // major version
+  AppendUInt16(0);  // minor version
+  // The section length isn't known.
+  AppendUInt32(0xffffffff);
+  AppendUInt32(0xffffffff);
+  AppendUInt32(block_length);
+}
+}  // namespace dmx
+}  // namespace ola
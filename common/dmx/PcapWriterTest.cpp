@@ -0,0 +1,227 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PcapWriterTest.cpp
+ * Test fixture for the PcapWriter class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/dmx/PcapWriter.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::TimeStamp;
+using ola::dmx::PcapWriter;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+namespace {
+
+struct Block {
+  uint32_t type;
+  vector<uint8_t> body;  // without the type and lengths
+};
+
+TimeStamp MakeTime(int32_t seconds, int32_t micro_seconds) {
+  struct timeval tv;
+  tv.tv_sec = seconds;
+  tv.tv_usec = micro_seconds;
+  return TimeStamp(tv);
+}
+
+uint32_t ReadUInt32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint16_t ReadUInt16(const uint8_t *data) {
+  uint16_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+/*
+ * Split a capture into blocks, checking the lengths at each end match.
+ */
+bool ReadBlocks(const string &path, vector<Block> *blocks) {
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  unsigned int offset = 0;
+  while (offset < data.size()) {
+    if (data.size() - offset < 12) {
+      return false;
+    }
+    const uint32_t length = ReadUInt32(&data[offset + 4]);
+    if (length % 4 || length < 12 || offset + length > data.size() ||
+        ReadUInt32(&data[offset + length - 4]) != length) {
+      return false;
+    }
+    Block block;
+    block.type = ReadUInt32(&data[offset]);
+    block.body.assign(data.begin() + offset + 8,
+                      data.begin() + offset + length - 4);
+    blocks->push_back(block);
+    offset += length;
+  }
+  return true;
+}
+}  // namespace
+
+class PcapWriterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PcapWriterTest);
+  CPPUNIT_TEST(testWriteFrames);
+  CPPUNIT_TEST(testManyFrames);
+  CPPUNIT_TEST(testOpenFailure);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testWriteFrames();
+  void testManyFrames();
+  void testOpenFailure();
+
+ private:
+  string m_path;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PcapWriterTest);
+
+void PcapWriterTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  std::ostringstream str;
+  str << "/tmp/ola-pcap-test-" << getpid();
+  m_path = str.str();
+  unlink(m_path.c_str());
+}
+
+void PcapWriterTest::tearDown() {
+  unlink(m_path.c_str());
+}
+
+/*
+ * Check the blocks in the capture.
+ */
+void PcapWriterTest::testWriteFrames() {
+  const uint8_t dmx[] = {1, 2, 3, 4, 5};
+  const uint8_t rdm[] = {0x01, 0x18, 0x7a};
+  {
+    auto_ptr<PcapWriter> writer(PcapWriter::Open(m_path));
+    OLA_ASSERT_NOT_NULL(writer.get());
+    OLA_ASSERT_EQ(0u, writer->AddInterface(PcapWriter::LINKTYPE_DMX, "dmx"));
+    OLA_ASSERT_EQ(1u, writer->AddInterface(PcapWriter::LINKTYPE_RDM, "rdm"));
+    OLA_ASSERT_TRUE(writer->WriteFrame(0, MakeTime(10, 250), 0, dmx,
+                                       sizeof(dmx)));
+    OLA_ASSERT_TRUE(writer->WriteFrame(1, MakeTime(10, 500), 0xcc, rdm,
+                                       sizeof(rdm)));
+    OLA_ASSERT_EQ(static_cast<uint64_t>(2), writer->FramesWritten());
+    OLA_ASSERT_EQ(static_cast<uint64_t>(0), writer->FramesDropped());
+  }
+
+  vector<Block> blocks;
+  OLA_ASSERT_TRUE(ReadBlocks(m_path, &blocks));
+  OLA_ASSERT_EQ(static_cast<size_t>(5), blocks.size());
+
+  // Section header
+  OLA_ASSERT_EQ(0x0A0D0D0Au, blocks[0].type);
+  OLA_ASSERT_EQ(0x1A2B3C4Du, ReadUInt32(&blocks[0].body[0]));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(1), ReadUInt16(&blocks[0].body[4]));
+
+  // Interfaces, with the name and nanosecond resolution options
+  OLA_ASSERT_EQ(1u, blocks[1].type);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(147), ReadUInt16(&blocks[1].body[0]));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(2), ReadUInt16(&blocks[1].body[8]));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(3), ReadUInt16(&blocks[1].body[10]));
+  OLA_ASSERT_EQ(string("dmx"),
+                string(reinterpret_cast<char*>(&blocks[1].body[12]), 3));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(9), ReadUInt16(&blocks[1].body[16]));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(9), blocks[1].body[20]);
+  OLA_ASSERT_EQ(1u, blocks[2].type);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(148), ReadUInt16(&blocks[2].body[0]));
+
+  // The DMX frame
+  OLA_ASSERT_EQ(6u, blocks[3].type);
+  OLA_ASSERT_EQ(0u, ReadUInt32(&blocks[3].body[0]));
+  const uint64_t timestamp = (
+      static_cast<uint64_t>(ReadUInt32(&blocks[3].body[4])) << 32 |
+      ReadUInt32(&blocks[3].body[8]));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10000250000ull), timestamp);
+  OLA_ASSERT_EQ(6u, ReadUInt32(&blocks[3].body[12]));
+  OLA_ASSERT_EQ(6u, ReadUInt32(&blocks[3].body[16]));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), blocks[3].body[20]);
+  OLA_ASSERT_DATA_EQUALS(dmx, sizeof(dmx), &blocks[3].body[21], sizeof(dmx));
+  // Padded to 4 bytes
+  OLA_ASSERT_EQ(static_cast<size_t>(28), blocks[3].body.size());
+
+  // The RDM frame
+  OLA_ASSERT_EQ(6u, blocks[4].type);
+  OLA_ASSERT_EQ(1u, ReadUInt32(&blocks[4].body[0]));
+  OLA_ASSERT_EQ(4u, ReadUInt32(&blocks[4].body[12]));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xcc), blocks[4].body[20]);
+  OLA_ASSERT_DATA_EQUALS(rdm, sizeof(rdm), &blocks[4].body[21], sizeof(rdm));
+}
+
+/*
+ * Check enough frames to fill many buffers all reach the file.
+ */
+void PcapWriterTest::testManyFrames() {
+  uint8_t dmx[512];
+  memset(dmx, 0, sizeof(dmx));
+  uint64_t written;
+  {
+    auto_ptr<PcapWriter> writer(PcapWriter::Open(m_path));
+    OLA_ASSERT_NOT_NULL(writer.get());
+    writer->AddInterface(PcapWriter::LINKTYPE_DMX, "universe 1");
+    for (unsigned int i = 0; i < 5000; i++) {
+      dmx[0] = i;
+      writer->WriteFrame(0, MakeTime(i / 40, (i % 40) * 25000), 0, dmx,
+                         sizeof(dmx));
+    }
+    written = writer->FramesWritten();
+    OLA_ASSERT_EQ(static_cast<uint64_t>(5000),
+                  written + writer->FramesDropped());
+  }
+
+  vector<Block> blocks;
+  OLA_ASSERT_TRUE(ReadBlocks(m_path, &blocks));
+  OLA_ASSERT_EQ(static_cast<size_t>(written + 2), blocks.size());
+  OLA_ASSERT_EQ(6u, blocks.back().type);
+}
+
+/*
+ * Check Open() fails if the file can't be created.
+ */
+void PcapWriterTest::testOpenFailure() {
+  auto_ptr<PcapWriter> writer(
+      PcapWriter::Open("/nonexistent-directory/capture.pcapng"));
+  OLA_ASSERT_NULL(writer.get());
+}
@@ -21,12 +21,81 @@
 #include <string.h>
 #include <ola/dmx/RunLengthEncoder.h>
 
+#include <algorithm>
+
+// SSE2 is part of the x86-64 baseline, so it's selected at compile time.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define OLA_RLE_SSE2 1
+#endif  // defined(__SSE2__)
+
 namespace ola {
 namespace dmx {
 
+namespace {
+
+/*
+ * Find the end of the run that starts at data[start].
+ * @returns the index of the first value in (start, end) that differs from
+ *   data[start], or end if they are all the same.
+ */
+unsigned int RunEnd(const uint8_t *data, unsigned int start,
+                    unsigned int end) {
+  unsigned int i = start + 1;
+#ifdef OLA_RLE_SSE2
+  const __m128i value = _mm_set1_epi8(static_cast<char>(data[start]));
+  for (; i + sizeof(__m128i) <= end; i += sizeof(__m128i)) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        data + i));
+    unsigned int differs = ~_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, value)) &
+        0xffff;
+    if (differs) {
+      return i + __builtin_ctz(differs);
+    }
+  }
+#endif  // OLA_RLE_SSE2
+  while (i < end && data[i] == data[start]) {
+    i++;
+  }
+  return i;
+}
+
+/*
+ * Find the first run of 3 or more values.
+ * @returns the first index j in [start, end) where data[j], data[j + 1] and
+ *   data[j + 2] are the same, or end if there isn't one. data[end + 1] must
+ *   be valid.
+ */
+unsigned int FindRun(const uint8_t *data, unsigned int start,
+                     unsigned int end) {
+  unsigned int j = start;
+#ifdef OLA_RLE_SSE2
+  for (; j + sizeof(__m128i) <= end; j += sizeof(__m128i)) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        data + j + 1));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        data + j + 2));
+    unsigned int runs = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(b, c)));
+    if (runs) {
+      return j + __builtin_ctz(runs);
+    }
+  }
+#endif  // OLA_RLE_SSE2
+  for (; j < end; j++) {
+    if (data[j] == data[j + 1] && data[j] == data[j + 2]) {
+      return j;
+    }
+  }
+  return end;
+}
+}  // namespace
+
 bool RunLengthEncoder::Encode(const DmxBuffer &src,
                               uint8_t *data,
                               unsigned int *data_size) {
+  const uint8_t *src_data = src.GetRaw();
   unsigned int src_size = src.Size();
   unsigned int dst_size = *data_size;
   unsigned int &dst_index = *data_size;
@@ -35,10 +104,8 @@ bool RunLengthEncoder::Encode(const DmxBuffer &src,
   unsigned int i;
   for (i = 0; i < src_size && dst_index < dst_size;) {
     // j points to the first non-repeating value
-    unsigned int j = i + 1;
-    while (j < src_size && src.Get(i) == src.Get(j) && j - i < 0x7f) {
-      j++;
-    }
+    unsigned int j = RunEnd(src_data, i,
+                            std::min(src_size, i + MAX_SEGMENT_LENGTH));
 
     // if the number of repeats is more than 2
     // don't encode only two repeats,
@@ -46,7 +113,7 @@ bool RunLengthEncoder::Encode(const DmxBuffer &src,
       // if room left in dst buffer
       if (dst_size - dst_index > 1) {
         data[dst_index++] = (REPEAT_FLAG | (j - i));
-        data[dst_index++] = src.Get(i);
+        data[dst_index++] = src_data[i];
       } else {
         // else return what we have done so far
         return false;
@@ -57,25 +124,23 @@ bool RunLengthEncoder::Encode(const DmxBuffer &src,
       // this value doesn't repeat more than twice
       // find out where the next repeat starts
 
-      // postcondition: j is one more than the last value we want to send
-      for (j = i + 1; j < src_size - 2 && j - i < 0x7f; j++) {
-        // at the end  of the array
+      // postcondition: j is one more than the last value we want to send.
+      // Runs of 3 that start in the last two values aren't worth encoding, so
+      // those are included in the literal segment.
+      if (i + 3 >= src_size) {
+        j = src_size;
+      } else {
+        unsigned int end = std::min(src_size - 2, i + MAX_SEGMENT_LENGTH);
+        j = FindRun(src_data, i + 1, end);
         if (j == src_size - 2) {
-          j = src_size;
-          break;
+          j = std::min(src_size, i + MAX_SEGMENT_LENGTH);
         }
-
-        // if we're found a repeat of 3 or more stop here
-        if (src.Get(j) == src.Get(j+1) && src.Get(j) == src.Get(j+2))
-          break;
       }
-      if (j >= src_size - 2)
-        j = src_size;
 
       // if we have enough room left for all the values
       if (dst_index + j - i < dst_size) {
         data[dst_index++] = j - i;
-        memcpy(&data[dst_index], src.GetRaw() + i, j-i);
+        memcpy(&data[dst_index], src_data + i, j-i);
         dst_index += j - i;
         i = j;
 
@@ -83,7 +148,7 @@ bool RunLengthEncoder::Encode(const DmxBuffer &src,
       } else if (dst_size - dst_index > 1) {
         unsigned int l = dst_size - dst_index -1;
         data[dst_index++] = l;
-        memcpy(&data[dst_index], src.GetRaw() + i, l);
+        memcpy(&data[dst_index], src_data + i, l);
         dst_index += l;
         return false;
       } else {
@@ -0,0 +1,107 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RunLengthEncoderBenchmark.cpp
+ * Microbenchmarks for the RunLengthEncoder.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/RunLengthEncoder.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::DmxBuffer;
+using ola::dmx::RunLengthEncoder;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+
+namespace {
+
+// Room for the worst case, one header byte per slot.
+const unsigned int ENCODED_SIZE = 2 * ola::DMX_UNIVERSE_SIZE;
+
+/*
+ * A frame with runs of repeated values, like a rig where a few fixtures are
+ * on and the rest are at zero.
+ */
+DmxBuffer RepeatingFrame() {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>((i / 32) % 2 ? 255 : 0);
+  }
+  return DmxBuffer(data, sizeof(data));
+}
+
+/*
+ * A frame where no two neighbouring slots match.
+ */
+DmxBuffer NoiseFrame() {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>(i * 7 + 1);
+  }
+  return DmxBuffer(data, sizeof(data));
+}
+
+void RunEncode(BenchmarkState *state, const DmxBuffer &frame) {
+  RunLengthEncoder encoder;
+  uint8_t encoded[ENCODED_SIZE];
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    unsigned int size = sizeof(encoded);
+    encoder.Encode(frame, encoded, &size);
+    DoNotOptimize(encoded);
+  }
+  state->SetBytesProcessed(state->Iterations() * frame.Size());
+}
+
+void RunDecode(BenchmarkState *state, const DmxBuffer &frame) {
+  RunLengthEncoder encoder;
+  uint8_t encoded[ENCODED_SIZE];
+  unsigned int size = sizeof(encoded);
+  encoder.Encode(frame, encoded, &size);
+
+  DmxBuffer output;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    encoder.Decode(0, encoded, size, &output);
+    DoNotOptimize(output);
+  }
+  state->SetBytesProcessed(state->Iterations() * frame.Size());
+}
+
+void BenchmarkEncodeRepeating(BenchmarkState *state) {
+  RunEncode(state, RepeatingFrame());
+}
+OLA_BENCHMARK(BenchmarkEncodeRepeating);
+
+void BenchmarkEncodeNoise(BenchmarkState *state) {
+  RunEncode(state, NoiseFrame());
+}
+OLA_BENCHMARK(BenchmarkEncodeNoise);
+
+void BenchmarkDecodeRepeating(BenchmarkState *state) {
+  RunDecode(state, RepeatingFrame());
+}
+OLA_BENCHMARK(BenchmarkDecodeRepeating);
+
+void BenchmarkDecodeNoise(BenchmarkState *state) {
+  RunDecode(state, NoiseFrame());
+}
+OLA_BENCHMARK(BenchmarkDecodeNoise);
+}  // namespace
@@ -21,6 +21,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
 
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
@@ -35,12 +36,16 @@ class RunLengthEncoderTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RunLengthEncoderTest);
   CPPUNIT_TEST(testEncode);
   CPPUNIT_TEST(testEncode2);
+  CPPUNIT_TEST(testLongLiteral);
+  CPPUNIT_TEST(testRandomData);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testEncode();
     void testEncode2();
     void testEncodeDecode();
+    void testLongLiteral();
+    void testRandomData();
     void setUp();
     void tearDown();
  private:
@@ -53,9 +58,104 @@ class RunLengthEncoderTest: public CppUnit::TestFixture {
                      const uint8_t *expected_data,
                      unsigned int expected_length);
     void checkEncodeDecode(const uint8_t *data, unsigned int data_size);
+    void checkMatchesReference(const DmxBuffer &buffer, unsigned int dst_size);
 };
 
 
+namespace {
+
+/*
+ * A simple encoder that checks one byte at a time, used to check the output
+ * of RunLengthEncoder.
+ */
+bool ReferenceEncode(const DmxBuffer &src, uint8_t *data,
+                     unsigned int *data_size) {
+  const unsigned int MAX_SEGMENT = 0x7f;
+  unsigned int src_size = src.Size();
+  unsigned int dst_size = *data_size;
+  unsigned int dst_index = 0;
+  unsigned int i = 0;
+  bool complete = true;
+
+  while (i < src_size) {
+    if (dst_index >= dst_size) {
+      complete = false;
+      break;
+    }
+
+    unsigned int run = 1;
+    while (i + run < src_size && run < MAX_SEGMENT &&
+           src.Get(i + run) == src.Get(i)) {
+      run++;
+    }
+
+    if (run > 2) {
+      if (dst_size - dst_index < 2) {
+        complete = false;
+        break;
+      }
+      data[dst_index++] = 0x80 | run;
+      data[dst_index++] = src.Get(i);
+      i += run;
+      continue;
+    }
+
+    // A literal runs until the next run of 3, but a run that starts in the
+    // last two values is included in the literal.
+    unsigned int j = i + 1;
+    while (j < src_size && j - i < MAX_SEGMENT) {
+      if (j + 2 < src_size && src.Get(j) == src.Get(j + 1) &&
+          src.Get(j) == src.Get(j + 2)) {
+        break;
+      }
+      j++;
+    }
+
+    if (dst_index + j - i < dst_size) {
+      data[dst_index++] = j - i;
+      for (; i < j; i++) {
+        data[dst_index++] = src.Get(i);
+      }
+    } else {
+      if (dst_size - dst_index > 1) {
+        unsigned int length = dst_size - dst_index - 1;
+        data[dst_index++] = length;
+        for (unsigned int k = 0; k < length; k++) {
+          data[dst_index++] = src.Get(i + k);
+        }
+      }
+      complete = false;
+      break;
+    }
+  }
+  *data_size = dst_index;
+  return complete;
+}
+
+/*
+ * A deterministic pseudo random number generator, so failures can be
+ * reproduced.
+ */
+class TestRandom {
+ public:
+  TestRandom() : m_state(0x12345678) {}
+
+  unsigned int Next(unsigned int limit) {
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state % limit;
+  }
+
+ private:
+  uint32_t m_state;
+};
+
+// Long enough for the worst case encoding of a universe.
+const unsigned int ENCODED_SIZE = ola::DMX_UNIVERSE_SIZE + 8;
+}  // namespace
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(RunLengthEncoderTest);
 
 
@@ -167,3 +267,81 @@ void RunLengthEncoderTest::testEncodeDecode() {
   checkEncodeDecode(TEST_DATA2, sizeof(TEST_DATA2));
   checkEncodeDecode(TEST_DATA3, sizeof(TEST_DATA3));
 }
+
+
+/*
+ * Check that the encoder matches the reference encoder for a buffer.
+ */
+void RunLengthEncoderTest::checkMatchesReference(const DmxBuffer &buffer,
+                                                 unsigned int dst_size) {
+  uint8_t expected[ENCODED_SIZE];
+  uint8_t actual[ENCODED_SIZE];
+  unsigned int expected_size = dst_size;
+  unsigned int actual_size = dst_size;
+
+  bool expected_complete = ReferenceEncode(buffer, expected, &expected_size);
+  OLA_ASSERT_EQ(expected_complete,
+                m_encoder.Encode(buffer, actual, &actual_size));
+  OLA_ASSERT_DATA_EQUALS(expected, expected_size, actual, actual_size);
+
+  if (expected_complete) {
+    // Decode() extends the buffer, so it needs to start off empty.
+    DmxBuffer decoded;
+    decoded.Blackout();
+    decoded.Reset();
+    OLA_ASSERT_TRUE(m_encoder.Decode(0, actual, actual_size, &decoded));
+    OLA_ASSERT_TRUE(buffer == decoded);
+  }
+}
+
+
+/*
+ * Check literal segments longer than a single header can describe.
+ */
+void RunLengthEncoderTest::testLongLiteral() {
+  for (unsigned int size = 120; size < 260; size++) {
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    for (unsigned int i = 0; i < size; i++) {
+      data[i] = i % 2;
+    }
+    DmxBuffer buffer(data, size);
+    checkMatchesReference(buffer, ENCODED_SIZE);
+  }
+}
+
+
+/*
+ * Check random data, made up of runs & literals, against the reference
+ * encoder.
+ */
+void RunLengthEncoderTest::testRandomData() {
+  TestRandom random;
+  for (unsigned int iteration = 0; iteration < 2000; iteration++) {
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    unsigned int size = random.Next(ola::DMX_UNIVERSE_SIZE + 1);
+    unsigned int i = 0;
+    while (i < size) {
+      unsigned int length = std::min(1 + random.Next(200), size - i);
+      switch (random.Next(3)) {
+        case 0:
+          memset(data + i, random.Next(256), length);
+          break;
+        case 1:
+          // values from a small range give short runs
+          for (unsigned int j = 0; j < length; j++) {
+            data[i + j] = random.Next(3);
+          }
+          break;
+        default:
+          for (unsigned int j = 0; j < length; j++) {
+            data[i + j] = random.Next(256);
+          }
+      }
+      i += length;
+    }
+
+    DmxBuffer buffer(data, size);
+    checkMatchesReference(buffer, ENCODED_SIZE);
+    checkMatchesReference(buffer, random.Next(ENCODED_SIZE));
+  }
+}
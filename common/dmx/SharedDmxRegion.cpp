@@ -0,0 +1,250 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegion.cpp
+ * A shared memory region used to pass DMX data between local processes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_SHM_OPEN)
+#include <sys/mman.h>
+#define OLA_HAVE_SHARED_DMX 1
+#endif  // defined(HAVE_SYS_MMAN_H) && defined(HAVE_SHM_OPEN)
+
+#include <algorithm>
+#include <string>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+
+namespace ola {
+namespace dmx {
+
+using std::string;
+
+struct SharedDmxRegion::RegionHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+};
+
+/*
+ * The sequence number is odd while the slot is being written to.
+ */
+struct SharedDmxRegion::Slot {
+  volatile uint32_t sequence;
+  uint32_t universe;
+  uint16_t length;
+  uint8_t priority;
+  uint8_t reserved;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+};
+
+const uint32_t SharedDmxRegion::REGION_MAGIC = 0x4f4c4144;  // OLAD
+const uint32_t SharedDmxRegion::REGION_VERSION = 1;
+const unsigned int SharedDmxRegion::MAX_SLOTS;
+
+SharedDmxRegion::SharedDmxRegion(void *memory, size_t size,
+                                 unsigned int slot_count)
+    : m_memory(memory),
+      m_size(size),
+      m_slot_count(slot_count),
+      m_slots(reinterpret_cast<Slot*>(
+          reinterpret_cast<uint8_t*>(memory) + sizeof(RegionHeader))) {
+}
+
+SharedDmxRegion::~SharedDmxRegion() {
+#ifdef OLA_HAVE_SHARED_DMX
+  munmap(m_memory, m_size);
+#endif  // OLA_HAVE_SHARED_DMX
+}
+
+SharedDmxRegion *SharedDmxRegion::Create(const string &name,
+                                         unsigned int slot_count) {
+#ifdef OLA_HAVE_SHARED_DMX
+  if (slot_count == 0 || slot_count > MAX_SLOTS) {
+    OLA_WARN << "Invalid slot count for shared region: " << slot_count;
+    return NULL;
+  }
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    OLA_WARN << "shm_open(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  size_t size = RegionSize(slot_count);
+  if (ftruncate(fd, size) < 0) {
+    OLA_WARN << "ftruncate(" << name << ") failed: " << strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "mmap(" << name << ") failed: " << strerror(errno);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+
+  // ftruncate zero fills, so all the sequence numbers start at 0.
+  RegionHeader *header = reinterpret_cast<RegionHeader*>(memory);
+  header->magic = REGION_MAGIC;
+  header->version = REGION_VERSION;
+  header->slot_count = slot_count;
+  header->slot_size = sizeof(Slot);
+  return new SharedDmxRegion(memory, size, slot_count);
+#else
+  OLA_WARN << "Shared memory isn't supported, can't create " << name << " ("
+           << slot_count << " slots)";
+  return NULL;
+#endif  // OLA_HAVE_SHARED_DMX
+}
+
+SharedDmxRegion *SharedDmxRegion::Open(const string &name) {
+#ifdef OLA_HAVE_SHARED_DMX
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    OLA_WARN << "shm_open(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) < 0 ||
+      static_cast<size_t>(stat_buf.st_size) < sizeof(RegionHeader)) {
+    OLA_WARN << "Shared region " << name << " is too small";
+    close(fd);
+    return NULL;
+  }
+
+  size_t size = stat_buf.st_size;
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "mmap(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  const RegionHeader *header = reinterpret_cast<RegionHeader*>(memory);
+  if (header->magic != REGION_MAGIC || header->version != REGION_VERSION ||
+      header->slot_size != sizeof(Slot) || header->slot_count == 0 ||
+      header->slot_count > MAX_SLOTS ||
+      RegionSize(header->slot_count) > size) {
+    OLA_WARN << "Shared region " << name << " has an invalid header";
+    munmap(memory, size);
+    return NULL;
+  }
+  return new SharedDmxRegion(memory, size, header->slot_count);
+#else
+  OLA_WARN << "Shared memory isn't supported, can't open " << name;
+  return NULL;
+#endif  // OLA_HAVE_SHARED_DMX
+}
+
+void SharedDmxRegion::Unlink(const string &name) {
+#ifdef OLA_HAVE_SHARED_DMX
+  shm_unlink(name.c_str());
+#else
+  (void) name;
+#endif  // OLA_HAVE_SHARED_DMX
+}
+
+bool SharedDmxRegion::IsSupported() {
+#ifdef OLA_HAVE_SHARED_DMX
+  return true;
+#else
+  return false;
+#endif  // OLA_HAVE_SHARED_DMX
+}
+
+bool SharedDmxRegion::Write(unsigned int slot_index,
+                            unsigned int universe,
+                            uint8_t priority,
+                            const DmxBuffer &data) {
+  if (slot_index >= m_slot_count) {
+    return false;
+  }
+
+  Slot *slot = &m_slots[slot_index];
+  uint32_t sequence = slot->sequence;
+  slot->sequence = sequence + 1;
+  __sync_synchronize();
+
+  unsigned int length = std::min(data.Size(),
+                                 static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  slot->universe = universe;
+  slot->priority = priority;
+  slot->length = static_cast<uint16_t>(length);
+  memcpy(slot->data, data.GetRaw(), length);
+
+  __sync_synchronize();
+  // skip 0 when we wrap, since that means the slot has never been written.
+  sequence += 2;
+  slot->sequence = sequence ? sequence : 2;
+  return true;
+}
+
+bool SharedDmxRegion::Read(unsigned int slot_index,
+                           uint32_t *sequence,
+                           unsigned int *universe,
+                           uint8_t *priority,
+                           uint8_t *data,
+                           unsigned int *length) const {
+  if (slot_index >= m_slot_count) {
+    return false;
+  }
+
+  const Slot *slot = &m_slots[slot_index];
+  uint32_t start_sequence = slot->sequence;
+  if (start_sequence == *sequence || start_sequence & 1) {
+    return false;
+  }
+  __sync_synchronize();
+
+  *universe = slot->universe;
+  *priority = slot->priority;
+  *length = std::min(static_cast<unsigned int>(slot->length),
+                     static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  memcpy(data, slot->data, *length);
+
+  __sync_synchronize();
+  if (slot->sequence != start_sequence) {
+    // The writer updated the slot while we were reading it.
+    return false;
+  }
+  *sequence = start_sequence;
+  return true;
+}
+
+size_t SharedDmxRegion::RegionSize(unsigned int slot_count) {
+  return sizeof(RegionHeader) + slot_count * sizeof(Slot);
+}
+}  // namespace dmx
+}  // namespace ola
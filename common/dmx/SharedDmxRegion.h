@@ -0,0 +1,135 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegion.h
+ * A shared memory region used to pass DMX data between local processes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_DMX_SHAREDDMXREGION_H_
+#define COMMON_DMX_SHAREDDMXREGION_H_
+
+#include <stdint.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+
+#include <string>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A region of shared memory holding DMX data for a number of universes.
+ *
+ * The region is divided into slots, each of which holds the data for a single
+ * universe. A single process writes to the region and another process reads
+ * from it. Each slot is protected by a sequence lock, so the writer never
+ * blocks; the reader detects torn reads and discards them.
+ *
+ * The region doesn't provide any notification mechanism, the writer is
+ * expected to tell the reader when slots have changed.
+ */
+class SharedDmxRegion {
+ public:
+  ~SharedDmxRegion();
+
+  /**
+   * @brief Create a new shared region.
+   * @param name the name of the region, this should start with a /.
+   * @param slot_count the number of slots in the region.
+   * @returns a new SharedDmxRegion, or NULL if the region couldn't be
+   *   created. Ownership is transferred to the caller.
+   */
+  static SharedDmxRegion *Create(const std::string &name,
+                                 unsigned int slot_count);
+
+  /**
+   * @brief Open an existing shared region.
+   * @param name the name of the region.
+   * @returns a new SharedDmxRegion, or NULL if the region couldn't be
+   *   opened. Ownership is transferred to the caller.
+   */
+  static SharedDmxRegion *Open(const std::string &name);
+
+  /**
+   * @brief Remove the name of a shared region.
+   * @param name the name of the region.
+   *
+   * Any processes that have the region open can continue to use it.
+   */
+  static void Unlink(const std::string &name);
+
+  /**
+   * @brief Check if shared regions are supported on this platform.
+   */
+  static bool IsSupported();
+
+  /**
+   * @brief The number of slots in the region.
+   */
+  unsigned int SlotCount() const { return m_slot_count; }
+
+  /**
+   * @brief Write DMX data to a slot.
+   * @param slot the slot to write to.
+   * @param universe the universe the data is for.
+   * @param priority the priority of the data.
+   * @param data the DMX data.
+   * @returns true if the data was written, false if the slot is out of range.
+   */
+  bool Write(unsigned int slot, unsigned int universe, uint8_t priority,
+             const DmxBuffer &data);
+
+  /**
+   * @brief Read the DMX data from a slot, if it has changed.
+   * @param slot the slot to read from.
+   * @param[in,out] sequence the sequence number of the last read from this
+   *   slot. This is updated if new data is returned. Use 0 for the first read.
+   * @param[out] universe the universe the data is for.
+   * @param[out] priority the priority of the data.
+   * @param[out] data the DMX data, must be at least DMX_UNIVERSE_SIZE bytes.
+   * @param[out] length the length of the DMX data.
+   * @returns true if new data was read, false if the slot hasn't changed or
+   *   is being written to.
+   */
+  bool Read(unsigned int slot, uint32_t *sequence, unsigned int *universe,
+            uint8_t *priority, uint8_t *data, unsigned int *length) const;
+
+  /**
+   * @brief The maximum number of slots in a region.
+   */
+  static const unsigned int MAX_SLOTS = 4096;
+
+ private:
+  struct RegionHeader;
+  struct Slot;
+
+  void *m_memory;
+  size_t m_size;
+  unsigned int m_slot_count;
+  Slot *m_slots;
+
+  SharedDmxRegion(void *memory, size_t size, unsigned int slot_count);
+
+  static size_t RegionSize(unsigned int slot_count);
+
+  static const uint32_t REGION_MAGIC;
+  static const uint32_t REGION_VERSION;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxRegion);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_SHAREDDMXREGION_H_
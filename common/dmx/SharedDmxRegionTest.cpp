@@ -0,0 +1,127 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegionTest.cpp
+ * Test fixture for the SharedDmxRegion class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::SharedDmxRegion;
+using std::auto_ptr;
+using std::string;
+
+class SharedDmxRegionTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SharedDmxRegionTest);
+  CPPUNIT_TEST(testReadWrite);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp() {
+      std::ostringstream str;
+      str << "/ola-test-" << getpid();
+      m_name = str.str();
+    }
+
+    void tearDown() {
+      SharedDmxRegion::Unlink(m_name);
+    }
+
+    void testReadWrite();
+
+ private:
+    string m_name;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedDmxRegionTest);
+
+
+/*
+ * Check we can pass data through a region.
+ */
+void SharedDmxRegionTest::testReadWrite() {
+  if (!SharedDmxRegion::IsSupported()) {
+    return;
+  }
+
+  OLA_ASSERT_NULL(SharedDmxRegion::Create(m_name, 0));
+  OLA_ASSERT_NULL(SharedDmxRegion::Open(m_name));
+
+  auto_ptr<SharedDmxRegion> writer(SharedDmxRegion::Create(m_name, 2));
+  OLA_ASSERT_NOT_NULL(writer.get());
+  // creating it twice fails
+  OLA_ASSERT_NULL(SharedDmxRegion::Create(m_name, 2));
+
+  auto_ptr<SharedDmxRegion> reader(SharedDmxRegion::Open(m_name));
+  OLA_ASSERT_NOT_NULL(reader.get());
+  OLA_ASSERT_EQ(2u, reader->SlotCount());
+
+  // nothing has been written yet
+  uint32_t sequence = 0;
+  unsigned int universe;
+  uint8_t priority;
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  unsigned int length;
+  OLA_ASSERT_FALSE(reader->Read(0, &sequence, &universe, &priority, data,
+                                &length));
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  OLA_ASSERT_FALSE(writer->Write(2, 10, 100, buffer));
+  OLA_ASSERT_TRUE(writer->Write(1, 10, 100, buffer));
+
+  OLA_ASSERT_FALSE(reader->Read(0, &sequence, &universe, &priority, data,
+                                &length));
+  OLA_ASSERT_TRUE(reader->Read(1, &sequence, &universe, &priority, data,
+                               &length));
+  OLA_ASSERT_EQ(10u, universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), priority);
+  OLA_ASSERT_DATA_EQUALS(buffer.GetRaw(), buffer.Size(), data, length);
+
+  // a second read returns nothing since the data hasn't changed
+  OLA_ASSERT_FALSE(reader->Read(1, &sequence, &universe, &priority, data,
+                                &length));
+
+  buffer.SetFromString("5,6");
+  OLA_ASSERT_TRUE(writer->Write(1, 11, 120, buffer));
+  OLA_ASSERT_TRUE(reader->Read(1, &sequence, &universe, &priority, data,
+                               &length));
+  OLA_ASSERT_EQ(11u, universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), priority);
+  OLA_ASSERT_DATA_EQUALS(buffer.GetRaw(), buffer.Size(), data, length);
+
+  // the region stays valid once the name is removed
+  SharedDmxRegion::Unlink(m_name);
+  OLA_ASSERT_NULL(SharedDmxRegion::Open(m_name));
+  OLA_ASSERT_TRUE(writer->Write(0, 1, 100, buffer));
+  sequence = 0;
+  OLA_ASSERT_TRUE(reader->Read(0, &sequence, &universe, &priority, data,
+                               &length));
+  OLA_ASSERT_EQ(1u, universe);
+}
@@ -34,9 +34,196 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
+string BaseVariable::MetricName(const string &name) {
+  string metric_name = name;
+  string::iterator iter = metric_name.begin();
+  for (; iter != metric_name.end(); ++iter) {
+    const char c = *iter;
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9') || c == '_' || c == ':')) {
+      *iter = '_';
+    }
+  }
+  if (metric_name.empty() ||
+      (metric_name[0] >= '0' && metric_name[0] <= '9')) {
+    metric_name.insert(0, "_");
+  }
+  return metric_name;
+}
+
+string BaseVariable::MetricLabelValue(const string &value) {
+  string escaped;
+  escaped.reserve(value.size());
+  string::const_iterator iter = value.begin();
+  for (; iter != value.end(); ++iter) {
+    switch (*iter) {
+      case '\\':
+        escaped.append("\\\\");
+        break;
+      case '"':
+        escaped.append("\\\"");
+        break;
+      case '\n':
+        escaped.append("\\n");
+        break;
+      default:
+        escaped.push_back(*iter);
+    }
+  }
+  return escaped;
+}
+
+void BaseVariable::WriteSingleMetric(std::ostream *output, const char *type,
+                                     const char *suffix,
+                                     const string &value) const {
+  const string name = MetricName(Name());
+  *output << "# TYPE " << name << " " << type << "\n"
+          << name << suffix << " " << value << "\n";
+}
+
+
+HistogramVariable::HistogramVariable(const string &name,
+                                     const vector<uint64_t> &bounds)
+    : BaseVariable(name),
+      m_bounds(bounds),
+      m_count(0),
+      m_sum(0) {
+  std::sort(m_bounds.begin(), m_bounds.end());
+  m_bounds.erase(std::unique(m_bounds.begin(), m_bounds.end()),
+                 m_bounds.end());
+  m_buckets.resize(m_bounds.size() + 1, 0);
+}
+
+void HistogramVariable::Observe(uint64_t value) {
+  const size_t bucket = std::lower_bound(m_bounds.begin(), m_bounds.end(),
+                                         value) - m_bounds.begin();
+  __atomic_fetch_add(&m_buckets[bucket], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&m_sum, value, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&m_count, 1, __ATOMIC_RELAXED);
+}
+
+void HistogramVariable::Reset() {
+  for (unsigned int i = 0; i < m_buckets.size(); i++) {
+    __atomic_store_n(&m_buckets[i], 0, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&m_sum, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&m_count, 0, __ATOMIC_RELAXED);
+}
+
+uint64_t HistogramVariable::Count() const {
+  return __atomic_load_n(&m_count, __ATOMIC_RELAXED);
+}
+
+uint64_t HistogramVariable::Sum() const {
+  return __atomic_load_n(&m_sum, __ATOMIC_RELAXED);
+}
+
+uint64_t HistogramVariable::BucketCount(unsigned int bucket) const {
+  if (bucket >= m_buckets.size()) {
+    return 0;
+  }
+  return __atomic_load_n(&m_buckets[bucket], __ATOMIC_RELAXED);
+}
+
+const string HistogramVariable::Value() const {
+  // The buckets are read one at a time, so in the presence of concurrent
+  // updates the total may not match the count exactly.
+  ostringstream out;
+  out << "count:" << Count() << " sum:" << Sum();
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < m_bounds.size(); i++) {
+    total += BucketCount(i);
+    out << " le_" << m_bounds[i] << ":" << total;
+  }
+  total += BucketCount(m_bounds.size());
+  out << " le_inf:" << total;
+  return out.str();
+}
+
+void HistogramVariable::WriteMetrics(std::ostream *output) const {
+  const string name = MetricName(Name());
+  *output << "# TYPE " << name << " histogram\n";
+  WriteSamples(output, name, "");
+}
+
+void HistogramVariable::WriteSamples(std::ostream *output, const string &name,
+                                     const string &labels) const {
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < m_bounds.size(); i++) {
+    total += BucketCount(i);
+    *output << name << "_bucket{" << labels << "le=\"" << m_bounds[i]
+            << "\"} " << total << "\n";
+  }
+  total += BucketCount(m_bounds.size());
+
+  // Strip the trailing comma for the _sum and _count samples.
+  string sample_labels;
+  if (!labels.empty()) {
+    sample_labels = "{" + labels.substr(0, labels.size() - 1) + "}";
+  }
+  // Use the bucket total for the count, so the +Inf bucket always matches.
+  *output << name << "_bucket{" << labels << "le=\"+Inf\"} " << total << "\n"
+          << name << "_sum" << sample_labels << " " << Sum() << "\n"
+          << name << "_count" << sample_labels << " " << total << "\n";
+}
+
+
+HistogramMap::~HistogramMap() {
+  STLDeleteValues(&m_variables);
+}
+
+HistogramVariable *HistogramMap::Get(const string &key) {
+  HistogramVariable *var = STLFindOrNull(m_variables, key);
+  if (!var) {
+    var = new HistogramVariable(Name(), m_bounds);
+    m_variables[key] = var;
+  }
+  return var;
+}
+
+void HistogramMap::Remove(const string &key) {
+  STLRemoveAndDelete(&m_variables, key);
+}
+
+void HistogramMap::Keys(vector<string> *keys) const {
+  STLKeys(m_variables, keys);
+}
+
+const HistogramVariable *HistogramMap::Find(const string &key) const {
+  return STLFindOrNull(m_variables, key);
+}
+
+/*
+ * The form is:
+ *   var_name  map:label_name key1:"histogram value" key2:"histogram value"
+ */
+const string HistogramMap::Value() const {
+  ostringstream value;
+  value << "map:" << m_label;
+  HistogramVariables::const_iterator iter = m_variables.begin();
+  for (; iter != m_variables.end(); ++iter) {
+    value << " " << iter->first << ":\"" << iter->second->Value() << "\"";
+  }
+  return value.str();
+}
+
+void HistogramMap::WriteMetrics(std::ostream *output) const {
+  const string name = MetricName(Name());
+  const string label = m_label.empty() ? "key" : MetricName(m_label);
+  *output << "# TYPE " << name << " histogram\n";
+  HistogramVariables::const_iterator iter = m_variables.begin();
+  for (; iter != m_variables.end(); ++iter) {
+    iter->second->WriteSamples(
+        output, name, label + "=\"" + MetricLabelValue(iter->first) + "\",");
+  }
+}
+
+
 ExportMap::~ExportMap() {
   STLDeleteValues(&m_bool_variables);
   STLDeleteValues(&m_counter_variables);
+  STLDeleteValues(&m_histogram_map_variables);
+  STLDeleteValues(&m_histogram_variables);
   STLDeleteValues(&m_int_map_variables);
   STLDeleteValues(&m_int_variables);
   STLDeleteValues(&m_str_map_variables);
@@ -94,6 +281,56 @@ UIntMap *ExportMap::GetUIntMapVar(const string &name, const string &label) {
 }
 
 
+/*
+ * Lookup or create a histogram variable
+ * @param name the name of the variable
+ * @param bounds the upper bounds of the buckets
+ * @return a HistogramVariable
+ */
+HistogramVariable *ExportMap::GetHistogramVar(const string &name,
+                                              const vector<uint64_t> &bounds) {
+  HistogramVariable *var = STLFindOrNull(m_histogram_variables, name);
+  if (!var) {
+    var = new HistogramVariable(name, bounds);
+    m_histogram_variables[name] = var;
+  }
+  return var;
+}
+
+
+/*
+ * Lookup or create a histogram map variable
+ * @param name the name of the variable
+ * @param label the label to use for the map
+ * @param bounds the upper bounds of the buckets
+ * @return a HistogramMap
+ */
+HistogramMap *ExportMap::GetHistogramMapVar(const string &name,
+                                            const string &label,
+                                            const vector<uint64_t> &bounds) {
+  HistogramMap *var = STLFindOrNull(m_histogram_map_variables, name);
+  if (!var) {
+    var = new HistogramMap(name, label, bounds);
+    m_histogram_map_variables[name] = var;
+  }
+  return var;
+}
+
+
+/*
+ * Write all variables in the OpenMetrics text format, followed by the
+ * terminating EOF line.
+ */
+void ExportMap::WriteMetrics(std::ostream *output) const {
+  vector<BaseVariable*> variables = AllVariables();
+  vector<BaseVariable*>::const_iterator iter = variables.begin();
+  for (; iter != variables.end(); ++iter) {
+    (*iter)->WriteMetrics(output);
+  }
+  *output << "# EOF\n";
+}
+
+
 /*
  * Return a list of all variables.
  * @return a vector of all variables.
@@ -102,6 +339,8 @@ vector<BaseVariable*> ExportMap::AllVariables() const {
   vector<BaseVariable*> variables;
   STLValues(m_bool_variables, &variables);
   STLValues(m_counter_variables, &variables);
+  STLValues(m_histogram_map_variables, &variables);
+  STLValues(m_histogram_variables, &variables);
   STLValues(m_int_map_variables, &variables);
   STLValues(m_int_variables, &variables);
   STLValues(m_str_map_variables, &variables);
@@ -19,6 +19,8 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -29,10 +31,13 @@ using ola::BaseVariable;
 using ola::BoolVariable;
 using ola::CounterVariable;
 using ola::ExportMap;
+using ola::HistogramVariable;
 using ola::IntMap;
 using ola::IntegerVariable;
 using ola::StringMap;
 using ola::StringVariable;
+using ola::UIntMap;
+using std::ostringstream;
 using std::string;
 using std::vector;
 
@@ -45,7 +50,9 @@ class ExportMapTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testBoolVariable);
   CPPUNIT_TEST(testStringMapVariable);
   CPPUNIT_TEST(testIntMapVariable);
+  CPPUNIT_TEST(testHistogramVariable);
   CPPUNIT_TEST(testExportMap);
+  CPPUNIT_TEST(testWriteMetrics);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -55,7 +62,9 @@ class ExportMapTest: public CppUnit::TestFixture {
     void testBoolVariable();
     void testStringMapVariable();
     void testIntMapVariable();
+    void testHistogramVariable();
     void testExportMap();
+    void testWriteMetrics();
 };
 
 
@@ -241,3 +250,87 @@ void ExportMapTest::testExportMap() {
   vector<BaseVariable*> variables = map.AllVariables();
   OLA_ASSERT_EQ(variables.size(), (size_t) 4);
 }
+
+
+/*
+ * Check that the HistogramVariable works correctly.
+ */
+void ExportMapTest::testHistogramVariable() {
+  vector<uint64_t> bounds;
+  bounds.push_back(100);
+  bounds.push_back(10);
+  bounds.push_back(1000);
+  HistogramVariable var("foo", bounds);
+
+  // The bounds are sorted.
+  OLA_ASSERT_EQ((size_t) 3, var.Bounds().size());
+  OLA_ASSERT_EQ((uint64_t) 10, var.Bounds()[0]);
+  OLA_ASSERT_EQ((uint64_t) 1000, var.Bounds()[2]);
+  OLA_ASSERT_EQ((uint64_t) 0, var.Count());
+  OLA_ASSERT_EQ(string("count:0 sum:0 le_10:0 le_100:0 le_1000:0 le_inf:0"),
+                var.Value());
+
+  var.Observe(5);
+  var.Observe(10);
+  var.Observe(11);
+  var.Observe(5000);
+  OLA_ASSERT_EQ((uint64_t) 4, var.Count());
+  OLA_ASSERT_EQ((uint64_t) 5026, var.Sum());
+  OLA_ASSERT_EQ((uint64_t) 2, var.BucketCount(0));
+  OLA_ASSERT_EQ((uint64_t) 1, var.BucketCount(1));
+  OLA_ASSERT_EQ((uint64_t) 0, var.BucketCount(2));
+  OLA_ASSERT_EQ((uint64_t) 1, var.BucketCount(3));
+  OLA_ASSERT_EQ((uint64_t) 0, var.BucketCount(4));
+  OLA_ASSERT_EQ(
+      string("count:4 sum:5026 le_10:2 le_100:3 le_1000:3 le_inf:4"),
+      var.Value());
+
+  var.Reset();
+  OLA_ASSERT_EQ((uint64_t) 0, var.Count());
+  OLA_ASSERT_EQ((uint64_t) 0, var.Sum());
+  OLA_ASSERT_EQ((uint64_t) 0, var.BucketCount(0));
+}
+
+
+/*
+ * Check the OpenMetrics output.
+ */
+void ExportMapTest::testWriteMetrics() {
+  ExportMap map;
+  map.GetBoolVar("bool-var")->Set(true);
+  (*map.GetCounterVar("frames"))++;
+  map.GetIntegerVar("1int")->Set(-4);
+  map.GetStringVar("str-var")->Set("not a number");
+  map.GetStringMapVar("str-map", "universe")->Set("1", "foo");
+  UIntMap *uint_map = map.GetUIntMapVar("universe-fps", "universe");
+  uint_map->Set("1", 40);
+  uint_map->Set("a\"b", 2);
+
+  vector<uint64_t> bounds;
+  bounds.push_back(1);
+  HistogramVariable *histogram = map.GetHistogramVar("latency", bounds);
+  histogram->Observe(1);
+  histogram->Observe(3);
+  // The existing variable is returned, the bounds are ignored.
+  OLA_ASSERT_EQ(histogram, map.GetHistogramVar("latency", vector<uint64_t>()));
+
+  ostringstream str;
+  map.WriteMetrics(&str);
+  OLA_ASSERT_EQ(string(
+      "# TYPE _1int gauge\n"
+      "_1int -4\n"
+      "# TYPE bool_var gauge\n"
+      "bool_var 1\n"
+      "# TYPE frames counter\n"
+      "frames_total 1\n"
+      "# TYPE latency histogram\n"
+      "latency_bucket{le=\"1\"} 1\n"
+      "latency_bucket{le=\"+Inf\"} 2\n"
+      "latency_sum 4\n"
+      "latency_count 2\n"
+      "# TYPE universe_fps gauge\n"
+      "universe_fps{universe=\"1\"} 40\n"
+      "universe_fps{universe=\"a\\\"b\"} 2\n"
+      "# EOF\n"),
+      str.str());
+}
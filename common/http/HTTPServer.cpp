@@ -24,10 +24,13 @@
 
 #include <stdio.h>
 #include <ola/Logging.h>
+#include <ola/StringUtils.h>
 #include <ola/base/Macro.h>
 #include <ola/file/Util.h>
 #include <ola/http/HTTPServer.h>
+#include <ola/http/WebSocket.h>
 #include <ola/io/Descriptor.h>
+#include <ola/stl/STLUtils.h>
 #include <ola/web/Json.h>
 #include <ola/web/JsonWriter.h>
 
@@ -35,10 +38,12 @@
 #include <ola/win/CleanWinSock2.h>
 #endif  // _WIN32
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -67,6 +72,7 @@ using std::pair;
 using std::set;
 using std::string;
 using std::vector;
+using ola::io::IOQueue;
 using ola::io::UnmanagedFileDescriptor;
 using ola::web::JsonValue;
 using ola::web::JsonWriter;
@@ -81,6 +87,131 @@ const char HTTPServer::CONTENT_TYPE_JS[] = "text/javascript";
 const char HTTPServer::CONTENT_TYPE_OCT[] = "application/octet-stream";
 const char HTTPServer::CONTENT_TYPE_JSON[] = "application/json";
 const char HTTPServer::CONTENT_TYPE_XML[] = "application/xml";
+const char HTTPServer::CONTENT_TYPE_OPENMETRICS[] =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+// The headers used in the WebSocket opening handshake.
+static const char K_UPGRADE_HEADER[] = "Upgrade";
+static const char K_WEBSOCKET_ACCEPT_HEADER[] = "Sec-WebSocket-Accept";
+static const char K_WEBSOCKET_KEY_HEADER[] = "Sec-WebSocket-Key";
+static const char K_WEBSOCKET_VERSION_HEADER[] = "Sec-WebSocket-Version";
+
+// The headers used for caching & compression.
+static const char K_ACCEPT_ENCODING_HEADER[] = "Accept-Encoding";
+static const char K_CONTENT_ENCODING_HEADER[] = "Content-Encoding";
+static const char K_ETAG_HEADER[] = "ETag";
+static const char K_IF_NONE_MATCH_HEADER[] = "If-None-Match";
+static const char K_VARY_HEADER[] = "Vary";
+// Static files can be cached, but must be revalidated with the ETag since the
+// file names don't change between releases.
+static const char K_STATIC_CACHE_CONTROL[] = "no-cache";
+static const unsigned int K_HTTP_NOT_MODIFIED = 304;
+
+static const uint64_t K_FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static const uint64_t K_FNV_PRIME = 0x100000001b3ULL;
+
+/**
+ * @brief Read the contents of a file.
+ */
+static bool ReadFile(const string &path, string *data) {
+  ifstream i_stream(path.c_str(), ifstream::binary);
+  if (!i_stream.is_open()) {
+    return false;
+  }
+  std::ostringstream contents;
+  contents << i_stream.rdbuf();
+  *data = contents.str();
+  return true;
+}
+
+/**
+ * @brief Update a 64 bit FNV-1a hash.
+ */
+static uint64_t UpdateHash(uint64_t hash, const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= K_FNV_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * @brief Build a strong ETag from the hash & length of the content.
+ */
+static string FormatETag(uint64_t hash, size_t length) {
+  std::ostringstream str;
+  str << "\"" << std::hex << hash << "-" << length << "\"";
+  return str.str();
+}
+
+static string ContentETag(const string &data) {
+  return FormatETag(
+      UpdateHash(K_FNV_OFFSET_BASIS,
+                 reinterpret_cast<const uint8_t*>(data.data()), data.size()),
+      data.size());
+}
+
+static string ContentETag(const IOQueue &data) {
+  int io_count;
+  const struct ola::io::IOVec *iov = data.AsIOVec(&io_count);
+  uint64_t hash = K_FNV_OFFSET_BASIS;
+  for (int i = 0; i < io_count; i++) {
+    hash = UpdateHash(hash, static_cast<const uint8_t*>(iov[i].iov_base),
+                      iov[i].iov_len);
+  }
+  IOQueue::FreeIOVec(iov);
+  return FormatETag(hash, data.Size());
+}
+
+/**
+ * @brief Check if the value of an If-None-Match header matches an ETag.
+ */
+static bool ETagMatches(const string &header, const string &etag) {
+  vector<string> tags;
+  StringSplit(header, &tags, ",");
+  vector<string>::iterator iter = tags.begin();
+  for (; iter != tags.end(); ++iter) {
+    StringTrim(&(*iter));
+    // If-None-Match uses the weak comparison
+    if (StringBeginsWith(*iter, "W/")) {
+      iter->erase(0, 2);
+    }
+    if (*iter == "*" || *iter == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Check if the client will accept a gzip encoded response.
+ */
+static bool AcceptsGzip(const string &header) {
+  vector<string> encodings;
+  StringSplit(header, &encodings, ",");
+  vector<string>::iterator iter = encodings.begin();
+  for (; iter != encodings.end(); ++iter) {
+    StringTrim(&(*iter));
+    ToLower(&(*iter));
+    if (*iter == "gzip") {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Build a response from data which outlives the response.
+ */
+static struct MHD_Response *BuildPersistentResponse(const string &data) {
+  void *ptr = static_cast<void*>(const_cast<char*>(data.data()));
+#ifdef HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
+  return MHD_create_response_from_buffer(data.size(), ptr,
+                                         MHD_RESPMEM_PERSISTENT);
+#else
+  return MHD_create_response_from_data(data.size(), ptr, MHD_NO, MHD_NO);
+#endif  // HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
+}
 
 /**
  * @brief Called by MHD_get_connection_values to add headers to a request
@@ -160,6 +291,10 @@ static int HandleRequest(void *http_server_ptr,
   request = static_cast<HTTPRequest*>(*ptr);
 
   if (request->InFlight()) {
+    // A deferred request is only called again once it's been resumed.
+    if (request->Deferred()) {
+      return request->QueueResponse();
+    }
     // don't dispatch more than once
     return MHD_YES;
   }
@@ -171,7 +306,9 @@ static int HandleRequest(void *http_server_ptr,
 
   } else if (request->Method() == MHD_HTTP_METHOD_POST) {
     if (*upload_data_size != 0) {
-      request->ProcessPostData(upload_data, upload_data_size);
+      if (!request->ProcessPostData(upload_data, upload_data_size)) {
+        return MHD_NO;
+      }
       *upload_data_size = 0;
       return MHD_YES;
     }
@@ -201,6 +338,122 @@ void RequestCompleted(void*,
 }
 
 
+/**
+ * @brief Called by microhttpd to fetch the next chunk of a streamed response.
+ *
+ * The data is read sequentially so we can ignore the position.
+ */
+ssize_t ReadFromQueue(void *queue_ptr, uint64_t, char *buffer, size_t max) {
+  IOQueue *queue = static_cast<IOQueue*>(queue_ptr);
+  if (queue->Empty()) {
+    return MHD_CONTENT_READER_END_OF_STREAM;
+  }
+  return queue->Read(reinterpret_cast<uint8_t*>(buffer),
+                     static_cast<unsigned int>(max));
+}
+
+
+/**
+ * @brief Called when a streamed response is destroyed.
+ */
+void FreeQueue(void *queue_ptr) {
+  delete static_cast<IOQueue*>(queue_ptr);
+}
+
+
+/**
+ * @brief The handler for a WebSocket path.
+ */
+struct WebSocketHandler {
+  HTTPServer *server;
+  HTTPServer::WebSocketCallback *callback;
+};
+
+
+#ifdef HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+/**
+ * @brief A connection that has been upgraded from HTTP.
+ *
+ * microhttpd owns the socket, so rather than closing it ourselves we tell
+ * microhttpd we're done with it.
+ */
+class UpgradedSocket : public ola::io::ConnectedDescriptor {
+ public:
+  UpgradedSocket(MHD_socket fd, struct MHD_UpgradeResponseHandle *handle)
+      : m_upgrade_handle(handle) {
+#ifdef _WIN32
+    m_handle.m_handle.m_fd = fd;
+    m_handle.m_type = ola::io::SOCKET_DESCRIPTOR;
+#else
+    m_handle = fd;
+#endif  // _WIN32
+    SetNonBlocking(m_handle);
+  }
+
+  ~UpgradedSocket() { Close(); }
+
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_handle; }
+  ola::io::DescriptorHandle WriteDescriptor() const { return m_handle; }
+
+  bool Close() {
+    if (!m_upgrade_handle) {
+      return false;
+    }
+    MHD_upgrade_action(m_upgrade_handle, MHD_UPGRADE_ACTION_CLOSE);
+    m_upgrade_handle = NULL;
+    m_handle = ola::io::INVALID_DESCRIPTOR;
+    return true;
+  }
+
+ protected:
+  bool IsSocket() const { return true; }
+
+ private:
+  ola::io::DescriptorHandle m_handle;
+  struct MHD_UpgradeResponseHandle *m_upgrade_handle;
+
+  DISALLOW_COPY_AND_ASSIGN(UpgradedSocket);
+};
+
+
+/**
+ * @brief Wrap an upgraded connection in a WebSocket and pass it to the
+ * handler.
+ */
+void StartWebSocket(WebSocketHandler *handler,
+                    UpgradedSocket *socket,
+                    const string initial_data) {
+  WebSocket *websocket = new WebSocket(handler->server->SelectServer(),
+                                       socket, initial_data);
+  handler->callback->Run(websocket);
+}
+
+
+/**
+ * @brief Called by microhttpd once the 101 response has been sent.
+ */
+void UpgradeToWebSocket(void *handler_ptr,
+                        struct MHD_Connection*,
+                        void*,
+                        const char *extra_in,
+                        size_t extra_in_size,
+                        MHD_socket sock,
+                        struct MHD_UpgradeResponseHandle *urh) {
+  WebSocketHandler *handler = static_cast<WebSocketHandler*>(handler_ptr);
+  UpgradedSocket *socket = new UpgradedSocket(sock, urh);
+  const string initial_data(extra_in, extra_in_size);
+  if (handler->server->ThreadPooled()) {
+    // We're on one of microhttpd's threads, the WebSocket belongs to the
+    // SelectServer thread.
+    handler->server->SelectServer()->Execute(
+        NewSingleCallback(&StartWebSocket, handler, socket, initial_data));
+  } else {
+    StartWebSocket(handler, socket, initial_data);
+  }
+}
+#endif  // HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+
+
 /*
  * @brief HTTPRequest object
  *
@@ -215,7 +468,11 @@ HTTPRequest::HTTPRequest(const string &url,
   m_version(version),
   m_connection(connection),
   m_processor(NULL),
-  m_in_flight(false) {
+  m_raw_body(false),
+  m_response(NULL),
+  m_response_status(MHD_HTTP_OK),
+  m_in_flight(false),
+  m_deferred(false) {
 }
 
 
@@ -227,6 +484,13 @@ bool HTTPRequest::Init() {
   MHD_get_connection_values(m_connection, MHD_HEADER_KIND, AddHeaders, this);
 
   if (m_method == MHD_HTTP_METHOD_POST) {
+    const char *content_type = MHD_lookup_connection_value(
+        m_connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_CONTENT_TYPE);
+    if (content_type &&
+        StringBeginsWith(content_type, HTTPServer::CONTENT_TYPE_OCT)) {
+      m_raw_body = true;
+      return true;
+    }
     m_processor = MHD_create_post_processor(m_connection,
                                             K_POST_BUFFER_SIZE,
                                             IteratePost,
@@ -244,6 +508,39 @@ HTTPRequest::~HTTPRequest() {
   if (m_processor) {
     MHD_destroy_post_processor(m_processor);
   }
+  if (m_response) {
+    MHD_destroy_response(m_response);
+  }
+}
+
+
+/**
+ * @brief Store the response for a deferred request.
+ * @param status_code the HTTP status code.
+ * @param response the MHD_Response, ownership is transferred.
+ */
+void HTTPRequest::SetResponse(unsigned int status_code,
+                              struct MHD_Response *response) {
+  if (m_response) {
+    MHD_destroy_response(m_response);
+  }
+  m_response_status = status_code;
+  m_response = response;
+}
+
+
+/**
+ * @brief Queue the response for a deferred request.
+ * @returns MHD_NO if there was no response, which closes the connection.
+ */
+int HTTPRequest::QueueResponse() {
+  if (!m_response) {
+    return MHD_NO;
+  }
+  int ret = MHD_queue_response(m_connection, m_response_status, m_response);
+  MHD_destroy_response(m_response);
+  m_response = NULL;
+  return ret;
 }
 
 
@@ -279,9 +576,19 @@ void HTTPRequest::AddPostParameter(const string &key, const string &value) {
 
 /**
  * @brief Process post data
+ * @returns false if the body is too large.
  */
-void HTTPRequest::ProcessPostData(const char *data, size_t *data_size) {
-  MHD_post_process(m_processor, data, *data_size);
+bool HTTPRequest::ProcessPostData(const char *data, size_t *data_size) {
+  if (!m_raw_body) {
+    MHD_post_process(m_processor, data, *data_size);
+    return true;
+  }
+  if (m_body.size() + *data_size > K_MAX_BODY_SIZE) {
+    OLA_WARN << "Request body for " << m_url << " is too large";
+    return false;
+  }
+  m_body.append(data, *data_size);
+  return true;
 }
 
 
@@ -392,18 +699,12 @@ void HTTPResponse::SetHeader(const string &key, const string &value) {
  */
 int HTTPResponse::SendJson(const JsonValue &json) {
   const string output = JsonWriter::AsString(json);
-  struct MHD_Response *response = HTTPServer::BuildResponse(
-      static_cast<void*>(const_cast<char*>(output.data())),
-      output.length());
-  HeadersMultiMap::const_iterator iter;
-  for (iter = m_headers.begin(); iter != m_headers.end(); ++iter) {
-    MHD_add_response_header(response,
-                            iter->first.c_str(),
-                            iter->second.c_str());
+  if (m_content_etag) {
+    m_etag = ContentETag(output);
   }
-  int ret = MHD_queue_response(m_connection, m_status_code, response);
-  MHD_destroy_response(response);
-  return ret;
+  return SendResponse(HTTPServer::BuildResponse(
+      static_cast<void*>(const_cast<char*>(output.data())),
+      output.length()));
 }
 
 
@@ -412,21 +713,85 @@ int HTTPResponse::SendJson(const JsonValue &json) {
  * @return true on success, false on error
  */
 int HTTPResponse::Send() {
-  HeadersMultiMap::const_iterator iter;
-  struct MHD_Response *response = HTTPServer::BuildResponse(
+  if (m_content_etag) {
+    m_etag = ContentETag(m_data);
+  }
+  return SendResponse(HTTPServer::BuildResponse(
       static_cast<void*>(const_cast<char*>(m_data.data())),
-      m_data.length());
+      m_data.length()));
+}
+
+
+/**
+ * @brief Send the contents of an IOQueue as the HTTP response.
+ *
+ * The MemoryBlocks are handed to microhttpd as it writes to the socket,
+ * which avoids copying the body into a single buffer first.
+ * @param data the IOQueue with the body, ownership is transferred.
+ * @return true on success, false on error
+ */
+int HTTPResponse::Send(IOQueue *data) {
+  if (m_content_etag) {
+    m_etag = ContentETag(*data);
+  }
+  return SendResponse(MHD_create_response_from_callback(
+      data->Size(), K_RESPONSE_BLOCK_SIZE, &ReadFromQueue, data,
+      &FreeQueue));
+}
+
+
+/**
+ * @brief Add the headers to a MHD_Response and queue it.
+ * @param response the MHD_Response to send, ownership is transferred.
+ * @return true on success, false on error
+ */
+int HTTPResponse::SendResponse(struct MHD_Response *response) {
+  if (!response) {
+    return MHD_NO;
+  }
+  if (!m_etag.empty()) {
+    SetHeader(K_ETAG_HEADER, m_etag);
+    if (NotModified()) {
+      // Drop the body, the client already has it.
+      MHD_destroy_response(response);
+      response = HTTPServer::BuildResponse(NULL, 0);
+      m_status_code = K_HTTP_NOT_MODIFIED;
+    }
+  }
+  HeadersMultiMap::const_iterator iter;
   for (iter = m_headers.begin(); iter != m_headers.end(); ++iter) {
     MHD_add_response_header(response,
                             iter->first.c_str(),
                             iter->second.c_str());
   }
+#ifdef HAVE_MHD_RESUME_CONNECTION
+  if (m_deferred_request) {
+    // The response is queued by the microhttpd thread once it resumes the
+    // connection.
+    m_deferred_request->SetResponse(m_status_code, response);
+    MHD_resume_connection(m_connection);
+    return MHD_YES;
+  }
+#endif  // HAVE_MHD_RESUME_CONNECTION
   int ret = MHD_queue_response(m_connection, m_status_code, response);
   MHD_destroy_response(response);
   return ret;
 }
 
 
+/**
+ * @brief Check if the client sent If-None-Match with our ETag.
+ */
+bool HTTPResponse::NotModified() const {
+  if (m_status_code != MHD_HTTP_OK) {
+    return false;
+  }
+  const char *header = MHD_lookup_connection_value(
+      m_connection, MHD_HEADER_KIND, K_IF_NONE_MATCH_HEADER);
+  return header && ETagMatches(header, m_etag);
+}
+
+
 /**
  * @brief Setup the HTTP server.
  * @param options the configuration options for the server
@@ -436,7 +801,17 @@ HTTPServer::HTTPServer(const HTTPServerOptions &options)
       m_httpd(NULL),
       m_default_handler(NULL),
       m_port(options.port),
-      m_data_dir(options.data_dir) {
+      m_data_dir(options.data_dir),
+      m_thread_pool_size(options.thread_pool_size),
+      m_connection_limit(options.connection_limit),
+      m_connection_timeout(options.connection_timeout) {
+#ifndef HAVE_MHD_RESUME_CONNECTION
+  if (m_thread_pool_size) {
+    OLA_WARN << "This version of libmicrohttpd can't suspend connections, "
+             << "not using a thread pool";
+    m_thread_pool_size = 0;
+  }
+#endif  // HAVE_MHD_RESUME_CONNECTION
   ola::io::SelectServer::Options ss_options;
   // See issue #761. epoll/kqueue can't be used with the current
   // implementation.
@@ -460,12 +835,20 @@ HTTPServer::~HTTPServer() {
     delete iter->second;
   }
 
+  map<string, WebSocketHandler*>::const_iterator ws_iter;
+  for (ws_iter = m_websocket_handlers.begin();
+       ws_iter != m_websocket_handlers.end(); ++ws_iter) {
+    delete ws_iter->second->callback;
+    delete ws_iter->second;
+  }
+
   if (m_default_handler) {
     delete m_default_handler;
     m_default_handler = NULL;
   }
 
   m_handlers.clear();
+  m_websocket_handlers.clear();
 }
 
 
@@ -479,7 +862,40 @@ bool HTTPServer::Init() {
     return false;
   }
 
-  m_httpd = MHD_start_daemon(MHD_NO_FLAG,
+#ifdef HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+  unsigned int flags = MHD_ALLOW_UPGRADE;
+#else
+  unsigned int flags = MHD_NO_FLAG;
+#endif  // HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+
+  LoadStaticContent();
+
+  vector<struct MHD_OptionItem> options;
+  if (m_connection_limit) {
+    struct MHD_OptionItem option = {
+      MHD_OPTION_CONNECTION_LIMIT, static_cast<intptr_t>(m_connection_limit),
+      NULL};
+    options.push_back(option);
+  }
+  if (m_connection_timeout) {
+    struct MHD_OptionItem option = {
+      MHD_OPTION_CONNECTION_TIMEOUT,
+      static_cast<intptr_t>(m_connection_timeout), NULL};
+    options.push_back(option);
+  }
+#ifdef HAVE_MHD_RESUME_CONNECTION
+  if (ThreadPooled()) {
+    flags |= MHD_USE_SELECT_INTERNALLY | MHD_USE_SUSPEND_RESUME;
+    struct MHD_OptionItem option = {
+      MHD_OPTION_THREAD_POOL_SIZE, static_cast<intptr_t>(m_thread_pool_size),
+      NULL};
+    options.push_back(option);
+  }
+#endif  // HAVE_MHD_RESUME_CONNECTION
+  struct MHD_OptionItem end = {MHD_OPTION_END, 0, NULL};
+  options.push_back(end);
+
+  m_httpd = MHD_start_daemon(flags,
                              m_port,
                              NULL,
                              NULL,
@@ -488,9 +904,12 @@ bool HTTPServer::Init() {
                              MHD_OPTION_NOTIFY_COMPLETED,
                              RequestCompleted,
                              NULL,
+                             MHD_OPTION_ARRAY,
+                             &options[0],
                              MHD_OPTION_END);
 
-  if (m_httpd) {
+  // With a thread pool microhttpd polls the sockets itself.
+  if (m_httpd && !ThreadPooled()) {
     m_select_server->RunInLoop(NewCallback(this, &HTTPServer::UpdateSockets));
   }
 
@@ -508,14 +927,22 @@ void *HTTPServer::Run() {
   }
 
   OLA_INFO << "HTTP Server started on port " << m_port;
+  if (ThreadPooled()) {
+    OLA_INFO << "Using " << m_thread_pool_size << " HTTP threads";
+  }
 
 #ifdef _WIN32
   // set a short poll interval since we'd block too long otherwise.
   // TODO(Lukas) investigate why the poller does not wake up on HTTP requests.
   m_select_server->SetDefaultInterval(TimeInterval(1, 0));
 #else
-  // set a long poll interval so we don't spin
-  m_select_server->SetDefaultInterval(TimeInterval(60, 0));
+  // set a long poll interval so we don't spin, but wake up often enough for
+  // microhttpd to time out idle connections.
+  unsigned int interval = K_POLL_INTERVAL;
+  if (m_connection_timeout && !ThreadPooled()) {
+    interval = std::min(interval, m_connection_timeout);
+  }
+  m_select_server->SetDefaultInterval(TimeInterval(interval, 0));
 #endif  // _WIN32
   m_select_server->Run();
 
@@ -623,15 +1050,69 @@ void HTTPServer::UpdateSockets() {
 }
 
 
+/**
+ * @brief Run a handler on the SelectServer thread.
+ *
+ * This is called from one of microhttpd's threads. The connection is
+ * suspended until the handler sends the response.
+ */
+int HTTPServer::DeferRequest(BaseHTTPCallback *handler,
+                             HTTPRequest *request,
+                             HTTPResponse *response) {
+#ifdef HAVE_MHD_RESUME_CONNECTION
+  request->SetDeferred();
+  response->DeferTo(request);
+  MHD_suspend_connection(request->Connection());
+  m_select_server->Execute(
+      NewSingleCallback(this, &HTTPServer::RunDeferredHandler, handler,
+                        request, response));
+  return MHD_YES;
+#else
+  // We never use a thread pool in this case.
+  return handler->Run(request, response);
+#endif  // HAVE_MHD_RESUME_CONNECTION
+}
+
+
+/**
+ * @brief Run a deferred handler.
+ *
+ * If the handler fails without sending a response, the connection is
+ * resumed so microhttpd can close it.
+ */
+void HTTPServer::RunDeferredHandler(BaseHTTPCallback *handler,
+                                    HTTPRequest *request,
+                                    HTTPResponse *response) {
+#ifdef HAVE_MHD_RESUME_CONNECTION
+  // Once the response is sent, the request may be deleted by another thread.
+  struct MHD_Connection *connection = request->Connection();
+  if (handler->Run(request, response) == MHD_NO) {
+    MHD_resume_connection(connection);
+  }
+#else
+  handler->Run(request, response);
+#endif  // HAVE_MHD_RESUME_CONNECTION
+}
+
+
 /**
  * @brief Call the appropriate handler.
  */
-int HTTPServer::DispatchRequest(const HTTPRequest *request,
+int HTTPServer::DispatchRequest(HTTPRequest *request,
                                 HTTPResponse *response) {
+  map<string, WebSocketHandler*>::iterator ws_iter =
+    m_websocket_handlers.find(request->Url());
+  if (ws_iter != m_websocket_handlers.end()) {
+    return ServeWebSocket(request, response, ws_iter->second);
+  }
+
   map<string, BaseHTTPCallback*>::iterator iter =
     m_handlers.find(request->Url());
 
   if (iter != m_handlers.end()) {
+    if (ThreadPooled() && !STLContains(m_thread_safe_handlers, iter->first)) {
+      return DeferRequest(iter->second, request, response);
+    }
     return iter->second->Run(request, response);
   }
 
@@ -639,10 +1120,13 @@ int HTTPServer::DispatchRequest(const HTTPRequest *request,
       m_static_content.find(request->Url());
 
   if (file_iter != m_static_content.end()) {
-    return ServeStaticContent(&(file_iter->second), response);
+    return ServeStaticContent(request, file_iter->second, response);
   }
 
   if (m_default_handler) {
+    if (ThreadPooled()) {
+      return DeferRequest(m_default_handler, request, response);
+    }
     return m_default_handler->Run(request, response);
   }
 
@@ -668,6 +1152,56 @@ bool HTTPServer::RegisterHandler(const string &path,
 }
 
 
+/**
+ * @brief Register a handler that doesn't need to run on the SelectServer
+ * thread.
+ *
+ * When the server uses a thread pool these handlers are run directly from
+ * the pool, and may be run concurrently.
+ * @param path the url to respond on
+ * @param handler the Closure to call for this request. These will be freed
+ * once the HTTPServer is destroyed.
+ */
+bool HTTPServer::RegisterThreadSafeHandler(const string &path,
+                                           BaseHTTPCallback *handler) {
+  if (!RegisterHandler(path, handler)) {
+    return false;
+  }
+  m_thread_safe_handlers.insert(path);
+  return true;
+}
+
+
+/**
+ * @brief Register a handler for WebSocket connections.
+ * @param path the url to accept WebSocket connections on
+ * @param handler the Callback to run with each new WebSocket. This will be
+ * freed once the HTTPServer is destroyed.
+ * @returns false if the path is already registered, or if the version of
+ *   libmicrohttpd doesn't support upgrading connections.
+ */
+bool HTTPServer::RegisterWebSocketHandler(const string &path,
+                                          WebSocketCallback *handler) {
+#ifdef HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+  if (STLContains(m_websocket_handlers, path) ||
+      STLContains(m_handlers, path)) {
+    delete handler;
+    return false;
+  }
+  WebSocketHandler *ws_handler = new WebSocketHandler();
+  ws_handler->server = this;
+  ws_handler->callback = handler;
+  m_websocket_handlers[path] = ws_handler;
+  return true;
+#else
+  OLA_WARN << "WebSockets aren't supported by this version of libmicrohttpd, "
+           << "not registering " << path;
+  delete handler;
+  return false;
+#endif  // HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+}
+
+
 /**
  * @brief Register a static file. The root of the URL corresponds to the data dir.
  * @param path the URL path for the file e.g. '/foo.png'
@@ -703,6 +1237,7 @@ bool HTTPServer::RegisterFile(const std::string &path,
   static_file_info file_info;
   file_info.file_path = file;
   file_info.content_type = content_type;
+  file_info.loaded = false;
 
   pair<string, static_file_info> pair(path, file_info);
   m_static_content.insert(pair);
@@ -792,55 +1327,104 @@ int HTTPServer::ServeStaticContent(const std::string &path,
   static_file_info file_info;
   file_info.file_path = path;
   file_info.content_type = content_type;
-  return ServeStaticContent(&file_info, response);
+  file_info.loaded = false;
+  return ServeStaticContent(NULL, file_info, response);
 }
 
 
 /**
  * @brief Serve static content.
- * @param file_info details on the file to server
+ *
+ * Files loaded by Init() are served from memory, the gzip version is sent if
+ * there is one and the client accepts it. Other files are read from disk.
+ * @param request the request, may be NULL
+ * @param file_info details on the file to serve
  * @param response the response to use
  */
-int HTTPServer::ServeStaticContent(static_file_info *file_info,
+int HTTPServer::ServeStaticContent(const HTTPRequest *request,
+                                   const static_file_info &file_info,
                                    HTTPResponse *response) {
-  char *data;
-  unsigned int length;
-  string file_path = m_data_dir;
-  file_path.push_back(ola::file::PATH_SEPARATOR);
-  file_path.append(file_info->file_path);
-  ifstream i_stream(file_path.c_str(), ifstream::binary);
+  const static_file_info *file = &file_info;
+  static_file_info disk_file;
+  if (!file_info.loaded) {
+    disk_file = file_info;
+    if (!LoadFile(&disk_file)) {
+      return ServeNotFound(response);
+    }
+    file = &disk_file;
+  }
 
-  if (!i_stream.is_open()) {
-    OLA_WARN << "Missing file: " << file_path;
-    return ServeNotFound(response);
+  if (!file->content_type.empty()) {
+    response->SetContentType(file->content_type);
+  }
+  response->SetHeader(MHD_HTTP_HEADER_CACHE_CONTROL, K_STATIC_CACHE_CONTROL);
+
+  const string *data = &file->data;
+  response->SetETag(file->etag);
+  if (!file->gzip_data.empty()) {
+    response->SetHeader(K_VARY_HEADER, K_ACCEPT_ENCODING_HEADER);
+    if (request && AcceptsGzip(request->GetHeader(K_ACCEPT_ENCODING_HEADER))) {
+      response->SetHeader(K_CONTENT_ENCODING_HEADER, "gzip");
+      response->SetETag(file->gzip_etag);
+      data = &file->gzip_data;
+    }
   }
 
-  i_stream.seekg(0, std::ios::end);
-  length = i_stream.tellg();
-  i_stream.seekg(0, std::ios::beg);
+  // The data in the cache outlives the response, the data from disk doesn't.
+  struct MHD_Response *mhd_response = NULL;
+  if (file == &file_info) {
+    mhd_response = BuildPersistentResponse(*data);
+  } else {
+    mhd_response = BuildResponse(const_cast<char*>(data->data()),
+                                 data->size());
+  }
+  int ret = response->SendResponse(mhd_response);
+  delete response;
+  return ret;
+}
 
-  data = static_cast<char*>(malloc(length));
 
-  i_stream.read(data, length);
-  i_stream.close();
+/**
+ * @brief Load the registered static files into memory.
+ */
+void HTTPServer::LoadStaticContent() {
+  map<string, static_file_info>::iterator iter = m_static_content.begin();
+  unsigned int loaded = 0;
+  for (; iter != m_static_content.end(); ++iter) {
+    if (!iter->second.loaded && LoadFile(&iter->second)) {
+      iter->second.loaded = true;
+      loaded++;
+    }
+  }
+  OLA_INFO << "Loaded " << loaded << " of " << m_static_content.size()
+           << " static files";
+}
 
-  struct MHD_Response *mhd_response = BuildResponse(static_cast<void*>(data),
-                                                    length);
 
-  if (!file_info->content_type.empty()) {
-    MHD_add_response_header(mhd_response,
-                            MHD_HTTP_HEADER_CONTENT_TYPE,
-                            file_info->content_type.c_str());
+/**
+ * @brief Read a static file, and the gzip version if there is one.
+ * @param file_info the static_file_info to populate.
+ * @returns true if the file was read, false if it's missing.
+ */
+bool HTTPServer::LoadFile(static_file_info *file_info) const {
+  string file_path = m_data_dir;
+  file_path.push_back(ola::file::PATH_SEPARATOR);
+  file_path.append(file_info->file_path);
+  if (!ReadFile(file_path, &file_info->data)) {
+    OLA_WARN << "Missing file: " << file_path;
+    return false;
   }
+  file_info->etag = ContentETag(file_info->data);
 
-  int ret = MHD_queue_response(response->Connection(),
-                               MHD_HTTP_OK,
-                               mhd_response);
-  MHD_destroy_response(mhd_response);
-  delete response;
-  return ret;
+  file_info->gzip_data.clear();
+  file_info->gzip_etag.clear();
+  if (ReadFile(file_path + ".gz", &file_info->gzip_data)) {
+    file_info->gzip_etag = ContentETag(file_info->gzip_data);
+  }
+  return true;
 }
 
+
 void HTTPServer::InsertSocket(bool is_readable, bool is_writeable, int fd) {
 #ifdef _WIN32
   UnmanagedSocketDescriptor *socket = new UnmanagedSocketDescriptor(fd);
@@ -878,6 +1462,47 @@ void HTTPServer::FreeSocket(DescriptorState *state) {
 }
 
 
+/**
+ * @brief Complete the opening handshake of a WebSocket.
+ * @param request the HTTP request, which should be a GET with an Upgrade
+ *   header.
+ * @param response the HTTPResponse to use.
+ * @param handler the handler to pass the new WebSocket to.
+ */
+int HTTPServer::ServeWebSocket(const HTTPRequest *request,
+                               HTTPResponse *response,
+                               WebSocketHandler *handler) {
+  string upgrade = request->GetHeader(K_UPGRADE_HEADER);
+  ToLower(&upgrade);
+  const string key = request->GetHeader(K_WEBSOCKET_KEY_HEADER);
+
+  if (request->Method() != MHD_HTTP_METHOD_GET || upgrade != "websocket" ||
+      key.empty() ||
+      request->GetHeader(K_WEBSOCKET_VERSION_HEADER) != "13") {
+    response->SetStatus(MHD_HTTP_BAD_REQUEST);
+    response->SetContentType(CONTENT_TYPE_PLAIN);
+    response->SetHeader(K_WEBSOCKET_VERSION_HEADER, "13");
+    response->Append("Expected a WebSocket upgrade request");
+    int r = response->Send();
+    delete response;
+    return r;
+  }
+
+#ifdef HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+  response->SetStatus(MHD_HTTP_SWITCHING_PROTOCOLS);
+  response->SetHeader(K_UPGRADE_HEADER, "websocket");
+  response->SetHeader(K_WEBSOCKET_ACCEPT_HEADER, WebSocket::AcceptKey(key));
+  int r = response->SendResponse(
+      MHD_create_response_for_upgrade(&UpgradeToWebSocket, handler));
+  delete response;
+  return r;
+#else
+  (void) handler;
+  return ServeError(response, "WebSockets aren't supported");
+#endif  // HAVE_MHD_CREATE_RESPONSE_FOR_UPGRADE
+}
+
+
 struct MHD_Response *HTTPServer::BuildResponse(void *data, size_t size) {
 #ifdef HAVE_MHD_CREATE_RESPONSE_FROM_BUFFER
   return MHD_create_response_from_buffer(size, data, MHD_RESPMEM_MUST_COPY);
@@ -4,6 +4,16 @@ if HAVE_LIBMICROHTTPD
 noinst_LTLIBRARIES += common/http/libolahttp.la
 common_http_libolahttp_la_SOURCES = \
     common/http/HTTPServer.cpp \
-    common/http/OlaHTTPServer.cpp
+    common/http/OlaHTTPServer.cpp \
+    common/http/WebSocket.cpp
 common_http_libolahttp_la_LIBADD = $(libmicrohttpd_LIBS)
+
+# TESTS
+##################################################
+test_programs += common/http/WebSocketTester
+
+common_http_WebSocketTester_SOURCES = common/http/WebSocketTest.cpp
+common_http_WebSocketTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_http_WebSocketTester_LDADD = $(COMMON_TESTING_LIBS) \
+                                    common/http/libolahttp.la
 endif
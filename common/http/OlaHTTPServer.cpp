@@ -22,19 +22,60 @@
 #include <ola/http/OlaHTTPServer.h>
 #include <ola/ExportMap.h>
 #include <ola/Clock.h>
+#include <algorithm>
+#include <iomanip>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/io/LoopProfiler.h"
+
 namespace ola {
 namespace http {
 
 using ola::ExportMap;
+using ola::io::LoopProfiler;
 using std::auto_ptr;
 using std::ostringstream;
+using std::pair;
 using std::string;
 using std::vector;
 
+namespace {
+/*
+ * Find a variable in the ExportMap without creating it.
+ */
+template <typename VariableType>
+VariableType *FindVariable(const ExportMap *export_map, const string &name) {
+  vector<BaseVariable*> variables = export_map->AllVariables();
+  vector<BaseVariable*>::iterator iter = variables.begin();
+  for (; iter != variables.end(); ++iter) {
+    if ((*iter)->Name() == name) {
+      return dynamic_cast<VariableType*>(*iter);
+    }
+  }
+  return NULL;
+}
+
+/*
+ * The upper bound of the highest non-empty bucket, or 0 if the values exceed
+ * all the bounds.
+ */
+uint64_t MaxBound(const HistogramVariable &histogram) {
+  const vector<uint64_t> &bounds = histogram.Bounds();
+  if (histogram.BucketCount(bounds.size())) {
+    return 0;
+  }
+  for (unsigned int i = bounds.size(); i > 0; i--) {
+    if (histogram.BucketCount(i - 1)) {
+      return bounds[i - 1];
+    }
+  }
+  return 0;
+}
+}  // namespace
+
 const char OlaHTTPServer::K_DATA_DIR_VAR[] = "http_data_dir";
 const char OlaHTTPServer::K_UPTIME_VAR[] = "uptime-in-ms";
 
@@ -48,7 +89,11 @@ OlaHTTPServer::OlaHTTPServer(const HTTPServer::HTTPServerOptions &options,
     : m_export_map(export_map),
       m_server(options) {
   RegisterHandler("/debug", &OlaHTTPServer::DisplayDebug);
+  RegisterHandler("/debug/loop", &OlaHTTPServer::DisplayLoopProfile);
   RegisterHandler("/help", &OlaHTTPServer::DisplayHandlers);
+  // This only reads the ExportMap, so it doesn't need the HTTP thread.
+  m_server.RegisterThreadSafeHandler(
+      "/metrics", NewCallback(this, &OlaHTTPServer::DisplayMetrics));
 
   StringVariable *data_dir_var = export_map->GetStringVar(K_DATA_DIR_VAR);
   data_dir_var->Set(m_server.DataDir());
@@ -93,6 +138,85 @@ int OlaHTTPServer::DisplayDebug(const HTTPRequest*,
 }
 
 
+/**
+ * Display the time spent in each event loop callback, largest total first.
+ */
+int OlaHTTPServer::DisplayLoopProfile(const HTTPRequest*,
+                                      HTTPResponse *raw_response) {
+  auto_ptr<HTTPResponse> response(raw_response);
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+
+  const HistogramMap *callback_time = FindVariable<HistogramMap>(
+      m_export_map, LoopProfiler::K_CALLBACK_TIME_VAR);
+  if (!callback_time) {
+    response->Append("Loop profiling is disabled, start with "
+                     "--profile-loop to enable it.\n");
+    return response->Send();
+  }
+
+  vector<string> owners;
+  callback_time->Keys(&owners);
+  vector<pair<uint64_t, string> > by_total;
+  vector<string>::const_iterator iter = owners.begin();
+  for (; iter != owners.end(); ++iter) {
+    const HistogramVariable *histogram = callback_time->Find(*iter);
+    if (histogram) {
+      by_total.push_back(std::make_pair(histogram->Sum(), *iter));
+    }
+  }
+  std::sort(by_total.rbegin(), by_total.rend());
+
+  ostringstream out;
+  out << "Time spent in event loop callbacks, in microseconds.\n\n"
+      << std::left << std::setw(32) << "owner" << std::right
+      << std::setw(12) << "calls" << std::setw(14) << "total"
+      << std::setw(10) << "mean" << std::setw(10) << "max <=" << "\n";
+  vector<pair<uint64_t, string> >::const_iterator total_iter;
+  for (total_iter = by_total.begin(); total_iter != by_total.end();
+       ++total_iter) {
+    const HistogramVariable *histogram = callback_time->Find(
+        total_iter->second);
+    const uint64_t count = histogram->Count();
+    const uint64_t max_bound = MaxBound(*histogram);
+    out << std::left << std::setw(32) << total_iter->second << std::right
+        << std::setw(12) << count << std::setw(14) << total_iter->first
+        << std::setw(10) << (count ? total_iter->first / count : 0)
+        << std::setw(10);
+    if (max_bound) {
+      out << max_bound;
+    } else {
+      out << "inf";
+    }
+    out << "\n";
+  }
+
+  const HistogramVariable *lag = FindVariable<HistogramVariable>(
+      m_export_map, LoopProfiler::K_TIMEOUT_LAG_VAR);
+  if (lag && lag->Count()) {
+    out << "\nTimeouts ran " << lag->Sum() / lag->Count()
+        << "us late on average, " << LoopProfiler::K_TIMEOUT_LAG_VAR << ": "
+        << lag->Value() << "\n";
+  }
+  response->Append(out.str());
+  return response->Send();
+}
+
+
+/**
+ * Display the contents of the ExportMap in the OpenMetrics text format.
+ */
+int OlaHTTPServer::DisplayMetrics(const HTTPRequest*,
+                                  HTTPResponse *raw_response) {
+  auto_ptr<HTTPResponse> response(raw_response);
+  ostringstream out;
+  m_export_map->WriteMetrics(&out);
+  response->SetContentType(HTTPServer::CONTENT_TYPE_OPENMETRICS);
+  response->Append(out.str());
+  int r = response->Send();
+  return r;
+}
+
+
 /**
  * Display a list of registered handlers
  */
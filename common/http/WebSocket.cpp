@@ -0,0 +1,443 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WebSocket.cpp
+ * The server side of a RFC 6455 WebSocket connection.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/http/WebSocket.h"
+
+namespace ola {
+namespace http {
+
+using ola::io::ConnectedDescriptor;
+using ola::io::IOQueue;
+using std::string;
+
+namespace {
+
+// From section 1.3 of RFC 6455.
+const char WEBSOCKET_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+const uint8_t FIN_BIT = 0x80;
+const uint8_t OPCODE_MASK = 0x0f;
+const uint8_t MASK_BIT = 0x80;
+const uint8_t LENGTH_MASK = 0x7f;
+const uint8_t LENGTH_16_BIT = 126;
+const uint8_t LENGTH_64_BIT = 127;
+
+inline uint32_t RotateLeft(uint32_t value, unsigned int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+/*
+ * SHA-1, as described in RFC 3174. This is only used for the opening
+ * handshake, it's not fast and shouldn't be used for anything else.
+ */
+void SHA1(const string &input, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+                   0xc3d2e1f0};
+
+  string data(input);
+  const uint64_t bit_length = static_cast<uint64_t>(input.size()) * 8;
+  data.push_back(static_cast<char>(0x80));
+  while (data.size() % 64 != 56) {
+    data.push_back(0);
+  }
+  for (int i = 7; i >= 0; i--) {
+    data.push_back(static_cast<char>((bit_length >> (i * 8)) & 0xff));
+  }
+
+  for (unsigned int chunk = 0; chunk < data.size(); chunk += 64) {
+    uint32_t w[80];
+    for (unsigned int i = 0; i < 16; i++) {
+      const uint8_t *ptr = reinterpret_cast<const uint8_t*>(
+          data.data() + chunk + i * 4);
+      w[i] = (ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
+    }
+    for (unsigned int i = 16; i < 80; i++) {
+      w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (unsigned int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5a827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ed9eba1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8f1bbcdc;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xca62c1d6;
+      }
+      uint32_t temp = RotateLeft(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = RotateLeft(b, 30);
+      b = a;
+      a = temp;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+
+  for (unsigned int i = 0; i < 5; i++) {
+    digest[i * 4] = h[i] >> 24;
+    digest[i * 4 + 1] = h[i] >> 16;
+    digest[i * 4 + 2] = h[i] >> 8;
+    digest[i * 4 + 3] = h[i];
+  }
+}
+
+string Base64Encode(const uint8_t *data, unsigned int length) {
+  static const char ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  string output;
+  for (unsigned int i = 0; i < length; i += 3) {
+    uint32_t group = data[i] << 16;
+    if (i + 1 < length) {
+      group |= data[i + 1] << 8;
+    }
+    if (i + 2 < length) {
+      group |= data[i + 2];
+    }
+    output.push_back(ALPHABET[(group >> 18) & 0x3f]);
+    output.push_back(ALPHABET[(group >> 12) & 0x3f]);
+    output.push_back(i + 1 < length ? ALPHABET[(group >> 6) & 0x3f] : '=');
+    output.push_back(i + 2 < length ? ALPHABET[group & 0x3f] : '=');
+  }
+  return output;
+}
+}  // namespace
+
+
+WebSocket::WebSocket(ola::io::SelectServerInterface *ss,
+                     ConnectedDescriptor *socket,
+                     const string &initial_data)
+    : m_ss(ss),
+      m_socket(socket),
+      m_input(initial_data),
+      m_in_message(false),
+      m_write_registered(false),
+      m_close_sent(false),
+      m_shutdown_pending(false),
+      m_closed(false) {
+  m_socket->SetOnData(NewCallback(this, &WebSocket::ReceiveData));
+  m_socket->SetOnWritable(NewCallback(this, &WebSocket::PerformWrite));
+  m_socket->SetOnClose(NewSingleCallback(this, &WebSocket::SocketClosed));
+  m_ss->AddReadDescriptor(m_socket.get());
+}
+
+
+WebSocket::~WebSocket() {
+  if (!m_closed) {
+    m_on_close.reset();
+    Shutdown();
+  }
+}
+
+
+void WebSocket::SetOnMessage(MessageCallback *callback) {
+  m_on_message.reset(callback);
+}
+
+
+void WebSocket::SetOnClose(CloseCallback *callback) {
+  m_on_close.reset(callback);
+}
+
+
+bool WebSocket::SendText(const string &data) {
+  return SendFrame(TEXT_FRAME, reinterpret_cast<const uint8_t*>(data.data()),
+                   data.size());
+}
+
+
+bool WebSocket::SendBinary(const uint8_t *data, unsigned int length) {
+  return SendFrame(BINARY_FRAME, data, length);
+}
+
+
+void WebSocket::Close() {
+  if (m_closed || m_close_sent) {
+    return;
+  }
+  EncodeFrame(CLOSE_FRAME, NULL, 0, &m_output);
+  m_close_sent = true;
+  PerformWrite();
+}
+
+
+string WebSocket::AcceptKey(const string &key) {
+  uint8_t digest[20];
+  SHA1(key + WEBSOCKET_GUID, digest);
+  return Base64Encode(digest, sizeof(digest));
+}
+
+
+void WebSocket::EncodeFrame(Opcode opcode, const uint8_t *data,
+                            unsigned int length, IOQueue *output) {
+  uint8_t header[10];
+  unsigned int header_size = 2;
+  header[0] = FIN_BIT | opcode;
+  if (length < LENGTH_16_BIT) {
+    header[1] = length;
+  } else if (length <= 0xffff) {
+    header[1] = LENGTH_16_BIT;
+    header[2] = length >> 8;
+    header[3] = length;
+    header_size = 4;
+  } else {
+    header[1] = LENGTH_64_BIT;
+    const uint64_t long_length = length;
+    for (unsigned int i = 0; i < 8; i++) {
+      header[2 + i] = long_length >> (8 * (7 - i));
+    }
+    header_size = 10;
+  }
+  output->Write(header, header_size);
+  if (length) {
+    output->Write(data, length);
+  }
+}
+
+
+/*
+ * Called when there is data to read from the socket.
+ */
+void WebSocket::ReceiveData() {
+  uint8_t buffer[READ_SIZE];
+  unsigned int data_read = 0;
+  if (m_socket->Receive(buffer, sizeof(buffer), data_read) < 0) {
+    OLA_WARN << "WebSocket read failed";
+    Shutdown();
+    return;
+  }
+  m_input.append(reinterpret_cast<char*>(buffer), data_read);
+
+  if (!ProcessFrames()) {
+    Shutdown();
+  }
+}
+
+
+/*
+ * Decode as many complete frames as are in the input buffer.
+ * @returns false if the connection should be closed.
+ */
+bool WebSocket::ProcessFrames() {
+  while (!m_closed && m_input.size() >= 2) {
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(m_input.data());
+    const bool fin = data[0] & FIN_BIT;
+    const uint8_t opcode = data[0] & OPCODE_MASK;
+    const bool masked = data[1] & MASK_BIT;
+    uint64_t length = data[1] & LENGTH_MASK;
+    unsigned int offset = 2;
+
+    if (length == LENGTH_16_BIT) {
+      if (m_input.size() < 4) {
+        return true;
+      }
+      length = (data[2] << 8) | data[3];
+      offset = 4;
+    } else if (length == LENGTH_64_BIT) {
+      if (m_input.size() < 10) {
+        return true;
+      }
+      length = 0;
+      for (unsigned int i = 0; i < 8; i++) {
+        length = (length << 8) | data[2 + i];
+      }
+      offset = 10;
+    }
+
+    if (!masked) {
+      OLA_WARN << "Unmasked frame from WebSocket client";
+      return false;
+    }
+    if (length + m_message.size() > MAX_MESSAGE_SIZE) {
+      OLA_WARN << "WebSocket message exceeds " << MAX_MESSAGE_SIZE
+               << " bytes";
+      return false;
+    }
+
+    const uint8_t *mask = data + offset;
+    offset += 4;
+    if (m_input.size() < offset + length) {
+      return true;
+    }
+
+    string payload(m_input, offset, length);
+    for (unsigned int i = 0; i < payload.size(); i++) {
+      payload[i] ^= mask[i % 4];
+    }
+    m_input.erase(0, offset + length);
+
+    if (!HandleFrame(fin, opcode, payload)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Handle a single frame.
+ * @returns false if the connection should be closed.
+ */
+bool WebSocket::HandleFrame(bool fin, uint8_t opcode, const string &payload) {
+  switch (opcode) {
+    case CONTINUATION_FRAME:
+      if (!m_in_message) {
+        OLA_WARN << "WebSocket continuation frame without a message";
+        return false;
+      }
+      m_message.append(payload);
+      break;
+    case TEXT_FRAME:
+    case BINARY_FRAME:
+      if (m_in_message) {
+        OLA_WARN << "WebSocket message started before the last one finished";
+        return false;
+      }
+      m_message = payload;
+      m_in_message = true;
+      break;
+    case CLOSE_FRAME:
+      if (!m_close_sent) {
+        // Echo the status code back, as per section 5.5.1.
+        SendFrame(CLOSE_FRAME,
+                  reinterpret_cast<const uint8_t*>(payload.data()),
+                  payload.size() >= 2 ? 2 : 0);
+        m_close_sent = true;
+      }
+      m_shutdown_pending = true;
+      if (!m_write_registered) {
+        Shutdown();
+      }
+      return true;
+    case PING_FRAME:
+      SendFrame(PONG_FRAME, reinterpret_cast<const uint8_t*>(payload.data()),
+                payload.size());
+      return true;
+    case PONG_FRAME:
+      return true;
+    default:
+      OLA_WARN << "Unknown WebSocket opcode " << static_cast<int>(opcode);
+      return false;
+  }
+
+  if (fin) {
+    m_in_message = false;
+    if (m_on_message.get()) {
+      m_on_message->Run(m_message);
+    }
+    m_message.clear();
+  }
+  return true;
+}
+
+
+bool WebSocket::SendFrame(Opcode opcode, const uint8_t *data,
+                          unsigned int length) {
+  if (m_closed || m_close_sent || LimitReached()) {
+    return false;
+  }
+  EncodeFrame(opcode, data, length, &m_output);
+  PerformWrite();
+  return true;
+}
+
+
+/*
+ * Write as much of the output buffer as we can, and register for write
+ * events if there is some left over.
+ */
+void WebSocket::PerformWrite() {
+  if (m_closed) {
+    return;
+  }
+
+  if (!m_output.Empty() && m_socket->Send(&m_output) < 0 &&
+      errno != EAGAIN && errno != EWOULDBLOCK) {
+    OLA_WARN << "WebSocket write failed";
+    m_output.Clear();
+    Shutdown();
+    return;
+  }
+
+  if (m_output.Empty()) {
+    if (m_write_registered) {
+      m_ss->RemoveWriteDescriptor(m_socket.get());
+      m_write_registered = false;
+    }
+    if (m_shutdown_pending) {
+      Shutdown();
+    }
+  } else if (!m_write_registered) {
+    m_ss->AddWriteDescriptor(m_socket.get());
+    m_write_registered = true;
+  }
+}
+
+
+/*
+ * Called by the SelectServer when the client closes the connection. The
+ * SelectServer has already removed the socket.
+ */
+void WebSocket::SocketClosed() {
+  Shutdown(false);
+}
+
+
+/*
+ * Close the socket and run the on-close callback.
+ * @param remove_descriptor true if the socket needs to be removed from the
+ *   SelectServer.
+ */
+void WebSocket::Shutdown(bool remove_descriptor) {
+  if (m_closed) {
+    return;
+  }
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_socket.get());
+    m_write_registered = false;
+  }
+  if (remove_descriptor) {
+    m_ss->RemoveReadDescriptor(m_socket.get());
+  }
+  m_closed = true;
+  m_socket->Close();
+  if (m_on_close.get()) {
+    m_on_close.release()->Run();
+  }
+}
+}  // namespace http
+}  // namespace ola
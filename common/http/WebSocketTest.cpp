@@ -0,0 +1,210 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WebSocketTest.cpp
+ * Test fixture for the WebSocket class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/http/WebSocket.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/SelectServer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::TimeInterval;
+using ola::http::WebSocket;
+using ola::io::IOQueue;
+using ola::io::PipeDescriptor;
+using ola::io::SelectServer;
+using std::string;
+using std::vector;
+
+class WebSocketTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(WebSocketTest);
+  CPPUNIT_TEST(testAcceptKey);
+  CPPUNIT_TEST(testEncodeFrame);
+  CPPUNIT_TEST(testReceive);
+  CPPUNIT_TEST(testClose);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testAcceptKey();
+  void testEncodeFrame();
+  void testReceive();
+  void testClose();
+
+  void NewMessage(const string &message) {
+    m_messages.push_back(message);
+  }
+
+  void Closed() {
+    m_closed = true;
+  }
+
+ private:
+  SelectServer m_ss;
+  PipeDescriptor *m_client;
+  WebSocket *m_websocket;
+  vector<string> m_messages;
+  bool m_closed;
+
+  void SendToServer(const uint8_t *data, unsigned int length);
+  string ReadFromServer();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(WebSocketTest);
+
+// The masked frames from section 5.7 of RFC 6455
+static const uint8_t MASKED_HELLO[] = {
+  0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58
+};
+
+static const uint8_t FRAGMENTED_HELLO[] = {
+  0x01, 0x83, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d,
+  0x80, 0x82, 0x37, 0xfa, 0x21, 0x3d, 0x5b, 0x95,
+};
+
+void WebSocketTest::setUp() {
+  PipeDescriptor *server = new PipeDescriptor();
+  OLA_ASSERT_TRUE(server->Init());
+  m_client = server->OppositeEnd();
+  m_closed = false;
+  m_messages.clear();
+
+  m_websocket = new WebSocket(&m_ss, server);
+  m_websocket->SetOnMessage(
+      ola::NewCallback(this, &WebSocketTest::NewMessage));
+  m_websocket->SetOnClose(
+      ola::NewSingleCallback(this, &WebSocketTest::Closed));
+}
+
+void WebSocketTest::tearDown() {
+  delete m_websocket;
+  delete m_client;
+}
+
+/*
+ * Check the handshake key, this is the example from section 1.3 of RFC 6455.
+ */
+void WebSocketTest::testAcceptKey() {
+  OLA_ASSERT_EQ(string("s3pPLMBiTxaQ9kYGzzhZRbK+xOo="),
+                WebSocket::AcceptKey("dGhlIHNhbXBsZSBub25jZQ=="));
+}
+
+/*
+ * Check we encode frames correctly.
+ */
+void WebSocketTest::testEncodeFrame() {
+  IOQueue output;
+  const string hello = "Hello";
+  WebSocket::EncodeFrame(WebSocket::TEXT_FRAME,
+                         reinterpret_cast<const uint8_t*>(hello.data()),
+                         hello.size(), &output);
+  const uint8_t expected[] = {0x81, 0x05, 'H', 'e', 'l', 'l', 'o'};
+  uint8_t frame[sizeof(expected)];
+  OLA_ASSERT_EQ(static_cast<unsigned int>(sizeof(expected)), output.Size());
+  output.Read(frame, sizeof(frame));
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), frame, sizeof(frame));
+
+  // 256 bytes uses the 16 bit length
+  uint8_t data[256];
+  memset(data, 0, sizeof(data));
+  WebSocket::EncodeFrame(WebSocket::BINARY_FRAME, data, sizeof(data),
+                         &output);
+  OLA_ASSERT_EQ(260u, output.Size());
+  uint8_t header[4];
+  output.Read(header, sizeof(header));
+  const uint8_t expected_header[] = {0x82, 0x7e, 0x01, 0x00};
+  OLA_ASSERT_DATA_EQUALS(expected_header, sizeof(expected_header),
+                         header, sizeof(header));
+}
+
+/*
+ * Check we receive single & fragmented messages and answer pings.
+ */
+void WebSocketTest::testReceive() {
+  SendToServer(MASKED_HELLO, sizeof(MASKED_HELLO));
+  SendToServer(FRAGMENTED_HELLO, sizeof(FRAGMENTED_HELLO));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_messages.size());
+  OLA_ASSERT_EQ(string("Hello"), m_messages[0]);
+  OLA_ASSERT_EQ(string("Hello"), m_messages[1]);
+
+  // a masked ping with "Hello" should return an unmasked pong
+  uint8_t ping[sizeof(MASKED_HELLO)];
+  memcpy(ping, MASKED_HELLO, sizeof(ping));
+  ping[0] = 0x89;
+  SendToServer(ping, sizeof(ping));
+  const uint8_t pong[] = {0x8a, 0x05, 'H', 'e', 'l', 'l', 'o'};
+  const string reply = ReadFromServer();
+  OLA_ASSERT_DATA_EQUALS(pong, sizeof(pong),
+                         reinterpret_cast<const uint8_t*>(reply.data()),
+                         reply.size());
+
+  // unmasked frames close the connection
+  const uint8_t unmasked[] = {0x81, 0x02, 'h', 'i'};
+  SendToServer(unmasked, sizeof(unmasked));
+  OLA_ASSERT_TRUE(m_closed);
+  OLA_ASSERT_TRUE(m_websocket->IsClosed());
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_messages.size());
+}
+
+/*
+ * Check the closing handshake.
+ */
+void WebSocketTest::testClose() {
+  const string hello = "Hello";
+  OLA_ASSERT_TRUE(m_websocket->SendText(hello));
+  const uint8_t expected[] = {0x81, 0x05, 'H', 'e', 'l', 'l', 'o'};
+  string reply = ReadFromServer();
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                         reinterpret_cast<const uint8_t*>(reply.data()),
+                         reply.size());
+
+  // close with status 1000
+  const uint8_t close_frame[] = {0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03,
+                                 0xe8};
+  SendToServer(close_frame, sizeof(close_frame));
+  OLA_ASSERT_TRUE(m_closed);
+  OLA_ASSERT_FALSE(m_websocket->SendText(hello));
+
+  reply = ReadFromServer();
+  const uint8_t expected_close[] = {0x88, 0x02, 0x03, 0xe8};
+  OLA_ASSERT_DATA_EQUALS(expected_close, sizeof(expected_close),
+                         reinterpret_cast<const uint8_t*>(reply.data()),
+                         reply.size());
+}
+
+void WebSocketTest::SendToServer(const uint8_t *data, unsigned int length) {
+  OLA_ASSERT_EQ(static_cast<ssize_t>(length), m_client->Send(data, length));
+  m_ss.RunOnce(TimeInterval(0, 10000));
+}
+
+string WebSocketTest::ReadFromServer() {
+  uint8_t buffer[100];
+  unsigned int data_read = 0;
+  OLA_ASSERT_EQ(0, m_client->Receive(buffer, sizeof(buffer), data_read));
+  return string(reinterpret_cast<char*>(buffer), data_read);
+}
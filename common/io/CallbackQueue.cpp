@@ -0,0 +1,220 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackQueue.cpp
+ * A queue of callbacks to run on the SelectServer thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include "common/io/CallbackQueue.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif  // HAVE_SYS_EVENTFD_H
+
+#include "ola/Logging.h"
+
+namespace ola {
+namespace io {
+
+// The number of callbacks run on the last wake up.
+const char CallbackQueue::K_QUEUE_DEPTH_VAR[] = "ss-execute-queue-depth";
+// The number of times the SelectServer was woken to run callbacks.
+const char CallbackQueue::K_QUEUE_WAKEUPS_VAR[] = "ss-execute-wakeups";
+
+CallbackQueue::CallbackQueue(ExportMap *export_map)
+    : m_export_map(export_map),
+      m_head(NULL),
+      m_wake_up_pending(false),
+      m_using_eventfd(false) {
+  if (m_export_map) {
+    m_export_map->GetIntegerVar(K_QUEUE_DEPTH_VAR);
+    m_export_map->GetCounterVar(K_QUEUE_WAKEUPS_VAR);
+  }
+}
+
+CallbackQueue::~CallbackQueue() {
+  Node *node = m_head;
+  while (node) {
+    Node *next = node->next;
+    delete node->callback;
+    delete node;
+    node = next;
+  }
+
+#ifdef HAVE_SYS_EVENTFD_H
+  if (m_using_eventfd) {
+    close(m_wake_up_descriptor->ReadDescriptor());
+  }
+#endif  // HAVE_SYS_EVENTFD_H
+}
+
+bool CallbackQueue::Init() {
+  if (m_wake_up_descriptor.get()) {
+    return true;
+  }
+
+#ifdef HAVE_SYS_EVENTFD_H
+  int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd >= 0) {
+    m_wake_up_descriptor.reset(new UnmanagedFileDescriptor(fd));
+    m_using_eventfd = true;
+    return true;
+  }
+  OLA_WARN << "eventfd() failed: " << strerror(errno)
+           << ", falling back to a pipe";
+#endif  // HAVE_SYS_EVENTFD_H
+
+  std::auto_ptr<LoopbackDescriptor> loopback(new LoopbackDescriptor());
+  if (!loopback->Init()) {
+    return false;
+  }
+  m_wake_up_descriptor.reset(loopback.release());
+  return true;
+}
+
+bool CallbackQueue::AddToPoller(PollerInterface *poller) {
+  if (!m_wake_up_descriptor.get()) {
+    return false;
+  }
+
+  m_wake_up_descriptor->SetOnData(
+      NewCallback(this, &CallbackQueue::HandleWakeUp));
+  if (m_using_eventfd) {
+    return poller->AddReadDescriptor(m_wake_up_descriptor.get());
+  }
+  return poller->AddReadDescriptor(
+      static_cast<LoopbackDescriptor*>(m_wake_up_descriptor.get()), false);
+}
+
+void CallbackQueue::Push(ola::BaseCallback0<void> *callback) {
+  Node *node = new Node();
+  node->callback = callback;
+  node->next = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&m_head, &node->next, node, true,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+  }
+
+  // We signal even if we're on the poller's thread. Otherwise a callback
+  // added just before the poller blocks wouldn't run until the poll interval
+  // expired.
+  if (!__atomic_exchange_n(&m_wake_up_pending, true, __ATOMIC_SEQ_CST)) {
+    WakeUp();
+  }
+}
+
+void CallbackQueue::RunCallbacks() {
+  while (RunQueued()) {
+  }
+}
+
+void CallbackQueue::WakeUp() {
+  if (!m_wake_up_descriptor.get()) {
+    return;
+  }
+
+#ifdef HAVE_SYS_EVENTFD_H
+  if (m_using_eventfd) {
+    uint64_t value = 1;
+    if (write(m_wake_up_descriptor->WriteDescriptor(), &value,
+              sizeof(value)) < 0) {
+      OLA_WARN << "Failed to write to eventfd: " << strerror(errno);
+    }
+    return;
+  }
+#endif  // HAVE_SYS_EVENTFD_H
+
+  uint8_t wake_up = 'a';
+  static_cast<LoopbackDescriptor*>(m_wake_up_descriptor.get())->Send(
+      &wake_up, sizeof(wake_up));
+}
+
+void CallbackQueue::HandleWakeUp() {
+#ifdef HAVE_SYS_EVENTFD_H
+  if (m_using_eventfd) {
+    uint64_t value;
+    if (read(m_wake_up_descriptor->ReadDescriptor(), &value,
+             sizeof(value)) < 0 && errno != EAGAIN) {
+      OLA_WARN << "Failed to read from eventfd: " << strerror(errno);
+    }
+  }
+#endif  // HAVE_SYS_EVENTFD_H
+  if (!m_using_eventfd) {
+    LoopbackDescriptor *loopback = static_cast<LoopbackDescriptor*>(
+        m_wake_up_descriptor.get());
+    while (loopback->DataRemaining()) {
+      // try to get everything in one read
+      uint8_t message[100];
+      unsigned int size;
+      loopback->Receive(message, sizeof(message), size);
+    }
+  }
+
+  if (m_export_map) {
+    (*m_export_map->GetCounterVar(K_QUEUE_WAKEUPS_VAR))++;
+  }
+
+  // This must be cleared before we take the queue, so that anything pushed
+  // after this point signals again.
+  __atomic_store_n(&m_wake_up_pending, false, __ATOMIC_SEQ_CST);
+  RunQueued();
+}
+
+/*
+ * Take everything in the queue and run it. Callbacks pushed while this is
+ * running are left for the next call.
+ * @returns the number of callbacks run.
+ */
+unsigned int CallbackQueue::RunQueued() {
+  Node *node = __atomic_exchange_n(&m_head, static_cast<Node*>(NULL),
+                                   __ATOMIC_SEQ_CST);
+
+  // The list is newest first, reverse it so we run in the order callbacks
+  // were pushed.
+  Node *ordered = NULL;
+  unsigned int count = 0;
+  while (node) {
+    Node *next = node->next;
+    node->next = ordered;
+    ordered = node;
+    node = next;
+    count++;
+  }
+
+  if (count && m_export_map) {
+    m_export_map->GetIntegerVar(K_QUEUE_DEPTH_VAR)->Set(count);
+  }
+
+  while (ordered) {
+    Node *next = ordered->next;
+    ola::BaseCallback0<void> *callback = ordered->callback;
+    delete ordered;
+    if (callback) {
+      callback->Run();
+    }
+    ordered = next;
+  }
+  return count;
+}
+}  // namespace io
+}  // namespace ola
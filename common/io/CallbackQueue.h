@@ -0,0 +1,123 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackQueue.h
+ * A queue of callbacks to run on the SelectServer thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_CALLBACKQUEUE_H_
+#define COMMON_IO_CALLBACKQUEUE_H_
+
+#include <ola/Callback.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+
+#include <memory>
+
+#include "common/io/PollerInterface.h"
+
+namespace ola {
+namespace io {
+
+/**
+ * @class CallbackQueue
+ * @brief A multi-producer, single-consumer queue of callbacks.
+ *
+ * Any thread may call Push(). The callbacks are run on the thread that owns
+ * the poller, in the order they were pushed.
+ *
+ * Pushing is lock free. Wake ups are coalesced. Only the first Push() after
+ * the queue has been drained signals the poller, later ones just add to the
+ * queue. The signal is an eventfd where available and a pipe otherwise.
+ */
+class CallbackQueue {
+ public:
+  /**
+   * @brief Create a new CallbackQueue.
+   * @param export_map the ExportMap to update, may be NULL.
+   */
+  explicit CallbackQueue(ExportMap *export_map);
+
+  /**
+   * @brief Destructor.
+   *
+   * Callbacks that haven't been run are deleted.
+   */
+  ~CallbackQueue();
+
+  /**
+   * @brief Setup the wake up descriptor.
+   * @returns true if successful, false otherwise.
+   */
+  bool Init();
+
+  /**
+   * @brief Register the wake up descriptor with a poller.
+   * @param poller the poller to add the descriptor to.
+   * @returns true if the descriptor was added, false otherwise.
+   */
+  bool AddToPoller(PollerInterface *poller);
+
+  /**
+   * @brief The descriptor that's read when the queue is woken up.
+   * @pre Init() returned true.
+   */
+  DescriptorHandle WakeUpDescriptor() const {
+    return m_wake_up_descriptor->ReadDescriptor();
+  }
+
+  /**
+   * @brief Add a callback to the queue.
+   * @param callback the callback to run, ownership is transferred.
+   *
+   * This can be called from any thread.
+   */
+  void Push(ola::BaseCallback0<void> *callback);
+
+  /**
+   * @brief Run callbacks until the queue is empty.
+   *
+   * This must be called from the thread that owns the poller.
+   */
+  void RunCallbacks();
+
+  static const char K_QUEUE_DEPTH_VAR[];
+  static const char K_QUEUE_WAKEUPS_VAR[];
+
+ private:
+  struct Node {
+    Node *next;
+    ola::BaseCallback0<void> *callback;
+  };
+
+  ExportMap *m_export_map;
+  // The most recently pushed node, the list runs from newest to oldest.
+  Node *m_head;
+  // True if a wake up has been signalled but not yet handled.
+  bool m_wake_up_pending;
+  std::auto_ptr<BidirectionalFileDescriptor> m_wake_up_descriptor;
+  bool m_using_eventfd;
+
+  void WakeUp();
+  void HandleWakeUp();
+  unsigned int RunQueued();
+
+  DISALLOW_COPY_AND_ASSIGN(CallbackQueue);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_CALLBACKQUEUE_H_
@@ -370,6 +370,17 @@ ssize_t ConnectedDescriptor::Send(IOQueue *ioqueue) {
 
   int iocnt;
   const struct IOVec *iov = ioqueue->AsIOVec(&iocnt);
+  ssize_t bytes_sent = Send(iov, iocnt);
+  ioqueue->FreeIOVec(iov);
+  if (bytes_sent >= 0) {
+    ioqueue->Pop(bytes_sent);
+  }
+  return bytes_sent;
+}
+
+ssize_t ConnectedDescriptor::Send(const struct IOVec *iov, int iocnt) {
+  if (!ValidWriteDescriptor())
+    return 0;
 
   ssize_t bytes_sent = 0;
 
@@ -409,12 +420,9 @@ ssize_t ConnectedDescriptor::Send(IOQueue *ioqueue) {
   }
 #endif  // _WIN32
 
-  ioqueue->FreeIOVec(iov);
   if (bytes_sent < 0) {
     OLA_INFO << "Failed to send on " << WriteDescriptor() << ": " <<
       strerror(errno);
-  } else {
-    ioqueue->Pop(bytes_sent);
   }
   return bytes_sent;
 }
@@ -123,10 +123,18 @@ bool RemoveEvent(int epoll_fd, int fd) {
 }
 }  // namespace
 
+/**
+ * @brief The minimum number of events to return in one epoll cycle
+ */
+const unsigned int EPoller::MIN_EVENTS = 10;
+
 /**
  * @brief The maximum number of events to return in one epoll cycle
+ *
+ * Below this the batch size tracks the number of registered descriptors, so
+ * every ready descriptor is normally handled by a single epoll_wait().
  */
-const int EPoller::MAX_EVENTS = 10;
+const unsigned int EPoller::MAX_EVENTS = 1024;
 
 
 /**
@@ -140,14 +148,20 @@ const int EPoller::READ_FLAGS = EPOLLIN | EPOLLRDHUP;
 const unsigned int EPoller::MAX_FREE_DESCRIPTORS = 10;
 
 EPoller::EPoller(ExportMap *export_map, Clock* clock)
-    : m_export_map(export_map),
+    : m_descriptor_count(0),
+      m_export_map(export_map),
       m_loop_iterations(NULL),
       m_loop_time(NULL),
+      m_poll_events(NULL),
+      m_poll_wakeups(NULL),
       m_epoll_fd(INVALID_DESCRIPTOR),
-      m_clock(clock) {
+      m_clock(clock),
+      m_events(MIN_EVENTS) {
   if (m_export_map) {
     m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
     m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+    m_poll_events = m_export_map->GetCounterVar(K_POLL_EVENTS);
+    m_poll_wakeups = m_export_map->GetCounterVar(K_POLL_WAKEUPS);
   }
 
   m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
@@ -162,12 +176,12 @@ EPoller::~EPoller() {
   }
 
   {
-    DescriptorMap::iterator iter = m_descriptor_map.begin();
-    for (; iter != m_descriptor_map.end(); ++iter) {
-      if (iter->second->delete_connected_on_close) {
-        delete iter->second->connected_descriptor;
+    DescriptorList::iterator iter = m_descriptors.begin();
+    for (; iter != m_descriptors.end(); ++iter) {
+      if (*iter && (*iter)->delete_connected_on_close) {
+        delete (*iter)->connected_descriptor;
       }
-      delete iter->second;
+      delete *iter;
     }
   }
 
@@ -290,7 +304,6 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
     return false;
   }
 
-  epoll_event events[MAX_EVENTS];
   TimeInterval sleep_interval = poll_interval;
   TimeStamp now;
   m_clock->CurrentTime(&now);
@@ -310,9 +323,16 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
       (*m_loop_iterations)++;
   }
 
+  // Size the batch so all the ready descriptors can be returned at once.
+  unsigned int max_events = std::max(
+      MIN_EVENTS, std::min(m_descriptor_count, MAX_EVENTS));
+  if (m_events.size() != max_events) {
+    m_events.resize(max_events);
+  }
+
   int ms_to_sleep = sleep_interval.InMilliSeconds();
-  int ready = epoll_wait(m_epoll_fd, reinterpret_cast<epoll_event*>(&events),
-                         MAX_EVENTS, ms_to_sleep ? ms_to_sleep : 1);
+  int ready = epoll_wait(m_epoll_fd, &m_events[0], max_events,
+                         ms_to_sleep ? ms_to_sleep : 1);
 
   if (ready == 0) {
     m_clock->CurrentTime(&m_wake_up_time);
@@ -327,10 +347,17 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
 
   m_clock->CurrentTime(&m_wake_up_time);
 
+  if (m_poll_events) {
+    (*m_poll_events) += ready;
+  }
+  if (m_poll_wakeups) {
+    (*m_poll_wakeups)++;
+  }
+
   for (int i = 0; i < ready; i++) {
     EPollData *descriptor = reinterpret_cast<EPollData*>(
-        events[i].data.ptr);
-    CheckDescriptor(&events[i], descriptor);
+        m_events[i].data.ptr);
+    CheckDescriptor(&m_events[i], descriptor);
   }
 
   // Now that we're out of the callback phase, clean up descriptors that were
@@ -361,9 +388,9 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
                               EPollData *epoll_data) {
   if (event->events & (EPOLLHUP | EPOLLRDHUP)) {
     if (epoll_data->read_descriptor) {
-      epoll_data->read_descriptor->PerformRead();
+      PerformRead(epoll_data->read_descriptor);
     } else if (epoll_data->write_descriptor) {
-      epoll_data->write_descriptor->PerformWrite();
+      PerformWrite(epoll_data->write_descriptor);
     } else if (epoll_data->connected_descriptor) {
       ConnectedDescriptor::OnCloseCallback *on_close =
           epoll_data->connected_descriptor->TransferOnClose();
@@ -392,9 +419,9 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
 
   if (event->events & EPOLLIN) {
     if (epoll_data->read_descriptor) {
-      epoll_data->read_descriptor->PerformRead();
+      PerformRead(epoll_data->read_descriptor);
     } else if (epoll_data->connected_descriptor) {
-      epoll_data->connected_descriptor->PerformRead();
+      PerformRead(epoll_data->connected_descriptor);
     }
   }
 
@@ -402,25 +429,36 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
     // epoll_data->write_descriptor may be null here if this descriptor was
     // removed between when kevent returned and now.
     if (epoll_data->write_descriptor) {
-      epoll_data->write_descriptor->PerformWrite();
+      PerformWrite(epoll_data->write_descriptor);
     }
   }
 }
 
 std::pair<EPollData*, bool> EPoller::LookupOrCreateDescriptor(int fd) {
-  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
-      DescriptorMap::value_type(fd, NULL));
-  bool new_descriptor = result.second;
+  if (static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    m_descriptors.resize(fd + 1, NULL);
+  }
 
-  if (new_descriptor) {
-    if (m_free_descriptors.empty()) {
-      result.first->second = new EPollData();
-    } else {
-      result.first->second = m_free_descriptors.back();
-      m_free_descriptors.pop_back();
-    }
+  EPollData *&epoll_data = m_descriptors[fd];
+  if (epoll_data) {
+    return std::make_pair(epoll_data, false);
+  }
+
+  if (m_free_descriptors.empty()) {
+    epoll_data = new EPollData();
+  } else {
+    epoll_data = m_free_descriptors.back();
+    m_free_descriptors.pop_back();
+  }
+  m_descriptor_count++;
+  return std::make_pair(epoll_data, true);
+}
+
+EPollData *EPoller::LookupDescriptor(int fd) const {
+  if (fd < 0 || static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    return NULL;
   }
-  return std::make_pair(result.first->second, new_descriptor);
+  return m_descriptors[fd];
 }
 
 bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
@@ -429,7 +467,7 @@ bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
     return false;
   }
 
-  EPollData *epoll_data = STLFindOrNull(m_descriptor_map, fd);
+  EPollData *epoll_data = LookupDescriptor(fd);
   if (!epoll_data) {
     if (warn_on_missing) {
       OLA_WARN << "Couldn't find EPollData for " << fd;
@@ -448,8 +486,9 @@ bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
 
   if (epoll_data->events == 0) {
     RemoveEvent(m_epoll_fd, fd);
-    m_orphaned_descriptors.push_back(
-        STLLookupAndRemovePtr(&m_descriptor_map, fd));
+    m_orphaned_descriptors.push_back(epoll_data);
+    m_descriptors[fd] = NULL;
+    m_descriptor_count--;
   } else {
     return UpdateEvent(m_epoll_fd, fd, epoll_data);
   }
@@ -27,7 +27,6 @@
 #include <ola/io/Descriptor.h>
 #include <sys/epoll.h>
 
-#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -74,10 +73,12 @@ class EPoller : public PollerInterface {
             const TimeInterval &poll_interval);
 
  private:
-  typedef std::map<int, EPollData*> DescriptorMap;
   typedef std::vector<EPollData*> DescriptorList;
 
-  DescriptorMap m_descriptor_map;
+  // The EPollData for each registered descriptor, indexed by fd. Unused
+  // entries are NULL.
+  DescriptorList m_descriptors;
+  unsigned int m_descriptor_count;
 
   // EPoller is re-enterant. Remove may be called while we hold a pointer to an
   // EPollData. To avoid deleting data out from underneath ourselves, we
@@ -89,16 +90,22 @@ class EPoller : public PollerInterface {
   ExportMap *m_export_map;
   CounterVariable *m_loop_iterations;
   CounterVariable *m_loop_time;
+  CounterVariable *m_poll_events;
+  CounterVariable *m_poll_wakeups;
   int m_epoll_fd;
   Clock *m_clock;
   TimeStamp m_wake_up_time;
+  // The buffer passed to epoll_wait(), sized by the number of descriptors.
+  std::vector<epoll_event> m_events;
 
   std::pair<EPollData*, bool> LookupOrCreateDescriptor(int fd);
+  EPollData *LookupDescriptor(int fd) const;
 
   bool RemoveDescriptor(int fd, int event, bool warn_on_missing);
   void CheckDescriptor(struct epoll_event *event, EPollData *descriptor);
 
-  static const int MAX_EVENTS;
+  static const unsigned int MIN_EVENTS;
+  static const unsigned int MAX_EVENTS;
   static const int READ_FLAGS;
   static const unsigned int MAX_FREE_DESCRIPTORS;
 
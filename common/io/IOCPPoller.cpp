@@ -0,0 +1,874 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOCPPoller.cpp
+ * A Poller which uses I/O completion ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/IOCPPoller.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define VC_EXTRALEAN
+#include <ola/win/CleanWinSock2.h>
+#include <winternl.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace io {
+
+using std::pair;
+
+namespace {
+
+// AFD is the driver behind WinSock. An IOCTL_AFD_POLL request is what
+// select() and WSAPoll() are built on, but unlike them it can complete on a
+// completion port. These definitions match the ones used by libuv and wepoll.
+const ULONG AFD_POLL_RECEIVE = 0x0001;
+const ULONG AFD_POLL_SEND = 0x0004;
+const ULONG AFD_POLL_DISCONNECT = 0x0008;
+const ULONG AFD_POLL_ABORT = 0x0010;
+const ULONG AFD_POLL_LOCAL_CLOSE = 0x0020;
+const ULONG AFD_POLL_ACCEPT = 0x0080;
+const ULONG AFD_POLL_CONNECT_FAIL = 0x0100;
+const DWORD IOCTL_AFD_POLL = 0x00012024;
+
+const ULONG AFD_READ_EVENTS = AFD_POLL_RECEIVE | AFD_POLL_ACCEPT |
+                              AFD_POLL_DISCONNECT | AFD_POLL_ABORT;
+const ULONG AFD_WRITE_EVENTS = AFD_POLL_SEND | AFD_POLL_CONNECT_FAIL;
+const ULONG AFD_CLOSE_EVENTS = AFD_POLL_DISCONNECT | AFD_POLL_ABORT;
+
+// FILE_OPEN from the DDK.
+const ULONG AFD_FILE_OPEN = 1;
+
+#ifndef SIO_BASE_HANDLE
+const DWORD SIO_BASE_HANDLE = 0x48000022;
+#endif  // SIO_BASE_HANDLE
+
+struct AFDPollHandleInfo {
+  HANDLE handle;
+  ULONG events;
+  NTSTATUS status;
+};
+
+struct AFDPollInfo {
+  LARGE_INTEGER timeout;
+  ULONG number_of_handles;
+  ULONG exclusive;
+  AFDPollHandleInfo handles[1];
+};
+
+typedef NTSTATUS (NTAPI *NtCreateFileFunction)(
+    PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES, PIO_STATUS_BLOCK,
+    PLARGE_INTEGER, ULONG, ULONG, ULONG, ULONG, PVOID, ULONG);
+
+/*
+ * Open a handle to the AFD device. There isn't a Win32 call for this, so
+ * NtCreateFile() is looked up in ntdll.
+ */
+HANDLE OpenAFD() {
+  HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+  NtCreateFileFunction nt_create_file = NULL;
+  if (ntdll) {
+    nt_create_file = reinterpret_cast<NtCreateFileFunction>(
+        GetProcAddress(ntdll, "NtCreateFile"));
+  }
+  if (!nt_create_file) {
+    OLA_WARN << "Failed to find NtCreateFile";
+    return NULL;
+  }
+
+  // Anything after \Device\Afd\ is ignored by the driver.
+  wchar_t name[] = L"\\Device\\Afd\\OLA";
+  UNICODE_STRING device_name;
+  device_name.Buffer = name;
+  device_name.Length = sizeof(name) - sizeof(name[0]);
+  device_name.MaximumLength = sizeof(name);
+
+  OBJECT_ATTRIBUTES attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.Length = sizeof(attributes);
+  attributes.ObjectName = &device_name;
+
+  IO_STATUS_BLOCK status_block;
+  HANDLE afd = NULL;
+  NTSTATUS status = nt_create_file(&afd, SYNCHRONIZE, &attributes,
+                                   &status_block, NULL, 0,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                   AFD_FILE_OPEN, 0, NULL, 0);
+  if (status != 0) {
+    OLA_WARN << "Failed to open the AFD device, status "
+             << static_cast<uint32_t>(status);
+    return NULL;
+  }
+  return afd;
+}
+
+/*
+ * Layered service providers can wrap sockets, the AFD poll needs the
+ * underlying socket.
+ */
+HANDLE BaseSocket(SOCKET socket) {
+  SOCKET base = INVALID_SOCKET;
+  DWORD bytes = 0;
+  if (WSAIoctl(socket, SIO_BASE_HANDLE, NULL, 0, &base, sizeof(base), &bytes,
+               NULL, NULL) == SOCKET_ERROR) {
+    return reinterpret_cast<HANDLE>(socket);
+  }
+  return reinterpret_cast<HANDLE>(base);
+}
+}  // namespace
+
+static const int FLAG_READ = 1;
+static const int FLAG_WRITE = 2;
+
+/*
+ * Represents a handle, and its outstanding request.
+ */
+class IOCPData {
+ public:
+  IOCPData()
+      : handle(NULL),
+        type(GENERIC_DESCRIPTOR),
+        flags(0),
+        read_descriptor(NULL),
+        write_descriptor(NULL),
+        connected_descriptor(NULL),
+        delete_connected_on_close(false),
+        pending(false),
+        removed(false),
+        associated(false),
+        broken(false),
+        closed(false),
+        base_socket(NULL),
+        poll_events(0) {
+    memset(&overlapped, 0, sizeof(overlapped));
+    memset(&poll_info, 0, sizeof(poll_info));
+  }
+
+  void *handle;
+  DescriptorType type;
+  int flags;
+  ReadFileDescriptor *read_descriptor;
+  WriteFileDescriptor *write_descriptor;
+  ConnectedDescriptor *connected_descriptor;
+  bool delete_connected_on_close;
+
+  // The outstanding request, an AFD poll for sockets or a ReadFile() for
+  // pipes.
+  OVERLAPPED overlapped;
+  bool pending;
+  // Set once the descriptor has been removed from the poller.
+  bool removed;
+  // True if the pipe has been associated with the completion port.
+  bool associated;
+  // True if the pipe's remote end has closed, but Close() hasn't run yet.
+  bool broken;
+  // True once Close() has run for the pipe.
+  bool closed;
+
+  HANDLE base_socket;
+  // The events the outstanding AFD poll is waiting for.
+  ULONG poll_events;
+  AFDPollInfo poll_info;
+
+  uint8_t buffer[ASYNC_DATA_BUFFER_SIZE];
+
+  DescriptorHandle ReadHandle() const {
+    return connected_descriptor ? connected_descriptor->ReadDescriptor() :
+        read_descriptor->ReadDescriptor();
+  }
+};
+
+const unsigned int IOCPPoller::MAX_COMPLETIONS = 64;
+
+IOCPPoller::IOCPPoller(ExportMap *export_map, Clock *clock)
+    : m_port(NULL),
+      m_afd(NULL),
+      m_export_map(export_map),
+      m_loop_iterations(NULL),
+      m_loop_time(NULL),
+      m_poll_events(NULL),
+      m_poll_wakeups(NULL),
+      m_clock(clock) {
+  if (m_export_map) {
+    m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
+    m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+    m_poll_events = m_export_map->GetCounterVar(K_POLL_EVENTS);
+    m_poll_wakeups = m_export_map->GetCounterVar(K_POLL_WAKEUPS);
+  }
+}
+
+IOCPPoller::~IOCPPoller() {
+  DescriptorList descriptors(m_orphaned_descriptors);
+  descriptors.insert(descriptors.end(), m_cancelled_descriptors.begin(),
+                     m_cancelled_descriptors.end());
+  DescriptorMap::iterator map_iter = m_descriptor_map.begin();
+  for (; map_iter != m_descriptor_map.end(); ++map_iter) {
+    if (map_iter->second->delete_connected_on_close) {
+      delete map_iter->second->connected_descriptor;
+    }
+    descriptors.push_back(map_iter->second);
+  }
+
+  unsigned int pending = 0;
+  DescriptorList::iterator iter = descriptors.begin();
+  for (; iter != descriptors.end(); ++iter) {
+    if ((*iter)->pending) {
+      Cancel(*iter);
+      pending++;
+    }
+  }
+
+  // The kernel writes to the buffers until the cancelled requests complete,
+  // so wait for them before the buffers are deleted.
+  OVERLAPPED_ENTRY entries[MAX_COMPLETIONS];
+  for (unsigned int i = 0; pending && i < 10; i++) {
+    ULONG count = 0;
+    if (!GetQueuedCompletionStatusEx(m_port, entries, MAX_COMPLETIONS, &count,
+                                     100, FALSE)) {
+      continue;
+    }
+    for (ULONG j = 0; j < count; j++) {
+      IOCPData *data = CONTAINING_RECORD(entries[j].lpOverlapped, IOCPData,
+                                         overlapped);
+      if (data->pending) {
+        data->pending = false;
+        pending--;
+      }
+    }
+  }
+
+  if (pending) {
+    OLA_WARN << pending << " requests didn't complete, leaking them";
+  }
+  for (iter = descriptors.begin(); iter != descriptors.end(); ++iter) {
+    if (!(*iter)->pending) {
+      delete *iter;
+    }
+  }
+
+  if (m_afd) {
+    CloseHandle(m_afd);
+  }
+  if (m_port) {
+    CloseHandle(m_port);
+  }
+}
+
+bool IOCPPoller::Init() {
+  if (m_port) {
+    return true;
+  }
+
+  HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+  if (!port) {
+    OLA_WARN << "CreateIoCompletionPort failed with " << GetLastError();
+    return false;
+  }
+
+  HANDLE afd = OpenAFD();
+  if (!afd) {
+    CloseHandle(port);
+    return false;
+  }
+
+  if (!CreateIoCompletionPort(afd, port, 0, 0)) {
+    OLA_WARN << "Failed to associate the AFD device with the completion "
+             << "port: " << GetLastError();
+    CloseHandle(afd);
+    CloseHandle(port);
+    return false;
+  }
+  // Only the completion port is waited on, so don't signal the handle too.
+  SetFileCompletionNotificationModes(afd, FILE_SKIP_SET_EVENT_ON_HANDLE);
+
+  m_port = port;
+  m_afd = afd;
+  return true;
+}
+
+bool IOCPPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (!m_port) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOCPData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+  if (!result.first) {
+    return false;
+  }
+  if (result.first->flags & FLAG_READ) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->flags |= FLAG_READ;
+  result.first->read_descriptor = descriptor;
+  if (!Arm(result.first)) {
+    RemoveDescriptor(descriptor->ReadDescriptor(), FLAG_READ, false);
+    return false;
+  }
+  return true;
+}
+
+bool IOCPPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
+                                   bool delete_on_close) {
+  if (!m_port) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOCPData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+  if (!result.first) {
+    return false;
+  }
+  if (result.first->flags & FLAG_READ) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->flags |= FLAG_READ;
+  result.first->connected_descriptor = descriptor;
+  result.first->delete_connected_on_close = delete_on_close;
+  if (!Arm(result.first)) {
+    RemoveDescriptor(descriptor->ReadDescriptor(), FLAG_READ, false);
+    return false;
+  }
+  return true;
+}
+
+bool IOCPPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), FLAG_READ, true);
+}
+
+bool IOCPPoller::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), FLAG_READ, true);
+}
+
+bool IOCPPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (!m_port) {
+    return false;
+  }
+
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "AddWriteDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOCPData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->WriteDescriptor());
+  if (!result.first) {
+    return false;
+  }
+  if (result.first->flags & FLAG_WRITE) {
+    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
+             << " already in write set";
+    return false;
+  }
+
+  result.first->flags |= FLAG_WRITE;
+  result.first->write_descriptor = descriptor;
+  if (!Arm(result.first)) {
+    RemoveDescriptor(descriptor->WriteDescriptor(), FLAG_WRITE, false);
+    return false;
+  }
+  return true;
+}
+
+bool IOCPPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->WriteDescriptor(), FLAG_WRITE, true);
+}
+
+bool IOCPPoller::Poll(TimeoutManager *timeout_manager,
+                      const TimeInterval &poll_interval) {
+  if (!m_port) {
+    return false;
+  }
+
+  TimeInterval sleep_interval = poll_interval;
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  if (!next_event_in.IsZero()) {
+    sleep_interval = std::min(next_event_in, sleep_interval);
+  }
+
+  // take care of stats accounting
+  if (m_wake_up_time.IsSet()) {
+    TimeInterval loop_time = now - m_wake_up_time;
+    OLA_DEBUG << "ss process time was " << loop_time.ToString();
+    if (m_loop_time)
+      (*m_loop_time) += loop_time.AsInt();
+    if (m_loop_iterations)
+      (*m_loop_iterations)++;
+  }
+
+  // Pipes that are ready don't have a request to complete, so don't block if
+  // there are any.
+  DWORD ms_to_sleep = PipesReady() ? 0 : sleep_interval.InMilliSeconds();
+
+  bool ok = true;
+  OVERLAPPED_ENTRY entries[MAX_COMPLETIONS];
+  ULONG count = 0;
+  if (!GetQueuedCompletionStatusEx(m_port, entries, MAX_COMPLETIONS, &count,
+                                   ms_to_sleep, FALSE)) {
+    DWORD error = GetLastError();
+    if (error != WAIT_TIMEOUT) {
+      OLA_WARN << "GetQueuedCompletionStatusEx failed with " << error;
+      ok = false;
+    }
+    count = 0;
+  }
+
+  m_clock->CurrentTime(&m_wake_up_time);
+
+  for (ULONG i = 0; i < count; i++) {
+    HandleCompletion(entries[i].lpOverlapped);
+  }
+
+  if (count) {
+    if (m_poll_events) {
+      (*m_poll_events) += count;
+    }
+    if (m_poll_wakeups) {
+      (*m_poll_wakeups)++;
+    }
+  }
+
+  CheckPipes();
+
+  // Now that we're out of the callback phase, clean up descriptors that were
+  // removed. Those with a request outstanding are deleted once it completes.
+  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
+  for (; iter != m_orphaned_descriptors.end(); ++iter) {
+    if ((*iter)->pending) {
+      m_cancelled_descriptors.insert(*iter);
+    } else {
+      delete *iter;
+    }
+  }
+  m_orphaned_descriptors.clear();
+
+  m_clock->CurrentTime(&m_wake_up_time);
+  timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+  return ok;
+}
+
+pair<IOCPData*, bool> IOCPPoller::LookupOrCreateDescriptor(
+    const DescriptorHandle &handle) {
+  if (handle.m_type != SOCKET_DESCRIPTOR &&
+      handle.m_type != PIPE_DESCRIPTOR) {
+    OLA_WARN << "Descriptor type not supported: " << handle.m_type;
+    return std::make_pair(static_cast<IOCPData*>(NULL), false);
+  }
+
+  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
+      DescriptorMap::value_type(ToHandle(handle), NULL));
+  if (!result.second) {
+    return std::make_pair(result.first->second, false);
+  }
+
+  IOCPData *data = new IOCPData();
+  data->handle = ToHandle(handle);
+  data->type = handle.m_type;
+  if (data->type == SOCKET_DESCRIPTOR) {
+    data->base_socket = BaseSocket(static_cast<SOCKET>(ToFD(handle)));
+  } else {
+    m_pipes.push_back(data);
+  }
+  result.first->second = data;
+  return std::make_pair(data, true);
+}
+
+bool IOCPPoller::RemoveDescriptor(const DescriptorHandle &handle,
+                                  int flag,
+                                  bool warn_on_missing) {
+  if (!handle.IsValid()) {
+    OLA_WARN << "Attempt to remove an invalid file descriptor";
+    return false;
+  }
+
+  IOCPData *data = STLFindOrNull(m_descriptor_map, ToHandle(handle));
+  if (!data) {
+    if (warn_on_missing) {
+      OLA_WARN << "Couldn't find IOCPData for " << handle;
+    }
+    return false;
+  }
+
+  if (flag & FLAG_READ) {
+    data->connected_descriptor = NULL;
+    data->read_descriptor = NULL;
+  } else if (flag & FLAG_WRITE) {
+    data->write_descriptor = NULL;
+  }
+  data->flags &= ~flag;
+
+  if (data->flags == 0) {
+    Cancel(data);
+    data->removed = true;
+    m_descriptor_map.erase(ToHandle(handle));
+    if (data->type == PIPE_DESCRIPTOR) {
+      m_pipes.erase(std::remove(m_pipes.begin(), m_pipes.end(), data),
+                    m_pipes.end());
+    }
+    m_orphaned_descriptors.push_back(data);
+    return true;
+  }
+  return Arm(data);
+}
+
+bool IOCPPoller::Arm(IOCPData *data) {
+  if (data->type == SOCKET_DESCRIPTOR) {
+    return ArmSocket(data);
+  }
+  return ArmPipe(data);
+}
+
+/*
+ * Start an AFD poll for the socket's events. If a poll for other events is
+ * outstanding it's cancelled, and the new poll starts once the cancel
+ * completes.
+ */
+bool IOCPPoller::ArmSocket(IOCPData *data) {
+  // Always poll for a local close, otherwise a request for a socket that's
+  // closed before it's removed never completes.
+  ULONG events = AFD_POLL_LOCAL_CLOSE;
+  if (data->flags & FLAG_READ) {
+    events |= AFD_READ_EVENTS;
+  }
+  if (data->flags & FLAG_WRITE) {
+    events |= AFD_WRITE_EVENTS;
+  }
+
+  if (data->pending) {
+    if (data->poll_events != events) {
+      Cancel(data);
+    }
+    return true;
+  }
+
+  memset(&data->overlapped, 0, sizeof(data->overlapped));
+  data->poll_info.timeout.QuadPart = 0x7fffffffffffffffLL;
+  data->poll_info.number_of_handles = 1;
+  data->poll_info.exclusive = FALSE;
+  data->poll_info.handles[0].handle = data->base_socket;
+  data->poll_info.handles[0].events = events;
+  data->poll_info.handles[0].status = 0;
+
+  if (!DeviceIoControl(m_afd, IOCTL_AFD_POLL,
+                       &data->poll_info, sizeof(data->poll_info),
+                       &data->poll_info, sizeof(data->poll_info),
+                       NULL, &data->overlapped)) {
+    DWORD error = GetLastError();
+    if (error != ERROR_IO_PENDING) {
+      OLA_WARN << "AFD poll for " << data->handle << " failed with " << error;
+      return false;
+    }
+  }
+  data->poll_events = events;
+  data->pending = true;
+  return true;
+}
+
+/*
+ * Start an overlapped read on the pipe, for no more than will fit in the
+ * descriptor's async buffer.
+ */
+bool IOCPPoller::ArmPipe(IOCPData *data) {
+  if (data->pending || data->broken || data->closed ||
+      !(data->flags & FLAG_READ)) {
+    return true;
+  }
+
+  DescriptorHandle handle = data->ReadHandle();
+  if (!handle.m_async_data_size) {
+    OLA_WARN << "No async data buffer for descriptor " << handle;
+    return false;
+  }
+
+  DWORD size = ASYNC_DATA_BUFFER_SIZE - *handle.m_async_data_size;
+  if (size == 0) {
+    // CheckPipes() starts the read once the buffer has been drained.
+    return true;
+  }
+
+  if (!data->associated) {
+    // A handle can only be associated once, so if it was registered with us
+    // before this fails, which is fine.
+    if (!CreateIoCompletionPort(data->handle, m_port, 0, 0) &&
+        GetLastError() != ERROR_INVALID_PARAMETER) {
+      OLA_WARN << "Failed to associate " << handle
+               << " with the completion port: " << GetLastError();
+      return false;
+    }
+    data->associated = true;
+  }
+
+  memset(&data->overlapped, 0, sizeof(data->overlapped));
+  if (!ReadFile(data->handle, data->buffer, size, NULL, &data->overlapped)) {
+    DWORD error = GetLastError();
+    if (error == ERROR_BROKEN_PIPE) {
+      // No completion is queued for this, so CheckPipes() runs the close.
+      OLA_DEBUG << "Broken pipe: " << handle;
+      data->broken = true;
+      return true;
+    } else if (error != ERROR_IO_PENDING) {
+      OLA_WARN << "ReadFile failed with " << error << " for " << handle;
+      return false;
+    }
+  }
+  data->pending = true;
+  return true;
+}
+
+void IOCPPoller::Cancel(IOCPData *data) {
+  if (data->pending) {
+    CancelIoEx(data->type == SOCKET_DESCRIPTOR ? m_afd : data->handle,
+               &data->overlapped);
+  }
+}
+
+void IOCPPoller::HandleCompletion(OVERLAPPED *overlapped) {
+  IOCPData *data = CONTAINING_RECORD(overlapped, IOCPData, overlapped);
+  data->pending = false;
+
+  if (data->removed) {
+    // If it's still in the orphan list, it's deleted at the end of Poll().
+    if (m_cancelled_descriptors.erase(data)) {
+      delete data;
+    }
+    return;
+  }
+
+  DWORD bytes_transferred = 0;
+  DWORD error = ERROR_SUCCESS;
+  HANDLE handle = data->type == SOCKET_DESCRIPTOR ? m_afd : data->handle;
+  if (!GetOverlappedResult(handle, overlapped, &bytes_transferred, FALSE)) {
+    error = GetLastError();
+  }
+
+  if (data->type == SOCKET_DESCRIPTOR) {
+    HandleSocketCompletion(data, error);
+  } else {
+    HandlePipeCompletion(data, error, bytes_transferred);
+  }
+}
+
+/*
+ * Run the callbacks for a completed AFD poll, then start the next poll.
+ */
+void IOCPPoller::HandleSocketCompletion(IOCPData *data, DWORD error) {
+  if (error == ERROR_OPERATION_ABORTED) {
+    // The poll was cancelled to change the events.
+    ArmSocket(data);
+    return;
+  } else if (error != ERROR_SUCCESS) {
+    OLA_WARN << "AFD poll for " << data->handle << " failed with " << error;
+    return;
+  }
+
+  const ULONG events = data->poll_info.handles[0].events;
+  if (events & AFD_POLL_LOCAL_CLOSE) {
+    OLA_WARN << "Socket " << data->handle << " was closed before it was "
+             << "removed";
+    return;
+  }
+
+  if ((events & AFD_CLOSE_EVENTS) && data->connected_descriptor) {
+    // Read anything that arrived before the close.
+    if (events & AFD_POLL_RECEIVE) {
+      PerformRead(data->connected_descriptor);
+    }
+    // The read callback may have removed the descriptor.
+    if (data->connected_descriptor) {
+      Close(data);
+    }
+  } else {
+    if (events & AFD_READ_EVENTS) {
+      if (data->read_descriptor) {
+        PerformRead(data->read_descriptor);
+      } else if (data->connected_descriptor) {
+        PerformRead(data->connected_descriptor);
+      }
+    }
+
+    // data->write_descriptor may be null here if this descriptor was
+    // removed by the read callback.
+    if ((events & AFD_WRITE_EVENTS) && data->write_descriptor) {
+      PerformWrite(data->write_descriptor);
+    }
+  }
+
+  if (!data->removed) {
+    ArmSocket(data);
+  }
+}
+
+/*
+ * Copy the data from a completed read to the descriptor's async buffer, run
+ * the callback, then start the next read.
+ */
+void IOCPPoller::HandlePipeCompletion(IOCPData *data, DWORD error,
+                                      DWORD bytes_transferred) {
+  if (error == ERROR_BROKEN_PIPE) {
+    OLA_DEBUG << "Broken pipe: " << data->handle;
+    data->broken = true;
+    Close(data);
+    return;
+  } else if (error != ERROR_SUCCESS && error != ERROR_OPERATION_ABORTED) {
+    OLA_WARN << "ReadFile failed with " << error << " for " << data->handle;
+    return;
+  }
+
+  if (bytes_transferred && (data->flags & FLAG_READ)) {
+    // The read was sized to fit, so this can't overflow.
+    DescriptorHandle handle = data->ReadHandle();
+    memcpy(handle.m_async_data + *handle.m_async_data_size, data->buffer,
+           bytes_transferred);
+    *handle.m_async_data_size += bytes_transferred;
+
+    if (data->connected_descriptor) {
+      PerformRead(data->connected_descriptor);
+    } else {
+      PerformRead(data->read_descriptor);
+    }
+  }
+
+  if (!data->removed) {
+    ArmPipe(data);
+  }
+}
+
+/*
+ * Returns true if any pipes can be handled without waiting.
+ */
+bool IOCPPoller::PipesReady() const {
+  DescriptorList::const_iterator iter = m_pipes.begin();
+  for (; iter != m_pipes.end(); ++iter) {
+    const IOCPData *data = *iter;
+    if (data->broken || (data->flags & FLAG_WRITE)) {
+      return true;
+    }
+    if ((data->flags & FLAG_READ) &&
+        *data->ReadHandle().m_async_data_size > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Handle the pipes that don't have a request to complete:
+ *  - Pipes can always be written to, so call PerformWrite().
+ *  - Call PerformRead() while there's data left in the async buffer.
+ *  - Close pipes that broke when the read was started.
+ */
+void IOCPPoller::CheckPipes() {
+  // The callbacks may add or remove pipes. Removed pipes aren't deleted until
+  // the end of Poll().
+  DescriptorList pipes(m_pipes);
+  DescriptorList::iterator iter = pipes.begin();
+  for (; iter != pipes.end(); ++iter) {
+    IOCPData *data = *iter;
+    if (data->removed) {
+      continue;
+    }
+
+    if (data->broken) {
+      Close(data);
+      continue;
+    }
+
+    if ((data->flags & FLAG_READ) &&
+        *data->ReadHandle().m_async_data_size > 0) {
+      if (data->connected_descriptor) {
+        PerformRead(data->connected_descriptor);
+      } else {
+        PerformRead(data->read_descriptor);
+      }
+    }
+
+    if (data->write_descriptor) {
+      PerformWrite(data->write_descriptor);
+    }
+
+    if (!data->removed) {
+      ArmPipe(data);
+    }
+  }
+}
+
+/*
+ * Run the OnClose handler for a descriptor whose remote end has closed.
+ */
+void IOCPPoller::Close(IOCPData *data) {
+  if (data->connected_descriptor) {
+    ConnectedDescriptor::OnCloseCallback *on_close =
+        data->connected_descriptor->TransferOnClose();
+    if (on_close)
+      on_close->Run();
+
+    // At this point the descriptor may be sitting in the orphan list if the
+    // OnClose handler called into RemoveReadDescriptor()
+    if (data->delete_connected_on_close && data->connected_descriptor) {
+      ConnectedDescriptor *descriptor = data->connected_descriptor;
+      bool removed = RemoveDescriptor(descriptor->ReadDescriptor(), FLAG_READ,
+                                      false);
+      if (removed && m_export_map) {
+        (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
+      }
+      delete descriptor;
+    }
+  } else if (data->read_descriptor) {
+    // Let the descriptor find out it's been closed, it's up to the owner to
+    // remove it.
+    PerformRead(data->read_descriptor);
+  }
+
+  // Pipes stay broken, so don't read or close them again.
+  if (data->broken) {
+    data->broken = false;
+    data->closed = true;
+  }
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,147 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOCPPoller.h
+ * A Poller which uses I/O completion ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_IOCPPOLLER_H_
+#define COMMON_IO_IOCPPOLLER_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <ola/win/CleanWindows.h>
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/TimeoutManager.h"
+
+namespace ola {
+namespace io {
+
+class IOCPData;
+
+/**
+ * @class IOCPPoller
+ * @brief An implementation of PollerInterface that uses an I/O completion
+ *   port.
+ *
+ * Unlike the WindowsPoller, which is limited to 64 handles per
+ * WaitForMultipleObjects() call and rebuilds the handle list on every loop,
+ * each descriptor here has a single outstanding overlapped request, which
+ * completes on the port:
+ *  - Pipes have an overlapped ReadFile() into a buffer, which is copied to
+ *    the descriptor's async buffer when it completes.
+ *  - Sockets have an AFD poll request, which completes when the socket is
+ *    readable, writable or closed. This is the same readiness mechanism
+ *    select() and WSAPoll() use internally, so the descriptors keep their
+ *    non-blocking recv() / send() semantics.
+ *
+ * Requests are re-issued once the callbacks have run, which gives the same
+ * level triggered behaviour as the other pollers.
+ *
+ * Init() returns false if the completion port or the AFD device can't be
+ * opened, in which case the WindowsPoller should be used.
+ */
+class IOCPPoller : public PollerInterface {
+ public :
+  /**
+   * @brief Create a new IOCPPoller.
+   * @param export_map the ExportMap to use
+   * @param clock the Clock to use
+   */
+  IOCPPoller(ExportMap *export_map, Clock *clock);
+
+  ~IOCPPoller();
+
+  /**
+   * @brief Create the completion port and open the AFD device.
+   * @returns false if the completion port can't be used.
+   */
+  bool Init();
+
+  bool AddReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool AddReadDescriptor(class ConnectedDescriptor *descriptor,
+                         bool delete_on_close);
+  bool RemoveReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool RemoveReadDescriptor(class ConnectedDescriptor *descriptor);
+
+  bool AddWriteDescriptor(class WriteFileDescriptor *descriptor);
+  bool RemoveWriteDescriptor(class WriteFileDescriptor *descriptor);
+
+  const TimeStamp *WakeUpTime() const { return &m_wake_up_time; }
+
+  bool Poll(TimeoutManager *timeout_manager,
+            const TimeInterval &poll_interval);
+
+ private:
+  typedef std::map<void*, IOCPData*> DescriptorMap;
+  typedef std::vector<IOCPData*> DescriptorList;
+  typedef std::set<IOCPData*> DescriptorSet;
+
+  HANDLE m_port;
+  HANDLE m_afd;
+  DescriptorMap m_descriptor_map;
+  // Pipes are checked on every loop, for write descriptors and for data
+  // left in the async buffer.
+  DescriptorList m_pipes;
+  // Removed descriptors are kept here until we're out of the callback loop.
+  DescriptorList m_orphaned_descriptors;
+  // Removed descriptors with a request that hasn't completed yet. These are
+  // deleted once the cancelled request completes.
+  DescriptorSet m_cancelled_descriptors;
+  ExportMap *m_export_map;
+  CounterVariable *m_loop_iterations;
+  CounterVariable *m_loop_time;
+  CounterVariable *m_poll_events;
+  CounterVariable *m_poll_wakeups;
+  Clock *m_clock;
+  TimeStamp m_wake_up_time;
+
+  std::pair<IOCPData*, bool> LookupOrCreateDescriptor(
+      const DescriptorHandle &handle);
+  bool RemoveDescriptor(const DescriptorHandle &handle,
+                        int flag,
+                        bool warn_on_missing);
+
+  bool Arm(IOCPData *data);
+  bool ArmSocket(IOCPData *data);
+  bool ArmPipe(IOCPData *data);
+  void Cancel(IOCPData *data);
+
+  void HandleCompletion(OVERLAPPED *overlapped);
+  void HandleSocketCompletion(IOCPData *data, DWORD error);
+  void HandlePipeCompletion(IOCPData *data, DWORD error,
+                            DWORD bytes_transferred);
+  bool PipesReady() const;
+  void CheckPipes();
+  void Close(IOCPData *data);
+
+  static const unsigned int MAX_COMPLETIONS;
+
+  DISALLOW_COPY_AND_ASSIGN(IOCPPoller);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_IOCPPOLLER_H_
@@ -0,0 +1,689 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.cpp
+ * A Poller which uses io_uring
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/IOUringPoller.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace io {
+
+using std::pair;
+
+/*
+ * Represents a FD
+ */
+class IOUringData {
+ public:
+  IOUringData()
+      : fd(INVALID_DESCRIPTOR),
+        events(0),
+        generation(0),
+        armed(false),
+        read_descriptor(NULL),
+        write_descriptor(NULL),
+        connected_descriptor(NULL),
+        delete_connected_on_close(false) {
+  }
+
+  int fd;
+  uint32_t events;
+  // Identifies the outstanding poll request, so that completions from
+  // earlier requests can be ignored.
+  uint32_t generation;
+  bool armed;
+  ReadFileDescriptor *read_descriptor;
+  WriteFileDescriptor *write_descriptor;
+  ConnectedDescriptor *connected_descriptor;
+  bool delete_connected_on_close;
+};
+
+
+/*
+ * A minimal wrapper around the io_uring submission and completion rings.
+ */
+class IOUring {
+ public:
+  IOUring()
+      : m_fd(INVALID_DESCRIPTOR),
+        m_ring(NULL),
+        m_ring_size(0),
+        m_sqes(NULL),
+        m_sqes_size(0),
+        m_sq_head(NULL),
+        m_sq_tail(NULL),
+        m_sq_array(NULL),
+        m_sq_mask(0),
+        m_sq_entries(0),
+        m_cq_head(NULL),
+        m_cq_tail(NULL),
+        m_cq_mask(0),
+        m_cqes(NULL),
+        m_pending(0) {
+  }
+
+  ~IOUring() {
+    if (m_sqes) {
+      munmap(m_sqes, m_sqes_size);
+    }
+    if (m_ring) {
+      munmap(m_ring, m_ring_size);
+    }
+    if (m_fd != INVALID_DESCRIPTOR) {
+      close(m_fd);
+    }
+  }
+
+  bool Init(unsigned int entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      OLA_WARN << "io_uring_setup failed: " << strerror(errno);
+      return false;
+    }
+    m_fd = fd;
+
+    const uint32_t required_features = IORING_FEAT_SINGLE_MMAP |
+                                       IORING_FEAT_EXT_ARG;
+    if ((params.features & required_features) != required_features) {
+      OLA_WARN << "io_uring is missing required features, kernel is too old";
+      return false;
+    }
+
+    m_ring_size = std::max(
+        params.sq_off.array + params.sq_entries * sizeof(unsigned),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    void *ring = mmap(NULL, m_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+      OLA_WARN << "Failed to map io_uring rings: " << strerror(errno);
+      return false;
+    }
+    m_ring = reinterpret_cast<uint8_t*>(ring);
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(NULL, m_sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      OLA_WARN << "Failed to map io_uring SQEs: " << strerror(errno);
+      return false;
+    }
+    m_sqes = reinterpret_cast<io_uring_sqe*>(sqes);
+
+    m_sq_head = reinterpret_cast<unsigned*>(m_ring + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned*>(m_ring + params.sq_off.tail);
+    m_sq_array = reinterpret_cast<unsigned*>(m_ring + params.sq_off.array);
+    m_sq_mask = *reinterpret_cast<unsigned*>(
+        m_ring + params.sq_off.ring_mask);
+    m_sq_entries = params.sq_entries;
+    m_cq_head = reinterpret_cast<unsigned*>(m_ring + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(m_ring + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned*>(
+        m_ring + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(m_ring + params.cq_off.cqes);
+    return true;
+  }
+
+  /*
+   * Return a zeroed SQE, or NULL if the submission queue is full and
+   * couldn't be flushed.
+   */
+  io_uring_sqe *GetSQE() {
+    unsigned tail = *m_sq_tail;
+    if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+      if (!Submit() ||
+          tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >=
+          m_sq_entries) {
+        return NULL;
+      }
+    }
+
+    unsigned index = tail & m_sq_mask;
+    io_uring_sqe *sqe = &m_sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    m_sq_array[index] = index;
+    __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    m_pending++;
+    return sqe;
+  }
+
+  /*
+   * Submit any queued SQEs and wait for at least one completion, or for the
+   * timeout to expire.
+   */
+  bool SubmitAndWait(int timeout_ms) {
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeout_ms / ONE_THOUSAND;
+    ts.tv_nsec = (timeout_ms % ONE_THOUSAND) * ONE_MILLION;
+
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    int r = Enter(m_pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                  &arg, sizeof(arg));
+    if (r < 0) {
+      // ETIME means the timeout expired, EBUSY that the completion queue
+      // needs draining.
+      if (errno == ETIME || errno == EINTR || errno == EBUSY) {
+        return true;
+      }
+      OLA_WARN << "io_uring_enter failed: " << strerror(errno);
+      return false;
+    }
+    Submitted(r);
+    return true;
+  }
+
+  /*
+   * Pop the next completion, returns false if there are none.
+   */
+  bool NextCompletion(uint64_t *user_data, int32_t *result) {
+    unsigned head = *m_cq_head;
+    if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    const io_uring_cqe &cqe = m_cqes[head & m_cq_mask];
+    *user_data = cqe.user_data;
+    *result = cqe.res;
+    __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+ private:
+  int m_fd;
+  uint8_t *m_ring;
+  size_t m_ring_size;
+  io_uring_sqe *m_sqes;
+  size_t m_sqes_size;
+  unsigned *m_sq_head;
+  unsigned *m_sq_tail;
+  unsigned *m_sq_array;
+  unsigned m_sq_mask;
+  unsigned m_sq_entries;
+  unsigned *m_cq_head;
+  unsigned *m_cq_tail;
+  unsigned m_cq_mask;
+  io_uring_cqe *m_cqes;
+  unsigned m_pending;
+
+  int Enter(unsigned int to_submit, unsigned int min_complete,
+            unsigned int flags, void *arg, size_t arg_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, m_fd, to_submit,
+                                    min_complete, flags, arg, arg_size));
+  }
+
+  bool Submit() {
+    int r = Enter(m_pending, 0, 0, NULL, 0);
+    if (r < 0) {
+      OLA_WARN << "io_uring_enter failed: " << strerror(errno);
+      return false;
+    }
+    Submitted(r);
+    return true;
+  }
+
+  void Submitted(int count) {
+    m_pending -= std::min(m_pending, static_cast<unsigned int>(count));
+  }
+
+  static const int ONE_THOUSAND = 1000;
+  static const int ONE_MILLION = 1000000;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUring);
+};
+
+namespace {
+
+/*
+ * Build the user_data for a poll request.
+ */
+uint64_t PollToken(int fd, uint32_t generation) {
+  return (static_cast<uint64_t>(fd) << 32) | generation;
+}
+
+/*
+ * The kernel reads poll32_events as a little endian value.
+ */
+uint32_t PollEvents(uint32_t events) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+  events = (events << 16) | (events >> 16);
+#endif  // __BYTE_ORDER == __BIG_ENDIAN
+  return events;
+}
+}  // namespace
+
+/**
+ * @brief the poll flags used for read descriptors.
+ */
+const uint32_t IOUringPoller::READ_FLAGS = POLLIN | POLLRDHUP;
+
+/**
+ * @brief The size of the submission queue.
+ */
+const unsigned int IOUringPoller::RING_ENTRIES = 256;
+
+IOUringPoller::IOUringPoller(ExportMap *export_map, Clock* clock)
+    : m_export_map(export_map),
+      m_loop_iterations(NULL),
+      m_loop_time(NULL),
+      m_poll_events(NULL),
+      m_poll_wakeups(NULL),
+      m_clock(clock),
+      m_generation(0) {
+  if (m_export_map) {
+    m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
+    m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+    m_poll_events = m_export_map->GetCounterVar(K_POLL_EVENTS);
+    m_poll_wakeups = m_export_map->GetCounterVar(K_POLL_WAKEUPS);
+  }
+}
+
+IOUringPoller::~IOUringPoller() {
+  {
+    DescriptorList::iterator iter = m_descriptors.begin();
+    for (; iter != m_descriptors.end(); ++iter) {
+      if (*iter && (*iter)->delete_connected_on_close) {
+        delete (*iter)->connected_descriptor;
+      }
+      delete *iter;
+    }
+  }
+
+  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
+  for (; iter != m_orphaned_descriptors.end(); ++iter) {
+    if ((*iter)->delete_connected_on_close) {
+      delete (*iter)->connected_descriptor;
+    }
+    delete *iter;
+  }
+}
+
+bool IOUringPoller::Init() {
+  if (m_ring.get()) {
+    return true;
+  }
+
+  std::auto_ptr<IOUring> ring(new IOUring());
+  if (!ring->Init(RING_ENTRIES)) {
+    return false;
+  }
+  m_ring.reset(ring.release());
+  return true;
+}
+
+bool IOUringPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (!m_ring.get()) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+  if (result.first->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->events |= READ_FLAGS;
+  result.first->read_descriptor = descriptor;
+  return Arm(descriptor->ReadDescriptor(), result.first);
+}
+
+bool IOUringPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
+                                      bool delete_on_close) {
+  if (!m_ring.get()) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor());
+
+  if (result.first->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  result.first->events |= READ_FLAGS;
+  result.first->connected_descriptor = descriptor;
+  result.first->delete_connected_on_close = delete_on_close;
+  return Arm(descriptor->ReadDescriptor(), result.first);
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (!m_ring.get()) {
+    return false;
+  }
+
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "AddWriteDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  pair<IOUringData*, bool> result = LookupOrCreateDescriptor(
+      descriptor->WriteDescriptor());
+
+  if (result.first->events & POLLOUT) {
+    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
+             << " already in write set";
+    return false;
+  }
+
+  result.first->events |= POLLOUT;
+  result.first->write_descriptor = descriptor;
+  return Arm(descriptor->WriteDescriptor(), result.first);
+}
+
+bool IOUringPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->WriteDescriptor(), POLLOUT, true);
+}
+
+bool IOUringPoller::Poll(TimeoutManager *timeout_manager,
+                         const TimeInterval &poll_interval) {
+  if (!m_ring.get()) {
+    return false;
+  }
+
+  TimeInterval sleep_interval = poll_interval;
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  if (!next_event_in.IsZero()) {
+    sleep_interval = std::min(next_event_in, sleep_interval);
+  }
+
+  // take care of stats accounting
+  if (m_wake_up_time.IsSet()) {
+    TimeInterval loop_time = now - m_wake_up_time;
+    OLA_DEBUG << "ss process time was " << loop_time.ToString();
+    if (m_loop_time)
+      (*m_loop_time) += loop_time.AsInt();
+    if (m_loop_iterations)
+      (*m_loop_iterations)++;
+  }
+
+  // This submits the poll requests queued since the last iteration, as well
+  // as waiting for completions.
+  int ms_to_sleep = sleep_interval.InMilliSeconds();
+  if (!m_ring->SubmitAndWait(ms_to_sleep ? ms_to_sleep : 1)) {
+    return false;
+  }
+
+  m_clock->CurrentTime(&m_wake_up_time);
+
+  unsigned int events = 0;
+  uint64_t user_data;
+  int32_t result;
+  while (m_ring->NextCompletion(&user_data, &result)) {
+    if (user_data) {
+      events++;
+    }
+    HandleCompletion(user_data, result);
+  }
+
+  if (events) {
+    if (m_poll_events) {
+      (*m_poll_events) += events;
+    }
+    if (m_poll_wakeups) {
+      (*m_poll_wakeups)++;
+    }
+  }
+
+  // Now that we're out of the callback phase, clean up descriptors that were
+  // removed.
+  STLDeleteElements(&m_orphaned_descriptors);
+
+  m_clock->CurrentTime(&m_wake_up_time);
+  timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+  return true;
+}
+
+/*
+ * Handle a completed poll request. Poll requests are one-shot, so once the
+ * callbacks have run the descriptor is re-armed. This gives the same level
+ * triggered behaviour as the other pollers.
+ */
+void IOUringPoller::HandleCompletion(uint64_t user_data, int32_t result) {
+  if (!user_data) {
+    // The completion of a POLL_REMOVE request.
+    return;
+  }
+
+  int fd = static_cast<int>(user_data >> 32);
+  uint32_t generation = static_cast<uint32_t>(user_data);
+  IOUringData *data = LookupDescriptor(fd);
+  if (!data || data->generation != generation) {
+    // A completion for a request that has since been removed or replaced.
+    return;
+  }
+
+  data->armed = false;
+  if (result < 0) {
+    OLA_WARN << "io_uring poll for " << fd << " failed: "
+             << strerror(-result);
+    return;
+  }
+
+  CheckDescriptor(static_cast<uint32_t>(result), data);
+
+  // The callbacks may have removed the descriptor, or re-armed it by changing
+  // the events.
+  data = LookupDescriptor(fd);
+  if (data && !data->armed) {
+    Arm(fd, data);
+  }
+}
+
+
+/*
+ * Check all the registered descriptors:
+ *  - Execute the callback for descriptors with data
+ *  - Excute OnClose if a remote end closed the connection
+ */
+void IOUringPoller::CheckDescriptor(uint32_t events, IOUringData *data) {
+  if (events & (POLLHUP | POLLRDHUP)) {
+    if (data->read_descriptor) {
+      PerformRead(data->read_descriptor);
+    } else if (data->write_descriptor) {
+      PerformWrite(data->write_descriptor);
+    } else if (data->connected_descriptor) {
+      ConnectedDescriptor::OnCloseCallback *on_close =
+          data->connected_descriptor->TransferOnClose();
+      if (on_close)
+        on_close->Run();
+
+      // At this point the descriptor may be sitting in the orphan list if the
+      // OnClose handler called into RemoveReadDescriptor()
+      if (data->delete_connected_on_close && data->connected_descriptor) {
+        bool removed = RemoveDescriptor(
+            data->connected_descriptor->ReadDescriptor(), READ_FLAGS, false);
+        if (removed && m_export_map) {
+          (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
+        }
+        delete data->connected_descriptor;
+        data->connected_descriptor = NULL;
+      }
+    } else {
+      OLA_FATAL << "HUP event for " << data
+                << " but no write or connected descriptor found!";
+    }
+    return;
+  }
+
+  if (events & POLLIN) {
+    if (data->read_descriptor) {
+      PerformRead(data->read_descriptor);
+    } else if (data->connected_descriptor) {
+      PerformRead(data->connected_descriptor);
+    }
+  }
+
+  if (events & POLLOUT) {
+    // data->write_descriptor may be null here if this descriptor was
+    // removed by the read callback.
+    if (data->write_descriptor) {
+      PerformWrite(data->write_descriptor);
+    }
+  }
+}
+
+/*
+ * Queue a poll request for the descriptor's events, replacing any
+ * outstanding request.
+ */
+bool IOUringPoller::Arm(int fd, IOUringData *data) {
+  if (data->armed) {
+    Disarm(data);
+  }
+
+  io_uring_sqe *sqe = m_ring->GetSQE();
+  if (!sqe) {
+    OLA_WARN << "io_uring submission queue full, can't poll " << fd;
+    return false;
+  }
+
+  // Skip 0, it's reserved for POLL_REMOVE requests.
+  if (++m_generation == 0) {
+    m_generation++;
+  }
+  data->generation = m_generation;
+  data->armed = true;
+
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = PollEvents(data->events);
+  sqe->user_data = PollToken(fd, data->generation);
+  return true;
+}
+
+/*
+ * Cancel the outstanding poll request for a descriptor.
+ */
+void IOUringPoller::Disarm(IOUringData *data) {
+  io_uring_sqe *sqe = m_ring->GetSQE();
+  if (sqe) {
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->addr = PollToken(data->fd, data->generation);
+    sqe->user_data = 0;
+  }
+  // Even if the remove couldn't be queued, the generation check means any
+  // completion from the old request is ignored.
+  data->generation = 0;
+  data->armed = false;
+}
+
+std::pair<IOUringData*, bool> IOUringPoller::LookupOrCreateDescriptor(
+    int fd) {
+  if (static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    m_descriptors.resize(fd + 1, NULL);
+  }
+
+  IOUringData *&data = m_descriptors[fd];
+  if (data) {
+    return std::make_pair(data, false);
+  }
+
+  data = new IOUringData();
+  data->fd = fd;
+  return std::make_pair(data, true);
+}
+
+IOUringData *IOUringPoller::LookupDescriptor(int fd) const {
+  if (fd < 0 || static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    return NULL;
+  }
+  return m_descriptors[fd];
+}
+
+bool IOUringPoller::RemoveDescriptor(int fd, uint32_t events,
+                                     bool warn_on_missing) {
+  if (fd == INVALID_DESCRIPTOR) {
+    OLA_WARN << "Attempt to remove an invalid file descriptor";
+    return false;
+  }
+
+  IOUringData *data = LookupDescriptor(fd);
+  if (!data) {
+    if (warn_on_missing) {
+      OLA_WARN << "Couldn't find IOUringData for " << fd;
+    }
+    return false;
+  }
+
+  data->events &= (~events);
+
+  if (events & POLLOUT) {
+    data->write_descriptor = NULL;
+  } else if (events & POLLIN) {
+    data->read_descriptor = NULL;
+    data->connected_descriptor = NULL;
+  }
+
+  if (data->events == 0) {
+    if (data->armed) {
+      Disarm(data);
+    }
+    m_descriptors[fd] = NULL;
+    m_orphaned_descriptors.push_back(data);
+  } else {
+    return Arm(fd, data);
+  }
+  return true;
+}
+}  // namespace io
+}  // namespace ola
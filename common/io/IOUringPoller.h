@@ -0,0 +1,120 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.h
+ * A Poller which uses io_uring
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_IOURINGPOLLER_H_
+#define COMMON_IO_IOURINGPOLLER_H_
+
+#include <ola/base/Macro.h>
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/io/Descriptor.h>
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/TimeoutManager.h"
+
+namespace ola {
+namespace io {
+
+class IOUring;
+class IOUringData;
+
+/**
+ * @class IOUringPoller
+ * @brief An implementation of PollerInterface that uses io_uring.
+ *
+ * Poll requests for every descriptor are queued in the submission ring, and
+ * submitted along with the wait for completions in a single io_uring_enter()
+ * call per loop iteration.
+ *
+ * io_uring requires Linux 5.13 or later. Init() returns false if the kernel
+ * doesn't support it, in which case another poller should be used.
+ */
+class IOUringPoller : public PollerInterface {
+ public :
+  /**
+   * @brief Create a new IOUringPoller.
+   * @param export_map the ExportMap to use
+   * @param clock the Clock to use
+   */
+  IOUringPoller(ExportMap *export_map, Clock *clock);
+
+  ~IOUringPoller();
+
+  /**
+   * @brief Setup the io_uring instance.
+   * @returns false if io_uring isn't available.
+   */
+  bool Init();
+
+  bool AddReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool AddReadDescriptor(class ConnectedDescriptor *descriptor,
+                         bool delete_on_close);
+  bool RemoveReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool RemoveReadDescriptor(class ConnectedDescriptor *descriptor);
+
+  bool AddWriteDescriptor(class WriteFileDescriptor *descriptor);
+  bool RemoveWriteDescriptor(class WriteFileDescriptor *descriptor);
+
+  const TimeStamp *WakeUpTime() const { return &m_wake_up_time; }
+
+  bool Poll(TimeoutManager *timeout_manager,
+            const TimeInterval &poll_interval);
+
+ private:
+  typedef std::vector<IOUringData*> DescriptorList;
+
+  std::auto_ptr<IOUring> m_ring;
+  // The IOUringData for each registered descriptor, indexed by fd. Unused
+  // entries are NULL.
+  DescriptorList m_descriptors;
+  // As with the EPoller, removed descriptors are kept here until we're out of
+  // the callback loop.
+  DescriptorList m_orphaned_descriptors;
+  ExportMap *m_export_map;
+  CounterVariable *m_loop_iterations;
+  CounterVariable *m_loop_time;
+  CounterVariable *m_poll_events;
+  CounterVariable *m_poll_wakeups;
+  Clock *m_clock;
+  TimeStamp m_wake_up_time;
+  uint32_t m_generation;
+
+  std::pair<IOUringData*, bool> LookupOrCreateDescriptor(int fd);
+  IOUringData *LookupDescriptor(int fd) const;
+
+  bool RemoveDescriptor(int fd, uint32_t events, bool warn_on_missing);
+  bool Arm(int fd, IOUringData *data);
+  void Disarm(IOUringData *data);
+  void HandleCompletion(uint64_t user_data, int32_t result);
+  void CheckDescriptor(uint32_t events, IOUringData *descriptor);
+
+  static const uint32_t READ_FLAGS;
+  static const unsigned int RING_ENTRIES;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringPoller);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_IOURINGPOLLER_H_
@@ -77,9 +77,17 @@ class KQueueData {
 };
 
 /**
- * @brief The maximum number of events to return in one epoll cycle
+ * @brief The minimum number of events to return in one kevent cycle
  */
-const int KQueuePoller::MAX_EVENTS = 10;
+const unsigned int KQueuePoller::MIN_EVENTS = 10;
+
+/**
+ * @brief The maximum number of events to return in one kevent cycle
+ *
+ * Below this the batch size tracks the number of registered descriptors, so
+ * every ready descriptor is normally handled by a single kevent().
+ */
+const unsigned int KQueuePoller::MAX_EVENTS = 1024;
 
 /**
  * @brief The number of pre-allocated KQueueData to have.
@@ -87,15 +95,19 @@ const int KQueuePoller::MAX_EVENTS = 10;
 const unsigned int KQueuePoller::MAX_FREE_DESCRIPTORS = 10;
 
 KQueuePoller::KQueuePoller(ExportMap *export_map, Clock* clock)
-    : m_export_map(export_map),
+    : m_descriptor_count(0),
+      m_export_map(export_map),
       m_loop_iterations(NULL),
       m_loop_time(NULL),
+      m_poll_events(NULL),
+      m_poll_wakeups(NULL),
       m_kqueue_fd(INVALID_DESCRIPTOR),
-      m_next_change_entry(0),
       m_clock(clock) {
   if (m_export_map) {
     m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
     m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+    m_poll_events = m_export_map->GetCounterVar(K_POLL_EVENTS);
+    m_poll_wakeups = m_export_map->GetCounterVar(K_POLL_WAKEUPS);
   }
 
   m_kqueue_fd = kqueue();
@@ -110,12 +122,12 @@ KQueuePoller::~KQueuePoller() {
   }
 
   {
-    DescriptorMap::iterator iter = m_descriptor_map.begin();
-    for (; iter != m_descriptor_map.end(); ++iter) {
-      if (iter->second->delete_connected_on_close) {
-        delete iter->second->connected_descriptor;
+    DescriptorList::iterator iter = m_descriptors.begin();
+    for (; iter != m_descriptors.end(); ++iter) {
+      if (*iter && (*iter)->delete_connected_on_close) {
+        delete (*iter)->connected_descriptor;
       }
-      delete iter->second;
+      delete *iter;
     }
   }
 
@@ -152,8 +164,8 @@ bool KQueuePoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
 
   kqueue_data->enable_read = true;
   kqueue_data->read_descriptor = descriptor;
-  return ApplyChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD,
-                     kqueue_data, false);
+  QueueChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD, kqueue_data);
+  return true;
 }
 
 bool KQueuePoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
@@ -181,8 +193,8 @@ bool KQueuePoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
   kqueue_data->enable_read = true;
   kqueue_data->connected_descriptor = descriptor;
   kqueue_data->delete_connected_on_close = delete_on_close;
-  return ApplyChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD,
-                     kqueue_data, false);
+  QueueChange(descriptor->ReadDescriptor(), EVFILT_READ, EV_ADD, kqueue_data);
+  return true;
 }
 
 bool KQueuePoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
@@ -215,8 +227,9 @@ bool KQueuePoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
 
   kqueue_data->enable_write = true;
   kqueue_data->write_descriptor = descriptor;
-  return ApplyChange(descriptor->WriteDescriptor(), EVFILT_WRITE, EV_ADD,
-                     kqueue_data, false);
+  QueueChange(descriptor->WriteDescriptor(), EVFILT_WRITE, EV_ADD,
+              kqueue_data);
+  return true;
 }
 
 bool KQueuePoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
@@ -229,8 +242,6 @@ bool KQueuePoller::Poll(TimeoutManager *timeout_manager,
     return false;
   }
 
-  struct kevent events[MAX_EVENTS];
-
   TimeInterval sleep_interval = poll_interval;
   TimeStamp now;
   m_clock->CurrentTime(&now);
@@ -254,11 +265,23 @@ bool KQueuePoller::Poll(TimeoutManager *timeout_manager,
   sleep_time.tv_sec = sleep_interval.Seconds();
   sleep_time.tv_nsec = sleep_interval.MicroSeconds() * 1000;
 
+  // Size the batch so all the ready descriptors can be returned at once.
+  // Changes that fail are returned as EV_ERROR events, so leave room for
+  // those too, otherwise kevent() stops applying the changes.
+  unsigned int max_events = std::max(
+      MIN_EVENTS, std::min(m_descriptor_count, MAX_EVENTS)) +
+      m_changes.size();
+  if (m_events.size() < max_events) {
+    m_events.resize(max_events);
+  }
+
+  // The queued changes are applied before waiting, even if the wait is
+  // interrupted.
   int ready = kevent(
-      m_kqueue_fd, reinterpret_cast<struct kevent*>(m_change_set),
-      m_next_change_entry, events, MAX_EVENTS, &sleep_time);
+      m_kqueue_fd, m_changes.empty() ? NULL : &m_changes[0],
+      m_changes.size(), &m_events[0], max_events, &sleep_time);
 
-  m_next_change_entry = 0;
+  m_changes.clear();
 
   if (ready == 0) {
     m_clock->CurrentTime(&m_wake_up_time);
@@ -273,12 +296,29 @@ bool KQueuePoller::Poll(TimeoutManager *timeout_manager,
 
   m_clock->CurrentTime(&m_wake_up_time);
 
+  if (m_poll_events) {
+    (*m_poll_events) += ready;
+  }
+  if (m_poll_wakeups) {
+    (*m_poll_wakeups)++;
+  }
+
   for (int i = 0; i < ready; i++) {
-    if (events[i].flags & EV_ERROR) {
-      OLA_WARN << "Error from kqueue on fd: " << events[i].ident << ": "
-               << strerror(events[i].data);
+    struct kevent *event = &m_events[i];
+    if (event->flags & EV_ERROR) {
+      // Closing a descriptor removes its filters, so deleting a filter for
+      // a descriptor that was closed after it was removed fails. That's
+      // fine. The kernel replaces the flags of a failed change with
+      // EV_ERROR, so we can't check for EV_DELETE here. Deletes are the
+      // only changes queued without KQueueData, so use that instead.
+      if (!event->udata &&
+          (event->data == ENOENT || event->data == EBADF)) {
+        continue;
+      }
+      OLA_WARN << "Error from kqueue on fd: " << event->ident << ": "
+               << strerror(event->data);
     } else {
-      CheckDescriptor(&events[i]);
+      CheckDescriptor(event);
     }
   }
 
@@ -311,13 +351,13 @@ void KQueuePoller::CheckDescriptor(struct kevent *event) {
       event->udata);
   if (event->filter == EVFILT_READ) {
     if (kqueue_data->read_descriptor) {
-      kqueue_data->read_descriptor->PerformRead();
+      PerformRead(kqueue_data->read_descriptor);
     } else if (kqueue_data->connected_descriptor) {
       ConnectedDescriptor *connected_descriptor =
           kqueue_data->connected_descriptor;
 
       if (event->data) {
-        connected_descriptor->PerformRead();
+        PerformRead(connected_descriptor);
       } else if (event->flags & EV_EOF) {
         // The remote end closed the descriptor.
         // According to man kevent, closing the descriptor removes it from the
@@ -338,10 +378,13 @@ void KQueuePoller::CheckDescriptor(struct kevent *event) {
         if (kqueue_data->delete_connected_on_close) {
           delete connected_descriptor;
 
-          // Remove from m_descriptor_map if it's still there
-          kqueue_data = STLLookupAndRemovePtr(&m_descriptor_map, event->ident);
+          // Remove from m_descriptors if it's still there
+          int fd = static_cast<int>(event->ident);
+          kqueue_data = LookupDescriptor(fd);
           if (kqueue_data) {
             m_orphaned_descriptors.push_back(kqueue_data);
+            m_descriptors[fd] = NULL;
+            m_descriptor_count--;
             if (m_export_map) {
               (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
             }
@@ -355,48 +398,56 @@ void KQueuePoller::CheckDescriptor(struct kevent *event) {
     // kqueue_data->write_descriptor may be null here if this descriptor was
     // removed between when kevent returned and now.
     if (kqueue_data->write_descriptor) {
-      kqueue_data->write_descriptor->PerformWrite();
+      PerformWrite(kqueue_data->write_descriptor);
     }
   }
 }
 
 std::pair<KQueueData*, bool> KQueuePoller::LookupOrCreateDescriptor(
     int fd) {
-  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
-      DescriptorMap::value_type(fd, NULL));
-  bool new_descriptor = result.second;
+  if (static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    m_descriptors.resize(fd + 1, NULL);
+  }
 
-  if (new_descriptor) {
-    if (m_free_descriptors.empty()) {
-      result.first->second = new KQueueData();
-    } else {
-      result.first->second = m_free_descriptors.back();
-      m_free_descriptors.pop_back();
-    }
+  KQueueData *&kqueue_data = m_descriptors[fd];
+  if (kqueue_data) {
+    return std::make_pair(kqueue_data, false);
+  }
+
+  if (m_free_descriptors.empty()) {
+    kqueue_data = new KQueueData();
+  } else {
+    kqueue_data = m_free_descriptors.back();
+    m_free_descriptors.pop_back();
+  }
+  m_descriptor_count++;
+  return std::make_pair(kqueue_data, true);
+}
+
+KQueueData *KQueuePoller::LookupDescriptor(int fd) const {
+  if (fd < 0 || static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    return NULL;
   }
-  return std::make_pair(result.first->second, new_descriptor);
+  return m_descriptors[fd];
 }
 
-bool KQueuePoller::ApplyChange(int fd, int16_t filter, uint16_t flags,
-                               KQueueData *descriptor,
-                               bool apply_immediately) {
+/*
+ * Queue a change, it's applied by the next call to Poll().
+ *
+ * Changes are applied in order, and before any events are returned, so a
+ * removed filter never returns an event with the old KQueueData, even if the
+ * fd is reused in the meantime.
+ */
+void KQueuePoller::QueueChange(int fd, int16_t filter, uint16_t flags,
+                               KQueueData *descriptor) {
+  struct kevent change;
 #ifdef __NetBSD__
-  EV_SET(&m_change_set[m_next_change_entry++], fd, filter, flags, 0, 0,
+  EV_SET(&change, fd, filter, flags, 0, 0,
          reinterpret_cast<intptr_t>(descriptor));
 #else
-  EV_SET(&m_change_set[m_next_change_entry++], fd, filter, flags, 0, 0,
-         descriptor);
+  EV_SET(&change, fd, filter, flags, 0, 0, descriptor);
 #endif  // __NetBSD__
-
-  if (m_next_change_entry == CHANGE_SET_SIZE || apply_immediately) {
-    int r = kevent(m_kqueue_fd, m_change_set, m_next_change_entry, NULL, 0,
-                   NULL);
-    if (r < 0) {
-      OLA_WARN << "Failed to apply kqueue changes: " << strerror(errno);
-    }
-    m_next_change_entry = 0;
-  }
-  return true;
+  m_changes.push_back(change);
 }
 
 bool KQueuePoller::RemoveDescriptor(int fd, int16_t filter) {
@@ -405,7 +456,7 @@ bool KQueuePoller::RemoveDescriptor(int fd, int16_t filter) {
     return false;
   }
 
-  KQueueData *kqueue_data = STLFindOrNull(m_descriptor_map, fd);
+  KQueueData *kqueue_data = LookupDescriptor(fd);
   if (!kqueue_data) {
     OLA_WARN << "Couldn't find KQueueData for fd " << fd;
     return false;
@@ -428,12 +479,13 @@ bool KQueuePoller::RemoveDescriptor(int fd, int16_t filter) {
   }
 
   if (remove_from_kevent) {
-    ApplyChange(fd, filter, EV_DELETE, NULL, true);
+    QueueChange(fd, filter, EV_DELETE, NULL);
   }
 
   if (!kqueue_data->enable_read && !kqueue_data->enable_write) {
-    m_orphaned_descriptors.push_back(
-        STLLookupAndRemovePtr(&m_descriptor_map, fd));
+    m_orphaned_descriptors.push_back(kqueue_data);
+    m_descriptors[fd] = NULL;
+    m_descriptor_count--;
   }
   return true;
 }
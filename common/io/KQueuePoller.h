@@ -27,9 +27,6 @@
 #include <ola/io/Descriptor.h>
 #include <sys/event.h>
 
-#include <map>
-#include <set>
-#include <string>
 #include <utility>
 #include <vector>
 
@@ -47,6 +44,10 @@ class KQueueData;
  *
  * kevent is more efficient than select() but only BSD-style systems support
  * it.
+ *
+ * Changes to the registered filters are queued, and passed to the kevent()
+ * call in Poll() that waits for events, so each loop iteration makes a single
+ * system call.
  */
 class KQueuePoller : public PollerInterface {
  public :
@@ -74,12 +75,12 @@ class KQueuePoller : public PollerInterface {
             const TimeInterval &poll_interval);
 
  private:
-  enum { CHANGE_SET_SIZE = 10 };
-
-  typedef std::map<int, KQueueData*> DescriptorMap;
   typedef std::vector<KQueueData*> DescriptorList;
 
-  DescriptorMap m_descriptor_map;
+  // The KQueueData for each registered descriptor, indexed by fd. Unused
+  // entries are NULL.
+  DescriptorList m_descriptors;
+  unsigned int m_descriptor_count;
 
   // KQueuePoller is re-enterant. Remove may be called while we hold a pointer
   // to an KQueueData. To avoid deleting data out from underneath
@@ -91,21 +92,27 @@ class KQueuePoller : public PollerInterface {
   ExportMap *m_export_map;
   CounterVariable *m_loop_iterations;
   CounterVariable *m_loop_time;
+  CounterVariable *m_poll_events;
+  CounterVariable *m_poll_wakeups;
   int m_kqueue_fd;
 
-  struct kevent m_change_set[CHANGE_SET_SIZE];
-  unsigned int m_next_change_entry;
+  // The changes to apply in the next call to kevent().
+  std::vector<struct kevent> m_changes;
+  // The buffer passed to kevent(), sized by the number of descriptors.
+  std::vector<struct kevent> m_events;
 
   Clock *m_clock;
   TimeStamp m_wake_up_time;
 
   void CheckDescriptor(struct kevent *event);
   std::pair<KQueueData*, bool> LookupOrCreateDescriptor(int fd);
-  bool ApplyChange(int fd, int16_t filter, uint16_t flags,
-                   KQueueData *kqueue_data, bool apply_immediately);
+  KQueueData *LookupDescriptor(int fd) const;
+  void QueueChange(int fd, int16_t filter, uint16_t flags,
+                   KQueueData *kqueue_data);
   bool RemoveDescriptor(int fd, int16_t filter);
 
-  static const int MAX_EVENTS;
+  static const unsigned int MIN_EVENTS;
+  static const unsigned int MAX_EVENTS;
   static const unsigned int MAX_FREE_DESCRIPTORS;
 
   DISALLOW_COPY_AND_ASSIGN(KQueuePoller);
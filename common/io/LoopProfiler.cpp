@@ -0,0 +1,129 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfiler.cpp
+ * Records where the time in the event loop goes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/LoopProfiler.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "ola/base/Array.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/strings/Format.h"
+
+namespace ola {
+namespace io {
+
+using ola::thread::timeout_id;
+using std::string;
+using std::vector;
+
+namespace {
+/*
+ * The bucket bounds in microseconds. A DMX frame is sent every ~23ms, so
+ * anything in the upper buckets delays output.
+ */
+vector<uint64_t> CallbackBounds() {
+  const uint64_t bounds[] = {
+    10, 50, 100, 500, 1000, 5000, 10000, 25000, 50000, 100000
+  };
+  return vector<uint64_t>(bounds, bounds + arraysize(bounds));
+}
+
+vector<uint64_t> LagBounds() {
+  const uint64_t bounds[] = {
+    100, 500, 1000, 2000, 5000, 10000, 25000, 50000, 100000, 500000
+  };
+  return vector<uint64_t>(bounds, bounds + arraysize(bounds));
+}
+}  // namespace
+
+/**
+ * @brief The time spent in each callback, by owner.
+ */
+const char LoopProfiler::K_CALLBACK_TIME_VAR[] = "ss-callback-time-us";
+
+/**
+ * @brief How late timeouts ran.
+ */
+const char LoopProfiler::K_TIMEOUT_LAG_VAR[] = "ss-timeout-lag-us";
+
+const char LoopProfiler::UNNAMED_TIMEOUT[] = "timeout";
+
+LoopProfiler::LoopProfiler(ExportMap *export_map, Clock *clock)
+    : m_clock(clock),
+      m_callback_time(export_map->GetHistogramMapVar(
+          K_CALLBACK_TIME_VAR, "owner", CallbackBounds())),
+      m_timeout_lag(export_map->GetHistogramVar(K_TIMEOUT_LAG_VAR,
+                                                LagBounds())) {
+}
+
+void LoopProfiler::SetDescriptorName(int fd, const string &name) {
+  m_descriptor_names[fd] = name;
+}
+
+void LoopProfiler::RemoveDescriptorName(int fd) {
+  m_descriptor_names.erase(fd);
+}
+
+void LoopProfiler::SetTimeoutName(timeout_id id, const string &name) {
+  m_timeout_names[id] = name;
+}
+
+void LoopProfiler::RemoveTimeoutName(timeout_id id) {
+  m_timeout_names.erase(id);
+}
+
+TimeStamp LoopProfiler::Now() const {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  return now;
+}
+
+void LoopProfiler::DescriptorDone(int fd, const TimeStamp &start) {
+  DescriptorNames::const_iterator iter = m_descriptor_names.find(fd);
+  if (iter == m_descriptor_names.end()) {
+    Record("fd:" + ola::strings::IntToString(fd), start);
+  } else {
+    Record(iter->second, start);
+  }
+}
+
+void LoopProfiler::TimeoutDone(timeout_id id, const TimeStamp &start) {
+  TimeoutNames::const_iterator iter = m_timeout_names.find(id);
+  Record(iter == m_timeout_names.end() ? UNNAMED_TIMEOUT : iter->second,
+         start);
+}
+
+void LoopProfiler::CallbackDone(const string &name, const TimeStamp &start) {
+  Record(name, start);
+}
+
+void LoopProfiler::TimeoutLag(const TimeStamp &due, const TimeStamp &now) {
+  m_timeout_lag->Observe(now > due ? (now - due).AsInt() : 0);
+}
+
+void LoopProfiler::Record(const string &name, const TimeStamp &start) {
+  const TimeStamp end = Now();
+  m_callback_time->Get(name)->Observe(end > start ? (end - start).AsInt() : 0);
+}
+}  // namespace io
+}  // namespace ola
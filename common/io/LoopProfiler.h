@@ -0,0 +1,137 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * LoopProfiler.h
+ * Records where the time in the event loop goes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_LOOPPROFILER_H_
+#define COMMON_IO_LOOPPROFILER_H_
+
+#include <map>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+namespace io {
+
+/**
+ * @class LoopProfiler
+ * @brief Records where the time in the event loop goes.
+ *
+ * The time taken by each descriptor callback, timeout and RunInLoop()
+ * callback is added to a histogram for its owner. Descriptors are named by
+ * their fd and timeouts by their id, anything without a name is grouped under
+ * "fd:N" or "timeout" respectively.
+ *
+ * The profiler also records how late each timeout ran compared to when it
+ * was due, which shows how far the loop is falling behind.
+ */
+class LoopProfiler {
+ public :
+  /**
+   * @brief Create a new LoopProfiler.
+   * @param export_map the ExportMap to record the histograms in.
+   * @param clock the Clock to use.
+   */
+  LoopProfiler(ola::ExportMap *export_map, Clock *clock);
+
+  /**
+   * @brief Set the name that time spent on a descriptor is recorded under.
+   * @param fd the descriptor's fd.
+   * @param name the name, usually the owner and the purpose of the socket.
+   */
+  void SetDescriptorName(int fd, const std::string &name);
+
+  /**
+   * @brief Remove the name of a descriptor.
+   * @param fd the descriptor's fd.
+   */
+  void RemoveDescriptorName(int fd);
+
+  /**
+   * @brief Set the name that time spent on a timeout is recorded under.
+   * @param id the id of the timeout.
+   * @param name the name.
+   */
+  void SetTimeoutName(ola::thread::timeout_id id, const std::string &name);
+
+  /**
+   * @brief Remove the name of a timeout, this must be called once the
+   *   timeout is cancelled or has fired, since the id may be reused.
+   * @param id the id of the timeout.
+   */
+  void RemoveTimeoutName(ola::thread::timeout_id id);
+
+  /**
+   * @brief The time a callback is starting.
+   */
+  TimeStamp Now() const;
+
+  /**
+   * @brief Record the time spent in a descriptor's callback.
+   * @param fd the descriptor's fd.
+   * @param start the time returned by Now() before the callback ran.
+   */
+  void DescriptorDone(int fd, const TimeStamp &start);
+
+  /**
+   * @brief Record the time spent in a timeout's callback.
+   * @param id the id of the timeout.
+   * @param start the time returned by Now() before the callback ran.
+   */
+  void TimeoutDone(ola::thread::timeout_id id, const TimeStamp &start);
+
+  /**
+   * @brief Record the time spent in some other callback.
+   * @param name the name to record the time under.
+   * @param start the time returned by Now() before the callback ran.
+   */
+  void CallbackDone(const std::string &name, const TimeStamp &start);
+
+  /**
+   * @brief Record how late a timeout ran.
+   * @param due the time the timeout was due.
+   * @param now the time it ran.
+   */
+  void TimeoutLag(const TimeStamp &due, const TimeStamp &now);
+
+  static const char K_CALLBACK_TIME_VAR[];
+  static const char K_TIMEOUT_LAG_VAR[];
+
+ private:
+  typedef std::map<int, std::string> DescriptorNames;
+  typedef std::map<ola::thread::timeout_id, std::string> TimeoutNames;
+
+  Clock *m_clock;
+  HistogramMap *m_callback_time;
+  HistogramVariable *m_timeout_lag;
+  DescriptorNames m_descriptor_names;
+  TimeoutNames m_timeout_names;
+
+  void Record(const std::string &name, const TimeStamp &start);
+
+  static const char UNNAMED_TIMEOUT[];
+
+  DISALLOW_COPY_AND_ASSIGN(LoopProfiler);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_LOOPPROFILER_H_
@@ -1,23 +1,32 @@
 # LIBRARIES
 ##################################################
 common_libolacommon_la_SOURCES += \
+    common/io/CallbackQueue.cpp \
+    common/io/CallbackQueue.h \
     common/io/Descriptor.cpp \
     common/io/ExtendedSerial.cpp \
     common/io/EPoller.h \
     common/io/IOQueue.cpp \
     common/io/IOStack.cpp \
     common/io/IOUtils.cpp \
+    common/io/LoopProfiler.cpp \
+    common/io/LoopProfiler.h \
     common/io/NonBlockingSender.cpp \
     common/io/PollerInterface.cpp \
     common/io/PollerInterface.h \
     common/io/SelectServer.cpp \
     common/io/Serial.cpp \
+    common/io/SharedMemoryBlockPool.cpp \
     common/io/StdinHandler.cpp \
     common/io/TimeoutManager.cpp \
-    common/io/TimeoutManager.h
+    common/io/TimeoutManager.h \
+    common/io/TimerWheel.cpp \
+    common/io/TimerWheel.h
 
 if USING_WIN32
 common_libolacommon_la_SOURCES += \
+    common/io/IOCPPoller.cpp \
+    common/io/IOCPPoller.h \
     common/io/WindowsPoller.cpp \
     common/io/WindowsPoller.h
 else
@@ -32,6 +41,12 @@ common_libolacommon_la_SOURCES += \
     common/io/EPoller.cpp
 endif
 
+if HAVE_IO_URING
+common_libolacommon_la_SOURCES += \
+    common/io/IOUringPoller.h \
+    common/io/IOUringPoller.cpp
+endif
+
 if HAVE_KQUEUE
 common_libolacommon_la_SOURCES += \
     common/io/KQueuePoller.h \
@@ -45,6 +60,7 @@ test_programs += \
     common/io/IOQueueTester \
     common/io/IOStackTester \
     common/io/MemoryBlockTester \
+    common/io/NonBlockingSenderTester \
     common/io/SelectServerTester \
     common/io/StreamTester \
     common/io/TimeoutManagerTester
@@ -61,16 +77,24 @@ common_io_DescriptorTester_SOURCES = common/io/DescriptorTest.cpp
 common_io_DescriptorTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_DescriptorTester_LDADD = $(COMMON_TESTING_LIBS)
 
-common_io_MemoryBlockTester_SOURCES = common/io/MemoryBlockTest.cpp
+common_io_MemoryBlockTester_SOURCES = \
+    common/io/MemoryBlockTest.cpp \
+    common/io/SharedMemoryBlockPoolTest.cpp
 common_io_MemoryBlockTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_MemoryBlockTester_LDADD = $(COMMON_TESTING_LIBS)
 
+common_io_NonBlockingSenderTester_SOURCES = \
+    common/io/NonBlockingSenderTest.cpp
+common_io_NonBlockingSenderTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_io_NonBlockingSenderTester_LDADD = $(COMMON_TESTING_LIBS)
+
 common_io_SelectServerTester_SOURCES = common/io/SelectServerTest.cpp \
                                        common/io/SelectServerThreadTest.cpp
 common_io_SelectServerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_SelectServerTester_LDADD = $(COMMON_TESTING_LIBS)
 
-common_io_TimeoutManagerTester_SOURCES = common/io/TimeoutManagerTest.cpp
+common_io_TimeoutManagerTester_SOURCES = common/io/TimeoutManagerTest.cpp \
+                                         common/io/TimerWheelTest.cpp
 common_io_TimeoutManagerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_TimeoutManagerTester_LDADD = $(COMMON_TESTING_LIBS)
 
@@ -78,3 +102,11 @@ common_io_StreamTester_SOURCES = common/io/InputStreamTest.cpp \
                                  common/io/OutputStreamTest.cpp
 common_io_StreamTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_StreamTester_LDADD = $(COMMON_TESTING_LIBS)
+
+# BENCHMARKS
+##################################################
+benchmark_programs += common/io/TimeoutManagerBenchmark
+
+common_io_TimeoutManagerBenchmark_SOURCES = \
+    common/io/TimeoutManagerBenchmark.cpp
+common_io_TimeoutManagerBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS)
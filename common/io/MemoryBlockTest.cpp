@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
 #include <memory>
 #include <iostream>
 
@@ -34,11 +35,13 @@ class MemoryBlockTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(MemoryBlockTest);
   CPPUNIT_TEST(testAppend);
   CPPUNIT_TEST(testPrepend);
+  CPPUNIT_TEST(testWriteInPlace);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testAppend();
   void testPrepend();
+  void testWriteInPlace();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(MemoryBlockTest);
@@ -120,3 +123,33 @@ void MemoryBlockTest::testPrepend() {
   // now that all data is removed, the block should reset
   OLA_ASSERT_EQ(100u, block.Remaining());
 }
+
+
+/*
+ * Check that writing directly into the free space works.
+ */
+void MemoryBlockTest::testWriteInPlace() {
+  unsigned int size = 10;
+  uint8_t *data = new uint8_t[size];
+  MemoryBlock block(data, size);
+
+  OLA_ASSERT_EQ(data, block.FreeSpace());
+  memset(block.FreeSpace(), 'a', 4);
+  OLA_ASSERT_EQ(4u, block.Extend(4));
+  OLA_ASSERT_EQ(4u, block.Size());
+  OLA_ASSERT_EQ(6u, block.Remaining());
+  OLA_ASSERT_EQ(data + 4, block.FreeSpace());
+
+  // Extending past the end is truncated.
+  OLA_ASSERT_EQ(6u, block.Extend(8));
+  OLA_ASSERT_EQ(size, block.Size());
+  OLA_ASSERT_EQ(0u, block.Remaining());
+
+  // Give back the unused part.
+  OLA_ASSERT_EQ(3u, block.PopBack(3));
+  OLA_ASSERT_EQ(7u, block.Size());
+  OLA_ASSERT_EQ(3u, block.Remaining());
+  OLA_ASSERT_EQ(7u, block.PopBack(20));
+  OLA_ASSERT_TRUE(block.Empty());
+  OLA_ASSERT_EQ(data, block.Data());
+}
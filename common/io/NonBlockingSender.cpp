@@ -21,6 +21,7 @@
 #include "ola/io/IOQueue.h"
 #include "ola/io/IOStack.h"
 #include "ola/io/NonBlockingSender.h"
+#include "ola/stl/STLUtils.h"
 
 namespace ola {
 namespace io {
@@ -30,12 +31,17 @@ const unsigned int NonBlockingSender::DEFAULT_MAX_BUFFER_SIZE = 1024;
 NonBlockingSender::NonBlockingSender(ola::io::ConnectedDescriptor *descriptor,
                                      ola::io::SelectServerInterface *ss,
                                      ola::io::MemoryBlockPool *memory_pool,
-                                     unsigned int max_buffer_size)
+                                     unsigned int max_buffer_size,
+                                     QueuePolicy policy)
   : m_descriptor(descriptor),
     m_ss(ss),
+    m_memory_pool(memory_pool),
     m_output_buffer(memory_pool),
     m_associated(false),
-    m_max_buffer_size(max_buffer_size) {
+    m_max_buffer_size(max_buffer_size),
+    m_policy(policy),
+    m_queued_bytes(0),
+    m_dropped_messages(0) {
   m_descriptor->SetOnWritable(
       ola::NewCallback(this, &NonBlockingSender::PerformWrite));
 }
@@ -45,13 +51,20 @@ NonBlockingSender::~NonBlockingSender() {
     m_ss->RemoveWriteDescriptor(m_descriptor);
   }
   m_descriptor->SetOnWritable(NULL);
+  STLDeleteElements(&m_queue);
 }
 
 bool NonBlockingSender::LimitReached() const {
-  return m_output_buffer.Size() >= m_max_buffer_size;
+  return BufferedBytes() >= m_max_buffer_size;
 }
 
 bool NonBlockingSender::SendMessage(ola::io::IOStack *stack) {
+  if (m_policy != REJECT_NEW) {
+    IOQueue queue(m_memory_pool);
+    stack->MoveToIOQueue(&queue);
+    return QueueMessage(&queue, false, 0);
+  }
+
   if (LimitReached()) {
     return false;
   }
@@ -62,6 +75,10 @@ bool NonBlockingSender::SendMessage(ola::io::IOStack *stack) {
 }
 
 bool NonBlockingSender::SendMessage(IOQueue *queue) {
+  if (m_policy != REJECT_NEW) {
+    return QueueMessage(queue, false, 0);
+  }
+
   if (LimitReached()) {
     return false;
   }
@@ -71,11 +88,94 @@ bool NonBlockingSender::SendMessage(IOQueue *queue) {
   return true;
 }
 
+bool NonBlockingSender::SendMessage(ola::io::IOStack *stack, uint32_t key) {
+  if (m_policy != LATEST_VALUE_WINS) {
+    return SendMessage(stack);
+  }
+  IOQueue queue(m_memory_pool);
+  stack->MoveToIOQueue(&queue);
+  return QueueMessage(&queue, true, key);
+}
+
+bool NonBlockingSender::SendMessage(IOQueue *queue, uint32_t key) {
+  if (m_policy != LATEST_VALUE_WINS) {
+    return SendMessage(queue);
+  }
+  return QueueMessage(queue, true, key);
+}
+
+unsigned int NonBlockingSender::BufferedBytes() const {
+  return m_output_buffer.Size() + m_queued_bytes;
+}
+
+/*
+ * Add a message to the queue, applying the QueuePolicy.
+ */
+bool NonBlockingSender::QueueMessage(IOQueue *data, bool has_key,
+                                     uint32_t key) {
+  if (has_key) {
+    QueuedMessage *existing = STLFindOrNull(m_keyed_messages, key);
+    if (existing) {
+      // Replace the data, the message keeps its place in the queue.
+      m_queued_bytes -= existing->data.Size();
+      existing->data.Clear();
+      existing->data.AppendMove(data);
+      m_queued_bytes += existing->data.Size();
+      m_dropped_messages++;
+      return true;
+    }
+  }
+
+  while (LimitReached() && !m_queue.empty()) {
+    DropOldest();
+  }
+
+  QueuedMessage *message = new QueuedMessage(m_memory_pool);
+  message->data.AppendMove(data);
+  message->has_key = has_key;
+  message->key = key;
+  m_queued_bytes += message->data.Size();
+  m_queue.push_back(message);
+  if (has_key) {
+    m_keyed_messages[key] = message;
+  }
+  AssociateIfRequired();
+  return true;
+}
+
+void NonBlockingSender::DropOldest() {
+  QueuedMessage *message = m_queue.front();
+  m_queue.pop_front();
+  if (message->has_key) {
+    m_keyed_messages.erase(message->key);
+  }
+  m_queued_bytes -= message->data.Size();
+  m_dropped_messages++;
+  delete message;
+}
+
 /*
  * Called when the descriptor is writeable, this does the actual write() call.
  */
 void NonBlockingSender::PerformWrite() {
-  m_descriptor->Send(&m_output_buffer);
+  if (!m_output_buffer.Empty()) {
+    m_descriptor->Send(&m_output_buffer);
+  }
+
+  if (m_output_buffer.Empty() && !m_queue.empty()) {
+    // Hand all the queued messages to the descriptor, from now on they can't
+    // be dropped.
+    MessageQueue::iterator iter = m_queue.begin();
+    for (; iter != m_queue.end(); ++iter) {
+      m_output_buffer.AppendMove(&(*iter)->data);
+      delete *iter;
+    }
+    m_queue.clear();
+    m_keyed_messages.clear();
+    m_queued_bytes = 0;
+    m_descriptor->Send(&m_output_buffer);
+  }
+
   if (m_output_buffer.Empty() && m_associated) {
     m_ss->RemoveWriteDescriptor(m_descriptor);
     m_associated = false;
@@ -86,7 +186,7 @@ void NonBlockingSender::PerformWrite() {
  * Associate our descriptor with the SelectServer if we have data to send.
  */
 void NonBlockingSender::AssociateIfRequired() {
-  if (m_output_buffer.Empty()) {
+  if (m_output_buffer.Empty() && m_queue.empty()) {
     return;
   }
   m_ss->AddWriteDescriptor(m_descriptor);
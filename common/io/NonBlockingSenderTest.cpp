@@ -0,0 +1,159 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * NonBlockingSenderTest.cpp
+ * Test fixture for the NonBlockingSender class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/io/Descriptor.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/MemoryBlockPool.h"
+#include "ola/io/NonBlockingSender.h"
+#include "ola/io/SelectServer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::io::IOQueue;
+using ola::io::LoopbackDescriptor;
+using ola::io::MemoryBlockPool;
+using ola::io::NonBlockingSender;
+using ola::io::SelectServer;
+using std::string;
+
+class NonBlockingSenderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(NonBlockingSenderTest);
+  CPPUNIT_TEST(testRejectNew);
+  CPPUNIT_TEST(testDropOldest);
+  CPPUNIT_TEST(testLatestValueWins);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testRejectNew();
+  void testDropOldest();
+  void testLatestValueWins();
+
+ private:
+  // The SelectServer is never run, the tests trigger the writes.
+  SelectServer m_ss;
+  MemoryBlockPool m_pool;
+  LoopbackDescriptor m_loopback;
+
+  bool Send(NonBlockingSender *sender, const string &data);
+  bool Send(NonBlockingSender *sender, const string &data, uint32_t key);
+  string ReadAll();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NonBlockingSenderTest);
+
+void NonBlockingSenderTest::setUp() {
+  OLA_ASSERT(m_loopback.Init());
+}
+
+void NonBlockingSenderTest::tearDown() {
+  m_loopback.Close();
+}
+
+bool NonBlockingSenderTest::Send(NonBlockingSender *sender,
+                                 const string &data) {
+  IOQueue queue(&m_pool);
+  queue.Write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  return sender->SendMessage(&queue);
+}
+
+bool NonBlockingSenderTest::Send(NonBlockingSender *sender,
+                                 const string &data,
+                                 uint32_t key) {
+  IOQueue queue(&m_pool);
+  queue.Write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  return sender->SendMessage(&queue, key);
+}
+
+string NonBlockingSenderTest::ReadAll() {
+  uint8_t buffer[100];
+  unsigned int data_read = 0;
+  m_loopback.Receive(buffer, sizeof(buffer), data_read);
+  return string(reinterpret_cast<char*>(buffer), data_read);
+}
+
+/*
+ * Check the default policy rejects messages once the limit is reached.
+ */
+void NonBlockingSenderTest::testRejectNew() {
+  NonBlockingSender sender(&m_loopback, &m_ss, &m_pool, 10);
+  OLA_ASSERT_TRUE(Send(&sender, "abcd"));
+  OLA_ASSERT_TRUE(Send(&sender, "efgh"));
+  // The limit is soft, so this one takes us over.
+  OLA_ASSERT_TRUE(Send(&sender, "ijkl"));
+  OLA_ASSERT_TRUE(sender.LimitReached());
+  OLA_ASSERT_FALSE(Send(&sender, "mnop"));
+  OLA_ASSERT_EQ(12u, sender.BufferedBytes());
+  OLA_ASSERT_EQ(0u, sender.DroppedMessages());
+
+  m_loopback.PerformWrite();
+  OLA_ASSERT_EQ(string("abcdefghijkl"), ReadAll());
+  OLA_ASSERT_EQ(0u, sender.BufferedBytes());
+}
+
+/*
+ * Check the oldest messages are dropped once the limit is reached.
+ */
+void NonBlockingSenderTest::testDropOldest() {
+  NonBlockingSender sender(&m_loopback, &m_ss, &m_pool, 10,
+                           NonBlockingSender::DROP_OLDEST);
+  OLA_ASSERT_TRUE(Send(&sender, "abcd"));
+  OLA_ASSERT_TRUE(Send(&sender, "efgh"));
+  OLA_ASSERT_TRUE(Send(&sender, "ijkl"));
+  OLA_ASSERT_TRUE(Send(&sender, "mnop"));
+  OLA_ASSERT_TRUE(Send(&sender, "qrst"));
+  OLA_ASSERT_EQ(3u, sender.QueuedMessages());
+  OLA_ASSERT_EQ(12u, sender.BufferedBytes());
+  OLA_ASSERT_EQ(2u, sender.DroppedMessages());
+
+  m_loopback.PerformWrite();
+  OLA_ASSERT_EQ(string("ijklmnopqrst"), ReadAll());
+  OLA_ASSERT_EQ(0u, sender.QueuedMessages());
+  OLA_ASSERT_EQ(0u, sender.BufferedBytes());
+}
+
+/*
+ * Check keyed messages replace queued messages with the same key.
+ */
+void NonBlockingSenderTest::testLatestValueWins() {
+  NonBlockingSender sender(&m_loopback, &m_ss, &m_pool, 100,
+                           NonBlockingSender::LATEST_VALUE_WINS);
+  OLA_ASSERT_TRUE(Send(&sender, "a1", 1));
+  OLA_ASSERT_TRUE(Send(&sender, "b1", 2));
+  OLA_ASSERT_TRUE(Send(&sender, "--"));
+  OLA_ASSERT_TRUE(Send(&sender, "a2", 1));
+  OLA_ASSERT_TRUE(Send(&sender, "a3", 1));
+  OLA_ASSERT_EQ(3u, sender.QueuedMessages());
+  OLA_ASSERT_EQ(2u, sender.DroppedMessages());
+
+  // The replaced message keeps its place in the queue.
+  m_loopback.PerformWrite();
+  OLA_ASSERT_EQ(string("a3b1--"), ReadAll());
+
+  // Once written, a message with the same key is queued again.
+  OLA_ASSERT_TRUE(Send(&sender, "a4", 1));
+  OLA_ASSERT_EQ(1u, sender.QueuedMessages());
+  m_loopback.PerformWrite();
+  OLA_ASSERT_EQ(string("a4"), ReadAll());
+}
@@ -51,5 +51,40 @@ const char PollerInterface::K_LOOP_TIME[] = "ss-loop-time";
  */
 const char PollerInterface::K_LOOP_COUNT[] = "ss-loop-count";
 
+/**
+ * @brief The number of descriptor events returned by the poller.
+ */
+const char PollerInterface::K_POLL_EVENTS[] = "ss-poll-events";
+
+/**
+ * @brief The number of polls that returned one or more descriptor events.
+ *
+ * Dividing ss-poll-events by this gives the average events per wakeup.
+ */
+const char PollerInterface::K_POLL_WAKEUPS[] = "ss-poll-wakeups";
+
+void PollerInterface::PerformRead(ReadFileDescriptor *descriptor) {
+  if (!m_profiler) {
+    descriptor->PerformRead();
+    return;
+  }
+  // The descriptor may be deleted by the callback.
+  const int fd = ToFD(descriptor->ReadDescriptor());
+  const TimeStamp start = m_profiler->Now();
+  descriptor->PerformRead();
+  m_profiler->DescriptorDone(fd, start);
+}
+
+void PollerInterface::PerformWrite(WriteFileDescriptor *descriptor) {
+  if (!m_profiler) {
+    descriptor->PerformWrite();
+    return;
+  }
+  const int fd = ToFD(descriptor->WriteDescriptor());
+  const TimeStamp start = m_profiler->Now();
+  descriptor->PerformWrite();
+  m_profiler->DescriptorDone(fd, start);
+}
+
 }  // namespace io
 }  // namespace ola
@@ -24,6 +24,7 @@
 #include <ola/Clock.h>
 #include <ola/io/Descriptor.h>
 
+#include "common/io/LoopProfiler.h"
 #include "common/io/TimeoutManager.h"
 
 namespace ola {
@@ -69,11 +70,21 @@ namespace io {
  */
 class PollerInterface {
  public :
+  PollerInterface() : m_profiler(NULL) {}
+
   /**
    * @brief Destructor
    */
   virtual ~PollerInterface() {}
 
+  /**
+   * @brief Set the LoopProfiler to record the time spent in descriptor
+   *   callbacks with.
+   * @param profiler the LoopProfiler to use, ownership is not transferred.
+   *   NULL disables profiling.
+   */
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
   /**
    * @brief Register a ReadFileDescriptor for read events.
    * @param descriptor the ReadFileDescriptor to register. The OnData() method
@@ -145,8 +156,24 @@ class PollerInterface {
   static const char K_CONNECTED_DESCRIPTORS_VAR[];
 
  protected:
+  LoopProfiler *m_profiler;
+
+  /**
+   * @brief Call PerformRead() on a descriptor, recording the time taken if
+   *   profiling is enabled.
+   */
+  void PerformRead(ReadFileDescriptor *descriptor);
+
+  /**
+   * @brief Call PerformWrite() on a descriptor, recording the time taken if
+   *   profiling is enabled.
+   */
+  void PerformWrite(WriteFileDescriptor *descriptor);
+
   static const char K_LOOP_TIME[];
   static const char K_LOOP_COUNT[];
+  static const char K_POLL_EVENTS[];
+  static const char K_POLL_WAKEUPS[];
 };
 }  // namespace io
 }  // namespace ola
@@ -38,26 +38,45 @@
 #include <string>
 #include <vector>
 
+#include "ola/base/Flags.h"
+
 #ifdef _WIN32
+#include "common/io/IOCPPoller.h"
 #include "common/io/WindowsPoller.h"
 #else
-#include "ola/base/Flags.h"
-
-
 #include "common/io/SelectPoller.h"
 #endif  // _WIN32
 
+#include "common/io/CallbackQueue.h"
+#include "common/io/LoopProfiler.h"
 #include "ola/io/Descriptor.h"
 #include "ola/Logging.h"
 #include "ola/network/Socket.h"
 #include "ola/stl/STLUtils.h"
 
+#ifdef _WIN32
+DEFINE_default_bool(use_iocp, true,
+                    "Disable the use of I/O completion ports, revert to "
+                    "WaitForMultipleObjects()");
+#endif  // _WIN32
+
+#ifndef _WIN32
+DEFINE_default_bool(profile_loop, false,
+                    "Record the time spent in each event loop callback");
+#endif  // _WIN32
+
 #ifdef HAVE_EPOLL
 #include "common/io/EPoller.h"
 DEFINE_default_bool(use_epoll, true,
                     "Disable the use of epoll(), revert to select()");
 #endif  // HAVE_EPOLL
 
+#ifdef HAVE_IO_URING
+#include "common/io/IOUringPoller.h"
+DEFINE_default_bool(use_io_uring, false,
+                    "Use io_uring rather than epoll() or select()");
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_KQUEUE
 #include "common/io/KQueuePoller.h"
 DEFINE_default_bool(use_kqueue, false,
@@ -73,6 +92,8 @@ using ola::thread::timeout_id;
 using std::max;
 
 const TimeStamp SelectServer::empty_time;
+const char SelectServer::K_EXECUTE_NAME[] = "execute";
+const char SelectServer::K_RUN_IN_LOOP_NAME[] = "run-in-loop";
 
 SelectServer::SelectServer(ExportMap *export_map,
                            Clock *clock)
@@ -174,6 +195,9 @@ void SelectServer::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
     return;
   }
 
+  if (m_profiler.get()) {
+    m_profiler->RemoveDescriptorName(ToFD(descriptor->ReadDescriptor()));
+  }
   bool removed = m_poller->RemoveReadDescriptor(descriptor);
   if (removed && m_export_map) {
     (*m_export_map->GetIntegerVar(
@@ -187,6 +211,9 @@ void SelectServer::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
     return;
   }
 
+  if (m_profiler.get()) {
+    m_profiler->RemoveDescriptorName(ToFD(descriptor->ReadDescriptor()));
+  }
   bool removed = m_poller->RemoveReadDescriptor(descriptor);
   if (removed && m_export_map) {
     (*m_export_map->GetIntegerVar(
@@ -246,37 +273,30 @@ void SelectServer::RemoveTimeout(timeout_id id) {
   return m_timeout_manager->CancelTimeout(id);
 }
 
+void SelectServer::SetDescriptorName(const ReadFileDescriptor *descriptor,
+                                     const std::string &name) {
+  if (m_profiler.get()) {
+    m_profiler->SetDescriptorName(ToFD(descriptor->ReadDescriptor()), name);
+  }
+}
+
+void SelectServer::SetTimeoutName(timeout_id id, const std::string &name) {
+  if (m_profiler.get() && id != ola::thread::INVALID_TIMEOUT) {
+    m_profiler->SetTimeoutName(id, name);
+  }
+}
+
 void SelectServer::RunInLoop(Callback0<void> *callback) {
   m_loop_callbacks.insert(callback);
 }
 
 void SelectServer::Execute(ola::BaseCallback0<void> *callback) {
-  {
-    ola::thread::MutexLocker locker(&m_incoming_mutex);
-    m_incoming_callbacks.push_back(callback);
-  }
-
-  // kick select(), we do this even if we're in the same thread as select() is
-  // called. If we don't do this there is a race condition because a callback
-  // may be added just prior to select(). Without this kick, select() will
-  // sleep for the poll_interval before executing the callback.
-  uint8_t wake_up = 'a';
-  m_incoming_descriptor.Send(&wake_up, sizeof(wake_up));
+  m_incoming_queue->Push(callback);
 }
 
 
 void SelectServer::DrainCallbacks() {
-  Callbacks callbacks_to_run;
-  while (true) {
-    {
-      ola::thread::MutexLocker locker(&m_incoming_mutex);
-      if (m_incoming_callbacks.empty()) {
-        return;
-      }
-      callbacks_to_run.swap(m_incoming_callbacks);
-    }
-    RunCallbacks(&callbacks_to_run);
-  }
+  m_incoming_queue->RunCallbacks();
 }
 
 void SelectServer::Init(const Options &options) {
@@ -291,18 +311,53 @@ void SelectServer::Init(const Options &options) {
     m_export_map->GetIntegerVar(PollerInterface::K_CONNECTED_DESCRIPTORS_VAR);
   }
 
-  m_timeout_manager.reset(new TimeoutManager(m_export_map, m_clock));
+  m_timeout_manager.reset(new TimeoutManager(m_export_map, m_clock,
+                                             options.use_timer_wheel));
 #ifdef _WIN32
-  m_poller.reset(new WindowsPoller(m_export_map, m_clock));
-  (void) options;
+  bool using_iocp = false;
+  if (FLAGS_use_iocp && !options.force_select) {
+    std::auto_ptr<IOCPPoller> poller(new IOCPPoller(m_export_map, m_clock));
+    if (poller->Init()) {
+      m_poller.reset(poller.release());
+      using_iocp = true;
+    } else {
+      OLA_WARN << "I/O completion ports aren't available, falling back";
+    }
+  }
+  if (m_export_map) {
+    m_export_map->GetBoolVar("using-iocp")->Set(using_iocp);
+  }
+
+  if (!m_poller.get()) {
+    m_poller.reset(new WindowsPoller(m_export_map, m_clock));
+  }
 #else
 
+#ifdef HAVE_IO_URING
+  bool using_io_uring = false;
+  if (FLAGS_use_io_uring && !options.force_select) {
+    std::auto_ptr<IOUringPoller> poller(
+        new IOUringPoller(m_export_map, m_clock));
+    if (poller->Init()) {
+      m_poller.reset(poller.release());
+      using_io_uring = true;
+    } else {
+      OLA_WARN << "io_uring isn't available, falling back";
+    }
+  }
+  if (m_export_map) {
+    m_export_map->GetBoolVar("using-io-uring")->Set(using_io_uring);
+  }
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_EPOLL
-  if (FLAGS_use_epoll && !options.force_select) {
+  bool using_epoll = false;
+  if (FLAGS_use_epoll && !m_poller.get() && !options.force_select) {
     m_poller.reset(new EPoller(m_export_map, m_clock));
+    using_epoll = true;
   }
   if (m_export_map) {
-    m_export_map->GetBoolVar("using-epoll")->Set(FLAGS_use_epoll);
+    m_export_map->GetBoolVar("using-epoll")->Set(using_epoll);
   }
 #endif  // HAVE_EPOLL
 
@@ -325,12 +380,23 @@ void SelectServer::Init(const Options &options) {
 
   // TODO(simon): this should really be in an Init() method that returns a
   // bool.
-  if (!m_incoming_descriptor.Init()) {
-    OLA_FATAL << "Failed to init LoopbackDescriptor, Execute() won't work!";
+  m_incoming_queue.reset(new CallbackQueue(m_export_map));
+  if (!m_incoming_queue->Init() ||
+      !m_incoming_queue->AddToPoller(m_poller.get())) {
+    OLA_FATAL << "Failed to init CallbackQueue, Execute() won't work!";
+  }
+
+  bool profile_loop = options.profile_loop;
+#ifndef _WIN32
+  profile_loop |= FLAGS_profile_loop;
+#endif  // _WIN32
+  if (profile_loop && m_export_map) {
+    m_profiler.reset(new LoopProfiler(m_export_map, m_clock));
+    m_poller->SetProfiler(m_profiler.get());
+    m_timeout_manager->SetProfiler(m_profiler.get());
+    m_profiler->SetDescriptorName(
+        ToFD(m_incoming_queue->WakeUpDescriptor()), K_EXECUTE_NAME);
   }
-  m_incoming_descriptor.SetOnData(
-      ola::NewCallback(this, &SelectServer::DrainAndExecute));
-  AddReadDescriptor(&m_incoming_descriptor);
 }
 
 /*
@@ -342,7 +408,13 @@ bool SelectServer::CheckForEvents(const TimeInterval &poll_interval) {
   for (loop_iter = m_loop_callbacks.begin();
        loop_iter != m_loop_callbacks.end();
        ++loop_iter) {
-    (*loop_iter)->Run();
+    if (m_profiler.get()) {
+      const TimeStamp start = m_profiler->Now();
+      (*loop_iter)->Run();
+      m_profiler->CallbackDone(K_RUN_IN_LOOP_NAME, start);
+    } else {
+      (*loop_iter)->Run();
+    }
   }
 
   TimeInterval default_poll_interval = poll_interval;
@@ -353,36 +425,5 @@ bool SelectServer::CheckForEvents(const TimeInterval &poll_interval) {
   }
   return m_poller->Poll(m_timeout_manager.get(), default_poll_interval);
 }
-
-void SelectServer::DrainAndExecute() {
-  while (m_incoming_descriptor.DataRemaining()) {
-    // try to get everything in one read
-    uint8_t message[100];
-    unsigned int size;
-    m_incoming_descriptor.Receive(reinterpret_cast<uint8_t*>(&message),
-                                  sizeof(message), size);
-  }
-
-  // We can't hold the mutex while we execute the callback, so instead we swap
-  // out the vector under a lock, release the lock and then run all the
-  // callbacks.
-  Callbacks callbacks_to_run;
-  {
-    thread::MutexLocker lock(&m_incoming_mutex);
-    callbacks_to_run.swap(m_incoming_callbacks);
-  }
-
-  RunCallbacks(&callbacks_to_run);
-}
-
-void SelectServer::RunCallbacks(Callbacks *callbacks) {
-  Callbacks::iterator iter = callbacks->begin();
-  for (; iter != callbacks->end(); ++iter) {
-    if (*iter) {
-      (*iter)->Run();
-    }
-  }
-  callbacks->clear();
-}
 }  // namespace io
 }  // namespace ola
@@ -23,6 +23,10 @@
  * turn means implementations of PollerInterface also need to be reentrant.
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #ifdef _WIN32
 #include <ola/win/CleanWinSock2.h>
 #endif  // _WIN32
@@ -31,22 +35,27 @@
 #include <set>
 #include <sstream>
 
+#include "common/io/LoopProfiler.h"
 #include "common/io/PollerInterface.h"
 #include "ola/Callback.h"
 #include "ola/Clock.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
+#include "ola/base/Flags.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/Socket.h"
 #include "ola/testing/TestUtils.h"
 
 using ola::ExportMap;
+using ola::HistogramMap;
+using ola::HistogramVariable;
 using ola::IntegerVariable;
 using ola::NewCallback;
 using ola::NewSingleCallback;
 using ola::TimeStamp;
 using ola::io::ConnectedDescriptor;
+using ola::io::LoopProfiler;
 using ola::io::LoopbackDescriptor;
 using ola::io::PollerInterface;
 using ola::io::SelectServer;
@@ -56,6 +65,10 @@ using ola::network::UDPSocket;
 using std::auto_ptr;
 using std::set;
 
+#ifdef HAVE_KQUEUE
+DECLARE_bool(use_kqueue);
+#endif  // HAVE_KQUEUE
+
 /*
  * For some of the tests we need precise control over the timing.
  * So we mock a clock out here.
@@ -88,6 +101,8 @@ class SelectServerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRemoveWriteWhenReadable);
   CPPUNIT_TEST(testRemoveOthersWhenReadable);
   CPPUNIT_TEST(testRemoveOthersWhenWriteable);
+  CPPUNIT_TEST(testBatchedAddAndRemove);
+  CPPUNIT_TEST(testRemoveCloseAndReuse);
 #ifndef _WIN32
   CPPUNIT_TEST(testReadWriteInteraction);
 #endif  // !_WIN32
@@ -95,6 +110,7 @@ class SelectServerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTimeout);
   CPPUNIT_TEST(testOffByOneTimeout);
   CPPUNIT_TEST(testLoopCallbacks);
+  CPPUNIT_TEST(testLoopProfiling);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -110,11 +126,14 @@ class SelectServerTest: public CppUnit::TestFixture {
   void testRemoveWriteWhenReadable();
   void testRemoveOthersWhenReadable();
   void testRemoveOthersWhenWriteable();
+  void testBatchedAddAndRemove();
+  void testRemoveCloseAndReuse();
   void testReadWriteInteraction();
   void testShutdownWithActiveDescriptors();
   void testTimeout();
   void testOffByOneTimeout();
   void testLoopCallbacks();
+  void testLoopProfiling();
 
   void FatalTimeout() {
     OLA_FAIL("Fatal Timeout");
@@ -146,6 +165,10 @@ class SelectServerTest: public CppUnit::TestFixture {
 
   void NullHandler() {}
 
+  void UnexpectedData() {
+    OLA_FAIL("Unexpected data");
+  }
+
   bool IncrementTimeout() {
     if (m_ss && m_ss->IsRunning())
       m_timeout_counter++;
@@ -187,6 +210,17 @@ class SelectServerTest: public CppUnit::TestFixture {
 
   void IncrementLoopCounter() { m_loop_counter++; }
 
+  void ReceiveData(ConnectedDescriptor *descriptor) {
+    uint8_t data[10];
+    unsigned int size;
+    descriptor->Receive(data, arraysize(data), size);
+  }
+
+  void ReceiveDataAndTerminate(ConnectedDescriptor *descriptor) {
+    ReceiveData(descriptor);
+    m_ss->Terminate();
+  }
+
  private:
   unsigned int m_timeout_counter;
   unsigned int m_loop_counter;
@@ -195,6 +229,12 @@ class SelectServerTest: public CppUnit::TestFixture {
   IntegerVariable *read_descriptor_count;
   IntegerVariable *write_descriptor_count;
   SelectServer *m_ss;
+
+  void CheckBatchedAddAndRemove();
+  void CheckRemoveCloseAndReuse();
+#ifdef HAVE_KQUEUE
+  void UseKQueuePoller();
+#endif  // HAVE_KQUEUE
 };
 
 
@@ -231,7 +271,7 @@ void SelectServerTest::tearDown() {
  * Confirm we can't add invalid descriptors to the SelectServer
  */
 void SelectServerTest::testAddInvalidDescriptor() {
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());  // internal socket
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -242,7 +282,7 @@ void SelectServerTest::testAddInvalidDescriptor() {
   m_ss->RemoveReadDescriptor(&bad_socket);
   m_ss->RemoveWriteDescriptor(&bad_socket);
 
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 }
@@ -251,7 +291,7 @@ void SelectServerTest::testAddInvalidDescriptor() {
  * Confirm we can't add the same descriptor twice.
  */
 void SelectServerTest::testDoubleAddAndRemove() {
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());  // internal socket
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -259,22 +299,22 @@ void SelectServerTest::testDoubleAddAndRemove() {
   loopback.Init();
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
   OLA_ASSERT_TRUE(m_ss->AddWriteDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, write_descriptor_count->Get());
 
   m_ss->RemoveReadDescriptor(&loopback);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, write_descriptor_count->Get());
 
   m_ss->RemoveWriteDescriptor(&loopback);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -289,7 +329,7 @@ void SelectServerTest::testDoubleAddAndRemove() {
  * export map is updated.
  */
 void SelectServerTest::testAddRemoveReadDescriptor() {
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -297,7 +337,7 @@ void SelectServerTest::testAddRemoveReadDescriptor() {
   loopback.Init();
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
@@ -305,18 +345,18 @@ void SelectServerTest::testAddRemoveReadDescriptor() {
   UDPSocket udp_socket;
   OLA_ASSERT_TRUE(udp_socket.Init());
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&udp_socket));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
   // Check remove works
   m_ss->RemoveReadDescriptor(&loopback);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 
   m_ss->RemoveReadDescriptor(&udp_socket);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
 }
@@ -336,14 +376,14 @@ void SelectServerTest::testRemoteEndClose() {
       read_set, write_set, delete_set));
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
   // now the Write end closes
   loopback.CloseClient();
 
   m_ss->Run();
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -359,14 +399,14 @@ void SelectServerTest::testRemoteEndCloseWithDelete() {
       this, &SelectServerTest::Terminate));
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback, true));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
   // Now the Write end closes
   loopback->CloseClient();
 
   m_ss->Run();
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -386,14 +426,14 @@ void SelectServerTest::testRemoteEndCloseWithRemoveAndDelete() {
 
   // Ownership is transferred.
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback, true));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
   // Close the write end of the descriptor.
   loopback->CloseClient();
 
   m_ss->Run();
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -421,7 +461,7 @@ void SelectServerTest::testRemoveWriteWhenOtherReadable() {
 
   m_ss->Run();
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -442,7 +482,7 @@ void SelectServerTest::testRemoveWriteWhenReadable() {
 
   OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(loopback));
   OLA_ASSERT_TRUE(m_ss->AddWriteDescriptor(loopback));
-  OLA_ASSERT_EQ(2, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(1, write_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 
@@ -452,7 +492,7 @@ void SelectServerTest::testRemoveWriteWhenReadable() {
 
   m_ss->Run();
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -481,13 +521,13 @@ void SelectServerTest::testRemoveOthersWhenReadable() {
       read_set, write_set, delete_set));
 
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(4, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(3, connected_read_descriptor_count->Get());
 
   loopback2.CloseClient();
   m_ss->Run();
 
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -521,15 +561,39 @@ void SelectServerTest::testRemoveOthersWhenWriteable() {
       this, &SelectServerTest::NullHandler));
 
   OLA_ASSERT_EQ(3, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
 
   m_ss->Run();
 
   OLA_ASSERT_EQ(0, write_descriptor_count->Get());
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
+/*
+ * Check that a descriptor added and removed in the same loop iteration never
+ * fires, and doesn't stop the other changes in the batch from being applied.
+ */
+void SelectServerTest::testBatchedAddAndRemove() {
+  CheckBatchedAddAndRemove();
+#ifdef HAVE_KQUEUE
+  UseKQueuePoller();
+  CheckBatchedAddAndRemove();
+#endif  // HAVE_KQUEUE
+}
+
+/*
+ * Check that removing and closing a descriptor, then reusing its fd number
+ * before the next loop iteration, delivers events to the new descriptor.
+ */
+void SelectServerTest::testRemoveCloseAndReuse() {
+  CheckRemoveCloseAndReuse();
+#ifdef HAVE_KQUEUE
+  UseKQueuePoller();
+  CheckRemoveCloseAndReuse();
+#endif  // HAVE_KQUEUE
+}
+
 /*
  * Test the interaction between read and write descriptor.
  */
@@ -550,7 +614,7 @@ void SelectServerTest::testReadWriteInteraction() {
       100, ola::NewSingleCallback(this, &SelectServerTest::FatalTimeout));
   m_ss->Run();
   m_ss->RemoveReadDescriptor(&socket);
-  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
   OLA_ASSERT_EQ(0, read_descriptor_count->Get());
 }
 
@@ -660,3 +724,127 @@ void SelectServerTest::testLoopCallbacks() {
   // we should have at least 5 calls to IncrementLoopCounter
   OLA_ASSERT_TRUE(m_loop_counter >= 5);
 }
+
+/*
+ * Check the time spent in callbacks is recorded by owner when profiling.
+ */
+void SelectServerTest::testLoopProfiling() {
+  OLA_ASSERT_FALSE(m_ss->Profiling());
+
+  SelectServer::Options options;
+  options.export_map = &m_map;
+  options.profile_loop = true;
+  SelectServer ss(options);
+  OLA_ASSERT_TRUE(ss.Profiling());
+
+  LoopbackDescriptor loopback;
+  loopback.Init();
+  loopback.SetOnData(
+      NewCallback(this, &SelectServerTest::ReceiveData,
+                  static_cast<ConnectedDescriptor*>(&loopback)));
+  OLA_ASSERT_TRUE(ss.AddReadDescriptor(&loopback));
+  ss.SetDescriptorName(&loopback, "loopback");
+
+  ola::thread::timeout_id id = ss.RegisterSingleTimeout(
+      0, NewSingleCallback(this, &SelectServerTest::SingleIncrementTimeout));
+  ss.SetTimeoutName(id, "named-timeout");
+  ss.RegisterSingleTimeout(
+      0, NewSingleCallback(this, &SelectServerTest::SingleIncrementTimeout));
+  ss.Execute(NewSingleCallback(this, &SelectServerTest::NullHandler));
+
+  const uint8_t data[] = {1, 2, 3};
+  loopback.Send(data, arraysize(data));
+  ss.RunOnce(ola::TimeInterval(0, 10000));
+  ss.RunOnce(ola::TimeInterval(0, 10000));
+  OLA_ASSERT_EQ(2u, m_timeout_counter);
+
+  HistogramMap *callback_time = m_map.GetHistogramMapVar(
+      LoopProfiler::K_CALLBACK_TIME_VAR, "", std::vector<uint64_t>());
+  const HistogramVariable *histogram = callback_time->Find("loopback");
+  OLA_ASSERT_NOT_NULL(histogram);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), histogram->Count());
+  histogram = callback_time->Find("named-timeout");
+  OLA_ASSERT_NOT_NULL(histogram);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), histogram->Count());
+  // Unnamed timeouts are grouped together.
+  histogram = callback_time->Find("timeout");
+  OLA_ASSERT_NOT_NULL(histogram);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), histogram->Count());
+  OLA_ASSERT_NOT_NULL(callback_time->Find(SelectServer::K_EXECUTE_NAME));
+
+  HistogramVariable *lag = m_map.GetHistogramVar(
+      LoopProfiler::K_TIMEOUT_LAG_VAR, std::vector<uint64_t>());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), lag->Count());
+
+  ss.RemoveReadDescriptor(&loopback);
+}
+
+void SelectServerTest::CheckBatchedAddAndRemove() {
+  LoopbackDescriptor removed, loopback;
+  removed.Init();
+  loopback.Init();
+  removed.SetOnData(NewCallback(this, &SelectServerTest::UnexpectedData));
+  loopback.SetOnData(NewCallback(
+      this, &SelectServerTest::ReceiveDataAndTerminate,
+      static_cast<ConnectedDescriptor*>(&loopback)));
+
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&removed));
+  m_ss->RemoveReadDescriptor(&removed);
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
+  OLA_ASSERT_EQ(1, connected_read_descriptor_count->Get());
+
+  const uint8_t data[] = {'a'};
+  removed.Send(data, arraysize(data));
+  loopback.Send(data, arraysize(data));
+
+  ola::thread::timeout_id timeout = m_ss->RegisterSingleTimeout(
+      1000, NewSingleCallback(this, &SelectServerTest::FatalTimeout));
+  m_ss->Run();
+  m_ss->RemoveTimeout(timeout);
+  m_ss->RemoveReadDescriptor(&loopback);
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
+}
+
+void SelectServerTest::CheckRemoveCloseAndReuse() {
+  LoopbackDescriptor *closed = new LoopbackDescriptor();
+  closed->Init();
+  closed->SetOnData(NewCallback(this, &SelectServerTest::UnexpectedData));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(closed));
+  m_ss->RunOnce(ola::TimeInterval(0, 0));
+
+  // Closing the descriptor drops its filters, so the queued removal fails
+  // in the next batch. The new descriptor will usually get the same fd.
+  m_ss->RemoveReadDescriptor(closed);
+  delete closed;
+
+  LoopbackDescriptor loopback;
+  loopback.Init();
+  loopback.SetOnData(NewCallback(
+      this, &SelectServerTest::ReceiveDataAndTerminate,
+      static_cast<ConnectedDescriptor*>(&loopback)));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&loopback));
+
+  const uint8_t data[] = {'a'};
+  loopback.Send(data, arraysize(data));
+
+  ola::thread::timeout_id timeout = m_ss->RegisterSingleTimeout(
+      1000, NewSingleCallback(this, &SelectServerTest::FatalTimeout));
+  m_ss->Run();
+  m_ss->RemoveTimeout(timeout);
+  m_ss->RemoveReadDescriptor(&loopback);
+  OLA_ASSERT_EQ(0, connected_read_descriptor_count->Get());
+}
+
+#ifdef HAVE_KQUEUE
+/*
+ * Replace m_ss with a SelectServer that uses the KQueuePoller, which queues
+ * the descriptor changes and applies them in one batch.
+ */
+void SelectServerTest::UseKQueuePoller() {
+  delete m_ss;
+  bool use_kqueue = FLAGS_use_kqueue;
+  FLAGS_use_kqueue = true;
+  m_ss = new SelectServer(&m_map);
+  FLAGS_use_kqueue = use_kqueue;
+}
+#endif  // HAVE_KQUEUE
@@ -21,14 +21,18 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <vector>
+
 #include "ola/testing/TestUtils.h"
 
 #include "ola/Callback.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/thread/Thread.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/Socket.h"
 
+using ola::ExportMap;
 using ola::io::SelectServer;
 using ola::network::UDPSocket;
 using ola::thread::ThreadId;
@@ -64,15 +68,63 @@ class TestThread: public ola::thread::Thread {
 };
 
 
+/*
+ * Executes a number of callbacks, and checks they run in order.
+ */
+class ProducerThread: public ola::thread::Thread {
+ public:
+    ProducerThread(SelectServer *ss, unsigned int count, unsigned int *total,
+                   unsigned int expected_total)
+        : m_ss(ss),
+          m_count(count),
+          m_next(0),
+          m_in_order(true),
+          m_total(total),
+          m_expected_total(expected_total) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 0; i < m_count; i++) {
+        m_ss->Execute(
+            ola::NewSingleCallback(this, &ProducerThread::TestCallback, i));
+      }
+      return NULL;
+    }
+
+    void TestCallback(unsigned int sequence) {
+      if (sequence != m_next) {
+        m_in_order = false;
+      }
+      m_next++;
+      if (++(*m_total) == m_expected_total) {
+        m_ss->Terminate();
+      }
+    }
+
+    unsigned int CallbacksRun() const { return m_next; }
+    bool InOrder() const { return m_in_order; }
+
+ private:
+    SelectServer *m_ss;
+    unsigned int m_count;
+    unsigned int m_next;
+    bool m_in_order;
+    unsigned int *m_total;
+    unsigned int m_expected_total;
+};
+
+
 class SelectServerThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SelectServerThreadTest);
   CPPUNIT_TEST(testSameThreadCallback);
   CPPUNIT_TEST(testDifferentThreadCallback);
+  CPPUNIT_TEST(testManyThreadCallbacks);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testSameThreadCallback();
   void testDifferentThreadCallback();
+  void testManyThreadCallbacks();
 
  private:
   SelectServer m_ss;
@@ -106,3 +158,37 @@ void SelectServerThreadTest::testDifferentThreadCallback() {
   test_thread.Join();
   OLA_ASSERT_TRUE(test_thread.CallbackRun());
 }
+
+
+/*
+ * Check that callbacks from many threads are all executed, in order for each
+ * thread.
+ */
+void SelectServerThreadTest::testManyThreadCallbacks() {
+  const unsigned int THREADS = 4;
+  const unsigned int CALLBACKS_PER_THREAD = 1000;
+  ExportMap export_map;
+  SelectServer ss(&export_map);
+  unsigned int total = 0;
+
+  std::vector<ProducerThread*> threads;
+  for (unsigned int i = 0; i < THREADS; i++) {
+    threads.push_back(new ProducerThread(&ss, CALLBACKS_PER_THREAD, &total,
+                                         THREADS * CALLBACKS_PER_THREAD));
+    threads.back()->Start();
+  }
+  ss.Run();
+
+  for (unsigned int i = 0; i < THREADS; i++) {
+    threads[i]->Join();
+    OLA_ASSERT_EQ(CALLBACKS_PER_THREAD, threads[i]->CallbacksRun());
+    OLA_ASSERT_TRUE(threads[i]->InOrder());
+    delete threads[i];
+  }
+  OLA_ASSERT_EQ(THREADS * CALLBACKS_PER_THREAD, total);
+
+  // Wake ups are coalesced, so there should be at most one per callback.
+  unsigned int wake_ups = export_map.GetCounterVar("ss-execute-wakeups")->Get();
+  OLA_ASSERT_GT(wake_ups, 0u);
+  OLA_ASSERT_LTE(wake_ups, THREADS * CALLBACKS_PER_THREAD + 1);
+}
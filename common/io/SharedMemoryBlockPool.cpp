@@ -0,0 +1,210 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedMemoryBlockPool.cpp
+ * A MemoryBlockPool that can be used from more than one thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "ola/io/SharedMemoryBlockPool.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+namespace ola {
+namespace io {
+
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+
+namespace {
+Mutex packet_pool_mutex;
+SharedMemoryBlockPool::Options packet_pool_options;
+SharedMemoryBlockPool *packet_pool = NULL;
+}  // namespace
+
+SharedMemoryBlockPool::SharedMemoryBlockPool(const Options &options)
+    : MemoryBlockPool(options.block_size),
+      m_thread_cache_size(options.thread_cache_size),
+      m_depot_size(options.depot_size),
+      m_blocks_allocated(0) {
+  pthread_key_create(&m_cache_key, DeleteCache);
+  m_depot.reserve(std::max(m_depot_size, options.preallocate));
+  for (unsigned int i = 0; i < options.preallocate; i++) {
+    m_depot.push_back(NewBlock());
+  }
+}
+
+SharedMemoryBlockPool::~SharedMemoryBlockPool() {
+  // After this the DeleteCache() won't be called when threads exit.
+  pthread_key_delete(m_cache_key);
+
+  ThreadCaches::iterator iter = m_caches.begin();
+  for (; iter != m_caches.end(); ++iter) {
+    BlockVector::iterator block_iter = (*iter)->blocks.begin();
+    for (; block_iter != (*iter)->blocks.end(); ++block_iter) {
+      FreeBlock(*block_iter);
+    }
+    delete *iter;
+  }
+  m_caches.clear();
+
+  BlockVector::iterator block_iter = m_depot.begin();
+  for (; block_iter != m_depot.end(); ++block_iter) {
+    FreeBlock(*block_iter);
+  }
+  m_depot.clear();
+}
+
+MemoryBlock *SharedMemoryBlockPool::Allocate() {
+  ThreadCache *cache = GetCache();
+  if (cache->blocks.empty()) {
+    MutexLocker lock(&m_mutex);
+    const unsigned int count = std::min(
+        static_cast<unsigned int>(m_depot.size()),
+        std::max(m_thread_cache_size / 2, 1u));
+    cache->blocks.insert(cache->blocks.end(), m_depot.end() - count,
+                         m_depot.end());
+    m_depot.resize(m_depot.size() - count);
+    if (cache->blocks.empty()) {
+      return NewBlock();
+    }
+  }
+  MemoryBlock *block = cache->blocks.back();
+  cache->blocks.pop_back();
+  return block;
+}
+
+void SharedMemoryBlockPool::Release(MemoryBlock *block) {
+  // discard any data left in the block so it's empty when reused.
+  block->PopFront(block->Size());
+  ThreadCache *cache = GetCache();
+  cache->blocks.push_back(block);
+  if (cache->blocks.size() > m_thread_cache_size) {
+    ReturnToDepot(cache, cache->blocks.size() - m_thread_cache_size / 2);
+  }
+}
+
+unsigned int SharedMemoryBlockPool::FreeBlocks() const {
+  const ThreadCache *cache = CurrentCache();
+  MutexLocker lock(&m_mutex);
+  return static_cast<unsigned int>(
+      m_depot.size() + (cache ? cache->blocks.size() : 0));
+}
+
+void SharedMemoryBlockPool::Purge(unsigned int remaining) {
+  ThreadCache *cache = CurrentCache();
+  if (cache) {
+    ReturnToDepot(cache, cache->blocks.size());
+  }
+
+  MutexLocker lock(&m_mutex);
+  while (m_depot.size() > remaining) {
+    FreeBlock(m_depot.back());
+    m_depot.pop_back();
+  }
+}
+
+unsigned int SharedMemoryBlockPool::BlocksAllocated() const {
+  MutexLocker lock(&m_mutex);
+  return m_blocks_allocated;
+}
+
+SharedMemoryBlockPool *SharedMemoryBlockPool::PacketPool() {
+  MutexLocker lock(&packet_pool_mutex);
+  if (!packet_pool) {
+    packet_pool = new SharedMemoryBlockPool(packet_pool_options);
+  }
+  return packet_pool;
+}
+
+bool SharedMemoryBlockPool::ConfigurePacketPool(const Options &options) {
+  MutexLocker lock(&packet_pool_mutex);
+  if (packet_pool) {
+    return false;
+  }
+  packet_pool_options = options;
+  return true;
+}
+
+SharedMemoryBlockPool::ThreadCache *SharedMemoryBlockPool::CurrentCache()
+    const {
+  return static_cast<ThreadCache*>(pthread_getspecific(m_cache_key));
+}
+
+SharedMemoryBlockPool::ThreadCache *SharedMemoryBlockPool::GetCache() {
+  ThreadCache *cache = CurrentCache();
+  if (!cache) {
+    cache = new ThreadCache();
+    cache->pool = this;
+    // Reserve enough that the cache never grows.
+    cache->blocks.reserve(m_thread_cache_size + 1);
+    pthread_setspecific(m_cache_key, cache);
+
+    MutexLocker lock(&m_mutex);
+    m_caches.insert(cache);
+  }
+  return cache;
+}
+
+/*
+ * Called with m_mutex held, or from the constructor.
+ */
+MemoryBlock *SharedMemoryBlockPool::NewBlock() {
+  m_blocks_allocated++;
+  return new MemoryBlock(new uint8_t[BlockSize()], BlockSize());
+}
+
+/*
+ * Move the last count blocks in a cache to the depot.
+ */
+void SharedMemoryBlockPool::ReturnToDepot(ThreadCache *cache,
+                                          unsigned int count) {
+  MutexLocker lock(&m_mutex);
+  for (; count > 0; count--) {
+    MemoryBlock *block = cache->blocks.back();
+    cache->blocks.pop_back();
+    if (m_depot.size() < m_depot_size) {
+      m_depot.push_back(block);
+    } else {
+      FreeBlock(block);
+    }
+  }
+}
+
+/*
+ * Called with m_mutex held, or from the destructor.
+ */
+void SharedMemoryBlockPool::FreeBlock(MemoryBlock *block) {
+  m_blocks_allocated--;
+  delete block;
+}
+
+/*
+ * Called when a thread using the pool exits.
+ */
+void SharedMemoryBlockPool::DeleteCache(void *data) {
+  ThreadCache *cache = static_cast<ThreadCache*>(data);
+  SharedMemoryBlockPool *pool = cache->pool;
+  pool->ReturnToDepot(cache, cache->blocks.size());
+
+  MutexLocker lock(&pool->m_mutex);
+  pool->m_caches.erase(cache);
+  delete cache;
+}
+}  // namespace io
+}  // namespace ola
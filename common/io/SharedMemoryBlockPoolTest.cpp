@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SharedMemoryBlockPoolTest.cpp
+ * Test fixture for the SharedMemoryBlockPool class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/base/Array.h"
+#include "ola/io/MemoryBlock.h"
+#include "ola/io/SharedMemoryBlockPool.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/CallbackThread.h"
+
+using ola::io::MemoryBlock;
+using ola::io::SharedMemoryBlockPool;
+using ola::thread::CallbackThread;
+using std::vector;
+
+class SharedMemoryBlockPoolTest: public CppUnit::TestFixture {
+ public:
+  CPPUNIT_TEST_SUITE(SharedMemoryBlockPoolTest);
+  CPPUNIT_TEST(testAllocateRelease);
+  CPPUNIT_TEST(testDepot);
+  CPPUNIT_TEST(testDepotLimit);
+  CPPUNIT_TEST(testPreallocate);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testAllocateRelease();
+  void testDepot();
+  void testDepotLimit();
+  void testPreallocate();
+  void testThreads();
+
+ private:
+  void AllocateAndRelease(SharedMemoryBlockPool *pool, unsigned int count);
+  void ReleaseBlocks(SharedMemoryBlockPool *pool, vector<MemoryBlock*> *blocks);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedMemoryBlockPoolTest);
+
+void SharedMemoryBlockPoolTest::AllocateAndRelease(
+    SharedMemoryBlockPool *pool,
+    unsigned int count) {
+  vector<MemoryBlock*> blocks;
+  for (unsigned int i = 0; i < count; i++) {
+    blocks.push_back(pool->Allocate());
+  }
+  ReleaseBlocks(pool, &blocks);
+}
+
+void SharedMemoryBlockPoolTest::ReleaseBlocks(SharedMemoryBlockPool *pool,
+                                              vector<MemoryBlock*> *blocks) {
+  vector<MemoryBlock*>::iterator iter = blocks->begin();
+  for (; iter != blocks->end(); ++iter) {
+    pool->Release(*iter);
+  }
+  blocks->clear();
+}
+
+/*
+ * Check that blocks are reused.
+ */
+void SharedMemoryBlockPoolTest::testAllocateRelease() {
+  SharedMemoryBlockPool::Options options;
+  options.block_size = 100;
+  SharedMemoryBlockPool pool(options);
+  OLA_ASSERT_EQ(100u, pool.BlockSize());
+  OLA_ASSERT_EQ(0u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+
+  MemoryBlock *block = pool.Allocate();
+  OLA_ASSERT_NOT_NULL(block);
+  OLA_ASSERT_EQ(100u, block->Capacity());
+  OLA_ASSERT_EQ(1u, pool.BlocksAllocated());
+
+  const uint8_t data[] = {1, 2, 3, 4};
+  block->Append(data, arraysize(data));
+  pool.Release(block);
+  OLA_ASSERT_EQ(1u, pool.FreeBlocks());
+
+  // We should get the same block back, without the data.
+  OLA_ASSERT_EQ(block, pool.Allocate());
+  OLA_ASSERT_TRUE(block->Empty());
+  OLA_ASSERT_EQ(1u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+  pool.Release(block);
+}
+
+/*
+ * Check blocks overflow from the thread cache into the depot.
+ */
+void SharedMemoryBlockPoolTest::testDepot() {
+  SharedMemoryBlockPool::Options options;
+  options.thread_cache_size = 4;
+  options.depot_size = 8;
+  SharedMemoryBlockPool pool(options);
+
+  AllocateAndRelease(&pool, 10);
+  OLA_ASSERT_EQ(10u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(10u, pool.FreeBlocks());
+
+  // Once warm, no more blocks are allocated.
+  AllocateAndRelease(&pool, 10);
+  OLA_ASSERT_EQ(10u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(10u, pool.FreeBlocks());
+
+  pool.Purge(2);
+  OLA_ASSERT_EQ(2u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(2u, pool.FreeBlocks());
+
+  pool.Purge();
+  OLA_ASSERT_EQ(0u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(0u, pool.FreeBlocks());
+}
+
+/*
+ * Check blocks beyond the depot size are freed.
+ */
+void SharedMemoryBlockPoolTest::testDepotLimit() {
+  SharedMemoryBlockPool::Options options;
+  options.thread_cache_size = 2;
+  options.depot_size = 2;
+  SharedMemoryBlockPool pool(options);
+
+  AllocateAndRelease(&pool, 10);
+  OLA_ASSERT_EQ(pool.BlocksAllocated(), pool.FreeBlocks());
+  OLA_ASSERT_TRUE(pool.BlocksAllocated() <= 4);
+
+  // With no thread cache every block goes through the depot.
+  options.thread_cache_size = 0;
+  SharedMemoryBlockPool uncached_pool(options);
+  AllocateAndRelease(&uncached_pool, 10);
+  OLA_ASSERT_EQ(2u, uncached_pool.BlocksAllocated());
+  OLA_ASSERT_EQ(2u, uncached_pool.FreeBlocks());
+}
+
+void SharedMemoryBlockPoolTest::testPreallocate() {
+  SharedMemoryBlockPool::Options options;
+  options.preallocate = 5;
+  SharedMemoryBlockPool pool(options);
+  OLA_ASSERT_EQ(5u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(5u, pool.FreeBlocks());
+
+  AllocateAndRelease(&pool, 5);
+  OLA_ASSERT_EQ(5u, pool.BlocksAllocated());
+}
+
+/*
+ * Check blocks can move between threads.
+ */
+void SharedMemoryBlockPoolTest::testThreads() {
+  SharedMemoryBlockPool::Options options;
+  options.thread_cache_size = 4;
+  SharedMemoryBlockPool pool(options);
+
+  // The thread's cache is returned to the depot when it exits.
+  CallbackThread thread(ola::NewSingleCallback(
+      this, &SharedMemoryBlockPoolTest::AllocateAndRelease, &pool, 6u));
+  OLA_ASSERT_TRUE(thread.Start());
+  OLA_ASSERT_TRUE(thread.Join());
+  OLA_ASSERT_EQ(6u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(6u, pool.FreeBlocks());
+
+  // Blocks allocated here can be released on another thread.
+  vector<MemoryBlock*> blocks;
+  for (unsigned int i = 0; i < 8; i++) {
+    blocks.push_back(pool.Allocate());
+  }
+  OLA_ASSERT_EQ(8u, pool.BlocksAllocated());
+
+  CallbackThread release_thread(ola::NewSingleCallback(
+      this, &SharedMemoryBlockPoolTest::ReleaseBlocks, &pool, &blocks));
+  OLA_ASSERT_TRUE(release_thread.Start());
+  OLA_ASSERT_TRUE(release_thread.Join());
+  OLA_ASSERT_EQ(8u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(8u, pool.FreeBlocks());
+}
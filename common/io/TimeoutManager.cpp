@@ -33,15 +33,22 @@ const char TimeoutManager::K_TIMER_VAR[] = "ss-timers";
 
 using ola::Callback0;
 using ola::ExportMap;
+using ola::IntegerVariable;
 using ola::thread::INVALID_TIMEOUT;
 using ola::thread::timeout_id;
 
 TimeoutManager::TimeoutManager(ExportMap *export_map,
-                               Clock *clock)
+                               Clock *clock,
+                               bool use_timer_wheel)
     : m_export_map(export_map),
-      m_clock(clock) {
+      m_clock(clock),
+      m_profiler(NULL) {
+  IntegerVariable *timer_var = NULL;
   if (m_export_map) {
-    m_export_map->GetIntegerVar(K_TIMER_VAR);
+    timer_var = m_export_map->GetIntegerVar(K_TIMER_VAR);
+  }
+  if (use_timer_wheel) {
+    m_timer_wheel.reset(new TimerWheel(m_clock, timer_var));
   }
 }
 
@@ -57,6 +64,9 @@ TimeoutManager::~TimeoutManager() {
 timeout_id TimeoutManager::RegisterRepeatingTimeout(
     const TimeInterval &interval,
     ola::Callback0<bool> *closure) {
+  if (m_timer_wheel.get())
+    return m_timer_wheel->RegisterRepeatingTimeout(interval, closure);
+
   if (!closure)
     return INVALID_TIMEOUT;
 
@@ -71,6 +81,9 @@ timeout_id TimeoutManager::RegisterRepeatingTimeout(
 timeout_id TimeoutManager::RegisterSingleTimeout(
     const TimeInterval &interval,
     ola::SingleUseCallback0<void> *closure) {
+  if (m_timer_wheel.get())
+    return m_timer_wheel->RegisterSingleTimeout(interval, closure);
+
   if (!closure)
     return INVALID_TIMEOUT;
 
@@ -88,11 +101,28 @@ void TimeoutManager::CancelTimeout(timeout_id id) {
   if (id == INVALID_TIMEOUT)
     return;
 
+  if (m_profiler)
+    m_profiler->RemoveTimeoutName(id);
+
+  if (m_timer_wheel.get()) {
+    m_timer_wheel->CancelTimeout(id);
+    return;
+  }
+
   if (!m_removed_timeouts.insert(id).second)
     OLA_WARN << "timeout " << id << " already in remove set";
 }
 
+void TimeoutManager::SetProfiler(LoopProfiler *profiler) {
+  m_profiler = profiler;
+  if (m_timer_wheel.get())
+    m_timer_wheel->SetProfiler(profiler);
+}
+
 TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
+  if (m_timer_wheel.get())
+    return m_timer_wheel->ExecuteTimeouts(now);
+
   Event *e;
   if (m_events.empty())
     return TimeInterval();
@@ -109,11 +139,22 @@ TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
       continue;
     }
 
-    if (e->Trigger()) {
+    TimeStamp start;
+    if (m_profiler) {
+      m_profiler->TimeoutLag(e->NextTime(), *now);
+      start = m_profiler->Now();
+    }
+    const bool repeat = e->Trigger();
+    if (m_profiler)
+      m_profiler->TimeoutDone(e, start);
+
+    if (repeat) {
       // true implies we need to run this again
       e->UpdateTime(*now);
       m_events.push(e);
     } else {
+      if (m_profiler)
+        m_profiler->RemoveTimeoutName(e);
       delete e;
       if (m_export_map)
         (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
@@ -21,10 +21,13 @@
 #ifndef COMMON_IO_TIMEOUTMANAGER_H_
 #define COMMON_IO_TIMEOUTMANAGER_H_
 
+#include <memory>
 #include <queue>
 #include <set>
 #include <vector>
 
+#include "common/io/LoopProfiler.h"
+#include "common/io/TimerWheel.h"
 #include "ola/Callback.h"
 #include "ola/Clock.h"
 #include "ola/ExportMap.h"
@@ -41,6 +44,10 @@ namespace io {
  *
  * The TimeoutManager allows Callbacks to trigger at some point in the future.
  * Callbacks can be invoked once, or periodically.
+ *
+ * By default timeouts are kept in a priority queue. Alternatively a
+ * TimerWheel can be used, which is better suited to large numbers of
+ * timeouts that are frequently cancelled.
  */
 class TimeoutManager {
  public :
@@ -48,8 +55,10 @@ class TimeoutManager {
    * @brief Create a new TimeoutManager.
    * @param export_map an ExportMap to update
    * @param clock the Clock to use.
+   * @param use_timer_wheel use a TimerWheel rather than a priority queue.
    */
-  TimeoutManager(ola::ExportMap *export_map, Clock *clock);
+  TimeoutManager(ola::ExportMap *export_map, Clock *clock,
+                 bool use_timer_wheel = false);
 
   ~TimeoutManager();
 
@@ -85,11 +94,13 @@ class TimeoutManager {
 
   /**
    * @brief Check if there are any events in the queue.
-   * Events remain in the queue even if they have been cancelled.
+   * Events remain in the queue even if they have been cancelled, unless the
+   * TimerWheel is in use.
    * @returns true if there are events pending, false otherwise.
    */
   bool EventsPending() const {
-    return !m_events.empty();
+    return m_timer_wheel.get() ? m_timer_wheel->EventsPending() :
+        !m_events.empty();
   }
 
   /**
@@ -100,6 +111,13 @@ class TimeoutManager {
    */
   TimeInterval ExecuteTimeouts(TimeStamp *now);
 
+  /**
+   * @brief Set the LoopProfiler to record the time spent in timeouts with.
+   * @param profiler the LoopProfiler to use, ownership is not transferred.
+   *   NULL disables profiling.
+   */
+  void SetProfiler(LoopProfiler *profiler);
+
   static const char K_TIMER_VAR[];
 
  private :
@@ -192,6 +210,8 @@ class TimeoutManager {
 
   event_queue_t m_events;
   std::set<ola::thread::timeout_id> m_removed_timeouts;
+  std::auto_ptr<TimerWheel> m_timer_wheel;
+  LoopProfiler *m_profiler;
 
   DISALLOW_COPY_AND_ASSIGN(TimeoutManager);
 };
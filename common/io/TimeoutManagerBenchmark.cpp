@@ -0,0 +1,111 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimeoutManagerBenchmark.cpp
+ * Microbenchmarks for the TimeoutManager.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::MockClock;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::TimeoutManager;
+using ola::testing::BenchmarkState;
+using ola::thread::timeout_id;
+using std::vector;
+
+namespace {
+
+// The number of timeouts outstanding at once, roughly what a busy olad has.
+const unsigned int PENDING_TIMEOUTS = 1000;
+
+void NoOp() {}
+
+/*
+ * Register a batch of timeouts, then cancel all of them.
+ */
+void RunRegisterCancel(BenchmarkState *state, bool use_timer_wheel) {
+  MockClock clock;
+  TimeoutManager timeouts(NULL, &clock, use_timer_wheel);
+  vector<timeout_id> ids(PENDING_TIMEOUTS);
+  TimeStamp now;
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i += PENDING_TIMEOUTS) {
+    for (unsigned int j = 0; j < PENDING_TIMEOUTS; j++) {
+      ids[j] = timeouts.RegisterSingleTimeout(
+          TimeInterval(0, 1000 + (j * 997) % 100000),
+          NewSingleCallback(&NoOp));
+    }
+    for (unsigned int j = 0; j < PENDING_TIMEOUTS; j++) {
+      timeouts.CancelTimeout(ids[j]);
+    }
+    // Clear out the cancelled events.
+    clock.AdvanceTime(1, 0);
+    clock.CurrentTime(&now);
+    timeouts.ExecuteTimeouts(&now);
+  }
+}
+
+/*
+ * Register timeouts and let them all fire.
+ */
+void RunRegisterExpire(BenchmarkState *state, bool use_timer_wheel) {
+  MockClock clock;
+  TimeoutManager timeouts(NULL, &clock, use_timer_wheel);
+  TimeStamp now;
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i += PENDING_TIMEOUTS) {
+    for (unsigned int j = 0; j < PENDING_TIMEOUTS; j++) {
+      timeouts.RegisterSingleTimeout(
+          TimeInterval(0, 1000 + (j * 997) % 100000),
+          NewSingleCallback(&NoOp));
+    }
+    clock.AdvanceTime(1, 0);
+    clock.CurrentTime(&now);
+    timeouts.ExecuteTimeouts(&now);
+  }
+}
+
+void BenchmarkRegisterCancelHeap(BenchmarkState *state) {
+  RunRegisterCancel(state, false);
+}
+OLA_BENCHMARK(BenchmarkRegisterCancelHeap);
+
+void BenchmarkRegisterCancelTimerWheel(BenchmarkState *state) {
+  RunRegisterCancel(state, true);
+}
+OLA_BENCHMARK(BenchmarkRegisterCancelTimerWheel);
+
+void BenchmarkRegisterExpireHeap(BenchmarkState *state) {
+  RunRegisterExpire(state, false);
+}
+OLA_BENCHMARK(BenchmarkRegisterExpireHeap);
+
+void BenchmarkRegisterExpireTimerWheel(BenchmarkState *state) {
+  RunRegisterExpire(state, true);
+}
+OLA_BENCHMARK(BenchmarkRegisterExpireTimerWheel);
+}  // namespace
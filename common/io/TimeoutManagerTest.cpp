@@ -44,6 +44,7 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRepeatingTimeouts);
   CPPUNIT_TEST(testAbortedRepeatingTimeouts);
   CPPUNIT_TEST(testPendingEventShutdown);
+  CPPUNIT_TEST(testTimerWheel);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -51,6 +52,7 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
     void testRepeatingTimeouts();
     void testAbortedRepeatingTimeouts();
     void testPendingEventShutdown();
+    void testTimerWheel();
 
     void HandleEvent(unsigned int event_id) {
       m_event_counters[event_id]++;
@@ -241,3 +243,37 @@ void TimeoutManagerTest::testPendingEventShutdown() {
 
   OLA_ASSERT_TRUE(timeout_manager.EventsPending());
 }
+
+/*
+ * Check the TimeoutManager works with the TimerWheel.
+ */
+void TimeoutManagerTest::testTimerWheel() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock, true);
+
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+
+  TimeInterval timeout_interval(1, 0);
+  timeout_id id1 = timeout_manager.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimeoutManagerTest::HandleEvent, 1u));
+  OLA_ASSERT_NE(id1, ola::thread::INVALID_TIMEOUT);
+  timeout_id id2 = timeout_manager.RegisterRepeatingTimeout(
+      timeout_interval,
+      NewCallback(this, &TimeoutManagerTest::HandleRepeatingEvent, 2u));
+  OLA_ASSERT_NE(id2, ola::thread::INVALID_TIMEOUT);
+  OLA_ASSERT_EQ(2, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  TimeStamp last_checked_time;
+  clock.AdvanceTime(1, 0);
+  clock.CurrentTime(&last_checked_time);
+  TimeInterval next = timeout_manager.ExecuteTimeouts(&last_checked_time);
+  OLA_ASSERT_EQ(1u, GetEventCounter(1));
+  OLA_ASSERT_EQ(1u, GetEventCounter(2));
+  OLA_ASSERT_LTE(next, timeout_interval);
+
+  // Cancelled timeouts are removed immediately.
+  timeout_manager.CancelTimeout(id2);
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+  OLA_ASSERT_EQ(0, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+}
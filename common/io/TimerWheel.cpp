@@ -0,0 +1,349 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimerWheel.cpp
+ * A hashed timer wheel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/TimerWheel.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ola/Logging.h"
+
+namespace ola {
+namespace io {
+
+using ola::thread::INVALID_TIMEOUT;
+using ola::thread::timeout_id;
+
+const unsigned int TimerWheel::WHEEL_SLOTS;
+const unsigned int TimerWheel::TICK_USECS;
+
+namespace {
+const unsigned int SLOT_MASK = TimerWheel::WHEEL_SLOTS - 1;
+const unsigned int BITS_PER_WORD = 64;
+const unsigned int OCCUPIED_WORDS = TimerWheel::WHEEL_SLOTS / BITS_PER_WORD;
+const int64_t ONE_MILLION = 1000000;
+}  // namespace
+
+TimerWheel::TimerWheel(Clock *clock, IntegerVariable *timer_count)
+    : m_clock(clock),
+      m_timer_var(timer_count),
+      m_timer_count(0),
+      m_current_tick(0),
+      m_free_list(NULL),
+      m_profiler(NULL) {
+  memset(m_slots, 0, sizeof(m_slots));
+  memset(m_occupied, 0, sizeof(m_occupied));
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  m_current_tick = TickFor(now);
+}
+
+TimerWheel::~TimerWheel() {
+  for (unsigned int i = 0; i < WHEEL_SLOTS; i++) {
+    Timer *timer = m_slots[i];
+    while (timer) {
+      Timer *next = timer->next;
+      delete timer->single_closure;
+      delete timer->repeating_closure;
+      delete timer;
+      timer = next;
+    }
+  }
+
+  while (m_free_list) {
+    Timer *next = m_free_list->next;
+    delete m_free_list;
+    m_free_list = next;
+  }
+}
+
+timeout_id TimerWheel::RegisterRepeatingTimeout(
+    const TimeInterval &interval,
+    ola::Callback0<bool> *closure) {
+  if (!closure)
+    return INVALID_TIMEOUT;
+
+  Timer *timer = NewTimer(interval);
+  timer->repeating_closure = closure;
+  Schedule(timer);
+  return timer;
+}
+
+timeout_id TimerWheel::RegisterSingleTimeout(
+    const TimeInterval &interval,
+    ola::SingleUseCallback0<void> *closure) {
+  if (!closure)
+    return INVALID_TIMEOUT;
+
+  Timer *timer = NewTimer(interval);
+  timer->single_closure = closure;
+  Schedule(timer);
+  return timer;
+}
+
+void TimerWheel::CancelTimeout(timeout_id id) {
+  if (id == INVALID_TIMEOUT)
+    return;
+
+  Timer *timer = static_cast<Timer*>(id);
+  switch (timer->state) {
+    case TIMER_SCHEDULED:
+      Unlink(timer);
+      Release(timer);
+      break;
+    case TIMER_EXPIRED:
+      // The timer is waiting to run, or is running. It'll be released by
+      // ExecuteTimeouts().
+      timer->state = TIMER_CANCELLED;
+      break;
+    case TIMER_CANCELLED:
+    case TIMER_FREE:
+      // Already cancelled, or it's already fired.
+      break;
+  }
+}
+
+TimeInterval TimerWheel::ExecuteTimeouts(TimeStamp *now) {
+  uint64_t now_tick = TickFor(*now);
+  if (m_timer_count == 0 || now_tick < m_current_tick) {
+    m_current_tick = std::max(m_current_tick, now_tick);
+    return TimeToNextEvent(*now);
+  }
+
+  // Collect the expired timers from each slot we've passed since the last
+  // call, including the current one.
+  uint64_t ticks = std::min(now_tick - m_current_tick + 1,
+                            static_cast<uint64_t>(WHEEL_SLOTS));
+  for (uint64_t i = 0; i < ticks; i++) {
+    unsigned int slot = static_cast<unsigned int>(
+        (m_current_tick + i) & SLOT_MASK);
+    Timer *timer = m_slots[slot];
+    while (timer) {
+      Timer *next = timer->next;
+      if (timer->expiry <= *now) {
+        Unlink(timer);
+        timer->state = TIMER_EXPIRED;
+        m_expired.push_back(timer);
+      }
+      timer = next;
+    }
+  }
+  m_current_tick = now_tick;
+
+  // Run them in order of expiry, as the TimeoutManager does.
+  std::sort(m_expired.begin(), m_expired.end(), ExpiresBefore);
+  TimerList::iterator iter = m_expired.begin();
+  for (; iter != m_expired.end(); ++iter) {
+    if ((*iter)->state == TIMER_CANCELLED) {
+      Release(*iter);
+      continue;
+    }
+    RunTimer(*iter, *now);
+    m_clock->CurrentTime(now);
+  }
+  m_expired.clear();
+  return TimeToNextEvent(*now);
+}
+
+TimerWheel::Timer *TimerWheel::NewTimer(const TimeInterval &interval) {
+  Timer *timer = m_free_list;
+  if (timer) {
+    m_free_list = timer->next;
+  } else {
+    timer = new Timer();
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  timer->next = NULL;
+  timer->prev = NULL;
+  timer->state = TIMER_FREE;
+  timer->tick = 0;
+  timer->expiry = now + interval;
+  timer->interval = interval;
+  timer->single_closure = NULL;
+  timer->repeating_closure = NULL;
+
+  m_timer_count++;
+  if (m_timer_var)
+    (*m_timer_var)++;
+  return timer;
+}
+
+/*
+ * Add a timer to the slot for its expiry time. Timers that should have
+ * already expired go in the current slot.
+ */
+void TimerWheel::Schedule(Timer *timer) {
+  timer->tick = std::max(TickFor(timer->expiry), m_current_tick);
+  timer->state = TIMER_SCHEDULED;
+
+  unsigned int slot = static_cast<unsigned int>(timer->tick & SLOT_MASK);
+  timer->prev = NULL;
+  timer->next = m_slots[slot];
+  if (timer->next)
+    timer->next->prev = timer;
+  m_slots[slot] = timer;
+  m_occupied[slot / BITS_PER_WORD] |=
+      static_cast<uint64_t>(1) << (slot % BITS_PER_WORD);
+}
+
+void TimerWheel::Unlink(Timer *timer) {
+  unsigned int slot = static_cast<unsigned int>(timer->tick & SLOT_MASK);
+  if (timer->prev) {
+    timer->prev->next = timer->next;
+  } else {
+    m_slots[slot] = timer->next;
+  }
+  if (timer->next)
+    timer->next->prev = timer->prev;
+  timer->next = NULL;
+  timer->prev = NULL;
+
+  if (!m_slots[slot]) {
+    m_occupied[slot / BITS_PER_WORD] &=
+        ~(static_cast<uint64_t>(1) << (slot % BITS_PER_WORD));
+  }
+}
+
+/*
+ * Delete the closures and return the timer to the free list.
+ */
+void TimerWheel::Release(Timer *timer) {
+  delete timer->single_closure;
+  timer->single_closure = NULL;
+  delete timer->repeating_closure;
+  timer->repeating_closure = NULL;
+
+  timer->state = TIMER_FREE;
+  timer->next = m_free_list;
+  m_free_list = timer;
+
+  m_timer_count--;
+  if (m_timer_var)
+    (*m_timer_var)--;
+}
+
+void TimerWheel::RunTimer(Timer *timer, const TimeStamp &now) {
+  TimeStamp start;
+  if (m_profiler) {
+    m_profiler->TimeoutLag(timer->expiry, now);
+    start = m_profiler->Now();
+  }
+
+  bool repeat = false;
+  if (timer->single_closure) {
+    ola::BaseCallback0<void> *closure = timer->single_closure;
+    // it deletes itself once run
+    timer->single_closure = NULL;
+    closure->Run();
+  } else if (timer->repeating_closure) {
+    repeat = timer->repeating_closure->Run();
+  }
+
+  if (m_profiler) {
+    m_profiler->TimeoutDone(timer, start);
+  }
+
+  // The closure may have cancelled the timer.
+  if (repeat && timer->state == TIMER_EXPIRED) {
+    timer->expiry = now + timer->interval;
+    Schedule(timer);
+  } else {
+    if (m_profiler) {
+      m_profiler->RemoveTimeoutName(timer);
+    }
+    Release(timer);
+  }
+}
+
+/*
+ * Find the first non-empty slot at or after start, wrapping around.
+ */
+bool TimerWheel::NextOccupiedSlot(unsigned int start,
+                                  unsigned int *slot) const {
+  unsigned int word = start / BITS_PER_WORD;
+  uint64_t bits = m_occupied[word] &
+      (~static_cast<uint64_t>(0) << (start % BITS_PER_WORD));
+
+  // The start word is checked twice, the second time for the bits before
+  // start.
+  for (unsigned int i = 0; i <= OCCUPIED_WORDS; i++) {
+    if (bits) {
+      *slot = word * BITS_PER_WORD + __builtin_ctzll(bits);
+      return true;
+    }
+    word = (word + 1) % OCCUPIED_WORDS;
+    bits = m_occupied[word];
+  }
+  return false;
+}
+
+/*
+ * Find the earliest timer in the next turn of the wheel. Slots may contain
+ * timers from later turns, which are skipped.
+ */
+TimeInterval TimerWheel::TimeToNextEvent(const TimeStamp &now) const {
+  if (m_timer_count == 0)
+    return TimeInterval();
+
+  unsigned int start = static_cast<unsigned int>(m_current_tick & SLOT_MASK);
+  unsigned int offset = 0;
+  unsigned int slot;
+  while (offset < WHEEL_SLOTS &&
+         NextOccupiedSlot((start + offset) & SLOT_MASK, &slot)) {
+    unsigned int slot_offset = (slot - start) & SLOT_MASK;
+    if (slot_offset < offset) {
+      // we've wrapped
+      break;
+    }
+
+    uint64_t tick = m_current_tick + slot_offset;
+    const Timer *next = NULL;
+    for (const Timer *timer = m_slots[slot]; timer; timer = timer->next) {
+      if (timer->tick == tick && (!next || ExpiresBefore(timer, next)))
+        next = timer;
+    }
+
+    if (next) {
+      if (next->expiry <= now) {
+        return TimeInterval(0, 1);
+      }
+      return next->expiry - now;
+    }
+    offset = slot_offset + 1;
+  }
+  // Nothing in this turn of the wheel, check again after one turn.
+  return TimeInterval(static_cast<int64_t>(WHEEL_SLOTS) * TICK_USECS);
+}
+
+uint64_t TimerWheel::TickFor(const TimeStamp &time) {
+  return static_cast<uint64_t>(time.Seconds() * ONE_MILLION +
+                               time.MicroSeconds()) / TICK_USECS;
+}
+
+bool TimerWheel::ExpiresBefore(const Timer *t1, const Timer *t2) {
+  return t1->expiry < t2->expiry;
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,170 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimerWheel.h
+ * A hashed timer wheel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_TIMERWHEEL_H_
+#define COMMON_IO_TIMERWHEEL_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "common/io/LoopProfiler.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+namespace io {
+
+/**
+ * @class TimerWheel
+ * @brief A hashed timer wheel.
+ *
+ * Timers are hashed into one of WHEEL_SLOTS slots by their expiry tick, so
+ * registering and cancelling a timer is O(1). Timers further away than a
+ * full turn of the wheel share a slot with nearer timers and are skipped
+ * until their turn comes around.
+ *
+ * Unlike the priority queue in the TimeoutManager, cancelled timers are
+ * unlinked immediately rather than being kept until they expire. Timer nodes
+ * are pooled and reused.
+ *
+ * Each timer keeps its exact expiry time, ticks only determine which slot it
+ * lives in.
+ */
+class TimerWheel {
+ public :
+  /**
+   * @brief Create a new TimerWheel.
+   * @param clock the Clock to use.
+   * @param timer_count the variable to update with the number of timers, may
+   *   be NULL.
+   */
+  TimerWheel(Clock *clock, IntegerVariable *timer_count);
+
+  ~TimerWheel();
+
+  /**
+   * @brief Register a repeating timeout.
+   * @param interval the delay between calls.
+   * @param closure the Callback to invoke, ownership is transferred.
+   * @returns the id of the timeout.
+   */
+  ola::thread::timeout_id RegisterRepeatingTimeout(
+      const ola::TimeInterval &interval,
+      ola::Callback0<bool> *closure);
+
+  /**
+   * @brief Register a single use timeout.
+   * @param interval the delay before the closure is run.
+   * @param closure the Callback to invoke, ownership is transferred.
+   * @returns the id of the timeout.
+   */
+  ola::thread::timeout_id RegisterSingleTimeout(
+      const ola::TimeInterval &interval,
+      ola::SingleUseCallback0<void> *closure);
+
+  /**
+   * @brief Cancel a timeout.
+   * @param id the id of the timeout.
+   */
+  void CancelTimeout(ola::thread::timeout_id id);
+
+  /**
+   * @brief Check if there are any timeouts registered.
+   */
+  bool EventsPending() const { return m_timer_count > 0; }
+
+  /**
+   * @brief Execute any expired timeouts.
+   * @param[in,out] now the current time, set to the last time events were
+   * checked.
+   * @returns the time until the next event, or an upper bound if the next
+   * event is more than one turn of the wheel away.
+   */
+  TimeInterval ExecuteTimeouts(TimeStamp *now);
+
+  /**
+   * @brief Set the LoopProfiler to record the time spent in timeouts with.
+   * @param profiler the LoopProfiler to use, ownership is not transferred.
+   */
+  void SetProfiler(LoopProfiler *profiler) { m_profiler = profiler; }
+
+  /**
+   * @brief The number of slots in the wheel.
+   */
+  static const unsigned int WHEEL_SLOTS = 4096;
+
+  /**
+   * @brief The width of each slot.
+   */
+  static const unsigned int TICK_USECS = 1000;
+
+ private:
+  enum TimerState {
+    TIMER_FREE,
+    TIMER_SCHEDULED,
+    TIMER_EXPIRED,
+    TIMER_CANCELLED
+  };
+
+  struct Timer {
+    Timer *next;
+    Timer *prev;
+    TimerState state;
+    uint64_t tick;
+    TimeStamp expiry;
+    TimeInterval interval;
+    ola::BaseCallback0<void> *single_closure;
+    ola::BaseCallback0<bool> *repeating_closure;
+  };
+
+  typedef std::vector<Timer*> TimerList;
+
+  Clock *m_clock;
+  IntegerVariable *m_timer_var;
+  unsigned int m_timer_count;
+  uint64_t m_current_tick;
+  // The head of the list of timers in each slot.
+  Timer *m_slots[WHEEL_SLOTS];
+  // One bit per slot, set if the slot is non-empty.
+  uint64_t m_occupied[WHEEL_SLOTS / 64];
+  Timer *m_free_list;
+  TimerList m_expired;
+  LoopProfiler *m_profiler;
+
+  Timer *NewTimer(const TimeInterval &interval);
+  void Schedule(Timer *timer);
+  void Unlink(Timer *timer);
+  void Release(Timer *timer);
+  void RunTimer(Timer *timer, const TimeStamp &now);
+  bool NextOccupiedSlot(unsigned int start, unsigned int *slot) const;
+  TimeInterval TimeToNextEvent(const TimeStamp &now) const;
+
+  static uint64_t TickFor(const TimeStamp &time);
+  static bool ExpiresBefore(const Timer *t1, const Timer *t2);
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_TIMERWHEEL_H_
@@ -0,0 +1,274 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * TimerWheelTest.cpp
+ * Test fixture for the TimerWheel class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+#include "common/io/TimerWheel.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::ExportMap;
+using ola::IntegerVariable;
+using ola::MockClock;
+using ola::NewSingleCallback;
+using ola::NewCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::TimerWheel;
+using ola::thread::timeout_id;
+using std::vector;
+
+class TimerWheelTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TimerWheelTest);
+  CPPUNIT_TEST(testSingleTimeouts);
+  CPPUNIT_TEST(testRepeatingTimeouts);
+  CPPUNIT_TEST(testOrdering);
+  CPPUNIT_TEST(testLongTimeouts);
+  CPPUNIT_TEST(testCancelFromCallback);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    TimerWheelTest() : m_wheel(NULL) {}
+
+    void setUp() {
+      m_timer_var = m_map.GetIntegerVar("ss-timers");
+    }
+
+    void testSingleTimeouts();
+    void testRepeatingTimeouts();
+    void testOrdering();
+    void testLongTimeouts();
+    void testCancelFromCallback();
+
+    void HandleEvent(unsigned int event_id) {
+      m_events.push_back(event_id);
+    }
+
+    bool HandleRepeatingEvent(unsigned int event_id) {
+      m_events.push_back(event_id);
+      return true;
+    }
+
+    bool CancelSelf(unsigned int event_id) {
+      m_events.push_back(event_id);
+      m_wheel->CancelTimeout(m_cancel_id);
+      return true;
+    }
+
+    void CancelOther(unsigned int event_id) {
+      m_events.push_back(event_id);
+      m_wheel->CancelTimeout(m_cancel_id);
+    }
+
+ private:
+    ExportMap m_map;
+    IntegerVariable *m_timer_var;
+    TimerWheel *m_wheel;
+    timeout_id m_cancel_id;
+    vector<unsigned int> m_events;
+
+    TimeInterval Advance(MockClock *clock, TimerWheel *wheel,
+                         int32_t sec, int32_t usec) {
+      clock->AdvanceTime(sec, usec);
+      TimeStamp now;
+      clock->CurrentTime(&now);
+      return wheel->ExecuteTimeouts(&now);
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
+
+/*
+ * Check single timeouts fire once, and can be cancelled.
+ */
+void TimerWheelTest::testSingleTimeouts() {
+  MockClock clock;
+  TimerWheel wheel(&clock, m_timer_var);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+
+  TimeInterval timeout_interval(1, 0);
+  timeout_id id1 = wheel.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 1u));
+  OLA_ASSERT_NE(id1, ola::thread::INVALID_TIMEOUT);
+  OLA_ASSERT_TRUE(wheel.EventsPending());
+  OLA_ASSERT_EQ(1, m_timer_var->Get());
+
+  TimeInterval next = Advance(&clock, &wheel, 0, 1);
+  OLA_ASSERT_TRUE(m_events.empty());
+  OLA_ASSERT_LTE(next, TimeInterval(0, 999999));
+  OLA_ASSERT_GT(next, TimeInterval(0, 900000));
+
+  next = Advance(&clock, &wheel, 0, 500000);
+  OLA_ASSERT_TRUE(m_events.empty());
+  OLA_ASSERT_LTE(next, TimeInterval(0, 499999));
+  OLA_ASSERT_GT(next, TimeInterval(0, 400000));
+
+  next = Advance(&clock, &wheel, 0, 500000);
+  OLA_ASSERT_TRUE(next.IsZero());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_events.size());
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  OLA_ASSERT_EQ(0, m_timer_var->Get());
+
+  // Cancelling removes the timeout immediately.
+  timeout_id id2 = wheel.RegisterSingleTimeout(
+      timeout_interval,
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 2u));
+  OLA_ASSERT_TRUE(wheel.EventsPending());
+  wheel.CancelTimeout(id2);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  OLA_ASSERT_EQ(0, m_timer_var->Get());
+
+  // Cancelling a timeout that has already fired is a no-op.
+  wheel.CancelTimeout(id1);
+
+  next = Advance(&clock, &wheel, 2, 0);
+  OLA_ASSERT_TRUE(next.IsZero());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_events.size());
+}
+
+/*
+ * Check repeating timeouts.
+ */
+void TimerWheelTest::testRepeatingTimeouts() {
+  MockClock clock;
+  TimerWheel wheel(&clock, m_timer_var);
+
+  TimeInterval timeout_interval(0, 250000);
+  timeout_id id1 = wheel.RegisterRepeatingTimeout(
+      timeout_interval,
+      NewCallback(this, &TimerWheelTest::HandleRepeatingEvent, 1u));
+
+  for (unsigned int i = 1; i <= 10; i++) {
+    TimeInterval next = Advance(&clock, &wheel, 0, 250000);
+    OLA_ASSERT_EQ(static_cast<size_t>(i), m_events.size());
+    OLA_ASSERT_LTE(next, timeout_interval);
+    OLA_ASSERT_GT(next, TimeInterval(0, 200000));
+  }
+
+  wheel.CancelTimeout(id1);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  OLA_ASSERT_TRUE(Advance(&clock, &wheel, 1, 0).IsZero());
+  OLA_ASSERT_EQ(static_cast<size_t>(10), m_events.size());
+}
+
+/*
+ * Check timeouts run in order of expiry.
+ */
+void TimerWheelTest::testOrdering() {
+  MockClock clock;
+  TimerWheel wheel(&clock, m_timer_var);
+
+  wheel.RegisterSingleTimeout(
+      TimeInterval(0, 300000),
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 3u));
+  wheel.RegisterSingleTimeout(
+      TimeInterval(0, 100000),
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 1u));
+  // Within a millisecond of the first, but earlier.
+  wheel.RegisterSingleTimeout(
+      TimeInterval(0, 299500),
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 2u));
+
+  TimeInterval next = Advance(&clock, &wheel, 0, 0);
+  OLA_ASSERT_LTE(next, TimeInterval(0, 100000));
+  OLA_ASSERT_GT(next, TimeInterval(0, 50000));
+
+  next = Advance(&clock, &wheel, 1, 0);
+  OLA_ASSERT_TRUE(next.IsZero());
+
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_events.size());
+  OLA_ASSERT_EQ(1u, m_events[0]);
+  OLA_ASSERT_EQ(2u, m_events[1]);
+  OLA_ASSERT_EQ(3u, m_events[2]);
+}
+
+/*
+ * Check timeouts more than one turn of the wheel away.
+ */
+void TimerWheelTest::testLongTimeouts() {
+  MockClock clock;
+  TimerWheel wheel(&clock, m_timer_var);
+
+  const int64_t turn_usecs =
+      static_cast<int64_t>(TimerWheel::WHEEL_SLOTS) * TimerWheel::TICK_USECS;
+
+  // Shares a slot with the short timeout.
+  wheel.RegisterSingleTimeout(
+      TimeInterval(turn_usecs + 1000),
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 2u));
+  wheel.RegisterSingleTimeout(
+      TimeInterval(0, 1000),
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 1u));
+
+  TimeInterval next = Advance(&clock, &wheel, 0, 1000);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_events.size());
+  // The long timeout is beyond this turn of the wheel.
+  OLA_ASSERT_EQ(TimeInterval(turn_usecs), next);
+  OLA_ASSERT_TRUE(wheel.EventsPending());
+
+  next = Advance(&clock, &wheel, 2, 0);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_events.size());
+  OLA_ASSERT_LTE(next, TimeInterval(turn_usecs - 2000000));
+  OLA_ASSERT_GT(next, TimeInterval(turn_usecs - 2100000));
+
+  Advance(&clock, &wheel, 10, 0);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_events.size());
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+}
+
+/*
+ * Check timeouts can be cancelled from within callbacks.
+ */
+void TimerWheelTest::testCancelFromCallback() {
+  MockClock clock;
+  TimerWheel wheel(&clock, m_timer_var);
+  m_wheel = &wheel;
+
+  // A repeating timeout that cancels itself.
+  m_cancel_id = wheel.RegisterRepeatingTimeout(
+      TimeInterval(0, 1000),
+      NewCallback(this, &TimerWheelTest::CancelSelf, 1u));
+  Advance(&clock, &wheel, 1, 0);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_events.size());
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  OLA_ASSERT_EQ(0, m_timer_var->Get());
+
+  // A timeout that cancels another which has also expired.
+  m_events.clear();
+  wheel.RegisterSingleTimeout(
+      TimeInterval(0, 1000),
+      NewSingleCallback(this, &TimerWheelTest::CancelOther, 1u));
+  m_cancel_id = wheel.RegisterSingleTimeout(
+      TimeInterval(0, 2000),
+      NewSingleCallback(this, &TimerWheelTest::HandleEvent, 2u));
+  Advance(&clock, &wheel, 1, 0);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_events.size());
+  OLA_ASSERT_EQ(1u, m_events[0]);
+  OLA_ASSERT_FALSE(wheel.EventsPending());
+  OLA_ASSERT_EQ(0, m_timer_var->Get());
+  m_wheel = NULL;
+}
@@ -102,6 +102,129 @@ void FieldDescriptorGroup::PopulateIfRequired() const {
 }
 
 
+/**
+ * Appends the fields of a descriptor to a FlatLayout.
+ */
+class FlatLayout::Builder: public FieldDescriptorVisitor {
+ public:
+  explicit Builder(FlatLayout *layout)
+      : m_layout(layout),
+        m_depth(0) {
+  }
+
+  // Groups are handled in Visit().
+  bool Descend() const { return false; }
+
+  void Visit(const BoolFieldDescriptor *descriptor) {
+    AddField(FlatLayout::BOOL, descriptor);
+  }
+  void Visit(const IPV4FieldDescriptor *descriptor) {
+    AddField(FlatLayout::IPV4, descriptor);
+  }
+  void Visit(const MACFieldDescriptor *descriptor) {
+    AddField(FlatLayout::MAC, descriptor);
+  }
+  void Visit(const UIDFieldDescriptor *descriptor) {
+    AddField(FlatLayout::UID, descriptor);
+  }
+  void Visit(const StringFieldDescriptor *descriptor);
+  void Visit(const UInt8FieldDescriptor *descriptor) {
+    AddField(FlatLayout::UINT8, descriptor);
+  }
+  void Visit(const UInt16FieldDescriptor *descriptor) {
+    AddField(FlatLayout::UINT16, descriptor);
+  }
+  void Visit(const UInt32FieldDescriptor *descriptor) {
+    AddField(FlatLayout::UINT32, descriptor);
+  }
+  void Visit(const Int8FieldDescriptor *descriptor) {
+    AddField(FlatLayout::INT8, descriptor);
+  }
+  void Visit(const Int16FieldDescriptor *descriptor) {
+    AddField(FlatLayout::INT16, descriptor);
+  }
+  void Visit(const Int32FieldDescriptor *descriptor) {
+    AddField(FlatLayout::INT32, descriptor);
+  }
+  void Visit(const FieldDescriptorGroup *descriptor);
+  void PostVisit(const FieldDescriptorGroup*) {}
+
+ private:
+  FlatLayout *m_layout;
+  unsigned int m_depth;
+
+  void AddField(FlatLayout::FieldType type,
+                const FieldDescriptor *descriptor,
+                bool variable = false,
+                unsigned int size = 0);
+};
+
+
+void FlatLayout::Builder::Visit(const StringFieldDescriptor *descriptor) {
+  if (descriptor->FixedSize()) {
+    AddField(FlatLayout::STRING, descriptor);
+  } else {
+    if (!m_depth) {
+      m_layout->m_variable_strings.push_back(descriptor);
+    }
+    AddField(FlatLayout::STRING, descriptor, true, 0);
+  }
+}
+
+
+void FlatLayout::Builder::Visit(const FieldDescriptorGroup *descriptor) {
+  bool fixed_size = descriptor->FixedSize();
+  if (!m_depth) {
+    if (fixed_size) {
+      m_layout->m_fixed_size += descriptor->MaxSize();
+    } else {
+      m_layout->m_variable_groups.push_back(descriptor);
+    }
+  }
+
+  unsigned int start = m_layout->m_fields.size();
+  const unsigned int blocks = fixed_size ?
+      static_cast<unsigned int>(descriptor->MinBlocks()) : 0;
+  Field field = {GROUP_START, descriptor, !fixed_size, blocks, 0};
+  m_layout->m_fields.push_back(field);
+
+  m_depth++;
+  for (unsigned int i = 0; i < descriptor->FieldCount(); ++i) {
+    descriptor->GetField(i)->Accept(this);
+  }
+  m_depth--;
+
+  Field end = {GROUP_END, descriptor, false, 0, 0};
+  m_layout->m_fields[start].end = m_layout->m_fields.size();
+  m_layout->m_fields.push_back(end);
+}
+
+
+void FlatLayout::Builder::AddField(FlatLayout::FieldType type,
+                                   const FieldDescriptor *descriptor,
+                                   bool variable,
+                                   unsigned int size) {
+  if (!variable) {
+    size = descriptor->MaxSize();
+    if (!m_depth) {
+      m_layout->m_fixed_size += size;
+    }
+  }
+  Field field = {type, descriptor, variable, size, 0};
+  m_layout->m_fields.push_back(field);
+}
+
+
+FlatLayout::FlatLayout(const vector<const FieldDescriptor*> &fields)
+    : m_fixed_size(0) {
+  Builder builder(this);
+  vector<const FieldDescriptor*>::const_iterator iter = fields.begin();
+  for (; iter != fields.end(); ++iter) {
+    (*iter)->Accept(&builder);
+  }
+}
+
+
 void Descriptor::Accept(FieldDescriptorVisitor *visitor) const {
   vector<const FieldDescriptor*>::const_iterator iter = m_fields.begin();
   for (; iter != m_fields.end(); ++iter)
@@ -31,8 +31,10 @@ using std::vector;
 
 
 using ola::messaging::BoolFieldDescriptor;
+using ola::messaging::Descriptor;
 using ola::messaging::FieldDescriptor;
 using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::FlatLayout;
 using ola::messaging::IPV4FieldDescriptor;
 using ola::messaging::StringFieldDescriptor;
 using ola::messaging::UIDFieldDescriptor;
@@ -45,6 +47,7 @@ class DescriptorTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testFieldDescriptors);
   CPPUNIT_TEST(testFieldDescriptorGroup);
   CPPUNIT_TEST(testIntervalsAndLabels);
+  CPPUNIT_TEST(testFlatLayout);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -52,6 +55,7 @@ class DescriptorTest: public CppUnit::TestFixture {
     void testFieldDescriptors();
     void testFieldDescriptorGroup();
     void testIntervalsAndLabels();
+    void testFlatLayout();
 };
 
 
@@ -347,3 +351,54 @@ void DescriptorTest::testIntervalsAndLabels() {
   OLA_ASSERT_TRUE(uint16_descriptor2.IsValid(255));
   OLA_ASSERT_TRUE(uint16_descriptor2.IsValid(65535));
 }
+
+
+/**
+ * Check the fields of a Descriptor are flattened.
+ */
+void DescriptorTest::testFlatLayout() {
+  vector<const FieldDescriptor*> inner_fields;
+  inner_fields.push_back(new BoolFieldDescriptor("bool"));
+  inner_fields.push_back(new UInt16FieldDescriptor("uint16"));
+
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new UInt8FieldDescriptor("uint8"));
+  fields.push_back(new FieldDescriptorGroup("fixed", inner_fields, 2, 2));
+  fields.push_back(new StringFieldDescriptor("string", 0, 32));
+  Descriptor descriptor("test", fields);
+
+  const FlatLayout &layout = descriptor.Layout();
+  OLA_ASSERT_EQ(7u, layout.FixedSize());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), layout.VariableStrings().size());
+  OLA_ASSERT_TRUE(layout.VariableGroups().empty());
+
+  const vector<FlatLayout::Field> &flat_fields = layout.Fields();
+  OLA_ASSERT_EQ(static_cast<size_t>(6), flat_fields.size());
+  OLA_ASSERT_EQ(FlatLayout::UINT8, flat_fields[0].type);
+  OLA_ASSERT_EQ(1u, flat_fields[0].size);
+  OLA_ASSERT_EQ(FlatLayout::GROUP_START, flat_fields[1].type);
+  OLA_ASSERT_FALSE(flat_fields[1].variable);
+  OLA_ASSERT_EQ(2u, flat_fields[1].size);
+  OLA_ASSERT_EQ(4u, flat_fields[1].end);
+  OLA_ASSERT_EQ(FlatLayout::BOOL, flat_fields[2].type);
+  OLA_ASSERT_EQ(FlatLayout::UINT16, flat_fields[3].type);
+  OLA_ASSERT_EQ(2u, flat_fields[3].size);
+  OLA_ASSERT_EQ(FlatLayout::GROUP_END, flat_fields[4].type);
+  OLA_ASSERT_EQ(FlatLayout::STRING, flat_fields[5].type);
+  OLA_ASSERT_TRUE(flat_fields[5].variable);
+
+  // A group with a variable number of blocks.
+  vector<const FieldDescriptor*> block_fields;
+  block_fields.push_back(new UInt16FieldDescriptor("uint16"));
+  vector<const FieldDescriptor*> group_fields;
+  group_fields.push_back(new FieldDescriptorGroup("group", block_fields, 0,
+                                                  4));
+  Descriptor group_descriptor("group", group_fields);
+
+  const FlatLayout &group_layout = group_descriptor.Layout();
+  OLA_ASSERT_EQ(0u, group_layout.FixedSize());
+  OLA_ASSERT_EQ(static_cast<size_t>(1),
+                group_layout.VariableGroups().size());
+  OLA_ASSERT_EQ(static_cast<size_t>(3), group_layout.Fields().size());
+  OLA_ASSERT_TRUE(group_layout.Fields()[0].variable);
+}
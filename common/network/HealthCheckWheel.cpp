@@ -0,0 +1,122 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HealthCheckWheel.cpp
+ * Runs the health checks for many connections from a single timer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/network/HealthCheckWheel.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace network {
+
+using std::vector;
+
+HealthCheckWheel::HealthCheckWheel(
+    ola::thread::SchedulerInterface *scheduler,
+    const TimeInterval &heartbeat_interval,
+    unsigned int slot_count)
+    : m_scheduler(scheduler),
+      m_tick_interval(heartbeat_interval.AsInt() /
+                      std::max(slot_count, 1u)),
+      m_timeout_ticks((5 * std::max(slot_count, 1u) + 1) / 2),
+      m_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_current_tick(0),
+      m_next_slot(0),
+      m_slots(std::max(slot_count, 1u)) {
+}
+
+HealthCheckWheel::~HealthCheckWheel() {
+  if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout_id);
+  }
+}
+
+void HealthCheckWheel::AddConnection(Connection *connection) {
+  if (STLContains(m_connections, connection)) {
+    return;
+  }
+
+  // Round robin keeps the slots balanced as connections come and go.
+  ConnectionState state = {m_next_slot, m_current_tick};
+  m_next_slot = (m_next_slot + 1) % m_slots.size();
+  m_connections[connection] = state;
+  m_slots[state.slot].push_back(connection);
+
+  if (m_timeout_id == ola::thread::INVALID_TIMEOUT) {
+    m_timeout_id = m_scheduler->RegisterRepeatingTimeout(
+        m_tick_interval,
+        NewCallback(this, &HealthCheckWheel::Tick));
+  }
+  connection->SendHeartbeat();
+}
+
+void HealthCheckWheel::RemoveConnection(Connection *connection) {
+  ConnectionMap::iterator iter = m_connections.find(connection);
+  if (iter == m_connections.end()) {
+    return;
+  }
+
+  Slot *slot = &m_slots[iter->second.slot];
+  Slot::iterator slot_iter = std::find(slot->begin(), slot->end(),
+                                       connection);
+  if (slot_iter != slot->end()) {
+    *slot_iter = slot->back();
+    slot->pop_back();
+  }
+  m_connections.erase(iter);
+}
+
+void HealthCheckWheel::HeartbeatReceived(Connection *connection) {
+  ConnectionState *state = STLFind(&m_connections, connection);
+  if (state) {
+    state->last_received_tick = m_current_tick;
+  }
+}
+
+bool HealthCheckWheel::Tick() {
+  m_current_tick++;
+  const Slot &slot = m_slots[m_current_tick % m_slots.size()];
+
+  vector<Connection*> dead;
+  Slot::const_iterator iter = slot.begin();
+  for (; iter != slot.end(); ++iter) {
+    const ConnectionState *state = STLFind(&m_connections, *iter);
+    if (m_current_tick - state->last_received_tick >= m_timeout_ticks) {
+      dead.push_back(*iter);
+    } else {
+      (*iter)->SendHeartbeat();
+    }
+  }
+
+  // The timeout handlers may remove other connections, so the slot isn't
+  // touched after this point.
+  for (iter = dead.begin(); iter != dead.end(); ++iter) {
+    RemoveConnection(*iter);
+  }
+  for (iter = dead.begin(); iter != dead.end(); ++iter) {
+    (*iter)->HeartbeatTimeout();
+  }
+  return true;
+}
+}  // namespace network
+}  // namespace ola
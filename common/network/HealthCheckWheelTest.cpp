@@ -0,0 +1,216 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HealthCheckWheelTest.cpp
+ * Test fixture for the HealthCheckWheel class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/network/HealthCheckWheel.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/SchedulerInterface.h"
+
+
+using ola::TimeInterval;
+using ola::network::HealthCheckWheel;
+using ola::thread::timeout_id;
+using std::auto_ptr;
+
+/*
+ * Captures the wheel's repeating timer, so the test can run the ticks.
+ */
+class FakeScheduler: public ola::thread::SchedulerInterface {
+ public:
+  FakeScheduler() : m_registrations(0) {}
+
+  timeout_id RegisterRepeatingTimeout(unsigned int,
+                                      ola::Callback0<bool> *callback) {
+    return RegisterRepeatingTimeout(TimeInterval(), callback);
+  }
+
+  timeout_id RegisterRepeatingTimeout(const TimeInterval &period,
+                                      ola::Callback0<bool> *callback) {
+    m_period = period;
+    m_callback.reset(callback);
+    m_registrations++;
+    return &m_callback;
+  }
+
+  timeout_id RegisterSingleTimeout(unsigned int,
+                                   ola::SingleUseCallback0<void> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  timeout_id RegisterSingleTimeout(const TimeInterval&,
+                                   ola::SingleUseCallback0<void> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  void RemoveTimeout(timeout_id) { m_callback.reset(); }
+
+  void Tick(unsigned int count = 1) {
+    for (unsigned int i = 0; i < count; i++) {
+      OLA_ASSERT_NOT_NULL(m_callback.get());
+      OLA_ASSERT_TRUE(m_callback->Run());
+    }
+  }
+
+  bool Registered() const { return m_callback.get() != NULL; }
+  const TimeInterval &Period() const { return m_period; }
+  unsigned int Registrations() const { return m_registrations; }
+
+ private:
+  auto_ptr<ola::Callback0<bool> > m_callback;
+  TimeInterval m_period;
+  unsigned int m_registrations;
+};
+
+
+class MockConnection: public HealthCheckWheel::Connection {
+ public:
+  MockConnection() : heartbeats(0), timeouts(0) {}
+
+  void SendHeartbeat() { heartbeats++; }
+  void HeartbeatTimeout() { timeouts++; }
+
+  unsigned int heartbeats;
+  unsigned int timeouts;
+};
+
+
+class HealthCheckWheelTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HealthCheckWheelTest);
+  CPPUNIT_TEST(testHeartbeats);
+  CPPUNIT_TEST(testTimeout);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testHeartbeats();
+  void testTimeout();
+  void testRemove();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HealthCheckWheelTest);
+
+
+/*
+ * Check each connection gets one heartbeat per interval.
+ */
+void HealthCheckWheelTest::testHeartbeats() {
+  FakeScheduler scheduler;
+  HealthCheckWheel wheel(&scheduler, TimeInterval(5, 0), 4);
+  OLA_ASSERT_FALSE(scheduler.Registered());
+
+  MockConnection connections[10];
+  for (unsigned int i = 0; i < 10; i++) {
+    wheel.AddConnection(&connections[i]);
+    OLA_ASSERT_EQ(1u, connections[i].heartbeats);
+  }
+  OLA_ASSERT_EQ(10u, wheel.ConnectionCount());
+  OLA_ASSERT_EQ(1u, scheduler.Registrations());
+  OLA_ASSERT_EQ(TimeInterval(1, 250000), scheduler.Period());
+
+  // adding a connection twice is a no-op
+  wheel.AddConnection(&connections[0]);
+  OLA_ASSERT_EQ(1u, connections[0].heartbeats);
+  OLA_ASSERT_EQ(10u, wheel.ConnectionCount());
+
+  // one heartbeat per turn of the wheel, as long as data keeps arriving
+  for (unsigned int turn = 0; turn < 5; turn++) {
+    for (unsigned int i = 0; i < 10; i++) {
+      wheel.HeartbeatReceived(&connections[i]);
+    }
+    scheduler.Tick(4);
+    for (unsigned int i = 0; i < 10; i++) {
+      OLA_ASSERT_EQ(turn + 2, connections[i].heartbeats);
+      OLA_ASSERT_EQ(0u, connections[i].timeouts);
+    }
+  }
+}
+
+
+/*
+ * Check connections that stop receiving are timed out.
+ */
+void HealthCheckWheelTest::testTimeout() {
+  FakeScheduler scheduler;
+  HealthCheckWheel wheel(&scheduler, TimeInterval(5, 0), 4);
+
+  MockConnection healthy, dead;
+  wheel.AddConnection(&healthy);
+  wheel.AddConnection(&dead);
+
+  // 2.5 intervals is 10 ticks, the dead connection's slot is visited on ticks
+  // 1, 5, 9 and 13.
+  for (unsigned int i = 0; i < 3; i++) {
+    wheel.HeartbeatReceived(&healthy);
+    scheduler.Tick(4);
+  }
+  OLA_ASSERT_EQ(0u, dead.timeouts);
+  OLA_ASSERT_EQ(4u, dead.heartbeats);
+
+  wheel.HeartbeatReceived(&healthy);
+  scheduler.Tick(4);
+  OLA_ASSERT_EQ(1u, dead.timeouts);
+  OLA_ASSERT_EQ(4u, dead.heartbeats);
+  OLA_ASSERT_EQ(0u, healthy.timeouts);
+  OLA_ASSERT_EQ(5u, healthy.heartbeats);
+  OLA_ASSERT_EQ(1u, wheel.ConnectionCount());
+
+  // once timed out, the connection is no longer checked
+  wheel.HeartbeatReceived(&healthy);
+  scheduler.Tick(8);
+  OLA_ASSERT_EQ(1u, dead.timeouts);
+  OLA_ASSERT_EQ(4u, dead.heartbeats);
+}
+
+
+/*
+ * Check removed connections aren't called.
+ */
+void HealthCheckWheelTest::testRemove() {
+  FakeScheduler scheduler;
+  HealthCheckWheel wheel(&scheduler, TimeInterval(5, 0), 2);
+
+  MockConnection connection1, connection2, connection3;
+  wheel.AddConnection(&connection1);
+  wheel.AddConnection(&connection2);
+  wheel.AddConnection(&connection3);
+  wheel.RemoveConnection(&connection1);
+  wheel.RemoveConnection(&connection1);
+  OLA_ASSERT_EQ(2u, wheel.ConnectionCount());
+
+  scheduler.Tick(20);
+  OLA_ASSERT_EQ(1u, connection1.heartbeats);
+  OLA_ASSERT_EQ(0u, connection1.timeouts);
+  OLA_ASSERT_EQ(1u, connection2.timeouts);
+  OLA_ASSERT_EQ(1u, connection3.timeouts);
+  OLA_ASSERT_EQ(0u, wheel.ConnectionCount());
+
+  // the timer is kept, and reused for new connections
+  wheel.AddConnection(&connection1);
+  OLA_ASSERT_EQ(1u, scheduler.Registrations());
+  scheduler.Tick(2);
+  OLA_ASSERT_EQ(3u, connection1.heartbeats);
+}
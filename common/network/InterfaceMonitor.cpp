@@ -0,0 +1,263 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * InterfaceMonitor.cpp
+ * Keeps a table of the network interfaces up to date.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#if defined(HAVE_LINUX_NETLINK_H) && defined(HAVE_LINUX_RTNETLINK_H)
+#define USE_NETLINK_FOR_INTERFACE_CHANGES 1
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#endif  // defined(HAVE_LINUX_NETLINK_H) && defined(HAVE_LINUX_RTNETLINK_H)
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <set>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/io/Descriptor.h"
+#include "ola/network/InterfaceMonitor.h"
+
+namespace ola {
+namespace network {
+
+using std::set;
+using std::vector;
+
+namespace {
+
+/*
+ * Interface::operator== isn't const, and ignores the broadcast address.
+ */
+bool SameInterface(const Interface &a, const Interface &b) {
+  return (a.name == b.name &&
+          a.ip_address == b.ip_address &&
+          a.bcast_address == b.bcast_address &&
+          a.subnet_mask == b.subnet_mask &&
+          a.loopback == b.loopback &&
+          a.index == b.index);
+}
+
+bool Contains(const vector<Interface> &interfaces, const Interface &iface) {
+  vector<Interface>::const_iterator iter = interfaces.begin();
+  for (; iter != interfaces.end(); ++iter) {
+    if (SameInterface(*iter, iface)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+bool InterfaceChanges::Affects(const Interface &iface) const {
+  vector<Interface>::const_iterator iter = removed.begin();
+  for (; iter != removed.end(); ++iter) {
+    if (iter->name == iface.name && iter->ip_address == iface.ip_address) {
+      return true;
+    }
+  }
+  return false;
+}
+
+InterfaceMonitor::InterfaceMonitor(ola::io::SelectServerInterface *ss,
+                                   InterfacePicker *picker)
+    : m_ss(ss),
+      m_picker(picker),
+      m_refresh_timeout(ola::thread::INVALID_TIMEOUT),
+      m_poll_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+InterfaceMonitor::~InterfaceMonitor() {
+  if (m_refresh_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_refresh_timeout);
+  }
+  if (m_poll_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_poll_timeout);
+  }
+  if (m_netlink_descriptor.get()) {
+    m_ss->RemoveReadDescriptor(m_netlink_descriptor.get());
+    close(m_netlink_descriptor->ReadDescriptor());
+  }
+}
+
+bool InterfaceMonitor::Init() {
+  m_interfaces = m_picker->GetInterfaces(true);
+  if (OpenNetlinkSocket()) {
+    return true;
+  }
+  OLA_INFO << "Polling for interface changes every " << POLL_INTERVAL_MS
+           << "ms";
+  m_poll_timeout = m_ss->RegisterRepeatingTimeout(
+      POLL_INTERVAL_MS, NewCallback(this, &InterfaceMonitor::Poll));
+  return false;
+}
+
+vector<Interface> InterfaceMonitor::GetInterfaces(
+    bool include_loopback) const {
+  if (include_loopback) {
+    return m_interfaces;
+  }
+  vector<Interface> interfaces;
+  vector<Interface>::const_iterator iter = m_interfaces.begin();
+  for (; iter != m_interfaces.end(); ++iter) {
+    if (!iter->loopback) {
+      interfaces.push_back(*iter);
+    }
+  }
+  return interfaces;
+}
+
+void InterfaceMonitor::AddListener(Listener *listener) {
+  m_listeners.insert(listener);
+}
+
+void InterfaceMonitor::RemoveListener(Listener *listener) {
+  m_listeners.erase(listener);
+}
+
+bool InterfaceMonitor::Refresh() {
+  vector<Interface> interfaces = m_picker->GetInterfaces(true);
+
+  InterfaceChanges changes;
+  vector<Interface>::const_iterator iter = interfaces.begin();
+  for (; iter != interfaces.end(); ++iter) {
+    if (!Contains(m_interfaces, *iter)) {
+      changes.added.push_back(*iter);
+    }
+  }
+  for (iter = m_interfaces.begin(); iter != m_interfaces.end(); ++iter) {
+    if (!Contains(interfaces, *iter)) {
+      changes.removed.push_back(*iter);
+    }
+  }
+
+  m_interfaces = interfaces;
+  if (changes.added.empty() && changes.removed.empty()) {
+    return false;
+  }
+
+  OLA_INFO << "Interfaces changed, " << changes.added.size() << " added, "
+           << changes.removed.size() << " removed";
+  // A listener may remove itself.
+  set<Listener*> listeners = m_listeners;
+  set<Listener*>::iterator listener = listeners.begin();
+  for (; listener != listeners.end(); ++listener) {
+    if (m_listeners.find(*listener) != m_listeners.end()) {
+      (*listener)->InterfacesChanged(changes);
+    }
+  }
+  return true;
+}
+
+#ifdef USE_NETLINK_FOR_INTERFACE_CHANGES
+bool InterfaceMonitor::OpenNetlinkSocket() {
+  int sd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                  NETLINK_ROUTE);
+  if (sd < 0) {
+    OLA_WARN << "Could not create netlink socket: " << strerror(errno);
+    return false;
+  }
+
+  struct sockaddr_nl address;
+  memset(&address, 0, sizeof(address));
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+  if (bind(sd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) < 0) {
+    OLA_WARN << "Could not bind netlink socket: " << strerror(errno);
+    close(sd);
+    return false;
+  }
+
+  m_netlink_descriptor.reset(new ola::io::UnmanagedFileDescriptor(sd));
+  m_netlink_descriptor->SetOnData(
+      NewCallback(this, &InterfaceMonitor::NetlinkReadable));
+  m_ss->AddReadDescriptor(m_netlink_descriptor.get());
+  return true;
+}
+
+/*
+ * We don't decode the messages, any change causes the table to be re-read
+ * once the burst of messages is over.
+ */
+void InterfaceMonitor::NetlinkReadable() {
+  char buffer[4096];
+  bool changed = false;
+  while (true) {
+    ssize_t size = recv(m_netlink_descriptor->ReadDescriptor(), buffer,
+                        sizeof(buffer), 0);
+    if (size < 0) {
+      if (errno == ENOBUFS) {
+        // Messages were dropped, re-read the table to be safe.
+        changed = true;
+        continue;
+      }
+      break;
+    }
+    const struct nlmsghdr *header =
+        reinterpret_cast<const struct nlmsghdr*>(buffer);
+    unsigned int length = size;
+    for (; NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+      switch (header->nlmsg_type) {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+          changed = true;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  if (changed) {
+    if (m_refresh_timeout != ola::thread::INVALID_TIMEOUT) {
+      m_ss->RemoveTimeout(m_refresh_timeout);
+    }
+    m_refresh_timeout = m_ss->RegisterSingleTimeout(
+        SETTLE_DELAY_MS,
+        NewSingleCallback(this, &InterfaceMonitor::SettleTimeout));
+  }
+}
+#else
+bool InterfaceMonitor::OpenNetlinkSocket() {
+  return false;
+}
+
+void InterfaceMonitor::NetlinkReadable() {}
+#endif  // USE_NETLINK_FOR_INTERFACE_CHANGES
+
+void InterfaceMonitor::SettleTimeout() {
+  m_refresh_timeout = ola::thread::INVALID_TIMEOUT;
+  Refresh();
+}
+
+bool InterfaceMonitor::Poll() {
+  Refresh();
+  return true;
+}
+}  // namespace network
+}  // namespace ola
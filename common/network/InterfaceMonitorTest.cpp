@@ -0,0 +1,178 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * InterfaceMonitorTest.cpp
+ * Test fixture for the InterfaceMonitor class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Interface.h"
+#include "ola/network/InterfaceMonitor.h"
+#include "ola/network/InterfacePicker.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::Interface;
+using ola::network::InterfaceChanges;
+using ola::network::InterfaceMonitor;
+using ola::network::InterfacePicker;
+using std::string;
+using std::vector;
+
+namespace {
+
+/*
+ * A picker where the interfaces can be changed.
+ */
+class MutableInterfacePicker: public InterfacePicker {
+ public:
+  explicit MutableInterfacePicker(vector<Interface> *interfaces)
+      : m_interfaces(interfaces),
+        m_calls(0) {
+  }
+
+  vector<Interface> GetInterfaces(bool) const {
+    m_calls++;
+    return *m_interfaces;
+  }
+
+  unsigned int Calls() const { return m_calls; }
+
+ private:
+  vector<Interface> *m_interfaces;
+  mutable unsigned int m_calls;
+};
+
+class RecordingListener: public InterfaceMonitor::Listener {
+ public:
+  RecordingListener() : m_calls(0) {}
+
+  void InterfacesChanged(const InterfaceChanges &changes) {
+    m_calls++;
+    m_changes = changes;
+  }
+
+  unsigned int m_calls;
+  InterfaceChanges m_changes;
+};
+
+Interface MakeInterface(const string &name, const string &ip,
+                        bool loopback) {
+  Interface iface;
+  iface.name = name;
+  IPV4Address::FromString(ip, &iface.ip_address);
+  iface.loopback = loopback;
+  return iface;
+}
+}  // namespace
+
+class InterfaceMonitorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(InterfaceMonitorTest);
+  CPPUNIT_TEST(testCachedInterfaces);
+  CPPUNIT_TEST(testChanges);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+  }
+
+  void testCachedInterfaces();
+  void testChanges();
+
+ private:
+  SelectServer m_ss;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(InterfaceMonitorTest);
+
+
+/*
+ * Check the interfaces are read once and then served from the cache.
+ */
+void InterfaceMonitorTest::testCachedInterfaces() {
+  vector<Interface> interfaces;
+  interfaces.push_back(MakeInterface("lo", "127.0.0.1", true));
+  interfaces.push_back(MakeInterface("eth0", "10.0.0.1", false));
+  MutableInterfacePicker *picker = new MutableInterfacePicker(&interfaces);
+  InterfaceMonitor monitor(&m_ss, picker);
+  monitor.Init();
+  OLA_ASSERT_EQ(1u, picker->Calls());
+
+  OLA_ASSERT_EQ(static_cast<size_t>(2), monitor.GetInterfaces(true).size());
+  vector<Interface> no_loopback = monitor.GetInterfaces(false);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), no_loopback.size());
+  OLA_ASSERT_EQ(string("eth0"), no_loopback[0].name);
+
+  Interface iface;
+  OLA_ASSERT_TRUE(monitor.ChooseInterface(&iface, "eth0"));
+  OLA_ASSERT_EQ(string("10.0.0.1"), iface.ip_address.ToString());
+  OLA_ASSERT_EQ(1u, picker->Calls());
+}
+
+
+/*
+ * Check listeners are told about added, removed and changed interfaces.
+ */
+void InterfaceMonitorTest::testChanges() {
+  vector<Interface> interfaces;
+  interfaces.push_back(MakeInterface("eth0", "10.0.0.1", false));
+  interfaces.push_back(MakeInterface("eth1", "192.168.0.1", false));
+  InterfaceMonitor monitor(&m_ss, new MutableInterfacePicker(&interfaces));
+  monitor.Init();
+
+  RecordingListener listener;
+  monitor.AddListener(&listener);
+
+  // No change
+  OLA_ASSERT_FALSE(monitor.Refresh());
+  OLA_ASSERT_EQ(0u, listener.m_calls);
+
+  // eth1 gets a new address and wlan0 appears
+  Interface old_eth1 = interfaces[1];
+  interfaces[1] = MakeInterface("eth1", "192.168.0.2", false);
+  interfaces.push_back(MakeInterface("wlan0", "172.16.0.1", false));
+  OLA_ASSERT_TRUE(monitor.Refresh());
+  OLA_ASSERT_EQ(1u, listener.m_calls);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), listener.m_changes.added.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), listener.m_changes.removed.size());
+  OLA_ASSERT_EQ(string("eth1"), listener.m_changes.removed[0].name);
+
+  OLA_ASSERT_TRUE(listener.m_changes.Affects(old_eth1));
+  OLA_ASSERT_FALSE(listener.m_changes.Affects(interfaces[0]));
+  OLA_ASSERT_FALSE(listener.m_changes.Affects(interfaces[1]));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), monitor.GetInterfaces(true).size());
+
+  // eth0 goes away
+  interfaces.erase(interfaces.begin());
+  OLA_ASSERT_TRUE(monitor.Refresh());
+  OLA_ASSERT_EQ(2u, listener.m_calls);
+  OLA_ASSERT_EQ(static_cast<size_t>(0), listener.m_changes.added.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), listener.m_changes.removed.size());
+  OLA_ASSERT_EQ(string("eth0"), listener.m_changes.removed[0].name);
+
+  monitor.RemoveListener(&listener);
+  interfaces.clear();
+  OLA_ASSERT_TRUE(monitor.Refresh());
+  OLA_ASSERT_EQ(2u, listener.m_calls);
+}
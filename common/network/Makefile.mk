@@ -3,13 +3,16 @@
 common_libolacommon_la_SOURCES += \
     common/network/AdvancedTCPConnector.cpp \
     common/network/FakeInterfacePicker.h \
+    common/network/HealthCheckWheel.cpp \
     common/network/HealthCheckedConnection.cpp \
     common/network/IPV4Address.cpp \
     common/network/Interface.cpp \
+    common/network/InterfaceMonitor.cpp \
     common/network/InterfacePicker.cpp \
     common/network/MACAddress.cpp \
     common/network/NetworkUtils.cpp \
     common/network/NetworkUtilsInternal.h \
+    common/network/PcapReader.cpp \
     common/network/Socket.cpp \
     common/network/SocketAddress.cpp \
     common/network/SocketCloser.cpp \
@@ -27,7 +30,8 @@ common_libolacommon_la_SOURCES += \
 else
 common_libolacommon_la_SOURCES += \
     common/network/PosixInterfacePicker.h \
-    common/network/PosixInterfacePicker.cpp
+    common/network/PosixInterfacePicker.cpp \
+    common/network/UnixDomainSocket.cpp
 endif
 
 # TESTS
@@ -38,18 +42,25 @@ test_programs += \
     common/network/TCPConnectorTester
 
 common_network_HealthCheckedConnectionTester_SOURCES = \
+    common/network/HealthCheckWheelTest.cpp \
     common/network/HealthCheckedConnectionTest.cpp
 common_network_HealthCheckedConnectionTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_network_HealthCheckedConnectionTester_LDADD = $(COMMON_TESTING_LIBS)
 
 common_network_NetworkTester_SOURCES = \
     common/network/IPV4AddressTest.cpp \
+    common/network/InterfaceMonitorTest.cpp \
     common/network/InterfacePickerTest.cpp \
     common/network/InterfaceTest.cpp \
     common/network/MACAddressTest.cpp \
     common/network/NetworkUtilsTest.cpp \
+    common/network/PcapReaderTest.cpp \
     common/network/SocketAddressTest.cpp \
     common/network/SocketTest.cpp
+if !USING_WIN32
+common_network_NetworkTester_SOURCES += \
+    common/network/UnixDomainSocketTest.cpp
+endif
 common_network_NetworkTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_network_NetworkTester_LDADD = $(COMMON_TESTING_LIBS)
 
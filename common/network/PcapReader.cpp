@@ -0,0 +1,440 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PcapReader.cpp
+ * Reads UDP datagrams from a pcap or pcapng capture file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/PcapReader.h"
+
+namespace ola {
+namespace network {
+
+using std::string;
+
+namespace {
+
+// Classic pcap magic numbers, as read on a host with the same byte order as
+// the writer.
+const uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+const uint32_t PCAP_NANOSECOND_MAGIC = 0xa1b23c4d;
+const unsigned int PCAP_HEADER_SIZE = 24;
+const unsigned int PCAP_RECORD_HEADER_SIZE = 16;
+
+// pcapng, see https://www.ietf.org/archive/id/draft-ietf-opsawg-pcapng-01.html
+const uint32_t SECTION_HEADER_BLOCK = 0x0A0D0D0A;
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 0x00000001;
+const uint32_t ENHANCED_PACKET_BLOCK = 0x00000006;
+const uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+const uint16_t OPT_ENDOFOPT = 0;
+const uint16_t OPT_IF_TSRESOL = 9;
+
+// Anything bigger than this is treated as corruption.
+const uint32_t MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+
+const uint16_t LINKTYPE_NULL = 0;
+const uint16_t LINKTYPE_ETHERNET = 1;
+const uint16_t LINKTYPE_RAW = 101;
+const uint16_t LINKTYPE_LINUX_SLL = 113;
+const uint16_t LINKTYPE_IPV4 = 228;
+const uint16_t LINKTYPE_LINUX_SLL2 = 276;
+
+const uint16_t ETHERTYPE_IPV4 = 0x0800;
+const uint16_t ETHERTYPE_VLAN = 0x8100;
+const uint16_t ETHERTYPE_QINQ = 0x88a8;
+const uint8_t IPPROTO_UDP_NUMBER = 17;
+const uint32_t BSD_AF_INET = 2;
+
+uint32_t ByteSwap32(uint32_t value) {
+  return ((value & 0xff) << 24) | ((value & 0xff00) << 8) |
+         ((value >> 8) & 0xff00) | (value >> 24);
+}
+
+uint16_t ReadBigEndian16(const uint8_t *data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+}  // namespace
+
+
+PcapReader* PcapReader::Open(const string &path) {
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << path;
+    return NULL;
+  }
+
+  uint8_t header[PCAP_HEADER_SIZE];
+  if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+    OLA_WARN << path << " is too short to be a capture";
+    return NULL;
+  }
+  file.close();
+
+  uint32_t magic;
+  memcpy(&magic, header, sizeof(magic));
+  if (magic == SECTION_HEADER_BLOCK) {
+    // The section header is read like any other block.
+    return new PcapReader(path, true, false);
+  }
+
+  const bool swapped = (magic == ByteSwap32(PCAP_MAGIC) ||
+                        magic == ByteSwap32(PCAP_NANOSECOND_MAGIC));
+  if (swapped) {
+    magic = ByteSwap32(magic);
+  }
+  if (magic != PCAP_MAGIC && magic != PCAP_NANOSECOND_MAGIC) {
+    OLA_WARN << path << " isn't a pcap or pcapng file";
+    return NULL;
+  }
+  const uint64_t units_per_second = (
+      magic == PCAP_NANOSECOND_MAGIC ? 1000000000 : 1000000);
+
+  PcapReader *reader = new PcapReader(path, false, swapped);
+  if (!reader->m_file.ignore(PCAP_HEADER_SIZE)) {
+    delete reader;
+    return NULL;
+  }
+  reader->m_classic_interface.link_type = static_cast<uint16_t>(
+      reader->ReadUInt32(header + 20));
+  reader->m_classic_interface.units_per_second = units_per_second;
+  return reader;
+}
+
+
+PcapReader::PcapReader(const string &path, bool pcapng, bool swapped)
+    : m_file(path.c_str(), std::ios::in | std::ios::binary),
+      m_pcapng(pcapng),
+      m_swapped(swapped),
+      m_failed(false),
+      m_packets_skipped(0) {
+  m_classic_interface.link_type = 0;
+  m_classic_interface.units_per_second = 1000000;
+}
+
+
+bool PcapReader::NextDatagram(CapturedDatagram *datagram) {
+  if (m_failed) {
+    return false;
+  }
+  return m_pcapng ? NextPcapngPacket(datagram) : NextClassicPacket(datagram);
+}
+
+
+bool PcapReader::NextClassicPacket(CapturedDatagram *datagram) {
+  while (true) {
+    uint8_t header[PCAP_RECORD_HEADER_SIZE];
+    if (!m_file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+      if (m_file.gcount()) {
+        OLA_WARN << "Capture ends part way through a packet header";
+        m_failed = true;
+      }
+      return false;
+    }
+
+    const uint32_t captured_length = ReadUInt32(header + 8);
+    if (captured_length > MAX_BLOCK_SIZE) {
+      OLA_WARN << "Packet of " << captured_length << " bytes, the capture is "
+               << "probably corrupt";
+      m_failed = true;
+      return false;
+    }
+    m_block.resize(captured_length);
+    if (!ReadData(m_block.empty() ? NULL : &m_block[0], captured_length)) {
+      return false;
+    }
+
+    const uint64_t timestamp = (
+        static_cast<uint64_t>(ReadUInt32(header)) *
+        m_classic_interface.units_per_second + ReadUInt32(header + 4));
+    if (HandlePacket(m_classic_interface, timestamp,
+                     m_block.empty() ? NULL : &m_block[0], captured_length,
+                     datagram)) {
+      return true;
+    }
+  }
+}
+
+
+bool PcapReader::NextPcapngPacket(CapturedDatagram *datagram) {
+  uint32_t type;
+  while (ReadBlock(&type)) {
+    if (type == INTERFACE_DESCRIPTION_BLOCK) {
+      HandleInterfaceBlock();
+      continue;
+    }
+    if (type != ENHANCED_PACKET_BLOCK) {
+      // Simple and obsolete packet blocks don't say which interface, or don't
+      // have a timestamp, so they're skipped along with everything else.
+      if (type != SECTION_HEADER_BLOCK) {
+        m_packets_skipped++;
+      }
+      continue;
+    }
+
+    // The body, followed by the trailing length.
+    if (m_block.size() < 24) {
+      m_packets_skipped++;
+      continue;
+    }
+    const uint32_t interface_id = ReadUInt32(&m_block[0]);
+    const uint32_t captured_length = ReadUInt32(&m_block[12]);
+    if (interface_id >= m_interfaces.size() ||
+        captured_length > m_block.size() - 24) {
+      m_packets_skipped++;
+      continue;
+    }
+    const uint64_t timestamp = (
+        static_cast<uint64_t>(ReadUInt32(&m_block[4])) << 32 |
+        ReadUInt32(&m_block[8]));
+    if (HandlePacket(m_interfaces[interface_id], timestamp, &m_block[20],
+                     captured_length, datagram)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * Read a pcapng block into m_block, without the type and leading length.
+ */
+bool PcapReader::ReadBlock(uint32_t *type) {
+  uint8_t header[8];
+  if (!m_file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+    if (m_file.gcount()) {
+      OLA_WARN << "Capture ends part way through a block header";
+      m_failed = true;
+    }
+    return false;
+  }
+
+  memcpy(type, header, sizeof(*type));
+  if (*type == SECTION_HEADER_BLOCK) {
+    // A new section, which may have a different byte order and always
+    // starts with a new set of interfaces.
+    uint8_t magic_data[4];
+    if (!ReadData(magic_data, sizeof(magic_data))) {
+      return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, magic_data, sizeof(magic));
+    if (magic == BYTE_ORDER_MAGIC) {
+      m_swapped = false;
+    } else if (magic == ByteSwap32(BYTE_ORDER_MAGIC)) {
+      m_swapped = true;
+    } else {
+      OLA_WARN << "Unknown pcapng byte order magic " << std::hex << magic;
+      m_failed = true;
+      return false;
+    }
+    m_interfaces.clear();
+  } else {
+    *type = ReadUInt32(header);
+  }
+
+  const uint32_t length = ReadUInt32(header + 4);
+  const unsigned int already_read = (
+      *type == SECTION_HEADER_BLOCK ? 12 : 8);
+  if (length % 4 || length < already_read + 4 || length > MAX_BLOCK_SIZE) {
+    OLA_WARN << "Invalid pcapng block length " << length;
+    m_failed = true;
+    return false;
+  }
+  m_block.resize(length - already_read);
+  return ReadData(&m_block[0], m_block.size());
+}
+
+
+void PcapReader::HandleInterfaceBlock() {
+  InterfaceInfo iface;
+  iface.link_type = 0;
+  iface.units_per_second = 1000000;
+  if (m_block.size() >= 12) {
+    iface.link_type = ReadUInt16(&m_block[0]);
+  }
+
+  // The options follow the link type, reserved field and snap length, and
+  // stop before the trailing length.
+  unsigned int offset = 8;
+  const unsigned int end = m_block.size() - 4;
+  while (offset + 4 <= end) {
+    const uint16_t code = ReadUInt16(&m_block[offset]);
+    const uint16_t length = ReadUInt16(&m_block[offset + 2]);
+    offset += 4;
+    if (code == OPT_ENDOFOPT || offset + length > end) {
+      break;
+    }
+    if (code == OPT_IF_TSRESOL && length >= 1) {
+      const uint8_t resolution = m_block[offset];
+      const unsigned int exponent = resolution & 0x7f;
+      uint64_t units = 1;
+      for (unsigned int i = 0; i < exponent && units < (1ull << 60); i++) {
+        units *= (resolution & 0x80) ? 2 : 10;
+      }
+      iface.units_per_second = units;
+    }
+    offset += length + ((4 - (length & 3)) & 3);
+  }
+  m_interfaces.push_back(iface);
+}
+
+
+/*
+ * Strip the link layer header and extract the UDP datagram.
+ */
+bool PcapReader::HandlePacket(const InterfaceInfo &iface, uint64_t timestamp,
+                              const uint8_t *data, unsigned int length,
+                              CapturedDatagram *datagram) {
+  bool is_ipv4 = false;
+  unsigned int offset = 0;
+  switch (iface.link_type) {
+    case LINKTYPE_NULL:
+      if (length >= 4) {
+        // The address family is in the byte order of the capturing host.
+        uint32_t family;
+        memcpy(&family, data, sizeof(family));
+        is_ipv4 = (family == BSD_AF_INET ||
+                   family == ByteSwap32(BSD_AF_INET));
+        offset = 4;
+      }
+      break;
+    case LINKTYPE_ETHERNET:
+      offset = 12;
+      while (length >= offset + 2) {
+        const uint16_t ether_type = ReadBigEndian16(data + offset);
+        offset += 2;
+        if (ether_type == ETHERTYPE_VLAN || ether_type == ETHERTYPE_QINQ) {
+          offset += 2;
+          continue;
+        }
+        is_ipv4 = ether_type == ETHERTYPE_IPV4;
+        break;
+      }
+      break;
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+      is_ipv4 = length && (data[0] >> 4) == 4;
+      break;
+    case LINKTYPE_LINUX_SLL:
+      if (length >= 16) {
+        is_ipv4 = ReadBigEndian16(data + 14) == ETHERTYPE_IPV4;
+        offset = 16;
+      }
+      break;
+    case LINKTYPE_LINUX_SLL2:
+      if (length >= 20) {
+        is_ipv4 = ReadBigEndian16(data) == ETHERTYPE_IPV4;
+        offset = 20;
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (!is_ipv4 || offset > length ||
+      !ParseIPv4(data + offset, length - offset, datagram)) {
+    m_packets_skipped++;
+    return false;
+  }
+
+  const uint64_t seconds = timestamp / iface.units_per_second;
+  const uint64_t fraction = timestamp % iface.units_per_second;
+  struct timeval tv;
+  tv.tv_sec = static_cast<time_t>(seconds);
+  tv.tv_usec = static_cast<suseconds_t>(
+      static_cast<double>(fraction) * 1000000 / iface.units_per_second);
+  datagram->time = TimeStamp(tv);
+  return true;
+}
+
+
+bool PcapReader::ReadData(uint8_t *data, unsigned int length) {
+  if (length && !m_file.read(reinterpret_cast<char*>(data), length)) {
+    OLA_WARN << "Capture ends part way through a packet";
+    m_failed = true;
+    return false;
+  }
+  return true;
+}
+
+
+uint16_t PcapReader::Swap16(uint16_t value) const {
+  return m_swapped ? static_cast<uint16_t>((value << 8) | (value >> 8)) :
+                     value;
+}
+
+
+uint32_t PcapReader::Swap32(uint32_t value) const {
+  return m_swapped ? ByteSwap32(value) : value;
+}
+
+
+uint16_t PcapReader::ReadUInt16(const uint8_t *data) const {
+  uint16_t value;
+  memcpy(&value, data, sizeof(value));
+  return Swap16(value);
+}
+
+
+uint32_t PcapReader::ReadUInt32(const uint8_t *data) const {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return Swap32(value);
+}
+
+
+bool PcapReader::ParseIPv4(const uint8_t *data, unsigned int length,
+                           CapturedDatagram *datagram) {
+  if (length < 20 || (data[0] >> 4) != 4) {
+    return false;
+  }
+  const unsigned int header_length = (data[0] & 0x0f) * 4;
+  const unsigned int total_length = ReadBigEndian16(data + 2);
+  // Fragments can't be replayed on their own.
+  const bool fragmented = ReadBigEndian16(data + 6) & 0x3fff;
+  if (header_length < 20 || total_length < header_length + 8 ||
+      total_length > length || fragmented ||
+      data[9] != IPPROTO_UDP_NUMBER) {
+    return false;
+  }
+
+  const uint8_t *udp = data + header_length;
+  const unsigned int udp_length = ReadBigEndian16(udp + 4);
+  if (udp_length < 8 || udp_length > total_length - header_length) {
+    return false;
+  }
+
+  uint32_t source_ip, destination_ip;
+  memcpy(&source_ip, data + 12, sizeof(source_ip));
+  memcpy(&destination_ip, data + 16, sizeof(destination_ip));
+  datagram->source = IPV4SocketAddress(IPV4Address(source_ip),
+                                       ReadBigEndian16(udp));
+  datagram->destination = IPV4SocketAddress(IPV4Address(destination_ip),
+                                            ReadBigEndian16(udp + 2));
+  datagram->payload.assign(udp + 8, udp + udp_length);
+  return true;
+}
+}  // namespace network
+}  // namespace ola
@@ -0,0 +1,358 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PcapReaderTest.cpp
+ * Test fixture for the PcapReader class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/network/PcapReader.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::network::CapturedDatagram;
+using ola::network::PcapReader;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+namespace {
+
+/*
+ * Builds a capture file, in either byte order.
+ */
+class CaptureBuilder {
+ public:
+  explicit CaptureBuilder(bool swapped) : m_swapped(swapped) {}
+
+  void UInt16(uint16_t value) {
+    if (m_swapped) {
+      BigEndian16(value);
+    } else {
+      Append(&value, sizeof(value));
+    }
+  }
+
+  void UInt32(uint32_t value) {
+    if (m_swapped) {
+      BigEndian16(static_cast<uint16_t>(value >> 16));
+      BigEndian16(static_cast<uint16_t>(value));
+    } else {
+      Append(&value, sizeof(value));
+    }
+  }
+
+  void BigEndian16(uint16_t value) {
+    m_data.push_back(static_cast<uint8_t>(value >> 8));
+    m_data.push_back(static_cast<uint8_t>(value));
+  }
+
+  void Append(const void *data, unsigned int length) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + length);
+  }
+
+  void Append(const vector<uint8_t> &data) {
+    m_data.insert(m_data.end(), data.begin(), data.end());
+  }
+
+  void Write(const string &path) const {
+    std::ofstream file(path.c_str(), std::ios::out | std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&m_data[0]), m_data.size());
+  }
+
+ private:
+  bool m_swapped;
+  vector<uint8_t> m_data;
+};
+
+/*
+ * An Ethernet frame, with an optional VLAN tag, carrying an IPv4 packet from
+ * 10.0.0.1 to 239.255.0.1.
+ */
+vector<uint8_t> EthernetFrame(bool vlan, uint8_t protocol, uint16_t fragment,
+                              uint16_t port, const string &payload) {
+  vector<uint8_t> frame(12, 0xff);
+  if (vlan) {
+    const uint8_t tag[] = {0x81, 0x00, 0x00, 0x05};
+    frame.insert(frame.end(), tag, tag + sizeof(tag));
+  }
+  frame.push_back(0x08);
+  frame.push_back(0x00);
+
+  const unsigned int udp_length = 8 + payload.size();
+  const unsigned int total_length = 20 + udp_length;
+  const uint8_t ip_header[] = {
+    0x45, 0, static_cast<uint8_t>(total_length >> 8),
+    static_cast<uint8_t>(total_length), 0, 0,
+    static_cast<uint8_t>(fragment >> 8), static_cast<uint8_t>(fragment),
+    64, protocol, 0, 0,
+    10, 0, 0, 1,
+    239, 255, 0, 1};
+  frame.insert(frame.end(), ip_header, ip_header + sizeof(ip_header));
+  const uint8_t udp_header[] = {
+    0xc0, 0x00, static_cast<uint8_t>(port >> 8), static_cast<uint8_t>(port),
+    static_cast<uint8_t>(udp_length >> 8), static_cast<uint8_t>(udp_length),
+    0, 0};
+  frame.insert(frame.end(), udp_header, udp_header + sizeof(udp_header));
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  return frame;
+}
+
+vector<uint8_t> UDPFrame(uint16_t port, const string &payload) {
+  return EthernetFrame(false, 17, 0, port, payload);
+}
+
+void AddClassicPacket(CaptureBuilder *builder, uint32_t seconds,
+                      uint32_t fraction, const vector<uint8_t> &frame) {
+  builder->UInt32(seconds);
+  builder->UInt32(fraction);
+  builder->UInt32(frame.size());
+  builder->UInt32(frame.size());
+  builder->Append(frame);
+}
+
+void AddClassicHeader(CaptureBuilder *builder, uint32_t magic) {
+  builder->UInt32(magic);
+  builder->UInt16(2);
+  builder->UInt16(4);
+  builder->UInt32(0);
+  builder->UInt32(0);
+  builder->UInt32(65535);
+  builder->UInt32(1);  // Ethernet
+}
+
+string PayloadOf(const CapturedDatagram &datagram) {
+  return string(datagram.payload.begin(), datagram.payload.end());
+}
+}  // namespace
+
+class PcapReaderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PcapReaderTest);
+  CPPUNIT_TEST(testClassicPcap);
+  CPPUNIT_TEST(testSwappedNanosecondPcap);
+  CPPUNIT_TEST(testPcapng);
+  CPPUNIT_TEST(testTruncatedCapture);
+  CPPUNIT_TEST(testNotACapture);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testClassicPcap();
+  void testSwappedNanosecondPcap();
+  void testPcapng();
+  void testTruncatedCapture();
+  void testNotACapture();
+
+ private:
+  string m_path;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PcapReaderTest);
+
+void PcapReaderTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  std::ostringstream str;
+  str << "/tmp/ola-pcap-reader-test-" << getpid();
+  m_path = str.str();
+}
+
+void PcapReaderTest::tearDown() {
+  unlink(m_path.c_str());
+}
+
+/*
+ * Check a microsecond pcap file, skipping the packets that can't be replayed.
+ */
+void PcapReaderTest::testClassicPcap() {
+  CaptureBuilder builder(false);
+  AddClassicHeader(&builder, 0xa1b2c3d4);
+  AddClassicPacket(&builder, 100, 250000, UDPFrame(5568, "e131"));
+  // TCP
+  AddClassicPacket(&builder, 100, 260000,
+                   EthernetFrame(false, 6, 0, 80, "http"));
+  // A fragment
+  AddClassicPacket(&builder, 100, 270000,
+                   EthernetFrame(false, 17, 0x2000, 6454, "frag"));
+  AddClassicPacket(&builder, 101, 5,
+                   EthernetFrame(true, 17, 0, 6454, "Art-Net"));
+  builder.Write(m_path);
+
+  auto_ptr<PcapReader> reader(PcapReader::Open(m_path));
+  OLA_ASSERT_NOT_NULL(reader.get());
+
+  CapturedDatagram datagram;
+  OLA_ASSERT_TRUE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_EQ(string("e131"), PayloadOf(datagram));
+  OLA_ASSERT_EQ(string("10.0.0.1:49152"), datagram.source.ToString());
+  OLA_ASSERT_EQ(string("239.255.0.1:5568"),
+                datagram.destination.ToString());
+  OLA_ASSERT_EQ(static_cast<int64_t>(100), datagram.time.Seconds());
+  OLA_ASSERT_EQ(static_cast<int32_t>(250000), datagram.time.MicroSeconds());
+
+  OLA_ASSERT_TRUE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_EQ(string("Art-Net"), PayloadOf(datagram));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(6454), datagram.destination.Port());
+  OLA_ASSERT_EQ(static_cast<int32_t>(5), datagram.time.MicroSeconds());
+
+  OLA_ASSERT_FALSE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_FALSE(reader->Failed());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), reader->PacketsSkipped());
+}
+
+/*
+ * Check a big endian pcap file with nanosecond timestamps.
+ */
+void PcapReaderTest::testSwappedNanosecondPcap() {
+  CaptureBuilder builder(true);
+  AddClassicHeader(&builder, 0xa1b23c4d);
+  AddClassicPacket(&builder, 7, 123456789, UDPFrame(2501, "ShowNet"));
+  builder.Write(m_path);
+
+  auto_ptr<PcapReader> reader(PcapReader::Open(m_path));
+  OLA_ASSERT_NOT_NULL(reader.get());
+  CapturedDatagram datagram;
+  OLA_ASSERT_TRUE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_EQ(string("ShowNet"), PayloadOf(datagram));
+  OLA_ASSERT_EQ(static_cast<int64_t>(7), datagram.time.Seconds());
+  OLA_ASSERT_EQ(static_cast<int32_t>(123456), datagram.time.MicroSeconds());
+  OLA_ASSERT_FALSE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_FALSE(reader->Failed());
+}
+
+/*
+ * Check a pcapng file with two interfaces with different resolutions.
+ */
+void PcapReaderTest::testPcapng() {
+  CaptureBuilder builder(false);
+  // Section header
+  builder.UInt32(0x0A0D0D0A);
+  builder.UInt32(28);
+  builder.UInt32(0x1A2B3C4D);
+  builder.UInt16(1);
+  builder.UInt16(0);
+  builder.UInt32(0xffffffff);
+  builder.UInt32(0xffffffff);
+  builder.UInt32(28);
+
+  // Interface 0 has the default microsecond resolution.
+  builder.UInt32(1);
+  builder.UInt32(20);
+  builder.UInt16(1);
+  builder.UInt16(0);
+  builder.UInt32(0);
+  builder.UInt32(20);
+
+  // Interface 1 is raw IP, with nanosecond resolution.
+  builder.UInt32(1);
+  builder.UInt32(32);
+  builder.UInt16(101);
+  builder.UInt16(0);
+  builder.UInt32(0);
+  builder.UInt16(9);
+  builder.UInt16(1);
+  const uint8_t resolution[] = {9, 0, 0, 0};
+  builder.Append(resolution, sizeof(resolution));
+  builder.UInt16(0);
+  builder.UInt16(0);
+  builder.UInt32(32);
+
+  vector<uint8_t> frames[] = {UDPFrame(6454, "one"), UDPFrame(5568, "two")};
+  // Strip the Ethernet header for the raw IP interface.
+  frames[1].erase(frames[1].begin(), frames[1].begin() + 14);
+  const uint64_t timestamps[] = {3000001, 4000000002ull};
+  for (unsigned int i = 0; i < 2; i++) {
+    const unsigned int padding = (4 - frames[i].size() % 4) % 4;
+    const unsigned int length = 32 + frames[i].size() + padding;
+    builder.UInt32(6);
+    builder.UInt32(length);
+    builder.UInt32(i);
+    builder.UInt32(static_cast<uint32_t>(timestamps[i] >> 32));
+    builder.UInt32(static_cast<uint32_t>(timestamps[i]));
+    builder.UInt32(frames[i].size());
+    builder.UInt32(frames[i].size());
+    builder.Append(frames[i]);
+    builder.Append(vector<uint8_t>(padding, 0));
+    builder.UInt32(length);
+  }
+  builder.Write(m_path);
+
+  auto_ptr<PcapReader> reader(PcapReader::Open(m_path));
+  OLA_ASSERT_NOT_NULL(reader.get());
+  CapturedDatagram datagram;
+  OLA_ASSERT_TRUE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_EQ(string("one"), PayloadOf(datagram));
+  OLA_ASSERT_EQ(static_cast<int64_t>(3), datagram.time.Seconds());
+  OLA_ASSERT_EQ(static_cast<int32_t>(1), datagram.time.MicroSeconds());
+
+  OLA_ASSERT_TRUE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_EQ(string("two"), PayloadOf(datagram));
+  OLA_ASSERT_EQ(static_cast<uint16_t>(5568), datagram.destination.Port());
+  OLA_ASSERT_EQ(static_cast<int64_t>(4), datagram.time.Seconds());
+  OLA_ASSERT_EQ(static_cast<int32_t>(0), datagram.time.MicroSeconds());
+
+  OLA_ASSERT_FALSE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_FALSE(reader->Failed());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), reader->PacketsSkipped());
+}
+
+/*
+ * Check a capture that ends part way through a packet is reported.
+ */
+void PcapReaderTest::testTruncatedCapture() {
+  CaptureBuilder builder(false);
+  AddClassicHeader(&builder, 0xa1b2c3d4);
+  AddClassicPacket(&builder, 1, 0, UDPFrame(5568, "whole"));
+  builder.UInt32(2);
+  builder.UInt32(0);
+  builder.UInt32(100);
+  builder.UInt32(100);
+  builder.Append(UDPFrame(5568, "partial"));
+  builder.Write(m_path);
+
+  auto_ptr<PcapReader> reader(PcapReader::Open(m_path));
+  OLA_ASSERT_NOT_NULL(reader.get());
+  CapturedDatagram datagram;
+  OLA_ASSERT_TRUE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_FALSE(reader->NextDatagram(&datagram));
+  OLA_ASSERT_TRUE(reader->Failed());
+}
+
+/*
+ * Check files that aren't captures are rejected.
+ */
+void PcapReaderTest::testNotACapture() {
+  CaptureBuilder builder(false);
+  builder.Append(string(64, 'x').data(), 64);
+  builder.Write(m_path);
+  auto_ptr<PcapReader> reader(PcapReader::Open(m_path));
+  OLA_ASSERT_NULL(reader.get());
+
+  reader.reset(PcapReader::Open("/nonexistent-directory/capture.pcap"));
+  OLA_ASSERT_NULL(reader.get());
+}
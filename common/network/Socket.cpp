@@ -48,6 +48,7 @@
 #include <netinet/in.h>
 #endif  // HAVE_NETINET_IN_H
 
+#include <algorithm>
 #include <string>
 
 #include "common/network/SocketHelper.h"
@@ -60,16 +61,151 @@ namespace network {
 
 namespace {
 
+/*
+ * The maximum number of datagrams to read in a single RecvBatch() call.
+ */
+const unsigned int MAX_RECV_BATCH = 32;
+
+/*
+ * The maximum number of datagrams to pass to a single sendmmsg() call.
+ */
+const unsigned int MAX_SEND_BATCH = 32;
+
+#ifdef HAVE_RECVMMSG
+#if defined(SO_TIMESTAMPNS)
+const int TIMESTAMP_OPTION = SO_TIMESTAMPNS;
+const int TIMESTAMP_TYPE = SCM_TIMESTAMPNS;
+typedef struct timespec timestamp_type;
+
+void ConvertTimestamp(const struct timespec &ts, TimeStamp *timestamp) {
+  struct timeval tv;
+  tv.tv_sec = ts.tv_sec;
+  tv.tv_usec = ts.tv_nsec / 1000;
+  *timestamp = tv;
+}
+#elif defined(SO_TIMESTAMP)
+const int TIMESTAMP_OPTION = SO_TIMESTAMP;
+const int TIMESTAMP_TYPE = SCM_TIMESTAMP;
+typedef struct timeval timestamp_type;
+
+void ConvertTimestamp(const struct timeval &tv, TimeStamp *timestamp) {
+  *timestamp = tv;
+}
+#endif  // SO_TIMESTAMPNS
+
+#ifdef SO_TIMESTAMP
+/*
+ * The space for the timestamp control message of each datagram.
+ */
+const unsigned int TIMESTAMP_CONTROL_SIZE = CMSG_SPACE(sizeof(timestamp_type));
+#else
+const unsigned int TIMESTAMP_CONTROL_SIZE = 0;
+#endif  // SO_TIMESTAMP
+
+#ifdef SO_TIMESTAMP
+
+/*
+ * Extract the receive timestamp from a message's control data.
+ */
+void ExtractTimestamp(struct msghdr *message, TimeStamp *timestamp) {
+  *timestamp = TimeStamp();
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(message); cmsg;
+       cmsg = CMSG_NXTHDR(message, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == TIMESTAMP_TYPE) {
+      timestamp_type value;
+      memcpy(&value, CMSG_DATA(cmsg), sizeof(value));
+      ConvertTimestamp(value, timestamp);
+      return;
+    }
+  }
+}
+#endif  // SO_TIMESTAMP
+#endif  // HAVE_RECVMMSG
+
+#ifdef SO_RXQ_OVFL
+/*
+ * The space for the drop count control message of each datagram.
+ */
+const unsigned int DROP_CONTROL_SIZE = CMSG_SPACE(sizeof(uint32_t));
+
+/*
+ * Extract the drop count from a message's control data. The kernel only
+ * includes it once a datagram has been dropped, and it's the total since the
+ * socket was created.
+ */
+void ExtractDropCount(struct msghdr *message, uint32_t *drops) {
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(message); cmsg;
+       cmsg = CMSG_NXTHDR(message, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+      memcpy(drops, CMSG_DATA(cmsg), sizeof(*drops));
+      return;
+    }
+  }
+}
+#else
+const unsigned int DROP_CONTROL_SIZE = 0;
+#endif  // SO_RXQ_OVFL
+
+/*
+ * Receive a single datagram. recvfrom() doesn't return the control data, so
+ * recvmsg() is used if the drops are being counted.
+ */
+ssize_t ReceiveDatagram(int fd, uint8_t *buffer, ssize_t length,
+                        struct sockaddr_in *source, socklen_t *src_size,
+                        int flags, uint32_t *drops) {
+#ifdef SO_RXQ_OVFL
+  if (drops) {
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = length;
+    // Use uint64_t to get the alignment the cmsg macros need.
+    uint64_t control[
+        (DROP_CONTROL_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_name = source;
+    message.msg_namelen = source ? *src_size : 0;
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(fd, &message, flags);
+    if (received >= 0) {
+      if (source) {
+        *src_size = message.msg_namelen;
+      }
+      ExtractDropCount(&message, drops);
+    }
+    return received;
+  }
+#else
+  (void) drops;
+#endif  // SO_RXQ_OVFL
+  return recvfrom(
+    fd, reinterpret_cast<char*>(buffer), length,
+    flags, reinterpret_cast<struct sockaddr*>(source),
+    source ? src_size : NULL);
+}
+
+/*
+ * If flags is non-zero, this is a non-blocking read and running out of data
+ * isn't logged. If drops is non-NULL, it's updated with the kernel's drop
+ * count.
+ */
 bool ReceiveFrom(int fd, uint8_t *buffer, ssize_t *data_read,
-                 struct sockaddr_in *source, socklen_t *src_size) {
-  *data_read = recvfrom(
-    fd, reinterpret_cast<char*>(buffer), *data_read,
-    0, reinterpret_cast<struct sockaddr*>(source), source ? src_size : NULL);
+                 struct sockaddr_in *source, socklen_t *src_size,
+                 int flags = 0, uint32_t *drops = NULL) {
+  *data_read = ReceiveDatagram(fd, buffer, *data_read, source, src_size,
+                               flags, drops);
   if (*data_read < 0) {
 #ifdef _WIN32
     OLA_WARN << "recvfrom fd: " << fd << " failed: " << WSAGetLastError();
 #else
-    OLA_WARN << "recvfrom fd: " << fd << " failed: " << strerror(errno);
+    if (!(flags && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+      OLA_WARN << "recvfrom fd: " << fd << " failed: " << strerror(errno);
+    }
 #endif  // _WIN32
     return false;
   }
@@ -78,6 +214,31 @@ bool ReceiveFrom(int fd, uint8_t *buffer, ssize_t *data_read,
 
 }  // namespace
 
+// UDPSocketInterface
+// ------------------------------------------------
+
+unsigned int UDPSocketInterface::RecvBatch(UDPDatagram *datagrams,
+                                           unsigned int count) {
+  if (!count) {
+    return 0;
+  }
+  return RecvFrom(datagrams[0].data, &datagrams[0].length,
+                  &datagrams[0].address) ? 1 : 0;
+}
+
+unsigned int UDPSocketInterface::SendBatch(const UDPDatagram *datagrams,
+                                           unsigned int count) const {
+  for (unsigned int i = 0; i < count; i++) {
+    ssize_t bytes_sent = SendTo(datagrams[i].data,
+                                static_cast<unsigned int>(datagrams[i].length),
+                                datagrams[i].address);
+    if (bytes_sent != datagrams[i].length) {
+      return i;
+    }
+  }
+  return count;
+}
+
 // UDPSocket
 // ------------------------------------------------
 
@@ -179,6 +340,8 @@ bool UDPSocket::Close() {
 #endif  // _WIN32
   m_handle = ola::io::INVALID_DESCRIPTOR;
   m_bound_to_port = false;
+  m_receive_timestamps = false;
+  m_count_drops = false;
 #ifdef _WIN32
   if (closesocket(fd)) {
 #else
@@ -222,6 +385,7 @@ ssize_t UDPSocket::SendTo(const uint8_t *buffer,
     sizeof(struct sockaddr));
   if (bytes_sent < 0 || static_cast<unsigned int>(bytes_sent) != size)
     OLA_INFO << "sendto failed: " << dest << " : " << strerror(errno);
+  RecordSent(bytes_sent);
   return bytes_sent;
 }
 
@@ -267,6 +431,7 @@ ssize_t UDPSocket::SendTo(ola::io::IOVecInterface *data,
   message.msg_flags = 0;
 
   ssize_t bytes_sent = sendmsg(WriteDescriptor(), &message, 0);
+  RecordSent(bytes_sent);
 #endif  // _WIN32
   data->FreeIOVec(iov);
 
@@ -282,10 +447,15 @@ ssize_t UDPSocket::SendTo(ola::io::IOVecInterface *data,
 bool UDPSocket::RecvFrom(uint8_t *buffer, ssize_t *data_read) const {
   socklen_t length = 0;
 #ifdef _WIN32
-  return ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read, NULL, &length);
+  bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read, NULL,
+                        &length);
 #else
-  return ReceiveFrom(m_handle, buffer, data_read, NULL, &length);
+  bool ok = ReceiveFrom(m_handle, buffer, data_read, NULL, &length, 0,
+                        DropCounter());
 #endif  // _WIN32
+  if (ok)
+    RecordReceived(*data_read);
+  return ok;
 }
 
 bool UDPSocket::RecvFrom(
@@ -298,10 +468,13 @@ bool UDPSocket::RecvFrom(
   bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read,
                         &src_sockaddr, &src_size);
 #else
-  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size);
+  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size,
+                        0, DropCounter());
 #endif  // _WIN32
-  if (ok)
+  if (ok) {
+    RecordReceived(*data_read);
     source = IPV4Address(src_sockaddr.sin_addr.s_addr);
+  }
   return ok;
 }
 
@@ -315,9 +488,11 @@ bool UDPSocket::RecvFrom(uint8_t *buffer,
   bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read,
                         &src_sockaddr, &src_size);
 #else
-  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size);
+  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size,
+                        0, DropCounter());
 #endif  // _WIN32
   if (ok) {
+    RecordReceived(*data_read);
     source = IPV4Address(src_sockaddr.sin_addr.s_addr);
     port = NetworkToHost(src_sockaddr.sin_port);
   }
@@ -333,15 +508,149 @@ bool UDPSocket::RecvFrom(uint8_t *buffer,
   bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read,
                         &src_sockaddr, &src_size);
 #else
-  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size);
+  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size,
+                        0, DropCounter());
 #endif  // _WIN32
   if (ok) {
+    RecordReceived(*data_read);
     *source = IPV4SocketAddress(IPV4Address(src_sockaddr.sin_addr.s_addr),
                                 NetworkToHost(src_sockaddr.sin_port));
   }
   return ok;
 }
 
+unsigned int UDPSocket::SendBatch(const UDPDatagram *datagrams,
+                                  unsigned int count) const {
+#ifdef HAVE_SENDMMSG
+  struct mmsghdr messages[MAX_SEND_BATCH];
+  struct iovec iovs[MAX_SEND_BATCH];
+  struct sockaddr addresses[MAX_SEND_BATCH];
+
+  unsigned int sent = 0;
+  while (sent < count) {
+    unsigned int batch_size = std::min(count - sent, MAX_SEND_BATCH);
+    memset(messages, 0, sizeof(messages));
+    for (unsigned int i = 0; i < batch_size; i++) {
+      const UDPDatagram &datagram = datagrams[sent + i];
+      if (!datagram.address.ToSockAddr(&addresses[i],
+                                       sizeof(addresses[i]))) {
+        return sent;
+      }
+      iovs[i].iov_base = datagram.data;
+      iovs[i].iov_len = datagram.length;
+      messages[i].msg_hdr.msg_name = &addresses[i];
+      messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      messages[i].msg_hdr.msg_iov = &iovs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int result = sendmmsg(m_handle, messages, batch_size, 0);
+    if (result <= 0) {
+      OLA_INFO << "Failed to send batch on " << m_handle << ": "
+               << strerror(errno);
+      return sent;
+    }
+    for (int i = 0; i < result; i++) {
+      RecordSent(messages[i].msg_len);
+    }
+    sent += static_cast<unsigned int>(result);
+  }
+  return sent;
+#else
+  return UDPSocketInterface::SendBatch(datagrams, count);
+#endif  // HAVE_SENDMMSG
+}
+
+unsigned int UDPSocket::RecvBatch(UDPDatagram *datagrams,
+                                  unsigned int count) {
+  count = std::min(count, MAX_RECV_BATCH);
+  if (!count) {
+    return 0;
+  }
+
+#ifdef HAVE_RECVMMSG
+  struct mmsghdr messages[MAX_RECV_BATCH];
+  struct iovec iovs[MAX_RECV_BATCH];
+  struct sockaddr_in addresses[MAX_RECV_BATCH];
+  memset(messages, 0, sizeof(messages));
+#if defined(SO_TIMESTAMP) || defined(SO_RXQ_OVFL)
+  // Use uint64_t to get the alignment the cmsg macros need.
+  uint64_t control[MAX_RECV_BATCH][
+      (TIMESTAMP_CONTROL_SIZE + DROP_CONTROL_SIZE + sizeof(uint64_t) - 1) /
+      sizeof(uint64_t)];
+  const bool use_control = m_receive_timestamps || m_count_drops;
+#endif  // defined(SO_TIMESTAMP) || defined(SO_RXQ_OVFL)
+
+  for (unsigned int i = 0; i < count; i++) {
+    iovs[i].iov_base = datagrams[i].data;
+    iovs[i].iov_len = datagrams[i].length;
+    messages[i].msg_hdr.msg_name = &addresses[i];
+    messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+    messages[i].msg_hdr.msg_iov = &iovs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+#if defined(SO_TIMESTAMP) || defined(SO_RXQ_OVFL)
+    if (use_control) {
+      messages[i].msg_hdr.msg_control = control[i];
+      messages[i].msg_hdr.msg_controllen = sizeof(control[i]);
+    }
+#endif  // defined(SO_TIMESTAMP) || defined(SO_RXQ_OVFL)
+  }
+
+  // MSG_WAITFORONE blocks for the first datagram only.
+  int received = recvmmsg(m_handle, messages, count, MSG_WAITFORONE, NULL);
+  if (received < 0) {
+    OLA_WARN << "recvmmsg fd: " << m_handle << " failed: " << strerror(errno);
+    return 0;
+  }
+
+  for (int i = 0; i < received; i++) {
+    datagrams[i].length = messages[i].msg_len;
+    datagrams[i].address = IPV4SocketAddress(
+        IPV4Address(addresses[i].sin_addr.s_addr),
+        NetworkToHost(addresses[i].sin_port));
+    RecordReceived(datagrams[i].length);
+#ifdef SO_TIMESTAMP
+    if (m_receive_timestamps) {
+      ExtractTimestamp(&messages[i].msg_hdr, &datagrams[i].timestamp);
+    }
+#endif  // SO_TIMESTAMP
+#ifdef SO_RXQ_OVFL
+    if (m_count_drops) {
+      ExtractDropCount(&messages[i].msg_hdr, &m_stats.kernel_drops);
+    }
+#endif  // SO_RXQ_OVFL
+  }
+  return static_cast<unsigned int>(received);
+#else
+  unsigned int received = 0;
+  for (; received < count; received++) {
+    UDPDatagram *datagram = &datagrams[received];
+    if (received == 0) {
+      if (!RecvFrom(datagram->data, &datagram->length, &datagram->address)) {
+        return 0;
+      }
+      continue;
+    }
+#ifdef MSG_DONTWAIT
+    struct sockaddr_in src_sockaddr;
+    socklen_t src_size = sizeof(src_sockaddr);
+    if (!ReceiveFrom(m_handle, datagram->data, &datagram->length,
+                     &src_sockaddr, &src_size, MSG_DONTWAIT, DropCounter())) {
+      break;
+    }
+    RecordReceived(datagram->length);
+    datagram->address = IPV4SocketAddress(
+        IPV4Address(src_sockaddr.sin_addr.s_addr),
+        NetworkToHost(src_sockaddr.sin_port));
+#else
+    // Without a non-blocking flag we can only safely read one datagram.
+    break;
+#endif  // MSG_DONTWAIT
+  }
+  return received;
+#endif  // HAVE_RECVMMSG
+}
+
 bool UDPSocket::EnableBroadcast() {
   if (m_handle == ola::io::INVALID_DESCRIPTOR)
     return false;
@@ -464,5 +773,127 @@ bool UDPSocket::SetTos(uint8_t tos) {
   }
   return true;
 }
+
+bool UDPSocket::EnableReceiveTimestamps() {
+  // Timestamps are only extracted by the recvmmsg() version of RecvBatch().
+#if defined(HAVE_RECVMMSG) && defined(SO_TIMESTAMP)
+  if (m_handle == ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  int enable = 1;
+  if (setsockopt(m_handle, SOL_SOCKET, TIMESTAMP_OPTION, &enable,
+                 sizeof(enable)) < 0) {
+    OLA_WARN << "Failed to enable receive timestamps for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+  m_receive_timestamps = true;
+  return true;
+#else
+  return false;
+#endif  // defined(HAVE_RECVMMSG) && defined(SO_TIMESTAMP)
+}
+
+bool UDPSocket::SetReceiveBufferSize(unsigned int size) {
+  if (m_handle == ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  int value = static_cast<int>(size);
+#ifdef _WIN32
+  int ok = setsockopt(m_handle.m_handle.m_fd,
+#else
+  int ok = setsockopt(m_handle,
+#endif  // _WIN32
+                      SOL_SOCKET,
+                      SO_RCVBUF,
+                      reinterpret_cast<char*>(&value),
+                      sizeof(value));
+  if (ok < 0) {
+    OLA_WARN << "Failed to set the receive buffer size for " << m_handle
+             << ", " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool UDPSocket::SetSendBufferSize(unsigned int size) {
+  if (m_handle == ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  int value = static_cast<int>(size);
+#ifdef _WIN32
+  int ok = setsockopt(m_handle.m_handle.m_fd,
+#else
+  int ok = setsockopt(m_handle,
+#endif  // _WIN32
+                      SOL_SOCKET,
+                      SO_SNDBUF,
+                      reinterpret_cast<char*>(&value),
+                      sizeof(value));
+  if (ok < 0) {
+    OLA_WARN << "Failed to set the send buffer size for " << m_handle
+             << ", " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool UDPSocket::ReceiveOnlyJoinedGroups() {
+  if (m_handle == ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+#ifdef IP_MULTICAST_ALL
+  int value = 0;
+  if (setsockopt(m_handle, IPPROTO_IP, IP_MULTICAST_ALL, &value,
+                 sizeof(value)) < 0) {
+    OLA_WARN << "Failed to disable IP_MULTICAST_ALL for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+#endif  // IP_MULTICAST_ALL
+  // Other platforms only deliver multicast to the sockets that joined the
+  // group.
+  return true;
+}
+
+bool UDPSocket::EnableDropCounting() {
+#ifdef SO_RXQ_OVFL
+  if (m_handle == ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  int enable = 1;
+  if (setsockopt(m_handle, SOL_SOCKET, SO_RXQ_OVFL, &enable,
+                 sizeof(enable)) < 0) {
+    OLA_WARN << "Failed to enable drop counting for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+  m_count_drops = true;
+  return true;
+#else
+  return false;
+#endif  // SO_RXQ_OVFL
+}
+
+void UDPSocket::RecordReceived(ssize_t length) const {
+  m_stats.packets_received++;
+  m_stats.bytes_received += length;
+}
+
+void UDPSocket::RecordSent(ssize_t length) const {
+  if (length >= 0) {
+    m_stats.packets_sent++;
+    m_stats.bytes_sent += length;
+  }
+}
+
+uint32_t *UDPSocket::DropCounter() const {
+  return m_count_drops ? &m_stats.kernel_drops : NULL;
+}
 }  // namespace network
 }  // namespace ola
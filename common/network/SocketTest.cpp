@@ -24,6 +24,7 @@
 #include <string>
 
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/io/Descriptor.h"
 #include "ola/io/IOQueue.h"
@@ -35,6 +36,9 @@
 #include "ola/testing/TestUtils.h"
 
 
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
 using ola::io::ConnectedDescriptor;
 using ola::io::IOQueue;
 using ola::io::SelectServer;
@@ -43,7 +47,9 @@ using ola::network::GenericSocketAddress;
 using ola::network::IPV4SocketAddress;
 using ola::network::TCPAcceptingSocket;
 using ola::network::TCPSocket;
+using ola::network::UDPDatagram;
 using ola::network::UDPSocket;
+using ola::network::UDPSocketStats;
 using std::string;
 
 static const unsigned char test_cstring[] = "Foo";
@@ -56,6 +62,11 @@ class SocketTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTCPSocketServerClose);
   CPPUNIT_TEST(testUDPSocket);
   CPPUNIT_TEST(testIOQueueUDPSend);
+  CPPUNIT_TEST(testUDPRecvBatch);
+  CPPUNIT_TEST(testUDPSendBatch);
+  CPPUNIT_TEST(testUDPReceiveTimestamps);
+  CPPUNIT_TEST(testUDPSharedPort);
+  CPPUNIT_TEST(testUDPStats);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +76,11 @@ class SocketTest: public CppUnit::TestFixture {
     void testTCPSocketServerClose();
     void testUDPSocket();
     void testIOQueueUDPSend();
+    void testUDPRecvBatch();
+    void testUDPSendBatch();
+    void testUDPReceiveTimestamps();
+    void testUDPSharedPort();
+    void testUDPStats();
 
     // timing out indicates something went wrong
     void Timeout() {
@@ -372,6 +388,216 @@ void SocketTest::NewConnectionSendAndClose(TCPSocket *new_socket) {
 }
 
 
+/*
+ * Test that RecvBatch() drains all the queued datagrams in one call.
+ */
+void SocketTest::testUDPRecvBatch() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+  OLA_ASSERT_TRUE(client_socket.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress client_address;
+  OLA_ASSERT_TRUE(client_socket.GetSocketAddress(&client_address));
+
+  const unsigned int datagram_count = 3;
+  for (unsigned int i = 0; i < datagram_count; i++) {
+    OLA_ASSERT_EQ(static_cast<ssize_t>(i + 1),
+                  client_socket.SendTo(test_cstring, i + 1, local_address));
+  }
+
+  const unsigned int batch_size = 5;
+  uint8_t buffers[batch_size][sizeof(test_cstring) + 10];
+  UDPDatagram datagrams[batch_size];
+  for (unsigned int i = 0; i < batch_size; i++) {
+    datagrams[i].data = buffers[i];
+    datagrams[i].length = sizeof(buffers[i]);
+  }
+
+  OLA_ASSERT_EQ(datagram_count, socket.RecvBatch(datagrams, batch_size));
+  for (unsigned int i = 0; i < datagram_count; i++) {
+    OLA_ASSERT_EQ(static_cast<ssize_t>(i + 1), datagrams[i].length);
+    OLA_ASSERT_EQ(0, memcmp(test_cstring, buffers[i], i + 1));
+    OLA_ASSERT_EQ(client_address, datagrams[i].address);
+  }
+}
+
+
+/*
+ * Test that RecvBatch() returns the receive time if timestamps are enabled.
+ */
+void SocketTest::testUDPReceiveTimestamps() {
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  bool have_timestamps = socket.EnableReceiveTimestamps();
+
+  Clock clock;
+  TimeStamp before, after;
+  clock.CurrentTime(&before);
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(test_cstring)),
+                socket.SendTo(test_cstring, sizeof(test_cstring),
+                              local_address));
+
+  uint8_t buffer[sizeof(test_cstring) + 10];
+  UDPDatagram datagram;
+  datagram.data = buffer;
+  datagram.length = sizeof(buffer);
+  OLA_ASSERT_EQ(1u, socket.RecvBatch(&datagram, 1));
+  clock.CurrentTime(&after);
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(test_cstring)), datagram.length);
+
+  if (!have_timestamps) {
+    OLA_ASSERT_FALSE(datagram.timestamp.IsSet());
+    return;
+  }
+  // Allow for the kernel and gettimeofday() rounding differently.
+  OLA_ASSERT_TRUE(datagram.timestamp.IsSet());
+  OLA_ASSERT_TRUE(before - TimeInterval(0, 1000) <= datagram.timestamp);
+  OLA_ASSERT_TRUE(datagram.timestamp <= after);
+}
+
+
+/*
+ * Test the options used when several sockets share a port.
+ */
+void SocketTest::testUDPSharedPort() {
+  UDPSocket unbound;
+  OLA_ASSERT_FALSE(unbound.SetReceiveBufferSize(65536));
+  OLA_ASSERT_FALSE(unbound.ReceiveOnlyJoinedGroups());
+
+  UDPSocket socket1, socket2;
+  OLA_ASSERT_TRUE(socket1.Init());
+  OLA_ASSERT_TRUE(socket1.Bind(IPV4SocketAddress(IPV4Address::WildCard(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket1.GetSocketAddress(&local_address));
+
+  OLA_ASSERT_TRUE(socket2.Init());
+  OLA_ASSERT_TRUE(socket2.Bind(
+      IPV4SocketAddress(IPV4Address::WildCard(), local_address.Port())));
+
+  OLA_ASSERT_TRUE(socket1.SetReceiveBufferSize(65536));
+  OLA_ASSERT_TRUE(socket2.SetReceiveBufferSize(1 << 20));
+  OLA_ASSERT_TRUE(socket1.ReceiveOnlyJoinedGroups());
+  OLA_ASSERT_TRUE(socket2.ReceiveOnlyJoinedGroups());
+}
+
+
+/*
+ * Test the traffic counters, and that the kernel drops are counted.
+ */
+void SocketTest::testUDPStats() {
+  UDPSocket unbound;
+  OLA_ASSERT_FALSE(unbound.SetSendBufferSize(65536));
+  OLA_ASSERT_FALSE(unbound.EnableDropCounting());
+
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+  OLA_ASSERT_TRUE(socket.SetSendBufferSize(65536));
+  // The kernel rounds this up to its minimum, which holds a few datagrams.
+  OLA_ASSERT_TRUE(socket.SetReceiveBufferSize(1));
+  bool have_drops = socket.EnableDropCounting();
+
+  uint8_t buffer[1000];
+  memset(buffer, 0, sizeof(buffer));
+  const unsigned int datagram_count = 50;
+  for (unsigned int i = 0; i < datagram_count; i++) {
+    OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(buffer)),
+                  socket.SendTo(buffer, sizeof(buffer), local_address));
+  }
+
+  UDPSocketStats stats = socket.Stats();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(datagram_count), stats.packets_sent);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(datagram_count * sizeof(buffer)),
+                stats.bytes_sent);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats.packets_received);
+
+  UDPDatagram datagrams[datagram_count];
+  uint8_t buffers[datagram_count][sizeof(buffer)];
+  for (unsigned int i = 0; i < datagram_count; i++) {
+    datagrams[i].data = buffers[i];
+    datagrams[i].length = sizeof(buffers[i]);
+  }
+  unsigned int received = socket.RecvBatch(datagrams, datagram_count);
+  OLA_ASSERT_TRUE(received > 0);
+  OLA_ASSERT_TRUE(received < datagram_count);
+
+  // The drop count is reported with the next datagram that's queued.
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(buffer)),
+                socket.SendTo(buffer, sizeof(buffer), local_address));
+  ssize_t length = sizeof(buffer);
+  OLA_ASSERT_TRUE(socket.RecvFrom(buffer, &length));
+
+  stats = socket.Stats();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(received + 1), stats.packets_received);
+  OLA_ASSERT_EQ(static_cast<uint64_t>((received + 1) * sizeof(buffer)),
+                stats.bytes_received);
+  if (have_drops) {
+    OLA_ASSERT_TRUE(stats.kernel_drops > 0);
+    OLA_ASSERT_TRUE(stats.kernel_drops <= datagram_count - received);
+  } else {
+    OLA_ASSERT_EQ(0u, stats.kernel_drops);
+  }
+}
+
+
+/*
+ * Test that SendBatch() sends each datagram to its own destination.
+ */
+void SocketTest::testUDPSendBatch() {
+  UDPSocket socket1, socket2;
+  IPV4SocketAddress address1, address2;
+  OLA_ASSERT_TRUE(socket1.Init());
+  OLA_ASSERT_TRUE(socket1.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT_TRUE(socket1.GetSocketAddress(&address1));
+  OLA_ASSERT_TRUE(socket2.Init());
+  OLA_ASSERT_TRUE(socket2.Bind(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT_TRUE(socket2.GetSocketAddress(&address2));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+
+  uint8_t data[sizeof(test_cstring)];
+  memcpy(data, test_cstring, sizeof(data));
+  UDPDatagram outgoing[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    outgoing[i].data = data;
+    outgoing[i].length = i + 1;
+    outgoing[i].address = (i == 1 ? address2 : address1);
+  }
+  OLA_ASSERT_EQ(3u, client_socket.SendBatch(outgoing, 3));
+
+  uint8_t buffers[3][sizeof(test_cstring) + 10];
+  UDPDatagram incoming[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    incoming[i].data = buffers[i];
+    incoming[i].length = sizeof(buffers[i]);
+  }
+
+  OLA_ASSERT_EQ(2u, socket1.RecvBatch(incoming, 3));
+  OLA_ASSERT_EQ(static_cast<ssize_t>(1), incoming[0].length);
+  OLA_ASSERT_EQ(static_cast<ssize_t>(3), incoming[1].length);
+
+  incoming[0].length = sizeof(buffers[0]);
+  OLA_ASSERT_EQ(1u, socket2.RecvBatch(incoming, 3));
+  OLA_ASSERT_EQ(static_cast<ssize_t>(2), incoming[0].length);
+  OLA_ASSERT_EQ(0, memcmp(test_cstring, buffers[0], 2));
+}
+
+
 /*
  * Receive some data and check it.
  */
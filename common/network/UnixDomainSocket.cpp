@@ -0,0 +1,220 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UnixDomainSocket.cpp
+ * Stream sockets in the AF_UNIX domain.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "ola/Logging.h"
+#include "ola/io/Descriptor.h"
+#include "ola/network/SocketCloser.h"
+#include "ola/network/UnixDomainSocket.h"
+
+namespace ola {
+namespace network {
+
+using std::string;
+
+namespace {
+/*
+ * Fill in a sockaddr_un.
+ * @returns false if the path is too long.
+ */
+bool PathToSockAddr(const string &path, struct sockaddr_un *address) {
+  memset(address, 0, sizeof(*address));
+  if (path.empty() || path.size() >= sizeof(address->sun_path)) {
+    OLA_WARN << "Invalid unix socket path: " << path;
+    return false;
+  }
+  address->sun_family = AF_UNIX;
+  memcpy(address->sun_path, path.data(), path.size());
+  return true;
+}
+}  // namespace
+
+// UnixDomainSocket
+// ------------------------------------------------
+
+UnixDomainSocket::UnixDomainSocket(int sd) {
+  m_handle = sd;
+  SetNoSigPipe(m_handle);
+}
+
+bool UnixDomainSocket::Close() {
+  if (m_handle != ola::io::INVALID_DESCRIPTOR) {
+    close(m_handle);
+    m_handle = ola::io::INVALID_DESCRIPTOR;
+  }
+  return true;
+}
+
+UnixDomainSocket* UnixDomainSocket::Connect(const string &path) {
+  struct sockaddr_un server_address;
+  if (!PathToSockAddr(path, &server_address)) {
+    return NULL;
+  }
+
+  int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sd < 0) {
+    OLA_WARN << "socket() failed, " << strerror(errno);
+    return NULL;
+  }
+
+  SocketCloser closer(sd);
+  if (connect(sd, reinterpret_cast<struct sockaddr*>(&server_address),
+              sizeof(server_address))) {
+    OLA_DEBUG << "connect(" << path << "): " << strerror(errno);
+    return NULL;
+  }
+  UnixDomainSocket *socket = new UnixDomainSocket(closer.Release());
+  socket->SetReadNonBlocking();
+  return socket;
+}
+
+bool UnixDomainSocket::PeerUid(uid_t *uid) const {
+#ifdef SO_PEERCRED
+  struct ucred credentials;
+  socklen_t length = sizeof(credentials);
+  if (getsockopt(m_handle, SOL_SOCKET, SO_PEERCRED, &credentials, &length)) {
+    OLA_WARN << "Failed to get the peer credentials: " << strerror(errno);
+    return false;
+  }
+  *uid = credentials.uid;
+  return true;
+#else
+  gid_t gid;
+  if (getpeereid(m_handle, uid, &gid)) {
+    OLA_WARN << "getpeereid() failed: " << strerror(errno);
+    return false;
+  }
+  return true;
+#endif  // SO_PEERCRED
+}
+
+
+// UnixDomainAcceptingSocket
+// ------------------------------------------------
+
+UnixDomainAcceptingSocket::UnixDomainAcceptingSocket(
+    AcceptCallback *on_accept)
+    : ReadFileDescriptor(),
+      m_handle(ola::io::INVALID_DESCRIPTOR),
+      m_on_accept(on_accept) {
+}
+
+UnixDomainAcceptingSocket::~UnixDomainAcceptingSocket() {
+  Close();
+}
+
+bool UnixDomainAcceptingSocket::Listen(const string &path, int backlog) {
+  if (m_handle != ola::io::INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  struct sockaddr_un server_address;
+  if (!PathToSockAddr(path, &server_address)) {
+    return false;
+  }
+
+  int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sd < 0) {
+    OLA_WARN << "socket() failed: " << strerror(errno);
+    return false;
+  }
+
+  SocketCloser closer(sd);
+  if (!ola::io::ConnectedDescriptor::SetNonBlocking(sd)) {
+    OLA_WARN << "Failed to mark unix accept socket as non-blocking";
+    return false;
+  }
+
+  // Remove a socket left behind by a previous instance. Anything else at the
+  // path is left alone and bind() will fail.
+  struct stat stat_buf;
+  if (lstat(path.c_str(), &stat_buf) == 0 && S_ISSOCK(stat_buf.st_mode)) {
+    if (unlink(path.c_str())) {
+      OLA_WARN << "Failed to remove " << path << ": " << strerror(errno);
+    }
+  }
+
+  if (bind(sd, reinterpret_cast<struct sockaddr*>(&server_address),
+           sizeof(server_address)) == -1) {
+    OLA_WARN << "bind to " << path << " failed, " << strerror(errno);
+    return false;
+  }
+
+  if (listen(sd, backlog)) {
+    OLA_WARN << "listen on " << path << " failed, " << strerror(errno);
+    unlink(path.c_str());
+    return false;
+  }
+  m_handle = closer.Release();
+  m_path = path;
+  return true;
+}
+
+bool UnixDomainAcceptingSocket::Close() {
+  bool ret = true;
+  if (m_handle != ola::io::INVALID_DESCRIPTOR) {
+    if (close(m_handle)) {
+      OLA_WARN << "close() failed " << strerror(errno);
+      ret = false;
+    }
+  }
+  m_handle = ola::io::INVALID_DESCRIPTOR;
+
+  if (!m_path.empty()) {
+    unlink(m_path.c_str());
+    m_path.clear();
+  }
+  return ret;
+}
+
+void UnixDomainAcceptingSocket::PerformRead() {
+  if (m_handle == ola::io::INVALID_DESCRIPTOR)
+    return;
+
+  while (1) {
+    int sd = accept(m_handle, NULL, NULL);
+    if (sd < 0) {
+      if (errno != EWOULDBLOCK && errno != EAGAIN) {
+        OLA_WARN << "accept() failed, " << strerror(errno);
+      }
+      return;
+    }
+
+    if (m_on_accept.get()) {
+      UnixDomainSocket *socket = new UnixDomainSocket(sd);
+      socket->SetReadNonBlocking();
+      m_on_accept->Run(socket);
+    } else {
+      OLA_WARN << "Accepted new unix connection but no callback registered";
+      close(sd);
+    }
+  }
+}
+}  // namespace network
+}  // namespace ola
@@ -0,0 +1,189 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UnixDomainSocketTest.cpp
+ * Test fixture for the UnixDomainSocket classes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/UnixDomainSocket.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::io::SelectServer;
+using ola::network::UnixDomainAcceptingSocket;
+using ola::network::UnixDomainSocket;
+using std::auto_ptr;
+using std::string;
+
+class UnixDomainSocketTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UnixDomainSocketTest);
+  CPPUNIT_TEST(testConnect);
+  CPPUNIT_TEST(testStaleSocket);
+  CPPUNIT_TEST(testPeerUid);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+  void testConnect();
+  void testStaleSocket();
+  void testPeerUid();
+
+  void NewConnection(UnixDomainSocket *socket) {
+    m_accepted.reset(socket);
+    m_ss.Terminate();
+  }
+
+  void ReceiveData() {
+    uint8_t buffer[10];
+    unsigned int size;
+    OLA_ASSERT_FALSE(m_accepted->Receive(buffer, sizeof(buffer), size));
+    m_received.append(reinterpret_cast<char*>(buffer), size);
+    m_ss.Terminate();
+  }
+
+ private:
+  SelectServer m_ss;
+  string m_path;
+  auto_ptr<UnixDomainSocket> m_accepted;
+  string m_received;
+
+  bool PathExists() const {
+    struct stat stat_buf;
+    return lstat(m_path.c_str(), &stat_buf) == 0;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UnixDomainSocketTest);
+
+void UnixDomainSocketTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  std::ostringstream str;
+  str << "/tmp/ola-socket-test-" << getpid();
+  m_path = str.str();
+  unlink(m_path.c_str());
+}
+
+void UnixDomainSocketTest::tearDown() {
+  m_accepted.reset();
+  unlink(m_path.c_str());
+}
+
+/*
+ * Check we can accept a connection and send data over it.
+ */
+void UnixDomainSocketTest::testConnect() {
+  OLA_ASSERT_NULL(UnixDomainSocket::Connect(m_path));
+
+  UnixDomainAcceptingSocket listener(
+      ola::NewCallback(this, &UnixDomainSocketTest::NewConnection));
+  OLA_ASSERT_TRUE(listener.Listen(m_path));
+  OLA_ASSERT_EQ(m_path, listener.Path());
+  OLA_ASSERT_TRUE(PathExists());
+  // Already listening.
+  OLA_ASSERT_FALSE(listener.Listen(m_path));
+  OLA_ASSERT_TRUE(m_ss.AddReadDescriptor(&listener));
+
+  auto_ptr<UnixDomainSocket> client(UnixDomainSocket::Connect(m_path));
+  OLA_ASSERT_NOT_NULL(client.get());
+  m_ss.Run();
+  OLA_ASSERT_NOT_NULL(m_accepted.get());
+
+  m_accepted->SetOnData(
+      ola::NewCallback(this, &UnixDomainSocketTest::ReceiveData));
+  OLA_ASSERT_TRUE(m_ss.AddReadDescriptor(m_accepted.get()));
+  const uint8_t data[] = "Foo";
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(data)),
+                client->Send(data, sizeof(data)));
+  m_ss.Run();
+  OLA_ASSERT_EQ(string(reinterpret_cast<const char*>(data), sizeof(data)),
+                m_received);
+  m_ss.RemoveReadDescriptor(m_accepted.get());
+
+  m_ss.RemoveReadDescriptor(&listener);
+  OLA_ASSERT_TRUE(listener.Close());
+  OLA_ASSERT_FALSE(PathExists());
+}
+
+/*
+ * Check a socket left behind by a previous listener is replaced, but other
+ * files are left alone.
+ */
+void UnixDomainSocketTest::testStaleSocket() {
+  // Bind a socket and close it without removing the path, as if the process
+  // had crashed.
+  int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+  OLA_ASSERT_TRUE(sd >= 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, m_path.c_str(), sizeof(address.sun_path) - 1);
+  OLA_ASSERT_EQ(0, bind(sd, reinterpret_cast<struct sockaddr*>(&address),
+                        sizeof(address)));
+  close(sd);
+  OLA_ASSERT_TRUE(PathExists());
+
+  {
+    UnixDomainAcceptingSocket listener(NULL);
+    OLA_ASSERT_TRUE(listener.Listen(m_path));
+  }
+  OLA_ASSERT_FALSE(PathExists());
+
+  FILE *file = fopen(m_path.c_str(), "w");
+  OLA_ASSERT_NOT_NULL(file);
+  fclose(file);
+  UnixDomainAcceptingSocket listener(NULL);
+  OLA_ASSERT_FALSE(listener.Listen(m_path));
+  OLA_ASSERT_TRUE(PathExists());
+}
+
+
+/*
+ * Check both ends of a connection can find the user id of the other end.
+ */
+void UnixDomainSocketTest::testPeerUid() {
+  UnixDomainAcceptingSocket listener(
+      ola::NewCallback(this, &UnixDomainSocketTest::NewConnection));
+  OLA_ASSERT_TRUE(listener.Listen(m_path));
+  OLA_ASSERT_TRUE(m_ss.AddReadDescriptor(&listener));
+
+  auto_ptr<UnixDomainSocket> client(UnixDomainSocket::Connect(m_path));
+  OLA_ASSERT_NOT_NULL(client.get());
+  m_ss.Run();
+  OLA_ASSERT_NOT_NULL(m_accepted.get());
+  m_ss.RemoveReadDescriptor(&listener);
+
+  uid_t uid;
+  OLA_ASSERT_TRUE(client->PeerUid(&uid));
+  OLA_ASSERT_EQ(geteuid(), uid);
+  OLA_ASSERT_TRUE(m_accepted->PeerUid(&uid));
+  OLA_ASSERT_EQ(geteuid(), uid);
+}
@@ -51,6 +51,7 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testNonMutingResponder);
   CPPUNIT_TEST(testFlakeyResponder);
   CPPUNIT_TEST(testProxy);
+  CPPUNIT_TEST(testKnownUIDs);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -69,6 +70,7 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
     void testNonMutingResponder();
     void testFlakeyResponder();
     void testProxy();
+    void testKnownUIDs();
 
  private:
     bool m_callback_run;
@@ -479,3 +481,31 @@ void DiscoveryAgentTest::testProxy() {
   OLA_ASSERT_TRUE(m_callback_run);
   m_callback_run = false;
 }
+
+
+/*
+ * Test incremental discovery with UIDs from a previous run.
+ */
+void DiscoveryAgentTest::testKnownUIDs() {
+  UIDSet uids;
+  ResponderList responders;
+  uids.AddUID(UID(1, 10));
+  uids.AddUID(UID(2, 7));
+  uids.AddUID(UID(2, 9));
+  PopulateResponderListFromUIDs(uids, &responders);
+  MockDiscoveryTarget target(responders);
+  DiscoveryAgent agent(&target);
+
+  // One of the known responders has gone & one is new.
+  UIDSet known_uids;
+  known_uids.AddUID(UID(1, 10));
+  known_uids.AddUID(UID(2, 7));
+  known_uids.AddUID(UID(3, 1));
+  agent.SetKnownUIDs(known_uids);
+
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+}
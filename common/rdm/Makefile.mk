@@ -98,6 +98,9 @@ common_rdm_PidStoreTester_SOURCES = \
 common_rdm_PidStoreTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
 common_rdm_PidStoreTester_LDADD = $(COMMON_TESTING_LIBS)
 
+CLEANFILES += common/rdm/compiled_pids_test/*.bin \
+              common/rdm/compiled_pids_test/*.proto
+
 common_rdm_RDMHelperTester_SOURCES = common/rdm/RDMHelperTest.cpp
 common_rdm_RDMHelperTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_rdm_RDMHelperTester_LDADD = $(COMMON_TESTING_LIBS)
@@ -156,3 +159,11 @@ common_rdm_UIDTester_SOURCES = \
     common/rdm/UIDTest.cpp
 common_rdm_UIDTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_rdm_UIDTester_LDADD = $(COMMON_TESTING_LIBS)
+
+# BENCHMARKS
+##################################################
+benchmark_programs += common/rdm/MessageDeserializerBenchmark
+
+common_rdm_MessageDeserializerBenchmark_SOURCES = \
+    common/rdm/MessageDeserializerBenchmark.cpp
+common_rdm_MessageDeserializerBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS)
@@ -31,6 +31,9 @@
 namespace ola {
 namespace rdm {
 
+using ola::messaging::FieldDescriptor;
+using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::FlatLayout;
 using ola::messaging::MessageFieldInterface;
 using std::string;
 using std::vector;
@@ -44,9 +47,7 @@ MessageDeserializer::MessageDeserializer()
 }
 
 
-MessageDeserializer::~MessageDeserializer() {
-  CleanUpVector();
-}
+MessageDeserializer::~MessageDeserializer() {}
 
 
 /**
@@ -66,8 +67,6 @@ const ola::messaging::Message *MessageDeserializer::InflateMessage(
   m_offset = 0;
   m_insufficient_data = false;
 
-  CleanUpVector();
-
   VariableFieldSizeCalculator calculator;
   VariableFieldSizeCalculator::calculator_state state =
     calculator.CalculateFieldSize(
@@ -89,160 +88,133 @@ const ola::messaging::Message *MessageDeserializer::InflateMessage(
         return NULL;
   }
 
-  message_vector root_messages;
-  m_message_stack.push(root_messages);
-
-  descriptor->Accept(this);
+  message_vector fields;
+  InflateFields(descriptor->Layout().Fields(), 0, &fields);
+  const ola::messaging::Message *message =
+      new ola::messaging::Message(&fields);
 
   // this should never trigger because we check the length in the
   // VariableFieldSizeCalculator
   if (m_insufficient_data) {
+    delete message;
     return NULL;
   }
-
-  const ola::messaging::Message *message =  new ola::messaging::Message(
-      m_message_stack.top());
-  m_message_stack.top().clear();
   return message;
 }
 
 
-void MessageDeserializer::Visit(
-    const ola::messaging::BoolFieldDescriptor *descriptor) {
-  if (!CheckForData(descriptor->MaxSize())) {
-    return;
-  }
-
-  m_message_stack.top().push_back(
-    new ola::messaging::BoolMessageField(descriptor, m_data[m_offset++]));
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IPV4FieldDescriptor *descriptor) {
-  if (!CheckForData(descriptor->MaxSize())) {
-    return;
-  }
-
-  uint32_t data;
-  memcpy(&data, m_data + m_offset, sizeof(data));
-  m_offset += sizeof(data);
-  m_message_stack.top().push_back(
-    new ola::messaging::IPV4MessageField(
-      descriptor,
-      ola::network::IPV4Address(data)));
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::MACFieldDescriptor *descriptor) {
-  if (!CheckForData(descriptor->MaxSize())) {
-    return;
-  }
-
-  ola::network::MACAddress mac_address(m_data + m_offset);
-  m_offset += descriptor->MaxSize();
-  m_message_stack.top().push_back(
-    new ola::messaging::MACMessageField(descriptor, mac_address));
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::UIDFieldDescriptor *descriptor) {
-  if (!CheckForData(descriptor->MaxSize())) {
-    return;
-  }
-
-  ola::rdm::UID uid(m_data + m_offset);
-  m_offset += descriptor->MaxSize();
-  m_message_stack.top().push_back(
-    new ola::messaging::UIDMessageField(descriptor, uid));
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::StringFieldDescriptor *descriptor) {
-  unsigned int string_size;
-
-  if (descriptor->FixedSize()) {
-    string_size = descriptor->MaxSize();
-  } else {
-    // variable sized string, the length is in m_variable_field_size
-    string_size = m_variable_field_size;
-  }
-
-  if (!CheckForData(string_size)) {
-    return;
-  }
-
-  string value(reinterpret_cast<const char *>(m_data + m_offset), string_size);
-  ShortenString(&value);
-  m_offset += string_size;
-  m_message_stack.top().push_back(
-    new ola::messaging::StringMessageField(descriptor, value));
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IntegerFieldDescriptor<uint8_t> *descriptor) {
-  IntVisit(descriptor);
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IntegerFieldDescriptor<uint16_t> *descriptor) {
-  IntVisit(descriptor);
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IntegerFieldDescriptor<uint32_t> *descriptor) {
-  IntVisit(descriptor);
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IntegerFieldDescriptor<int8_t> *descriptor) {
-  IntVisit(descriptor);
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IntegerFieldDescriptor<int16_t> *descriptor) {
-  IntVisit(descriptor);
-}
-
-
-void MessageDeserializer::Visit(
-    const ola::messaging::IntegerFieldDescriptor<int32_t> *descriptor) {
-  IntVisit(descriptor);
-}
-
-
 /**
- * @brief Visit a group field
+ * @brief Inflate the fields from index up to the end of the enclosing group.
+ * @returns the index of the GROUP_END, or the number of fields.
  */
-void MessageDeserializer::Visit(
-    const ola::messaging::FieldDescriptorGroup *descriptor) {
-
-  unsigned int iterations = descriptor->FixedSize() ? descriptor->MinBlocks() :
-    m_variable_field_size;
-
-  for (unsigned int i = 0; i < iterations; ++i) {
-    vector<const MessageFieldInterface*> fields;
-    m_message_stack.push(fields);
-
-    for (unsigned int j = 0; j < descriptor->FieldCount(); ++j) {
-      descriptor->GetField(j)->Accept(this);
+unsigned int MessageDeserializer::InflateFields(
+    const vector<FlatLayout::Field> &fields,
+    unsigned int index,
+    message_vector *output) {
+  for (; index < fields.size(); ++index) {
+    const FlatLayout::Field &field = fields[index];
+    const MessageFieldInterface *message_field = NULL;
+
+    switch (field.type) {
+      case FlatLayout::BOOL:
+        if (CheckForData(field.size)) {
+          message_field = new ola::messaging::BoolMessageField(
+              static_cast<const ola::messaging::BoolFieldDescriptor*>(
+                  field.descriptor),
+              m_data[m_offset]);
+        }
+        break;
+      case FlatLayout::IPV4:
+        if (CheckForData(field.size)) {
+          uint32_t data;
+          memcpy(&data, m_data + m_offset, sizeof(data));
+          message_field = new ola::messaging::IPV4MessageField(
+              static_cast<const ola::messaging::IPV4FieldDescriptor*>(
+                  field.descriptor),
+              ola::network::IPV4Address(data));
+        }
+        break;
+      case FlatLayout::MAC:
+        if (CheckForData(field.size)) {
+          message_field = new ola::messaging::MACMessageField(
+              static_cast<const ola::messaging::MACFieldDescriptor*>(
+                  field.descriptor),
+              ola::network::MACAddress(m_data + m_offset));
+        }
+        break;
+      case FlatLayout::UID:
+        if (CheckForData(field.size)) {
+          message_field = new ola::messaging::UIDMessageField(
+              static_cast<const ola::messaging::UIDFieldDescriptor*>(
+                  field.descriptor),
+              ola::rdm::UID(m_data + m_offset));
+        }
+        break;
+      case FlatLayout::STRING:
+        {
+          // the length of a variable sized string is in
+          // m_variable_field_size
+          unsigned int string_size = field.variable ? m_variable_field_size :
+                                                      field.size;
+          if (CheckForData(string_size)) {
+            string value(reinterpret_cast<const char *>(m_data + m_offset),
+                         string_size);
+            ShortenString(&value);
+            message_field = new ola::messaging::StringMessageField(
+                static_cast<const ola::messaging::StringFieldDescriptor*>(
+                    field.descriptor),
+                value);
+            m_offset += string_size;
+          }
+        }
+        break;
+      case FlatLayout::UINT8:
+        message_field = InflateInt<uint8_t>(field.descriptor);
+        break;
+      case FlatLayout::UINT16:
+        message_field = InflateInt<uint16_t>(field.descriptor);
+        break;
+      case FlatLayout::UINT32:
+        message_field = InflateInt<uint32_t>(field.descriptor);
+        break;
+      case FlatLayout::INT8:
+        message_field = InflateInt<int8_t>(field.descriptor);
+        break;
+      case FlatLayout::INT16:
+        message_field = InflateInt<int16_t>(field.descriptor);
+        break;
+      case FlatLayout::INT32:
+        message_field = InflateInt<int32_t>(field.descriptor);
+        break;
+      case FlatLayout::GROUP_START:
+        {
+          const FieldDescriptorGroup *group =
+              static_cast<const FieldDescriptorGroup*>(field.descriptor);
+          unsigned int blocks = field.variable ? m_variable_field_size :
+                                                 field.size;
+          for (unsigned int i = 0; i < blocks; ++i) {
+            message_vector block_fields;
+            block_fields.reserve(group->FieldCount());
+            InflateFields(fields, index + 1, &block_fields);
+            output->push_back(
+                new ola::messaging::GroupMessageField(group, &block_fields));
+          }
+          index = field.end;
+        }
+        continue;
+      case FlatLayout::GROUP_END:
+        return index;
     }
 
-    const vector<const MessageFieldInterface*> &populated_fields =
-        m_message_stack.top();
-    const ola::messaging::MessageFieldInterface *message =
-        new ola::messaging::GroupMessageField(descriptor, populated_fields);
-    m_message_stack.pop();
-    m_message_stack.top().push_back(message);
+    if (message_field) {
+      output->push_back(message_field);
+      // Strings have already moved the offset, since their size varies.
+      if (field.type != FlatLayout::STRING) {
+        m_offset += field.size;
+      }
+    }
   }
+  return index;
 }
 
 
@@ -258,47 +230,31 @@ bool MessageDeserializer::CheckForData(unsigned int required_size) {
 }
 
 
-
-/**
- * @brief Remove any old messages from the stack.
- */
-void MessageDeserializer::CleanUpVector() {
-  while (!m_message_stack.empty()) {
-    const message_vector &fields = m_message_stack.top();
-    message_vector::const_iterator iter = fields.begin();
-    for (; iter != fields.end(); ++iter) {
-      delete *iter;
-    }
-    m_message_stack.pop();
-  }
-}
-
-
 /**
  * @brief Deserialize an integer value, converting from little endian if needed
  */
 template <typename int_type>
-void MessageDeserializer::IntVisit(
-    const ola::messaging::IntegerFieldDescriptor<int_type> *descriptor) {
+const MessageFieldInterface *MessageDeserializer::InflateInt(
+    const FieldDescriptor *field_descriptor) {
   if (!CheckForData(sizeof(int_type))) {
-    return;
+    return NULL;
   }
 
+  const ola::messaging::IntegerFieldDescriptor<int_type> *descriptor =
+      static_cast<const ola::messaging::IntegerFieldDescriptor<int_type>*>(
+          field_descriptor);
   int_type value;
 
   memcpy(reinterpret_cast<uint8_t*>(&value),
          m_data + m_offset,
          sizeof(int_type));
-  m_offset += sizeof(int_type);
 
   if (descriptor->IsLittleEndian()) {
     value = ola::network::LittleEndianToHost(value);
   } else {
     value = ola::network::NetworkToHost(value);
   }
-
-  m_message_stack.top().push_back(
-    new ola::messaging::BasicMessageField<int_type>(descriptor, value));
+  return new ola::messaging::BasicMessageField<int_type>(descriptor, value);
 }
 }  // namespace rdm
 }  // namespace ola
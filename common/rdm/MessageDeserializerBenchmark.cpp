@@ -0,0 +1,107 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessageDeserializerBenchmark.cpp
+ * Microbenchmarks for inflating RDM responses.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/messaging/Descriptor.h"
+#include "ola/messaging/Message.h"
+#include "ola/rdm/MessageDeserializer.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::messaging::Descriptor;
+using ola::messaging::FieldDescriptor;
+using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::Int16FieldDescriptor;
+using ola::messaging::Message;
+using ola::messaging::StringFieldDescriptor;
+using ola::messaging::UInt16FieldDescriptor;
+using ola::messaging::UInt8FieldDescriptor;
+using ola::rdm::MessageDeserializer;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using std::auto_ptr;
+using std::vector;
+
+namespace {
+
+/*
+ * The layout of a SENSOR_DEFINITION response.
+ */
+Descriptor *SensorDefinition() {
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new UInt8FieldDescriptor("sensor_number"));
+  fields.push_back(new UInt8FieldDescriptor("type"));
+  fields.push_back(new UInt8FieldDescriptor("unit"));
+  fields.push_back(new UInt8FieldDescriptor("prefix"));
+  fields.push_back(new Int16FieldDescriptor("range_min"));
+  fields.push_back(new Int16FieldDescriptor("range_max"));
+  fields.push_back(new Int16FieldDescriptor("normal_min"));
+  fields.push_back(new Int16FieldDescriptor("normal_max"));
+  fields.push_back(new UInt8FieldDescriptor("supports_recording"));
+  fields.push_back(new StringFieldDescriptor("name", 0, 32));
+  return new Descriptor("SENSOR_DEFINITION", fields);
+}
+
+/*
+ * The layout of a SUPPORTED_PARAMETERS response.
+ */
+Descriptor *SupportedParameters() {
+  vector<const FieldDescriptor*> group_fields;
+  group_fields.push_back(new UInt16FieldDescriptor("param_id"));
+  vector<const FieldDescriptor*> fields;
+  fields.push_back(new FieldDescriptorGroup("params", group_fields, 0, 115));
+  return new Descriptor("SUPPORTED_PARAMETERS", fields);
+}
+
+void Inflate(BenchmarkState *state, const Descriptor *descriptor,
+             const vector<uint8_t> &data) {
+  MessageDeserializer deserializer;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    auto_ptr<const Message> message(
+        deserializer.InflateMessage(descriptor, &data[0], data.size()));
+    DoNotOptimize(message.get());
+  }
+  state->SetBytesProcessed(state->Iterations() * data.size());
+}
+
+void BenchmarkInflateSensorDefinition(BenchmarkState *state) {
+  auto_ptr<Descriptor> descriptor(SensorDefinition());
+  vector<uint8_t> data(13, 1);
+  const char name[] = "Temperature";
+  data.insert(data.end(), name, name + sizeof(name) - 1);
+  Inflate(state, descriptor.get(), data);
+}
+OLA_BENCHMARK(BenchmarkInflateSensorDefinition);
+
+void BenchmarkInflateSupportedParameters(BenchmarkState *state) {
+  auto_ptr<Descriptor> descriptor(SupportedParameters());
+  vector<uint8_t> data;
+  for (unsigned int i = 0; i < 40; i++) {
+    data.push_back(0x80);
+    data.push_back(static_cast<uint8_t>(i));
+  }
+  Inflate(state, descriptor.get(), data);
+}
+OLA_BENCHMARK(BenchmarkInflateSupportedParameters);
+}  // namespace
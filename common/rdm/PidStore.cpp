@@ -18,6 +18,7 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,16 @@ namespace rdm {
 using std::string;
 using std::vector;
 
+namespace {
+bool PidLessThan(const PidDescriptor *left, const PidDescriptor *right) {
+  return left->Value() < right->Value();
+}
+
+bool PidValueLessThan(const PidDescriptor *descriptor, uint16_t pid_value) {
+  return descriptor->Value() < pid_value;
+}
+}  // namespace
+
 RootPidStore::~RootPidStore() {
   m_esta_store.reset();
   STLDeleteValues(&m_manufacturer_store);
@@ -128,26 +139,22 @@ const string RootPidStore::DataLocation() {
   return PID_DATA_DIR;
 }
 
-PidStore::PidStore(const vector<const PidDescriptor*> &pids) {
+PidStore::PidStore(const vector<const PidDescriptor*> &pids)
+    : m_pid_by_value(pids) {
+  std::sort(m_pid_by_value.begin(), m_pid_by_value.end(), PidLessThan);
   vector<const PidDescriptor*>::const_iterator iter = pids.begin();
   for (; iter != pids.end(); ++iter) {
-    m_pid_by_value[(*iter)->Value()] = *iter;
     m_pid_by_name[(*iter)->Name()] = *iter;
   }
 }
 
 PidStore::~PidStore() {
-  STLDeleteValues(&m_pid_by_value);
+  STLDeleteElements(&m_pid_by_value);
   m_pid_by_name.clear();
 }
 
 void PidStore::AllPids(vector<const PidDescriptor*> *pids) const {
-  pids->reserve(pids->size() + m_pid_by_value.size());
-
-  PidMap::const_iterator iter = m_pid_by_value.begin();
-  for (; iter != m_pid_by_value.end(); ++iter) {
-    pids->push_back(iter->second);
-  }
+  pids->insert(pids->end(), m_pid_by_value.begin(), m_pid_by_value.end());
 }
 
 
@@ -167,11 +174,13 @@ PidDescriptor::~PidDescriptor() {
  * @param pid_value the 16 bit pid value.
  */
 const PidDescriptor *PidStore::LookupPID(uint16_t pid_value) const {
-  PidMap::const_iterator iter = m_pid_by_value.find(pid_value);
-  if (iter == m_pid_by_value.end())
+  PidVector::const_iterator iter = std::lower_bound(
+      m_pid_by_value.begin(), m_pid_by_value.end(), pid_value,
+      PidValueLessThan);
+  if (iter == m_pid_by_value.end() || (*iter)->Value() != pid_value)
     return NULL;
   else
-    return iter->second;
+    return *iter;
 }
 
 
@@ -21,6 +21,7 @@
 #include <errno.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
+#include <algorithm>
 #include <fstream>
 #include <set>
 #include <sstream>
@@ -49,7 +50,11 @@ using std::set;
 using std::string;
 using std::vector;
 
+const char PidStoreLoader::COMPILED_FILE_NAME[] = "compiled_pids.bin";
 const char PidStoreLoader::OVERRIDE_FILE_NAME[] = "overrides.proto";
+// The FNV-1a parameters, this is only used to spot stale compiled files.
+const uint64_t PidStoreLoader::CHECKSUM_OFFSET = 14695981039346656037ULL;
+const uint64_t PidStoreLoader::CHECKSUM_PRIME = 1099511628211ULL;
 const uint16_t PidStoreLoader::ESTA_MANUFACTURER_ID = 0;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MIN = 0x8000;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MAX = 0xffe0;
@@ -71,61 +76,171 @@ const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
 const RootPidStore *PidStoreLoader::LoadFromDirectory(
     const string &directory,
     bool validate) {
-  vector<string> files;
+  ola::rdm::pid::PidStore pid_store_pb;
+  uint64_t checksum;
+  string override_file;
+  if (!ReadDirectory(directory, &pid_store_pb, &checksum, &override_file)) {
+    return NULL;
+  }
+
+  ola::rdm::pid::PidStore override_pb;
+  if (!override_file.empty()) {
+    if (!ReadFile(override_file, &override_pb)) {
+      return NULL;
+    }
+  }
+
+  return BuildStore(pid_store_pb, override_pb, validate);
+}
+
+const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
+                                                   bool validate) {
+  ola::rdm::pid::PidStore pid_store_pb;
+  google::protobuf::io::IstreamInputStream input_stream(data);
+  bool ok = google::protobuf::TextFormat::Parse(&input_stream, &pid_store_pb);
+
+  if (!ok)
+    return NULL;
+
+  ola::rdm::pid::PidStore override_pb;
+  return BuildStore(pid_store_pb, override_pb, validate);
+}
 
+bool PidStoreLoader::CompileDirectory(const string &directory,
+                                      const string &output_file) {
+  ola::rdm::pid::CompiledPidStore compiled_pb;
+  uint64_t checksum;
   string override_file;
+  // Force the text files to be parsed, they may have changed.
+  if (!ReadDirectory(directory, compiled_pb.mutable_store(), &checksum,
+                     &override_file)) {
+    return false;
+  }
+  compiled_pb.set_checksum(checksum);
+  if (!compiled_pb.IsInitialized()) {
+    OLA_WARN << "Missing fields in the PIDs from " << directory << ": "
+             << compiled_pb.InitializationErrorString();
+    return false;
+  }
+
+  // Check the data is valid before writing it.
+  ola::rdm::pid::PidStore override_pb;
+  auto_ptr<const RootPidStore> store(
+      BuildStore(compiled_pb.store(), override_pb, true));
+  if (!store.get()) {
+    return false;
+  }
+
+  std::ofstream output(output_file.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output.is_open()) {
+    OLA_WARN << "Failed to open " << output_file << ": " << strerror(errno);
+    return false;
+  }
+
+  if (!compiled_pb.SerializeToOstream(&output)) {
+    OLA_WARN << "Failed to write " << output_file;
+    return false;
+  }
+  output.close();
+  return true;
+}
+
+/*
+ * Read the text files in a directory, or the compiled file if it's up to
+ * date. The checksum of the text files is returned in checksum.
+ */
+bool PidStoreLoader::ReadDirectory(const string &directory,
+                                   ola::rdm::pid::PidStore *proto,
+                                   uint64_t *checksum,
+                                   string *override_file) {
+  vector<string> files;
+  string compiled_file;
+
   vector<string> all_files;
   ola::file::ListDirectory(directory, &all_files);
   vector<string>::const_iterator file_iter = all_files.begin();
   for (; file_iter != all_files.end(); ++file_iter) {
-    if (ola::file::FilenameFromPath(*file_iter) == OVERRIDE_FILE_NAME) {
-      override_file = *file_iter;
+    const string file_name = ola::file::FilenameFromPath(*file_iter);
+    if (file_name == OVERRIDE_FILE_NAME) {
+      *override_file = *file_iter;
+    } else if (file_name == COMPILED_FILE_NAME) {
+      compiled_file = *file_iter;
     } else if (StringEndsWith(*file_iter, ".proto")) {
       files.push_back(*file_iter);
     }
   }
+  // The checksum depends on the order.
+  std::sort(files.begin(), files.end());
 
-  ola::rdm::pid::PidStore pid_store_pb;
+  // Reading the files is cheap, it's the parsing that takes the time.
+  vector<string> contents;
+  *checksum = CHECKSUM_OFFSET;
   vector<string>::const_iterator iter = files.begin();
   for (; iter != files.end(); ++iter) {
-    std::ifstream proto_file(iter->data());
+    std::ifstream proto_file(iter->data(), std::ios::in | std::ios::binary);
     if (!proto_file.is_open()) {
       OLA_WARN << "Failed to open " << *iter << ": " << strerror(errno);
-      return NULL;
+      return false;
     }
-
-    google::protobuf::io::IstreamInputStream input_stream(&proto_file);
-    bool ok = google::protobuf::TextFormat::Merge(&input_stream,
-                                                  &pid_store_pb);
+    ostringstream str;
+    str << proto_file.rdbuf();
     proto_file.close();
-
-    if (!ok) {
-      OLA_WARN << "Failed to load " << *iter;
-      return NULL;
+    contents.push_back(str.str());
+
+    // Include the separators, so moving data between files changes the sum.
+    const string file_name = ola::file::FilenameFromPath(*iter);
+    const string *parts[] = {&file_name, &contents.back()};
+    for (unsigned int i = 0; i < 2; i++) {
+      string::const_iterator c = parts[i]->begin();
+      for (; c != parts[i]->end(); ++c) {
+        *checksum = (*checksum ^ static_cast<uint8_t>(*c)) * CHECKSUM_PRIME;
+      }
+      *checksum *= CHECKSUM_PRIME;
     }
   }
 
-  ola::rdm::pid::PidStore override_pb;
-  if (!override_file.empty()) {
-    if (!ReadFile(override_file, &override_pb)) {
-      return NULL;
-    }
+  if (!compiled_file.empty() &&
+      ReadCompiledFile(compiled_file, *checksum, proto)) {
+    return true;
   }
 
-  return BuildStore(pid_store_pb, override_pb, validate);
+  for (unsigned int i = 0; i < files.size(); i++) {
+    if (!google::protobuf::TextFormat::MergeFromString(contents[i], proto)) {
+      OLA_WARN << "Failed to load " << files[i];
+      return false;
+    }
+  }
+  return true;
 }
 
-const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
-                                                   bool validate) {
-  ola::rdm::pid::PidStore pid_store_pb;
-  google::protobuf::io::IstreamInputStream input_stream(data);
-  bool ok = google::protobuf::TextFormat::Parse(&input_stream, &pid_store_pb);
+bool PidStoreLoader::ReadCompiledFile(const string &file_path,
+                                      uint64_t checksum,
+                                      ola::rdm::pid::PidStore *proto) {
+  std::ifstream compiled_file(file_path.c_str(),
+                              std::ios::in | std::ios::binary);
+  if (!compiled_file.is_open()) {
+    OLA_WARN << "Failed to open " << file_path << ": " << strerror(errno);
+    return false;
+  }
 
-  if (!ok)
-    return NULL;
+  ola::rdm::pid::CompiledPidStore compiled_pb;
+  bool ok = compiled_pb.ParseFromIstream(&compiled_file);
+  compiled_file.close();
 
-  ola::rdm::pid::PidStore override_pb;
-  return BuildStore(pid_store_pb, override_pb, validate);
+  if (!ok) {
+    OLA_WARN << "Failed to load " << file_path;
+    return false;
+  }
+
+  if (compiled_pb.checksum() != checksum) {
+    OLA_INFO << file_path << " is out of date, loading the text files";
+    return false;
+  }
+
+  OLA_DEBUG << "Loaded compiled PIDs from " << file_path;
+  proto->Swap(compiled_pb.mutable_store());
+  return true;
 }
 
 bool PidStoreLoader::ReadFile(const std::string &file_path,
@@ -74,6 +74,22 @@ class PidStoreLoader {
   const RootPidStore *LoadFromStream(std::istream *data,
                                      bool validate = true);
 
+  /**
+   * @brief Compile the PID files in a directory into a single binary file.
+   * @param directory the directory to load files from.
+   * @param output_file the path to write the compiled data to.
+   * @returns true if the file was written, false otherwise.
+   *
+   * The override file isn't included, so it can still be edited. If a file
+   * named COMPILED_FILE_NAME is present, LoadFromDirectory() uses it rather
+   * than parsing the text files, as long as it was compiled from the same
+   * files.
+   */
+  bool CompileDirectory(const std::string &directory,
+                        const std::string &output_file);
+
+  static const char COMPILED_FILE_NAME[];
+
  private:
   typedef std::map<uint16_t, const PidDescriptor*> PidMap;
   typedef std::map<uint16_t, PidMap*> ManufacturerMap;
@@ -83,6 +99,14 @@ class PidStoreLoader {
   bool ReadFile(const std::string &file_path,
                 ola::rdm::pid::PidStore *proto);
 
+  bool ReadDirectory(const std::string &directory,
+                     ola::rdm::pid::PidStore *proto,
+                     uint64_t *checksum,
+                     std::string *override_file);
+  bool ReadCompiledFile(const std::string &file_path,
+                        uint64_t checksum,
+                        ola::rdm::pid::PidStore *proto);
+
   const RootPidStore *BuildStore(const ola::rdm::pid::PidStore &store_pb,
                                  const ola::rdm::pid::PidStore &override_pb,
                                  bool validate);
@@ -119,6 +143,8 @@ class PidStoreLoader {
   void FreeManufacturerMap(ManufacturerMap *data);
 
   static const char OVERRIDE_FILE_NAME[];
+  static const uint64_t CHECKSUM_OFFSET;
+  static const uint64_t CHECKSUM_PRIME;
   static const uint16_t ESTA_MANUFACTURER_ID;
   static const uint16_t MANUFACTURER_PID_MIN;
   static const uint16_t MANUFACTURER_PID_MAX;
@@ -19,7 +19,11 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <errno.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -56,6 +60,7 @@ class PidStoreTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testPidStoreLoad);
   CPPUNIT_TEST(testPidStoreFileLoad);
   CPPUNIT_TEST(testPidStoreDirectoryLoad);
+  CPPUNIT_TEST(testPidStoreCompiledLoad);
   CPPUNIT_TEST(testPidStoreLoadMissingFile);
   CPPUNIT_TEST(testPidStoreLoadDuplicateManufacturer);
   CPPUNIT_TEST(testPidStoreLoadDuplicateValue);
@@ -70,6 +75,7 @@ class PidStoreTest: public CppUnit::TestFixture {
   void testPidStoreLoad();
   void testPidStoreFileLoad();
   void testPidStoreDirectoryLoad();
+  void testPidStoreCompiledLoad();
   void testPidStoreLoadMissingFile();
   void testPidStoreLoadDuplicateManufacturer();
   void testPidStoreLoadDuplicateValue();
@@ -84,6 +90,18 @@ class PidStoreTest: public CppUnit::TestFixture {
     path.append(filename);
     return path;
   }
+
+  // Copy a file from the pids test data directory to another directory.
+  void CopyTestDataFile(const string &filename, const string &directory,
+                        const string &suffix = "") {
+    std::ifstream input(GetTestDataFile("pids/" + filename).c_str());
+    OLA_ASSERT_TRUE(input.is_open());
+    std::ofstream output((directory + "/" + filename).c_str());
+    OLA_ASSERT_TRUE(output.is_open());
+    output << input.rdbuf() << suffix;
+  }
+
+  void CheckDirectoryStore(const RootPidStore *root_store);
 };
 
 
@@ -399,7 +417,57 @@ void PidStoreTest::testPidStoreDirectoryLoad() {
 
   auto_ptr<const RootPidStore> root_store(loader.LoadFromDirectory(
       GetTestDataFile("pids")));
-  OLA_ASSERT_NOT_NULL(root_store.get());
+  CheckDirectoryStore(root_store.get());
+}
+
+
+/**
+ * Check that a compiled directory is loaded, and ignored when the text files
+ * change.
+ */
+void PidStoreTest::testPidStoreCompiledLoad() {
+  const string directory = string(TEST_BUILD_DIR) +
+      "/common/rdm/compiled_pids_test";
+  if (mkdir(directory.c_str(), 0755) && errno != EEXIST) {
+    CPPUNIT_FAIL("Failed to create " + directory);
+  }
+  CopyTestDataFile("overrides.proto", directory);
+  CopyTestDataFile("pids1.proto", directory);
+  CopyTestDataFile("pids2.proto", directory);
+
+  PidStoreLoader loader;
+  const string compiled_file = directory + "/" +
+      PidStoreLoader::COMPILED_FILE_NAME;
+  OLA_ASSERT_TRUE(loader.CompileDirectory(directory, compiled_file));
+
+  auto_ptr<const RootPidStore> root_store(
+      loader.LoadFromDirectory(directory));
+  CheckDirectoryStore(root_store.get());
+
+  // Now change one of the files, the compiled version is out of date
+  CopyTestDataFile("pids2.proto", directory, "\n# changed\n");
+  root_store.reset(loader.LoadFromDirectory(directory));
+  CheckDirectoryStore(root_store.get());
+
+  // A corrupt compiled file is also ignored
+  {
+    std::ofstream output(compiled_file.c_str(), std::ios::trunc);
+    output << "corrupt";
+  }
+  root_store.reset(loader.LoadFromDirectory(directory));
+  CheckDirectoryStore(root_store.get());
+
+  // An invalid directory can't be compiled
+  OLA_ASSERT_FALSE(loader.CompileDirectory(
+      GetTestDataFile("pids_does_not_exist"), compiled_file + ".missing"));
+}
+
+
+/*
+ * Check the data loaded from the pids directory.
+ */
+void PidStoreTest::CheckDirectoryStore(const RootPidStore *root_store) {
+  OLA_ASSERT_NOT_NULL(root_store);
   // check version
   OLA_ASSERT_EQ(static_cast<uint64_t>(1302986774), root_store->Version());
 
@@ -14,11 +14,12 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  *
  * QueueingRDMController.cpp
- * The Jese DMX TRI device.
+ * A RDM Controller that limits the number of messages in flight.
  * Copyright (C) 2010 Simon Newton
  */
 
 #include <string.h>
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -43,17 +44,16 @@ using std::vector;
 
 /*
  * A new QueueingRDMController. This takes another controller as a argument,
- * and ensures that we only send one request at a time.
+ * and ensures that we only send max_in_flight requests at a time.
  */
 QueueingRDMController::QueueingRDMController(
     RDMControllerInterface *controller,
-    unsigned int max_queue_size)
+    unsigned int max_queue_size,
+    unsigned int max_in_flight)
   : m_controller(controller),
     m_max_queue_size(max_queue_size),
-    m_rdm_request_pending(false),
-    m_active(true),
-    m_callback(ola::NewCallback(this,
-                                &QueueingRDMController::HandleRDMResponse)) {
+    m_max_in_flight(max_in_flight ? max_in_flight : 1),
+    m_active(true) {
 }
 
 
@@ -62,13 +62,20 @@ QueueingRDMController::QueueingRDMController(
  */
 QueueingRDMController::~QueueingRDMController() {
   // delete all outstanding requests
+  InFlightRequests::iterator in_flight_iter = m_in_flight.begin();
+  for (; in_flight_iter != m_in_flight.end(); ++in_flight_iter) {
+    m_pending_requests.push_front((*in_flight_iter)->outstanding);
+    delete *in_flight_iter;
+  }
+  m_in_flight.clear();
+
   while (!m_pending_requests.empty()) {
     outstanding_rdm_request outstanding_request = m_pending_requests.front();
     if (outstanding_request.on_complete) {
       RunRDMCallback(outstanding_request.on_complete, RDM_FAILED_TO_SEND);
     }
     delete outstanding_request.request;
-    m_pending_requests.pop();
+    m_pending_requests.pop_front();
   }
 }
 
@@ -86,7 +93,7 @@ void QueueingRDMController::Pause() {
  */
 void QueueingRDMController::Resume() {
   m_active = true;
-  MaybeSendRDMRequest();
+  TakeNextAction();
 }
 
 
@@ -95,7 +102,7 @@ void QueueingRDMController::Resume() {
  */
 void QueueingRDMController::SendRDMRequest(RDMRequest *request,
                                            RDMCallback *on_complete) {
-  if (m_pending_requests.size() >= m_max_queue_size) {
+  if (m_pending_requests.size() + m_in_flight.size() >= m_max_queue_size) {
     OLA_WARN << "RDM Queue is full, dropping request";
     if (on_complete) {
       RunRDMCallback(on_complete, RDM_FAILED_TO_SEND);
@@ -107,7 +114,7 @@ void QueueingRDMController::SendRDMRequest(RDMRequest *request,
   outstanding_rdm_request outstanding_request;
   outstanding_request.request = request;
   outstanding_request.on_complete = on_complete;
-  m_pending_requests.push(outstanding_request);
+  m_pending_requests.push_back(outstanding_request);
   TakeNextAction();
 }
 
@@ -130,102 +137,153 @@ void QueueingRDMController::TakeNextAction() {
  * @returns true if some other action is running, false otherwise.
  */
 bool QueueingRDMController::CheckForBlockingCondition() {
-  return !m_active || m_rdm_request_pending;
+  return !m_active || m_in_flight.size() >= m_max_in_flight;
 }
 
 
 /*
- * If we're not paused, send the next request.
+ * Send the next request that doesn't conflict with those in flight.
  */
 void QueueingRDMController::MaybeSendRDMRequest() {
-  if (m_pending_requests.empty())
+  PendingRequests::iterator iter = NextSendableRequest();
+  if (iter == m_pending_requests.end())
     return;
 
-  m_rdm_request_pending = true;
-  DispatchNextRequest();
+  InFlightRequest *in_flight = new InFlightRequest(*iter);
+  m_pending_requests.erase(iter);
+  m_in_flight.push_back(in_flight);
+  DispatchRequest(in_flight);
+
+  // There may be room for another request. The underlying controller may
+  // have already run the callback, in which case this is a no-op.
+  TakeNextAction();
 }
 
 
 /*
- * Send the next RDM request.
+ * Find the first pending request that can be sent now. A request can't be
+ * sent while an earlier request to the same UID is in flight or queued, and
+ * broadcast requests are sent on their own.
  */
-void QueueingRDMController::DispatchNextRequest() {
-  outstanding_rdm_request outstanding_request = m_pending_requests.front();
+QueueingRDMController::PendingRequests::iterator
+    QueueingRDMController::NextSendableRequest() {
+  UIDSet busy_uids;
+  InFlightRequests::const_iterator in_flight_iter = m_in_flight.begin();
+  for (; in_flight_iter != m_in_flight.end(); ++in_flight_iter) {
+    const UID &uid = (*in_flight_iter)->outstanding.request->DestinationUID();
+    if (uid.IsBroadcast()) {
+      return m_pending_requests.end();
+    }
+    busy_uids.AddUID(uid);
+  }
+
+  PendingRequests::iterator iter = m_pending_requests.begin();
+  for (; iter != m_pending_requests.end(); ++iter) {
+    const UID &uid = iter->request->DestinationUID();
+    if (uid.IsBroadcast()) {
+      // Broadcasts wait for everything before them, and block everything
+      // after them.
+      if (iter == m_pending_requests.begin() && m_in_flight.empty()) {
+        return iter;
+      }
+      return m_pending_requests.end();
+    }
+    if (!busy_uids.Contains(uid)) {
+      return iter;
+    }
+    busy_uids.AddUID(uid);
+  }
+  return m_pending_requests.end();
+}
+
+
+/*
+ * Send a request to the underlying controller.
+ */
+void QueueingRDMController::DispatchRequest(InFlightRequest *in_flight) {
   // We have to make a copy here because we pass ownership of the request to
   // the underlying controller.
   // We need to have the original request because we use it if we receive an
   // ACK_OVERFLOW.
-  m_controller->SendRDMRequest(outstanding_request.request->Duplicate(),
-                               m_callback.get());
+  m_controller->SendRDMRequest(
+      in_flight->outstanding.request->Duplicate(),
+      NewSingleCallback(this, &QueueingRDMController::HandleRDMResponse,
+                        in_flight));
 }
 
 
 /*
  * Handle the response to a RemoteGet command
  */
-void QueueingRDMController::HandleRDMResponse(RDMReply *reply) {
-  m_rdm_request_pending = false;
-
-  if (m_pending_requests.empty()) {
-    OLA_FATAL << "Received a response but the queue was empty!";
-    return;
-  }
-
+void QueueingRDMController::HandleRDMResponse(InFlightRequest *in_flight,
+                                              RDMReply *reply) {
   bool was_ack_overflow = reply->StatusCode() == RDM_COMPLETED_OK &&
                           reply->Response() &&
                           reply->Response()->ResponseType() == ACK_OVERFLOW;
   // Check for ACK_OVERFLOW
-  if (m_response.get()) {
+  if (in_flight->response.get()) {
     if (reply->StatusCode() != RDM_COMPLETED_OK || reply->Response() == NULL) {
       // We failed part way through an ACK_OVERFLOW
-      m_frames.insert(m_frames.end(), reply->Frames().begin(),
-                      reply->Frames().end());
-      RDMReply new_reply(reply->StatusCode(), NULL, m_frames);
-      RunCallback(&new_reply);
-      m_response.reset();
-      m_frames.clear();
+      in_flight->frames.insert(in_flight->frames.end(),
+                               reply->Frames().begin(),
+                               reply->Frames().end());
+      RDMReply new_reply(reply->StatusCode(), NULL, in_flight->frames);
+      RunCallback(in_flight, &new_reply);
       TakeNextAction();
     } else {
       // Combine the data.
-      m_response.reset(RDMResponse::CombineResponses(
-          m_response.get(), reply->Response()));
-      m_frames.insert(m_frames.end(), reply->Frames().begin(),
-                      reply->Frames().end());
+      in_flight->response.reset(RDMResponse::CombineResponses(
+          in_flight->response.get(), reply->Response()));
+      in_flight->frames.insert(in_flight->frames.end(),
+                               reply->Frames().begin(),
+                               reply->Frames().end());
 
-      if (!m_response.get()) {
+      if (!in_flight->response.get()) {
         // The response was invalid
-        RDMReply new_reply(RDM_INVALID_RESPONSE, NULL, m_frames);
-        RunCallback(&new_reply);
-        m_frames.clear();
+        RDMReply new_reply(RDM_INVALID_RESPONSE, NULL, in_flight->frames);
+        RunCallback(in_flight, &new_reply);
         TakeNextAction();
       } else if (reply->Response()->ResponseType() != ACK_OVERFLOW) {
-        RDMReply new_reply(RDM_COMPLETED_OK, m_response.release(), m_frames);
-        RunCallback(&new_reply);
-        m_response.reset();
-        m_frames.clear();
+        RDMReply new_reply(RDM_COMPLETED_OK, in_flight->response.release(),
+                           in_flight->frames);
+        RunCallback(in_flight, &new_reply);
         TakeNextAction();
       } else {
-        DispatchNextRequest();
+        DispatchRequest(in_flight);
       }
       return;
     }
   } else if (was_ack_overflow) {
     // We're in an ACK_OVERFLOW sequence.
-    m_frames.clear();
-    m_response.reset(reply->Response()->Duplicate());
-    m_frames.insert(m_frames.end(), reply->Frames().begin(),
-                    reply->Frames().end());
-    DispatchNextRequest();
+    in_flight->frames.clear();
+    in_flight->response.reset(reply->Response()->Duplicate());
+    in_flight->frames.insert(in_flight->frames.end(),
+                             reply->Frames().begin(),
+                             reply->Frames().end());
+    DispatchRequest(in_flight);
   } else {
     // Just pass the RDMReply on.
-    RunCallback(reply);
+    RunCallback(in_flight, reply);
     TakeNextAction();
   }
 }
 
-void QueueingRDMController::RunCallback(RDMReply *reply) {
-  outstanding_rdm_request outstanding_request = m_pending_requests.front();
-  m_pending_requests.pop();
+
+/*
+ * Remove the request from the in flight list and run the callback.
+ */
+void QueueingRDMController::RunCallback(InFlightRequest *in_flight,
+                                        RDMReply *reply) {
+  InFlightRequests::iterator iter = std::find(m_in_flight.begin(),
+                                              m_in_flight.end(), in_flight);
+  if (iter == m_in_flight.end()) {
+    OLA_FATAL << "Received a response for an unknown request!";
+    return;
+  }
+  m_in_flight.erase(iter);
+
+  outstanding_rdm_request outstanding_request = in_flight->outstanding;
+  delete in_flight;
   if (outstanding_request.on_complete) {
     outstanding_request.on_complete->Run(reply);
   }
@@ -238,8 +296,9 @@ void QueueingRDMController::RunCallback(RDMReply *reply) {
  */
 DiscoverableQueueingRDMController::DiscoverableQueueingRDMController(
         DiscoverableRDMControllerInterface *controller,
-        unsigned int max_queue_size)
-    : QueueingRDMController(controller, max_queue_size),
+        unsigned int max_queue_size,
+    unsigned int max_in_flight)
+    : QueueingRDMController(controller, max_queue_size, max_in_flight),
       m_discoverable_controller(controller) {
 }
 
@@ -272,10 +331,13 @@ void DiscoverableQueueingRDMController::TakeNextAction() {
     return;
 
   // prioritize discovery above RDM requests
-  if (!m_pending_discovery_callbacks.empty())
-    StartRDMDiscovery();
-  else
+  if (!m_pending_discovery_callbacks.empty()) {
+    // Wait for the requests in flight to complete.
+    if (m_in_flight.empty())
+      StartRDMDiscovery();
+  } else {
     MaybeSendRDMRequest();
+  }
 }
 
 
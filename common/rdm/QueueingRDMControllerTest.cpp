@@ -84,6 +84,7 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testMultipleDiscovery);
   CPPUNIT_TEST(testReentrantDiscovery);
   CPPUNIT_TEST(testRequestAndDiscovery);
+  CPPUNIT_TEST(testPipelinedRequests);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -102,6 +103,7 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
   void testMultipleDiscovery();
   void testReentrantDiscovery();
   void testRequestAndDiscovery();
+  void testPipelinedRequests();
 
   void VerifyResponse(RDMReply *expected_reply, RDMReply *reply) {
     OLA_ASSERT_EQ(*expected_reply, *reply);
@@ -138,8 +140,7 @@ CPPUNIT_TEST_SUITE_REGISTRATION(QueueingRDMControllerTest);
 class MockRDMController: public ola::rdm::DiscoverableRDMControllerInterface {
  public:
     MockRDMController()
-        : m_rdm_callback(NULL),
-          m_discovery_callback(NULL) {
+        : m_discovery_callback(NULL) {
     }
 
     void SendRDMRequest(RDMRequest *request, RDMCallback *on_complete);
@@ -176,7 +177,7 @@ class MockRDMController: public ola::rdm::DiscoverableRDMControllerInterface {
 
     std::queue<expected_call> m_expected_calls;
     std::queue<expected_discovery_call> m_expected_discover_calls;
-    RDMCallback *m_rdm_callback;
+    std::queue<RDMCallback*> m_rdm_callbacks;
     RDMDiscoveryCallback *m_discovery_callback;
 };
 
@@ -193,8 +194,7 @@ void MockRDMController::SendRDMRequest(RDMRequest *request,
     on_complete->Run(call.reply);
     delete call.reply;
   } else {
-    OLA_ASSERT_FALSE(m_rdm_callback);
-    m_rdm_callback = on_complete;
+    m_rdm_callbacks.push(on_complete);
   }
 }
 
@@ -260,12 +260,12 @@ void MockRDMController::AddExpectedDiscoveryCall(bool full,
 
 
 /**
- * Run the current RDM callback
+ * Run the oldest captured RDM callback
  */
 void MockRDMController::RunRDMCallback(RDMReply *reply) {
-  OLA_ASSERT_TRUE(m_rdm_callback);
-  RDMCallback *callback = m_rdm_callback;
-  m_rdm_callback = NULL;
+  OLA_ASSERT_TRUE(m_rdm_callbacks.size());
+  RDMCallback *callback = m_rdm_callbacks.front();
+  m_rdm_callbacks.pop();
   callback->Run(reply);
 }
 
@@ -851,3 +851,81 @@ void QueueingRDMControllerTest::testRequestAndDiscovery() {
   OLA_ASSERT_TRUE(m_discovery_complete_count);
   mock_controller.Verify();
 }
+
+
+/*
+ * Check that requests to different UIDs overlap when more than one request
+ * can be in flight, and that requests to the same UID don't.
+ */
+void QueueingRDMControllerTest::testPipelinedRequests() {
+  MockRDMController mock_controller;
+  auto_ptr<ola::rdm::DiscoverableQueueingRDMController> controller(
+      new ola::rdm::DiscoverableQueueingRDMController(&mock_controller, 10,
+                                                      2));
+
+  UID other_destination(5, 6);
+  UIDSet uids;
+  uids.AddUID(m_destination);
+  uids.AddUID(other_destination);
+
+  RDMRequest *get_request1 = NewGetRequest(m_source, m_destination);
+  RDMRequest *get_request2 = NewGetRequest(m_source, m_destination);
+  RDMRequest *get_request3 = NewGetRequest(m_source, other_destination);
+  RDMReply expected_reply1(
+      ola::rdm::RDM_COMPLETED_OK,
+      NewGetResponse(m_destination, m_source));
+  RDMReply expected_reply2(
+      ola::rdm::RDM_COMPLETED_OK,
+      NewGetResponse(m_destination, m_source));
+  RDMReply expected_reply3(
+      ola::rdm::RDM_COMPLETED_OK,
+      NewGetResponse(other_destination, m_source));
+
+  // The second request to m_destination waits for the first to complete, so
+  // the request to other_destination is sent ahead of it.
+  mock_controller.ExpectCallAndCapture(get_request1);
+  mock_controller.ExpectCallAndCapture(get_request3);
+
+  controller->SendRDMRequest(
+      get_request1,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          &expected_reply1));
+  controller->SendRDMRequest(
+      get_request2,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          &expected_reply2));
+  controller->SendRDMRequest(
+      get_request3,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          &expected_reply3));
+  mock_controller.Verify();
+
+  // Discovery waits until both requests in flight complete, and the queued
+  // request waits for discovery.
+  controller->RunFullDiscovery(
+      NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyDiscoveryComplete,
+          &uids));
+  mock_controller.RunRDMCallback(&expected_reply1);
+  mock_controller.Verify();
+  OLA_ASSERT_FALSE(m_discovery_complete_count);
+
+  mock_controller.AddExpectedDiscoveryCall(true, NULL);
+  mock_controller.RunRDMCallback(&expected_reply3);
+  mock_controller.Verify();
+
+  mock_controller.ExpectCallAndCapture(get_request2);
+  mock_controller.RunDiscoveryCallback(uids);
+  OLA_ASSERT_TRUE(m_discovery_complete_count);
+  mock_controller.Verify();
+
+  mock_controller.RunRDMCallback(&expected_reply2);
+  mock_controller.Verify();
+}
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include "ola/base/Macro.h"
 #include "ola/io/BigEndianStream.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMCommandSerializer.h"
@@ -31,6 +32,10 @@ namespace rdm {
 
 using ola::utils::SplitUInt16;
 
+STATIC_ASSERT(sizeof(RDMCommandHeader) +
+              RDMCommandSerializer::MAX_PARAM_DATA_LENGTH + 2 ==
+              RDMCommandSerializer::MAX_PACKED_SIZE);
+
 unsigned int RDMCommandSerializer::RequiredSize(
     const RDMCommand &command) {
   if (command.ParamDataSize() > MAX_PARAM_DATA_LENGTH) {
@@ -99,6 +104,22 @@ bool RDMCommandSerializer::Pack(const RDMCommand &command,
   return true;
 }
 
+bool RDMCommandSerializer::PackWithStartCode(const RDMCommand &command,
+                                             uint8_t *buffer,
+                                             unsigned int *size) {
+  if (*size == 0) {
+    return false;
+  }
+
+  unsigned int packed_size = *size - 1;
+  if (!Pack(command, buffer + 1, &packed_size)) {
+    return false;
+  }
+  buffer[0] = START_CODE;
+  *size = packed_size + 1;
+  return true;
+}
+
 bool RDMCommandSerializer::Write(const RDMCommand &command,
                                  ola::io::IOStack *stack) {
   const unsigned int packet_length = RequiredSize(command);
@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
 #include <iomanip>
 #include <memory>
 #include <sstream>
@@ -257,6 +258,34 @@ void RDMCommandSerializerTest::testPackWithStartCode() {
   OLA_ASSERT_DATA_EQUALS(expected_data,
                          arraysize(expected_data),
                          output.data(), output.length());
+
+  uint8_t buffer[RDMCommandSerializer::MAX_PACKED_SIZE + 1];
+  unsigned int length = sizeof(buffer);
+  OLA_ASSERT_TRUE(
+      RDMCommandSerializer::PackWithStartCode(request, buffer, &length));
+  OLA_ASSERT_DATA_EQUALS(expected_data, arraysize(expected_data),
+                         buffer, length);
+
+  // too small
+  length = arraysize(expected_data) - 1;
+  OLA_ASSERT_FALSE(
+      RDMCommandSerializer::PackWithStartCode(request, buffer, &length));
+
+  // the largest command fills MAX_PACKED_SIZE
+  uint8_t param_data[RDMCommandSerializer::MAX_PARAM_DATA_LENGTH];
+  memset(param_data, 0xa5, sizeof(param_data));
+  RDMSetRequest large_request(m_source, m_destination, 0, 1, 10, 296,
+                              param_data, sizeof(param_data));
+  OLA_ASSERT_EQ(
+      static_cast<unsigned int>(RDMCommandSerializer::MAX_PACKED_SIZE),
+      RDMCommandSerializer::RequiredSize(large_request));
+  length = sizeof(buffer);
+  OLA_ASSERT_TRUE(
+      RDMCommandSerializer::PackWithStartCode(large_request, buffer, &length));
+  OLA_ASSERT_EQ(sizeof(buffer), static_cast<size_t>(length));
+  OLA_ASSERT_DATA_EQUALS(param_data, sizeof(param_data),
+                         buffer + 1 + sizeof(ola::rdm::RDMCommandHeader),
+                         sizeof(param_data));
 }
 
 void RDMCommandSerializerTest::testDUB() {
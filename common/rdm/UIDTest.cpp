@@ -38,6 +38,7 @@ class UIDTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testUIDInequalities);
   CPPUNIT_TEST(testUIDSet);
   CPPUNIT_TEST(testUIDSetUnion);
+  CPPUNIT_TEST(testUIDSetIntersection);
   CPPUNIT_TEST(testUIDParse);
   CPPUNIT_TEST(testDirectedToUID);
   CPPUNIT_TEST_SUITE_END();
@@ -47,6 +48,7 @@ class UIDTest: public CppUnit::TestFixture {
     void testUIDInequalities();
     void testUIDSet();
     void testUIDSetUnion();
+    void testUIDSetIntersection();
     void testUIDParse();
     void testDirectedToUID();
 };
@@ -252,6 +254,43 @@ void UIDTest::testUIDSetUnion() {
 }
 
 
+/*
+ * Test the UIDSet Intersection method, and that the set stays ordered.
+ */
+void UIDTest::testUIDSetIntersection() {
+  UIDSet set1, set2;
+
+  UID uid(1, 2);
+  UID uid2(2, 10);
+  UID uid3(3, 10);
+  UID uid4(4, 10);
+  // add out of order
+  set1.AddUID(uid3);
+  set1.AddUID(uid);
+  set1.AddUID(uid2);
+  OLA_ASSERT_EQ(string("0001:00000002,0002:0000000a,0003:0000000a"),
+                set1.ToString());
+  set2.AddUID(uid4);
+  set2.AddUID(uid2);
+  set2.AddUID(uid3);
+
+  UIDSet intersection = set1.Intersection(set2);
+  OLA_ASSERT_EQ(2u, intersection.Size());
+  OLA_ASSERT_FALSE(intersection.Contains(uid));
+  OLA_ASSERT_TRUE(intersection.Contains(uid2));
+  OLA_ASSERT_TRUE(intersection.Contains(uid3));
+  OLA_ASSERT_FALSE(intersection.Contains(uid4));
+
+  OLA_ASSERT_TRUE(set1.Intersection(UIDSet()).Empty());
+
+  // removing a UID that isn't there is a no-op
+  set1.RemoveUID(uid4);
+  OLA_ASSERT_EQ(3u, set1.Size());
+  set1.RemoveUID(uid2);
+  OLA_ASSERT_EQ(string("0001:00000002,0003:0000000a"), set1.ToString());
+}
+
+
 /*
  * Test UID parsing
  */
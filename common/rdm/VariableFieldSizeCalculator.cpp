@@ -26,6 +26,7 @@ namespace ola {
 namespace rdm {
 
 using ola::messaging::FieldDescriptorGroup;
+using ola::messaging::FlatLayout;
 using ola::messaging::StringFieldDescriptor;
 
 
@@ -35,7 +36,6 @@ using ola::messaging::StringFieldDescriptor;
  * length fields are not supported as this doesn't allow us to determine the
  * boundary of the individual fields within a message.
  *
- * This method is *not* re-entrant.
  * @param data_size the size in bytes of the data in this message
  * @param descriptor The descriptor to use to build the Message
  * @param variable_field_size a pointer to a int which is set to the length of
@@ -48,33 +48,28 @@ VariableFieldSizeCalculator::calculator_state
         unsigned int data_size,
         const class ola::messaging::Descriptor *descriptor,
         unsigned int *variable_field_size) {
-  m_fixed_size_sum = 0;
-  m_variable_string_fields.clear();
-  m_variable_group_fields.clear();
+  const FlatLayout &layout = descriptor->Layout();
+  const unsigned int fixed_size_sum = layout.FixedSize();
 
-  // split out the fields into fixed and variable length
-  for (unsigned int i = 0; i < descriptor->FieldCount(); ++i)
-    descriptor->GetField(i)->Accept(this);
-
-  if (data_size < m_fixed_size_sum)
+  if (data_size < fixed_size_sum)
     return TOO_SMALL;
 
-  unsigned int variable_string_field_count = m_variable_string_fields.size();
-  unsigned int variable_group_field_count = m_variable_group_fields.size();
+  unsigned int variable_string_field_count = layout.VariableStrings().size();
+  unsigned int variable_group_field_count = layout.VariableGroups().size();
 
   if (variable_string_field_count + variable_group_field_count > 1)
     return MULTIPLE_VARIABLE_FIELDS;
 
   if (variable_string_field_count + variable_group_field_count == 0)
-    return data_size > m_fixed_size_sum ? TOO_LARGE : FIXED_SIZE;
+    return data_size > fixed_size_sum ? TOO_LARGE : FIXED_SIZE;
 
   // we know there is only one, now we need to work out the number of
   // repeatitions or length if it's a string
-  unsigned int bytes_remaining = data_size - m_fixed_size_sum;
+  unsigned int bytes_remaining = data_size - fixed_size_sum;
   if (variable_string_field_count) {
     // variable string
     const StringFieldDescriptor *string_descriptor =
-      m_variable_string_fields[0];
+      layout.VariableStrings()[0];
 
     if (bytes_remaining < string_descriptor->MinSize())
       return TOO_SMALL;
@@ -84,7 +79,7 @@ VariableFieldSizeCalculator::calculator_state
     return VARIABLE_STRING;
   } else {
     // variable group
-    const FieldDescriptorGroup *group_descriptor = m_variable_group_fields[0];
+    const FieldDescriptorGroup *group_descriptor = layout.VariableGroups()[0];
     if (!group_descriptor->FixedBlockSize())
       return NESTED_VARIABLE_GROUPS;
 
@@ -110,83 +105,5 @@ VariableFieldSizeCalculator::calculator_state
     return VARIABLE_GROUP;
   }
 }
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::BoolFieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::IPV4FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::MACFieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::UIDFieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::StringFieldDescriptor *descriptor) {
-  if (descriptor->FixedSize())
-    m_fixed_size_sum += descriptor->MaxSize();
-  else
-    m_variable_string_fields.push_back(descriptor);
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::UInt8FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::UInt16FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::UInt32FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::Int8FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::Int16FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::Int32FieldDescriptor *descriptor) {
-  m_fixed_size_sum += descriptor->MaxSize();
-}
-
-
-void VariableFieldSizeCalculator::Visit(
-    const ola::messaging::FieldDescriptorGroup *descriptor) {
-  if (descriptor->FixedSize())
-    m_fixed_size_sum += descriptor->MaxSize();
-  else
-    m_variable_group_fields.push_back(descriptor);
-}
 }  // namespace rdm
 }  // namespace ola
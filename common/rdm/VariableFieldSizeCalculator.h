@@ -21,10 +21,6 @@
 #ifndef COMMON_RDM_VARIABLEFIELDSIZECALCULATOR_H_
 #define COMMON_RDM_VARIABLEFIELDSIZECALCULATOR_H_
 
-#include <ola/messaging/DescriptorVisitor.h>
-#include <stack>
-#include <vector>
-
 namespace ola {
 
 namespace messaging {
@@ -37,9 +33,11 @@ namespace rdm {
 /**
  * Calculate the size of a variable field when unpacking a Message from a raw
  * data stream.
+ *
+ * This uses the Descriptor's FlatLayout, so the fields aren't visited for
+ * each message.
  */
-class VariableFieldSizeCalculator
-    : public ola::messaging::FieldDescriptorVisitor {
+class VariableFieldSizeCalculator {
  public:
     typedef enum {
       TOO_SMALL,
@@ -52,38 +50,13 @@ class VariableFieldSizeCalculator
       MISMATCHED_SIZE,
     } calculator_state;
 
-    VariableFieldSizeCalculator() : m_fixed_size_sum(0) {}
+    VariableFieldSizeCalculator() {}
     ~VariableFieldSizeCalculator() {}
 
-    bool Descend() const { return false; }
     calculator_state CalculateFieldSize(
         unsigned int data_size,
         const class ola::messaging::Descriptor*,
         unsigned int *variable_field_repeat_count);
-
-    void Visit(const ola::messaging::BoolFieldDescriptor*);
-    void Visit(const ola::messaging::IPV4FieldDescriptor*);
-    void Visit(const ola::messaging::MACFieldDescriptor*);
-    void Visit(const ola::messaging::UIDFieldDescriptor*);
-    void Visit(const ola::messaging::StringFieldDescriptor*);
-    void Visit(const ola::messaging::UInt8FieldDescriptor*);
-    void Visit(const ola::messaging::UInt16FieldDescriptor*);
-    void Visit(const ola::messaging::UInt32FieldDescriptor*);
-    void Visit(const ola::messaging::Int8FieldDescriptor*);
-    void Visit(const ola::messaging::Int16FieldDescriptor*);
-    void Visit(const ola::messaging::Int32FieldDescriptor*);
-    void Visit(const ola::messaging::FieldDescriptorGroup*);
-    void PostVisit(const ola::messaging::FieldDescriptorGroup*) {}
-
- private:
-    unsigned int m_fixed_size_sum;
-    std::vector<const ola::messaging::StringFieldDescriptor*>
-        m_variable_string_fields;
-    std::vector<const ola::messaging::FieldDescriptorGroup*>
-        m_variable_group_fields;
-
-    unsigned int DetermineGroupSize(const
-        ola::messaging::FieldDescriptorGroup*);
 };
 }  // namespace rdm
 }  // namespace ola
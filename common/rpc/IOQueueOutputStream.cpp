@@ -0,0 +1,81 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOQueueOutputStream.cpp
+ * A protobuf ZeroCopyOutputStream which writes to an IOQueue.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/rpc/IOQueueOutputStream.h"
+
+namespace ola {
+namespace rpc {
+
+using ola::io::IOQueue;
+using ola::io::MemoryBlock;
+using ola::io::MemoryBlockPool;
+
+IOQueueOutputStream::IOQueueOutputStream(IOQueue *queue,
+                                         MemoryBlockPool *pool)
+    : m_queue(queue),
+      m_pool(pool),
+      m_block(NULL),
+      m_byte_count(0) {
+}
+
+IOQueueOutputStream::~IOQueueOutputStream() {
+  AppendCurrentBlock();
+}
+
+bool IOQueueOutputStream::Next(void **data, int *size) {
+  if (m_block && !m_block->Remaining()) {
+    AppendCurrentBlock();
+  }
+
+  if (!m_block) {
+    m_block = m_pool->Allocate();
+    if (!m_block) {
+      return false;
+    }
+  }
+
+  // Hand out all the free space in the block, BackUp() returns what isn't
+  // used.
+  *data = m_block->FreeSpace();
+  *size = static_cast<int>(m_block->Extend(m_block->Remaining()));
+  m_byte_count += *size;
+  return true;
+}
+
+void IOQueueOutputStream::BackUp(int count) {
+  if (m_block && count > 0) {
+    m_byte_count -= m_block->PopBack(static_cast<unsigned int>(count));
+  }
+}
+
+void IOQueueOutputStream::AppendCurrentBlock() {
+  if (!m_block) {
+    return;
+  }
+
+  if (m_block->Empty()) {
+    m_pool->Release(m_block);
+  } else {
+    m_queue->AppendBlock(m_block);
+  }
+  m_block = NULL;
+}
+}  // namespace rpc
+}  // namespace ola
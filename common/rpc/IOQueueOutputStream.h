@@ -0,0 +1,78 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOQueueOutputStream.h
+ * A protobuf ZeroCopyOutputStream which writes to an IOQueue.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_RPC_IOQUEUEOUTPUTSTREAM_H_
+#define COMMON_RPC_IOQUEUEOUTPUTSTREAM_H_
+
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <stdint.h>
+#include <ola/base/Macro.h>
+#include <ola/io/IOQueue.h>
+#include <ola/io/MemoryBlock.h>
+#include <ola/io/MemoryBlockPool.h>
+
+namespace ola {
+namespace rpc {
+
+/**
+ * @brief A ZeroCopyOutputStream that serializes into MemoryBlocks.
+ *
+ * This lets protobuf messages be serialized directly into the blocks which
+ * are later passed to writev(), rather than into a string which is then
+ * copied.
+ *
+ * Blocks are taken from the pool and appended to the IOQueue as they fill.
+ * The last block is appended when the stream is destroyed, so the queue
+ * shouldn't be used until then.
+ */
+class IOQueueOutputStream
+    : public google::protobuf::io::ZeroCopyOutputStream {
+ public:
+  /**
+   * @brief Create a new IOQueueOutputStream.
+   * @param queue the IOQueue to append to.
+   * @param pool the MemoryBlockPool to allocate blocks from. This must be the
+   *   pool used by the queue.
+   */
+  IOQueueOutputStream(ola::io::IOQueue *queue,
+                      ola::io::MemoryBlockPool *pool);
+
+  /**
+   * @brief Destructor, this appends any remaining data to the queue.
+   */
+  ~IOQueueOutputStream();
+
+  bool Next(void **data, int *size);
+  void BackUp(int count);
+  int64_t ByteCount() const { return m_byte_count; }
+
+ private:
+  ola::io::IOQueue *m_queue;
+  ola::io::MemoryBlockPool *m_pool;
+  ola::io::MemoryBlock *m_block;
+  int64_t m_byte_count;
+
+  void AppendCurrentBlock();
+
+  DISALLOW_COPY_AND_ASSIGN(IOQueueOutputStream);
+};
+}  // namespace rpc
+}  // namespace ola
+#endif  // COMMON_RPC_IOQUEUEOUTPUTSTREAM_H_
@@ -0,0 +1,126 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOQueueOutputStreamTest.cpp
+ * Test fixture for the IOQueueOutputStream class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <string.h>
+#include <string>
+
+#include "common/rpc/IOQueueOutputStream.h"
+#include "common/rpc/TestService.pb.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/MemoryBlockPool.h"
+#include "ola/testing/TestUtils.h"
+
+using google::protobuf::io::CodedOutputStream;
+using ola::io::IOQueue;
+using ola::io::MemoryBlockPool;
+using ola::rpc::EchoRequest;
+using ola::rpc::IOQueueOutputStream;
+using std::string;
+
+class IOQueueOutputStreamTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(IOQueueOutputStreamTest);
+  CPPUNIT_TEST(testNextAndBackUp);
+  CPPUNIT_TEST(testSerialize);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testNextAndBackUp();
+  void testSerialize();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IOQueueOutputStreamTest);
+
+/*
+ * Check that Next() and BackUp() update the queue.
+ */
+void IOQueueOutputStreamTest::testNextAndBackUp() {
+  MemoryBlockPool pool(16);
+  IOQueue queue(&pool);
+
+  {
+    IOQueueOutputStream stream(&queue, &pool);
+    void *data;
+    int size;
+    OLA_ASSERT_TRUE(stream.Next(&data, &size));
+    OLA_ASSERT_EQ(16, size);
+    memset(data, 'a', size);
+    OLA_ASSERT_EQ(static_cast<int64_t>(16), stream.ByteCount());
+
+    OLA_ASSERT_TRUE(stream.Next(&data, &size));
+    OLA_ASSERT_EQ(16, size);
+    memset(data, 'b', 4);
+    stream.BackUp(12);
+    OLA_ASSERT_EQ(static_cast<int64_t>(20), stream.ByteCount());
+
+    // Blocks are only added to the queue once they're full.
+    OLA_ASSERT_EQ(16u, queue.Size());
+  }
+
+  OLA_ASSERT_EQ(20u, queue.Size());
+  OLA_ASSERT_EQ(2u, pool.BlocksAllocated());
+  string output;
+  queue.Read(&output, queue.Size());
+  OLA_ASSERT_EQ(string(16, 'a') + string(4, 'b'), output);
+
+  // An unused block is returned to the pool.
+  {
+    IOQueueOutputStream stream(&queue, &pool);
+    void *data;
+    int size;
+    OLA_ASSERT_TRUE(stream.Next(&data, &size));
+    stream.BackUp(size);
+  }
+  OLA_ASSERT_EQ(0u, queue.Size());
+  OLA_ASSERT_EQ(2u, pool.FreeBlocks());
+}
+
+/*
+ * Check a message serialized to the queue parses correctly.
+ */
+void IOQueueOutputStreamTest::testSerialize() {
+  MemoryBlockPool pool(64);
+  IOQueue queue(&pool);
+
+  EchoRequest request;
+  request.set_data(string(1000, 'x'));
+  request.set_session_ptr(42);
+
+  {
+    IOQueueOutputStream stream(&queue, &pool);
+    CodedOutputStream output(&stream);
+    OLA_ASSERT_TRUE(request.SerializeToCodedStream(&output));
+  }
+
+  string serialized;
+  request.SerializeToString(&serialized);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(serialized.size()), queue.Size());
+
+  string output;
+  queue.Read(&output, queue.Size());
+  OLA_ASSERT_EQ(serialized, output);
+
+  EchoRequest parsed;
+  OLA_ASSERT_TRUE(parsed.ParseFromString(output));
+  OLA_ASSERT_EQ(request.data(), parsed.data());
+  OLA_ASSERT_EQ(static_cast<int64_t>(42), parsed.session_ptr());
+}
@@ -9,6 +9,12 @@ built_sources += \
 # LIBRARIES
 ##################################################
 common_libolacommon_la_SOURCES += \
+    common/rpc/IOQueueOutputStream.cpp \
+    common/rpc/IOQueueOutputStream.h \
+    common/rpc/MessagePool.cpp \
+    common/rpc/MessagePool.h \
+    common/rpc/RpcMethodStats.cpp \
+    common/rpc/RpcMethodStats.h \
     common/rpc/RpcChannel.cpp \
     common/rpc/RpcChannel.h \
     common/rpc/RpcSession.h \
@@ -44,9 +50,12 @@ common_rpc_TEST_SOURCES = \
     common/rpc/TestService.cpp
 
 common_rpc_RpcTester_SOURCES = \
+    common/rpc/IOQueueOutputStreamTest.cpp \
+    common/rpc/MessagePoolTest.cpp \
     common/rpc/RpcControllerTest.cpp \
     common/rpc/RpcChannelTest.cpp \
     common/rpc/RpcHeaderTest.cpp \
+    common/rpc/RpcMethodStatsTest.cpp \
     $(common_rpc_TEST_SOURCES)
 nodist_common_rpc_RpcTester_SOURCES = \
     common/rpc/TestService.pb.cc \
@@ -66,3 +75,16 @@ nodist_common_rpc_RpcServerTester_SOURCES = \
 common_rpc_RpcServerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS_ONLY_WARNINGS)
 common_rpc_RpcServerTester_LDADD = $(COMMON_TESTING_LIBS) \
                                    $(libprotobuf_LIBS)
+
+# BENCHMARKS
+##################################################
+benchmark_programs += common/rpc/RpcChannelBenchmark
+
+common_rpc_RpcChannelBenchmark_SOURCES = common/rpc/RpcChannelBenchmark.cpp
+nodist_common_rpc_RpcChannelBenchmark_SOURCES = \
+    common/rpc/TestService.pb.cc \
+    common/rpc/TestServiceService.pb.cpp
+# required, otherwise we get build errors
+common_rpc_RpcChannelBenchmark_CXXFLAGS = $(COMMON_CXXFLAGS_ONLY_WARNINGS)
+common_rpc_RpcChannelBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS) \
+                                       $(libprotobuf_LIBS)
@@ -0,0 +1,77 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessagePool.cpp
+ * Reuses protobuf messages between RPCs.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/rpc/MessagePool.h"
+
+#include <google/protobuf/message.h>
+
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+namespace rpc {
+
+using google::protobuf::Message;
+
+MessagePool::MessagePool(unsigned int max_free)
+    : m_max_free(max_free) {
+}
+
+MessagePool::~MessagePool() {
+  FreeMessageMap::iterator iter = m_free_messages.begin();
+  for (; iter != m_free_messages.end(); ++iter) {
+    STLDeleteElements(&iter->second);
+  }
+}
+
+Message *MessagePool::Allocate(const Message &prototype) {
+  FreeMessageMap::iterator iter = m_free_messages.find(
+      prototype.GetDescriptor());
+  if (iter == m_free_messages.end() || iter->second.empty()) {
+    return prototype.New();
+  }
+  Message *message = iter->second.back();
+  iter->second.pop_back();
+  return message;
+}
+
+void MessagePool::Release(Message *message) {
+  if (!message) {
+    return;
+  }
+
+  MessageList &free_messages = m_free_messages[message->GetDescriptor()];
+  if (free_messages.size() >= m_max_free) {
+    delete message;
+    return;
+  }
+  message->Clear();
+  free_messages.push_back(message);
+}
+
+unsigned int MessagePool::FreeMessages() const {
+  unsigned int count = 0;
+  FreeMessageMap::const_iterator iter = m_free_messages.begin();
+  for (; iter != m_free_messages.end(); ++iter) {
+    count += iter->second.size();
+  }
+  return count;
+}
+}  // namespace rpc
+}  // namespace ola
@@ -0,0 +1,91 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessagePool.h
+ * Reuses protobuf messages between RPCs.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_RPC_MESSAGEPOOL_H_
+#define COMMON_RPC_MESSAGEPOOL_H_
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <ola/base/Macro.h>
+#include <map>
+#include <vector>
+
+namespace ola {
+namespace rpc {
+
+/**
+ * @brief A cache of free protobuf messages, by message type.
+ *
+ * Messages are cleared when they're released, which keeps the memory
+ * protobuf allocated for string and repeated fields. A message taken from
+ * the pool can then be parsed into without going to the heap, as long as
+ * the new contents are no larger than the old.
+ *
+ * This isn't thread safe, each RpcChannel has its own pool.
+ */
+class MessagePool {
+ public:
+  /**
+   * @brief Create a new MessagePool.
+   * @param max_free the maximum number of free messages to keep for each
+   *   type.
+   */
+  explicit MessagePool(unsigned int max_free = DEFAULT_MAX_FREE_MESSAGES);
+
+  /**
+   * @brief Destructor, this deletes all free messages.
+   */
+  ~MessagePool();
+
+  /**
+   * @brief Get an empty message.
+   * @param prototype the prototype for the type of message.
+   * @returns a new or reused message, which should be returned with
+   *   Release().
+   */
+  google::protobuf::Message *Allocate(
+      const google::protobuf::Message &prototype);
+
+  /**
+   * @brief Return a message to the pool.
+   * @param message the message, ownership is transferred. May be NULL.
+   */
+  void Release(google::protobuf::Message *message);
+
+  /**
+   * @brief The number of free messages of all types.
+   */
+  unsigned int FreeMessages() const;
+
+  static const unsigned int DEFAULT_MAX_FREE_MESSAGES = 4;
+
+ private:
+  typedef std::vector<google::protobuf::Message*> MessageList;
+  typedef std::map<const google::protobuf::Descriptor*, MessageList>
+      FreeMessageMap;
+
+  const unsigned int m_max_free;
+  FreeMessageMap m_free_messages;
+
+  DISALLOW_COPY_AND_ASSIGN(MessagePool);
+};
+}  // namespace rpc
+}  // namespace ola
+#endif  // COMMON_RPC_MESSAGEPOOL_H_
@@ -0,0 +1,84 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MessagePoolTest.cpp
+ * Test fixture for the MessagePool class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "common/rpc/MessagePool.h"
+#include "common/rpc/Rpc.pb.h"
+#include "ola/testing/TestUtils.h"
+
+using google::protobuf::Message;
+using ola::rpc::MessagePool;
+using ola::rpc::RpcMessage;
+using std::string;
+
+class MessagePoolTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MessagePoolTest);
+  CPPUNIT_TEST(testReuse);
+  CPPUNIT_TEST(testMaxFree);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testReuse();
+    void testMaxFree();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MessagePoolTest);
+
+/*
+ * Check released messages are cleared and reused.
+ */
+void MessagePoolTest::testReuse() {
+  MessagePool pool;
+  OLA_ASSERT_EQ(0u, pool.FreeMessages());
+
+  RpcMessage *message = dynamic_cast<RpcMessage*>(
+      pool.Allocate(RpcMessage::default_instance()));
+  OLA_ASSERT_NOT_NULL(message);
+  message->set_type(ola::rpc::REQUEST);
+  message->set_buffer(string(100, 'x'));
+  pool.Release(message);
+  OLA_ASSERT_EQ(1u, pool.FreeMessages());
+  pool.Release(NULL);
+  OLA_ASSERT_EQ(1u, pool.FreeMessages());
+
+  Message *reused = pool.Allocate(RpcMessage::default_instance());
+  OLA_ASSERT_EQ(static_cast<Message*>(message), reused);
+  OLA_ASSERT_FALSE(message->has_type());
+  OLA_ASSERT_FALSE(message->has_buffer());
+  OLA_ASSERT_EQ(0u, pool.FreeMessages());
+  pool.Release(reused);
+}
+
+/*
+ * Check only max_free messages of each type are kept.
+ */
+void MessagePoolTest::testMaxFree() {
+  MessagePool pool(2);
+  Message *messages[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    messages[i] = pool.Allocate(RpcMessage::default_instance());
+  }
+  for (unsigned int i = 0; i < 3; i++) {
+    pool.Release(messages[i]);
+  }
+  OLA_ASSERT_EQ(2u, pool.FreeMessages());
+}
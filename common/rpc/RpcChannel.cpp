@@ -21,12 +21,16 @@
 #include "common/rpc/RpcChannel.h"
 
 #include <errno.h>
+#include <string.h>
 #include <google/protobuf/service.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 #include <string>
 
+#include "common/rpc/IOQueueOutputStream.h"
 #include "common/rpc/Rpc.pb.h"
 #include "common/rpc/RpcSession.h"
 #include "common/rpc/RpcController.h"
@@ -35,6 +39,7 @@
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
+#include "ola/io/SharedMemoryBlockPool.h"
 #include "ola/stl/STLUtils.h"
 
 namespace ola {
@@ -43,6 +48,8 @@ namespace rpc {
 using google::protobuf::Message;
 using google::protobuf::MethodDescriptor;
 using google::protobuf::ServiceDescriptor;
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedOutputStream;
 using std::auto_ptr;
 using std::string;
 
@@ -58,6 +65,17 @@ const char *RpcChannel::K_RPC_VARIABLES[] = {
   K_RPC_SENT_VAR,
 };
 
+namespace {
+
+unsigned int MessageSize(const Message &message) {
+#if GOOGLE_PROTOBUF_VERSION >= 3001000
+  return static_cast<unsigned int>(message.ByteSizeLong());
+#else
+  return message.ByteSize();
+#endif  // GOOGLE_PROTOBUF_VERSION >= 3001000
+}
+}  // namespace
+
 class OutstandingRequest {
   /*
    * These are requests on the server end that haven't completed yet.
@@ -65,10 +83,14 @@ class OutstandingRequest {
  public:
   OutstandingRequest(int id,
                      RpcSession *session,
-                     google::protobuf::Message *response)
+                     google::protobuf::Message *response,
+                     const MethodDescriptor *method,
+                     const TimeStamp &start)
       : id(id),
         controller(new RpcController(session)),
-        response(response) {
+        response(response),
+        method(method),
+        start(start) {
   }
   ~OutstandingRequest() {
     if (controller) {
@@ -82,6 +104,8 @@ class OutstandingRequest {
   int id;
   RpcController *controller;
   google::protobuf::Message *response;
+  const MethodDescriptor *method;
+  const TimeStamp start;
 };
 
 
@@ -115,8 +139,13 @@ RpcChannel::RpcChannel(
       m_descriptor(descriptor),
       m_buffer(NULL),
       m_buffer_size(0),
-      m_expected_size(0),
       m_current_size(0),
+      m_ss(NULL),
+      m_block_pool(ola::io::SharedMemoryBlockPool::PacketPool()),
+      m_output(m_block_pool),
+      m_incoming(new RpcMessage()),
+      m_method_stats(export_map),
+      m_write_registered(false),
       m_export_map(export_map),
       m_recv_type_map(NULL) {
   if (descriptor) {
@@ -136,66 +165,103 @@ RpcChannel::RpcChannel(
 }
 
 RpcChannel::~RpcChannel() {
+  StopWriting();
+  if (m_ss && m_descriptor) {
+    m_descriptor->SetOnWritable(NULL);
+  }
   free(m_buffer);
 }
 
+void RpcChannel::SetSelectServer(ola::io::SelectServerInterface *ss) {
+  m_ss = ss;
+  if (m_ss && m_descriptor) {
+    m_descriptor->SetOnWritable(
+        ola::NewCallback(this, &RpcChannel::DescriptorWritable));
+  }
+}
+
+/*
+ * Read as much as is available and dispatch every complete message.
+ *
+ * Clients streaming DMX can queue many messages between calls, so rather
+ * than reading the header and body of each message separately, we read ahead
+ * into m_buffer and work through everything that's there.
+ */
 void RpcChannel::DescriptorReady() {
-  if (!m_expected_size) {
-    // this is a new msg
-    unsigned int version;
-    if (ReadHeader(&version, &m_expected_size) < 0)
-      return;
+  if (!m_descriptor) {
+    return;
+  }
 
-    if (!m_expected_size)
-      return;
+  if (!ReserveBuffer(m_current_size + INITIAL_BUFFER_SIZE)) {
+    OLA_WARN << "Failed to grow the RPC receive buffer, closing";
+    m_descriptor->Close();
+    return;
+  }
+
+  unsigned int data_read;
+  if (m_descriptor->Receive(m_buffer + m_current_size,
+                            m_buffer_size - m_current_size,
+                            data_read) < 0) {
+    OLA_WARN << "something went wrong in descriptor recv\n";
+    return;
+  }
+  m_current_size += data_read;
+
+  unsigned int offset = 0;
+  while (m_descriptor && m_current_size - offset >= sizeof(uint32_t)) {
+    uint32_t header;
+    unsigned int version, size;
+    memcpy(&header, m_buffer + offset, sizeof(header));
+    RpcHeader::DecodeHeader(header, &version, &size);
 
     if (version != PROTOCOL_VERSION) {
+      // the framing is lost at this point, there's no way to recover.
       OLA_WARN << "protocol mismatch " << version << " != " <<
-        PROTOCOL_VERSION;
+        PROTOCOL_VERSION << ", closing channel";
+      m_descriptor->Close();
+      m_current_size = 0;
       return;
     }
 
-    if (m_expected_size > MAX_BUFFER_SIZE) {
-      OLA_WARN << "Incoming message size " << m_expected_size
+    if (size > MAX_BUFFER_SIZE) {
+      OLA_WARN << "Incoming message size " << size
                 << " is larger than MAX_BUFFER_SIZE: " << MAX_BUFFER_SIZE;
       m_descriptor->Close();
+      m_current_size = 0;
       return;
     }
 
-    m_current_size = 0;
-    m_buffer_size = AllocateMsgBuffer(m_expected_size);
-
-    if (m_buffer_size < m_expected_size) {
-      OLA_WARN << "buffer size to small " << m_buffer_size << " < " <<
-        m_expected_size;
-      return;
+    unsigned int total_size = sizeof(header) + size;
+    if (m_current_size - offset < total_size) {
+      // Make sure the rest of the message fits, so the next read can
+      // complete it.
+      if (!ReserveBuffer(total_size)) {
+        OLA_WARN << "buffer size to small " << m_buffer_size << " < " <<
+          total_size;
+        m_descriptor->Close();
+        m_current_size = 0;
+        return;
+      }
+      break;
     }
-  }
 
-  if (!m_descriptor) {
-    return;
-  }
-
-  unsigned int data_read;
-  if (m_descriptor->Receive(m_buffer + m_current_size,
-                            m_expected_size - m_current_size,
-                            data_read) < 0) {
-    OLA_WARN << "something went wrong in descriptor recv\n";
-    return;
-  }
-
-  m_current_size += data_read;
-
-  if (m_current_size == m_expected_size) {
-    // we've got all of this message so parse it.
-    if (!HandleNewMsg(m_buffer, m_expected_size)) {
+    if (size && !HandleNewMsg(m_buffer + offset + sizeof(header), size)) {
       // this probably means we've messed the framing up, close the channel
       OLA_WARN << "Errors detected on RPC channel, closing";
-      m_descriptor->Close();
+      if (m_descriptor) {
+        m_descriptor->Close();
+      }
+      m_current_size = 0;
+      return;
     }
-    m_expected_size = 0;
+    offset += total_size;
+  }
+
+  // Move any partial message to the front of the buffer.
+  if (offset) {
+    m_current_size -= offset;
+    memmove(m_buffer, m_buffer + offset, m_current_size);
   }
-  return;
 }
 
 void RpcChannel::SetChannelCloseHandler(CloseCallback *callback) {
@@ -207,8 +273,6 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
                             const Message *request,
                             Message *reply,
                             SingleUseCallback0<void> *done) {
-  // TODO(simonn): reduce the number of copies here
-  string output;
   RpcMessage message;
   bool is_streaming = false;
 
@@ -227,9 +291,7 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
   message.set_id(m_sequence.Next());
   message.set_name(method->name());
 
-  request->SerializeToString(&output);
-  message.set_buffer(output);
-  bool r = SendMsg(&message);
+  bool r = SendMsg(&message, request);
 
   if (is_streaming)
     return;
@@ -257,7 +319,6 @@ void RpcChannel::CallMethod(const MethodDescriptor *method,
 }
 
 void RpcChannel::RequestComplete(OutstandingRequest *request) {
-  string output;
   RpcMessage message;
 
   if (request->controller->Failed()) {
@@ -267,9 +328,10 @@ void RpcChannel::RequestComplete(OutstandingRequest *request) {
 
   message.set_type(RESPONSE);
   message.set_id(request->id);
-  request->response->SerializeToString(&output);
-  message.set_buffer(output);
-  SendMsg(&message);
+  SendMsg(&message, request->response);
+  // SendMsg() computed the size of the response.
+  m_method_stats.CallCompleted(request->method, request->start,
+                               request->response->GetCachedSize());
   DeleteOutstandingRequest(request);
 }
 
@@ -282,42 +344,59 @@ RpcSession *RpcChannel::Session() {
 
 /*
  * Write an RpcMessage to the write descriptor.
+ * @param msg the RpcMessage to send.
+ * @param payload if not NULL, the message to send as the buffer field of msg.
+ *
+ * The message is serialized straight into the output queue, the payload is
+ * encoded as the buffer field rather than being serialized to a string
+ * first.
  */
-bool RpcChannel::SendMsg(RpcMessage *msg) {
+bool RpcChannel::SendMsg(RpcMessage *msg, const Message *payload) {
   if (!(m_descriptor && m_descriptor->ValidReadDescriptor())) {
     OLA_WARN << "RPC descriptor closed, not sending messages";
     return false;
   }
 
-  uint32_t header;
-  // reserve the first 4 bytes for the header
-  string output(sizeof(header), 0);
-  msg->AppendToString(&output);
-  int length = output.size();
-
-  RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION,
-                                length - sizeof(header));
-  output.replace(
-      0, sizeof(header),
-      reinterpret_cast<const char*>(&header), sizeof(header));
-
-  ssize_t ret = m_descriptor->Send(
-      reinterpret_cast<const uint8_t*>(output.data()), length);
-
-  if (ret != length) {
-    OLA_WARN << "Failed to send full RPC message, closing channel";
-
-    if (m_export_map) {
-      (*m_export_map->GetCounterVar(K_RPC_SENT_ERROR_VAR))++;
+  if (m_output.Size() > MAX_BUFFER_SIZE) {
+    OLA_WARN << "RPC output buffer exceeded " << MAX_BUFFER_SIZE
+             << " bytes, closing channel";
+    return SendFailed();
+  }
+
+  const uint32_t buffer_tag = WireFormatLite::MakeTag(
+      RpcMessage::kBufferFieldNumber,
+      WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+
+  unsigned int payload_size = 0;
+  unsigned int size = MessageSize(*msg);
+  if (payload) {
+    payload_size = MessageSize(*payload);
+    size += CodedOutputStream::VarintSize32(buffer_tag) +
+            CodedOutputStream::VarintSize32(payload_size) + payload_size;
+  }
+
+  bool serialized;
+  {
+    IOQueueOutputStream stream(&m_output, m_block_pool);
+    CodedOutputStream output(&stream);
+    uint32_t header;
+    RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION, size);
+    output.WriteRaw(&header, sizeof(header));
+    msg->SerializeWithCachedSizes(&output);
+    if (payload) {
+      output.WriteTag(buffer_tag);
+      output.WriteVarint32(payload_size);
+      payload->SerializeWithCachedSizes(&output);
     }
+    serialized = !output.HadError();
+  }
 
-    // At this point there is no point using the descriptor since framing has
-    // probably been messed up.
-    // TODO(simon): consider if it's worth leaving the descriptor open for
-    // reading.
-    m_descriptor = NULL;
+  if (!serialized) {
+    OLA_WARN << "Failed to serialize RPC message, closing channel";
+    return SendFailed();
+  }
 
-    HandleChannelClose();
+  if (!FlushOutput()) {
     return false;
   }
 
@@ -327,59 +406,95 @@ bool RpcChannel::SendMsg(RpcMessage *msg) {
   return true;
 }
 
-
 /*
- * Allocate an incoming message buffer
- * @param size the size of the new buffer to allocate
- * @returns the size of the new buffer
+ * Write as much of the queued output as the descriptor will take. If we have
+ * a SelectServer the rest is written once the descriptor is writable.
+ * @returns false if the channel was closed.
  */
-int RpcChannel::AllocateMsgBuffer(unsigned int size) {
-  unsigned int requested_size = size;
-  uint8_t *new_buffer;
-
-  if (size < m_buffer_size)
-    return size;
+bool RpcChannel::FlushOutput() {
+  ssize_t ret = m_descriptor->Send(&m_output);
+  if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    OLA_WARN << "Failed to send RPC message, closing channel";
+    return SendFailed();
+  }
 
-  if (m_buffer_size == 0 && size < INITIAL_BUFFER_SIZE)
-    requested_size = INITIAL_BUFFER_SIZE;
+  if (m_output.Empty()) {
+    StopWriting();
+    return true;
+  }
 
-  if (requested_size > MAX_BUFFER_SIZE) {
-    OLA_WARN << "Incoming message size " << requested_size
-              << " is larger than MAX_BUFFER_SIZE: " << MAX_BUFFER_SIZE;
-    return m_buffer_size;
+  if (!m_ss) {
+    OLA_WARN << "Failed to send full RPC message, closing channel";
+    return SendFailed();
   }
 
-  new_buffer = static_cast<uint8_t*>(realloc(m_buffer, requested_size));
-  if (!new_buffer)
-    return m_buffer_size;
+  if (!m_write_registered) {
+    m_write_registered = m_ss->AddWriteDescriptor(m_descriptor);
+  }
+  return true;
+}
 
-  m_buffer = new_buffer;
-  m_buffer_size = requested_size;
-  return requested_size;
+void RpcChannel::DescriptorWritable() {
+  if (m_descriptor) {
+    FlushOutput();
+  }
 }
 
+void RpcChannel::StopWriting() {
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_descriptor);
+    m_write_registered = false;
+  }
+}
 
 /*
- * Read 4 bytes and decode the header fields.
- * @returns: -1 if there is no data is available, version and size are 0
+ * Called when a message couldn't be sent, this closes the channel.
+ * @returns false.
  */
-int RpcChannel::ReadHeader(unsigned int *version,
-                                 unsigned int *size) const {
-  uint32_t header;
-  unsigned int data_read = 0;
-  *version = *size = 0;
+bool RpcChannel::SendFailed() {
+  if (m_export_map) {
+    (*m_export_map->GetCounterVar(K_RPC_SENT_ERROR_VAR))++;
+  }
 
-  if (m_descriptor->Receive(reinterpret_cast<uint8_t*>(&header),
-                            sizeof(header), data_read)) {
-    OLA_WARN << "read header error: " << strerror(errno);
-    return -1;
+  // At this point there is no point using the descriptor since framing has
+  // probably been messed up.
+  // TODO(simon): consider if it's worth leaving the descriptor open for
+  // reading.
+  StopWriting();
+  if (m_ss) {
+    m_descriptor->SetOnWritable(NULL);
   }
+  m_output.Clear();
+  m_descriptor = NULL;
+
+  HandleChannelClose();
+  return false;
+}
 
-  if (!data_read)
-    return 0;
 
-  RpcHeader::DecodeHeader(header, version, size);
-  return 0;
+/*
+ * Make sure the incoming message buffer can hold size bytes. Any data already
+ * in the buffer is preserved.
+ * @param size the number of bytes required.
+ * @returns true if the buffer is large enough, false otherwise.
+ */
+bool RpcChannel::ReserveBuffer(unsigned int size) {
+  if (size <= m_buffer_size)
+    return true;
+
+  unsigned int requested_size = m_buffer_size ? m_buffer_size :
+      INITIAL_BUFFER_SIZE;
+  while (requested_size < size)
+    requested_size *= 2;
+
+  uint8_t *new_buffer = static_cast<uint8_t*>(
+      realloc(m_buffer, requested_size));
+  if (!new_buffer)
+    return false;
+
+  m_buffer = new_buffer;
+  m_buffer_size = requested_size;
+  return true;
 }
 
 
@@ -387,7 +502,8 @@ int RpcChannel::ReadHeader(unsigned int *version,
  * Parse a new message and handle it.
  */
 bool RpcChannel::HandleNewMsg(uint8_t *data, unsigned int size) {
-  RpcMessage msg;
+  // Reusing the message keeps the memory for the name and buffer fields.
+  RpcMessage &msg = *m_incoming;
   if (!msg.ParseFromArray(data, size)) {
     OLA_WARN << "Failed to parse RPC";
     return false;
@@ -456,21 +572,29 @@ void RpcChannel::HandleRequest(RpcMessage *msg) {
     return;
   }
 
-  Message* request_pb = m_service->GetRequestPrototype(method).New();
-  Message* response_pb = m_service->GetResponsePrototype(method).New();
+  Message* request_pb = m_message_pool.Allocate(
+      m_service->GetRequestPrototype(method));
+  Message* response_pb = m_message_pool.Allocate(
+      m_service->GetResponsePrototype(method));
 
   if (!request_pb || !response_pb) {
     OLA_WARN << "failed to get request or response objects";
+    m_message_pool.Release(request_pb);
+    m_message_pool.Release(response_pb);
     return;
   }
 
   if (!request_pb->ParseFromString(msg->buffer())) {
     OLA_WARN << "parsing of request pb failed";
+    m_message_pool.Release(request_pb);
+    m_message_pool.Release(response_pb);
     return;
   }
 
+  const TimeStamp start = m_method_stats.Now();
+  m_method_stats.CallStarted(method, msg->buffer().size());
   OutstandingRequest *request = new OutstandingRequest(
-      msg->id(), m_session.get(), response_pb);
+      msg->id(), m_session.get(), response_pb, method, start);
 
   if (m_requests.find(msg->id()) != m_requests.end()) {
     OLA_WARN << "dup sequence number for request " << msg->id();
@@ -482,7 +606,8 @@ void RpcChannel::HandleRequest(RpcMessage *msg) {
       this, &RpcChannel::RequestComplete, request);
   m_service->CallMethod(method, request->controller, request_pb, response_pb,
                         callback);
-  delete request_pb;
+  m_method_stats.HandlerDone(method, start);
+  m_message_pool.Release(request_pb);
 }
 
 
@@ -513,7 +638,8 @@ void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
     return;
   }
 
-  Message* request_pb = m_service->GetRequestPrototype(method).New();
+  Message* request_pb = m_message_pool.Allocate(
+      m_service->GetRequestPrototype(method));
 
   if (!request_pb) {
     OLA_WARN << "failed to get request or response objects";
@@ -522,12 +648,18 @@ void RpcChannel::HandleStreamRequest(RpcMessage *msg) {
 
   if (!request_pb->ParseFromString(msg->buffer())) {
     OLA_WARN << "parsing of request pb failed";
+    m_message_pool.Release(request_pb);
     return;
   }
 
+  const TimeStamp start = m_method_stats.Now();
+  m_method_stats.CallStarted(method, msg->buffer().size());
   RpcController controller(m_session.get());
   m_service->CallMethod(method, &controller, request_pb, NULL, NULL);
-  delete request_pb;
+  m_method_stats.HandlerDone(method, start);
+  // There's no response, so the call is complete once the handler returns.
+  m_method_stats.CallCompleted(method, start, 0);
+  m_message_pool.Release(request_pb);
 }
 
 
@@ -541,6 +673,8 @@ void RpcChannel::SendRequestFailed(OutstandingRequest *request) {
   message.set_id(request->id);
   message.set_buffer(request->controller->ErrorText());
   SendMsg(&message);
+  m_method_stats.CallCompleted(request->method, request->start,
+                               message.buffer().size());
   DeleteOutstandingRequest(request);
 }
 
@@ -560,6 +694,8 @@ void RpcChannel::SendNotImplemented(int msg_id) {
  * Cleanup an outstanding request after the response has been returned
  */
 void RpcChannel::DeleteOutstandingRequest(OutstandingRequest *request) {
+  m_message_pool.Release(request->response);
+  request->response = NULL;
   STLRemoveAndDelete(&m_requests, request->id);
 }
 
@@ -625,6 +761,7 @@ void RpcChannel::HandleNotImplemented(RpcMessage *msg) {
  * Invoke the Channel close handler/
  */
 void RpcChannel::HandleChannelClose() {
+  StopWriting();
   if (m_on_close.get()) {
     m_on_close.release()->Run(m_session.get());
   }
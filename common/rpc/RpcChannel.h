@@ -29,9 +29,15 @@
 #include <google/protobuf/service.h>
 #include <ola/Callback.h>
 #include <ola/io/Descriptor.h>
+#include <ola/io/IOQueue.h>
+#include <ola/io/MemoryBlockPool.h>
+#include <ola/io/SelectServerInterface.h>
 #include <ola/util/SequenceNumber.h>
 #include <memory>
+#include <string>
 
+#include "common/rpc/MessagePool.h"
+#include "common/rpc/RpcMethodStats.h"
 #include "ola/ExportMap.h"
 
 #include HASH_MAP_H
@@ -82,6 +88,30 @@ class RpcChannel {
      */
     void SetService(RpcService *service) { m_service = service; }
 
+    /**
+     * @brief Set the SelectServer to use for buffered writes.
+     * @param ss the SelectServer the descriptor is registered with.
+     *   Ownership is not transferred.
+     *
+     * If a message can't be written in full, the remainder is sent once the
+     * descriptor is writable. Without a SelectServer, a short write closes
+     * the channel.
+     */
+    void SetSelectServer(ola::io::SelectServerInterface *ss);
+
+    /**
+     * @brief Set the name of the client on the other end of the channel.
+     * @param name the client name, this is used for the per-client stats.
+     */
+    void SetClientName(const std::string &name) {
+      m_method_stats.SetClientName(name);
+    }
+
+    /**
+     * @brief The per-method stats for requests handled by this channel.
+     */
+    const RpcMethodStats &MethodStats() const { return m_method_stats; }
+
     /**
      * @brief Check if there are any pending RPCs on the channel.
      * Pending RPCs are those where a request has been sent, but no reply has
@@ -130,6 +160,14 @@ class RpcChannel {
      */
     RpcSession *Session();
 
+    /**
+     * @brief The size of the buffer for incoming messages, in bytes.
+     *
+     * The buffer grows to fit the largest message received and isn't shrunk.
+     * Outgoing messages use blocks from the shared packet pool.
+     */
+    unsigned int ReceiveBufferSize() const { return m_buffer_size; }
+
     /**
      * @brief the RPC protocol version.
      */
@@ -147,16 +185,28 @@ class RpcChannel {
     SequenceNumber<uint32_t> m_sequence;
     uint8_t *m_buffer;  // buffer for incoming msgs
     unsigned int m_buffer_size;  // size of the buffer
-    unsigned int m_expected_size;  // the total size of the current msg
-    unsigned int m_current_size;  // the amount of data read for the current msg
+    unsigned int m_current_size;  // the amount of data in the buffer
+    ola::io::SelectServerInterface *m_ss;  // may be NULL
+    // blocks for outgoing msgs, this is the shared packet pool.
+    ola::io::MemoryBlockPool *const m_block_pool;
+    ola::io::IOQueue m_output;  // data waiting to be written
+    // request and response messages for incoming RPCs
+    MessagePool m_message_pool;
+    std::auto_ptr<RpcMessage> m_incoming;  // reused for each incoming msg
+    RpcMethodStats m_method_stats;
+    bool m_write_registered;
     HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingRequest*> m_requests;
     ResponseMap m_responses;
     ExportMap *m_export_map;
     UIntMap *m_recv_type_map;
 
-    bool SendMsg(RpcMessage *msg);
-    int AllocateMsgBuffer(unsigned int size);
-    int ReadHeader(unsigned int *version, unsigned int *size) const;
+    bool SendMsg(RpcMessage *msg,
+                 const google::protobuf::Message *payload = NULL);
+    bool FlushOutput();
+    void DescriptorWritable();
+    void StopWriting();
+    bool SendFailed();
+    bool ReserveBuffer(unsigned int size);
     bool HandleNewMsg(uint8_t *buffer, unsigned int size);
     void HandleRequest(RpcMessage *msg);
     void HandleStreamRequest(RpcMessage *msg);
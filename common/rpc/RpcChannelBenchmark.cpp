@@ -0,0 +1,178 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RpcChannelBenchmark.cpp
+ * Microbenchmarks for the RpcChannel framing.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
+#include "common/rpc/TestService.pb.h"
+#include "common/rpc/TestServiceService.pb.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::io::LoopbackDescriptor;
+using ola::io::SelectServer;
+using ola::rpc::EchoReply;
+using ola::rpc::EchoRequest;
+using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using ola::rpc::STREAMING_NO_RESPONSE;
+using ola::rpc::TestService_Stub;
+using ola::testing::BenchmarkState;
+using std::auto_ptr;
+using std::string;
+
+namespace {
+
+/*
+ * The TestServiceImpl used by the tests asserts on the requests, this just
+ * counts them.
+ */
+class CountingService : public ola::rpc::TestService {
+ public:
+  CountingService() : m_streamed(0) {}
+
+  void Echo(OLA_UNUSED RpcController* controller,
+            const EchoRequest* request,
+            EchoReply* response,
+            CompletionCallback* done) {
+    response->set_data(request->data());
+    done->Run();
+  }
+
+  void FailedEcho(RpcController* controller,
+                  OLA_UNUSED const EchoRequest* request,
+                  OLA_UNUSED EchoReply* response,
+                  CompletionCallback* done) {
+    controller->SetFailed("Error");
+    done->Run();
+  }
+
+  void Stream(OLA_UNUSED RpcController* controller,
+              OLA_UNUSED const EchoRequest* request,
+              OLA_UNUSED STREAMING_NO_RESPONSE* response,
+              OLA_UNUSED CompletionCallback* done) {
+    m_streamed++;
+  }
+
+  uint64_t Streamed() const { return m_streamed; }
+
+ private:
+  uint64_t m_streamed;
+};
+
+/*
+ * A channel that talks to itself over a loopback descriptor.
+ */
+class LoopbackChannel {
+ public:
+  LoopbackChannel() {
+    m_socket.Init();
+    m_channel.reset(new RpcChannel(&m_service, &m_socket));
+    m_ss.AddReadDescriptor(&m_socket);
+    m_stub.reset(new TestService_Stub(m_channel.get()));
+  }
+
+  ~LoopbackChannel() {
+    m_ss.RemoveReadDescriptor(&m_socket);
+  }
+
+  void Poll() { m_ss.RunOnce(TimeInterval(0, 0)); }
+
+  CountingService *Service() { return &m_service; }
+  TestService_Stub *Stub() { return m_stub.get(); }
+
+ private:
+  SelectServer m_ss;
+  LoopbackDescriptor m_socket;
+  CountingService m_service;
+  auto_ptr<RpcChannel> m_channel;
+  auto_ptr<TestService_Stub> m_stub;
+};
+
+void SetDone(bool *done) {
+  *done = true;
+}
+
+/*
+ * A request and response, the size of a typical olad RPC.
+ */
+void RunEcho(BenchmarkState *state, unsigned int payload_size) {
+  LoopbackChannel channel;
+  EchoRequest request;
+  request.set_data(string(payload_size, 'x'));
+  request.set_session_ptr(0);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    RpcController controller;
+    EchoReply reply;
+    bool done = false;
+    channel.Stub()->Echo(&controller, &request, &reply,
+                         NewSingleCallback(&SetDone, &done));
+    while (!done) {
+      channel.Poll();
+    }
+  }
+  state->SetBytesProcessed(state->Iterations() * payload_size * 2);
+}
+
+void BenchmarkEchoSmall(BenchmarkState *state) {
+  RunEcho(state, 16);
+}
+OLA_BENCHMARK(BenchmarkEchoSmall);
+
+void BenchmarkEchoDmxFrame(BenchmarkState *state) {
+  RunEcho(state, 512);
+}
+OLA_BENCHMARK(BenchmarkEchoDmxFrame);
+
+/*
+ * Streaming requests, like StreamDmxData, where there is no response.
+ */
+void BenchmarkStream(BenchmarkState *state) {
+  const unsigned int BATCH_SIZE = 100;
+  LoopbackChannel channel;
+  EchoRequest request;
+  request.set_data(string(512, 'x'));
+
+  state->StartTiming();
+  uint64_t sent = 0;
+  while (sent < state->Iterations()) {
+    for (unsigned int i = 0; i < BATCH_SIZE && sent < state->Iterations();
+         i++, sent++) {
+      channel.Stub()->Stream(NULL, &request, NULL, NULL);
+    }
+    while (channel.Service()->Streamed() < sent) {
+      channel.Poll();
+    }
+  }
+  state->SetBytesProcessed(state->Iterations() * request.data().size());
+}
+OLA_BENCHMARK(BenchmarkStream);
+}  // namespace
@@ -53,6 +53,8 @@ class RpcChannelTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+  CPPUNIT_TEST(testQueuedRequests);
+  CPPUNIT_TEST(testLargeMessage);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -61,14 +63,18 @@ class RpcChannelTest: public CppUnit::TestFixture {
   void testEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testQueuedRequests();
+  void testLargeMessage();
   void EchoComplete();
   void FailedEchoComplete();
+  void QueuedEchoComplete(unsigned int index);
 
  private:
   RpcController m_controller;
   EchoRequest m_request;
   EchoReply m_reply;
   SelectServer m_ss;
+  unsigned int m_replies_received;
 
   auto_ptr<TestServiceImpl> m_service;
   auto_ptr<RpcChannel> m_channel;
@@ -79,6 +85,8 @@ class RpcChannelTest: public CppUnit::TestFixture {
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RpcChannelTest);
 
+static const unsigned int QUEUED_REQUESTS = 20;
+
 void RpcChannelTest::setUp() {
   m_socket.reset(new LoopbackDescriptor());
   m_socket->Init();
@@ -99,6 +107,12 @@ void RpcChannelTest::EchoComplete() {
   OLA_ASSERT_EQ(m_reply.data(), m_request.data());
 }
 
+void RpcChannelTest::QueuedEchoComplete(unsigned int index) {
+  OLA_ASSERT_EQ(m_replies_received, index);
+  if (++m_replies_received == QUEUED_REQUESTS)
+    m_ss.Terminate();
+}
+
 void RpcChannelTest::FailedEchoComplete() {
   m_ss.Terminate();
   OLA_ASSERT_TRUE(m_controller.Failed());
@@ -139,3 +153,41 @@ void RpcChannelTest::testStreamRequest() {
   m_stub->Stream(NULL, &m_request, NULL, NULL);
   m_ss.Run();
 }
+
+/*
+ * Check that requests which arrive together are all dispatched, in order.
+ */
+void RpcChannelTest::testQueuedRequests() {
+  m_replies_received = 0;
+  RpcController controllers[QUEUED_REQUESTS];
+  EchoReply replies[QUEUED_REQUESTS];
+  m_request.set_data("foo");
+  m_request.set_session_ptr(0);
+  for (unsigned int i = 0; i < QUEUED_REQUESTS; i++) {
+    m_stub->Echo(
+        &controllers[i], &m_request, &replies[i],
+        NewSingleCallback(this, &RpcChannelTest::QueuedEchoComplete, i));
+  }
+
+  m_ss.Run();
+  OLA_ASSERT_EQ(QUEUED_REQUESTS, m_replies_received);
+  for (unsigned int i = 0; i < QUEUED_REQUESTS; i++) {
+    OLA_ASSERT_FALSE(controllers[i].Failed());
+    OLA_ASSERT_EQ(m_request.data(), replies[i].data());
+  }
+}
+
+/*
+ * Check that messages larger than the initial buffer are reassembled.
+ */
+void RpcChannelTest::testLargeMessage() {
+  m_request.set_data(string(30000, 'x'));
+  m_request.set_session_ptr(0);
+  m_stub->Echo(&m_controller,
+               &m_request,
+               &m_reply,
+               NewSingleCallback(this, &RpcChannelTest::EchoComplete));
+
+  m_ss.Run();
+  OLA_ASSERT_EQ(m_request.data().size(), m_reply.data().size());
+}
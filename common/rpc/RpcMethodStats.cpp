@@ -0,0 +1,177 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RpcMethodStats.cpp
+ * Per-method statistics for the RPCs handled by a channel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/rpc/RpcMethodStats.h"
+
+#include <google/protobuf/descriptor.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "ola/base/Array.h"
+
+namespace ola {
+namespace rpc {
+
+using google::protobuf::MethodDescriptor;
+using std::string;
+using std::vector;
+
+namespace {
+/*
+ * The bucket bounds in microseconds.
+ */
+vector<uint64_t> LatencyBounds() {
+  const uint64_t bounds[] = {
+    10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000
+  };
+  return vector<uint64_t>(bounds, bounds + arraysize(bounds));
+}
+}  // namespace
+
+const char RpcMethodStats::K_METHOD_CALLS_VAR[] = "rpc-method-calls";
+const char RpcMethodStats::K_METHOD_IN_FLIGHT_VAR[] = "rpc-method-in-flight";
+const char RpcMethodStats::K_METHOD_BYTES_IN_VAR[] = "rpc-method-bytes-in";
+const char RpcMethodStats::K_METHOD_BYTES_OUT_VAR[] = "rpc-method-bytes-out";
+const char RpcMethodStats::K_METHOD_HANDLER_TIME_VAR[] =
+    "rpc-method-handler-us";
+const char RpcMethodStats::K_METHOD_COMPLETION_TIME_VAR[] =
+    "rpc-method-completion-us";
+const char RpcMethodStats::K_CLIENT_CALLS_VAR[] = "rpc-client-calls";
+const char RpcMethodStats::K_CLIENT_IN_FLIGHT_VAR[] = "rpc-client-in-flight";
+
+RpcMethodStats::RpcMethodStats(ExportMap *export_map)
+    : m_export_map(export_map),
+      m_client_calls(NULL),
+      m_client_in_flight(NULL) {
+}
+
+RpcMethodStats::~RpcMethodStats() {
+  if (m_export_map && !m_client.empty()) {
+    m_export_map->GetUIntMapVar(K_CLIENT_CALLS_VAR)->Remove(m_client);
+    m_export_map->GetUIntMapVar(K_CLIENT_IN_FLIGHT_VAR)->Remove(m_client);
+  }
+}
+
+void RpcMethodStats::SetClientName(const string &client) {
+  if (!m_export_map || client.empty() || !m_client.empty()) {
+    return;
+  }
+  m_client = client;
+  m_client_calls = &(*m_export_map->GetUIntMapVar(K_CLIENT_CALLS_VAR,
+                                                  "client"))[m_client];
+  m_client_in_flight = &(*m_export_map->GetUIntMapVar(K_CLIENT_IN_FLIGHT_VAR,
+                                                      "client"))[m_client];
+}
+
+TimeStamp RpcMethodStats::Now() const {
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  return now;
+}
+
+void RpcMethodStats::CallStarted(const MethodDescriptor *method,
+                                 unsigned int bytes_in) {
+  Method *state = GetMethod(method);
+  state->counters.calls++;
+  state->counters.in_flight++;
+  state->counters.bytes_in += bytes_in;
+  if (m_export_map) {
+    (*state->calls)++;
+    (*state->in_flight)++;
+    *state->bytes_in += bytes_in;
+  }
+  if (m_client_calls) {
+    (*m_client_calls)++;
+    (*m_client_in_flight)++;
+  }
+}
+
+void RpcMethodStats::HandlerDone(const MethodDescriptor *method,
+                                 const TimeStamp &start) {
+  if (m_export_map) {
+    GetMethod(method)->handler_time->Observe(Elapsed(start));
+  }
+}
+
+void RpcMethodStats::CallCompleted(const MethodDescriptor *method,
+                                   const TimeStamp &start,
+                                   unsigned int bytes_out) {
+  Method *state = GetMethod(method);
+  if (state->counters.in_flight) {
+    state->counters.in_flight--;
+  }
+  state->counters.bytes_out += bytes_out;
+  if (m_export_map) {
+    if (*state->in_flight) {
+      (*state->in_flight)--;
+    }
+    *state->bytes_out += bytes_out;
+    state->completion_time->Observe(Elapsed(start));
+  }
+  if (m_client_in_flight && *m_client_in_flight) {
+    (*m_client_in_flight)--;
+  }
+}
+
+RpcMethodStats::MethodCounters RpcMethodStats::Counters(
+    const MethodDescriptor *method) const {
+  const unsigned int index = static_cast<unsigned int>(method->index());
+  return index < m_methods.size() ? m_methods[index].counters :
+      MethodCounters();
+}
+
+RpcMethodStats::Method *RpcMethodStats::GetMethod(
+    const MethodDescriptor *method) {
+  const unsigned int index = static_cast<unsigned int>(method->index());
+  if (index >= m_methods.size()) {
+    const unsigned int old_size = m_methods.size();
+    m_methods.resize(method->service()->method_count());
+
+    for (unsigned int i = old_size; i < m_methods.size(); i++) {
+      Method &state = m_methods[i];
+      if (!m_export_map) {
+        continue;
+      }
+      const string &name = method->service()->method(i)->name();
+      state.calls = &(*m_export_map->GetUIntMapVar(K_METHOD_CALLS_VAR,
+                                                   "method"))[name];
+      state.in_flight = &(*m_export_map->GetUIntMapVar(K_METHOD_IN_FLIGHT_VAR,
+                                                       "method"))[name];
+      state.bytes_in = &(*m_export_map->GetUIntMapVar(K_METHOD_BYTES_IN_VAR,
+                                                      "method"))[name];
+      state.bytes_out = &(*m_export_map->GetUIntMapVar(K_METHOD_BYTES_OUT_VAR,
+                                                       "method"))[name];
+      state.handler_time = m_export_map->GetHistogramMapVar(
+          K_METHOD_HANDLER_TIME_VAR, "method", LatencyBounds())->Get(name);
+      state.completion_time = m_export_map->GetHistogramMapVar(
+          K_METHOD_COMPLETION_TIME_VAR, "method", LatencyBounds())->Get(name);
+    }
+  }
+  return &m_methods[index];
+}
+
+uint64_t RpcMethodStats::Elapsed(const TimeStamp &start) const {
+  const TimeStamp end = Now();
+  return end > start ? (end - start).AsInt() : 0;
+}
+}  // namespace rpc
+}  // namespace ola
@@ -0,0 +1,167 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RpcMethodStats.h
+ * Per-method statistics for the RPCs handled by a channel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_RPC_RPCMETHODSTATS_H_
+#define COMMON_RPC_RPCMETHODSTATS_H_
+
+#include <google/protobuf/descriptor.h>
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rpc {
+
+/**
+ * @brief Per-method statistics for the RPCs handled by a channel.
+ *
+ * Every channel counts the calls, calls in flight and bytes in and out for
+ * each method, in an array indexed by the method's index in the service.
+ *
+ * If an ExportMap is provided, the totals across all channels are added to
+ * it, keyed by method name, along with histograms of how long the handler
+ * ran and how long until the response was sent. Once the channel has a
+ * client name, the calls and calls in flight for the client are exported as
+ * well.
+ */
+class RpcMethodStats {
+ public:
+  /**
+   * @brief The counters for one method.
+   */
+  struct MethodCounters {
+   public:
+    unsigned int calls;
+    unsigned int in_flight;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+
+    MethodCounters()
+        : calls(0),
+          in_flight(0),
+          bytes_in(0),
+          bytes_out(0) {
+    }
+  };
+
+  /**
+   * @brief Create a new RpcMethodStats.
+   * @param export_map the ExportMap to add the totals to, may be NULL.
+   */
+  explicit RpcMethodStats(ola::ExportMap *export_map);
+
+  /**
+   * @brief Destructor, this removes the client from the ExportMap.
+   */
+  ~RpcMethodStats();
+
+  /**
+   * @brief Set the name of the client on the other end of the channel.
+   * @param client the client name, usually the peer address.
+   */
+  void SetClientName(const std::string &client);
+
+  /**
+   * @brief The time a call started.
+   */
+  TimeStamp Now() const;
+
+  /**
+   * @brief Called when a request arrives.
+   * @param method the method being called.
+   * @param bytes_in the size of the request.
+   */
+  void CallStarted(const google::protobuf::MethodDescriptor *method,
+                   unsigned int bytes_in);
+
+  /**
+   * @brief Called when the method's handler returns.
+   * @param method the method being called.
+   * @param start the time from Now() when the request arrived.
+   */
+  void HandlerDone(const google::protobuf::MethodDescriptor *method,
+                   const TimeStamp &start);
+
+  /**
+   * @brief Called when the call completes, successfully or not.
+   * @param method the method being called.
+   * @param start the time from Now() when the request arrived.
+   * @param bytes_out the size of the response.
+   */
+  void CallCompleted(const google::protobuf::MethodDescriptor *method,
+                     const TimeStamp &start,
+                     unsigned int bytes_out);
+
+  /**
+   * @brief The counters for a method on this channel.
+   * @param method the method.
+   * @returns the counters, which are all zero if the method hasn't been
+   *   called.
+   */
+  MethodCounters Counters(
+      const google::protobuf::MethodDescriptor *method) const;
+
+  static const char K_METHOD_CALLS_VAR[];
+  static const char K_METHOD_IN_FLIGHT_VAR[];
+  static const char K_METHOD_BYTES_IN_VAR[];
+  static const char K_METHOD_BYTES_OUT_VAR[];
+  static const char K_METHOD_HANDLER_TIME_VAR[];
+  static const char K_METHOD_COMPLETION_TIME_VAR[];
+  static const char K_CLIENT_CALLS_VAR[];
+  static const char K_CLIENT_IN_FLIGHT_VAR[];
+
+ private:
+  // The state for a method, the pointers are into the ExportMap.
+  struct Method {
+    MethodCounters counters;
+    unsigned int *calls;
+    unsigned int *in_flight;
+    unsigned int *bytes_in;
+    unsigned int *bytes_out;
+    HistogramVariable *handler_time;
+    HistogramVariable *completion_time;
+
+    Method()
+        : calls(NULL),
+          in_flight(NULL),
+          bytes_in(NULL),
+          bytes_out(NULL),
+          handler_time(NULL),
+          completion_time(NULL) {
+    }
+  };
+
+  ola::ExportMap *m_export_map;
+  ola::Clock m_clock;
+  std::vector<Method> m_methods;
+  std::string m_client;
+  unsigned int *m_client_calls;
+  unsigned int *m_client_in_flight;
+
+  Method *GetMethod(const google::protobuf::MethodDescriptor *method);
+  uint64_t Elapsed(const TimeStamp &start) const;
+
+  DISALLOW_COPY_AND_ASSIGN(RpcMethodStats);
+};
+}  // namespace rpc
+}  // namespace ola
+#endif  // COMMON_RPC_RPCMETHODSTATS_H_
@@ -0,0 +1,136 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * RpcMethodStatsTest.cpp
+ * Test fixture for the RpcMethodStats class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <google/protobuf/descriptor.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/rpc/RpcMethodStats.h"
+#include "common/rpc/TestService.pb.h"
+#include "ola/ExportMap.h"
+#include "ola/testing/TestUtils.h"
+
+using google::protobuf::MethodDescriptor;
+using google::protobuf::ServiceDescriptor;
+using ola::ExportMap;
+using ola::TimeStamp;
+using ola::UIntMap;
+using ola::rpc::RpcMethodStats;
+using std::string;
+
+class RpcMethodStatsTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RpcMethodStatsTest);
+  CPPUNIT_TEST(testCounters);
+  CPPUNIT_TEST(testExportMap);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testCounters();
+    void testExportMap();
+
+ private:
+    const MethodDescriptor *m_echo;
+    const MethodDescriptor *m_stream;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RpcMethodStatsTest);
+
+void RpcMethodStatsTest::setUp() {
+  const ServiceDescriptor *service =
+      ola::rpc::EchoRequest::descriptor()->file()->FindServiceByName(
+          "TestService");
+  OLA_ASSERT_NOT_NULL(service);
+  m_echo = service->FindMethodByName("Echo");
+  m_stream = service->FindMethodByName("Stream");
+  OLA_ASSERT_NOT_NULL(m_echo);
+  OLA_ASSERT_NOT_NULL(m_stream);
+}
+
+/*
+ * Check the per-channel counters, without an ExportMap.
+ */
+void RpcMethodStatsTest::testCounters() {
+  RpcMethodStats stats(NULL);
+  OLA_ASSERT_EQ(0u, stats.Counters(m_echo).calls);
+
+  const TimeStamp start = stats.Now();
+  stats.CallStarted(m_echo, 10);
+  stats.HandlerDone(m_echo, start);
+  RpcMethodStats::MethodCounters counters = stats.Counters(m_echo);
+  OLA_ASSERT_EQ(1u, counters.calls);
+  OLA_ASSERT_EQ(1u, counters.in_flight);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(10), counters.bytes_in);
+
+  stats.CallCompleted(m_echo, start, 20);
+  counters = stats.Counters(m_echo);
+  OLA_ASSERT_EQ(1u, counters.calls);
+  OLA_ASSERT_EQ(0u, counters.in_flight);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(20), counters.bytes_out);
+
+  OLA_ASSERT_EQ(0u, stats.Counters(m_stream).calls);
+}
+
+/*
+ * Check the totals and per-client stats are exported.
+ */
+void RpcMethodStatsTest::testExportMap() {
+  ExportMap export_map;
+  UIntMap *client_calls = export_map.GetUIntMapVar(
+      RpcMethodStats::K_CLIENT_CALLS_VAR, "client");
+  {
+    RpcMethodStats stats1(&export_map);
+    stats1.SetClientName("client1");
+    RpcMethodStats stats2(&export_map);
+
+    const TimeStamp start = stats1.Now();
+    stats1.CallStarted(m_echo, 10);
+    stats2.CallStarted(m_echo, 5);
+    stats2.CallStarted(m_stream, 5);
+
+    UIntMap *calls = export_map.GetUIntMapVar(
+        RpcMethodStats::K_METHOD_CALLS_VAR);
+    UIntMap *in_flight = export_map.GetUIntMapVar(
+        RpcMethodStats::K_METHOD_IN_FLIGHT_VAR);
+    OLA_ASSERT_EQ(2u, (*calls)["Echo"]);
+    OLA_ASSERT_EQ(1u, (*calls)["Stream"]);
+    OLA_ASSERT_EQ(2u, (*in_flight)["Echo"]);
+    OLA_ASSERT_EQ(15u, (*export_map.GetUIntMapVar(
+        RpcMethodStats::K_METHOD_BYTES_IN_VAR))["Echo"]);
+    OLA_ASSERT_EQ(1u, (*client_calls)["client1"]);
+
+    stats1.HandlerDone(m_echo, start);
+    stats1.CallCompleted(m_echo, start, 8);
+    OLA_ASSERT_EQ(1u, (*in_flight)["Echo"]);
+    OLA_ASSERT_EQ(8u, (*export_map.GetUIntMapVar(
+        RpcMethodStats::K_METHOD_BYTES_OUT_VAR))["Echo"]);
+
+    ola::HistogramMap *handler_time = export_map.GetHistogramMapVar(
+        RpcMethodStats::K_METHOD_HANDLER_TIME_VAR, "",
+        std::vector<uint64_t>());
+    OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                  handler_time->Get("Echo")->Count());
+  }
+
+  // The client is removed once the channel has gone.
+  OLA_ASSERT_EQ(string("map:client"), client_calls->Value());
+}
@@ -20,11 +20,26 @@
 
 #include "common/rpc/RpcServer.h"
 
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
 #include <ola/ExportMap.h>
 #include <ola/Logging.h>
 #include <ola/network/SocketAddress.h>
 #include <ola/network/TCPSocket.h>
+#ifndef _WIN32
+#include <ola/network/UnixDomainSocket.h>
+#endif  // !_WIN32
 #include <ola/rpc/RpcSessionHandler.h>
+
+#include <sstream>
+#include <string>
 #include "common/rpc/RpcChannel.h"
 #include "common/rpc/RpcSession.h"
 
@@ -38,6 +53,8 @@ using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::TCPAcceptingSocket;
 using ola::network::TCPSocket;
+using ola::network::UnixDomainSocket;
+using std::string;
 
 namespace {
 void CleanupChannel(RpcChannel *channel,
@@ -49,6 +66,54 @@ void CleanupChannel(RpcChannel *channel,
 
 const char RpcServer::K_CLIENT_VAR[] = "clients-connected";
 const char RpcServer::K_RPC_PORT_VAR[] = "rpc-port";
+const char RpcServer::K_RPC_SOCKET_VAR[] = "rpc-socket-path";
+
+string LocalSocketDirectory() {
+#ifdef _WIN32
+  return "";
+#else
+  const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+  if (runtime_dir && runtime_dir[0] == '/') {
+    return runtime_dir;
+  }
+  std::ostringstream str;
+  str << "/tmp/ola-" << geteuid();
+  return str.str();
+#endif  // _WIN32
+}
+
+bool SetupLocalSocketDirectory() {
+#ifdef _WIN32
+  return false;
+#else
+  // /tmp is shared, so another user may have created the directory first.
+  // Only use it if it's ours and no one else can get in.
+  const string directory = LocalSocketDirectory();
+  if (mkdir(directory.c_str(), 0700) && errno != EEXIST) {
+    OLA_WARN << "Failed to create " << directory << ": " << strerror(errno);
+    return false;
+  }
+
+  struct stat stat_buf;
+  if (lstat(directory.c_str(), &stat_buf)) {
+    OLA_WARN << "Failed to stat " << directory << ": " << strerror(errno);
+    return false;
+  }
+  if (!S_ISDIR(stat_buf.st_mode) || stat_buf.st_uid != geteuid() ||
+      (stat_buf.st_mode & (S_IRWXG | S_IRWXO))) {
+    OLA_WARN << directory << " isn't a directory private to uid "
+             << geteuid();
+    return false;
+  }
+  return true;
+#endif  // _WIN32
+}
+
+string LocalSocketPath(uint16_t port) {
+  std::ostringstream str;
+  str << LocalSocketDirectory() << "/ola-rpc-" << port << ".sock";
+  return str.str();
+}
 
 RpcServer::RpcServer(ola::io::SelectServerInterface *ss,
                      RpcService *service,
@@ -81,6 +146,13 @@ RpcServer::~RpcServer() {
   if (m_accepting_socket.get() && m_accepting_socket->ValidReadDescriptor()) {
     m_ss->RemoveReadDescriptor(m_accepting_socket.get());
   }
+
+#ifndef _WIN32
+  if (m_unix_accepting_socket.get() &&
+      m_unix_accepting_socket->ValidReadDescriptor()) {
+    m_ss->RemoveReadDescriptor(m_unix_accepting_socket.get());
+  }
+#endif  // !_WIN32
 }
 
 bool RpcServer::Init() {
@@ -115,6 +187,12 @@ bool RpcServer::Init() {
   }
 
   m_accepting_socket.reset(accepting_socket.release());
+
+  if (!m_options.listen_path.empty() && !ListenOnPath()) {
+    m_ss->RemoveReadDescriptor(m_accepting_socket.get());
+    m_accepting_socket.reset();
+    return false;
+  }
   return true;
 }
 
@@ -125,11 +203,14 @@ GenericSocketAddress RpcServer::ListenAddress() {
   return GenericSocketAddress();
 }
 
-bool RpcServer::AddClient(ConnectedDescriptor *descriptor) {
-  // If RpcChannel had a pointer to the SelectServer to use, we could hand off
-  // ownership of the socket here.
+bool RpcServer::AddClient(ConnectedDescriptor *descriptor,
+                          const string &client_name) {
+  // If RpcChannel owned the descriptor, we could hand off ownership of the
+  // socket here.
   RpcChannel *channel = new RpcChannel(m_service, descriptor,
                                        m_options.export_map);
+  channel->SetSelectServer(m_ss);
+  channel->SetClientName(client_name);
 
   if (m_session_handler) {
     m_session_handler->NewClient(channel->Session());
@@ -153,7 +234,50 @@ void RpcServer::NewTCPConnection(TCPSocket *socket) {
     return;
 
   socket->SetNoDelay();
-  AddClient(socket);
+  AddClient(socket, socket->GetPeerAddress().ToString());
+}
+
+#ifndef _WIN32
+void RpcServer::NewUnixConnection(UnixDomainSocket *socket) {
+  if (!socket)
+    return;
+
+  std::ostringstream client_name;
+  client_name << "local:" << socket->ReadDescriptor();
+  AddClient(socket, client_name.str());
+}
+#endif  // !_WIN32
+
+/*
+ * Listen on the unix domain socket. If something else holds the path, local
+ * clients could end up talking to it, so this is fatal.
+ */
+bool RpcServer::ListenOnPath() {
+#ifdef _WIN32
+  OLA_WARN << "Unix domain sockets aren't supported, not listening on "
+           << m_options.listen_path;
+  return false;
+#else
+  auto_ptr<ola::network::UnixDomainAcceptingSocket> socket(
+      new ola::network::UnixDomainAcceptingSocket(
+          ola::NewCallback(this, &RpcServer::NewUnixConnection)));
+  if (!socket->Listen(m_options.listen_path)) {
+    OLA_FATAL << "Could not listen on " << m_options.listen_path;
+    return false;
+  }
+
+  if (!m_ss->AddReadDescriptor(socket.get())) {
+    OLA_WARN << "Failed to add RPC unix socket to SelectServer";
+    return false;
+  }
+
+  if (m_options.export_map) {
+    m_options.export_map->GetStringVar(K_RPC_SOCKET_VAR)->Set(
+        m_options.listen_path);
+  }
+  m_unix_accepting_socket.reset(socket.release());
+  return true;
+#endif  // _WIN32
 }
 
 void RpcServer::ChannelClosed(ConnectedDescriptor *descriptor,
@@ -27,13 +27,41 @@
 
 #include <set>
 #include <memory>
+#include <string>
 
 namespace ola {
 
 class ExportMap;
 
+namespace network {
+class UnixDomainAcceptingSocket;
+class UnixDomainSocket;
+}  // namespace network
+
 namespace rpc {
 
+/**
+ * @brief The directory that holds the unix domain sockets for the current
+ *   user.
+ *
+ * This is $XDG_RUNTIME_DIR if it's set, otherwise /tmp/ola-<uid>.
+ */
+std::string LocalSocketDirectory();
+
+/**
+ * @brief Create the LocalSocketDirectory() if it doesn't exist, and check
+ *   that only the current user can access it.
+ * @returns true if the directory is safe to use, false otherwise.
+ */
+bool SetupLocalSocketDirectory();
+
+/**
+ * @brief The path of the unix domain socket used alongside an RPC port.
+ * @param port the TCP port the RPC server listens on.
+ * @returns the path of the socket, in the LocalSocketDirectory().
+ */
+std::string LocalSocketPath(uint16_t port);
+
 /**
  * @brief An RPC server.
  *
@@ -72,6 +100,15 @@ class RpcServer {
      */
     ola::network::TCPAcceptingSocket *listen_socket;
 
+    /**
+     * @brief The path of a unix domain socket to also wait for clients on.
+     *
+     * Local clients can use this rather than TCP. If empty, the default, only
+     * TCP is used. Init() fails if the path can't be listened on. This isn't
+     * supported on Windows.
+     */
+    std::string listen_path;
+
     Options()
       : listen_port(0),
         export_map(NULL),
@@ -110,8 +147,11 @@ class RpcServer {
    * @brief Manually attach a new client on the given descriptor
    * @param descriptor The ConnectedDescriptor that the client is using.
    *   Ownership of the descriptor is transferred.
+   * @param client_name the name to export the client's stats under, if
+   *   empty the client isn't included in the per-client stats.
    */
-  bool AddClient(ola::io::ConnectedDescriptor *descriptor);
+  bool AddClient(ola::io::ConnectedDescriptor *descriptor,
+                 const std::string &client_name = "");
 
  private:
   typedef std::set<ola::io::ConnectedDescriptor*> ClientDescriptors;
@@ -123,14 +163,21 @@ class RpcServer {
 
   ola::network::TCPSocketFactory m_tcp_socket_factory;
   std::auto_ptr<ola::network::TCPAcceptingSocket> m_accepting_socket;
+#ifndef _WIN32
+  std::auto_ptr<ola::network::UnixDomainAcceptingSocket>
+      m_unix_accepting_socket;
+#endif  // !_WIN32
   ClientDescriptors m_connected_sockets;
 
   void NewTCPConnection(ola::network::TCPSocket *socket);
+  void NewUnixConnection(ola::network::UnixDomainSocket *socket);
+  bool ListenOnPath();
   void ChannelClosed(ola::io::ConnectedDescriptor *socket,
                      class RpcSession *session);
 
   static const char K_CLIENT_VAR[];
   static const char K_RPC_PORT_VAR[];
+  static const char K_RPC_SOCKET_VAR[];
 };
 }  // namespace rpc
 }  // namespace ola
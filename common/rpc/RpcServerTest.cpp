@@ -18,7 +18,13 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <memory>
+#include <sstream>
+#include <string>
 
 #include "common/rpc/RpcServer.h"
 #include "common/rpc/RpcSession.h"
@@ -39,12 +45,20 @@ class RpcServerTest: public CppUnit::TestFixture,
   CPPUNIT_TEST(testEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+#ifndef _WIN32
+  CPPUNIT_TEST(testUnixSocket);
+  CPPUNIT_TEST(testUnixSocketFailure);
+  CPPUNIT_TEST(testLocalSocketDirectory);
+#endif  // !_WIN32
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testUnixSocket();
+  void testUnixSocketFailure();
+  void testLocalSocketDirectory();
 
   void setUp();
 
@@ -91,3 +105,85 @@ void RpcServerTest::testFailedEcho() {
 void RpcServerTest::testStreamRequest() {
   m_client->StreamMessage();
 }
+
+/*
+ * Check clients can connect over the unix domain socket.
+ */
+void RpcServerTest::testUnixSocket() {
+  std::ostringstream str;
+  str << "/tmp/ola-rpc-test-" << getpid() << ".sock";
+  const std::string path = str.str();
+
+  RpcServer::Options options;
+  options.listen_path = path;
+  auto_ptr<RpcServer> server(
+      new RpcServer(&m_ss, m_service.get(), this, options));
+  OLA_ASSERT_TRUE(server->Init());
+  OLA_ASSERT_EQ(0, access(path.c_str(), F_OK));
+
+  TestClient client(&m_ss, path);
+  OLA_ASSERT_TRUE(client.Init());
+  client.CallEcho(&ptr_data);
+  client.StreamMessage();
+
+  // The path is removed when the server is destroyed.
+  server.reset();
+  OLA_ASSERT_NE(0, access(path.c_str(), F_OK));
+}
+
+
+/*
+ * Check Init() fails if the unix domain socket can't be created.
+ */
+void RpcServerTest::testUnixSocketFailure() {
+  std::ostringstream str;
+  str << "/tmp/ola-rpc-test-" << getpid() << "/missing/rpc.sock";
+
+  RpcServer::Options options;
+  options.listen_path = str.str();
+  RpcServer server(&m_ss, m_service.get(), this, options);
+  OLA_ASSERT_FALSE(server.Init());
+  OLA_ASSERT_EQ(ola::network::GenericSocketAddress().Family(),
+                server.ListenAddress().Family());
+}
+
+/*
+ * Check the socket directory is only used if it's private to this user.
+ */
+void RpcServerTest::testLocalSocketDirectory() {
+  const char *old_runtime_dir = getenv("XDG_RUNTIME_DIR");
+  const std::string saved_runtime_dir(old_runtime_dir ? old_runtime_dir : "");
+
+  std::ostringstream str;
+  str << "/tmp/ola-rpc-test-dir-" << getpid();
+  const std::string directory = str.str();
+  setenv("XDG_RUNTIME_DIR", directory.c_str(), 1);
+
+  OLA_ASSERT_EQ(directory, ola::rpc::LocalSocketDirectory());
+  OLA_ASSERT_EQ(directory + "/ola-rpc-9010.sock",
+                ola::rpc::LocalSocketPath(9010));
+
+  // The directory is created if it's missing.
+  OLA_ASSERT_TRUE(ola::rpc::SetupLocalSocketDirectory());
+  struct stat stat_buf;
+  OLA_ASSERT_EQ(0, lstat(directory.c_str(), &stat_buf));
+  OLA_ASSERT_TRUE(S_ISDIR(stat_buf.st_mode));
+  OLA_ASSERT_EQ(0700u, static_cast<unsigned int>(stat_buf.st_mode & 0777));
+  OLA_ASSERT_TRUE(ola::rpc::SetupLocalSocketDirectory());
+
+  // Other users can get in.
+  OLA_ASSERT_EQ(0, chmod(directory.c_str(), 0755));
+  OLA_ASSERT_FALSE(ola::rpc::SetupLocalSocketDirectory());
+  OLA_ASSERT_EQ(0, rmdir(directory.c_str()));
+
+  // Not a directory.
+  OLA_ASSERT_EQ(0, symlink("/tmp", directory.c_str()));
+  OLA_ASSERT_FALSE(ola::rpc::SetupLocalSocketDirectory());
+  OLA_ASSERT_EQ(0, unlink(directory.c_str()));
+
+  if (old_runtime_dir) {
+    setenv("XDG_RUNTIME_DIR", saved_runtime_dir.c_str(), 1);
+  } else {
+    unsetenv("XDG_RUNTIME_DIR");
+  }
+}
@@ -27,6 +27,9 @@
 #include "common/rpc/RpcSession.h"
 #include "common/rpc/TestServiceService.pb.h"
 #include "ola/io/SelectServer.h"
+#ifndef _WIN32
+#include "ola/network/UnixDomainSocket.h"
+#endif  // !_WIN32
 #include "ola/testing/TestUtils.h"
 #include "common/rpc/RpcChannel.h"
 
@@ -83,12 +86,23 @@ TestClient::TestClient(SelectServer *ss,
       m_server_addr(server_addr) {
 }
 
+TestClient::TestClient(SelectServer *ss, const string &socket_path)
+    : m_ss(ss),
+      m_socket_path(socket_path) {
+}
+
 TestClient::~TestClient() {
   m_ss->RemoveReadDescriptor(m_socket.get());
 }
 
 bool TestClient::Init() {
-  m_socket.reset(TCPSocket::Connect(m_server_addr));
+  if (m_socket_path.empty()) {
+    m_socket.reset(TCPSocket::Connect(m_server_addr));
+  } else {
+#ifndef _WIN32
+    m_socket.reset(ola::network::UnixDomainSocket::Connect(m_socket_path));
+#endif  // !_WIN32
+  }
   OLA_ASSERT_NOT_NULL(m_socket.get());
 
   m_channel.reset(new RpcChannel(NULL, m_socket.get()));
@@ -22,6 +22,7 @@
 #define COMMON_RPC_TESTSERVICE_H_
 
 #include <memory>
+#include <string>
 
 #include "common/rpc/RpcController.h"
 #include "common/rpc/TestServiceService.pb.h"
@@ -57,6 +58,8 @@ class TestClient {
  public:
   TestClient(ola::io::SelectServer *ss,
              const ola::network::GenericSocketAddress &server_addr);
+  // Connect over a unix domain socket.
+  TestClient(ola::io::SelectServer *ss, const std::string &socket_path);
   ~TestClient();
 
   bool Init();
@@ -77,7 +80,8 @@ class TestClient {
  private:
   ola::io::SelectServer *m_ss;
   const ola::network::GenericSocketAddress m_server_addr;
-  std::auto_ptr<ola::network::TCPSocket> m_socket;
+  const std::string m_socket_path;
+  std::auto_ptr<ola::io::ConnectedDescriptor> m_socket;
   std::auto_ptr<ola::rpc::TestService_Stub> m_stub;
   std::auto_ptr<ola::rpc::RpcChannel> m_channel;
 };
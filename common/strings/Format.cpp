@@ -20,6 +20,7 @@
 
 #include "ola/strings/Format.h"
 
+#include <string.h>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -31,16 +32,34 @@ using std::endl;
 using std::ostringstream;
 using std::string;
 
+char *FormatUnsigned(unsigned int value, char *buffer) {
+  // Write the digits backwards, then copy them into place.
+  char digits[MAX_UNSIGNED_DIGITS];
+  char *ptr = digits + sizeof(digits);
+  do {
+    *--ptr = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  const unsigned int length = digits + sizeof(digits) - ptr;
+  memcpy(buffer, ptr, length);
+  return buffer + length;
+}
+
 string IntToString(int i) {
-  ostringstream str;
-  str << i;
-  return str.str();
+  char buffer[MAX_UNSIGNED_DIGITS + 1];
+  char *ptr = buffer;
+  unsigned int value = static_cast<unsigned int>(i);
+  if (i < 0) {
+    *ptr++ = '-';
+    value = 0u - value;
+  }
+  return string(buffer, FormatUnsigned(value, ptr));
 }
 
 string IntToString(unsigned int i) {
-  ostringstream str;
-  str << i;
-  return str.str();
+  char buffer[MAX_UNSIGNED_DIGITS];
+  return string(buffer, FormatUnsigned(i, buffer));
 }
 
 void FormatData(std::ostream *out,
@@ -0,0 +1,241 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * Benchmark.cpp
+ * A minimal microbenchmark framework.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Flags.h"
+#include "ola/testing/Benchmark.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonWriter.h"
+
+DEFINE_string(benchmark_filter, "",
+              "Only run the benchmarks with names containing this string.");
+DEFINE_uint32(benchmark_min_time, 200,
+              "The minimum time in ms for each repetition of a benchmark.");
+DEFINE_uint32(benchmark_repetitions, 5,
+              "The number of times to run each benchmark, the median is "
+              "reported.");
+DEFINE_default_bool(benchmark_json, false, "Print the results as JSON.");
+
+namespace ola {
+namespace testing {
+
+using ola::web::JsonArray;
+using ola::web::JsonObject;
+using ola::web::JsonUInt64;
+using std::string;
+using std::vector;
+
+namespace {
+
+struct BenchmarkEntry {
+  const char *name;
+  BenchmarkFunction function;
+};
+
+struct BenchmarkResult {
+  string name;
+  uint64_t iterations;
+  double median_ns;
+  double min_ns;
+  double max_ns;
+  // The throughput of the median run, or 0 if the benchmark doesn't set the
+  // bytes processed.
+  double megabytes_per_second;
+};
+
+/*
+ * A function level static, so registrations from other translation units
+ * don't depend on the initialization order.
+ */
+vector<BenchmarkEntry> &Benchmarks() {
+  static vector<BenchmarkEntry> benchmarks;
+  return benchmarks;
+}
+
+const uint64_t MAX_ITERATIONS = 1000000000;
+
+int64_t RunOnce(BenchmarkFunction function, uint64_t iterations,
+                uint64_t *bytes_processed) {
+  BenchmarkState state(iterations);
+  function(&state);
+  state.StopTiming();
+  *bytes_processed = state.BytesProcessed();
+  return state.Elapsed().AsInt();
+}
+
+/*
+ * Find an iteration count that takes at least the minimum time.
+ */
+uint64_t Calibrate(BenchmarkFunction function, int64_t min_time_us) {
+  uint64_t iterations = 1;
+  while (iterations < MAX_ITERATIONS) {
+    uint64_t bytes_processed;
+    const int64_t elapsed = RunOnce(function, iterations, &bytes_processed);
+    if (elapsed >= min_time_us) {
+      break;
+    }
+    // Overshoot a little, so we don't need another try.
+    double multiplier = 100.0;
+    if (elapsed > 0) {
+      multiplier = std::min(100.0, std::max(
+          2.0, 1.4 * static_cast<double>(min_time_us) / elapsed));
+    }
+    iterations = std::min(
+        MAX_ITERATIONS, static_cast<uint64_t>(iterations * multiplier));
+  }
+  return iterations;
+}
+
+BenchmarkResult RunBenchmark(const BenchmarkEntry &entry) {
+  const int64_t min_time_us = FLAGS_benchmark_min_time * 1000;
+  const unsigned int repetitions = std::max(1u,
+      static_cast<unsigned int>(FLAGS_benchmark_repetitions));
+
+  BenchmarkResult result;
+  result.name = entry.name;
+  result.iterations = Calibrate(entry.function, min_time_us);
+
+  vector<double> times;
+  vector<uint64_t> bytes;
+  for (unsigned int i = 0; i < repetitions; i++) {
+    uint64_t bytes_processed;
+    const int64_t elapsed = RunOnce(entry.function, result.iterations,
+                                    &bytes_processed);
+    times.push_back(elapsed * 1000.0 / result.iterations);
+    bytes.push_back(bytes_processed);
+  }
+
+  vector<double> sorted_times(times);
+  std::sort(sorted_times.begin(), sorted_times.end());
+  result.median_ns = sorted_times[sorted_times.size() / 2];
+  result.min_ns = sorted_times.front();
+  result.max_ns = sorted_times.back();
+
+  result.megabytes_per_second = 0;
+  const unsigned int median_run =
+      std::find(times.begin(), times.end(), result.median_ns) - times.begin();
+  if (bytes[median_run] && result.median_ns > 0) {
+    const double bytes_per_iteration =
+        static_cast<double>(bytes[median_run]) / result.iterations;
+    result.megabytes_per_second =
+        bytes_per_iteration * 1000.0 / result.median_ns;
+  }
+  return result;
+}
+
+void PrintText(const BenchmarkResult &result) {
+  std::cout << std::left << std::setw(40) << result.name << std::right
+            << std::setw(12) << result.iterations
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << result.median_ns << " ns"
+            << "  (" << result.min_ns << " - " << result.max_ns << ")";
+  if (result.megabytes_per_second) {
+    std::cout << "  " << result.megabytes_per_second << " MB/s";
+  }
+  std::cout << std::endl;
+}
+}  // namespace
+
+
+BenchmarkState::BenchmarkState(uint64_t iterations)
+    : m_iterations(iterations),
+      m_bytes_processed(0),
+      m_running(true) {
+  m_clock.CurrentTime(&m_start);
+}
+
+void BenchmarkState::StartTiming() {
+  m_elapsed = TimeInterval();
+  m_running = true;
+  m_clock.CurrentTime(&m_start);
+}
+
+void BenchmarkState::PauseTiming() {
+  if (m_running) {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    m_elapsed += now - m_start;
+    m_running = false;
+  }
+}
+
+void BenchmarkState::ResumeTiming() {
+  if (!m_running) {
+    m_running = true;
+    m_clock.CurrentTime(&m_start);
+  }
+}
+
+void BenchmarkState::StopTiming() {
+  PauseTiming();
+}
+
+
+BenchmarkRegistration::BenchmarkRegistration(const char *name,
+                                             BenchmarkFunction function) {
+  BenchmarkEntry entry = {name, function};
+  Benchmarks().push_back(entry);
+}
+
+
+#if !defined(__GNUC__) && !defined(__clang__)
+void UseCharPointer(char const volatile*) {}
+#endif  // !defined(__GNUC__) && !defined(__clang__)
+
+
+int RunBenchmarks() {
+  const string filter = FLAGS_benchmark_filter.str();
+  JsonArray json;
+
+  vector<BenchmarkEntry>::const_iterator iter = Benchmarks().begin();
+  for (; iter != Benchmarks().end(); ++iter) {
+    if (!filter.empty() && string(iter->name).find(filter) == string::npos) {
+      continue;
+    }
+    const BenchmarkResult result = RunBenchmark(*iter);
+    if (FLAGS_benchmark_json) {
+      JsonObject *object = json.AppendObject();
+      object->Add("name", result.name);
+      object->AddValue("iterations", new JsonUInt64(result.iterations));
+      object->Add("ns_per_iteration", result.median_ns);
+      object->Add("min_ns_per_iteration", result.min_ns);
+      object->Add("max_ns_per_iteration", result.max_ns);
+      if (result.megabytes_per_second) {
+        object->Add("megabytes_per_second", result.megabytes_per_second);
+      }
+    } else {
+      PrintText(result);
+    }
+  }
+
+  if (FLAGS_benchmark_json) {
+    std::cout << ola::web::JsonWriter::AsString(json) << std::endl;
+  }
+  return 0;
+}
+}  // namespace testing
+}  // namespace ola
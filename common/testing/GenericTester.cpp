@@ -35,10 +35,18 @@
 
 using std::string;
 
+#ifdef _WIN32
+DECLARE_bool(use_iocp);
+#endif  // _WIN32
+
 #ifdef HAVE_EPOLL
 DECLARE_bool(use_epoll);
 #endif  // HAVE_EPOLL
 
+#ifdef HAVE_IO_URING
+DECLARE_bool(use_io_uring);
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_KQUEUE
 DECLARE_bool(use_kqueue);
 #endif  // HAVE_KQUEUE
@@ -56,10 +64,18 @@ int main(int argc, char* argv[]) {
   // Default to INFO since it's tests.
   FLAGS_log_level = ola::OLA_LOG_INFO;
 
+#ifdef _WIN32
+  FLAGS_use_iocp = GetBoolEnvVar("OLA_USE_IOCP");
+#endif  // _WIN32
+
 #ifdef HAVE_EPOLL
   FLAGS_use_epoll = GetBoolEnvVar("OLA_USE_EPOLL");
 #endif  // HAVE_EPOLL
 
+#ifdef HAVE_IO_URING
+  FLAGS_use_io_uring = GetBoolEnvVar("OLA_USE_IO_URING");
+#endif  // HAVE_IO_URING
+
 #ifdef HAVE_KQUEUE
   FLAGS_use_kqueue = GetBoolEnvVar("OLA_USE_KQUEUE");
 #endif  // HAVE_KQUEUE
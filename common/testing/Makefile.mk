@@ -8,3 +8,9 @@ common_testing_libolatesting_la_SOURCES = \
     common/testing/TestUtils.cpp
 common_testing_libtestmain_la_SOURCES = common/testing/GenericTester.cpp
 endif
+
+# The microbenchmark framework, used by the benchmark_programs.
+check_LTLIBRARIES += common/testing/libolabenchmark.la
+common_testing_libolabenchmark_la_SOURCES = \
+    common/testing/Benchmark.cpp \
+    common/testing/BenchmarkMain.cpp
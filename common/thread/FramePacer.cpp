@@ -0,0 +1,167 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FramePacer.cpp
+ * Sleeps until absolute deadlines, so output threads can send frames at a
+ * steady rate.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "ola/thread/FramePacer.h"
+#include "ola/thread/Mutex.h"
+
+namespace ola {
+namespace thread {
+
+FramePacer::FramePacer(unsigned int spin_time)
+    : m_spin_time(spin_time * NANOSECONDS_IN_MICROSECOND),
+      m_frame_start(0),
+      m_next_frame(0),
+      m_started(false),
+      m_window_start(0),
+      m_window_frames(0),
+      m_window_jitter(0),
+      m_window_max_jitter(0) {
+}
+
+void FramePacer::StartFrame(unsigned int frame_time) {
+  const Nanoseconds now = Now();
+  const Nanoseconds frame_length = frame_time * NANOSECONDS_IN_MICROSECOND;
+
+  Nanoseconds jitter = 0;
+  bool overrun = false;
+  if (m_started && m_next_frame) {
+    // Schedule from the deadline rather than from now, unless we're so late
+    // that we'd have to send frames back to back to catch up.
+    jitter = now > m_next_frame ? now - m_next_frame : 0;
+    overrun = jitter >= frame_length;
+    m_frame_start = overrun ? now : m_next_frame;
+  } else {
+    m_frame_start = now;
+  }
+
+  if (!m_started) {
+    m_started = true;
+    m_window_start = now;
+  }
+
+  m_next_frame = frame_length ? m_frame_start + frame_length : 0;
+  UpdateStats(now, jitter, overrun);
+}
+
+void FramePacer::SleepUntil(unsigned int offset) {
+  SleepUntilTime(m_frame_start + offset * NANOSECONDS_IN_MICROSECOND);
+}
+
+void FramePacer::Sleep(unsigned int delay) {
+  SleepUntilTime(Now() + delay * NANOSECONDS_IN_MICROSECOND);
+}
+
+void FramePacer::WaitForFrameEnd() {
+  if (m_next_frame) {
+    SleepUntilTime(m_next_frame);
+  }
+}
+
+void FramePacer::GetStats(Stats *stats) const {
+  MutexLocker locker(&m_stats_mutex);
+  *stats = m_stats;
+}
+
+void FramePacer::SleepUntilTime(Nanoseconds deadline) {
+  const Nanoseconds wake_time = deadline - m_spin_time;
+  Nanoseconds now = Now();
+
+  if (wake_time > now) {
+    struct timespec spec;
+#ifdef HAVE_CLOCK_NANOSLEEP
+    ToTimeSpec(wake_time, &spec);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, NULL) ==
+           EINTR) {
+    }
+#else
+    ToTimeSpec(wake_time - now, &spec);
+    while (nanosleep(&spec, &spec) == -1 && errno == EINTR) {
+    }
+#endif  // HAVE_CLOCK_NANOSLEEP
+    now = Now();
+  }
+
+  while (now < deadline) {
+    now = Now();
+  }
+}
+
+void FramePacer::UpdateStats(Nanoseconds now, Nanoseconds jitter,
+                             bool overrun) {
+  const unsigned int jitter_us = static_cast<unsigned int>(
+      jitter / NANOSECONDS_IN_MICROSECOND);
+  m_window_frames++;
+  m_window_jitter += jitter_us;
+  if (jitter_us > m_window_max_jitter) {
+    m_window_max_jitter = jitter_us;
+  }
+
+  MutexLocker locker(&m_stats_mutex);
+  m_stats.frames++;
+  if (overrun) {
+    m_stats.overruns++;
+  }
+
+  const Nanoseconds window = now - m_window_start;
+  if (window < NANOSECONDS_IN_SECOND) {
+    return;
+  }
+
+  m_stats.frame_rate = static_cast<double>(m_window_frames) *
+      NANOSECONDS_IN_SECOND / window;
+  m_stats.mean_jitter = static_cast<unsigned int>(
+      m_window_jitter / m_window_frames);
+  m_stats.max_jitter = m_window_max_jitter;
+
+  m_window_start = now;
+  m_window_frames = 0;
+  m_window_jitter = 0;
+  m_window_max_jitter = 0;
+}
+
+FramePacer::Nanoseconds FramePacer::Now() {
+#ifdef CLOCK_MONOTONIC
+  struct timespec spec;
+  if (clock_gettime(CLOCK_MONOTONIC, &spec) == 0) {
+    return static_cast<Nanoseconds>(spec.tv_sec) * NANOSECONDS_IN_SECOND +
+        spec.tv_nsec;
+  }
+#endif  // CLOCK_MONOTONIC
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<Nanoseconds>(tv.tv_sec) * NANOSECONDS_IN_SECOND +
+      tv.tv_usec * NANOSECONDS_IN_MICROSECOND;
+}
+
+void FramePacer::ToTimeSpec(Nanoseconds time, struct timespec *spec) {
+  spec->tv_sec = static_cast<time_t>(time / NANOSECONDS_IN_SECOND);
+  spec->tv_nsec = static_cast<long>(time % NANOSECONDS_IN_SECOND);  // NOLINT
+}
+}  // namespace thread
+}  // namespace ola
@@ -0,0 +1,108 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FramePacerTest.cpp
+ * Test fixture for the FramePacer class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Clock.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/FramePacer.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::FramePacer;
+
+class FramePacerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FramePacerTest);
+  CPPUNIT_TEST(testSleep);
+  CPPUNIT_TEST(testFrames);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testSleep();
+  void testFrames();
+
+ private:
+  Clock m_clock;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FramePacerTest);
+
+/*
+ * Check we never wake up before a deadline.
+ */
+void FramePacerTest::testSleep() {
+  FramePacer pacer(200);
+  TimeStamp start, end;
+
+  m_clock.CurrentTime(&start);
+  pacer.StartFrame(0);
+  pacer.SleepUntil(2000);
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 2000));
+
+  // Deadlines are measured from the start of the frame, not from now.
+  pacer.SleepUntil(3000);
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 3000));
+  OLA_ASSERT_TRUE(end - start < TimeInterval(0, 500000));
+
+  m_clock.CurrentTime(&start);
+  pacer.Sleep(1500);
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, 1500));
+
+  // A deadline in the past returns straight away.
+  m_clock.CurrentTime(&start);
+  pacer.SleepUntil(0);
+  pacer.WaitForFrameEnd();
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(end - start < TimeInterval(0, 500000));
+}
+
+/*
+ * Check frames are scheduled from the previous deadline & the stats.
+ */
+void FramePacerTest::testFrames() {
+  const unsigned int FRAME_TIME = 20000;
+  const unsigned int FRAMES = 55;
+  FramePacer pacer;
+  TimeStamp start, end;
+
+  FramePacer::Stats stats;
+  pacer.GetStats(&stats);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats.frames);
+
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FRAMES; i++) {
+    pacer.StartFrame(FRAME_TIME);
+    pacer.WaitForFrameEnd();
+  }
+  m_clock.CurrentTime(&end);
+
+  OLA_ASSERT_TRUE(end - start >= TimeInterval(0, FRAMES * FRAME_TIME));
+
+  pacer.GetStats(&stats);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(FRAMES), stats.frames);
+  // The stats window closed after a second, allow for a slow machine.
+  OLA_ASSERT_TRUE(stats.frame_rate > 30);
+  OLA_ASSERT_TRUE(stats.frame_rate <= 52);
+  OLA_ASSERT_TRUE(stats.max_jitter >= stats.mean_jitter);
+}
@@ -20,28 +20,52 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
 #include "ola/Logging.h"
+#include "ola/strings/Format.h"
+#include "ola/thread/ExecutorThread.h"
 #include "ola/thread/Future.h"
 #include "ola/thread/Thread.h"
 #include "ola/testing/TestUtils.h"
 
 
+using ola::NewSingleCallback;
 using ola::thread::ConditionVariable;
+using ola::thread::ExecutorThread;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using ola::thread::Future;
+using ola::thread::WhenAll;
+using ola::thread::WhenAny;
+using std::string;
+using std::vector;
 
 class FutureTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(FutureTest);
   CPPUNIT_TEST(testSingleThreadedFuture);
   CPPUNIT_TEST(testSingleThreadedVoidFuture);
   CPPUNIT_TEST(testMultithreadedFuture);
+  CPPUNIT_TEST(testThen);
+  CPPUNIT_TEST(testVoidThen);
+  CPPUNIT_TEST(testDropReferenceInContinuation);
+  CPPUNIT_TEST(testWhenAll);
+  CPPUNIT_TEST(testWhenAllAbandoned);
+  CPPUNIT_TEST(testWhenAny);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testSingleThreadedFuture();
     void testSingleThreadedVoidFuture();
     void testMultithreadedFuture();
+    void testThen();
+    void testVoidThen();
+    void testDropReferenceInContinuation();
+    void testWhenAll();
+    void testWhenAllAbandoned();
+    void testWhenAny();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(FutureTest);
@@ -67,6 +91,58 @@ class AdderThread: public ola::thread::Thread {
     Future<int> *future;
 };
 
+int Double(const int &i) {
+  return 2 * i;
+}
+
+string ToString(const int &i) {
+  return ola::strings::IntToString(i);
+}
+
+int Seven() {
+  return 7;
+}
+
+void SetFlag(bool *flag) {
+  *flag = true;
+}
+
+void DeleteFuture(Future<int> *future, const int&) {
+  delete future;
+}
+
+void StoreValue(int *output, const int &value) {
+  *output = value;
+}
+
+/*
+ * A value which counts the live instances.
+ */
+class Counted {
+ public:
+    Counted() { live++; }
+    Counted(const Counted&) { live++; }
+    ~Counted() { live--; }
+
+    static int live;
+};
+
+int Counted::live = 0;
+
+/*
+ * A callback which records when it's deleted.
+ */
+class DeletionTracker: public ola::BaseCallback1<int, const int&> {
+ public:
+    explicit DeletionTracker(bool *deleted) : m_deleted(deleted) {}
+    ~DeletionTracker() { *m_deleted = true; }
+
+    int Run(const int &i) { return i; }
+
+ private:
+    bool *m_deleted;
+};
+
 /*
  * Check that single threaded Future functionality works.
  */
@@ -133,3 +209,169 @@ void FutureTest::testMultithreadedFuture() {
   thread.Run();
   OLA_ASSERT_EQ(8, f1.Get());
 }
+
+
+/*
+ * Check continuations.
+ */
+void FutureTest::testThen() {
+  ExecutorThread executor((ola::thread::Thread::Options()));
+  OLA_ASSERT_TRUE(executor.Start());
+
+  // Run in the thread that sets the value, then on the executor.
+  Future<int> f1;
+  Future<int> doubled = f1.Then(NULL, NewSingleCallback(&Double));
+  Future<string> str = doubled.Then(&executor,
+                                    NewSingleCallback(&ToString));
+  OLA_ASSERT_FALSE(doubled.IsComplete());
+  f1.Set(21);
+  OLA_ASSERT_TRUE(doubled.IsComplete());
+  OLA_ASSERT_EQ(42, doubled.Get());
+  OLA_ASSERT_EQ(string("42"), str.Get());
+
+  // A continuation added once the value is set is dispatched straight away.
+  Future<int> f2 = f1.Then(NULL, NewSingleCallback(&Double));
+  OLA_ASSERT_TRUE(f2.IsComplete());
+  OLA_ASSERT_EQ(42, f2.Get());
+  OLA_ASSERT_EQ(42, f1.Then(&executor, NewSingleCallback(&Double)).Get());
+
+  // A continuation for a future that's never set is deleted, along with its
+  // callback.
+  bool deleted = false;
+  {
+    Future<int> f3;
+    f3.Then(&executor, new DeletionTracker(&deleted));
+  }
+  OLA_ASSERT_TRUE(deleted);
+  OLA_ASSERT_TRUE(executor.Stop());
+}
+
+
+/*
+ * Check continuations of void futures.
+ */
+void FutureTest::testVoidThen() {
+  ExecutorThread executor((ola::thread::Thread::Options()));
+  OLA_ASSERT_TRUE(executor.Start());
+
+  bool flag = false;
+  Future<void> f1;
+  Future<void> f2 = f1.Then(NULL, NewSingleCallback(&SetFlag, &flag));
+  Future<int> f3 = f1.Then(&executor, NewSingleCallback(&Seven));
+  OLA_ASSERT_FALSE(flag);
+  f1.Set();
+  OLA_ASSERT_TRUE(flag);
+  OLA_ASSERT_TRUE(f2.IsComplete());
+  OLA_ASSERT_EQ(7, f3.Get());
+  OLA_ASSERT_TRUE(executor.Stop());
+}
+
+
+/*
+ * Check WhenAll().
+ */
+void FutureTest::testWhenAll() {
+  vector<Future<int> > futures;
+  for (unsigned int i = 0; i < 3; i++) {
+    futures.push_back(Future<int>());
+  }
+  Future<vector<int> > all = WhenAll(futures);
+  futures[2].Set(3);
+  futures[0].Set(1);
+  OLA_ASSERT_FALSE(all.IsComplete());
+
+  AdderThread thread(1, 1, &futures[1]);
+  OLA_ASSERT_TRUE(thread.Start());
+  const vector<int> &values = all.Get();
+  OLA_ASSERT_TRUE(thread.Join());
+  OLA_ASSERT_EQ(static_cast<size_t>(3), values.size());
+  OLA_ASSERT_EQ(1, values[0]);
+  OLA_ASSERT_EQ(2, values[1]);
+  OLA_ASSERT_EQ(3, values[2]);
+
+  vector<Future<void> > void_futures;
+  for (unsigned int i = 0; i < 2; i++) {
+    void_futures.push_back(Future<void>());
+  }
+  Future<void> all_void = WhenAll(void_futures);
+  void_futures[0].Set();
+  OLA_ASSERT_FALSE(all_void.IsComplete());
+  void_futures[1].Set();
+  OLA_ASSERT_TRUE(all_void.IsComplete());
+
+  // No futures completes straight away.
+  OLA_ASSERT_TRUE(WhenAll(vector<Future<int> >()).IsComplete());
+  OLA_ASSERT_TRUE(WhenAll(vector<Future<void> >()).IsComplete());
+}
+
+
+/*
+ * Check the state for WhenAll() is freed if a future is destroyed without
+ * being set.
+ */
+void FutureTest::testWhenAllAbandoned() {
+  {
+    vector<Future<Counted> > futures;
+    for (unsigned int i = 0; i < 2; i++) {
+      futures.push_back(Future<Counted>());
+    }
+    Future<vector<Counted> > all = WhenAll(futures);
+    futures[0].Set(Counted());
+    futures.clear();
+    OLA_ASSERT_FALSE(all.IsComplete());
+  }
+  OLA_ASSERT_EQ(0, Counted::live);
+
+  Future<void> all_void;
+  {
+    vector<Future<void> > void_futures;
+    for (unsigned int i = 0; i < 2; i++) {
+      void_futures.push_back(Future<void>());
+    }
+    all_void = WhenAll(void_futures);
+    void_futures[1].Set();
+  }
+  OLA_ASSERT_FALSE(all_void.IsComplete());
+}
+
+
+/*
+ * Check a continuation can drop the last reference to the future while the
+ * later continuations still need the value.
+ */
+void FutureTest::testDropReferenceInContinuation() {
+  Future<int> *future = new Future<int>();
+  int value = 0;
+  future->Then(NULL, NewSingleCallback(&DeleteFuture, future));
+  future->Then(NULL, NewSingleCallback(&StoreValue, &value));
+  future->Set(5);
+  OLA_ASSERT_EQ(5, value);
+}
+
+
+/*
+ * Check WhenAny().
+ */
+void FutureTest::testWhenAny() {
+  vector<Future<int> > futures;
+  for (unsigned int i = 0; i < 3; i++) {
+    futures.push_back(Future<int>());
+  }
+  Future<unsigned int> any = WhenAny(futures);
+  OLA_ASSERT_FALSE(any.IsComplete());
+  futures[1].Set(5);
+  OLA_ASSERT_EQ(1u, any.Get());
+  futures[0].Set(4);
+  futures[2].Set(6);
+  OLA_ASSERT_EQ(1u, any.Get());
+  OLA_ASSERT_EQ(5, futures[any.Get()].Get());
+
+  vector<Future<void> > void_futures;
+  for (unsigned int i = 0; i < 2; i++) {
+    void_futures.push_back(Future<void>());
+  }
+  Future<unsigned int> any_void = WhenAny(void_futures);
+  void_futures[1].Set();
+  OLA_ASSERT_EQ(1u, any_void.Get());
+  void_futures[0].Set();
+}
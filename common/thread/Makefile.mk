@@ -3,12 +3,25 @@
 common_libolacommon_la_SOURCES += \
     common/thread/ConsumerThread.cpp \
     common/thread/ExecutorThread.cpp \
+    common/thread/FramePacer.cpp \
     common/thread/Mutex.cpp \
     common/thread/PeriodicThread.cpp \
     common/thread/SignalThread.cpp \
     common/thread/Thread.cpp \
     common/thread/ThreadPool.cpp \
-    common/thread/Utils.cpp
+    common/thread/Utils.cpp \
+    common/thread/WorkStealingExecutor.cpp
+
+# TESTS_DATA
+##################################################
+
+EXTRA_DIST += \
+    common/thread/testdata/net/eth0/device/numa_node \
+    common/thread/testdata/net/eth1/device/numa_node \
+    common/thread/testdata/node/node0/cpulist \
+    common/thread/testdata/node/node1/cpulist \
+    common/thread/testdata/node/node2/cpulist \
+    common/thread/testdata/node/online
 
 # TESTS
 ##################################################
@@ -17,8 +30,12 @@ test_programs += common/thread/ExecutorThreadTester \
                  common/thread/FutureTester
 
 common_thread_ThreadTester_SOURCES = \
+    common/thread/FramePacerTest.cpp \
+    common/thread/SPSCQueueTest.cpp \
     common/thread/ThreadPoolTest.cpp \
-    common/thread/ThreadTest.cpp
+    common/thread/ThreadTest.cpp \
+    common/thread/TripleBufferTest.cpp \
+    common/thread/WorkStealingExecutorTest.cpp
 common_thread_ThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_thread_ThreadTester_LDADD = $(COMMON_TESTING_LIBS)
 
@@ -0,0 +1,137 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ * SPSCQueueTest.cpp
+ * Test fixture for the SPSCQueue class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Logging.h"
+#include "ola/thread/SPSCQueue.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::SPSCQueue;
+using ola::thread::Thread;
+
+namespace {
+
+// Pushes the integers from 0 to count - 1 onto the queue.
+class ProducerThread: public Thread {
+ public:
+  ProducerThread(SPSCQueue<unsigned int> *queue, unsigned int count)
+      : Thread(Thread::Options("ProducerThread")),
+        m_queue(queue),
+        m_count(count) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < m_count;) {
+      unsigned int *slot = m_queue->Reserve();
+      if (slot) {
+        *slot = i++;
+        m_queue->Commit();
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  SPSCQueue<unsigned int> *m_queue;
+  const unsigned int m_count;
+};
+}  // namespace
+
+
+class SPSCQueueTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPSCQueueTest);
+  CPPUNIT_TEST(testQueue);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testQueue();
+  void testThreads();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPSCQueueTest);
+
+
+/*
+ * Check the queue from a single thread.
+ */
+void SPSCQueueTest::testQueue() {
+  SPSCQueue<unsigned int> queue(3);
+  OLA_ASSERT_EQ(3u, queue.Capacity());
+  OLA_ASSERT_EQ(0u, queue.Size());
+  OLA_ASSERT_NULL(queue.Peek());
+
+  // Go around the ring a few times.
+  for (unsigned int i = 0; i < 5; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      unsigned int *slot = queue.Reserve();
+      OLA_ASSERT_NOT_NULL(slot);
+      *slot = i * 10 + j;
+      queue.Commit();
+    }
+    OLA_ASSERT_NULL(queue.Reserve());
+    OLA_ASSERT_EQ(3u, queue.Size());
+
+    for (unsigned int j = 0; j < 3; j++) {
+      const unsigned int *value = queue.Peek();
+      OLA_ASSERT_NOT_NULL(value);
+      OLA_ASSERT_EQ(i * 10 + j, *value);
+      queue.Pop();
+      OLA_ASSERT_EQ(2 - j, queue.Size());
+    }
+    OLA_ASSERT_NULL(queue.Peek());
+  }
+
+  // A reserved slot isn't visible until it's committed.
+  *queue.Reserve() = 99;
+  OLA_ASSERT_NULL(queue.Peek());
+  queue.Commit();
+  OLA_ASSERT_EQ(99u, *queue.Peek());
+}
+
+
+/*
+ * Check the elements arrive in order when passed between threads.
+ */
+void SPSCQueueTest::testThreads() {
+  const unsigned int COUNT = 100000;
+  SPSCQueue<unsigned int> queue(16);
+  ProducerThread producer(&queue, COUNT);
+  OLA_ASSERT_TRUE(producer.Start());
+
+  // Don't assert until the producer has finished, otherwise it would spin
+  // forever.
+  unsigned int expected = 0;
+  bool in_order = true;
+  while (expected < COUNT) {
+    const unsigned int *value = queue.Peek();
+    if (value) {
+      in_order &= (*value == expected);
+      expected++;
+      queue.Pop();
+    }
+  }
+  OLA_ASSERT_TRUE(producer.Join());
+  OLA_ASSERT_TRUE(in_order);
+  OLA_ASSERT_NULL(queue.Peek());
+}
@@ -191,8 +191,14 @@ void *Thread::_InternalRun() {
   struct sched_param param;
   pthread_getschedparam(pthread_self(), &policy, &param);
 
+  if (!m_options.cpu_affinity.empty()) {
+    SetThreadAffinity(pthread_self(), m_options.cpu_affinity);
+  }
+
   OLA_INFO << "Thread " << Name() << ", policy " << PolicyToString(policy)
-           << ", priority " << param.sched_priority;
+           << ", priority " << param.sched_priority
+           << (m_options.cpu_affinity.empty() ? "" : ", CPUs ")
+           << CPUListToString(m_options.cpu_affinity);
   {
     MutexLocker locker(&m_mutex);
     m_running = true;
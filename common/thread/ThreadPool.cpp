@@ -19,9 +19,8 @@
  */
 
 #include "ola/Logging.h"
-#include "ola/thread/Thread.h"
 #include "ola/thread/ThreadPool.h"
-#include "ola/thread/ConsumerThread.h"
+#include "ola/thread/WorkStealingExecutor.h"
 
 namespace ola {
 namespace thread {
@@ -31,7 +30,7 @@ namespace thread {
  * Clean up
  */
 ThreadPool::~ThreadPool() {
-  JoinAllThreads();
+  JoinAll();
 }
 
 
@@ -39,72 +38,37 @@ ThreadPool::~ThreadPool() {
  * Start the threads
  */
 bool ThreadPool::Init() {
-  if (!m_threads.empty()) {
-    OLA_WARN << "Thread pool already started";
+  if (!m_executor.Start()) {
+    OLA_WARN << "Thread pool already started, or a thread failed to start";
     return false;
   }
-
-  for (unsigned int i = 1 ; i <= m_thread_count; i++) {
-    ConsumerThread *thread = new ConsumerThread(
-        &m_callback_queue,
-        &m_shutdown,
-        &m_mutex,
-        &m_condition_var);
-    if (!thread->Start()) {
-      OLA_WARN << "Failed to start thread " << i
-               << ", aborting ThreadPool::Init()";
-      JoinAllThreads();
-      return false;
-    }
-    m_threads.push_back(thread);
-  }
   return true;
 }
 
 
 /**
- * Join all threads
+ * Join all threads, the remaining actions are run in the calling thread.
  */
 void ThreadPool::JoinAll() {
-  JoinAllThreads();
+  m_executor.Stop();
 }
 
 
 /**
  * Queue the callback.
- * Don't call this after JoinAll() otherwise the closure may not run and will
- * probably leak memory.
  */
 void ThreadPool::Execute(ola::BaseCallback0<void> *closure) {
-  MutexLocker locker(&m_mutex);
-  if (m_shutdown) {
-    OLA_WARN << "Adding actions to a ThreadPool while it's shutting down, "
-                "this will leak!";
-  }
-  m_callback_queue.push(closure);
-  m_condition_var.Signal();
+  m_executor.Execute(closure);
 }
 
 
-/**
- * Join all threads.
- */
-void ThreadPool::JoinAllThreads() {
-  if (m_threads.empty())
-    return;
-
-  {
-    MutexLocker locker(&m_mutex);
-    m_shutdown = true;
-    m_condition_var.Broadcast();
-  }
-
-  while (!m_threads.empty()) {
-    ConsumerThread *thread = m_threads.back();
-    m_threads.pop_back();
-    thread->Join();
-    delete thread;
-  }
+WorkStealingExecutor::Options ThreadPool::ExecutorOptions(
+    unsigned int thread_count) {
+  WorkStealingExecutor::Options options;
+  // 0 would mean one thread per CPU.
+  options.thread_count = thread_count ? thread_count : 1;
+  options.name = "ola-thread-pool";
+  return options;
 }
 }  // namespace thread
 }  // namespace ola
@@ -29,6 +29,8 @@
 #include <sys/resource.h>
 #endif  // _WIN32
 #include <algorithm>
+#include <string>
+#include <vector>
 
 #include "ola/Logging.h"
 #include "ola/system/Limits.h"
@@ -110,12 +112,16 @@ class ThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testThread);
   CPPUNIT_TEST(testSchedulingOptions);
   CPPUNIT_TEST(testConditionVariable);
+  CPPUNIT_TEST(testCPUList);
+  CPPUNIT_TEST(testNumaTopology);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testThread();
   void testConditionVariable();
   void testSchedulingOptions();
+  void testCPUList();
+  void testNumaTopology();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ThreadTest);
@@ -269,3 +275,74 @@ void ThreadTest::testConditionVariable() {
 
   thread.Join();
 }
+
+
+/*
+ * Check the CPU list parsing.
+ */
+void ThreadTest::testCPUList() {
+  using ola::thread::CPUListToString;
+  using ola::thread::ParseCPUList;
+  std::vector<unsigned int> cpus;
+
+  OLA_ASSERT_TRUE(ParseCPUList("", &cpus));
+  OLA_ASSERT_TRUE(cpus.empty());
+  OLA_ASSERT_TRUE(ParseCPUList("-1", &cpus));
+  OLA_ASSERT_TRUE(cpus.empty());
+
+  OLA_ASSERT_TRUE(ParseCPUList("3", &cpus));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), cpus.size());
+  OLA_ASSERT_EQ(3u, cpus[0]);
+
+  OLA_ASSERT_TRUE(ParseCPUList("5,0,2-3,3", &cpus));
+  OLA_ASSERT_EQ(static_cast<size_t>(4), cpus.size());
+  OLA_ASSERT_EQ(0u, cpus[0]);
+  OLA_ASSERT_EQ(2u, cpus[1]);
+  OLA_ASSERT_EQ(3u, cpus[2]);
+  OLA_ASSERT_EQ(5u, cpus[3]);
+  OLA_ASSERT_EQ(std::string("0,2-3,5"), CPUListToString(cpus));
+
+  OLA_ASSERT_FALSE(ParseCPUList("a", &cpus));
+  OLA_ASSERT_FALSE(ParseCPUList("1,", &cpus));
+  OLA_ASSERT_FALSE(ParseCPUList("3-2", &cpus));
+  OLA_ASSERT_FALSE(ParseCPUList("1-", &cpus));
+  OLA_ASSERT_FALSE(ParseCPUList("1024", &cpus));
+
+  // An affinity in the options shouldn't stop the thread from running, even
+  // if it can't be applied.
+  Thread::Options options("affinity");
+  options.cpu_affinity.push_back(0);
+  MockThread thread(options);
+  OLA_ASSERT_TRUE(RunThread(&thread));
+}
+
+
+/*
+ * Check the NUMA topology is read from sysfs.
+ */
+void ThreadTest::testNumaTopology() {
+  using ola::thread::CPUListToString;
+  using ola::thread::GetInterfaceNumaNode;
+  using ola::thread::GetNumaNodes;
+  using ola::thread::NumaNodeMap;
+  const std::string testdata = std::string(TEST_SRC_DIR) +
+      "/common/thread/testdata";
+
+  // Node 2 has memory but no CPUs.
+  NumaNodeMap nodes;
+  OLA_ASSERT_TRUE(GetNumaNodes(&nodes, testdata + "/node"));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), nodes.size());
+  OLA_ASSERT_EQ(std::string("0-3,8-11"), CPUListToString(nodes[0]));
+  OLA_ASSERT_EQ(std::string("4-7"), CPUListToString(nodes[1]));
+  OLA_ASSERT_FALSE(GetNumaNodes(&nodes, testdata + "/missing"));
+  OLA_ASSERT_TRUE(nodes.empty());
+
+  // eth1 is on a host with a single node, and lo doesn't have a device.
+  unsigned int node = 0;
+  OLA_ASSERT_TRUE(GetInterfaceNumaNode("eth0", &node, testdata + "/net"));
+  OLA_ASSERT_EQ(1u, node);
+  OLA_ASSERT_FALSE(GetInterfaceNumaNode("eth1", &node, testdata + "/net"));
+  OLA_ASSERT_FALSE(GetInterfaceNumaNode("lo", &node, testdata + "/net"));
+  OLA_ASSERT_FALSE(GetInterfaceNumaNode("../net/eth0", &node,
+                                        testdata + "/net"));
+}
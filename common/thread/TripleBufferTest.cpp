@@ -0,0 +1,137 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ * TripleBufferTest.cpp
+ * Test fixture for the TripleBuffer class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::thread::Thread;
+using ola::thread::TripleBuffer;
+
+namespace {
+
+// The two halves are always written with the same value, so a torn read
+// shows up as a mismatch.
+struct Frame {
+  unsigned int first;
+  unsigned int second;
+};
+
+// Publishes the frames from 1 to count.
+class ProducerThread: public Thread {
+ public:
+  ProducerThread(TripleBuffer<Frame> *buffer, unsigned int count)
+      : Thread(Thread::Options("ProducerThread")),
+        m_buffer(buffer),
+        m_count(count) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 1; i <= m_count; i++) {
+      Frame *frame = m_buffer->WriteBuffer();
+      frame->first = i;
+      frame->second = i;
+      m_buffer->Publish();
+    }
+    return NULL;
+  }
+
+ private:
+  TripleBuffer<Frame> *m_buffer;
+  const unsigned int m_count;
+};
+}  // namespace
+
+
+class TripleBufferTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TripleBufferTest);
+  CPPUNIT_TEST(testBuffer);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testBuffer();
+  void testThreads();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TripleBufferTest);
+
+
+/*
+ * Check the buffer from a single thread.
+ */
+void TripleBufferTest::testBuffer() {
+  TripleBuffer<unsigned int> buffer;
+  OLA_ASSERT_FALSE(buffer.Update());
+
+  *buffer.WriteBuffer() = 1;
+  // Nothing is visible until it's published.
+  OLA_ASSERT_FALSE(buffer.Update());
+  buffer.Publish();
+  OLA_ASSERT_TRUE(buffer.Update());
+  OLA_ASSERT_EQ(1u, buffer.ReadBuffer());
+  OLA_ASSERT_FALSE(buffer.Update());
+  OLA_ASSERT_EQ(1u, buffer.ReadBuffer());
+
+  // The newest value wins.
+  for (unsigned int i = 2; i < 6; i++) {
+    *buffer.WriteBuffer() = i;
+    buffer.Publish();
+  }
+  OLA_ASSERT_EQ(1u, buffer.ReadBuffer());
+  OLA_ASSERT_TRUE(buffer.Update());
+  OLA_ASSERT_EQ(5u, buffer.ReadBuffer());
+  OLA_ASSERT_FALSE(buffer.Update());
+
+  // The producer never gets the buffer the consumer is reading.
+  *buffer.WriteBuffer() = 6;
+  buffer.Publish();
+  *buffer.WriteBuffer() = 7;
+  OLA_ASSERT_EQ(5u, buffer.ReadBuffer());
+  OLA_ASSERT_TRUE(buffer.Update());
+  OLA_ASSERT_EQ(6u, buffer.ReadBuffer());
+}
+
+
+/*
+ * Check the frames aren't torn or reordered when passed between threads.
+ */
+void TripleBufferTest::testThreads() {
+  const unsigned int COUNT = 100000;
+  TripleBuffer<Frame> buffer;
+  ProducerThread producer(&buffer, COUNT);
+  OLA_ASSERT_TRUE(producer.Start());
+
+  unsigned int last = 0;
+  bool consistent = true;
+  while (last < COUNT) {
+    if (buffer.Update()) {
+      const Frame &frame = buffer.ReadBuffer();
+      consistent &= (frame.first == frame.second && frame.first > last);
+      last = frame.first;
+    }
+  }
+  OLA_ASSERT_TRUE(producer.Join());
+  OLA_ASSERT_TRUE(consistent);
+  OLA_ASSERT_EQ(COUNT, last);
+}
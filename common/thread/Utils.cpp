@@ -18,17 +18,52 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include "ola/thread/Utils.h"
 
+#include <errno.h>
 #include <pthread.h>
 #include <string.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
+
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
 namespace thread {
 
+namespace {
+// Matches the CPU preferences the plugins accept.
+const unsigned int MAX_CPUS = 1024;
+// The number of nodes in the mask passed to set_mempolicy().
+const unsigned int MAX_NUMA_NODES = 1024;
+
+/*
+ * Read the first line of a sysfs file.
+ */
+bool ReadSysfsLine(const std::string &path, std::string *line) {
+  std::ifstream file(path.c_str());
+  if (!file.is_open() || !std::getline(file, *line)) {
+    return false;
+  }
+  StringTrim(line);
+  return true;
+}
+}  // namespace
+
 std::string PolicyToString(int policy) {
   switch (policy) {
     case SCHED_FIFO:
@@ -56,5 +91,191 @@ bool SetSchedParam(pthread_t thread, int policy,
   }
   return true;
 }
+
+bool SetThreadAffinity(pthread_t thread, unsigned int cpu) {
+  return SetThreadAffinity(thread, std::vector<unsigned int>(1, cpu));
+}
+
+bool SetThreadAffinity(pthread_t thread,
+                       const std::vector<unsigned int> &cpus) {
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  std::vector<unsigned int>::const_iterator iter = cpus.begin();
+  for (; iter != cpus.end(); ++iter) {
+    if (*iter >= CPU_SETSIZE) {
+      OLA_WARN << "CPU " << *iter << " is out of range";
+      return false;
+    }
+    CPU_SET(*iter, &cpu_set);
+  }
+  int r = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+  if (r != 0) {
+    OLA_WARN << "Unable to set the CPU affinity to " << CPUListToString(cpus)
+             << ": " << strerror(r);
+    return false;
+  }
+  return true;
+#else
+  OLA_WARN << "CPU affinity isn't supported on this platform, can't use CPUs "
+           << CPUListToString(cpus);
+  (void) thread;
+  return false;
+#endif  // HAVE_PTHREAD_SETAFFINITY_NP
+}
+
+bool ParseCPUList(const std::string &list, std::vector<unsigned int> *cpus) {
+  cpus->clear();
+  if (list.empty() || list == "-1") {
+    return true;
+  }
+
+  std::vector<unsigned int> parsed;
+  std::vector<std::string> ranges;
+  StringSplit(list, &ranges, ",");
+  std::vector<std::string>::const_iterator iter = ranges.begin();
+  for (; iter != ranges.end(); ++iter) {
+    const std::string::size_type dash = iter->find('-');
+    unsigned int first, last;
+    if (dash == std::string::npos) {
+      if (!StringToInt(*iter, &first, true)) {
+        return false;
+      }
+      last = first;
+    } else if (!StringToInt(iter->substr(0, dash), &first, true) ||
+               !StringToInt(iter->substr(dash + 1), &last, true) ||
+               last < first) {
+      return false;
+    }
+    if (last >= MAX_CPUS) {
+      return false;
+    }
+    for (unsigned int cpu = first; cpu <= last; cpu++) {
+      parsed.push_back(cpu);
+    }
+  }
+  std::sort(parsed.begin(), parsed.end());
+  parsed.erase(std::unique(parsed.begin(), parsed.end()), parsed.end());
+  cpus->swap(parsed);
+  return true;
+}
+
+std::string CPUListToString(const std::vector<unsigned int> &cpus) {
+  std::ostringstream str;
+  std::vector<unsigned int>::const_iterator iter = cpus.begin();
+  while (iter != cpus.end()) {
+    std::vector<unsigned int>::const_iterator end = iter + 1;
+    while (end != cpus.end() && *end == *(end - 1) + 1) {
+      ++end;
+    }
+    if (iter != cpus.begin()) {
+      str << ",";
+    }
+    str << *iter;
+    if (end - iter > 1) {
+      str << "-" << *(end - 1);
+    }
+    iter = end;
+  }
+  return str.str();
+}
+
+bool GetNumaNodes(NumaNodeMap *nodes, const std::string &sysfs_path) {
+  nodes->clear();
+  std::string line;
+  std::vector<unsigned int> node_ids;
+  if (!ReadSysfsLine(sysfs_path + "/online", &line) ||
+      !ParseCPUList(line, &node_ids)) {
+    return false;
+  }
+
+  std::vector<unsigned int>::const_iterator iter = node_ids.begin();
+  for (; iter != node_ids.end(); ++iter) {
+    std::vector<unsigned int> cpus;
+    const std::string path = sysfs_path + "/node" + IntToString(*iter) +
+        "/cpulist";
+    if (ReadSysfsLine(path, &line) && ParseCPUList(line, &cpus) &&
+        !cpus.empty()) {
+      (*nodes)[*iter] = cpus;
+    }
+  }
+  return !nodes->empty();
+}
+
+bool GetInterfaceNumaNode(const std::string &interface_name,
+                          unsigned int *node,
+                          const std::string &sysfs_path) {
+  if (interface_name.empty() ||
+      interface_name.find('/') != std::string::npos) {
+    return false;
+  }
+
+  // Virtual interfaces don't have a device, and devices report -1 on hosts
+  // with a single node.
+  std::string line;
+  int value;
+  if (!ReadSysfsLine(sysfs_path + "/" + interface_name + "/device/numa_node",
+                     &line) ||
+      !StringToInt(line, &value, true) || value < 0) {
+    return false;
+  }
+  *node = value;
+  return true;
+}
+
+bool SetMemoryNode(unsigned int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  // MPOL_PREFERRED, linux/mempolicy.h isn't always installed.
+  const int preferred_policy = 1;
+  const unsigned int bits_per_word = sizeof(unsigned long) * 8;  // NOLINT
+  if (node >= MAX_NUMA_NODES) {
+    OLA_WARN << "NUMA node " << node << " is out of range";
+    return false;
+  }
+
+  unsigned long mask[MAX_NUMA_NODES / bits_per_word];  // NOLINT
+  memset(mask, 0, sizeof(mask));
+  mask[node / bits_per_word] = 1ul << (node % bits_per_word);
+  // The kernel ignores the last bit of maxnode.
+  if (syscall(SYS_set_mempolicy, preferred_policy, mask,
+              MAX_NUMA_NODES + 1) != 0) {
+    OLA_WARN << "Unable to prefer memory from NUMA node " << node << ": "
+             << strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  OLA_WARN << "NUMA memory placement isn't supported on this platform, can't "
+           << "use node " << node;
+  return false;
+#endif  // defined(__linux__) && defined(SYS_set_mempolicy)
+}
+
+bool ApplySchedulingOptions(const SchedulingOptions &options,
+                            const std::string &description) {
+  bool ok = true;
+  if (options.priority) {
+    struct sched_param param;
+    param.sched_priority = options.priority;
+    if (SetSchedParam(pthread_self(), options.policy, param)) {
+      OLA_INFO << description << " is using " << PolicyToString(options.policy)
+               << ", priority " << options.priority;
+    } else {
+      OLA_WARN << "Continuing with the default scheduling for "
+               << description;
+      ok = false;
+    }
+  }
+
+  if (!options.cpus.empty()) {
+    if (SetThreadAffinity(pthread_self(), options.cpus)) {
+      OLA_INFO << description << " is running on CPUs "
+               << CPUListToString(options.cpus);
+    } else {
+      ok = false;
+    }
+  }
+  return ok;
+}
 }  // namespace thread
 }  // namespace ola
@@ -0,0 +1,477 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingExecutor.cpp
+ * Run callbacks on a pool of threads, with a work stealing queue per thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/thread/Future.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "ola/thread/WorkStealingExecutor.h"
+
+namespace ola {
+namespace thread {
+
+using std::vector;
+
+typedef ola::BaseCallback0<void> Callback;
+
+namespace {
+
+/*
+ * A fixed size Chase-Lev deque. The owning thread pushes and takes from the
+ * bottom without locking, other threads steal from the top with a compare
+ * and swap. See "Correct and Efficient Work-Stealing for Weak Memory Models",
+ * Le et al. 2013.
+ */
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(unsigned int size)
+      : m_mask(RoundUp(size) - 1),
+        m_entries(new Callback*[m_mask + 1]),
+        m_top(0),
+        m_bottom(0) {
+  }
+
+  ~WorkStealingDeque() { delete[] m_entries; }
+
+  /*
+   * Owner only. Returns false if the deque is full.
+   */
+  bool Push(Callback *callback) {
+    const int64_t bottom = __atomic_load_n(&m_bottom, __ATOMIC_RELAXED);
+    const int64_t top = __atomic_load_n(&m_top, __ATOMIC_ACQUIRE);
+    if (bottom - top > static_cast<int64_t>(m_mask)) {
+      return false;
+    }
+    __atomic_store_n(&m_entries[bottom & m_mask], callback, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_bottom, bottom + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /*
+   * Owner only. Returns the newest callback, or NULL if the deque is empty.
+   */
+  Callback *Take() {
+    const int64_t bottom = __atomic_load_n(&m_bottom, __ATOMIC_RELAXED) - 1;
+    // The store must be visible before top is read, seq_cst upholds that
+    // without a standalone fence, which some tools don't understand.
+    __atomic_store_n(&m_bottom, bottom, __ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&m_top, __ATOMIC_SEQ_CST);
+    if (top > bottom) {
+      __atomic_store_n(&m_bottom, bottom + 1, __ATOMIC_RELAXED);
+      return NULL;
+    }
+
+    Callback *callback = __atomic_load_n(&m_entries[bottom & m_mask],
+                                         __ATOMIC_RELAXED);
+    if (top == bottom) {
+      // This is the last entry, race the thieves for it.
+      if (!__atomic_compare_exchange_n(&m_top, &top, top + 1, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        callback = NULL;
+      }
+      __atomic_store_n(&m_bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return callback;
+  }
+
+  /*
+   * Any thread. Returns the oldest callback, or NULL if the deque is empty or
+   * another thread won the race for it.
+   */
+  Callback *Steal() {
+    int64_t top = __atomic_load_n(&m_top, __ATOMIC_SEQ_CST);
+    const int64_t bottom = __atomic_load_n(&m_bottom, __ATOMIC_SEQ_CST);
+    if (top >= bottom) {
+      return NULL;
+    }
+    Callback *callback = __atomic_load_n(&m_entries[top & m_mask],
+                                         __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&m_top, &top, top + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      return NULL;
+    }
+    return callback;
+  }
+
+ private:
+  const int64_t m_mask;
+  Callback **m_entries;
+  int64_t m_top;
+  int64_t m_bottom;
+
+  static unsigned int RoundUp(unsigned int size) {
+    unsigned int rounded = 2;
+    while (rounded < size && rounded < (1u << 24)) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+pthread_key_t worker_key;
+pthread_once_t worker_key_once = PTHREAD_ONCE_INIT;
+
+void CreateWorkerKey() {
+  pthread_key_create(&worker_key, NULL);
+}
+
+unsigned int CPUCount() {
+#ifdef _SC_NPROCESSORS_ONLN
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);  // NOLINT(runtime/int)
+  if (cpus > 0) {
+    return static_cast<unsigned int>(cpus);
+  }
+#endif  // _SC_NPROCESSORS_ONLN
+  return 1;
+}
+}  // namespace
+
+
+/**
+ * @private
+ * A worker thread, with its lock free deque and a locked queue for the
+ * callbacks queued from other threads or that didn't fit in the deque.
+ */
+class WorkStealingExecutor::Worker : public Thread {
+ public:
+  Worker(WorkStealingExecutor *executor, unsigned int index,
+         const WorkStealingExecutor::Options &options)
+      : Thread(Thread::Options(options.name)),
+        executor(executor),
+        index(index),
+        deque(options.queue_size),
+        random_state(index * 2654435761u + 1) {
+  }
+
+  WorkStealingExecutor *executor;
+  const unsigned int index;
+  WorkStealingDeque deque;
+  Mutex inbox_mutex;
+  std::deque<Callback*> inbox;
+  // Only used by this worker, to pick where to steal from.
+  uint32_t random_state;
+
+  void PushInbox(Callback *callback) {
+    MutexLocker locker(&inbox_mutex);
+    inbox.push_back(callback);
+  }
+
+  Callback *PopInbox() {
+    MutexLocker locker(&inbox_mutex);
+    return PopInboxLocked();
+  }
+
+  Callback *TryPopInbox() {
+    if (!inbox_mutex.TryLock()) {
+      return NULL;
+    }
+    Callback *callback = PopInboxLocked();
+    inbox_mutex.Unlock();
+    return callback;
+  }
+
+  uint32_t NextRandom() {
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+  }
+
+ protected:
+  void *Run() {
+    pthread_setspecific(worker_key, this);
+    executor->RunWorker(this);
+    return NULL;
+  }
+
+ private:
+  Callback *PopInboxLocked() {
+    if (inbox.empty()) {
+      return NULL;
+    }
+    Callback *callback = inbox.front();
+    inbox.pop_front();
+    return callback;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+
+WorkStealingExecutor::WorkStealingExecutor(const Options &options)
+    : m_options(options),
+      m_running(false),
+      m_next_worker(0),
+      m_queued(0),
+      m_outstanding(0),
+      m_sleeping(0),
+      m_shutdown(false) {
+  pthread_once(&worker_key_once, CreateWorkerKey);
+  const unsigned int thread_count = (
+      options.thread_count ? options.thread_count : CPUCount());
+  for (unsigned int i = 0; i < thread_count; i++) {
+    m_workers.push_back(new Worker(this, i, m_options));
+  }
+}
+
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  Stop();
+  RunRemaining();
+  vector<Worker*>::iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    delete *iter;
+  }
+}
+
+
+bool WorkStealingExecutor::Start() {
+  if (m_running) {
+    return false;
+  }
+  m_shutdown = false;
+  m_running = true;
+
+  vector<Worker*>::iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    if (!(*iter)->Start()) {
+      OLA_WARN << "Failed to start worker " << (*iter)->index;
+      Stop();
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool WorkStealingExecutor::Stop() {
+  if (!m_running) {
+    return false;
+  }
+
+  {
+    MutexLocker locker(&m_mutex);
+    m_shutdown = true;
+  }
+  m_work_condition.Broadcast();
+
+  vector<Worker*>::iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    if ((*iter)->IsRunning()) {
+      (*iter)->Join();
+    }
+  }
+  m_running = false;
+  RunRemaining();
+  return true;
+}
+
+
+void WorkStealingExecutor::Execute(Callback *callback) {
+  __atomic_add_fetch(&m_outstanding, 1, __ATOMIC_RELAXED);
+  // This is counted before the push, so a worker that takes the callback
+  // straight away doesn't see the count underflow. Paired with the increment
+  // of m_sleeping in WaitForWork(), either the worker sees the new callback,
+  // or we see that it's sleeping.
+  __atomic_add_fetch(&m_queued, 1, __ATOMIC_SEQ_CST);
+
+  Worker *worker = CurrentWorker();
+  if (!worker || !worker->deque.Push(callback)) {
+    if (!worker) {
+      const uint32_t next = __atomic_fetch_add(&m_next_worker, 1,
+                                               __ATOMIC_RELAXED);
+      worker = m_workers[next % m_workers.size()];
+    }
+    worker->PushInbox(callback);
+  }
+  if (__atomic_load_n(&m_sleeping, __ATOMIC_SEQ_CST)) {
+    WakeWorker();
+  }
+}
+
+
+void WorkStealingExecutor::DrainCallbacks() {
+  Worker *worker = CurrentWorker();
+  while (true) {
+    Callback *callback = FindWork(worker);
+    if (callback) {
+      RunCallback(callback);
+      continue;
+    }
+
+    MutexLocker locker(&m_mutex);
+    if (!__atomic_load_n(&m_outstanding, __ATOMIC_ACQUIRE)) {
+      return;
+    }
+    if (!__atomic_load_n(&m_queued, __ATOMIC_ACQUIRE)) {
+      // Everything's been taken, wait for the running callbacks. If they
+      // queue more callbacks we'll be woken to help with those.
+      m_drained_condition.Wait(&m_mutex);
+    }
+  }
+}
+
+
+Future<void> WorkStealingExecutor::Submit(Callback *callback) {
+  Future<void> future;
+  Execute(NewSingleCallback(&WorkStealingExecutor::RunAndSetVoid,
+                            callback, future));
+  return future;
+}
+
+
+WorkStealingExecutor::Worker *WorkStealingExecutor::CurrentWorker() const {
+  Worker *worker = static_cast<Worker*>(pthread_getspecific(worker_key));
+  return (worker && worker->executor == this) ? worker : NULL;
+}
+
+
+/*
+ * Find a callback to run, first from the worker's own queues, then from the
+ * other workers. worker may be NULL if this isn't called from a worker.
+ */
+Callback *WorkStealingExecutor::FindWork(Worker *worker) {
+  Callback *callback = NULL;
+  if (worker) {
+    callback = worker->deque.Take();
+    if (!callback) {
+      callback = worker->PopInbox();
+    }
+  }
+  if (!callback) {
+    callback = Steal(worker);
+  }
+  if (callback) {
+    __atomic_sub_fetch(&m_queued, 1, __ATOMIC_RELAXED);
+  }
+  return callback;
+}
+
+
+Callback *WorkStealingExecutor::Steal(Worker *worker) {
+  if (!__atomic_load_n(&m_queued, __ATOMIC_RELAXED)) {
+    return NULL;
+  }
+
+  const unsigned int count = m_workers.size();
+  const unsigned int start = worker ? worker->NextRandom() % count : 0;
+  for (unsigned int i = 0; i < count; i++) {
+    Worker *victim = m_workers[(start + i) % count];
+    if (victim == worker) {
+      continue;
+    }
+    Callback *callback = victim->deque.Steal();
+    if (!callback) {
+      callback = victim->TryPopInbox();
+    }
+    if (callback) {
+      return callback;
+    }
+  }
+  return NULL;
+}
+
+
+void WorkStealingExecutor::RunCallback(Callback *callback) {
+  callback->Run();
+  if (!__atomic_sub_fetch(&m_outstanding, 1, __ATOMIC_ACQ_REL)) {
+    MutexLocker locker(&m_mutex);
+    m_drained_condition.Broadcast();
+  }
+}
+
+
+void WorkStealingExecutor::WakeWorker() {
+  MutexLocker locker(&m_mutex);
+  m_work_condition.Signal();
+  // Anyone in DrainCallbacks() can help with the new work.
+  m_drained_condition.Broadcast();
+}
+
+
+void WorkStealingExecutor::WaitForWork() {
+  MutexLocker locker(&m_mutex);
+  __atomic_add_fetch(&m_sleeping, 1, __ATOMIC_SEQ_CST);
+  while (!m_shutdown && !__atomic_load_n(&m_queued, __ATOMIC_SEQ_CST)) {
+    m_work_condition.Wait(&m_mutex);
+  }
+  __atomic_sub_fetch(&m_sleeping, 1, __ATOMIC_SEQ_CST);
+}
+
+
+void WorkStealingExecutor::RunWorker(Worker *worker) {
+  while (true) {
+    Callback *callback = FindWork(worker);
+    if (callback) {
+      RunCallback(callback);
+      continue;
+    }
+
+    {
+      MutexLocker locker(&m_mutex);
+      if (m_shutdown) {
+        return;
+      }
+    }
+    if (!__atomic_load_n(&m_queued, __ATOMIC_SEQ_CST)) {
+      WaitForWork();
+    }
+  }
+}
+
+
+/*
+ * Run the callbacks left once the workers have stopped.
+ */
+void WorkStealingExecutor::RunRemaining() {
+  // The callbacks may queue more callbacks.
+  while (__atomic_load_n(&m_queued, __ATOMIC_ACQUIRE)) {
+    vector<Worker*>::iterator iter = m_workers.begin();
+    for (; iter != m_workers.end(); ++iter) {
+      Callback *callback;
+      while ((callback = (*iter)->deque.Steal()) ||
+             (callback = (*iter)->PopInbox())) {
+        __atomic_sub_fetch(&m_queued, 1, __ATOMIC_RELAXED);
+        RunCallback(callback);
+      }
+    }
+  }
+}
+
+
+void WorkStealingExecutor::RunAndSetVoid(Callback *callback,
+                                         Future<void> future) {
+  callback->Run();
+  future.Set();
+}
+}  // namespace thread
+}  // namespace ola
@@ -0,0 +1,168 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingExecutorTest.cpp
+ * Test fixture for the WorkStealingExecutor class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Callback.h"
+#include "ola/thread/Future.h"
+#include "ola/thread/WorkStealingExecutor.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::NewSingleCallback;
+using ola::thread::Future;
+using ola::thread::WorkStealingExecutor;
+
+namespace {
+int Square(int value) {
+  return value * value;
+}
+}  // namespace
+
+
+class WorkStealingExecutorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(WorkStealingExecutorTest);
+  CPPUNIT_TEST(testExecute);
+  CPPUNIT_TEST(testNestedExecute);
+  CPPUNIT_TEST(testSubmit);
+  CPPUNIT_TEST(testStop);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testExecute();
+    void testNestedExecute();
+    void testSubmit();
+    void testStop();
+
+    void setUp() {
+      m_counter = 0;
+      m_executor = NULL;
+    }
+
+ private:
+    unsigned int m_counter;
+    WorkStealingExecutor *m_executor;
+
+    void IncrementCounter() {
+      __atomic_add_fetch(&m_counter, 1, __ATOMIC_RELAXED);
+    }
+
+    void Split(unsigned int depth) {
+      IncrementCounter();
+      if (depth) {
+        m_executor->Execute(
+            NewSingleCallback(this, &WorkStealingExecutorTest::Split,
+                              depth - 1));
+        m_executor->Execute(
+            NewSingleCallback(this, &WorkStealingExecutorTest::Split,
+                              depth - 1));
+      }
+    }
+
+    unsigned int Counter() const {
+      return __atomic_load_n(&m_counter, __ATOMIC_RELAXED);
+    }
+
+    WorkStealingExecutor::Options SmallQueueOptions() {
+      WorkStealingExecutor::Options options;
+      options.thread_count = 4;
+      // Small enough that the nested callbacks overflow the deques.
+      options.queue_size = 16;
+      return options;
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(WorkStealingExecutorTest);
+
+
+/*
+ * Check callbacks queued from another thread are run.
+ */
+void WorkStealingExecutorTest::testExecute() {
+  WorkStealingExecutor executor(SmallQueueOptions());
+  OLA_ASSERT_EQ(4u, executor.ThreadCount());
+  OLA_ASSERT_TRUE(executor.Start());
+  OLA_ASSERT_FALSE(executor.Start());
+
+  for (unsigned int i = 0; i < 1000; i++) {
+    executor.Execute(
+        NewSingleCallback(this, &WorkStealingExecutorTest::IncrementCounter));
+  }
+  executor.DrainCallbacks();
+  OLA_ASSERT_EQ(1000u, Counter());
+  OLA_ASSERT_TRUE(executor.Stop());
+}
+
+
+/*
+ * Check callbacks queued from the workers are run.
+ */
+void WorkStealingExecutorTest::testNestedExecute() {
+  WorkStealingExecutor executor(SmallQueueOptions());
+  m_executor = &executor;
+  OLA_ASSERT_TRUE(executor.Start());
+
+  executor.Execute(
+      NewSingleCallback(this, &WorkStealingExecutorTest::Split, 10u));
+  executor.DrainCallbacks();
+  OLA_ASSERT_EQ(2047u, Counter());
+}
+
+
+/*
+ * Check Submit() sets the Future.
+ */
+void WorkStealingExecutorTest::testSubmit() {
+  WorkStealingExecutor executor(SmallQueueOptions());
+  OLA_ASSERT_TRUE(executor.Start());
+
+  Future<int> result = executor.Submit(NewSingleCallback(Square, 7));
+  OLA_ASSERT_EQ(49, result.Get());
+
+  Future<void> done = executor.Submit(
+      NewSingleCallback(this, &WorkStealingExecutorTest::IncrementCounter));
+  done.Get();
+  OLA_ASSERT_EQ(1u, Counter());
+}
+
+
+/*
+ * Check the remaining callbacks are run when the executor stops, or if it was
+ * never started.
+ */
+void WorkStealingExecutorTest::testStop() {
+  {
+    WorkStealingExecutor executor(SmallQueueOptions());
+    OLA_ASSERT_FALSE(executor.Stop());
+    executor.Execute(
+        NewSingleCallback(this, &WorkStealingExecutorTest::IncrementCounter));
+  }
+  OLA_ASSERT_EQ(1u, Counter());
+
+  WorkStealingExecutor executor(SmallQueueOptions());
+  OLA_ASSERT_TRUE(executor.Start());
+  for (unsigned int i = 0; i < 100; i++) {
+    executor.Execute(
+        NewSingleCallback(this, &WorkStealingExecutorTest::IncrementCounter));
+  }
+  OLA_ASSERT_TRUE(executor.Stop());
+  OLA_ASSERT_EQ(101u, Counter());
+  OLA_ASSERT_FALSE(executor.Stop());
+}
@@ -0,0 +1,113 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackPool.cpp
+ * The allocator used for single use callbacks.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include <new>
+
+#include "ola/CallbackPool.h"
+
+namespace ola {
+
+namespace {
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+struct BlockCache {
+  FreeBlock *head;
+  unsigned int count;
+};
+
+pthread_key_t cache_key;
+pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Called when a thread exits, return the cached blocks to the heap.
+ */
+void DeleteCache(void *data) {
+  BlockCache *cache = static_cast<BlockCache*>(data);
+  while (cache->head) {
+    FreeBlock *next = cache->head->next;
+    ::operator delete(cache->head);
+    cache->head = next;
+  }
+  delete cache;
+}
+
+void CreateCacheKey() {
+  pthread_key_create(&cache_key, DeleteCache);
+}
+
+BlockCache *GetCache() {
+  pthread_once(&cache_key_once, CreateCacheKey);
+  BlockCache *cache = static_cast<BlockCache*>(pthread_getspecific(cache_key));
+  if (!cache) {
+    cache = new BlockCache();
+    cache->head = NULL;
+    cache->count = 0;
+    pthread_setspecific(cache_key, cache);
+  }
+  return cache;
+}
+}  // namespace
+
+void *AllocateSingleUseCallback(size_t size) {
+  if (size > SINGLE_USE_CALLBACK_BLOCK_SIZE) {
+    return ::operator new(size);
+  }
+
+  BlockCache *cache = GetCache();
+  FreeBlock *block = cache->head;
+  if (!block) {
+    return ::operator new(SINGLE_USE_CALLBACK_BLOCK_SIZE);
+  }
+  cache->head = block->next;
+  cache->count--;
+  return block;
+}
+
+void FreeSingleUseCallback(void *ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+
+  if (size > SINGLE_USE_CALLBACK_BLOCK_SIZE) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  BlockCache *cache = GetCache();
+  if (cache->count >= MAX_CACHED_CALLBACK_BLOCKS) {
+    ::operator delete(ptr);
+    return;
+  }
+  FreeBlock *block = static_cast<FreeBlock*>(ptr);
+  block->next = cache->head;
+  cache->head = block;
+  cache->count++;
+}
+
+unsigned int CachedCallbackBlocks() {
+  return GetCache()->count;
+}
+}  // namespace ola
@@ -22,6 +22,7 @@
 #include <string>
 
 #include "ola/Callback.h"
+#include "ola/CallbackPool.h"
 #include "ola/testing/TestUtils.h"
 
 
@@ -34,6 +35,7 @@ class CallbackTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testFunctionCallbacks1);
   CPPUNIT_TEST(testMethodCallbacks1);
   CPPUNIT_TEST(testMethodCallbacks2);
+  CPPUNIT_TEST(testSingleUsePool);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -43,6 +45,7 @@ class CallbackTest: public CppUnit::TestFixture {
     void testMethodCallbacks1();
     void testMethodCallbacks2();
     void testMethodCallbacks4();
+    void testSingleUsePool();
 
     void Method0() {}
     bool BoolMethod0() { return true; }
@@ -95,6 +98,12 @@ class CallbackTest: public CppUnit::TestFixture {
       return true;
     }
 
+    struct LargeArg {
+      char data[ola::SINGLE_USE_CALLBACK_BLOCK_SIZE];
+    };
+
+    void LargeArgMethod(LargeArg) {}
+
     static const unsigned int TEST_INT_VALUE;
     static const int TEST_INT_VALUE2;
     static const char TEST_CHAR_VALUE;
@@ -551,3 +560,48 @@ void CallbackTest::testMethodCallbacks4() {
                          TEST_STRING_VALUE));
   delete c4;
 }
+
+
+/*
+ * Check single use callbacks are allocated from the pool.
+ */
+void CallbackTest::testSingleUsePool() {
+  // Make sure there's a free block in the cache.
+  SingleUseCallback0<void> *callback = NewSingleCallback(
+      this, &CallbackTest::Method0);
+  callback->Run();
+  unsigned int cached = ola::CachedCallbackBlocks();
+  OLA_ASSERT_GT(cached, 0u);
+
+  // The next allocation reuses a cached block, and returns it once run.
+  BaseCallback1<void, unsigned int> *callback1 = NewSingleCallback(
+      this, &CallbackTest::Method1);
+  OLA_ASSERT_EQ(cached - 1, ola::CachedCallbackBlocks());
+  callback1->Run(TEST_INT_VALUE);
+  OLA_ASSERT_EQ(cached, ola::CachedCallbackBlocks());
+
+  // Deleting a callback without running it also returns the block.
+  callback1 = NewSingleCallback(this, &CallbackTest::Method1);
+  delete callback1;
+  OLA_ASSERT_EQ(cached, ola::CachedCallbackBlocks());
+
+  // Callbacks that don't fit in a block don't touch the cache.
+  LargeArg arg;
+  callback = NewSingleCallback(this, &CallbackTest::LargeArgMethod, arg);
+  OLA_ASSERT_EQ(cached, ola::CachedCallbackBlocks());
+  callback->Run();
+  OLA_ASSERT_EQ(cached, ola::CachedCallbackBlocks());
+
+  // Multiple outstanding callbacks each take a block.
+  if (cached < 2)
+    return;
+  SingleUseCallback0<void> *first = NewSingleCallback(
+      this, &CallbackTest::Method0);
+  SingleUseCallback0<void> *second = NewSingleCallback(
+      this, &CallbackTest::Method0);
+  OLA_ASSERT_NE(first, second);
+  OLA_ASSERT_EQ(cached - 2, ola::CachedCallbackBlocks());
+  first->Run();
+  second->Run();
+  OLA_ASSERT_EQ(cached, ola::CachedCallbackBlocks());
+}
@@ -29,6 +29,7 @@
 #include <ola/Clock.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <time.h>
 
 #if HAVE_CONFIG_H
 #include <config.h>
@@ -257,6 +258,34 @@ void Clock::CurrentTime(TimeStamp *timestamp) const {
   *timestamp = tv;
 }
 
+void CoarseClock::CurrentTime(TimeStamp *timestamp) const {
+#ifdef CLOCK_REALTIME_COARSE
+  struct timespec ts;
+  if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0) {
+    struct timeval tv;
+    tv.tv_sec = ts.tv_sec;
+    tv.tv_usec = ts.tv_nsec / 1000;
+    *timestamp = tv;
+    return;
+  }
+#endif  // CLOCK_REALTIME_COARSE
+  Clock::CurrentTime(timestamp);
+}
+
+CachedClock::CachedClock(const Clock *clock)
+    : Clock(),
+      m_clock(clock ? clock : &m_coarse_clock) {
+  Update();
+}
+
+void CachedClock::Update() {
+  m_clock->CurrentTime(&m_now);
+}
+
+void CachedClock::CurrentTime(TimeStamp *timestamp) const {
+  *timestamp = m_now;
+}
+
 void MockClock::AdvanceTime(const TimeInterval &interval) {
   m_offset += interval;
 }
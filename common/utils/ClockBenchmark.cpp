@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ClockBenchmark.cpp
+ * Compares the cost of reading the time from each type of Clock.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include "ola/Clock.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::CachedClock;
+using ola::Clock;
+using ola::CoarseClock;
+using ola::TimeStamp;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+
+namespace {
+
+void ReadClock(BenchmarkState *state, const Clock &clock) {
+  TimeStamp now;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    clock.CurrentTime(&now);
+    DoNotOptimize(now);
+  }
+}
+
+void BenchmarkClock(BenchmarkState *state) {
+  Clock clock;
+  ReadClock(state, clock);
+}
+OLA_BENCHMARK(BenchmarkClock);
+
+void BenchmarkCoarseClock(BenchmarkState *state) {
+  CoarseClock clock;
+  ReadClock(state, clock);
+}
+OLA_BENCHMARK(BenchmarkCoarseClock);
+
+void BenchmarkCachedClock(BenchmarkState *state) {
+  CachedClock clock;
+  ReadClock(state, clock);
+}
+OLA_BENCHMARK(BenchmarkCachedClock);
+}  // namespace
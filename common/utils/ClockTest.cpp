@@ -38,6 +38,8 @@ class ClockTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTimeIntervalMutliplication);
   CPPUNIT_TEST(testClock);
   CPPUNIT_TEST(testMockClock);
+  CPPUNIT_TEST(testCoarseClock);
+  CPPUNIT_TEST(testCachedClock);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -46,12 +48,16 @@ class ClockTest: public CppUnit::TestFixture {
     void testTimeIntervalMutliplication();
     void testClock();
     void testMockClock();
+    void testCoarseClock();
+    void testCachedClock();
 };
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ClockTest);
 
+using ola::CachedClock;
 using ola::Clock;
+using ola::CoarseClock;
 using ola::MockClock;
 using ola::TimeStamp;
 using ola::TimeInterval;
@@ -188,3 +194,47 @@ void ClockTest::testMockClock() {
   OLA_ASSERT_LT(second, third);
   OLA_ASSERT_TRUE(ten_point_five_seconds <= (third - second));
 }
+
+
+/**
+ * test the CoarseClock
+ */
+void ClockTest::testCoarseClock() {
+  Clock clock;
+  CoarseClock coarse_clock;
+
+  TimeStamp precise;
+  TimeStamp coarse;
+  clock.CurrentTime(&precise);
+  coarse_clock.CurrentTime(&coarse);
+  // The coarse time can lag by up to a tick.
+  OLA_ASSERT_TRUE(precise - coarse < TimeInterval(0, 100000));
+  OLA_ASSERT_TRUE(coarse - precise < TimeInterval(0, 100000));
+}
+
+
+/**
+ * test the CachedClock
+ */
+void ClockTest::testCachedClock() {
+  MockClock mock_clock;
+  CachedClock clock(&mock_clock);
+
+  TimeStamp first;
+  clock.CurrentTime(&first);
+  OLA_ASSERT_EQ(first, clock.Now());
+
+  // The time doesn't move until Update() is called.
+  mock_clock.AdvanceTime(1, 0);
+  TimeStamp second;
+  clock.CurrentTime(&second);
+  OLA_ASSERT_EQ(first, second);
+
+  clock.Update();
+  clock.CurrentTime(&second);
+  OLA_ASSERT_TRUE(TimeInterval(1, 0) <= (second - first));
+
+  TimeStamp third = second + TimeInterval(5, 0);
+  clock.Set(third);
+  OLA_ASSERT_EQ(third, clock.Now());
+}
@@ -27,16 +27,38 @@
  * @file DmxBuffer.cpp
  */
 
+#include <ctype.h>
 #include <string.h>
 #include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
+#include "common/utils/DmxFramePool.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 
+// The SSE2 & NEON kernels are selected at compile time, since they are part
+// of the baseline for x86-64 & AArch64. AVX2 isn't, so we check for it at
+// runtime.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define OLA_DMXBUFFER_SSE2 1
+#endif  // defined(__SSE2__)
+
+#if defined(__x86_64__) && (defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define OLA_DMXBUFFER_AVX2 1
+#endif  // defined(__x86_64__) && ...
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OLA_DMXBUFFER_NEON 1
+#endif  // defined(__ARM_NEON) || defined(__ARM_NEON__)
+
 namespace ola {
 
 using std::min;
@@ -44,8 +66,210 @@ using std::max;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * Set each byte in dst to the max of itself & the matching byte in src.
+ */
+typedef void (*MaxMergeFunction)(uint8_t *dst, const uint8_t *src,
+                                 unsigned int length);
+
+void ScalarMaxMerge(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  for (unsigned int i = 0; i < length; i++) {
+    dst[i] = max(dst[i], src[i]);
+  }
+}
+
+#ifdef OLA_DMXBUFFER_SSE2
+void SSE2MaxMerge(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(a, b));
+  }
+  ScalarMaxMerge(dst + i, src + i, length - i);
+}
+#endif  // OLA_DMXBUFFER_SSE2
+
+#ifdef OLA_DMXBUFFER_AVX2
+__attribute__((target("avx2")))
+void AVX2MaxMerge(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i)) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_max_epu8(a, b));
+  }
+  ScalarMaxMerge(dst + i, src + i, length - i);
+}
+#endif  // OLA_DMXBUFFER_AVX2
+
+#ifdef OLA_DMXBUFFER_NEON
+void NeonMaxMerge(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  unsigned int i = 0;
+  for (; i + sizeof(uint8x16_t) <= length; i += sizeof(uint8x16_t)) {
+    vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+  }
+  ScalarMaxMerge(dst + i, src + i, length - i);
+}
+#endif  // OLA_DMXBUFFER_NEON
+
+MaxMergeFunction ChooseMaxMergeFunction() {
+#ifdef OLA_DMXBUFFER_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return AVX2MaxMerge;
+  }
+#endif  // OLA_DMXBUFFER_AVX2
+
+#if defined(OLA_DMXBUFFER_SSE2)
+  return SSE2MaxMerge;
+#elif defined(OLA_DMXBUFFER_NEON)
+  return NeonMaxMerge;
+#else
+  return ScalarMaxMerge;
+#endif  // defined(OLA_DMXBUFFER_SSE2)
+}
+
+void MaxMerge(uint8_t *dst, const uint8_t *src, unsigned int length) {
+  static const MaxMergeFunction merge_function = ChooseMaxMergeFunction();
+  merge_function(dst, src, length);
+}
+
+/*
+ * Return the first index in [start, length) where a and b differ, or length
+ * if they don't.
+ */
+unsigned int FindDifference(const uint8_t *a, const uint8_t *b,
+                            unsigned int start, unsigned int length) {
+  unsigned int i = start;
+#ifdef OLA_DMXBUFFER_SSE2
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    const __m128i equal = _mm_cmpeq_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    const unsigned int differ = ~_mm_movemask_epi8(equal) & 0xffff;
+    if (differ) {
+      return i + __builtin_ctz(differ);
+    }
+  }
+#else
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t x, y;
+    memcpy(&x, a + i, sizeof(x));
+    memcpy(&y, b + i, sizeof(y));
+    if (x != y) {
+      break;
+    }
+  }
+#endif  // OLA_DMXBUFFER_SSE2
+  for (; i < length && a[i] == b[i]; i++) {}
+  return i;
+}
+
+/*
+ * Return the first index in [start, length) where a and b are the same, or
+ * length if there isn't one.
+ */
+unsigned int FindMatch(const uint8_t *a, const uint8_t *b,
+                       unsigned int start, unsigned int length) {
+  unsigned int i = start;
+#ifdef OLA_DMXBUFFER_SSE2
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    const __m128i equal = _mm_cmpeq_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    const unsigned int same = _mm_movemask_epi8(equal);
+    if (same) {
+      return i + __builtin_ctz(same);
+    }
+  }
+#endif  // OLA_DMXBUFFER_SSE2
+  for (; i < length && a[i] != b[i]; i++) {}
+  return i;
+}
+
+/*
+ * Set the bits of dst selected by mask to the bits of src.
+ */
+void MaskedCopy(uint8_t *dst, const uint8_t *src, const uint8_t *mask,
+                unsigned int length) {
+  unsigned int i = 0;
+#ifdef OLA_DMXBUFFER_SSE2
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    const __m128i d = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i s = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + i));
+    const __m128i m = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(mask + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_or_si128(_mm_andnot_si128(m, d), _mm_and_si128(s, m)));
+  }
+#endif  // OLA_DMXBUFFER_SSE2
+  for (; i < length; i++) {
+    dst[i] = static_cast<uint8_t>((dst[i] & ~mask[i]) | (src[i] & mask[i]));
+  }
+}
+
+/*
+ * Compares two frames where the slots from common onwards only exist in the
+ * first one, and so always differ.
+ */
+class FrameComparison {
+ public:
+  FrameComparison(const uint8_t *a, unsigned int a_length,
+                  const uint8_t *b, unsigned int b_length)
+      : m_a(a),
+        m_b(b),
+        m_length(a_length),
+        m_common(min(a_length, b_length)) {
+  }
+
+  // The first slot at or after slot that differs, or the length of a.
+  unsigned int NextDifference(unsigned int slot) const {
+    return slot >= m_common ? slot : FindDifference(m_a, m_b, slot, m_common);
+  }
+
+  // The first slot at or after slot that's the same, or the length of a.
+  unsigned int NextMatch(unsigned int slot) const {
+    if (slot >= m_common) {
+      return m_length;
+    }
+    const unsigned int match = FindMatch(m_a, m_b, slot, m_common);
+    return match == m_common ? m_length : match;
+  }
+
+ private:
+  const uint8_t *m_a;
+  const uint8_t *m_b;
+  const unsigned int m_length;
+  const unsigned int m_common;
+};
+
+/*
+ * Parse a slot value the way atoi() does, values that aren't numbers are 0
+ * and out of range values wrap.
+ */
+uint8_t ParseSlotValue(const char *ptr, const char *end) {
+  while (ptr != end && isspace(static_cast<unsigned char>(*ptr))) {
+    ptr++;
+  }
+  bool negative = false;
+  if (ptr != end && (*ptr == '-' || *ptr == '+')) {
+    negative = *ptr == '-';
+    ptr++;
+  }
+  unsigned int value = 0;
+  ParseUnsigned(ptr, end, &value);
+  return static_cast<uint8_t>(negative ? 0u - value : value);
+}
+}  // namespace
+
 DmxBuffer::DmxBuffer()
-    : m_ref_count(NULL),
+    : m_frame(NULL),
       m_copy_on_write(false),
       m_data(NULL),
       m_length(0) {
@@ -53,19 +277,19 @@ DmxBuffer::DmxBuffer()
 
 
 DmxBuffer::DmxBuffer(const DmxBuffer &other)
-    : m_ref_count(NULL),
+    : m_frame(NULL),
       m_copy_on_write(false),
       m_data(NULL),
       m_length(0) {
 
-  if (other.m_data && other.m_ref_count) {
+  if (other.m_data && other.m_frame) {
     CopyFromOther(other);
   }
 }
 
 
 DmxBuffer::DmxBuffer(const uint8_t *data, unsigned int length)
-    : m_ref_count(0),
+    : m_frame(NULL),
       m_copy_on_write(false),
       m_data(NULL),
       m_length(0) {
@@ -74,7 +298,7 @@ DmxBuffer::DmxBuffer(const uint8_t *data, unsigned int length)
 
 
 DmxBuffer::DmxBuffer(const string &data)
-    : m_ref_count(0),
+    : m_frame(NULL),
       m_copy_on_write(false),
       m_data(NULL),
       m_length(0) {
@@ -110,25 +334,74 @@ bool DmxBuffer::operator!=(const DmxBuffer &other) const {
 }
 
 
+bool DmxBuffer::FirstDifference(const DmxBuffer &other,
+                                unsigned int *slot) const {
+  const unsigned int common = min(m_length, other.m_length);
+  *slot = m_data == other.m_data ? common :
+      FindDifference(m_data, other.m_data, 0, common);
+  return *slot < common || m_length != other.m_length;
+}
+
+
+bool DmxBuffer::Diff(const DmxBuffer &other, vector<SlotRange> *ranges,
+                     unsigned int merge_gap) const {
+  ranges->clear();
+  if (m_data == other.m_data && m_length <= other.m_length) {
+    return false;
+  }
+
+  const FrameComparison comparison(m_data, m_length, other.m_data,
+                                   other.m_length);
+  unsigned int slot = comparison.NextDifference(0);
+  while (slot < m_length) {
+    SlotRange range;
+    range.offset = slot;
+    unsigned int end = comparison.NextMatch(slot);
+    slot = comparison.NextDifference(end);
+    while (slot < m_length && slot - end < merge_gap) {
+      end = comparison.NextMatch(slot);
+      slot = comparison.NextDifference(end);
+    }
+    range.length = end - range.offset;
+    ranges->push_back(range);
+  }
+  return !ranges->empty();
+}
+
+
+uint32_t DmxBuffer::Hash() const {
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < m_length; i++) {
+    hash ^= m_data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
 bool DmxBuffer::HTPMerge(const DmxBuffer &other) {
   if (!m_data) {
     if (!Init())
       return false;
   }
   DuplicateIfNeeded();
+  MergeFrom(other);
+  return true;
+}
 
-  unsigned int other_length = min((unsigned int) DMX_UNIVERSE_SIZE,
-                                  other.m_length);
-  unsigned int merge_length = min(m_length, other.m_length);
 
-  for (unsigned int i = 0; i < merge_length; i++) {
-    m_data[i] = max(m_data[i], other.m_data[i]);
+bool DmxBuffer::HTPMerge(const vector<const DmxBuffer*> &others) {
+  if (!m_data) {
+    if (!Init())
+      return false;
   }
+  DuplicateIfNeeded();
 
-  if (other_length > m_length) {
-    memcpy(m_data + merge_length, other.m_data + merge_length,
-           other_length - merge_length);
-    m_length = other_length;
+  vector<const DmxBuffer*>::const_iterator iter = others.begin();
+  for (; iter != others.end(); ++iter) {
+    if (*iter) {
+      MergeFrom(**iter);
+    }
   }
   return true;
 }
@@ -138,6 +411,10 @@ bool DmxBuffer::Set(const uint8_t *data, unsigned int length) {
   if (!data)
     return false;
 
+  // If we're the last holder of shared data we can reuse the memory rather
+  // than freeing and allocating it again.
+  if (m_copy_on_write && m_frame->ref_count == 1)
+    m_copy_on_write = false;
   if (m_copy_on_write)
     CleanupMemory();
   if (!m_data) {
@@ -162,8 +439,6 @@ bool DmxBuffer::Set(const DmxBuffer &other) {
 
 bool DmxBuffer::SetFromString(const string &input) {
   unsigned int i = 0;
-  vector<string> dmx_values;
-  vector<string>::const_iterator iter;
 
   if (m_copy_on_write)
     CleanupMemory();
@@ -175,10 +450,10 @@ bool DmxBuffer::SetFromString(const string &input) {
     m_length = 0;
     return true;
   }
-  StringSplit(input, &dmx_values, ",");
-  for (iter = dmx_values.begin();
-      iter != dmx_values.end() && i < DMX_UNIVERSE_SIZE; ++iter, ++i) {
-    m_data[i] = atoi(iter->data());
+  StringTokenizer tokenizer(input, ',');
+  const char *token, *token_end;
+  while (i < DMX_UNIVERSE_SIZE && tokenizer.Next(&token, &token_end)) {
+    m_data[i++] = ParseSlotValue(token, token_end);
   }
   m_length = i;
   return true;
@@ -229,6 +504,32 @@ bool DmxBuffer::SetRange(unsigned int offset,
 }
 
 
+bool DmxBuffer::SetRangeMasked(unsigned int offset,
+                               const uint8_t *data,
+                               const uint8_t *mask,
+                               unsigned int length) {
+  if (!data || !mask || offset >= DMX_UNIVERSE_SIZE)
+    return false;
+
+  if (!m_data) {
+    Blackout();
+  }
+
+  if (offset > m_length)
+    return false;
+
+  DuplicateIfNeeded();
+
+  unsigned int copy_length = min(length, DMX_UNIVERSE_SIZE - offset);
+  if (offset + copy_length > m_length) {
+    memset(m_data + m_length, 0, offset + copy_length - m_length);
+  }
+  MaskedCopy(m_data + offset, data, mask, copy_length);
+  m_length = max(m_length, offset + copy_length);
+  return true;
+}
+
+
 void DmxBuffer::SetChannel(unsigned int channel, uint8_t data) {
   if (channel >= DMX_UNIVERSE_SIZE)
     return;
@@ -318,15 +619,22 @@ string DmxBuffer::ToString() const {
     return "";
   }
 
-  // TODO(Peter): Change to the uint8_t version of StringJoin
-  std::ostringstream str;
+  // Each slot is at most 3 digits and a comma.
+  string output;
+  output.reserve(Size() * 4);
+  char digits[ola::strings::MAX_UNSIGNED_DIGITS];
   for (unsigned int i = 0; i < Size(); i++) {
     if (i) {
-      str << ",";
+      output.push_back(',');
     }
-    str << static_cast<int>(m_data[i]);
+    output.append(digits, ola::strings::FormatUnsigned(m_data[i], digits));
   }
-  return str.str();
+  return output;
+}
+
+
+size_t DmxBuffer::PoolMemoryUsage() {
+  return DmxFramePool::Instance()->MemoryUsage();
 }
 
 
@@ -335,10 +643,9 @@ string DmxBuffer::ToString() const {
  * @return true on success, otherwise raises an exception
  */
 bool DmxBuffer::Init() {
-  m_data = new uint8_t[DMX_UNIVERSE_SIZE];
-  m_ref_count = new unsigned int;
+  m_frame = DmxFramePool::Instance()->Allocate();
+  m_data = m_frame->data;
   m_length = 0;
-  *m_ref_count = 1;
   return true;
 }
 
@@ -348,18 +655,18 @@ bool DmxBuffer::Init() {
  * @return true on Duplication, and false it duplication was not needed
  */
 bool DmxBuffer::DuplicateIfNeeded() {
-  if (m_copy_on_write && *m_ref_count == 1) {
+  if (m_copy_on_write && m_frame->ref_count == 1) {
     m_copy_on_write = false;
   }
 
-  if (m_copy_on_write && *m_ref_count > 1) {
-    unsigned int *old_ref_count = m_ref_count;
+  if (m_copy_on_write && m_frame->ref_count > 1) {
+    DmxFrame *old_frame = m_frame;
     uint8_t *original_data = m_data;
     unsigned int length = m_length;
     m_copy_on_write = false;
     if (Init()) {
       Set(original_data, length);
-      (*old_ref_count)--;
+      old_frame->ref_count--;
       return true;
     }
     return false;
@@ -368,16 +675,39 @@ bool DmxBuffer::DuplicateIfNeeded() {
 }
 
 
+/*
+ * HTP merge the data from another buffer into this one.
+ * @pre m_data is not NULL and we're not in copy-on-write mode.
+ */
+void DmxBuffer::MergeFrom(const DmxBuffer &other) {
+  if (!other.m_data) {
+    return;
+  }
+
+  unsigned int other_length = min((unsigned int) DMX_UNIVERSE_SIZE,
+                                  other.m_length);
+  unsigned int merge_length = min(m_length, other_length);
+
+  MaxMerge(m_data, other.m_data, merge_length);
+
+  if (other_length > m_length) {
+    memcpy(m_data + merge_length, other.m_data + merge_length,
+           other_length - merge_length);
+    m_length = other_length;
+  }
+}
+
+
 /*
  * Setup this buffer to point to the data of the other buffer
  * @param other the source buffer
- * @pre other.m_data and other.m_ref_count are not NULL
+ * @pre other.m_data and other.m_frame are not NULL
  */
 void DmxBuffer::CopyFromOther(const DmxBuffer &other) {
   m_copy_on_write = true;
   other.m_copy_on_write = true;
-  m_ref_count = other.m_ref_count;
-  (*m_ref_count)++;
+  m_frame = other.m_frame;
+  m_frame->ref_count++;
   m_data = other.m_data;
   m_length = other.m_length;
 }
@@ -387,14 +717,13 @@ void DmxBuffer::CopyFromOther(const DmxBuffer &other) {
  * Decrement the ref count by one and free the memory if required
  */
 void DmxBuffer::CleanupMemory() {
-  if (m_ref_count && m_data) {
-    (*m_ref_count)--;
-    if (!*m_ref_count) {
-      delete[] m_data;
-      delete m_ref_count;
+  if (m_frame && m_data) {
+    m_frame->ref_count--;
+    if (!m_frame->ref_count) {
+      DmxFramePool::Instance()->Release(m_frame);
     }
     m_data = NULL;
-    m_ref_count = NULL;
+    m_frame = NULL;
     m_length = 0;
   }
 }
@@ -0,0 +1,188 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxBufferBenchmark.cpp
+ * Microbenchmarks for the DmxBuffer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::DmxBuffer;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using std::vector;
+
+namespace {
+
+void FillFrame(uint8_t *data, unsigned int length, uint8_t seed) {
+  for (unsigned int i = 0; i < length; i++) {
+    data[i] = static_cast<uint8_t>(i * 7 + seed);
+  }
+}
+
+void BenchmarkDmxBufferSet(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  DmxBuffer buffer;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    data[0] = static_cast<uint8_t>(i);
+    buffer.Set(data, sizeof(data));
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferSet);
+
+void BenchmarkDmxBufferSetFromBuffer(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  const DmxBuffer source(data, sizeof(data));
+  DmxBuffer buffer;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    buffer.Set(source);
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferSetFromBuffer);
+
+void BenchmarkDmxBufferGet(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  const DmxBuffer buffer(data, sizeof(data));
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    unsigned int length = sizeof(data);
+    buffer.Get(data, &length);
+    DoNotOptimize(data);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferGet);
+
+void BenchmarkDmxBufferGetChannel(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  const DmxBuffer buffer(data, sizeof(data));
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    DoNotOptimize(buffer.Get(i % ola::DMX_UNIVERSE_SIZE));
+  }
+}
+OLA_BENCHMARK(BenchmarkDmxBufferGetChannel);
+
+void BenchmarkDmxBufferSetRange(BenchmarkState *state) {
+  const unsigned int RANGE_SIZE = 64;
+  uint8_t data[RANGE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  DmxBuffer buffer;
+  buffer.Blackout();
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    buffer.SetRange((i * RANGE_SIZE) % ola::DMX_UNIVERSE_SIZE, data,
+                    sizeof(data));
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferSetRange);
+
+void BenchmarkDmxBufferHTPMerge(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  const DmxBuffer other(data, sizeof(data));
+  FillFrame(data, sizeof(data), 128);
+  const DmxBuffer base(data, sizeof(data));
+  DmxBuffer buffer;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    buffer.Set(base);
+    buffer.HTPMerge(other);
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferHTPMerge);
+
+/*
+ * Merge 8 sources at once.
+ */
+void BenchmarkDmxBufferMultiHTPMerge(BenchmarkState *state) {
+  const unsigned int SOURCE_COUNT = 8;
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  vector<DmxBuffer> sources;
+  for (unsigned int i = 0; i < SOURCE_COUNT; i++) {
+    FillFrame(data, sizeof(data), static_cast<uint8_t>(i * 31));
+    sources.push_back(DmxBuffer(data, sizeof(data)));
+  }
+  vector<const DmxBuffer*> others;
+  for (unsigned int i = 1; i < SOURCE_COUNT; i++) {
+    others.push_back(&sources[i]);
+  }
+
+  DmxBuffer buffer;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    buffer.Set(sources[0]);
+    buffer.HTPMerge(others);
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data) * SOURCE_COUNT);
+}
+OLA_BENCHMARK(BenchmarkDmxBufferMultiHTPMerge);
+
+/*
+ * Find the changes between frames where a few slots change, the common case
+ * for a fade on a handful of fixtures.
+ */
+void BenchmarkDmxBufferDiff(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  const DmxBuffer previous(data, sizeof(data));
+  data[10]++;
+  data[11]++;
+  data[200]++;
+  data[400]++;
+  const DmxBuffer frame(data, sizeof(data));
+  vector<DmxBuffer::SlotRange> ranges;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    frame.Diff(previous, &ranges, 4);
+    DoNotOptimize(ranges);
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferDiff);
+
+void BenchmarkDmxBufferHash(BenchmarkState *state) {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  FillFrame(data, sizeof(data), 0);
+  const DmxBuffer buffer(data, sizeof(data));
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    DoNotOptimize(buffer.Hash());
+  }
+  state->SetBytesProcessed(state->Iterations() * sizeof(data));
+}
+OLA_BENCHMARK(BenchmarkDmxBufferHash);
+}  // namespace
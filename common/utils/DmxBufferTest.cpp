@@ -20,7 +20,9 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
@@ -28,8 +30,23 @@
 
 using std::ostringstream;
 using std::string;
+using std::vector;
 using ola::DmxBuffer;
 
+namespace {
+string RangesToString(const vector<DmxBuffer::SlotRange> &ranges) {
+  ostringstream str;
+  vector<DmxBuffer::SlotRange>::const_iterator iter = ranges.begin();
+  for (; iter != ranges.end(); ++iter) {
+    if (iter != ranges.begin()) {
+      str << ",";
+    }
+    str << iter->offset << "+" << iter->length;
+  }
+  return str.str();
+}
+}  // namespace
+
 class DmxBufferTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(DmxBufferTest);
   CPPUNIT_TEST(testBlackout);
@@ -38,12 +55,17 @@ class DmxBufferTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testAssign);
   CPPUNIT_TEST(testCopy);
   CPPUNIT_TEST(testMerge);
+  CPPUNIT_TEST(testMultiMerge);
   CPPUNIT_TEST(testStringToDmx);
   CPPUNIT_TEST(testCopyOnWrite);
   CPPUNIT_TEST(testSetRange);
   CPPUNIT_TEST(testSetRangeToValue);
   CPPUNIT_TEST(testSetChannel);
   CPPUNIT_TEST(testToString);
+  CPPUNIT_TEST(testFirstDifference);
+  CPPUNIT_TEST(testDiff);
+  CPPUNIT_TEST(testHash);
+  CPPUNIT_TEST(testSetRangeMasked);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -53,12 +75,17 @@ class DmxBufferTest: public CppUnit::TestFixture {
     void testStringGetSet();
     void testCopy();
     void testMerge();
+    void testMultiMerge();
     void testStringToDmx();
     void testCopyOnWrite();
     void testSetRange();
     void testSetRangeToValue();
     void testSetChannel();
     void testToString();
+    void testFirstDifference();
+    void testDiff();
+    void testHash();
+    void testSetRangeMasked();
 
  private:
     static const uint8_t TEST_DATA[];
@@ -286,6 +313,70 @@ void DmxBufferTest::testMerge() {
 }
 
 
+/*
+ * Check that merging many buffers at once matches merging them one by one.
+ */
+void DmxBufferTest::testMultiMerge() {
+  DmxBuffer buffer1(TEST_DATA, sizeof(TEST_DATA));
+  DmxBuffer buffer2(TEST_DATA2, sizeof(TEST_DATA2));
+  DmxBuffer buffer3(TEST_DATA3, sizeof(TEST_DATA3));
+  DmxBuffer uninitialized_buffer;
+  DmxBuffer merge_result(MERGE_RESULT2, sizeof(MERGE_RESULT2));
+
+  vector<const DmxBuffer*> buffers;
+  buffers.push_back(&buffer1);
+  buffers.push_back(NULL);
+  buffers.push_back(&uninitialized_buffer);
+  buffers.push_back(&buffer2);
+  buffers.push_back(&buffer3);
+
+  DmxBuffer result;
+  OLA_ASSERT_TRUE(result.HTPMerge(buffers));
+  OLA_ASSERT_TRUE(merge_result == result);
+
+  // The copy-on-write buffer shouldn't be modified.
+  DmxBuffer copy(buffer1);
+  OLA_ASSERT_TRUE(copy.HTPMerge(buffers));
+  OLA_ASSERT_TRUE(merge_result == copy);
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA, sizeof(TEST_DATA), buffer1.GetRaw(),
+                         buffer1.Size());
+
+  // Use lengths that aren't a multiple of the vector width, to make sure we
+  // handle the tail of the buffer correctly.
+  const unsigned int lengths[] = {ola::DMX_UNIVERSE_SIZE, 511, 33, 17, 1};
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+
+  vector<DmxBuffer> sources;
+  for (unsigned int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    for (unsigned int j = 0; j < lengths[i]; j++) {
+      data[j] = (j * 37 + i * 101) & 0xff;
+    }
+    sources.push_back(DmxBuffer(data, lengths[i]));
+  }
+
+  DmxBuffer expected;
+  buffers.clear();
+  for (vector<DmxBuffer>::const_iterator iter = sources.begin();
+       iter != sources.end(); ++iter) {
+    OLA_ASSERT_TRUE(expected.HTPMerge(*iter));
+    buffers.push_back(&(*iter));
+  }
+
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    uint8_t max_value = 0;
+    for (unsigned int j = 0; j < sources.size(); j++) {
+      max_value = std::max(max_value, sources[j].Get(i));
+    }
+    OLA_ASSERT_EQ(max_value, expected.Get(i));
+  }
+
+  result.Reset();
+  OLA_ASSERT_TRUE(result.HTPMerge(buffers));
+  OLA_ASSERT_EQ((unsigned int) ola::DMX_UNIVERSE_SIZE, result.Size());
+  OLA_ASSERT_TRUE(expected == result);
+}
+
+
 /*
  * Run the StringToDmxTest
  * @param input the string to parse
@@ -398,6 +489,18 @@ void DmxBufferTest::testCopyOnWrite() {
   OLA_ASSERT_EQ(expected_change, src_buffer.Get());
   OLA_ASSERT_EQ(initial_data, dest_buffer.Get());
   src_buffer.Set(initial_data);
+
+  // Once the other copies have gone, Set() re-uses the memory.
+  const uint8_t *data_ptr;
+  {
+    DmxBuffer copy(src_buffer);
+    data_ptr = src_buffer.GetRaw();
+    OLA_ASSERT_EQ(data_ptr, copy.GetRaw());
+  }
+  src_buffer.Set(TEST_DATA, sizeof(TEST_DATA));
+  OLA_ASSERT_EQ(data_ptr, src_buffer.GetRaw());
+  OLA_ASSERT_DATA_EQUALS(TEST_DATA, sizeof(TEST_DATA), src_buffer.GetRaw(),
+                         src_buffer.Size());
 }
 
 
@@ -524,3 +627,171 @@ void DmxBufferTest::testToString() {
   str << buffer;
   OLA_ASSERT_EQ(string("1,2,3,4"), str.str());
 }
+
+
+/*
+ * Test FirstDifference()
+ */
+void DmxBufferTest::testFirstDifference() {
+  DmxBuffer empty, buffer, other;
+  unsigned int slot = 99;
+  OLA_ASSERT_FALSE(empty.FirstDifference(empty, &slot));
+  OLA_ASSERT_EQ(0u, slot);
+
+  buffer.Blackout();
+  other.Blackout();
+  OLA_ASSERT_FALSE(buffer.FirstDifference(other, &slot));
+  OLA_ASSERT_EQ(static_cast<unsigned int>(ola::DMX_UNIVERSE_SIZE), slot);
+
+  // Check each position, so both the vector and scalar paths are used.
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    other.Set(buffer);
+    other.SetChannel(i, 1);
+    OLA_ASSERT_TRUE(buffer.FirstDifference(other, &slot));
+    OLA_ASSERT_EQ(i, slot);
+    OLA_ASSERT_TRUE(other.FirstDifference(buffer, &slot));
+    OLA_ASSERT_EQ(i, slot);
+  }
+
+  // Shared data
+  other = buffer;
+  OLA_ASSERT_FALSE(buffer.FirstDifference(other, &slot));
+
+  // Different sizes
+  other.Set(buffer.GetRaw(), 20);
+  OLA_ASSERT_TRUE(buffer.FirstDifference(other, &slot));
+  OLA_ASSERT_EQ(20u, slot);
+  OLA_ASSERT_TRUE(other.FirstDifference(buffer, &slot));
+  OLA_ASSERT_EQ(20u, slot);
+  OLA_ASSERT_TRUE(empty.FirstDifference(other, &slot));
+  OLA_ASSERT_EQ(0u, slot);
+}
+
+
+/*
+ * Test Diff()
+ */
+void DmxBufferTest::testDiff() {
+  DmxBuffer previous, frame;
+  vector<DmxBuffer::SlotRange> ranges;
+  OLA_ASSERT_FALSE(frame.Diff(previous, &ranges));
+  OLA_ASSERT_TRUE(ranges.empty());
+
+  previous.Blackout();
+  frame.Blackout();
+  OLA_ASSERT_FALSE(frame.Diff(previous, &ranges));
+  OLA_ASSERT_TRUE(ranges.empty());
+
+  frame.SetChannel(0, 1);
+  frame.SetChannel(1, 1);
+  frame.SetChannel(5, 1);
+  frame.SetChannel(17, 1);
+  frame.SetChannel(40, 1);
+  frame.SetRangeToValue(100, 7, 50);
+  frame.SetChannel(511, 1);
+  OLA_ASSERT_TRUE(frame.Diff(previous, &ranges));
+  OLA_ASSERT_EQ(string("0+2,5+1,17+1,40+1,100+50,511+1"),
+                RangesToString(ranges));
+
+  // Merge ranges separated by fewer than 4 unchanged slots, 1 -> 5 is 3
+  // unchanged slots.
+  OLA_ASSERT_TRUE(frame.Diff(previous, &ranges, 4));
+  OLA_ASSERT_EQ(string("0+6,17+1,40+1,100+50,511+1"),
+                RangesToString(ranges));
+  OLA_ASSERT_TRUE(frame.Diff(previous, &ranges, 100));
+  OLA_ASSERT_EQ(string("0+150,511+1"), RangesToString(ranges));
+
+  // Slots past the end of the previous frame have all changed, slots past
+  // the end of the new frame are ignored.
+  previous.Set(frame.GetRaw(), 100);
+  OLA_ASSERT_TRUE(frame.Diff(previous, &ranges));
+  OLA_ASSERT_EQ(string("100+412"), RangesToString(ranges));
+  OLA_ASSERT_FALSE(previous.Diff(frame, &ranges));
+  OLA_ASSERT_TRUE(ranges.empty());
+  OLA_ASSERT_TRUE(frame.Diff(DmxBuffer(), &ranges));
+  OLA_ASSERT_EQ(string("0+512"), RangesToString(ranges));
+
+  // A change right before the end of the common slots joins the new slots.
+  previous.SetChannel(99, 9);
+  OLA_ASSERT_TRUE(frame.Diff(previous, &ranges));
+  OLA_ASSERT_EQ(string("99+413"), RangesToString(ranges));
+
+  // Shared data
+  previous = frame;
+  OLA_ASSERT_FALSE(frame.Diff(previous, &ranges));
+}
+
+
+/*
+ * Test Hash()
+ */
+void DmxBufferTest::testHash() {
+  DmxBuffer buffer;
+  OLA_ASSERT_EQ(2166136261u, buffer.Hash());
+
+  buffer.Set(TEST_DATA, sizeof(TEST_DATA));
+  DmxBuffer other(TEST_DATA, sizeof(TEST_DATA));
+  OLA_ASSERT_EQ(buffer.Hash(), other.Hash());
+
+  other.SetChannel(2, 99);
+  OLA_ASSERT_NE(buffer.Hash(), other.Hash());
+  // FNV-1a of "a"
+  buffer.Set(string("a"));
+  OLA_ASSERT_EQ(0xe40c292cu, buffer.Hash());
+}
+
+
+/*
+ * Test SetRangeMasked()
+ */
+void DmxBufferTest::testSetRangeMasked() {
+  uint8_t data[40];
+  uint8_t mask[40];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = 0xaa;
+    mask[i] = i % 2 ? 0xff : 0x0f;
+  }
+
+  DmxBuffer buffer;
+  OLA_ASSERT_FALSE(buffer.SetRangeMasked(0, NULL, mask, sizeof(data)));
+  OLA_ASSERT_FALSE(buffer.SetRangeMasked(0, data, NULL, sizeof(data)));
+  OLA_ASSERT_FALSE(buffer.SetRangeMasked(600, data, mask, sizeof(data)));
+
+  // Setting an uninitialized buffer calls blackout first
+  OLA_ASSERT_TRUE(buffer.SetRangeMasked(2, data, mask, sizeof(data)));
+  OLA_ASSERT_EQ((unsigned int) ola::DMX_UNIVERSE_SIZE, buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), buffer.Get(1));
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i % 2 ? 0xaa : 0x0a),
+                  buffer.Get(i + 2));
+  }
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), buffer.Get(42));
+
+  // Only the masked bits change.
+  buffer.SetRangeToValue(0, 0x55, 100);
+  OLA_ASSERT_TRUE(buffer.SetRangeMasked(0, data, mask, sizeof(data)));
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i % 2 ? 0xaa : 0x5a), buffer.Get(i));
+  }
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0x55), buffer.Get(40));
+
+  // Extending the data, the new slots start at 0.
+  uint8_t full[sizeof(data)];
+  memset(full, 0xff, sizeof(full));
+  buffer.Set(full, 10);
+  OLA_ASSERT_TRUE(buffer.SetRangeMasked(5, data, mask, 20));
+  OLA_ASSERT_EQ(25u, buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xfa), buffer.Get(5));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0x0a), buffer.Get(11));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xaa), buffer.Get(12));
+
+  // Past the end of the valid data fails
+  OLA_ASSERT_FALSE(buffer.SetRangeMasked(30, data, mask, 1));
+
+  // Copy-on-write is respected
+  DmxBuffer copy(buffer);
+  const uint8_t zero = 0;
+  OLA_ASSERT_TRUE(buffer.SetRangeMasked(6, &zero, full, 1));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), buffer.Get(6));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0xaa), copy.Get(6));
+}
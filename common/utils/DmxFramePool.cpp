@@ -0,0 +1,191 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFramePool.cpp
+ * A pool of reference counted DMX frames.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/utils/DmxFramePool.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ola/Logging.h"
+
+namespace ola {
+
+using ola::thread::MutexLocker;
+using std::vector;
+
+const unsigned int DmxFramePool::DEFAULT_SLAB_SIZE;
+const unsigned int DmxFramePool::DEFAULT_THREAD_CACHE_SIZE;
+
+DmxFramePool::DmxFramePool(unsigned int frames_per_slab,
+                           unsigned int thread_cache_size)
+    : m_frames_per_slab(frames_per_slab ? frames_per_slab : 1),
+      m_thread_cache_size(thread_cache_size ? thread_cache_size : 1),
+      m_free_list(NULL),
+      m_free_frames(0) {
+  pthread_key_create(&m_cache_key, DeleteCache);
+}
+
+DmxFramePool::~DmxFramePool() {
+  // After this DeleteCache() won't be called when threads exit.
+  pthread_key_delete(m_cache_key);
+
+  unsigned int free_frames = m_free_frames;
+  ThreadCaches::iterator cache_iter = m_caches.begin();
+  for (; cache_iter != m_caches.end(); ++cache_iter) {
+    free_frames += (*cache_iter)->free_frames;
+    delete *cache_iter;
+  }
+  m_caches.clear();
+
+  if (free_frames != m_slabs.size() * m_frames_per_slab) {
+    OLA_WARN << "DmxFramePool destroyed with "
+             << m_slabs.size() * m_frames_per_slab - free_frames
+             << " frames in use";
+  }
+  vector<DmxFrame*>::iterator iter = m_slabs.begin();
+  for (; iter != m_slabs.end(); ++iter) {
+    delete[] *iter;
+  }
+}
+
+DmxFrame *DmxFramePool::Allocate() {
+  ThreadCache *cache = GetCache();
+  if (!cache->free_list) {
+    FillCache(cache);
+  }
+
+  DmxFrame *frame = cache->free_list;
+  cache->free_list = frame->next_free;
+  cache->free_frames--;
+  frame->next_free = NULL;
+  frame->ref_count = 1;
+  return frame;
+}
+
+void DmxFramePool::Release(DmxFrame *frame) {
+  ThreadCache *cache = GetCache();
+  frame->next_free = cache->free_list;
+  cache->free_list = frame;
+  cache->free_frames++;
+  if (cache->free_frames > m_thread_cache_size) {
+    ReturnFrames(cache, cache->free_frames - m_thread_cache_size / 2);
+  }
+}
+
+unsigned int DmxFramePool::FreeFrames() const {
+  const ThreadCache *cache = CurrentCache();
+  MutexLocker locker(&m_mutex);
+  return m_free_frames + (cache ? cache->free_frames : 0);
+}
+
+unsigned int DmxFramePool::SlabCount() const {
+  MutexLocker locker(&m_mutex);
+  return m_slabs.size();
+}
+
+size_t DmxFramePool::MemoryUsage() const {
+  return SlabCount() * m_frames_per_slab * sizeof(DmxFrame);
+}
+
+DmxFramePool *DmxFramePool::Instance() {
+  static DmxFramePool *pool = new DmxFramePool();
+  return pool;
+}
+
+DmxFramePool::ThreadCache *DmxFramePool::CurrentCache() const {
+  return static_cast<ThreadCache*>(pthread_getspecific(m_cache_key));
+}
+
+DmxFramePool::ThreadCache *DmxFramePool::GetCache() {
+  ThreadCache *cache = CurrentCache();
+  if (!cache) {
+    cache = new ThreadCache();
+    cache->pool = this;
+    cache->free_list = NULL;
+    cache->free_frames = 0;
+    pthread_setspecific(m_cache_key, cache);
+
+    MutexLocker locker(&m_mutex);
+    m_caches.insert(cache);
+  }
+  return cache;
+}
+
+/*
+ * Move half a cache's worth of frames from the shared free list to an empty
+ * cache, adding a slab if the shared list runs out.
+ */
+void DmxFramePool::FillCache(ThreadCache *cache) {
+  MutexLocker locker(&m_mutex);
+  unsigned int count = std::max(m_thread_cache_size / 2, 1u);
+  while (count > 0) {
+    if (!m_free_list) {
+      if (cache->free_list) {
+        break;
+      }
+      DmxFrame *slab = new DmxFrame[m_frames_per_slab];
+      m_slabs.push_back(slab);
+      for (unsigned int i = 0; i < m_frames_per_slab; i++) {
+        slab[i].next_free = m_free_list;
+        m_free_list = &slab[i];
+      }
+      m_free_frames += m_frames_per_slab;
+    }
+
+    DmxFrame *frame = m_free_list;
+    m_free_list = frame->next_free;
+    m_free_frames--;
+    frame->next_free = cache->free_list;
+    cache->free_list = frame;
+    cache->free_frames++;
+    count--;
+  }
+}
+
+/*
+ * Move count frames from a cache to the shared free list.
+ */
+void DmxFramePool::ReturnFrames(ThreadCache *cache, unsigned int count) {
+  MutexLocker locker(&m_mutex);
+  for (; count > 0; count--) {
+    DmxFrame *frame = cache->free_list;
+    cache->free_list = frame->next_free;
+    cache->free_frames--;
+    frame->next_free = m_free_list;
+    m_free_list = frame;
+    m_free_frames++;
+  }
+}
+
+/*
+ * Called when a thread using the pool exits.
+ */
+void DmxFramePool::DeleteCache(void *data) {
+  ThreadCache *cache = static_cast<ThreadCache*>(data);
+  DmxFramePool *pool = cache->pool;
+  pool->ReturnFrames(cache, cache->free_frames);
+
+  MutexLocker locker(&pool->m_mutex);
+  pool->m_caches.erase(cache);
+  delete cache;
+}
+}  // namespace ola
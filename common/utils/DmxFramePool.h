@@ -0,0 +1,149 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFramePool.h
+ * A pool of reference counted DMX frames.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_UTILS_DMXFRAMEPOOL_H_
+#define COMMON_UTILS_DMXFRAMEPOOL_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <ola/Constants.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+
+#include <set>
+#include <vector>
+
+namespace ola {
+
+/**
+ * @brief A DMX frame with an intrusive reference count.
+ *
+ * DmxBuffers that share data point at the same frame.
+ */
+struct DmxFrame {
+  unsigned int ref_count;
+  DmxFrame *next_free;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+};
+
+/**
+ * @class DmxFramePool
+ * @brief A slab allocator for DmxFrames.
+ *
+ * Frames are allocated in slabs and returned to a free list once the last
+ * reference is released, so publishing a universe frame to many ports and
+ * clients doesn't churn the heap. Slabs are held until the pool is destroyed.
+ *
+ * Each thread keeps a small cache of free frames, so Allocate() and Release()
+ * only take the pool's lock to move a batch of frames between the cache and
+ * the shared free list. A thread's cache is returned to the shared list when
+ * the thread exits.
+ *
+ * Allocate() and Release() are thread safe. The reference count itself isn't,
+ * a frame must only be shared between DmxBuffers on the same thread.
+ */
+class DmxFramePool {
+ public:
+  /**
+   * @brief Create a new pool.
+   * @param frames_per_slab the number of frames to allocate at once.
+   * @param thread_cache_size the number of free frames each thread can hold
+   *   before some are returned to the shared free list.
+   */
+  explicit DmxFramePool(
+      unsigned int frames_per_slab = DEFAULT_SLAB_SIZE,
+      unsigned int thread_cache_size = DEFAULT_THREAD_CACHE_SIZE);
+
+  /**
+   * @brief Destructor.
+   *
+   * All frames must have been released.
+   */
+  ~DmxFramePool();
+
+  /**
+   * @brief Get a frame with a reference count of 1.
+   */
+  DmxFrame *Allocate();
+
+  /**
+   * @brief Return a frame to the pool.
+   * @param frame the frame, whose reference count must be 0.
+   */
+  void Release(DmxFrame *frame);
+
+  /**
+   * @brief The number of frames on the shared free list and in the calling
+   *   thread's cache.
+   */
+  unsigned int FreeFrames() const;
+
+  /**
+   * @brief The number of slabs allocated.
+   */
+  unsigned int SlabCount() const;
+
+  /**
+   * @brief The memory held by the slabs, in bytes.
+   */
+  size_t MemoryUsage() const;
+
+  /**
+   * @brief The pool used by DmxBuffer.
+   *
+   * This is never destroyed, since DmxBuffers may be released during static
+   * destruction.
+   */
+  static DmxFramePool *Instance();
+
+  static const unsigned int DEFAULT_SLAB_SIZE = 64;
+  static const unsigned int DEFAULT_THREAD_CACHE_SIZE = 32;
+
+ private:
+  struct ThreadCache {
+    DmxFramePool *pool;
+    DmxFrame *free_list;
+    unsigned int free_frames;
+  };
+
+  typedef std::set<ThreadCache*> ThreadCaches;
+
+  const unsigned int m_frames_per_slab;
+  const unsigned int m_thread_cache_size;
+  pthread_key_t m_cache_key;
+
+  mutable ola::thread::Mutex m_mutex;
+  // Protected by m_mutex.
+  DmxFrame *m_free_list;
+  unsigned int m_free_frames;
+  std::vector<DmxFrame*> m_slabs;
+  ThreadCaches m_caches;
+
+  ThreadCache *CurrentCache() const;
+  ThreadCache *GetCache();
+  void FillCache(ThreadCache *cache);
+  void ReturnFrames(ThreadCache *cache, unsigned int count);
+
+  static void DeleteCache(void *data);
+
+  DISALLOW_COPY_AND_ASSIGN(DmxFramePool);
+};
+}  // namespace ola
+#endif  // COMMON_UTILS_DMXFRAMEPOOL_H_
@@ -0,0 +1,206 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * DmxFramePoolTest.cpp
+ * Test fixture for the DmxFramePool class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+#include "common/utils/DmxFramePool.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
+
+using ola::DmxBuffer;
+using ola::DmxFrame;
+using ola::DmxFramePool;
+
+/*
+ * A thread that allocates and releases frames from a pool.
+ */
+class PoolUserThread : public ola::thread::Thread {
+ public:
+  PoolUserThread(DmxFramePool *pool, unsigned int count)
+      : m_pool(pool),
+        m_count(count),
+        m_free_frames(0) {
+  }
+
+  unsigned int FreeFrames() const { return m_free_frames; }
+
+ protected:
+  void *Run() {
+    DmxFrame *frames[8];
+    for (unsigned int i = 0; i < m_count; i++) {
+      frames[i] = m_pool->Allocate();
+    }
+    for (unsigned int i = 0; i < m_count; i++) {
+      frames[i]->ref_count = 0;
+      m_pool->Release(frames[i]);
+    }
+    m_free_frames = m_pool->FreeFrames();
+    return NULL;
+  }
+
+ private:
+  DmxFramePool *m_pool;
+  const unsigned int m_count;
+  unsigned int m_free_frames;
+};
+
+class DmxFramePoolTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DmxFramePoolTest);
+  CPPUNIT_TEST(testAllocate);
+  CPPUNIT_TEST(testSlabs);
+  CPPUNIT_TEST(testThreadCache);
+  CPPUNIT_TEST(testDmxBufferReuse);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testAllocate();
+    void testSlabs();
+    void testThreadCache();
+    void testDmxBufferReuse();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DmxFramePoolTest);
+
+
+/*
+ * Check frames are reused once released.
+ */
+void DmxFramePoolTest::testAllocate() {
+  DmxFramePool pool(4);
+  OLA_ASSERT_EQ(0u, pool.SlabCount());
+
+  DmxFrame *frame = pool.Allocate();
+  OLA_ASSERT_NOT_NULL(frame);
+  OLA_ASSERT_EQ(1u, frame->ref_count);
+  OLA_ASSERT_EQ(1u, pool.SlabCount());
+  OLA_ASSERT_EQ(3u, pool.FreeFrames());
+  OLA_ASSERT_EQ(4 * sizeof(DmxFrame), pool.MemoryUsage());
+
+  frame->ref_count = 0;
+  pool.Release(frame);
+  OLA_ASSERT_EQ(4u, pool.FreeFrames());
+  OLA_ASSERT_EQ(frame, pool.Allocate());
+  frame->ref_count = 0;
+  pool.Release(frame);
+}
+
+
+/*
+ * Check a new slab is only added once the free list is empty.
+ */
+void DmxFramePoolTest::testSlabs() {
+  DmxFramePool pool(2);
+  DmxFrame *frames[5];
+  for (unsigned int i = 0; i < 5; i++) {
+    frames[i] = pool.Allocate();
+    memset(frames[i]->data, i, sizeof(frames[i]->data));
+  }
+  OLA_ASSERT_EQ(3u, pool.SlabCount());
+  OLA_ASSERT_EQ(1u, pool.FreeFrames());
+
+  // Frames don't overlap.
+  for (unsigned int i = 0; i < 5; i++) {
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i), frames[i]->data[0]);
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i),
+                  frames[i]->data[ola::DMX_UNIVERSE_SIZE - 1]);
+  }
+
+  for (unsigned int i = 0; i < 5; i++) {
+    frames[i]->ref_count = 0;
+    pool.Release(frames[i]);
+  }
+  OLA_ASSERT_EQ(6u, pool.FreeFrames());
+  OLA_ASSERT_EQ(3u, pool.SlabCount());
+}
+
+
+/*
+ * Check frames move between the thread caches and the shared free list.
+ */
+void DmxFramePoolTest::testThreadCache() {
+  DmxFramePool pool(8, 4);
+  DmxFrame *frames[8];
+  for (unsigned int i = 0; i < 8; i++) {
+    frames[i] = pool.Allocate();
+  }
+  OLA_ASSERT_EQ(1u, pool.SlabCount());
+  OLA_ASSERT_EQ(0u, pool.FreeFrames());
+
+  // Once the cache is over 4 frames, all but 2 go back to the shared list.
+  for (unsigned int i = 0; i < 5; i++) {
+    frames[i]->ref_count = 0;
+    pool.Release(frames[i]);
+  }
+  OLA_ASSERT_EQ(5u, pool.FreeFrames());
+
+  // Another thread takes frames from the shared list, rather than allocating
+  // a new slab. Its cache goes back to the pool when it exits.
+  PoolUserThread thread(&pool, 3);
+  OLA_ASSERT_TRUE(thread.Start());
+  OLA_ASSERT_TRUE(thread.Join());
+  OLA_ASSERT_EQ(3u, thread.FreeFrames());
+  OLA_ASSERT_EQ(1u, pool.SlabCount());
+  OLA_ASSERT_EQ(5u, pool.FreeFrames());
+
+  for (unsigned int i = 5; i < 8; i++) {
+    frames[i]->ref_count = 0;
+    pool.Release(frames[i]);
+  }
+  OLA_ASSERT_EQ(8u, pool.FreeFrames());
+}
+
+
+/*
+ * Check DmxBuffers share a frame, and return it to the pool when the last
+ * reference goes away.
+ */
+void DmxFramePoolTest::testDmxBufferReuse() {
+  const uint8_t data[] = {1, 2, 3, 4};
+  DmxFramePool *pool = DmxFramePool::Instance();
+
+  const uint8_t *raw;
+  unsigned int free_frames;
+  {
+    DmxBuffer buffer(data, sizeof(data));
+    raw = buffer.GetRaw();
+    free_frames = pool->FreeFrames();
+
+    // Copies share the frame.
+    DmxBuffer copy1(buffer);
+    DmxBuffer copy2 = copy1;
+    OLA_ASSERT_EQ(raw, copy1.GetRaw());
+    OLA_ASSERT_EQ(raw, copy2.GetRaw());
+    OLA_ASSERT_EQ(free_frames, pool->FreeFrames());
+
+    // Writing to a copy takes a new frame.
+    copy2.SetChannel(0, 10);
+    OLA_ASSERT_NE(raw, copy2.GetRaw());
+    OLA_ASSERT_EQ(free_frames - 1, pool->FreeFrames());
+  }
+  OLA_ASSERT_EQ(free_frames + 1, pool->FreeFrames());
+
+  // The next buffer reuses the most recently released frame.
+  DmxBuffer buffer(data, sizeof(data));
+  OLA_ASSERT_EQ(free_frames, pool->FreeFrames());
+  OLA_ASSERT_NE(static_cast<const uint8_t*>(NULL), buffer.GetRaw());
+}
@@ -2,8 +2,11 @@
 ################################################
 common_libolacommon_la_SOURCES += \
     common/utils/ActionQueue.cpp \
+    common/utils/CallbackPool.cpp \
     common/utils/Clock.cpp \
     common/utils/DmxBuffer.cpp \
+    common/utils/DmxFramePool.cpp \
+    common/utils/DmxFramePool.h \
     common/utils/StringUtils.cpp \
     common/utils/TokenBucket.cpp \
     common/utils/Watchdog.cpp
@@ -18,6 +21,7 @@ common_utils_UtilsTester_SOURCES = \
     common/utils/CallbackTest.cpp \
     common/utils/ClockTest.cpp \
     common/utils/DmxBufferTest.cpp \
+    common/utils/DmxFramePoolTest.cpp \
     common/utils/MultiCallbackTest.cpp \
     common/utils/StringUtilsTest.cpp \
     common/utils/TokenBucketTest.cpp \
@@ -25,3 +29,13 @@ common_utils_UtilsTester_SOURCES = \
     common/utils/WatchdogTest.cpp
 common_utils_UtilsTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_utils_UtilsTester_LDADD = $(COMMON_TESTING_LIBS)
+
+# BENCHMARKS
+################################################
+benchmark_programs += common/utils/UtilsBenchmark
+
+common_utils_UtilsBenchmark_SOURCES = \
+    common/utils/ClockBenchmark.cpp \
+    common/utils/DmxBufferBenchmark.cpp \
+    common/utils/StringUtilsBenchmark.cpp
+common_utils_UtilsBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS)
@@ -19,7 +19,8 @@
  */
 
 #define __STDC_LIMIT_MACROS  // for UINT8_MAX & friends
-#include <errno.h>
+#include <ctype.h>
+#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <algorithm>
@@ -39,6 +40,26 @@ using std::ostringstream;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * Skip the leading whitespace and sign, like strtol() does.
+ * @returns a pointer to the first digit.
+ */
+const char *SkipSpaceAndSign(const char *ptr, const char *end,
+                             bool *negative) {
+  while (ptr != end && isspace(static_cast<unsigned char>(*ptr))) {
+    ptr++;
+  }
+  *negative = false;
+  if (ptr != end && (*ptr == '-' || *ptr == '+')) {
+    *negative = *ptr == '-';
+    ptr++;
+  }
+  return ptr;
+}
+}  // namespace
+
 void StringSplit(const string &input,
                  vector<string> *tokens,
                  const string &delimiters) {
@@ -58,6 +79,21 @@ void StringSplit(const string &input,
   }
 }
 
+bool StringTokenizer::Next(const char **begin, const char **end) {
+  if (m_done) {
+    return false;
+  }
+  const char *delimiter = std::find(m_position, m_end, m_delimiter);
+  *begin = m_position;
+  *end = delimiter;
+  if (delimiter == m_end) {
+    m_done = true;
+  } else {
+    m_position = delimiter + 1;
+  }
+  return true;
+}
+
 void StringTrim(string *input) {
   string characters_to_trim = " \n\r\t";
   string::size_type start = input->find_first_not_of(characters_to_trim);
@@ -152,26 +188,38 @@ bool StringToBoolTolerant(const string &value, bool *output) {
   return false;
 }
 
-bool StringToInt(const string &value, unsigned int *output, bool strict) {
-  if (value.empty()) {
-    return false;
-  }
-  char *end_ptr;
-  errno = 0;
-  long long l = strtoll(value.data(), &end_ptr, 10);  // NOLINT(runtime/int)
-  if (l < 0 || (l == 0 && errno != 0)) {
-    return false;
+const char *ParseUnsigned(const char *begin,
+                          const char *end,
+                          unsigned int *output) {
+  unsigned int value = 0;
+  const char *ptr = begin;
+  for (; ptr != end && *ptr >= '0' && *ptr <= '9'; ptr++) {
+    unsigned int digit = *ptr - '0';
+    if (value > (UINT_MAX - digit) / 10) {
+      return begin;
+    }
+    value = value * 10 + digit;
   }
-  if (value == end_ptr) {
-    return false;
+  if (ptr != begin) {
+    *output = value;
   }
-  if (strict && *end_ptr != 0) {
+  return ptr;
+}
+
+bool StringToInt(const string &value, unsigned int *output, bool strict) {
+  const char *end = value.data() + value.size();
+  bool negative;
+  const char *digits = SkipSpaceAndSign(value.data(), end, &negative);
+  unsigned int v;
+  const char *ptr = ParseUnsigned(digits, end, &v);
+  if (ptr == digits || (strict && ptr != end)) {
     return false;
   }
-  if (l > static_cast<long long>(UINT32_MAX)) {  // NOLINT(runtime/int)
+  // -0 is the only negative value allowed.
+  if (negative && v) {
     return false;
   }
-  *output = static_cast<unsigned int>(l);
+  *output = v;
   return true;
 }
 
@@ -200,25 +248,19 @@ bool StringToInt(const string &value, uint8_t *output, bool strict) {
 }
 
 bool StringToInt(const string &value, int *output, bool strict) {
-  if (value.empty()) {
-    return false;
-  }
-  char *end_ptr;
-  errno = 0;
-  long long l = strtoll(value.data(), &end_ptr, 10);  // NOLINT(runtime/int)
-  if (l == 0 && errno != 0) {
-    return false;
-  }
-  if (value == end_ptr) {
-    return false;
-  }
-  if (strict && *end_ptr != 0) {
+  const char *end = value.data() + value.size();
+  bool negative;
+  const char *digits = SkipSpaceAndSign(value.data(), end, &negative);
+  unsigned int v;
+  const char *ptr = ParseUnsigned(digits, end, &v);
+  if (ptr == digits || (strict && ptr != end)) {
     return false;
   }
-  if (l < INT32_MIN || l > INT32_MAX) {
+  if (v > (negative ? 0u - static_cast<unsigned int>(INT32_MIN) :
+           static_cast<unsigned int>(INT32_MAX))) {
     return false;
   }
-  *output = static_cast<unsigned int>(l);
+  *output = negative ? static_cast<int>(0u - v) : static_cast<int>(v);
   return true;
 }
 
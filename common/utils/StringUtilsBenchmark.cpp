@@ -0,0 +1,88 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * StringUtilsBenchmark.cpp
+ * Microbenchmarks for parsing and formatting numbers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/StringUtils.h"
+#include "ola/testing/Benchmark.h"
+
+using ola::DmxBuffer;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using std::string;
+
+namespace {
+
+/*
+ * A full universe, like the one sent to /set_dmx.
+ */
+DmxBuffer Frame() {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>(i * 7 + 1);
+  }
+  return DmxBuffer(data, sizeof(data));
+}
+
+void BenchmarkDmxBufferSetFromString(BenchmarkState *state) {
+  const string input = Frame().ToString();
+  DmxBuffer buffer;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    buffer.SetFromString(input);
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * input.size());
+}
+OLA_BENCHMARK(BenchmarkDmxBufferSetFromString);
+
+void BenchmarkDmxBufferToString(BenchmarkState *state) {
+  const DmxBuffer buffer = Frame();
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    DoNotOptimize(buffer.ToString());
+  }
+  state->SetBytesProcessed(state->Iterations() * buffer.Size());
+}
+OLA_BENCHMARK(BenchmarkDmxBufferToString);
+
+void BenchmarkStringToInt(BenchmarkState *state) {
+  const string inputs[] = {"0", "42", "512", "65535", "4294967295"};
+  const unsigned int count = sizeof(inputs) / sizeof(inputs[0]);
+  unsigned int value;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    ola::StringToInt(inputs[i % count], &value, true);
+    DoNotOptimize(value);
+  }
+}
+OLA_BENCHMARK(BenchmarkStringToInt);
+
+void BenchmarkIntToString(BenchmarkState *state) {
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    DoNotOptimize(ola::strings::IntToString(static_cast<unsigned int>(i)));
+  }
+}
+OLA_BENCHMARK(BenchmarkIntToString);
+}  // namespace
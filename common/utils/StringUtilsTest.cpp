@@ -37,6 +37,7 @@ using ola::FormatData;
 using ola::HexStringToInt;
 using ola::IntToHexString;
 using ola::IntToString;
+using ola::ParseUnsigned;
 using ola::PrefixedHexStringToInt;
 using ola::ReplaceAll;
 using ola::ShortenString;
@@ -44,6 +45,7 @@ using ola::StringBeginsWith;
 using ola::StringEndsWith;
 using ola::StringJoin;
 using ola::StringSplit;
+using ola::StringTokenizer;
 using ola::StringToBool;
 using ola::StringToBoolTolerant;
 using ola::StringToInt;
@@ -53,6 +55,7 @@ using ola::StripPrefix;
 using ola::StripSuffix;
 using ola::ToLower;
 using ola::ToUpper;
+using ola::strings::FormatUnsigned;
 using ola::strings::ToHex;
 using std::ostringstream;
 using std::string;
@@ -61,6 +64,7 @@ using std::vector;
 class StringUtilsTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(StringUtilsTest);
   CPPUNIT_TEST(testSplit);
+  CPPUNIT_TEST(testTokenizer);
   CPPUNIT_TEST(testTrim);
   CPPUNIT_TEST(testShorten);
   CPPUNIT_TEST(testBeginsWith);
@@ -68,11 +72,13 @@ class StringUtilsTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testStripPrefix);
   CPPUNIT_TEST(testStripSuffix);
   CPPUNIT_TEST(testIntToString);
+  CPPUNIT_TEST(testFormatUnsigned);
   CPPUNIT_TEST(testIntToHexString);
   CPPUNIT_TEST(testEscape);
   CPPUNIT_TEST(testEncodeString);
   CPPUNIT_TEST(testStringToBool);
   CPPUNIT_TEST(testStringToBoolTolerant);
+  CPPUNIT_TEST(testParseUnsigned);
   CPPUNIT_TEST(testStringToUInt);
   CPPUNIT_TEST(testStringToUIntOrDefault);
   CPPUNIT_TEST(testStringToUInt16);
@@ -99,6 +105,7 @@ class StringUtilsTest: public CppUnit::TestFixture {
 
  public:
     void testSplit();
+    void testTokenizer();
     void testTrim();
     void testShorten();
     void testBeginsWith();
@@ -106,11 +113,13 @@ class StringUtilsTest: public CppUnit::TestFixture {
     void testStripPrefix();
     void testStripSuffix();
     void testIntToString();
+    void testFormatUnsigned();
     void testIntToHexString();
     void testEscape();
     void testEncodeString();
     void testStringToBool();
     void testStringToBoolTolerant();
+    void testParseUnsigned();
     void testStringToUInt();
     void testStringToUIntOrDefault();
     void testStringToUInt16();
@@ -219,6 +228,31 @@ void StringUtilsTest::testSplit() {
 }
 
 
+/*
+ * Test the StringTokenizer matches StringSplit.
+ */
+void StringUtilsTest::testTokenizer() {
+  const char *inputs[] = {"", "1", "1,2,3", ",1,,2,", ","};
+  for (unsigned int i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    const string input(inputs[i]);
+    vector<string> expected;
+    StringSplit(input, &expected, ",");
+
+    vector<string> tokens;
+    StringTokenizer tokenizer(input, ',');
+    const char *begin, *end;
+    while (tokenizer.Next(&begin, &end)) {
+      tokens.push_back(string(begin, end));
+    }
+    OLA_ASSERT_EQ(expected.size(), tokens.size());
+    for (unsigned int j = 0; j < tokens.size(); j++) {
+      OLA_ASSERT_EQ(expected[j], tokens[j]);
+    }
+    OLA_ASSERT_FALSE(tokenizer.Next(&begin, &end));
+  }
+}
+
+
 /*
  * Test the trim function.
  */
@@ -339,6 +373,21 @@ void StringUtilsTest::testIntToString() {
 }
 
 
+/*
+ * Test the FormatUnsigned function.
+ */
+void StringUtilsTest::testFormatUnsigned() {
+  char buffer[ola::strings::MAX_UNSIGNED_DIGITS];
+  OLA_ASSERT_EQ(string("0"), string(buffer, FormatUnsigned(0, buffer)));
+  OLA_ASSERT_EQ(string("255"), string(buffer, FormatUnsigned(255, buffer)));
+  OLA_ASSERT_EQ(string("4294967295"),
+                string(buffer, FormatUnsigned(4294967295u, buffer)));
+
+  OLA_ASSERT_EQ(string("-2147483648"), IntToString(INT32_MIN));
+  OLA_ASSERT_EQ(string("2147483647"), IntToString(INT32_MAX));
+}
+
+
 /*
  * test the IntToHexString function.
  */
@@ -538,6 +587,38 @@ void StringUtilsTest::testStringToBoolTolerant() {
 }
 
 
+/*
+ * Test the ParseUnsigned function.
+ */
+void StringUtilsTest::testParseUnsigned() {
+  unsigned int value = 42;
+  const string input = "123,4294967295,4294967296,,x";
+  const char *begin = input.data();
+  const char *end = input.data() + input.size();
+
+  const char *ptr = ParseUnsigned(begin, end, &value);
+  OLA_ASSERT_EQ(123u, value);
+  OLA_ASSERT_EQ(',', *ptr);
+
+  ptr = ParseUnsigned(ptr + 1, end, &value);
+  OLA_ASSERT_EQ(4294967295u, value);
+
+  // Too large
+  const char *start = ptr + 1;
+  OLA_ASSERT_EQ(start, ParseUnsigned(start, end, &value));
+  OLA_ASSERT_EQ(4294967295u, value);
+
+  // No digits
+  start = input.data() + input.find(",,") + 1;
+  OLA_ASSERT_EQ(start, ParseUnsigned(start, end, &value));
+  OLA_ASSERT_EQ(end - 1, ParseUnsigned(end - 1, end, &value));
+
+  // The end of the range is respected
+  OLA_ASSERT_EQ(begin + 2, ParseUnsigned(begin, begin + 2, &value));
+  OLA_ASSERT_EQ(12u, value);
+}
+
+
 void StringUtilsTest::testStringToUInt() {
   unsigned int value;
   OLA_ASSERT_FALSE(StringToInt("", &value));
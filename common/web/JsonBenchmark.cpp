@@ -0,0 +1,87 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonBenchmark.cpp
+ * Microbenchmarks for the JsonParser and JsonWriter.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "ola/testing/Benchmark.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonParser.h"
+#include "ola/web/JsonWriter.h"
+
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using ola::web::JsonArray;
+using ola::web::JsonObject;
+using ola::web::JsonParser;
+using ola::web::JsonValue;
+using ola::web::JsonWriter;
+using std::auto_ptr;
+using std::string;
+
+namespace {
+
+/*
+ * Build something shaped like the web UI's universe list, which is one of the
+ * larger documents olad generates.
+ */
+JsonObject *BuildDocument() {
+  JsonObject *root = new JsonObject();
+  JsonArray *universes = root->AddArray("universes");
+  for (unsigned int i = 0; i < 64; i++) {
+    JsonObject *universe = universes->AppendObject();
+    universe->Add("id", i);
+    universe->Add("name", "Universe " + string(1, 'A' + (i % 26)));
+    universe->Add("merge_mode", i % 2 ? "HTP" : "LTP");
+    universe->Add("input_ports", i % 4);
+    universe->Add("output_ports", 1);
+    universe->Add("rdm_devices", 0);
+    universe->Add("active", true);
+  }
+  return root;
+}
+
+void BenchmarkJsonWriter(BenchmarkState *state) {
+  auto_ptr<JsonObject> document(BuildDocument());
+  uint64_t bytes = 0;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    const string output = JsonWriter::AsString(*document);
+    bytes += output.size();
+    DoNotOptimize(output);
+  }
+  state->SetBytesProcessed(bytes);
+}
+OLA_BENCHMARK(BenchmarkJsonWriter);
+
+void BenchmarkJsonParser(BenchmarkState *state) {
+  auto_ptr<JsonObject> document(BuildDocument());
+  const string input = JsonWriter::AsString(*document);
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    string error;
+    auto_ptr<JsonValue> value(JsonParser::Parse(input, &error));
+    DoNotOptimize(value.get());
+  }
+  state->SetBytesProcessed(state->Iterations() * input.size());
+}
+OLA_BENCHMARK(BenchmarkJsonParser);
+}  // namespace
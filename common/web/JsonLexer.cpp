@@ -52,11 +52,9 @@ static bool ParseTrimmedInput(const char **input,
  * because I think we'll need a wchar on Windows.
  */
 static bool TrimWhitespace(const char **input) {
-  while (**input != 0 &&
-         (**input == ' ' || **input == '\t' || **input == '\r' ||
-          **input == '\n')) {
-    (*input)++;
-  }
+  // strspn & strcspn are vectorized by most libcs, so prefer them to
+  // walking the input one character at a time.
+  *input += strspn(*input, " \t\r\n");
   return **input != 0;
 }
 
@@ -314,6 +312,8 @@ static bool ParseObject(const char **input, JsonParserInterface *parser) {
     return true;
   }
 
+  // Reuse the key's buffer for each member of the object.
+  string key;
   while (true) {
     if (!TrimWhitespace(input)) {
       parser->SetError("Unterminated object");
@@ -327,7 +327,7 @@ static bool ParseObject(const char **input, JsonParserInterface *parser) {
     }
     (*input)++;
 
-    string key;
+    key.clear();
     if (!ParseString(input, &key, parser)) {
       return false;
     }
@@ -433,13 +433,9 @@ bool JsonLexer::Parse(const string &input,
                       JsonParserInterface *parser) {
   // TODO(simon): Do we need to convert to unicode here? I think this may be
   // an issue on Windows. Consider mbstowcs.
-  // Copying the input sucks though, so we should use input.c_str() if we can.
-  char* input_data = new char[input.size() + 1];
-  strncpy(input_data, input.c_str(), input.size() + 1);
-
-  bool result = ParseRaw(input_data, parser);
-  delete[] input_data;
-  return result;
+  // c_str() is always NULL terminated, so the lexer can read it in place.
+  // Like the old copy, parsing stops at the first embedded NULL.
+  return ParseRaw(input.c_str(), parser);
 }
 }  // namespace web
 }  // namespace ola
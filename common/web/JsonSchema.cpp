@@ -19,7 +19,16 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <ctype.h>
 #include <math.h>
+#include <string.h>
+#ifdef HAVE_REGEX_H
+#include <regex.h>
+#endif  // HAVE_REGEX_H
 #include <algorithm>
 #include <set>
 #include <string>
@@ -27,6 +36,7 @@
 
 #include "ola/Logging.h"
 #include "common/web/SchemaParser.h"
+#include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
 #include "ola/web/JsonLexer.h"
 #include "ola/web/JsonSchema.h"
@@ -35,7 +45,6 @@
 namespace ola {
 namespace web {
 
-using std::auto_ptr;
 using std::set;
 using std::string;
 using std::vector;
@@ -106,6 +115,10 @@ const JsonValue *BaseValidator::GetDefaultValue() const {
 
 void BaseValidator::AddEnumValue(const JsonValue *value) {
   m_enums.push_back(value);
+  const JsonString *str = dynamic_cast<const JsonString*>(value);
+  if (str) {
+    m_string_enums.insert(str->Value());
+  }
 }
 
 bool BaseValidator::CheckEnums(const JsonValue &value) {
@@ -121,6 +134,11 @@ bool BaseValidator::CheckEnums(const JsonValue &value) {
   return false;
 }
 
+bool BaseValidator::CheckEnums(const JsonString &value) {
+  // A string can only ever be equal to one of the string enums.
+  return m_enums.empty() || STLContains(m_string_enums, value.Value());
+}
+
 // ReferenceValidator
 // -----------------------------------------------------------------------------
 ReferenceValidator::ReferenceValidator(const SchemaDefinitions *definitions,
@@ -202,8 +220,306 @@ void ReferenceValidator::Validate(const T &value) {
   }
 }
 
+// StringValidator::Pattern
+// -----------------------------------------------------------------------------
+/*
+ * JSON Schema patterns are ECMA 262 regular expressions, these are translated
+ * to POSIX extended regular expressions. The translation covers:
+ *  - the class escapes \d \D \w \W \s \S, inside and outside brackets,
+ *    except the negated ones inside brackets.
+ *  - \f \n \r \t \v, ASCII \xHH and \uHHHH, and escaped punctuation.
+ *  - non-capturing groups (?:...).
+ *  - lazy quantifiers, which are made greedy. Only a yes / no answer is
+ *    needed, and that's the same either way.
+ * Anything else with no ERE equivalent, e.g. lookaround, backreferences and
+ * \b, makes the pattern invalid, rather than silently matching differently.
+ */
+class StringValidator::Pattern {
+ public:
+  explicit Pattern(const string &pattern)
+      : m_compiled(false) {
+    string translated;
+    if (!Translate(pattern, &translated)) {
+      return;
+    }
+#ifdef HAVE_REGEX_H
+    // REG_NOSUB since we only want to know if it matches.
+    m_compiled = regcomp(&m_regex, translated.c_str(),
+                         REG_EXTENDED | REG_NOSUB) == 0;
+#else
+    OLA_WARN << "Regular expressions aren't supported, ignoring pattern "
+             << pattern;
+    m_compiled = true;
+#endif  // HAVE_REGEX_H
+  }
+
+  ~Pattern() {
+#ifdef HAVE_REGEX_H
+    if (m_compiled) {
+      regfree(&m_regex);
+    }
+#endif  // HAVE_REGEX_H
+  }
+
+  bool IsValid() const { return m_compiled; }
+
+  // Patterns aren't anchored, so this checks if any part of the value
+  // matches.
+  bool Matches(const string &value) const {
+#ifdef HAVE_REGEX_H
+    return m_compiled && regexec(&m_regex, value.c_str(), 0, NULL, 0) == 0;
+#else
+    (void) value;
+    return true;
+#endif  // HAVE_REGEX_H
+  }
+
+ private:
+  bool m_compiled;
+#ifdef HAVE_REGEX_H
+  regex_t m_regex;
+#endif  // HAVE_REGEX_H
+
+  static bool Translate(const string &pattern, string *output);
+  static bool TranslateBracket(const string &pattern, size_t *i,
+                               string *output);
+  static const char *ClassEscape(char c);
+  static bool LiteralEscape(const string &pattern, size_t *i, char *literal);
+
+  DISALLOW_COPY_AND_ASSIGN(Pattern);
+};
+
+bool StringValidator::Pattern::Translate(const string &pattern,
+                                         string *output) {
+  bool in_braces = false;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    const char c = pattern[i];
+    switch (c) {
+      case '\\':
+        if (++i == pattern.size()) {
+          return false;
+        }
+        if (const char *set = ClassEscape(pattern[i])) {
+          output->append(isupper(pattern[i]) ? "[^" : "[");
+          output->append(set);
+          output->push_back(']');
+        } else {
+          char literal;
+          if (!LiteralEscape(pattern, &i, &literal)) {
+            return false;
+          }
+          if (strchr(".[](){}*+?|^$\\", literal)) {
+            output->push_back('\\');
+          }
+          output->push_back(literal);
+        }
+        break;
+      case '[':
+        if (!TranslateBracket(pattern, &i, output)) {
+          return false;
+        }
+        break;
+      case '(':
+        output->push_back(c);
+        if (i + 1 < pattern.size() && pattern[i + 1] == '?') {
+          if (i + 2 == pattern.size() || pattern[i + 2] != ':') {
+            // Lookaround or a named group.
+            return false;
+          }
+          i += 2;
+        }
+        break;
+      case '{':
+        in_braces = true;
+        output->push_back(c);
+        break;
+      case '}':
+      case '*':
+      case '+':
+      case '?':
+        output->push_back(c);
+        if ((c != '}' || in_braces) && i + 1 < pattern.size() &&
+            pattern[i + 1] == '?') {
+          i++;  // lazy
+        }
+        in_braces = false;
+        break;
+      default:
+        output->push_back(c);
+    }
+  }
+  return true;
+}
+
+/*
+ * Translate the bracket expression that starts at pattern[*i], leaving *i on
+ * the closing ']'. Backslash isn't special in a POSIX bracket expression, so
+ * a literal ']', '^' or '-' has to be moved to where it's not an operator.
+ */
+bool StringValidator::Pattern::TranslateBracket(const string &pattern,
+                                                size_t *i, string *output) {
+  size_t j = *i + 1;
+  const bool negated = j < pattern.size() && pattern[j] == '^';
+  if (negated) {
+    j++;
+  }
+
+  const size_t first = j;
+  string set;
+  bool close = false, caret = false, dash = false;
+  for (; j < pattern.size() && pattern[j] != ']'; j++) {
+    char c = pattern[j];
+    if (c == '-' && j != first && j + 1 < pattern.size() &&
+        pattern[j + 1] != ']') {
+      set.push_back(c);  // a range
+      continue;
+    }
+    if (c == '\\') {
+      if (++j == pattern.size()) {
+        return false;
+      }
+      if (const char *escape_set = ClassEscape(pattern[j])) {
+        if (isupper(pattern[j])) {
+          return false;
+        }
+        set.append(escape_set);
+        continue;
+      }
+      if (!LiteralEscape(pattern, &j, &c)) {
+        return false;
+      }
+    }
+    switch (c) {
+      case ']':
+        close = true;
+        break;
+      case '^':
+        caret = true;
+        break;
+      case '-':
+        dash = true;
+        break;
+      default:
+        set.push_back(c);
+    }
+  }
+  if (j == pattern.size()) {
+    return false;
+  }
+  if (!(close || caret || dash || !set.empty())) {
+    return false;  // [] and [^] have no ERE equivalent
+  }
+
+  if (!negated && caret && !close && set.empty()) {
+    // A '^' on its own can't be first.
+    output->append(dash ? "[-^]" : "\\^");
+    *i = j;
+    return true;
+  }
+  output->push_back('[');
+  if (negated) {
+    output->push_back('^');
+  }
+  if (close) {
+    output->push_back(']');
+  }
+  output->append(set);
+  if (caret) {
+    output->push_back('^');
+  }
+  if (dash) {
+    output->push_back('-');
+  }
+  output->push_back(']');
+  *i = j;
+  return true;
+}
+
+/*
+ * @returns the contents of a bracket expression for a class escape, or NULL
+ * if c isn't one.
+ */
+const char *StringValidator::Pattern::ClassEscape(char c) {
+  switch (c) {
+    case 'd':
+    case 'D':
+      return "0-9";
+    case 'w':
+    case 'W':
+      return "A-Za-z0-9_";
+    case 's':
+    case 'S':
+      return "[:space:]";
+    default:
+      return NULL;
+  }
+}
+
+/*
+ * Parse an escape that stands for a single character. pattern[*i] is the
+ * character after the backslash, and *i is left on the last character of the
+ * escape.
+ */
+bool StringValidator::Pattern::LiteralEscape(const string &pattern,
+                                             size_t *i, char *literal) {
+  const char c = pattern[*i];
+  switch (c) {
+    case 'f':
+      *literal = '\f';
+      return true;
+    case 'n':
+      *literal = '\n';
+      return true;
+    case 'r':
+      *literal = '\r';
+      return true;
+    case 't':
+      *literal = '\t';
+      return true;
+    case 'v':
+      *literal = '\v';
+      return true;
+    case 'x':
+    case 'u':
+      {
+        const size_t digits = c == 'x' ? 2 : 4;
+        const string hex = pattern.substr(*i + 1, digits);
+        uint32_t value;
+        // POSIX regexes match bytes, so only ASCII is supported.
+        if (hex.size() != digits || !HexStringToInt(hex, &value) ||
+            value == 0 || value > 0x7f) {
+          return false;
+        }
+        *literal = static_cast<char>(value);
+        *i += digits;
+        return true;
+      }
+    default:
+      // \b, backreferences, \c etc.
+      if (isalnum(c)) {
+        return false;
+      }
+      *literal = c;
+      return true;
+  }
+}
+
 // StringValidator
 // -----------------------------------------------------------------------------
+StringValidator::StringValidator(const Options &options)
+    : BaseValidator(JSON_STRING),
+      m_options(options) {
+  if (!m_options.pattern.empty()) {
+    m_pattern.reset(new Pattern(m_options.pattern));
+  }
+}
+
+StringValidator::~StringValidator() {}
+
+bool StringValidator::PatternIsValid() const {
+  return m_pattern.get() ? m_pattern->IsValid() : true;
+}
+
 void StringValidator::Visit(const JsonString &str) {
   const std::string& value = str.Value();
   size_t str_size = value.size();
@@ -218,6 +534,11 @@ void StringValidator::Visit(const JsonString &str) {
     return;
   }
 
+  if (m_pattern.get() && !m_pattern->Matches(value)) {
+    m_is_valid = false;
+    return;
+  }
+
   m_is_valid = CheckEnums(str);
 }
 
@@ -230,7 +551,10 @@ void StringValidator::ExtendSchema(JsonObject *schema) const {
     schema->Add("maxLength", m_options.max_length);
   }
 
-  // TODO(simon): Add pattern here?
+  if (!m_options.pattern.empty()) {
+    schema->Add("pattern", m_options.pattern);
+  }
+
   // TODO(simon): Add format here?
 }
 
@@ -290,7 +614,14 @@ void NumberValidator::Visit(const JsonDouble &value) {
 // -----------------------------------------------------------------------------
 ObjectValidator::ObjectValidator(const Options &options)
     : BaseValidator(JSON_OBJECT),
-      m_options(options) {
+      m_options(options),
+      m_required_count(0),
+      m_required_seen(0) {
+  StringSet::const_iterator iter = m_options.required_properties.begin();
+  for (; iter != m_options.required_properties.end(); ++iter) {
+    GetPropertyInfo(*iter)->required = true;
+    m_required_count++;
+  }
 }
 
 ObjectValidator::~ObjectValidator() {
@@ -301,6 +632,7 @@ ObjectValidator::~ObjectValidator() {
 void ObjectValidator::AddValidator(const std::string &property,
                                    ValidatorInterface *validator) {
   STLReplaceAndDelete(&m_property_validators, property, validator);
+  GetPropertyInfo(property)->validator = validator;
 }
 
 void ObjectValidator::SetAdditionalValidator(ValidatorInterface *validator) {
@@ -310,11 +642,25 @@ void ObjectValidator::SetAdditionalValidator(ValidatorInterface *validator) {
 void ObjectValidator::AddSchemaDependency(const string &property,
                                           ValidatorInterface *validator) {
   STLReplaceAndDelete(&m_schema_dependencies, property, validator);
+  PropertyInfo *info = GetPropertyInfo(property);
+  info->schema_dependency = validator;
+  AddDependent(info);
 }
 
 void ObjectValidator::AddPropertyDependency(const string &property,
                                             const StringSet &properties) {
   m_property_dependencies[property] = properties;
+
+  // Look up the dependencies first, since GetPropertyInfo may add entries.
+  vector<unsigned int> dependencies;
+  StringSet::const_iterator iter = properties.begin();
+  for (; iter != properties.end(); ++iter) {
+    dependencies.push_back(GetPropertyInfo(*iter)->index);
+  }
+
+  PropertyInfo *info = GetPropertyInfo(property);
+  info->property_dependencies = dependencies;
+  AddDependent(info);
 }
 
 void ObjectValidator::Visit(const JsonObject &obj) {
@@ -331,48 +677,43 @@ void ObjectValidator::Visit(const JsonObject &obj) {
     return;
   }
 
-  m_seen_properties.clear();
+  m_required_seen = 0;
+  // We only need to track which properties we've seen for the dependencies.
+  if (!m_dependents.empty()) {
+    m_seen.assign(m_property_info.size(), false);
+  }
   obj.VisitProperties(this);
 
-  StringSet missing_properties;
-  std::set_difference(m_options.required_properties.begin(),
-                      m_options.required_properties.end(),
-                      m_seen_properties.begin(),
-                      m_seen_properties.end(),
-                      std::inserter(missing_properties,
-                                    missing_properties.end()));
-  if (!missing_properties.empty()) {
+  // Properties are unique, so if we saw as many required properties as there
+  // are, none are missing.
+  if (!m_is_valid || m_required_seen != m_required_count) {
     m_is_valid = false;
+    return;
   }
 
-  // Check PropertyDependencies
-  PropertyDependencies::const_iterator prop_iter =
-    m_property_dependencies.begin();
-  for (; prop_iter != m_property_dependencies.end() && m_is_valid;
-       ++prop_iter) {
-    if (!STLContains(m_seen_properties, prop_iter->first)) {
+  vector<const PropertyInfo*>::const_iterator iter = m_dependents.begin();
+  for (; iter != m_dependents.end(); ++iter) {
+    const PropertyInfo *info = *iter;
+    if (!m_seen[info->index]) {
       continue;
     }
 
-    StringSet::const_iterator iter = prop_iter->second.begin();
-    for (; iter != prop_iter->second.end(); ++iter) {
-      if (!STLContains(m_seen_properties, *iter)) {
+    // Check PropertyDependencies
+    vector<unsigned int>::const_iterator dep_iter =
+        info->property_dependencies.begin();
+    for (; dep_iter != info->property_dependencies.end(); ++dep_iter) {
+      if (!m_seen[*dep_iter]) {
         m_is_valid = false;
-        break;
+        return;
       }
     }
-  }
 
-  // Check Schema Dependencies
-  SchemaDependencies::const_iterator schema_iter =
-    m_schema_dependencies.begin();
-  for (; schema_iter != m_schema_dependencies.end() && m_is_valid;
-       ++schema_iter) {
-    if (STLContains(m_seen_properties, schema_iter->first)) {
-      obj.Accept(schema_iter->second);
-      if (!schema_iter->second->IsValid()) {
+    // Check Schema Dependencies
+    if (info->schema_dependency) {
+      obj.Accept(info->schema_dependency);
+      if (!info->schema_dependency->IsValid()) {
         m_is_valid = false;
-        break;
+        return;
       }
     }
   }
@@ -380,11 +721,24 @@ void ObjectValidator::Visit(const JsonObject &obj) {
 
 void ObjectValidator::VisitProperty(const std::string &property,
                                     const JsonValue &value) {
-  m_seen_properties.insert(property);
+  if (!m_is_valid) {
+    // No point checking the rest of the properties.
+    return;
+  }
 
   // The algorithm is described in section 8.3.3
-  ValidatorInterface *validator = STLFindOrNull(
-      m_property_validators, property);
+  ValidatorInterface *validator = NULL;
+  PropertyInfoMap::const_iterator iter = m_property_info.find(property);
+  if (iter != m_property_info.end()) {
+    const PropertyInfo &info = iter->second;
+    if (info.required) {
+      m_required_seen++;
+    }
+    if (!m_dependents.empty()) {
+      m_seen[info.index] = true;
+    }
+    validator = info.validator;
+  }
 
   // patternProperties would be added here if supported
 
@@ -405,6 +759,25 @@ void ObjectValidator::VisitProperty(const std::string &property,
   }
 }
 
+ObjectValidator::PropertyInfo *ObjectValidator::GetPropertyInfo(
+    const string &property) {
+  PropertyInfoMap::iterator iter = m_property_info.find(property);
+  if (iter == m_property_info.end()) {
+    PropertyInfo info;
+    info.index = m_property_info.size();
+    iter = m_property_info.insert(
+        PropertyInfoMap::value_type(property, info)).first;
+  }
+  return &iter->second;
+}
+
+void ObjectValidator::AddDependent(const PropertyInfo *info) {
+  if (std::find(m_dependents.begin(), m_dependents.end(), info) ==
+      m_dependents.end()) {
+    m_dependents.push_back(info);
+  }
+}
+
 void ObjectValidator::ExtendSchema(JsonObject *schema) const {
   if (m_options.min_properties > 0) {
     schema->Add("minProperties", m_options.min_properties);
@@ -467,7 +840,35 @@ ArrayValidator::ArrayValidator(Items *items, AdditionalItems *additional_items,
     m_items(items),
     m_additional_items(additional_items),
     m_options(options),
-    m_wildcard_validator(new WildcardValidator()) {
+    m_wildcard_validator(new WildcardValidator()),
+    m_default_validator(NULL) {
+  if (m_items.get()) {
+    if (m_items->Validator()) {
+      // 8.2.3.1, items is an object.
+      m_default_validator = m_items->Validator();
+    } else {
+      // 8.2.3.3, items is an array.
+      m_item_validators = m_items->Validators();
+
+      // Check to see if additionalItems it defined.
+      if (m_additional_items.get()) {
+        if (m_additional_items->Validator()) {
+          // additionalItems is an object
+          m_default_validator = m_additional_items->Validator();
+        } else if (m_additional_items->AllowAdditional()) {
+          // additionalItems is a bool, and true
+          m_default_validator = m_wildcard_validator.get();
+        }
+      } else {
+        // additionalItems not provided, so it defaults to the empty schema
+        // (wildcard).
+        m_default_validator = m_wildcard_validator.get();
+      }
+    }
+  } else {
+    // no items, therefore it defaults to the empty (wildcard) schema.
+    m_default_validator = m_wildcard_validator.get();
+  }
 }
 
 ArrayValidator::~ArrayValidator() {}
@@ -490,21 +891,22 @@ void ArrayValidator::Visit(const JsonArray &array) {
     return;
   }
 
-
-  auto_ptr<ArrayElementValidator> element_validator(
-      ConstructElementValidator());
-
   for (unsigned int i = 0; i < array.Size(); i++) {
-    array.ElementAt(i)->Accept(element_validator.get());
-    if (!element_validator->IsValid()) {
-      break;
+    ValidatorInterface *validator = i < m_item_validators.size() ?
+        m_item_validators[i] : m_default_validator;
+    if (!validator) {
+      // additional items aren't allowed
+      m_is_valid = false;
+      return;
+    }
+    array.ElementAt(i)->Accept(validator);
+    if (!validator->IsValid()) {
+      m_is_valid = false;
+      return;
     }
-  }
-  m_is_valid = element_validator->IsValid();
-  if (!m_is_valid) {
-    return;
   }
 
+  m_is_valid = true;
   if (m_options.unique_items) {
     for (unsigned int i = 0; i < array.Size(); i++) {
       for (unsigned int j = 0; j < i; j++) {
@@ -561,118 +963,6 @@ void ArrayValidator::ExtendSchema(JsonObject *schema) const {
   }
 }
 
-// TODO(simon): do this once at construction, rather than on every visit?
-ArrayValidator::ArrayElementValidator*
-    ArrayValidator::ConstructElementValidator() const {
-  if (m_items.get()) {
-    if (m_items->Validator()) {
-      // 8.2.3.1, items is an object.
-      ValidatorList empty_validators;
-      return new ArrayElementValidator(empty_validators, m_items->Validator());
-    } else {
-      // 8.2.3.3, items is an array.
-      const ValidatorList &validators = m_items->Validators();
-      ValidatorInterface *default_validator = NULL;
-
-      // Check to see if additionalItems it defined.
-      if (m_additional_items.get()) {
-        if (m_additional_items->Validator()) {
-          // additionalItems is an object
-          default_validator = m_additional_items->Validator();
-        } else if (m_additional_items->AllowAdditional()) {
-          // additionalItems is a bool, and true
-          default_validator = m_wildcard_validator.get();
-        }
-      } else {
-        // additionalItems not provided, so it defaults to the empty schema
-        // (wildcard).
-        default_validator = m_wildcard_validator.get();
-      }
-      return new ArrayElementValidator(validators, default_validator);
-    }
-  } else {
-    // no items, therefore it defaults to the empty (wildcard) schema.
-    ValidatorList empty_validators;
-    return new ArrayElementValidator(
-        empty_validators, m_wildcard_validator.get());
-  }
-}
-
-// ArrayValidator::ArrayElementValidator
-// -----------------------------------------------------------------------------
-ArrayValidator::ArrayElementValidator::ArrayElementValidator(
-    const ValidatorList &validators,
-    ValidatorInterface *default_validator)
-    : BaseValidator(JSON_UNDEFINED),
-      m_item_validators(validators.begin(), validators.end()),
-      m_default_validator(default_validator) {
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(
-    const JsonString &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonBool &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonNull &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonRawValue &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonObject &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonArray &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonUInt &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(
-    const JsonUInt64 &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonInt &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(const JsonInt64 &value) {
-  ValidateItem(value);
-}
-
-void ArrayValidator::ArrayElementValidator::Visit(
-    const JsonDouble &value) {
-  ValidateItem(value);
-}
-
-template <typename T>
-void ArrayValidator::ArrayElementValidator::ValidateItem(const T &item) {
-  ValidatorInterface *validator = NULL;
-
-  if (!m_item_validators.empty()) {
-    validator = m_item_validators.front();
-    m_item_validators.pop_front();
-  } else if (!m_default_validator) {
-    // additional items aren't allowed
-    m_is_valid = false;
-    return;
-  } else {
-    validator = m_default_validator;
-  }
-  item.Accept(validator);
-  m_is_valid = validator->IsValid();
-}
-
 // ConjunctionValidator
 // -----------------------------------------------------------------------------
 ConjunctionValidator::ConjunctionValidator(const string &keyword,
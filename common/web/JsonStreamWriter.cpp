@@ -0,0 +1,210 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonStreamWriter.cpp
+ * Write JSON to a buffer without building a JsonValue first.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <sstream>
+#include <string>
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/web/JsonStreamWriter.h"
+
+namespace ola {
+namespace web {
+
+using std::ostringstream;
+using std::string;
+
+namespace {
+
+template <typename T>
+string NumberToString(T value) {
+  ostringstream str;
+  str << value;
+  return str.str();
+}
+}  // namespace
+
+JsonStreamWriter::JsonStreamWriter(ola::io::OutputBufferInterface *output)
+    : m_output(output),
+      m_indent(0),
+      m_started(false),
+      m_have_key(false) {
+}
+
+void JsonStreamWriter::StartObject() {
+  StartValue(true);
+  Write("{");
+  m_indent += DEFAULT_INDENT;
+  Scope scope = {true, false, 0};
+  m_stack.push_back(scope);
+}
+
+void JsonStreamWriter::StartObject(const string &key) {
+  Key(key);
+  StartObject();
+}
+
+void JsonStreamWriter::EndObject() {
+  EndScope(true);
+}
+
+void JsonStreamWriter::StartArray() {
+  StartValue(true);
+  Write("[");
+  Scope scope = {false, false, 0};
+  m_stack.push_back(scope);
+}
+
+void JsonStreamWriter::StartArray(const string &key) {
+  Key(key);
+  StartArray();
+}
+
+void JsonStreamWriter::EndArray() {
+  EndScope(false);
+}
+
+void JsonStreamWriter::Key(const string &key) {
+  if (m_stack.empty() || !m_stack.back().is_object || m_have_key) {
+    OLA_WARN << "Key " << key << " added outside of an object";
+    return;
+  }
+  Scope &scope = m_stack.back();
+  Write(scope.count ? ",\n" : "\n");
+  WriteIndent();
+  Write("\"" + EscapeString(key) + "\": ");
+  scope.count++;
+  m_have_key = true;
+}
+
+void JsonStreamWriter::Value(const string &value) {
+  StartValue(false);
+  Write("\"" + EscapeString(EncodeString(value)) + "\"");
+}
+
+void JsonStreamWriter::Value(const char *value) {
+  Value(string(value));
+}
+
+void JsonStreamWriter::Value(bool value) {
+  StartValue(false);
+  Write(value ? "true" : "false");
+}
+
+void JsonStreamWriter::Value(uint32_t value) {
+  StartValue(false);
+  Write(NumberToString(value));
+}
+
+void JsonStreamWriter::Value(int32_t value) {
+  StartValue(false);
+  Write(NumberToString(value));
+}
+
+void JsonStreamWriter::Value(uint64_t value) {
+  StartValue(false);
+  Write(NumberToString(value));
+}
+
+void JsonStreamWriter::Value(int64_t value) {
+  StartValue(false);
+  Write(NumberToString(value));
+}
+
+void JsonStreamWriter::Null() {
+  StartValue(false);
+  Write("null");
+}
+
+void JsonStreamWriter::RawValue(const string &value) {
+  StartValue(false);
+  Write(value);
+}
+
+/*
+ * Write the separator before a value. Complex values are objects & arrays.
+ */
+void JsonStreamWriter::StartValue(bool complex) {
+  if (m_stack.empty()) {
+    m_started = true;
+    return;
+  }
+
+  Scope &scope = m_stack.back();
+  if (scope.is_object) {
+    if (!m_have_key) {
+      OLA_WARN << "Value added to a JSON object without a key";
+    }
+    m_have_key = false;
+    return;
+  }
+
+  if (scope.count == 0) {
+    if (complex) {
+      scope.multi_line = true;
+      m_indent += DEFAULT_INDENT;
+      Write("\n");
+      WriteIndent();
+    }
+  } else if (scope.multi_line) {
+    Write(",\n");
+    WriteIndent();
+  } else {
+    Write(", ");
+  }
+  scope.count++;
+}
+
+void JsonStreamWriter::EndScope(bool is_object) {
+  if (m_stack.empty() || m_stack.back().is_object != is_object) {
+    OLA_WARN << "Mismatched end of JSON " << (is_object ? "object" : "array");
+    return;
+  }
+
+  const Scope scope = m_stack.back();
+  m_stack.pop_back();
+  m_have_key = false;
+
+  if (is_object) {
+    m_indent -= DEFAULT_INDENT;
+    if (scope.count) {
+      Write("\n");
+      WriteIndent();
+    }
+    Write("}");
+  } else {
+    if (scope.multi_line) {
+      m_indent -= DEFAULT_INDENT;
+      Write("\n");
+      WriteIndent();
+    }
+    Write("]");
+  }
+}
+
+void JsonStreamWriter::Write(const string &data) {
+  m_output->Write(reinterpret_cast<const uint8_t*>(data.data()),
+                  data.size());
+}
+
+void JsonStreamWriter::WriteIndent() {
+  Write(string(m_indent, ' '));
+}
+}  // namespace web
+}  // namespace ola
@@ -23,9 +23,11 @@
 #include <sstream>
 #include <vector>
 
+#include "ola/io/IOQueue.h"
 #include "ola/testing/TestUtils.h"
 #include "ola/web/Json.h"
 #include "ola/web/JsonPointer.h"
+#include "ola/web/JsonStreamWriter.h"
 #include "ola/web/JsonWriter.h"
 
 using ola::web::JsonArray;
@@ -37,6 +39,7 @@ using ola::web::JsonNull;
 using ola::web::JsonObject;
 using ola::web::JsonPointer;
 using ola::web::JsonRawValue;
+using ola::web::JsonStreamWriter;
 using ola::web::JsonString;
 using ola::web::JsonUInt64;
 using ola::web::JsonUInt;
@@ -57,6 +60,7 @@ class JsonTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testEmptyObject);
   CPPUNIT_TEST(testSimpleObject);
   CPPUNIT_TEST(testComplexObject);
+  CPPUNIT_TEST(testStreamWriter);
   CPPUNIT_TEST(testEquality);
   CPPUNIT_TEST(testIntInequality);
   CPPUNIT_TEST(testMultipleOf);
@@ -75,6 +79,7 @@ class JsonTest: public CppUnit::TestFixture {
     void testEmptyObject();
     void testSimpleObject();
     void testComplexObject();
+    void testStreamWriter();
     void testEquality();
     void testIntInequality();
     void testMultipleOf();
@@ -265,6 +270,81 @@ void JsonTest::testComplexObject() {
   OLA_ASSERT_EQ(expected, JsonWriter::AsString(object));
 }
 
+/*
+ * Check the JsonStreamWriter produces the same text as the JsonWriter.
+ */
+void JsonTest::testStreamWriter() {
+  JsonObject object;
+  object.Add("age", 10);
+  object.AddValue("big", new JsonUInt64(static_cast<uint64_t>(1) << 40));
+  object.AddObject("empty");
+  object.AddArray("empty list");
+  JsonArray *array = object.AddArray("lucky numbers");
+  array->Append(2);
+  array->Append(-5);
+  object.Add("male", true);
+  object.Add("name", "simon \"the tester\"");
+  object.Add("nothing");
+  JsonArray *uids = object.AddArray("uids");
+  for (unsigned int i = 0; i < 2; i++) {
+    JsonObject *uid = uids->AppendObject();
+    uid->Add("device_id", i);
+    JsonArray *tags = uid->AddArray("tags");
+    tags->Append("a");
+    tags->Append("b");
+  }
+
+  ola::io::IOQueue output;
+  JsonStreamWriter writer(&output);
+  writer.StartObject();
+  writer.Add("age", 10);
+  writer.Add("big", static_cast<uint64_t>(1) << 40);
+  writer.StartObject("empty");
+  writer.EndObject();
+  writer.StartArray("empty list");
+  writer.EndArray();
+  writer.StartArray("lucky numbers");
+  writer.Value(2);
+  writer.Value(-5);
+  writer.EndArray();
+  writer.Add("male", true);
+  writer.Add("name", "simon \"the tester\"");
+  writer.Key("nothing");
+  writer.Null();
+  writer.StartArray("uids");
+  for (unsigned int i = 0; i < 2; i++) {
+    writer.StartObject();
+    writer.Add("device_id", i);
+    writer.StartArray("tags");
+    writer.Value("a");
+    writer.Value("b");
+    writer.EndArray();
+    writer.EndObject();
+  }
+  writer.EndArray();
+  OLA_ASSERT_FALSE(writer.Complete());
+  writer.EndObject();
+  OLA_ASSERT_TRUE(writer.Complete());
+
+  string streamed;
+  output.Read(&streamed, output.Size());
+  OLA_ASSERT_EQ(JsonWriter::AsString(object), streamed);
+
+  // a top level array
+  JsonArray top_level;
+  top_level.Append("foo");
+  top_level.Append(true);
+
+  JsonStreamWriter array_writer(&output);
+  array_writer.StartArray();
+  array_writer.Value("foo");
+  array_writer.Value(true);
+  array_writer.EndArray();
+  streamed.clear();
+  output.Read(&streamed, output.Size());
+  OLA_ASSERT_EQ(JsonWriter::AsString(top_level), streamed);
+}
+
 /*
  * Test for equality.
  */
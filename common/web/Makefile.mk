@@ -26,6 +26,7 @@ common_web_libolaweb_la_SOURCES = \
     common/web/JsonPointer.cpp \
     common/web/JsonSchema.cpp \
     common/web/JsonSections.cpp \
+    common/web/JsonStreamWriter.cpp \
     common/web/JsonTypes.cpp \
     common/web/JsonWriter.cpp \
     common/web/PointerTracker.cpp \
@@ -96,3 +97,10 @@ common_web_SchemaTester_LDADD = $(COMMON_WEB_TEST_LDADD)
 common_web_SectionsTester_SOURCES = common/web/SectionsTest.cpp
 common_web_SectionsTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_web_SectionsTester_LDADD = $(COMMON_WEB_TEST_LDADD)
+
+# BENCHMARKS
+################################################
+benchmark_programs += common/web/JsonBenchmark
+
+common_web_JsonBenchmark_SOURCES = common/web/JsonBenchmark.cpp
+common_web_JsonBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS)
@@ -290,6 +290,9 @@ void SchemaParseContext::String(SchemaErrorLogger *logger,
     case SCHEMA_ID:
       m_id.Set(value);
       break;
+    case SCHEMA_PATTERN:
+      m_pattern.Set(value);
+      break;
     case SCHEMA_TITLE:
       m_title.Set(value);
       break;
@@ -662,7 +665,7 @@ BaseValidator* SchemaParseContext::BuildObjectValidator(
 }
 
 BaseValidator* SchemaParseContext::BuildStringValidator(
-    OLA_UNUSED SchemaErrorLogger *logger) {
+    SchemaErrorLogger *logger) {
   StringValidator::Options options;
 
   if (m_max_length.IsSet()) {
@@ -673,7 +676,16 @@ BaseValidator* SchemaParseContext::BuildStringValidator(
     options.min_length = m_min_length.Value();
   }
 
-  return new StringValidator(options);
+  if (m_pattern.IsSet()) {
+    options.pattern = m_pattern.Value();
+  }
+
+  auto_ptr<StringValidator> validator(new StringValidator(options));
+  if (!validator->PatternIsValid()) {
+    logger->Error() << "Invalid pattern: " << options.pattern;
+    return NULL;
+  }
+  return validator.release();
 }
 
 /*
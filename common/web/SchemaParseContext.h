@@ -224,7 +224,6 @@ class SchemaParseContext : public SchemaParseContextInterface {
   std::auto_ptr<JsonNumber> m_multiple_of;
 
   // 5.2 String keywords
-  // TODO(simon): Implement pattern support?
   OptionalItem<std::string> m_pattern;
   OptionalItem<uint64_t> m_max_length;
   OptionalItem<uint64_t> m_min_length;
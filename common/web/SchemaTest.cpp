@@ -18,6 +18,10 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
 #include <set>
@@ -25,6 +29,7 @@
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/base/Array.h"
 #include "ola/testing/TestUtils.h"
 #include "ola/web/Json.h"
 #include "ola/web/JsonParser.h"
@@ -173,6 +178,30 @@ void JsonSchemaTest::testReferenceValidator() {
   OLA_ASSERT_FALSE(validator.IsValid());
 }
 
+#ifdef HAVE_REGEX_H
+struct PatternTest {
+  const char *pattern;
+  const char *value;
+  bool matches;
+};
+
+const PatternTest ECMA_PATTERN_TESTS[] = {
+  {"^\\d{3}-\\d+$", "123-45", true},
+  {"^\\d{3}-\\d+$", "12a-45", false},
+  {"^\\D\\W$", "a!", true},
+  {"^\\D\\W$", "1!", false},
+  {"^\\w+\\s\\S+$", "ab_1 x.y", true},
+  {"^[\\w.-]+@[^\\s@]+$", "a.b-c@host", true},
+  {"^[\\w.-]+@[^\\s@]+$", "a b@host", false},
+  {"^(?:ab)+?c$", "ababc", true},
+  {"^a.*?b$", "axxb", true},
+  {"^\\x41\\u0042\\.$", "AB.", true},
+  {"^\\x41\\u0042\\.$", "ABx", false},
+  {"^[\\]\\-^]+$", "]-^", true},
+  {"^[\\^]$", "^", true},
+};
+#endif  // HAVE_REGEX_H
+
 void JsonSchemaTest::testStringValidator() {
   StringValidator basic_string_validator((StringValidator::Options()));
 
@@ -217,6 +246,59 @@ void JsonSchemaTest::testStringValidator() {
   OLA_ASSERT_TRUE(max_length_string_validator.IsValid());
   m_long_string_value->Accept(&max_length_string_validator);
   OLA_ASSERT_FALSE(max_length_string_validator.IsValid());
+
+#ifdef HAVE_REGEX_H
+  // test a string with a pattern
+  StringValidator::Options pattern_options;
+  pattern_options.pattern = "^f[aeiou]+$";
+
+  StringValidator pattern_string_validator(pattern_options);
+  OLA_ASSERT_TRUE(pattern_string_validator.PatternIsValid());
+
+  m_string_value->Accept(&pattern_string_validator);
+  OLA_ASSERT_TRUE(pattern_string_validator.IsValid());
+  m_long_string_value->Accept(&pattern_string_validator);
+  OLA_ASSERT_FALSE(pattern_string_validator.IsValid());
+  m_string_value->Accept(&pattern_string_validator);
+  OLA_ASSERT_TRUE(pattern_string_validator.IsValid());
+
+  // patterns aren't anchored
+  StringValidator::Options unanchored_options;
+  unanchored_options.pattern = "longer";
+  StringValidator unanchored_validator(unanchored_options);
+  m_long_string_value->Accept(&unanchored_validator);
+  OLA_ASSERT_TRUE(unanchored_validator.IsValid());
+  m_string_value->Accept(&unanchored_validator);
+  OLA_ASSERT_FALSE(unanchored_validator.IsValid());
+
+  StringValidator::Options invalid_options;
+  invalid_options.pattern = "[foo";
+  StringValidator invalid_pattern_validator(invalid_options);
+  OLA_ASSERT_FALSE(invalid_pattern_validator.PatternIsValid());
+
+  // patterns are ECMA 262 regular expressions
+  for (unsigned int i = 0; i < arraysize(ECMA_PATTERN_TESTS); i++) {
+    StringValidator::Options options;
+    options.pattern = ECMA_PATTERN_TESTS[i].pattern;
+    StringValidator validator(options);
+    OLA_ASSERT_TRUE(validator.PatternIsValid());
+    JsonString value(ECMA_PATTERN_TESTS[i].value);
+    value.Accept(&validator);
+    OLA_ASSERT_EQ(ECMA_PATTERN_TESTS[i].matches, validator.IsValid());
+  }
+#endif  // HAVE_REGEX_H
+
+  // ECMA 262 features with no POSIX equivalent make the pattern invalid
+  const char *unsupported[] = {
+    "a(?=b)", "(?!a)", "(a)\\1", "\\bfoo", "[\\D]", "\\u00e9", "foo\\",
+    "[abc",
+  };
+  for (unsigned int i = 0; i < arraysize(unsupported); i++) {
+    StringValidator::Options options;
+    options.pattern = unsupported[i];
+    StringValidator validator(options);
+    OLA_ASSERT_FALSE(validator.PatternIsValid());
+  }
 }
 
 void JsonSchemaTest::testBoolValidator() {
@@ -831,6 +913,16 @@ void JsonSchemaTest::testEnums() {
   baz_value.Accept(&string_validator);
   OLA_ASSERT_FALSE(string_validator.IsValid());
 
+  // Enums can contain values of any type, only the strings can match.
+  StringValidator mixed_validator((StringValidator::Options()));
+  mixed_validator.AddEnumValue(new JsonInt(1));
+  mixed_validator.AddEnumValue(new JsonString("bar"));
+
+  bar_value.Accept(&mixed_validator);
+  OLA_ASSERT_TRUE(mixed_validator.IsValid());
+  m_string_value->Accept(&mixed_validator);
+  OLA_ASSERT_FALSE(mixed_validator.IsValid());
+
   IntegerValidator integer_validator;
   integer_validator.AddEnumValue(new JsonInt(1));
   integer_validator.AddEnumValue(new JsonInt(2));
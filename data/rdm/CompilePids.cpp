@@ -0,0 +1,44 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CompilePids.cpp
+ * Compile the pid data into a single binary file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Logging.h>
+#include <ola/base/Flags.h>
+#include <ola/base/Init.h>
+
+#include "common/rdm/PidStoreLoader.h"
+
+/*
+ * Main
+ */
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "<pid_directory> <output_file>",
+               "Compile the PID data in a directory into a binary file.");
+
+  if (argc != 3) {
+    ola::DisplayUsageAndExit();
+  }
+
+  ola::rdm::PidStoreLoader loader;
+  if (!loader.CompileDirectory(argv[1], argv[2])) {
+    OLA_FATAL << "Failed to compile the PIDs in " << argv[1];
+    return 1;
+  }
+  return 0;
+}
@@ -5,6 +5,25 @@ dist_piddata_DATA = \
     data/rdm/pids.proto \
     data/rdm/manufacturer_pids.proto
 
+# The PIDs compiled into a single binary file, this speeds up loading.
+if !CROSS_COMPILING
+nodist_piddata_DATA = data/rdm/compiled_pids.bin
+endif
+
+data/rdm/compiled_pids.bin: data/rdm/compile_pids$(EXEEXT) \
+                            $(dist_piddata_DATA)
+	$(AM_V_GEN)data/rdm/compile_pids$(EXEEXT) $(srcdir)/data/rdm $@
+
+CLEANFILES += data/rdm/compiled_pids.bin
+
+# PROGRAMS
+################################################
+noinst_PROGRAMS += data/rdm/compile_pids
+data_rdm_compile_pids_SOURCES = data/rdm/CompilePids.cpp
+data_rdm_compile_pids_CXXFLAGS = $(COMMON_PROTOBUF_CXXFLAGS)
+data_rdm_compile_pids_LDADD = common/libolacommon.la \
+                              $(libprotobuf_LIBS)
+
 # SCRIPTS
 ################################################
 dist_noinst_SCRIPTS += \
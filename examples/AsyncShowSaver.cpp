@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * AsyncShowSaver.cpp
+ * Writes show data to a file from a background thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/thread/Mutex.h>
+
+#include "examples/AsyncShowSaver.h"
+
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::MutexLocker;
+
+
+AsyncShowSaver::AsyncShowSaver(ShowSaverInterface *saver,
+                               const Options &options)
+    : Thread(Thread::Options("show-writer")),
+      m_saver(saver),
+      m_options(options),
+      m_queue(options.queue_size),
+      m_running(false),
+      m_stopping(false),
+      m_flush_requested(false),
+      m_sync_requested(false),
+      m_queued_frames(0),
+      m_written_frames(0),
+      m_dropped_frames(0) {
+}
+
+
+AsyncShowSaver::~AsyncShowSaver() {
+  Close();
+}
+
+
+bool AsyncShowSaver::Open() {
+  if (m_running) {
+    return true;
+  }
+  if (!m_saver->Open()) {
+    return false;
+  }
+
+  m_stopping = false;
+  m_running = Start();
+  if (!m_running) {
+    OLA_FATAL << "Failed to start the writer thread";
+    m_saver->Close();
+  }
+  return m_running;
+}
+
+
+/*
+ * Stop the writer thread once it's written the queued frames, then close the
+ * file.
+ */
+void AsyncShowSaver::Close() {
+  if (!m_running) {
+    return;
+  }
+
+  {
+    MutexLocker lock(&m_mutex);
+    m_stopping = true;
+  }
+  m_condition.Signal();
+  Join();
+  m_running = false;
+
+  m_saver->Flush(m_options.sync_interval != 0);
+  m_saver->Close();
+}
+
+
+bool AsyncShowSaver::NewFrame(const TimeStamp &arrival_time,
+                              unsigned int universe,
+                              const ola::DmxBuffer &data) {
+  Frame *frame = m_queue.Reserve();
+  if (!frame) {
+    __atomic_add_fetch(&m_dropped_frames, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  frame->arrival_time = arrival_time;
+  frame->universe = universe;
+  frame->length = data.Size();
+  memcpy(frame->data, data.GetRaw(), frame->length);
+  m_queue.Commit();
+  __atomic_add_fetch(&m_queued_frames, 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+
+bool AsyncShowSaver::Flush(bool sync) {
+  {
+    MutexLocker lock(&m_mutex);
+    m_flush_requested = true;
+    m_sync_requested |= sync;
+  }
+  m_condition.Signal();
+  return true;
+}
+
+
+uint64_t AsyncShowSaver::QueuedFrames() const {
+  return __atomic_load_n(&m_queued_frames, __ATOMIC_RELAXED);
+}
+
+
+uint64_t AsyncShowSaver::WrittenFrames() const {
+  return __atomic_load_n(&m_written_frames, __ATOMIC_RELAXED);
+}
+
+
+uint64_t AsyncShowSaver::DroppedFrames() const {
+  return __atomic_load_n(&m_dropped_frames, __ATOMIC_RELAXED);
+}
+
+
+/*
+ * The producer doesn't signal when it adds a frame, so NewFrame() never
+ * takes a lock. Instead we poll the queue every POLL_INTERVAL_MS.
+ */
+void *AsyncShowSaver::Run() {
+  const TimeInterval flush_interval(
+      static_cast<int64_t>(m_options.flush_interval) * 1000);
+  const TimeInterval sync_interval(
+      static_cast<int64_t>(m_options.sync_interval) * 1000);
+  const TimeInterval poll_interval(
+      static_cast<int64_t>(POLL_INTERVAL_MS) * 1000);
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  TimeStamp last_flush = now;
+  TimeStamp last_sync = now;
+
+  while (true) {
+    WriteQueuedFrames();
+    m_clock.CurrentTime(&now);
+
+    bool flush = now >= last_flush + flush_interval;
+    bool sync = m_options.sync_interval && now >= last_sync + sync_interval;
+    bool stopping;
+    {
+      MutexLocker lock(&m_mutex);
+      flush |= m_flush_requested;
+      sync |= m_sync_requested;
+      m_flush_requested = false;
+      m_sync_requested = false;
+      stopping = m_stopping;
+    }
+    if (stopping) {
+      break;
+    }
+
+    if (flush || sync) {
+      if (!m_saver->Flush(sync)) {
+        OLA_WARN << "Failed to flush the show file";
+      }
+      last_flush = now;
+      if (sync) {
+        last_sync = now;
+      }
+    }
+
+    MutexLocker lock(&m_mutex);
+    if (!m_stopping && !m_flush_requested && !m_queue.Peek()) {
+      m_condition.TimedWait(&m_mutex, now + poll_interval);
+    }
+  }
+
+  // Close() is called once the producer has stopped, so this gets the last
+  // of the frames.
+  WriteQueuedFrames();
+  return NULL;
+}
+
+
+void AsyncShowSaver::WriteQueuedFrames() {
+  const Frame *frame;
+  while ((frame = m_queue.Peek())) {
+    m_buffer.Set(frame->data, frame->length);
+    m_saver->NewFrame(frame->arrival_time, frame->universe, m_buffer);
+    m_queue.Pop();
+    __atomic_add_fetch(&m_written_frames, 1, __ATOMIC_RELAXED);
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * AsyncShowSaver.h
+ * Writes show data to a file from a background thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/SPSCQueue.h>
+#include <ola/thread/Thread.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "examples/ShowSaver.h"
+
+#ifndef EXAMPLES_ASYNCSHOWSAVER_H_
+#define EXAMPLES_ASYNCSHOWSAVER_H_
+
+/**
+ * Wraps another ShowSaverInterface and runs it on a writer thread.
+ *
+ * NewFrame() copies the frame into a preallocated slot in a lock free queue
+ * and returns, so a slow disk doesn't block the thread receiving the DMX
+ * data. If the queue is full the frame is dropped. NewFrame() must only be
+ * called from one thread.
+ */
+class AsyncShowSaver : public ShowSaverInterface,
+                       private ola::thread::Thread {
+ public:
+  struct Options {
+    /**
+     * The number of frames that can be queued for the writer thread.
+     */
+    unsigned int queue_size;
+
+    /**
+     * How often the file is flushed, in ms.
+     */
+    unsigned int flush_interval;
+
+    /**
+     * How often the file is fsync()ed, in ms. 0 means never.
+     */
+    unsigned int sync_interval;
+
+    Options()
+        : queue_size(DEFAULT_QUEUE_SIZE),
+          flush_interval(DEFAULT_FLUSH_INTERVAL_MS),
+          sync_interval(0) {
+    }
+  };
+
+  /**
+   * @param saver the saver to write to, ownership is transferred.
+   * @param options the Options to use.
+   */
+  AsyncShowSaver(ShowSaverInterface *saver, const Options &options);
+  ~AsyncShowSaver();
+
+  bool Open();
+  void Close();
+
+  bool NewFrame(const ola::TimeStamp &arrival_time,
+                unsigned int universe,
+                const ola::DmxBuffer &data);
+
+  /**
+   * Ask the writer thread to flush at the next opportunity.
+   */
+  bool Flush(bool sync);
+
+  /**
+   * The number of frames passed to the writer thread.
+   */
+  uint64_t QueuedFrames() const;
+
+  /**
+   * The number of frames the writer thread has written.
+   */
+  uint64_t WrittenFrames() const;
+
+  /**
+   * The number of frames dropped because the queue was full.
+   */
+  uint64_t DroppedFrames() const;
+
+  static const unsigned int DEFAULT_QUEUE_SIZE = 4096;
+  static const unsigned int DEFAULT_FLUSH_INTERVAL_MS = 1000;
+
+ private:
+  struct Frame {
+    ola::TimeStamp arrival_time;
+    unsigned int universe;
+    unsigned int length;
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  };
+
+  std::auto_ptr<ShowSaverInterface> m_saver;
+  const Options m_options;
+  ola::thread::SPSCQueue<Frame> m_queue;
+  ola::Clock m_clock;
+  bool m_running;
+
+  // Protects m_stopping & m_flush_requested, and lets the producer wake the
+  // writer thread.
+  ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_condition;
+  bool m_stopping;
+  bool m_flush_requested;
+  bool m_sync_requested;
+
+  // These are read by the producer and written with atomic operations.
+  uint64_t m_queued_frames;
+  uint64_t m_written_frames;
+  uint64_t m_dropped_frames;
+
+  // Only used by the writer thread.
+  ola::DmxBuffer m_buffer;
+
+  void *Run();
+  void WriteQueuedFrames();
+
+  // How long the writer thread waits for new frames.
+  static const unsigned int POLL_INTERVAL_MS = 10;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncShowSaver);
+};
+#endif  // EXAMPLES_ASYNCSHOWSAVER_H_
@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowFormat.h
+ * The on disk layout of binary show files.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * A binary show file is:
+ *   show_file_header
+ *   records, each a show_frame_header followed by payload_length bytes
+ *   the index, an index_header followed by entry_count index_entry
+ *
+ * All values are in network byte order. The timestamp of each record is the
+ * number of ms since the first frame of the show.
+ *
+ * Every snapshot_interval ms the saver writes a snapshot, which is a
+ * SNAPSHOT_RECORD for every universe seen so far. Each snapshot has an entry
+ * in the index, so playback can start from any point by finding the last
+ * snapshot before it. The index is written when the show is closed; if it's
+ * missing, the loader rebuilds it by scanning the records.
+ */
+
+#include <ola/base/Macro.h>
+#include <stdint.h>
+
+#ifndef EXAMPLES_BINARYSHOWFORMAT_H_
+#define EXAMPLES_BINARYSHOWFORMAT_H_
+
+namespace binary_show {
+
+static const char SHOW_MAGIC[] = "OLASHOW";  // includes the NULL
+static const uint16_t SHOW_VERSION = 1;
+static const char INDEX_MAGIC[] = "OLAIDX";
+
+// The default time between snapshots.
+static const uint32_t DEFAULT_SNAPSHOT_INTERVAL_MS = 1000;
+
+typedef enum {
+  FRAME_RECORD = 0,  // a frame that was received
+  SNAPSHOT_RECORD = 1,  // the state of a universe at a snapshot
+} record_type;
+
+typedef enum {
+  ENCODING_RAW = 0,  // the slot data
+  ENCODING_RLE = 1,  // the RunLengthEncoder format
+  // The RunLengthEncoder format of the previous frame for the universe XORed
+  // with this frame.
+  ENCODING_DELTA = 2,
+} payload_encoding;
+
+PACK(
+struct show_file_header_s {
+  char magic[8];
+  uint16_t version;
+  uint16_t reserved;
+  uint32_t snapshot_interval;
+  // The offset of the index, or 0 if the index wasn't written.
+  uint32_t index_offset_high;
+  uint32_t index_offset_low;
+});
+typedef struct show_file_header_s show_file_header;
+
+PACK(
+struct show_frame_header_s {
+  uint32_t timestamp;
+  uint32_t universe;
+  uint8_t type;
+  uint8_t encoding;
+  uint16_t slot_count;
+  uint16_t payload_length;
+});
+typedef struct show_frame_header_s show_frame_header;
+
+PACK(
+struct index_header_s {
+  char magic[7];
+  uint8_t reserved;
+  uint32_t entry_count;
+});
+typedef struct index_header_s index_header;
+
+PACK(
+struct index_entry_s {
+  uint32_t timestamp;
+  uint32_t offset_high;
+  uint32_t offset_low;
+});
+typedef struct index_entry_s index_entry;
+}  // namespace binary_show
+#endif  // EXAMPLES_BINARYSHOWFORMAT_H_
@@ -0,0 +1,435 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowLoader.cpp
+ * Plays back binary show files.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif  // HAVE_SYS_MMAN_H
+
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/network/NetworkUtils.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+#include "examples/BinaryShowLoader.h"
+
+using ola::DmxBuffer;
+using ola::network::NetworkToHost;
+using std::string;
+using std::vector;
+using binary_show::ENCODING_DELTA;
+using binary_show::ENCODING_RAW;
+using binary_show::ENCODING_RLE;
+using binary_show::INDEX_MAGIC;
+using binary_show::SHOW_MAGIC;
+using binary_show::SHOW_VERSION;
+using binary_show::SNAPSHOT_RECORD;
+using binary_show::index_entry;
+using binary_show::index_header;
+using binary_show::show_file_header;
+using binary_show::show_frame_header;
+
+
+BinaryShowLoader::BinaryShowLoader(const string &filename)
+    : m_filename(filename),
+      m_data(NULL),
+      m_size(0),
+      m_mapped(false),
+      m_records_end(0),
+      m_position(FIRST_RECORD),
+      m_current_time(0) {
+}
+
+
+BinaryShowLoader::~BinaryShowLoader() {
+  UnmapFile();
+}
+
+
+bool BinaryShowLoader::Load() {
+  if (!MapFile()) {
+    return false;
+  }
+
+  show_file_header header;
+  if (m_size < sizeof(header)) {
+    OLA_WARN << m_filename << " is too short to be a show file";
+    return false;
+  }
+  memcpy(&header, m_data, sizeof(header));
+  if (memcmp(header.magic, SHOW_MAGIC, sizeof(header.magic))) {
+    OLA_WARN << m_filename << " isn't a binary show file";
+    return false;
+  }
+  if (NetworkToHost(header.version) != SHOW_VERSION) {
+    OLA_WARN << m_filename << " has an unknown version "
+             << NetworkToHost(header.version);
+    return false;
+  }
+
+  const uint64_t index_offset =
+      (static_cast<uint64_t>(NetworkToHost(header.index_offset_high)) << 32) |
+      NetworkToHost(header.index_offset_low);
+  if (!LoadIndex(index_offset)) {
+    OLA_INFO << m_filename << " doesn't have a valid index, it may not have "
+             << "been closed cleanly. Scanning the file instead.";
+    BuildIndex();
+  }
+  Reset();
+  return true;
+}
+
+
+void BinaryShowLoader::Reset() {
+  m_position = FIRST_RECORD;
+  m_current_time = 0;
+  m_universes.clear();
+  m_pending.clear();
+}
+
+
+/*
+ * Find the last snapshot before the offset, then apply the frames up to the
+ * offset. Once that's done the state of each universe is sent.
+ */
+bool BinaryShowLoader::Seek(unsigned int offset_ms) {
+  Reset();
+  if (m_index.empty()) {
+    return true;
+  }
+
+  IndexEntry target = {offset_ms, 0};
+  vector<IndexEntry>::const_iterator iter = std::upper_bound(
+      m_index.begin(), m_index.end(), target);
+  if (iter != m_index.begin()) {
+    --iter;
+  }
+  m_position = iter->offset;
+
+  Record record;
+  while (ReadRecord(m_position, &record) && record.timestamp <= offset_ms) {
+    if (!ApplyRecord(record)) {
+      return false;
+    }
+    m_position += sizeof(show_frame_header) + record.payload_length;
+  }
+
+  m_current_time = offset_ms;
+  UniverseMap::const_iterator universe_iter = m_universes.begin();
+  for (; universe_iter != m_universes.end(); ++universe_iter) {
+    m_pending.push_back(universe_iter->first);
+  }
+  return true;
+}
+
+
+BinaryShowLoader::State BinaryShowLoader::NextTimeout(unsigned int *timeout) {
+  if (!m_pending.empty()) {
+    *timeout = 0;
+    return OK;
+  }
+
+  Record record;
+  if (!ReadRecord(m_position, &record)) {
+    return END_OF_FILE;
+  }
+  *timeout = record.timestamp > m_current_time ?
+      record.timestamp - m_current_time : 0;
+  return OK;
+}
+
+
+BinaryShowLoader::State BinaryShowLoader::NextFrame(unsigned int *universe,
+                                                    DmxBuffer *data) {
+  if (!m_pending.empty()) {
+    *universe = m_pending.front();
+    m_pending.pop_front();
+    const DmxBuffer &state = m_universes[*universe];
+    data->Set(state.GetRaw(), state.Size());
+    return OK;
+  }
+
+  Record record;
+  while (ReadRecord(m_position, &record)) {
+    if (!ApplyRecord(record)) {
+      OLA_WARN << "Invalid record at offset " << m_position;
+      return INVALID_LINE;
+    }
+    m_position += sizeof(show_frame_header) + record.payload_length;
+    // Snapshots repeat the current state, so they aren't sent.
+    if (record.type == SNAPSHOT_RECORD) {
+      continue;
+    }
+
+    m_current_time = record.timestamp;
+    *universe = record.universe;
+    const DmxBuffer &state = m_universes[record.universe];
+    data->Set(state.GetRaw(), state.Size());
+    return OK;
+  }
+  return END_OF_FILE;
+}
+
+
+bool BinaryShowLoader::IsBinaryShow(const string &filename) {
+  std::ifstream show_file(filename.data(), std::ios::in | std::ios::binary);
+  char magic[sizeof(SHOW_MAGIC)];
+  if (!show_file.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return memcmp(magic, SHOW_MAGIC, sizeof(magic)) == 0;
+}
+
+
+bool BinaryShowLoader::MapFile() {
+  UnmapFile();
+  int fd = open(m_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) < 0) {
+    OLA_FATAL << "Can't stat " << m_filename << ": " << strerror(errno);
+    close(fd);
+    return false;
+  }
+  m_size = file_stat.st_size;
+  if (m_size == 0) {
+    close(fd);
+    return true;
+  }
+
+#ifdef HAVE_SYS_MMAN_H
+  void *memory = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory != MAP_FAILED) {
+    close(fd);
+    m_data = reinterpret_cast<const uint8_t*>(memory);
+    m_mapped = true;
+    return true;
+  }
+  OLA_INFO << "mmap(" << m_filename << ") failed: " << strerror(errno)
+           << ", reading the file instead";
+#endif  // HAVE_SYS_MMAN_H
+
+  m_file_data.resize(m_size);
+  size_t offset = 0;
+  while (offset < m_size) {
+    ssize_t bytes_read = read(fd, &m_file_data[offset], m_size - offset);
+    if (bytes_read <= 0) {
+      OLA_FATAL << "Can't read " << m_filename << ": " << strerror(errno);
+      close(fd);
+      m_file_data.clear();
+      m_size = 0;
+      return false;
+    }
+    offset += bytes_read;
+  }
+  close(fd);
+  m_data = &m_file_data[0];
+  return true;
+}
+
+
+void BinaryShowLoader::UnmapFile() {
+#ifdef HAVE_SYS_MMAN_H
+  if (m_mapped) {
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+#endif  // HAVE_SYS_MMAN_H
+  m_mapped = false;
+  m_data = NULL;
+  m_size = 0;
+  m_file_data.clear();
+}
+
+
+bool BinaryShowLoader::LoadIndex(uint64_t index_offset) {
+  m_index.clear();
+  m_records_end = index_offset;
+
+  index_header header;
+  if (index_offset < FIRST_RECORD || index_offset > m_size ||
+      m_size - index_offset < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, m_data + index_offset, sizeof(header));
+  if (memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic))) {
+    return false;
+  }
+
+  const uint64_t entry_count = NetworkToHost(header.entry_count);
+  const uint8_t *entries = m_data + index_offset + sizeof(header);
+  if ((m_size - index_offset - sizeof(header)) / sizeof(index_entry) <
+      entry_count) {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < entry_count; i++) {
+    index_entry entry;
+    memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+    IndexEntry index_entry = {
+      NetworkToHost(entry.timestamp),
+      (static_cast<uint64_t>(NetworkToHost(entry.offset_high)) << 32) |
+          NetworkToHost(entry.offset_low)
+    };
+    if (index_entry.offset < FIRST_RECORD ||
+        index_entry.offset > m_records_end ||
+        (!m_index.empty() &&
+         (index_entry.timestamp < m_index.back().timestamp ||
+          index_entry.offset < m_index.back().offset))) {
+      m_index.clear();
+      return false;
+    }
+    m_index.push_back(index_entry);
+  }
+  return true;
+}
+
+
+/*
+ * Scan the records to find the snapshots. This also finds the end of the
+ * records, if the last one was only partly written.
+ */
+void BinaryShowLoader::BuildIndex() {
+  m_index.clear();
+  m_records_end = m_size;
+
+  IndexEntry start = {0, FIRST_RECORD};
+  m_index.push_back(start);
+
+  uint64_t offset = FIRST_RECORD;
+  bool in_snapshot = false;
+  Record record;
+  while (ReadRecord(offset, &record)) {
+    if (record.type == SNAPSHOT_RECORD) {
+      if (!in_snapshot) {
+        IndexEntry entry = {record.timestamp, offset};
+        m_index.push_back(entry);
+      }
+      in_snapshot = true;
+    } else {
+      in_snapshot = false;
+    }
+    offset += sizeof(show_frame_header) + record.payload_length;
+  }
+  m_records_end = offset;
+}
+
+
+bool BinaryShowLoader::ReadRecord(uint64_t offset, Record *record) const {
+  show_frame_header header;
+  if (offset > m_records_end || m_records_end - offset < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, m_data + offset, sizeof(header));
+
+  record->timestamp = NetworkToHost(header.timestamp);
+  record->universe = NetworkToHost(header.universe);
+  record->type = header.type;
+  record->encoding = header.encoding;
+  record->slot_count = NetworkToHost(header.slot_count);
+  record->payload_length = NetworkToHost(header.payload_length);
+  record->payload = m_data + offset + sizeof(header);
+  return (m_records_end - offset - sizeof(header) >= record->payload_length &&
+          record->slot_count <= ola::DMX_UNIVERSE_SIZE);
+}
+
+
+/*
+ * Update the state of the universe with a record.
+ */
+bool BinaryShowLoader::ApplyRecord(const Record &record) {
+  DmxBuffer &state = m_universes[record.universe];
+  switch (record.encoding) {
+    case ENCODING_RAW:
+      if (record.payload_length != record.slot_count) {
+        return false;
+      }
+      return state.Set(record.payload, record.payload_length);
+    case ENCODING_RLE:
+      if (!DecodeRLE(record)) {
+        return false;
+      }
+      return state.Set(m_scratch.GetRaw(), record.slot_count);
+    case ENCODING_DELTA:
+      {
+        if (state.Size() != record.slot_count || !DecodeRLE(record)) {
+          return false;
+        }
+        uint8_t data[ola::DMX_UNIVERSE_SIZE];
+        const uint8_t *current = state.GetRaw();
+        const uint8_t *changes = m_scratch.GetRaw();
+        for (unsigned int i = 0; i < record.slot_count; i++) {
+          data[i] = current[i] ^ changes[i];
+        }
+        return state.Set(data, record.slot_count);
+      }
+    default:
+      return false;
+  }
+}
+
+
+/*
+ * Decode the RLE payload of a record into m_scratch. The RunLengthEncoder
+ * trusts its input, so check the segments first.
+ */
+bool BinaryShowLoader::DecodeRLE(const Record &record) {
+  const uint8_t REPEAT_FLAG = 0x80;
+  unsigned int slots = 0;
+  unsigned int i = 0;
+  while (i < record.payload_length) {
+    const unsigned int segment_length = record.payload[i] & ~REPEAT_FLAG;
+    const unsigned int data_length = record.payload[i] & REPEAT_FLAG ?
+        1 : segment_length;
+    i++;
+    if (record.payload_length - i < data_length) {
+      return false;
+    }
+    i += data_length;
+    slots += segment_length;
+  }
+  if (slots != record.slot_count) {
+    return false;
+  }
+
+  // Decode() needs an allocated buffer, the first slot_count slots are then
+  // overwritten.
+  m_scratch.Blackout();
+  return m_encoder.Decode(0, record.payload, record.payload_length,
+                          &m_scratch);
+}
@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowLoader.h
+ * Plays back binary show files.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/DmxBuffer.h>
+#include <ola/dmx/RunLengthEncoder.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+#include "examples/ShowLoader.h"
+
+#ifndef EXAMPLES_BINARYSHOWLOADER_H_
+#define EXAMPLES_BINARYSHOWLOADER_H_
+
+/**
+ * Reads the binary show format, see BinaryShowFormat.h.
+ *
+ * The file is memory mapped, and the index of snapshots is used to seek.
+ */
+class BinaryShowLoader : public ShowLoaderInterface {
+ public:
+  explicit BinaryShowLoader(const std::string &filename);
+  ~BinaryShowLoader();
+
+  bool Load();
+  void Reset();
+  bool Seek(unsigned int offset_ms);
+
+  State NextTimeout(unsigned int *timeout);
+  State NextFrame(unsigned int *universe, ola::DmxBuffer *data);
+
+  /**
+   * @brief Check if a file is a binary show file.
+   */
+  static bool IsBinaryShow(const std::string &filename);
+
+ private:
+  struct IndexEntry {
+    uint32_t timestamp;
+    uint64_t offset;
+
+    bool operator<(const IndexEntry &other) const {
+      return timestamp < other.timestamp;
+    }
+  };
+
+  struct Record {
+    uint32_t timestamp;
+    unsigned int universe;
+    uint8_t type;
+    uint8_t encoding;
+    unsigned int slot_count;
+    const uint8_t *payload;
+    unsigned int payload_length;
+  };
+
+  typedef std::map<unsigned int, ola::DmxBuffer> UniverseMap;
+
+  const std::string m_filename;
+  const uint8_t *m_data;
+  size_t m_size;
+  bool m_mapped;
+  std::vector<uint8_t> m_file_data;  // used if mmap isn't available
+  uint64_t m_records_end;
+  std::vector<IndexEntry> m_index;
+
+  uint64_t m_position;
+  uint32_t m_current_time;
+  // The state of each universe.
+  UniverseMap m_universes;
+  // The universes to send after a seek.
+  std::deque<unsigned int> m_pending;
+  ola::dmx::RunLengthEncoder m_encoder;
+  ola::DmxBuffer m_scratch;
+
+  bool MapFile();
+  void UnmapFile();
+  bool LoadIndex(uint64_t index_offset);
+  void BuildIndex();
+  bool ReadRecord(uint64_t offset, Record *record) const;
+  bool ApplyRecord(const Record &record);
+  bool DecodeRLE(const Record &record);
+
+  static const uint64_t FIRST_RECORD = sizeof(binary_show::show_file_header);
+};
+#endif  // EXAMPLES_BINARYSHOWLOADER_H_
@@ -0,0 +1,244 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowSaver.cpp
+ * Writes show data to a binary file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/network/NetworkUtils.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+#include "examples/BinaryShowSaver.h"
+
+using ola::DmxBuffer;
+using ola::network::HostToNetwork;
+using std::string;
+using std::vector;
+using binary_show::ENCODING_DELTA;
+using binary_show::ENCODING_RAW;
+using binary_show::ENCODING_RLE;
+using binary_show::FRAME_RECORD;
+using binary_show::INDEX_MAGIC;
+using binary_show::SHOW_MAGIC;
+using binary_show::SHOW_VERSION;
+using binary_show::SNAPSHOT_RECORD;
+using binary_show::index_entry;
+using binary_show::index_header;
+using binary_show::payload_encoding;
+using binary_show::record_type;
+using binary_show::show_file_header;
+using binary_show::show_frame_header;
+
+
+BinaryShowSaver::BinaryShowSaver(const string &filename,
+                                 unsigned int snapshot_interval)
+    : m_filename(filename),
+      m_snapshot_interval(snapshot_interval),
+      m_offset(0),
+      m_last_snapshot(0) {
+}
+
+
+BinaryShowSaver::~BinaryShowSaver() {
+  Close();
+}
+
+
+bool BinaryShowSaver::Open() {
+  m_show_file.open(m_filename.data(), std::ios::out | std::ios::binary);
+  if (!m_show_file.is_open()) {
+    OLA_FATAL << "Can't open " << m_filename << ": " << strerror(errno);
+    return false;
+  }
+
+  show_file_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SHOW_MAGIC, sizeof(header.magic));
+  header.version = HostToNetwork(SHOW_VERSION);
+  header.snapshot_interval = HostToNetwork(
+      static_cast<uint32_t>(m_snapshot_interval));
+  m_offset = 0;
+  Write(&header, sizeof(header));
+
+  // Seeking to a time before the first snapshot starts from the beginning.
+  index_entry entry;
+  entry.timestamp = 0;
+  entry.offset_high = 0;
+  entry.offset_low = HostToNetwork(static_cast<uint32_t>(m_offset));
+  m_index.push_back(entry);
+  return true;
+}
+
+
+void BinaryShowSaver::Close() {
+  if (!m_show_file.is_open()) {
+    return;
+  }
+
+  const uint64_t index_offset = m_offset;
+  WriteIndex();
+
+  // Now the index is complete, point the header at it.
+  const uint32_t offset[] = {
+    HostToNetwork(static_cast<uint32_t>(index_offset >> 32)),
+    HostToNetwork(static_cast<uint32_t>(index_offset)),
+  };
+  m_show_file.seekp(offsetof(show_file_header, index_offset_high));
+  m_show_file.write(reinterpret_cast<const char*>(offset), sizeof(offset));
+  m_show_file.close();
+  m_universes.clear();
+  m_index.clear();
+}
+
+
+bool BinaryShowSaver::Flush(bool sync) {
+  if (!m_show_file.flush()) {
+    return false;
+  }
+  return sync ? SyncFile(m_filename) : true;
+}
+
+
+bool BinaryShowSaver::NewFrame(const ola::TimeStamp &arrival_time,
+                               unsigned int universe,
+                               const DmxBuffer &data) {
+  if (!m_start_time.IsSet()) {
+    m_start_time = arrival_time;
+  }
+  const uint32_t timestamp = static_cast<uint32_t>(
+      (arrival_time - m_start_time).InMilliSeconds());
+
+  if (!m_universes.empty() &&
+      timestamp - m_last_snapshot >= m_snapshot_interval) {
+    WriteSnapshot(timestamp);
+  }
+
+  UniverseMap::iterator iter = m_universes.find(universe);
+  const DmxBuffer *previous = NULL;
+  if (iter != m_universes.end()) {
+    previous = &iter->second;
+  }
+  if (!WriteRecord(timestamp, universe, FRAME_RECORD, data, previous)) {
+    return false;
+  }
+  // Copy the data, rather than sharing the caller's buffer.
+  m_universes[universe].Set(data.GetRaw(), data.Size());
+  return true;
+}
+
+
+/*
+ * Write the current state of every universe, so playback can start here.
+ */
+void BinaryShowSaver::WriteSnapshot(uint32_t timestamp) {
+  index_entry entry;
+  entry.timestamp = HostToNetwork(timestamp);
+  entry.offset_high = HostToNetwork(static_cast<uint32_t>(m_offset >> 32));
+  entry.offset_low = HostToNetwork(static_cast<uint32_t>(m_offset));
+  m_index.push_back(entry);
+
+  UniverseMap::const_iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter) {
+    WriteRecord(timestamp, iter->first, SNAPSHOT_RECORD, iter->second, NULL);
+  }
+  m_last_snapshot = timestamp;
+}
+
+
+/*
+ * Write a record, using whichever encoding is smallest.
+ * @param previous the last frame for the universe, or NULL if this frame
+ *   can't be delta encoded.
+ */
+bool BinaryShowSaver::WriteRecord(uint32_t timestamp,
+                                  unsigned int universe,
+                                  record_type type,
+                                  const DmxBuffer &data,
+                                  const DmxBuffer *previous) {
+  const unsigned int size = data.Size();
+  payload_encoding encoding = ENCODING_RAW;
+  const uint8_t *payload = data.GetRaw();
+  unsigned int payload_length = size;
+
+  // The encoding is only used if it's smaller than the raw data.
+  unsigned int rle_length = size;
+  if (size && m_encoder.Encode(data, m_payload, &rle_length) &&
+      rle_length < payload_length) {
+    encoding = ENCODING_RLE;
+    payload = m_payload;
+    payload_length = rle_length;
+  }
+
+  uint8_t delta_payload[ola::DMX_UNIVERSE_SIZE];
+  if (size && previous && previous->Size() == size) {
+    uint8_t changes[ola::DMX_UNIVERSE_SIZE];
+    const uint8_t *current = data.GetRaw();
+    const uint8_t *last = previous->GetRaw();
+    for (unsigned int i = 0; i < size; i++) {
+      changes[i] = current[i] ^ last[i];
+    }
+
+    unsigned int delta_length = payload_length;
+    if (m_encoder.Encode(DmxBuffer(changes, size), delta_payload,
+                         &delta_length) &&
+        delta_length < payload_length) {
+      encoding = ENCODING_DELTA;
+      payload = delta_payload;
+      payload_length = delta_length;
+    }
+  }
+
+  show_frame_header header;
+  header.timestamp = HostToNetwork(timestamp);
+  header.universe = HostToNetwork(static_cast<uint32_t>(universe));
+  header.type = type;
+  header.encoding = encoding;
+  header.slot_count = HostToNetwork(static_cast<uint16_t>(size));
+  header.payload_length = HostToNetwork(static_cast<uint16_t>(payload_length));
+  Write(&header, sizeof(header));
+  Write(payload, payload_length);
+  if (!m_show_file.good()) {
+    OLA_WARN << "Failed to write to " << m_filename;
+    return false;
+  }
+  return true;
+}
+
+
+void BinaryShowSaver::WriteIndex() {
+  index_header header;
+  memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+  header.reserved = 0;
+  header.entry_count = HostToNetwork(static_cast<uint32_t>(m_index.size()));
+  Write(&header, sizeof(header));
+  if (!m_index.empty()) {
+    Write(&m_index[0], m_index.size() * sizeof(index_entry));
+  }
+}
+
+
+void BinaryShowSaver::Write(const void *data, unsigned int length) {
+  m_show_file.write(reinterpret_cast<const char*>(data), length);
+  m_offset += length;
+}
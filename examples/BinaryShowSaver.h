@@ -0,0 +1,80 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * BinaryShowSaver.h
+ * Writes show data to a binary file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Clock.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/dmx/RunLengthEncoder.h>
+#include <stdint.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "examples/BinaryShowFormat.h"
+#include "examples/ShowSaver.h"
+
+#ifndef EXAMPLES_BINARYSHOWSAVER_H_
+#define EXAMPLES_BINARYSHOWSAVER_H_
+
+/**
+ * Write show data in the binary format, see BinaryShowFormat.h.
+ */
+class BinaryShowSaver : public ShowSaverInterface {
+ public:
+  explicit BinaryShowSaver(
+      const std::string &filename,
+      unsigned int snapshot_interval =
+          binary_show::DEFAULT_SNAPSHOT_INTERVAL_MS);
+  ~BinaryShowSaver();
+
+  bool Open();
+  void Close();
+
+  bool NewFrame(const ola::TimeStamp &arrival_time,
+                unsigned int universe,
+                const ola::DmxBuffer &data);
+  bool Flush(bool sync);
+
+ private:
+  typedef std::map<unsigned int, ola::DmxBuffer> UniverseMap;
+
+  const std::string m_filename;
+  const unsigned int m_snapshot_interval;
+  std::ofstream m_show_file;
+  uint64_t m_offset;
+  ola::TimeStamp m_start_time;
+  uint32_t m_last_snapshot;
+  // The last frame written for each universe.
+  UniverseMap m_universes;
+  std::vector<binary_show::index_entry> m_index;
+  ola::dmx::RunLengthEncoder m_encoder;
+  uint8_t m_payload[ola::DMX_UNIVERSE_SIZE];
+
+  void WriteSnapshot(uint32_t timestamp);
+  bool WriteRecord(uint32_t timestamp, unsigned int universe,
+                   binary_show::record_type type,
+                   const ola::DmxBuffer &data,
+                   const ola::DmxBuffer *previous);
+  void WriteIndex();
+  void Write(const void *data, unsigned int length);
+};
+#endif  // EXAMPLES_BINARYSHOWSAVER_H_
@@ -72,6 +72,13 @@ examples_ola_rdm_discover_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 examples_ola_recorder_SOURCES = \
     examples/ola-recorder.cpp \
+    examples/AsyncShowSaver.h \
+    examples/AsyncShowSaver.cpp \
+    examples/BinaryShowFormat.h \
+    examples/BinaryShowLoader.h \
+    examples/BinaryShowLoader.cpp \
+    examples/BinaryShowSaver.h \
+    examples/BinaryShowSaver.cpp \
     examples/ShowLoader.h \
     examples/ShowLoader.cpp \
     examples/ShowPlayer.h \
@@ -79,7 +86,9 @@ examples_ola_recorder_SOURCES = \
     examples/ShowRecorder.h \
     examples/ShowRecorder.cpp \
     examples/ShowSaver.h \
-    examples/ShowSaver.cpp
+    examples/ShowSaver.cpp \
+    examples/TimeCodeReceiver.h \
+    examples/TimeCodeReceiver.cpp
 examples_ola_recorder_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 examples_ola_timecode_SOURCES = examples/ola-timecode.cpp
@@ -96,11 +105,14 @@ examples_ola_dmxmonitor_SOURCES = examples/ola-dmxmonitor.cpp
 examples_ola_dmxmonitor_LDADD = $(EXAMPLE_COMMON_LIBS) -lncurses
 endif
 
-noinst_PROGRAMS += examples/ola_throughput examples/ola_latency
+noinst_PROGRAMS += examples/ola_throughput examples/ola_latency \
+                   examples/ola_replay
 examples_ola_throughput_SOURCES = examples/ola-throughput.cpp
 examples_ola_throughput_LDADD = $(EXAMPLE_COMMON_LIBS)
 examples_ola_latency_SOURCES = examples/ola-latency.cpp
 examples_ola_latency_LDADD = $(EXAMPLE_COMMON_LIBS)
+examples_ola_replay_SOURCES = examples/ola-replay.cpp
+examples_ola_replay_LDADD = $(EXAMPLE_COMMON_LIBS)
 
 if USING_WIN32
 # rename this program, otherwise UAC will block it
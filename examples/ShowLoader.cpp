@@ -28,6 +28,7 @@
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
+#include <ola/base/Macro.h>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -35,6 +36,7 @@
 #include <string>
 #include <vector>
 
+#include "examples/BinaryShowLoader.h"
 #include "examples/ShowLoader.h"
 
 using std::vector;
@@ -44,6 +46,13 @@ using ola::DmxBuffer;
 
 const char ShowLoader::OLA_SHOW_HEADER[] = "OLA Show";
 
+ShowLoaderInterface *ShowLoaderInterface::NewLoader(const string &filename) {
+  if (BinaryShowLoader::IsBinaryShow(filename)) {
+    return new BinaryShowLoader(filename);
+  }
+  return new ShowLoader(filename);
+}
+
 ShowLoader::ShowLoader(const string &filename)
     : m_filename(filename),
       m_line(0) {
@@ -95,6 +104,12 @@ void ShowLoader::Reset() {
  * Get the next time offset
  * @param timeout a pointer to the timeout in ms
  */
+bool ShowLoader::Seek(OLA_UNUSED unsigned int offset_ms) {
+  OLA_WARN << "Seeking needs a binary show file, use --convert to create one";
+  return false;
+}
+
+
 ShowLoader::State ShowLoader::NextTimeout(unsigned int *timeout) {
   string line;
   ReadLine(&line);
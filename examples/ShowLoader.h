@@ -27,12 +27,12 @@
 #define EXAMPLES_SHOWLOADER_H_
 
 /**
- * Loads a show file and reads the DMX data.
+ * The interface for reading show files. Frames and timeouts alternate, the
+ * timeout is the delay in ms between one frame and the next.
  */
-class ShowLoader {
+class ShowLoaderInterface {
  public:
-  explicit ShowLoader(const std::string &filename);
-  ~ShowLoader();
+  virtual ~ShowLoaderInterface() {}
 
   typedef enum {
     OK,
@@ -40,8 +40,37 @@ class ShowLoader {
     END_OF_FILE,
   } State;
 
+  virtual bool Load() = 0;
+  virtual void Reset() = 0;
+
+  /**
+   * Move to a time in the show, the next frames are the state of each
+   * universe at that time.
+   * @returns false if the loader can't seek.
+   */
+  virtual bool Seek(unsigned int offset_ms) = 0;
+
+  virtual State NextTimeout(unsigned int *timeout) = 0;
+  virtual State NextFrame(unsigned int *universe, ola::DmxBuffer *data) = 0;
+
+  /**
+   * Create a loader for either the text or the binary format.
+   */
+  static ShowLoaderInterface *NewLoader(const std::string &filename);
+};
+
+
+/**
+ * Reads the text show format.
+ */
+class ShowLoader : public ShowLoaderInterface {
+ public:
+  explicit ShowLoader(const std::string &filename);
+  ~ShowLoader();
+
   bool Load();
   void Reset();
+  bool Seek(unsigned int offset_ms);
 
   State NextTimeout(unsigned int *timeout);
   State NextFrame(unsigned int *universe, ola::DmxBuffer *data);
@@ -30,8 +30,8 @@
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
 #include <ola/base/SysExits.h>
-#include <ola/client/ClientWrapper.h>
-#include <ola/client/OlaClient.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/timecode/TimeCodeEnums.h>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -42,16 +42,55 @@
 using std::vector;
 using std::string;
 using ola::DmxBuffer;
+using ola::client::StreamingClient;
+using ola::timecode::TimeCode;
+
+namespace {
+
+/*
+ * Convert a timecode to ms. Drop frame timecode skips frame numbers 0 and 1
+ * at the start of each minute, except every tenth minute, so it's converted
+ * to a frame count first.
+ */
+uint64_t TimeCodeToMs(const TimeCode &timecode) {
+  const uint64_t minutes = timecode.Hours() * 60 + timecode.Minutes();
+  const uint64_t seconds = minutes * 60 + timecode.Seconds();
+  switch (timecode.Type()) {
+    case ola::timecode::TIMECODE_FILM:
+      return seconds * 1000 + timecode.Frames() * 1000 / 24;
+    case ola::timecode::TIMECODE_EBU:
+      return seconds * 1000 + timecode.Frames() * 1000 / 25;
+    case ola::timecode::TIMECODE_DF:
+      {
+        const uint64_t frames = seconds * 30 + timecode.Frames() -
+                                2 * (minutes - minutes / 10);
+        return frames * 1001 / 30;
+      }
+    case ola::timecode::TIMECODE_SMPTE:
+    default:
+      return seconds * 1000 + timecode.Frames() * 1000 / 30;
+  }
+}
+}  // namespace
 
 
 ShowPlayer::ShowPlayer(const string &filename)
-    : m_loader(filename),
+    : m_filename(filename),
       m_infinite_loop(false),
       m_iteration_remaining(0),
-      m_loop_delay(0) {
+      m_loop_delay(0),
+      m_show_time(0),
+      m_frame_timeout(ola::thread::INVALID_TIMEOUT),
+      m_chasing(false),
+      m_timecode_offset(0),
+      m_running(false),
+      m_at_end(false),
+      m_loss_timeout(ola::thread::INVALID_TIMEOUT) {
 }
 
-ShowPlayer::~ShowPlayer() {}
+ShowPlayer::~ShowPlayer() {
+  m_client.Stop();
+}
 
 int ShowPlayer::Init() {
   if (!m_client.Setup()) {
@@ -59,7 +98,8 @@ int ShowPlayer::Init() {
     return ola::EXIT_UNAVAILABLE;
   }
 
-  if (!m_loader.Load()) {
+  m_loader.reset(ShowLoaderInterface::NewLoader(m_filename));
+  if (!m_loader->Load()) {
     return ola::EXIT_NOINPUT;
   }
 
@@ -68,72 +108,143 @@ int ShowPlayer::Init() {
 
 int ShowPlayer::Playback(unsigned int iterations,
                          unsigned int duration,
-                         unsigned int delay) {
+                         unsigned int delay,
+                         unsigned int start) {
+  if (start && !m_loader->Seek(start)) {
+    return ola::EXIT_USAGE;
+  }
   m_infinite_loop = iterations == 0 || duration != 0;
   m_iteration_remaining = iterations;
   m_loop_delay = delay;
-  SendNextFrame();
-
-  ola::io::SelectServer *ss = m_client.GetSelectServer();
+  m_clock.CurrentTime(&m_start_time);
+  m_show_time = 0;
+  SendNextFrames();
 
   if (duration != 0) {
-    ss->RegisterSingleTimeout(
+    m_ss.RegisterSingleTimeout(
         duration * 1000,
-        ola::NewSingleCallback(ss, &ola::io::SelectServer::Terminate));
+        ola::NewSingleCallback(&m_ss, &ola::io::SelectServer::Terminate));
   }
-  ss->Run();
+  m_ss.Run();
   return ola::EXIT_OK;
 }
 
-void ShowPlayer::SendNextFrame() {
-  DmxBuffer buffer;
-  unsigned int universe;
-  ShowLoader::State state = m_loader.NextFrame(&universe, &buffer);
-  switch (state) {
-    case ShowLoader::END_OF_FILE:
-      HandleEndOfFile();
-      return;
-    case ShowLoader::INVALID_LINE:
-      m_client.GetSelectServer()->Terminate();
-      return;
-    default:
-      {}
+int ShowPlayer::Chase(uint16_t port, unsigned int offset) {
+  if (!m_loader->Seek(0)) {
+    OLA_FATAL << "Chasing timecode needs a binary show file";
+    return ola::EXIT_USAGE;
   }
 
-  state = RegisterNextTimeout();
+  m_timecode_receiver.reset(new TimeCodeReceiver(
+      &m_ss, port, ola::NewCallback(this, &ShowPlayer::NewTimeCode)));
+  if (!m_timecode_receiver->Init()) {
+    OLA_FATAL << "Failed to listen for timecode on port " << port;
+    return ola::EXIT_UNAVAILABLE;
+  }
 
-  OLA_INFO << "Universe: " << universe << ": " << buffer.ToString();
-  ola::client::SendDMXArgs args;
-  m_client.GetClient()->SendDMX(universe, buffer, args);
+  m_chasing = true;
+  m_timecode_offset = offset;
+  m_ss.Run();
+  return ola::EXIT_OK;
+}
+
+/**
+ * Send all the frames due now, and schedule the next ones.
+ */
+void ShowPlayer::SendNextFrames() {
+  m_frame_timeout = ola::thread::INVALID_TIMEOUT;
+  unsigned int timeout = 0;
+  ShowLoaderInterface::State state = ReadFrames(&timeout);
+
+  if (!m_batch.empty()) {
+    if (!m_client.SendBatch(m_batch)) {
+      OLA_WARN << "Failed to send DMX to olad";
+    }
+    m_batch.clear();
+  }
 
   switch (state) {
-    case ShowLoader::END_OF_FILE:
+    case ShowLoaderInterface::END_OF_FILE:
+      if (m_chasing) {
+        // Wait for the timecode to move us somewhere else.
+        m_running = false;
+        m_at_end = true;
+        return;
+      }
       HandleEndOfFile();
       return;
-    case ShowLoader::INVALID_LINE:
-      m_client.GetSelectServer()->Terminate();
+    case ShowLoaderInterface::INVALID_LINE:
+      m_ss.Terminate();
       return;
     default:
       {}
   }
+
+  m_show_time += timeout;
+  ScheduleNextFrames();
 }
 
+/**
+ * Read frames until there's a non-zero timeout.
+ */
+ShowLoaderInterface::State ShowPlayer::ReadFrames(unsigned int *timeout) {
+  DmxBuffer buffer;
+  unsigned int universe;
+  while (true) {
+    ShowLoaderInterface::State state = m_loader->NextFrame(&universe, &buffer);
+    if (state != ShowLoaderInterface::OK) {
+      return state;
+    }
+    OLA_INFO << "Universe: " << universe << ": " << buffer.ToString();
+    AddToBatch(universe, buffer);
+
+    state = m_loader->NextTimeout(timeout);
+    if (state != ShowLoaderInterface::OK || *timeout) {
+      return state;
+    }
+  }
+}
 
 /**
- * Get the next time offset
+ * Add a frame to the batch, replacing any earlier frame for the universe.
  */
-ShowLoader::State ShowPlayer::RegisterNextTimeout() {
-  unsigned int timeout;
-  ShowLoader::State state = m_loader.NextTimeout(&timeout);
-  if (state != ShowLoader::OK) {
-    return state;
-  }
-
-  OLA_INFO << "Registering timeout for " << timeout << "ms";
-  m_client.GetSelectServer()->RegisterSingleTimeout(
-      timeout,
-      ola::NewSingleCallback(this, &ShowPlayer::SendNextFrame));
-  return state;
+void ShowPlayer::AddToBatch(unsigned int universe, const DmxBuffer &data) {
+  vector<StreamingClient::DmxUpdate>::iterator iter = m_batch.begin();
+  for (; iter != m_batch.end(); ++iter) {
+    if (iter->universe == universe) {
+      iter->data = data;
+      return;
+    }
+  }
+  m_batch.push_back(StreamingClient::DmxUpdate(universe, data));
+}
+
+/**
+ * Schedule the next frames for their deadline. If we've fallen behind they're
+ * sent straight away, the deadlines after that are unchanged so playback
+ * catches up.
+ */
+void ShowPlayer::ScheduleNextFrames() {
+  const ola::TimeStamp deadline = m_start_time + ola::TimeInterval(
+      static_cast<int64_t>(m_show_time * 1000));
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+
+  ola::TimeInterval delay;
+  if (deadline > now) {
+    delay = deadline - now;
+  }
+  OLA_INFO << "Registering timeout for " << delay;
+  m_frame_timeout = m_ss.RegisterSingleTimeout(
+      delay, ola::NewSingleCallback(this, &ShowPlayer::SendNextFrames));
+}
+
+
+void ShowPlayer::CancelNextFrames() {
+  if (m_frame_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss.RemoveTimeout(m_frame_timeout);
+    m_frame_timeout = ola::thread::INVALID_TIMEOUT;
+  }
 }
 
 
@@ -143,13 +254,93 @@ ShowLoader::State ShowPlayer::RegisterNextTimeout() {
 void ShowPlayer::HandleEndOfFile() {
   m_iteration_remaining--;
   if (m_infinite_loop || m_iteration_remaining > 0) {
-    m_loader.Reset();
-    m_client.GetSelectServer()->RegisterSingleTimeout(
-        m_loop_delay,
-        ola::NewSingleCallback(this, &ShowPlayer::SendNextFrame));
+    m_loader->Reset();
+    // The next iteration starts after the loop delay, measured from the end of
+    // this one.
+    m_start_time = m_start_time + ola::TimeInterval(
+        static_cast<int64_t>((m_show_time + m_loop_delay) * 1000));
+    m_show_time = 0;
+    ScheduleNextFrames();
     return;
   } else {
     // stop the show
-    m_client.GetSelectServer()->Terminate();
+    m_ss.Terminate();
+  }
+}
+
+
+/**
+ * Called when timecode arrives. Small differences between the timecode and
+ * the show position are corrected gradually, so the output doesn't jump on
+ * every timecode frame because of network jitter.
+ */
+void ShowPlayer::NewTimeCode(const TimeCode &timecode) {
+  if (m_loss_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss.RemoveTimeout(m_loss_timeout);
+  }
+  m_loss_timeout = m_ss.RegisterSingleTimeout(
+      TIMECODE_LOSS_MS,
+      ola::NewSingleCallback(this, &ShowPlayer::TimeCodeLost));
+
+  const uint64_t timecode_ms = TimeCodeToMs(timecode);
+  if (timecode_ms < m_timecode_offset) {
+    // Before the start of the show.
+    StopChasing();
+    return;
+  }
+  const uint64_t show_ms = timecode_ms - m_timecode_offset;
+
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+
+  if (m_running) {
+    const int64_t error = static_cast<int64_t>(show_ms) -
+                          (now - m_start_time).InMilliSeconds();
+    if (error <= RESYNC_THRESHOLD_MS && error >= -RESYNC_THRESHOLD_MS) {
+      const int64_t correction = error * 1000 / DRIFT_CORRECTION_DIVISOR;
+      if (correction > 0) {
+        m_start_time -= ola::TimeInterval(correction);
+      } else {
+        m_start_time += ola::TimeInterval(-correction);
+      }
+      CancelNextFrames();
+      ScheduleNextFrames();
+      return;
+    }
+  } else if (m_at_end && show_ms >= m_show_time) {
+    // Still past the end of the show.
+    return;
+  }
+
+  OLA_INFO << "Seeking to " << timecode << " (" << show_ms << "ms)";
+  CancelNextFrames();
+  if (!m_loader->Seek(show_ms)) {
+    OLA_WARN << "Failed to seek to " << show_ms << "ms";
+    m_ss.Terminate();
+    return;
   }
+  m_start_time = now - ola::TimeInterval(static_cast<int64_t>(show_ms * 1000));
+  m_show_time = show_ms;
+  m_running = true;
+  m_at_end = false;
+  SendNextFrames();
+}
+
+
+/**
+ * Called when the timecode stops, playback holds the last frames sent.
+ */
+void ShowPlayer::TimeCodeLost() {
+  m_loss_timeout = ola::thread::INVALID_TIMEOUT;
+  if (m_running) {
+    OLA_INFO << "Timecode stopped";
+  }
+  StopChasing();
+}
+
+
+void ShowPlayer::StopChasing() {
+  CancelNextFrames();
+  m_running = false;
+  m_at_end = false;
 }
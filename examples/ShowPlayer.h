@@ -18,19 +18,37 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
-#include <ola/client/ClientWrapper.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/io/SelectServer.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <ola/timecode/TimeCode.h>
+#include <stdint.h>
 
-#include <string>
 #include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "examples/ShowLoader.h"
+#include "examples/TimeCodeReceiver.h"
 
 #ifndef EXAMPLES_SHOWPLAYER_H_
 #define EXAMPLES_SHOWPLAYER_H_
 
 /**
  * @brief A class which plays back recorded show files.
+ *
+ * Frames are scheduled against the time each iteration started, rather than
+ * the previous frame, so the timing errors don't accumulate. All the frames
+ * with the same timestamp are sent to olad as a single batch.
+ *
+ * When chasing timecode, the show position follows the received timecode.
+ * Between timecode frames the show free-runs on the local clock, and each
+ * timecode frame nudges the clock by a fraction of the difference. If the
+ * difference is too large, e.g. the timecode jumped, the show seeks to the
+ * new position using the index of a binary show file.
  */
 class ShowPlayer {
  public:
@@ -53,21 +71,67 @@ class ShowPlayer {
    * @param duration the duration in seconds after which playback is stopped.
    * @param delay the hold time at the end of a show before playback starts
    * from the beginning again.
+   * @param start the offset in ms to start the first iteration from. This
+   * needs a binary show file.
    */
   int Playback(unsigned int iterations,
                unsigned int duration,
-               unsigned int delay);
+               unsigned int delay,
+               unsigned int start = 0);
+
+  /**
+   * @brief Play the show in time with ArtTimeCode packets.
+   * @param port the UDP port to listen for ArtTimeCode on.
+   * @param offset the timecode, in ms, that the start of the show
+   *   corresponds to.
+   *
+   * This needs a binary show file. Playback stops if the timecode stops, and
+   * runs until the process is terminated.
+   */
+  int Chase(uint16_t port, unsigned int offset);
 
  private:
-  ola::client::OlaClientWrapper m_client;
-  ShowLoader m_loader;
+  ola::io::SelectServer m_ss;
+  ola::client::StreamingClient m_client;
+  ola::Clock m_clock;
+  const std::string m_filename;
+  std::auto_ptr<ShowLoaderInterface> m_loader;
   bool m_infinite_loop;
   unsigned int m_iteration_remaining;
   unsigned int m_loop_delay;
+  // The time the current iteration started, and the offset of the next
+  // frames since then.
+  ola::TimeStamp m_start_time;
+  uint64_t m_show_time;
+  std::vector<ola::client::StreamingClient::DmxUpdate> m_batch;
+  ola::thread::timeout_id m_frame_timeout;
 
-  void SendNextFrame();
-  ShowLoader::State RegisterNextTimeout();
-  bool ReadNextFrame(unsigned int *universe, ola::DmxBuffer *data);
+  // Timecode chasing
+  std::auto_ptr<TimeCodeReceiver> m_timecode_receiver;
+  bool m_chasing;
+  unsigned int m_timecode_offset;
+  // True if frames are being sent.
+  bool m_running;
+  // True if we stopped because we reached the end of the show.
+  bool m_at_end;
+  ola::thread::timeout_id m_loss_timeout;
+
+  void SendNextFrames();
+  ShowLoaderInterface::State ReadFrames(unsigned int *timeout);
+  void AddToBatch(unsigned int universe, const ola::DmxBuffer &data);
+  void ScheduleNextFrames();
+  void CancelNextFrames();
   void HandleEndOfFile();
+  void NewTimeCode(const ola::timecode::TimeCode &timecode);
+  void TimeCodeLost();
+  void StopChasing();
+
+  // Differences smaller than this are corrected by adjusting the clock,
+  // anything larger causes a seek.
+  static const int64_t RESYNC_THRESHOLD_MS = 100;
+  // The fraction of the difference corrected by each timecode frame.
+  static const int64_t DRIFT_CORRECTION_DIVISOR = 4;
+  // Playback stops if no timecode is received for this long.
+  static const unsigned int TIMECODE_LOSS_MS = 500;
 };
 #endif  // EXAMPLES_SHOWPLAYER_H_
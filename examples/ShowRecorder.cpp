@@ -38,6 +38,7 @@
 #include <string>
 #include <vector>
 
+#include "examples/BinaryShowSaver.h"
 #include "examples/ShowRecorder.h"
 
 using ola::DmxBuffer;
@@ -47,8 +48,13 @@ using std::vector;
 
 
 ShowRecorder::ShowRecorder(const string &filename,
-                           const vector<unsigned int> &universes)
-    : m_saver(filename),
+                           const vector<unsigned int> &universes,
+                           bool binary,
+                           const AsyncShowSaver::Options &options)
+    : m_saver(binary ? static_cast<ShowSaverInterface*>(
+                           new BinaryShowSaver(filename)) :
+                       new ShowSaver(filename),
+              options),
       m_universes(universes),
       m_frame_count(0) {
 }
@@ -91,6 +97,8 @@ int ShowRecorder::Init() {
  */
 int ShowRecorder::Record() {
   m_client.GetSelectServer()->Run();
+  // Wait for the writer thread to finish.
+  m_saver.Close();
   return ola::EXIT_OK;
 }
 
@@ -22,11 +22,11 @@
 #include <ola/DmxBuffer.h>
 #include <ola/client/ClientWrapper.h>
 #include <stdint.h>
-#include <string>
 #include <fstream>
+#include <string>
 #include <vector>
 
-#include "examples/ShowSaver.h"
+#include "examples/AsyncShowSaver.h"
 
 #ifndef EXAMPLES_SHOWRECORDER_H_
 #define EXAMPLES_SHOWRECORDER_H_
@@ -36,8 +36,17 @@
  */
 class ShowRecorder {
  public:
+  /**
+   * @param filename the file to record to.
+   * @param universes the universes to record.
+   * @param binary write the binary show format rather than the text one.
+   * @param options the options for the writer thread.
+   */
   ShowRecorder(const std::string &filename,
-               const std::vector<unsigned int> &universes);
+               const std::vector<unsigned int> &universes,
+               bool binary = false,
+               const AsyncShowSaver::Options &options =
+                   AsyncShowSaver::Options());
   ~ShowRecorder();
 
   int Init();
@@ -45,10 +54,13 @@ class ShowRecorder {
   void Stop();
 
   uint64_t FrameCount() const { return m_frame_count; }
+  uint64_t QueuedFrames() const { return m_saver.QueuedFrames(); }
+  uint64_t WrittenFrames() const { return m_saver.WrittenFrames(); }
+  uint64_t DroppedFrames() const { return m_saver.DroppedFrames(); }
 
  private:
   ola::client::OlaClientWrapper m_client;
-  ShowSaver m_saver;
+  AsyncShowSaver m_saver;
   std::vector<unsigned int> m_universes;
   ola::Clock m_clock;
   uint64_t m_frame_count;
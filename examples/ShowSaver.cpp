@@ -24,7 +24,9 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <unistd.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <fstream>
@@ -35,7 +37,6 @@
 
 using std::string;
 using ola::DmxBuffer;
-using std::endl;
 
 
 const char ShowSaver::OLA_SHOW_HEADER[] = "OLA Show";
@@ -61,7 +62,7 @@ bool ShowSaver::Open() {
     return false;
   }
 
-  m_show_file << OLA_SHOW_HEADER << endl;
+  m_show_file << OLA_SHOW_HEADER << '\n';
   return true;
 }
 
@@ -88,9 +89,33 @@ bool ShowSaver::NewFrame(const ola::TimeStamp &arrival_time,
     // this is not the first frame so write the delay in ms
     const ola::TimeInterval delta = arrival_time - m_last_frame;
 
-    m_show_file << delta.InMilliSeconds() << endl;
+    m_show_file << delta.InMilliSeconds() << '\n';
   }
   m_last_frame = arrival_time;
-  m_show_file << universe << " " << data.ToString() << endl;
+  // Flush() is called periodically, so don't flush every line.
+  m_show_file << universe << " " << data.ToString() << '\n';
   return true;
 }
+
+
+bool ShowSaver::Flush(bool sync) {
+  if (!m_show_file.flush()) {
+    return false;
+  }
+  return sync ? SyncFile(m_filename) : true;
+}
+
+
+bool ShowSaverInterface::SyncFile(const string &filename) {
+  int fd = open(filename.c_str(), O_WRONLY);
+  if (fd < 0) {
+    OLA_WARN << "Can't open " << filename << ": " << strerror(errno);
+    return false;
+  }
+  bool ok = fsync(fd) == 0;
+  if (!ok) {
+    OLA_WARN << "fsync(" << filename << ") failed: " << strerror(errno);
+  }
+  close(fd);
+  return ok;
+}
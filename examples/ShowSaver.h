@@ -28,9 +28,37 @@
 #define EXAMPLES_SHOWSAVER_H_
 
 /**
- * Write show data to a file.
+ * The interface for writing show data to a file.
  */
-class ShowSaver {
+class ShowSaverInterface {
+ public:
+  virtual ~ShowSaverInterface() {}
+
+  virtual bool Open() = 0;
+  virtual void Close() = 0;
+
+  virtual bool NewFrame(const ola::TimeStamp &arrival_time,
+                        unsigned int universe,
+                        const ola::DmxBuffer &data) = 0;
+
+  /**
+   * Write any buffered data to the file.
+   * @param sync if true, also wait for the data to reach the disk.
+   */
+  virtual bool Flush(bool sync) = 0;
+
+ protected:
+  /**
+   * fsync() a file, this syncs the data written through any descriptor.
+   */
+  static bool SyncFile(const std::string &filename);
+};
+
+
+/**
+ * Writes the text show format.
+ */
+class ShowSaver : public ShowSaverInterface {
  public:
   explicit ShowSaver(const std::string &filename);
   ~ShowSaver();
@@ -41,6 +69,7 @@ class ShowSaver {
   bool NewFrame(const ola::TimeStamp &arrival_time,
                 unsigned int universe,
                 const ola::DmxBuffer &data);
+  bool Flush(bool sync);
 
  private:
   const std::string m_filename;
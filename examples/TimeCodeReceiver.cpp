@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TimeCodeReceiver.cpp
+ * Receives ArtTimeCode packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <ola/Logging.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/timecode/TimeCodeEnums.h>
+#include <ola/util/Utils.h>
+
+#include "examples/TimeCodeReceiver.h"
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::timecode::TimeCode;
+using ola::timecode::TimeCodeType;
+
+namespace {
+const char ARTNET_ID[] = "Art-Net";  // includes the NULL
+const uint16_t OP_TIMECODE = 0x9700;
+
+// The header is the id and the little endian op code, then the body is
+// version (2), filler (2), frames, seconds, minutes, hours and type.
+const unsigned int HEADER_SIZE = sizeof(ARTNET_ID) + 2;
+const unsigned int PACKET_SIZE = HEADER_SIZE + 9;
+}  // namespace
+
+TimeCodeReceiver::TimeCodeReceiver(ola::io::SelectServerInterface *ss,
+                                   uint16_t port,
+                                   TimeCodeCallback *callback)
+    : m_ss(ss),
+      m_port(port),
+      m_callback(callback),
+      m_registered(false) {
+}
+
+TimeCodeReceiver::~TimeCodeReceiver() {
+  if (m_registered) {
+    m_ss->RemoveReadDescriptor(&m_socket);
+  }
+  m_socket.Close();
+}
+
+bool TimeCodeReceiver::Init() {
+  if (!m_socket.Init()) {
+    return false;
+  }
+  if (!m_socket.Bind(IPV4SocketAddress(IPV4Address::WildCard(), m_port))) {
+    return false;
+  }
+  m_socket.SetOnData(ola::NewCallback(this, &TimeCodeReceiver::ReceivePacket));
+  m_registered = m_ss->AddReadDescriptor(&m_socket);
+  return m_registered;
+}
+
+bool TimeCodeReceiver::ParsePacket(const uint8_t *data, unsigned int length,
+                                   TimeCode *timecode) {
+  if (length < PACKET_SIZE ||
+      memcmp(data, ARTNET_ID, sizeof(ARTNET_ID)) != 0) {
+    return false;
+  }
+  const uint8_t *op_code = data + sizeof(ARTNET_ID);
+  if (ola::utils::JoinUInt8(op_code[1], op_code[0]) != OP_TIMECODE) {
+    return false;
+  }
+
+  const uint8_t *body = data + HEADER_SIZE + 4;
+  *timecode = TimeCode(static_cast<TimeCodeType>(body[4]), body[3], body[2],
+                       body[1], body[0]);
+  return timecode->IsValid();
+}
+
+void TimeCodeReceiver::ReceivePacket() {
+  uint8_t packet[512];
+  ssize_t length = sizeof(packet);
+  if (!m_socket.RecvFrom(packet, &length)) {
+    return;
+  }
+
+  TimeCode timecode(ola::timecode::TIMECODE_FILM, 0, 0, 0, 0);
+  if (ParsePacket(packet, length, &timecode)) {
+    m_callback->Run(timecode);
+  }
+}
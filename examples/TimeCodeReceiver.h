@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * TimeCodeReceiver.h
+ * Receives ArtTimeCode packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Callback.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/network/Socket.h>
+#include <ola/timecode/TimeCode.h>
+#include <stdint.h>
+
+#include <memory>
+
+#ifndef EXAMPLES_TIMECODERECEIVER_H_
+#define EXAMPLES_TIMECODERECEIVER_H_
+
+/**
+ * Listens for the ArtTimeCode packets sent by olad's ArtNet plugin when a
+ * client calls SendTimeCode, or by any other Art-Net timecode source.
+ *
+ * The socket is bound with SO_REUSEADDR, so this works alongside an olad
+ * that's running the ArtNet plugin on the same host.
+ */
+class TimeCodeReceiver {
+ public:
+  typedef ola::Callback1<void, const ola::timecode::TimeCode&>
+      TimeCodeCallback;
+
+  /**
+   * @brief Create a new TimeCodeReceiver.
+   * @param ss the SelectServer to use.
+   * @param port the UDP port to listen on.
+   * @param callback run for each timecode received, ownership is transferred.
+   */
+  TimeCodeReceiver(ola::io::SelectServerInterface *ss,
+                   uint16_t port,
+                   TimeCodeCallback *callback);
+  ~TimeCodeReceiver();
+
+  bool Init();
+
+  /**
+   * @brief Extract the timecode from an ArtTimeCode packet.
+   * @returns false if the packet isn't a valid ArtTimeCode packet.
+   */
+  static bool ParsePacket(const uint8_t *data, unsigned int length,
+                          ola::timecode::TimeCode *timecode);
+
+  static const uint16_t ARTNET_PORT = 6454;
+
+ private:
+  ola::io::SelectServerInterface *m_ss;
+  const uint16_t m_port;
+  std::auto_ptr<TimeCodeCallback> m_callback;
+  ola::network::UDPSocket m_socket;
+  bool m_registered;
+
+  void ReceivePacket();
+};
+#endif  // EXAMPLES_TIMECODERECEIVER_H_
@@ -114,6 +114,9 @@ static int palette_number = 0;
 static int palette[MAXCOLOR];
 static bool screen_to_small = false;
 static int channels_offset = 1;
+// What each cell on the screen shows, so values() only redraws the changes.
+static int drawn[ola::DMX_UNIVERSE_SIZE];
+static int drawn_cursor = -1;
 
 OlaClient *client;
 SelectServer *ss;
@@ -161,6 +164,13 @@ void set() {
 }
 
 
+/* forget what's on the screen, so values() draws every cell */
+void invalidatecells() {
+  for (int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++)
+    drawn[i] = -1;
+  drawn_cursor = -1;
+}
+
 /* display the channels numbers */
 void mask() {
   int i = 0;
@@ -168,6 +178,7 @@ void mask() {
   int z = first_channel;
 
   erase();
+  invalidatecells();
 
   /* clear headline */
   (void) attrset(palette[HEADLINE]);
@@ -269,17 +280,23 @@ void values() {
     printw("ERROR: screen too small, we need at least 3 lines");
   }
 
-  /* values */
+  /* values, only the cells that changed are drawn */
   for (y = ROWS_PER_CHANNEL_ROW;
        y < LINES && z < ola::DMX_UNIVERSE_SIZE && i < channels_per_screen;
        y += ROWS_PER_CHANNEL_ROW) {
-    move(y, 0);  // NOLINT(build/include_what_you_use) This is ncurses.h's move
     for (x = 0;
          x < channels_per_line &&
          z < ola::DMX_UNIVERSE_SIZE &&
          i < channels_per_screen;
          x++, z++, i++) {
       const int d = dmx[z];
+      if (drawn[z] == d &&
+          (z == current_channel) == (z == drawn_cursor))
+        continue;
+      drawn[z] = d;
+
+      // NOLINTNEXTLINE(build/include_what_you_use) This is ncurses.h's move
+      move(y, x * CHANNEL_DISPLAY_WIDTH);
       switch (d) {
         case ola::DMX_MIN_SLOT_VALUE:
           attrset(palette[ZERO]);
@@ -322,6 +339,7 @@ void values() {
       }
     }
   }
+  drawn_cursor = current_channel;
 }
 
 /* save current cue into cuebuffer */
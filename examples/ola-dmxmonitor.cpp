@@ -46,6 +46,7 @@
 #include <ola/Clock.h>
 #include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
+#include <ola/StringUtils.h>
 #include <ola/base/Init.h>
 #include <ola/base/Macro.h>
 #include <ola/base/SysExits.h>
@@ -55,6 +56,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 
 using ola::Clock;
 using ola::DmxBuffer;
@@ -65,10 +67,14 @@ using ola::TimeInterval;
 using ola::TimeStamp;
 using ola::io::SelectServer;
 using std::string;
+using std::vector;
 
 static const unsigned int DEFAULT_UNIVERSE = 0;
+static const unsigned int DEFAULT_REFRESH_RATE = 10;
 static const unsigned char CHANNEL_DISPLAY_WIDTH = 4;
 static const unsigned char ROWS_PER_CHANNEL_ROW = 2;
+// What a cell shows when the slot isn't in the frame.
+static const int NO_SLOT_CELL = 256;
 
 /* color names used */
 enum {
@@ -91,7 +97,9 @@ enum {
 };
 
 typedef struct {
-  unsigned int universe;
+  vector<unsigned int> universes;
+  unsigned int refresh_rate;  // screen updates per second
+  bool all_frames;  // receive every frame, not just the changes
   bool help;        // help
 } options;
 
@@ -112,14 +120,23 @@ static int palette[MAXCOLOR];
  */
 class DmxMonitor {
  public:
-    explicit DmxMonitor(unsigned int universe)
-        : m_universe(universe),
+    explicit DmxMonitor(const options &opts)
+        : m_refresh_rate(opts.refresh_rate ? opts.refresh_rate : 1),
+          m_all_frames(opts.all_frames),
+          m_current_view(0),
           m_counter(0),
           m_palette_number(0),
           m_stdin_descriptor(STDIN_FILENO),
           m_window(NULL),
           m_data_loss_window(NULL),
-          m_channels_offset(true) {
+          m_channels_offset(true),
+          m_new_data(false),
+          m_drawn_cursor(-1) {
+      vector<unsigned int>::const_iterator iter = opts.universes.begin();
+      for (; iter != opts.universes.end(); ++iter) {
+        m_views.push_back(UniverseView(*iter));
+      }
+      InvalidateCells();
     }
 
     ~DmxMonitor() {
@@ -136,21 +153,44 @@ class DmxMonitor {
     void RegisterComplete(const Result &result);
     void StdinReady();
     bool CheckDataLoss();
+    bool Redraw();
     void DrawDataLossWindow();
     void TerminalResized();
 
  private:
-    unsigned int m_universe;
+    // The state of one of the universes being monitored.
+    struct UniverseView {
+      explicit UniverseView(unsigned int _universe) : universe(_universe) {
+        buffer.Blackout();
+      }
+
+      unsigned int universe;
+      DmxBuffer buffer;
+      TimeStamp last_data;
+    };
+
+    const unsigned int m_refresh_rate;
+    const bool m_all_frames;
+    vector<UniverseView> m_views;
+    unsigned int m_current_view;
     unsigned int m_counter;
     int m_palette_number;
     ola::io::UnmanagedFileDescriptor m_stdin_descriptor;
-    TimeStamp m_last_data;
     WINDOW *m_window;
     WINDOW *m_data_loss_window;
     bool m_channels_offset;  // start from channel 1 rather than 0;
     OlaClientWrapper m_client;
-    DmxBuffer m_buffer;
-
+    // Set when the current universe has data that isn't on the screen yet.
+    bool m_new_data;
+    // What each cell on the screen shows, so only changed cells are redrawn.
+    int m_drawn[ola::DMX_UNIVERSE_SIZE];
+    int m_drawn_cursor;
+
+    UniverseView *CurrentView() { return &m_views[m_current_view]; }
+    UniverseView *FindView(unsigned int universe);
+    void ChangeView(int offset);
+    void InvalidateCells();
+    void RemoveDataLossWindow();
     void DrawScreen(bool include_values = true);
     void Mask();
     void Values();
@@ -169,12 +209,18 @@ bool DmxMonitor::Init() {
     return false;
   }
 
+  // Frames that arrive faster than we redraw are of no use, and unless we're
+  // watching for data loss neither are frames that haven't changed.
   OlaClient *client = m_client.GetClient();
   client->SetDMXCallback(ola::NewCallback(this, &DmxMonitor::NewDmx));
-  client->RegisterUniverse(
-      m_universe,
-      ola::client::REGISTER,
-      ola::NewSingleCallback(this, &DmxMonitor::RegisterComplete));
+  vector<UniverseView>::const_iterator iter = m_views.begin();
+  for (; iter != m_views.end(); ++iter) {
+    ola::client::RegisterArgs args(
+        ola::NewSingleCallback(this, &DmxMonitor::RegisterComplete));
+    args.max_fps = m_refresh_rate;
+    args.only_on_change = !m_all_frames;
+    client->RegisterUniverse(iter->universe, ola::client::REGISTER, args);
+  }
 
   /* init curses */
   m_window = initscr();
@@ -192,31 +238,50 @@ bool DmxMonitor::Init() {
   m_client.GetSelectServer()->AddReadDescriptor(&m_stdin_descriptor);
   m_stdin_descriptor.SetOnData(
       ola::NewCallback(this, &DmxMonitor::StdinReady));
+  if (m_all_frames) {
+    m_client.GetSelectServer()->RegisterRepeatingTimeout(
+        500,
+        ola::NewCallback(this, &DmxMonitor::CheckDataLoss));
+  }
   m_client.GetSelectServer()->RegisterRepeatingTimeout(
-      500,
-      ola::NewCallback(this, &DmxMonitor::CheckDataLoss));
+      1000 / m_refresh_rate,
+      ola::NewCallback(this, &DmxMonitor::Redraw));
   CalcScreenGeometry();
   ChangePalette(m_palette_number);
-
-  m_buffer.Blackout();
   DrawScreen();
   return true;
 }
 
 
 /*
- * Called when there is new DMX data
+ * Called when there is new DMX data. The screen is updated by Redraw().
  */
-void DmxMonitor::NewDmx(OLA_UNUSED const ola::client::DMXMetadata &meta,
+void DmxMonitor::NewDmx(const ola::client::DMXMetadata &meta,
                         const DmxBuffer &buffer) {
-  m_buffer.Set(buffer);
+  UniverseView *view = FindView(meta.universe);
+  if (!view) {
+    return;
+  }
+  view->buffer.Set(buffer);
+  Clock clock;
+  clock.CurrentTime(&view->last_data);
+  if (view == CurrentView()) {
+    m_new_data = true;
+  }
+}
+
+
+/*
+ * Draw the cells that have changed, this runs at the refresh rate.
+ */
+bool DmxMonitor::Redraw() {
+  if (!m_new_data) {
+    return true;
+  }
+  m_new_data = false;
 
   if (m_data_loss_window) {
-    // delete the window
-    wborder(m_data_loss_window, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
-    wrefresh(m_data_loss_window);
-    delwin(m_data_loss_window);
-    m_data_loss_window = NULL;
+    RemoveDataLossWindow();
     Mask();
   }
   move(0, COLS - 1);  // NOLINT(build/include_what_you_use) This is ncurses.h's
@@ -236,10 +301,9 @@ void DmxMonitor::NewDmx(OLA_UNUSED const ola::client::DMXMetadata &meta,
   }
   m_counter++;
 
-  Clock clock;
-  clock.CurrentTime(&m_last_data);
   Values();
   refresh();
+  return true;
 }
 
 
@@ -351,6 +415,14 @@ void DmxMonitor::StdinReady() {
     case 'q':
       m_client.GetSelectServer()->Terminate();
       break;
+
+    case '\t':
+      ChangeView(1);
+      break;
+
+    case KEY_BTAB:
+      ChangeView(-1);
+      break;
     default:
         break;
   }
@@ -362,11 +434,12 @@ void DmxMonitor::StdinReady() {
  * TODO(simon): move to the ola server
  */
 bool DmxMonitor::CheckDataLoss() {
-  if (m_last_data.IsSet()) {
+  const TimeStamp &last_data = CurrentView()->last_data;
+  if (last_data.IsSet()) {
     TimeStamp now;
     Clock clock;
     clock.CurrentTime(&now);
-    TimeInterval diff = now - m_last_data;
+    TimeInterval diff = now - last_data;
     if (diff > TimeInterval(2, 5000000)) {
       // loss of data
       DrawDataLossWindow();
@@ -376,6 +449,16 @@ bool DmxMonitor::CheckDataLoss() {
 }
 
 
+void DmxMonitor::RemoveDataLossWindow() {
+  wborder(m_data_loss_window, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
+  wrefresh(m_data_loss_window);
+  delwin(m_data_loss_window);
+  m_data_loss_window = NULL;
+  // The window hid part of the screen, so it all needs to be sent again.
+  touchwin(stdscr);
+}
+
+
 void DmxMonitor::DrawDataLossWindow() {
   if (!m_data_loss_window) {
     m_data_loss_window = newwin(3, 14, (LINES - 3) / 2, (COLS - 14) / 2);
@@ -400,9 +483,50 @@ void DmxMonitor::TerminalResized() {
 }
 
 
+DmxMonitor::UniverseView *DmxMonitor::FindView(unsigned int universe) {
+  vector<UniverseView>::iterator iter = m_views.begin();
+  for (; iter != m_views.end(); ++iter) {
+    if (iter->universe == universe) {
+      return &(*iter);
+    }
+  }
+  return NULL;
+}
+
+
+/*
+ * Switch to the next or previous universe.
+ */
+void DmxMonitor::ChangeView(int offset) {
+  if (m_views.size() < 2) {
+    return;
+  }
+  m_current_view = (m_current_view + m_views.size() + offset) %
+                   m_views.size();
+  if (m_data_loss_window) {
+    RemoveDataLossWindow();
+  }
+  m_new_data = false;
+  DrawScreen();
+}
+
+
+/*
+ * Forget what's on the screen, so the next call to Values() draws every cell.
+ */
+void DmxMonitor::InvalidateCells() {
+  for (unsigned int i = 0; i < ola::DMX_UNIVERSE_SIZE; i++) {
+    m_drawn[i] = -1;
+  }
+  m_drawn_cursor = -1;
+}
+
+
 void DmxMonitor::DrawScreen(bool include_values) {
-  if (include_values)
+  if (include_values) {
     erase();
+    InvalidateCells();
+  }
   Mask();
 
   if (include_values)
@@ -427,7 +551,11 @@ void DmxMonitor::Mask() {
 
   if (COLS > 15) {
     mvprintw(0 , 0, "Universe: ");
-    printw("%u", m_universe);
+    printw("%u", m_views[m_current_view].universe);
+    if (m_views.size() > 1 && COLS > 40) {
+      printw(" (%u of %u, Tab for next)", m_current_view + 1,
+             static_cast<unsigned int>(m_views.size()));
+    }
   }
 
   /* write channel numbers */
@@ -459,9 +587,11 @@ void DmxMonitor::Mask() {
 
 
 /*
- * Update the screen with new values
+ * Update the screen with new values. Only the cells that have changed since
+ * the last call are drawn.
  */
 void DmxMonitor::Values() {
+  const DmxBuffer &buffer = CurrentView()->buffer;
   int i = 0, x, y, z = first_channel;
 
   /* values */
@@ -469,13 +599,24 @@ void DmxMonitor::Values() {
        y < LINES && z < ola::DMX_UNIVERSE_SIZE &&
        i < static_cast<int>(channels_per_screen);
        y += ROWS_PER_CHANNEL_ROW) {
-    move(y, 0);  // NOLINT(build/include_what_you_use) This is ncurses.h's move
     for (x = 0;
          x < static_cast<int>(channels_per_line) &&
          z < ola::DMX_UNIVERSE_SIZE &&
          i < static_cast<int>(channels_per_screen);
          x++, z++, i++) {
-      const int d = m_buffer.Get(z);
+      const int d = buffer.Get(z);
+      // Slots past the end of the frame are drawn differently to 0.
+      const int cell = static_cast<int>(buffer.Size()) <= z ?
+          NO_SLOT_CELL : d;
+      const bool cursor_moved = (z == current_channel) !=
+                                (z == m_drawn_cursor);
+      if (m_drawn[z] == cell && !cursor_moved) {
+        continue;
+      }
+      m_drawn[z] = cell;
+
+      // NOLINTNEXTLINE(build/include_what_you_use) This is ncurses.h's move
+      move(y, x * CHANNEL_DISPLAY_WIDTH);
       switch (d) {
         case ola::DMX_MIN_SLOT_VALUE:
           (void) attrset(palette[ZERO]);
@@ -491,7 +632,7 @@ void DmxMonitor::Values() {
       switch (display_mode) {
         case DISP_MODE_HEX:
           if (d == 0) {
-            if (static_cast<int>(m_buffer.Size()) <= z) {
+            if (cell == NO_SLOT_CELL) {
               addstr("--- ");
             } else {
               addstr("    ");
@@ -502,7 +643,7 @@ void DmxMonitor::Values() {
           break;
         case DISP_MODE_DEC:
           if (d == 0) {
-            if (static_cast<int>(m_buffer.Size()) <= z) {
+            if (cell == NO_SLOT_CELL) {
               addstr("--- ");
             } else {
               addstr("    ");
@@ -517,7 +658,7 @@ void DmxMonitor::Values() {
         default:
           switch (d) {
             case ola::DMX_MIN_SLOT_VALUE:
-              if (static_cast<int>(m_buffer.Size()) <= z) {
+              if (cell == NO_SLOT_CELL) {
                 addstr("--- ");
               } else {
                 addstr("    ");
@@ -532,6 +673,7 @@ void DmxMonitor::Values() {
       }
     }
   }
+  m_drawn_cursor = current_channel;
 }
 
 
@@ -639,20 +781,27 @@ void cleanup() {
  * parse our cmd line options
  */
 void ParseOptions(int argc, char *argv[], options *opts) {
+  enum {
+    ALL_FRAMES_OPTION = 256,
+  };
+
   static struct option long_options[] = {
+      {"all-frames", no_argument, 0, ALL_FRAMES_OPTION},
       {"help", no_argument, 0, 'h'},
+      {"refresh-rate", required_argument, 0, 'r'},
       {"universe", required_argument, 0, 'u'},
       {0, 0, 0, 0}
     };
 
-  opts->universe = DEFAULT_UNIVERSE;
+  opts->refresh_rate = DEFAULT_REFRESH_RATE;
+  opts->all_frames = false;
   opts->help = false;
 
   int c;
   int option_index = 0;
 
   while (1) {
-    c = getopt_long(argc, argv, "hu:", long_options, &option_index);
+    c = getopt_long(argc, argv, "hr:u:", long_options, &option_index);
 
     if (c == -1)
       break;
@@ -663,8 +812,25 @@ void ParseOptions(int argc, char *argv[], options *opts) {
       case 'h':
         opts->help = true;
         break;
+      case 'r':
+        opts->refresh_rate = strtoul(optarg, NULL, 0);
+        break;
       case 'u':
-        opts->universe = strtoul(optarg, NULL, 0);
+        {
+          // A list of universes, e.g. 1,2,5
+          vector<string> universes;
+          ola::StringSplit(optarg, &universes, ",");
+          vector<string>::const_iterator iter = universes.begin();
+          for (; iter != universes.end(); ++iter) {
+            unsigned int universe;
+            if (ola::StringToInt(*iter, &universe)) {
+              opts->universes.push_back(universe);
+            }
+          }
+        }
+        break;
+      case ALL_FRAMES_OPTION:
+        opts->all_frames = true;
         break;
       case '?':
         break;
@@ -672,6 +838,10 @@ void ParseOptions(int argc, char *argv[], options *opts) {
         break;
     }
   }
+
+  if (opts->universes.empty()) {
+    opts->universes.push_back(DEFAULT_UNIVERSE);
+  }
 }
 
 
@@ -681,11 +851,18 @@ void ParseOptions(int argc, char *argv[], options *opts) {
 void DisplayHelpAndExit(char arg[]) {
   std::cout << "Usage: " << arg << " [--universe <universe_id>]\n"
   "\n"
-  "Monitor the values on a DMX512 universe.\n"
+  "Monitor the values on one or more DMX512 universes. Tab switches between\n"
+  "the universes.\n"
   "\n"
   "  -h, --help                   Display this help message and exit.\n"
+  "  -r, --refresh-rate <hz>      Screen updates per second (defaults to "
+  << DEFAULT_REFRESH_RATE << ").\n"
   "  -u, --universe <universe_id> Id of universe to monitor (defaults to "
-  << DEFAULT_UNIVERSE << ").\n"
+  << DEFAULT_UNIVERSE << "). Repeat or\n"
+  "                               separate with commas to monitor more.\n"
+  "  --all-frames                 Receive every frame rather than just the\n"
+  "                               changes, this enables the data loss\n"
+  "                               warning.\n"
   << std::endl;
   exit(ola::EXIT_OK);
 }
@@ -708,7 +885,7 @@ int main(int argc, char *argv[]) {
     DisplayHelpAndExit(argv[0]);
   }
 
-  dmx_monitor = new DmxMonitor(opts.universe);
+  dmx_monitor = new DmxMonitor(opts);
   if (!dmx_monitor->Init())
     return 1;
 
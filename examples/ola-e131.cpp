@@ -23,15 +23,18 @@
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
+#include <ola/StringUtils.h>
 #include <plugins/e131/messages/E131ConfigMessages.pb.h>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "examples/OlaConfigurator.h"
 
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::string;
+using std::vector;
 
 DECLARE_int32(device);
 DEFINE_s_uint32(port_id, p, 0, "Id of the port to control");
@@ -39,6 +42,14 @@ DEFINE_s_default_bool(input, i, false,
                       "Set an input port, otherwise set an output port.");
 DEFINE_bool(preview_mode, false, "Set the preview mode bit on|off");
 DEFINE_default_bool(discovery, false, "Get the discovery state");
+DEFINE_s_uint16(universe, u, 0,
+                "Get the unicast destinations for this universe, or with "
+                "--discovery, only list the sources sending it");
+DEFINE_uint32(page_size, 0,
+              "With --discovery, fetch this many sources per request.");
+DEFINE_string(unicast, "",
+              "A comma separated list of ip[:port] unicast destinations to "
+              "set for --universe, an empty list removes them.");
 
 /*
  * A class that configures E131 devices
@@ -50,8 +61,11 @@ class E131Configurator: public OlaConfigurator {
   void HandleConfigResponse(const string &reply, const string &error);
   void SendConfigRequest();
  private:
+  void SendSourceListRequest(const string &page_token);
   void DisplayOptions(const ola::plugin::e131::PortInfoReply &reply);
   void DisplaySourceList(const ola::plugin::e131::SourceListReply &reply);
+  void DisplayUnicastDestinations(
+      const ola::plugin::e131::UnicastDestinationsReply &reply);
 };
 
 
@@ -60,13 +74,14 @@ class E131Configurator: public OlaConfigurator {
  */
 void E131Configurator::HandleConfigResponse(const string &reply,
                                             const string &error) {
-  Terminate();
   if (!error.empty()) {
+    Terminate();
     cerr << error << endl;
     return;
   }
   ola::plugin::e131::Reply reply_pb;
   if (!reply_pb.ParseFromString(reply)) {
+    Terminate();
     cout << "Protobuf parsing failed" << endl;
     return;
   }
@@ -82,13 +97,25 @@ void E131Configurator::HandleConfigResponse(const string &reply,
     case ola::plugin::e131::Reply::E131_SOURCES_LIST:
       if (reply_pb.has_source_list()) {
         DisplaySourceList(reply_pb.source_list());
+        if (reply_pb.source_list().has_next_page_token()) {
+          SendSourceListRequest(reply_pb.source_list().next_page_token());
+          return;
+        }
       } else {
         cout << "Missing source_list field in reply" << endl;
       }
       break;
+    case ola::plugin::e131::Reply::E131_UNICAST_DESTINATIONS:
+      if (reply_pb.has_unicast_destinations()) {
+        DisplayUnicastDestinations(reply_pb.unicast_destinations());
+      } else {
+        cout << "Missing unicast_destinations field in reply" << endl;
+      }
+      break;
     default:
       cout << "Invalid response type" << endl;
   }
+  Terminate();
 }
 
 
@@ -113,10 +140,24 @@ void E131Configurator::SendConfigRequest() {
       request.set_type(ola::plugin::e131::Request::E131_PORT_INFO);
     }
   } else if (FLAGS_discovery) {
-    request.set_type(ola::plugin::e131::Request::E131_SOURCES_LIST);
-    ola::plugin::e131::SourceListRequest *source_list_request =
-        request.mutable_source_list();
-    (void) source_list_request;  // no options for now.
+    SendSourceListRequest("");
+    return;
+  } else if (FLAGS_universe.present()) {
+    request.set_type(ola::plugin::e131::Request::E131_UNICAST_DESTINATIONS);
+    ola::plugin::e131::UnicastDestinationsRequest *unicast_request =
+        request.mutable_unicast_destinations();
+    unicast_request->set_universe(FLAGS_universe);
+    if (FLAGS_unicast.present()) {
+      unicast_request->set_update(true);
+      vector<string> destinations;
+      ola::StringSplit(FLAGS_unicast.str(), &destinations, ",");
+      vector<string>::const_iterator iter = destinations.begin();
+      for (; iter != destinations.end(); ++iter) {
+        if (!iter->empty()) {
+          unicast_request->add_destination(*iter);
+        }
+      }
+    }
   } else {
     request.set_type(ola::plugin::e131::Request::E131_PORT_INFO);
   }
@@ -124,6 +165,27 @@ void E131Configurator::SendConfigRequest() {
 }
 
 
+/*
+ * Request a page of discovered sources.
+ */
+void E131Configurator::SendSourceListRequest(const string &page_token) {
+  ola::plugin::e131::Request request;
+  request.set_type(ola::plugin::e131::Request::E131_SOURCES_LIST);
+  ola::plugin::e131::SourceListRequest *source_list_request =
+      request.mutable_source_list();
+  if (!page_token.empty()) {
+    source_list_request->set_page_token(page_token);
+  }
+  if (FLAGS_page_size) {
+    source_list_request->set_page_size(FLAGS_page_size);
+  }
+  if (FLAGS_universe.present()) {
+    source_list_request->set_universe(FLAGS_universe);
+  }
+  SendMessage(request);
+}
+
+
 /*
  * Display the widget parameters
  */
@@ -156,6 +218,9 @@ void E131Configurator::DisplaySourceList(
     if (entry.has_source_name()) {
       cout << ", " << entry.source_name();
     }
+    if (entry.has_last_seen_ms()) {
+      cout << ", seen " << entry.last_seen_ms() << "ms ago";
+    }
     cout << endl;
     for (int j = 0; j < entry.universe_size(); j++) {
       cout << "  " << entry.universe(j) << endl;
@@ -163,6 +228,19 @@ void E131Configurator::DisplaySourceList(
   }
 }
 
+void E131Configurator::DisplayUnicastDestinations(
+    const ola::plugin::e131::UnicastDestinationsReply &reply) {
+  if (!reply.destination_size()) {
+    cout << "Universe " << reply.universe() << " is multicast only" << endl;
+    return;
+  }
+
+  cout << "Universe " << reply.universe() << " unicast destinations:" << endl;
+  for (int i = 0; i < reply.destination_size(); i++) {
+    cout << "  " << reply.destination(i) << endl;
+  }
+}
+
 /*
  * The main function
  */
@@ -170,7 +248,9 @@ int main(int argc, char*argv[]) {
   ola::AppInit(
       &argc,
       argv,
-      "-d <dev-id> -p <port-id> [--input] --preview-mode <on|off>",
+      "-d <dev-id> [-p <port-id> [--input] --preview-mode <on|off>] "
+      "[-u <universe> [--unicast <ip[:port],...>]] "
+      "[--discovery [-u <universe>] [--page-size <n>]]",
       "Configure E1.31 devices managed by OLA.");
 
   if (FLAGS_device < 0)
@@ -18,64 +18,203 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <ola/Callback.h>
 #include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
-#include <ola/OlaClientWrapper.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
+#include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
 #include <ola/thread/SignalThread.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using ola::DmxBuffer;
 using ola::NewSingleCallback;
-using ola::OlaCallbackClientWrapper;
 using ola::TimeStamp;
 using ola::TimeInterval;
+using ola::client::DMXMetadata;
+using ola::client::DMXView;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::client::SendDMXArgs;
 using std::cout;
 using std::endl;
 using std::string;
+using std::vector;
 
-DEFINE_s_uint32(universe, u, 1, "The universe to receive data for");
+DEFINE_s_uint32(universe, u, 1, "The universe to send or fetch data for");
 DEFINE_default_bool(send_dmx, false, "Use SendDmx messages, default is GetDmx");
+DEFINE_uint32(loopback_universe, 0,
+              "Send on --universe and time how long it takes for the data to "
+              "arrive on this universe. Patch --universe to an output port "
+              "and this universe to an input port that receives from it, e.g. "
+              "E1.31 out and in on the same host.");
+DEFINE_uint32(timeout, 1000,
+              "In loopback mode, how long to wait for each frame in ms");
+DEFINE_uint32(interval, 0, "The time between requests in micro-seconds");
 DEFINE_s_uint32(count, c, 0,
     "Exit after this many RPCs, default: infinite (0)");
 
+namespace {
+
+/*
+ * A histogram with a bounded relative error, so long runs can be recorded in
+ * constant memory and the tail percentiles are still accurate.
+ *
+ * Values below 2^SUB_BUCKET_BITS are recorded exactly. Above that each power
+ * of two is split into 2^(SUB_BUCKET_BITS - 1) buckets, giving an error of
+ * less than 1.6%.
+ */
+class LatencyHistogram {
+ public:
+    LatencyHistogram() : m_count(0), m_sum(0), m_max(0) {}
+
+    void Record(uint64_t value) {
+      const unsigned int index = BucketIndex(value);
+      if (index >= m_buckets.size()) {
+        m_buckets.resize(index + 1, 0);
+      }
+      m_buckets[index]++;
+      m_count++;
+      m_sum += value;
+      m_max = std::max(m_max, value);
+    }
+
+    uint64_t Count() const { return m_count; }
+    uint64_t Max() const { return m_max; }
+    uint64_t Mean() const { return m_count ? m_sum / m_count : 0; }
+
+    /*
+     * Return the value that percentile % of the values are less than or equal
+     * to.
+     */
+    uint64_t Percentile(double percentile) const {
+      const uint64_t target = static_cast<uint64_t>(
+          m_count * percentile / 100.0 + 0.5);
+      uint64_t seen = 0;
+      for (unsigned int i = 0; i < m_buckets.size(); i++) {
+        seen += m_buckets[i];
+        if (seen && seen >= target) {
+          return std::min(BucketUpperBound(i), m_max);
+        }
+      }
+      return m_max;
+    }
+
+ private:
+    vector<uint64_t> m_buckets;
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_max;
+
+    static const unsigned int SUB_BUCKET_BITS = 7;
+    static const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const unsigned int HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+
+    static unsigned int BucketIndex(uint64_t value) {
+      if (value < SUB_BUCKETS) {
+        return static_cast<unsigned int>(value);
+      }
+      // Shift until the value has SUB_BUCKET_BITS - 1 significant bits.
+      unsigned int shift = 0;
+      while ((value >> shift) >= SUB_BUCKETS) {
+        shift++;
+      }
+      const unsigned int mantissa = static_cast<unsigned int>(value >> shift);
+      return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS +
+             (mantissa - HALF_SUB_BUCKETS);
+    }
+
+    static uint64_t BucketUpperBound(unsigned int index) {
+      if (index < SUB_BUCKETS) {
+        return index;
+      }
+      const unsigned int offset = index - SUB_BUCKETS;
+      const unsigned int shift = offset / HALF_SUB_BUCKETS + 1;
+      const uint64_t mantissa = offset % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+      return ((mantissa + 1) << shift) - 1;
+    }
+};
+
+void PrintHistogram(const string &name, const LatencyHistogram &histogram) {
+  cout << name << ": count " << histogram.Count();
+  if (histogram.Count()) {
+    cout << ", mean " << histogram.Mean() << "us"
+         << ", p50 " << histogram.Percentile(50) << "us"
+         << ", p99 " << histogram.Percentile(99) << "us"
+         << ", p99.9 " << histogram.Percentile(99.9) << "us"
+         << ", max " << histogram.Max() << "us";
+  }
+  cout << endl;
+}
+}  // namespace
+
 class Tracker {
  public:
     Tracker()
         : m_count(0),
-          m_sum(0) {
+          m_lost(0),
+          m_sequence(0),
+          m_waiting_for_ack(false),
+          m_waiting_for_data(false),
+          m_timeout(ola::thread::INVALID_TIMEOUT) {
       m_buffer.Blackout();
     }
 
     bool Setup();
     void Start();
 
-    void GotDmx(const DmxBuffer &data, const string &error);
-    void SendComplete(const string &error);
-
  private:
     uint32_t m_count;
-    uint64_t m_sum;
-    TimeInterval m_max;
+    uint32_t m_lost;
+    uint32_t m_sequence;
+    bool m_waiting_for_ack;
+    bool m_waiting_for_data;
+    ola::thread::timeout_id m_timeout;
     ola::DmxBuffer m_buffer;
-    OlaCallbackClientWrapper m_wrapper;
+    OlaClientWrapper m_wrapper;
     ola::Clock m_clock;
     ola::thread::SignalThread m_signal_thread;
     TimeStamp m_send_time;
+    // The time from sending until olad acknowledges the RPC.
+    LatencyHistogram m_rpc_latency;
+    // The time from sending until the data arrives on the loopback universe.
+    LatencyHistogram m_delivery_latency;
+
+    void GotDmx(const Result &result, const DMXMetadata &metadata,
+                const DmxBuffer &data);
+    void SendComplete(const Result &result);
+    void NewLoopbackData(const DMXMetadata &metadata, const DMXView &view);
+    void RegisterComplete(const Result &result);
+    void LoopbackTimeout();
 
     void SendRequest();
-    void LogTime();
+    void RequestComplete();
+    TimeInterval Elapsed();
     void StartSignalThread();
 };
 
 bool Tracker::Setup() {
-  return m_wrapper.Setup();
+  if (!m_wrapper.Setup()) {
+    return false;
+  }
+  if (FLAGS_loopback_universe) {
+    // Only the sequence number is needed.
+    m_wrapper.GetClient()->SetDMXViewCallback(
+        ola::NewCallback(this, &Tracker::NewLoopbackData), 0,
+        sizeof(m_sequence));
+    m_wrapper.GetClient()->RegisterUniverse(
+        FLAGS_loopback_universe, ola::client::REGISTER,
+        NewSingleCallback(this, &Tracker::RegisterComplete));
+  }
+  return true;
 }
 
 void Tracker::Start() {
@@ -95,51 +234,126 @@ void Tracker::Start() {
   // It also means you can just see the stats and not each individual request
   // if you want.
   cout << "--------------" << endl;
-  cout << "Sent " << m_count << " RPCs" << endl;
-  cout << "Max was " << m_max.MicroSeconds() << " microseconds" << endl;
-  cout << "Mean " << m_sum / m_count << " microseconds" << endl;
+  cout << "Sent " << m_count << " requests";
+  if (FLAGS_loopback_universe) {
+    cout << ", " << m_lost << " frames lost";
+  }
+  cout << endl;
+  PrintHistogram("rpc", m_rpc_latency);
+  if (FLAGS_loopback_universe) {
+    PrintHistogram("delivery", m_delivery_latency);
+  }
 }
 
-void Tracker::GotDmx(const DmxBuffer &, const string &) {
-  LogTime();
+void Tracker::GotDmx(const Result &result, const DMXMetadata&,
+                     const DmxBuffer&) {
+  if (!result.Success()) {
+    OLA_WARN << "FetchDmx failed: " << result.Error();
+  }
+  m_rpc_latency.Record(Elapsed().AsInt());
+  RequestComplete();
+}
+
+void Tracker::SendComplete(const Result &result) {
+  if (!result.Success()) {
+    OLA_WARN << "SendDmx failed: " << result.Error();
+  }
+  m_rpc_latency.Record(Elapsed().AsInt());
+  m_waiting_for_ack = false;
+  if (!m_waiting_for_data) {
+    RequestComplete();
+  }
+}
+
+void Tracker::NewLoopbackData(const DMXMetadata &metadata,
+                              const DMXView &view) {
+  if (!m_waiting_for_data || metadata.universe != FLAGS_loopback_universe ||
+      view.length < sizeof(m_sequence)) {
+    return;
+  }
+  uint32_t sequence = 0;
+  for (unsigned int i = 0; i < sizeof(sequence); i++) {
+    sequence = (sequence << 8) | view.data[i];
+  }
+  if (sequence != m_sequence) {
+    // An earlier frame, or one from another source.
+    return;
+  }
+
+  m_delivery_latency.Record(Elapsed().AsInt());
+  m_waiting_for_data = false;
+  m_wrapper.GetSelectServer()->RemoveTimeout(m_timeout);
+  m_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!m_waiting_for_ack) {
+    RequestComplete();
+  }
+}
+
+void Tracker::RegisterComplete(const Result &result) {
+  if (!result.Success()) {
+    OLA_FATAL << "Failed to register for universe "
+              << FLAGS_loopback_universe << ": " << result.Error();
+    m_wrapper.GetSelectServer()->Terminate();
+  }
 }
 
-void Tracker::SendComplete(const string &) {
-  LogTime();
+void Tracker::LoopbackTimeout() {
+  OLA_INFO << "Frame " << m_sequence << " didn't arrive";
+  m_timeout = ola::thread::INVALID_TIMEOUT;
+  m_waiting_for_data = false;
+  m_lost++;
+  if (!m_waiting_for_ack) {
+    RequestComplete();
+  }
 }
 
 void Tracker::SendRequest() {
   m_clock.CurrentTime(&m_send_time);
-  if (FLAGS_send_dmx) {
-    m_wrapper.GetClient()->SendDmx(
-        FLAGS_universe,
-        m_buffer,
-        NewSingleCallback(this, &Tracker::SendComplete));
-
+  if (FLAGS_loopback_universe) {
+    // Tag the frame so we can tell when it comes back.
+    m_sequence++;
+    for (unsigned int i = 0; i < sizeof(m_sequence); i++) {
+      m_buffer.SetChannel(
+          i, static_cast<uint8_t>(m_sequence >> (8 * (3 - i))));
+    }
+    m_waiting_for_ack = true;
+    m_waiting_for_data = true;
+    m_timeout = m_wrapper.GetSelectServer()->RegisterSingleTimeout(
+        FLAGS_timeout,
+        NewSingleCallback(this, &Tracker::LoopbackTimeout));
+    m_wrapper.GetClient()->SendDMX(
+        FLAGS_universe, m_buffer,
+        SendDMXArgs(NewSingleCallback(this, &Tracker::SendComplete)));
+  } else if (FLAGS_send_dmx) {
+    m_wrapper.GetClient()->SendDMX(
+        FLAGS_universe, m_buffer,
+        SendDMXArgs(NewSingleCallback(this, &Tracker::SendComplete)));
   } else {
-    m_wrapper.GetClient()->FetchDmx(
+    m_wrapper.GetClient()->FetchDMX(
         FLAGS_universe,
         NewSingleCallback(this, &Tracker::GotDmx));
   }
 }
 
-void Tracker::LogTime() {
-  TimeStamp now;
-  m_clock.CurrentTime(&now);
-  TimeInterval delta = now - m_send_time;
-  if (delta > m_max) {
-    m_max = delta;
-  }
-  m_sum += delta.MicroSeconds();
-
-  OLA_INFO << "RPC took " << delta;
+void Tracker::RequestComplete() {
+  OLA_INFO << "Request took " << Elapsed();
   if (FLAGS_count == ++m_count) {
     m_wrapper.GetSelectServer()->Terminate();
+  } else if (FLAGS_interval) {
+    m_wrapper.GetSelectServer()->RegisterSingleTimeout(
+        TimeInterval(0, FLAGS_interval),
+        NewSingleCallback(this, &Tracker::SendRequest));
   } else {
     SendRequest();
   }
 }
 
+TimeInterval Tracker::Elapsed() {
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  return now - m_send_time;
+}
+
 void Tracker::StartSignalThread() {
   if (!m_signal_thread.Start()) {
     m_wrapper.GetSelectServer()->Terminate();
@@ -150,6 +364,11 @@ int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "[options]",
                "Measure the latency of RPCs to olad.");
 
+  if (FLAGS_loopback_universe == FLAGS_universe) {
+    OLA_FATAL << "--loopback_universe must be different to --universe";
+    exit(ola::EXIT_USAGE);
+  }
+
   Tracker tracker;
   if (!tracker.Setup()) {
     OLA_FATAL << "Setup failed";
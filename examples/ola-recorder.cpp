@@ -19,6 +19,7 @@
  */
 
 #include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
@@ -33,9 +34,14 @@
 #include <string>
 #include <vector>
 
+#include "examples/AsyncShowSaver.h"
+#include "examples/BinaryShowLoader.h"
+#include "examples/BinaryShowSaver.h"
 #include "examples/ShowPlayer.h"
 #include "examples/ShowLoader.h"
 #include "examples/ShowRecorder.h"
+#include "examples/ShowSaver.h"
+#include "examples/TimeCodeReceiver.h"
 
 using std::auto_ptr;
 using std::cout;
@@ -47,6 +53,32 @@ using std::string;
 DEFINE_s_string(playback, p, "", "The show file to playback.");
 DEFINE_s_string(record, r, "", "The show file to record data to.");
 DEFINE_string(verify, "", "The show file to verify.");
+DEFINE_string(convert, "",
+              "The show file to convert, text files are converted to the "
+              "binary format and binary files to the text format.");
+DEFINE_s_string(output, o, "", "The file to write the converted show to.");
+DEFINE_default_bool(binary, false,
+                    "Record in the binary format, which is smaller and "
+                    "supports --start.");
+DEFINE_uint32(queue_size, AsyncShowSaver::DEFAULT_QUEUE_SIZE,
+              "The number of frames to buffer while recording, frames are "
+              "dropped if the disk can't keep up.");
+DEFINE_uint32(flush_interval, AsyncShowSaver::DEFAULT_FLUSH_INTERVAL_MS,
+              "How often in ms to flush the show file while recording.");
+DEFINE_uint32(sync_interval, 0,
+              "How often in ms to fsync the show file while recording, 0 "
+              "means never.");
+DEFINE_uint32(start, 0,
+              "The offset in ms to start playback from, this needs a binary "
+              "show file.");
+DEFINE_default_bool(chase, false,
+                    "Follow Art-Net timecode during playback, this needs a "
+                    "binary show file.");
+DEFINE_uint16(timecode_port, TimeCodeReceiver::ARTNET_PORT,
+              "The UDP port to listen for Art-Net timecode on.");
+DEFINE_uint32(timecode_offset, 0,
+              "The timecode in ms that the start of the show corresponds "
+              "to, when using --chase.");
 DEFINE_s_string(universes, u, "",
                 "A comma separated list of universes to record");
 DEFINE_s_uint32(delay, d, 0, "The delay in ms between successive iterations.");
@@ -81,7 +113,12 @@ int RecordShow() {
     universes.push_back(universe);
   }
 
-  ShowRecorder show_recorder(FLAGS_record.str(), universes);
+  AsyncShowSaver::Options options;
+  options.queue_size = FLAGS_queue_size;
+  options.flush_interval = FLAGS_flush_interval;
+  options.sync_interval = FLAGS_sync_interval;
+  ShowRecorder show_recorder(FLAGS_record.str(), universes, FLAGS_binary,
+                             options);
   int status = show_recorder.Init();
   if (status)
     return status;
@@ -98,7 +135,10 @@ int RecordShow() {
     }
     show_recorder.Record();
   }
-  cout << "Saved " << show_recorder.FrameCount() << " frames" << endl;
+  cout << "Received " << show_recorder.FrameCount() << " frames, queued "
+       << show_recorder.QueuedFrames() << ", saved "
+       << show_recorder.WrittenFrames() << ", dropped "
+       << show_recorder.DroppedFrames() << endl;
   return ola::EXIT_OK;
 }
 
@@ -107,8 +147,9 @@ int RecordShow() {
  * Verify a show file is valid
  */
 int VerifyShow(const string &filename) {
-  ShowLoader loader(filename);
-  if (!loader.Load())
+  auto_ptr<ShowLoaderInterface> loader(
+      ShowLoaderInterface::NewLoader(filename));
+  if (!loader->Load())
     return ola::EXIT_NOINPUT;
 
   map<unsigned int, unsigned int> frames_by_universe;
@@ -119,12 +160,12 @@ int VerifyShow(const string &filename) {
   unsigned int timeout;
   ShowLoader::State state;
   while (true) {
-    state = loader.NextFrame(&universe, &buffer);
+    state = loader->NextFrame(&universe, &buffer);
     if (state != ShowLoader::OK)
       break;
     frames_by_universe[universe]++;
 
-    state = loader.NextTimeout(&timeout);
+    state = loader->NextTimeout(&timeout);
     if (state != ShowLoader::OK)
       break;
     total_time += timeout;
@@ -151,28 +192,98 @@ int VerifyShow(const string &filename) {
   }
 }
 
+
+/**
+ * Convert a show between the text and binary formats.
+ */
+int ConvertShow(const string &input, const string &output) {
+  if (output.empty()) {
+    OLA_FATAL << "No output file specified, use -o";
+    return ola::EXIT_USAGE;
+  }
+
+  auto_ptr<ShowLoaderInterface> loader;
+  auto_ptr<ShowSaverInterface> saver;
+  if (BinaryShowLoader::IsBinaryShow(input)) {
+    loader.reset(new BinaryShowLoader(input));
+    saver.reset(new ShowSaver(output));
+  } else {
+    loader.reset(new ShowLoader(input));
+    saver.reset(new BinaryShowSaver(output));
+  }
+
+  if (!loader->Load()) {
+    return ola::EXIT_NOINPUT;
+  }
+  if (!saver->Open()) {
+    return ola::EXIT_CANTCREAT;
+  }
+
+  // The savers only use the differences between the arrival times.
+  ola::Clock clock;
+  ola::TimeStamp arrival_time;
+  clock.CurrentTime(&arrival_time);
+
+  unsigned int universe;
+  unsigned int timeout;
+  ola::DmxBuffer buffer;
+  uint64_t frame_count = 0;
+  ShowLoader::State state;
+  while (true) {
+    state = loader->NextFrame(&universe, &buffer);
+    if (state != ShowLoader::OK)
+      break;
+    if (!saver->NewFrame(arrival_time, universe, buffer)) {
+      return ola::EXIT_IOERR;
+    }
+    frame_count++;
+
+    state = loader->NextTimeout(&timeout);
+    if (state != ShowLoader::OK)
+      break;
+    arrival_time += ola::TimeInterval(timeout / 1000, (timeout % 1000) * 1000);
+  }
+  saver->Close();
+
+  if (state == ShowLoader::INVALID_LINE) {
+    OLA_FATAL << "Error loading show, got state " << state;
+    return ola::EXIT_DATAERR;
+  }
+  cout << "Converted " << frame_count << " frames" << endl;
+  return ola::EXIT_OK;
+}
+
 /*
  * Main
  */
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv,
                "[--record <file> --universes <universe_list>] [--playback "
-               "<file>] [--verify <file>]",
+               "<file>] [--verify <file>] [--convert <file> --output <file>]",
                "Record a series of universes, or playback a previously "
                "recorded show.");
 
   if (!FLAGS_playback.str().empty()) {
     ShowPlayer player(FLAGS_playback.str());
     int status = player.Init();
-    if (!status)
-      status = player.Playback(FLAGS_iterations, FLAGS_duration, FLAGS_delay);
+    if (!status) {
+      if (FLAGS_chase) {
+        status = player.Chase(FLAGS_timecode_port, FLAGS_timecode_offset);
+      } else {
+        status = player.Playback(FLAGS_iterations, FLAGS_duration,
+                                 FLAGS_delay, FLAGS_start);
+      }
+    }
     return status;
   } else if (!FLAGS_record.str().empty()) {
     return RecordShow();
   } else if (!FLAGS_verify.str().empty()) {
     return VerifyShow(FLAGS_verify.str());
+  } else if (!FLAGS_convert.str().empty()) {
+    return ConvertShow(FLAGS_convert.str(), FLAGS_output.str());
   } else {
-    OLA_FATAL << "One of --record or --playback or --verify must be provided";
+    OLA_FATAL << "One of --record, --playback, --verify or --convert must be "
+              << "provided";
     ola::DisplayUsage();
   }
   return ola::EXIT_OK;
@@ -0,0 +1,455 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ola-replay.cpp
+ * Replay captured network DMX traffic into olad and measure how it copes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/StringUtils.h>
+#include <ola/base/Flags.h>
+#include <ola/base/Init.h>
+#include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/network/IPV4Address.h>
+#include <ola/network/PcapReader.h>
+#include <ola/network/Socket.h>
+#include <ola/network/SocketAddress.h>
+#include <ola/thread/SignalThread.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using ola::DmxBuffer;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::client::DMXMetadata;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::network::CapturedDatagram;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::PcapReader;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+DEFINE_string(target, "127.0.0.1",
+              "Send the packets to this address rather than their original "
+              "destination. Set this to an empty string to keep the captured "
+              "destinations.");
+DEFINE_uint32(speed, 100,
+              "The replay speed, as a percentage of the original. 0 sends "
+              "the packets as fast as possible.");
+DEFINE_string(ports, "2501,5568,6038,6454",
+              "The UDP ports to replay: ShowNet, E1.31, KiNet and Art-Net by "
+              "default.");
+DEFINE_string(universes, "",
+              "A comma separated list of universes to register for. The "
+              "frames olad outputs on these are counted and checksummed.");
+DEFINE_uint32(olad_pid, 0, "The pid of olad, to report the CPU it used.");
+DEFINE_uint32(settle_time, 1000,
+              "How long to wait for olad's output after the last packet, in "
+              "ms.");
+
+namespace {
+
+/*
+ * Read the user and system CPU time of a process from /proc, in clock ticks.
+ */
+bool ProcessCPUTicks(unsigned int pid, uint64_t *ticks) {
+  std::ostringstream path;
+  path << "/proc/" << pid << "/stat";
+  std::ifstream file(path.str().c_str());
+  string stat;
+  if (!std::getline(file, stat)) {
+    return false;
+  }
+  // The command name may contain spaces, so skip past it.
+  const size_t end_of_name = stat.rfind(')');
+  if (end_of_name == string::npos) {
+    return false;
+  }
+  std::istringstream fields(stat.substr(end_of_name + 1));
+  string field;
+  uint64_t user = 0, system = 0;
+  // utime and stime are the 12th and 13th fields after the name.
+  for (unsigned int i = 0; i < 13 && fields >> field; i++) {
+    if (i == 11) {
+      user = strtoull(field.c_str(), NULL, 10);
+    } else if (i == 12) {
+      system = strtoull(field.c_str(), NULL, 10);
+      *ticks = user + system;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseList(const string &input, set<unsigned int> *values) {
+  vector<string> tokens;
+  ola::StringSplit(input, &tokens, ",");
+  vector<string>::const_iterator iter = tokens.begin();
+  for (; iter != tokens.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+    unsigned int value;
+    if (!ola::StringToInt(*iter, &value)) {
+      return false;
+    }
+    values->insert(value);
+  }
+  return true;
+}
+}  // namespace
+
+class Replayer {
+ public:
+  Replayer(PcapReader *reader, const set<uint16_t> &ports,
+           const set<unsigned int> &universes)
+      : m_reader(reader),
+        m_ports(ports),
+        m_universes(universes),
+        m_have_next(false),
+        m_waiting_for_output(false),
+        m_sent(0),
+        m_filtered(0),
+        m_send_errors(0),
+        m_start_ticks(0),
+        m_latency_count(0),
+        m_latency_sum(0),
+        m_latency_max(0) {
+  }
+
+  bool Setup();
+  void Run();
+
+ private:
+  struct UniverseStats {
+    UniverseStats() : frames(0), checksum(0) {}
+
+    uint64_t frames;
+    uint32_t checksum;
+  };
+
+  auto_ptr<PcapReader> m_reader;
+  const set<uint16_t> m_ports;
+  const set<unsigned int> m_universes;
+  OlaClientWrapper m_wrapper;
+  ola::network::UDPSocket m_socket;
+  ola::thread::SignalThread m_signal_thread;
+  ola::Clock m_clock;
+  IPV4Address m_target;
+
+  CapturedDatagram m_next;
+  bool m_have_next;
+  bool m_waiting_for_output;
+  TimeStamp m_capture_start;
+  TimeStamp m_replay_start;
+  TimeStamp m_last_send;
+  uint64_t m_sent;
+  uint64_t m_filtered;
+  uint64_t m_send_errors;
+  uint64_t m_start_ticks;
+  uint64_t m_latency_count;
+  uint64_t m_latency_sum;
+  uint64_t m_latency_max;
+  map<unsigned int, UniverseStats> m_stats;
+
+  bool LoadNext();
+  void SendDue();
+  void Send(const CapturedDatagram &datagram);
+  void ReplayComplete();
+  void NewDmx(const DMXMetadata &metadata, const DmxBuffer &data);
+  void RegisterComplete(unsigned int universe, const Result &result);
+  void StartSignalThread();
+  void PrintReport(const TimeInterval &duration);
+};
+
+bool Replayer::Setup() {
+  if (!FLAGS_target.str().empty() &&
+      !IPV4Address::FromString(FLAGS_target.str(), &m_target)) {
+    OLA_FATAL << "Invalid --target " << FLAGS_target.str();
+    return false;
+  }
+  if (!m_socket.Init() || !m_socket.EnableBroadcast()) {
+    return false;
+  }
+
+  if (!m_universes.empty()) {
+    if (!m_wrapper.Setup()) {
+      return false;
+    }
+    m_wrapper.GetClient()->SetDMXCallback(
+        NewCallback(this, &Replayer::NewDmx));
+    set<unsigned int>::const_iterator iter = m_universes.begin();
+    for (; iter != m_universes.end(); ++iter) {
+      m_stats[*iter] = UniverseStats();
+      m_wrapper.GetClient()->RegisterUniverse(
+          *iter, ola::client::REGISTER,
+          NewSingleCallback(this, &Replayer::RegisterComplete, *iter));
+    }
+  }
+
+  if (FLAGS_olad_pid && !ProcessCPUTicks(FLAGS_olad_pid, &m_start_ticks)) {
+    OLA_FATAL << "Can't read the CPU time of pid " << FLAGS_olad_pid;
+    return false;
+  }
+
+  m_have_next = LoadNext();
+  if (!m_have_next) {
+    OLA_FATAL << "No datagrams to replay";
+    return false;
+  }
+  m_capture_start = m_next.time;
+  return true;
+}
+
+void Replayer::Run() {
+  ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+  m_signal_thread.InstallSignalHandler(
+      SIGINT,
+      ola::NewCallback(ss, &ola::io::SelectServer::Terminate));
+  m_signal_thread.InstallSignalHandler(
+      SIGTERM,
+      ola::NewCallback(ss, &ola::io::SelectServer::Terminate));
+  ss->Execute(ola::NewSingleCallback(this, &Replayer::StartSignalThread));
+
+  m_clock.CurrentTime(&m_replay_start);
+  ss->Execute(NewSingleCallback(this, &Replayer::SendDue));
+  ss->Run();
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  PrintReport(now - m_replay_start);
+}
+
+/*
+ * Read the next datagram on one of the replayed ports.
+ */
+bool Replayer::LoadNext() {
+  while (m_reader->NextDatagram(&m_next)) {
+    if (m_ports.find(m_next.destination.Port()) != m_ports.end()) {
+      return true;
+    }
+    m_filtered++;
+  }
+  return false;
+}
+
+/*
+ * Send the datagrams that are due, and schedule the next call.
+ */
+void Replayer::SendDue() {
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  TimeInterval delay;
+  // In fast mode, send in batches so the client connection is serviced.
+  const unsigned int batch_size = 64;
+  unsigned int sent = 0;
+  while (m_have_next) {
+    if (FLAGS_speed) {
+      const int64_t offset = (
+          (m_next.time - m_capture_start).AsInt() * 100 /
+          FLAGS_speed);
+      const TimeStamp due = m_replay_start + TimeInterval(offset);
+      if (due > now) {
+        delay = due - now;
+        break;
+      }
+    } else if (sent == batch_size) {
+      break;
+    }
+    Send(m_next);
+    sent++;
+    m_have_next = LoadNext();
+  }
+
+  ola::io::SelectServer *ss = m_wrapper.GetSelectServer();
+  if (!m_have_next) {
+    if (m_reader->Failed()) {
+      OLA_WARN << "The capture is corrupt, stopping the replay early";
+    }
+    ss->RegisterSingleTimeout(
+        FLAGS_settle_time,
+        NewSingleCallback(this, &Replayer::ReplayComplete));
+  } else if (delay.InMilliSeconds() > 0) {
+    ss->RegisterSingleTimeout(delay,
+                              NewSingleCallback(this, &Replayer::SendDue));
+  } else {
+    // Due within the next millisecond, so poll once and carry on.
+    ss->Execute(NewSingleCallback(this, &Replayer::SendDue));
+  }
+}
+
+void Replayer::Send(const CapturedDatagram &datagram) {
+  const IPV4SocketAddress destination(
+      FLAGS_target.str().empty() ? datagram.destination.Host() : m_target,
+      datagram.destination.Port());
+  const ssize_t sent = m_socket.SendTo(
+      datagram.payload.empty() ? NULL : &datagram.payload[0],
+      datagram.payload.size(), destination);
+  if (sent != static_cast<ssize_t>(datagram.payload.size())) {
+    m_send_errors++;
+    return;
+  }
+  m_sent++;
+  m_clock.CurrentTime(&m_last_send);
+  m_waiting_for_output = true;
+}
+
+void Replayer::ReplayComplete() {
+  m_wrapper.GetSelectServer()->Terminate();
+}
+
+/*
+ * The latency is the time from sending a datagram until the next frame olad
+ * outputs on a registered universe. At high packet rates this is a lower
+ * bound, since the frame may be the result of an earlier datagram.
+ */
+void Replayer::NewDmx(const DMXMetadata &metadata, const DmxBuffer &data) {
+  map<unsigned int, UniverseStats>::iterator iter =
+      m_stats.find(metadata.universe);
+  if (iter == m_stats.end()) {
+    return;
+  }
+  iter->second.frames++;
+  iter->second.checksum = data.Hash();
+
+  if (m_waiting_for_output) {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    const uint64_t latency = (now - m_last_send).AsInt();
+    m_latency_count++;
+    m_latency_sum += latency;
+    m_latency_max = std::max(m_latency_max, latency);
+    m_waiting_for_output = false;
+  }
+}
+
+void Replayer::RegisterComplete(unsigned int universe, const Result &result) {
+  if (!result.Success()) {
+    OLA_FATAL << "Failed to register for universe " << universe << ": "
+              << result.Error();
+    m_wrapper.GetSelectServer()->Terminate();
+  }
+}
+
+void Replayer::StartSignalThread() {
+  if (!m_signal_thread.Start()) {
+    m_wrapper.GetSelectServer()->Terminate();
+  }
+}
+
+void Replayer::PrintReport(const TimeInterval &duration) {
+  cout << "--------------" << endl;
+  cout << "Replayed " << m_sent << " datagrams in " << duration << "s"
+       << ", skipped " << m_reader->PacketsSkipped() + m_filtered
+       << " packets";
+  if (m_send_errors) {
+    cout << ", " << m_send_errors << " send errors";
+  }
+  cout << endl;
+
+  uint64_t end_ticks;
+  if (FLAGS_olad_pid && ProcessCPUTicks(FLAGS_olad_pid, &end_ticks)) {
+    const double cpu_seconds = (
+        static_cast<double>(end_ticks - m_start_ticks) /
+        sysconf(_SC_CLK_TCK));
+    const double wall_seconds = duration.AsInt() / 1000000.0;
+    cout << "olad CPU: " << std::fixed << std::setprecision(2)
+         << cpu_seconds << "s";
+    if (wall_seconds > 0) {
+      cout << ", " << 100 * cpu_seconds / wall_seconds << "%";
+    }
+    cout << endl;
+  }
+
+  if (m_universes.empty()) {
+    return;
+  }
+  cout << "latency: count " << m_latency_count;
+  if (m_latency_count) {
+    cout << ", mean " << m_latency_sum / m_latency_count << "us"
+         << ", max " << m_latency_max << "us";
+  }
+  cout << endl;
+
+  map<unsigned int, UniverseStats>::const_iterator iter = m_stats.begin();
+  for (; iter != m_stats.end(); ++iter) {
+    cout << "universe " << iter->first << ": " << iter->second.frames
+         << " frames, final frame checksum " << std::hex << std::setw(8)
+         << std::setfill('0') << iter->second.checksum << std::dec
+         << std::setfill(' ') << endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options] <capture_file>",
+               "Replay the E1.31, Art-Net, ShowNet and KiNet traffic in a "
+               "pcap or pcapng capture to olad, and report the CPU olad used, "
+               "the output latency and checksums of the output frames.");
+
+  if (argc != 2) {
+    ola::DisplayUsageAndExit();
+  }
+
+  set<unsigned int> ports, universes;
+  if (!ParseList(FLAGS_ports.str(), &ports) ||
+      !ParseList(FLAGS_universes.str(), &universes)) {
+    OLA_FATAL << "Invalid --ports or --universes";
+    exit(ola::EXIT_USAGE);
+  }
+  set<uint16_t> udp_ports;
+  set<unsigned int>::const_iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    udp_ports.insert(static_cast<uint16_t>(*iter));
+  }
+
+  PcapReader *reader = PcapReader::Open(argv[1]);
+  if (!reader) {
+    exit(ola::EXIT_NOINPUT);
+  }
+
+  Replayer replayer(reader, udp_ports, universes);
+  if (!replayer.Setup()) {
+    OLA_FATAL << "Setup failed";
+    exit(1);
+  }
+  replayer.Run();
+  return 0;
+}
@@ -18,22 +18,32 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <ola/client/StreamingClient.h>
 #include <ola/StringUtils.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
+#include <ola/dmx/BinaryFrame.h>
 #include <ola/dmx/SourcePriorities.h>
 
 #include <iostream>
+#include <set>
 #include <string>
+#include <vector>
 
 using std::cout;
 using std::endl;
+using std::set;
 using std::string;
+using std::vector;
 using ola::client::StreamingClient;
+using ola::dmx::BinaryFrame;
 
 DEFINE_s_string(dmx, d, "", "Comma separated DMX values to send, e.g. "
                             "0,255,128 sets first channel to 0, second "
@@ -41,9 +51,14 @@ DEFINE_s_string(dmx, d, "", "Comma separated DMX values to send, e.g. "
 DEFINE_s_uint32(universe, u, 1, "The universe to send data for");
 DEFINE_uint8(priority, ola::dmx::SOURCE_PRIORITY_DEFAULT,
              "The source priority to send data at");
+DEFINE_default_bool(binary, false,
+                    "Read binary frames, for any number of universes, from "
+                    "STDIN rather than text.");
 
 bool terminate = false;
 
+static const unsigned int BINARY_BUFFER_SIZE = 65536;
+
 bool SendDataFromString(StreamingClient *client,
                         unsigned int universe,
                         const string &data) {
@@ -65,6 +80,85 @@ bool SendDataFromString(StreamingClient *client,
   return true;
 }
 
+void SendUpdates(StreamingClient *client,
+                 vector<StreamingClient::DmxUpdate> *updates,
+                 set<unsigned int> *universes) {
+  if (updates->empty()) {
+    return;
+  }
+  if (!client->SendBatch(*updates)) {
+    cout << "Send DMX failed" << endl;
+    terminate = true;
+  }
+  updates->clear();
+  universes->clear();
+}
+
+/*
+ * Read binary frames from STDIN. The frames are sent in batches, a batch is
+ * sent once STDIN has been drained, or when a universe appears for a second
+ * time so no frames are dropped.
+ */
+bool SendBinaryFromStdin(StreamingClient *client) {
+  vector<uint8_t> buffer(BINARY_BUFFER_SIZE);
+  unsigned int used = 0;
+  vector<StreamingClient::DmxUpdate> updates;
+  set<unsigned int> universes;
+
+  while (!terminate) {
+    unsigned int space = BINARY_BUFFER_SIZE - used;
+    ssize_t size = read(STDIN_FILENO, &buffer[used], space);
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      OLA_WARN << "Failed to read from STDIN: " << strerror(errno);
+      break;
+    } else if (size == 0) {
+      break;
+    }
+    used += size;
+
+    unsigned int offset = 0;
+    while (used - offset >= BinaryFrame::HEADER_SIZE) {
+      unsigned int universe, slot_count;
+      if (!BinaryFrame::ParseHeader(&buffer[offset], &universe,
+                                    &slot_count)) {
+        OLA_WARN << "Invalid frame header, " << slot_count << " slots";
+        return false;
+      }
+      unsigned int frame_size = BinaryFrame::HEADER_SIZE + slot_count;
+      if (used - offset < frame_size) {
+        break;
+      }
+
+      if (!universes.insert(universe).second) {
+        SendUpdates(client, &updates, &universes);
+        universes.insert(universe);
+      }
+      updates.push_back(StreamingClient::DmxUpdate(
+          universe,
+          ola::DmxBuffer(&buffer[offset + BinaryFrame::HEADER_SIZE],
+                         slot_count),
+          FLAGS_priority));
+      offset += frame_size;
+    }
+
+    memmove(&buffer[0], &buffer[offset], used - offset);
+    used -= offset;
+
+    if (static_cast<unsigned int>(size) < space) {
+      SendUpdates(client, &updates, &universes);
+    }
+  }
+
+  SendUpdates(client, &updates, &universes);
+  if (used) {
+    OLA_WARN << "Discarding " << used << " bytes of a partial frame";
+  }
+  return !terminate;
+}
+
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "--dmx <dmx_data> --universe <universe_id>",
                "Send DMX512 data to OLA. If DMX512 data isn't provided, it "
@@ -76,7 +170,9 @@ int main(int argc, char *argv[]) {
     exit(1);
   }
 
-  if (FLAGS_dmx.str().empty()) {
+  if (FLAGS_binary) {
+    SendBinaryFromStdin(&ola_client);
+  } else if (FLAGS_dmx.str().empty()) {
     string input;
     while (!terminate && std::cin >> input) {
       ola::StringTrim(&input);
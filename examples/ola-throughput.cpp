@@ -14,52 +14,470 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  *
  * ola-throughput.cpp
- * Send a bunch of frames quickly to load test the server.
+ * Load test olad with many clients and universes, and report the throughput.
  * Copyright (C) 2005 Simon Newton
  */
 
-#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <ola/base/Flags.h>
-#include <ola/base/Init.h>
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
-#include <ola/StreamingClient.h>
 #include <ola/StringUtils.h>
+#include <ola/base/Flags.h>
+#include <ola/base/Init.h>
+#include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/io/SelectServer.h>
+#include <ola/stl/STLUtils.h>
+#include <ola/thread/SignalThread.h>
+#include <ola/thread/Thread.h>
+#include <ola/web/Json.h>
+#include <ola/web/JsonWriter.h>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
+using ola::DmxBuffer;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::client::DMXMetadata;
+using ola::client::DMXView;
+using ola::client::OlaClientWrapper;
+using ola::client::RegisterArgs;
+using ola::client::Result;
+using ola::client::SendDMXArgs;
+using ola::client::StreamingClient;
+using ola::io::SelectServer;
+using ola::web::JsonObject;
+using ola::web::JsonUInt64;
 using std::cout;
 using std::endl;
 using std::string;
-using ola::StreamingClient;
+using std::vector;
 
-DEFINE_s_uint32(universe, u, 1, "The universe to send data on");
+DEFINE_s_uint32(universe, u, 1, "The first universe to send data on");
+DEFINE_uint32(universes, 1, "The number of universes to send data on");
+DEFINE_s_uint32(producers, p, 1,
+                "The number of clients sending data, the universes are split "
+                "between them");
+DEFINE_uint32(sinks, 0,
+              "The number of clients that register for all the universes");
+DEFINE_s_string(api, a, "streaming",
+                "The API the producers use, one of streaming, batch or client");
 DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
+DEFINE_s_uint32(duration, d, 10,
+                "The number of seconds to run for, 0 runs until interrupted");
+DEFINE_uint32(olad_pid, 0, "The pid of olad, used to report its CPU usage");
+
+namespace {
+
+/*
+ * A client running on its own thread.
+ */
+class Worker : public ola::thread::Thread {
+ public:
+  Worker() : Thread(Thread::Options("ola-throughput")) {}
+  virtual ~Worker() {}
+
+  virtual bool Setup() = 0;
+
+  void Stop() {
+    SS()->Execute(NewSingleCallback(SS(), &SelectServer::Terminate));
+    Join();
+  }
+
+ protected:
+  virtual SelectServer *SS() = 0;
+
+  void *Run() {
+    SS()->Run();
+    return NULL;
+  }
+};
+
+/*
+ * Sends a new frame to each of its universes every interval.
+ */
+class Producer : public Worker {
+ public:
+  Producer(const vector<unsigned int> &universes,
+           const TimeInterval &interval)
+      : m_universes(universes),
+        m_frames_sent(0),
+        m_frames_failed(0),
+        m_interval(interval),
+        m_value(0) {
+  }
+
+  bool Setup() {
+    if (!Connect()) {
+      return false;
+    }
+    SS()->RegisterRepeatingTimeout(m_interval,
+                                   NewCallback(this, &Producer::Tick));
+    return true;
+  }
+
+  uint64_t FramesSent() const { return m_frames_sent; }
+  uint64_t FramesFailed() const { return m_frames_failed; }
+
+ protected:
+  const vector<unsigned int> m_universes;
+  uint64_t m_frames_sent;
+  uint64_t m_frames_failed;
+
+  virtual bool Connect() = 0;
+  virtual void SendFrame(const DmxBuffer &frame) = 0;
+
+ private:
+  const TimeInterval m_interval;
+  DmxBuffer m_frame;
+  uint8_t m_value;
+
+  bool Tick() {
+    // Change every slot, so each frame is a full update.
+    m_frame.SetRangeToValue(0, m_value++, ola::DMX_UNIVERSE_SIZE);
+    SendFrame(m_frame);
+    return true;
+  }
+};
+
+/*
+ * Sends with StreamingClient, either one universe at a time or as a batch.
+ */
+class StreamingProducer : public Producer {
+ public:
+  StreamingProducer(const vector<unsigned int> &universes,
+                    const TimeInterval &interval,
+                    bool batch)
+      : Producer(universes, interval),
+        m_batch(batch) {
+  }
+
+ protected:
+  SelectServer *SS() { return &m_ss; }
+
+  bool Connect() {
+    return m_client.Setup();
+  }
+
+  void SendFrame(const DmxBuffer &frame) {
+    if (m_batch) {
+      vector<StreamingClient::DmxUpdate> updates;
+      vector<unsigned int>::const_iterator iter = m_universes.begin();
+      for (; iter != m_universes.end(); ++iter) {
+        updates.push_back(StreamingClient::DmxUpdate(*iter, frame));
+      }
+      if (m_client.SendBatch(updates)) {
+        m_frames_sent += updates.size();
+      } else {
+        m_frames_failed += updates.size();
+      }
+      return;
+    }
+
+    vector<unsigned int>::const_iterator iter = m_universes.begin();
+    for (; iter != m_universes.end(); ++iter) {
+      if (m_client.SendDMX(*iter, frame, StreamingClient::SendArgs())) {
+        m_frames_sent++;
+      } else {
+        m_frames_failed++;
+      }
+    }
+  }
+
+ private:
+  const bool m_batch;
+  SelectServer m_ss;
+  StreamingClient m_client;
+};
+
+/*
+ * Sends with OlaClient, counting the frames once they're acknowledged.
+ */
+class ClientProducer : public Producer {
+ public:
+  ClientProducer(const vector<unsigned int> &universes,
+                 const TimeInterval &interval)
+      : Producer(universes, interval),
+        m_wrapper(false) {
+  }
+
+ protected:
+  SelectServer *SS() { return m_wrapper.GetSelectServer(); }
+
+  bool Connect() {
+    return m_wrapper.Setup();
+  }
+
+  void SendFrame(const DmxBuffer &frame) {
+    vector<unsigned int>::const_iterator iter = m_universes.begin();
+    for (; iter != m_universes.end(); ++iter) {
+      SendDMXArgs args(NewSingleCallback(this, &ClientProducer::SendComplete));
+      m_wrapper.GetClient()->SendDMX(*iter, frame, args);
+    }
+  }
+
+ private:
+  OlaClientWrapper m_wrapper;
+
+  void SendComplete(const Result &result) {
+    if (result.Success()) {
+      m_frames_sent++;
+    } else {
+      m_frames_failed++;
+    }
+  }
+};
+
+/*
+ * Registers for all the universes and counts the frames it receives.
+ */
+class Sink : public Worker {
+ public:
+  explicit Sink(const vector<unsigned int> &universes)
+      : m_universes(universes),
+        m_wrapper(false),
+        m_frames_received(0) {
+  }
+
+  bool Setup() {
+    if (!m_wrapper.Setup()) {
+      return false;
+    }
+    ola::client::OlaClient *client = m_wrapper.GetClient();
+    client->SetDMXViewCallback(NewCallback(this, &Sink::NewDMX));
+    vector<unsigned int>::const_iterator iter = m_universes.begin();
+    for (; iter != m_universes.end(); ++iter) {
+      client->RegisterUniverse(
+          *iter, ola::client::REGISTER,
+          NewSingleCallback(this, &Sink::RegisterComplete));
+    }
+    return true;
+  }
+
+  uint64_t FramesReceived() const { return m_frames_received; }
+
+ protected:
+  SelectServer *SS() { return m_wrapper.GetSelectServer(); }
+
+ private:
+  const vector<unsigned int> m_universes;
+  OlaClientWrapper m_wrapper;
+  uint64_t m_frames_received;
+
+  void NewDMX(const DMXMetadata&, const DMXView&) {
+    m_frames_received++;
+  }
+
+  void RegisterComplete(const Result &result) {
+    if (!result.Success()) {
+      OLA_WARN << "Failed to register universe: " << result.Error();
+    }
+  }
+};
+
+/*
+ * Get the CPU time used by a process, in clock ticks.
+ */
+bool GetCPUTicks(unsigned int pid, uint64_t *ticks) {
+  std::ifstream stat_file(("/proc/" + ola::IntToString(pid) + "/stat").c_str());
+  string line;
+  if (!std::getline(stat_file, line)) {
+    return false;
+  }
+
+  // The command name may contain spaces, so skip past it.
+  const string::size_type pos = line.rfind(')');
+  if (pos == string::npos) {
+    return false;
+  }
+  vector<string> fields;
+  ola::StringSplit(line.substr(pos + 2), &fields, " ");
+  // utime and stime are fields 14 and 15 of the full line.
+  unsigned int utime, stime;
+  if (fields.size() < 13 || !ola::StringToInt(fields[11], &utime) ||
+      !ola::StringToInt(fields[12], &stime)) {
+    return false;
+  }
+  *ticks = static_cast<uint64_t>(utime) + stime;
+  return true;
+}
+
+double Seconds(const TimeInterval &interval) {
+  return interval.AsInt() / 1000000.0;
+}
+
+double Rate(uint64_t count, const TimeInterval &elapsed) {
+  const double seconds = Seconds(elapsed);
+  return seconds > 0 ? count / seconds : 0.0;
+}
+
+void StartSignalThread(ola::thread::SignalThread *signal_thread,
+                       SelectServer *ss) {
+  if (!signal_thread->Start()) {
+    ss->Terminate();
+  }
+}
+}  // namespace
 
 /*
  * Main
  */
 int main(int argc, char *argv[]) {
-  ola::AppInit(&argc, argv, "[options]", "Send DMX512 data to OLA.");
+  ola::AppInit(&argc, argv, "[options]",
+               "Load test olad and print the throughput as JSON.");
 
-  StreamingClient ola_client;
-  if (!ola_client.Setup()) {
-    OLA_FATAL << "Setup failed";
-    exit(1);
+  if (FLAGS_api.str() != "streaming" && FLAGS_api.str() != "batch" &&
+      FLAGS_api.str() != "client") {
+    OLA_FATAL << "Unknown API " << FLAGS_api.str();
+    exit(ola::EXIT_USAGE);
+  }
+  if (!FLAGS_universes || !FLAGS_producers || !FLAGS_sleep) {
+    OLA_FATAL << "--universes, --producers and --sleep must be non-zero";
+    exit(ola::EXIT_USAGE);
   }
 
-  ola::DmxBuffer buffer;
-  buffer.Blackout();
+  // Split the universes between the producers.
+  const unsigned int producer_count = std::min(
+      static_cast<unsigned int>(FLAGS_producers),
+      static_cast<unsigned int>(FLAGS_universes));
+  vector<vector<unsigned int> > assignments(producer_count);
+  vector<unsigned int> all_universes;
+  for (unsigned int i = 0; i < FLAGS_universes; i++) {
+    assignments[i % producer_count].push_back(FLAGS_universe + i);
+    all_universes.push_back(FLAGS_universe + i);
+  }
+
+  SelectServer ss;
+  ola::thread::SignalThread signal_thread;
+  // This has to happen before the worker threads start, so they inherit the
+  // blocked signals.
+  signal_thread.InstallSignalHandler(
+      SIGINT, NewCallback(&ss, &SelectServer::Terminate));
+  signal_thread.InstallSignalHandler(
+      SIGTERM, NewCallback(&ss, &SelectServer::Terminate));
 
-  while (1) {
-    usleep(FLAGS_sleep);
-    if (!ola_client.SendDmx(FLAGS_universe, buffer)) {
-      cout << "Send DMX failed" << endl;
-      exit(1);
+  const TimeInterval interval(0, FLAGS_sleep);
+  vector<Sink*> sinks;
+  vector<Producer*> producers;
+  for (unsigned int i = 0; i < FLAGS_sinks; i++) {
+    sinks.push_back(new Sink(all_universes));
+  }
+  for (unsigned int i = 0; i < producer_count; i++) {
+    if (FLAGS_api.str() == "client") {
+      producers.push_back(new ClientProducer(assignments[i], interval));
+    } else {
+      producers.push_back(new StreamingProducer(
+          assignments[i], interval, FLAGS_api.str() == "batch"));
     }
   }
-  return 0;
+
+  // Start the sinks first so they see every frame.
+  bool ok = true;
+  for (unsigned int i = 0; ok && i < sinks.size(); i++) {
+    ok = sinks[i]->Setup() && sinks[i]->Start();
+  }
+  for (unsigned int i = 0; ok && i < producers.size(); i++) {
+    ok = producers[i]->Setup();
+  }
+  if (!ok) {
+    OLA_FATAL << "Setup failed";
+    exit(ola::EXIT_UNAVAILABLE);
+  }
+
+  uint64_t start_ticks = 0;
+  const bool have_cpu = FLAGS_olad_pid && GetCPUTicks(FLAGS_olad_pid,
+                                                      &start_ticks);
+  if (FLAGS_olad_pid && !have_cpu) {
+    OLA_WARN << "Unable to read the CPU usage of pid " << FLAGS_olad_pid;
+  }
+
+  TimeStamp start, end;
+  ola::Clock clock;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < producers.size(); i++) {
+    producers[i]->Start();
+  }
+
+  if (FLAGS_duration) {
+    ss.RegisterSingleTimeout(
+        FLAGS_duration * 1000,
+        NewSingleCallback(&ss, &SelectServer::Terminate));
+  }
+  ss.Execute(NewSingleCallback(StartSignalThread, &signal_thread, &ss));
+  ss.Run();
+
+  for (unsigned int i = 0; i < producers.size(); i++) {
+    producers[i]->Stop();
+  }
+  clock.CurrentTime(&end);
+  uint64_t end_ticks = 0;
+  const bool have_end_cpu = have_cpu && GetCPUTicks(FLAGS_olad_pid,
+                                                    &end_ticks);
+  for (unsigned int i = 0; i < sinks.size(); i++) {
+    sinks[i]->Stop();
+  }
+
+  uint64_t frames_sent = 0;
+  uint64_t frames_failed = 0;
+  uint64_t frames_received = 0;
+  for (unsigned int i = 0; i < producers.size(); i++) {
+    frames_sent += producers[i]->FramesSent();
+    frames_failed += producers[i]->FramesFailed();
+  }
+  for (unsigned int i = 0; i < sinks.size(); i++) {
+    frames_received += sinks[i]->FramesReceived();
+  }
+  const TimeInterval elapsed = end - start;
+
+  JsonObject json;
+  json.Add("api", FLAGS_api.str());
+  json.Add("producers", producer_count);
+  json.Add("sinks", static_cast<unsigned int>(FLAGS_sinks));
+  json.Add("universes", static_cast<unsigned int>(FLAGS_universes));
+  json.Add("target_fps_per_universe", 1000000.0 / FLAGS_sleep);
+  json.Add("duration_s", Seconds(elapsed));
+
+  JsonObject *sent = json.AddObject("sent");
+  sent->AddValue("frames", new JsonUInt64(frames_sent));
+  sent->AddValue("failed", new JsonUInt64(frames_failed));
+  sent->Add("fps", Rate(frames_sent, elapsed));
+  sent->Add("fps_per_universe",
+            Rate(frames_sent, elapsed) / FLAGS_universes);
+
+  if (!sinks.empty()) {
+    JsonObject *delivered = json.AddObject("delivered");
+    delivered->AddValue("frames", new JsonUInt64(frames_received));
+    delivered->Add("fps_per_sink",
+                   Rate(frames_received, elapsed) / sinks.size());
+    delivered->Add("ratio",
+                   frames_sent ?
+                   static_cast<double>(frames_received) /
+                   (frames_sent * sinks.size()) : 0.0);
+  }
+
+  if (have_end_cpu) {
+    // The usage of one core, so this can exceed 100% if olad is threaded.
+    const double cpu_seconds = static_cast<double>(end_ticks - start_ticks) /
+                               sysconf(_SC_CLK_TCK);
+    json.Add("olad_cpu_percent", Rate(1, elapsed) * cpu_seconds * 100.0);
+  }
+
+  cout << ola::web::JsonWriter::AsString(json) << endl;
+
+  ola::STLDeleteElements(&producers);
+  ola::STLDeleteElements(&sinks);
+  return ola::EXIT_OK;
 }
@@ -19,6 +19,7 @@
  */
 
 #include <errno.h>
+#include <math.h>
 #include <signal.h>
 #include <stdlib.h>
 
@@ -32,6 +33,8 @@
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/client/OlaClient.h>
 #include <ola/io/StdinHandler.h>
 
 #include <iostream>
@@ -45,6 +48,10 @@ using ola::OlaCallbackClientWrapper;
 using ola::StringToInt;
 using ola::TimeInterval;
 using ola::TimeStamp;
+using ola::client::FetchUniverseStatsArgs;
+using ola::client::OlaClientWrapper;
+using ola::client::Result;
+using ola::client::UniverseStats;
 using ola::io::SelectServer;
 using std::cerr;
 using std::cout;
@@ -53,6 +60,12 @@ using std::setw;
 using std::string;
 using std::vector;
 
+DEFINE_s_default_bool(all, a, false,
+                      "Sample the server's counters for all universes, "
+                      "rather than receiving every frame.");
+DEFINE_s_uint32(interval, i, 1,
+                "With --all, the time between samples in seconds.");
+
 
 class UniverseTracker {
  public:
@@ -232,6 +245,159 @@ void UniverseTracker::RegisterComplete(const string &error) {
 }
 
 
+/*
+ * Samples the server's counters for all universes. Each sample is a single
+ * request, no matter how many universes there are, and no DMX data is sent
+ * to the client.
+ */
+class AllUniverseTracker {
+ public:
+    AllUniverseTracker(OlaClientWrapper *wrapper, unsigned int interval);
+
+    void Run();
+
+ private:
+    typedef std::map<unsigned int, UniverseStats> Sample;
+
+    OlaClientWrapper *m_wrapper;
+    ola::io::StdinHandler m_stdin_handler;
+    ola::Clock m_clock;
+    const unsigned int m_interval;
+    bool m_request_pending;
+    Sample m_last_sample;
+    TimeStamp m_last_sample_time;
+    Sample m_sample;
+    TimeStamp m_sample_time;
+
+    void Input(int c);
+    bool RequestStats();
+    void StatsReceived(const Result &result,
+                       const vector<UniverseStats> &stats);
+    void PrintStats();
+};
+
+
+AllUniverseTracker::AllUniverseTracker(OlaClientWrapper *wrapper,
+                                       unsigned int interval)
+    : m_wrapper(wrapper),
+      m_stdin_handler(wrapper->GetSelectServer(),
+                      ola::NewCallback(this, &AllUniverseTracker::Input)),
+      m_interval(interval),
+      m_request_pending(false) {
+}
+
+
+void AllUniverseTracker::Run() {
+  RequestStats();
+  m_wrapper->GetSelectServer()->RegisterRepeatingTimeout(
+      m_interval * 1000,
+      ola::NewCallback(this, &AllUniverseTracker::RequestStats));
+  m_wrapper->GetSelectServer()->Run();
+}
+
+
+void AllUniverseTracker::Input(int c) {
+  if (c == 'q') {
+    m_wrapper->GetSelectServer()->Terminate();
+  }
+}
+
+
+bool AllUniverseTracker::RequestStats() {
+  // If the server is slow, skip a sample rather than queue requests.
+  if (!m_request_pending) {
+    m_request_pending = true;
+    FetchUniverseStatsArgs args(
+        ola::NewSingleCallback(this, &AllUniverseTracker::StatsReceived));
+    m_wrapper->GetClient()->FetchUniverseStats(args);
+  }
+  return true;
+}
+
+
+void AllUniverseTracker::StatsReceived(const Result &result,
+                                       const vector<UniverseStats> &stats) {
+  m_request_pending = false;
+  if (!result.Success()) {
+    OLA_WARN << result.Error();
+    return;
+  }
+
+  m_last_sample.swap(m_sample);
+  m_last_sample_time = m_sample_time;
+  m_sample.clear();
+  m_clock.CurrentTime(&m_sample_time);
+  vector<UniverseStats>::const_iterator iter = stats.begin();
+  for (; iter != stats.end(); ++iter) {
+    m_sample[iter->universe] = *iter;
+  }
+
+  if (m_last_sample_time.IsSet()) {
+    PrintStats();
+  }
+}
+
+
+/*
+ * Print the rates between the last two samples, for the universes that had
+ * traffic.
+ */
+void AllUniverseTracker::PrintStats() {
+  const double seconds =
+      (m_sample_time - m_last_sample_time).AsInt() / 1000000.0;
+  if (seconds <= 0) {
+    return;
+  }
+
+  cout << setw(8) << "Universe" << setw(10) << "In fps" << setw(10)
+       << "Out fps" << setw(9) << "Sources" << setw(10) << "Priority"
+       << setw(9) << "Changes" << setw(12) << "Jitter ms" << endl;
+  cout << std::fixed << std::setprecision(1);
+
+  unsigned int active = 0;
+  Sample::const_iterator iter = m_sample.begin();
+  for (; iter != m_sample.end(); ++iter) {
+    const UniverseStats &stats = iter->second;
+    UniverseStats last;
+    Sample::const_iterator last_iter = m_last_sample.find(iter->first);
+    // The counters start again if the universe was deleted and re-created.
+    if (last_iter != m_last_sample.end() &&
+        last_iter->second.input_frames <= stats.input_frames &&
+        last_iter->second.output_frames <= stats.output_frames) {
+      last = last_iter->second;
+    }
+
+    const uint64_t inputs = stats.input_frames - last.input_frames;
+    const uint64_t outputs = stats.output_frames - last.output_frames;
+    const uint64_t changes = stats.priority_changes - last.priority_changes;
+    if (!inputs && !outputs && !changes) {
+      continue;
+    }
+    active++;
+
+    cout << setw(8) << iter->first << setw(10) << inputs / seconds
+         << setw(10) << outputs / seconds << setw(9) << stats.active_sources
+         << setw(10) << static_cast<int>(stats.active_priority) << setw(9)
+         << changes << setw(12);
+
+    // The standard deviation of the interval between input frames.
+    const double count = stats.interval_count - last.interval_count;
+    if (count > 1) {
+      const double mean = (stats.interval_sum - last.interval_sum) / count;
+      const double variance =
+          (stats.interval_sum_squares - last.interval_sum_squares) / count -
+          mean * mean;
+      cout << (variance > 0 ? sqrt(variance) : 0) / 1000.0;
+    } else {
+      cout << "-";
+    }
+    cout << endl;
+  }
+  cout << active << " of " << m_sample.size() << " universes active" << endl;
+  cout << "------------------------------" << endl;
+}
+
+
 SelectServer *ss = NULL;
 
 static void InteruptSignal(OLA_UNUSED int signo) {
@@ -253,6 +419,26 @@ int main(int argc, char *argv[]) {
       "[options] <universe1> <universe2> ...",
       "Watch one or more universes and produce stats on DMX frame rates.");
 
+  if (FLAGS_all) {
+    if (argc > 1 || FLAGS_interval == 0) {
+      ola::DisplayUsageAndExit();
+    }
+
+    OlaClientWrapper ola_client;
+    if (!ola_client.Setup()) {
+      OLA_FATAL << "Setup failed";
+      exit(ola::EXIT_UNAVAILABLE);
+    }
+    ss = ola_client.GetSelectServer();
+
+    AllUniverseTracker tracker(&ola_client, FLAGS_interval);
+    ola::InstallSignal(SIGINT, InteruptSignal);
+    cout << "Actions:" << endl;
+    cout << "  q - Quit" << endl;
+    tracker.Run();
+    return ola::EXIT_OK;
+  }
+
   vector<unsigned int> universes;
   for (int i = 1; i < argc; i++) {
     unsigned int universe;
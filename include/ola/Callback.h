@@ -90,6 +90,10 @@
  *   delete callback4;
  *   @endcode
  *
+ * @note Single use callbacks are allocated from a per-thread pool of fixed
+ * size blocks, see CallbackPool.h. Creating one on a hot path doesn't hit
+ * the heap once the pool is warm.
+ *
  * @note The code in Callback.h is autogenerated by gen_callbacks.py. Please
  * edit and run gen_callbacks.py if you need to add more types.
  *
@@ -105,6 +109,9 @@
 #ifndef INCLUDE_OLA_CALLBACK_H_
 #define INCLUDE_OLA_CALLBACK_H_
 
+#include <stddef.h>
+#include <ola/CallbackPool.h>
+
 namespace ola {
 
 /**
@@ -146,6 +153,12 @@ class SingleUseCallback0: public BaseCallback0<ReturnType> {
     delete this;
     return ret;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual ReturnType DoRun() = 0;
 };
@@ -161,6 +174,12 @@ class SingleUseCallback0<void>: public BaseCallback0<void> {
     this->DoRun();
     delete this;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual void DoRun() = 0;
 };
@@ -1009,6 +1028,12 @@ class SingleUseCallback1: public BaseCallback1<ReturnType, Arg0> {
     delete this;
     return ret;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual ReturnType DoRun(Arg0 arg0) = 0;
 };
@@ -1024,6 +1049,12 @@ class SingleUseCallback1<void, Arg0>: public BaseCallback1<void, Arg0> {
     this->DoRun(arg0);
     delete this;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual void DoRun(Arg0 arg0) = 0;
 };
@@ -1912,6 +1943,12 @@ class SingleUseCallback2: public BaseCallback2<ReturnType, Arg0, Arg1> {
     delete this;
     return ret;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual ReturnType DoRun(Arg0 arg0, Arg1 arg1) = 0;
 };
@@ -1927,6 +1964,12 @@ class SingleUseCallback2<void, Arg0, Arg1>: public BaseCallback2<void, Arg0, Arg
     this->DoRun(arg0, arg1);
     delete this;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual void DoRun(Arg0 arg0, Arg1 arg1) = 0;
 };
@@ -2855,6 +2898,12 @@ class SingleUseCallback3: public BaseCallback3<ReturnType, Arg0, Arg1, Arg2> {
     delete this;
     return ret;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual ReturnType DoRun(Arg0 arg0, Arg1 arg1, Arg2 arg2) = 0;
 };
@@ -2870,6 +2919,12 @@ class SingleUseCallback3<void, Arg0, Arg1, Arg2>: public BaseCallback3<void, Arg
     this->DoRun(arg0, arg1, arg2);
     delete this;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual void DoRun(Arg0 arg0, Arg1 arg1, Arg2 arg2) = 0;
 };
@@ -3838,6 +3893,12 @@ class SingleUseCallback4: public BaseCallback4<ReturnType, Arg0, Arg1, Arg2, Arg
     delete this;
     return ret;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual ReturnType DoRun(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) = 0;
 };
@@ -3853,6 +3914,12 @@ class SingleUseCallback4<void, Arg0, Arg1, Arg2, Arg3>: public BaseCallback4<voi
     this->DoRun(arg0, arg1, arg2, arg3);
     delete this;
   }
+  static void *operator new(size_t size) {
+    return ola::AllocateSingleUseCallback(size);
+  }
+  static void operator delete(void *ptr, size_t size) {
+    ola::FreeSingleUseCallback(ptr, size);
+  }
  private:
   virtual void DoRun(Arg0 arg0, Arg1 arg1, Arg2 arg2, Arg3 arg3) = 0;
 };
@@ -0,0 +1,84 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * CallbackPool.h
+ * The allocator used for single use callbacks.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @addtogroup callbacks
+ * @{
+ * @file CallbackPool.h
+ * @brief The allocator used for single use callbacks.
+ *
+ * Single use callbacks are created and destroyed for every RPC and every
+ * call to SelectServer::Execute(). Rather than going to the heap each time,
+ * they're carved from fixed size blocks which are cached per-thread.
+ *
+ * Callbacks larger than SINGLE_USE_CALLBACK_BLOCK_SIZE fall back to the heap.
+ * A callback may be freed on a different thread to the one which created it,
+ * in which case the block ends up in the freeing thread's cache.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_CALLBACKPOOL_H_
+#define INCLUDE_OLA_CALLBACKPOOL_H_
+
+#include <stddef.h>
+
+namespace ola {
+
+/**
+ * @addtogroup callbacks
+ * @{
+ */
+
+/**
+ * @brief The size of the blocks in the pool.
+ *
+ * This is large enough for a method callback with four bound arguments.
+ */
+static const size_t SINGLE_USE_CALLBACK_BLOCK_SIZE = 64;
+
+/**
+ * @brief The maximum number of free blocks each thread holds on to.
+ */
+static const unsigned int MAX_CACHED_CALLBACK_BLOCKS = 256;
+
+/**
+ * @brief Allocate memory for a single use callback.
+ * @param size the size of the callback.
+ * @returns a pointer to at least size bytes.
+ */
+void *AllocateSingleUseCallback(size_t size);
+
+/**
+ * @brief Free memory allocated with AllocateSingleUseCallback().
+ * @param ptr the memory to free.
+ * @param size the size passed to AllocateSingleUseCallback().
+ */
+void FreeSingleUseCallback(void *ptr, size_t size);
+
+/**
+ * @brief The number of free blocks cached by the calling thread.
+ */
+unsigned int CachedCallbackBlocks();
+
+/**
+ * @}
+ */
+}  // namespace ola
+#endif  // INCLUDE_OLA_CALLBACKPOOL_H_
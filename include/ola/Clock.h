@@ -241,6 +241,67 @@ class Clock {
 };
 
 
+/**
+ * @brief A clock that trades precision for speed.
+ *
+ * On Linux this reads CLOCK_REALTIME_COARSE, which is served from the vDSO
+ * without reading the hardware clock. The time is only accurate to the
+ * kernel tick, usually 1 - 4ms, so use it for things like source timeouts,
+ * not for measuring latency. Elsewhere it's the same as Clock.
+ */
+class CoarseClock: public Clock {
+ public:
+  CoarseClock() : Clock() {}
+
+  void CurrentTime(TimeStamp *timestamp) const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CoarseClock);
+};
+
+
+/**
+ * @brief A clock that returns a snapshot of another clock.
+ *
+ * The time only changes when Update() or Set() is called. Code that handles
+ * many events at once, like all the packets read in one iteration of an
+ * event loop, can take the time once and share it.
+ */
+class CachedClock: public Clock {
+ public:
+  /**
+   * @brief Create a new CachedClock.
+   * @param clock the clock to take snapshots of, or NULL to use a
+   *   CoarseClock. Ownership is not transferred.
+   */
+  explicit CachedClock(const Clock *clock = NULL);
+
+  /**
+   * @brief Take a new snapshot of the underlying clock.
+   */
+  void Update();
+
+  /**
+   * @brief Set the snapshot, e.g. to a time the caller already has.
+   */
+  void Set(const TimeStamp &timestamp) { m_now = timestamp; }
+
+  void CurrentTime(TimeStamp *timestamp) const;
+
+  /**
+   * @brief Return the snapshot.
+   */
+  const TimeStamp &Now() const { return m_now; }
+
+ private:
+  CoarseClock m_coarse_clock;
+  const Clock *m_clock;
+  TimeStamp m_now;
+
+  DISALLOW_COPY_AND_ASSIGN(CachedClock);
+};
+
+
 /**
  * A Mock Clock used for testing.
  */
@@ -29,10 +29,13 @@
 #include <stdint.h>
 #include <iostream>
 #include <string>
+#include <vector>
 
 
 namespace ola {
 
+struct DmxFrame;
+
 /**
  * @class DmxBuffer ola/DmxBuffer.h
  * @brief Used to hold a single universe of DMX data.
@@ -44,10 +47,23 @@ namespace ola {
  * @note DmxBuffer uses a copy-on-write (COW) optimization, more info can be
  * found here: http://en.wikipedia.org/wiki/Copy-on-write
  *
+ * @note The data is held in frames from a shared pool, so setting and
+ * releasing buffers doesn't normally touch the heap.
+ *
  * @note This class is <b>NOT</b> thread safe.
  */
 class DmxBuffer {
  public:
+    /**
+     * @brief A range of slots.
+     */
+    struct SlotRange {
+      /** @brief The first slot in the range. */
+      unsigned int offset;
+      /** @brief The number of slots in the range. */
+      unsigned int length;
+    };
+
     /**
      * Constructor
      * This initializes an empty DmxBuffer, Size() == 0
@@ -104,6 +120,38 @@ class DmxBuffer {
      */
     bool operator!=(const DmxBuffer &other) const;
 
+    /**
+     * @brief Find the first slot that differs from another DmxBuffer.
+     * @param other the DmxBuffer to compare against
+     * @param[out] slot the first slot that differs. Slots past the end of the
+     *   shorter buffer count as different.
+     * @return true if the buffers differ, false if they are equal
+     */
+    bool FirstDifference(const DmxBuffer &other, unsigned int *slot) const;
+
+    /**
+     * @brief Find the ranges of slots that differ from another DmxBuffer.
+     * @param other the DmxBuffer to compare against, e.g. the previous frame
+     * @param[out] ranges the ranges of slots in this buffer that differ, in
+     *   order. Slots past the end of other count as different, slots past
+     *   the end of this buffer are ignored. This is cleared first.
+     * @param merge_gap changed slots separated by fewer than this many
+     *   unchanged slots are put in the same range. 0 means ranges are never
+     *   merged.
+     * @return true if any slots differ
+     *
+     * This compares many slots at a time, so it's much cheaper than
+     * comparing slot by slot when only a few slots have changed.
+     */
+    bool Diff(const DmxBuffer &other, std::vector<SlotRange> *ranges,
+              unsigned int merge_gap = 0) const;
+
+    /**
+     * @brief The FNV-1a hash of the slot data.
+     * @return the hash, buffers with equal data have equal hashes
+     */
+    uint32_t Hash() const;
+
     /**
      * @brief Current size of DmxBuffer
      * @return the current number of slots in the buffer.
@@ -117,6 +165,18 @@ class DmxBuffer {
      */
     bool HTPMerge(const DmxBuffer &other);
 
+    /**
+     * @brief HTP Merge from a number of DmxBuffers.
+     *
+     * This produces the same result as calling HTPMerge() for each buffer in
+     * turn, but only checks the copy-on-write state once, which makes it
+     * cheaper when folding many sources into a single buffer.
+     * @param others the DmxBuffers to HTP merge into this one. NULL entries
+     *   are skipped.
+     * @return false if the merge failed, and true if merge was successful
+     */
+    bool HTPMerge(const std::vector<const DmxBuffer*> &others);
+
     /**
      * @brief Set the contents of this DmxBuffer
      * @param data is a pointer to an array of uint8_t values
@@ -190,6 +250,21 @@ class DmxBuffer {
     bool SetRange(unsigned int offset, const uint8_t *data,
                   unsigned int length);
 
+    /**
+     * @brief Set the bits selected by a mask in a range of data.
+     *
+     * Each slot becomes (slot & ~mask) | (data & mask), so a mask byte of 0xff
+     * sets the slot and 0x00 leaves it unchanged. Slots past the current end
+     * of the data start at 0. Otherwise this behaves like SetRange().
+     * @param offset the starting channel
+     * @param data a pointer to the new data
+     * @param mask a pointer to the mask, the same length as the data
+     * @param length the length of the data
+     * @return true if the call successful and false if it failed
+     */
+    bool SetRangeMasked(unsigned int offset, const uint8_t *data,
+                        const uint8_t *mask, unsigned int length);
+
     /**
      * @brief Set a single channel.
      * Calling this on an uninitialized buffer will call Blackout() first.
@@ -264,12 +339,19 @@ class DmxBuffer {
      */
     std::string ToString() const;
 
+    /**
+     * @brief The memory held by the pool of frames that all DmxBuffers share.
+     * @return the size of the pool in bytes, including frames that are free.
+     */
+    static size_t PoolMemoryUsage();
+
  private:
     bool Init();
     bool DuplicateIfNeeded();
+    void MergeFrom(const DmxBuffer &other);
     void CopyFromOther(const DmxBuffer &other);
     void CleanupMemory();
-    unsigned int *m_ref_count;
+    DmxFrame *m_frame;
     mutable bool m_copy_on_write;
     uint8_t *m_data;
     unsigned int m_length;
@@ -24,7 +24,8 @@
  *
  * Exported variables can be used to expose the internal state on the /debug
  * page of the webserver. This allows real time debugging and monitoring of the
- * applications.
+ * applications. The same variables are served in the OpenMetrics text format
+ * on the /metrics page, for use by monitoring systems.
  */
 
 #ifndef INCLUDE_OLA_EXPORTMAP_H_
@@ -32,10 +33,12 @@
 
 #include <ola/base/Macro.h>
 #include <ola/StringUtils.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <functional>
 #include <map>
+#include <ostream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -73,6 +76,41 @@ class BaseVariable {
    */
   virtual const std::string Value() const = 0;
 
+  /**
+   * @brief Write the variable in the OpenMetrics text format.
+   * @param output the stream to write to.
+   *
+   * Variables which don't have a numeric value write nothing.
+   */
+  virtual void WriteMetrics(std::ostream *output) const {
+    (void) output;
+  }
+
+ protected:
+  /**
+   * @brief Convert a variable or label name to a valid metric name.
+   * @param name the name to convert.
+   * @returns the name with any invalid characters replaced with '_'.
+   */
+  static std::string MetricName(const std::string &name);
+
+  /**
+   * @brief Escape a string for use as an OpenMetrics label value.
+   * @param value the string to escape.
+   * @returns the escaped string.
+   */
+  static std::string MetricLabelValue(const std::string &value);
+
+  /**
+   * @brief Write a single metric family with one unlabelled sample.
+   * @param output the stream to write to.
+   * @param type the metric type, e.g. gauge.
+   * @param suffix the suffix for the sample name, e.g. _total.
+   * @param value the sample value.
+   */
+  void WriteSingleMetric(std::ostream *output, const char *type,
+                         const char *suffix, const std::string &value) const;
+
  private:
   std::string m_name;
 };
@@ -120,6 +158,10 @@ class BoolVariable: public BaseVariable {
    */
   const std::string Value() const { return m_value ? "1" : "0"; }
 
+  void WriteMetrics(std::ostream *output) const {
+    WriteSingleMetric(output, "gauge", "", Value());
+  }
+
  private:
   bool m_value;
 };
@@ -145,7 +187,12 @@ class StringVariable: public BaseVariable {
 
 
 /*
- * Represents a integer variable
+ * Represents a integer variable.
+ *
+ * Updates are relaxed atomic operations, so the variable can be updated from
+ * any thread without a lock. Resolve the variable once with
+ * ExportMap::GetIntegerVar() and keep the pointer, rather than looking it up
+ * on each update.
  */
 class IntegerVariable: public BaseVariable {
  public:
@@ -154,15 +201,17 @@ class IntegerVariable: public BaseVariable {
         m_value(0) {}
   ~IntegerVariable() {}
 
-  void Set(int value) { m_value = value; }
-  void operator++(int) { m_value++; }
-  void operator--(int) { m_value--; }
-  void Reset() { m_value = 0; }
-  int Get() const { return m_value; }
+  void Set(int value) { __atomic_store_n(&m_value, value, __ATOMIC_RELAXED); }
+  void operator++(int) { __atomic_fetch_add(&m_value, 1, __ATOMIC_RELAXED); }
+  void operator--(int) { __atomic_fetch_sub(&m_value, 1, __ATOMIC_RELAXED); }
+  void Reset() { Set(0); }
+  int Get() const { return __atomic_load_n(&m_value, __ATOMIC_RELAXED); }
   const std::string Value() const {
-    std::ostringstream out;
-    out << m_value;
-    return out.str();
+    return ola::strings::IntToString(Get());
+  }
+
+  void WriteMetrics(std::ostream *output) const {
+    WriteSingleMetric(output, "gauge", "", Value());
   }
 
  private:
@@ -172,6 +221,8 @@ class IntegerVariable: public BaseVariable {
 
 /*
  * Represents a counter which can only be added to.
+ *
+ * Like IntegerVariable, updates are relaxed atomic operations.
  */
 class CounterVariable: public BaseVariable {
  public:
@@ -180,14 +231,20 @@ class CounterVariable: public BaseVariable {
         m_value(0) {}
   ~CounterVariable() {}
 
-  void operator++(int) { m_value++; }
-  void operator+=(unsigned int value) { m_value += value; }
-  void Reset() { m_value = 0; }
-  unsigned int Get() const { return m_value; }
+  void operator++(int) { __atomic_fetch_add(&m_value, 1, __ATOMIC_RELAXED); }
+  void operator+=(unsigned int value) {
+    __atomic_fetch_add(&m_value, value, __ATOMIC_RELAXED);
+  }
+  void Reset() { __atomic_store_n(&m_value, 0, __ATOMIC_RELAXED); }
+  unsigned int Get() const {
+    return __atomic_load_n(&m_value, __ATOMIC_RELAXED);
+  }
   const std::string Value() const {
-    std::ostringstream out;
-    out << m_value;
-    return out.str();
+    return ola::strings::IntToString(Get());
+  }
+
+  void WriteMetrics(std::ostream *output) const {
+    WriteSingleMetric(output, "counter", "_total", Value());
   }
 
  private:
@@ -195,6 +252,141 @@ class CounterVariable: public BaseVariable {
 };
 
 
+/**
+ * @class HistogramVariable <ola/ExportMap.h>
+ * @brief A distribution of values, counted in fixed buckets.
+ *
+ * Each bucket has an inclusive upper bound, and there is a final bucket for
+ * values larger than all of the bounds. Like CounterVariable, updates are
+ * relaxed atomic operations.
+ */
+class HistogramVariable: public BaseVariable {
+ public:
+  /**
+   * @brief Create a new HistogramVariable.
+   * @param name the variable name.
+   * @param bounds the upper bounds of the buckets.
+   */
+  HistogramVariable(const std::string &name,
+                    const std::vector<uint64_t> &bounds);
+  ~HistogramVariable() {}
+
+  /**
+   * @brief Record a value.
+   * @param value the value to record.
+   */
+  void Observe(uint64_t value);
+
+  /**
+   * @brief Clear all recorded values.
+   */
+  void Reset();
+
+  /**
+   * @brief The number of values recorded.
+   */
+  uint64_t Count() const;
+
+  /**
+   * @brief The sum of the values recorded.
+   */
+  uint64_t Sum() const;
+
+  /**
+   * @brief The upper bounds of the buckets, in ascending order.
+   */
+  const std::vector<uint64_t> &Bounds() const { return m_bounds; }
+
+  /**
+   * @brief The number of values recorded in a bucket.
+   * @param bucket the index of the bucket. Bounds().size() is the bucket for
+   *   values larger than all the bounds.
+   * @returns the number of values in the bucket, this is not cumulative.
+   */
+  uint64_t BucketCount(unsigned int bucket) const;
+
+  /**
+   * @brief The value as a string.
+   *
+   * The form is: count:N sum:S le_B1:C1 le_B2:C2 ... le_inf:N, where the
+   * bucket counts are cumulative.
+   */
+  const std::string Value() const;
+
+  void WriteMetrics(std::ostream *output) const;
+
+  /**
+   * @brief Write the samples for this histogram, without the TYPE line.
+   * @param output the stream to write to.
+   * @param name the metric name to use.
+   * @param labels any labels to add to each sample, each followed by a
+   *   comma, e.g. universe="1",
+   */
+  void WriteSamples(std::ostream *output, const std::string &name,
+                    const std::string &labels) const;
+
+ private:
+  std::vector<uint64_t> m_bounds;
+  std::vector<uint64_t> m_buckets;
+  uint64_t m_count;
+  uint64_t m_sum;
+};
+
+
+/**
+ * @class HistogramMap <ola/ExportMap.h>
+ * @brief A map of string keys to HistogramVariables which share bounds.
+ */
+class HistogramMap: public BaseVariable {
+ public:
+  HistogramMap(const std::string &name, const std::string &label,
+               const std::vector<uint64_t> &bounds)
+      : BaseVariable(name),
+        m_label(label),
+        m_bounds(bounds) {}
+  ~HistogramMap();
+
+  /**
+   * @brief Lookup or create the histogram for a key.
+   * @param key the key to lookup.
+   * @returns the HistogramVariable, which is valid until the key is removed.
+   */
+  HistogramVariable *Get(const std::string &key);
+
+  /**
+   * @brief Remove, and delete, the histogram for a key.
+   * @param key the key to remove.
+   */
+  void Remove(const std::string &key);
+
+  /**
+   * @brief Get the keys in the map.
+   * @param[out] keys the keys, in sorted order.
+   */
+  void Keys(std::vector<std::string> *keys) const;
+
+  /**
+   * @brief Lookup the histogram for a key.
+   * @param key the key to lookup.
+   * @returns the HistogramVariable, or NULL if there isn't one.
+   */
+  const HistogramVariable *Find(const std::string &key) const;
+
+  const std::string Value() const;
+  const std::string Label() const { return m_label; }
+  void WriteMetrics(std::ostream *output) const;
+
+ private:
+  typedef std::map<std::string, HistogramVariable*> HistogramVariables;
+
+  HistogramVariables m_variables;
+  std::string m_label;
+  std::vector<uint64_t> m_bounds;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramMap);
+};
+
+
 /*
  * A Map variable holds string -> type mappings
  */
@@ -211,6 +403,7 @@ class MapVariable: public BaseVariable {
   Type &operator[](const std::string &key);
   const std::string Value() const;
   const std::string Label() const { return m_label; }
+  void WriteMetrics(std::ostream *output) const;
 
  protected:
   std::map<std::string, Type> m_variables;
@@ -298,6 +491,29 @@ inline const std::string MapVariable<Type>::Value() const {
 }
 
 
+/*
+ * Write the map as a gauge, with one sample per key.
+ */
+template<typename Type>
+inline void MapVariable<Type>::WriteMetrics(std::ostream *output) const {
+  const std::string name = MetricName(Name());
+  const std::string label = m_label.empty() ? "key" : MetricName(m_label);
+  *output << "# TYPE " << name << " gauge\n";
+  typename std::map<std::string, Type>::const_iterator iter;
+  for (iter = m_variables.begin(); iter != m_variables.end(); ++iter) {
+    *output << name << "{" << label << "=\"" << MetricLabelValue(iter->first)
+            << "\"} " << iter->second << "\n";
+  }
+}
+
+
+/*
+ * String maps have no numeric value.
+ */
+template<>
+inline void MapVariable<std::string>::WriteMetrics(std::ostream*) const {}
+
+
 /*
  * Strings need to be quoted
  */
@@ -372,6 +588,40 @@ class ExportMap {
   UIntMap *GetUIntMapVar(const std::string &name,
                          const std::string &label = "");
 
+  /**
+   * @brief Lookup or create a HistogramVariable.
+   * @param name the name of this variable.
+   * @param bounds the upper bounds of the buckets, this is ignored if the
+   *   variable already exists.
+   * @return a HistogramVariable.
+   *
+   * The variable is created if it doesn't already exist. The pointer is
+   * valid for the lifetime of the ExportMap.
+   */
+  HistogramVariable *GetHistogramVar(const std::string &name,
+                                     const std::vector<uint64_t> &bounds);
+
+  /**
+   * @brief Lookup or create a HistogramMap.
+   * @param name the name of this variable.
+   * @param label the label to use for the map keys.
+   * @param bounds the upper bounds of the buckets, this is ignored if the
+   *   variable already exists.
+   * @return a HistogramMap.
+   *
+   * The variable is created if it doesn't already exist. The pointer is
+   * valid for the lifetime of the ExportMap.
+   */
+  HistogramMap *GetHistogramMapVar(const std::string &name,
+                                   const std::string &label,
+                                   const std::vector<uint64_t> &bounds);
+
+  /**
+   * @brief Write all numeric variables in the OpenMetrics text format.
+   * @param output the stream to write to.
+   */
+  void WriteMetrics(std::ostream *output) const;
+
   /**
    * @brief Fetch a list of all known variables.
    * @returns a vector of all variables.
@@ -396,6 +646,8 @@ class ExportMap {
   std::map<std::string, StringMap*> m_str_map_variables;
   std::map<std::string, IntMap*> m_int_map_variables;
   std::map<std::string, UIntMap*> m_uint_map_variables;
+  std::map<std::string, HistogramVariable*> m_histogram_variables;
+  std::map<std::string, HistogramMap*> m_histogram_map_variables;
 
   DISALLOW_COPY_AND_ASSIGN(ExportMap);
 };
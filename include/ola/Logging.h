@@ -44,10 +44,32 @@
 #ifndef INCLUDE_OLA_LOGGING_H_
 #define INCLUDE_OLA_LOGGING_H_
 
+#include <stdint.h>
+#include <ola/base/Macro.h>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <sstream>
 
+/**
+ * @brief The most verbose level that's compiled in.
+ *
+ * Messages above this level are removed at compile time, regardless of the
+ * level set at runtime. This is a number rather than a log_level since it's
+ * usually set from the build, e.g. CPPFLAGS=-DOLA_LOG_COMPILE_LEVEL=2 only
+ * keeps the FATAL and WARN messages.
+ */
+#ifndef OLA_LOG_COMPILE_LEVEL
+#define OLA_LOG_COMPILE_LEVEL 4
+#endif  // OLA_LOG_COMPILE_LEVEL
+
+/**
+ * @brief True if messages at the specified level should be logged.
+ * @param level the log_level to check.
+ */
+#define OLA_LOG_ENABLED(level) \
+    ((level) <= OLA_LOG_COMPILE_LEVEL && (level) <= ola::LogLevel())
+
 /**
  * @brief Provide a stream interface to log a message at the specified log
  * level.
@@ -56,8 +78,33 @@
  * OLA_INFO or OLA_DEBUG macros.
  * @param level the log_level to log at.
  */
-#define OLA_LOG(level) (level <= ola::LogLevel()) && \
+#define OLA_LOG(level) OLA_LOG_ENABLED(level) && \
                         ola::LogLine(__FILE__, __LINE__, level).stream()
+
+/**
+ * @brief Provide a stream interface to log a message at the specified level,
+ * at most max_per_second times a second from this call site.
+ *
+ * Messages over the limit are dropped, and the number dropped is appended to
+ * the next message that's logged from the call site.
+ *
+ * This expands to more than one statement, so it can't be used as the body of
+ * an if or loop without braces. Rather than calling this directly use one of
+ * the OLA_WARN_RATE_LIMITED, OLA_INFO_RATE_LIMITED or OLA_DEBUG_RATE_LIMITED
+ * macros.
+ * @param level the log_level to log at.
+ * @param max_per_second the maximum number of messages per second.
+ */
+#define OLA_LOG_RATE_LIMITED(level, max_per_second) \
+    static ola::LogRateLimiter OLA_LOG_LIMITER(__LINE__)(max_per_second); \
+    OLA_LOG_ENABLED(level) && OLA_LOG_LIMITER(__LINE__).Allow() && \
+    ola::LogLine(__FILE__, __LINE__, level, \
+                 OLA_LOG_LIMITER(__LINE__).TakeSuppressed()).stream()
+
+/**@cond HIDDEN_SYMBOLS*/
+#define OLA_LOG_LIMITER(line) OLA_LOG_LIMITER_NAME(line)
+#define OLA_LOG_LIMITER_NAME(line) ola_log_rate_limiter_##line
+/**@endcond*/
 /**
  * Provide a stream to log a fatal message. e.g.
  * @code
@@ -90,6 +137,30 @@
  */
 #define OLA_DEBUG OLA_LOG(ola::OLA_LOG_DEBUG)
 
+/**
+ * Provide a stream to log a warning message, at most max_per_second times a
+ * second. e.g.
+ * @code
+ *     OLA_WARN_RATE_LIMITED(10) << "Bad packet from " << source;
+ * @endcode
+ */
+#define OLA_WARN_RATE_LIMITED(max_per_second) \
+    OLA_LOG_RATE_LIMITED(ola::OLA_LOG_WARN, max_per_second)
+
+/**
+ * Provide a stream to log an infomational message, at most max_per_second
+ * times a second.
+ */
+#define OLA_INFO_RATE_LIMITED(max_per_second) \
+    OLA_LOG_RATE_LIMITED(ola::OLA_LOG_INFO, max_per_second)
+
+/**
+ * Provide a stream to log a debug message, at most max_per_second times a
+ * second.
+ */
+#define OLA_DEBUG_RATE_LIMITED(max_per_second) \
+    OLA_LOG_RATE_LIMITED(ola::OLA_LOG_DEBUG, max_per_second)
+
 namespace ola {
 
 /**
@@ -138,6 +209,13 @@ class LogDestination {
    * destination
    */
   virtual void Write(log_level level, const std::string &log_line) = 0;
+
+  /**
+   * @brief Write out any buffered messages.
+   *
+   * Destinations that write straight away don't need to override this.
+   */
+  virtual void Flush() {}
 };
 
 /**
@@ -210,16 +288,118 @@ class UnixSyslogDestination : public SyslogDestination {
 };
 #endif  // _WIN32
 
+/**
+ * @brief A LogDestination that hands messages to a background thread, which
+ * writes them to another LogDestination.
+ *
+ * Write() copies the message into a fixed size, lock free ring and returns
+ * straight away, so the calling thread never waits on stderr or syslog. If
+ * the ring is full the message is dropped, and the number dropped is logged
+ * once there's space again. Lines longer than MAX_LINE_LENGTH are truncated.
+ *
+ * Fatal messages are written synchronously, after everything already queued,
+ * since the program may be about to exit.
+ */
+class AsyncLogDestination: public LogDestination {
+ public:
+  /**
+   * @brief Create a new AsyncLogDestination.
+   * @param destination the LogDestination to write to, ownership is
+   *   transferred.
+   * @param capacity the number of messages that can be queued, this is
+   *   rounded up to a power of two.
+   */
+  explicit AsyncLogDestination(LogDestination *destination,
+                               unsigned int capacity = DEFAULT_CAPACITY);
+
+  /**
+   * @brief Destructor, this writes out the queued messages and stops the
+   * background thread.
+   */
+  ~AsyncLogDestination();
+
+  /**
+   * @brief Queue a message, this may be called from any thread.
+   */
+  void Write(log_level level, const std::string &log_line);
+
+  /**
+   * @brief Write out the queued messages from the calling thread.
+   */
+  void Flush();
+
+  /**
+   * @brief The total number of messages dropped because the ring was full.
+   */
+  uint64_t Dropped() const;
+
+  static const unsigned int DEFAULT_CAPACITY = 1024;
+  static const unsigned int MAX_LINE_LENGTH = 1024;
+
+ private:
+  class WriterThread;
+  struct Entry;
+
+  std::auto_ptr<LogDestination> m_destination;
+  Entry *m_entries;
+  const uint32_t m_mask;
+  uint32_t m_enqueue_position;
+  // Only used by the thread that holds the writer lock.
+  uint32_t m_dequeue_position;
+  uint32_t m_pending_drops;
+  uint64_t m_dropped;
+  WriterThread *m_thread;
+
+  void Drain();
+  static uint32_t Capacity(unsigned int capacity);
+
+  friend class WriterThread;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogDestination);
+};
+
 /**@}*/
 
 /**
  * @cond HIDDEN_SYMBOLS
+ * @class LogRateLimiter
+ * @brief Limits the number of messages logged from a call site, see
+ * OLA_LOG_RATE_LIMITED.
+ */
+class LogRateLimiter {
+ public:
+  explicit LogRateLimiter(unsigned int max_per_second);
+
+  /**
+   * @brief Returns true if a message can be logged, or false if the limit
+   * was reached, in which case the message is counted as suppressed.
+   */
+  bool Allow();
+
+  /**
+   * @brief Return the number of messages suppressed since the last call, and
+   * reset the count.
+   */
+  unsigned int TakeSuppressed();
+
+ private:
+  const unsigned int m_max_per_second;
+  int64_t m_window;
+  unsigned int m_count;
+  unsigned int m_suppressed;
+
+  DISALLOW_COPY_AND_ASSIGN(LogRateLimiter);
+};
+
+/**
  * @class LogLine
  * @brief A LogLine, this represents a single log message.
  */
 class LogLine {
  public:
   LogLine(const char *file, int line, log_level level);
+  LogLine(const char *file, int line, log_level level,
+          unsigned int suppressed);
   ~LogLine();
   void Write();
 
@@ -228,6 +408,7 @@ class LogLine {
   log_level m_level;
   std::ostringstream m_stream;
   unsigned int m_prefix_length;
+  unsigned int m_suppressed;
 };
 /**@endcond*/
 
@@ -274,6 +455,11 @@ bool InitLogging(log_level level, log_output output);
  * @param destination the LogDestination to use.
  */
 void InitLogging(log_level level, LogDestination *destination);
+
+/**
+ * @brief Write out any messages buffered by the LogDestination.
+ */
+void FlushLogs();
 /***/
 }  // namespace ola
 /**@}*/
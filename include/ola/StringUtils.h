@@ -68,6 +68,50 @@ inline void StringSplit(
   StringSplit(input, &tokens, delimiters);
 }
 
+/**
+ * @brief Split a string into pieces without copying them.
+ *
+ * Like StringSplit(), if two delimiters appear next to each other an empty
+ * token is returned. The tokens point into the input, which must outlive the
+ * StringTokenizer.
+ *
+ * @code
+ * StringTokenizer tokenizer(input, ',');
+ * const char *begin, *end;
+ * while (tokenizer.Next(&begin, &end)) {
+ *   ...
+ * }
+ * @endcode
+ */
+class StringTokenizer {
+ public:
+  /**
+   * @brief Create a new StringTokenizer.
+   * @param input the string to split
+   * @param delimiter the delimiter to split on
+   */
+  StringTokenizer(const std::string &input, char delimiter)
+      : m_position(input.data()),
+        m_end(input.data() + input.size()),
+        m_delimiter(delimiter),
+        m_done(false) {
+  }
+
+  /**
+   * @brief Get the next token.
+   * @param[out] begin set to the first character of the token
+   * @param[out] end set to one past the last character of the token
+   * @returns false once all the tokens have been returned.
+   */
+  bool Next(const char **begin, const char **end);
+
+ private:
+  const char *m_position;
+  const char *m_end;
+  const char m_delimiter;
+  bool m_done;
+};
+
 /**
  * @brief Trim leading and trailing whitespace from a string
  * @param input the string to trim.
@@ -295,6 +339,22 @@ bool StringToInt(const std::string &value,
                  uint8_t *output,
                  bool strict = false);
 
+/**
+ * @brief Parse an unsigned decimal integer from the start of a range.
+ *
+ * Unlike StringToInt(), this doesn't allocate, skip leading whitespace or
+ * accept a sign.
+ * @param[in] begin the first character to parse
+ * @param[in] end one past the last character that can be parsed
+ * @param[out] output a pointer where the value will be stored.
+ * @returns a pointer to the first character that wasn't part of the number.
+ * This is begin if the range doesn't start with a digit, or the value is too
+ * large for an unsigned int, in which case output isn't changed.
+ */
+const char *ParseUnsigned(const char *begin,
+                          const char *end,
+                          unsigned int *output);
+
 /**
  * @brief Convert a string to a int.
  * @param[in] value the string to convert
@@ -98,6 +98,30 @@ typedef BaseCallback1<void, const Result&> GeneralSetCallback;
 typedef SingleUseCallback2<void, const Result&, const std::vector<OlaUniverse>&>
     UniverseListCallback;
 
+/**
+ * @brief Invoked when OlaClient::FetchUniverseChanges() completes.
+ * @param result the Result of the API call.
+ * @param universes the universes that were created or changed.
+ * @param removed the ids of the universes that were removed.
+ * @param generation the universe generation to pass to the next call.
+ */
+typedef SingleUseCallback4<void, const Result&,
+                           const std::vector<OlaUniverse>&,
+                           const std::vector<unsigned int>&,
+                           uint64_t> UniverseChangesCallback;
+
+/**
+ * @brief Invoked when OlaClient::FetchDeviceChanges() completes.
+ * @param result the Result of the API call.
+ * @param devices the devices that were registered or changed.
+ * @param removed the aliases of the devices that were removed.
+ * @param generation the device generation to pass to the next call.
+ */
+typedef SingleUseCallback4<void, const Result&,
+                           const std::vector<OlaDevice>&,
+                           const std::vector<unsigned int>&,
+                           uint64_t> DeviceChangesCallback;
+
 /**
  * @brief Invoked when OlaClient::FetchUniverseInfo() completes.
  * @param result the Result of the API call.
@@ -133,6 +157,25 @@ typedef SingleUseCallback2<void, const Result&, const ola::rdm::UIDSet&>
 typedef SingleUseCallback3<void, const Result&, const DMXMetadata&,
                            const DmxBuffer&> DMXCallback;
 
+/**
+ * @brief Called once when OlaClient::FetchDMXBatch() completes.
+ * @param result the Result of the API call.
+ * @param frames the DMXFrames, in universe order.
+ * @param generation the server's generation, pass this as since_generation
+ *   in the next call to only fetch the universes that have changed.
+ */
+typedef SingleUseCallback3<void, const Result&, const std::vector<DMXFrame>&,
+                           uint64_t> DMXBatchCallback;
+
+/**
+ * @brief Called once when OlaClient::FetchUniverseStats() completes.
+ * @param result the Result of the API call.
+ * @param stats the UniverseStats, in universe order.
+ */
+typedef SingleUseCallback2<void, const Result&,
+                           const std::vector<UniverseStats>&>
+    UniverseStatsCallback;
+
 /**
  * @brief Called when new DMX data arrives.
  * @param metadata the DMXMetadata associated with the frame.
@@ -141,6 +184,15 @@ typedef SingleUseCallback3<void, const Result&, const DMXMetadata&,
 typedef Callback2<void, const DMXMetadata&, const DmxBuffer&>
     RepeatableDMXCallback;
 
+/**
+ * @brief Called when new DMX data arrives, with a view of the received data
+ * rather than a copy.
+ * @param metadata the DMXMetadata associated with the frame.
+ * @param view the DMXView of the slots, only valid until the callback returns.
+ */
+typedef Callback2<void, const DMXMetadata&, const DMXView&>
+    RepeatableDMXViewCallback;
+
 /**
  * @brief Called when a RDM request completes.
  * Used with OlaClient::RDMGet() and OlaClient::RDMSet().
@@ -153,6 +205,33 @@ typedef SingleUseCallback3<void, const Result&,
                            const RDMMetadata&,
                            const ola::rdm::RDMResponse*> RDMCallback;
 
+/**
+ * @brief Called when the response to a polled item changes.
+ * @param result the new RDMPollResult.
+ * @sa OlaClient::RegisterForRDMPoll().
+ */
+typedef Callback1<void, const RDMPollResult&> RepeatableRDMPollCallback;
+
+/**
+ * @brief Called as each request in a batch of RDM requests completes.
+ * Used with OlaClient::SendRDMBatch(). The callback is run once for each
+ * request, and is deleted after the last one.
+ * @param index the index of the request in SendRDMBatchArgs::requests.
+ * @param result the Result of the API call.
+ * @param metadata the metadata for the response, including the
+ * rdm_response_code.
+ * @param response the RDM Response, or NULL if no response was received.
+ */
+typedef Callback4<void, unsigned int, const Result&, const RDMMetadata&,
+                  const ola::rdm::RDMResponse*> RDMBatchCallback;
+
+/**
+ * @brief Called when universes or devices change on the server.
+ * @param changes the InfoChanges.
+ * @sa OlaClient::RegisterForInfoUpdates().
+ */
+typedef Callback1<void, const InfoChanges&> RepeatableInfoChangesCallback;
+
 
 }  // namespace client
 }  // namespace ola
@@ -22,8 +22,12 @@
 #define INCLUDE_OLA_CLIENT_CLIENTARGS_H_
 
 #include <ola/client/CallbackTypes.h>
+#include <ola/client/ClientTypes.h>
 #include <ola/dmx/SourcePriorities.h>
 
+#include <string>
+#include <vector>
+
 /**
  * @file
  * @brief Types used as arguments for the OLA Client.
@@ -65,6 +69,64 @@ enum DiscoveryType {
   DISCOVERY_FULL,  /**< Trigger full discovery */
 };
 
+/**
+ * @brief A change to a port's patching, used with OlaClient::PatchPorts().
+ */
+struct PortPatch {
+  unsigned int device_alias;  /**< The device containing the port */
+  unsigned int port;  /**< The port id */
+  PortDirection direction;  /**< The direction of the port */
+  PatchAction action;  /**< Patch or unpatch the port */
+  unsigned int universe;  /**< The universe to patch to */
+
+  PortPatch(unsigned int device_alias, unsigned int port,
+            PortDirection direction, PatchAction action,
+            unsigned int universe)
+      : device_alias(device_alias),
+        port(port),
+        direction(direction),
+        action(action),
+        universe(universe) {
+  }
+};
+
+/**
+ * @brief The settings for a universe, used with
+ * OlaClient::ConfigureUniverses().
+ *
+ * Only the settings that have been set are changed.
+ */
+struct UniverseConfig {
+  unsigned int universe;  /**< The universe id */
+  bool has_name;  /**< True if the name should be changed */
+  std::string name;  /**< The new name */
+  bool has_merge_mode;  /**< True if the merge mode should be changed */
+  OlaUniverse::merge_mode merge_mode;  /**< The new merge mode */
+
+  explicit UniverseConfig(unsigned int universe)
+      : universe(universe),
+        has_name(false),
+        has_merge_mode(false),
+        merge_mode(OlaUniverse::MERGE_LTP) {
+  }
+
+  /**
+   * @brief Set the new name of the universe.
+   */
+  void SetName(const std::string &new_name) {
+    has_name = true;
+    name = new_name;
+  }
+
+  /**
+   * @brief Set the new merge mode of the universe.
+   */
+  void SetMergeMode(OlaUniverse::merge_mode mode) {
+    has_merge_mode = true;
+    merge_mode = mode;
+  }
+};
+
 /**
  * @brief Arguments passed to the SendDMX() method.
  */
@@ -96,6 +158,206 @@ struct SendDMXArgs {
   }
 };
 
+/**
+ * @brief The timing of a fade started with FadeDMX().
+ */
+enum FadeCurve {
+  FADE_LINEAR,  /**< Constant rate of change */
+  FADE_EASE_IN_OUT,  /**< Slow at the start and end */
+  FADE_SQUARE,  /**< Slow at the start, fast at the end */
+};
+
+/**
+ * @brief Arguments passed to the FadeDMX() method.
+ */
+struct FadeDMXArgs {
+  /**
+   * @brief The slot the target data starts at, defaults to 0.
+   */
+  unsigned int start_slot;
+  /**
+   * @brief The timing of the fade, defaults to FADE_LINEAR.
+   */
+  FadeCurve curve;
+  /**
+   * @brief The priority of the data, defaults to
+   * ola::dmx::PRIORITY_DEFAULT.
+   */
+  uint8_t priority;
+  /**
+   * @brief the Callback to run upon completion. Defaults to NULL.
+   */
+  SetCallback *callback;
+
+  /**
+   * @brief Create a new FadeDMXArgs object
+   */
+  FadeDMXArgs()
+      : start_slot(0),
+        curve(FADE_LINEAR),
+        priority(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+        callback(NULL) {
+  }
+
+  /**
+   * @brief Create a new FadeDMXArgs object
+   */
+  explicit FadeDMXArgs(SetCallback *_callback)
+      : start_slot(0),
+        curve(FADE_LINEAR),
+        priority(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+        callback(_callback) {
+  }
+};
+
+/**
+ * @brief Arguments passed to the RegisterUniverse() method.
+ *
+ * These limit the DMX data sent for the universe, which saves bandwidth and
+ * CPU for clients that only monitor a universe.
+ */
+struct RegisterArgs {
+  /**
+   * @brief the Callback to run upon completion.
+   */
+  SetCallback *callback;
+
+  /**
+   * @brief The maximum number of frames per second to receive. Defaults to 0,
+   * which is unlimited.
+   *
+   * Frames that arrive too soon after the last one aren't sent.
+   */
+  unsigned int max_fps;
+
+  /**
+   * @brief Only receive frames if the slots have changed. Defaults to false.
+   */
+  bool only_on_change;
+
+  /**
+   * @brief The first slot to receive. Defaults to 0.
+   *
+   * The frames passed to the DMX callback start from this slot.
+   */
+  unsigned int start_slot;
+
+  /**
+   * @brief The number of slots to receive. Defaults to 0, which is all slots
+   * from start_slot.
+   */
+  unsigned int slot_count;
+
+  explicit RegisterArgs(SetCallback *_callback)
+      : callback(_callback),
+        max_fps(0),
+        only_on_change(false),
+        start_slot(0),
+        slot_count(0) {
+  }
+};
+
+/**
+ * @brief Arguments passed to the RegisterForRDMPoll() method.
+ */
+struct RDMPollArgs {
+  /**
+   * @brief the Callback to run upon completion.
+   */
+  SetCallback *callback;
+
+  /**
+   * @brief The time between the start of each poll cycle, in milliseconds.
+   * Defaults to 0, the server raises this to its minimum interval.
+   *
+   * If other clients poll the universe more often, the items are polled at
+   * their interval instead.
+   */
+  unsigned int interval_ms;
+
+  /**
+   * @brief The items to poll from each responder.
+   */
+  std::vector<RDMPollItem> items;
+
+  explicit RDMPollArgs(SetCallback *_callback)
+      : callback(_callback),
+        interval_ms(0) {
+  }
+};
+
+/**
+ * @brief Arguments passed to the FetchDMXBatch() method.
+ *
+ * The universes can be listed, given as a range, or both. If neither is given
+ * all universes are fetched. Universes that don't exist are skipped.
+ */
+struct FetchDMXBatchArgs {
+  /**
+   * @brief the Callback to run upon completion.
+   */
+  DMXBatchCallback *callback;
+
+  /**
+   * @brief The universes to fetch.
+   */
+  std::vector<unsigned int> universes;
+
+  /**
+   * @brief Set to true to fetch the universes from first_universe to
+   * last_universe inclusive. Defaults to false.
+   */
+  bool use_range;
+  unsigned int first_universe;
+  unsigned int last_universe;
+
+  /**
+   * @brief Only fetch universes that have changed since this generation.
+   * Defaults to 0, which fetches all of them.
+   */
+  uint64_t since_generation;
+
+  explicit FetchDMXBatchArgs(DMXBatchCallback *_callback)
+      : callback(_callback),
+        use_range(false),
+        first_universe(0),
+        last_universe(0),
+        since_generation(0) {
+  }
+};
+
+/**
+ * @brief Arguments passed to the FetchUniverseStats() method.
+ *
+ * The universes are chosen in the same way as FetchDMXBatchArgs.
+ */
+struct FetchUniverseStatsArgs {
+  /**
+   * @brief the Callback to run upon completion.
+   */
+  UniverseStatsCallback *callback;
+
+  /**
+   * @brief The universes to fetch.
+   */
+  std::vector<unsigned int> universes;
+
+  /**
+   * @brief Set to true to fetch the universes from first_universe to
+   * last_universe inclusive. Defaults to false.
+   */
+  bool use_range;
+  unsigned int first_universe;
+  unsigned int last_universe;
+
+  explicit FetchUniverseStatsArgs(UniverseStatsCallback *_callback)
+      : callback(_callback),
+        use_range(false),
+        first_universe(0),
+        last_universe(0) {
+  }
+};
+
 /**
  * @brief Arguments used with OlaClient::RDMGet() and OlaClient::RDMSet()
  * methods.
@@ -116,6 +378,33 @@ struct SendRDMArgs {
       include_raw_frames(false) {
   }
 };
+
+/**
+ * @brief Arguments used with OlaClient::SendRDMBatch().
+ */
+struct SendRDMBatchArgs {
+  /**
+   * @brief The callback to run as each request completes. This is deleted
+   * once all the requests have completed.
+   */
+  RDMBatchCallback *callback;
+
+  /**
+   * @brief The requests to send.
+   */
+  std::vector<RDMBatchItem> requests;
+
+  /**
+   * @brief Set to true to include frame & timing information in the
+   * responses.
+   */
+  bool include_raw_frames;
+
+  explicit SendRDMBatchArgs(RDMBatchCallback *_callback)
+    : callback(_callback),
+      include_raw_frames(false) {
+  }
+};
 }  // namespace client
 }  // namespace ola
 #endif  // INCLUDE_OLA_CLIENT_CLIENTARGS_H_
@@ -21,9 +21,12 @@
 #ifndef INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 #define INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 
+#include <ola/DmxBuffer.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <ola/rdm/RDMEnums.h>
 #include <ola/rdm/RDMFrame.h>
 #include <ola/rdm/RDMResponseCodes.h>
+#include <ola/rdm/UID.h>
 
 #include <olad/PortConstants.h>
 
@@ -325,6 +328,129 @@ struct DMXMetadata {
   }
 };
 
+/**
+ * @brief A DMX frame returned by OlaClient::FetchDMXBatch().
+ */
+struct DMXFrame {
+  /**
+   * @brief The universe and priority of the frame.
+   */
+  DMXMetadata metadata;
+  /**
+   * @brief The DMX data.
+   */
+  DmxBuffer data;
+
+  DMXFrame(const DMXMetadata &_metadata, const DmxBuffer &_data)
+      : metadata(_metadata),
+        data(_data) {
+  }
+};
+
+/**
+ * @brief The counters for a universe, returned by
+ * OlaClient::FetchUniverseStats().
+ *
+ * The counters only ever increase, rates are found by comparing two samples.
+ */
+struct UniverseStats {
+  unsigned int universe;
+  /**
+   * @brief Frames received from input ports and source clients.
+   */
+  uint64_t input_frames;
+  /**
+   * @brief Frames sent to the output ports and sink clients.
+   */
+  uint64_t output_frames;
+  /**
+   * @brief The number of sources with data which hasn't timed out.
+   */
+  unsigned int active_sources;
+  uint8_t active_priority;
+  /**
+   * @brief The number of times the priority of the output changed.
+   */
+  uint64_t priority_changes;
+  /**
+   * @brief The count, sum and sum of squares of the intervals between input
+   * frames, in microseconds.
+   */
+  uint64_t interval_count;
+  uint64_t interval_sum;
+  uint64_t interval_sum_squares;
+
+  UniverseStats()
+      : universe(0),
+        input_frames(0),
+        output_frames(0),
+        active_sources(0),
+        active_priority(0),
+        priority_changes(0),
+        interval_count(0),
+        interval_sum(0),
+        interval_sum_squares(0) {
+  }
+};
+
+/**
+ * @brief A read only view of some of the slots in a received DMX frame.
+ *
+ * The data points into the client's own buffers and is only valid until the
+ * callback it was passed to returns. Copy it if it's needed for longer.
+ */
+struct DMXView {
+  /**
+   * @brief The slot data, or NULL if length is 0.
+   */
+  const uint8_t *data;
+  /**
+   * @brief The slot number of data[0], counting from 0.
+   */
+  unsigned int offset;
+  /**
+   * @brief The number of slots in the view.
+   */
+  unsigned int length;
+  /**
+   * @brief The number of slots in the whole frame.
+   */
+  unsigned int frame_size;
+
+  DMXView()
+      : data(NULL),
+        offset(0),
+        length(0),
+        frame_size(0) {
+  }
+};
+
+/**
+ * @brief Counters for the frames passed to SendDMX() while coalescing is
+ * enabled.
+ */
+struct SendDMXCounters {
+  /**
+   * @brief The number of frames passed to SendDMX().
+   */
+  uint64_t frames_queued;
+  /**
+   * @brief The number of frames sent to the server.
+   */
+  uint64_t frames_sent;
+  /**
+   * @brief The number of frames that were replaced by a newer frame before
+   * they were sent.
+   */
+  uint64_t frames_coalesced;
+
+  SendDMXCounters()
+      : frames_queued(0),
+        frames_sent(0),
+        frames_coalesced(0) {
+  }
+};
+
 
 /**
  * @brief Metadata that accompanies RDM Responses.
@@ -350,6 +476,173 @@ struct RDMMetadata {
       : response_code(_response_code) {
   }
 };
+
+/**
+ * @brief Something the server GETs from each responder in a universe.
+ * @sa OlaClient::RegisterForRDMPoll().
+ */
+struct RDMPollItem {
+  /**
+   * @brief The sub device to send the GET to.
+   */
+  uint16_t sub_device;
+
+  /**
+   * @brief The PID to GET.
+   */
+  uint16_t pid;
+
+  /**
+   * @brief The param data to send with the GET, e.g. the sensor number for
+   * SENSOR_VALUE.
+   */
+  std::string data;
+
+  RDMPollItem(uint16_t _sub_device, uint16_t _pid,
+              const std::string &_data = "")
+      : sub_device(_sub_device),
+        pid(_pid),
+        data(_data) {
+  }
+};
+
+/**
+ * @brief A single GET or SET in a batch of RDM requests.
+ * @sa OlaClient::SendRDMBatch().
+ */
+struct RDMBatchItem {
+  /**
+   * @brief The universe to send the request on.
+   */
+  unsigned int universe;
+
+  /**
+   * @brief The UID to send the request to.
+   */
+  ola::rdm::UID uid;
+
+  /**
+   * @brief The sub device index.
+   */
+  uint16_t sub_device;
+
+  /**
+   * @brief The PID to address.
+   */
+  uint16_t pid;
+
+  /**
+   * @brief True for a SET, false for a GET.
+   */
+  bool is_set;
+
+  /**
+   * @brief The param data to send.
+   */
+  std::string data;
+
+  RDMBatchItem(unsigned int _universe,
+               const ola::rdm::UID &_uid,
+               uint16_t _sub_device,
+               uint16_t _pid,
+               bool _is_set = false,
+               const std::string &_data = "")
+      : universe(_universe),
+        uid(_uid),
+        sub_device(_sub_device),
+        pid(_pid),
+        is_set(_is_set),
+        data(_data) {
+  }
+};
+
+/**
+ * @brief The latest response from a responder for an RDMPollItem.
+ */
+struct RDMPollResult {
+  /**
+   * @brief The universe the responder is in.
+   */
+  unsigned int universe;
+
+  /**
+   * @brief The UID of the responder.
+   */
+  ola::rdm::UID uid;
+
+  /**
+   * @brief The item that was polled.
+   */
+  RDMPollItem item;
+
+  /**
+   * @brief The internal (OLA) response code.
+   */
+  ola::rdm::rdm_response_code response_code;
+
+  /**
+   * @brief The response type, only valid if response_code is
+   * RDM_COMPLETED_OK.
+   */
+  ola::rdm::rdm_response_type response_type;
+
+  /**
+   * @brief The param data from the response. For a NACK this holds the
+   * reason.
+   */
+  std::string data;
+
+  RDMPollResult(unsigned int _universe,
+                const ola::rdm::UID &_uid,
+                const RDMPollItem &_item)
+      : universe(_universe),
+        uid(_uid),
+        item(_item),
+        response_code(ola::rdm::RDM_FAILED_TO_SEND),
+        response_type(ola::rdm::RDM_ACK) {
+  }
+};
+
+/**
+ * @brief The universes and devices that changed on the server.
+ * @sa OlaClient::RegisterForInfoUpdates().
+ */
+struct InfoChanges {
+  /**
+   * @brief The universe generation, pass this to FetchUniverseChanges().
+   */
+  uint64_t universe_generation;
+
+  /**
+   * @brief The device generation, pass this to FetchDeviceChanges().
+   */
+  uint64_t device_generation;
+
+  /**
+   * @brief The ids of the universes that were created or changed.
+   */
+  std::vector<unsigned int> changed_universes;
+
+  /**
+   * @brief The ids of the universes that were removed.
+   */
+  std::vector<unsigned int> removed_universes;
+
+  /**
+   * @brief The aliases of the devices that were registered or changed.
+   */
+  std::vector<unsigned int> changed_devices;
+
+  /**
+   * @brief The aliases of the devices that were removed.
+   */
+  std::vector<unsigned int> removed_devices;
+
+  InfoChanges()
+      : universe_generation(0),
+        device_generation(0) {
+  }
+};
 }  // namespace client
 }  // namespace ola
 #endif  // INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
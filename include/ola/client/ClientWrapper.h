@@ -89,7 +89,7 @@ class BaseClientWrapper {
   void SocketClosed();
 
  protected:
-  std::auto_ptr<ola::network::TCPSocket> m_socket;
+  std::auto_ptr<ola::io::ConnectedDescriptor> m_socket;
 
  private:
   ola::io::SelectServer m_ss;
@@ -118,6 +118,31 @@ class GenericClientWrapper: public BaseClientWrapper {
    */
   ClientClass *GetClient() const { return m_client.get(); }
 
+  /**
+   * @brief Coalesce the frames sent by the client, using this wrapper's
+   * SelectServer for the interval.
+   * @param interval the longest time to wait for an ack.
+   *
+   * This must be called after Setup(). See OlaClient::EnableDMXCoalescing().
+   */
+  void EnableDMXCoalescing(const TimeInterval &interval) {
+    m_client->EnableDMXCoalescing(GetSelectServer(), interval);
+  }
+
+  /**
+   * @brief Send the frames the client has coalesced.
+   */
+  void FlushDMX() {
+    m_client->FlushDMX();
+  }
+
+  /**
+   * @brief Return the counters for the frames the client has sent.
+   */
+  const SendDMXCounters &DMXCounters() const {
+    return m_client->DMXCounters();
+  }
+
  private:
   std::auto_ptr<ClientClass> m_client;
   bool m_auto_start;
@@ -140,13 +165,7 @@ class GenericClientWrapper: public BaseClientWrapper {
     if (m_auto_start) {
       m_socket.reset(ola::client::ConnectToServer(OLA_DEFAULT_PORT));
     } else {
-      m_socket.reset(ola::network::TCPSocket::Connect(
-          ola::network::IPV4SocketAddress(
-            ola::network::IPV4Address::Loopback(),
-           OLA_DEFAULT_PORT)));
-    }
-    if (m_socket.get()) {
-      m_socket->SetNoDelay();
+      m_socket.reset(ola::client::ConnectToRunningServer(OLA_DEFAULT_PORT));
     }
   }
 };
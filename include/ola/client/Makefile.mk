@@ -8,4 +8,5 @@ olaclientinclude_HEADERS = \
     include/ola/client/Module.h \
     include/ola/client/OlaClient.h \
     include/ola/client/Result.h \
-    include/ola/client/StreamingClient.h
+    include/ola/client/StreamingClient.h \
+    include/ola/client/ThreadedStreamingClient.h
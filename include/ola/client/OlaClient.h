@@ -21,6 +21,8 @@
 #ifndef INCLUDE_OLA_CLIENT_OLACLIENT_H_
 #define INCLUDE_OLA_CLIENT_OLACLIENT_H_
 
+#include <ola/Clock.h>
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/client/CallbackTypes.h>
 #include <ola/client/ClientArgs.h>
@@ -30,6 +32,7 @@
 #include <ola/plugin_id.h>
 #include <ola/rdm/UID.h>
 #include <ola/rdm/UIDSet.h>
+#include <ola/thread/SchedulerInterface.h>
 #include <ola/timecode/TimeCode.h>
 
 #include <memory>
@@ -73,12 +76,56 @@ class OlaClient {
    */
   void SetDMXCallback(RepeatableDMXCallback *callback);
 
+  /**
+   * @brief Set a callback to be run with a view of the new DMX data.
+   *
+   * This avoids copying the received data into a DmxBuffer. The view is only
+   * valid until the callback returns. It can be used alongside the callback
+   * set by SetDMXCallback().
+   * @param callback the callback to run upon receiving new DMX data, or NULL
+   *   to remove it.
+   * @param start_slot the first slot to include in the view, counting from 0.
+   * @param slot_count the maximum number of slots to include in the view.
+   *
+   * The callback isn't run for frames that don't reach start_slot, or for
+   * delta encoded frames that don't change any of the slots in the view.
+   */
+  void SetDMXViewCallback(RepeatableDMXViewCallback *callback,
+                          unsigned int start_slot = 0,
+                          unsigned int slot_count = DMX_UNIVERSE_SIZE);
+
+  /**
+   * @brief Set the callback to be run when a polled RDM item changes.
+   *
+   * The callback is run for the items registered with RegisterForRDMPoll().
+   * @param callback the callback to run, or NULL to remove it.
+   */
+  void SetRDMPollCallback(RepeatableRDMPollCallback *callback);
+
+  /**
+   * @brief Set the callback to be run when universes or devices change.
+   *
+   * The callback is run once RegisterForInfoUpdates() has been called.
+   * @param callback the callback to run, or NULL to remove it.
+   */
+  void SetInfoChangesCallback(RepeatableInfoChangesCallback *callback);
+
   /**
    * @brief Trigger a plugin reload.
    * @param callback the SetCallback to invoke upon completion.
    */
   void ReloadPlugins(SetCallback *callback);
 
+  /**
+   * @brief Reload a single plugin, leaving the others running.
+   *
+   * The plugin's preferences are read again and its ports are re-patched once
+   * it's restarted.
+   * @param plugin_id the id of the plugin to reload.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ReloadPlugin(ola_plugin_id plugin_id, SetCallback *callback);
+
   /**
    * @brief Fetch the list of plugins loaded.
    * @param callback the PluginListCallback to be invoked upon completion.
@@ -225,6 +272,28 @@ class OlaClient {
              unsigned int universe,
              SetCallback *callback);
 
+  /**
+   * @brief Patch or unpatch a set of ports.
+   *
+   * Either all of the changes are made or none of them are. The changes are
+   * checked against the patching as it will be once they're all made, so
+   * ports can be swapped between universes.
+   * @param patches the changes to make.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void PatchPorts(const std::vector<PortPatch> &patches,
+                  SetCallback *callback);
+
+  /**
+   * @brief Set the name and merge mode of a set of universes.
+   *
+   * If any of the universes don't exist, no changes are made.
+   * @param universes the universes to configure.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ConfigureUniverses(const std::vector<UniverseConfig> &universes,
+                          SetCallback *callback);
+
   /**
    * @brief Register our interest in a universe.
    *
@@ -238,6 +307,65 @@ class OlaClient {
                         RegisterAction register_action,
                         SetCallback *callback);
 
+  /**
+   * @brief Register our interest in a universe, with limits on the data
+   * that's sent.
+   * @param universe the id of the universe to register for.
+   * @param register_action the action (register or unregister)
+   * @param args the RegisterArgs to use for this call.
+   */
+  void RegisterUniverse(unsigned int universe,
+                        RegisterAction register_action,
+                        const RegisterArgs &args);
+
+  /**
+   * @brief Ask the server to poll the responders in a universe for us.
+   *
+   * The server polls the items from every responder, and the callback set by
+   * SetRDMPollCallback() is run with the latest result for each responder and
+   * item, and then each time a result changes. The polling is shared with
+   * the other clients interested in the universe.
+   * @param universe the id of the universe to poll.
+   * @param register_action the action (register or unregister)
+   * @param args the RDMPollArgs to use for this call. Registering again
+   *   replaces the previous items and interval.
+   */
+  void RegisterForRDMPoll(unsigned int universe,
+                          RegisterAction register_action,
+                          const RDMPollArgs &args);
+
+  /**
+   * @brief Ask the server to tell us when universes, ports or devices
+   * change.
+   *
+   * Rather than polling FetchUniverseList() and FetchDeviceInfo(), the
+   * callback set by SetInfoChangesCallback() is run with the ids of what
+   * changed, and FetchUniverseChanges() and FetchDeviceChanges() can be used
+   * to fetch just those.
+   * @param register_action the action (register or unregister)
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterForInfoUpdates(RegisterAction register_action,
+                              SetCallback *callback);
+
+  /**
+   * @brief Fetch the universes that changed since a generation.
+   * @param since_generation the generation from a previous call, or from
+   *   InfoChanges. 0 fetches all the universes.
+   * @param callback the UniverseChangesCallback to invoke upon completion.
+   */
+  void FetchUniverseChanges(uint64_t since_generation,
+                            UniverseChangesCallback *callback);
+
+  /**
+   * @brief Fetch the devices that changed since a generation.
+   * @param since_generation the generation from a previous call, or from
+   *   InfoChanges. 0 fetches all the devices.
+   * @param callback the DeviceChangesCallback to invoke upon completion.
+   */
+  void FetchDeviceChanges(uint64_t since_generation,
+                          DeviceChangesCallback *callback);
+
   /**
    * @brief Send DMX data.
    * @param universe the universe to send to.
@@ -248,6 +376,57 @@ class OlaClient {
                const DmxBuffer &data,
                const SendDMXArgs &args);
 
+  /**
+   * @brief Coalesce the frames passed to SendDMX().
+   * @param scheduler the scheduler to use for the interval, usually the
+   *   SelectServer the client runs on. May be NULL, ownership isn't
+   *   transferred.
+   * @param interval the longest time to wait for an ack. Zero means always
+   *   wait for the ack.
+   *
+   * Once enabled, each universe has at most one unacknowledged frame. Frames
+   * sent while waiting for the ack replace each other, and only the newest is
+   * sent, once the previous frame is acked or interval has passed. With a
+   * scheduler, frames sent in the same loop iteration are also combined. This
+   * stops clients that send faster than the server can process from filling
+   * up the connection.
+   *
+   * The callback for a frame that was replaced is run when the frame that
+   * replaced it is acked.
+   */
+  void EnableDMXCoalescing(ola::thread::SchedulerInterface *scheduler,
+                           const TimeInterval &interval);
+
+  /**
+   * @brief Send any coalesced frames, and go back to sending every frame.
+   */
+  void DisableDMXCoalescing();
+
+  /**
+   * @brief Send the coalesced frames now, without waiting for the acks.
+   */
+  void FlushDMX();
+
+  /**
+   * @brief Return the counters for the frames sent with coalescing enabled.
+   */
+  const SendDMXCounters &DMXCounters() const;
+
+  /**
+   * @brief Ask the server to fade our data for a universe to new values.
+   * @param universe the universe to fade.
+   * @param data the values to fade to, starting at args.start_slot.
+   * @param duration_ms the length of the fade in milliseconds.
+   * @param args the FadeDMXArgs to use for this call.
+   *
+   * The fade starts from the last data we sent for the universe. Sending DMX
+   * data for the universe stops the fade.
+   */
+  void FadeDMX(unsigned int universe,
+               const DmxBuffer &data,
+               unsigned int duration_ms,
+               const FadeDMXArgs &args);
+
   /**
    * @brief Fetch the latest DMX data for a universe.
    * @param universe the universe id to get data for.
@@ -255,6 +434,18 @@ class OlaClient {
    */
   void FetchDMX(unsigned int universe, DMXCallback *callback);
 
+  /**
+   * @brief Fetch the latest DMX data for a set of universes in one request.
+   * @param args the FetchDMXBatchArgs.
+   */
+  void FetchDMXBatch(const FetchDMXBatchArgs &args);
+
+  /**
+   * @brief Fetch the counters for a set of universes in one request.
+   * @param args the FetchUniverseStatsArgs.
+   */
+  void FetchUniverseStats(const FetchUniverseStatsArgs &args);
+
   /**
    * @brief Trigger discovery for a universe.
    * @param universe the universe id to run discovery on.
@@ -308,6 +499,17 @@ class OlaClient {
               unsigned int data_length,
               const SendRDMArgs& args);
 
+  /**
+   * @brief Send a batch of RDM Get and Set Commands in a single call.
+   *
+   * This avoids a round trip to the server for each request. The requests
+   * are sent to the responders in order, and the callback is run as each one
+   * completes.
+   * @param args the batch arguments which includes the requests and the
+   *   callback to run.
+   */
+  void SendRDMBatch(const SendRDMBatchArgs &args);
+
   /**
    * @brief Send TimeCode data.
    * @param timecode The timecode data.
@@ -30,11 +30,21 @@
 #include <ola/base/Macro.h>
 #include <ola/dmx/SourcePriorities.h>
 
+#include <map>
+#include <vector>
+
 namespace ola {
 
-namespace io { class SelectServer; }
-namespace network { class TCPSocket; }
-namespace proto { class OlaServerService_Stub; }
+namespace dmx { class SharedDmxRegion; }
+namespace io {
+class ConnectedDescriptor;
+class SelectServer;
+}
+namespace network { class UDPSocket; }
+namespace proto {
+class OlaServerService_Stub;
+class UdpDmxFrame;
+}
 namespace rpc {
 class RpcChannel;
 class RpcSession;
@@ -97,7 +107,12 @@ class StreamingClient : public StreamingClientInterface {
      * Create a new options structure with the default options. This
      * includes automatically starting olad if it's not already running.
      */
-    Options() : auto_start(true), server_port(OLA_DEFAULT_PORT) {}
+    Options()
+        : auto_start(true),
+          server_port(OLA_DEFAULT_PORT),
+          use_shared_memory(false),
+          use_udp(false) {
+    }
 
     /**
      * If true, the client will automatically start olad if it's not
@@ -109,6 +124,51 @@ class StreamingClient : public StreamingClientInterface {
      * The RPC port olad is listening on.
      */
     uint16_t server_port;
+
+    /**
+     * If true, the client will try to send DMX data to olad through shared
+     * memory, rather than over the RPC connection. If olad doesn't support
+     * this, the RPC connection is used.
+     */
+    bool use_shared_memory;
+
+    /**
+     * If true, the client will send DMX data to olad in UDP datagrams,
+     * rather than over the RPC connection. A lost or late datagram doesn't
+     * hold up the ones after it, instead olad skips any data older than
+     * what it already has. If olad doesn't support this, the RPC connection
+     * is used. Shared memory is preferred if both are enabled.
+     */
+    bool use_udp;
+  };
+
+  /**
+   * @brief The DMX data for a single universe, used with SendBatch().
+   */
+  class DmxUpdate {
+   public:
+    /**
+     * @brief the universe to send to.
+     */
+    unsigned int universe;
+
+    /**
+     * @brief the DMX512 data.
+     */
+    DmxBuffer data;
+
+    /**
+     * @brief the priority of the data.
+     */
+    uint8_t priority;
+
+    DmxUpdate(unsigned int universe,
+              const DmxBuffer &data,
+              uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT)
+        : universe(universe),
+          data(data),
+          priority(priority) {
+    }
   };
 
   /**
@@ -164,18 +224,75 @@ class StreamingClient : public StreamingClientInterface {
                const DmxBuffer &data,
                const SendArgs &args);
 
+  /**
+   * @brief Send DMX data for many universes in a single message.
+   * @param updates the updates to send.
+   * @returns true if sent sucessfully, false if the connection to the server
+   *   has been closed.
+   *
+   * This is much more efficient than calling SendDMX() for each universe
+   * since the updates share a single RPC message and write. The server
+   * applies all the updates before updating the universes.
+   */
+  bool SendBatch(const std::vector<DmxUpdate> &updates);
+
+  /**
+   * @brief Send DMX data for a run of consecutive universes.
+   * @param first_universe the first universe to send to.
+   * @param data the data for the universes, packed one after another.
+   * @param length the length of the data.
+   * @param slots_per_universe the number of slots in each universe, the last
+   *   universe may be shorter.
+   * @param args the SendArgs to use for this call.
+   * @returns true if sent sucessfully, false if the connection to the server
+   *   has been closed.
+   *
+   * This suits pixel mapping, where a large run of universes is sent each
+   * frame but only some of them change. olad only merges and outputs the
+   * universes whose data has changed since the last range. The range always
+   * goes over the RPC connection.
+   */
+  bool SendRange(unsigned int first_universe,
+                 const uint8_t *data,
+                 unsigned int length,
+                 unsigned int slots_per_universe = DMX_UNIVERSE_SIZE,
+                 const SendArgs &args = SendArgs());
+
   void ChannelClosed(ola::rpc::RpcSession *session);
 
  private:
+  typedef std::map<unsigned int, unsigned int> SharedSlotMap;
+
   bool m_auto_start;
   uint16_t m_server_port;
-  ola::network::TCPSocket *m_socket;
+  bool m_use_shared_memory;
+  bool m_use_udp;
+  ola::io::ConnectedDescriptor *m_socket;
   ola::io::SelectServer *m_ss;
   class ola::rpc::RpcChannel *m_channel;
   class ola::proto::OlaServerService_Stub *m_stub;
   bool m_socket_closed;
+  ola::dmx::SharedDmxRegion *m_shared_dmx;
+  SharedSlotMap m_shared_slots;  // universe -> slot
+  ola::network::UDPSocket *m_udp_socket;
+  uint16_t m_udp_port;
+  uint64_t m_udp_token;
+  uint32_t m_udp_sequence;
 
   bool Send(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+  bool CheckConnection();
+  bool WaitForSetup(const bool *done);
+  void SetupComplete(bool *done);
+  bool SetupSharedDmx();
+  bool WriteSharedDmx(unsigned int universe, uint8_t priority,
+                      const DmxBuffer &data, unsigned int *slot);
+  void NotifySharedDmx(unsigned int first_slot, unsigned int last_slot);
+  bool SetupUdp();
+  void SendUdpFrame(ola::proto::UdpDmxFrame *frame);
+
+  static const unsigned int SHARED_DMX_SLOTS;
+  static const unsigned int SETUP_TIMEOUT_MS;
+  static const unsigned int MAX_UDP_FRAME_SIZE;
 
   DISALLOW_COPY_AND_ASSIGN(StreamingClient);
 };
@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ThreadedStreamingClient.h
+ * A StreamingClient that can be fed from other threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file
+ * @brief A client for sending DMX512 data to olad from many threads.
+ */
+
+#ifndef INCLUDE_OLA_CLIENT_THREADEDSTREAMINGCLIENT_H_
+#define INCLUDE_OLA_CLIENT_THREADEDSTREAMINGCLIENT_H_
+
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/io/SelectServer.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <ola/thread/Thread.h>
+#include <ola/thread/TripleBuffer.h>
+
+#include <map>
+#include <vector>
+
+namespace ola {
+namespace client {
+
+/**
+ * @class ThreadedStreamingClient ola/client/ThreadedStreamingClient.h
+ * @brief Send DMX512 data to olad without blocking the threads that produce
+ * it.
+ *
+ * The client runs a StreamingClient on its own thread. Each universe has a
+ * lock free slot: SendDMX() copies the frame into the slot and returns
+ * straight away. On each tick the client thread collects the frames that
+ * changed since the last tick and sends them to olad as a single batch. If a
+ * universe is sent more than once between ticks only the newest frame is
+ * used.
+ *
+ * The universes must be added with AddUniverse() before Setup() is called.
+ * Each universe should only be sent to by one thread at a time, different
+ * universes may be sent from different threads.
+ *
+ * If the connection to olad is lost, the client tries to reconnect, and
+ * resends the last frame for every universe once it does.
+ */
+class ThreadedStreamingClient : private ola::thread::Thread {
+ public:
+  /**
+   * Controls the options for the ThreadedStreamingClient class.
+   */
+  class Options {
+   public:
+    Options()
+        : tick_interval(TimeInterval(0, DEFAULT_TICK_INTERVAL_US)) {
+    }
+
+    /**
+     * The options for the underlying StreamingClient.
+     */
+    StreamingClient::Options client_options;
+
+    /**
+     * How often the slots are checked for new frames.
+     */
+    TimeInterval tick_interval;
+
+    /**
+     * The CPUs to run the client thread on, empty means any CPU.
+     */
+    std::vector<unsigned int> cpu_affinity;
+  };
+
+  explicit ThreadedStreamingClient(const Options &options = Options());
+
+  /**
+   * Destructor. This stops the client thread if it's still running.
+   */
+  ~ThreadedStreamingClient();
+
+  /**
+   * @brief Add a slot for a universe.
+   * @param universe the universe to add.
+   * @returns false if the client has already been setup.
+   */
+  bool AddUniverse(unsigned int universe);
+
+  /**
+   * @brief Connect to olad and start the client thread.
+   * @returns true if the client connected, false otherwise.
+   */
+  bool Setup();
+
+  /**
+   * @brief Send any remaining frames, and stop the client thread.
+   */
+  void Stop();
+
+  /**
+   * @brief Queue a frame for a universe.
+   * @param universe the universe to send to, this must have been added with
+   *   AddUniverse().
+   * @param data the DMX512 data.
+   * @param args the SendArgs to use for this frame.
+   * @returns false if the universe wasn't added.
+   *
+   * This never blocks, and may be called from any thread.
+   */
+  bool SendDMX(unsigned int universe,
+               const DmxBuffer &data,
+               const StreamingClientInterface::SendArgs &args =
+                   StreamingClientInterface::SendArgs());
+
+ private:
+  struct Frame {
+    DmxBuffer data;
+    uint8_t priority;
+
+    Frame() : priority(0) {}
+  };
+
+  struct UniverseSlot {
+    ola::thread::TripleBuffer<Frame> frames;
+    // The last frame sent, only used by the client thread.
+    DmxBuffer last_sent;
+    uint8_t last_priority;
+    bool has_data;
+
+    UniverseSlot() : last_priority(0), has_data(false) {}
+  };
+
+  typedef std::map<unsigned int, UniverseSlot*> SlotMap;
+
+  const TimeInterval m_tick_interval;
+  StreamingClient m_client;
+  ola::io::SelectServer m_ss;
+  // This isn't modified once the thread starts, so the producers can read it
+  // without locking.
+  SlotMap m_slots;
+  bool m_started;
+  bool m_connected;
+  TimeStamp m_last_connect_attempt;
+  ola::thread::timeout_id m_tick_timeout;
+  std::vector<StreamingClient::DmxUpdate> m_batch;
+
+  void *Run();
+  bool Tick();
+  void SendUpdates(bool send_all);
+  bool Reconnect();
+
+  static const unsigned int DEFAULT_TICK_INTERVAL_US = 25000;
+  static const unsigned int RECONNECT_INTERVAL_S = 1;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadedStreamingClient);
+};
+}  // namespace client
+}  // namespace ola
+#endif  // INCLUDE_OLA_CLIENT_THREADEDSTREAMINGCLIENT_H_
@@ -0,0 +1,95 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * BinaryFrame.h
+ * A binary format for DMX frames.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file BinaryFrame.h
+ * @brief A binary format for DMX frames, used where text parsing would be too
+ * slow.
+ */
+
+#ifndef INCLUDE_OLA_DMX_BINARYFRAME_H_
+#define INCLUDE_OLA_DMX_BINARYFRAME_H_
+
+#include <ola/DmxBuffer.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A DMX frame for a universe.
+ *
+ * On the wire each frame is a header, the universe as a big endian uint32_t
+ * followed by the slot count as a big endian uint16_t, and then the slots.
+ * Frames for several universes can be sent back to back.
+ *
+ * This is used by the application/octet-stream variants of the HTTP server's
+ * /set_dmx and /get_dmx, and by ola_streaming_client --binary.
+ */
+class BinaryFrame {
+ public:
+  BinaryFrame() : universe(0) {}
+  BinaryFrame(unsigned int universe, const DmxBuffer &data)
+      : universe(universe),
+        data(data) {
+  }
+
+  unsigned int universe;
+  DmxBuffer data;
+
+  /**
+   * @brief Parse a frame header.
+   * @param[in] header the header, this must be HEADER_SIZE bytes.
+   * @param[out] universe the universe of the frame.
+   * @param[out] slot_count the number of slots that follow the header.
+   * @returns false if the slot count is more than a universe holds.
+   */
+  static bool ParseHeader(const uint8_t *header,
+                          unsigned int *universe,
+                          unsigned int *slot_count);
+
+  /**
+   * @brief Parse a series of frames.
+   * @param[in] data the frames.
+   * @param[in] length the length of data.
+   * @param[out] frames the parsed frames are appended to this.
+   * @returns false if the data wasn't a whole number of valid frames.
+   */
+  static bool Parse(const uint8_t *data,
+                    unsigned int length,
+                    std::vector<BinaryFrame> *frames);
+
+  /**
+   * @brief Append a frame to a string.
+   * @param universe the universe of the frame.
+   * @param buffer the DMX data.
+   * @param[out] output the string to append the frame to.
+   */
+  static void Write(unsigned int universe,
+                    const DmxBuffer &buffer,
+                    std::string *output);
+
+  static const unsigned int HEADER_SIZE = 6;
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_BINARYFRAME_H_
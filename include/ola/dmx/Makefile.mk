@@ -1,4 +1,6 @@
 oladmxincludedir = $(pkgincludedir)/dmx/
 oladmxinclude_HEADERS = \
+    include/ola/dmx/BinaryFrame.h \
+    include/ola/dmx/PcapWriter.h \
     include/ola/dmx/RunLengthEncoder.h \
     include/ola/dmx/SourcePriorities.h
@@ -0,0 +1,152 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PcapWriter.h
+ * Writes DMX512 and RDM frames to a pcapng capture file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file PcapWriter.h
+ * @brief Writes DMX512 and RDM frames to a pcapng capture file.
+ */
+
+#ifndef INCLUDE_OLA_DMX_PCAPWRITER_H_
+#define INCLUDE_OLA_DMX_PCAPWRITER_H_
+
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief Writes frames to a pcapng file, so long sessions can be recorded
+ * and analysed offline.
+ *
+ * Each source of frames, e.g. a line or a universe, is an interface in the
+ * capture. Frames are recorded as they appear on the line: the start code
+ * followed by the slots. Timestamps have nanosecond resolution.
+ *
+ * Frames are appended to a buffer, and full buffers are written to disk by a
+ * background thread, so the caller never blocks on the disk. If the disk
+ * can't keep up and MAX_PENDING_BUFFERS are waiting to be written, frames are
+ * dropped and counted.
+ *
+ * AddInterface() and WriteFrame() must only be called from one thread at a
+ * time.
+ */
+class PcapWriter {
+ public:
+  /**
+   * @brief The link type of an interface.
+   *
+   * There are no registered link types for DMX512 and RDM, so these use the
+   * link types reserved for private use, LINKTYPE_USER0 and LINKTYPE_USER1.
+   */
+  enum LinkType {
+    /** DMX512 packets, with any start code */
+    LINKTYPE_DMX = 147,
+    /** RDM messages, starting with the RDM start code */
+    LINKTYPE_RDM = 148,
+  };
+
+  /**
+   * @brief Create a new capture file, replacing any existing file.
+   * @param path the file to write to.
+   * @returns a new PcapWriter or NULL if the file couldn't be opened.
+   */
+  static PcapWriter* Open(const std::string &path);
+
+  /**
+   * @brief Destructor, this writes out the buffered frames and closes the
+   * file.
+   */
+  ~PcapWriter();
+
+  /**
+   * @brief Add an interface to the capture.
+   * @param link_type the type of frames on the interface.
+   * @param name the name of the interface, e.g. "universe 1".
+   * @returns the id of the interface, used with WriteFrame().
+   */
+  unsigned int AddInterface(LinkType link_type, const std::string &name);
+
+  /**
+   * @brief Record a frame.
+   * @param interface_id the interface the frame was seen on.
+   * @param time the time the frame was seen.
+   * @param start_code the start code of the frame.
+   * @param slots the slot data, following the start code.
+   * @param slot_count the number of slots.
+   * @returns false if the frame was dropped.
+   */
+  bool WriteFrame(unsigned int interface_id,
+                  const TimeStamp &time,
+                  uint8_t start_code,
+                  const uint8_t *slots,
+                  unsigned int slot_count);
+
+  /**
+   * @brief Pass the buffered frames to the writer thread.
+   *
+   * This is done automatically when the buffer is full, or when a frame is
+   * written more than FLUSH_INTERVAL_MS after the last flush.
+   */
+  void Flush();
+
+  /**
+   * @brief The number of frames written.
+   */
+  uint64_t FramesWritten() const { return m_frames_written; }
+
+  /**
+   * @brief The number of frames dropped because the disk couldn't keep up.
+   */
+  uint64_t FramesDropped() const { return m_frames_dropped; }
+
+  static const unsigned int BUFFER_SIZE = 64 * 1024;
+  static const unsigned int MAX_PENDING_BUFFERS = 64;
+  static const unsigned int FLUSH_INTERVAL_MS = 1000;
+
+ private:
+  class WriterThread;
+  typedef std::vector<uint8_t> Buffer;
+
+  WriterThread *m_thread;
+  Buffer *m_buffer;
+  unsigned int m_interface_count;
+  TimeStamp m_last_flush;
+  uint64_t m_frames_written;
+  uint64_t m_frames_dropped;
+
+  explicit PcapWriter(int fd);
+
+  bool Reserve(unsigned int size);
+  void AppendUInt16(uint16_t value);
+  void AppendUInt32(uint32_t value);
+  void AppendData(const uint8_t *data, unsigned int length);
+  void AppendPadding(unsigned int length);
+  void AppendOption(uint16_t code, const uint8_t *data, unsigned int length);
+  void WriteSectionHeader();
+
+  DISALLOW_COPY_AND_ASSIGN(PcapWriter);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_PCAPWRITER_H_
@@ -68,6 +68,8 @@ class RunLengthEncoder {
 
  private:
   static const uint8_t REPEAT_FLAG = 0x80;
+  // The longest segment a single header can describe.
+  static const unsigned int MAX_SEGMENT_LENGTH = 0x7f;
 };
 }  // namespace dmx
 }  // namespace ola
@@ -61,8 +61,14 @@ class DeviceManager {
     // Run when we give up (or lose) designated controller status.
     typedef ola::Callback1<void, const IPV4Address&> ReleaseDeviceCallback;
 
+    /*
+     * In scalable mode the connections are health checked from a single
+     * timer wheel, and share a pool of receive buffers. Use this when
+     * managing a large number of devices.
+     */
     DeviceManager(ola::io::SelectServerInterface *ss,
-                  ola::e133::MessageBuilder *message_builder);
+                  ola::e133::MessageBuilder *message_builder,
+                  bool scalable_mode = false);
     ~DeviceManager();
 
     // Ownership of the callbacks is transferred.
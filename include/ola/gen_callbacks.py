@@ -122,6 +122,10 @@ USA
    *   delete callback4;
    *   @endcode
    *
+   * @note Single use callbacks are allocated from a per-thread pool of fixed
+   * size blocks, see CallbackPool.h. Creating one on a hot path doesn't hit
+   * the heap once the pool is warm.
+   *
    * @note The code in Callback.h is autogenerated by gen_callbacks.py. Please
    * edit and run gen_callbacks.py if you need to add more types.
    *
@@ -137,6 +141,9 @@ USA
   #ifndef INCLUDE_OLA_CALLBACK_H_
   #define INCLUDE_OLA_CALLBACK_H_
 
+  #include <stddef.h>
+  #include <ola/CallbackPool.h>
+
   namespace ola {
 
   /**
@@ -155,6 +162,16 @@ def Footer():
   #endif  // INCLUDE_OLA_CALLBACK_H_""")
 
 
+def PrintPoolOperators():
+  """Print the operators which allocate single use callbacks from the pool."""
+  print '  static void *operator new(size_t size) {'
+  print '    return ola::AllocateSingleUseCallback(size);'
+  print '  }'
+  print '  static void operator delete(void *ptr, size_t size) {'
+  print '    ola::FreeSingleUseCallback(ptr, size);'
+  print '  }'
+
+
 def GenerateBase(number_of_args):
   """Generate the base Callback classes."""
   optional_comma = ''
@@ -217,6 +234,7 @@ def GenerateBase(number_of_args):
   print '    delete this;'
   print '    return ret;'
   print '  }'
+  PrintPoolOperators()
   print ' private:'
   print '  virtual ReturnType DoRun(%s) = 0;' % arg_list
   print '};'
@@ -238,6 +256,7 @@ def GenerateBase(number_of_args):
   print '    this->DoRun(%s);' % args
   print '    delete this;'
   print '  }'
+  PrintPoolOperators()
   print ' private:'
   print '  virtual void DoRun(%s) = 0;' % arg_list
   print '};'
@@ -24,7 +24,9 @@
 
 #include <ola/Callback.h>
 #include <ola/base/Macro.h>
+#include <ola/http/WebSocket.h>
 #include <ola/io/Descriptor.h>
+#include <ola/io/IOQueue.h>
 #include <ola/io/SelectServer.h>
 #include <ola/thread/Thread.h>
 #include <ola/web/Json.h>
@@ -48,6 +50,8 @@
 namespace ola {
 namespace http {
 
+struct WebSocketHandler;
+
 /*
  * Represents the HTTP request
  */
@@ -67,15 +71,29 @@ class HTTPRequest {
 
   void AddHeader(const std::string &key, const std::string &value);
   void AddPostParameter(const std::string &key, const std::string &value);
-  void ProcessPostData(const char *data, size_t *data_size);
+  bool ProcessPostData(const char *data, size_t *data_size);
   const std::string GetHeader(const std::string &key) const;
   bool CheckParameterExists(const std::string &key) const;
   const std::string GetParameter(const std::string &key) const;
   const std::string GetPostParameter(const std::string &key) const;
 
+  // True if this is a POST with an application/octet-stream body, which is
+  // available from Body() rather than as post parameters.
+  bool HasRawBody() const { return m_raw_body; }
+  const std::string &Body() const { return m_body; }
+
   bool InFlight() const { return m_in_flight; }
   void SetInFlight() { m_in_flight = true; }
 
+  // Used when the response is built on another thread, the connection is
+  // suspended until the response is ready.
+  bool Deferred() const { return m_deferred; }
+  void SetDeferred() { m_deferred = true; }
+  void SetResponse(unsigned int status_code, struct MHD_Response *response);
+  int QueueResponse();
+
+  struct MHD_Connection *Connection() const { return m_connection; }
+
  private:
   std::string m_url;
   std::string m_method;
@@ -84,9 +102,16 @@ class HTTPRequest {
   std::map<std::string, std::string> m_headers;
   std::map<std::string, std::string> m_post_params;
   struct MHD_PostProcessor *m_processor;
+  bool m_raw_body;
+  std::string m_body;
+  struct MHD_Response *m_response;
+  unsigned int m_response_status;
   bool m_in_flight;
+  bool m_deferred;
 
   static const unsigned int K_POST_BUFFER_SIZE = 1024;
+  // Enough for a binary frame for each of 2000 universes.
+  static const unsigned int K_MAX_BODY_SIZE = 1024 * 1024;
 
   DISALLOW_COPY_AND_ASSIGN(HTTPRequest);
 };
@@ -99,22 +124,50 @@ class HTTPResponse {
  public:
   explicit HTTPResponse(struct MHD_Connection *connection):
     m_connection(connection),
-    m_status_code(MHD_HTTP_OK) {}
+    m_status_code(MHD_HTTP_OK),
+    m_deferred_request(NULL),
+    m_content_etag(false) {}
 
   void Append(const std::string &data) { m_data.append(data); }
   void SetContentType(const std::string &type);
   void SetHeader(const std::string &key, const std::string &value);
   void SetStatus(unsigned int status) { m_status_code = status; }
   void SetNoCache();
+
+  /**
+   * @brief Set the ETag of the response.
+   *
+   * If the client already has this version, a 304 is sent instead of the
+   * body.
+   */
+  void SetETag(const std::string &etag) { m_etag = etag; }
+
+  /**
+   * @brief Set the ETag from a hash of the body when the response is sent.
+   */
+  void EnableContentETag() { m_content_etag = true; }
   int SendJson(const ola::web::JsonValue &json);
   int Send();
+  int Send(ola::io::IOQueue *data);
+  int SendResponse(struct MHD_Response *response);
   struct MHD_Connection *Connection() const { return m_connection; }
+
+  // Hand the response to a suspended request rather than queueing it.
+  void DeferTo(HTTPRequest *request) { m_deferred_request = request; }
  private:
   std::string m_data;
   struct MHD_Connection *m_connection;
   typedef std::multimap<std::string, std::string> HeadersMultiMap;
   HeadersMultiMap m_headers;
   unsigned int m_status_code;
+  HTTPRequest *m_deferred_request;
+  std::string m_etag;
+  bool m_content_etag;
+
+  bool NotModified() const;
+
+  // The size of the chunks passed to microhttpd by Send(IOQueue*)
+  static const unsigned int K_RESPONSE_BLOCK_SIZE = 4096;
 
   DISALLOW_COPY_AND_ASSIGN(HTTPResponse);
 };
@@ -129,6 +182,13 @@ class HTTPResponse {
  * This is a simple HTTP Server built around libmicrohttpd. It runs in a
  * separate thread.
  *
+ * By default microhttpd is driven from the server's SelectServer, so all
+ * requests are handled on that one thread. If thread_pool_size is set,
+ * microhttpd processes connections on its own pool of threads. Static files
+ * and handlers registered with RegisterThreadSafeHandler() are served from
+ * the pool, all other handlers are run on the SelectServer thread and the
+ * connection is suspended until they respond.
+ *
  * @examplepara
  * @code
  *   HTTPServer::HTTPServerOptions options;
@@ -145,6 +205,8 @@ class HTTPServer: public ola::thread::Thread {
  public:
   typedef ola::Callback2<int, const HTTPRequest*, HTTPResponse*>
     BaseHTTPCallback;
+  // Called with a new WebSocket, ownership of the WebSocket is transferred.
+  typedef ola::Callback1<void, WebSocket*> WebSocketCallback;
 
   struct HTTPServerOptions {
    public:
@@ -152,10 +214,21 @@ class HTTPServer: public ola::thread::Thread {
     uint16_t port;
     // The root for content served with ServeStaticContent();
     std::string data_dir;
+    // The number of threads microhttpd uses, 0 handles every connection on
+    // the SelectServer thread.
+    unsigned int thread_pool_size;
+    // The maximum number of open connections, 0 uses the microhttpd default.
+    unsigned int connection_limit;
+    // Close idle keep-alive connections after this many seconds, 0 means
+    // never.
+    unsigned int connection_timeout;
 
     HTTPServerOptions()
       : port(0),
-        data_dir("") {
+        data_dir(""),
+        thread_pool_size(0),
+        connection_limit(0),
+        connection_timeout(0) {
     }
   };
 
@@ -172,11 +245,19 @@ class HTTPServer: public ola::thread::Thread {
    */
   void HandleHTTPIO() {}
 
-  int DispatchRequest(const HTTPRequest *request, HTTPResponse *response);
+  int DispatchRequest(HTTPRequest *request, HTTPResponse *response);
 
   // Register a callback handler.
   bool RegisterHandler(const std::string &path, BaseHTTPCallback *handler);
 
+  // Register a handler that may be run on any of the thread pool's threads.
+  bool RegisterThreadSafeHandler(const std::string &path,
+                                 BaseHTTPCallback *handler);
+
+  // Register a handler for WebSocket connections.
+  bool RegisterWebSocketHandler(const std::string &path,
+                                WebSocketCallback *handler);
+
   // Register a file handler.
   bool RegisterFile(const std::string &path,
                     const std::string &content_type);
@@ -188,6 +269,7 @@ class HTTPServer: public ola::thread::Thread {
 
   void Handlers(std::vector<std::string> *handlers) const;
   const std::string DataDir() const { return m_data_dir; }
+  bool ThreadPooled() const { return m_thread_pool_size > 0; }
 
   // Return an error
   int ServeError(HTTPResponse *response, const std::string &details = "");
@@ -209,6 +291,7 @@ class HTTPServer: public ola::thread::Thread {
   static const char CONTENT_TYPE_OCT[];
   static const char CONTENT_TYPE_XML[];
   static const char CONTENT_TYPE_JSON[];
+  static const char CONTENT_TYPE_OPENMETRICS[];
 
   // Expose the SelectServer
   ola::io::SelectServer *SelectServer() { return m_select_server.get(); }
@@ -219,6 +302,13 @@ class HTTPServer: public ola::thread::Thread {
   typedef struct {
     std::string file_path;
     std::string content_type;
+    // The contents are loaded into memory by Init()
+    bool loaded;
+    std::string data;
+    std::string etag;
+    // The data from file_path.gz, if it exists
+    std::string gzip_data;
+    std::string gzip_etag;
   } static_file_info;
 
   struct DescriptorState {
@@ -247,17 +337,37 @@ class HTTPServer: public ola::thread::Thread {
   SocketSet m_sockets;
 
   std::map<std::string, BaseHTTPCallback*> m_handlers;
+  std::set<std::string> m_thread_safe_handlers;
+  std::map<std::string, WebSocketHandler*> m_websocket_handlers;
   std::map<std::string, static_file_info> m_static_content;
   BaseHTTPCallback *m_default_handler;
   unsigned int m_port;
   std::string m_data_dir;
+  unsigned int m_thread_pool_size;
+  unsigned int m_connection_limit;
+  unsigned int m_connection_timeout;
 
-  int ServeStaticContent(static_file_info *file_info,
+  int ServeStaticContent(const HTTPRequest *request,
+                         const static_file_info &file_info,
                          HTTPResponse *response);
+  void LoadStaticContent();
+  bool LoadFile(static_file_info *file_info) const;
+  int DeferRequest(BaseHTTPCallback *handler,
+                   HTTPRequest *request,
+                   HTTPResponse *response);
+  void RunDeferredHandler(BaseHTTPCallback *handler,
+                          HTTPRequest *request,
+                          HTTPResponse *response);
+  int ServeWebSocket(const HTTPRequest *request,
+                     HTTPResponse *response,
+                     WebSocketHandler *handler);
 
   void InsertSocket(bool is_readable, bool is_writeable, int fd);
   void FreeSocket(DescriptorState *state);
 
+  // The SelectServer poll interval, in seconds.
+  static const unsigned int K_POLL_INTERVAL = 60;
+
   DISALLOW_COPY_AND_ASSIGN(HTTPServer);
 };
 }  // namespace http
@@ -1,4 +1,5 @@
 olahttpincludedir = $(pkgincludedir)/http/
 olahttpinclude_HEADERS = \
     include/ola/http/HTTPServer.h \
-    include/ola/http/OlaHTTPServer.h
+    include/ola/http/OlaHTTPServer.h \
+    include/ola/http/WebSocket.h
@@ -77,6 +77,9 @@ class OlaHTTPServer {
     }
 
     int DisplayDebug(const HTTPRequest *request, HTTPResponse *response);
+    int DisplayLoopProfile(const HTTPRequest *request,
+                           HTTPResponse *response);
+    int DisplayMetrics(const HTTPRequest *request, HTTPResponse *response);
     int DisplayHandlers(const HTTPRequest *request, HTTPResponse *response);
 
     DISALLOW_COPY_AND_ASSIGN(OlaHTTPServer);
@@ -0,0 +1,147 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WebSocket.h
+ * The server side of a RFC 6455 WebSocket connection.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_HTTP_WEBSOCKET_H_
+#define INCLUDE_OLA_HTTP_WEBSOCKET_H_
+
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <ola/io/IOQueue.h>
+#include <ola/io/SelectServerInterface.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+namespace ola {
+namespace http {
+
+/**
+ * @brief A WebSocket connection, once the HTTP upgrade has completed.
+ *
+ * This handles the framing, ping / pong and the closing handshake. Messages
+ * from the client are passed to the on-message callback, fragmented messages
+ * are re-assembled first.
+ *
+ * Writes are non-blocking and buffered, if the client isn't reading fast
+ * enough the buffer limit is reached and SendText() / SendBinary() return
+ * false rather than queueing more data.
+ *
+ * Once the connection closes, the on-close callback is run. The owner should
+ * delete the WebSocket from outside of the callback, for example with
+ * SelectServer::Execute().
+ */
+class WebSocket {
+ public:
+  typedef ola::Callback1<void, const std::string&> MessageCallback;
+  typedef ola::SingleUseCallback0<void> CloseCallback;
+
+  enum Opcode {
+    CONTINUATION_FRAME = 0x0,
+    TEXT_FRAME = 0x1,
+    BINARY_FRAME = 0x2,
+    CLOSE_FRAME = 0x8,
+    PING_FRAME = 0x9,
+    PONG_FRAME = 0xa
+  };
+
+  /**
+   * @brief Create a new WebSocket.
+   * @param ss the SelectServer to register the socket with.
+   * @param socket the upgraded connection, ownership is transferred.
+   * @param initial_data any data the client sent after the upgrade request.
+   */
+  WebSocket(ola::io::SelectServerInterface *ss,
+            ola::io::ConnectedDescriptor *socket,
+            const std::string &initial_data = "");
+  ~WebSocket();
+
+  /**
+   * @brief Set the callback to run when a message is received.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void SetOnMessage(MessageCallback *callback);
+
+  /**
+   * @brief Set the callback to run when the connection closes.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void SetOnClose(CloseCallback *callback);
+
+  bool SendText(const std::string &data);
+  bool SendBinary(const uint8_t *data, unsigned int length);
+
+  /**
+   * @brief Start the closing handshake.
+   */
+  void Close();
+
+  bool IsClosed() const { return m_closed; }
+  bool LimitReached() const { return m_output.Size() >= MAX_BUFFER_SIZE; }
+
+  /**
+   * @brief Compute the Sec-WebSocket-Accept value for a handshake.
+   * @param key the Sec-WebSocket-Key value sent by the client.
+   */
+  static std::string AcceptKey(const std::string &key);
+
+  /**
+   * @brief Encode an un-masked, un-fragmented frame.
+   * @param opcode the Opcode of the frame.
+   * @param data the payload.
+   * @param length the length of the payload.
+   * @param output the IOQueue to append the frame to.
+   */
+  static void EncodeFrame(Opcode opcode, const uint8_t *data,
+                          unsigned int length, ola::io::IOQueue *output);
+
+  // The largest message we'll accept from a client.
+  static const unsigned int MAX_MESSAGE_SIZE = 64 * 1024;
+
+ private:
+  ola::io::SelectServerInterface *m_ss;
+  std::auto_ptr<ola::io::ConnectedDescriptor> m_socket;
+  ola::io::IOQueue m_output;
+  std::auto_ptr<MessageCallback> m_on_message;
+  std::auto_ptr<CloseCallback> m_on_close;
+  std::string m_input;
+  std::string m_message;
+  bool m_in_message;
+  bool m_write_registered;
+  bool m_close_sent;
+  bool m_shutdown_pending;
+  bool m_closed;
+
+  void ReceiveData();
+  bool ProcessFrames();
+  bool HandleFrame(bool fin, uint8_t opcode, const std::string &payload);
+  bool SendFrame(Opcode opcode, const uint8_t *data, unsigned int length);
+  void PerformWrite();
+  void SocketClosed();
+  void Shutdown(bool remove_descriptor = true);
+
+  static const unsigned int MAX_BUFFER_SIZE = 64 * 1024;
+  static const unsigned int READ_SIZE = 1024;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocket);
+};
+}  // namespace http
+}  // namespace ola
+#endif  // INCLUDE_OLA_HTTP_WEBSOCKET_H_
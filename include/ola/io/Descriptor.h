@@ -310,6 +310,17 @@ class ConnectedDescriptor: public BidirectionalFileDescriptor {
    */
   virtual ssize_t Send(IOQueue *data);
 
+  /**
+   * @brief Write an array of IOVecs to the descriptor.
+   * @param iov the IOVecs to write.
+   * @param iocnt the number of IOVecs.
+   * @returns the number of bytes written, or -1 on error.
+   *
+   * This gathers the data with a single call where the platform supports it,
+   * so callers don't need to copy it into a contiguous buffer first.
+   */
+  virtual ssize_t Send(const struct IOVec *iov, int iocnt);
+
 
   /**
    * @brief Read data from this descriptor.
@@ -121,6 +121,40 @@ class MemoryBlock {
       return bytes_to_write;
     }
 
+    /**
+     * @brief Provides a pointer to the free space at the end of this block.
+     * @returns a pointer to the first byte after the valid data.
+     *
+     * This allows the block to be written to in place. Use Extend() to add
+     * the written data to the block.
+     */
+    uint8_t *FreeSpace() const { return m_last; }
+
+    /**
+     * @brief Add data written to the free space at the end of this block.
+     * @param length the number of bytes written.
+     * @returns the number of bytes added, which will be less than length if
+     * the block is now full.
+     */
+    unsigned int Extend(unsigned int length) {
+      unsigned int bytes_to_add = std::min(
+          length, static_cast<unsigned int>(m_data_end - m_last));
+      m_last += bytes_to_add;
+      return bytes_to_add;
+    }
+
+    /**
+     * @brief Remove data from the end of the block
+     * @param length the amount of data to remove
+     * @returns the amount of data removed.
+     */
+    unsigned int PopBack(unsigned int length) {
+      unsigned int bytes_to_pop = std::min(
+          length, static_cast<unsigned int>(m_last - m_first));
+      m_last -= bytes_to_pop;
+      return bytes_to_pop;
+    }
+
     /**
      * @brief Prepend data to this block.
      * @param data the data to prepend.
@@ -32,19 +32,23 @@ namespace io {
  * @brief MemoryBlockPool. This class is not thread safe.
  * @param block_size the size of blocks to use.
  */
+/*
+ * This isn't thread safe, see SharedMemoryBlockPool for a pool that can be
+ * used from more than one thread.
+ */
 class MemoryBlockPool {
  public:
     explicit MemoryBlockPool(unsigned int block_size = DEFAULT_BLOCK_SIZE)
         : m_block_size(block_size),
           m_blocks_allocated(0) {
     }
-    ~MemoryBlockPool() {
+    virtual ~MemoryBlockPool() {
       Purge();
     }
 
     // Allocate a new MemoryBlock from the pool. May return NULL if allocation
     // fails.
-    MemoryBlock *Allocate() {
+    virtual MemoryBlock *Allocate() {
       if (m_free_blocks.empty()) {
         uint8_t* data = new uint8_t[m_block_size];
         OLA_DEBUG << "new block allocated at @" << reinterpret_cast<int*>(data);
@@ -62,12 +66,14 @@ class MemoryBlockPool {
     }
 
     // Release a MemoryBlock back to the pool.
-    void Release(MemoryBlock *block) {
+    virtual void Release(MemoryBlock *block) {
+      // discard any data left in the block so it's empty when reused.
+      block->PopFront(block->Size());
       m_free_blocks.push(block);
     }
 
     // Returns the number of free blocks in the pool.
-    unsigned int FreeBlocks() const {
+    virtual unsigned int FreeBlocks() const {
       return static_cast<unsigned int>(m_free_blocks.size());
     }
 
@@ -77,7 +83,7 @@ class MemoryBlockPool {
     }
 
     // Delete all but remaining free blocks.
-    void Purge(unsigned int remaining) {
+    virtual void Purge(unsigned int remaining) {
       while (m_free_blocks.size() != remaining) {
         MemoryBlock *block = m_free_blocks.front();
         m_blocks_allocated--;
@@ -86,7 +92,12 @@ class MemoryBlockPool {
       }
     }
 
-    unsigned int BlocksAllocated() const { return m_blocks_allocated; }
+    virtual unsigned int BlocksAllocated() const {
+      return m_blocks_allocated;
+    }
+
+    // Returns the size of the blocks in this pool.
+    unsigned int BlockSize() const { return m_block_size; }
 
     // default to 1k blocks
     static const unsigned int DEFAULT_BLOCK_SIZE = 1024;
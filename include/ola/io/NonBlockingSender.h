@@ -23,19 +23,23 @@
  *
  *  This class abstracts the caller from having to deal with this situation. At
  *  construction time we specify the maximum number of message bytes we want to
- *  buffer. Once the buffer reaches this size subsequent calls to SendMessage
- *  will return false.
+ *  buffer. What happens once the buffer reaches this size depends on the
+ *  QueuePolicy.
  */
 
 #ifndef INCLUDE_OLA_IO_NONBLOCKINGSENDER_H_
 #define INCLUDE_OLA_IO_NONBLOCKINGSENDER_H_
 
+#include <stdint.h>
 #include <ola/io/Descriptor.h>
 #include <ola/io/IOQueue.h>
 #include <ola/io/MemoryBlockPool.h>
 #include <ola/io/OutputBuffer.h>
 #include <ola/io/SelectServerInterface.h>
 
+#include <deque>
+#include <map>
+
 namespace ola {
 namespace io {
 
@@ -49,13 +53,32 @@ namespace io {
  * available). If there is more data than fits in the descriptor's socket
  * buffer, the remaining data is held in the internal buffer.
  *
- * The internal buffer has a limit on the size. Once the limit is
- * exceeded, calls to SendMessage() will return false. The limit is a soft
- * limit however, a call to SendMessage() may cause the buffer to exceed the
- * internal limit, provided the limit has not already been reached.
+ * The internal buffer has a limit on the size. What happens once the limit is
+ * exceeded depends on the QueuePolicy:
+ *  - REJECT_NEW: calls to SendMessage() return false.
+ *  - DROP_OLDEST: the oldest queued messages are dropped to make room.
+ *  - LATEST_VALUE_WINS: as DROP_OLDEST, and in addition a keyed message
+ *    replaces any queued message with the same key.
+ *
+ * The limit is a soft limit however, a call to SendMessage() may cause the
+ * buffer to exceed the internal limit, provided the limit has not already been
+ * reached.
+ *
+ * With the dropping policies, messages are held in a queue until the
+ * descriptor is writable. Once a message has been passed to the descriptor
+ * it's never dropped, since that would corrupt the stream.
  */
 class NonBlockingSender {
  public:
+  /**
+   * @brief What to do when the buffer limit is reached.
+   */
+  enum QueuePolicy {
+    REJECT_NEW,  /**< Reject the new message */
+    DROP_OLDEST,  /**< Drop the oldest queued messages */
+    LATEST_VALUE_WINS,  /**< Replace queued messages with the same key */
+  };
+
   /**
    * @brief Create a new NonBlockingSender.
    * @param descriptor the ConnectedDescriptor to send on, ownership is not
@@ -66,11 +89,13 @@ class NonBlockingSender {
    *   because the underlying MemoryBlocks may be partially used, this does not
    *   reflect the actual amount of memory used (in pathological cases we may
    *   allocate up to max_buffer_size * memory_block_size bytes.
+   * @param policy the QueuePolicy to use once the limit is reached.
    */
   NonBlockingSender(ola::io::ConnectedDescriptor *descriptor,
                     ola::io::SelectServerInterface *ss,
                     ola::io::MemoryBlockPool *memory_pool,
-                    unsigned int max_buffer_size = DEFAULT_MAX_BUFFER_SIZE);
+                    unsigned int max_buffer_size = DEFAULT_MAX_BUFFER_SIZE,
+                    QueuePolicy policy = REJECT_NEW);
 
   /**
    * @brief Destructor
@@ -101,6 +126,42 @@ class NonBlockingSender {
    */
   bool SendMessage(IOQueue *queue);
 
+  /**
+   * @brief Send a keyed message.
+   * @param stack the IOStack to send, the stack will be emptied.
+   * @param key the key for this message. With the LATEST_VALUE_WINS policy,
+   *   this replaces any queued message with the same key. Otherwise the key
+   *   is ignored.
+   * @returns true if the message was buffered for transmit, false otherwise.
+   */
+  bool SendMessage(class IOStack *stack, uint32_t key);
+
+  /**
+   * @brief Send a keyed message.
+   * @param queue the IOQueue to send, the queue will be emptied.
+   * @param key the key for this message.
+   * @returns true if the message was buffered for transmit, false otherwise.
+   */
+  bool SendMessage(IOQueue *queue, uint32_t key);
+
+  /**
+   * @brief The number of bytes waiting to be written.
+   */
+  unsigned int BufferedBytes() const;
+
+  /**
+   * @brief The number of messages queued, this doesn't include messages
+   *   already passed to the descriptor.
+   */
+  unsigned int QueuedMessages() const {
+    return static_cast<unsigned int>(m_queue.size());
+  }
+
+  /**
+   * @brief The number of messages dropped or replaced by the QueuePolicy.
+   */
+  unsigned int DroppedMessages() const { return m_dropped_messages; }
+
   /**
    * @brief The default max internal buffer size.
    *
@@ -113,12 +174,35 @@ class NonBlockingSender {
   static const unsigned int DEFAULT_MAX_BUFFER_SIZE;
 
  private:
+  struct QueuedMessage {
+    explicit QueuedMessage(MemoryBlockPool *pool)
+        : data(pool), key(0), has_key(false) {
+    }
+
+    IOQueue data;
+    uint32_t key;
+    bool has_key;
+  };
+
+  typedef std::deque<QueuedMessage*> MessageQueue;
+  typedef std::map<uint32_t, QueuedMessage*> KeyMap;
+
   ola::io::ConnectedDescriptor *m_descriptor;
   ola::io::SelectServerInterface *m_ss;
+  ola::io::MemoryBlockPool *m_memory_pool;
+  // The data that's been passed to the descriptor.
   ola::io::IOQueue m_output_buffer;
   bool m_associated;
   unsigned int m_max_buffer_size;
+  const QueuePolicy m_policy;
+  // Messages that can still be dropped, only used by the dropping policies.
+  MessageQueue m_queue;
+  KeyMap m_keyed_messages;
+  unsigned int m_queued_bytes;
+  unsigned int m_dropped_messages;
 
+  bool QueueMessage(IOQueue *data, bool has_key, uint32_t key);
+  void DropOldest();
   void PerformWrite();
   void AssociateIfRequired();
 
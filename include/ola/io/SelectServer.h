@@ -31,6 +31,7 @@
 
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 class SelectServerTest;
@@ -66,6 +67,8 @@ class SelectServer: public SelectServerInterface {
    public:
     Options()
         : force_select(false),
+          use_timer_wheel(false),
+          profile_loop(false),
           export_map(NULL),
           clock(NULL) {
     }
@@ -76,6 +79,23 @@ class SelectServer: public SelectServerInterface {
      */
     bool force_select;
 
+    /**
+     * @brief Use a timer wheel rather than a priority queue for timeouts.
+     *
+     * The timer wheel is cheaper when there are many timeouts, particularly
+     * if most of them are cancelled before they fire.
+     */
+    bool use_timer_wheel;
+
+    /**
+     * @brief Record the time spent in each callback, and how late timeouts
+     * run.
+     *
+     * The results are recorded in the export map, so this has no effect
+     * without one. The --profile-loop flag also enables this.
+     */
+    bool profile_loop;
+
     /**
      * @brief The export map to use.
      */
@@ -175,6 +195,15 @@ class SelectServer: public SelectServerInterface {
       ola::SingleUseCallback0<void> *callback);
   void RemoveTimeout(ola::thread::timeout_id id);
 
+  void SetDescriptorName(const ReadFileDescriptor *descriptor,
+                         const std::string &name);
+  void SetTimeoutName(ola::thread::timeout_id id, const std::string &name);
+
+  /**
+   * @brief Check if the loop is being profiled.
+   */
+  bool Profiling() const { return m_profiler.get() != NULL; }
+
   /**
    * @brief Execute a callback on every event loop.
    * @param callback the Callback to execute. Ownership is transferrred to the
@@ -192,7 +221,6 @@ class SelectServer: public SelectServerInterface {
   void DrainCallbacks();
 
  private:
-  typedef std::vector<ola::BaseCallback0<void>*> Callbacks;
   typedef std::set<ola::Callback0<void>*> LoopClosureSet;
 
   ExportMap *m_export_map;
@@ -200,18 +228,15 @@ class SelectServer: public SelectServerInterface {
   TimeInterval m_poll_interval;
   std::auto_ptr<class TimeoutManager> m_timeout_manager;
   std::auto_ptr<class PollerInterface> m_poller;
+  std::auto_ptr<class LoopProfiler> m_profiler;
 
   Clock *m_clock;
   bool m_free_clock;
   LoopClosureSet m_loop_callbacks;
-  Callbacks m_incoming_callbacks;
-  ola::thread::Mutex m_incoming_mutex;
-  LoopbackDescriptor m_incoming_descriptor;
+  std::auto_ptr<class CallbackQueue> m_incoming_queue;
 
   void Init(const Options &options);
   bool CheckForEvents(const TimeInterval &poll_interval);
-  void DrainAndExecute();
-  void RunCallbacks(Callbacks *callbacks);
   void SetTerminate() { m_terminate = true; }
 
   // the maximum time we'll wait in the select call
@@ -219,6 +244,9 @@ class SelectServer: public SelectServerInterface {
   static const unsigned int POLL_INTERVAL_USECOND = 0;
 
   static const TimeStamp empty_time;
+  // The names the loop profiler uses for Execute() and RunInLoop() callbacks.
+  static const char K_EXECUTE_NAME[];
+  static const char K_RUN_IN_LOOP_NAME[];
 
   friend class ::SelectServerTest;
 
@@ -25,6 +25,7 @@
 #include <ola/Clock.h>
 #include <ola/io/Descriptor.h>
 #include <ola/thread/SchedulingExecutorInterface.h>
+#include <string>
 
 namespace ola {
 namespace io {
@@ -123,6 +124,31 @@ class SelectServerInterface: public ola::thread::SchedulingExecutorInterface {
 
   virtual void RemoveTimeout(ola::thread::timeout_id id) = 0;
 
+  /**
+   * @brief Name a descriptor for loop profiling.
+   * @param descriptor the descriptor, this should already be registered.
+   * @param name the name the time spent on the descriptor's events is
+   *   recorded under, e.g. "artnet-socket".
+   *
+   * This does nothing unless the loop is being profiled. The name is removed
+   * when the descriptor is removed.
+   */
+  virtual void SetDescriptorName(const ReadFileDescriptor*,
+                                 const std::string&) {
+  }
+
+  /**
+   * @brief Name a timeout for loop profiling.
+   * @param id the timeout_id returned when the timeout was registered.
+   * @param name the name the time spent in the timeout is recorded under.
+   *
+   * This does nothing unless the loop is being profiled. The name is removed
+   * once the timeout is cancelled or stops repeating.
+   */
+  virtual void SetTimeoutName(ola::thread::timeout_id,
+                              const std::string&) {
+  }
+
   /**
    * @brief The time when this SelectServer was woken up.
    * @returns The TimeStamp of when the SelectServer was woken up.
@@ -0,0 +1,166 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedMemoryBlockPool.h
+ * A MemoryBlockPool that can be used from more than one thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_IO_SHAREDMEMORYBLOCKPOOL_H_
+#define INCLUDE_OLA_IO_SHAREDMEMORYBLOCKPOOL_H_
+
+#include <pthread.h>
+#include <ola/base/Macro.h>
+#include <ola/io/MemoryBlock.h>
+#include <ola/io/MemoryBlockPool.h>
+#include <ola/thread/Mutex.h>
+#include <set>
+#include <vector>
+
+namespace ola {
+namespace io {
+
+/**
+ * @brief A thread safe MemoryBlockPool.
+ *
+ * Each thread has a cache (magazine) of free blocks which is used without
+ * locking. When a thread's cache is empty it takes a batch of blocks from the
+ * shared depot, and when it's full half of it is returned to the depot. Once
+ * the pool has warmed up, allocating and releasing blocks doesn't touch the
+ * heap.
+ *
+ * A block may be released on a different thread to the one which allocated
+ * it, in which case it ends up in the releasing thread's cache.
+ *
+ * The cache of a thread is returned to the depot when the thread exits.
+ *
+ * Each pool uses a pthread key, so pools should be long lived and shared,
+ * rather than created per connection. Most code should use PacketPool().
+ */
+class SharedMemoryBlockPool : public MemoryBlockPool {
+ public:
+  struct Options {
+   public:
+    /**
+     * @brief The size of each block.
+     */
+    unsigned int block_size;
+
+    /**
+     * @brief The maximum number of free blocks each thread caches.
+     */
+    unsigned int thread_cache_size;
+
+    /**
+     * @brief The maximum number of free blocks held in the depot, blocks
+     *   released beyond this are freed.
+     */
+    unsigned int depot_size;
+
+    /**
+     * @brief The number of blocks to allocate up front.
+     */
+    unsigned int preallocate;
+
+    Options()
+        : block_size(DEFAULT_BLOCK_SIZE),
+          thread_cache_size(DEFAULT_THREAD_CACHE_SIZE),
+          depot_size(DEFAULT_DEPOT_SIZE),
+          preallocate(0) {
+    }
+  };
+
+  /**
+   * @brief Create a new SharedMemoryBlockPool.
+   * @param options the Options for the pool.
+   */
+  explicit SharedMemoryBlockPool(const Options &options = Options());
+
+  /**
+   * @brief Destructor.
+   *
+   * No thread may be using the pool when it's destroyed. All free blocks,
+   * including those in each thread's cache, are freed.
+   */
+  ~SharedMemoryBlockPool();
+
+  MemoryBlock *Allocate();
+  void Release(MemoryBlock *block);
+
+  /**
+   * @brief The number of free blocks in the depot and the calling thread's
+   *   cache.
+   */
+  unsigned int FreeBlocks() const;
+
+  /**
+   * @brief Return the calling thread's cache to the depot and then free all
+   *   but remaining blocks from the depot.
+   */
+  void Purge(unsigned int remaining);
+  using MemoryBlockPool::Purge;
+
+  unsigned int BlocksAllocated() const;
+
+  /**
+   * @brief The pool used for network packets and RPC messages.
+   *
+   * The pool is created on first use, and lives until the process exits.
+   */
+  static SharedMemoryBlockPool *PacketPool();
+
+  /**
+   * @brief Set the options used to create the PacketPool().
+   * @param options the Options to use.
+   * @returns false if the PacketPool() has already been created.
+   */
+  static bool ConfigurePacketPool(const Options &options);
+
+  static const unsigned int DEFAULT_THREAD_CACHE_SIZE = 64;
+  static const unsigned int DEFAULT_DEPOT_SIZE = 1024;
+
+ private:
+  typedef std::vector<MemoryBlock*> BlockVector;
+
+  struct ThreadCache {
+    SharedMemoryBlockPool *pool;
+    BlockVector blocks;
+  };
+
+  typedef std::set<ThreadCache*> ThreadCaches;
+
+  const unsigned int m_thread_cache_size;
+  const unsigned int m_depot_size;
+  pthread_key_t m_cache_key;
+
+  mutable ola::thread::Mutex m_mutex;
+  // Protected by m_mutex.
+  BlockVector m_depot;
+  ThreadCaches m_caches;
+  unsigned int m_blocks_allocated;
+
+  ThreadCache *CurrentCache() const;
+  ThreadCache *GetCache();
+  MemoryBlock *NewBlock();
+  void ReturnToDepot(ThreadCache *cache, unsigned int count);
+  void FreeBlock(MemoryBlock *block);
+
+  static void DeleteCache(void *data);
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryBlockPool);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // INCLUDE_OLA_IO_SHAREDMEMORYBLOCKPOOL_H_
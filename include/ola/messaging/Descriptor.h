@@ -393,6 +393,70 @@ class FieldDescriptorGroup: public FieldDescriptor {
 };
 
 
+/**
+ * The fields of a Descriptor flattened into a list, so a message can be
+ * decoded with a loop rather than by visiting the descriptor tree.
+ *
+ * Each group is replaced by a GROUP_START entry, the entries for its fields
+ * and a GROUP_END entry.
+ */
+class FlatLayout {
+ public:
+    typedef enum {
+      BOOL,
+      IPV4,
+      MAC,
+      UID,
+      STRING,
+      UINT8,
+      UINT16,
+      UINT32,
+      INT8,
+      INT16,
+      INT32,
+      GROUP_START,
+      GROUP_END,
+    } FieldType;
+
+    struct Field {
+      FieldType type;
+      // Cast this to the descriptor class for the type.
+      const FieldDescriptor *descriptor;
+      // True for the variable sized field, if there is one. Its size, or the
+      // number of blocks for a group, depends on the length of the data.
+      bool variable;
+      // The size in bytes, or for a GROUP_START the number of blocks.
+      unsigned int size;
+      // For a GROUP_START, the index of the matching GROUP_END.
+      unsigned int end;
+    };
+
+    explicit FlatLayout(const std::vector<const FieldDescriptor*> &fields);
+
+    const std::vector<Field> &Fields() const { return m_fields; }
+
+    // The total size of the fixed size fields at the top level.
+    unsigned int FixedSize() const { return m_fixed_size; }
+
+    // The variable sized fields at the top level. Only a single variable
+    // sized field can be decoded.
+    const std::vector<const StringFieldDescriptor*> &VariableStrings() const {
+      return m_variable_strings;
+    }
+    const std::vector<const FieldDescriptorGroup*> &VariableGroups() const {
+      return m_variable_groups;
+    }
+
+ private:
+    class Builder;
+
+    std::vector<Field> m_fields;
+    unsigned int m_fixed_size;
+    std::vector<const StringFieldDescriptor*> m_variable_strings;
+    std::vector<const FieldDescriptorGroup*> m_variable_groups;
+};
+
+
 /**
  * A descriptor is a group of fields which can't be repeated
  */
@@ -400,9 +464,17 @@ class Descriptor: public FieldDescriptorGroup {
  public:
     Descriptor(const std::string &name,
                const std::vector<const FieldDescriptor*> &fields)
-        : FieldDescriptorGroup(name, fields, 1, 1) {}
+        : FieldDescriptorGroup(name, fields, 1, 1),
+          m_layout(fields) {
+    }
 
     void Accept(FieldDescriptorVisitor *visitor) const;
+
+    // The layout is built when the descriptor is created.
+    const FlatLayout &Layout() const { return m_layout; }
+
+ private:
+    const FlatLayout m_layout;
 };
 }  // namespace messaging
 }  // namespace ola
@@ -42,6 +42,10 @@ class Message {
         const std::vector<const class MessageFieldInterface*> &fields)
         : m_fields(fields) {
     }
+    // Takes the fields, leaving the vector empty.
+    explicit Message(std::vector<const class MessageFieldInterface*> *fields) {
+      m_fields.swap(*fields);
+    }
     ~Message();
 
     void Accept(MessageVisitor *visitor) const;
@@ -246,6 +250,13 @@ class GroupMessageField: public MessageFieldInterface {
         const std::vector<const class MessageFieldInterface*> &fields)
         : m_descriptor(descriptor),
           m_fields(fields) {}
+    // Takes the fields, leaving the vector empty.
+    GroupMessageField(
+        const FieldDescriptorGroup *descriptor,
+        std::vector<const class MessageFieldInterface*> *fields)
+        : m_descriptor(descriptor) {
+      m_fields.swap(*fields);
+    }
     ~GroupMessageField();
 
     const FieldDescriptorGroup *GetDescriptor() const { return m_descriptor; }
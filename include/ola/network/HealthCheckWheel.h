@@ -0,0 +1,139 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HealthCheckWheel.h
+ * Runs the health checks for many connections from a single timer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_HEALTHCHECKWHEEL_H_
+#define INCLUDE_OLA_NETWORK_HEALTHCHECKWHEEL_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/SchedulerInterface.h>
+
+#include <map>
+#include <vector>
+
+namespace ola {
+namespace network {
+
+/**
+ * @brief Health checks a large number of connections from one timer.
+ *
+ * A HealthCheckedConnection uses a repeating timer to send heartbeats, and
+ * re-registers a receive timer on every heartbeat it gets. With thousands of
+ * connections that's thousands of timers, which are constantly being
+ * cancelled.
+ *
+ * The wheel instead spreads the connections over a number of slots, and
+ * visits one slot on each tick of a single repeating timer, so each slot is
+ * visited once per heartbeat interval. On each visit a connection is sent a
+ * heartbeat, or if nothing was received for 2.5 heartbeat intervals, it's
+ * declared dead. Receiving a heartbeat just records the current tick.
+ *
+ * Because timeouts are only checked when a connection's slot comes around, a
+ * dead connection is detected between 2.5 and 3.5 heartbeat intervals after
+ * the last heartbeat was received.
+ */
+class HealthCheckWheel {
+ public:
+  /**
+   * @brief A connection checked by the wheel.
+   */
+  class Connection {
+   public:
+    virtual ~Connection() {}
+
+    /**
+     * @brief Send a heartbeat. This must not add or remove connections.
+     */
+    virtual void SendHeartbeat() = 0;
+
+    /**
+     * @brief Called when the connection is declared dead. The connection has
+     * already been removed from the wheel. This must not delete the wheel or
+     * other connections.
+     */
+    virtual void HeartbeatTimeout() = 0;
+  };
+
+  /**
+   * @brief Create a new HealthCheckWheel.
+   * @param scheduler the scheduler to use for the timer.
+   * @param heartbeat_interval the interval between heartbeats.
+   * @param slot_count the number of slots, more slots spread the heartbeats
+   *   more evenly.
+   */
+  HealthCheckWheel(ola::thread::SchedulerInterface *scheduler,
+                   const TimeInterval &heartbeat_interval,
+                   unsigned int slot_count = DEFAULT_SLOT_COUNT);
+  ~HealthCheckWheel();
+
+  /**
+   * @brief Start checking a connection. A heartbeat is sent straight away.
+   *
+   * The wheel's timer is registered when the first connection is added.
+   * @param connection the connection to add, ownership is not transferred.
+   */
+  void AddConnection(Connection *connection);
+
+  /**
+   * @brief Stop checking a connection.
+   */
+  void RemoveConnection(Connection *connection);
+
+  /**
+   * @brief Called when data is received on a connection.
+   */
+  void HeartbeatReceived(Connection *connection);
+
+  /**
+   * @brief The number of connections being checked.
+   */
+  unsigned int ConnectionCount() const {
+    return static_cast<unsigned int>(m_connections.size());
+  }
+
+  static const unsigned int DEFAULT_SLOT_COUNT = 20;
+
+ private:
+  struct ConnectionState {
+    unsigned int slot;
+    uint64_t last_received_tick;
+  };
+
+  typedef std::map<Connection*, ConnectionState> ConnectionMap;
+  typedef std::vector<Connection*> Slot;
+
+  ola::thread::SchedulerInterface *m_scheduler;
+  const TimeInterval m_tick_interval;
+  // The number of ticks without a heartbeat before a connection is dead.
+  const uint64_t m_timeout_ticks;
+  ola::thread::timeout_id m_timeout_id;
+  uint64_t m_current_tick;
+  unsigned int m_next_slot;
+  ConnectionMap m_connections;
+  std::vector<Slot> m_slots;
+
+  bool Tick();
+
+  DISALLOW_COPY_AND_ASSIGN(HealthCheckWheel);
+};
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_HEALTHCHECKWHEEL_H_
@@ -0,0 +1,134 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * InterfaceMonitor.h
+ * Keeps a table of the network interfaces up to date.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_INTERFACEMONITOR_H_
+#define INCLUDE_OLA_NETWORK_INTERFACEMONITOR_H_
+
+#include <ola/base/Macro.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/network/Interface.h>
+#include <ola/network/InterfacePicker.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace ola {
+
+namespace io {
+class UnmanagedFileDescriptor;
+}
+
+namespace network {
+
+/**
+ * @brief The interfaces that changed between two refreshes of the table.
+ *
+ * An interface that has a new address appears in both lists, with the old
+ * address in removed and the new one in added.
+ */
+struct InterfaceChanges {
+  std::vector<Interface> added;
+  std::vector<Interface> removed;
+
+  /**
+   * @brief Check if a socket bound to an interface needs to be rebound.
+   * @returns true if the interface, matched by name and address, was removed.
+   */
+  bool Affects(const Interface &iface) const;
+};
+
+/**
+ * @brief An InterfacePicker that caches the interfaces and tells listeners
+ * when they change.
+ *
+ * On Linux the monitor subscribes to link and address changes on a netlink
+ * socket, elsewhere the table is refreshed periodically. Changes usually
+ * arrive in bursts, e.g. when DHCP renews a lease, so the table is refreshed
+ * once the changes have settled.
+ *
+ * Picking an interface from the cached table avoids enumerating the
+ * interfaces each time a plugin starts.
+ */
+class InterfaceMonitor: public InterfacePicker {
+ public:
+  /**
+   * @brief Told when the interfaces change.
+   */
+  class Listener {
+   public:
+    virtual ~Listener() {}
+
+    virtual void InterfacesChanged(const InterfaceChanges &changes) = 0;
+  };
+
+  /**
+   * @brief Create a new InterfaceMonitor.
+   * @param ss the SelectServer to use.
+   * @param picker the picker used to read the interfaces, ownership is
+   *   transferred.
+   */
+  InterfaceMonitor(ola::io::SelectServerInterface *ss,
+                   InterfacePicker *picker);
+  ~InterfaceMonitor();
+
+  /**
+   * @brief Load the interfaces and start watching for changes.
+   * @returns true if changes are reported as they happen, false if the
+   *   monitor fell back to polling.
+   */
+  bool Init();
+
+  std::vector<Interface> GetInterfaces(bool include_loopback) const;
+
+  /**
+   * @brief Add a listener, ownership is not transferred.
+   */
+  void AddListener(Listener *listener);
+  void RemoveListener(Listener *listener);
+
+  /**
+   * @brief Read the interfaces and notify the listeners of any changes.
+   * @returns true if the interfaces changed.
+   */
+  bool Refresh();
+
+  static const unsigned int SETTLE_DELAY_MS = 500;
+  static const unsigned int POLL_INTERVAL_MS = 10000;
+
+ private:
+  ola::io::SelectServerInterface *m_ss;
+  std::auto_ptr<InterfacePicker> m_picker;
+  std::vector<Interface> m_interfaces;
+  std::set<Listener*> m_listeners;
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_netlink_descriptor;
+  ola::thread::timeout_id m_refresh_timeout;
+  ola::thread::timeout_id m_poll_timeout;
+
+  bool OpenNetlinkSocket();
+  void NetlinkReadable();
+  void SettleTimeout();
+  bool Poll();
+
+  DISALLOW_COPY_AND_ASSIGN(InterfaceMonitor);
+};
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_INTERFACEMONITOR_H_
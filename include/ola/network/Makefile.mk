@@ -1,15 +1,19 @@
 olanetworkincludedir = $(pkgincludedir)/network/
 olanetworkinclude_HEADERS = \
     include/ola/network/AdvancedTCPConnector.h\
+    include/ola/network/HealthCheckWheel.h \
     include/ola/network/HealthCheckedConnection.h \
     include/ola/network/IPV4Address.h \
     include/ola/network/Interface.h \
+    include/ola/network/InterfaceMonitor.h \
     include/ola/network/InterfacePicker.h \
     include/ola/network/MACAddress.h \
     include/ola/network/NetworkUtils.h \
+    include/ola/network/PcapReader.h \
     include/ola/network/Socket.h \
     include/ola/network/SocketAddress.h \
     include/ola/network/SocketCloser.h \
     include/ola/network/TCPConnector.h \
     include/ola/network/TCPSocket.h \
-    include/ola/network/TCPSocketFactory.h
+    include/ola/network/TCPSocketFactory.h \
+    include/ola/network/UnixDomainSocket.h
@@ -0,0 +1,134 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PcapReader.h
+ * Reads UDP datagrams from a pcap or pcapng capture file.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file PcapReader.h
+ * @brief Reads UDP datagrams from a pcap or pcapng capture file.
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_PCAPREADER_H_
+#define INCLUDE_OLA_NETWORK_PCAPREADER_H_
+
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <ola/network/SocketAddress.h>
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace network {
+
+/**
+ * @brief A UDP datagram read from a capture.
+ */
+struct CapturedDatagram {
+  /** @brief The time the datagram was captured. */
+  TimeStamp time;
+  /** @brief The source of the datagram. */
+  IPV4SocketAddress source;
+  /** @brief The destination of the datagram. */
+  IPV4SocketAddress destination;
+  /** @brief The UDP payload. */
+  std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief Reads the IPv4 UDP datagrams from a capture, so recorded network
+ * traffic can be replayed.
+ *
+ * Both the classic pcap format, with micro or nanosecond timestamps, and
+ * pcapng are supported, in either byte order. Packets can be Ethernet (with
+ * or without VLAN tags), Linux cooked, BSD loopback or raw IP. Everything
+ * else, including fragmented datagrams, is skipped and counted.
+ *
+ * The file is read a packet at a time, so large captures can be replayed.
+ */
+class PcapReader {
+ public:
+  /**
+   * @brief Open a capture file.
+   * @param path the file to read.
+   * @returns a new PcapReader, or NULL if the file couldn't be opened or
+   *   isn't a capture.
+   */
+  static PcapReader* Open(const std::string &path);
+
+  ~PcapReader() {}
+
+  /**
+   * @brief Read the next UDP datagram.
+   * @param[out] datagram the datagram.
+   * @returns false at the end of the capture, or if the file is corrupt, see
+   *   Failed().
+   */
+  bool NextDatagram(CapturedDatagram *datagram);
+
+  /**
+   * @brief Check if reading stopped because the file was corrupt.
+   */
+  bool Failed() const { return m_failed; }
+
+  /**
+   * @brief The number of packets that weren't IPv4 UDP datagrams.
+   */
+  uint64_t PacketsSkipped() const { return m_packets_skipped; }
+
+ private:
+  // The timestamp resolution and link type of a pcapng interface.
+  struct InterfaceInfo {
+    uint16_t link_type;
+    uint64_t units_per_second;
+  };
+
+  std::ifstream m_file;
+  bool m_pcapng;
+  bool m_swapped;
+  bool m_failed;
+  uint64_t m_packets_skipped;
+  // Only used for classic pcap files.
+  InterfaceInfo m_classic_interface;
+  std::vector<InterfaceInfo> m_interfaces;
+  std::vector<uint8_t> m_block;
+
+  PcapReader(const std::string &path, bool pcapng, bool swapped);
+
+  bool NextClassicPacket(CapturedDatagram *datagram);
+  bool NextPcapngPacket(CapturedDatagram *datagram);
+  bool ReadBlock(uint32_t *type);
+  void HandleInterfaceBlock();
+  bool HandlePacket(const InterfaceInfo &iface, uint64_t timestamp,
+                    const uint8_t *data, unsigned int length,
+                    CapturedDatagram *datagram);
+  bool ReadData(uint8_t *data, unsigned int length);
+  uint16_t Swap16(uint16_t value) const;
+  uint32_t Swap32(uint32_t value) const;
+  uint16_t ReadUInt16(const uint8_t *data) const;
+  uint32_t ReadUInt32(const uint8_t *data) const;
+
+  static bool ParseIPv4(const uint8_t *data, unsigned int length,
+                        CapturedDatagram *datagram);
+
+  DISALLOW_COPY_AND_ASSIGN(PcapReader);
+};
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_PCAPREADER_H_
@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/base/Macro.h>
 #include <ola/io/Descriptor.h>
 #include <ola/io/IOQueue.h>
@@ -36,6 +37,56 @@
 namespace ola {
 namespace network {
 
+/**
+ * @brief A buffer for a single datagram, used with
+ * UDPSocketInterface::RecvBatch() and UDPSocketInterface::SendBatch().
+ */
+struct UDPDatagram {
+  /** @brief The datagram data. */
+  uint8_t *data;
+  /**
+   * @brief The length of the data. When receiving this is the size of the
+   * buffer, and is updated with the number of bytes read.
+   */
+  ssize_t length;
+  /**
+   * @brief The source of a received datagram, or the destination of one to
+   * send.
+   */
+  IPV4SocketAddress address;
+  /**
+   * @brief The time the kernel received the datagram. This is only set if
+   * receive timestamps have been enabled with
+   * UDPSocketInterface::EnableReceiveTimestamps(), and are supported.
+   */
+  TimeStamp timestamp;
+};
+
+/**
+ * @brief The traffic counters for a UDP socket.
+ */
+struct UDPSocketStats {
+  UDPSocketStats()
+      : packets_received(0),
+        bytes_received(0),
+        packets_sent(0),
+        bytes_sent(0),
+        kernel_drops(0) {
+  }
+
+  uint64_t packets_received;
+  uint64_t bytes_received;
+  uint64_t packets_sent;
+  uint64_t bytes_sent;
+  /**
+   * @brief The number of datagrams the kernel dropped because the receive
+   * buffer was full. This is only counted once
+   * UDPSocketInterface::EnableDropCounting() has been called, and is updated
+   * as datagrams are received.
+   */
+  uint32_t kernel_drops;
+};
+
 /**
  * @brief The interface for UDPSockets.
  *
@@ -132,6 +183,18 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
   virtual ssize_t SendTo(ola::io::IOVecInterface *data,
                          const IPV4SocketAddress &dest) const = 0;
 
+  /**
+   * @brief Send multiple datagrams.
+   * @param datagrams an array of count datagrams to send.
+   * @param count the number of entries in datagrams.
+   * @returns the number of datagrams sent. If this is less than count, an
+   *   error occurred.
+   *
+   * The default implementation calls SendTo() for each datagram.
+   */
+  virtual unsigned int SendBatch(const UDPDatagram *datagrams,
+                                 unsigned int count) const;
+
   /**
    * @brief Receive data
    * @param buffer the buffer to store the data
@@ -185,6 +248,20 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
                         ssize_t *data_read,
                         IPV4SocketAddress *source) = 0;
 
+  /**
+   * @brief Receive up to count datagrams on the UDP Socket.
+   * @param datagrams an array of count datagram buffers. The length of each
+   *   buffer is updated with the number of bytes read.
+   * @param count the number of entries in datagrams.
+   * @returns the number of datagrams received, which may be 0.
+   *
+   * This should only be called once the socket is ready to read. It waits
+   * for the first datagram and then returns as many of the queued datagrams
+   * as will fit without blocking. The default implementation receives a
+   * single datagram with RecvFrom().
+   */
+  virtual unsigned int RecvBatch(UDPDatagram *datagrams, unsigned int count);
+
   /**
    * @brief Enable broadcasting for this socket.
    * @return true if it worked, false otherwise
@@ -224,6 +301,68 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
    */
   virtual bool SetTos(uint8_t tos) = 0;
 
+  /**
+   * @brief Ask the kernel to timestamp received datagrams.
+   * @return true if timestamps will be provided by RecvBatch(), false
+   * otherwise.
+   *
+   * The default implementation doesn't support timestamps.
+   */
+  virtual bool EnableReceiveTimestamps() { return false; }
+
+  /**
+   * @brief Set the size of the kernel receive buffer for this socket.
+   * @param size the size in bytes, the kernel may adjust this.
+   * @return true if it worked, false otherwise
+   *
+   * The default implementation doesn't support changing the buffer size.
+   */
+  virtual bool SetReceiveBufferSize(unsigned int size) {
+    (void) size;
+    return false;
+  }
+
+  /**
+   * @brief Set the size of the kernel send buffer for this socket.
+   * @param size the size in bytes, the kernel may adjust this.
+   * @return true if it worked, false otherwise
+   *
+   * The default implementation doesn't support changing the buffer size.
+   */
+  virtual bool SetSendBufferSize(unsigned int size) {
+    (void) size;
+    return false;
+  }
+
+  /**
+   * @brief Ask the kernel to report the datagrams it drops for this socket.
+   * @return true if UDPSocketStats::kernel_drops will be updated, false
+   * otherwise.
+   *
+   * The default implementation doesn't support counting drops.
+   */
+  virtual bool EnableDropCounting() { return false; }
+
+  /**
+   * @brief Return the traffic counters for this socket.
+   *
+   * The default implementation doesn't count anything.
+   */
+  virtual UDPSocketStats Stats() const { return UDPSocketStats(); }
+
+  /**
+   * @brief Only deliver multicast datagrams for the groups this socket has
+   * joined.
+   * @return true if the socket only receives the groups it joined, false
+   * otherwise.
+   *
+   * On Linux a socket bound to the wildcard address receives the datagrams
+   * for any group joined on the host, by any socket bound to the same port.
+   * This must be called if several sockets share a port, each with their own
+   * groups. The default implementation doesn't support it.
+   */
+  virtual bool ReceiveOnlyJoinedGroups() { return false; }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(UDPSocketInterface);
 };
@@ -237,7 +376,9 @@ class UDPSocket: public UDPSocketInterface {
   UDPSocket()
       : UDPSocketInterface(),
         m_handle(ola::io::INVALID_DESCRIPTOR),
-        m_bound_to_port(false) {}
+        m_bound_to_port(false),
+        m_receive_timestamps(false),
+        m_count_drops(false) {}
   ~UDPSocket() { Close(); }
   bool Init();
   bool Bind(const IPV4SocketAddress &endpoint);
@@ -259,6 +400,8 @@ class UDPSocket: public UDPSocketInterface {
                  unsigned short port) const;
   ssize_t SendTo(ola::io::IOVecInterface *data,
                  const IPV4SocketAddress &dest) const;
+  unsigned int SendBatch(const UDPDatagram *datagrams,
+                         unsigned int count) const;
 
   bool RecvFrom(uint8_t *buffer, ssize_t *data_read) const;
   bool RecvFrom(uint8_t *buffer,
@@ -273,6 +416,8 @@ class UDPSocket: public UDPSocketInterface {
                 ssize_t *data_read,
                 IPV4SocketAddress *source);
 
+  unsigned int RecvBatch(UDPDatagram *datagrams, unsigned int count);
+
   bool EnableBroadcast();
   bool SetMulticastInterface(const IPV4Address &iface);
   bool JoinMulticast(const IPV4Address &iface,
@@ -283,9 +428,24 @@ class UDPSocket: public UDPSocketInterface {
 
   bool SetTos(uint8_t tos);
 
+  bool EnableReceiveTimestamps();
+  bool SetReceiveBufferSize(unsigned int size);
+  bool SetSendBufferSize(unsigned int size);
+  bool ReceiveOnlyJoinedGroups();
+  bool EnableDropCounting();
+  UDPSocketStats Stats() const { return m_stats; }
+
  private:
   ola::io::DescriptorHandle m_handle;
   bool m_bound_to_port;
+  bool m_receive_timestamps;
+  bool m_count_drops;
+  // Updated by the const send and receive methods.
+  mutable UDPSocketStats m_stats;
+
+  void RecordReceived(ssize_t length) const;
+  void RecordSent(ssize_t length) const;
+  uint32_t *DropCounter() const;
 
   DISALLOW_COPY_AND_ASSIGN(UDPSocket);
 };
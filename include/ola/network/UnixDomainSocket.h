@@ -0,0 +1,121 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * UnixDomainSocket.h
+ * Stream sockets in the AF_UNIX domain.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * UnixDomainSocket is a connection to a local endpoint, identified by a path.
+ * UnixDomainAcceptingSocket listens on a path and accepts new connections.
+ *
+ * These aren't available on Windows.
+ */
+
+#ifndef INCLUDE_OLA_NETWORK_UNIXDOMAINSOCKET_H_
+#define INCLUDE_OLA_NETWORK_UNIXDOMAINSOCKET_H_
+
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/io/Descriptor.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+
+namespace ola {
+namespace network {
+
+/*
+ * A connected AF_UNIX stream socket.
+ */
+class UnixDomainSocket: public ola::io::ConnectedDescriptor {
+ public:
+  explicit UnixDomainSocket(int sd);
+
+  ~UnixDomainSocket() { Close(); }
+
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_handle; }
+  ola::io::DescriptorHandle WriteDescriptor() const { return m_handle; }
+  bool Close();
+
+  /**
+   * @brief Connect to a listening socket.
+   * @param path the path of the socket.
+   * @returns a new UnixDomainSocket, or NULL if the connection failed.
+   */
+  static UnixDomainSocket* Connect(const std::string &path);
+
+  /**
+   * @brief Get the user id of the process at the other end of the socket.
+   * @param[out] uid the user id of the peer.
+   * @returns true if the user id was found, false otherwise.
+   */
+  bool PeerUid(uid_t *uid) const;
+
+ protected:
+  bool IsSocket() const { return true; }
+
+ private:
+  ola::io::DescriptorHandle m_handle;
+
+  DISALLOW_COPY_AND_ASSIGN(UnixDomainSocket);
+};
+
+
+/*
+ * An AF_UNIX accepting socket.
+ */
+class UnixDomainAcceptingSocket: public ola::io::ReadFileDescriptor {
+ public:
+  typedef ola::Callback1<void, UnixDomainSocket*> AcceptCallback;
+
+  /**
+   * @brief Create a new UnixDomainAcceptingSocket.
+   * @param on_accept the callback to run for each new connection, ownership
+   *   is transferred. The callback takes ownership of the socket.
+   */
+  explicit UnixDomainAcceptingSocket(AcceptCallback *on_accept);
+  ~UnixDomainAcceptingSocket();
+
+  /**
+   * @brief Start listening.
+   * @param path the path to listen on.
+   * @param backlog the listen backlog.
+   * @returns true if it succeeded, false otherwise.
+   *
+   * If there is already a socket at the path, it's assumed to be stale and
+   * removed. The path is removed when the socket is closed.
+   */
+  bool Listen(const std::string &path, int backlog = 10);
+
+  ola::io::DescriptorHandle ReadDescriptor() const { return m_handle; }
+  bool Close();
+  void PerformRead();
+
+  /**
+   * @brief The path this socket is listening on.
+   */
+  const std::string &Path() const { return m_path; }
+
+ private:
+  ola::io::DescriptorHandle m_handle;
+  std::string m_path;
+  std::auto_ptr<AcceptCallback> m_on_accept;
+
+  DISALLOW_COPY_AND_ASSIGN(UnixDomainAcceptingSocket);
+};
+}  // namespace network
+}  // namespace ola
+#endif  // INCLUDE_OLA_NETWORK_UNIXDOMAINSOCKET_H_
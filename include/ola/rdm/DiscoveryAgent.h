@@ -167,6 +167,17 @@ class DiscoveryAgent {
    */
   void StartIncrementalDiscovery(DiscoveryCompleteCallback *on_complete);
 
+  /**
+   * @brief Set the UIDs the next incremental discovery will check.
+   * @param uids the UIDs, usually the ones found before a restart.
+   *
+   * Incremental discovery mutes each known UID, rather than searching for it,
+   * so once the known responders have been muted a single DUB is enough to
+   * show there are no new ones. Responders that don't answer the mute are
+   * dropped. This is ignored if discovery is already running.
+   */
+  void SetKnownUIDs(const UIDSet &uids);
+
  private:
   /**
    * @brief Represents a range of UIDs (a branch of the UID tree)
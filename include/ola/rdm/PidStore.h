@@ -230,9 +230,11 @@ class PidStore {
   const PidDescriptor *LookupPID(const std::string &pid_name) const;
 
  private:
-  typedef std::map<uint16_t, const PidDescriptor*> PidMap;
+  // Sorted by PID. Lookups by PID happen for each RDM message that's
+  // printed, and a binary search over a vector avoids chasing map nodes.
+  typedef std::vector<const PidDescriptor*> PidVector;
   typedef std::map<std::string, const PidDescriptor*> PidNameMap;
-  PidMap m_pid_by_value;
+  PidVector m_pid_by_value;
   PidNameMap m_pid_by_name;
 
   DISALLOW_COPY_AND_ASSIGN(PidStore);
@@ -14,7 +14,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  *
  * QueueingRDMController.h
- * A RDM Controller that sends a single message at a time.
+ * A RDM Controller that limits the number of messages in flight.
  * Copyright (C) 2010 Simon Newton
  */
 
@@ -22,15 +22,16 @@
  * @addtogroup rdm_controller
  * @{
  * @file QueueingRDMController.h
- * @brief An RDM Controller that queues messages and only sends a single message
- * at a time.
+ * @brief An RDM Controller that queues messages and limits the number of
+ * messages in flight.
  * @}
  */
 #ifndef INCLUDE_OLA_RDM_QUEUEINGRDMCONTROLLER_H_
 #define INCLUDE_OLA_RDM_QUEUEINGRDMCONTROLLER_H_
 
 #include <ola/rdm/RDMControllerInterface.h>
-#include <queue>
+#include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -39,13 +40,20 @@ namespace ola {
 namespace rdm {
 
 /*
- * A RDM controller that only sends a single request at a time. This also
- * handles timing out messages that we don't get a response for.
+ * A RDM controller that queues requests and sends them to the underlying
+ * controller. This also handles ACK_OVERFLOW sequences.
+ *
+ * By default only a single request is sent at a time. If the underlying
+ * controller can have more than one transaction outstanding, max_in_flight
+ * allows requests to different responders to overlap. Requests to the same
+ * UID are always sent in order, one at a time, and broadcast requests are
+ * never overlapped with anything else.
  */
 class QueueingRDMController: public RDMControllerInterface {
  public:
     QueueingRDMController(RDMControllerInterface *controller,
-                          unsigned int max_queue_size);
+                          unsigned int max_queue_size,
+                          unsigned int max_in_flight = 1);
     ~QueueingRDMController();
 
     void Pause();
@@ -60,22 +68,41 @@ class QueueingRDMController: public RDMControllerInterface {
       RDMCallback *on_complete;
     } outstanding_rdm_request;
 
+    /*
+     * A request that has been sent to the underlying controller, along with
+     * the state of any ACK_OVERFLOW sequence.
+     */
+    class InFlightRequest {
+     public:
+      explicit InFlightRequest(const outstanding_rdm_request &request)
+          : outstanding(request) {
+      }
+
+      outstanding_rdm_request outstanding;
+      std::auto_ptr<ola::rdm::RDMResponse> response;
+      std::vector<RDMFrame> frames;
+    };
+
+    typedef std::deque<outstanding_rdm_request> PendingRequests;
+    typedef std::vector<InFlightRequest*> InFlightRequests;
+
     RDMControllerInterface *m_controller;
     unsigned int m_max_queue_size;
-    std::queue<outstanding_rdm_request> m_pending_requests;
-    bool m_rdm_request_pending;  // true if a request is in progress
+    const unsigned int m_max_in_flight;
+    PendingRequests m_pending_requests;
+    InFlightRequests m_in_flight;  // requests sent to m_controller
     bool m_active;  // true if the controller is active
-    std::auto_ptr<RDMCallback> m_callback;
-    std::auto_ptr<ola::rdm::RDMResponse> m_response;
-    std::vector<RDMFrame> m_frames;
 
     virtual void TakeNextAction();
     virtual bool CheckForBlockingCondition();
     void MaybeSendRDMRequest();
-    void DispatchNextRequest();
+    void DispatchRequest(InFlightRequest *in_flight);
+
+    void HandleRDMResponse(InFlightRequest *in_flight, RDMReply *reply);
+    void RunCallback(InFlightRequest *in_flight, RDMReply *reply);
 
-    void HandleRDMResponse(RDMReply *reply);
-    void RunCallback(RDMReply *reply);
+ private:
+    PendingRequests::iterator NextSendableRequest();
 };
 
 
@@ -83,13 +110,16 @@ class QueueingRDMController: public RDMControllerInterface {
  * The DiscoverableQueueingRDMController also handles discovery, and ensures
  * that only a single discovery or RDM request sequence occurs at once.
  *
- * In this model, discovery has a higher precedence than RDM messages.
+ * In this model, discovery has a higher precedence than RDM messages. Once
+ * discovery has been requested no more RDM requests are sent, and discovery
+ * starts when all the requests in flight have completed.
  */
 class DiscoverableQueueingRDMController: public QueueingRDMController {
  public:
     DiscoverableQueueingRDMController(
         DiscoverableRDMControllerInterface *controller,
-        unsigned int max_queue_size);
+        unsigned int max_queue_size,
+        unsigned int max_in_flight = 1);
 
     ~DiscoverableQueueingRDMController() {}
 
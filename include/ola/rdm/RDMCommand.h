@@ -219,6 +219,10 @@ class RDMCommand {
   uint16_t m_param_id;
   uint8_t *m_data;
   unsigned int m_data_length;
+  // Param data up to this size is stored in the command itself, this saves
+  // an allocation for DUBs and most GETs.
+  enum { INLINE_DATA_SIZE = 16 };
+  uint8_t m_inline_data[INLINE_DATA_SIZE];
 
   static uint16_t CalculateChecksum(const uint8_t *data,
                                     unsigned int packet_length);
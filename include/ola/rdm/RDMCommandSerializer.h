@@ -89,6 +89,22 @@ class RDMCommandSerializer {
                    uint8_t *buffer,
                    unsigned int *size);
 
+  /**
+   * @brief Serialize a RDMCommand to an array of bytes, with the RDM Start
+   *   Code.
+   * @param command the RDMCommand to serialize.
+   * @param buffer The memory location to serailize to.
+   * @param[in,out] size The size of the memory location.
+   * @returns True if the command was serialized correctly, false otherwise.
+   *
+   * Along with Pack(), this lets a widget build its frame in a buffer on the
+   * stack: leave room for the widget's header, then pack the command after
+   * it. A buffer of MAX_PACKED_SIZE + 1 bytes always fits the command.
+   */
+  static bool PackWithStartCode(const RDMCommand &command,
+                                uint8_t *buffer,
+                                unsigned int *size);
+
   // TODO(simon): Add IOQueue Write() method here
 
   /**
@@ -105,6 +121,12 @@ class RDMCommandSerializer {
    */
   enum { MAX_PARAM_DATA_LENGTH = 231 };
 
+  /**
+   * @brief The largest value RequiredSize() returns, i.e. the size of a
+   * command with MAX_PARAM_DATA_LENGTH bytes of parameter data.
+   */
+  enum { MAX_PACKED_SIZE = 256 };
+
  private:
   static const unsigned int CHECKSUM_LENGTH = 2;
 
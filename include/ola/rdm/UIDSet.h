@@ -32,8 +32,9 @@
 #include <ola/rdm/UID.h>
 #include <algorithm>
 #include <iomanip>
-#include <set>
+#include <iterator>
 #include <string>
+#include <vector>
 
 namespace ola {
 namespace rdm {
@@ -43,6 +44,13 @@ namespace rdm {
  * @{
  * @class UIDSet
  * @brief Represents a set of RDM UIDs.
+ *
+ * The UIDs are held in a sorted vector, so iteration is over contiguous
+ * memory, lookups are O(log n) and Union(), SetDifference() &
+ * Intersection() are linear merges. Adding or removing a single UID is O(n),
+ * which is cheap for the few thousand UIDs found on a port.
+ *
+ * Adding or removing UIDs invalidates any Iterators.
  * @}
  */
 class UIDSet {
@@ -50,7 +58,7 @@ class UIDSet {
     /**
      * @brief the Iterator for a UIDSets
      */
-    typedef std::set<UID>::const_iterator Iterator;
+    typedef std::vector<UID>::const_iterator Iterator;
 
     /**
      * @brief Construct an empty set
@@ -103,7 +111,11 @@ class UIDSet {
      * @param uid the UID to add.
      */
     void AddUID(const UID &uid) {
-      m_uids.insert(uid);
+      std::vector<UID>::iterator iter = std::lower_bound(
+          m_uids.begin(), m_uids.end(), uid);
+      if (iter == m_uids.end() || uid < *iter) {
+        m_uids.insert(iter, uid);
+      }
     }
 
     /**
@@ -111,7 +123,11 @@ class UIDSet {
      * @param uid the UID to remove.
      */
     void RemoveUID(const UID &uid) {
-      m_uids.erase(uid);
+      std::vector<UID>::iterator iter = std::lower_bound(
+          m_uids.begin(), m_uids.end(), uid);
+      if (iter != m_uids.end() && *iter == uid) {
+        m_uids.erase(iter);
+      }
     }
 
     /**
@@ -120,7 +136,7 @@ class UIDSet {
      * @return true if the set contains this UID.
      */
     bool Contains(const UID &uid) const {
-      return m_uids.find(uid) != m_uids.end();
+      return std::binary_search(m_uids.begin(), m_uids.end(), uid);
     }
 
     /**
@@ -128,14 +144,31 @@ class UIDSet {
      * @param other the UIDSet to perform the union with.
      * @return the union of the two UIDSets.
      */
-    UIDSet Union(const UIDSet &other) {
-      std::set<UID> result;
-      set_union(m_uids.begin(),
-                m_uids.end(),
-                other.Begin(),
-                other.End(),
-                inserter(result, result.begin()));
-      return UIDSet(result);
+    UIDSet Union(const UIDSet &other) const {
+      UIDSet result;
+      result.m_uids.reserve(m_uids.size() + other.m_uids.size());
+      std::set_union(m_uids.begin(),
+                     m_uids.end(),
+                     other.m_uids.begin(),
+                     other.m_uids.end(),
+                     std::back_inserter(result.m_uids));
+      return result;
+    }
+
+    /**
+     * @brief Return the UIDs that are in both this set and another UIDSet.
+     * @param other the UIDSet to perform the intersection with.
+     * @return the intersection of the two UIDSets.
+     */
+    UIDSet Intersection(const UIDSet &other) const {
+      UIDSet result;
+      result.m_uids.reserve(std::min(m_uids.size(), other.m_uids.size()));
+      std::set_intersection(m_uids.begin(),
+                            m_uids.end(),
+                            other.m_uids.begin(),
+                            other.m_uids.end(),
+                            std::back_inserter(result.m_uids));
+      return result;
     }
 
     /**
@@ -157,14 +190,15 @@ class UIDSet {
      * @param other the UIDSet to subtract from this set.
      * @return the difference between this UIDSet and other.
      */
-    UIDSet SetDifference(const UIDSet &other) {
-      std::set<UID> difference;
+    UIDSet SetDifference(const UIDSet &other) const {
+      UIDSet result;
+      result.m_uids.reserve(m_uids.size());
       std::set_difference(m_uids.begin(),
                           m_uids.end(),
                           other.m_uids.begin(),
                           other.m_uids.end(),
-                          std::inserter(difference, difference.begin()));
-      return UIDSet(difference);
+                          std::back_inserter(result.m_uids));
+      return result;
     }
 
     /**
@@ -189,7 +223,7 @@ class UIDSet {
      */
     std::string ToString() const {
       std::ostringstream str;
-      std::set<UID>::const_iterator iter;
+      Iterator iter;
       for (iter = m_uids.begin(); iter != m_uids.end(); ++iter) {
         if (iter != m_uids.begin())
           str << ",";
@@ -208,11 +242,7 @@ class UIDSet {
     }
 
  private:
-    std::set<UID> m_uids;
-
-    explicit UIDSet(const std::set<UID> uids) {
-      m_uids = uids;
-    }
+    std::vector<UID> m_uids;
 };
 }  // namespace rdm
 }  // namespace ola
@@ -511,6 +511,33 @@ void STLMapFromKeys(T1 *output, const T2 input,
     }
   }
 }
+
+/**
+ * @brief Estimate the heap memory used by a node based container.
+ * @tparam T A map or set.
+ * @param container the container.
+ * @returns the size of the nodes, this doesn't include any memory owned by
+ *   the elements themselves.
+ *
+ * Each node of a red-black tree holds the value, three pointers and the
+ * colour, which is padded to the size of a pointer.
+ */
+template<typename T>
+size_t STLNodeMemoryUsage(const T &container) {
+  return container.size() * (sizeof(typename T::value_type) +
+                             4 * sizeof(void*));
+}
+
+/**
+ * @brief Estimate the heap memory used by a vector.
+ * @tparam T A vector.
+ * @param container the vector.
+ * @returns the size of the allocated storage.
+ */
+template<typename T>
+size_t STLVectorMemoryUsage(const T &container) {
+  return container.capacity() * sizeof(typename T::value_type);
+}
 }  // namespace ola
 #endif  // INCLUDE_OLA_STL_STLUTILS_H_
 /**
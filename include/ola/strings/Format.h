@@ -38,6 +38,20 @@
 namespace ola {
 namespace strings {
 
+/**
+ * @brief The most characters FormatUnsigned() writes.
+ */
+static const unsigned int MAX_UNSIGNED_DIGITS = 10;
+
+/**
+ * @brief Write an unsigned int in decimal, without allocating.
+ * @param value the value to write
+ * @param buffer where to write the digits, this needs room for
+ *   MAX_UNSIGNED_DIGITS characters. The output isn't NULL terminated.
+ * @return a pointer to one past the last character written.
+ */
+char *FormatUnsigned(unsigned int value, char *buffer);
+
 /**
  * @brief Convert an int to a string.
  * @param i the int to convert
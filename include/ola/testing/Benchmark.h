@@ -0,0 +1,127 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * Benchmark.h
+ * A minimal microbenchmark framework.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_TESTING_BENCHMARK_H_
+#define INCLUDE_OLA_TESTING_BENCHMARK_H_
+
+#include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace testing {
+
+/*
+ * Passed to each benchmark function. The function should run the code being
+ * measured Iterations() times, e.g.
+ *
+ *   void BenchmarkFoo(BenchmarkState *state) {
+ *     Foo foo;  // setup isn't timed until the loop starts
+ *     state->StartTiming();
+ *     for (uint64_t i = 0; i < state->Iterations(); i++) {
+ *       DoNotOptimize(foo.Bar());
+ *     }
+ *   }
+ *   OLA_BENCHMARK(BenchmarkFoo);
+ *
+ * If StartTiming() isn't called the whole function is timed.
+ */
+class BenchmarkState {
+ public:
+  explicit BenchmarkState(uint64_t iterations);
+
+  uint64_t Iterations() const { return m_iterations; }
+
+  /*
+   * Reset the timer, so the setup before this isn't counted.
+   */
+  void StartTiming();
+
+  /*
+   * Stop and restart the timer, for per-iteration setup that shouldn't be
+   * counted. These are relatively expensive, so use them sparingly.
+   */
+  void PauseTiming();
+  void ResumeTiming();
+
+  /*
+   * Set the number of bytes processed by all the iterations, this is used to
+   * report the throughput.
+   */
+  void SetBytesProcessed(uint64_t bytes) { m_bytes_processed = bytes; }
+  uint64_t BytesProcessed() const { return m_bytes_processed; }
+
+  /*
+   * Called by the runner once the function returns.
+   */
+  void StopTiming();
+  TimeInterval Elapsed() const { return m_elapsed; }
+
+ private:
+  const uint64_t m_iterations;
+  uint64_t m_bytes_processed;
+  bool m_running;
+  Clock m_clock;
+  TimeStamp m_start;
+  TimeInterval m_elapsed;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkState);
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState *state);
+
+/*
+ * Adds a benchmark to the global list, use OLA_BENCHMARK() below.
+ */
+class BenchmarkRegistration {
+ public:
+  BenchmarkRegistration(const char *name, BenchmarkFunction function);
+};
+
+/*
+ * Stop the compiler from optimizing away a value that's otherwise unused.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+#else
+void UseCharPointer(char const volatile *pointer);
+
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  UseCharPointer(&reinterpret_cast<char const volatile&>(value));
+}
+#endif  // defined(__GNUC__) || defined(__clang__)
+
+/*
+ * Run the benchmarks that match the --benchmark_filter flag.
+ * @returns the exit code for the program.
+ */
+int RunBenchmarks();
+}  // namespace testing
+}  // namespace ola
+
+#define OLA_BENCHMARK(function) \
+  static ola::testing::BenchmarkRegistration \
+      benchmark_registration_##function(#function, function)
+
+#endif  // INCLUDE_OLA_TESTING_BENCHMARK_H_
@@ -0,0 +1,161 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FramePacer.h
+ * Sleeps until absolute deadlines, so output threads can send frames at a
+ * steady rate.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_FRAMEPACER_H_
+#define INCLUDE_OLA_THREAD_FRAMEPACER_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Paces the frames sent by an output thread.
+ *
+ * Sleeping with usleep() for each part of a frame means every overshoot adds
+ * to the frame time. Instead, the FramePacer measures each sleep from the
+ * start of the frame and sleeps until that deadline on the monotonic clock.
+ * Frames are scheduled one frame time apart, so a late wakeup doesn't delay
+ * the following frames.
+ *
+ * The scheduler may wake us late by more than the time we want to wait (the
+ * MAB is only 16us). If a spin time is set, the pacer sleeps until the
+ * deadline minus the spin time and then busy waits for the rest.
+ *
+ * A thread that drives several outputs can give each output its own
+ * FramePacer, for the frame schedule and statistics, and sleep until the
+ * earliest deadline with SleepUntilTime().
+ *
+ * All methods other than GetStats() should be called from the output thread.
+ */
+class FramePacer {
+ public:
+  /**
+   * @brief A time on the monotonic clock, in nanoseconds.
+   */
+  typedef int64_t Nanoseconds;
+
+  /**
+   * @brief Frame statistics, these are updated once a second.
+   */
+  struct Stats {
+    double frame_rate;  /**< Frames per second */
+    unsigned int mean_jitter;  /**< The mean frame start error, in us */
+    unsigned int max_jitter;  /**< The max frame start error, in us */
+    uint64_t frames;  /**< The total number of frames */
+    uint64_t overruns;  /**< Frames that started a whole frame late */
+
+    Stats()
+        : frame_rate(0),
+          mean_jitter(0),
+          max_jitter(0),
+          frames(0),
+          overruns(0) {
+    }
+  };
+
+  /**
+   * @brief Create a new FramePacer.
+   * @param spin_time the time to busy wait for before each deadline, in
+   *   microseconds. 0 disables busy waiting.
+   */
+  explicit FramePacer(unsigned int spin_time = 0);
+
+  /**
+   * @brief Start a new frame.
+   * @param frame_time the time until the next frame should start, in
+   *   microseconds. 0 means the frame ends once WaitForFrameEnd() is called.
+   */
+  void StartFrame(unsigned int frame_time);
+
+  /**
+   * @brief Sleep until a time after the start of the frame.
+   * @param offset the time in microseconds from the start of the frame.
+   */
+  void SleepUntil(unsigned int offset);
+
+  /**
+   * @brief Sleep for a time after now.
+   * @param delay the time to sleep for, in microseconds.
+   *
+   * This still uses the monotonic clock & the spin time, so it's more
+   * precise than usleep().
+   */
+  void Sleep(unsigned int delay);
+
+  /**
+   * @brief Sleep until the frame time passed to StartFrame() has elapsed.
+   */
+  void WaitForFrameEnd();
+
+  /**
+   * @brief Sleep until a time on the monotonic clock.
+   * @param deadline the time, see Now().
+   */
+  void SleepUntilTime(Nanoseconds deadline);
+
+  /**
+   * @brief The time the next frame should start, or 0 if there isn't a frame
+   *   time.
+   */
+  Nanoseconds NextFrame() const { return m_next_frame; }
+
+  /**
+   * @brief Get the frame statistics, this can be called from any thread.
+   * @param[out] stats the statistics.
+   */
+  void GetStats(Stats *stats) const;
+
+  /**
+   * @brief The current time on the monotonic clock.
+   */
+  static Nanoseconds Now();
+
+  static const Nanoseconds NANOSECONDS_IN_MICROSECOND = 1000;
+  static const Nanoseconds NANOSECONDS_IN_SECOND = 1000000000;
+
+ private:
+  const Nanoseconds m_spin_time;
+  Nanoseconds m_frame_start;
+  Nanoseconds m_next_frame;
+  bool m_started;
+
+  // The stats for the current window.
+  Nanoseconds m_window_start;
+  unsigned int m_window_frames;
+  uint64_t m_window_jitter;
+  unsigned int m_window_max_jitter;
+
+  mutable Mutex m_stats_mutex;
+  Stats m_stats;
+
+  void UpdateStats(Nanoseconds now, Nanoseconds jitter, bool overrun);
+
+  static void ToTimeSpec(Nanoseconds time, struct timespec *spec);
+
+  DISALLOW_COPY_AND_ASSIGN(FramePacer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_FRAMEPACER_H_
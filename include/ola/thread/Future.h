@@ -21,13 +21,37 @@
 #ifndef INCLUDE_OLA_THREAD_FUTURE_H_
 #define INCLUDE_OLA_THREAD_FUTURE_H_
 
+#include <ola/Callback.h>
+#include <ola/thread/ExecutorInterface.h>
 #include <ola/thread/FuturePrivate.h>
+#include <ola/thread/Mutex.h>
+
+#include <vector>
 
 namespace ola {
 namespace thread {
 
+template <typename T, typename R>
+class FutureThen;
+
+template <typename R>
+class VoidFutureThen;
+
 /**
  * A Future object
+ *
+ * Rather than blocking in Get(), a continuation can be attached with Then().
+ * The continuation is run once the value is set, either on an executor, or
+ * if the executor is NULL, in the thread that calls Set(). The callbacks
+ * passed to Then() must be single use, i.e. created with NewSingleCallback().
+ *
+ * @examplepara
+ *   @code
+ *   int Double(const int &i) { return 2 * i; }
+ *
+ *   Future<int> f = thread_pool.Submit(...);
+ *   Future<int> doubled = f.Then(&executor, NewSingleCallback(&Double));
+ *   @endcode
  */
 template <typename T>
 class Future {
@@ -63,6 +87,24 @@ class Future {
       m_impl->Set(t);
     }
 
+    /**
+     * @brief Run a callback with the value once it's set.
+     * @param executor the executor to run the callback on, or NULL to run it
+     *   in the thread that sets the value.
+     * @param callback the callback to run, ownership is transferred.
+     * @returns A Future that's set to the value returned by the callback.
+     *
+     * If the value is already set, the callback is dispatched straight away.
+     */
+    template <typename R>
+    Future<R> Then(ExecutorInterface *executor,
+                   BaseCallback1<R, const T&> *callback) {
+      Future<R> result;
+      m_impl->AddContinuation(executor,
+                              new FutureThen<T, R>(callback, result));
+      return result;
+    }
+
  private:
     class FutureImpl<T> *m_impl;
 };
@@ -104,9 +146,399 @@ class Future<void> {
       m_impl->Set();
     }
 
+    /**
+     * @brief Run a callback once this future completes.
+     * @param executor the executor to run the callback on, or NULL to run it
+     *   in the thread that completes the future.
+     * @param callback the callback to run, ownership is transferred.
+     * @returns A Future that's set to the value returned by the callback.
+     */
+    template <typename R>
+    Future<R> Then(ExecutorInterface *executor, BaseCallback0<R> *callback) {
+      Future<R> result;
+      m_impl->AddContinuation(executor,
+                              new VoidFutureThen<R>(callback, result));
+      return result;
+    }
+
  private:
     class FutureImpl<void> *m_impl;
 };
+
+
+/*
+ * Run a continuation and pass the result on. The continuation owns the
+ * callback, so if it's deleted without being run, the callback is deleted
+ * too.
+ */
+template <typename T, typename R>
+class FutureThen : public SingleUseCallback1<void, const T&> {
+ public:
+  FutureThen(BaseCallback1<R, const T&> *callback, const Future<R> &result)
+      : m_callback(callback),
+        m_result(result) {
+  }
+
+  ~FutureThen() { delete m_callback; }
+
+ private:
+  BaseCallback1<R, const T&> *m_callback;
+  Future<R> m_result;
+
+  void DoRun(const T &value) {
+    BaseCallback1<R, const T&> *callback = m_callback;
+    m_callback = NULL;
+    m_result.Set(callback->Run(value));
+  }
+};
+
+template <typename T>
+class FutureThen<T, void> : public SingleUseCallback1<void, const T&> {
+ public:
+  FutureThen(BaseCallback1<void, const T&> *callback,
+             const Future<void> &result)
+      : m_callback(callback),
+        m_result(result) {
+  }
+
+  ~FutureThen() { delete m_callback; }
+
+ private:
+  BaseCallback1<void, const T&> *m_callback;
+  Future<void> m_result;
+
+  void DoRun(const T &value) {
+    BaseCallback1<void, const T&> *callback = m_callback;
+    m_callback = NULL;
+    callback->Run(value);
+    m_result.Set();
+  }
+};
+
+template <typename R>
+class VoidFutureThen : public SingleUseCallback0<void> {
+ public:
+  VoidFutureThen(BaseCallback0<R> *callback, const Future<R> &result)
+      : m_callback(callback),
+        m_result(result) {
+  }
+
+  ~VoidFutureThen() { delete m_callback; }
+
+ private:
+  BaseCallback0<R> *m_callback;
+  Future<R> m_result;
+
+  void DoRun() {
+    BaseCallback0<R> *callback = m_callback;
+    m_callback = NULL;
+    m_result.Set(callback->Run());
+  }
+};
+
+template <>
+class VoidFutureThen<void> : public SingleUseCallback0<void> {
+ public:
+  VoidFutureThen(BaseCallback0<void> *callback, const Future<void> &result)
+      : m_callback(callback),
+        m_result(result) {
+  }
+
+  ~VoidFutureThen() { delete m_callback; }
+
+ private:
+  BaseCallback0<void> *m_callback;
+  Future<void> m_result;
+
+  void DoRun() {
+    BaseCallback0<void> *callback = m_callback;
+    m_callback = NULL;
+    callback->Run();
+    m_result.Set();
+  }
+};
+
+
+/*
+ * The continuation WhenAll() and WhenAny() add to each future. The state is
+ * released once per future, either when the future completes or, if the
+ * future is destroyed without being set, when the continuation is deleted.
+ */
+template <typename State, typename T>
+class WhenContinuation : public SingleUseCallback1<void, const T&> {
+ public:
+  WhenContinuation(State *state, unsigned int index)
+      : m_state(state),
+        m_index(index) {
+  }
+
+  ~WhenContinuation() {
+    if (m_state) {
+      State::Release(m_state, false);
+    }
+  }
+
+ private:
+  State *m_state;
+  const unsigned int m_index;
+
+  void DoRun(const T &value) {
+    State *state = m_state;
+    m_state = NULL;
+    State::Complete(state, m_index, value);
+  }
+};
+
+template <typename State>
+class WhenVoidContinuation : public SingleUseCallback0<void> {
+ public:
+  WhenVoidContinuation(State *state, unsigned int index)
+      : m_state(state),
+        m_index(index) {
+  }
+
+  ~WhenVoidContinuation() {
+    if (m_state) {
+      State::Release(m_state, false);
+    }
+  }
+
+ private:
+  State *m_state;
+  const unsigned int m_index;
+
+  void DoRun() {
+    State *state = m_state;
+    m_state = NULL;
+    State::CompleteVoid(state, m_index);
+  }
+};
+
+
+/*
+ * The state shared by the continuations for WhenAll(). This is deleted once
+ * all the futures complete or are destroyed. If any are destroyed without
+ * being set, the result never completes.
+ */
+template <typename T>
+class WhenAllState {
+ public:
+  explicit WhenAllState(unsigned int count)
+      : m_remaining(count),
+        m_abandoned(false),
+        m_values(count) {
+  }
+
+  Future<std::vector<T> > Result() const { return m_result; }
+
+  static void Complete(WhenAllState<T> *state, unsigned int index,
+                       const T &value) {
+    {
+      MutexLocker lock(&state->m_mutex);
+      state->m_values[index] = value;
+    }
+    Release(state, true);
+  }
+
+  static void Release(WhenAllState<T> *state, bool completed) {
+    {
+      MutexLocker lock(&state->m_mutex);
+      state->m_abandoned |= !completed;
+      if (--state->m_remaining) {
+        return;
+      }
+    }
+    if (!state->m_abandoned) {
+      state->m_result.Set(state->m_values);
+    }
+    delete state;
+  }
+
+ private:
+  Mutex m_mutex;
+  unsigned int m_remaining;
+  bool m_abandoned;
+  std::vector<T> m_values;
+  Future<std::vector<T> > m_result;
+
+  DISALLOW_COPY_AND_ASSIGN(WhenAllState<T>);
+};
+
+class WhenAllVoidState {
+ public:
+  explicit WhenAllVoidState(unsigned int count)
+      : m_remaining(count),
+        m_abandoned(false) {
+  }
+
+  Future<void> Result() const { return m_result; }
+
+  static void CompleteVoid(WhenAllVoidState *state, unsigned int) {
+    Release(state, true);
+  }
+
+  static void Release(WhenAllVoidState *state, bool completed) {
+    {
+      MutexLocker lock(&state->m_mutex);
+      state->m_abandoned |= !completed;
+      if (--state->m_remaining) {
+        return;
+      }
+    }
+    if (!state->m_abandoned) {
+      state->m_result.Set();
+    }
+    delete state;
+  }
+
+ private:
+  Mutex m_mutex;
+  unsigned int m_remaining;
+  bool m_abandoned;
+  Future<void> m_result;
+
+  DISALLOW_COPY_AND_ASSIGN(WhenAllVoidState);
+};
+
+/*
+ * The state shared by the continuations for WhenAny(). This is deleted once
+ * all the futures complete or are destroyed.
+ */
+class WhenAnyState {
+ public:
+  explicit WhenAnyState(unsigned int count)
+      : m_remaining(count),
+        m_done(false) {
+  }
+
+  Future<unsigned int> Result() const { return m_result; }
+
+  template <typename T>
+  static void Complete(WhenAnyState *state, unsigned int index,
+                       const T&) {
+    CompleteVoid(state, index);
+  }
+
+  static void CompleteVoid(WhenAnyState *state, unsigned int index) {
+    bool first;
+    {
+      MutexLocker lock(&state->m_mutex);
+      first = !state->m_done;
+      state->m_done = true;
+    }
+    if (first) {
+      state->m_result.Set(index);
+    }
+    Release(state, true);
+  }
+
+  static void Release(WhenAnyState *state, bool) {
+    {
+      MutexLocker lock(&state->m_mutex);
+      if (--state->m_remaining) {
+        return;
+      }
+    }
+    delete state;
+  }
+
+ private:
+  Mutex m_mutex;
+  unsigned int m_remaining;
+  bool m_done;
+  Future<unsigned int> m_result;
+
+  DISALLOW_COPY_AND_ASSIGN(WhenAnyState);
+};
+
+
+/**
+ * @brief Combine futures into one that completes once they all complete.
+ * @param futures the futures to wait for.
+ * @returns A Future that's set to the values of the futures, in the same
+ *   order. If futures is empty it's already complete.
+ */
+template <typename T>
+Future<std::vector<T> > WhenAll(const std::vector<Future<T> > &futures) {
+  if (futures.empty()) {
+    Future<std::vector<T> > result;
+    result.Set(std::vector<T>());
+    return result;
+  }
+
+  WhenAllState<T> *state = new WhenAllState<T>(futures.size());
+  Future<std::vector<T> > result = state->Result();
+  for (unsigned int i = 0; i < futures.size(); i++) {
+    Future<T> future = futures[i];
+    future.Then(NULL, new WhenContinuation<WhenAllState<T>, T>(state, i));
+  }
+  return result;
+}
+
+/**
+ * @brief Combine void futures into one that completes once they all
+ * complete.
+ * @param futures the futures to wait for.
+ * @returns A Future that completes once all the futures have.
+ */
+inline Future<void> WhenAll(const std::vector<Future<void> > &futures) {
+  if (futures.empty()) {
+    Future<void> result;
+    result.Set();
+    return result;
+  }
+
+  WhenAllVoidState *state = new WhenAllVoidState(futures.size());
+  Future<void> result = state->Result();
+  for (unsigned int i = 0; i < futures.size(); i++) {
+    Future<void> future = futures[i];
+    future.Then(NULL, new WhenVoidContinuation<WhenAllVoidState>(state, i));
+  }
+  return result;
+}
+
+/**
+ * @brief Wait for the first of a set of futures to complete.
+ * @param futures the futures to wait for, this must not be empty.
+ * @returns A Future that's set to the index of the first future to complete.
+ *   The value can then be read from that future without blocking.
+ */
+template <typename T>
+Future<unsigned int> WhenAny(const std::vector<Future<T> > &futures) {
+  if (futures.empty()) {
+    OLA_WARN << "WhenAny() called with no futures";
+    return Future<unsigned int>();
+  }
+
+  WhenAnyState *state = new WhenAnyState(futures.size());
+  Future<unsigned int> result = state->Result();
+  for (unsigned int i = 0; i < futures.size(); i++) {
+    Future<T> future = futures[i];
+    future.Then(NULL, new WhenContinuation<WhenAnyState, T>(state, i));
+  }
+  return result;
+}
+
+/**
+ * @brief Wait for the first of a set of void futures to complete.
+ * @param futures the futures to wait for, this must not be empty.
+ * @returns A Future that's set to the index of the first future to complete.
+ */
+inline Future<unsigned int> WhenAny(
+    const std::vector<Future<void> > &futures) {
+  if (futures.empty()) {
+    OLA_WARN << "WhenAny() called with no futures";
+    return Future<unsigned int>();
+  }
+
+  WhenAnyState *state = new WhenAnyState(futures.size());
+  Future<unsigned int> result = state->Result();
+  for (unsigned int i = 0; i < futures.size(); i++) {
+    Future<void> future = futures[i];
+    future.Then(NULL, new WhenVoidContinuation<WhenAnyState>(state, i));
+  }
+  return result;
+}
 }  // namespace thread
 }  // namespace ola
 #endif  // INCLUDE_OLA_THREAD_FUTURE_H_
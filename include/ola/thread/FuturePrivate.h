@@ -21,16 +21,58 @@
 #ifndef INCLUDE_OLA_THREAD_FUTUREPRIVATE_H_
 #define INCLUDE_OLA_THREAD_FUTUREPRIVATE_H_
 
+#include <ola/Callback.h>
 #include <ola/Logging.h>
 #include <ola/base/Macro.h>
+#include <ola/thread/ExecutorInterface.h>
 #include <ola/thread/Mutex.h>
 
+#include <utility>
+#include <vector>
+
 namespace ola {
 namespace thread {
 
+/**
+ * The continuations waiting for a future to complete.
+ */
+template <typename Callback>
+class FutureContinuations {
+ public:
+  typedef std::pair<ExecutorInterface*, Callback*> Continuation;
+  typedef std::vector<Continuation> ContinuationList;
+
+  FutureContinuations() {}
+
+  // Continuations that were never run are deleted, the futures they would
+  // have completed never complete.
+  ~FutureContinuations() {
+    typename ContinuationList::iterator iter = m_continuations.begin();
+    for (; iter != m_continuations.end(); ++iter) {
+      delete iter->second;
+    }
+  }
+
+  void Add(ExecutorInterface *executor, Callback *callback) {
+    m_continuations.push_back(Continuation(executor, callback));
+  }
+
+  void Swap(ContinuationList *continuations) {
+    m_continuations.swap(*continuations);
+  }
+
+ private:
+  ContinuationList m_continuations;
+
+  DISALLOW_COPY_AND_ASSIGN(FutureContinuations<Callback>);
+};
+
+
 template <typename T>
 class FutureImpl {
  public:
+  typedef BaseCallback1<void, const T&> Continuation;
+
   FutureImpl()
       : m_ref_count(1),
         m_is_set(false),
@@ -62,14 +104,14 @@ class FutureImpl {
 
   const T& Get() const {
     MutexLocker l(&m_mutex);
-    if (m_is_set) {
-      return m_value;
+    while (!m_is_set) {
+      m_condition.Wait(&m_mutex);
     }
-    m_condition.Wait(&m_mutex);
     return m_value;
   }
 
   void Set(const T &t) {
+    typename FutureContinuations<Continuation>::ContinuationList continuations;
     {
       MutexLocker l(&m_mutex);
       if (m_is_set) {
@@ -78,8 +120,37 @@ class FutureImpl {
       }
       m_is_set = true;
       m_value = t;
+      m_continuations.Swap(&continuations);
+      // A waiter may drop the last Future as soon as Get() returns, so this
+      // must be done before the mutex is released.
+      m_condition.Broadcast();
+      // Keep this alive while the continuations run, they may drop the last
+      // Future too.
+      m_ref_count++;
+    }
+
+    typename FutureContinuations<Continuation>::ContinuationList::iterator
+        iter = continuations.begin();
+    for (; iter != continuations.end(); ++iter) {
+      Dispatch(iter->first, iter->second);
     }
-    m_condition.Broadcast();
+    DeRef();
+  }
+
+  /*
+   * Run the callback with the value once it's set, either on the executor or,
+   * if the executor is NULL, in the thread that sets the value. If the value
+   * is already set the callback is dispatched straight away.
+   */
+  void AddContinuation(ExecutorInterface *executor, Continuation *callback) {
+    {
+      MutexLocker l(&m_mutex);
+      if (!m_is_set) {
+        m_continuations.Add(executor, callback);
+        return;
+      }
+    }
+    Dispatch(executor, callback);
   }
 
  private:
@@ -88,6 +159,23 @@ class FutureImpl {
   unsigned int m_ref_count;
   bool m_is_set;
   T m_value;
+  FutureContinuations<Continuation> m_continuations;
+
+  void Dispatch(ExecutorInterface *executor, Continuation *callback) {
+    if (executor) {
+      // Hold a reference so the value outlives the Future objects.
+      Ref();
+      executor->Execute(NewSingleCallback(&FutureImpl<T>::RunContinuation,
+                                          this, callback));
+    } else {
+      callback->Run(m_value);
+    }
+  }
+
+  static void RunContinuation(FutureImpl<T> *impl, Continuation *callback) {
+    callback->Run(impl->m_value);
+    impl->DeRef();
+  }
 
   DISALLOW_COPY_AND_ASSIGN(FutureImpl<T>);
 };
@@ -98,6 +186,8 @@ class FutureImpl {
 template <>
 class FutureImpl<void> {
  public:
+  typedef BaseCallback0<void> Continuation;
+
   FutureImpl()
       : m_ref_count(1),
         m_is_set(false) {
@@ -128,13 +218,13 @@ class FutureImpl<void> {
 
   void Get() const {
     MutexLocker l(&m_mutex);
-    if (m_is_set) {
-      return;
+    while (!m_is_set) {
+      m_condition.Wait(&m_mutex);
     }
-    m_condition.Wait(&m_mutex);
   }
 
   void Set() {
+    FutureContinuations<Continuation>::ContinuationList continuations;
     {
       MutexLocker l(&m_mutex);
       if (m_is_set) {
@@ -142,8 +232,29 @@ class FutureImpl<void> {
         return;
       }
       m_is_set = true;
+      m_continuations.Swap(&continuations);
+      // See FutureImpl<T>::Set().
+      m_condition.Broadcast();
+      m_ref_count++;
+    }
+
+    FutureContinuations<Continuation>::ContinuationList::iterator iter =
+        continuations.begin();
+    for (; iter != continuations.end(); ++iter) {
+      Dispatch(iter->first, iter->second);
+    }
+    DeRef();
+  }
+
+  void AddContinuation(ExecutorInterface *executor, Continuation *callback) {
+    {
+      MutexLocker l(&m_mutex);
+      if (!m_is_set) {
+        m_continuations.Add(executor, callback);
+        return;
+      }
     }
-    m_condition.Broadcast();
+    Dispatch(executor, callback);
   }
 
  private:
@@ -151,10 +262,18 @@ class FutureImpl<void> {
   mutable ConditionVariable m_condition;
   unsigned int m_ref_count;
   bool m_is_set;
+  FutureContinuations<Continuation> m_continuations;
+
+  static void Dispatch(ExecutorInterface *executor, Continuation *callback) {
+    if (executor) {
+      executor->Execute(callback);
+    } else {
+      callback->Run();
+    }
+  }
 
   DISALLOW_COPY_AND_ASSIGN(FutureImpl<void>);
 };
-
 }  // namespace thread
 }  // namespace ola
 #endif  // INCLUDE_OLA_THREAD_FUTUREPRIVATE_H_
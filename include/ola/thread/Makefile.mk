@@ -4,6 +4,7 @@ olathreadinclude_HEADERS = \
     include/ola/thread/ConsumerThread.h \
     include/ola/thread/ExecutorInterface.h \
     include/ola/thread/ExecutorThread.h \
+    include/ola/thread/FramePacer.h \
     include/ola/thread/Future.h \
     include/ola/thread/FuturePrivate.h \
     include/ola/thread/Mutex.h \
@@ -11,6 +12,9 @@ olathreadinclude_HEADERS = \
     include/ola/thread/SchedulerInterface.h \
     include/ola/thread/SchedulingExecutorInterface.h \
     include/ola/thread/SignalThread.h \
+    include/ola/thread/SPSCQueue.h \
     include/ola/thread/Thread.h \
     include/ola/thread/ThreadPool.h \
-    include/ola/thread/Utils.h
+    include/ola/thread/TripleBuffer.h \
+    include/ola/thread/Utils.h \
+    include/ola/thread/WorkStealingExecutor.h
@@ -0,0 +1,141 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ * SPSCQueue.h
+ * A fixed size, lock free, single producer & single consumer queue.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file SPSCQueue.h
+ * @brief A lock free queue for passing data between two threads.
+ */
+
+#ifndef INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+#define INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A fixed size ring of T, with one producer thread and one consumer
+ * thread.
+ *
+ * The slots are allocated up front and written in place, so passing an
+ * element doesn't allocate. The producer calls Reserve(), fills in the slot
+ * and then calls Commit(). The consumer calls Peek(), reads the element and
+ * then calls Pop().
+ *
+ * Only the producer may call Reserve() & Commit(), and only the consumer may
+ * call Peek(), Pop() & Size().
+ */
+template <typename T>
+class SPSCQueue {
+ public:
+  /**
+   * @brief Create a new queue.
+   * @param capacity the max number of elements the queue can hold.
+   */
+  explicit SPSCQueue(unsigned int capacity)
+      : m_size(capacity + 1),
+        m_slots(new T[capacity + 1]),
+        m_head(0),
+        m_tail(0) {
+  }
+
+  ~SPSCQueue() { delete[] m_slots; }
+
+  /**
+   * @brief The max number of elements the queue can hold.
+   */
+  unsigned int Capacity() const { return m_size - 1; }
+
+  /**
+   * @brief Get the next free slot.
+   * @returns the slot to fill in, or NULL if the queue is full.
+   *
+   * The slot isn't visible to the consumer until Commit() is called.
+   */
+  T *Reserve() {
+    unsigned int tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    if (Next(tail) == __atomic_load_n(&m_head, __ATOMIC_ACQUIRE)) {
+      return NULL;
+    }
+    return &m_slots[tail];
+  }
+
+  /**
+   * @brief Pass the slot returned by Reserve() to the consumer.
+   */
+  void Commit() {
+    unsigned int tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_tail, Next(tail), __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief Get the oldest element in the queue.
+   * @returns the element, or NULL if the queue is empty. The element remains
+   *   valid until Pop() is called.
+   */
+  const T *Peek() const {
+    unsigned int head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    if (head == __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE)) {
+      return NULL;
+    }
+    return &m_slots[head];
+  }
+
+  /**
+   * @brief Remove the oldest element from the queue.
+   *
+   * The queue must not be empty.
+   */
+  void Pop() {
+    unsigned int head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_head, Next(head), __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief The number of elements in the queue.
+   *
+   * The producer may add more elements at any time, so this is a lower
+   * bound.
+   */
+  unsigned int Size() const {
+    unsigned int head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+    unsigned int tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    return tail >= head ? tail - head : m_size - head + tail;
+  }
+
+ private:
+  const unsigned int m_size;
+  T *m_slots;
+  // The next slot to read, only written by the consumer.
+  unsigned int m_head;
+  // The next slot to write, only written by the producer.
+  unsigned int m_tail;
+
+  unsigned int Next(unsigned int index) const {
+    return index + 1 == m_size ? 0 : index + 1;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SPSCQueue);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_SPSCQUEUE_H_
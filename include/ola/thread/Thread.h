@@ -32,6 +32,7 @@
 #include <ola/thread/Mutex.h>
 
 #include <string>
+#include <vector>
 
 #if defined(_WIN32) && defined(__GNUC__)
 inline std::ostream& operator<<(std::ostream &stream,
@@ -87,6 +88,15 @@ class Thread {
      */
     int inheritsched;
 
+    /**
+     * @brief The CPUs the thread may run on, starting from 0.
+     *
+     * Defaults to empty, which leaves the thread on the same CPUs as the
+     * thread that started it. If the affinity can't be set a warning is
+     * logged and the thread runs anyway.
+     */
+    std::vector<unsigned int> cpu_affinity;
+
     /**
      * @brief Create new thread Options.
      * @param name the name of the thread.
@@ -23,21 +23,23 @@
 
 #include <ola/Callback.h>
 #include <ola/base/Macro.h>
-#include <ola/thread/ConsumerThread.h>
-#include <ola/thread/Thread.h>
-#include <queue>
-#include <vector>
+#include <ola/thread/WorkStealingExecutor.h>
 
 namespace ola {
 namespace thread {
 
+/**
+ * @brief A fixed size pool of threads.
+ *
+ * This is a thin wrapper around a WorkStealingExecutor, which new code should
+ * use directly.
+ */
 class ThreadPool {
  public :
   typedef ola::BaseCallback0<void>* Action;
 
   explicit ThreadPool(unsigned int thread_count)
-      : m_thread_count(thread_count),
-        m_shutdown(false) {
+      : m_executor(ExecutorOptions(thread_count)) {
   }
   ~ThreadPool();
   bool Init();
@@ -45,14 +47,10 @@ class ThreadPool {
   void Execute(Action action);
 
  private:
-  std::queue<Action> m_callback_queue;
-  unsigned int m_thread_count;
-  bool m_shutdown;
-  Mutex m_mutex;
-  ConditionVariable m_condition_var;
-  std::vector<ConsumerThread*> m_threads;
-
-  void JoinAllThreads();
+  WorkStealingExecutor m_executor;
+
+  static WorkStealingExecutor::Options ExecutorOptions(
+      unsigned int thread_count);
 
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
@@ -0,0 +1,117 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ *
+ * TripleBuffer.h
+ * A lock free handoff of the latest value from one thread to another.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @file TripleBuffer.h
+ * @brief A lock free triple buffer for passing the latest frame between two
+ * threads.
+ */
+
+#ifndef INCLUDE_OLA_THREAD_TRIPLEBUFFER_H_
+#define INCLUDE_OLA_THREAD_TRIPLEBUFFER_H_
+
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Three copies of T, shared between a producer thread and a consumer
+ * thread.
+ *
+ * The producer fills in the buffer returned by WriteBuffer() and then calls
+ * Publish(). The consumer calls Update() to pick up the most recently
+ * published buffer, and then reads it with ReadBuffer(). Neither side ever
+ * blocks: if the producer publishes several times before the consumer
+ * calls Update(), only the newest value is seen.
+ *
+ * Only the producer may call WriteBuffer() & Publish(), and only the
+ * consumer may call Update() & ReadBuffer().
+ *
+ * The buffers are written in place so T should be copied into, rather than
+ * assigned, if assignment shares state. For a DmxBuffer, use
+ * WriteBuffer()->Set(buffer).
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer()
+      : m_write(0),
+        m_middle(1),
+        m_read(2) {
+  }
+
+  /**
+   * @brief The buffer the producer should write the next value to.
+   *
+   * This remains owned by the producer until Publish() is called.
+   */
+  T *WriteBuffer() { return &m_buffers[m_write]; }
+
+  /**
+   * @brief Hand the buffer returned by WriteBuffer() to the consumer.
+   */
+  void Publish() {
+    unsigned int old = __atomic_exchange_n(&m_middle, m_write | NEW_DATA,
+                                           __ATOMIC_ACQ_REL);
+    m_write = old & INDEX_MASK;
+  }
+
+  /**
+   * @brief Pick up the newest value published by the producer.
+   * @returns true if there was a new value, false if ReadBuffer() is the
+   *   same as it was before.
+   */
+  bool Update() {
+    if (!(__atomic_load_n(&m_middle, __ATOMIC_RELAXED) & NEW_DATA)) {
+      return false;
+    }
+    unsigned int old = __atomic_exchange_n(&m_middle, m_read,
+                                           __ATOMIC_ACQ_REL);
+    m_read = old & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * @brief The value the consumer last picked up with Update().
+   *
+   * This doesn't change until the next call to Update().
+   */
+  const T &ReadBuffer() const { return m_buffers[m_read]; }
+
+ private:
+  T m_buffers[3];
+  // Only used by the producer.
+  unsigned int m_write;
+  // The index of the buffer between the two threads, with NEW_DATA set if
+  // it was published since the consumer last picked it up.
+  unsigned int m_middle;
+  // Only used by the consumer.
+  unsigned int m_read;
+
+  static const unsigned int INDEX_MASK = 0x3;
+  static const unsigned int NEW_DATA = 0x4;
+
+  DISALLOW_COPY_AND_ASSIGN(TripleBuffer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_TRIPLEBUFFER_H_
@@ -22,7 +22,9 @@
 #define INCLUDE_OLA_THREAD_UTILS_H_
 
 #include <pthread.h>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace ola {
 namespace thread {
@@ -44,6 +46,116 @@ std::string PolicyToString(int policy);
 bool SetSchedParam(pthread_t thread, int policy,
                    const struct sched_param &param);
 
+/**
+ * @brief Restrict a thread to run on a single CPU.
+ * @param thread The thread id.
+ * @param cpu the CPU to run on, starting from 0.
+ * @returns True if the call succeeded, false if it failed or the platform
+ *   doesn't support CPU affinity.
+ */
+bool SetThreadAffinity(pthread_t thread, unsigned int cpu);
+
+/**
+ * @brief Restrict a thread to run on a set of CPUs.
+ * @param thread The thread id.
+ * @param cpus the CPUs to run on, starting from 0.
+ * @returns True if the call succeeded, false if it failed or the platform
+ *   doesn't support CPU affinity.
+ */
+bool SetThreadAffinity(pthread_t thread, const std::vector<unsigned int> &cpus);
+
+/**
+ * @brief Parse a list of CPUs.
+ * @param list a comma separated list of CPUs or ranges of CPUs, e.g.
+ *   "0,2-3". An empty list, or -1, means any CPU.
+ * @param[out] cpus the CPUs, in ascending order.
+ * @returns true if the list was valid, false otherwise.
+ */
+bool ParseCPUList(const std::string &list, std::vector<unsigned int> *cpus);
+
+/**
+ * @brief Convert a list of CPUs to a string, the inverse of ParseCPUList().
+ * @param cpus the CPUs.
+ * @returns the CPUs as a string, consecutive CPUs are shown as a range.
+ */
+std::string CPUListToString(const std::vector<unsigned int> &cpus);
+
+/**
+ * @brief The CPUs in each NUMA node, keyed by the node id.
+ */
+typedef std::map<unsigned int, std::vector<unsigned int> > NumaNodeMap;
+
+/**
+ * @brief Find the NUMA nodes and the CPUs in each one.
+ * @param[out] nodes the CPUs in each node. Nodes without CPUs are skipped.
+ * @param sysfs_path the directory that holds the node directories.
+ * @returns true if at least one node was found, false if the topology isn't
+ *   available, e.g. on platforms other than Linux.
+ */
+bool GetNumaNodes(NumaNodeMap *nodes,
+                  const std::string &sysfs_path = "/sys/devices/system/node");
+
+/**
+ * @brief Find the NUMA node a network interface is attached to.
+ * @param interface_name the name of the interface, e.g. eth0.
+ * @param[out] node the node the interface's device is attached to.
+ * @param sysfs_path the directory that holds the interface directories.
+ * @returns true if the node is known, false for virtual interfaces, hosts
+ *   with a single node or platforms other than Linux.
+ */
+bool GetInterfaceNumaNode(const std::string &interface_name,
+                          unsigned int *node,
+                          const std::string &sysfs_path = "/sys/class/net");
+
+/**
+ * @brief Prefer memory from a NUMA node for the calling thread.
+ * @param node the node to allocate from.
+ * @returns true if the policy was set, false if it failed or the platform
+ *   doesn't support it.
+ *
+ * Pages that the thread touches for the first time after this are taken
+ * from the node while it has free memory. Memory the thread already uses
+ * isn't moved.
+ */
+bool SetMemoryNode(unsigned int node);
+
+/**
+ * @brief Scheduling options that a thread applies to itself once it's
+ * running.
+ *
+ * Unlike the policy and priority in Thread::Options, failing to apply these
+ * isn't fatal: a warning is logged and the thread carries on with the
+ * default scheduling. This suits options read from config files, which may
+ * ask for more than the process is allowed.
+ */
+struct SchedulingOptions {
+  /**
+   * @brief The real time policy, SCHED_FIFO or SCHED_RR.
+   */
+  int policy;
+
+  /**
+   * @brief The real time priority, 0 leaves the scheduling unchanged.
+   */
+  int priority;
+
+  /**
+   * @brief The CPUs to run on, empty for any CPU.
+   */
+  std::vector<unsigned int> cpus;
+
+  SchedulingOptions() : policy(SCHED_FIFO), priority(0) {}
+};
+
+/**
+ * @brief Apply SchedulingOptions to the calling thread.
+ * @param options the options to apply.
+ * @param description the thread's description, used in the log messages.
+ * @returns true if all the options were applied, false otherwise.
+ */
+bool ApplySchedulingOptions(const SchedulingOptions &options,
+                            const std::string &description);
+
 }  // namespace thread
 }  // namespace ola
 #endif  // INCLUDE_OLA_THREAD_UTILS_H_
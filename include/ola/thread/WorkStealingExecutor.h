@@ -0,0 +1,199 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * WorkStealingExecutor.h
+ * Run callbacks on a pool of threads, with a work stealing queue per thread.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_WORKSTEALINGEXECUTOR_H_
+#define INCLUDE_OLA_THREAD_WORKSTEALINGEXECUTOR_H_
+
+#include <stdint.h>
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/ExecutorInterface.h>
+#include <ola/thread/Future.h>
+#include <ola/thread/Mutex.h>
+#include <ola/thread/Thread.h>
+
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Run callbacks on a pool of threads.
+ *
+ * Each worker thread has its own queue. Callbacks queued from a worker, e.g.
+ * when a callback splits its work into smaller pieces, go onto that worker's
+ * queue without locking. Callbacks queued from other threads are spread
+ * across the workers. A worker that runs out of callbacks steals them from
+ * the other workers, so the threads stay busy without contending on a single
+ * lock.
+ *
+ * Unlike ExecutorThread, callbacks run concurrently and not necessarily in
+ * the order they were queued, so they must not depend on each other. Use an
+ * ExecutorThread if the order matters.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~
+  WorkStealingExecutor executor;
+  executor.Start();
+
+  Future<bool> result = executor.Submit(
+      NewSingleCallback(&LoadFirmware, filename));
+  // Do something else ...
+  if (result.Get()) { ... }
+
+  executor.Stop();
+ * ~~~~~~~~~~~~~~~~~~~~~
+ */
+class WorkStealingExecutor : public ExecutorInterface {
+ public:
+  /**
+   * @brief Controls the options for the WorkStealingExecutor.
+   */
+  struct Options {
+   public:
+    /**
+     * The number of worker threads, 0 means one per CPU.
+     */
+    unsigned int thread_count;
+
+    /**
+     * The number of callbacks each worker's lock free queue can hold. This
+     * is rounded up to a power of two. Callbacks that don't fit are held in a
+     * locked overflow queue.
+     */
+    unsigned int queue_size;
+
+    /**
+     * The name to give the worker threads.
+     */
+    std::string name;
+
+    Options()
+        : thread_count(0),
+          queue_size(DEFAULT_QUEUE_SIZE),
+          name("ola-worker") {
+    }
+  };
+
+  explicit WorkStealingExecutor(const Options &options = Options());
+
+  /**
+   * @brief Destructor, this stops the workers and runs any remaining
+   * callbacks.
+   */
+  ~WorkStealingExecutor();
+
+  /**
+   * @brief Start the worker threads.
+   * @returns true if the threads started, false if they were already
+   *   running or a thread couldn't be started.
+   */
+  bool Start();
+
+  /**
+   * @brief Stop the worker threads.
+   * @returns true if the workers were stopped, false if they weren't
+   *   running.
+   *
+   * Once the threads have stopped, the remaining callbacks are run in the
+   * calling thread.
+   */
+  bool Stop();
+
+  /**
+   * @brief The number of worker threads.
+   */
+  unsigned int ThreadCount() const { return m_workers.size(); }
+
+  /**
+   * @brief Queue a callback, this may be called from any thread, including
+   * the workers.
+   */
+  void Execute(ola::BaseCallback0<void> *callback);
+
+  /**
+   * @brief Block until all the queued callbacks have run.
+   *
+   * The calling thread runs queued callbacks while it waits, so this may be
+   * called from a worker.
+   */
+  void DrainCallbacks();
+
+  /**
+   * @brief Queue a callback, and return a Future for the result.
+   * @param callback the callback to run.
+   * @returns a Future that's set once the callback has run.
+   */
+  template <typename T>
+  Future<T> Submit(ola::BaseCallback0<T> *callback) {
+    Future<T> future;
+    Execute(NewSingleCallback(&WorkStealingExecutor::RunAndSet<T>,
+                              callback, future));
+    return future;
+  }
+
+  /**
+   * @brief Queue a callback, and return a Future that's set once it's run.
+   * @param callback the callback to run.
+   */
+  Future<void> Submit(ola::BaseCallback0<void> *callback);
+
+  static const unsigned int DEFAULT_QUEUE_SIZE = 1024;
+
+ private:
+  class Worker;
+
+  const Options m_options;
+  std::vector<Worker*> m_workers;
+  bool m_running;
+  // Used to pick which worker gets the callbacks queued from other threads.
+  uint32_t m_next_worker;
+  // The number of callbacks that are queued but haven't been taken.
+  uint32_t m_queued;
+  // The number of callbacks that are queued or running.
+  uint32_t m_outstanding;
+  uint32_t m_sleeping;
+  bool m_shutdown;
+  Mutex m_mutex;
+  ConditionVariable m_work_condition;
+  ConditionVariable m_drained_condition;
+
+  Worker *CurrentWorker() const;
+  ola::BaseCallback0<void> *FindWork(Worker *worker);
+  ola::BaseCallback0<void> *Steal(Worker *worker);
+  void RunCallback(ola::BaseCallback0<void> *callback);
+  void WakeWorker();
+  void WaitForWork();
+  void RunWorker(Worker *worker);
+  void RunRemaining();
+
+  template <typename T>
+  static void RunAndSet(ola::BaseCallback0<T> *callback, Future<T> future) {
+    future.Set(callback->Run());
+  }
+
+  static void RunAndSetVoid(ola::BaseCallback0<void> *callback,
+                            Future<void> future);
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingExecutor);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_WORKSTEALINGEXECUTOR_H_
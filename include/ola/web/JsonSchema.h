@@ -33,7 +33,6 @@
 #include <ola/stl/STLUtils.h>
 #include <ola/web/Json.h>
 #include <ola/web/JsonTypes.h>
-#include <deque>
 #include <map>
 #include <memory>
 #include <set>
@@ -223,8 +222,11 @@ class BaseValidator : public ValidatorInterface {
   std::string m_description;
   std::auto_ptr<const JsonValue> m_default_value;
   std::vector<const JsonValue*> m_enums;
+  // The string values from m_enums, so strings can be checked with a lookup.
+  std::set<std::string> m_string_enums;
 
   bool CheckEnums(const JsonValue &value);
+  bool CheckEnums(const JsonString &value);
 
   // Child classes can hook in here to extend the schema.
   virtual void ExtendSchema(JsonObject *schema) const {
@@ -301,20 +303,35 @@ class StringValidator : public BaseValidator {
 
     unsigned int min_length;
     int max_length;
-    // Formats & Regexes aren't supported.
-    // std::string pattern
+    // An ECMA 262 regular expression, empty means no pattern. This is
+    // translated to a POSIX extended regular expression, patterns that use
+    // features with no POSIX equivalent, e.g. lookahead, aren't valid.
+    std::string pattern;
+    // Formats aren't supported.
     // std::string format
   };
 
-  explicit StringValidator(const Options &options)
-      : BaseValidator(JSON_STRING),
-        m_options(options) {
-  }
+  /**
+   * @brief Create a new StringValidator.
+   * @param options the constraints to apply. Any pattern is compiled here,
+   *   rather than each time a string is validated.
+   */
+  explicit StringValidator(const Options &options);
+  ~StringValidator();
+
+  /**
+   * @brief Check if the pattern compiled.
+   * @returns false if the pattern isn't a valid regular expression.
+   */
+  bool PatternIsValid() const;
 
   void Visit(const JsonString &str);
 
  private:
+  class Pattern;
+
   const Options m_options;
+  std::auto_ptr<Pattern> m_pattern;
 
   void ExtendSchema(JsonObject *schema) const;
 
@@ -519,9 +536,7 @@ class NumberValidator : public IntegerValidator {
 /**
  * @brief The validator for JsonObject.
  *
- * @note This does not implement patternProperties. This is done because we
- * don't want to pull in a regex library just yet. Maybe some point in the
- * future we can use re2.
+ * @note This does not implement patternProperties.
  */
 class ObjectValidator : public BaseValidator, JsonObjectPropertyVisitor {
  public:
@@ -610,8 +625,40 @@ class ObjectValidator : public BaseValidator, JsonObjectPropertyVisitor {
   PropertyDependencies m_property_dependencies;
   SchemaDependencies m_schema_dependencies;
 
-  StringSet m_seen_properties;
+  /*
+   * The required properties and dependencies are resolved as the validator is
+   * built, so each property in a document takes a single lookup.
+   */
+  struct PropertyInfo {
+    PropertyInfo()
+        : index(0),
+          validator(NULL),
+          required(false),
+          schema_dependency(NULL) {
+    }
+
+    // The position of the property in m_seen.
+    unsigned int index;
+    ValidatorInterface *validator;  // not owned
+    bool required;
+    // The indices of the properties that must be present if this one is.
+    std::vector<unsigned int> property_dependencies;
+    ValidatorInterface *schema_dependency;  // not owned
+  };
+
+  typedef std::map<std::string, PropertyInfo> PropertyInfoMap;
+
+  PropertyInfoMap m_property_info;
+  // The properties that have dependencies, these point into m_property_info.
+  std::vector<const PropertyInfo*> m_dependents;
+  unsigned int m_required_count;
 
+  // Per-document state
+  unsigned int m_required_seen;
+  std::vector<bool> m_seen;
+
+  PropertyInfo *GetPropertyInfo(const std::string &property);
+  void AddDependent(const PropertyInfo *info);
   void ExtendSchema(JsonObject *schema) const;
 
   DISALLOW_COPY_AND_ASSIGN(ObjectValidator);
@@ -703,8 +750,6 @@ class ArrayValidator : public BaseValidator {
   void Visit(const JsonArray &array);
 
  private:
-  typedef std::deque<ValidatorInterface*> ValidatorQueue;
-
   const std::auto_ptr<Items> m_items;
   const std::auto_ptr<AdditionalItems> m_additional_items;
   const Options m_options;
@@ -712,35 +757,14 @@ class ArrayValidator : public BaseValidator {
   // This is used if items is missing, or if additionalItems is true.
   std::auto_ptr<WildcardValidator> m_wildcard_validator;
 
-  class ArrayElementValidator : public BaseValidator {
-   public:
-    ArrayElementValidator(const ValidatorList &validators,
-                          ValidatorInterface *default_validator);
-
-    void Visit(const JsonString&);
-    void Visit(const JsonBool&);
-    void Visit(const JsonNull&);
-    void Visit(const JsonRawValue&);
-    void Visit(const JsonObject&);
-    void Visit(const JsonArray &array);
-    void Visit(const JsonUInt&);
-    void Visit(const JsonUInt64&);
-    void Visit(const JsonInt&);
-    void Visit(const JsonInt64&);
-    void Visit(const JsonDouble&);
-
-   private:
-    ValidatorQueue m_item_validators;
-    ValidatorInterface *m_default_validator;
-
-    template <typename T>
-    void ValidateItem(const T &item);
-
-    DISALLOW_COPY_AND_ASSIGN(ArrayElementValidator);
-  };
+  // Worked out from items & additionalItems at construction. The first
+  // elements are checked against m_item_validators, the rest against
+  // m_default_validator. If m_default_validator is NULL, additional items
+  // aren't allowed.
+  ValidatorList m_item_validators;
+  ValidatorInterface *m_default_validator;
 
   void ExtendSchema(JsonObject *schema) const;
-  ArrayElementValidator* ConstructElementValidator() const;
 
   DISALLOW_COPY_AND_ASSIGN(ArrayValidator);
 };
@@ -0,0 +1,145 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * JsonStreamWriter.h
+ * Write JSON to a buffer without building a JsonValue first.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+/**
+ * @addtogroup json
+ * @{
+ * @file JsonStreamWriter.h
+ * @brief Write JSON to a buffer without building a JsonValue first.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_WEB_JSONSTREAMWRITER_H_
+#define INCLUDE_OLA_WEB_JSONSTREAMWRITER_H_
+
+#include <ola/base/Macro.h>
+#include <ola/io/OutputBuffer.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace web {
+
+/**
+ * @addtogroup json
+ * @{
+ */
+
+/**
+ * @brief Emit JSON text as it's generated.
+ *
+ * This produces the same text as JsonWriter, but the data is written to the
+ * output as each value is added, rather than building a JsonValue tree and
+ * serializing it. Writing to an IOQueue means large responses are held in
+ * MemoryBlocks rather than a single string.
+ *
+ * @examplepara
+ * @code
+ *   ola::io::IOQueue output;
+ *   JsonStreamWriter writer(&output);
+ *   writer.StartObject();
+ *   writer.Add("universe", 1);
+ *   writer.StartArray("uids");
+ *   writer.Value("7a70:00000001");
+ *   writer.EndArray();
+ *   writer.EndObject();
+ * @endcode
+ *
+ * Keys must be added before each value in an object, either with Key() or
+ * with the Add(), StartObject(key) & StartArray(key) methods. Arrays are
+ * formatted on multiple lines if their first element is an object or
+ * array.
+ */
+class JsonStreamWriter {
+ public:
+  /**
+   * @brief Create a new JsonStreamWriter.
+   * @param output the buffer to write to, ownership is not transferred.
+   */
+  explicit JsonStreamWriter(ola::io::OutputBufferInterface *output);
+
+  void StartObject();
+  void StartObject(const std::string &key);
+  void EndObject();
+
+  void StartArray();
+  void StartArray(const std::string &key);
+  void EndArray();
+
+  /**
+   * @brief Add the key for the next value in an object.
+   */
+  void Key(const std::string &key);
+
+  void Value(const std::string &value);
+  void Value(const char *value);
+  void Value(bool value);
+  void Value(uint32_t value);
+  void Value(int32_t value);
+  void Value(uint64_t value);
+  void Value(int64_t value);
+  void Null();
+
+  /**
+   * @brief Add a value that is already valid JSON.
+   */
+  void RawValue(const std::string &value);
+
+  /**
+   * @brief Add a key & value to the current object.
+   */
+  template <typename T>
+  void Add(const std::string &key, const T &value) {
+    Key(key);
+    Value(value);
+  }
+
+  /**
+   * @brief Returns true if all objects & arrays have been closed.
+   */
+  bool Complete() const { return m_stack.empty() && m_started; }
+
+ private:
+  struct Scope {
+    bool is_object;
+    bool multi_line;
+    unsigned int count;
+  };
+
+  ola::io::OutputBufferInterface *m_output;
+  std::vector<Scope> m_stack;
+  unsigned int m_indent;
+  bool m_started;
+  bool m_have_key;
+
+  void StartValue(bool complex);
+  void EndScope(bool is_object);
+  void Write(const std::string &data);
+  void WriteIndent();
+
+  static const unsigned int DEFAULT_INDENT = 2;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonStreamWriter);
+};
+/**@}*/
+}  // namespace web
+}  // namespace ola
+#endif  // INCLUDE_OLA_WEB_JSONSTREAMWRITER_H_
@@ -86,6 +86,31 @@ class AbstractDevice {
                          const std::string &request,
                          std::string *response,
                          ConfigureCallback *done) = 0;
+
+  /**
+   * @brief Called before the first OutputPort::WriteDMX() of a frame.
+   *
+   * When a set of universes is updated together, the writes to all of this
+   * device's output ports are bracketed by a single BeginFrame() /
+   * EndFrame() pair. Devices can use this to queue the data and send it with
+   * a single sendmmsg(), sync packet or USB transfer.
+   */
+  virtual void BeginFrame() {}
+
+  /**
+   * @brief Called after the last OutputPort::WriteDMX() of a frame.
+   */
+  virtual void EndFrame() {}
+
+  /**
+   * @brief Estimate the memory used by this Device's protocol state, e.g.
+   * the sources and nodes it tracks.
+   * @returns the estimate in bytes.
+   *
+   * This is called periodically from the PluginAdaptor's loop. Devices that
+   * don't track anything can leave this as is.
+   */
+  virtual size_t MemoryUsage() { return 0; }
 };
 
 
@@ -32,12 +32,18 @@ namespace ola {
 
 /*
  * The DmxSource class
+ *
+ * As well as the time the data was last updated, a DmxSource records the time
+ * the data arrived on the host, if that's known. This is used to measure the
+ * latency from ingress to output. Unless it's set with SetIngressTime(), the
+ * ingress time is the same as the update timestamp.
  */
 class DmxSource {
  public:
     DmxSource():
         m_buffer(),
         m_timestamp(),
+        m_ingress_time(),
         m_priority(ola::dmx::SOURCE_PRIORITY_MIN) {
     }
 
@@ -46,12 +52,14 @@ class DmxSource {
               uint8_t priority):
         m_buffer(buffer),
         m_timestamp(timestamp),
+        m_ingress_time(timestamp),
         m_priority(priority) {
     }
 
     DmxSource(const DmxSource &other) {
       m_buffer = other.m_buffer;
       m_timestamp = other.m_timestamp;
+      m_ingress_time = other.m_ingress_time;
       m_priority = other.m_priority;
     }
 
@@ -63,6 +71,7 @@ class DmxSource {
       if (this != &other) {
         m_buffer = other.m_buffer;
         m_timestamp = other.m_timestamp;
+        m_ingress_time = other.m_ingress_time;
         m_priority = other.m_priority;
       }
       return *this;
@@ -85,10 +94,42 @@ class DmxSource {
                     uint8_t priority) {
       m_buffer = buffer;
       m_timestamp = timestamp;
+      m_ingress_time = timestamp;
+      m_priority = priority;
+    }
+
+
+    /*
+     * Update the DmxSource with new data. This copies into the existing
+     * buffer, so no memory is allocated unless the data is shared.
+     */
+    void UpdateData(const uint8_t *data, unsigned int length,
+                    const TimeStamp &timestamp, uint8_t priority) {
+      m_buffer.Set(data, length);
+      m_timestamp = timestamp;
+      m_ingress_time = timestamp;
       m_priority = priority;
     }
 
 
+    /*
+     * Mark the current data as received again, without changing it.
+     */
+    void Refresh(const TimeStamp &timestamp) {
+      m_timestamp = timestamp;
+      m_ingress_time = timestamp;
+    }
+
+
+    /*
+     * Set the time the current data arrived on the host. This should be
+     * called after UpdateData().
+     */
+    void SetIngressTime(const TimeStamp &ingress_time) {
+      m_ingress_time = ingress_time;
+    }
+
+
     /*
      * Get the DmxBuffer in this source
      */
@@ -101,12 +142,25 @@ class DmxSource {
     const TimeStamp &Timestamp() const { return m_timestamp; }
 
 
+    /*
+     * Get the time the data arrived on the host
+     */
+    const TimeStamp &IngressTime() const { return m_ingress_time; }
+
+
     /*
      * Check if this source has timed out
      */
     bool IsActive(const TimeStamp &now) const {
-      TimeStamp timeout = m_timestamp + TIMEOUT_INTERVAL;
-      return now < timeout;
+      return now < Expiry();
+    }
+
+
+    /*
+     * Get the time this source times out
+     */
+    TimeStamp Expiry() const {
+      return m_timestamp + TIMEOUT_INTERVAL;
     }
 
 
@@ -126,6 +180,7 @@ class DmxSource {
  private:
     DmxBuffer m_buffer;
     TimeStamp m_timestamp;
+    TimeStamp m_ingress_time;
     uint8_t m_priority;
 
     static const TimeInterval TIMEOUT_INTERVAL;
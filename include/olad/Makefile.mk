@@ -7,5 +7,8 @@ oladinclude_HEADERS = \
     include/olad/PortBroker.h \
     include/olad/PortConstants.h \
     include/olad/Preferences.h \
+    include/olad/SpanFrame.h \
+    include/olad/ThreadPreferences.h \
     include/olad/TokenBucket.h \
+    include/olad/UDPSocketMonitor.h \
     include/olad/Universe.h
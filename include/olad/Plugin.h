@@ -30,6 +30,10 @@
 
 namespace ola {
 
+namespace network {
+struct InterfaceChanges;
+}
+
 class PluginAdaptor;
 
 /**
@@ -45,6 +49,14 @@ class AbstractPlugin {
    */
   virtual bool LoadPreferences() = 0;
 
+  /**
+   * @brief Read the preferences from storage again and set defaults.
+   *
+   * This is used to pick up changes to the config when the plugin is reloaded
+   * on its own. The plugin should be stopped when this is called.
+   */
+  virtual bool ReloadPreferences() = 0;
+
   /**
    * @brief The location for preferences.
    *
@@ -66,6 +78,26 @@ class AbstractPlugin {
    */
   virtual void SetEnabledState(bool enable) = 0;
 
+  /**
+   * @brief Check if PrepareStart() can be run off the main thread.
+   * @return true if PrepareStart() can be run on a separate thread.
+   *
+   * Plugins with slow setup, like probing hardware, should return true so
+   * they don't hold up the other plugins when olad starts.
+   */
+  virtual bool CanPrepareOffMainThread() const { return false; }
+
+  /**
+   * @brief Do the slow part of starting the plugin.
+   *
+   * This is called before Start(). If CanPrepareOffMainThread() returns true
+   * it may be run on a thread other than the main thread, so it must not use
+   * the PluginAdaptor. Devices should be registered from Start(), which is
+   * always run on the main thread.
+   * @return true if the plugin can now be started, false otherwise
+   */
+  virtual bool PrepareStart() { return true; }
+
   /**
    * @brief Start the plugin
    *
@@ -102,6 +134,13 @@ class AbstractPlugin {
 
   virtual void ConflictsWith(std::set<ola_plugin_id> *conflict_set) const = 0;
 
+  /**
+   * @brief Called when the network interfaces change.
+   *
+   * This is only called on active plugins, from the main thread.
+   */
+  virtual void InterfacesChanged(const ola::network::InterfaceChanges&) {}
+
   // used to sort plugins
   virtual bool operator<(const AbstractPlugin &other) const = 0;
 };
@@ -126,6 +165,7 @@ class Plugin: public AbstractPlugin {
   virtual ~Plugin() {}
 
   bool LoadPreferences();
+  bool ReloadPreferences();
   std::string PreferenceConfigLocation() const;
   bool IsEnabled() const;
   void SetEnabledState(bool enable);
@@ -145,6 +185,11 @@ class Plugin: public AbstractPlugin {
   // by default we don't conflict with any other plugins
   virtual void ConflictsWith(std::set<ola_plugin_id>*) const {}
 
+  /**
+   * @brief Restart the plugin if AffectedBy() returns true.
+   */
+  void InterfacesChanged(const ola::network::InterfaceChanges &changes);
+
   bool operator<(const AbstractPlugin &other) const {
     return Id() < other.Id();
   }
@@ -153,6 +198,17 @@ class Plugin: public AbstractPlugin {
   virtual bool StartHook() { return 0; }
   virtual bool StopHook() { return 0; }
 
+  /**
+   * @brief Check if the plugin's sockets are bound to a changed interface.
+   *
+   * Plugins that bind to a particular interface should override this, the
+   * plugin is then restarted with StopHook() & StartHook() so the sockets
+   * are rebound. Patches are restored when the devices are registered again.
+   */
+  virtual bool AffectedBy(const ola::network::InterfaceChanges&) const {
+    return false;
+  }
+
   /**
    * Set default preferences.
    */
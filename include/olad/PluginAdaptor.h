@@ -32,9 +32,12 @@
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
 #include <ola/io/SelectServerInterface.h>
+#include <ola/network/InterfaceMonitor.h>
+#include <ola/plugin_id.h>
 #include <olad/OlaServer.h>
 
 #include <string>
+#include <vector>
 
 namespace ola {
 
@@ -87,6 +90,10 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
 
   void RemoveTimeout(ola::thread::timeout_id id);
 
+  void SetDescriptorName(const ola::io::ReadFileDescriptor *descriptor,
+                         const std::string &name);
+  void SetTimeoutName(ola::thread::timeout_id id, const std::string &name);
+
   void Execute(ola::BaseCallback0<void> *closure);
 
   const TimeStamp *WakeUpTime() const;
@@ -127,6 +134,88 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
 
   void DrainCallbacks();
 
+  /**
+   * @brief Set the extra event loops that plugins can be sharded across.
+   * @param loops the SelectServers for each loop, ownership is not
+   *   transferred.
+   * @param loop_nodes the NUMA node each loop is placed on, empty if the
+   *   loops haven't been placed.
+   */
+  void SetWorkerLoops(
+      const std::vector<ola::io::SelectServerInterface*> &loops,
+      const std::vector<unsigned int> &loop_nodes =
+          std::vector<unsigned int>());
+
+  /**
+   * @brief Return the event loop a plugin should run its I/O on.
+   * @param plugin_id the id of the plugin.
+   * @returns the SelectServer for the plugin's shard, or NULL if olad is
+   *   running with a single event loop.
+   *
+   * The shard's loop runs in a different thread. Anything that touches the
+   * rest of olad, including the PluginAdaptor itself, must be passed back
+   * with Execute().
+   */
+  ola::io::SelectServerInterface *WorkerLoop(ola_plugin_id plugin_id) const;
+
+  /**
+   * @brief Return the event loop a plugin should run its I/O on, preferring
+   *   a loop on the same NUMA node as the plugin's network interface.
+   * @param plugin_id the id of the plugin.
+   * @param interface_name the interface the plugin reads from, e.g. eth0.
+   * @returns the SelectServer for the plugin's shard, or NULL if olad is
+   *   running with a single event loop.
+   *
+   * This is the same as WorkerLoop(plugin_id) if the loops haven't been
+   * placed on NUMA nodes, or the interface's node isn't known.
+   */
+  ola::io::SelectServerInterface *WorkerLoop(
+      ola_plugin_id plugin_id,
+      const std::string &interface_name) const;
+
+  /**
+   * @brief Return the event loop a plugin should run its I/O on, preferring
+   *   a loop on a NUMA node.
+   * @param plugin_id the id of the plugin.
+   * @param node the NUMA node of the memory and devices the plugin uses.
+   * @returns the SelectServer for the plugin's shard, or NULL if olad is
+   *   running with a single event loop.
+   *
+   * If there aren't any loops on the node, the plugin's usual loop is
+   * returned.
+   */
+  ola::io::SelectServerInterface *WorkerLoopOnNode(ola_plugin_id plugin_id,
+                                                   unsigned int node) const;
+
+  /**
+   * @brief The NUMA node of the interface each plugin uses, keyed by plugin
+   *   id.
+   */
+  static const char K_PLUGIN_NIC_NODE_VAR[];
+
+  /**
+   * @brief The NUMA node of the loop each plugin was placed on, keyed by
+   *   plugin id.
+   */
+  static const char K_PLUGIN_LOOP_NODE_VAR[];
+
+  /**
+   * @brief Set the monitor that tracks the network interfaces.
+   * @param monitor the InterfaceMonitor, ownership is not transferred.
+   */
+  void SetInterfaceMonitor(ola::network::InterfaceMonitor *monitor) {
+    m_interface_monitor = monitor;
+  }
+
+  /**
+   * @brief Return the cached table of network interfaces.
+   * @returns the InterfaceMonitor, or NULL if there isn't one. It must only
+   *   be used from the main thread.
+   */
+  ola::network::InterfaceMonitor *GetInterfaceMonitor() const {
+    return m_interface_monitor;
+  }
+
  private:
   DeviceManager *m_device_manager;
   ola::io::SelectServerInterface *m_ss;
@@ -134,6 +223,9 @@ class PluginAdaptor: public ola::io::SelectServerInterface {
   class PreferencesFactory *m_preferences_factory;
   class PortBrokerInterface *m_port_broker;
   const std::string *m_instance_name;
+  std::vector<ola::io::SelectServerInterface*> m_worker_loops;
+  std::vector<unsigned int> m_worker_loop_nodes;
+  ola::network::InterfaceMonitor *m_interface_monitor;
 
   DISALLOW_COPY_AND_ASSIGN(PluginAdaptor);
 };
@@ -25,6 +25,7 @@
 #include <ola/base/Macro.h>
 #include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMControllerInterface.h>
+#include <ola/rdm/UIDSet.h>
 #include <ola/timecode/TimeCode.h>
 #include <olad/DmxSource.h>
 #include <olad/PluginAdaptor.h>
@@ -36,6 +37,9 @@
 namespace ola {
 
 class AbstractDevice;
+class DuplicateFrameFilter;
+class InputFrameStats;
+class OutputCurve;
 
 /**
  * @brief The base port class.
@@ -148,6 +152,20 @@ class InputPort: public Port {
    */
   virtual const DmxSource &SourceData() const = 0;
 
+  /**
+   * @brief Enable or disable duplicate frame suppression.
+   * @param suppress if true, a frame with the same data and priority as the
+   *   previous one only refreshes the source, rather than being merged and
+   *   sent on to the universe's outputs and clients. Some duplicates are
+   *   still merged, so that the outputs are refreshed.
+   */
+  virtual void SetSuppressDuplicates(bool suppress) = 0;
+
+  /**
+   * @brief Check if duplicate frames are suppressed.
+   */
+  virtual bool GetSuppressDuplicates() const = 0;
+
   /**
    * @brief Handle RDMRequests, ownership of the RDMRequest object is
    *   transferred
@@ -172,6 +190,63 @@ class OutputPort: public Port, ola::rdm::DiscoverableRDMControllerInterface {
    */
   virtual bool WriteDMX(const DmxBuffer &buffer, uint8_t priority) = 0;
 
+  /**
+   * @brief The number of consecutive universes this port takes.
+   *
+   * A port that takes more than one universe is patched to the first, and is
+   * sent the data for each of the others with WriteSpanDMX(). This must not
+   * change while the port is patched.
+   */
+  virtual unsigned int UniverseCount() const { return 1; }
+
+  /**
+   * @brief Write the DMX data for one of the universes after the one this
+   * port is patched to.
+   * @param index the index of the universe, 1 is the universe after the one
+   *   the port is patched to.
+   * @param buffer the DmxBuffer to write
+   * @param priority the priority of the DMX data
+   * @return true on success, false on failure
+   *
+   * The port's OutputCurve and DuplicateFrameFilter are only applied to the
+   * data passed to WriteDMX(). See SpanFrame for assembling the universes.
+   */
+  virtual bool WriteSpanDMX(unsigned int index,
+                            const DmxBuffer &buffer,
+                            uint8_t priority) {
+    (void) index;
+    (void) buffer;
+    (void) priority;
+    return false;
+  }
+
+  /**
+   * @brief Set the curve applied to the data before it's passed to
+   * WriteDMX().
+   * @param curve the OutputCurve to use, or NULL to send the data unchanged.
+   *   Ownership is transferred.
+   */
+  virtual void SetOutputCurve(OutputCurve *curve) = 0;
+
+  /**
+   * @brief Get the curve applied to the data for this port.
+   * @return the OutputCurve, or NULL if the data is sent unchanged.
+   */
+  virtual const OutputCurve *GetOutputCurve() const = 0;
+
+  /**
+   * @brief Set the filter that suppresses unchanged frames.
+   * @param filter the DuplicateFrameFilter to use, or NULL to write every
+   *   frame. Ownership is transferred.
+   */
+  virtual void SetDuplicateFrameFilter(DuplicateFrameFilter *filter) = 0;
+
+  /**
+   * @brief Get the filter that suppresses unchanged frames for this port.
+   * @return the DuplicateFrameFilter, or NULL if every frame is written.
+   */
+  virtual DuplicateFrameFilter *GetDuplicateFrameFilter() const = 0;
+
   /**
    * @brief Called if the universe name changes
    */
@@ -186,6 +261,16 @@ class OutputPort: public Port, ola::rdm::DiscoverableRDMControllerInterface {
   virtual void RunIncrementalDiscovery(
       ola::rdm::RDMDiscoveryCallback *on_complete) = 0;
 
+  /**
+   * @brief Restore the UIDs that were on this port when olad last stopped.
+   * @param uids the UIDs to restore.
+   *
+   * This is called before the port is patched. The UIDs are added to the
+   * universe as soon as the port is patched, and are replaced once discovery
+   * completes.
+   */
+  virtual void RestoreUIDs(const ola::rdm::UIDSet &uids) = 0;
+
   // timecode support
   virtual bool SupportsTimeCode() const = 0;
   virtual bool SendTimeCode(const ola::timecode::TimeCode &timecode) = 0;
@@ -205,6 +290,7 @@ class BasicInputPort: public InputPort {
                  unsigned int port_id,
                  const PluginAdaptor *plugin_adaptor,
                  bool supports_rdm = false);
+  virtual ~BasicInputPort();
 
   unsigned int PortId() const { return m_port_id; }
   AbstractDevice *GetDevice() const { return m_device; }
@@ -220,8 +306,41 @@ class BasicInputPort: public InputPort {
    * @brief Called when there is new data for this port
    */
   void DmxChanged();
+
+  /**
+   * @brief Called when there is new data for this port.
+   * @param ingress_time the time the data arrived on the host, e.g. the
+   *   kernel receive timestamp of the packet. If this isn't set, the time
+   *   the event loop woke up is used.
+   */
+  void DmxChangedAt(const TimeStamp &ingress_time);
   const DmxSource &SourceData() const { return m_dmx_source; }
 
+  void SetSuppressDuplicates(bool suppress);
+  bool GetSuppressDuplicates() const { return m_suppress_duplicates; }
+
+  /**
+   * @brief The number of frames which were suppressed as duplicates.
+   */
+  unsigned int DuplicateFrames() const { return m_duplicate_frames; }
+
+  /**
+   * @brief The frame interval stats for this port, or NULL if no frames have
+   * been received while it was patched.
+   */
+  const InputFrameStats *FrameStats() const { return m_frame_stats; }
+
+  /**
+   * @brief The number of duplicate frames, by port id.
+   */
+  static const char K_DUPLICATE_FRAMES_VAR[];
+
+  /**
+   * @brief How often a duplicate frame is merged anyway, so outputs which
+   * only send when they're written to, e.g. E1.31, keep sending.
+   */
+  static const unsigned int DUPLICATE_REFRESH_MS = 1000;
+
   // RDM methods, the child class provides HandleRDMResponse
   /**
    * @brief Handle an RDM Request on this port.
@@ -271,6 +390,16 @@ class BasicInputPort: public InputPort {
   DmxSource m_dmx_source;
   const PluginAdaptor *m_plugin_adaptor;
   bool m_supports_rdm;
+  bool m_suppress_duplicates;
+  // When a frame was last merged into the current universe, unset if there
+  // hasn't been one.
+  TimeStamp m_last_merge;
+  unsigned int m_duplicate_frames;
+  unsigned int *m_duplicate_frames_var;
+  InputFrameStats *m_frame_stats;
+
+  bool IsDuplicate(const DmxBuffer &buffer, uint8_t priority,
+                   const TimeStamp &now) const;
 
   DISALLOW_COPY_AND_ASSIGN(BasicInputPort);
 };
@@ -288,6 +417,7 @@ class BasicOutputPort: public OutputPort {
                   unsigned int port_id,
                   bool start_rdm_discovery_on_patch = false,
                   bool supports_rdm = false);
+  virtual ~BasicOutputPort();
 
   unsigned int PortId() const { return m_port_id; }
   AbstractDevice *GetDevice() const { return m_device; }
@@ -299,6 +429,14 @@ class BasicOutputPort: public OutputPort {
   void SetPriorityMode(port_priority_mode mode) { m_priority_mode = mode; }
   port_priority_mode GetPriorityMode() const { return m_priority_mode; }
 
+  void SetOutputCurve(OutputCurve *curve);
+  const OutputCurve *GetOutputCurve() const { return m_output_curve; }
+
+  void SetDuplicateFrameFilter(DuplicateFrameFilter *filter);
+  DuplicateFrameFilter *GetDuplicateFrameFilter() const {
+    return m_frame_filter;
+  }
+
   virtual void UniverseNameChanged(const std::string &new_name) {
     (void) new_name;
   }
@@ -324,6 +462,12 @@ class BasicOutputPort: public OutputPort {
   virtual void RunIncrementalDiscovery(
       ola::rdm::RDMDiscoveryCallback *on_complete);
 
+  /**
+   * @brief Subclasses can override this to pass the UIDs on to the
+   *   discovery code, they should also call this one.
+   */
+  virtual void RestoreUIDs(const ola::rdm::UIDSet &uids);
+
   // TimeCode
   virtual bool SupportsTimeCode() const { return false; }
 
@@ -358,6 +502,9 @@ class BasicOutputPort: public OutputPort {
   Universe *m_universe;  // the universe this port belongs to
   AbstractDevice *m_device;
   bool m_supports_rdm;
+  OutputCurve *m_output_curve;
+  DuplicateFrameFilter *m_frame_filter;
+  ola::rdm::UIDSet m_restored_uids;  // added to the universe on patching
 
   DISALLOW_COPY_AND_ASSIGN(BasicOutputPort);
 };
@@ -24,6 +24,8 @@
 
 #include <ola/base/Macro.h>
 #include <ola/Logging.h>
+#include <ola/Clock.h>
+#include <ola/thread/Mutex.h>
 #include <ola/thread/Thread.h>
 #include <ola/io/SelectServer.h>
 
@@ -293,6 +295,16 @@ class Preferences {
    */
   virtual std::string GetValue(const std::string &key) const = 0;
 
+  /**
+   * @brief Get a preference value as an unsigned int.
+   * @param key the key to fetch
+   * @param[out] value the value corresponding to key
+   * @return true if the key exists and its value is an unsigned int, false
+   * otherwise.
+   */
+  virtual bool GetValueAsUInt(const std::string &key,
+                              unsigned int *value) const = 0;
+
   /**
    * @brief Returns all preference values corresponding to this key
    * @param key the key to fetch
@@ -368,10 +380,15 @@ class PreferencesFactory {
 
 /*
  * MemoryPreferences just stores the preferences in memory. Useful for testing.
+ *
+ * Lookups go through a hash index of the keys, which also caches the parsed
+ * value for GetValueAsUInt(). Subclasses must modify the preferences with the
+ * setters, rather than changing m_pref_map directly, so the index stays in
+ * sync.
  */
 class MemoryPreferences: public Preferences {
  public:
-  explicit MemoryPreferences(const std::string name): Preferences(name) {}
+  explicit MemoryPreferences(const std::string name);
   virtual ~MemoryPreferences();
   virtual bool Load() { return true; }
   virtual bool Save() const { return true; }
@@ -403,6 +420,8 @@ class MemoryPreferences: public Preferences {
                                bool value);
 
   virtual std::string GetValue(const std::string &key) const;
+  virtual bool GetValueAsUInt(const std::string &key,
+                              unsigned int *value) const;
   virtual std::vector<std::string> GetMultipleValue(
       const std::string &key) const;
   virtual bool HasKey(const std::string &key) const;
@@ -420,6 +439,17 @@ class MemoryPreferences: public Preferences {
  protected:
   typedef std::multimap<std::string, std::string> PreferencesMap;
   PreferencesMap m_pref_map;
+  // True if the preferences may differ from the last Load() or Save().
+  mutable bool m_dirty;
+
+ private:
+  class KeyIndex;
+
+  // Maps each key to its first entry in m_pref_map.
+  KeyIndex *m_index;
+
+  PreferencesMap::const_iterator FindFirst(const std::string &key) const;
+  void IndexKey(const std::string &key);
 };
 
 
@@ -435,12 +465,23 @@ class MemoryPreferencesFactory: public PreferencesFactory {
 
 
 /**
- * The thread that saves preferences
+ * The thread that saves preferences.
+ *
+ * Saves are coalesced: the first save to a file starts the save delay, and
+ * only the latest preferences for each file are written once it expires.
+ * Files are written to a temporary file which is then renamed, so a crash
+ * never leaves a partially written file behind. Any pending saves are written
+ * when the thread is stopped.
  */
 class FilePreferenceSaverThread: public ola::thread::Thread {
  public:
   typedef std::multimap<std::string, std::string> PreferencesMap;
-  FilePreferenceSaverThread();
+
+  /**
+   * @param save_delay how long to wait for more changes before writing.
+   */
+  explicit FilePreferenceSaverThread(
+      const TimeInterval &save_delay = TimeInterval(DEFAULT_SAVE_DELAY_S, 0));
 
   void SavePreferences(const std::string &filename,
                        const PreferencesMap &preferences);
@@ -458,18 +499,31 @@ class FilePreferenceSaverThread: public ola::thread::Thread {
   /**
    * This can be used to syncronize with the file saving thread. Useful if you
    * want to make sure the files have been written to disk before continuing.
-   * This blocks until all pending save requests are complete.
+   * This writes any pending saves without waiting for the save delay, and
+   * blocks until they are complete.
    */
   void Syncronize();
 
  private:
+  typedef std::map<std::string, PreferencesMap> PendingSaves;
+
   ola::io::SelectServer m_ss;
+  const TimeInterval m_save_delay;
+  ola::thread::Mutex m_pending_mutex;
+  // The latest preferences for each file, protected by m_pending_mutex.
+  PendingSaves m_pending_saves;
+  bool m_flush_scheduled;
+
+  void ScheduleFlush();
+  void FlushPendingSaves();
 
   /**
    * Notify the blocked thread we're done
    */
   void CompleteSyncronization(ola::thread::ConditionVariable *condition,
                               ola::thread::Mutex *mutex);
+
+  static const unsigned int DEFAULT_SAVE_DELAY_S = 1;
 };
 
 
@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SpanFrame.h
+ * Assembles the universes of a port that spans several universes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_SPANFRAME_H_
+#define INCLUDE_OLAD_SPANFRAME_H_
+
+#include <ola/Callback.h>
+#include <ola/Constants.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace ola {
+
+/**
+ * @brief Assembles the universes of a port that spans several universes into
+ * a single frame.
+ *
+ * Pixel outputs often need more than 512 slots. A port that returns more than
+ * 1 from OutputPort::UniverseCount() is sent the data for each of its
+ * universes with OutputPort::WriteSpanDMX(), which it passes to Update().
+ * Each universe is copied straight into its place in the frame.
+ *
+ * The frame is sent once all the universes have arrived. If a universe
+ * arrives a second time first, some of the universes aren't changing, so the
+ * frame is sent as it is before the new data is copied in. Sync() sends a
+ * partial frame straight away, e.g. when a sync packet arrives.
+ */
+class SpanFrame {
+ public:
+  /**
+   * @brief Called with each complete frame.
+   */
+  typedef Callback2<void, const uint8_t*, unsigned int> FrameCallback;
+
+  /**
+   * @brief Create a new SpanFrame.
+   * @param universe_count the number of universes in the frame.
+   * @param callback the callback to run with each frame, ownership is
+   *   transferred.
+   * @param slots_per_universe the number of slots taken from each universe.
+   */
+  SpanFrame(unsigned int universe_count,
+            FrameCallback *callback,
+            unsigned int slots_per_universe = DMX_UNIVERSE_SIZE);
+
+  /**
+   * @brief The number of universes in the frame.
+   */
+  unsigned int UniverseCount() const { return m_universe_count; }
+
+  /**
+   * @brief The size of the frame.
+   */
+  unsigned int Size() const {
+    return static_cast<unsigned int>(m_frame.size());
+  }
+
+  /**
+   * @brief Update one of the universes.
+   * @param index the index of the universe in the frame, from 0.
+   * @param buffer the universe's data. Only the first slots_per_universe
+   *   slots are used, if the data is shorter the remaining slots keep their
+   *   previous values.
+   * @returns false if the index is out of range.
+   */
+  bool Update(unsigned int index, const DmxBuffer &buffer);
+
+  /**
+   * @brief Send the frame now, if any universes have been updated.
+   */
+  void Sync();
+
+ private:
+  const unsigned int m_universe_count;
+  const unsigned int m_slots_per_universe;
+  std::auto_ptr<FrameCallback> m_callback;
+  std::vector<uint8_t> m_frame;
+  std::vector<bool> m_updated;
+  unsigned int m_updated_count;
+
+  DISALLOW_COPY_AND_ASSIGN(SpanFrame);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_SPANFRAME_H_
@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ThreadPreferences.h
+ * The common preferences for plugins that run their own output threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_THREADPREFERENCES_H_
+#define INCLUDE_OLAD_THREADPREFERENCES_H_
+
+#include <ola/thread/Utils.h>
+#include <olad/Preferences.h>
+
+#include <string>
+
+namespace ola {
+
+/*
+ * Check a value is a list of CPUs, see ola::thread::ParseCPUList().
+ */
+class CPUListValidator: public Validator {
+ public:
+  CPUListValidator() {}
+  bool IsValid(const std::string &value) const;
+};
+
+
+/**
+ * @brief The preferences that control the scheduling of a plugin's output
+ * threads.
+ *
+ * Each plugin uses the same keys, so the threads are configured the same way
+ * everywhere. The keys can have a prefix, e.g. the device name, if each
+ * device has its own thread:
+ *  - rt-priority: the real time priority, 1 - 99. 0, the default, leaves the
+ *    scheduling unchanged.
+ *  - rt-policy: the real time policy, fifo (the default) or rr.
+ *  - cpu: the CPUs the thread runs on, e.g. "3" or "2-3". -1, the default,
+ *    means any CPU.
+ */
+class ThreadPreferences {
+ public:
+  /**
+   * @brief Set the default values for the keys.
+   * @param preferences the Preferences to update.
+   * @param prefix the prefix for the keys.
+   * @returns true if any values were changed, and so the preferences need to
+   *   be saved.
+   */
+  static bool SetDefaults(Preferences *preferences,
+                          const std::string &prefix = "");
+
+  /**
+   * @brief Read the scheduling options from the preferences.
+   * @param preferences the Preferences to read from.
+   * @param prefix the prefix for the keys.
+   * @returns the SchedulingOptions, which the thread should apply with
+   *   ola::thread::ApplySchedulingOptions() once it's running.
+   *
+   * Invalid values are logged and replaced by the defaults.
+   */
+  static ola::thread::SchedulingOptions Load(const Preferences *preferences,
+                                             const std::string &prefix = "");
+
+  static const char RT_PRIORITY_KEY[];
+  static const char RT_POLICY_KEY[];
+  static const char CPU_KEY[];
+
+  static const char FIFO_POLICY[];
+  static const char RR_POLICY[];
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_THREADPREFERENCES_H_
@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UDPSocketMonitor.h
+ * Configures the UDP sockets of a network plugin and exports their stats.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_UDPSOCKETMONITOR_H_
+#define INCLUDE_OLAD_UDPSOCKETMONITOR_H_
+
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/base/Macro.h>
+#include <ola/io/SelectServerInterface.h>
+#include <ola/network/Socket.h>
+#include <ola/thread/ExecutorInterface.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <olad/Preferences.h>
+
+#include <set>
+#include <string>
+
+namespace ola {
+
+/**
+ * @brief Configures the UDP sockets of a network plugin and exports their
+ * stats.
+ *
+ * Each socket added has its kernel buffer sizes set and drop counting
+ * enabled. Once a second the packets and bytes received and sent per second,
+ * and the total number of datagrams the kernel dropped, are exported with the
+ * plugin name as the key. Kernel drops are only counted on platforms that
+ * support SO_RXQ_OVFL.
+ *
+ * All methods must be called on the socket_loop thread. If that isn't the
+ * thread which owns the ExportMap, pass an export_executor and the ExportMap
+ * is updated on that instead.
+ */
+class UDPSocketMonitor {
+ public:
+  struct Options {
+   public:
+    Options()
+        : receive_buffer_size(0),
+          send_buffer_size(0) {
+    }
+
+    /**
+     * @brief The size of the kernel receive buffer, 0 leaves the system
+     * default.
+     */
+    unsigned int receive_buffer_size;
+    /**
+     * @brief The size of the kernel send buffer, 0 leaves the system
+     * default.
+     */
+    unsigned int send_buffer_size;
+  };
+
+  /**
+   * @brief Create a new UDPSocketMonitor.
+   * @param socket_loop the SelectServer the sockets are used on.
+   * @param export_map the ExportMap to update, may be NULL.
+   * @param plugin_name the key for this plugin's stats.
+   * @param options the socket options.
+   * @param export_executor if not NULL, the ExportMap is updated on this
+   *   executor rather than the socket_loop.
+   */
+  UDPSocketMonitor(ola::io::SelectServerInterface *socket_loop,
+                   ExportMap *export_map,
+                   const std::string &plugin_name,
+                   const Options &options,
+                   ola::thread::ExecutorInterface *export_executor = NULL);
+
+  /**
+   * @brief Destructor, this removes the plugin's stats.
+   */
+  ~UDPSocketMonitor();
+
+  /**
+   * @brief Configure a socket and add it to the stats.
+   * @param socket the socket, ownership is not transferred. It must be
+   *   removed before it's deleted.
+   */
+  void AddSocket(ola::network::UDPSocketInterface *socket);
+
+  /**
+   * @brief Stop monitoring a socket.
+   *
+   * The socket's traffic so far still counts towards the totals.
+   */
+  void RemoveSocket(ola::network::UDPSocketInterface *socket);
+
+  /**
+   * @brief Set the default values for the socket preferences.
+   * @returns true if the preferences changed and should be saved.
+   */
+  static bool SetDefaultPreferences(Preferences *preferences);
+
+  /**
+   * @brief Read the socket options from a plugin's preferences.
+   */
+  static Options OptionsFromPreferences(const Preferences *preferences);
+
+  static const char RECEIVE_BUFFER_SIZE_KEY[];
+  static const char SEND_BUFFER_SIZE_KEY[];
+
+  static const char K_PACKETS_RECEIVED_VAR[];
+  static const char K_BYTES_RECEIVED_VAR[];
+  static const char K_PACKETS_SENT_VAR[];
+  static const char K_BYTES_SENT_VAR[];
+  static const char K_KERNEL_DROPS_VAR[];
+
+  static const unsigned int UPDATE_INTERVAL_MS = 1000;
+
+ private:
+  typedef std::set<ola::network::UDPSocketInterface*> SocketSet;
+
+  struct ExportedStats {
+    unsigned int packets_received;
+    unsigned int bytes_received;
+    unsigned int packets_sent;
+    unsigned int bytes_sent;
+    unsigned int kernel_drops;
+  };
+
+  ola::io::SelectServerInterface *m_socket_loop;
+  ExportMap *m_export_map;
+  const std::string m_plugin_name;
+  const Options m_options;
+  ola::thread::ExecutorInterface *m_export_executor;
+  ola::thread::timeout_id m_timeout_id;
+  SocketSet m_sockets;
+  // The totals for the sockets which have been removed.
+  ola::network::UDPSocketStats m_removed;
+  ola::network::UDPSocketStats m_last;
+  TimeStamp m_last_update;
+
+  bool Update();
+  ola::network::UDPSocketStats Totals() const;
+
+  static void AddStats(const ola::network::UDPSocketStats &stats,
+                       ola::network::UDPSocketStats *total);
+  static unsigned int PerSecond(uint64_t delta, int64_t elapsed_ms);
+  static void Publish(ExportMap *export_map, std::string plugin_name,
+                      ExportedStats stats);
+  static void RemoveStats(ExportMap *export_map, std::string plugin_name);
+
+  DISALLOW_COPY_AND_ASSIGN(UDPSocketMonitor);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_UDPSOCKETMONITOR_H_
@@ -21,6 +21,7 @@
 #ifndef INCLUDE_OLAD_UNIVERSE_H_
 #define INCLUDE_OLAD_UNIVERSE_H_
 
+#include <stdint.h>
 #include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
 #include <ola/ExportMap.h>
@@ -49,6 +50,40 @@ class Universe: public ola::rdm::RDMControllerInterface {
       MERGE_LTP
     };
 
+    /**
+     * @brief Counters for the traffic through a universe.
+     *
+     * The counters only ever increase, rates are found by comparing two
+     * samples. Keeping them costs a few additions per frame, so they're
+     * always on.
+     */
+    struct Counters {
+      /** @brief Frames received from input ports and source clients. */
+      uint64_t input_frames;
+      /** @brief Frames sent to the output ports and sink clients. */
+      uint64_t output_frames;
+      /** @brief The number of times the priority of the output changed. */
+      uint64_t priority_changes;
+      /**
+       * @brief The intervals between input frames, in microseconds.
+       *
+       * Gaps longer than MAX_FRAME_INTERVAL_US aren't frame intervals and
+       * aren't counted.
+       */
+      uint64_t interval_count;
+      uint64_t interval_sum;
+      uint64_t interval_sum_squares;
+
+      Counters()
+          : input_frames(0),
+            output_frames(0),
+            priority_changes(0),
+            interval_count(0),
+            interval_sum(0),
+            interval_sum_squares(0) {
+      }
+    };
+
     Universe(unsigned int uid, class UniverseStore *store,
              ExportMap *export_map,
              Clock *clock);
@@ -77,10 +112,31 @@ class Universe: public ola::rdm::RDMControllerInterface {
       return m_last_discovery_time;
     }
 
+    /**
+     * @brief Return the maximum rate at which updates are sent to the
+     * output ports and sink clients.
+     * @return the frame rate in frames per second. A value of 0 means
+     * updates are sent as soon as new data arrives.
+     */
+    unsigned int MaxFrameRate() const { return m_max_frame_rate; }
+
     // Used to adjust the properties
     void SetName(const std::string &name);
     void SetMergeMode(merge_mode merge_mode);
 
+    /**
+     * @brief Limit the rate at which updates are sent to the output ports and
+     * sink clients.
+     * @param frame_rate the maximum number of frames per second, or 0 to send
+     * updates as soon as new data arrives.
+     *
+     * When a limit is set, data that arrives less than one frame interval
+     * after the last update is merged into the buffer and the universe is
+     * marked as dirty. The merged frame is sent by the next call to
+     * SendPendingUpdate().
+     */
+    void SetMaxFrameRate(unsigned int frame_rate);
+
     /**
      * Set the time between periodic RDM discovery operations.
      */
@@ -88,10 +144,49 @@ class Universe: public ola::rdm::RDMControllerInterface {
       m_rdm_discovery_interval = discovery_interval;
     }
 
+    /**
+     * @brief Set how long the responses to GETs of static PIDs are cached.
+     * @param ttl the time to cache responses for, 0 disables the cache.
+     *
+     * The cached responses are used for requests from the web UI and
+     * clients, rather than sending the request to the responder again.
+     */
+    void SetRDMCacheTTL(const TimeInterval &ttl);
+
     // Each universe has a DMXBuffer
     bool SetDMX(const DmxBuffer &buffer);
     const DmxBuffer &GetDMX() const { return m_buffer; }
 
+    /**
+     * @brief The UniverseStore generation when the data last changed.
+     *
+     * This is 0 if the data hasn't changed since the universe was created.
+     */
+    uint64_t Generation() const { return m_generation; }
+
+    /**
+     * @brief The UniverseStore info generation when the name, merge mode,
+     *   ports or RDM devices of this universe last changed.
+     */
+    uint64_t InfoGeneration() const { return m_info_generation; }
+
+    /**
+     * @brief Mark the info for this universe as changed.
+     *
+     * This is called by the universe itself, and when something it reports
+     * changes elsewhere, e.g. the priority of one of its ports.
+     */
+    void InfoChanged();
+
+    /**
+     * @brief Set the data saved before a restart.
+     * @param buffer the saved data.
+     *
+     * Output ports are sent this data as they're added, until the first new
+     * frame is sent.
+     */
+    void RestoreDMX(const DmxBuffer &buffer);
+
     // These are the ports we need to nofity when data changes
     bool AddPort(InputPort *port);
     bool AddPort(OutputPort *port);
@@ -104,6 +199,24 @@ class Universe: public ola::rdm::RDMControllerInterface {
     void InputPorts(std::vector<InputPort*> *ports) const;
     void OutputPorts(std::vector<OutputPort*> *ports) const;
 
+    /**
+     * @brief Add a port, patched to an earlier universe, which also takes
+     *   this universe.
+     * @param port the OutputPort.
+     * @param index the index of this universe in the port's span.
+     */
+    void AddSpanPort(OutputPort *port, unsigned int index);
+
+    /**
+     * @brief Remove a port added with AddSpanPort().
+     */
+    void RemoveSpanPort(OutputPort *port);
+
+    /**
+     * @brief The number of ports added with AddSpanPort().
+     */
+    unsigned int SpanPortCount() const { return m_span_ports.size(); }
+
     // Source clients are those that provide us with data
     bool AddSourceClient(Client *client);
     bool RemoveSourceClient(Client *client);
@@ -116,13 +229,54 @@ class Universe: public ola::rdm::RDMControllerInterface {
     bool ContainsSinkClient(Client *client) const;
     unsigned int SinkClientCount() const { return m_sink_clients.size(); }
 
+    /**
+     * @brief The number of input ports and source clients with data which
+     *   hasn't timed out.
+     */
+    unsigned int ActiveSourceCount() const {
+      return m_source_priorities.size();
+    }
+
+    /**
+     * @brief Return the counters for this universe.
+     */
+    const Counters &GetCounters() const { return m_counters; }
+
     // These are called when new data arrives on a port/client
     bool PortDataChanged(InputPort *port);
     bool SourceClientDataChanged(Client *client);
 
-    // This is can be called periodically to clean stale clients
-    //    stale == client that has not sent data
-    void CleanStaleSourceClients();
+    /**
+     * @brief Check if there is merged data that hasn't been sent yet.
+     */
+    bool UpdatePending() const { return m_update_pending; }
+
+    /**
+     * @brief The earliest time a pending update can be sent.
+     */
+    TimeStamp NextUpdateTime() const {
+      return m_last_update_time + m_frame_interval;
+    }
+
+    /**
+     * @brief Send any pending update, if a frame interval has passed.
+     * @param now the current time.
+     * @returns true if the update was sent, or there was nothing to send,
+     * false if the update is still pending.
+     */
+    bool SendPendingUpdate(const TimeStamp &now);
+
+    /**
+     * @brief Remove the source clients whose data has timed out.
+     * @param now the current time.
+     * @returns the time the next source times out, this isn't set if no
+     *   sources have data.
+     *
+     * If a source that was being used has timed out, the remaining sources
+     * are merged again. UniverseStore calls this when the first source
+     * times out, see UniverseStore::ScheduleSourceExpiry().
+     */
+    TimeStamp ExpireSources(const TimeStamp &now);
 
     // RDM methods
     void SendRDMRequest(ola::rdm::RDMRequest *request,
@@ -131,8 +285,22 @@ class Universe: public ola::rdm::RDMControllerInterface {
                          bool full = true);
     void NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids);
     void GetUIDs(ola::rdm::UIDSet *uids) const;
+    void GetUIDs(const OutputPort *port, ola::rdm::UIDSet *uids) const;
     unsigned int UIDCount() const;
 
+    /**
+     * @brief Estimate the memory used by this universe, in bytes.
+     *
+     * This covers the universe's buffers, the source and port tables and the
+     * RDM state, but not the RDM response cache, see RDMCacheMemoryUsage().
+     */
+    size_t MemoryUsage() const;
+
+    /**
+     * @brief Estimate the memory used by the RDM response cache, in bytes.
+     */
+    size_t RDMCacheMemoryUsage() const;
+
     bool operator==(const Universe &other) {
       return m_universe_id == other.UniverseId();
     }
@@ -148,6 +316,14 @@ class Universe: public ola::rdm::RDMControllerInterface {
     static const char K_UNIVERSE_SINK_CLIENTS_VAR[];
     static const char K_UNIVERSE_SOURCE_CLIENTS_VAR[];
     static const char K_UNIVERSE_UID_COUNT_VAR[];
+    static const char K_UNIVERSE_OUTPUT_LATENCY_VAR[];
+    static const char K_PLUGIN_OUTPUT_LATENCY_VAR[];
+    static const char K_PORT_SUPPRESSED_FRAMES_VAR[];
+
+    /**
+     * @brief The longest interval between input frames that is counted.
+     */
+    static const int64_t MAX_FRAME_INTERVAL_US = 2000000;
 
  private:
     typedef struct {
@@ -158,7 +334,24 @@ class Universe: public ola::rdm::RDMControllerInterface {
       std::vector<rdm::RDMFrame> frames;
     } broadcast_request_tracker;
 
-    typedef std::map<Client*, bool> SourceClientMap;
+    typedef std::set<Client*> SourceClientSet;
+    // A source of data, either an input port or a source client.
+    typedef std::pair<const InputPort*, const Client*> SourceKey;
+    typedef std::map<uint8_t, std::set<SourceKey> > PriorityBuckets;
+
+    // The per-universe UIntMap variables, in the order of K_STAT_VARS.
+    enum universe_stat {
+      FPS_STAT,
+      INPUT_PORT_STAT,
+      OUTPUT_PORT_STAT,
+      RDM_REQUESTS_STAT,
+      SINK_CLIENTS_STAT,
+      SOURCE_CLIENTS_STAT,
+      UID_COUNT_STAT,
+      STAT_COUNT,
+    };
+
+    static const char *const K_STAT_VARS[];
 
     std::string m_universe_name;
     unsigned int m_universe_id;
@@ -167,36 +360,102 @@ class Universe: public ola::rdm::RDMControllerInterface {
     enum merge_mode m_merge_mode;  // merge mode
     std::vector<InputPort*> m_input_ports;
     std::vector<OutputPort*> m_output_ports;
+    // Ports patched to an earlier universe which also take this one, and the
+    // index of this universe in each port's span.
+    std::map<OutputPort*, unsigned int> m_span_ports;
     std::set<Client*> m_sink_clients;  // clients that require updates
-    /**
-     * Tracks current source clients and whether or not they are stale.
-     * true == stale and can be removed, false == active is to be kept
-     */
-    SourceClientMap m_source_clients;
+    SourceClientSet m_source_clients;  // clients that provide data
+    // The priority each source last sent data with, and the sources at each
+    // priority. This lets MergeAll() ignore a source that is outranked
+    // without looking at every source.
+    std::map<SourceKey, uint8_t> m_source_priorities;
+    PriorityBuckets m_priority_buckets;
     class UniverseStore *m_universe_store;
     DmxBuffer m_buffer;
     ExportMap *m_export_map;
-    std::map<ola::rdm::UID, OutputPort*> m_output_uids;
+    // Our entries in the UIntMap variables, resolved once so that updates
+    // don't need a lookup by name. These are NULL if there is no ExportMap.
+    unsigned int *m_stats[STAT_COUNT];
+    // The time the data in m_buffer arrived on the host, may not be set.
+    TimeStamp m_ingress_time;
+    // The latency from ingress to the output ports being written to, this is
+    // created when the first latency is recorded.
+    HistogramVariable *m_output_latency;
+    // The latency from ingress to each port's WriteDMX() returning, which is
+    // recorded per plugin.
+    std::map<OutputPort*, HistogramVariable*> m_port_latency;
+    // The count of unchanged frames that weren't written, for each port with
+    // a DuplicateFrameFilter.
+    std::map<OutputPort*, unsigned int*> m_port_suppressed;
+    // The UIDs and the RDM request handling. This is created the first time
+    // the universe has RDM devices or is sent a request, so DMX only
+    // universes don't pay for it.
+    struct RDMState;
+    RDMState *m_rdm;
+    TimeInterval m_rdm_cache_ttl;
     Clock *m_clock;
     TimeInterval m_rdm_discovery_interval;
     TimeStamp m_last_discovery_time;
+    unsigned int m_max_frame_rate;
+    TimeInterval m_frame_interval;
+    TimeStamp m_last_update_time;
+    TimeStamp m_last_sink_update;
+    bool m_update_pending;
+    // True if m_buffer holds restored data that hasn't been replaced yet.
+    bool m_restored;
+    Counters m_counters;
+    // The time the last input frame arrived, and the priority of the last
+    // frame sent.
+    TimeStamp m_last_input_time;
+    uint8_t m_sent_priority;
+    // The store's generation when m_buffer last changed.
+    uint64_t m_generation;
+    uint64_t m_info_generation;
+    // Holds the corrected data for ports with an OutputCurve.
+    DmxBuffer m_curve_buffer;
+    // Scratch space for MergeAll(), kept so a merge doesn't allocate.
+    std::vector<DmxSource> m_active_sources;
+    std::vector<const DmxBuffer*> m_merge_buffers;
 
     void HandleBroadcastAck(broadcast_request_tracker *tracker,
                             ola::rdm::RDMReply *reply);
     void HandleBroadcastDiscovery(broadcast_request_tracker *tracker,
                                   ola::rdm::RDMReply *reply);
+    void HandleRDMReply(ola::rdm::RDMRequest *request,
+                        ola::rdm::RDMCallback *callback,
+                        ola::rdm::RDMReply *reply);
+    void RecordRDMTiming(std::string port_id,
+                         ola::rdm::UID uid,
+                         uint16_t pid,
+                         ola::rdm::RDMCallback *callback,
+                         ola::rdm::RDMReply *reply);
+    RDMState *GetRDMState();
     bool UpdateDependants();
+    void SendUpdate(const TimeStamp &now);
+    void WriteToPort(OutputPort *port, const TimeStamp &now);
     void UpdateName();
     void UpdateMode();
-    void HTPMergeSources(const std::vector<DmxSource> &sources);
-    bool MergeAll(const InputPort *port, const Client *client);
+    void HTPMergeSources();
+    bool MergeAll(const InputPort *port, const Client *client,
+                  const TimeStamp &now);
+    bool MergeActiveSources(const InputPort *port, const Client *client,
+                            const TimeStamp &now);
+    void Remerge(const TimeStamp &now);
+    bool IsMerged(const SourceKey &key) const;
+    DmxSource LookupSource(const SourceKey &key) const;
+    void TrackSource(const SourceKey &key, const DmxSource &source);
+    void UntrackSource(const SourceKey &key);
+    bool IsOutranked(uint8_t priority, const TimeStamp &now);
     void PortDiscoveryComplete(BaseCallback0<void> *on_complete,
                                OutputPort *output_port,
                                const ola::rdm::UIDSet &uids);
     void DiscoveryComplete(ola::rdm::RDMDiscoveryCallback *on_complete);
 
-    void SafeIncrement(const std::string &name);
-    void SafeDecrement(const std::string &name);
+    void SafeIncrement(universe_stat stat);
+    void SafeDecrement(universe_stat stat);
+    void SafeSet(universe_stat stat, unsigned int value);
+    void RecordLatency(HistogramVariable *histogram, const TimeStamp &now);
+    void RecordInput(const TimeStamp &now);
 
     template<class PortClass>
     bool GenericAddPort(PortClass *port,
@@ -129,22 +129,24 @@ bool BaseInflator::DecodeLength(const uint8_t *data,
 
   if (flags & LFLAG_MASK) {
     if (length < 3) {
-      OLA_WARN << "PDU length " << length << " < 3 and the LENGTH bit is set";
+      OLA_WARN_RATE_LIMITED(10) << "PDU length " << length
+                                << " < 3 and the LENGTH bit is set";
       return false;
     }
     *bytes_used = 3;
     *pdu_length = JoinUInt8(0, (data[0] & LENGTH_MASK), data[1], data[2]);
   } else {
     if (length < 2) {
-      OLA_WARN << "PDU length " << length << " < 2";
+      OLA_WARN_RATE_LIMITED(10) << "PDU length " << length << " < 2";
       return false;
     }
     *bytes_used = 2;
     *pdu_length = JoinUInt8((data[0] & LENGTH_MASK), data[1]);
   }
   if (*pdu_length < *bytes_used) {
-    OLA_WARN << "PDU length was set to " << *pdu_length << " but "
-             << *bytes_used << " bytes were used in the header";
+    OLA_WARN_RATE_LIMITED(10) << "PDU length was set to " << *pdu_length
+                              << " but " << *bytes_used
+                              << " bytes were used in the header";
     *bytes_used = 0;
     return false;
   }
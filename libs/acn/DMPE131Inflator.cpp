@@ -18,12 +18,13 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <string.h>
 #include <sys/time.h>
 #include <algorithm>
-#include <map>
-#include <memory>
 #include <vector>
 #include "ola/Logging.h"
+#include "ola/network/NetworkUtils.h"
+#include "ola/stl/STLUtils.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/DMPHeader.h"
 #include "libs/acn/DMPPDU.h"
@@ -34,19 +35,34 @@ namespace acn {
 using ola::Callback0;
 using ola::acn::CID;
 using ola::io::OutputStream;
-using std::map;
-using std::pair;
+using ola::network::NetworkToHost;
 using std::vector;
 
 const TimeInterval DMPE131Inflator::EXPIRY_INTERVAL(2500000);
 
 
+DMPE131Inflator::DMPE131Inflator(bool ignore_preview, bool per_slot_priority)
+    : DMPInflator(),
+      m_ignore_preview(ignore_preview),
+      m_per_slot_priority(per_slot_priority) {
+  memset(m_handler_pages, 0, sizeof(m_handler_pages));
+}
+
+
 DMPE131Inflator::~DMPE131Inflator() {
-  UniverseHandlers::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
+  for (unsigned int i = 0; i < HANDLER_PAGE_COUNT; i++) {
+    universe_handler **page = m_handler_pages[i];
+    if (!page) {
+      continue;
+    }
+    for (unsigned int j = 0; j < HANDLER_PAGE_SIZE; j++) {
+      if (page[j]) {
+        delete page[j]->closure;
+        delete page[j];
+      }
+    }
+    delete[] page;
   }
-  m_handlers.clear();
 }
 
 
@@ -62,19 +78,11 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     return true;
   }
 
-  E131Header e131_header = headers.GetE131Header();
-  UniverseHandlers::iterator universe_iter =
-      m_handlers.find(e131_header.Universe());
-
-  if (e131_header.PreviewData() && m_ignore_preview) {
-    OLA_DEBUG << "Ignoring preview data";
-    return true;
-  }
-
-  if (universe_iter == m_handlers.end())
+  const E131Header &e131_header = headers.GetE131Header();
+  if (!LookupHandler(e131_header.Universe()))
     return true;
 
-  DMPHeader dmp_header = headers.GetDMPHeader();
+  const DMPHeader &dmp_header = headers.GetDMPHeader();
 
   if (!dmp_header.IsVirtual() || dmp_header.IsRelative() ||
       dmp_header.Size() != TWO_BYTES ||
@@ -83,84 +91,120 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     return true;
   }
 
-  if (e131_header.Priority() > MAX_E131_PRIORITY) {
-    OLA_INFO << "Priority " << static_cast<int>(e131_header.Priority())
-             << " is greater than the max priority ("
-             << static_cast<int>(MAX_E131_PRIORITY) << "), ignoring data";
-    return true;
-  }
-
-  unsigned int available_length = pdu_len;
-  std::auto_ptr<const BaseDMPAddress> address(
-      DecodeAddress(dmp_header.Size(),
-                    dmp_header.Type(),
-                    data,
-                    &available_length));
-
-  if (!address.get()) {
+  // We've checked the address type above, so decode the two byte range
+  // address here rather than using DecodeAddress(), which allocates.
+  uint16_t fields[3];
+  if (pdu_len < sizeof(fields)) {
     OLA_INFO << "DMP address parsing failed, the length is probably too small";
     return true;
   }
-
-  if (address->Increment() != 1) {
-    OLA_INFO << "E1.31 DMP packet with increment " << address->Increment()
+  memcpy(fields, data, sizeof(fields));
+  const TwoByteRangeDMPAddress address(NetworkToHost(fields[0]),
+                                       NetworkToHost(fields[1]),
+                                       NetworkToHost(fields[2]));
+  const unsigned int available_length = sizeof(fields);
+
+  if (address.Increment() != 1) {
+    OLA_INFO << "E1.31 DMP packet with increment " << address.Increment()
       << ", disarding";
     return true;
   }
 
+  DataPacket packet;
+  packet.cid = headers.GetRootHeader().CidData();
+  packet.universe = e131_header.Universe();
+  packet.priority = e131_header.Priority();
+  packet.sequence = e131_header.Sequence();
+  packet.sync_address = e131_header.SyncAddress();
+  packet.preview = e131_header.PreviewData();
+  packet.terminated = e131_header.StreamTerminated();
+  packet.receive_time = headers.GetTransportHeader().ReceiveTime();
+
   unsigned int length_remaining = pdu_len - available_length;
-  int start_code = -1;
-  if (e131_header.UsingRev2())
-    start_code = static_cast<int>(address->Start());
-  else if (length_remaining && address->Number())
-    start_code = *(data + available_length);
+  unsigned int channels = std::min(length_remaining, address.Number());
+  packet.start_code = -1;
+  packet.slots = data + available_length;
+  packet.slot_count = channels;
+  if (e131_header.UsingRev2()) {
+    packet.start_code = static_cast<int>(address.Start());
+  } else if (channels) {
+    packet.start_code = *packet.slots;
+    packet.slots++;
+    packet.slot_count--;
+  }
+
+  HandleDataPacket(packet);
+  return true;
+}
+
+
+void DMPE131Inflator::HandleDataPacket(const DataPacket &packet) {
+  universe_handler *universe_data = LookupHandler(packet.universe);
+  m_receive_time = packet.receive_time;
+
+  if (packet.preview && m_ignore_preview) {
+    OLA_DEBUG << "Ignoring preview data";
+    return;
+  }
+
+  if (!universe_data)
+    return;
+
+  CheckSyncAddress(universe_data, packet.sync_address);
+
+  if (packet.priority > MAX_E131_PRIORITY) {
+    OLA_INFO << "Priority " << static_cast<int>(packet.priority)
+             << " is greater than the max priority ("
+             << static_cast<int>(MAX_E131_PRIORITY) << "), ignoring data";
+    return;
+  }
 
   // The only time we want to continue processing a non-0 start code is if it
-  // contains a Terminate message.
-  if (start_code && !e131_header.StreamTerminated()) {
+  // contains a Terminate message, or it's per-slot priority data and we're
+  // merging using per-slot priorities.
+  const int start_code = packet.start_code;
+  bool is_slot_priority_data = (m_per_slot_priority &&
+                                start_code == PER_SLOT_PRIORITY_START_CODE);
+  if (start_code && !is_slot_priority_data && !packet.terminated) {
     OLA_INFO << "Skipping packet with non-0 start code: " << start_code;
-    return true;
+    return;
+  }
+
+  if (m_per_slot_priority) {
+    HandlePerSlotData(universe_data, packet);
+    return;
   }
 
   DmxBuffer *target_buffer;
-  if (!TrackSourceIfRequired(&universe_iter->second, headers,
-                             &target_buffer)) {
+  if (!TrackSourceIfRequired(universe_data, packet, &target_buffer)) {
     // no need to continue processing
-    return true;
+    return;
   }
 
   // Reaching here means that we actually have new data and we should merge.
   if (target_buffer && start_code == 0) {
-    unsigned int channels = std::min(length_remaining, address->Number());
-    if (e131_header.UsingRev2())
-      target_buffer->Set(data + available_length, channels);
-    else
-     target_buffer->Set(data + available_length + 1, channels - 1);
+    target_buffer->Set(packet.slots, packet.slot_count);
   }
 
-  if (universe_iter->second.priority)
-    *universe_iter->second.priority = universe_iter->second.active_priority;
+  SetOutputPriority(universe_data, universe_data->active_priority);
 
   // merge the sources
-  switch (universe_iter->second.sources.size()) {
+  DmxBuffer *output = OutputBuffer(universe_data);
+  switch (universe_data->source_count) {
     case 0:
-      universe_iter->second.buffer->Reset();
+      output->Reset();
       break;
     case 1:
-      universe_iter->second.buffer->Set(
-          universe_iter->second.sources[0].buffer);
-      universe_iter->second.closure->Run();
+      output->Set(universe_data->sources[0].buffer);
+      DataReady(universe_data);
       break;
     default:
       // HTP Merge
-      universe_iter->second.buffer->Reset();
-      std::vector<dmx_source>::const_iterator source_iter =
-        universe_iter->second.sources.begin();
-      for (; source_iter != universe_iter->second.sources.end(); ++source_iter)
-        universe_iter->second.buffer->HTPMerge(source_iter->buffer);
-      universe_iter->second.closure->Run();
+      output->Reset();
+      for (unsigned int i = 0; i < universe_data->source_count; i++)
+        output->HTPMerge(universe_data->sources[i].buffer);
+      DataReady(universe_data);
   }
-  return true;
 }
 
 
@@ -178,20 +222,35 @@ bool DMPE131Inflator::SetHandler(uint16_t universe,
   if (!closure || !buffer)
     return false;
 
-  UniverseHandlers::iterator iter = m_handlers.find(universe);
+  universe_handler *handler = LookupHandler(universe);
 
-  if (iter == m_handlers.end()) {
-    universe_handler handler;
-    handler.buffer = buffer;
-    handler.closure = closure;
-    handler.active_priority = 0;
-    handler.priority = priority;
-    m_handlers[universe] = handler;
+  if (!handler) {
+    universe_handler ***page = &m_handler_pages[universe / HANDLER_PAGE_SIZE];
+    if (!*page) {
+      *page = new universe_handler*[HANDLER_PAGE_SIZE]();
+    }
+    handler = new universe_handler();
+    handler->buffer = buffer;
+    handler->closure = closure;
+    handler->active_priority = 0;
+    handler->priority = priority;
+    handler->source_count = 0;
+    handler->slot_state.length = 0;
+    memset(handler->slot_state.winners, NO_SOURCE,
+           sizeof(handler->slot_state.winners));
+    memset(handler->slot_state.values, 0, sizeof(handler->slot_state.values));
+    memset(handler->slot_state.priorities, 0,
+           sizeof(handler->slot_state.priorities));
+    handler->sync_address = 0;
+    handler->holding = false;
+    handler->sync_pending = false;
+    handler->sync_priority = 0;
+    (*page)[universe % HANDLER_PAGE_SIZE] = handler;
   } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    iter->second.buffer = buffer;
-    iter->second.priority = priority;
+    Callback0<void> *old_closure = handler->closure;
+    handler->closure = closure;
+    handler->buffer = buffer;
+    handler->priority = priority;
     delete old_closure;
   }
   return true;
@@ -204,18 +263,54 @@ bool DMPE131Inflator::SetHandler(uint16_t universe,
  * @param true if removed, false if it didn't exist
  */
 bool DMPE131Inflator::RemoveHandler(uint16_t universe) {
-  UniverseHandlers::iterator iter = m_handlers.find(universe);
-
-  if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
-    m_handlers.erase(iter);
-    delete old_closure;
+  universe_handler *handler = LookupHandler(universe);
+
+  if (handler) {
+    m_handler_pages[universe / HANDLER_PAGE_SIZE][
+        universe % HANDLER_PAGE_SIZE] = NULL;
+    vector<universe_handler*>::iterator iter = std::find(
+        m_sync_pending.begin(), m_sync_pending.end(), handler);
+    if (iter != m_sync_pending.end()) {
+      m_sync_pending.erase(iter);
+    }
+    delete handler->closure;
+    delete handler;
     return true;
   }
   return false;
 }
 
 
+void DMPE131Inflator::HandleSync(uint16_t sync_address) {
+  if (!sync_address) {
+    return;
+  }
+  m_clock.CurrentTime(&m_sync_times[sync_address]);
+
+  // Take the universes first, since the closures may change the handlers.
+  vector<universe_handler*> ready;
+  vector<universe_handler*>::iterator iter = m_sync_pending.begin();
+  while (iter != m_sync_pending.end()) {
+    if ((*iter)->sync_address == sync_address) {
+      ready.push_back(*iter);
+      iter = m_sync_pending.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  for (iter = ready.begin(); iter != ready.end(); ++iter) {
+    universe_handler *handler = *iter;
+    handler->sync_pending = false;
+    handler->buffer->Set(handler->sync_buffer);
+    if (handler->priority) {
+      *handler->priority = handler->sync_priority;
+    }
+    handler->closure->Run();
+  }
+}
+
+
 /**
  * Get the list of registered universes
  * @param universes a pointer to a vector which is populated with the list of
@@ -223,10 +318,66 @@ bool DMPE131Inflator::RemoveHandler(uint16_t universe) {
  */
 void DMPE131Inflator::RegisteredUniverses(vector<uint16_t> *universes) {
   universes->clear();
-  UniverseHandlers::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    universes->push_back(iter->first);
+  for (unsigned int i = 0; i < HANDLER_PAGE_COUNT; i++) {
+    if (!m_handler_pages[i]) {
+      continue;
+    }
+    for (unsigned int j = 0; j < HANDLER_PAGE_SIZE; j++) {
+      if (m_handler_pages[i][j]) {
+        universes->push_back(
+            static_cast<uint16_t>(i * HANDLER_PAGE_SIZE + j));
+      }
+    }
+  }
+}
+
+
+bool DMPE131Inflator::SourceStatistics(uint16_t universe,
+                                       vector<SourceStats> *stats) const {
+  const universe_handler *handler = LookupHandler(universe);
+  if (!handler) {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < handler->source_count; i++) {
+    const dmx_source &source = handler->sources[i];
+    SourceStats source_stats;
+    source_stats.cid = source.cid;
+    source_stats.packets = source.packets;
+    source_stats.sequence_gaps = source.sequence_gaps;
+    source_stats.out_of_order = source.out_of_order;
+    source_stats.last_priority = source.priority;
+    stats->push_back(source_stats);
+  }
+  return true;
+}
+
+
+size_t DMPE131Inflator::MemoryUsage() const {
+  // Buffers which hold data each reference a frame from the DmxBuffer pool.
+  size_t bytes = STLNodeMemoryUsage(m_sync_times) +
+      STLVectorMemoryUsage(m_sync_pending);
+  for (unsigned int i = 0; i < HANDLER_PAGE_COUNT; i++) {
+    universe_handler **page = m_handler_pages[i];
+    if (!page) {
+      continue;
+    }
+    bytes += HANDLER_PAGE_SIZE * sizeof(universe_handler*);
+    for (unsigned int j = 0; j < HANDLER_PAGE_SIZE; j++) {
+      const universe_handler *handler = page[j];
+      if (!handler) {
+        continue;
+      }
+      bytes += sizeof(*handler) +
+          (handler->sync_buffer.Size() ? DMX_UNIVERSE_SIZE : 0);
+      for (unsigned int k = 0; k < handler->source_count; k++) {
+        const dmx_source &source = handler->sources[k];
+        bytes += (source.buffer.Size() ? DMX_UNIVERSE_SIZE : 0) +
+            (source.slot_priorities.Size() ? DMX_UNIVERSE_SIZE : 0);
+      }
+    }
   }
+  return bytes;
 }
 
 
@@ -235,121 +386,540 @@ void DMPE131Inflator::RegisteredUniverses(vector<uint16_t> *universes) {
  * This takes care of tracking all sources for a universe at the active
  * priority.
  * @param universe_data the universe_handler struct for this universe,
- * @param HeaderSet the set of headers in this packet
+ * @param packet the packet being handled.
  * @param buffer, if set to a non-NULL pointer, the caller should copy the data
  * in the buffer.
  * @returns true if we should remerge the data, false otherwise.
  */
 bool DMPE131Inflator::TrackSourceIfRequired(
     universe_handler *universe_data,
-    const HeaderSet &headers,
+    const DataPacket &packet,
     DmxBuffer **buffer) {
 
   *buffer = NULL;  // default the buffer to NULL
   ola::TimeStamp now;
   m_clock.CurrentTime(&now);
-  const E131Header &e131_header = headers.GetE131Header();
-  uint8_t priority = e131_header.Priority();
-  vector<dmx_source> &sources = universe_data->sources;
-  vector<dmx_source>::iterator iter = sources.begin();
-
-  while (iter != sources.end()) {
-    if (iter->cid != headers.GetRootHeader().GetCid()) {
-      TimeStamp expiry_time = iter->last_heard_from + EXPIRY_INTERVAL;
-      if (now > expiry_time) {
-        OLA_INFO << "source " << iter->cid.ToString() << " has expired";
-        iter = sources.erase(iter);
-        continue;
-      }
-    }
-    iter++;
-  }
+  uint8_t priority = packet.priority;
+  cid_key key;
+  MakeKey(packet.cid, &key);
 
-  if (sources.empty())
+  ExpireSources(universe_data, key, now);
+
+  if (!universe_data->source_count)
     universe_data->active_priority = 0;
 
-  for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    if (iter->cid == headers.GetRootHeader().GetCid())
-      break;
-  }
+  unsigned int index = FindSource(*universe_data, key);
 
-  if (iter == sources.end()) {
+  if (index == NO_SOURCE) {
     // This is an untracked source
-    if (e131_header.StreamTerminated() ||
+    if (packet.terminated ||
         priority < universe_data->active_priority)
       return false;
 
     if (priority > universe_data->active_priority) {
       OLA_INFO << "Raising priority for universe " <<
-        e131_header.Universe() << " from " <<
+        packet.universe << " from " <<
         static_cast<int>(universe_data->active_priority) << " to " <<
         static_cast<int>(priority);
-      sources.clear();
+      universe_data->source_count = 0;
       universe_data->active_priority = priority;
     }
 
-    if (sources.size() == MAX_MERGE_SOURCES) {
+    if (universe_data->source_count == MAX_MERGE_SOURCES) {
       // TODO(simon): flag this in the export map
-      OLA_WARN << "Max merge sources reached for universe " <<
-        e131_header.Universe() << ", " <<
-        headers.GetRootHeader().GetCid().ToString() << " won't be tracked";
+      OLA_WARN_RATE_LIMITED(1) << "Max merge sources reached for universe " <<
+        packet.universe << ", " << CID::FromData(packet.cid).ToString() <<
+        " won't be tracked";
         return false;
     } else {
-      OLA_INFO << "Added new E1.31 source: " <<
-        headers.GetRootHeader().GetCid().ToString();
-      dmx_source new_source;
-      new_source.cid = headers.GetRootHeader().GetCid();
-      new_source.sequence = e131_header.Sequence();
-      new_source.last_heard_from = now;
-      iter = sources.insert(sources.end(), new_source);
-      *buffer = &iter->buffer;
+      dmx_source *source = AddSource(universe_data, key, packet, now);
+      OLA_INFO << "Added new E1.31 source: " << source->cid.ToString();
+      *buffer = &source->buffer;
       return true;
     }
 
   } else {
     // We already know about this one, check the seq #
-    int8_t seq_diff = static_cast<int8_t>(e131_header.Sequence() -
-                                          iter->sequence);
-    if (seq_diff <= 0 && seq_diff > SEQUENCE_DIFF_THRESHOLD) {
-      OLA_INFO << "Old packet received, ignoring, this # " <<
-        static_cast<int>(e131_header.Sequence()) << ", last " <<
-        static_cast<int>(iter->sequence);
+    dmx_source *source = &universe_data->sources[index];
+    if (!CheckSequence(source, packet.sequence)) {
       return false;
     }
-    iter->sequence = e131_header.Sequence();
 
-    if (e131_header.StreamTerminated()) {
-      OLA_INFO << "CID " << headers.GetRootHeader().GetCid().ToString() <<
-        " sent a termination for universe " << e131_header.Universe();
-      sources.erase(iter);
-      if (sources.empty())
+    if (packet.terminated) {
+      OLA_INFO << "CID " << CID::FromData(packet.cid).ToString() <<
+        " sent a termination for universe " << packet.universe;
+      RemoveSource(universe_data, index);
+      if (!universe_data->source_count)
         universe_data->active_priority = 0;
       // We need to trigger a merge here else the buffer will be stale, we keep
       // the buffer as NULL though so we don't use the data.
       return true;
     }
 
-    iter->last_heard_from = now;
+    source->last_heard_from = now;
+    source->priority = priority;
     if (priority < universe_data->active_priority) {
-      if (sources.size() == 1) {
+      if (universe_data->source_count == 1) {
         universe_data->active_priority = priority;
       } else {
-        sources.erase(iter);
+        RemoveSource(universe_data, index);
         return true;
       }
     } else if (priority > universe_data->active_priority) {
       // new active priority
       universe_data->active_priority = priority;
-      if (sources.size() != 1) {
+      if (universe_data->source_count != 1) {
         // clear all sources other than this one
-        dmx_source this_source = *iter;
-        sources.clear();
-        iter = sources.insert(sources.end(), this_source);
+        if (index) {
+          universe_data->sources[0] = *source;
+          source = &universe_data->sources[0];
+        }
+        universe_data->source_count = 1;
       }
     }
-    *buffer = &iter->buffer;
+    *buffer = &source->buffer;
     return true;
   }
 }
+
+
+/*
+ * Track sources when we're merging using per-slot priorities.
+ *
+ * Unlike TrackSourceIfRequired, sources with a lower universe priority are
+ * kept since they may still win some slots.
+ * @param universe_data the universe_handler struct for this universe.
+ * @param packet the packet being handled.
+ * @param[out] source_index the index of the source this packet belongs to, or
+ *   NO_SOURCE if the data in the packet shouldn't be used.
+ * @param[out] full_merge set to true if the set of sources changed, which
+ *   means all slots need to be re-merged.
+ * @returns true if we should remerge the data, false otherwise.
+ */
+bool DMPE131Inflator::TrackPerSlotSource(universe_handler *universe_data,
+                                         const DataPacket &packet,
+                                         unsigned int *source_index,
+                                         bool *full_merge) {
+  *source_index = NO_SOURCE;
+
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  cid_key key;
+  MakeKey(packet.cid, &key);
+
+  *full_merge = ExpireSources(universe_data, key, now);
+
+  unsigned int index = FindSource(*universe_data, key);
+
+  if (index == NO_SOURCE) {
+    // This is an untracked source
+    if (packet.terminated)
+      return *full_merge;
+
+    if (universe_data->source_count == MAX_MERGE_SOURCES) {
+      OLA_WARN_RATE_LIMITED(1) << "Max merge sources reached for universe " <<
+        packet.universe << ", " << CID::FromData(packet.cid).ToString() <<
+        " won't be tracked";
+      return *full_merge;
+    }
+
+    dmx_source *source = AddSource(universe_data, key, packet, now);
+    OLA_INFO << "Added new E1.31 source: " << source->cid.ToString();
+    index = universe_data->source_count - 1;
+  } else {
+    // We already know about this one, check the seq #
+    dmx_source *source = &universe_data->sources[index];
+    if (!CheckSequence(source, packet.sequence)) {
+      return *full_merge;
+    }
+
+    if (packet.terminated) {
+      OLA_INFO << "CID " << CID::FromData(packet.cid).ToString() <<
+        " sent a termination for universe " << packet.universe;
+      RemoveSource(universe_data, index);
+      *full_merge = true;
+      return true;
+    }
+
+    source->last_heard_from = now;
+    source->priority = packet.priority;
+  }
+
+  *source_index = index;
+  return true;
+}
+
+
+/*
+ * Remove any sources, other than the sender of the current packet, that we
+ * haven't heard from recently, and drop per-slot priorities that have
+ * expired.
+ *
+ * The earliest time any source could expire is tracked, so this only walks
+ * the sources when something may have expired.
+ * @returns true if the set of sources or their priorities changed.
+ */
+bool DMPE131Inflator::ExpireSources(universe_handler *universe_data,
+                                    const cid_key &sender,
+                                    const TimeStamp &now) {
+  if (!universe_data->source_count || now <= universe_data->next_expiry) {
+    return false;
+  }
+
+  bool changed = false;
+  TimeStamp next_expiry;
+  unsigned int i = 0;
+  while (i < universe_data->source_count) {
+    dmx_source *source = &universe_data->sources[i];
+    TimeStamp expiry_time = source->last_heard_from + EXPIRY_INTERVAL;
+    if (now > expiry_time &&
+        (source->key.hash != sender.hash ||
+         memcmp(source->key.data, sender.data, CID::CID_LENGTH))) {
+      OLA_INFO << "source " << source->cid.ToString() << " has expired";
+      RemoveSource(universe_data, i);
+      changed = true;
+      continue;
+    }
+
+    if (source->slot_priorities.Size()) {
+      TimeStamp priority_expiry = (source->last_priority_heard_from +
+                                   EXPIRY_INTERVAL);
+      if (now > priority_expiry) {
+        // fall back to the universe priority
+        OLA_INFO << "per-slot priorities from " << source->cid.ToString()
+                 << " have expired";
+        source->slot_priorities.Reset();
+        changed = true;
+      } else {
+        expiry_time = std::min(expiry_time, priority_expiry);
+      }
+    }
+
+    if (!next_expiry.IsSet() || expiry_time < next_expiry) {
+      next_expiry = expiry_time;
+    }
+    i++;
+  }
+  universe_data->next_expiry = next_expiry;
+  return changed;
+}
+
+
+/*
+ * Add a new source to the end of the table. The caller checks there is room.
+ */
+DMPE131Inflator::dmx_source *DMPE131Inflator::AddSource(
+    universe_handler *universe_data,
+    const cid_key &key,
+    const DataPacket &packet,
+    const TimeStamp &now) {
+  dmx_source *source = &universe_data->sources[universe_data->source_count++];
+  source->cid = CID::FromData(key.data);
+  source->key = key;
+  source->sequence = packet.sequence;
+  source->last_heard_from = now;
+  source->buffer.Reset();
+  source->priority = packet.priority;
+  source->slot_priorities.Reset();
+  source->packets = 1;
+  source->sequence_gaps = 0;
+  source->out_of_order = 0;
+
+  // Every other source expires before this one.
+  if (universe_data->source_count == 1) {
+    universe_data->next_expiry = now + EXPIRY_INTERVAL;
+  }
+  return source;
+}
+
+
+/*
+ * Update the sequence number & statistics for a source.
+ * @returns false if the packet is old and should be dropped.
+ */
+bool DMPE131Inflator::CheckSequence(dmx_source *source, uint8_t sequence) {
+  source->packets++;
+  int8_t seq_diff = static_cast<int8_t>(sequence - source->sequence);
+  if (seq_diff <= 0 && seq_diff > SEQUENCE_DIFF_THRESHOLD) {
+    OLA_INFO << "Old packet received, ignoring, this # " <<
+      static_cast<int>(sequence) << ", last " <<
+      static_cast<int>(source->sequence);
+    source->out_of_order++;
+    return false;
+  }
+
+  if (seq_diff != 1) {
+    source->sequence_gaps++;
+  }
+  source->sequence = sequence;
+  return true;
+}
+
+
+/*
+ * Copy a CID and hash it, using FNV-1a.
+ */
+void DMPE131Inflator::MakeKey(const uint8_t *cid, cid_key *key) {
+  memcpy(key->data, cid, CID::CID_LENGTH);
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < CID::CID_LENGTH; i++) {
+    hash = (hash ^ key->data[i]) * 16777619u;
+  }
+  key->hash = hash;
+}
+
+
+/*
+ * Find a source in the table.
+ * @returns the index of the source, or NO_SOURCE if it's not being tracked.
+ */
+unsigned int DMPE131Inflator::FindSource(const universe_handler &universe_data,
+                                         const cid_key &key) {
+  for (unsigned int i = 0; i < universe_data.source_count; i++) {
+    const cid_key &source_key = universe_data.sources[i].key;
+    if (source_key.hash == key.hash &&
+        !memcmp(source_key.data, key.data, CID::CID_LENGTH)) {
+      return i;
+    }
+  }
+  return NO_SOURCE;
+}
+
+
+/*
+ * Remove a source from the table, keeping the remaining sources in order.
+ */
+void DMPE131Inflator::RemoveSource(universe_handler *universe_data,
+                                   unsigned int index) {
+  for (unsigned int i = index + 1; i < universe_data->source_count; i++) {
+    universe_data->sources[i - 1] = universe_data->sources[i];
+  }
+  universe_data->source_count--;
+}
+
+
+/*
+ * Handle data for a universe when we're merging using per-slot priorities.
+ * @param universe_data the universe_handler struct for this universe.
+ * @param packet the packet being handled.
+ */
+void DMPE131Inflator::HandlePerSlotData(universe_handler *universe_data,
+                                        const DataPacket &packet) {
+  unsigned int source_index;
+  bool full_merge;
+  if (!TrackPerSlotSource(universe_data, packet, &source_index,
+                          &full_merge)) {
+    return;
+  }
+
+  if (source_index != NO_SOURCE) {
+    dmx_source &source = universe_data->sources[source_index];
+    if (packet.start_code == DMX512_START_CODE) {
+      source.buffer.Set(packet.slots, packet.slot_count);
+    } else if (packet.start_code == PER_SLOT_PRIORITY_START_CODE) {
+      source.slot_priorities.Set(packet.slots, packet.slot_count);
+      m_clock.CurrentTime(&source.last_priority_heard_from);
+    }
+  }
+
+  if (full_merge) {
+    MergeAllSlots(universe_data);
+  } else if (source_index != NO_SOURCE) {
+    MergeSlotsFromSource(universe_data, source_index);
+  }
+  UpdateFromSlotState(universe_data);
+}
+
+
+/*
+ * Update the winner table when a single source has changed.
+ *
+ * A slot only needs to be re-merged across all sources if the changed source
+ * was the winner and has since dropped in priority or value.
+ */
+void DMPE131Inflator::MergeSlotsFromSource(universe_handler *universe_data,
+                                           unsigned int source_index) {
+  const dmx_source &source = universe_data->sources[source_index];
+  slot_merge_state *state = &universe_data->slot_state;
+  state->length = std::max(state->length, source.buffer.Size());
+
+  for (unsigned int slot = 0; slot < state->length; slot++) {
+    uint8_t priority = SlotPriority(source, slot);
+    uint8_t value = source.buffer.Get(slot);
+
+    if (state->winners[slot] == source_index) {
+      if (priority &&
+          (priority > state->priorities[slot] ||
+           (priority == state->priorities[slot] &&
+            value >= state->values[slot]))) {
+        state->values[slot] = value;
+        state->priorities[slot] = priority;
+      } else {
+        MergeSlot(universe_data, slot);
+      }
+    } else if (priority &&
+               (priority > state->priorities[slot] ||
+                (priority == state->priorities[slot] &&
+                 value > state->values[slot]))) {
+      state->winners[slot] = static_cast<uint8_t>(source_index);
+      state->values[slot] = value;
+      state->priorities[slot] = priority;
+    }
+  }
+}
+
+
+/*
+ * Rebuild the winner table from scratch.
+ */
+void DMPE131Inflator::MergeAllSlots(universe_handler *universe_data) {
+  slot_merge_state *state = &universe_data->slot_state;
+  state->length = 0;
+
+  for (unsigned int i = 0; i < universe_data->source_count; i++) {
+    state->length = std::max(state->length,
+                             universe_data->sources[i].buffer.Size());
+  }
+
+  for (unsigned int slot = 0; slot < DMX_UNIVERSE_SIZE; slot++) {
+    MergeSlot(universe_data, slot);
+  }
+}
+
+
+/*
+ * Find the winner for a single slot. The source with the highest priority
+ * wins, if more than one source has the same priority we HTP merge them.
+ */
+void DMPE131Inflator::MergeSlot(universe_handler *universe_data,
+                                unsigned int slot) {
+  slot_merge_state *state = &universe_data->slot_state;
+  uint8_t winner = NO_SOURCE;
+  uint8_t winning_priority = 0;
+  uint8_t winning_value = 0;
+
+  const dmx_source *sources = universe_data->sources;
+  for (unsigned int i = 0; i < universe_data->source_count; i++) {
+    uint8_t priority = SlotPriority(sources[i], slot);
+    if (!priority) {
+      continue;
+    }
+
+    uint8_t value = sources[i].buffer.Get(slot);
+    if (priority > winning_priority ||
+        (priority == winning_priority && value > winning_value)) {
+      winner = static_cast<uint8_t>(i);
+      winning_priority = priority;
+      winning_value = value;
+    }
+  }
+
+  state->winners[slot] = winner;
+  state->values[slot] = winning_value;
+  state->priorities[slot] = winning_priority;
+}
+
+
+/*
+ * Copy the merged data to the handler's buffer and run the closure.
+ */
+void DMPE131Inflator::UpdateFromSlotState(universe_handler *universe_data) {
+  const slot_merge_state &state = universe_data->slot_state;
+
+  if (!universe_data->source_count) {
+    universe_data->active_priority = 0;
+    OutputBuffer(universe_data)->Reset();
+    return;
+  }
+
+  // Report the highest priority of any slot we're using.
+  uint8_t active_priority = 0;
+  for (unsigned int slot = 0; slot < state.length; slot++) {
+    active_priority = std::max(active_priority, state.priorities[slot]);
+  }
+  universe_data->active_priority = active_priority;
+  SetOutputPriority(universe_data, active_priority);
+
+  OutputBuffer(universe_data)->Set(state.values, state.length);
+  DataReady(universe_data);
+}
+
+
+/*
+ * Record the sync address for a universe, and decide if the data from this
+ * packet should be held until a sync packet arrives.
+ */
+void DMPE131Inflator::CheckSyncAddress(universe_handler *universe_data,
+                                       uint16_t sync_address) {
+  if (sync_address != universe_data->sync_address) {
+    universe_data->sync_address = sync_address;
+    if (sync_address && m_sync_address_handler.get()) {
+      m_sync_address_handler->Run(sync_address);
+    }
+  }
+
+  universe_data->holding = false;
+  if (sync_address) {
+    std::map<uint16_t, TimeStamp>::const_iterator iter = m_sync_times.find(
+        sync_address);
+    if (iter != m_sync_times.end()) {
+      TimeStamp now;
+      m_clock.CurrentTime(&now);
+      universe_data->holding = now - iter->second < EXPIRY_INTERVAL;
+    }
+  }
+}
+
+
+void DMPE131Inflator::SetOutputPriority(universe_handler *universe_data,
+                                        uint8_t priority) {
+  if (universe_data->holding) {
+    universe_data->sync_priority = priority;
+  } else if (universe_data->priority) {
+    *universe_data->priority = priority;
+  }
+}
+
+
+/*
+ * Called once the output buffer has new data. If we're holding for a sync
+ * the universe is queued, otherwise the closure is run.
+ */
+void DMPE131Inflator::DataReady(universe_handler *universe_data) {
+  if (universe_data->holding) {
+    if (!universe_data->sync_pending) {
+      universe_data->sync_pending = true;
+      m_sync_pending.push_back(universe_data);
+    }
+    return;
+  }
+
+  if (universe_data->sync_pending) {
+    // This data supersedes what was held.
+    universe_data->sync_pending = false;
+    m_sync_pending.erase(std::find(m_sync_pending.begin(),
+                                   m_sync_pending.end(), universe_data));
+  }
+  universe_data->closure->Run();
+}
+
+
+/*
+ * Return the priority of a source for a particular slot, or 0 if the source
+ * isn't providing data for the slot.
+ */
+uint8_t DMPE131Inflator::SlotPriority(const dmx_source &source,
+                                      unsigned int slot) {
+  if (slot >= source.buffer.Size()) {
+    return 0;
+  }
+
+  if (!source.slot_priorities.Size()) {
+    return source.priority;
+  }
+
+  uint8_t priority = source.slot_priorities.Get(slot);
+  return priority > MAX_E131_PRIORITY ? MAX_E131_PRIORITY : priority;
+}
 }  // namespace acn
 }  // namespace ola
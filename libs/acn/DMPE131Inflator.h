@@ -22,11 +22,15 @@
 #ifndef LIBS_ACN_DMPE131INFLATOR_H_
 #define LIBS_ACN_DMPE131INFLATOR_H_
 
+#include <stdint.h>
 #include <map>
+#include <memory>
 #include <vector>
 #include "ola/Clock.h"
 #include "ola/Callback.h"
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/acn/CID.h"
 #include "libs/acn/DMPInflator.h"
 
 namespace ola {
@@ -36,10 +40,50 @@ class DMPE131Inflator: public DMPInflator {
   friend class DMPE131InflatorTest;
 
  public:
-    explicit DMPE131Inflator(bool ignore_preview):
-      DMPInflator(),
-      m_ignore_preview(ignore_preview) {
-    }
+    /**
+     * @brief Statistics for a source that's being tracked for a universe.
+     */
+    struct SourceStats {
+      ola::acn::CID cid;
+      uint64_t packets;  /**< The number of packets received */
+      /**
+       * @brief The number of packets that didn't follow on from the previous
+       * sequence number.
+       */
+      uint64_t sequence_gaps;
+      uint64_t out_of_order;  /**< The number of old packets dropped */
+      uint8_t last_priority;  /**< The last universe priority received */
+    };
+
+    /**
+     * @brief A decoded E1.31 data packet.
+     *
+     * The CID & slot data point into the received datagram, so this is only
+     * valid while the datagram is being handled.
+     */
+    struct DataPacket {
+      const uint8_t *cid;  /**< The CID, CID::CID_LENGTH bytes */
+      uint16_t universe;
+      uint8_t priority;
+      uint8_t sequence;
+      uint16_t sync_address;
+      bool preview;
+      bool terminated;
+      int start_code;  /**< The start code, or -1 if there was no data */
+      const uint8_t *slots;  /**< The slot data, after the start code */
+      unsigned int slot_count;
+      TimeStamp receive_time;
+    };
+
+    /**
+     * @brief Create a new DMPE131Inflator.
+     * @param ignore_preview true to drop data with the preview bit set.
+     * @param per_slot_priority true to merge sources using the per-slot
+     *   priorities sent with the 0xDD start code, rather than the universe
+     *   priority.
+     */
+    explicit DMPE131Inflator(bool ignore_preview,
+                             bool per_slot_priority = false);
     ~DMPE131Inflator();
 
     bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
@@ -48,6 +92,61 @@ class DMPE131Inflator: public DMPInflator {
 
     void RegisteredUniverses(std::vector<uint16_t> *universes);
 
+    /**
+     * @brief Merge the data from an E1.31 data packet.
+     * @param packet the packet to merge.
+     *
+     * This is used by HandlePDUData() and by the E131DataDecoder, which
+     * decodes common packets without inflating each layer.
+     */
+    void HandleDataPacket(const DataPacket &packet);
+
+    /**
+     * @brief Get the statistics for the sources of a universe.
+     * @param universe the universe to get the statistics for.
+     * @param[out] stats the statistics for each source being tracked.
+     * @returns false if there isn't a handler for the universe.
+     */
+    bool SourceStatistics(uint16_t universe,
+                          std::vector<SourceStats> *stats) const;
+
+    /**
+     * @brief Estimate the memory used by the universe handlers and the
+     *   sources they track.
+     * @returns the estimate in bytes.
+     */
+    size_t MemoryUsage() const;
+
+    /**
+     * @brief Set the callback run when a universe starts using a new sync
+     *   address.
+     * @param handler the callback to run with the sync address, ownership is
+     *   transferred. This is used to join the multicast group for the sync
+     *   address.
+     */
+    void SetSyncAddressHandler(ola::Callback1<void, uint16_t> *handler) {
+      m_sync_address_handler.reset(handler);
+    }
+
+    /**
+     * @brief Handle a synchronization packet.
+     * @param sync_address the sync address from the packet.
+     *
+     * Data that was being held for the sync address is passed on. Once a sync
+     * packet has been seen, data for universes using the sync address is held
+     * until the next one arrives. If no sync packets arrive for
+     * EXPIRY_INTERVAL, data is passed on immediately again.
+     */
+    void HandleSync(uint16_t sync_address);
+
+    /**
+     * @brief The time the packet being handled was received.
+     *
+     * This is only valid from within a handler, and isn't set if the receive
+     * time isn't known.
+     */
+    const TimeStamp &ReceiveTime() const { return m_receive_time; }
+
  protected:
     virtual bool HandlePDUData(uint32_t vector,
                                const HeaderSet &headers,
@@ -55,33 +154,132 @@ class DMPE131Inflator: public DMPInflator {
                                unsigned int pdu_len);
 
  private:
+    /*
+     * A CID in binary form, along with a hash so most comparisons only need
+     * to check a single word.
+     */
+    typedef struct {
+      uint32_t hash;
+      uint8_t data[CID::CID_LENGTH];
+    } cid_key;
+
     typedef struct {
       ola::acn::CID cid;
+      cid_key key;
       uint8_t sequence;
       TimeStamp last_heard_from;
       DmxBuffer buffer;
+      uint8_t priority;  // the universe priority from the E1.31 header
+      // The following are only used in per-slot priority mode.
+      TimeStamp last_priority_heard_from;
+      DmxBuffer slot_priorities;  // empty if we haven't seen a 0xDD packet
+      // statistics
+      uint64_t packets;
+      uint64_t sequence_gaps;
+      uint64_t out_of_order;
     } dmx_source;
 
+    /*
+     * The per-slot winner table, used in per-slot priority mode.
+     * For each slot this holds the index of the source that owns it, along
+     * with the value & priority of that source for the slot.
+     */
+    typedef struct {
+      unsigned int length;
+      uint8_t winners[DMX_UNIVERSE_SIZE];
+      uint8_t values[DMX_UNIVERSE_SIZE];
+      uint8_t priorities[DMX_UNIVERSE_SIZE];
+    } slot_merge_state;
+
+    // The max number of sources we'll track per universe.
+    static const uint8_t MAX_MERGE_SOURCES = 6;
+
     typedef struct {
       DmxBuffer *buffer;
       Callback0<void> *closure;
       uint8_t active_priority;
       uint8_t *priority;
-      std::vector<dmx_source> sources;
+      // The sources are kept in the order they were added.
+      dmx_source sources[MAX_MERGE_SOURCES];
+      unsigned int source_count;
+      // No source can expire before this time.
+      TimeStamp next_expiry;
+      slot_merge_state slot_state;
+      // Universe synchronization
+      uint16_t sync_address;  // from the last packet, 0 if not synchronized
+      bool holding;  // true if the current packet is held for a sync
+      bool sync_pending;  // true if sync_buffer is waiting for a sync
+      DmxBuffer sync_buffer;
+      uint8_t sync_priority;
     } universe_handler;
 
-    typedef std::map<uint16_t, universe_handler> UniverseHandlers;
+    /*
+     * The handlers are stored in pages of HANDLER_PAGE_SIZE universes, so
+     * the lookup for each packet doesn't depend on the number of universes.
+     */
+    static const unsigned int HANDLER_PAGE_SIZE = 256;
+    static const unsigned int HANDLER_PAGE_COUNT = 256;
 
-    UniverseHandlers m_handlers;
+    universe_handler **m_handler_pages[HANDLER_PAGE_COUNT];
     bool m_ignore_preview;
-    ola::Clock m_clock;
+    bool m_per_slot_priority;
+    // Only used for source and sync timeouts, which are measured in seconds.
+    ola::CoarseClock m_clock;
+    TimeStamp m_receive_time;
+    // The last time a sync packet was received for each sync address.
+    std::map<uint16_t, TimeStamp> m_sync_times;
+    // The universes with data waiting for a sync packet.
+    std::vector<universe_handler*> m_sync_pending;
+    std::auto_ptr<ola::Callback1<void, uint16_t> > m_sync_address_handler;
+
+    universe_handler *LookupHandler(uint16_t universe) const {
+      universe_handler **page = m_handler_pages[universe / HANDLER_PAGE_SIZE];
+      return page ? page[universe % HANDLER_PAGE_SIZE] : NULL;
+    }
 
     bool TrackSourceIfRequired(universe_handler *universe_data,
-                               const HeaderSet &headers,
+                               const DataPacket &packet,
                                DmxBuffer **buffer);
 
-    // The max number of sources we'll track per universe.
-    static const uint8_t MAX_MERGE_SOURCES = 6;
+    bool TrackPerSlotSource(universe_handler *universe_data,
+                            const DataPacket &packet,
+                            unsigned int *source_index,
+                            bool *full_merge);
+    void HandlePerSlotData(universe_handler *universe_data,
+                           const DataPacket &packet);
+    void MergeSlotsFromSource(universe_handler *universe_data,
+                              unsigned int source_index);
+    void MergeAllSlots(universe_handler *universe_data);
+    void MergeSlot(universe_handler *universe_data, unsigned int slot);
+    void UpdateFromSlotState(universe_handler *universe_data);
+
+    void CheckSyncAddress(universe_handler *universe_data,
+                          uint16_t sync_address);
+    DmxBuffer *OutputBuffer(universe_handler *universe_data) {
+      return universe_data->holding ? &universe_data->sync_buffer :
+          universe_data->buffer;
+    }
+    void SetOutputPriority(universe_handler *universe_data, uint8_t priority);
+    void DataReady(universe_handler *universe_data);
+
+    bool ExpireSources(universe_handler *universe_data, const cid_key &sender,
+                       const TimeStamp &now);
+    dmx_source *AddSource(universe_handler *universe_data,
+                          const cid_key &key, const DataPacket &packet,
+                          const TimeStamp &now);
+    bool CheckSequence(dmx_source *source, uint8_t sequence);
+
+    static void MakeKey(const uint8_t *cid, cid_key *key);
+    static unsigned int FindSource(const universe_handler &universe_data,
+                                   const cid_key &key);
+    static void RemoveSource(universe_handler *universe_data,
+                             unsigned int index);
+    static uint8_t SlotPriority(const dmx_source &source, unsigned int slot);
+
+    // Used in the winner table for slots that no source is providing.
+    static const uint8_t NO_SOURCE = 0xff;
+    // The start code used for per-slot priority data.
+    static const uint8_t PER_SLOT_PRIORITY_START_CODE = 0xdd;
     // The max merge priority.
     static const uint8_t MAX_E131_PRIORITY = 200;
     // ignore packets that differ by less than this amount from the last one
@@ -0,0 +1,393 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DMPE131InflatorTest.cpp
+ * Test fixture for the DMPE131Inflator class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/DMPHeader.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/HeaderSet.h"
+#include "libs/acn/RootHeader.h"
+#include "ola/testing/TestUtils.h"
+
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using std::vector;
+
+class DMPE131InflatorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DMPE131InflatorTest);
+  CPPUNIT_TEST(testUniversePriority);
+  CPPUNIT_TEST(testPerSlotPriority);
+  CPPUNIT_TEST(testSourceStatistics);
+  CPPUNIT_TEST(testManyUniverses);
+  CPPUNIT_TEST(testSync);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    DMPE131InflatorTest()
+        : m_priority(0),
+          m_updates(0) {
+    }
+
+    void setUp() {
+      m_cid1 = CID::Generate();
+      m_cid2 = CID::Generate();
+      m_priority = 0;
+      m_updates = 0;
+      m_sequence = 0;
+    }
+
+    void testUniversePriority();
+    void testPerSlotPriority();
+    void testSourceStatistics();
+    void testManyUniverses();
+    void testSync();
+
+ private:
+    CID m_cid1, m_cid2;
+    DmxBuffer m_buffer;
+    uint8_t m_priority;
+    unsigned int m_updates;
+    uint8_t m_sequence;
+
+    vector<uint16_t> m_sync_addresses;
+
+    void NewData() { m_updates++; }
+    void NewSyncAddress(uint16_t sync_address) {
+      m_sync_addresses.push_back(sync_address);
+    }
+    Callback0<void> *NewHandler() {
+      return NewCallback(this, &DMPE131InflatorTest::NewData);
+    }
+    void SendData(DMPE131Inflator *inflator, const CID &cid,
+                  uint8_t priority, uint8_t start_code,
+                  const uint8_t *data, unsigned int length,
+                  bool terminated = false, uint16_t universe = UNIVERSE,
+                  uint16_t sync_address = 0);
+
+    static const uint16_t UNIVERSE = 1;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DMPE131InflatorTest);
+
+
+/*
+ * Pass a DMP set property message to the inflator.
+ */
+void DMPE131InflatorTest::SendData(DMPE131Inflator *inflator,
+                                   const CID &cid,
+                                   uint8_t priority,
+                                   uint8_t start_code,
+                                   const uint8_t *data,
+                                   unsigned int length,
+                                   bool terminated,
+                                   uint16_t universe,
+                                   uint16_t sync_address) {
+  RootHeader root_header;
+  root_header.SetCid(cid);
+  E131Header e131_header("test", priority, m_sequence++, universe, false,
+                         terminated, false, sync_address);
+  DMPHeader dmp_header(true, false, RANGE_EQUAL, TWO_BYTES);
+  HeaderSet headers;
+  headers.SetRootHeader(root_header);
+  headers.SetE131Header(e131_header);
+  headers.SetDMPHeader(dmp_header);
+
+  // start, increment & count, followed by the start code & data.
+  vector<uint8_t> pdu;
+  pdu.push_back(0);
+  pdu.push_back(0);
+  pdu.push_back(0);
+  pdu.push_back(1);
+  pdu.push_back(static_cast<uint8_t>((length + 1) >> 8));
+  pdu.push_back(static_cast<uint8_t>(length + 1));
+  pdu.push_back(start_code);
+  pdu.insert(pdu.end(), data, data + length);
+
+  inflator->HandlePDUData(ola::acn::DMP_SET_PROPERTY_VECTOR, headers,
+                          &pdu[0], static_cast<unsigned int>(pdu.size()));
+}
+
+
+/*
+ * Check that per-slot priority data is ignored unless it's enabled.
+ */
+void DMPE131InflatorTest::testUniversePriority() {
+  DMPE131Inflator inflator(true);
+  OLA_ASSERT(inflator.SetHandler(UNIVERSE, &m_buffer, &m_priority,
+                                 NewHandler()));
+
+  const uint8_t data1[] = {10, 20, 30};
+  const uint8_t data2[] = {40, 5, 60};
+  const uint8_t priorities[] = {200, 200, 200};
+  const uint8_t expected[] = {40, 20, 60};
+
+  SendData(&inflator, m_cid1, 100, 0, data1, sizeof(data1));
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_priority);
+  SendData(&inflator, m_cid1, 100, 0xdd, priorities, sizeof(priorities));
+  OLA_ASSERT_EQ(1u, m_updates);
+
+  SendData(&inflator, m_cid2, 100, 0, data2, sizeof(data2));
+  OLA_ASSERT_EQ(2u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), m_buffer.GetRaw(),
+                         m_buffer.Size());
+}
+
+
+/*
+ * Check merging with per-slot priorities.
+ */
+void DMPE131InflatorTest::testPerSlotPriority() {
+  DMPE131Inflator inflator(true, true);
+  OLA_ASSERT(inflator.SetHandler(UNIVERSE, &m_buffer, &m_priority,
+                                 NewHandler()));
+
+  const uint8_t data1[] = {10, 20, 30, 40};
+  const uint8_t priorities1[] = {150, 50, 100, 0};
+  const uint8_t data2[] = {40, 50, 60};
+
+  SendData(&inflator, m_cid1, 100, 0, data1, sizeof(data1));
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(data1, sizeof(data1), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_priority);
+
+  SendData(&inflator, m_cid1, 100, 0xdd, priorities1, sizeof(priorities1));
+  OLA_ASSERT_EQ(2u, m_updates);
+  const uint8_t expected1[] = {10, 20, 30, 0};
+  OLA_ASSERT_DATA_EQUALS(expected1, sizeof(expected1), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), m_priority);
+
+  // The second source uses the universe priority for all slots. Slot 0 is
+  // owned by the first source, slot 1 by the second and slot 2 is a tie so
+  // it's HTP merged.
+  SendData(&inflator, m_cid2, 100, 0, data2, sizeof(data2));
+  OLA_ASSERT_EQ(3u, m_updates);
+  const uint8_t expected2[] = {10, 50, 60, 0};
+  OLA_ASSERT_DATA_EQUALS(expected2, sizeof(expected2), m_buffer.GetRaw(),
+                         m_buffer.Size());
+
+  // Drop the value of the winning source in the tied slot.
+  const uint8_t data3[] = {40, 50, 5};
+  SendData(&inflator, m_cid2, 100, 0, data3, sizeof(data3));
+  const uint8_t expected3[] = {10, 50, 30, 0};
+  OLA_ASSERT_DATA_EQUALS(expected3, sizeof(expected3), m_buffer.GetRaw(),
+                         m_buffer.Size());
+
+  // Now raise the universe priority of the second source, it takes over
+  // every slot other than slot 0.
+  SendData(&inflator, m_cid2, 120, 0, data3, sizeof(data3));
+  const uint8_t expected4[] = {10, 50, 5, 0};
+  OLA_ASSERT_DATA_EQUALS(expected4, sizeof(expected4), m_buffer.GetRaw(),
+                         m_buffer.Size());
+
+  // Terminate the second source, the first source should own everything
+  // again.
+  SendData(&inflator, m_cid2, 120, 0, data3, sizeof(data3), true);
+  OLA_ASSERT_DATA_EQUALS(expected1, sizeof(expected1), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), m_priority);
+
+  // and then the first.
+  unsigned int updates = m_updates;
+  SendData(&inflator, m_cid1, 100, 0, data1, sizeof(data1), true);
+  OLA_ASSERT_EQ(0u, m_buffer.Size());
+  OLA_ASSERT_EQ(updates, m_updates);
+}
+
+
+/*
+ * Check the per-source statistics.
+ */
+void DMPE131InflatorTest::testSourceStatistics() {
+  DMPE131Inflator inflator(true);
+  vector<DMPE131Inflator::SourceStats> stats;
+  OLA_ASSERT_FALSE(inflator.SourceStatistics(UNIVERSE, &stats));
+  OLA_ASSERT(inflator.SetHandler(UNIVERSE, &m_buffer, &m_priority,
+                                 NewHandler()));
+  OLA_ASSERT(inflator.SourceStatistics(UNIVERSE, &stats));
+  OLA_ASSERT_TRUE(stats.empty());
+
+  const uint8_t data[] = {10, 20, 30};
+  SendData(&inflator, m_cid1, 100, 0, data, sizeof(data));
+  SendData(&inflator, m_cid1, 100, 0, data, sizeof(data));
+  // an old packet
+  m_sequence = 0;
+  SendData(&inflator, m_cid1, 100, 0, data, sizeof(data));
+  OLA_ASSERT_EQ(2u, m_updates);
+  // skip some sequence numbers
+  m_sequence = 10;
+  SendData(&inflator, m_cid1, 120, 0, data, sizeof(data));
+  OLA_ASSERT_EQ(3u, m_updates);
+
+  SendData(&inflator, m_cid2, 120, 0, data, sizeof(data));
+  OLA_ASSERT_EQ(4u, m_updates);
+
+  OLA_ASSERT(inflator.SourceStatistics(UNIVERSE, &stats));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), stats.size());
+  OLA_ASSERT_TRUE(m_cid1 == stats[0].cid);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), stats[0].packets);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats[0].sequence_gaps);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats[0].out_of_order);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), stats[0].last_priority);
+  OLA_ASSERT_TRUE(m_cid2 == stats[1].cid);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats[1].packets);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats[1].sequence_gaps);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats[1].out_of_order);
+
+  // terminating the first source leaves the second
+  SendData(&inflator, m_cid1, 120, 0, data, sizeof(data), true);
+  stats.clear();
+  OLA_ASSERT(inflator.SourceStatistics(UNIVERSE, &stats));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stats.size());
+  OLA_ASSERT_TRUE(m_cid2 == stats[0].cid);
+}
+
+
+/*
+ * Check handlers for universes spread across the range.
+ */
+void DMPE131InflatorTest::testManyUniverses() {
+  DMPE131Inflator inflator(true);
+  DmxBuffer buffer2, buffer3;
+  OLA_ASSERT(inflator.SetHandler(63999, &buffer3, NULL, NewHandler()));
+  OLA_ASSERT(inflator.SetHandler(UNIVERSE, &m_buffer, &m_priority,
+                                 NewHandler()));
+  OLA_ASSERT(inflator.SetHandler(300, &buffer2, NULL, NewHandler()));
+
+  vector<uint16_t> universes;
+  inflator.RegisteredUniverses(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), universes.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(1), universes[0]);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(300), universes[1]);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(63999), universes[2]);
+
+  const uint8_t data[] = {1, 2, 3};
+  SendData(&inflator, m_cid1, 100, 0, data, sizeof(data), false, 300);
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(data, sizeof(data), buffer2.GetRaw(),
+                         buffer2.Size());
+  OLA_ASSERT_EQ(0u, m_buffer.Size());
+
+  // universes without handlers are ignored
+  SendData(&inflator, m_cid1, 100, 0, data, sizeof(data), false, 301);
+  OLA_ASSERT_EQ(1u, m_updates);
+
+  OLA_ASSERT(inflator.RemoveHandler(300));
+  OLA_ASSERT_FALSE(inflator.RemoveHandler(300));
+  SendData(&inflator, m_cid1, 100, 0, data, sizeof(data), false, 300);
+  OLA_ASSERT_EQ(1u, m_updates);
+  inflator.RegisteredUniverses(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), universes.size());
+}
+
+
+/*
+ * Check that data is held until a sync packet arrives.
+ */
+void DMPE131InflatorTest::testSync() {
+  const uint16_t SYNC_ADDRESS = 7000;
+  DMPE131Inflator inflator(true);
+  inflator.SetSyncAddressHandler(
+      NewCallback(this, &DMPE131InflatorTest::NewSyncAddress));
+  DmxBuffer buffer2;
+  uint8_t priority2 = 0;
+  OLA_ASSERT(inflator.SetHandler(UNIVERSE, &m_buffer, &m_priority,
+                                 NewHandler()));
+  OLA_ASSERT(inflator.SetHandler(2, &buffer2, &priority2, NewHandler()));
+
+  // Until a sync packet arrives, the data is passed on immediately.
+  const uint8_t data1[] = {1, 2, 3};
+  SendData(&inflator, m_cid1, 100, 0, data1, sizeof(data1), false, UNIVERSE,
+           SYNC_ADDRESS);
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(data1, sizeof(data1), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_sync_addresses.size());
+  OLA_ASSERT_EQ(SYNC_ADDRESS, m_sync_addresses[0]);
+
+  // Once we've seen a sync, the data is held for the next one.
+  inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(1u, m_updates);
+  const uint8_t data2[] = {4, 5, 6};
+  const uint8_t data3[] = {7, 8};
+  SendData(&inflator, m_cid1, 120, 0, data2, sizeof(data2), false, UNIVERSE,
+           SYNC_ADDRESS);
+  SendData(&inflator, m_cid1, 150, 0, data3, sizeof(data3), false, 2,
+           SYNC_ADDRESS);
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(data1, sizeof(data1), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_priority);
+  OLA_ASSERT_EQ(0u, buffer2.Size());
+  // The handler is run for each universe that starts using the address.
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_sync_addresses.size());
+
+  // A sync for a different address doesn't release the data.
+  inflator.HandleSync(SYNC_ADDRESS + 1);
+  OLA_ASSERT_EQ(1u, m_updates);
+
+  inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(3u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(data2, sizeof(data2), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), m_priority);
+  OLA_ASSERT_DATA_EQUALS(data3, sizeof(data3), buffer2.GetRaw(),
+                         buffer2.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), priority2);
+
+  // Nothing is pending now.
+  inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(3u, m_updates);
+
+  // A sync address of 0 means act on the data immediately, and drops any
+  // data that was held.
+  SendData(&inflator, m_cid1, 120, 0, data1, sizeof(data1), false, UNIVERSE,
+           SYNC_ADDRESS);
+  OLA_ASSERT_EQ(3u, m_updates);
+  SendData(&inflator, m_cid1, 120, 0, data3, sizeof(data3));
+  OLA_ASSERT_EQ(4u, m_updates);
+  OLA_ASSERT_DATA_EQUALS(data3, sizeof(data3), m_buffer.GetRaw(),
+                         m_buffer.Size());
+  inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(4u, m_updates);
+
+  // Removing a universe with held data is safe.
+  SendData(&inflator, m_cid1, 150, 0, data1, sizeof(data1), false, 2,
+           SYNC_ADDRESS);
+  OLA_ASSERT(inflator.RemoveHandler(2));
+  inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(4u, m_updates);
+}
+}  // namespace acn
+}  // namespace ola
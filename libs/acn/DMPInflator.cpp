@@ -40,10 +40,9 @@ bool DMPInflator::DecodeHeader(HeaderSet *headers,
   if (data) {
     // the header bit was set, decode it
     if (length >= DMPHeader::DMP_HEADER_SIZE) {
-      DMPHeader header(*data);
-      m_last_header = header;
+      m_last_header = DMPHeader(*data);
       m_last_header_valid = true;
-      headers->SetDMPHeader(header);
+      headers->SetDMPHeader(m_last_header);
       *bytes_used = DMPHeader::DMP_HEADER_SIZE;
       return true;
     }
@@ -0,0 +1,201 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131Benchmark.cpp
+ * Microbenchmarks for packing and parsing E1.31 data packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/CID.h"
+#include "ola/testing/Benchmark.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131DataDecoder.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131Sender.h"
+#include "libs/acn/HeaderSet.h"
+#include "libs/acn/PDUStack.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootInflator.h"
+#include "libs/acn/RootSender.h"
+#include "libs/acn/TransportHeader.h"
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using std::vector;
+
+namespace {
+
+const uint16_t UNIVERSE = 1;
+// The offset of the sequence number, once the preamble has been removed.
+const unsigned int SEQUENCE_OFFSET = 95;
+
+DmxBuffer TestFrame() {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>(i * 7);
+  }
+  return DmxBuffer(data, sizeof(data));
+}
+
+/*
+ * Pack a full data packet, the same way the E131Node does.
+ */
+void PackData(E131Sender *sender, const DmxBuffer &buffer, uint8_t sequence,
+              vector<uint8_t> *packet) {
+  vector<uint8_t> slots;
+  slots.reserve(buffer.Size() + 1);
+  slots.push_back(0);  // start code
+  slots.insert(slots.end(), buffer.GetRaw(),
+               buffer.GetRaw() + buffer.Size());
+
+  TwoByteRangeDMPAddress range_addr(
+      0, 1, static_cast<uint16_t>(slots.size()));
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(
+      &range_addr, &slots[0], static_cast<unsigned int>(slots.size()));
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true, false,
+                                                       ranged_chunks);
+
+  E131Header header("benchmark", 100, sequence, UNIVERSE);
+  packet->clear();
+  sender->PackDMP(header, pdu, packet);
+  delete pdu;
+}
+
+/*
+ * A packet without the ACN preamble, as the inflators see it.
+ */
+void PackStrippedData(vector<uint8_t> *packet) {
+  RootSender root_sender(CID::Generate());
+  E131Sender sender(NULL, &root_sender);
+  PackData(&sender, TestFrame(), 0, packet);
+  packet->erase(packet->begin(),
+                packet->begin() + PreamblePacker::ACN_HEADER_SIZE);
+}
+
+void NoOp() {}
+
+void BenchmarkE131Pack(BenchmarkState *state) {
+  RootSender root_sender(CID::Generate());
+  E131Sender sender(NULL, &root_sender);
+  const DmxBuffer frame = TestFrame();
+  vector<uint8_t> packet;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    PackData(&sender, frame, static_cast<uint8_t>(i), &packet);
+    DoNotOptimize(packet);
+  }
+  state->SetBytesProcessed(state->Iterations() * packet.size());
+}
+OLA_BENCHMARK(BenchmarkE131Pack);
+
+/*
+ * Pack the same PDUs with a PDUStack. This doesn't include the preamble.
+ */
+void BenchmarkE131PackStack(BenchmarkState *state) {
+  const CID cid = CID::Generate();
+  const DmxBuffer frame = TestFrame();
+  uint8_t slots[ola::DMX_UNIVERSE_SIZE + 1];
+  slots[0] = 0;  // start code
+  memcpy(slots + 1, frame.GetRaw(), frame.Size());
+  uint8_t packet[1024];
+  unsigned int length = 0;
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    E131Header header("benchmark", 100, static_cast<uint8_t>(i), UNIVERSE);
+    RootLayer root(ola::acn::VECTOR_ROOT_E131, cid);
+    E131Layer e131(ola::acn::VECTOR_E131_DATA, header);
+    DMPRangeSetPropertyLayer dmp(slots, frame.Size() + 1);
+    PDUStack<RootLayer, E131Layer, DMPRangeSetPropertyLayer> stack(
+        &root, &e131, &dmp);
+    length = sizeof(packet);
+    stack.Pack(packet, &length);
+    DoNotOptimize(packet);
+  }
+  state->SetBytesProcessed(state->Iterations() * length);
+}
+OLA_BENCHMARK(BenchmarkE131PackStack);
+
+/*
+ * Parse with the E131DataDecoder, which is what the E131Node uses for plain
+ * data packets.
+ */
+void BenchmarkE131DecodeFastPath(BenchmarkState *state) {
+  DmxBuffer buffer;
+  uint8_t priority;
+  DMPE131Inflator inflator(false);
+  inflator.SetHandler(UNIVERSE, &buffer, &priority, NewCallback(&NoOp));
+  E131DataDecoder decoder(&inflator);
+  TransportHeader transport_header;
+  vector<uint8_t> packet;
+  PackStrippedData(&packet);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    packet[SEQUENCE_OFFSET] = static_cast<uint8_t>(i);
+    decoder.HandleDatagram(&packet[0], static_cast<unsigned int>(packet.size()),
+                           transport_header);
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * packet.size());
+}
+OLA_BENCHMARK(BenchmarkE131DecodeFastPath);
+
+/*
+ * Parse with the generic inflators, one layer at a time.
+ */
+void BenchmarkE131DecodeInflators(BenchmarkState *state) {
+  DmxBuffer buffer;
+  uint8_t priority;
+  DMPE131Inflator inflator(false);
+  inflator.SetHandler(UNIVERSE, &buffer, &priority, NewCallback(&NoOp));
+  E131Inflator e131_inflator;
+  e131_inflator.AddInflator(&inflator);
+  RootInflator root_inflator;
+  root_inflator.AddInflator(&e131_inflator);
+  TransportHeader transport_header;
+  vector<uint8_t> packet;
+  PackStrippedData(&packet);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    packet[SEQUENCE_OFFSET] = static_cast<uint8_t>(i);
+    HeaderSet header_set;
+    header_set.SetTransportHeader(transport_header);
+    root_inflator.InflatePDUBlock(&header_set, &packet[0],
+                                  static_cast<unsigned int>(packet.size()));
+    DoNotOptimize(buffer);
+  }
+  state->SetBytesProcessed(state->Iterations() * packet.size());
+}
+OLA_BENCHMARK(BenchmarkE131DecodeInflators);
+}  // namespace
+}  // namespace acn
+}  // namespace ola
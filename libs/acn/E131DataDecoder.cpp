@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131DataDecoder.cpp
+ * Decodes E1.31 data packets without inflating each PDU layer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stddef.h>
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "ola/util/Utils.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPHeader.h"
+#include "libs/acn/E131DataDecoder.h"
+#include "libs/acn/E131Header.h"
+
+namespace ola {
+namespace acn {
+
+using ola::utils::JoinUInt8;
+
+namespace {
+
+// The flags & length, followed by a 4 byte vector.
+const unsigned int PDU_PREAMBLE_SIZE = 6;
+// The root layer is followed by the CID.
+const unsigned int FRAMING_OFFSET = PDU_PREAMBLE_SIZE + CID::CID_LENGTH;
+const unsigned int FRAMING_HEADER_OFFSET = FRAMING_OFFSET + PDU_PREAMBLE_SIZE;
+const unsigned int DMP_OFFSET = (FRAMING_HEADER_OFFSET +
+                                 sizeof(E131Header::e131_pdu_header));
+// The DMP layer has a 1 byte vector, the address type and a 2 byte range
+// address.
+const unsigned int DMP_VECTOR_OFFSET = DMP_OFFSET + 2;
+const unsigned int DMP_HEADER_OFFSET = DMP_VECTOR_OFFSET + 1;
+const unsigned int DMP_INCREMENT_OFFSET = DMP_HEADER_OFFSET + 3;
+const unsigned int DMP_COUNT_OFFSET = DMP_INCREMENT_OFFSET + 2;
+const unsigned int PROPERTY_OFFSET = DMP_COUNT_OFFSET + 2;
+
+// Vector, header & data present, with a 12 bit length.
+const uint8_t PDU_FLAGS = 0x70;
+const uint8_t FLAGS_MASK = 0xf0;
+
+const uint8_t DMP_ADDRESS_TYPE = (
+    DMPHeader(true, false, RANGE_EQUAL, TWO_BYTES).Header());
+
+uint16_t ReadUInt16(const uint8_t *data) {
+  return JoinUInt8(data[0], data[1]);
+}
+
+uint32_t ReadUInt32(const uint8_t *data) {
+  return JoinUInt8(data[0], data[1], data[2], data[3]);
+}
+}  // namespace
+
+
+bool E131DataDecoder::HandleDatagram(const uint8_t *data,
+                                     unsigned int length,
+                                     const TransportHeader &transport_header) {
+  // We need at least the start code.
+  if (length <= PROPERTY_OFFSET ||
+      !CheckPDU(data, length) ||
+      ReadUInt32(data + 2) != ola::acn::VECTOR_ROOT_E131 ||
+      !CheckPDU(data + FRAMING_OFFSET, length - FRAMING_OFFSET) ||
+      ReadUInt32(data + FRAMING_OFFSET + 2) != ola::acn::VECTOR_E131_DATA ||
+      !CheckPDU(data + DMP_OFFSET, length - DMP_OFFSET) ||
+      data[DMP_VECTOR_OFFSET] != ola::acn::DMP_SET_PROPERTY_VECTOR ||
+      data[DMP_HEADER_OFFSET] != DMP_ADDRESS_TYPE ||
+      ReadUInt16(data + DMP_INCREMENT_OFFSET) != 1 ||
+      static_cast<unsigned int>(ReadUInt16(data + DMP_COUNT_OFFSET)) !=
+          length - PROPERTY_OFFSET) {
+    return false;
+  }
+
+  const uint8_t *header = data + FRAMING_HEADER_OFFSET;
+  const uint8_t options = header[
+      offsetof(E131Header::e131_pdu_header, options)];
+
+  DMPE131Inflator::DataPacket packet;
+  packet.cid = data + PDU_PREAMBLE_SIZE;
+  packet.universe = ReadUInt16(
+      header + offsetof(E131Header::e131_pdu_header, universe));
+  packet.priority = header[offsetof(E131Header::e131_pdu_header, priority)];
+  packet.sequence = header[offsetof(E131Header::e131_pdu_header, sequence)];
+  packet.sync_address = ReadUInt16(
+      header + offsetof(E131Header::e131_pdu_header, sync_address));
+  packet.preview = options & E131Header::PREVIEW_DATA_MASK;
+  packet.terminated = options & E131Header::STREAM_TERMINATED_MASK;
+  packet.start_code = data[PROPERTY_OFFSET];
+  packet.slots = data + PROPERTY_OFFSET + 1;
+  packet.slot_count = length - PROPERTY_OFFSET - 1;
+  packet.receive_time = transport_header.ReceiveTime();
+
+  m_inflator->HandleDataPacket(packet);
+  return true;
+}
+
+
+/*
+ * Check the flags of a PDU and that it runs to the end of the datagram.
+ */
+bool E131DataDecoder::CheckPDU(const uint8_t *pdu,
+                               unsigned int expected_length) {
+  const unsigned int pdu_length = ReadUInt16(pdu) & 0x0fff;
+  return (pdu[0] & FLAGS_MASK) == PDU_FLAGS && pdu_length == expected_length;
+}
+}  // namespace acn
+}  // namespace ola
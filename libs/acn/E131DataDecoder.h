@@ -0,0 +1,65 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131DataDecoder.h
+ * Decodes E1.31 data packets without inflating each PDU layer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_E131DATADECODER_H_
+#define LIBS_ACN_E131DATADECODER_H_
+
+#include <stdint.h>
+#include "ola/base/Macro.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/TransportHeader.h"
+#include "libs/acn/UDPTransport.h"
+
+namespace ola {
+namespace acn {
+
+/*
+ * Almost every E1.31 datagram is a single root PDU, containing a single data
+ * framing PDU, containing a single DMP set property PDU. In that case the
+ * fields are at fixed offsets, so they're checked in one pass and the slot
+ * data is passed to the DMPE131Inflator without building a HeaderSet.
+ *
+ * Anything else, including packets with inherited headers, the 20 bit length
+ * flag, revision 0.2 packets and sync or discovery packets, is left for the
+ * generic inflators.
+ */
+class E131DataDecoder: public DatagramDecoder {
+ public:
+  /*
+   * @param inflator the DMPE131Inflator to pass the data to, ownership is not
+   *   transferred.
+   */
+  explicit E131DataDecoder(DMPE131Inflator *inflator)
+      : m_inflator(inflator) {
+  }
+
+  bool HandleDatagram(const uint8_t *data, unsigned int length,
+                      const TransportHeader &transport_header);
+
+ private:
+  DMPE131Inflator *m_inflator;
+
+  static bool CheckPDU(const uint8_t *pdu, unsigned int expected_length);
+
+  DISALLOW_COPY_AND_ASSIGN(E131DataDecoder);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131DATADECODER_H_
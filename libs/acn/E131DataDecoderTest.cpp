@@ -0,0 +1,229 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ *
+ * E131DataDecoderTest.cpp
+ * Test fixture for the E131DataDecoder class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131DataDecoder.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131Sender.h"
+#include "libs/acn/HeaderSet.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootInflator.h"
+#include "libs/acn/RootSender.h"
+#include "libs/acn/TransportHeader.h"
+#include "ola/testing/TestUtils.h"
+
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using std::vector;
+
+class E131DataDecoderTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(E131DataDecoderTest);
+  CPPUNIT_TEST(testDecode);
+  CPPUNIT_TEST(testFallback);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    E131DataDecoderTest()
+        : m_priority(0),
+          m_updates(0) {
+    }
+
+    void setUp() {
+      m_cid = CID::Generate();
+      m_priority = 0;
+      m_updates = 0;
+    }
+
+    void testDecode();
+    void testFallback();
+
+ private:
+    CID m_cid;
+    DmxBuffer m_buffer;
+    uint8_t m_priority;
+    unsigned int m_updates;
+
+    void NewData() { m_updates++; }
+    void PackData(const DmxBuffer &buffer, uint8_t priority,
+                  bool rev2, vector<uint8_t> *packet);
+
+    static const uint16_t UNIVERSE = 1;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(E131DataDecoderTest);
+
+
+/*
+ * Pack a data packet, leaving off the ACN preamble.
+ */
+void E131DataDecoderTest::PackData(const DmxBuffer &buffer, uint8_t priority,
+                                   bool rev2, vector<uint8_t> *packet) {
+  vector<uint8_t> slots;
+  slots.push_back(0);  // start code
+  slots.insert(slots.end(), buffer.GetRaw(),
+               buffer.GetRaw() + buffer.Size());
+
+  TwoByteRangeDMPAddress range_addr(
+      0, 1, static_cast<uint16_t>(slots.size()));
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(
+      &range_addr, &slots[0], static_cast<unsigned int>(slots.size()));
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true, false,
+                                                       ranged_chunks);
+
+  E131Header header("test", priority, 1, UNIVERSE, false, false, rev2);
+  RootSender root_sender(m_cid);
+  E131Sender sender(NULL, &root_sender);
+  packet->clear();
+  OLA_ASSERT(sender.PackDMP(header, pdu, packet));
+  delete pdu;
+  packet->erase(packet->begin(),
+                packet->begin() + PreamblePacker::ACN_HEADER_SIZE);
+}
+
+
+/*
+ * Check that data packets are decoded the same way as the generic inflators
+ * would.
+ */
+void E131DataDecoderTest::testDecode() {
+  DMPE131Inflator inflator(false);
+  OLA_ASSERT(inflator.SetHandler(
+        UNIVERSE, &m_buffer, &m_priority,
+        NewCallback(this, &E131DataDecoderTest::NewData)));
+  E131DataDecoder decoder(&inflator);
+  TransportHeader transport_header;
+
+  DmxBuffer expected;
+  expected.SetFromString("1,2,3,4,5");
+  vector<uint8_t> packet;
+  PackData(expected, 150, false, &packet);
+
+  OLA_ASSERT(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size()),
+      transport_header));
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), m_priority);
+  OLA_ASSERT(expected == m_buffer);
+
+  vector<DMPE131Inflator::SourceStats> stats;
+  OLA_ASSERT(inflator.SourceStatistics(UNIVERSE, &stats));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stats.size());
+  OLA_ASSERT(m_cid == stats[0].cid);
+
+  // Now the same data through the generic inflators, into a second inflator.
+  DmxBuffer buffer2;
+  uint8_t priority2 = 0;
+  DMPE131Inflator inflator2(false);
+  OLA_ASSERT(inflator2.SetHandler(
+        UNIVERSE, &buffer2, &priority2,
+        NewCallback(this, &E131DataDecoderTest::NewData)));
+  E131Inflator e131_inflator;
+  e131_inflator.AddInflator(&inflator2);
+  RootInflator root_inflator;
+  root_inflator.AddInflator(&e131_inflator);
+
+  HeaderSet header_set;
+  header_set.SetTransportHeader(transport_header);
+  root_inflator.InflatePDUBlock(&header_set, &packet[0],
+                                static_cast<unsigned int>(packet.size()));
+  OLA_ASSERT_EQ(2u, m_updates);
+  OLA_ASSERT_EQ(m_priority, priority2);
+  OLA_ASSERT(m_buffer == buffer2);
+}
+
+
+/*
+ * Check that anything other than a plain data packet is left for the
+ * generic inflators.
+ */
+void E131DataDecoderTest::testFallback() {
+  DMPE131Inflator inflator(false);
+  OLA_ASSERT(inflator.SetHandler(
+        UNIVERSE, &m_buffer, &m_priority,
+        NewCallback(this, &E131DataDecoderTest::NewData)));
+  E131DataDecoder decoder(&inflator);
+  TransportHeader transport_header;
+
+  DmxBuffer data;
+  data.SetFromString("1,2,3");
+  vector<uint8_t> packet;
+
+  // revision 0.2
+  PackData(data, 100, true, &packet);
+  OLA_ASSERT_FALSE(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size()),
+      transport_header));
+
+  // trailing data after the root PDU
+  PackData(data, 100, false, &packet);
+  packet.push_back(0);
+  OLA_ASSERT_FALSE(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size()),
+      transport_header));
+
+  // truncated
+  PackData(data, 100, false, &packet);
+  OLA_ASSERT_FALSE(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size() - 1),
+      transport_header));
+  OLA_ASSERT_FALSE(decoder.HandleDatagram(&packet[0], 20, transport_header));
+
+  // the 20 bit length flag on the root PDU
+  PackData(data, 100, false, &packet);
+  packet[0] = static_cast<uint8_t>(packet[0] | 0x80);
+  OLA_ASSERT_FALSE(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size()),
+      transport_header));
+
+  // an address increment other than 1
+  PackData(data, 100, false, &packet);
+  packet[106] = 2;
+  OLA_ASSERT_FALSE(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size()),
+      transport_header));
+
+  OLA_ASSERT_EQ(0u, m_updates);
+
+  // and a valid packet is decoded
+  PackData(data, 100, false, &packet);
+  OLA_ASSERT(decoder.HandleDatagram(
+      &packet[0], static_cast<unsigned int>(packet.size()),
+      transport_header));
+  OLA_ASSERT_EQ(1u, m_updates);
+  OLA_ASSERT(data == m_buffer);
+}
+}  // namespace acn
+}  // namespace ola
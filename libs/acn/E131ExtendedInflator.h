@@ -0,0 +1,74 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131ExtendedInflator.h
+ * An inflator for the E1.31 extended (synchronization) messages.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_E131EXTENDEDINFLATOR_H_
+#define LIBS_ACN_E131EXTENDEDINFLATOR_H_
+
+#include <stdint.h>
+#include <memory>
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+#include "ola/acn/ACNVectors.h"
+#include "libs/acn/BaseInflator.h"
+
+namespace ola {
+namespace acn {
+
+/*
+ * Handles the PDUs within a VECTOR_ROOT_E131_EXTENDED root PDU. Only
+ * synchronization is supported, the sync address is passed to the callback.
+ */
+class E131ExtendedInflator: public BaseInflator {
+ public:
+  typedef ola::Callback2<void, const HeaderSet&, uint16_t> SyncCallback;
+
+  /**
+   * @brief Create a new E131ExtendedInflator.
+   * @param callback the callback to run when a sync packet arrives, ownership
+   *   is transferred.
+   */
+  explicit E131ExtendedInflator(SyncCallback *callback)
+      : BaseInflator(),
+        m_sync_callback(callback) {
+  }
+  ~E131ExtendedInflator() {}
+
+  uint32_t Id() const { return ola::acn::VECTOR_ROOT_E131_EXTENDED; }
+
+ protected:
+  // The header depends on the vector, so it's handled with the data.
+  bool DecodeHeader(HeaderSet *headers, const uint8_t *data,
+                    unsigned int len, unsigned int *bytes_used);
+
+  void ResetHeaderField() {}
+
+  bool HandlePDUData(uint32_t vector,
+                     const HeaderSet &headers,
+                     const uint8_t *data,
+                     unsigned int pdu_len);
+
+ private:
+  std::auto_ptr<SyncCallback> m_sync_callback;
+
+  DISALLOW_COPY_AND_ASSIGN(E131ExtendedInflator);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131EXTENDEDINFLATOR_H_
@@ -40,7 +40,8 @@ class E131Header {
           m_universe(0),
           m_is_preview(false),
           m_has_terminated(false),
-          m_is_rev2(false) {
+          m_is_rev2(false),
+          m_sync_address(0) {
     }
     E131Header(const std::string &source,
                uint8_t priority,
@@ -48,18 +49,43 @@ class E131Header {
                uint16_t universe,
                bool is_preview = false,
                bool has_terminated = false,
-               bool is_rev2 = false)
+               bool is_rev2 = false,
+               uint16_t sync_address = 0)
         : m_source(source),
           m_priority(priority),
           m_sequence(sequence),
           m_universe(universe),
           m_is_preview(is_preview),
           m_has_terminated(has_terminated),
-          m_is_rev2(is_rev2) {
+          m_is_rev2(is_rev2),
+          m_sync_address(sync_address) {
     }
     ~E131Header() {}
 
-    const std::string Source() const { return m_source; }
+    /*
+     * Update the header in place. This reuses the storage for the source
+     * name, so the inflators can decode into the same header each time
+     * without allocating.
+     */
+    void Set(const char *source,
+             uint8_t priority,
+             uint8_t sequence,
+             uint16_t universe,
+             bool is_preview = false,
+             bool has_terminated = false,
+             bool is_rev2 = false,
+             uint16_t sync_address = 0) {
+      m_source.assign(source);
+      m_priority = priority;
+      m_sequence = sequence;
+      m_universe = universe;
+      m_is_preview = is_preview;
+      m_has_terminated = has_terminated;
+      m_is_rev2 = is_rev2;
+      m_sync_address = sync_address;
+    }
+
+    const std::string &Source() const { return m_source; }
     uint8_t Priority() const { return m_priority; }
     uint8_t Sequence() const { return m_sequence; }
     uint16_t Universe() const { return m_universe; }
@@ -68,6 +94,12 @@ class E131Header {
 
     bool UsingRev2() const { return m_is_rev2; }
 
+    /*
+     * The universe that sync packets for this data are sent on, 0 means the
+     * data isn't synchronized.
+     */
+    uint16_t SyncAddress() const { return m_sync_address; }
+
     bool operator==(const E131Header &other) const {
       return m_source == other.m_source &&
         m_priority == other.m_priority &&
@@ -75,7 +107,8 @@ class E131Header {
         m_universe == other.m_universe &&
         m_is_preview == other.m_is_preview &&
         m_has_terminated == other.m_has_terminated &&
-        m_is_rev2 == other.m_is_rev2;
+        m_is_rev2 == other.m_is_rev2 &&
+        m_sync_address == other.m_sync_address;
     }
 
     enum { SOURCE_NAME_LEN = 64 };
@@ -84,7 +117,7 @@ class E131Header {
     struct e131_pdu_header_s {
       char source[SOURCE_NAME_LEN];
       uint8_t priority;
-      uint16_t reserved;
+      uint16_t sync_address;
       uint8_t sequence;
       uint8_t options;
       uint16_t universe;
@@ -102,6 +135,7 @@ class E131Header {
     bool m_is_preview;
     bool m_has_terminated;
     bool m_is_rev2;
+    uint16_t m_sync_address;
 };
 
 
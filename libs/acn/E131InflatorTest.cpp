@@ -26,8 +26,10 @@
 #include "ola/network/NetworkUtils.h"
 #include "libs/acn/HeaderSet.h"
 #include "libs/acn/PDUTestCommon.h"
+#include "libs/acn/E131ExtendedInflator.h"
 #include "libs/acn/E131Inflator.h"
 #include "libs/acn/E131PDU.h"
+#include "libs/acn/E131SyncPDU.h"
 #include "ola/testing/TestUtils.h"
 
 namespace ola {
@@ -42,13 +44,26 @@ class E131InflatorTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testDecodeHeader);
   CPPUNIT_TEST(testInflateRev2PDU);
   CPPUNIT_TEST(testInflatePDU);
+  CPPUNIT_TEST(testInflateSyncPDU);
   CPPUNIT_TEST_SUITE_END();
 
  public:
+    E131InflatorTest() : m_sync_count(0), m_sync_address(0) {}
+
     void testDecodeRev2Header();
     void testDecodeHeader();
     void testInflatePDU();
     void testInflateRev2PDU();
+    void testInflateSyncPDU();
+
+ private:
+    unsigned int m_sync_count;
+    uint16_t m_sync_address;
+
+    void HandleSync(const HeaderSet&, uint16_t sync_address) {
+      m_sync_count++;
+      m_sync_address = sync_address;
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(E131InflatorTest);
@@ -114,7 +129,9 @@ void E131InflatorTest::testDecodeHeader() {
 
   strncpy(header.source, source_name.data(), source_name.size() + 1);
   header.priority = 99;
+  header.sync_address = HostToNetwork(static_cast<uint16_t>(7000));
   header.sequence = 10;
+  header.options = 0;
   header.universe = HostToNetwork(static_cast<uint16_t>(42));
 
   OLA_ASSERT(inflator.DecodeHeader(&header_set,
@@ -127,6 +144,7 @@ void E131InflatorTest::testDecodeHeader() {
   OLA_ASSERT_EQ((uint8_t) 99, decoded_header.Priority());
   OLA_ASSERT_EQ((uint8_t) 10, decoded_header.Sequence());
   OLA_ASSERT_EQ((uint16_t) 42, decoded_header.Universe());
+  OLA_ASSERT_EQ((uint16_t) 7000, decoded_header.SyncAddress());
 
   // try an undersized header
   OLA_ASSERT_FALSE(inflator.DecodeHeader(
@@ -181,7 +199,7 @@ void E131InflatorTest::testInflateRev2PDU() {
  */
 void E131InflatorTest::testInflatePDU() {
   const string source = "foobar source";
-  E131Header header(source, 1, 2, 6000);
+  E131Header header(source, 1, 2, 6000, false, false, false, 7000);
   // TODO(simon): pass a DMP msg here as well
   E131PDU pdu(3, header, NULL);
   OLA_ASSERT_EQ((unsigned int) 77, pdu.Size());
@@ -198,5 +216,30 @@ void E131InflatorTest::testInflatePDU() {
   OLA_ASSERT(header == header_set.GetE131Header());
   delete[] data;
 }
+
+
+/*
+ * Check that the extended inflator handles sync PDUs.
+ */
+void E131InflatorTest::testInflateSyncPDU() {
+  E131SyncPDU pdu(5, 7000);
+  unsigned int size = pdu.Size();
+  uint8_t *data = new uint8_t[size];
+  unsigned int bytes_used = size;
+  OLA_ASSERT(pdu.Pack(data, &bytes_used));
+
+  E131ExtendedInflator inflator(
+      NewCallback(this, &E131InflatorTest::HandleSync));
+  HeaderSet header_set;
+  OLA_ASSERT_EQ(size, inflator.InflatePDUBlock(&header_set, data, size));
+  OLA_ASSERT_EQ(1u, m_sync_count);
+  OLA_ASSERT_EQ((uint16_t) 7000, m_sync_address);
+
+  // Other vectors are ignored
+  data[5] = ola::acn::VECTOR_E131_EXTENDED_DISCOVERY;
+  inflator.InflatePDUBlock(&header_set, data, size);
+  OLA_ASSERT_EQ(1u, m_sync_count);
+  delete[] data;
+}
 }  // namespace acn
 }  // namespace ola
@@ -18,6 +18,7 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <stddef.h>
 #include <string.h>
 #include <algorithm>
 #include <map>
@@ -53,13 +54,12 @@ class TrackedSource {
         total_pages(0) {
   }
 
-  IPV4Address ip_address;
-  string source_name;
+  // The universes from the last complete set of pages.
   set<uint16_t> universes;
 
   uint8_t clean_counter;
 
-  void NewPage(uint8_t page_number, uint8_t last_page,
+  bool NewPage(uint8_t page_number, uint8_t last_page,
                uint32_t sequence_number,
                const vector<uint16_t> &universes);
 
@@ -70,7 +70,10 @@ class TrackedSource {
   set<uint16_t> new_universes;
 };
 
-void TrackedSource::NewPage(uint8_t page_number, uint8_t last_page,
+/*
+ * Returns true if this page completed the set.
+ */
+bool TrackedSource::NewPage(uint8_t page_number, uint8_t last_page,
                             uint32_t sequence_number,
                             const vector<uint16_t> &rx_universes) {
   clean_counter = 0;
@@ -94,7 +97,7 @@ void TrackedSource::NewPage(uint8_t page_number, uint8_t last_page,
   set<uint8_t>::const_iterator iter = received_pages.begin();
   for (; iter != received_pages.end(); ++iter) {
     if (*iter != expected_page)
-      return;
+      return false;
 
     expected_page++;
   }
@@ -104,9 +107,30 @@ void TrackedSource::NewPage(uint8_t page_number, uint8_t last_page,
     received_pages.clear();
     new_universes.clear();
     total_pages = 0;
+    return true;
   }
+  return false;
 }
 
+/*
+ * An extra socket used to receive data, along with the multicast groups it has
+ * joined.
+ */
+class ReceiveSocket {
+ public:
+  ReceiveSocket(RootInflator *inflator, E131DataDecoder *decoder)
+      : transport(&socket, inflator, decoder),
+        groups(0) {
+  }
+
+  ola::network::UDPSocket socket;
+  IncomingUDPTransport transport;
+  unsigned int groups;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ReceiveSocket);
+};
+
 E131Node::E131Node(ola::thread::SchedulerInterface *ss,
                    const string &ip_address,
                    const Options &options,
@@ -117,25 +141,30 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
       m_cid(cid),
       m_root_sender(m_cid),
       m_e131_sender(&m_socket, &m_root_sender),
-      m_dmp_inflator(options.ignore_preview),
+      m_dmp_inflator(options.ignore_preview, options.per_slot_priority),
       m_discovery_inflator(NewCallback(this, &E131Node::NewDiscoveryPage)),
-      m_incoming_udp_transport(&m_socket, &m_root_inflator),
+      m_extended_inflator(NewCallback(this, &E131Node::HandleSync)),
+      m_data_decoder(&m_dmp_inflator),
+      m_incoming_udp_transport(&m_socket, &m_root_inflator, &m_data_decoder),
+      m_packet_ring(&m_incoming_udp_transport, options.port),
       m_send_buffer(NULL),
-      m_discovery_timeout(ola::thread::INVALID_TIMEOUT) {
+      m_discovery_timeout(ola::thread::INVALID_TIMEOUT),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
 
 
-  if (!m_options.use_rev2) {
-    // Allocate a buffer for the dmx data + start code
-    m_send_buffer = new uint8_t[DMX_UNIVERSE_SIZE + 1];
-    m_send_buffer[0] = 0;  // start code is 0
-  }
+  // Allocate a buffer for the dmx data + start code
+  m_send_buffer = new uint8_t[DMX_UNIVERSE_SIZE + 1];
+  m_send_buffer[0] = 0;  // start code is 0
 
   // setup all the inflators
   m_root_inflator.AddInflator(&m_e131_inflator);
   m_root_inflator.AddInflator(&m_e131_rev2_inflator);
+  m_root_inflator.AddInflator(&m_extended_inflator);
   m_e131_inflator.AddInflator(&m_dmp_inflator);
   m_e131_inflator.AddInflator(&m_discovery_inflator);
   m_e131_rev2_inflator.AddInflator(&m_dmp_inflator);
+  m_dmp_inflator.SetSyncAddressHandler(
+      NewCallback(this, &E131Node::NewSyncAddress));
 }
 
 
@@ -156,6 +185,7 @@ E131Node::~E131Node() {
     delete[] m_send_buffer;
 
   STLDeleteValues(&m_discovered_sources);
+  STLDeleteElements(&m_receive_sockets);
 }
 
 
@@ -180,10 +210,22 @@ bool E131Node::Start() {
 
   m_socket.SetTos(m_options.dscp);
   m_socket.SetMulticastInterface(m_interface.ip_address);
+  m_socket.EnableReceiveTimestamps();
+  if (m_options.receive_buffer_size) {
+    m_socket.SetReceiveBufferSize(m_options.receive_buffer_size);
+  }
 
   m_socket.SetOnData(NewCallback(&m_incoming_udp_transport,
                                  &IncomingUDPTransport::Receive));
 
+  if (m_options.receive_sockets && !SetupReceiveSockets()) {
+    return false;
+  }
+
+  if (m_options.packet_ring) {
+    SetupPacketRing();
+  }
+
   if (m_options.enable_draft_discovery) {
     IPV4Address addr;
     m_e131_sender.UniverseIP(DISCOVERY_UNIVERSE_ID, &addr);
@@ -202,6 +244,7 @@ bool E131Node::Start() {
 bool E131Node::Stop() {
   m_ss->RemoveTimeout(m_discovery_timeout);
   m_discovery_timeout = ola::thread::INVALID_TIMEOUT;
+  FlushOutput();
   return true;
 }
 
@@ -213,6 +256,20 @@ bool E131Node::SetSourceName(uint16_t universe, const string &source) {
     settings->source = source;
   } else {
     iter->second.source = source;
+    iter->second.packet.clear();
+  }
+  return true;
+}
+
+bool E131Node::SetSyncAddress(uint16_t universe, uint16_t sync_address) {
+  ActiveTxUniverses::iterator iter = m_tx_universes.find(universe);
+
+  if (iter == m_tx_universes.end()) {
+    tx_universe *settings = SetupOutgoingSettings(universe);
+    settings->sync_address = sync_address;
+  } else {
+    iter->second.sync_address = sync_address;
+    iter->second.packet.clear();
   }
   return true;
 }
@@ -261,41 +318,50 @@ bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
     settings = &iter->second;
   }
 
-  const uint8_t *dmp_data;
-  unsigned int dmp_data_length;
+  unsigned int slots = buffer.Size();
+  unsigned int data_offset = settings->data_offset + StartCodeSize();
+  if (settings->packet.empty() ||
+      settings->packet.size() - data_offset != slots) {
+    if (!BuildPacketTemplate(universe, settings, slots)) {
+      return false;
+    }
+    data_offset = settings->data_offset + StartCodeSize();
+  }
 
+  // Patch the per-frame fields & the slot data into the cached packet.
+  uint8_t *packet = &settings->packet[0];
+  uint8_t *header = packet + settings->header_offset;
+  uint8_t sequence = static_cast<uint8_t>(settings->sequence + sequence_offset);
   if (m_options.use_rev2) {
-    dmp_data = buffer.GetRaw();
-    dmp_data_length = buffer.Size();
+    header[offsetof(E131Rev2Header::e131_rev2_pdu_header, priority)] =
+        priority;
+    header[offsetof(E131Rev2Header::e131_rev2_pdu_header, sequence)] =
+        sequence;
   } else {
-    unsigned int data_size = DMX_UNIVERSE_SIZE;
-    buffer.Get(m_send_buffer + 1, &data_size);
-    dmp_data = m_send_buffer;
-    dmp_data_length = data_size + 1;
+    header[offsetof(E131Header::e131_pdu_header, priority)] = priority;
+    header[offsetof(E131Header::e131_pdu_header, sequence)] = sequence;
+    header[offsetof(E131Header::e131_pdu_header, options)] =
+        static_cast<uint8_t>(preview ? E131Header::PREVIEW_DATA_MASK : 0);
   }
+  buffer.Get(packet + data_offset, &slots);
 
-  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) dmp_data_length);
-  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(&range_addr,
-                                                     dmp_data,
-                                                     dmp_data_length);
-  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
-  ranged_chunks.push_back(range_chunk);
-  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true,
-                                                       false,
-                                                       ranged_chunks);
-
-  E131Header header(settings->source,
-                    priority,
-                    static_cast<uint8_t>(settings->sequence + sequence_offset),
-                    universe,
-                    preview,  // preview
-                    false,  // terminated
-                    m_options.use_rev2);
+  // Synchronized data is always batched, so the sync packet follows the data
+  // for all the universes.
+  const bool synchronized = settings->sync_address && !m_options.use_rev2;
+  if (m_options.batch_output || synchronized) {
+    StartBatch();
+  }
 
-  bool result = m_e131_sender.SendDMP(header, pdu);
+  const unsigned int length = static_cast<unsigned int>(
+      settings->packet.size());
+  bool result = settings->unicast ?
+      m_e131_sender.SendPacket(settings->unicast->targets, packet, length) :
+      m_e131_sender.SendPacket(universe, packet, length);
   if (result && !sequence_offset)
     settings->sequence++;
-  delete pdu;
+  if (result && synchronized) {
+    AddPendingSync(*settings);
+  }
   return result;
 }
 
@@ -335,7 +401,16 @@ bool E131Node::SendStreamTerminated(uint16_t universe,
                     true,  // terminated
                     false);
 
-  bool result = m_e131_sender.SendDMP(header, pdu);
+  bool result;
+  const unicast_output *unicast = STLFind(&m_unicast_outputs, universe);
+  if (unicast) {
+    vector<uint8_t> packet;
+    result = m_e131_sender.PackDMP(header, pdu, &packet) &&
+        m_e131_sender.SendPacket(unicast->targets, &packet[0],
+                                 static_cast<unsigned int>(packet.size()));
+  } else {
+    result = m_e131_sender.SendDMP(header, pdu);
+  }
   // only update if we were previously tracking this universe
   if (result && iter != m_tx_universes.end())
     iter->second.sequence++;
@@ -343,6 +418,56 @@ bool E131Node::SendStreamTerminated(uint16_t universe,
   return result;
 }
 
+bool E131Node::SetUnicastDestinations(
+    uint16_t universe,
+    const vector<IPV4SocketAddress> &destinations) {
+  IPV4Address group;
+  if (!E131Sender::UniverseIP(universe, &group)) {
+    return false;
+  }
+
+  tx_universe *settings = STLFind(&m_tx_universes, universe);
+  if (destinations.empty()) {
+    if (settings) {
+      settings->unicast = NULL;
+    }
+    STLRemove(&m_unicast_outputs, universe);
+    return true;
+  }
+
+  unicast_output *output = &m_unicast_outputs[universe];
+  output->unicast = destinations;
+  output->targets.clear();
+  if (!m_options.suppress_multicast) {
+    output->targets.push_back(IPV4SocketAddress(group, ola::acn::ACN_PORT));
+  }
+  output->targets.insert(output->targets.end(), destinations.begin(),
+                         destinations.end());
+  if (settings) {
+    settings->unicast = output;
+  }
+  return true;
+}
+
+void E131Node::GetUnicastDestinations(
+    uint16_t universe,
+    vector<IPV4SocketAddress> *destinations) const {
+  destinations->clear();
+  const unicast_output *output = STLFind(&m_unicast_outputs, universe);
+  if (output) {
+    *destinations = output->unicast;
+  }
+}
+
+bool E131Node::FlushOutput() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+  bool ok = m_e131_sender.FlushBatch();
+  return SendPendingSyncs() && ok;
+}
+
 bool E131Node::SetHandler(uint16_t universe,
                           DmxBuffer *buffer,
                           uint8_t *priority,
@@ -354,7 +479,7 @@ bool E131Node::SetHandler(uint16_t universe,
     return false;
   }
 
-  if (!m_socket.JoinMulticast(m_interface.ip_address, addr)) {
+  if (!JoinUniverseGroup(universe, addr)) {
     OLA_WARN << "Failed to join multicast group " << addr;
     return false;
   }
@@ -370,7 +495,7 @@ bool E131Node::RemoveHandler(uint16_t universe) {
     return false;
   }
 
-  if (!m_socket.LeaveMulticast(m_interface.ip_address, addr)) {
+  if (!LeaveUniverseGroup(universe, addr)) {
     OLA_WARN << "Failed to leave multicast group " << addr;
     return false;
   }
@@ -379,19 +504,68 @@ bool E131Node::RemoveHandler(uint16_t universe) {
 }
 
 
+void E131Node::GetReceiveSockets(vector<ola::network::UDPSocket*> *sockets) {
+  ReceiveSockets::iterator iter = m_receive_sockets.begin();
+  for (; iter != m_receive_sockets.end(); ++iter) {
+    sockets->push_back(&(*iter)->socket);
+  }
+}
+
+
 void E131Node::GetKnownControllers(std::vector<KnownController> *controllers) {
-  TrackedSources::const_iterator iter = m_discovered_sources.begin();
-  for (; iter != m_discovered_sources.end(); ++iter) {
+  vector<UniverseDiscoveryIndex::Source> sources;
+  m_discovery_index.GetSources(&sources);
+  vector<UniverseDiscoveryIndex::Source>::const_iterator iter =
+      sources.begin();
+  for (; iter != sources.end(); ++iter) {
     controllers->push_back(KnownController());
     KnownController &controller = controllers->back();
 
-    controller.cid = iter->first;
-    controller.ip_address = iter->second->ip_address;
-    controller.source_name = iter->second->source_name;
-    controller.universes = iter->second->universes;
+    controller.cid = iter->cid;
+    controller.ip_address = iter->ip_address;
+    controller.source_name = iter->source_name;
+    controller.universes = iter->universes;
   }
 }
 
+size_t E131Node::MemoryUsage() const {
+  size_t bytes = m_dmp_inflator.MemoryUsage() +
+      STLNodeMemoryUsage(m_tx_universes) +
+      STLNodeMemoryUsage(m_unicast_outputs) +
+      STLNodeMemoryUsage(m_discovered_sources) +
+      STLNodeMemoryUsage(m_pending_syncs) +
+      STLNodeMemoryUsage(m_sync_sequences) +
+      STLNodeMemoryUsage(m_sync_groups);
+
+  ActiveTxUniverses::const_iterator tx_iter = m_tx_universes.begin();
+  for (; tx_iter != m_tx_universes.end(); ++tx_iter) {
+    bytes += tx_iter->second.source.capacity() +
+        STLVectorMemoryUsage(tx_iter->second.packet);
+  }
+
+  UnicastOutputs::const_iterator unicast_iter = m_unicast_outputs.begin();
+  for (; unicast_iter != m_unicast_outputs.end(); ++unicast_iter) {
+    bytes += STLVectorMemoryUsage(unicast_iter->second.unicast) +
+        STLVectorMemoryUsage(unicast_iter->second.targets);
+  }
+
+  TrackedSources::const_iterator source_iter = m_discovered_sources.begin();
+  for (; source_iter != m_discovered_sources.end(); ++source_iter) {
+    bytes += sizeof(TrackedSource) +
+        STLNodeMemoryUsage(source_iter->second->universes);
+  }
+  return bytes;
+}
+
+void E131Node::GetDiscoveredSources(const UniverseDiscoveryIndex::Query *query,
+                                    UniverseDiscoveryIndex::Page *page) {
+  m_discovery_index.Lookup(*query, page);
+}
+
+void E131Node::SetDiscoveryHandler(DiscoveryHandler *handler) {
+  m_discovery_handler.reset(handler);
+}
+
 /*
  * Create a settings entry for an outgoing universe
  */
@@ -399,12 +573,284 @@ E131Node::tx_universe *E131Node::SetupOutgoingSettings(uint16_t universe) {
   tx_universe settings;
   settings.source = m_options.source_name;
   settings.sequence = 0;
+  settings.sync_address = m_options.sync_universe;
+  settings.header_offset = 0;
+  settings.data_offset = 0;
+  settings.unicast = STLFind(&m_unicast_outputs, universe);
   ActiveTxUniverses::iterator iter =
       m_tx_universes.insert(std::make_pair(universe, settings)).first;
   return &iter->second;
 }
 
 
+/*
+ * Pack the data packet for a universe with the given number of slots. The
+ * priority, sequence number, options and slot data are filled in for each
+ * frame.
+ */
+bool E131Node::BuildPacketTemplate(uint16_t universe, tx_universe *settings,
+                                   unsigned int slots) {
+  const unsigned int dmp_data_length = slots + StartCodeSize();
+  memset(m_send_buffer + 1, 0, DMX_UNIVERSE_SIZE);
+  const uint8_t *dmp_data = m_send_buffer + 1 - StartCodeSize();
+
+  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) dmp_data_length);
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(&range_addr,
+                                                     dmp_data,
+                                                     dmp_data_length);
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true,
+                                                       false,
+                                                       ranged_chunks);
+
+  E131Header header(settings->source,
+                    0,  // priority
+                    0,  // sequence
+                    universe,
+                    false,  // preview
+                    false,  // terminated
+                    m_options.use_rev2,
+                    m_options.use_rev2 ? 0 : settings->sync_address);
+
+  bool ok = m_e131_sender.PackDMP(header, pdu, &settings->packet);
+  if (ok) {
+    const unsigned int header_size = m_options.use_rev2 ?
+        sizeof(E131Rev2Header::e131_rev2_pdu_header) :
+        sizeof(E131Header::e131_pdu_header);
+    // The DMP PDU is the last thing in the packet, and the property values
+    // are the last thing in the DMP PDU.
+    unsigned int packet_size = static_cast<unsigned int>(
+        settings->packet.size());
+    settings->data_offset = packet_size - dmp_data_length;
+    settings->header_offset = packet_size - pdu->Size() - header_size;
+  } else {
+    settings->packet.clear();
+  }
+  delete pdu;
+  return ok;
+}
+
+
+/*
+ * Open the extra receive sockets. These share the port with the main socket,
+ * so each one must only receive the groups it has joined, otherwise every
+ * datagram would be delivered to every socket.
+ */
+bool E131Node::SetupReceiveSockets() {
+  if (!m_socket.ReceiveOnlyJoinedGroups()) {
+    OLA_WARN << "Multicast can't be limited to joined groups, using a single "
+             << "socket";
+    return true;
+  }
+
+  for (unsigned int i = 0; i < m_options.receive_sockets; i++) {
+    auto_ptr<ReceiveSocket> receive_socket(
+        new ReceiveSocket(&m_root_inflator, &m_data_decoder));
+    ola::network::UDPSocket *socket = &receive_socket->socket;
+    if (!socket->Init() ||
+        !socket->Bind(IPV4SocketAddress(IPV4Address::WildCard(),
+                                        m_options.port)) ||
+        !socket->ReceiveOnlyJoinedGroups()) {
+      return false;
+    }
+    socket->EnableReceiveTimestamps();
+    if (m_options.receive_buffer_size) {
+      socket->SetReceiveBufferSize(m_options.receive_buffer_size);
+    }
+    socket->SetOnData(NewCallback(&receive_socket->transport,
+                                  &IncomingUDPTransport::Receive));
+    m_receive_sockets.push_back(receive_socket.release());
+  }
+  OLA_INFO << "Receiving E1.31 on " << m_receive_sockets.size()
+           << " extra sockets";
+  return true;
+}
+
+
+/*
+ * Switch the input to the packet ring. The sockets still join the multicast
+ * groups, but drop what they receive.
+ */
+void E131Node::SetupPacketRing() {
+  if (!m_packet_ring.Init(m_interface.index)) {
+    OLA_WARN << "Packet ring unavailable, receiving from the sockets";
+    return;
+  }
+
+  bool ok = PacketRingTransport::DiscardInput(&m_socket);
+  ReceiveSockets::iterator iter = m_receive_sockets.begin();
+  for (; iter != m_receive_sockets.end(); ++iter) {
+    ok &= PacketRingTransport::DiscardInput(&(*iter)->socket);
+  }
+  if (!ok) {
+    OLA_WARN << "Some datagrams may be handled twice";
+  }
+}
+
+
+/*
+ * Join the group for a universe. If there are extra receive sockets, the
+ * least used one is tried first, falling back to the others if the socket has
+ * reached the membership limit.
+ */
+bool E131Node::JoinUniverseGroup(uint16_t universe,
+                                 const IPV4Address &group) {
+  if (m_receive_sockets.empty()) {
+    return m_socket.JoinMulticast(m_interface.ip_address, group);
+  }
+
+  if (STLContains(m_universe_sockets, universe)) {
+    return true;
+  }
+
+  ReceiveSockets candidates = m_receive_sockets;
+  while (!candidates.empty()) {
+    ReceiveSockets::iterator least_used = candidates.begin();
+    ReceiveSockets::iterator iter = candidates.begin();
+    for (; iter != candidates.end(); ++iter) {
+      if ((*iter)->groups < (*least_used)->groups) {
+        least_used = iter;
+      }
+    }
+
+    ReceiveSocket *receive_socket = *least_used;
+    if (receive_socket->socket.JoinMulticast(m_interface.ip_address, group)) {
+      receive_socket->groups++;
+      m_universe_sockets[universe] = receive_socket;
+      return true;
+    }
+    candidates.erase(least_used);
+  }
+  return false;
+}
+
+
+bool E131Node::LeaveUniverseGroup(uint16_t universe,
+                                  const IPV4Address &group) {
+  if (m_receive_sockets.empty()) {
+    return m_socket.LeaveMulticast(m_interface.ip_address, group);
+  }
+
+  ReceiveSocket *receive_socket = STLLookupAndRemovePtr(&m_universe_sockets,
+                                                        universe);
+  if (!receive_socket) {
+    return false;
+  }
+  receive_socket->groups--;
+  return receive_socket->socket.LeaveMulticast(m_interface.ip_address, group);
+}
+
+
+/*
+ * Start queuing packets, if we're not already, and schedule the flush for
+ * when control returns to the event loop.
+ */
+void E131Node::StartBatch() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  m_e131_sender.StartBatch();
+  m_flush_timeout = m_ss->RegisterSingleTimeout(
+      0, NewSingleCallback(this, &E131Node::BatchTimeout));
+}
+
+void E131Node::BatchTimeout() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  m_e131_sender.FlushBatch();
+  SendPendingSyncs();
+}
+
+
+/*
+ * Record that data was sent for a synchronized universe, so the sync packet
+ * goes to the same destinations.
+ */
+void E131Node::AddPendingSync(const tx_universe &settings) {
+  pending_sync *sync = &m_pending_syncs[settings.sync_address];
+  if (!settings.unicast || !m_options.suppress_multicast) {
+    sync->multicast = true;
+  }
+  if (!settings.unicast) {
+    return;
+  }
+
+  vector<IPV4SocketAddress>::const_iterator iter =
+      settings.unicast->unicast.begin();
+  for (; iter != settings.unicast->unicast.end(); ++iter) {
+    if (std::find(sync->unicast.begin(), sync->unicast.end(), *iter) ==
+        sync->unicast.end()) {
+      sync->unicast.push_back(*iter);
+    }
+  }
+}
+
+
+/*
+ * Send a sync packet for each sync address that had data sent since the last
+ * flush.
+ */
+bool E131Node::SendPendingSyncs() {
+  bool ok = true;
+  PendingSyncs::const_iterator iter = m_pending_syncs.begin();
+  for (; iter != m_pending_syncs.end(); ++iter) {
+    const uint16_t sync_address = iter->first;
+    const pending_sync &sync = iter->second;
+    uint8_t &sequence = m_sync_sequences[sync_address];
+
+    bool sent;
+    if (sync.unicast.empty()) {
+      sent = m_e131_sender.SendSync(sync_address, sequence);
+    } else {
+      m_sync_targets.clear();
+      IPV4Address group;
+      if (sync.multicast && E131Sender::UniverseIP(sync_address, &group)) {
+        m_sync_targets.push_back(IPV4SocketAddress(group, ola::acn::ACN_PORT));
+      }
+      m_sync_targets.insert(m_sync_targets.end(), sync.unicast.begin(),
+                            sync.unicast.end());
+      sent = m_e131_sender.SendSync(sync_address, sequence, m_sync_targets);
+    }
+
+    if (sent) {
+      sequence++;
+    } else {
+      ok = false;
+    }
+  }
+  m_pending_syncs.clear();
+  return ok;
+}
+
+
+void E131Node::HandleSync(const HeaderSet&, uint16_t sync_address) {
+  m_dmp_inflator.HandleSync(sync_address);
+}
+
+
+/*
+ * Called when an input universe starts using a new sync address, we need to
+ * join the group to get the sync packets.
+ */
+void E131Node::NewSyncAddress(uint16_t sync_address) {
+  if (STLContains(m_sync_groups, sync_address)) {
+    return;
+  }
+
+  IPV4Address addr;
+  if (!m_e131_sender.UniverseIP(sync_address, &addr)) {
+    return;
+  }
+
+  OLA_INFO << "Joining E1.31 sync address " << sync_address;
+  if (!m_socket.JoinMulticast(m_interface.ip_address, addr)) {
+    OLA_WARN << "Failed to join multicast group " << addr;
+    return;
+  }
+  m_sync_groups.insert(sync_address);
+}
+
+
 bool E131Node::PerformDiscoveryHousekeeping() {
   // Send the Universe Discovery packets.
   vector<uint16_t> universes;
@@ -419,11 +865,13 @@ bool E131Node::PerformDiscoveryHousekeeping() {
 
   // Delete any sources that we haven't heard from in 2 x
   // UNIVERSE_DISCOVERY_INTERVAL.
+  bool changed = false;
   TrackedSources::iterator iter = m_discovered_sources.begin();
   while (iter != m_discovered_sources.end()) {
     if (iter->second->clean_counter >= 2) {
       delete iter->second;
       OLA_INFO << "Removing " << iter->first.ToString() << " due to inactivity";
+      changed |= m_discovery_index.Remove(iter->first);
       m_discovered_sources.erase(iter++);
     } else {
       iter->second->clean_counter++;
@@ -431,9 +879,20 @@ bool E131Node::PerformDiscoveryHousekeeping() {
     }
   }
 
+  if (changed) {
+    DiscoveryChanged();
+  }
   return true;
 }
 
+void E131Node::DiscoveryChanged() {
+  if (m_discovery_handler.get()) {
+    UniverseDiscoveryIndex::Stats stats;
+    m_discovery_index.GetStats(&stats);
+    m_discovery_handler->Run(stats);
+  }
+}
+
 void E131Node::NewDiscoveryPage(
     const HeaderSet &headers,
     const E131DiscoveryInflator::DiscoveryPage &page) {
@@ -441,25 +900,29 @@ void E131Node::NewDiscoveryPage(
     return;
   }
 
+  const CID cid = headers.GetRootHeader().GetCid();
   TrackedSources::iterator iter = STLLookupOrInsertNull(
-      &m_discovered_sources,
-      headers.GetRootHeader().GetCid());
+      &m_discovered_sources, cid);
   if (!iter->second) {
     iter->second = new TrackedSource();
-    iter->second->ip_address = headers.GetTransportHeader().Source().Host();
-    iter->second->source_name = headers.GetE131Header().Source();
   }
 
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
   TrackedSource *source = iter->second;
-  if (source->ip_address != headers.GetTransportHeader().Source().Host()) {
-    OLA_INFO << "CID " << headers.GetRootHeader().GetCid().ToString()
-             << " changed from " << source->ip_address << " to "
-             << headers.GetTransportHeader().Source().Host();
-    source->ip_address = headers.GetTransportHeader().Source().Host();
-  }
-  source->source_name = headers.GetE131Header().Source();
-  source->NewPage(page.page_number, page.last_page, page.page_sequence,
-                  page.universes);
+  if (!source->NewPage(page.page_number, page.last_page, page.page_sequence,
+                       page.universes)) {
+    m_discovery_index.Seen(cid, now);
+    return;
+  }
+
+  // The index only changes once a complete set of pages has arrived.
+  if (m_discovery_index.Update(cid,
+                               headers.GetTransportHeader().Source().Host(),
+                               headers.GetE131Header().Source(),
+                               source->universes, now)) {
+    DiscoveryChanged();
+  }
 }
 
 void E131Node::SendDiscoveryPage(const std::vector<uint16_t> &universes,
@@ -23,10 +23,12 @@
 #define LIBS_ACN_E131NODE_H_
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/acn/ACNPort.h"
@@ -36,13 +38,18 @@
 #include "ola/thread/SchedulerInterface.h"
 #include "ola/network/Interface.h"
 #include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
 #include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/E131DataDecoder.h"
 #include "libs/acn/E131DiscoveryInflator.h"
+#include "libs/acn/E131ExtendedInflator.h"
 #include "libs/acn/E131Inflator.h"
 #include "libs/acn/E131Sender.h"
+#include "libs/acn/PacketRingTransport.h"
 #include "libs/acn/RootInflator.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
+#include "libs/acn/UniverseDiscoveryIndex.h"
 
 namespace ola {
 namespace acn {
@@ -58,6 +65,13 @@ class E131Node {
        : use_rev2(false),
          ignore_preview(true),
          enable_draft_discovery(false),
+         per_slot_priority(false),
+         batch_output(false),
+         suppress_multicast(false),
+         receive_sockets(0),
+         receive_buffer_size(0),
+         packet_ring(false),
+         sync_universe(0),
          dscp(0),
          port(ola::acn::ACN_PORT),
          source_name(ola::OLA_DEFAULT_INSTANCE_NAME) {
@@ -66,6 +80,49 @@ class E131Node {
     bool use_rev2;  /**< Use Revision 0.2 of the 2009 draft */
     bool ignore_preview;  /**< Ignore preview data */
     bool enable_draft_discovery;  /**< Enable 2014 draft discovery */
+    /**
+     * @brief Merge sources using the per-slot priorities (0xDD start code).
+     */
+    bool per_slot_priority;
+    /**
+     * @brief Queue the DMX packets sent during an iteration of the event loop
+     * and send them all at once.
+     */
+    bool batch_output;
+    /**
+     * @brief Don't send to the multicast group for universes that have
+     * unicast destinations.
+     */
+    bool suppress_multicast;
+    /**
+     * @brief The number of extra sockets to spread the input universes
+     * across.
+     *
+     * Each socket has its own multicast memberships and receive queue, which
+     * avoids the per-socket membership limit (igmp_max_memberships on Linux).
+     * If 0, all universes are received on the main socket.
+     */
+    unsigned int receive_sockets;
+    /**
+     * @brief The size of the kernel receive buffer for each socket, 0 uses the
+     * system default.
+     */
+    unsigned int receive_buffer_size;
+    /**
+     * @brief Receive from a PACKET_MMAP ring on the interface rather than
+     * from the sockets.
+     *
+     * This needs Linux and CAP_NET_RAW, otherwise the sockets are used.
+     */
+    bool packet_ring;
+    /**
+     * @brief The sync address to use for outgoing universes, 0 disables
+     * universe synchronization.
+     *
+     * Synchronized data is batched and the sync packet is sent after the
+     * data for all universes has been sent. This is ignored for revision 0.2.
+     */
+    uint16_t sync_universe;
     uint8_t dscp;  /**< The DSCP value to tag packets with */
     uint16_t port; /**< The UDP port to use, defaults to ACN_PORT */
     std::string source_name; /**< The source name to use */
@@ -108,6 +165,14 @@ class E131Node {
    */
   bool SetSourceName(uint16_t universe, const std::string &source);
 
+  /**
+   * @brief Set the sync address for a universe.
+   * @param universe the id of the universe to send
+   * @param sync_address the universe to send sync packets on, 0 disables
+   *   synchronization for this universe.
+   */
+  bool SetSyncAddress(uint16_t universe, uint16_t sync_address);
+
   /**
    * @brief Signal that we will start sending on this particular universe.
    *   Without sending any DMX data.
@@ -171,6 +236,40 @@ class E131Node {
                             const ola::DmxBuffer &buffer = DmxBuffer(),
                             uint8_t priority = DEFAULT_PRIORITY);
 
+  /**
+   * @brief Set the unicast destinations for an outgoing universe.
+   * @param universe the universe to set the destinations for.
+   * @param destinations the addresses to send the universe to. If empty, the
+   *   universe is only sent to its multicast group.
+   * @return false if the universe isn't a valid E1.31 universe.
+   *
+   * Each packet is packed once and sent to all the destinations, along with
+   * the multicast group unless suppress_multicast was set in the node
+   * Options. Stream terminated and synchronization packets for the universe
+   * are sent to the same destinations.
+   */
+  bool SetUnicastDestinations(
+      uint16_t universe,
+      const std::vector<ola::network::IPV4SocketAddress> &destinations);
+
+  /**
+   * @brief Get the unicast destinations for an outgoing universe.
+   * @param universe the universe to get the destinations for.
+   * @param[out] destinations the unicast destinations for the universe.
+   */
+  void GetUnicastDestinations(
+      uint16_t universe,
+      std::vector<ola::network::IPV4SocketAddress> *destinations) const;
+
+  /**
+   * @brief Send any DMX packets that have been queued.
+   * @return true if all the packets were sent, false otherwise.
+   *
+   * If batch_output is set, this is called automatically once control returns
+   * to the event loop.
+   */
+  bool FlushOutput();
+
   /**
    * @brief Set the Callback to be run when we receive data for this universe.
    * @param universe the universe to register the handler for
@@ -182,6 +281,35 @@ class E131Node {
   bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
                   uint8_t *priority, ola::Callback0<void> *handler);
 
+  /**
+   * @brief The time the packet being handled was received by the kernel.
+   *
+   * This is only valid from within a handler set with SetHandler(). It isn't
+   * set if the platform doesn't support receive timestamps.
+   */
+  const TimeStamp &ReceiveTime() const {
+    return m_dmp_inflator.ReceiveTime();
+  }
+
+  /**
+   * @brief Get the statistics for the sources of an input universe.
+   * @param universe the universe to get the statistics for.
+   * @param[out] stats the statistics for each source being tracked.
+   * @return false if there isn't a handler for the universe.
+   */
+  bool GetSourceStatistics(
+      uint16_t universe,
+      std::vector<DMPE131Inflator::SourceStats> *stats) const {
+    return m_dmp_inflator.SourceStatistics(universe, stats);
+  }
+
+  /**
+   * @brief Estimate the memory used by the sources the node tracks, the
+   *   discovered sources and the outgoing universes.
+   * @returns the estimate in bytes.
+   */
+  size_t MemoryUsage() const;
+
   /**
    * @brief Remove the handler for a particular universe.
    * @param universe the universe handler to remove
@@ -199,6 +327,24 @@ class E131Node {
    */
   ola::network::UDPSocket* GetSocket() { return &m_socket; }
 
+  /**
+   * @brief Return the extra sockets used to receive data.
+   * @param[out] sockets the sockets, these need to be added to the
+   *   SelectServer along with the one from GetSocket().
+   *
+   * This is empty unless receive_sockets was set in the node Options.
+   */
+  void GetReceiveSockets(std::vector<ola::network::UDPSocket*> *sockets);
+
+  /**
+   * @brief Return the descriptor for the packet ring.
+   * @returns the descriptor, which needs to be added to the SelectServer, or
+   *   NULL if the packet ring isn't in use.
+   */
+  ola::io::ReadFileDescriptor *GetPacketRing() {
+    return m_packet_ring.GetDescriptor();
+  }
+
   /**
    * @brief Return a list of known controllers.
    *
@@ -207,14 +353,61 @@ class E131Node {
    */
   void GetKnownControllers(std::vector<KnownController> *controllers);
 
+  /**
+   * @brief Look up the sources learnt from universe discovery.
+   * @param query the sources to return.
+   * @param[out] page the matching sources.
+   *
+   * The page will be empty unless enable_draft_discovery was set in the node
+   * Options.
+   */
+  void GetDiscoveredSources(const UniverseDiscoveryIndex::Query *query,
+                            UniverseDiscoveryIndex::Page *page);
+
+  typedef Callback1<void, const UniverseDiscoveryIndex::Stats&>
+      DiscoveryHandler;
+
+  /**
+   * @brief Set the handler to run when the discovered sources change.
+   * @param handler the handler to run, ownership is transferred. It's run on
+   *   the node's SchedulerInterface. May be NULL.
+   */
+  void SetDiscoveryHandler(DiscoveryHandler *handler);
+
  private:
+  struct unicast_output {
+    std::vector<ola::network::IPV4SocketAddress> unicast;
+    // The multicast group, unless it's suppressed, followed by the unicast
+    // destinations.
+    std::vector<ola::network::IPV4SocketAddress> targets;
+  };
+
   struct tx_universe {
     std::string source;
     uint8_t sequence;
+    uint16_t sync_address;  // 0 if not synchronized
+    // The packed data packet, rebuilt when the source name or slot count
+    // changes.
+    std::vector<uint8_t> packet;
+    unsigned int header_offset;  // offset of the E1.31 framing layer header
+    unsigned int data_offset;  // offset of the DMP property values
+    // NULL if the universe is multicast only.
+    const unicast_output *unicast;
+  };
+
+  struct pending_sync {
+    bool multicast;
+    std::vector<ola::network::IPV4SocketAddress> unicast;
+
+    pending_sync() : multicast(false) {}
   };
 
   typedef std::map<uint16_t, tx_universe> ActiveTxUniverses;
+  typedef std::map<uint16_t, unicast_output> UnicastOutputs;
+  typedef std::map<uint16_t, pending_sync> PendingSyncs;
   typedef std::map<acn::CID, class TrackedSource*> TrackedSources;
+  typedef std::vector<class ReceiveSocket*> ReceiveSockets;
+  typedef std::map<uint16_t, class ReceiveSocket*> UniverseSockets;
 
   ola::thread::SchedulerInterface *m_ss;
   const Options m_options;
@@ -232,18 +425,53 @@ class E131Node {
   E131InflatorRev2 m_e131_rev2_inflator;
   DMPE131Inflator m_dmp_inflator;
   E131DiscoveryInflator m_discovery_inflator;
+  E131ExtendedInflator m_extended_inflator;
+  // Decodes simple data packets without going through the inflators.
+  E131DataDecoder m_data_decoder;
 
   IncomingUDPTransport m_incoming_udp_transport;
+  PacketRingTransport m_packet_ring;
+  ReceiveSockets m_receive_sockets;
+  UniverseSockets m_universe_sockets;
   ActiveTxUniverses m_tx_universes;
+  UnicastOutputs m_unicast_outputs;
   uint8_t *m_send_buffer;
 
   // Discovery members
   ola::thread::timeout_id m_discovery_timeout;
   TrackedSources m_discovered_sources;
+  UniverseDiscoveryIndex m_discovery_index;
+  std::auto_ptr<DiscoveryHandler> m_discovery_handler;
+  // Only used to expire discovered sources.
+  ola::CoarseClock m_clock;
+
+  ola::thread::timeout_id m_flush_timeout;
+
+  // Universe synchronization members
+  PendingSyncs m_pending_syncs;
+  std::vector<ola::network::IPV4SocketAddress> m_sync_targets;
+  std::map<uint16_t, uint8_t> m_sync_sequences;
+  std::set<uint16_t> m_sync_groups;
 
   tx_universe *SetupOutgoingSettings(uint16_t universe);
+  bool BuildPacketTemplate(uint16_t universe, tx_universe *settings,
+                           unsigned int slots);
+  unsigned int StartCodeSize() const { return m_options.use_rev2 ? 0 : 1; }
+  void AddPendingSync(const tx_universe &settings);
+  void StartBatch();
+  bool SetupReceiveSockets();
+  void SetupPacketRing();
+  bool JoinUniverseGroup(uint16_t universe,
+                         const ola::network::IPV4Address &group);
+  bool LeaveUniverseGroup(uint16_t universe,
+                          const ola::network::IPV4Address &group);
+  void BatchTimeout();
+  bool SendPendingSyncs();
+  void HandleSync(const HeaderSet &headers, uint16_t sync_address);
+  void NewSyncAddress(uint16_t sync_address);
 
   bool PerformDiscoveryHousekeeping();
+  void DiscoveryChanged();
   void NewDiscoveryPage(const HeaderSet &headers,
                         const E131DiscoveryInflator::DiscoveryPage &page);
   void SendDiscoveryPage(const std::vector<uint16_t> &universes, uint8_t page,
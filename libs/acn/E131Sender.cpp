@@ -18,15 +18,20 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <vector>
+
 #include "ola/Logging.h"
+#include "ola/acn/ACNPort.h"
 #include "ola/acn/ACNVectors.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/SocketAddress.h"
 #include "ola/util/Utils.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/E131Inflator.h"
 #include "libs/acn/E131Sender.h"
 #include "libs/acn/E131PDU.h"
+#include "libs/acn/E131SyncPDU.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
 
@@ -34,7 +39,38 @@ namespace ola {
 namespace acn {
 
 using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
 using ola::network::HostToNetwork;
+using std::vector;
+
+namespace {
+
+/*
+ * An OutgoingTransport that stores the packed datagram rather than
+ * sending it.
+ */
+class PackingTransport: public OutgoingTransport {
+ public:
+  PackingTransport(PreamblePacker *packer, std::vector<uint8_t> *packet)
+      : m_packer(packer),
+        m_packet(packet) {
+  }
+
+  bool Send(const PDUBlock<PDU> &pdu_block) {
+    unsigned int length;
+    const uint8_t *data = m_packer->Pack(pdu_block, &length);
+    if (!data) {
+      return false;
+    }
+    m_packet->assign(data, data + length);
+    return true;
+  }
+
+ private:
+  PreamblePacker *m_packer;
+  std::vector<uint8_t> *m_packet;
+};
+}  // namespace
 
 /*
  * Create a new E131Sender
@@ -78,6 +114,53 @@ bool E131Sender::SendDMP(const E131Header &header, const DMPPDU *dmp_pdu) {
   return m_root_sender->SendPDU(vector, pdu, &transport);
 }
 
+/*
+ * Pack a DMPPDU into a complete datagram without sending it.
+ * @param header the E131Header
+ * @param dmp_pdu the DMPPDU to pack
+ * @param packet where to store the packed datagram
+ */
+bool E131Sender::PackDMP(const E131Header &header, const DMPPDU *dmp_pdu,
+                         std::vector<uint8_t> *packet) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  PackingTransport transport(&m_packer, packet);
+
+  E131PDU pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu);
+  unsigned int vector = ola::acn::VECTOR_ROOT_E131;
+  if (header.UsingRev2()) {
+    vector = ola::acn::VECTOR_ROOT_E131_REV2;
+  }
+  return m_root_sender->SendPDU(vector, pdu, &transport);
+}
+
+
+/*
+ * Send a datagram that was packed with PackDMP().
+ * @param universe the universe the datagram is for
+ * @param data the datagram
+ * @param length the length of the datagram
+ */
+bool E131Sender::SendPacket(uint16_t universe, const uint8_t *data,
+                            unsigned int length) {
+  IPV4Address addr;
+  if (!UniverseIP(universe, &addr)) {
+    OLA_INFO << "Could not convert universe " << universe << " to IP.";
+    return false;
+  }
+  return m_transport_impl.Send(
+      data, length, IPV4SocketAddress(addr, ola::acn::ACN_PORT));
+}
+
+
+bool E131Sender::SendPacket(const vector<IPV4SocketAddress> &destinations,
+                            const uint8_t *data,
+                            unsigned int length) {
+  return m_transport_impl.Send(data, length, destinations);
+}
+
 bool E131Sender::SendDiscoveryData(const E131Header &header,
                                    const uint8_t *data,
                                    unsigned int data_size) {
@@ -100,6 +183,47 @@ bool E131Sender::SendDiscoveryData(const E131Header &header,
 }
 
 
+/*
+ * Send a Synchronization packet, this tells receivers to act on the data
+ * they've been holding for the sync address.
+ */
+bool E131Sender::SendSync(uint16_t sync_address, uint8_t sequence) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  IPV4Address addr;
+  if (!UniverseIP(sync_address, &addr)) {
+    OLA_INFO << "Could not convert universe " << sync_address << " to IP.";
+    return false;
+  }
+
+  OutgoingUDPTransport transport(&m_transport_impl, addr);
+
+  E131SyncPDU pdu(sequence, sync_address);
+  return m_root_sender->SendPDU(ola::acn::VECTOR_ROOT_E131_EXTENDED, pdu,
+                                &transport);
+}
+
+
+bool E131Sender::SendSync(uint16_t sync_address, uint8_t sequence,
+                          const vector<IPV4SocketAddress> &destinations) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  PackingTransport transport(&m_packer, &m_sync_packet);
+  E131SyncPDU pdu(sequence, sync_address);
+  if (!m_root_sender->SendPDU(ola::acn::VECTOR_ROOT_E131_EXTENDED, pdu,
+                              &transport)) {
+    return false;
+  }
+  return m_transport_impl.Send(
+      &m_sync_packet[0], static_cast<unsigned int>(m_sync_packet.size()),
+      destinations);
+}
+
+
 /*
  * Calculate the IP that corresponds to a universe.
  * @param universe the universe id
@@ -22,6 +22,8 @@
 #ifndef LIBS_ACN_E131SENDER_H_
 #define LIBS_ACN_E131SENDER_H_
 
+#include <vector>
+
 #include "ola/network/Socket.h"
 #include "libs/acn/DMPPDU.h"
 #include "libs/acn/E131Header.h"
@@ -41,9 +43,51 @@ class E131Sender {
   ~E131Sender() {}
 
   bool SendDMP(const E131Header &header, const DMPPDU *pdu);
+  bool PackDMP(const E131Header &header, const DMPPDU *pdu,
+               std::vector<uint8_t> *packet);
+  bool SendPacket(uint16_t universe, const uint8_t *data,
+                  unsigned int length);
+
+  /**
+   * @brief Send a datagram packed with PackDMP() to a list of destinations.
+   * @param destinations the addresses to send to.
+   * @param data the datagram
+   * @param length the length of the datagram
+   */
+  bool SendPacket(
+      const std::vector<ola::network::IPV4SocketAddress> &destinations,
+      const uint8_t *data,
+      unsigned int length);
   bool SendDiscoveryData(const E131Header &header, const uint8_t *data,
                          unsigned int data_size);
 
+  /**
+   * @brief Send a synchronization packet.
+   * @param sync_address the universe to send the sync packet on.
+   * @param sequence the sequence number for the sync address.
+   */
+  bool SendSync(uint16_t sync_address, uint8_t sequence);
+
+  /**
+   * @brief Send a synchronization packet to a list of destinations.
+   * @param sync_address the universe the sync packet is for.
+   * @param sequence the sequence number for the sync address.
+   * @param destinations the addresses to send to.
+   */
+  bool SendSync(
+      uint16_t sync_address, uint8_t sequence,
+      const std::vector<ola::network::IPV4SocketAddress> &destinations);
+
+  /**
+   * @brief Queue packets until FlushBatch() is called.
+   */
+  void StartBatch() { m_transport_impl.StartBatch(); }
+
+  /**
+   * @brief Send all queued packets.
+   */
+  bool FlushBatch() { return m_transport_impl.FlushBatch(); }
+
   static bool UniverseIP(uint16_t universe,
                          class ola::network::IPV4Address *addr);
 
@@ -52,6 +96,7 @@ class E131Sender {
   PreamblePacker m_packer;
   OutgoingUDPTransportImpl m_transport_impl;
   class RootSender *m_root_sender;
+  std::vector<uint8_t> m_sync_packet;
 
   DISALLOW_COPY_AND_ASSIGN(E131Sender);
 };
@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131SyncPDU.cpp
+ * The E131SyncPDU
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include "ola/Logging.h"
+#include "ola/network/NetworkUtils.h"
+#include "libs/acn/E131SyncPDU.h"
+
+namespace ola {
+namespace acn {
+
+using ola::io::OutputStream;
+using ola::network::HostToNetwork;
+
+/*
+ * Pack the header portion.
+ */
+bool E131SyncPDU::PackHeader(uint8_t *data, unsigned int *length) const {
+  if (*length < HeaderSize()) {
+    OLA_WARN << "E131SyncPDU::PackHeader: buffer too small, got " << *length
+             << " required " << HeaderSize();
+    *length = 0;
+    return false;
+  }
+
+  sync_pdu_header header;
+  BuildHeader(&header);
+  *length = sizeof(header);
+  memcpy(data, &header, *length);
+  return true;
+}
+
+
+/*
+ * There is no data.
+ */
+bool E131SyncPDU::PackData(uint8_t *, unsigned int *length) const {
+  *length = 0;
+  return true;
+}
+
+
+/*
+ * Pack the header into a buffer.
+ */
+void E131SyncPDU::PackHeader(OutputStream *stream) const {
+  sync_pdu_header header;
+  BuildHeader(&header);
+  stream->Write(reinterpret_cast<uint8_t*>(&header), sizeof(header));
+}
+
+
+void E131SyncPDU::PackData(OutputStream *) const {}
+
+
+void E131SyncPDU::BuildHeader(sync_pdu_header *header) const {
+  header->sequence = m_sequence;
+  header->sync_address = HostToNetwork(m_sync_address);
+  header->reserved = 0;
+}
+}  // namespace acn
+}  // namespace ola
@@ -48,7 +48,16 @@ class E133Header {
     }
     ~E133Header() {}
 
-    const std::string Source() const { return m_source; }
+    /*
+     * Update the header in place, this reuses the storage for the source name.
+     */
+    void Set(const char *source, uint32_t sequence, uint16_t endpoint) {
+      m_source.assign(source);
+      m_sequence = sequence;
+      m_endpoint = endpoint;
+    }
+
+    const std::string &Source() const { return m_source; }
     uint32_t Sequence() const { return m_sequence; }
     uint16_t Endpoint() const { return m_endpoint; }
 
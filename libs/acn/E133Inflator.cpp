@@ -46,13 +46,11 @@ bool E133Inflator::DecodeHeader(HeaderSet *headers,
       E133Header::e133_pdu_header raw_header;
       memcpy(&raw_header, data, sizeof(E133Header::e133_pdu_header));
       raw_header.source[E133Header::SOURCE_NAME_LEN - 1] = 0x00;
-      E133Header header(
-          raw_header.source,
-          NetworkToHost(raw_header.sequence),
-          NetworkToHost(raw_header.endpoint));
-      m_last_header = header;
+      m_last_header.Set(raw_header.source,
+                        NetworkToHost(raw_header.sequence),
+                        NetworkToHost(raw_header.endpoint));
       m_last_header_valid = true;
-      headers->SetE133Header(header);
+      headers->SetE133Header(m_last_header);
       *bytes_used = sizeof(E133Header::e133_pdu_header);
       return true;
     }
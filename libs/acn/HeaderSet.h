@@ -32,45 +32,66 @@
 namespace ola {
 namespace acn {
 
+/*
+ * The HeaderSet is the per-packet decode context. It doesn't hold copies of
+ * the headers, instead it points at the headers decoded by each inflator (or
+ * the transport), so passing a packet down the stack doesn't copy or allocate.
+ *
+ * The headers passed to the setters must outlive any use of the HeaderSet.
+ * The getters return a default constructed header for a layer that hasn't
+ * been set.
+ */
 class HeaderSet {
  public:
-    HeaderSet() {}
+    HeaderSet()
+        : m_transport_header(NULL),
+          m_root_header(NULL),
+          m_e131_header(NULL),
+          m_e133_header(NULL),
+          m_dmp_header(NULL) {
+    }
     ~HeaderSet() {}
 
     const TransportHeader &GetTransportHeader() const {
-      return m_transport_header;
+      return Get(m_transport_header);
     }
     void SetTransportHeader(const TransportHeader &header) {
-      m_transport_header = header;
+      m_transport_header = &header;
     }
 
-    const RootHeader &GetRootHeader() const { return m_root_header; }
-    void SetRootHeader(const RootHeader &header) { m_root_header = header; }
+    const RootHeader &GetRootHeader() const { return Get(m_root_header); }
+    void SetRootHeader(const RootHeader &header) { m_root_header = &header; }
 
-    const E131Header &GetE131Header() const { return m_e131_header; }
-    void SetE131Header(const E131Header &header) { m_e131_header = header; }
+    const E131Header &GetE131Header() const { return Get(m_e131_header); }
+    void SetE131Header(const E131Header &header) { m_e131_header = &header; }
 
-    const E133Header &GetE133Header() const { return m_e133_header; }
-    void SetE133Header(const E133Header &header) { m_e133_header = header; }
+    const E133Header &GetE133Header() const { return Get(m_e133_header); }
+    void SetE133Header(const E133Header &header) { m_e133_header = &header; }
 
-    const DMPHeader &GetDMPHeader() const { return m_dmp_header; }
-    void SetDMPHeader(const DMPHeader &header) { m_dmp_header = header; }
+    const DMPHeader &GetDMPHeader() const { return Get(m_dmp_header); }
+    void SetDMPHeader(const DMPHeader &header) { m_dmp_header = &header; }
 
     bool operator==(const HeaderSet &other) const {
       return (
-          m_transport_header == other.m_transport_header &&
-          m_root_header == other.m_root_header  &&
-          m_e131_header == other.m_e131_header &&
-          m_e133_header == other.m_e133_header &&
-          m_dmp_header == other.m_dmp_header);
+          GetTransportHeader() == other.GetTransportHeader() &&
+          GetRootHeader() == other.GetRootHeader() &&
+          GetE131Header() == other.GetE131Header() &&
+          GetE133Header() == other.GetE133Header() &&
+          GetDMPHeader() == other.GetDMPHeader());
     }
 
  private:
-    TransportHeader m_transport_header;
-    RootHeader m_root_header;
-    E131Header m_e131_header;
-    E133Header m_e133_header;
-    DMPHeader m_dmp_header;
+    const TransportHeader *m_transport_header;
+    const RootHeader *m_root_header;
+    const E131Header *m_e131_header;
+    const E133Header *m_e133_header;
+    const DMPHeader *m_dmp_header;
+
+    template <typename Header>
+    static const Header &Get(const Header *header) {
+      static const Header empty_header;
+      return header ? *header : empty_header;
+    }
 };
 }  // namespace acn
 }  // namespace ola
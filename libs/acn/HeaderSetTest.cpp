@@ -100,6 +100,17 @@ void HeaderSetTest::testRootHeader() {
   RootHeader header3(header);
   OLA_ASSERT(cid == header3.GetCid());
   OLA_ASSERT(header3 == header);
+
+  // test setting the CID from the raw data
+  uint8_t cid_data[CID::CID_LENGTH];
+  cid.Pack(cid_data);
+  RootHeader header4;
+  OLA_ASSERT(header4.GetCid().IsNil());
+  header4.SetCidData(cid_data);
+  OLA_ASSERT(cid == header4.GetCid());
+  OLA_ASSERT(header4 == header);
+  OLA_ASSERT_DATA_EQUALS(cid_data, sizeof(cid_data), header4.CidData(),
+                         CID::CID_LENGTH);
 }
 
 
@@ -154,6 +165,17 @@ void HeaderSetTest::testE131Header() {
   OLA_ASSERT_EQ(true, header4.PreviewData());
   OLA_ASSERT_EQ(true, header4.StreamTerminated());
   OLA_ASSERT_FALSE(header4.UsingRev2());
+
+  // test updating a header in place
+  header4.Set("bar", 3, 4, 2051, false, false, true, 7000);
+  OLA_ASSERT("bar" == header4.Source());
+  OLA_ASSERT_EQ((uint8_t) 3, header4.Priority());
+  OLA_ASSERT_EQ((uint8_t) 4, header4.Sequence());
+  OLA_ASSERT_EQ((uint16_t) 2051, header4.Universe());
+  OLA_ASSERT_EQ(false, header4.PreviewData());
+  OLA_ASSERT_EQ(false, header4.StreamTerminated());
+  OLA_ASSERT(header4.UsingRev2());
+  OLA_ASSERT_EQ((uint16_t) 7000, header4.SyncAddress());
 }
 
 
@@ -177,6 +199,12 @@ void HeaderSetTest::testE133Header() {
   OLA_ASSERT_EQ(header.Sequence(), header3.Sequence());
   OLA_ASSERT_EQ(header.Endpoint(), header3.Endpoint());
   OLA_ASSERT(header == header3);
+
+  // test updating a header in place
+  header3.Set("bar", 9841, 3);
+  OLA_ASSERT("bar" == header3.Source());
+  OLA_ASSERT_EQ((uint32_t) 9841, header3.Sequence());
+  OLA_ASSERT_EQ((uint16_t) 3, header3.Endpoint());
 }
 
 
@@ -218,6 +246,15 @@ void HeaderSetTest::testDMPHeader() {
  */
 void HeaderSetTest::testHeaderSet() {
   HeaderSet headers;
+
+  // the headers that haven't been set are default constructed
+  OLA_ASSERT(RootHeader() == headers.GetRootHeader());
+  OLA_ASSERT(E131Header() == headers.GetE131Header());
+  OLA_ASSERT(E133Header() == headers.GetE133Header());
+  OLA_ASSERT(DMPHeader() == headers.GetDMPHeader());
+  OLA_ASSERT_EQ(TransportHeader::UNDEFINED,
+                headers.GetTransportHeader().Transport());
+
   RootHeader root_header;
   E131Header e131_header("e131", 1, 2, 6001);
   E133Header e133_header("foo", 1, 2050);
@@ -256,4 +293,9 @@ void HeaderSetTest::testHeaderSet() {
   OLA_ASSERT(e133_header == headers3.GetE133Header());
   OLA_ASSERT(dmp_header == headers3.GetDMPHeader());
   OLA_ASSERT(headers3 == headers);
+
+  // the HeaderSet refers to the headers rather than copying them
+  e131_header.Set("e131", 1, 3, 6001);
+  OLA_ASSERT_EQ((uint8_t) 3, headers.GetE131Header().Sequence());
+  OLA_ASSERT(&e131_header == &headers.GetE131Header());
 }
@@ -40,8 +40,12 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/DMPInflator.h \
     libs/acn/DMPPDU.cpp \
     libs/acn/DMPPDU.h \
+    libs/acn/E131DataDecoder.cpp \
+    libs/acn/E131DataDecoder.h \
     libs/acn/E131DiscoveryInflator.cpp \
     libs/acn/E131DiscoveryInflator.h \
+    libs/acn/E131ExtendedInflator.cpp \
+    libs/acn/E131ExtendedInflator.h \
     libs/acn/E131Header.h \
     libs/acn/E131Inflator.cpp \
     libs/acn/E131Inflator.h \
@@ -51,6 +55,8 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/E131PDU.h \
     libs/acn/E131Sender.cpp \
     libs/acn/E131Sender.h \
+    libs/acn/E131SyncPDU.cpp \
+    libs/acn/E131SyncPDU.h \
     libs/acn/E133Header.h \
     libs/acn/E133Inflator.cpp \
     libs/acn/E133Inflator.h \
@@ -63,7 +69,10 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/HeaderSet.h \
     libs/acn/PDU.cpp \
     libs/acn/PDU.h \
+    libs/acn/PDUStack.h \
     libs/acn/PDUTestCommon.h \
+    libs/acn/PacketRingTransport.cpp \
+    libs/acn/PacketRingTransport.h \
     libs/acn/PreamblePacker.cpp \
     libs/acn/PreamblePacker.h \
     libs/acn/RDMInflator.cpp \
@@ -82,7 +91,9 @@ libs_acn_libolae131core_la_SOURCES = \
     libs/acn/Transport.h \
     libs/acn/TransportHeader.h \
     libs/acn/UDPTransport.cpp \
-    libs/acn/UDPTransport.h
+    libs/acn/UDPTransport.h \
+    libs/acn/UniverseDiscoveryIndex.cpp \
+    libs/acn/UniverseDiscoveryIndex.h
 
 libs_acn_libolae131core_la_CXXFLAGS = \
     $(COMMON_E131_CXXFLAGS) $(uuid_CFLAGS)
@@ -101,7 +112,8 @@ libs_acn_e131_transmit_test_SOURCES = \
 libs_acn_e131_transmit_test_LDADD = libs/acn/libolae131core.la
 
 libs_acn_e131_loadtest_SOURCES = libs/acn/e131_loadtest.cpp
-libs_acn_e131_loadtest_LDADD = libs/acn/libolae131core.la
+libs_acn_e131_loadtest_LDADD = libs/acn/libolae131core.la \
+                               common/web/libolaweb.la
 
 # TESTS
 ##################################################
@@ -114,15 +126,19 @@ libs_acn_E131Tester_SOURCES = \
     libs/acn/BaseInflatorTest.cpp \
     libs/acn/CIDTest.cpp \
     libs/acn/DMPAddressTest.cpp \
+    libs/acn/DMPE131InflatorTest.cpp \
     libs/acn/DMPInflatorTest.cpp \
     libs/acn/DMPPDUTest.cpp \
+    libs/acn/E131DataDecoderTest.cpp \
     libs/acn/E131InflatorTest.cpp \
     libs/acn/E131PDUTest.cpp \
     libs/acn/HeaderSetTest.cpp \
+    libs/acn/PDUStackTest.cpp \
     libs/acn/PDUTest.cpp \
     libs/acn/RootInflatorTest.cpp \
     libs/acn/RootPDUTest.cpp \
-    libs/acn/RootSenderTest.cpp
+    libs/acn/RootSenderTest.cpp \
+    libs/acn/UniverseDiscoveryIndexTest.cpp
 libs_acn_E131Tester_CPPFLAGS = $(COMMON_TESTING_FLAGS)
 # For some completely messed up reason on mac CPPUNIT_LIBS has to come after
 # the ossp uuid library.
@@ -141,8 +157,17 @@ libs_acn_E133Tester_LDADD = \
     $(COMMON_TESTING_LIBS)
 
 libs_acn_TransportTester_SOURCES = \
+    libs/acn/PacketRingTransportTest.cpp \
     libs/acn/TCPTransportTest.cpp \
     libs/acn/UDPTransportTest.cpp
 libs_acn_TransportTester_CPPFLAGS = $(COMMON_TESTING_FLAGS)
 libs_acn_TransportTester_LDADD = libs/acn/libolae131core.la \
                                  $(COMMON_TESTING_LIBS)
+
+# BENCHMARKS
+##################################################
+benchmark_programs += libs/acn/E131Benchmark
+
+libs_acn_E131Benchmark_SOURCES = libs/acn/E131Benchmark.cpp
+libs_acn_E131Benchmark_LDADD = libs/acn/libolae131core.la \
+                               $(COMMON_BENCHMARK_LIBS)
@@ -0,0 +1,445 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PDUStack.h
+ * Pack a fixed stack of PDUs in a single pass.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_PDUSTACK_H_
+#define LIBS_ACN_PDUSTACK_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <ola/acn/ACNVectors.h>
+#include <ola/acn/CID.h>
+#include <ola/base/Array.h>
+#include <ola/network/NetworkUtils.h>
+#include <ola/rdm/RDMPacket.h>
+#include <ola/strings/Utils.h>
+
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPHeader.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E133Header.h"
+#include "libs/acn/PDU.h"
+
+namespace ola {
+namespace acn {
+
+/**
+ * The PDU classes build the packet from a tree of objects, with virtual calls
+ * to find the size of each layer and then again to pack it. When the layers
+ * are known at compile time, a PDUStack can be used instead, e.g.
+ *
+ *   RootLayer root(VECTOR_ROOT_E131, cid);
+ *   E131Layer e131(VECTOR_E131_DATA, header);
+ *   DMPRangeSetPropertyLayer dmp(slot_data, slot_count);
+ *   PDUStack<RootLayer, E131Layer, DMPRangeSetPropertyLayer> stack(
+ *       &root, &e131, &dmp);
+ *   stack.Pack(buffer, &length);
+ *
+ * The size of every layer except the innermost one is a compile time
+ * constant, so the lengths are known up front and the packet is written in a
+ * single pass.
+ *
+ * A layer provides:
+ *  - static const unsigned int VECTOR_SIZE and HEADER_SIZE.
+ *  - uint32_t Vector() const.
+ *  - void PackHeader(uint8_t *data) const, which writes HEADER_SIZE bytes.
+ * The innermost layer also provides:
+ *  - unsigned int DataSize() const.
+ *  - void PackData(uint8_t *data) const, which writes DataSize() bytes.
+ *
+ * Only the two byte length format is used, so each PDU must be less than
+ * 4096 bytes. Use the PDU classes for anything larger.
+ */
+
+/**
+ * The placeholder for unused layers in a PDUStack.
+ */
+struct NullLayer {};
+
+
+/**
+ * The number of bytes a layer adds before the layer it contains.
+ */
+template <typename Layer>
+struct PDULayerOverhead {
+  static const unsigned int VALUE = 2 + Layer::VECTOR_SIZE + Layer::HEADER_SIZE;
+};
+
+template <>
+struct PDULayerOverhead<NullLayer> {
+  static const unsigned int VALUE = 0;
+};
+
+
+template <unsigned int VectorSize>
+inline uint8_t *PackPDUVector(uint32_t vector, uint8_t *data);
+
+template <>
+inline uint8_t *PackPDUVector<1>(uint32_t vector, uint8_t *data) {
+  data[0] = static_cast<uint8_t>(vector);
+  return data + 1;
+}
+
+template <>
+inline uint8_t *PackPDUVector<2>(uint32_t vector, uint8_t *data) {
+  data[0] = static_cast<uint8_t>(vector >> 8);
+  data[1] = static_cast<uint8_t>(vector);
+  return data + 2;
+}
+
+template <>
+inline uint8_t *PackPDUVector<4>(uint32_t vector, uint8_t *data) {
+  data[0] = static_cast<uint8_t>(vector >> 24);
+  data[1] = static_cast<uint8_t>(vector >> 16);
+  data[2] = static_cast<uint8_t>(vector >> 8);
+  data[3] = static_cast<uint8_t>(vector);
+  return data + 4;
+}
+
+
+/**
+ * Write the flags, length, vector and header for a layer.
+ * @returns a pointer to the data for this layer.
+ */
+template <typename Layer>
+inline uint8_t *PackPDULayer(const Layer &layer, unsigned int pdu_length,
+                             uint8_t *data) {
+  data[0] = static_cast<uint8_t>(
+      PDU::VFLAG_MASK | PDU::HFLAG_MASK | PDU::DFLAG_MASK |
+      ((pdu_length >> 8) & 0x0f));
+  data[1] = static_cast<uint8_t>(pdu_length);
+  data = PackPDUVector<Layer::VECTOR_SIZE>(layer.Vector(), data + 2);
+  layer.PackHeader(data);
+  return data + Layer::HEADER_SIZE;
+}
+
+
+/**
+ * A stack of up to three PDU layers, outermost first.
+ */
+template <typename L0, typename L1 = NullLayer, typename L2 = NullLayer>
+class PDUStack {
+ public:
+  /**
+   * The size of everything except the innermost layer's data.
+   */
+  static const unsigned int OVERHEAD = PDULayerOverhead<L0>::VALUE +
+                                       PDULayerOverhead<L1>::VALUE +
+                                       PDULayerOverhead<L2>::VALUE;
+
+  /**
+   * Ownership of the layers is not transferred.
+   */
+  PDUStack(const L0 *l0, const L1 *l1, const L2 *l2)
+      : m_l0(l0), m_l1(l1), m_l2(l2) {
+  }
+
+  unsigned int Size() const { return OVERHEAD + m_l2->DataSize(); }
+
+  /**
+   * Pack the PDUs into the buffer.
+   * @param data the buffer to pack into.
+   * @param length the size of the buffer, updated with the bytes used.
+   * @returns false if the buffer was too small, or the PDU too large.
+   */
+  bool Pack(uint8_t *data, unsigned int *length) const {
+    const unsigned int size = Size();
+    if (*length < size || size > MAX_PDU_LENGTH) {
+      *length = 0;
+      return false;
+    }
+    data = PackPDULayer(*m_l0, size, data);
+    unsigned int remaining = size - PDULayerOverhead<L0>::VALUE;
+    data = PackPDULayer(*m_l1, remaining, data);
+    remaining -= PDULayerOverhead<L1>::VALUE;
+    data = PackPDULayer(*m_l2, remaining, data);
+    m_l2->PackData(data);
+    *length = size;
+    return true;
+  }
+
+ private:
+  const L0 *m_l0;
+  const L1 *m_l1;
+  const L2 *m_l2;
+
+  static const unsigned int MAX_PDU_LENGTH = 0x0fff;
+};
+
+
+/**
+ * A stack of two PDU layers.
+ */
+template <typename L0, typename L1>
+class PDUStack<L0, L1, NullLayer> {
+ public:
+  static const unsigned int OVERHEAD = PDULayerOverhead<L0>::VALUE +
+                                       PDULayerOverhead<L1>::VALUE;
+
+  PDUStack(const L0 *l0, const L1 *l1) : m_l0(l0), m_l1(l1) {}
+
+  unsigned int Size() const { return OVERHEAD + m_l1->DataSize(); }
+
+  bool Pack(uint8_t *data, unsigned int *length) const {
+    const unsigned int size = Size();
+    if (*length < size || size > MAX_PDU_LENGTH) {
+      *length = 0;
+      return false;
+    }
+    data = PackPDULayer(*m_l0, size, data);
+    data = PackPDULayer(*m_l1, size - PDULayerOverhead<L0>::VALUE, data);
+    m_l1->PackData(data);
+    *length = size;
+    return true;
+  }
+
+ private:
+  const L0 *m_l0;
+  const L1 *m_l1;
+
+  static const unsigned int MAX_PDU_LENGTH = 0x0fff;
+};
+
+
+/**
+ * A single PDU layer.
+ */
+template <typename L0>
+class PDUStack<L0, NullLayer, NullLayer> {
+ public:
+  static const unsigned int OVERHEAD = PDULayerOverhead<L0>::VALUE;
+
+  explicit PDUStack(const L0 *l0) : m_l0(l0) {}
+
+  unsigned int Size() const { return OVERHEAD + m_l0->DataSize(); }
+
+  bool Pack(uint8_t *data, unsigned int *length) const {
+    const unsigned int size = Size();
+    if (*length < size || size > MAX_PDU_LENGTH) {
+      *length = 0;
+      return false;
+    }
+    data = PackPDULayer(*m_l0, size, data);
+    m_l0->PackData(data);
+    *length = size;
+    return true;
+  }
+
+ private:
+  const L0 *m_l0;
+
+  static const unsigned int MAX_PDU_LENGTH = 0x0fff;
+};
+
+
+/**
+ * The Root layer.
+ */
+class RootLayer {
+ public:
+  static const unsigned int VECTOR_SIZE = 4;
+  static const unsigned int HEADER_SIZE = CID::CID_LENGTH;
+
+  RootLayer(uint32_t vector, const CID &cid) : m_vector(vector), m_cid(cid) {}
+
+  uint32_t Vector() const { return m_vector; }
+  void PackHeader(uint8_t *data) const { m_cid.Pack(data); }
+
+ private:
+  uint32_t m_vector;
+  const CID &m_cid;
+};
+
+
+/**
+ * The E1.31 framing layer.
+ */
+class E131Layer {
+ public:
+  static const unsigned int VECTOR_SIZE = 4;
+  static const unsigned int HEADER_SIZE = sizeof(E131Header::e131_pdu_header);
+
+  E131Layer(uint32_t vector, const E131Header &header)
+      : m_vector(vector), m_header(header) {
+  }
+
+  uint32_t Vector() const { return m_vector; }
+
+  void PackHeader(uint8_t *data) const {
+    E131Header::e131_pdu_header header;
+    strings::CopyToFixedLengthBuffer(m_header.Source(), header.source,
+                                     arraysize(header.source));
+    header.priority = m_header.Priority();
+    header.sync_address = ola::network::HostToNetwork(m_header.SyncAddress());
+    header.sequence = m_header.Sequence();
+    header.options = static_cast<uint8_t>(
+        (m_header.PreviewData() ? E131Header::PREVIEW_DATA_MASK : 0) |
+        (m_header.StreamTerminated() ? E131Header::STREAM_TERMINATED_MASK : 0));
+    header.universe = ola::network::HostToNetwork(m_header.Universe());
+    memcpy(data, &header, sizeof(header));
+  }
+
+ private:
+  uint32_t m_vector;
+  const E131Header &m_header;
+};
+
+
+/**
+ * The framing layer for the draft (revision 2) E1.31 standard.
+ */
+class E131Rev2Layer {
+ public:
+  static const unsigned int VECTOR_SIZE = 4;
+  static const unsigned int HEADER_SIZE =
+      sizeof(E131Rev2Header::e131_rev2_pdu_header);
+
+  E131Rev2Layer(uint32_t vector, const E131Header &header)
+      : m_vector(vector), m_header(header) {
+  }
+
+  uint32_t Vector() const { return m_vector; }
+
+  void PackHeader(uint8_t *data) const {
+    E131Rev2Header::e131_rev2_pdu_header header;
+    strings::CopyToFixedLengthBuffer(m_header.Source(), header.source,
+                                     arraysize(header.source));
+    header.priority = m_header.Priority();
+    header.sequence = m_header.Sequence();
+    header.universe = ola::network::HostToNetwork(m_header.Universe());
+    memcpy(data, &header, sizeof(header));
+  }
+
+ private:
+  uint32_t m_vector;
+  const E131Header &m_header;
+};
+
+
+/**
+ * A DMP Set Property message with a single two byte range address, this is
+ * what E1.31 uses for DMX data.
+ */
+class DMPRangeSetPropertyLayer {
+ public:
+  static const unsigned int VECTOR_SIZE = 1;
+  static const unsigned int HEADER_SIZE = DMPHeader::DMP_HEADER_SIZE;
+
+  /**
+   * @param data the property values, ownership is not transferred.
+   * @param length the number of property values.
+   * @param start the first address.
+   * @param increment the address increment.
+   */
+  DMPRangeSetPropertyLayer(const uint8_t *data, uint16_t length,
+                           uint16_t start = 0, uint16_t increment = 1)
+      : m_data(data),
+        m_length(length),
+        m_start(start),
+        m_increment(increment) {
+  }
+
+  uint32_t Vector() const { return ola::acn::DMP_SET_PROPERTY_VECTOR; }
+
+  void PackHeader(uint8_t *data) const {
+    *data = DMPHeader(true, false, RANGE_EQUAL, TWO_BYTES).Header();
+  }
+
+  unsigned int DataSize() const { return ADDRESS_SIZE + m_length; }
+
+  void PackData(uint8_t *data) const {
+    const uint16_t address[] = {
+      ola::network::HostToNetwork(m_start),
+      ola::network::HostToNetwork(m_increment),
+      ola::network::HostToNetwork(m_length),
+    };
+    memcpy(data, address, ADDRESS_SIZE);
+    memcpy(data + ADDRESS_SIZE, m_data, m_length);
+  }
+
+ private:
+  const uint8_t *m_data;
+  uint16_t m_length;
+  uint16_t m_start;
+  uint16_t m_increment;
+
+  static const unsigned int ADDRESS_SIZE = 6;
+};
+
+
+/**
+ * The E1.33 framing layer.
+ */
+class E133Layer {
+ public:
+  static const unsigned int VECTOR_SIZE = 4;
+  static const unsigned int HEADER_SIZE = sizeof(E133Header::e133_pdu_header);
+
+  E133Layer(uint32_t vector, const E133Header &header)
+      : m_vector(vector), m_header(header) {
+  }
+
+  uint32_t Vector() const { return m_vector; }
+
+  void PackHeader(uint8_t *data) const {
+    E133Header::e133_pdu_header header;
+    strings::CopyToFixedLengthBuffer(m_header.Source(), header.source,
+                                     arraysize(header.source));
+    header.sequence = ola::network::HostToNetwork(m_header.Sequence());
+    header.endpoint = ola::network::HostToNetwork(m_header.Endpoint());
+    header.reserved = 0;
+    memcpy(data, &header, sizeof(header));
+  }
+
+ private:
+  uint32_t m_vector;
+  const E133Header &m_header;
+};
+
+
+/**
+ * The RDM layer, which carries a raw RDM message.
+ */
+class RDMLayer {
+ public:
+  static const unsigned int VECTOR_SIZE = 1;
+  static const unsigned int HEADER_SIZE = 0;
+
+  /**
+   * @param data the RDM message, without the start code. Ownership is not
+   *   transferred.
+   * @param length the length of the message.
+   */
+  RDMLayer(const uint8_t *data, unsigned int length)
+      : m_data(data), m_length(length) {
+  }
+
+  uint32_t Vector() const { return ola::rdm::START_CODE; }
+  void PackHeader(uint8_t*) const {}
+
+  unsigned int DataSize() const { return m_length; }
+  void PackData(uint8_t *data) const { memcpy(data, m_data, m_length); }
+
+ private:
+  const uint8_t *m_data;
+  unsigned int m_length;
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_PDUSTACK_H_
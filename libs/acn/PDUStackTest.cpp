@@ -0,0 +1,200 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PDUStackTest.cpp
+ * Test fixture for the PDUStack class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <vector>
+
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/IOStack.h"
+#include "ola/testing/TestUtils.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131PDU.h"
+#include "libs/acn/E133PDU.h"
+#include "libs/acn/PDUStack.h"
+#include "libs/acn/RDMPDU.h"
+#include "libs/acn/RootPDU.h"
+
+namespace ola {
+namespace acn {
+
+using ola::io::IOQueue;
+using ola::io::IOStack;
+using std::vector;
+
+class PDUStackTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PDUStackTest);
+  CPPUNIT_TEST(testE131);
+  CPPUNIT_TEST(testE131Rev2);
+  CPPUNIT_TEST(testE133);
+  CPPUNIT_TEST(testSmallBuffer);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testE131();
+  void testE131Rev2();
+  void testE133();
+  void testSmallBuffer();
+
+ private:
+  void PackE131(const CID &cid, const E131Header &header,
+                const uint8_t *slots, uint16_t slot_count,
+                vector<uint8_t> *packet);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PDUStackTest);
+
+/*
+ * Pack an E1.31 data packet with the PDU classes.
+ */
+void PDUStackTest::PackE131(const CID &cid, const E131Header &header,
+                            const uint8_t *slots, uint16_t slot_count,
+                            vector<uint8_t> *packet) {
+  TwoByteRangeDMPAddress range_addr(0, 1, slot_count);
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(&range_addr, slots,
+                                                     slot_count);
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *dmp_pdu = NewRangeDMPSetProperty<uint16_t>(true, false,
+                                                           ranged_chunks);
+  E131PDU e131_pdu(VECTOR_E131_DATA, header, dmp_pdu);
+  PDUBlock<PDU> block;
+  block.AddPDU(&e131_pdu);
+  RootPDU root_pdu(VECTOR_ROOT_E131, cid, &block);
+
+  unsigned int length = root_pdu.Size();
+  packet->resize(length);
+  OLA_ASSERT_TRUE(root_pdu.Pack(&(*packet)[0], &length));
+  packet->resize(length);
+  delete dmp_pdu;
+}
+
+/*
+ * Check an E1.31 data packet matches the one built by the PDU classes.
+ */
+void PDUStackTest::testE131() {
+  const CID cid = CID::Generate();
+  uint8_t slots[513];
+  for (unsigned int i = 0; i < sizeof(slots); i++) {
+    slots[i] = static_cast<uint8_t>(i);
+  }
+  E131Header header("foo source", 150, 42, 7, true, false, false, 3);
+
+  vector<uint8_t> expected;
+  PackE131(cid, header, slots, sizeof(slots), &expected);
+
+  RootLayer root(VECTOR_ROOT_E131, cid);
+  E131Layer e131(VECTOR_E131_DATA, header);
+  DMPRangeSetPropertyLayer dmp(slots, sizeof(slots));
+  PDUStack<RootLayer, E131Layer, DMPRangeSetPropertyLayer> stack(
+      &root, &e131, &dmp);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(expected.size()), stack.Size());
+
+  uint8_t buffer[1000];
+  unsigned int length = sizeof(buffer);
+  OLA_ASSERT_TRUE(stack.Pack(buffer, &length));
+  OLA_ASSERT_DATA_EQUALS(&expected[0], expected.size(), buffer, length);
+}
+
+/*
+ * Check the draft E1.31 header.
+ */
+void PDUStackTest::testE131Rev2() {
+  const CID cid = CID::Generate();
+  uint8_t slots[] = {0, 1, 2, 3, 4, 5};
+  E131Header header("foo source", 100, 3, 1, false, false, true);
+
+  vector<uint8_t> expected;
+  PackE131(cid, header, slots, sizeof(slots), &expected);
+
+  RootLayer root(VECTOR_ROOT_E131, cid);
+  E131Rev2Layer e131(VECTOR_E131_DATA, header);
+  DMPRangeSetPropertyLayer dmp(slots, sizeof(slots));
+  PDUStack<RootLayer, E131Rev2Layer, DMPRangeSetPropertyLayer> stack(
+      &root, &e131, &dmp);
+
+  uint8_t buffer[100];
+  unsigned int length = sizeof(buffer);
+  OLA_ASSERT_TRUE(stack.Pack(buffer, &length));
+  OLA_ASSERT_DATA_EQUALS(&expected[0], expected.size(), buffer, length);
+}
+
+/*
+ * Check an E1.33 RDM packet matches the one built with an IOStack.
+ */
+void PDUStackTest::testE133() {
+  const CID cid = CID::Generate();
+  const uint8_t rdm_data[] = {1, 24, 0x7a, 0x70, 0, 0, 0, 0};
+  E133Header header("foo source", 101, 2);
+
+  IOStack io_stack;
+  io_stack.Write(rdm_data, sizeof(rdm_data));
+  RDMPDU::PrependPDU(&io_stack);
+  E133PDU::PrependPDU(&io_stack, VECTOR_FRAMING_RDMNET, header.Source(),
+                      header.Sequence(), header.Endpoint());
+  RootPDU::PrependPDU(&io_stack, VECTOR_ROOT_E133, cid);
+  IOQueue queue;
+  io_stack.MoveToIOQueue(&queue);
+  uint8_t expected[200];
+  const unsigned int expected_length = queue.Read(expected, sizeof(expected));
+
+  RootLayer root(VECTOR_ROOT_E133, cid);
+  E133Layer e133(VECTOR_FRAMING_RDMNET, header);
+  RDMLayer rdm(rdm_data, sizeof(rdm_data));
+  PDUStack<RootLayer, E133Layer, RDMLayer> stack(&root, &e133, &rdm);
+
+  uint8_t buffer[200];
+  unsigned int length = sizeof(buffer);
+  OLA_ASSERT_TRUE(stack.Pack(buffer, &length));
+  OLA_ASSERT_DATA_EQUALS(expected, expected_length, buffer, length);
+
+  // A shorter stack.
+  PDUStack<E133Layer, RDMLayer> inner_stack(&e133, &rdm);
+  length = sizeof(buffer);
+  OLA_ASSERT_TRUE(inner_stack.Pack(buffer, &length));
+  OLA_ASSERT_EQ(stack.Size() - PDULayerOverhead<RootLayer>::VALUE, length);
+  OLA_ASSERT_DATA_EQUALS(expected + PDULayerOverhead<RootLayer>::VALUE,
+                         length, buffer, length);
+}
+
+/*
+ * Check we don't overrun the buffer.
+ */
+void PDUStackTest::testSmallBuffer() {
+  const uint8_t rdm_data[] = {1, 2, 3, 4};
+  RDMLayer rdm(rdm_data, sizeof(rdm_data));
+  PDUStack<RDMLayer> stack(&rdm);
+  OLA_ASSERT_EQ(7u, stack.Size());
+
+  uint8_t buffer[7];
+  unsigned int length = sizeof(buffer) - 1;
+  OLA_ASSERT_FALSE(stack.Pack(buffer, &length));
+  OLA_ASSERT_EQ(0u, length);
+
+  length = sizeof(buffer);
+  OLA_ASSERT_TRUE(stack.Pack(buffer, &length));
+  const uint8_t expected[] = {0x70, 7, 0xcc, 1, 2, 3, 4};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), buffer, length);
+}
+}  // namespace acn
+}  // namespace ola
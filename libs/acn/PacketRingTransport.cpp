@@ -0,0 +1,287 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PacketRingTransport.cpp
+ * Receives UDP datagrams from a memory mapped packet ring.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <string.h>
+
+#if defined(HAVE_LINUX_IF_PACKET_H) && defined(HAVE_SYS_MMAN_H)
+#define HAVE_PACKET_RING
+#include <errno.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // defined(HAVE_LINUX_IF_PACKET_H) && defined(HAVE_SYS_MMAN_H)
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/NetworkUtils.h"
+#include "ola/network/SocketAddress.h"
+#include "libs/acn/PacketRingTransport.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
+
+namespace {
+const unsigned int IPV4_MIN_HEADER_SIZE = 20;
+const unsigned int UDP_HEADER_SIZE = 8;
+const uint8_t UDP_PROTOCOL = 17;
+// The more fragments flag and the fragment offset.
+const uint16_t FRAGMENT_MASK = 0x3fff;
+
+uint16_t ReadUInt16(const uint8_t *data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+}  // namespace
+
+// 1MB blocks of 2k frames, 32k frames in total. That's about 12ms of a full
+// 63999 universe network at 44Hz.
+const unsigned int PacketRingTransport::BLOCK_SIZE = 1 << 20;
+const unsigned int PacketRingTransport::BLOCK_COUNT = 64;
+const unsigned int PacketRingTransport::FRAME_SIZE = 1 << 11;
+const unsigned int PacketRingTransport::MAX_FRAMES_PER_RECEIVE = 256;
+
+PacketRingTransport::PacketRingTransport(IncomingUDPTransport *transport,
+                                         uint16_t port)
+    : m_transport(transport),
+      m_port(port),
+      m_ring(NULL),
+      m_next_frame(0) {
+}
+
+PacketRingTransport::~PacketRingTransport() {
+  Close();
+}
+
+#ifdef HAVE_PACKET_RING
+
+bool PacketRingTransport::Init(int32_t interface_index) {
+  if (m_descriptor.get()) {
+    return true;
+  }
+
+  // Open with no protocol so nothing is received until the filter is in place.
+  int fd = socket(AF_PACKET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    OLA_WARN << "Failed to open packet socket: " << strerror(errno);
+    return false;
+  }
+  m_descriptor.reset(new ola::io::UnmanagedFileDescriptor(fd));
+
+  // Accept unfragmented IPv4 UDP datagrams for m_port. SOCK_DGRAM removes the
+  // link layer header, so the packet starts at the IP header.
+  struct sock_filter filter[] = {
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+    BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xf0),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x40, 0, 8),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 9),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UDP_PROTOCOL, 0, 6),
+    BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 6),
+    BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, FRAGMENT_MASK, 4, 0),
+    BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0),
+    BPF_STMT(BPF_LD | BPF_H | BPF_IND, 2),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, m_port, 0, 1),
+    BPF_STMT(BPF_RET | BPF_K, 0xffffffff),
+    BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  struct sock_fprog program;
+  program.len = arraysize(filter);
+  program.filter = filter;
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program,
+                 sizeof(program))) {
+    OLA_WARN << "Failed to attach packet filter: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  int version = TPACKET_V2;
+  if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))) {
+    OLA_WARN << "Failed to set TPACKET_V2: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  struct tpacket_req request;
+  request.tp_block_size = BLOCK_SIZE;
+  request.tp_block_nr = BLOCK_COUNT;
+  request.tp_frame_size = FRAME_SIZE;
+  request.tp_frame_nr = BLOCK_SIZE / FRAME_SIZE * BLOCK_COUNT;
+  if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request))) {
+    OLA_WARN << "Failed to set up the packet ring: " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  void *ring = mmap(NULL, BLOCK_SIZE * BLOCK_COUNT, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  if (ring == MAP_FAILED) {
+    OLA_WARN << "Failed to map the packet ring: " << strerror(errno);
+    Close();
+    return false;
+  }
+  m_ring = static_cast<uint8_t*>(ring);
+  m_next_frame = 0;
+
+  struct sockaddr_ll address;
+  memset(&address, 0, sizeof(address));
+  address.sll_family = AF_PACKET;
+  address.sll_protocol = ola::network::HostToNetwork(
+      static_cast<uint16_t>(ETH_P_IP));
+  address.sll_ifindex = interface_index;
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address))) {
+    OLA_WARN << "Failed to bind packet socket to interface "
+             << interface_index << ": " << strerror(errno);
+    Close();
+    return false;
+  }
+
+  m_descriptor->SetOnData(NewCallback(this, &PacketRingTransport::Receive));
+  OLA_INFO << "Receiving UDP port " << m_port << " from a "
+           << request.tp_frame_nr << " frame packet ring";
+  return true;
+}
+
+void PacketRingTransport::Receive() {
+  const unsigned int frame_count = BLOCK_SIZE / FRAME_SIZE * BLOCK_COUNT;
+  UDPDatagram datagram;
+
+  for (unsigned int i = 0; i < MAX_FRAMES_PER_RECEIVE; i++) {
+    struct tpacket2_hdr *header = reinterpret_cast<struct tpacket2_hdr*>(
+        m_ring + m_next_frame * FRAME_SIZE);
+    if (!(__atomic_load_n(&header->tp_status, __ATOMIC_ACQUIRE) &
+          TP_STATUS_USER)) {
+      return;
+    }
+
+    const struct sockaddr_ll *address =
+        reinterpret_cast<const struct sockaddr_ll*>(
+            reinterpret_cast<uint8_t*>(header) +
+            TPACKET_ALIGN(sizeof(struct tpacket2_hdr)));
+    // Skip the datagrams we sent, those for other hosts and any that were
+    // truncated.
+    if (address->sll_pkttype != PACKET_OUTGOING &&
+        address->sll_pkttype != PACKET_OTHERHOST &&
+        header->tp_snaplen == header->tp_len &&
+        ExtractDatagram(reinterpret_cast<uint8_t*>(header) + header->tp_net,
+                        header->tp_snaplen, m_port, &datagram)) {
+      struct timeval tv;
+      tv.tv_sec = header->tp_sec;
+      tv.tv_usec = header->tp_nsec / 1000;
+      datagram.timestamp = tv;
+      m_transport->HandleDatagram(datagram);
+    }
+
+    __atomic_store_n(&header->tp_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    m_next_frame = (m_next_frame + 1) % frame_count;
+  }
+}
+
+bool PacketRingTransport::DiscardInput(ola::network::UDPSocket *socket) {
+  struct sock_filter filter[] = {
+    BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  struct sock_fprog program;
+  program.len = arraysize(filter);
+  program.filter = filter;
+  int fd = ola::io::ToFD(socket->ReadDescriptor());
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program,
+                 sizeof(program))) {
+    OLA_WARN << "Failed to attach discard filter: " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+void PacketRingTransport::Close() {
+  if (m_ring) {
+    munmap(m_ring, BLOCK_SIZE * BLOCK_COUNT);
+    m_ring = NULL;
+  }
+  if (m_descriptor.get()) {
+    close(ola::io::ToFD(m_descriptor->ReadDescriptor()));
+    m_descriptor.reset();
+  }
+}
+
+#else
+
+bool PacketRingTransport::Init(int32_t) {
+  OLA_WARN << "Packet rings aren't supported on this platform";
+  return false;
+}
+
+void PacketRingTransport::Receive() {}
+
+bool PacketRingTransport::DiscardInput(ola::network::UDPSocket*) {
+  return false;
+}
+
+void PacketRingTransport::Close() {}
+
+#endif  // HAVE_PACKET_RING
+
+bool PacketRingTransport::ExtractDatagram(uint8_t *packet,
+                                          unsigned int length,
+                                          uint16_t port,
+                                          UDPDatagram *datagram) {
+  if (length < IPV4_MIN_HEADER_SIZE || (packet[0] >> 4) != 4) {
+    return false;
+  }
+
+  const unsigned int header_size = (packet[0] & 0x0f) * 4u;
+  const unsigned int total_length = ReadUInt16(packet + 2);
+  if (header_size < IPV4_MIN_HEADER_SIZE ||
+      total_length > length ||
+      total_length < header_size + UDP_HEADER_SIZE ||
+      packet[9] != UDP_PROTOCOL ||
+      (ReadUInt16(packet + 6) & FRAGMENT_MASK)) {
+    return false;
+  }
+
+  const uint8_t *udp = packet + header_size;
+  const unsigned int udp_length = ReadUInt16(udp + 4);
+  if (ReadUInt16(udp + 2) != port ||
+      udp_length < UDP_HEADER_SIZE ||
+      udp_length > total_length - header_size) {
+    return false;
+  }
+
+  uint32_t source;
+  memcpy(&source, packet + 12, sizeof(source));
+  datagram->address = IPV4SocketAddress(IPV4Address(source), ReadUInt16(udp));
+  datagram->data = packet + header_size + UDP_HEADER_SIZE;
+  datagram->length = udp_length - UDP_HEADER_SIZE;
+  return true;
+}
+}  // namespace acn
+}  // namespace ola
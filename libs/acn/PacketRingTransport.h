@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PacketRingTransport.h
+ * Receives UDP datagrams from a memory mapped packet ring.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_PACKETRINGTRANSPORT_H_
+#define LIBS_ACN_PACKETRINGTRANSPORT_H_
+
+#include <stdint.h>
+#include <memory>
+
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/network/Socket.h"
+#include "libs/acn/UDPTransport.h"
+
+namespace ola {
+namespace acn {
+
+/*
+ * Receives the datagrams for a UDP port straight from a PACKET_MMAP ring on
+ * an interface, rather than through UDP sockets.
+ *
+ * A BPF filter on the packet socket only lets unfragmented IPv4 datagrams to
+ * the port through, and the kernel copies those into a ring shared with
+ * userspace. The datagrams are decoded in place, so there's no recv call per
+ * datagram and no copy out of the kernel.
+ *
+ * The UDP sockets on the port are still needed for sending, and to join the
+ * multicast groups, but their input should be dropped with DiscardInput()
+ * otherwise each datagram is handled twice.
+ *
+ * This needs Linux and CAP_NET_RAW. Init() returns false if either is
+ * missing, and the sockets should be used instead. Datagrams sent over the
+ * loopback interface aren't seen.
+ */
+class PacketRingTransport {
+ public:
+  /*
+   * @param transport the IncomingUDPTransport to pass datagrams to,
+   *   ownership is not transferred.
+   * @param port the UDP port to receive.
+   */
+  PacketRingTransport(IncomingUDPTransport *transport, uint16_t port);
+  ~PacketRingTransport();
+
+  /*
+   * Open the packet socket and map the ring.
+   * @param interface_index the index of the interface to receive on.
+   * @returns true if the ring is ready, false otherwise.
+   */
+  bool Init(int32_t interface_index);
+
+  /*
+   * The descriptor to add to the SelectServer, or NULL if Init() hasn't
+   * succeeded.
+   */
+  ola::io::ReadFileDescriptor *GetDescriptor() { return m_descriptor.get(); }
+
+  /*
+   * Called when the ring has frames, this handles up to MAX_FRAMES_PER_RECEIVE
+   * of them.
+   */
+  void Receive();
+
+  /*
+   * Drop everything a UDP socket receives, before it's queued.
+   * @returns true if the filter was attached, false otherwise.
+   */
+  static bool DiscardInput(ola::network::UDPSocket *socket);
+
+  /*
+   * Find the UDP payload in an IPv4 packet.
+   * @param packet the packet, starting at the IP header.
+   * @param length the length of the packet.
+   * @param port the destination port the datagram must be for.
+   * @param[out] datagram set to the payload and the source address.
+   * @returns true if this was a valid datagram for the port, false otherwise.
+   */
+  static bool ExtractDatagram(uint8_t *packet, unsigned int length,
+                              uint16_t port,
+                              ola::network::UDPDatagram *datagram);
+
+ private:
+  IncomingUDPTransport *m_transport;
+  const uint16_t m_port;
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_descriptor;
+  uint8_t *m_ring;
+  unsigned int m_next_frame;
+
+  void Close();
+
+  static const unsigned int BLOCK_SIZE;
+  static const unsigned int BLOCK_COUNT;
+  static const unsigned int FRAME_SIZE;
+  static const unsigned int MAX_FRAMES_PER_RECEIVE;
+
+  DISALLOW_COPY_AND_ASSIGN(PacketRingTransport);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_PACKETRINGTRANSPORT_H_
@@ -0,0 +1,134 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PacketRingTransportTest.cpp
+ * Test fixture for the PacketRingTransport class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+#include "ola/Logging.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/testing/TestUtils.h"
+#include "libs/acn/PacketRingTransport.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
+
+class PacketRingTransportTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PacketRingTransportTest);
+  CPPUNIT_TEST(testExtractDatagram);
+  CPPUNIT_TEST(testInvalidPackets);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testExtractDatagram();
+    void testInvalidPackets();
+
+ private:
+    // An IPv4 header with options, a UDP header and 4 bytes of data.
+    uint8_t m_packet[24 + 8 + 4];
+
+    static const uint16_t PORT = 5568;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PacketRingTransportTest);
+
+void PacketRingTransportTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_DEBUG, ola::OLA_LOG_STDERR);
+  const uint8_t packet[] = {
+    0x46, 0, 0, 36,  // version, header length, total length
+    0x12, 0x34, 0x40, 0,  // id, don't fragment
+    1, 17, 0, 0,  // ttl, protocol, checksum
+    10, 0, 0, 1,  // source
+    239, 255, 0, 1,  // destination
+    0, 0, 0, 0,  // options
+    0x3a, 0x98, 0x15, 0xc0,  // source port 15000, destination port 5568
+    0, 12, 0, 0,  // length, checksum
+    'A', 'S', 'C', '-',
+  };
+  memcpy(m_packet, packet, sizeof(m_packet));
+}
+
+
+/*
+ * Check the payload and source are found.
+ */
+void PacketRingTransportTest::testExtractDatagram() {
+  UDPDatagram datagram;
+  OLA_ASSERT_TRUE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet), PORT, &datagram));
+  OLA_ASSERT_EQ(m_packet + 32, datagram.data);
+  OLA_ASSERT_EQ(static_cast<ssize_t>(4), datagram.length);
+  OLA_ASSERT_EQ(
+      IPV4SocketAddress(IPV4Address::FromStringOrDie("10.0.0.1"), 15000),
+      datagram.address);
+
+  // Trailing link layer padding is ignored.
+  uint8_t padded[sizeof(m_packet) + 10];
+  memset(padded, 0, sizeof(padded));
+  memcpy(padded, m_packet, sizeof(m_packet));
+  OLA_ASSERT_TRUE(PacketRingTransport::ExtractDatagram(
+      padded, sizeof(padded), PORT, &datagram));
+  OLA_ASSERT_EQ(static_cast<ssize_t>(4), datagram.length);
+}
+
+
+/*
+ * Check anything that isn't a complete datagram for the port is rejected.
+ */
+void PacketRingTransportTest::testInvalidPackets() {
+  UDPDatagram datagram;
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet), 6454, &datagram));
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet) - 1, PORT, &datagram));
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, 16, PORT, &datagram));
+
+  // IPv6
+  m_packet[0] = 0x66;
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet), PORT, &datagram));
+  setUp();
+
+  // TCP
+  m_packet[9] = 6;
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet), PORT, &datagram));
+  setUp();
+
+  // The first fragment.
+  m_packet[6] = 0x20;
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet), PORT, &datagram));
+  setUp();
+
+  // A UDP length past the end of the IP packet.
+  m_packet[29] = 13;
+  OLA_ASSERT_FALSE(PacketRingTransport::ExtractDatagram(
+      m_packet, sizeof(m_packet), PORT, &datagram));
+}
+}  // namespace acn
+}  // namespace ola
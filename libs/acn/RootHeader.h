@@ -21,26 +21,43 @@
 #ifndef LIBS_ACN_ROOTHEADER_H_
 #define LIBS_ACN_ROOTHEADER_H_
 
+#include <stdint.h>
+#include <string.h>
 #include "ola/acn/CID.h"
 
 namespace ola {
 namespace acn {
 
 /*
- * The header for the root layer
+ * The header for the root layer.
+ *
+ * The CID is stored as the raw bytes from the PDU, so decoding a header
+ * doesn't allocate. Use GetCid() if a CID object is needed.
  */
 class RootHeader {
  public:
-    RootHeader() {}
+    RootHeader() { memset(m_cid, 0, sizeof(m_cid)); }
     ~RootHeader() {}
-    void SetCid(ola::acn::CID cid) { m_cid = cid; }
-    ola::acn::CID GetCid() const { return m_cid; }
+    void SetCid(const ola::acn::CID &cid) { cid.Pack(m_cid); }
+    ola::acn::CID GetCid() const { return ola::acn::CID::FromData(m_cid); }
+
+    /*
+     * Set the CID from CID::CID_LENGTH bytes of PDU data.
+     */
+    void SetCidData(const uint8_t *data) {
+      memcpy(m_cid, data, sizeof(m_cid));
+    }
+
+    /*
+     * The CID_LENGTH bytes of the CID, in network byte order.
+     */
+    const uint8_t *CidData() const { return m_cid; }
 
     bool operator==(const RootHeader &other) const {
-      return m_cid == other.m_cid;
+      return memcmp(m_cid, other.m_cid, sizeof(m_cid)) == 0;
     }
  private:
-    ola::acn::CID m_cid;
+    uint8_t m_cid[CID::CID_LENGTH];
 };
 }  // namespace acn
 }  // namespace ola
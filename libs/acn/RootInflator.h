@@ -54,6 +54,7 @@ class RootInflator: public BaseInflator {
    */
   explicit RootInflator(OnDataCallback *on_data = NULL)
     : BaseInflator(),
+      m_last_hdr_valid(false),
       m_on_data(on_data) {
     AddInflator(&m_null_inflator);
   }
@@ -71,6 +72,7 @@ class RootInflator: public BaseInflator {
  private :
   NullInflator m_null_inflator;
   RootHeader m_last_hdr;
+  bool m_last_hdr_valid;
   std::auto_ptr<OnDataCallback> m_on_data;
 };
 }  // namespace acn
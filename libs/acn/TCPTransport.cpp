@@ -18,6 +18,7 @@
  * Copyright (C) 2012 Simon Newton
  */
 
+#include <string.h>
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
 #include <ola/network/SocketAddress.h>
@@ -50,14 +51,18 @@ const unsigned int IncomingStreamTransport::INITIAL_SIZE = 500;
  * @param inflator the inflator to call for each PDU
  * @param descriptor the descriptor to read from
  * @param source the IP and port to use in the transport header
+ * @param buffer_pool the pool to take receive buffers from, may be NULL.
  */
 IncomingStreamTransport::IncomingStreamTransport(
     BaseInflator *inflator,
     ola::io::ConnectedDescriptor *descriptor,
-    const ola::network::IPV4SocketAddress &source)
+    const ola::network::IPV4SocketAddress &source,
+    ola::io::MemoryBlockPool *buffer_pool)
     : m_transport_header(source, TransportHeader::TCP),
       m_inflator(inflator),
       m_descriptor(descriptor),
+      m_buffer_pool(buffer_pool),
+      m_block(NULL),
       m_buffer_start(NULL),
       m_buffer_end(NULL),
       m_data_end(NULL),
@@ -74,8 +79,7 @@ IncomingStreamTransport::IncomingStreamTransport(
  * Clean up
  */
 IncomingStreamTransport::~IncomingStreamTransport() {
-  if (m_buffer_start)
-    delete[] m_buffer_start;
+  FreeBuffer();
 }
 
 
@@ -93,8 +97,15 @@ bool IncomingStreamTransport::Receive() {
     OLA_DEBUG << "done read, bytes outstanding is " << m_outstanding_data;
 
     // if we still don't have enough, return
-    if (m_stream_valid == false || m_outstanding_data)
+    if (m_stream_valid == false || m_outstanding_data) {
+      if (m_buffer_pool && m_state == WAITING_FOR_PREAMBLE &&
+          DataLength() == 0) {
+        // Nothing is buffered between blocks, so the buffer can go back to
+        // the pool until more data arrives.
+        FreeBuffer();
+      }
       return m_stream_valid;
+    }
 
     OLA_DEBUG << "state is " << m_state;
 
@@ -246,27 +257,51 @@ void IncomingStreamTransport::IncreaseBufferSize(unsigned int new_size) {
   if (new_size <= BufferSize())
     return;
 
-  new_size = std::max(new_size, INITIAL_SIZE);
-
   unsigned int data_length = DataLength();
   if (!m_buffer_start)
     data_length = 0;
 
   // allocate new buffer and copy the data over
-  uint8_t *buffer = new uint8_t[new_size];
+  ola::io::MemoryBlock *block = NULL;
+  uint8_t *buffer;
+  if (m_buffer_pool && new_size <= m_buffer_pool->BlockSize()) {
+    block = m_buffer_pool->Allocate();
+    new_size = block->Capacity();
+    buffer = block->Data();
+  } else {
+    new_size = std::max(new_size, INITIAL_SIZE);
+    buffer = new uint8_t[new_size];
+  }
   if (m_buffer_start) {
     if (data_length > 0)
       // this moves the data to the start of the buffer if it wasn't already
       memcpy(buffer, m_buffer_start, data_length);
-    delete[] m_buffer_start;
+    FreeBuffer();
   }
 
+  m_block = block;
   m_buffer_start = buffer;
   m_buffer_end = buffer + new_size;
   m_data_end = buffer + data_length;
 }
 
 
+/**
+ * Free the rx buffer, or return it to the pool.
+ */
+void IncomingStreamTransport::FreeBuffer() {
+  if (m_block) {
+    m_buffer_pool->Release(m_block);
+    m_block = NULL;
+  } else if (m_buffer_start) {
+    delete[] m_buffer_start;
+  }
+  m_buffer_start = NULL;
+  m_buffer_end = NULL;
+  m_data_end = NULL;
+}
+
+
 /**
  * Read data until we reach the number of bytes we required or there is no more
  * data to be read
@@ -312,20 +347,206 @@ void IncomingStreamTransport::EnterWaitingForPDU() {
 }
 
 
+/**
+ * Create a new BufferedStreamTransport.
+ * @param inflator the inflator to call for each PDU
+ * @param descriptor the descriptor to read from
+ * @param source the IP and port to use in the transport header
+ * @param initial_size the initial size of the rx buffer.
+ */
+BufferedStreamTransport::BufferedStreamTransport(
+    BaseInflator *inflator,
+    ola::io::ConnectedDescriptor *descriptor,
+    const ola::network::IPV4SocketAddress &source,
+    unsigned int initial_size)
+    : m_transport_header(source, TransportHeader::TCP),
+      m_inflator(inflator),
+      m_descriptor(descriptor),
+      m_buffer(NULL),
+      m_buffer_size(std::max(initial_size, ACN_HEADER_SIZE + PDU_BLOCK_SIZE)),
+      m_read_offset(0),
+      m_write_offset(0),
+      m_block_remaining(0),
+      m_stream_valid(true) {
+  m_buffer = new uint8_t[m_buffer_size];
+}
+
+
+BufferedStreamTransport::~BufferedStreamTransport() {
+  delete[] m_buffer;
+}
+
+
+/**
+ * Read all available data from the stream, and inflate the complete PDUs.
+ * @returns false if the stream is no longer consistent. At this point the
+ * caller should close the descriptor since the data is no longer valid.
+ */
+bool BufferedStreamTransport::Receive() {
+  while (m_stream_valid) {
+    const unsigned int free_space = m_buffer_size - m_write_offset;
+    unsigned int data_read = 0;
+    if (m_descriptor->Receive(m_buffer + m_write_offset, free_space,
+                              data_read)) {
+      OLA_WARN << "tcp rx failed";
+    }
+    m_write_offset += data_read;
+
+    const unsigned int required = ProcessData();
+    if (!m_stream_valid) {
+      break;
+    }
+
+    if (m_read_offset == m_write_offset) {
+      m_read_offset = 0;
+      m_write_offset = 0;
+    } else if (m_read_offset + required > m_buffer_size) {
+      MakeSpace(required);
+    }
+
+    if (data_read < free_space) {
+      // There's nothing more to read.
+      break;
+    }
+  }
+  return m_stream_valid;
+}
+
+
+/**
+ * Inflate every complete PDU in the buffer.
+ * @returns the amount of data required, from the read offset, before the
+ * next step can be processed.
+ */
+unsigned int BufferedStreamTransport::ProcessData() {
+  while (true) {
+    const uint8_t *data = m_buffer + m_read_offset;
+    const unsigned int available = m_write_offset - m_read_offset;
+
+    if (m_block_remaining == 0) {
+      // waiting for a preamble
+      if (available < ACN_HEADER_SIZE + PDU_BLOCK_SIZE) {
+        return ACN_HEADER_SIZE + PDU_BLOCK_SIZE;
+      }
+
+      if (memcmp(data, ACN_HEADER, ACN_HEADER_SIZE) != 0) {
+        OLA_WARN << "bad ACN header";
+        m_stream_valid = false;
+        return 0;
+      }
+
+      uint32_t block_size;
+      memcpy(reinterpret_cast<void*>(&block_size), data + ACN_HEADER_SIZE,
+             sizeof(block_size));
+      m_block_remaining = ola::network::NetworkToHost(block_size);
+      m_read_offset += ACN_HEADER_SIZE + PDU_BLOCK_SIZE;
+      continue;
+    }
+
+    // The flags tell us if the length is 2 or 3 bytes.
+    unsigned int length_size = 2;
+    if (available && (data[0] & BaseInflator::LFLAG_MASK)) {
+      length_size = 3;
+    }
+    if (available < length_size) {
+      return length_size;
+    }
+
+    unsigned int pdu_size;
+    if (length_size == 3) {
+      pdu_size = (
+        data[2] +
+        static_cast<unsigned int>(data[1] << 8) +
+        static_cast<unsigned int>((data[0] & BaseInflator::LENGTH_MASK)
+          << 16));
+    } else {
+      pdu_size = data[1] + static_cast<unsigned int>(
+          (data[0] & BaseInflator::LENGTH_MASK) << 8);
+    }
+
+    if (pdu_size < length_size) {
+      OLA_WARN << "PDU length was set to " << pdu_size << " but "
+               << length_size << " bytes were used in the header";
+      m_stream_valid = false;
+      return 0;
+    }
+    if (pdu_size > m_block_remaining) {
+      OLA_WARN << "PDU of size " << pdu_size << " exceeds the remaining "
+               << m_block_remaining << " bytes in the block";
+      m_stream_valid = false;
+      return 0;
+    }
+
+    if (available < pdu_size) {
+      return pdu_size;
+    }
+
+    HeaderSet header_set;
+    header_set.SetTransportHeader(m_transport_header);
+    unsigned int data_consumed = m_inflator->InflatePDUBlock(
+        &header_set, data, pdu_size);
+    if (data_consumed != pdu_size) {
+      OLA_WARN << "PDU inflation size mismatch, " << pdu_size << " != "
+               << data_consumed;
+      m_stream_valid = false;
+      return 0;
+    }
+    m_read_offset += pdu_size;
+    m_block_remaining -= pdu_size;
+  }
+}
+
+
+/**
+ * Move the unprocessed data to the start of the buffer, growing the buffer if
+ * it can't hold the required amount of data.
+ */
+void BufferedStreamTransport::MakeSpace(unsigned int required) {
+  const unsigned int data_length = m_write_offset - m_read_offset;
+  if (required > m_buffer_size) {
+    const unsigned int new_size = std::max(required, 2 * m_buffer_size);
+    uint8_t *buffer = new uint8_t[new_size];
+    memcpy(buffer, m_buffer + m_read_offset, data_length);
+    delete[] m_buffer;
+    m_buffer = buffer;
+    m_buffer_size = new_size;
+  } else {
+    memmove(m_buffer, m_buffer + m_read_offset, data_length);
+  }
+  m_read_offset = 0;
+  m_write_offset = data_length;
+}
+
+
 /**
  * Create a new IncomingTCPTransport
  */
-IncomingTCPTransport::IncomingTCPTransport(BaseInflator *inflator,
-                                           ola::network::TCPSocket *socket)
+IncomingTCPTransport::IncomingTCPTransport(
+    BaseInflator *inflator,
+    ola::network::TCPSocket *socket,
+    ola::io::MemoryBlockPool *buffer_pool)
     : m_transport(NULL) {
   ola::network::GenericSocketAddress address = socket->GetPeerAddress();
   if (address.Family() == AF_INET) {
     ola::network::IPV4SocketAddress v4_addr = address.V4Addr();
-    m_transport.reset(
-        new IncomingStreamTransport(inflator, socket, v4_addr));
+    if (buffer_pool) {
+      m_transport.reset(
+          new IncomingStreamTransport(inflator, socket, v4_addr, buffer_pool));
+    } else {
+      m_buffered_transport.reset(
+          new BufferedStreamTransport(inflator, socket, v4_addr));
+    }
   } else {
     OLA_WARN << "Invalid address for fd " << socket->ReadDescriptor();
   }
 }
+
+
+bool IncomingTCPTransport::Receive() {
+  if (m_buffered_transport.get()) {
+    return m_buffered_transport->Receive();
+  }
+  return m_transport.get() && m_transport->Receive();
+}
 }  // namespace acn
 }  // namespace ola
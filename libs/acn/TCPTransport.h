@@ -31,7 +31,11 @@
 #ifndef LIBS_ACN_TCPTRANSPORT_H_
 #define LIBS_ACN_TCPTRANSPORT_H_
 
+#include <stdint.h>
 #include <memory>
+#include "ola/base/Macro.h"
+#include "ola/io/MemoryBlock.h"
+#include "ola/io/MemoryBlockPool.h"
 #include "ola/io/OutputBuffer.h"
 #include "ola/io/OutputStream.h"
 #include "ola/io/Descriptor.h"
@@ -50,9 +54,16 @@ namespace acn {
  */
 class IncomingStreamTransport {
  public:
+    /*
+     * If a buffer_pool is provided, the receive buffer is taken from the pool
+     * as data arrives, and returned to it once each PDU block is processed.
+     * This means idle connections don't hold a buffer. PDU blocks larger
+     * than the pool's block size use a buffer of their own.
+     */
     IncomingStreamTransport(class BaseInflator *inflator,
                             ola::io::ConnectedDescriptor *descriptor,
-                            const ola::network::IPV4SocketAddress &source);
+                            const ola::network::IPV4SocketAddress &source,
+                            ola::io::MemoryBlockPool *buffer_pool = NULL);
     ~IncomingStreamTransport();
 
     bool Receive();
@@ -74,6 +85,9 @@ class IncomingStreamTransport {
     TransportHeader m_transport_header;
     class BaseInflator *m_inflator;
     ola::io::ConnectedDescriptor *m_descriptor;
+    ola::io::MemoryBlockPool *m_buffer_pool;
+    // The block the buffer came from, or NULL if we allocated it.
+    ola::io::MemoryBlock *m_block;
 
     // end points to the byte after the data
     uint8_t *m_buffer_start, *m_buffer_end, *m_data_end;
@@ -93,6 +107,7 @@ class IncomingStreamTransport {
     void HandlePDU();
 
     void IncreaseBufferSize(unsigned int new_size);
+    void FreeBuffer();
     void ReadRequiredData();
     void EnterWaitingForPreamble();
     void EnterWaitingForPDU();
@@ -125,19 +140,72 @@ class IncomingStreamTransport {
 };
 
 
+/**
+ * Read ACN messages from a stream using a single buffer.
+ *
+ * Unlike the IncomingStreamTransport, which reads just enough for the next
+ * step of the state machine, each Receive() reads as much data as is
+ * available and then inflates every complete PDU in place, so in the common
+ * case the data is never copied after it's read.
+ *
+ * The buffer is used like a ring, except that PDUs are never split across
+ * the end: when there isn't room for the rest of a partial PDU, it's moved to
+ * the start of the buffer. The buffer grows if a single PDU doesn't fit.
+ */
+class BufferedStreamTransport {
+ public:
+    BufferedStreamTransport(class BaseInflator *inflator,
+                            ola::io::ConnectedDescriptor *descriptor,
+                            const ola::network::IPV4SocketAddress &source,
+                            unsigned int initial_size = DEFAULT_BUFFER_SIZE);
+    ~BufferedStreamTransport();
+
+    bool Receive();
+
+    static const unsigned int DEFAULT_BUFFER_SIZE = 4096;
+
+ private:
+    TransportHeader m_transport_header;
+    class BaseInflator *m_inflator;
+    ola::io::ConnectedDescriptor *m_descriptor;
+
+    uint8_t *m_buffer;
+    unsigned int m_buffer_size;
+    // The unprocessed data is between the read and write offsets.
+    unsigned int m_read_offset;
+    unsigned int m_write_offset;
+    // The data left in the current PDU block, 0 if we're waiting for a
+    // preamble.
+    unsigned int m_block_remaining;
+    bool m_stream_valid;
+
+    unsigned int ProcessData();
+    void MakeSpace(unsigned int required);
+
+    static const unsigned int PDU_BLOCK_SIZE = 4;
+
+    DISALLOW_COPY_AND_ASSIGN(BufferedStreamTransport);
+};
+
+
 /**
  * IncomingTCPTransport is responsible for receiving ACN over TCP.
+ *
+ * Without a buffer_pool this uses a BufferedStreamTransport. With a pool the
+ * IncomingStreamTransport is used, so idle connections don't hold a buffer.
  */
 class IncomingTCPTransport {
  public:
     IncomingTCPTransport(class BaseInflator *inflator,
-                         ola::network::TCPSocket *socket);
+                         ola::network::TCPSocket *socket,
+                         ola::io::MemoryBlockPool *buffer_pool = NULL);
     ~IncomingTCPTransport() {}
 
-    bool Receive() { return m_transport->Receive(); }
+    bool Receive();
 
  private:
     std::auto_ptr<IncomingStreamTransport> m_transport;
+    std::auto_ptr<BufferedStreamTransport> m_buffered_transport;
 };
 }  // namespace acn
 }  // namespace ola
@@ -26,6 +26,7 @@
 #include "ola/Logging.h"
 #include "ola/io/IOQueue.h"
 #include "ola/io/IOStack.h"
+#include "ola/io/MemoryBlockPool.h"
 #include "ola/io/SelectServer.h"
 #include "libs/acn/PDUTestCommon.h"
 #include "libs/acn/PreamblePacker.h"
@@ -52,6 +53,9 @@ class TCPTransportTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testZeroLengthPDUBlock);
   CPPUNIT_TEST(testMultiplePDUs);
   CPPUNIT_TEST(testSinglePDUBlock);
+  CPPUNIT_TEST(testBufferPool);
+  CPPUNIT_TEST(testBufferedTransport);
+  CPPUNIT_TEST(testBufferedBadPreamble);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -63,6 +67,9 @@ class TCPTransportTest: public CppUnit::TestFixture {
     void testMultiplePDUs();
     void testMultiplePDUsWithExtraData();
     void testSinglePDUBlock();
+    void testBufferPool();
+    void testBufferedTransport();
+    void testBufferedBadPreamble();
     void setUp();
     void tearDown();
 
@@ -81,6 +88,7 @@ class TCPTransportTest: public CppUnit::TestFixture {
     auto_ptr<Callback0<void> > m_rx_callback;
     auto_ptr<MockInflator> m_inflator;
     auto_ptr<IncomingStreamTransport> m_transport;
+    auto_ptr<BufferedStreamTransport> m_buffered_transport;
 
     void SendEmptyPDUBLock(const ola::testing::SourceLine &source_line);
     void SendPDU(const ola::testing::SourceLine &source_line);
@@ -144,7 +152,11 @@ void TCPTransportTest::Stop() {
  * Receive data and terminate if the stream is bad.
  */
 void TCPTransportTest::Receive() {
-  m_stream_ok = m_transport->Receive();
+  if (m_buffered_transport.get()) {
+    m_stream_ok = m_buffered_transport->Receive();
+  } else {
+    m_stream_ok = m_transport->Receive();
+  }
   if (!m_stream_ok)
     m_ss->Terminate();
 }
@@ -245,6 +257,77 @@ void TCPTransportTest::testSinglePDUBlock() {
 }
 
 
+/**
+ * Check that the rx buffers are taken from, and returned to the pool.
+ */
+void TCPTransportTest::testBufferPool() {
+  ola::io::MemoryBlockPool pool(64);
+  m_transport.reset(new IncomingStreamTransport(m_inflator.get(), &m_loopback,
+                                                m_localhost, &pool));
+  // No buffer is held until data arrives.
+  OLA_ASSERT_EQ(0u, pool.BlocksAllocated());
+
+  SendPDU(OLA_SOURCELINE());
+  SendPDUBlock(OLA_SOURCELINE());
+  SendPDU(OLA_SOURCELINE());
+
+  m_ss->RunOnce(TimeInterval(1, 0));
+  m_loopback.CloseClient();
+  m_ss->RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT(m_stream_ok);
+  OLA_ASSERT_EQ(5u, m_pdus_received);
+
+  // The same block is reused for each PDU block, and is back in the pool.
+  OLA_ASSERT_EQ(1u, pool.BlocksAllocated());
+  OLA_ASSERT_EQ(1u, pool.FreeBlocks());
+  m_transport.reset();
+}
+
+
+/**
+ * Check the BufferedStreamTransport inflates all the PDUs from a single read.
+ */
+void TCPTransportTest::testBufferedTransport() {
+  // Start with a buffer smaller than the PDU block, so it has to grow.
+  m_buffered_transport.reset(new BufferedStreamTransport(
+      m_inflator.get(), &m_loopback, m_localhost, 24));
+
+  SendPDU(OLA_SOURCELINE());
+  SendPDUBlock(OLA_SOURCELINE());
+  SendEmptyPDUBLock(OLA_SOURCELINE());
+  SendPDU(OLA_SOURCELINE());
+
+  m_ss->RunOnce(TimeInterval(1, 0));
+  m_loopback.CloseClient();
+  m_ss->RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT(m_stream_ok);
+  OLA_ASSERT_EQ(5u, m_pdus_received);
+}
+
+
+/**
+ * Check the BufferedStreamTransport rejects bogus data.
+ */
+void TCPTransportTest::testBufferedBadPreamble() {
+  m_buffered_transport.reset(new BufferedStreamTransport(
+      m_inflator.get(), &m_loopback, m_localhost));
+
+  uint8_t bogus_data[] = {
+    1, 2, 3, 4,
+    5, 0, 1, 0,
+    0, 4, 5, 6,
+    7, 8, 9, 0,
+    1, 2, 3, 4};
+  m_loopback.Send(bogus_data, sizeof(bogus_data));
+
+  m_ss->RunOnce(TimeInterval(1, 0));
+  m_loopback.CloseClient();
+  m_ss->RunOnce(TimeInterval(1, 0));
+  OLA_ASSERT_FALSE(m_stream_ok);
+  OLA_ASSERT_EQ(0u, m_pdus_received);
+}
+
+
 /**
  * Send empty PDU block.
  */
@@ -16,14 +16,16 @@
  * TransportHeader.h
  * Interface for the TransportHeader class.
  * This holds the source IP of the packet which is used to address replies
- * correctly. At some point in the future we should try to abtract the
- * transport protocol (IP/UDP in this case).
+ * correctly, and the time the packet was received, if known. At some point in
+ * the future we should try to abtract the transport protocol (IP/UDP in this
+ * case).
  * Copyright (C) 2011 Simon Newton
  */
 
 #ifndef LIBS_ACN_TRANSPORTHEADER_H_
 #define LIBS_ACN_TRANSPORTHEADER_H_
 
+#include "ola/Clock.h"
 #include "ola/network/SocketAddress.h"
 
 namespace ola {
@@ -42,13 +44,17 @@ class TransportHeader {
 
   TransportHeader() : m_transport_type(UNDEFINED) {}
   TransportHeader(const ola::network::IPV4SocketAddress &source,
-                  TransportType type)
+                  TransportType type,
+                  const TimeStamp &receive_time = TimeStamp())
       : m_source(source),
-        m_transport_type(type) {}
+        m_transport_type(type),
+        m_receive_time(receive_time) {}
 
   ~TransportHeader() {}
   const ola::network::IPV4SocketAddress& Source() const { return m_source; }
   TransportType Transport() const { return m_transport_type; }
+  // The time the kernel received the packet, this may not be set.
+  const TimeStamp &ReceiveTime() const { return m_receive_time; }
 
   bool operator==(const TransportHeader &other) const {
     return (m_source == other.m_source &&
@@ -58,11 +64,13 @@ class TransportHeader {
   void operator=(const TransportHeader &other) {
     m_source = other.m_source;
     m_transport_type = other.m_transport_type;
+    m_receive_time = other.m_receive_time;
   }
 
  private:
   ola::network::IPV4SocketAddress m_source;
   TransportType m_transport_type;
+  TimeStamp m_receive_time;
 };
 }  // namespace acn
 }  // namespace ola
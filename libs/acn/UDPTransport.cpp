@@ -19,6 +19,7 @@
  */
 
 #include <string.h>
+#include <vector>
 
 #include "ola/Callback.h"
 #include "ola/Logging.h"
@@ -33,6 +34,10 @@ namespace acn {
 
 using ola::network::HostToNetwork;
 using ola::network::IPV4SocketAddress;
+using std::vector;
+
+const unsigned int OutgoingUDPTransportImpl::MAX_BATCH_SIZE = 64;
+const unsigned int IncomingUDPTransport::RECV_BATCH_SIZE = 16;
 
 /*
  * Send a block of PDU messages.
@@ -57,52 +62,185 @@ bool OutgoingUDPTransportImpl::Send(const PDUBlock<PDU> &pdu_block,
   if (!data)
     return false;
 
-  return m_socket->SendTo(data, data_size, destination);
+  return Send(data, data_size, destination);
+}
+
+
+/*
+ * Send a datagram that has already been packed.
+ * @param data the datagram, including the ACN preamble.
+ * @param data_size the size of the datagram.
+ * @param destination the ipv4 address to send to
+ */
+bool OutgoingUDPTransportImpl::Send(const uint8_t *data,
+                                    unsigned int data_size,
+                                    const IPV4SocketAddress &destination) {
+  if (!m_batching) {
+    return m_socket->SendTo(data, data_size, destination);
+  }
+
+  if (m_batch.size() == MAX_BATCH_SIZE && !SendQueued()) {
+    return false;
+  }
+
+  ola::network::UDPDatagram datagram;
+  datagram.data = QueueData(data, data_size);
+  datagram.length = data_size;
+  datagram.address = destination;
+  m_batch.push_back(datagram);
+  return true;
+}
+
+
+/*
+ * Send a datagram that has already been packed to a list of destinations.
+ * @param data the datagram, including the ACN preamble.
+ * @param data_size the size of the datagram.
+ * @param destinations the addresses to send to
+ */
+bool OutgoingUDPTransportImpl::Send(
+    const uint8_t *data,
+    unsigned int data_size,
+    const vector<IPV4SocketAddress> &destinations) {
+  if (destinations.empty()) {
+    return true;
+  }
+
+  ola::network::UDPDatagram datagram;
+  datagram.length = data_size;
+
+  if (!m_batching || destinations.size() > MAX_BATCH_SIZE) {
+    // SendBatch() doesn't modify the data.
+    datagram.data = const_cast<uint8_t*>(data);
+    m_multi_send.clear();
+    vector<IPV4SocketAddress>::const_iterator iter = destinations.begin();
+    for (; iter != destinations.end(); ++iter) {
+      datagram.address = *iter;
+      m_multi_send.push_back(datagram);
+    }
+    // Anything already queued goes first.
+    bool ok = SendQueued();
+    unsigned int count = static_cast<unsigned int>(m_multi_send.size());
+    return m_socket->SendBatch(&m_multi_send[0], count) == count && ok;
+  }
+
+  if (m_batch.size() + destinations.size() > MAX_BATCH_SIZE &&
+      !SendQueued()) {
+    return false;
+  }
+
+  datagram.data = QueueData(data, data_size);
+  vector<IPV4SocketAddress>::const_iterator iter = destinations.begin();
+  for (; iter != destinations.end(); ++iter) {
+    datagram.address = *iter;
+    m_batch.push_back(datagram);
+  }
+  return true;
+}
+
+
+bool OutgoingUDPTransportImpl::FlushBatch() {
+  m_batching = false;
+  return SendQueued();
+}
+
+
+/*
+ * Send everything in the queue.
+ */
+bool OutgoingUDPTransportImpl::SendQueued() {
+  if (m_batch.empty()) {
+    return true;
+  }
+
+  unsigned int count = static_cast<unsigned int>(m_batch.size());
+  unsigned int sent = m_socket->SendBatch(&m_batch[0], count);
+  m_batch.clear();
+  m_batch_slots = 0;
+  return sent == count;
+}
+
+
+/*
+ * Copy a datagram into the next free slot of the batch buffer.
+ */
+uint8_t *OutgoingUDPTransportImpl::QueueData(const uint8_t *data,
+                                             unsigned int data_size) {
+  if (!m_batch_buffer) {
+    m_batch_buffer =
+        new uint8_t[MAX_BATCH_SIZE * PreamblePacker::MAX_DATAGRAM_SIZE];
+  }
+  uint8_t *slot = m_batch_buffer +
+      m_batch_slots * PreamblePacker::MAX_DATAGRAM_SIZE;
+  m_batch_slots++;
+  memcpy(slot, data, data_size);
+  return slot;
 }
 
 
 
 IncomingUDPTransport::IncomingUDPTransport(ola::network::UDPSocket *socket,
-                                           BaseInflator *inflator)
+                                           BaseInflator *inflator,
+                                           DatagramDecoder *decoder)
     : m_socket(socket),
       m_inflator(inflator),
+      m_decoder(decoder),
       m_recv_buffer(NULL) {
 }
 
 
 /*
- * Called when new data arrives.
+ * Called when new data arrives. This drains up to RECV_BATCH_SIZE datagrams
+ * from the socket.
  */
 void IncomingUDPTransport::Receive() {
-  if (!m_recv_buffer)
-    m_recv_buffer = new uint8_t[PreamblePacker::MAX_DATAGRAM_SIZE];
+  if (!m_recv_buffer) {
+    m_recv_buffer =
+        new uint8_t[RECV_BATCH_SIZE * PreamblePacker::MAX_DATAGRAM_SIZE];
+  }
 
-  ssize_t size = PreamblePacker::MAX_DATAGRAM_SIZE;
-  ola::network::IPV4SocketAddress source;
+  ola::network::UDPDatagram datagrams[RECV_BATCH_SIZE];
+  for (unsigned int i = 0; i < RECV_BATCH_SIZE; i++) {
+    datagrams[i].data =
+        m_recv_buffer + i * PreamblePacker::MAX_DATAGRAM_SIZE;
+    datagrams[i].length = PreamblePacker::MAX_DATAGRAM_SIZE;
+  }
+
+  unsigned int received = m_socket->RecvBatch(datagrams, RECV_BATCH_SIZE);
+  for (unsigned int i = 0; i < received; i++) {
+    HandleDatagram(datagrams[i]);
+  }
+}
 
-  if (!m_socket->RecvFrom(m_recv_buffer, &size, &source))
-    return;
 
+/*
+ * Check the ACN header and inflate a single datagram.
+ */
+void IncomingUDPTransport::HandleDatagram(
+    const ola::network::UDPDatagram &datagram) {
   unsigned int header_size = PreamblePacker::ACN_HEADER_SIZE;
-  if (size < static_cast<ssize_t>(header_size)) {
+  if (datagram.length < static_cast<ssize_t>(header_size)) {
     OLA_WARN << "short ACN frame, discarding";
     return;
   }
 
-  if (memcmp(m_recv_buffer, PreamblePacker::ACN_HEADER, header_size)) {
+  if (memcmp(datagram.data, PreamblePacker::ACN_HEADER, header_size)) {
     OLA_WARN << "ACN header is bad, discarding";
     return;
   }
 
+  const uint8_t *data = datagram.data + header_size;
+  unsigned int length = static_cast<unsigned int>(datagram.length) -
+                        header_size;
+  TransportHeader transport_header(datagram.address, TransportHeader::UDP,
+                                   datagram.timestamp);
+  if (m_decoder && m_decoder->HandleDatagram(data, length, transport_header)) {
+    return;
+  }
+
   HeaderSet header_set;
-  TransportHeader transport_header(source, TransportHeader::UDP);
   header_set.SetTransportHeader(transport_header);
-
-  m_inflator->InflatePDUBlock(
-      &header_set,
-      m_recv_buffer + header_size,
-      static_cast<unsigned int>(size) - header_size);
-  return;
+  m_inflator->InflatePDUBlock(&header_set, data, length);
 }
 }  // namespace acn
 }  // namespace ola
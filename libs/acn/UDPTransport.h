@@ -21,12 +21,15 @@
 #ifndef LIBS_ACN_UDPTRANSPORT_H_
 #define LIBS_ACN_UDPTRANSPORT_H_
 
+#include <vector>
+
 #include "ola/acn/ACNPort.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Socket.h"
 #include "libs/acn/PDU.h"
 #include "libs/acn/PreamblePacker.h"
 #include "libs/acn/Transport.h"
+#include "libs/acn/TransportHeader.h"
 
 namespace ola {
 namespace acn {
@@ -65,7 +68,10 @@ class OutgoingUDPTransportImpl {
                              PreamblePacker *packer = NULL)
         : m_socket(socket),
           m_packer(packer),
-          m_free_packer(false) {
+          m_free_packer(false),
+          m_batching(false),
+          m_batch_buffer(NULL),
+          m_batch_slots(0) {
       if (!m_packer) {
         m_packer = new PreamblePacker();
         m_free_packer = true;
@@ -74,15 +80,62 @@ class OutgoingUDPTransportImpl {
     ~OutgoingUDPTransportImpl() {
       if (m_free_packer)
         delete m_packer;
+      if (m_batch_buffer)
+        delete[] m_batch_buffer;
     }
 
     bool Send(const PDUBlock<PDU> &pdu_block,
               const ola::network::IPV4SocketAddress &destination);
+    bool Send(const uint8_t *data,
+              unsigned int data_size,
+              const ola::network::IPV4SocketAddress &destination);
+
+    /**
+     * @brief Send a packed datagram to many destinations.
+     *
+     * The datagrams all refer to the same data, and are sent with a single
+     * UDPSocket::SendBatch() call. If batching, the data is copied once and
+     * queued for each destination.
+     */
+    bool Send(const uint8_t *data,
+              unsigned int data_size,
+              const std::vector<ola::network::IPV4SocketAddress> &destinations);
+
+    /**
+     * @brief Queue datagrams rather than sending them immediately.
+     *
+     * Queued datagrams are sent by FlushBatch(), or when the queue fills up.
+     */
+    void StartBatch() { m_batching = true; }
+
+    /**
+     * @brief Send all queued datagrams and stop batching.
+     * @returns true if all the datagrams were sent, false otherwise.
+     */
+    bool FlushBatch();
+
+    /**
+     * @brief Check if datagrams are being queued.
+     */
+    bool Batching() const { return m_batching; }
 
  private:
     ola::network::UDPSocket *m_socket;
     PreamblePacker *m_packer;
     bool m_free_packer;
+    bool m_batching;
+    uint8_t *m_batch_buffer;
+    // The number of datagram sized slots of m_batch_buffer in use.
+    unsigned int m_batch_slots;
+    std::vector<ola::network::UDPDatagram> m_batch;
+    // Used for sending to many destinations when not batching.
+    std::vector<ola::network::UDPDatagram> m_multi_send;
+
+    uint8_t *QueueData(const uint8_t *data, unsigned int data_size);
+    bool SendQueued();
+
+    // The max number of datagrams to queue before sending.
+    static const unsigned int MAX_BATCH_SIZE;
 };
 
 
@@ -91,10 +144,38 @@ class OutgoingUDPTransportImpl {
  * TODO(simon): pass the socket as an argument to receive so we can reuse the
  * transport for multiple sockets.
  */
+/*
+ * A DatagramDecoder is given each datagram before the inflator. This allows
+ * common packets to be decoded without inflating each PDU layer.
+ */
+class DatagramDecoder {
+ public:
+    virtual ~DatagramDecoder() {}
+
+    /*
+     * Handle a datagram.
+     * @param data the PDU block, after the ACN preamble.
+     * @param length the length of the PDU block.
+     * @param transport_header the TransportHeader for the datagram.
+     * @returns true if the datagram was handled, false if it should be passed
+     *   to the inflator.
+     */
+    virtual bool HandleDatagram(const uint8_t *data, unsigned int length,
+                                const TransportHeader &transport_header) = 0;
+};
+
+
 class IncomingUDPTransport {
  public:
+    /*
+     * @param socket the socket to read from.
+     * @param inflator the inflator to pass datagrams to.
+     * @param decoder an optional DatagramDecoder to try first, ownership is
+     *   not transferred.
+     */
     IncomingUDPTransport(ola::network::UDPSocket *socket,
-                         class BaseInflator *inflator);
+                         class BaseInflator *inflator,
+                         DatagramDecoder *decoder = NULL);
     ~IncomingUDPTransport() {
       if (m_recv_buffer)
         delete[] m_recv_buffer;
@@ -102,10 +183,20 @@ class IncomingUDPTransport {
 
     void Receive();
 
+    /*
+     * Check the ACN header and handle a datagram that was received by other
+     * means, e.g. from a PacketRingTransport.
+     */
+    void HandleDatagram(const ola::network::UDPDatagram &datagram);
+
  private:
     ola::network::UDPSocket *m_socket;
     class BaseInflator *m_inflator;
+    DatagramDecoder *m_decoder;
     uint8_t *m_recv_buffer;
+
+    // The max number of datagrams read per call to Receive().
+    static const unsigned int RECV_BATCH_SIZE;
 };
 }  // namespace acn
 }  // namespace ola
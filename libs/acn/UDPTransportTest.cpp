@@ -20,6 +20,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
+#include <vector>
 
 #include "ola/Logging.h"
 #include "ola/io/SelectServer.h"
@@ -37,22 +38,29 @@ using ola::acn::CID;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
+using std::vector;
 
 class UDPTransportTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(UDPTransportTest);
   CPPUNIT_TEST(testUDPTransport);
+  CPPUNIT_TEST(testBatchedSend);
+  CPPUNIT_TEST(testMultipleDestinations);
   CPPUNIT_TEST_SUITE_END();
 
  public:
-    UDPTransportTest(): TestFixture(), m_ss(NULL) {}
+    UDPTransportTest(): TestFixture(), m_ss(NULL), m_received(0) {}
     void testUDPTransport();
+    void testBatchedSend();
+    void testMultipleDestinations();
     void setUp();
     void tearDown();
     void Stop();
     void FatalStop() { OLA_ASSERT(false); }
+    void CountAndStop();
 
  private:
     ola::io::SelectServer *m_ss;
+    unsigned int m_received;
     static const int ABORT_TIMEOUT_IN_MS = 1000;
 };
 
@@ -71,6 +79,11 @@ void UDPTransportTest::Stop() {
     m_ss->Terminate();
 }
 
+void UDPTransportTest::CountAndStop() {
+  if (++m_received == 3)
+    Stop();
+}
+
 
 /*
  * Test the UDPTransport
@@ -112,5 +125,121 @@ void UDPTransportTest::testUDPTransport() {
   m_ss->RegisterSingleTimeout(ABORT_TIMEOUT_IN_MS, closure);
   m_ss->Run();
 }
+
+
+/*
+ * Test that batched datagrams are only sent once the batch is flushed.
+ */
+void UDPTransportTest::testBatchedSend() {
+  CID cid;
+  std::auto_ptr<Callback0<void> > count_closure(
+      NewCallback(this, &UDPTransportTest::CountAndStop));
+  MockInflator inflator(cid, count_closure.get());
+
+  ola::network::UDPSocket socket;
+  OLA_ASSERT(socket.Init());
+  OLA_ASSERT(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress local_address;
+  OLA_ASSERT(socket.GetSocketAddress(&local_address));
+
+  IncomingUDPTransport incoming_udp_transport(&socket, &inflator);
+  socket.SetOnData(NewCallback(&incoming_udp_transport,
+                               &IncomingUDPTransport::Receive));
+  OLA_ASSERT(m_ss->AddReadDescriptor(&socket));
+
+  OutgoingUDPTransportImpl udp_transport_impl(&socket);
+  OutgoingUDPTransport outgoing_udp_transport(&udp_transport_impl,
+      IPV4Address::Loopback(), local_address.Port());
+
+  PDUBlock<PDU> pdu_block;
+  MockPDU mock_pdu(4, 8);
+  pdu_block.AddPDU(&mock_pdu);
+
+  udp_transport_impl.StartBatch();
+  OLA_ASSERT(udp_transport_impl.Batching());
+  for (unsigned int i = 0; i < 3; i++) {
+    OLA_ASSERT(outgoing_udp_transport.Send(pdu_block));
+  }
+
+  // nothing should have been sent yet
+  m_ss->RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(0u, m_received);
+
+  OLA_ASSERT(udp_transport_impl.FlushBatch());
+  OLA_ASSERT_FALSE(udp_transport_impl.Batching());
+
+  SingleUseCallback0<void> *closure =
+    NewSingleCallback(this, &UDPTransportTest::FatalStop);
+  m_ss->RegisterSingleTimeout(ABORT_TIMEOUT_IN_MS, closure);
+  m_ss->Run();
+  OLA_ASSERT_EQ(3u, m_received);
+}
+
+
+/*
+ * Test that a packed datagram can be sent to many destinations, with and
+ * without batching.
+ */
+void UDPTransportTest::testMultipleDestinations() {
+  CID cid;
+  std::auto_ptr<Callback0<void> > count_closure(
+      NewCallback(this, &UDPTransportTest::CountAndStop));
+  MockInflator inflator(cid, count_closure.get());
+
+  ola::network::UDPSocket socket1, socket2;
+  OLA_ASSERT(socket1.Init());
+  OLA_ASSERT(socket1.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT(socket2.Init());
+  OLA_ASSERT(socket2.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  IPV4SocketAddress address1, address2;
+  OLA_ASSERT(socket1.GetSocketAddress(&address1));
+  OLA_ASSERT(socket2.GetSocketAddress(&address2));
+
+  IncomingUDPTransport incoming_transport1(&socket1, &inflator);
+  socket1.SetOnData(NewCallback(&incoming_transport1,
+                                &IncomingUDPTransport::Receive));
+  OLA_ASSERT(m_ss->AddReadDescriptor(&socket1));
+  IncomingUDPTransport incoming_transport2(&socket2, &inflator);
+  socket2.SetOnData(NewCallback(&incoming_transport2,
+                                &IncomingUDPTransport::Receive));
+  OLA_ASSERT(m_ss->AddReadDescriptor(&socket2));
+
+  PDUBlock<PDU> pdu_block;
+  MockPDU mock_pdu(4, 8);
+  pdu_block.AddPDU(&mock_pdu);
+  PreamblePacker packer;
+  unsigned int size;
+  const uint8_t *data = packer.Pack(pdu_block, &size);
+  OLA_ASSERT(data);
+
+  vector<IPV4SocketAddress> destinations;
+  destinations.push_back(address1);
+  destinations.push_back(address2);
+  destinations.push_back(address2);
+
+  OutgoingUDPTransportImpl udp_transport_impl(&socket1);
+  OLA_ASSERT(udp_transport_impl.Send(data, size, destinations));
+
+  SingleUseCallback0<void> *closure =
+    NewSingleCallback(this, &UDPTransportTest::FatalStop);
+  ola::thread::timeout_id timeout = m_ss->RegisterSingleTimeout(
+      ABORT_TIMEOUT_IN_MS, closure);
+  m_ss->Run();
+  m_ss->RemoveTimeout(timeout);
+  OLA_ASSERT_EQ(3u, m_received);
+
+  // Now with batching, the datagrams are held until the flush.
+  m_received = 0;
+  udp_transport_impl.StartBatch();
+  OLA_ASSERT(udp_transport_impl.Send(data, size, destinations));
+  m_ss->RunOnce(ola::TimeInterval(0, 0));
+  OLA_ASSERT_EQ(0u, m_received);
+  OLA_ASSERT(udp_transport_impl.FlushBatch());
+
+  closure = NewSingleCallback(this, &UDPTransportTest::FatalStop);
+  m_ss->RegisterSingleTimeout(ABORT_TIMEOUT_IN_MS, closure);
+  m_ss->Run();
+  OLA_ASSERT_EQ(3u, m_received);
+}
 }  // namespace acn
 }  // namespace ola
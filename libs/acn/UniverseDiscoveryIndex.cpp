@@ -0,0 +1,200 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseDiscoveryIndex.cpp
+ * Tracks the universes announced by E1.31 sources.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "libs/acn/UniverseDiscoveryIndex.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::IPV4Address;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+bool UniverseDiscoveryIndex::Update(const CID &cid,
+                                   const IPV4Address &ip_address,
+                                   const string &source_name,
+                                   const set<uint16_t> &universes,
+                                   const TimeStamp &now) {
+  std::pair<SourceMap::iterator, bool> result = m_sources.insert(
+      SourceMap::value_type(cid, Source()));
+  Source &source = result.first->second;
+  source.last_seen = now;
+
+  if (!result.second &&
+      source.ip_address == ip_address &&
+      source.source_name == source_name &&
+      source.universes == universes) {
+    return false;
+  }
+
+  if (source.universes != universes) {
+    set<uint16_t> removed, added;
+    std::set_difference(source.universes.begin(), source.universes.end(),
+                        universes.begin(), universes.end(),
+                        std::inserter(removed, removed.end()));
+    std::set_difference(universes.begin(), universes.end(),
+                        source.universes.begin(), source.universes.end(),
+                        std::inserter(added, added.end()));
+    RemoveFromUniverses(cid, removed);
+    AddToUniverses(cid, added);
+    source.universes = universes;
+  }
+
+  source.cid = cid;
+  source.ip_address = ip_address;
+  source.source_name = source_name;
+  source.generation = ++m_generation;
+  return true;
+}
+
+void UniverseDiscoveryIndex::Seen(const CID &cid, const TimeStamp &now) {
+  SourceMap::iterator iter = m_sources.find(cid);
+  if (iter != m_sources.end()) {
+    iter->second.last_seen = now;
+  }
+}
+
+bool UniverseDiscoveryIndex::Remove(const CID &cid) {
+  SourceMap::iterator iter = m_sources.find(cid);
+  if (iter == m_sources.end()) {
+    return false;
+  }
+
+  RemoveFromUniverses(cid, iter->second.universes);
+  m_sources.erase(iter);
+
+  m_removed[++m_generation] = cid;
+  if (m_removed.size() > MAX_REMOVED) {
+    m_resync_generation = m_removed.begin()->first;
+    m_removed.erase(m_removed.begin());
+  }
+  return true;
+}
+
+void UniverseDiscoveryIndex::Lookup(const Query &query, Page *page) const {
+  page->generation = m_generation;
+
+  uint64_t since_generation = query.since_generation;
+  if (since_generation && since_generation < m_resync_generation) {
+    page->resync = true;
+    since_generation = 0;
+  }
+
+  if (since_generation && query.start_after.IsNil()) {
+    map<uint64_t, CID>::const_iterator iter =
+        m_removed.upper_bound(since_generation);
+    for (; iter != m_removed.end(); ++iter) {
+      page->removed.push_back(iter->second);
+    }
+  }
+
+  if (query.filter_universe) {
+    UniverseMap::const_iterator universe_iter =
+        m_universes.find(query.universe);
+    if (universe_iter == m_universes.end()) {
+      return;
+    }
+
+    const set<CID> &cids = universe_iter->second;
+    set<CID>::const_iterator iter = query.start_after.IsNil() ?
+        cids.begin() : cids.upper_bound(query.start_after);
+    for (; iter != cids.end(); ++iter) {
+      SourceMap::const_iterator source_iter = m_sources.find(*iter);
+      if (!AddToPage(source_iter->second, query, since_generation, page)) {
+        return;
+      }
+    }
+  } else {
+    SourceMap::const_iterator iter = query.start_after.IsNil() ?
+        m_sources.begin() : m_sources.upper_bound(query.start_after);
+    for (; iter != m_sources.end(); ++iter) {
+      if (!AddToPage(iter->second, query, since_generation, page)) {
+        return;
+      }
+    }
+  }
+}
+
+void UniverseDiscoveryIndex::GetSources(vector<Source> *sources) const {
+  SourceMap::const_iterator iter = m_sources.begin();
+  for (; iter != m_sources.end(); ++iter) {
+    sources->push_back(iter->second);
+  }
+}
+
+void UniverseDiscoveryIndex::GetStats(Stats *stats) const {
+  stats->sources = static_cast<unsigned int>(m_sources.size());
+  stats->universes = static_cast<unsigned int>(m_universes.size());
+  stats->generation = m_generation;
+}
+
+void UniverseDiscoveryIndex::AddToUniverses(const CID &cid,
+                                           const set<uint16_t> &universes) {
+  set<uint16_t>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    m_universes[*iter].insert(cid);
+  }
+}
+
+void UniverseDiscoveryIndex::RemoveFromUniverses(
+    const CID &cid,
+    const set<uint16_t> &universes) {
+  set<uint16_t>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    UniverseMap::iterator universe_iter = m_universes.find(*iter);
+    if (universe_iter == m_universes.end()) {
+      continue;
+    }
+    universe_iter->second.erase(cid);
+    if (universe_iter->second.empty()) {
+      m_universes.erase(universe_iter);
+    }
+  }
+}
+
+/*
+ * Add a source to the page if it changed after since_generation.
+ * @returns false if the page is full.
+ */
+bool UniverseDiscoveryIndex::AddToPage(const Source &source,
+                                       const Query &query,
+                                       uint64_t since_generation,
+                                       Page *page) const {
+  if (source.generation <= since_generation) {
+    return true;
+  }
+
+  if (query.limit && page->sources.size() >= query.limit) {
+    page->next = page->sources.back().cid;
+    return false;
+  }
+  page->sources.push_back(source);
+  return true;
+}
+}  // namespace acn
+}  // namespace ola
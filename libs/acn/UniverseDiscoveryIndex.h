@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseDiscoveryIndex.h
+ * Tracks the universes announced by E1.31 sources.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_UNIVERSEDISCOVERYINDEX_H_
+#define LIBS_ACN_UNIVERSEDISCOVERYINDEX_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "ola/Clock.h"
+#include "ola/acn/CID.h"
+#include "ola/base/Macro.h"
+#include "ola/network/IPV4Address.h"
+
+namespace ola {
+namespace acn {
+
+/*
+ * The sources learnt from E1.31 universe discovery, indexed by CID and by
+ * universe.
+ *
+ * Every change, a source being added, changing its universe list, name or IP
+ * address, or being removed, is assigned the next generation number. Clients
+ * that remember the generation from their last query can ask for just the
+ * sources that changed since, along with the CIDs of those that were removed.
+ * Only the last MAX_REMOVED removals are remembered; a client that's further
+ * behind than that is told to start again.
+ */
+class UniverseDiscoveryIndex {
+ public:
+  struct Source {
+    CID cid;
+    ola::network::IPV4Address ip_address;
+    std::string source_name;
+    std::set<uint16_t> universes;
+    // When the last discovery packet arrived from the source.
+    TimeStamp last_seen;
+    // The generation the source last changed in.
+    uint64_t generation;
+  };
+
+  struct Query {
+    Query()
+        : since_generation(0),
+          limit(0),
+          filter_universe(false),
+          universe(0) {
+    }
+
+    // Only return sources that changed after this generation, 0 for all.
+    uint64_t since_generation;
+    // Return the sources after this CID, a nil CID starts from the first.
+    CID start_after;
+    // The maximum number of sources to return, 0 for no limit.
+    unsigned int limit;
+    // If true, only return sources that announce this universe.
+    bool filter_universe;
+    uint16_t universe;
+  };
+
+  struct Page {
+    Page() : generation(0), resync(false) {}
+
+    // The generation when the page was built.
+    uint64_t generation;
+    std::vector<Source> sources;
+    // The sources removed after since_generation. These are only set on the
+    // first page.
+    std::vector<CID> removed;
+    // True if since_generation was too old, in which case every source is
+    // returned.
+    bool resync;
+    // The CID to pass as start_after for the next page, nil if this was the
+    // last page.
+    CID next;
+  };
+
+  struct Stats {
+    Stats() : sources(0), universes(0), generation(0) {}
+
+    unsigned int sources;
+    unsigned int universes;
+    uint64_t generation;
+  };
+
+  UniverseDiscoveryIndex()
+      : m_generation(0),
+        m_resync_generation(0) {
+  }
+
+  /*
+   * Set the universes announced by a source, adding it if it's new.
+   * @returns true if anything changed.
+   */
+  bool Update(const CID &cid,
+              const ola::network::IPV4Address &ip_address,
+              const std::string &source_name,
+              const std::set<uint16_t> &universes,
+              const TimeStamp &now);
+
+  /*
+   * Record that we've heard from a source, without changing its universes.
+   */
+  void Seen(const CID &cid, const TimeStamp &now);
+
+  /*
+   * Remove a source.
+   * @returns true if the source was known.
+   */
+  bool Remove(const CID &cid);
+
+  void Lookup(const Query &query, Page *page) const;
+
+  void GetSources(std::vector<Source> *sources) const;
+
+  void GetStats(Stats *stats) const;
+
+  uint64_t Generation() const { return m_generation; }
+
+  // The number of removals remembered for clients catching up.
+  static const unsigned int MAX_REMOVED = 1024;
+
+ private:
+  typedef std::map<CID, Source> SourceMap;
+  typedef std::map<uint16_t, std::set<CID> > UniverseMap;
+
+  SourceMap m_sources;
+  UniverseMap m_universes;
+  // The removed sources, by the generation they were removed in.
+  std::map<uint64_t, CID> m_removed;
+  uint64_t m_generation;
+  // Clients older than this generation have missed some removals.
+  uint64_t m_resync_generation;
+
+  void AddToUniverses(const CID &cid, const std::set<uint16_t> &universes);
+  void RemoveFromUniverses(const CID &cid,
+                           const std::set<uint16_t> &universes);
+  bool AddToPage(const Source &source, const Query &query,
+                 uint64_t since_generation, Page *page) const;
+
+  DISALLOW_COPY_AND_ASSIGN(UniverseDiscoveryIndex);
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_UNIVERSEDISCOVERYINDEX_H_
@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseDiscoveryIndexTest.cpp
+ * Test fixture for the UniverseDiscoveryIndex class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/acn/CID.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/testing/TestUtils.h"
+#include "libs/acn/UniverseDiscoveryIndex.h"
+
+using ola::TimeStamp;
+using ola::acn::CID;
+using ola::acn::UniverseDiscoveryIndex;
+using ola::network::IPV4Address;
+using std::set;
+using std::string;
+using std::vector;
+
+class UniverseDiscoveryIndexTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UniverseDiscoveryIndexTest);
+  CPPUNIT_TEST(testUpdate);
+  CPPUNIT_TEST(testChanges);
+  CPPUNIT_TEST(testPaging);
+  CPPUNIT_TEST(testUniverseFilter);
+  CPPUNIT_TEST(testResync);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+
+  void testUpdate();
+  void testChanges();
+  void testPaging();
+  void testUniverseFilter();
+  void testResync();
+
+ private:
+  UniverseDiscoveryIndex m_index;
+  TimeStamp m_now;
+  // Sorted, so the order matches the index.
+  vector<CID> m_cids;
+
+  bool Update(unsigned int source, uint16_t first, uint16_t last) {
+    set<uint16_t> universes;
+    for (unsigned int universe = first; universe <= last; universe++) {
+      universes.insert(static_cast<uint16_t>(universe));
+    }
+    return m_index.Update(m_cids[source], IPV4Address::Loopback(), "source",
+                          universes, m_now);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UniverseDiscoveryIndexTest);
+
+
+void UniverseDiscoveryIndexTest::setUp() {
+  set<CID> cids;
+  while (cids.size() < 4) {
+    cids.insert(CID::Generate());
+  }
+  m_cids.assign(cids.begin(), cids.end());
+}
+
+
+/*
+ * Check sources are added, updated and removed.
+ */
+void UniverseDiscoveryIndexTest::testUpdate() {
+  OLA_ASSERT_TRUE(Update(0, 1, 3));
+  OLA_ASSERT_TRUE(Update(1, 3, 4));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), m_index.Generation());
+
+  // Nothing changed.
+  OLA_ASSERT_FALSE(Update(0, 1, 3));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), m_index.Generation());
+
+  UniverseDiscoveryIndex::Stats stats;
+  m_index.GetStats(&stats);
+  OLA_ASSERT_EQ(2u, stats.sources);
+  OLA_ASSERT_EQ(4u, stats.universes);
+
+  OLA_ASSERT_TRUE(Update(0, 1, 1));
+  m_index.GetStats(&stats);
+  OLA_ASSERT_EQ(3u, stats.universes);
+
+  OLA_ASSERT_TRUE(m_index.Remove(m_cids[1]));
+  OLA_ASSERT_FALSE(m_index.Remove(m_cids[1]));
+  m_index.GetStats(&stats);
+  OLA_ASSERT_EQ(1u, stats.sources);
+  OLA_ASSERT_EQ(1u, stats.universes);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), stats.generation);
+
+  vector<UniverseDiscoveryIndex::Source> sources;
+  m_index.GetSources(&sources);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), sources.size());
+  OLA_ASSERT(m_cids[0] == sources[0].cid);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), sources[0].universes.size());
+}
+
+
+/*
+ * Check a client can ask for the changes since its last query.
+ */
+void UniverseDiscoveryIndexTest::testChanges() {
+  Update(0, 1, 1);
+  Update(1, 2, 2);
+  Update(2, 3, 3);
+
+  UniverseDiscoveryIndex::Query query;
+  UniverseDiscoveryIndex::Page page;
+  m_index.Lookup(query, &page);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), page.sources.size());
+  OLA_ASSERT_TRUE(page.next.IsNil());
+
+  query.since_generation = page.generation;
+  Update(1, 2, 5);
+  m_index.Remove(m_cids[2]);
+
+  UniverseDiscoveryIndex::Page changes;
+  m_index.Lookup(query, &changes);
+  OLA_ASSERT_FALSE(changes.resync);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changes.sources.size());
+  OLA_ASSERT(m_cids[1] == changes.sources[0].cid);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changes.removed.size());
+  OLA_ASSERT(m_cids[2] == changes.removed[0]);
+
+  // Being seen isn't a change.
+  query.since_generation = changes.generation;
+  m_index.Seen(m_cids[0], m_now);
+  UniverseDiscoveryIndex::Page no_changes;
+  m_index.Lookup(query, &no_changes);
+  OLA_ASSERT_TRUE(no_changes.sources.empty());
+  OLA_ASSERT_TRUE(no_changes.removed.empty());
+}
+
+
+/*
+ * Check the sources can be fetched a page at a time.
+ */
+void UniverseDiscoveryIndexTest::testPaging() {
+  for (unsigned int i = 0; i < m_cids.size(); i++) {
+    Update(i, 1, 1);
+  }
+
+  UniverseDiscoveryIndex::Query query;
+  query.limit = 3;
+  UniverseDiscoveryIndex::Page first;
+  m_index.Lookup(query, &first);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), first.sources.size());
+  OLA_ASSERT(m_cids[2] == first.next);
+
+  query.start_after = first.next;
+  UniverseDiscoveryIndex::Page second;
+  m_index.Lookup(query, &second);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), second.sources.size());
+  OLA_ASSERT(m_cids[3] == second.sources[0].cid);
+  OLA_ASSERT_TRUE(second.next.IsNil());
+
+  // An exactly full page has no next page.
+  query.start_after = CID();
+  query.limit = 4;
+  UniverseDiscoveryIndex::Page all;
+  m_index.Lookup(query, &all);
+  OLA_ASSERT_EQ(static_cast<size_t>(4), all.sources.size());
+  OLA_ASSERT_TRUE(all.next.IsNil());
+}
+
+
+/*
+ * Check the sources for a single universe can be listed.
+ */
+void UniverseDiscoveryIndexTest::testUniverseFilter() {
+  Update(0, 1, 10);
+  Update(1, 5, 5);
+  Update(2, 20, 30);
+  Update(3, 10, 20);
+
+  UniverseDiscoveryIndex::Query query;
+  query.filter_universe = true;
+  query.universe = 10;
+  query.limit = 1;
+  UniverseDiscoveryIndex::Page page;
+  m_index.Lookup(query, &page);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), page.sources.size());
+  OLA_ASSERT(m_cids[0] == page.sources[0].cid);
+  OLA_ASSERT(m_cids[0] == page.next);
+
+  query.start_after = page.next;
+  UniverseDiscoveryIndex::Page next_page;
+  m_index.Lookup(query, &next_page);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), next_page.sources.size());
+  OLA_ASSERT(m_cids[3] == next_page.sources[0].cid);
+  OLA_ASSERT_TRUE(next_page.next.IsNil());
+
+  // Once a source stops sending a universe, it's no longer listed for it.
+  Update(0, 1, 9);
+  query.start_after = CID();
+  query.limit = 0;
+  UniverseDiscoveryIndex::Page updated;
+  m_index.Lookup(query, &updated);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), updated.sources.size());
+  OLA_ASSERT(m_cids[3] == updated.sources[0].cid);
+
+  query.universe = 100;
+  UniverseDiscoveryIndex::Page empty;
+  m_index.Lookup(query, &empty);
+  OLA_ASSERT_TRUE(empty.sources.empty());
+}
+
+
+/*
+ * Check a client that has missed removals is told to start again.
+ */
+void UniverseDiscoveryIndexTest::testResync() {
+  Update(0, 1, 1);
+  UniverseDiscoveryIndex::Query query;
+  query.since_generation = m_index.Generation();
+
+  for (unsigned int i = 0; i <= UniverseDiscoveryIndex::MAX_REMOVED; i++) {
+    Update(1, 1, 1);
+    m_index.Remove(m_cids[1]);
+  }
+
+  UniverseDiscoveryIndex::Page page;
+  m_index.Lookup(query, &page);
+  OLA_ASSERT_TRUE(page.resync);
+  OLA_ASSERT_TRUE(page.removed.empty());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), page.sources.size());
+  OLA_ASSERT(m_cids[0] == page.sources[0].cid);
+
+  // A client that's up to date doesn't need to.
+  query.since_generation = m_index.Generation() - 1;
+  UniverseDiscoveryIndex::Page recent;
+  m_index.Lookup(query, &recent);
+  OLA_ASSERT_FALSE(recent.resync);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), recent.removed.size());
+}
@@ -14,62 +14,545 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  *
  * e131_loadtest.cpp
- * A simple E1.31 load tester
+ * An E1.31 load & soak tester.
  * Copyright (C) 2013 Simon Newton
+ *
+ * This sends N universes from each of M sources, each with its own CID &
+ * priority. Frames can be sent with timing jitter and a percentage can be
+ * dropped, which shows up as sequence gaps at the receiver.
+ *
+ * In receive mode, the universes, offset by --receive_offset, are listened
+ * for and the delivered frame rate, sequence gaps, merge results & latency
+ * are measured. With an offset of 0 this runs both ends in one process,
+ * otherwise olad can be patched in between the two sets of universes to
+ * measure the latency through olad.
+ *
+ * The first slots of each frame carry the source index, a frame counter and
+ * the time the frame was sent. The results are written as JSON.
  */
 
-#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
 #include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Flags.h"
 #include "ola/base/Init.h"
 #include "ola/io/SelectServer.h"
+#include "ola/math/Random.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonWriter.h"
+#include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/E131Node.h"
 
+using ola::Clock;
 using ola::DmxBuffer;
-using ola::io::SelectServer;
-using ola::acn::E131Node;
 using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::acn::DMPE131Inflator;
+using ola::acn::E131Node;
+using ola::io::SelectServer;
+using ola::web::JsonObject;
+using ola::web::JsonWriter;
+using std::auto_ptr;
+using std::max;
 using std::min;
+using std::string;
+using std::vector;
 
 DEFINE_s_uint32(fps, s, 10, "Frames per second per universe [1 - 40]");
 DEFINE_s_uint16(universes, u, 1, "Number of universes to send");
+DEFINE_uint16(start_universe, 1, "The first universe to send");
+DEFINE_uint16(slots, 512, "The number of slots in each frame [13 - 512]");
+DEFINE_uint16(sources, 1, "The number of sources, each with its own CID");
+DEFINE_string(priorities, "100",
+              "A comma separated list of priorities, one per source. The last "
+              "one is used for any remaining sources.");
+DEFINE_uint32(jitter, 0,
+              "Vary the time between frames by up to this many ms");
+DEFINE_uint8(loss, 0, "The percentage of frames to drop [0 - 100]");
+DEFINE_string(mode, "send", "One of send, receive or both");
+DEFINE_uint16(receive_offset, 0,
+              "Receive on the sent universes plus this offset");
+DEFINE_uint32(duration, 0, "Stop after this many seconds, 0 runs forever");
+DEFINE_uint32(report_interval, 0,
+              "Write the results every N seconds, 0 only writes them on exit");
+DEFINE_string(output, "", "Write the results to this file, not stdout");
+
+namespace {
+
+// The layout of the start of each frame.
+const unsigned int SOURCE_SLOT = 0;
+const unsigned int FRAME_SLOT = 1;
+const unsigned int TIME_SLOT = 5;
+const unsigned int PAYLOAD_SIZE = 13;
+
+// Merging isn't checked until a universe has been received for this long, so
+// the sources have all been heard from.
+const TimeInterval MERGE_WARMUP(1, 0);
+
+const uint8_t DEFAULT_PRIORITY = 100;
+const uint8_t MAX_PRIORITY = 200;
+
+SelectServer *ss = NULL;
+
+int64_t AsMicroSeconds(const TimeStamp &timestamp) {
+  return static_cast<int64_t>(timestamp.Seconds()) * 1000000 +
+         timestamp.MicroSeconds();
+}
+
+void PutUInt(uint64_t value, unsigned int size, uint8_t *data) {
+  for (unsigned int i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>(value >> (8 * (size - i - 1)));
+  }
+}
+
+uint64_t GetUInt(const uint8_t *data, unsigned int size) {
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < size; i++) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+void AddUInt64(JsonObject *object, const string &key, uint64_t value) {
+  object->Add(key, static_cast<double>(value));
+}
+
+/**
+ * A source of E1.31 data, this sends all the universes from one CID.
+ */
+class LoadSource {
+ public:
+  LoadSource(SelectServer *ss, uint8_t index, uint8_t priority,
+             uint16_t start_universe, uint16_t universes,
+             unsigned int slots)
+      : m_ss(ss),
+        m_index(index),
+        m_priority(priority),
+        m_start_universe(start_universe),
+        m_node(ss, "", E131Node::Options()),
+        m_frame(0),
+        m_sent(0),
+        m_dropped(0),
+        m_errors(0),
+        m_sequences(universes, 0),
+        m_next_sequences(universes, 0) {
+    m_buffer.SetRangeToValue(0, 0, slots);
+    m_buffer.SetChannel(SOURCE_SLOT, m_index);
+  }
+
+  bool Start() {
+    if (!m_node.Start()) {
+      return false;
+    }
+    ScheduleFrame();
+    return true;
+  }
+
+  void SendFrame();
+
+  uint8_t Priority() const { return m_priority; }
+  uint64_t Sent() const { return m_sent; }
+  uint64_t Dropped() const { return m_dropped; }
+  uint64_t Errors() const { return m_errors; }
+
+ private:
+  SelectServer *m_ss;
+  const uint8_t m_index;
+  const uint8_t m_priority;
+  const uint16_t m_start_universe;
+  E131Node m_node;
+  Clock m_clock;
+  DmxBuffer m_buffer;
+  uint32_t m_frame;
+  uint64_t m_sent;
+  uint64_t m_dropped;
+  uint64_t m_errors;
+  // The sequence number the node will use next, and the one we want to use.
+  vector<uint8_t> m_sequences;
+  vector<uint8_t> m_next_sequences;
+
+  void ScheduleFrame();
+};
+
+
+void LoadSource::ScheduleFrame() {
+  int delay = static_cast<int>(1000 / FLAGS_fps);
+  if (FLAGS_jitter) {
+    const int jitter = static_cast<int>(FLAGS_jitter);
+    delay = max(1, delay + ola::math::Random(-jitter, jitter));
+  }
+  m_ss->RegisterSingleTimeout(
+      delay, NewSingleCallback(this, &LoadSource::SendFrame));
+}
+
+
+void LoadSource::SendFrame() {
+  uint8_t payload[PAYLOAD_SIZE - FRAME_SLOT];
+  PutUInt(m_frame++, TIME_SLOT - FRAME_SLOT, payload);
+
+  for (unsigned int i = 0; i < m_sequences.size(); i++) {
+    m_next_sequences[i]++;
+    if (FLAGS_loss && ola::math::Random(0, 99) < FLAGS_loss) {
+      m_dropped++;
+      continue;
+    }
+
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    PutUInt(AsMicroSeconds(now), PAYLOAD_SIZE - TIME_SLOT,
+            payload + TIME_SLOT - FRAME_SLOT);
+    m_buffer.SetRange(FRAME_SLOT, payload, sizeof(payload));
+
+    // The node only advances its sequence number when the offset is 0, so
+    // this sends the next number we want to use, skipping any for frames
+    // that were dropped.
+    const uint8_t current = static_cast<uint8_t>(m_next_sequences[i] - 1);
+    const int8_t offset = static_cast<int8_t>(current - m_sequences[i]);
+    const uint16_t universe = static_cast<uint16_t>(m_start_universe + i);
+    if (m_node.SendDMXWithSequenceOffset(universe, m_buffer, offset,
+                                         m_priority)) {
+      m_sent++;
+      if (!offset) {
+        m_sequences[i]++;
+      }
+    } else {
+      m_errors++;
+    }
+  }
+  ScheduleFrame();
+}
+
 
 /**
- * Send N DMX frames using E1.31, where N is given by number_of_universes.
+ * Receives the universes and checks what was delivered.
  */
-bool SendFrames(E131Node *node, DmxBuffer *buffer,
-                uint16_t number_of_universes) {
-  for (uint16_t i = 1; i < number_of_universes + 1; i++) {
-    node->SendDMX(i, *buffer);
+class LoadReceiver {
+ public:
+  LoadReceiver(SelectServer *ss, uint16_t start_universe, uint16_t universes,
+               uint8_t expected_source, bool check_latency)
+      : m_ss(ss),
+        m_start_universe(start_universe),
+        m_expected_source(expected_source),
+        m_check_latency(check_latency),
+        m_node(ss, "", E131Node::Options()),
+        m_universes(universes),
+        m_frames(0),
+        m_merge_errors(0),
+        m_latency_samples(0),
+        m_latency_min(0),
+        m_latency_max(0),
+        m_latency_total(0) {
+  }
+
+  ~LoadReceiver() {
+    ola::STLDeleteElements(&m_universes);
+  }
+
+  bool Start();
+  void AddResults(JsonObject *results, const TimeInterval &elapsed);
+
+ private:
+  struct UniverseState {
+    DmxBuffer buffer;
+    uint8_t priority;
+    TimeStamp first_frame;
+  };
+
+  SelectServer *m_ss;
+  const uint16_t m_start_universe;
+  const uint8_t m_expected_source;
+  const bool m_check_latency;
+  E131Node m_node;
+  Clock m_clock;
+  vector<UniverseState*> m_universes;
+  uint64_t m_frames;
+  uint64_t m_merge_errors;
+  uint64_t m_latency_samples;
+  int64_t m_latency_min;
+  int64_t m_latency_max;
+  int64_t m_latency_total;
+
+  void NewData(unsigned int index);
+};
+
+
+bool LoadReceiver::Start() {
+  if (!m_node.Start()) {
+    return false;
+  }
+  m_ss->AddReadDescriptor(m_node.GetSocket());
+
+  for (unsigned int i = 0; i < m_universes.size(); i++) {
+    m_universes[i] = new UniverseState();
+    m_universes[i]->priority = 0;
+    m_node.SetHandler(static_cast<uint16_t>(m_start_universe + i),
+                      &m_universes[i]->buffer, &m_universes[i]->priority,
+                      NewCallback(this, &LoadReceiver::NewData, i));
   }
   return true;
 }
 
+
+void LoadReceiver::AddResults(JsonObject *results,
+                              const TimeInterval &elapsed) {
+  uint64_t sequence_gaps = 0;
+  uint64_t out_of_order = 0;
+  vector<DMPE131Inflator::SourceStats> stats;
+  for (unsigned int i = 0; i < m_universes.size(); i++) {
+    stats.clear();
+    m_node.GetSourceStatistics(static_cast<uint16_t>(m_start_universe + i),
+                               &stats);
+    vector<DMPE131Inflator::SourceStats>::const_iterator iter = stats.begin();
+    for (; iter != stats.end(); ++iter) {
+      sequence_gaps += iter->sequence_gaps;
+      out_of_order += iter->out_of_order;
+    }
+  }
+
+  JsonObject *received = results->AddObject("received");
+  AddUInt64(received, "frames", m_frames);
+  const int64_t elapsed_ms = elapsed.InMilliSeconds();
+  received->Add("fps", elapsed_ms ?
+      static_cast<double>(m_frames) * 1000 / static_cast<double>(elapsed_ms) :
+      0.0);
+  AddUInt64(received, "sequence_gaps", sequence_gaps);
+  AddUInt64(received, "out_of_order", out_of_order);
+  AddUInt64(received, "merge_errors", m_merge_errors);
+
+  JsonObject *latency = received->AddObject("latency_us");
+  AddUInt64(latency, "samples", m_latency_samples);
+  if (m_latency_samples) {
+    latency->Add("min", static_cast<double>(m_latency_min));
+    latency->Add("mean", static_cast<double>(m_latency_total) /
+                         static_cast<double>(m_latency_samples));
+    latency->Add("max", static_cast<double>(m_latency_max));
+  }
+}
+
+
+void LoadReceiver::NewData(unsigned int index) {
+  UniverseState *state = m_universes[index];
+  m_frames++;
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  if (state->buffer.Size() < PAYLOAD_SIZE) {
+    return;
+  }
+
+  if (!state->first_frame.IsSet()) {
+    state->first_frame = now;
+  } else if (now - state->first_frame > MERGE_WARMUP &&
+             state->buffer.Get(SOURCE_SLOT) != m_expected_source) {
+    m_merge_errors++;
+  }
+
+  // If more than one source has the highest priority the slots are HTP
+  // merged, so the send time isn't valid.
+  if (!m_check_latency) {
+    return;
+  }
+  TimeStamp received = m_node.ReceiveTime();
+  if (!received.IsSet()) {
+    received = now;
+  }
+  const int64_t sent = static_cast<int64_t>(
+      GetUInt(state->buffer.GetRaw() + TIME_SLOT, PAYLOAD_SIZE - TIME_SLOT));
+  const int64_t latency = AsMicroSeconds(received) - sent;
+  if (!m_latency_samples) {
+    m_latency_min = latency;
+    m_latency_max = latency;
+  } else {
+    m_latency_min = min(m_latency_min, latency);
+    m_latency_max = max(m_latency_max, latency);
+  }
+  m_latency_total += latency;
+  m_latency_samples++;
+}
+
+
+/**
+ * Holds the sources & receiver for a run.
+ */
+struct LoadTest {
+  vector<LoadSource*> sources;
+  auto_ptr<LoadReceiver> receiver;
+  TimeStamp start_time;
+};
+
+
+void WriteResults(const LoadTest *test, bool final_results) {
+  Clock clock;
+  TimeStamp now;
+  clock.CurrentTime(&now);
+  const TimeInterval elapsed = now - test->start_time;
+
+  JsonObject results;
+  results.Add("final", final_results);
+  results.Add("elapsed_ms", static_cast<double>(elapsed.InMilliSeconds()));
+  results.Add("universes", static_cast<unsigned int>(FLAGS_universes));
+  results.Add("sources", static_cast<unsigned int>(FLAGS_sources));
+  results.Add("fps", static_cast<unsigned int>(FLAGS_fps));
+
+  if (!test->sources.empty()) {
+    uint64_t sent = 0, dropped = 0, errors = 0;
+    vector<LoadSource*>::const_iterator iter = test->sources.begin();
+    for (; iter != test->sources.end(); ++iter) {
+      sent += (*iter)->Sent();
+      dropped += (*iter)->Dropped();
+      errors += (*iter)->Errors();
+    }
+    JsonObject *sent_results = results.AddObject("sent");
+    AddUInt64(sent_results, "frames", sent);
+    AddUInt64(sent_results, "dropped", dropped);
+    AddUInt64(sent_results, "errors", errors);
+  }
+
+  if (test->receiver.get()) {
+    test->receiver->AddResults(&results, elapsed);
+  }
+
+  const string output = JsonWriter::AsString(results);
+  if (FLAGS_output.str().empty()) {
+    std::cout << output << std::endl;
+  } else {
+    std::ofstream file(FLAGS_output.str().c_str());
+    file << output << std::endl;
+  }
+}
+
+
+bool WritePeriodicResults(const LoadTest *test) {
+  WriteResults(test, false);
+  return true;
+}
+
+
+/*
+ * Parse the priorities flag, one for each source.
+ */
+bool GetPriorities(vector<uint8_t> *priorities) {
+  vector<string> tokens;
+  ola::StringSplit(FLAGS_priorities.str(), &tokens, ",");
+  uint8_t priority = DEFAULT_PRIORITY;
+  for (unsigned int i = 0; i < FLAGS_sources; i++) {
+    if (i < tokens.size() &&
+        (!ola::StringToInt(tokens[i], &priority) ||
+         priority > MAX_PRIORITY)) {
+      OLA_WARN << "Invalid priority " << tokens[i];
+      return false;
+    }
+    priorities->push_back(priority);
+  }
+  return true;
+}
+
+
+static void InteruptSignal(OLA_UNUSED int signo) {
+  int old_errno = errno;
+  if (ss) {
+    ss->Terminate();
+  }
+  errno = old_errno;
+}
+}  // namespace
+
 int main(int argc, char* argv[]) {
   ola::AppInit(&argc, argv, "", "Run the E1.31 load test.");
 
-  if (FLAGS_universes == 0 || FLAGS_fps == 0)
+  const string mode = FLAGS_mode.str();
+  const bool send = mode == "send" || mode == "both";
+  const bool receive = mode == "receive" || mode == "both";
+  if (FLAGS_universes == 0 || FLAGS_fps == 0 || FLAGS_sources == 0 ||
+      FLAGS_sources > 255 || FLAGS_loss > 100 ||
+      FLAGS_slots < PAYLOAD_SIZE || FLAGS_slots > ola::DMX_UNIVERSE_SIZE ||
+      (!send && !receive)) {
+    ola::DisplayUsage();
     return -1;
+  }
 
-  unsigned int fps = min(40u, static_cast<unsigned int>(FLAGS_fps));
-  uint16_t universes = FLAGS_universes;
+  FLAGS_fps = min(40u, static_cast<unsigned int>(FLAGS_fps));
+  vector<uint8_t> priorities;
+  if (!GetPriorities(&priorities)) {
+    return -1;
+  }
 
-  DmxBuffer output;
-  output.Blackout();
-  SelectServer ss;
+  // The slots are HTP merged between the sources with the highest priority, so
+  // the highest index of those ends up in the source slot.
+  const uint8_t max_priority = *std::max_element(priorities.begin(),
+                                                 priorities.end());
+  uint8_t expected_source = 0;
+  unsigned int winners = 0;
+  for (unsigned int i = 0; i < priorities.size(); i++) {
+    if (priorities[i] == max_priority) {
+      expected_source = static_cast<uint8_t>(i + 1);
+      winners++;
+    }
+  }
 
-  E131Node node(&ss, "", E131Node::Options());
-  if (!node.Start())
-    return -1;
+  ola::math::InitRandom();
+  SelectServer select_server;
+  ss = &select_server;
+  LoadTest test;
+
+  if (receive) {
+    test.receiver.reset(new LoadReceiver(
+        &select_server,
+        static_cast<uint16_t>(FLAGS_start_universe + FLAGS_receive_offset),
+        FLAGS_universes, expected_source, winners == 1));
+    if (!test.receiver->Start()) {
+      return -1;
+    }
+  }
+
+  if (send) {
+    for (unsigned int i = 0; i < FLAGS_sources; i++) {
+      LoadSource *source = new LoadSource(
+          &select_server, static_cast<uint8_t>(i + 1), priorities[i],
+          FLAGS_start_universe, FLAGS_universes, FLAGS_slots);
+      test.sources.push_back(source);
+      if (!source->Start()) {
+        ola::STLDeleteElements(&test.sources);
+        return -1;
+      }
+    }
+  }
 
-  ss.AddReadDescriptor(node.GetSocket());
-  ss.RegisterRepeatingTimeout(
-      1000 / fps,
-      NewCallback(&SendFrames, &node, &output, universes));
+  if (FLAGS_duration) {
+    select_server.RegisterSingleTimeout(
+        FLAGS_duration * 1000,
+        NewSingleCallback(&select_server, &SelectServer::Terminate));
+  }
+  if (FLAGS_report_interval) {
+    select_server.RegisterRepeatingTimeout(
+        FLAGS_report_interval * 1000,
+        NewCallback(&WritePeriodicResults,
+                    static_cast<const LoadTest*>(&test)));
+  }
+  ola::InstallSignal(SIGINT, InteruptSignal);
+
+  Clock clock;
+  clock.CurrentTime(&test.start_time);
   OLA_INFO << "Starting loadtester...";
-  ss.Run();
+  select_server.Run();
+
+  WriteResults(&test, true);
+  ss = NULL;
+  ola::STLDeleteElements(&test.sources);
+  return 0;
 }
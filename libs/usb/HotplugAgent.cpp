@@ -58,11 +58,16 @@ int LIBUSB_CALL hotplug_callback(OLA_UNUSED struct libusb_context *ctx,
 }  // namespace
 
 HotplugAgent::HotplugAgent(NotificationCallback* notification_cb,
-                           int debug_level)
+                           int debug_level,
+                           const ola::thread::SchedulingOptions &scheduling,
+                           ola::io::SelectServerInterface *ss)
     : m_notification_cb(notification_cb),
       m_debug_level(debug_level),
+      m_scheduling(scheduling),
+      m_ss(ss),
       m_use_hotplug(false),
       m_context(NULL),
+      m_scanner_timeout(ola::thread::INVALID_TIMEOUT),
       m_suppress_hotplug_events(false) {
 }
 
@@ -86,15 +91,33 @@ bool HotplugAgent::Init() {
 
   m_use_hotplug = ola::usb::LibUsbAdaptor::HotplugSupported();
   OLA_DEBUG << "HotplugSupported(): " << m_use_hotplug;
+  if (m_ss && !LibUsbSelectServerThread::PollFdsSupported(m_context)) {
+    OLA_WARN << "libusb doesn't support pollfds on this platform, using a "
+             << "dedicated thread for libusb events";
+    m_ss = NULL;
+  }
+
+  if (m_ss) {
+    LibUsbSelectServerThread *thread = new LibUsbSelectServerThread(m_context,
+                                                                    m_ss);
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+    if (m_use_hotplug) {
+      thread->SetHotplugCallback(hotplug_callback, this);
+    }
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+    m_usb_thread.reset(thread);
+  }
+
 #ifdef HAVE_LIBUSB_HOTPLUG_API
-  if (m_use_hotplug) {
+  if (m_use_hotplug && !m_usb_thread.get()) {
     m_usb_thread.reset(new ola::usb::LibUsbHotplugThread(
-          m_context, hotplug_callback, this));
+          m_context, hotplug_callback, this, m_scheduling));
   }
 #endif  // HAVE_LIBUSB_HOTPLUG_API
 
   if (!m_usb_thread.get()) {
-    m_usb_thread.reset(new ola::usb::LibUsbSimpleThread(m_context));
+    m_usb_thread.reset(new ola::usb::LibUsbSimpleThread(m_context,
+                                                        m_scheduling));
   }
   m_usb_adaptor.reset(
       new ola::usb::AsyncronousLibUsbAdaptor(m_usb_thread.get()));
@@ -113,9 +136,16 @@ bool HotplugAgent::Start() {
     // Either we don't support hotplug or the setup failed.
     // As poor man's hotplug, we call libusb_get_device_list periodically to
     // check for new devices.
-    m_scanner_thread.reset(new ola::thread::PeriodicThread(
+    if (m_ss) {
+      ScanUSBDevices();
+      m_scanner_timeout = m_ss->RegisterRepeatingTimeout(
           TimeInterval(5, 0),
-          NewCallback(this, &HotplugAgent::ScanUSBDevices)));
+          NewCallback(this, &HotplugAgent::ScanUSBDevices));
+    } else {
+      m_scanner_thread.reset(new ola::thread::PeriodicThread(
+            TimeInterval(5, 0),
+            NewCallback(this, &HotplugAgent::ScanUSBDevices)));
+    }
   }
   return true;
 }
@@ -128,6 +158,10 @@ void HotplugAgent::HaltNotifications() {
   if (m_scanner_thread.get()) {
     m_scanner_thread->Stop();
   }
+  if (m_scanner_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_scanner_timeout);
+    m_scanner_timeout = ola::thread::INVALID_TIMEOUT;
+  }
 
   {
     ola::thread::MutexLocker locker(&m_mutex);
@@ -142,7 +176,8 @@ bool HotplugAgent::Stop() {
 
   m_devices.clear();
 
-  // Stop the usb_thread (if using hotplug, otherwise this is a noop).
+  // Stop the usb_thread (if using hotplug or a SelectServer, otherwise this
+  // is a noop).
   m_usb_thread->Shutdown();
 
   m_usb_thread.reset();
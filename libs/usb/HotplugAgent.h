@@ -24,6 +24,7 @@
 #include <libusb.h>
 #include <ola/Callback.h>
 #include <ola/thread/PeriodicThread.h>
+#include <ola/thread/Utils.h>
 
 #include <map>
 #include <memory>
@@ -41,6 +42,10 @@ namespace usb {
  * The HotplugAgent will run a callback when a USB device is added or removed.
  * On systems with libusb >= 1.0.16 which also support hotplug we'll use the
  * Hotplug API, otherwise we'll periodically check for devices.
+ *
+ * If a SelectServer is provided, libusb events are handled in the
+ * SelectServer's thread and the device checks are run as a timeout on it,
+ * so no threads are started.
  */
 class HotplugAgent {
  public:
@@ -56,6 +61,8 @@ class HotplugAgent {
    *
    * The callback can be run in either the thread calling Start() or from
    * an internal hotplug thread. However it won't be called from both at once.
+   * If a SelectServer was provided, it's always run in the SelectServer's
+   * thread.
    */
   typedef ola::Callback2<void, EventType, struct libusb_device*>
       NotificationCallback;
@@ -65,9 +72,18 @@ class HotplugAgent {
    * @param notification_cb The callback to run when the device is added or
    *   removed. Ownership is transferred.
    * @param debug_level The libusb debug level.
+   * @param scheduling The scheduling options for the libusb thread.
+   * @param ss If not NULL, handle libusb events on this SelectServer rather
+   *   than a dedicated thread. Ownership is not transferred. The
+   *   HotplugAgent must then be used from the SelectServer's thread. If
+   *   libusb can't provide file descriptors on this platform, a dedicated
+   *   thread is used instead, see UsesEventLoop().
    */
   HotplugAgent(NotificationCallback* notification_cb,
-               int debug_level);
+               int debug_level,
+               const ola::thread::SchedulingOptions &scheduling =
+                   ola::thread::SchedulingOptions(),
+               ola::io::SelectServerInterface *ss = NULL);
 
   /**
    * @brief Destructor.
@@ -85,6 +101,13 @@ class HotplugAgent {
    */
   AsyncronousLibUsbAdaptor *GetUSBAdaptor() const;
 
+  /**
+   * @brief Check if libusb events are handled on the SelectServer.
+   * @returns true if the SelectServer passed to the constructor is used.
+   * @pre Must be called after Init()
+   */
+  bool UsesEventLoop() const { return m_ss != NULL; }
+
   /**
    * @brief Initialize the hotplug agent.
    * @returns true if the agent started correctly, false otherwise.
@@ -134,11 +157,14 @@ class HotplugAgent {
 
   std::auto_ptr<NotificationCallback> const m_notification_cb;
   const int m_debug_level;
+  const ola::thread::SchedulingOptions m_scheduling;
+  ola::io::SelectServerInterface *m_ss;
   bool m_use_hotplug;
   libusb_context *m_context;
   std::auto_ptr<ola::usb::LibUsbThread> m_usb_thread;
   std::auto_ptr<ola::usb::AsyncronousLibUsbAdaptor> m_usb_adaptor;
   std::auto_ptr<ola::thread::PeriodicThread> m_scanner_thread;
+  ola::thread::timeout_id m_scanner_timeout;
 
   ola::thread::Mutex m_mutex;
   bool m_suppress_hotplug_events;  // GUARDED_BY(m_mutex);
@@ -147,7 +173,8 @@ class HotplugAgent {
   // m_suppress_hotplug_events is false.
   // In non-hotplug mode, this is only accessed from the scanner thread, unless
   // the thread is no longer running in which case it's accessed from the main
-  // thread during cleanup
+  // thread during cleanup. With a SelectServer, it's only accessed from the
+  // SelectServer's thread.
   DeviceMap m_devices;
 
   bool HotplugSupported();
@@ -37,7 +37,7 @@ JaRulePortHandle::JaRulePortHandle(class JaRuleWidgetPort *parent_port,
                                    const ola::rdm::UID &uid,
                                    uint8_t physical_port)
   : m_impl(new JaRulePortHandleImpl(parent_port, uid, physical_port)),
-    m_queueing_controller(m_impl.get(), RDM_QUEUE_SIZE) {
+    m_queueing_controller(m_impl.get(), RDM_QUEUE_SIZE, RDM_MAX_IN_FLIGHT) {
 }
 
 JaRulePortHandle::~JaRulePortHandle() {
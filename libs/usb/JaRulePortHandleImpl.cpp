@@ -104,15 +104,16 @@ void JaRulePortHandleImpl::SendRDMRequest(RDMRequest *request,
   request->SetPortId(m_physical_port + 1);
   request->SetTransactionNumber(m_transaction_number.Next());
 
-  ByteString frame;
-  if (!RDMCommandSerializer::Pack(*request, &frame)) {
+  uint8_t frame[RDMCommandSerializer::MAX_PACKED_SIZE];
+  unsigned int frame_size = sizeof(frame);
+  if (!RDMCommandSerializer::Pack(*request, frame, &frame_size)) {
     RunRDMCallback(on_complete, ola::rdm::RDM_FAILED_TO_SEND);
     delete request;
     return;
   }
 
   m_port->SendCommand(
-      GetCommandFromRequest(request), frame.data(), frame.size(),
+      GetCommandFromRequest(request), frame, frame_size,
       NewSingleCallback(this, &JaRulePortHandleImpl::RDMComplete,
                         static_cast<const RDMRequest*>(request), on_complete));
 }
@@ -124,10 +125,11 @@ void JaRulePortHandleImpl::MuteDevice(const UID &target,
                                m_transaction_number.Next(),
                                m_physical_port + 1));
 
-  ByteString frame;
-  RDMCommandSerializer::Pack(*request, &frame);
+  uint8_t frame[RDMCommandSerializer::MAX_PACKED_SIZE];
+  unsigned int frame_size = sizeof(frame);
+  RDMCommandSerializer::Pack(*request, frame, &frame_size);
   m_port->SendCommand(
-      JARULE_CMD_RDM_REQUEST, frame.data(), frame.size(),
+      JARULE_CMD_RDM_REQUEST, frame, frame_size,
       NewSingleCallback(this, &JaRulePortHandleImpl::MuteDeviceComplete,
                         mute_complete));
 }
@@ -138,10 +140,11 @@ void JaRulePortHandleImpl::UnMuteAll(UnMuteDeviceCallback *unmute_complete) {
                                  m_transaction_number.Next(),
                                  m_physical_port + 1));
 
-  ByteString frame;
-  RDMCommandSerializer::Pack(*request, &frame);
+  uint8_t frame[RDMCommandSerializer::MAX_PACKED_SIZE];
+  unsigned int frame_size = sizeof(frame);
+  RDMCommandSerializer::Pack(*request, frame, &frame_size);
   m_port->SendCommand(
-      JARULE_CMD_RDM_BROADCAST_REQUEST, frame.data(), frame.size(),
+      JARULE_CMD_RDM_BROADCAST_REQUEST, frame, frame_size,
       NewSingleCallback(this, &JaRulePortHandleImpl::UnMuteDeviceComplete,
                         unmute_complete));
 }
@@ -153,11 +156,12 @@ void JaRulePortHandleImpl::Branch(const UID &lower,
       ola::rdm::NewDiscoveryUniqueBranchRequest(m_uid, lower, upper,
                                                 m_transaction_number.Next()));
 
-  ByteString frame;
-  RDMCommandSerializer::Pack(*request, &frame);
+  uint8_t frame[RDMCommandSerializer::MAX_PACKED_SIZE];
+  unsigned int frame_size = sizeof(frame);
+  RDMCommandSerializer::Pack(*request, frame, &frame_size);
   OLA_INFO << "Sending RDM DUB: " << lower << " - " << upper;
   m_port->SendCommand(
-      JARULE_CMD_RDM_DUB_REQUEST, frame.data(), frame.size(),
+      JARULE_CMD_RDM_DUB_REQUEST, frame, frame_size,
       NewSingleCallback(this, &JaRulePortHandleImpl::DUBComplete,
                         branch_complete));
 }
@@ -70,7 +70,8 @@ JaRuleWidget::JaRuleWidget(ola::thread::ExecutorInterface *executor,
     m_adaptor(adaptor),
     m_device(usb_device),
     m_usb_handle(NULL),
-    m_uid(0, 0) {
+    m_uid(0, 0),
+    m_frame_depth(0) {
   m_adaptor->RefDevice(m_device);
 }
 
@@ -138,6 +139,28 @@ void JaRuleWidget::ReleasePort(uint8_t port_index) {
   m_ports[port_index]->ReleasePort();
 }
 
+void JaRuleWidget::BeginFrame() {
+  if (m_frame_depth++) {
+    return;
+  }
+  PortHandles::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    (*iter)->HoldCommands();
+  }
+}
+
+void JaRuleWidget::EndFrame() {
+  if (!m_frame_depth || --m_frame_depth) {
+    return;
+  }
+  // The ports use separate endpoints, so this is one transfer per port, but
+  // they're all submitted in a single pass.
+  PortHandles::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    (*iter)->ReleaseCommands();
+  }
+}
+
 void JaRuleWidget::SendCommand(uint8_t port_index,
                                CommandClass command,
                                const uint8_t *data,
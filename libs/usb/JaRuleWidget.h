@@ -138,6 +138,21 @@ class JaRuleWidget {
    */
   void ReleasePort(uint8_t port_index);
 
+  /**
+   * @brief Start a frame.
+   *
+   * Commands sent to any port are held until the matching EndFrame(), and
+   * then submitted together, so the DMX frames for all the ports go out
+   * back to back and stay aligned in time. Each port's completions are still
+   * delivered to its own callbacks. Frames nest.
+   */
+  void BeginFrame();
+
+  /**
+   * @brief End a frame, and submit the commands held since BeginFrame().
+   */
+  void EndFrame();
+
   /**
    * @brief The low level API to send a command to the widget.
    * @param port_index The port on which to send the command.
@@ -165,6 +180,7 @@ class JaRuleWidget {
   std::string m_manufacturer;
   std::string m_product;
   PortHandles m_ports;  // The list of port handles.
+  unsigned int m_frame_depth;
 
   bool InternalInit();
 
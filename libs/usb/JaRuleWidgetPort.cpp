@@ -80,6 +80,7 @@ JaRuleWidgetPort::JaRuleWidgetPort(ola::thread::ExecutorInterface *executor,
       m_handle(NULL),
       m_out_transfer(adaptor->AllocTransfer(0)),
       m_out_in_progress(false),
+      m_hold_commands(false),
       m_in_transfer(adaptor->AllocTransfer(0)),
       m_in_in_progress(false) {
 }
@@ -117,8 +118,13 @@ JaRuleWidgetPort::~JaRuleWidgetPort() {
   bool transfers_pending = true;
   while (transfers_pending) {
     // Spin waiting for the transfers to complete.
-    MutexLocker locker(&m_mutex);
-    transfers_pending = m_out_in_progress || m_in_in_progress;
+    {
+      MutexLocker locker(&m_mutex);
+      transfers_pending = m_out_in_progress || m_in_in_progress;
+    }
+    if (transfers_pending) {
+      m_adaptor->HandlePendingEvents();
+    }
   }
 
   if (m_out_transfer) {
@@ -244,6 +250,17 @@ void JaRuleWidgetPort::SendCommand(
   MaybeSendCommand();
 }
 
+void JaRuleWidgetPort::HoldCommands() {
+  MutexLocker locker(&m_mutex);
+  m_hold_commands = true;
+}
+
+void JaRuleWidgetPort::ReleaseCommands() {
+  MutexLocker locker(&m_mutex);
+  m_hold_commands = false;
+  MaybeSendCommand();
+}
+
 void JaRuleWidgetPort::_OutTransferComplete() {
   OLA_DEBUG << "Out Command status is "
             << LibUsbAdaptor::ErrorCodeToString(m_in_transfer->status);
@@ -293,7 +310,7 @@ void JaRuleWidgetPort::_InTransferComplete() {
 }
 
 void JaRuleWidgetPort::MaybeSendCommand() {
-  if (m_out_in_progress ||
+  if (m_out_in_progress || m_hold_commands ||
       m_pending_commands.size() > MAX_IN_FLIGHT ||
       m_queued_commands.empty()) {
     return;
@@ -101,6 +101,19 @@ class JaRuleWidgetPort {
                    unsigned int size,
                    CommandCompleteCallback *callback);
 
+  /**
+   * @brief Hold new commands in the queue until ReleaseCommands() is called.
+   *
+   * JaRuleWidget uses this to submit the DMX frames for all of its ports
+   * together.
+   */
+  void HoldCommands();
+
+  /**
+   * @brief Send the commands held since HoldCommands() was called.
+   */
+  void ReleaseCommands();
+
   /**
    * @brief Called by the libusb callback when the transfer completes or is
    * cancelled.
@@ -164,6 +177,7 @@ class JaRuleWidgetPort {
 
   libusb_transfer *m_out_transfer;  // GUARDED_BY(m_mutex);
   bool m_out_in_progress;  // GUARDED_BY(m_mutex);
+  bool m_hold_commands;  // GUARDED_BY(m_mutex);
 
   uint8_t m_in_buffer[IN_BUFFER_SIZE];  // GUARDED_BY(m_mutex);
   libusb_transfer *m_in_transfer;  // GUARDED_BY(m_mutex);
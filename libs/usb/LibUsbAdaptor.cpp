@@ -396,6 +396,10 @@ void AsyncronousLibUsbAdaptor::Close(libusb_device_handle *handle) {
   m_thread->CloseHandle(handle);
 }
 
+void AsyncronousLibUsbAdaptor::HandlePendingEvents() {
+  m_thread->HandlePendingEvents();
+}
+
 int AsyncronousLibUsbAdaptor::ControlTransfer(
     OLA_UNUSED libusb_device_handle *dev_handle,
     OLA_UNUSED uint8_t bmRequestType,
@@ -229,6 +229,15 @@ class LibUsbAdaptor {
    */
   virtual int CancelTransfer(struct libusb_transfer *transfer) = 0;
 
+  /**
+   * @brief Handle pending libusb events, if they are handled by the calling
+   * thread.
+   *
+   * This should be called when waiting for transfers to complete, otherwise
+   * the wait never ends if the completions run on the waiting thread.
+   */
+  virtual void HandlePendingEvents() {}
+
   /**
    * @brief Wraps libusb_fill_control_setup
    * @param[out] buffer buffer to output the setup packet into
@@ -575,6 +584,8 @@ class AsyncronousLibUsbAdaptor : public BaseLibUsbAdaptor {
 
   void Close(libusb_device_handle *usb_handle);
 
+  void HandlePendingEvents();
+
   int ControlTransfer(libusb_device_handle *dev_handle,
                       uint8_t bmRequestType,
                       uint8_t bRequest,
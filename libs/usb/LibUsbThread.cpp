@@ -20,7 +20,13 @@
 
 #include "libs/usb/LibUsbThread.h"
 
+#ifndef _WIN32
+#include <poll.h>
+#endif  // _WIN32
+#include <stdlib.h>
+
 #include "libs/usb/LibUsbAdaptor.h"
+#include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
@@ -28,11 +34,28 @@
 namespace ola {
 namespace usb {
 
+using ola::io::UnmanagedFileDescriptor;
+
+namespace {
+void LIBUSB_CALL pollfd_added(int fd, short events, void *user_data) {
+  LibUsbSelectServerThread *thread =
+      reinterpret_cast<LibUsbSelectServerThread*>(user_data);
+  thread->PollFdAdded(fd, events);
+}
+
+void LIBUSB_CALL pollfd_removed(int fd, void *user_data) {
+  LibUsbSelectServerThread *thread =
+      reinterpret_cast<LibUsbSelectServerThread*>(user_data);
+  thread->PollFdRemoved(fd);
+}
+}  // namespace
+
 // LibUsbThread
 // -----------------------------------------------------------------------------
 
 void *LibUsbThread::Run() {
   OLA_INFO << "----libusb event thread is running";
+  ola::thread::ApplySchedulingOptions(m_scheduling, "libusb thread");
   while (1) {
     {
       ola::thread::MutexLocker locker(&m_term_mutex);
@@ -60,11 +83,13 @@ void LibUsbThread::JoinThread() {
 // LibUsbHotplugThread
 // -----------------------------------------------------------------------------
 
-#if HAVE_LIBUSB_HOTPLUG_API
-LibUsbHotplugThread::LibUsbHotplugThread(libusb_context *context,
-                                         libusb_hotplug_callback_fn callback_fn,
-                                         void *user_data)
-    : LibUsbThread(context),
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+LibUsbHotplugThread::LibUsbHotplugThread(
+    libusb_context *context,
+    libusb_hotplug_callback_fn callback_fn,
+    void *user_data,
+    const ola::thread::SchedulingOptions &scheduling)
+    : LibUsbThread(context, scheduling),
       m_hotplug_handle(0),
       m_callback_fn(callback_fn),
       m_user_data(user_data) {
@@ -126,5 +151,184 @@ void LibUsbSimpleThread::CloseHandle(libusb_device_handle *handle) {
   }
   m_device_count--;
 }
+
+// LibUsbSelectServerThread
+// -----------------------------------------------------------------------------
+
+LibUsbSelectServerThread::LibUsbSelectServerThread(
+    libusb_context *context,
+    ola::io::SelectServerInterface *ss)
+    : LibUsbThread(context),
+      m_ss(ss),
+      m_timeout_id(ola::thread::INVALID_TIMEOUT),
+      m_running(false) {
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+  m_hotplug_handle = 0;
+  m_callback_fn = NULL;
+  m_user_data = NULL;
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+}
+
+LibUsbSelectServerThread::~LibUsbSelectServerThread() {
+  Shutdown();
+}
+
+bool LibUsbSelectServerThread::Init() {
+  // Set the notifiers first, so we don't miss descriptors added in between.
+  libusb_set_pollfd_notifiers(Context(), pollfd_added, pollfd_removed, this);
+  const struct libusb_pollfd **pollfds = libusb_get_pollfds(Context());
+  if (!pollfds) {
+    OLA_WARN << "libusb doesn't support pollfds on this platform";
+    libusb_set_pollfd_notifiers(Context(), NULL, NULL, NULL);
+    return false;
+  }
+
+  for (const struct libusb_pollfd **pollfd = pollfds; *pollfd; pollfd++) {
+    PollFdAdded((*pollfd)->fd, (*pollfd)->events);
+  }
+  // libusb_free_pollfds() is only available from 1.0.20.
+  free(pollfds);
+
+  if (!libusb_pollfds_handle_timeouts(Context())) {
+    m_timeout_id = m_ss->RegisterRepeatingTimeout(
+        TIMEOUT_CHECK_INTERVAL_MS,
+        NewCallback(this, &LibUsbSelectServerThread::CheckTimeouts));
+  }
+  m_running = true;
+
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+  if (m_callback_fn) {
+    int rc = libusb_hotplug_register_callback(
+        Context(),
+        static_cast<libusb_hotplug_event>(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                          LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+        LIBUSB_HOTPLUG_ENUMERATE, LIBUSB_HOTPLUG_MATCH_ANY,
+        LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+        m_callback_fn, m_user_data, &m_hotplug_handle);
+
+    if (LIBUSB_SUCCESS != rc) {
+      OLA_WARN << "Error creating a hotplug callback "
+               << LibUsbAdaptor::ErrorCodeToString(rc);
+      m_callback_fn = NULL;
+      Shutdown();
+      return false;
+    }
+  }
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+  return true;
+}
+
+void LibUsbSelectServerThread::Shutdown() {
+  if (!m_running) {
+    return;
+  }
+
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+  if (m_callback_fn) {
+    libusb_hotplug_deregister_callback(Context(), m_hotplug_handle);
+  }
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+
+  libusb_set_pollfd_notifiers(Context(), NULL, NULL, NULL);
+  if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_timeout_id);
+    m_timeout_id = ola::thread::INVALID_TIMEOUT;
+  }
+
+  DescriptorMap::iterator iter = m_descriptors.begin();
+  for (; iter != m_descriptors.end(); ++iter) {
+    RemoveDescriptor(iter->second);
+  }
+  m_descriptors.clear();
+  DeleteRemovedDescriptors();
+  m_running = false;
+}
+
+void LibUsbSelectServerThread::CloseHandle(libusb_device_handle *handle) {
+  libusb_close(handle);
+}
+
+void LibUsbSelectServerThread::HandlePendingEvents() {
+  struct timeval tv = {0, PENDING_EVENTS_TIMEOUT_MS * 1000};
+  libusb_handle_events_timeout_completed(Context(), &tv, NULL);
+}
+
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+void LibUsbSelectServerThread::SetHotplugCallback(
+    libusb_hotplug_callback_fn callback_fn,
+    void *user_data) {
+  m_callback_fn = callback_fn;
+  m_user_data = user_data;
+}
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+
+bool LibUsbSelectServerThread::PollFdsSupported(libusb_context *context) {
+  const struct libusb_pollfd **pollfds = libusb_get_pollfds(context);
+  if (!pollfds) {
+    return false;
+  }
+  free(pollfds);
+  return true;
+}
+
+void LibUsbSelectServerThread::PollFdAdded(int fd, short events) {
+  if (STLContains(m_descriptors, fd)) {
+    return;
+  }
+
+  PollDescriptor poll_descriptor;
+  poll_descriptor.descriptor = new UnmanagedFileDescriptor(fd);
+  poll_descriptor.events = events;
+
+  if (events & POLLIN) {
+    poll_descriptor.descriptor->SetOnData(
+        NewCallback(this, &LibUsbSelectServerThread::HandleEvents));
+    m_ss->AddReadDescriptor(poll_descriptor.descriptor);
+  }
+  if (events & POLLOUT) {
+    poll_descriptor.descriptor->SetOnWritable(
+        NewCallback(this, &LibUsbSelectServerThread::HandleEvents));
+    m_ss->AddWriteDescriptor(poll_descriptor.descriptor);
+  }
+  m_descriptors[fd] = poll_descriptor;
+}
+
+void LibUsbSelectServerThread::PollFdRemoved(int fd) {
+  DescriptorMap::iterator iter = m_descriptors.find(fd);
+  if (iter == m_descriptors.end()) {
+    return;
+  }
+  RemoveDescriptor(iter->second);
+  m_descriptors.erase(iter);
+}
+
+void LibUsbSelectServerThread::HandleEvents() {
+  DeleteRemovedDescriptors();
+  struct timeval tv = {0, 0};
+  libusb_handle_events_timeout(Context(), &tv);
+}
+
+bool LibUsbSelectServerThread::CheckTimeouts() {
+  HandleEvents();
+  return true;
+}
+
+void LibUsbSelectServerThread::RemoveDescriptor(
+    const PollDescriptor &poll_descriptor) {
+  if (poll_descriptor.events & POLLIN) {
+    m_ss->RemoveReadDescriptor(poll_descriptor.descriptor);
+  }
+  if (poll_descriptor.events & POLLOUT) {
+    m_ss->RemoveWriteDescriptor(poll_descriptor.descriptor);
+  }
+  // libusb removes descriptors from within libusb_handle_events_timeout(),
+  // which may be running from this descriptor's callback, so the delete is
+  // deferred.
+  m_removed_descriptors.push_back(poll_descriptor.descriptor);
+}
+
+void LibUsbSelectServerThread::DeleteRemovedDescriptors() {
+  STLDeleteElements(&m_removed_descriptors);
+}
 }  // namespace usb
 }  // namespace ola
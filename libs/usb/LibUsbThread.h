@@ -27,8 +27,15 @@
 #include <config.h>
 #endif  // HAVE_CONFIG_H
 
+#include <map>
+#include <vector>
+
 #include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/Utils.h"
 
 namespace ola {
 namespace usb {
@@ -50,16 +57,21 @@ namespace usb {
  * libusb_close() are paired with calls to OpenHandle() and CloseHandle().
  *
  * http://libusb.sourceforge.net/api-1.0/group__asyncio.html covers both
- * approaches.
+ * approaches. LibUsbSelectServerThread implements ii) for platforms that
+ * support it.
  */
 class LibUsbThread : private ola::thread::Thread {
  public:
   /**
    * @brief Base constructor
    * @param context the libusb context to use.
+   * @param scheduling the scheduling options to apply when the thread starts.
    */
-  explicit LibUsbThread(libusb_context *context)
+  explicit LibUsbThread(libusb_context *context,
+                        const ola::thread::SchedulingOptions &scheduling =
+                            ola::thread::SchedulingOptions())
     : m_context(context),
+      m_scheduling(scheduling),
       m_term(false) {
   }
 
@@ -97,6 +109,14 @@ class LibUsbThread : private ola::thread::Thread {
    */
   virtual void CloseHandle(libusb_device_handle *handle) = 0;
 
+  /**
+   * @brief Handle any pending libusb events.
+   *
+   * This is called when waiting for transfers to complete. Threads that run
+   * libusb_handle_events() themselves don't need to do anything.
+   */
+  virtual void HandlePendingEvents() {}
+
  protected:
   /**
    * @brief Indicate that the libusb thread should terminate.
@@ -127,11 +147,12 @@ class LibUsbThread : private ola::thread::Thread {
 
  private:
   libusb_context *m_context;
+  const ola::thread::SchedulingOptions m_scheduling;
   bool m_term;  // GUARDED_BY(m_term_mutex)
   ola::thread::Mutex m_term_mutex;
 };
 
-#if HAVE_LIBUSB_HOTPLUG_API
+#ifdef HAVE_LIBUSB_HOTPLUG_API
 
 /**
  * @brief The hotplug version of the LibUsbThread.
@@ -143,6 +164,7 @@ class LibUsbHotplugThread : public LibUsbThread {
    * @param context the libusb context to use.
    * @param callback_fn The callback function to run when hotplug events occur.
    * @param user_data User data to pass to the callback function.
+   * @param scheduling the scheduling options to apply when the thread starts.
    *
    * The thread is started in Init(). When the object is
    * destroyed, the handle is de-registered as part of the thread shutdown
@@ -150,7 +172,9 @@ class LibUsbHotplugThread : public LibUsbThread {
    */
   LibUsbHotplugThread(libusb_context *context,
                       libusb_hotplug_callback_fn callback_fn,
-                      void *user_data);
+                      void *user_data,
+                      const ola::thread::SchedulingOptions &scheduling =
+                          ola::thread::SchedulingOptions());
 
   bool Init();
 
@@ -183,13 +207,16 @@ class LibUsbSimpleThread : public LibUsbThread {
   /**
    * @brief Create a new LibUsbHotplugThread
    * @param context the libusb context to use.
+   * @param scheduling the scheduling options to apply when the thread starts.
    *
    * The thread is starts as soon as this object is created. When the object is
    * destroyed, the handle is de-registered as part of the thread shutdown
    * sequence.
    */
-  explicit LibUsbSimpleThread(libusb_context *context)
-    : LibUsbThread(context),
+  explicit LibUsbSimpleThread(libusb_context *context,
+                              const ola::thread::SchedulingOptions &scheduling =
+                                  ola::thread::SchedulingOptions())
+    : LibUsbThread(context, scheduling),
       m_device_count(0) {
   }
 
@@ -201,6 +228,125 @@ class LibUsbSimpleThread : public LibUsbThread {
 
   DISALLOW_COPY_AND_ASSIGN(LibUsbSimpleThread);
 };
+
+/**
+ * @brief Handle libusb events from a SelectServer, rather than a thread.
+ *
+ * Despite the name, no thread is started. The file descriptors libusb polls
+ * are added to the SelectServer, and libusb_handle_events_timeout() is called
+ * when one of them is ready. Transfer completions and hotplug events are then
+ * run in the SelectServer's thread, so they don't need to be passed across
+ * threads.
+ *
+ * All methods, including those on the LibUsbAdaptor that opens and closes
+ * devices, must be called from the SelectServer's thread.
+ *
+ * This isn't supported on Windows, where libusb doesn't provide pollfds.
+ */
+class LibUsbSelectServerThread : public LibUsbThread {
+ public:
+  /**
+   * @brief Create a new LibUsbSelectServerThread.
+   * @param context the libusb context to use.
+   * @param ss the SelectServer to handle events on, ownership is not
+   *   transferred.
+   */
+  LibUsbSelectServerThread(libusb_context *context,
+                           ola::io::SelectServerInterface *ss);
+
+  ~LibUsbSelectServerThread();
+
+  /**
+   * @brief Add libusb's file descriptors to the SelectServer.
+   * @returns false if libusb doesn't support pollfds.
+   */
+  bool Init();
+
+  /**
+   * @brief Remove libusb's file descriptors from the SelectServer.
+   */
+  void Shutdown();
+
+  void OpenHandle() {}
+  void CloseHandle(libusb_device_handle *handle);
+
+  /**
+   * @brief Handle libusb events, waiting up to PENDING_EVENTS_TIMEOUT_MS.
+   *
+   * This must not be called from within a libusb callback, since libusb
+   * doesn't allow events to be handled recursively.
+   */
+  void HandlePendingEvents();
+
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+  /**
+   * @brief Register a hotplug callback when Init() is called.
+   * @param callback_fn The callback function to run when hotplug events occur.
+   * @param user_data User data to pass to the callback function.
+   *
+   * The callback is run from the SelectServer's thread, or from within Init()
+   * for the devices that are already attached.
+   */
+  void SetHotplugCallback(libusb_hotplug_callback_fn callback_fn,
+                          void *user_data);
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+
+  /**
+   * @brief Called by libusb when a file descriptor is added.
+   */
+  void PollFdAdded(int fd, short events);
+
+  /**
+   * @brief Called by libusb when a file descriptor is removed.
+   */
+  void PollFdRemoved(int fd);
+
+  /**
+   * @brief Check if libusb can provide file descriptors to poll.
+   * @param context the libusb context to check.
+   * @returns false if a LibUsbSelectServerThread can't be used.
+   */
+  static bool PollFdsSupported(libusb_context *context);
+
+  /**
+   * @brief How often to check for transfer timeouts if libusb can't signal
+   * them with a file descriptor.
+   */
+  static const unsigned int TIMEOUT_CHECK_INTERVAL_MS = 50;
+
+  /**
+   * @brief How long HandlePendingEvents() waits for an event.
+   */
+  static const unsigned int PENDING_EVENTS_TIMEOUT_MS = 10;
+
+ private:
+  struct PollDescriptor {
+    ola::io::UnmanagedFileDescriptor *descriptor;
+    short events;
+  };
+
+  typedef std::map<int, PollDescriptor> DescriptorMap;
+
+  ola::io::SelectServerInterface* const m_ss;
+  DescriptorMap m_descriptors;
+  // Descriptors libusb removed while we may have been in their callback.
+  std::vector<ola::io::UnmanagedFileDescriptor*> m_removed_descriptors;
+  ola::thread::timeout_id m_timeout_id;
+  bool m_running;
+
+#ifdef HAVE_LIBUSB_HOTPLUG_API
+  libusb_hotplug_callback_handle m_hotplug_handle;
+  libusb_hotplug_callback_fn m_callback_fn;
+  void *m_user_data;
+#endif  // HAVE_LIBUSB_HOTPLUG_API
+
+  void HandleEvents();
+  bool CheckTimeouts();
+  void RemoveDescriptor(const PollDescriptor &poll_descriptor);
+  void DeleteRemovedDescriptors();
+
+  DISALLOW_COPY_AND_ASSIGN(LibUsbSelectServerThread);
+};
 }  // namespace usb
 }  // namespace ola
 #endif  // LIBS_USB_LIBUSBTHREAD_H_
@@ -24,10 +24,11 @@
 #include "libs/usb/LibUsbAdaptor.h"
 #include "libs/usb/LibUsbThread.h"
 #include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
 #include "ola/testing/TestUtils.h"
 
 namespace {
-#if HAVE_LIBUSB_HOTPLUG_API
+#ifdef HAVE_LIBUSB_HOTPLUG_API
 int LIBUSB_CALL hotplug_callback(OLA_UNUSED struct libusb_context *ctx,
                                  OLA_UNUSED struct libusb_device *dev,
                                  OLA_UNUSED libusb_hotplug_event event,
@@ -40,9 +41,12 @@ int LIBUSB_CALL hotplug_callback(OLA_UNUSED struct libusb_context *ctx,
 class LibUsbThreadTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(LibUsbThreadTest);
   CPPUNIT_TEST(testNonHotplug);
-#if HAVE_LIBUSB_HOTPLUG_API
+#ifdef HAVE_LIBUSB_HOTPLUG_API
   CPPUNIT_TEST(testHotplug);
 #endif  // HAVE_LIBUSB_HOTPLUG_API
+#ifndef _WIN32
+  CPPUNIT_TEST(testSelectServer);
+#endif  // _WIN32
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -52,9 +56,10 @@ class LibUsbThreadTest: public CppUnit::TestFixture {
   void tearDown();
 
   void testNonHotplug();
-#if HAVE_LIBUSB_HOTPLUG_API
+#ifdef HAVE_LIBUSB_HOTPLUG_API
   void testHotplug();
 #endif  // HAVE_LIBUSB_HOTPLUG_API
+  void testSelectServer();
 
  private:
   libusb_context *m_context;
@@ -86,7 +91,7 @@ void LibUsbThreadTest::testNonHotplug() {
   AttemptDeviceOpen(&thread);
 }
 
-#if HAVE_LIBUSB_HOTPLUG_API
+#ifdef HAVE_LIBUSB_HOTPLUG_API
 void LibUsbThreadTest::testHotplug() {
   if (!m_context) {
     return;
@@ -106,6 +111,19 @@ void LibUsbThreadTest::testHotplug() {
 }
 #endif  // HAVE_LIBUSB_HOTPLUG_API
 
+void LibUsbThreadTest::testSelectServer() {
+  if (!m_context) {
+    return;
+  }
+
+  ola::io::SelectServer ss;
+  ola::usb::LibUsbSelectServerThread thread(m_context, &ss);
+  OLA_ASSERT_TRUE(thread.Init());
+  AttemptDeviceOpen(&thread);
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  thread.Shutdown();
+}
+
 /*
  * Try to open any USB device so we can test interaction with the thread.
  */
@@ -33,20 +33,54 @@
 #include <ola/AutoStart.h>
 #include <ola/network/IPV4Address.h>
 #include <ola/network/SocketAddress.h>
+#ifndef _WIN32
+#include <ola/network/UnixDomainSocket.h>
+#endif  // !_WIN32
 #include <ola/Logging.h>
 
+#include <memory>
+
+#include "common/rpc/RpcServer.h"
+
 namespace ola {
 namespace client {
 
+using ola::io::ConnectedDescriptor;
 using ola::network::TCPSocket;
 
 /*
- * Open a connection to the server.
+ * Open a connection to a running server.
  */
-TCPSocket *ConnectToServer(unsigned short port) {
+ConnectedDescriptor *ConnectToRunningServer(unsigned short port) {
+#ifndef _WIN32
+  // Only trust the socket if olad is running as the same user, otherwise use
+  // TCP.
+  std::auto_ptr<ola::network::UnixDomainSocket> local_socket(
+      ola::network::UnixDomainSocket::Connect(
+          ola::rpc::LocalSocketPath(port)));
+  if (local_socket.get()) {
+    uid_t uid;
+    if (local_socket->PeerUid(&uid) && uid == geteuid()) {
+      return local_socket.release();
+    }
+    OLA_WARN << "The RPC socket isn't owned by uid " << geteuid()
+             << ", using TCP";
+  }
+#endif  // !_WIN32
+
   ola::network::IPV4SocketAddress server_address(
       ola::network::IPV4Address::Loopback(), port);
   TCPSocket *socket = TCPSocket::Connect(server_address);
+  if (socket)
+    socket->SetNoDelay();
+  return socket;
+}
+
+/*
+ * Open a connection to the server.
+ */
+ConnectedDescriptor *ConnectToServer(unsigned short port) {
+  ConnectedDescriptor *socket = ConnectToRunningServer(port);
   if (socket)
     return socket;
 
@@ -118,7 +152,7 @@ TCPSocket *ConnectToServer(unsigned short port) {
   sleep(1);
 #endif  // _WIN32
 
-  return TCPSocket::Connect(server_address);
+  return ConnectToRunningServer(port);
 }
 }  // namespace client
 }  // namespace ola
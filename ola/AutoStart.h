@@ -22,15 +22,22 @@
 #define OLA_AUTOSTART_H_
 
 #include <ola/Constants.h>
+#include <ola/io/Descriptor.h>
 #include <ola/network/TCPSocket.h>
 
 namespace ola {
 namespace client {
 
 /*
- * Open a connection to the server.
+ * Open a connection to a running server. The local unix domain socket is
+ * preferred, with TCP as a fallback.
  */
-ola::network::TCPSocket *ConnectToServer(unsigned short port);
+ola::io::ConnectedDescriptor *ConnectToRunningServer(unsigned short port);
+
+/*
+ * Open a connection to the server, starting it if it's not running.
+ */
+ola::io::ConnectedDescriptor *ConnectToServer(unsigned short port);
 }  // namespace client
 }  // namespace ola
 #endif  // OLA_AUTOSTART_H_
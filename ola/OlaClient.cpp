@@ -62,10 +62,29 @@ void OlaClient::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_core->SetDMXCallback(callback);
 }
 
+void OlaClient::SetDMXViewCallback(RepeatableDMXViewCallback *callback,
+                                   unsigned int start_slot,
+                                   unsigned int slot_count) {
+  m_core->SetDMXViewCallback(callback, start_slot, slot_count);
+}
+
+void OlaClient::SetRDMPollCallback(RepeatableRDMPollCallback *callback) {
+  m_core->SetRDMPollCallback(callback);
+}
+
+void OlaClient::SetInfoChangesCallback(
+    RepeatableInfoChangesCallback *callback) {
+  m_core->SetInfoChangesCallback(callback);
+}
+
 void OlaClient::ReloadPlugins(SetCallback *callback) {
   m_core->ReloadPlugins(callback);
 }
 
+void OlaClient::ReloadPlugin(ola_plugin_id plugin_id, SetCallback *callback) {
+  m_core->ReloadPlugin(plugin_id, callback);
+}
+
 void OlaClient::FetchPluginList(PluginListCallback *callback) {
   m_core->FetchPluginList(callback);
 }
@@ -152,22 +171,92 @@ void OlaClient::Patch(unsigned int device_alias,
   m_core->Patch(device_alias, port, port_direction, action, universe, callback);
 }
 
+void OlaClient::PatchPorts(const vector<PortPatch> &patches,
+                           SetCallback *callback) {
+  m_core->PatchPorts(patches, callback);
+}
+
+void OlaClient::ConfigureUniverses(const vector<UniverseConfig> &universes,
+                                   SetCallback *callback) {
+  m_core->ConfigureUniverses(universes, callback);
+}
+
 void OlaClient::RegisterUniverse(unsigned int universe,
                                  RegisterAction register_action,
                                  SetCallback *callback) {
   m_core->RegisterUniverse(universe, register_action, callback);
 }
 
+void OlaClient::RegisterUniverse(unsigned int universe,
+                                 RegisterAction register_action,
+                                 const RegisterArgs &args) {
+  m_core->RegisterUniverse(universe, register_action, args);
+}
+
+void OlaClient::RegisterForRDMPoll(unsigned int universe,
+                                   RegisterAction register_action,
+                                   const RDMPollArgs &args) {
+  m_core->RegisterForRDMPoll(universe, register_action, args);
+}
+
+void OlaClient::RegisterForInfoUpdates(RegisterAction register_action,
+                                       SetCallback *callback) {
+  m_core->RegisterForInfoUpdates(register_action, callback);
+}
+
+void OlaClient::FetchUniverseChanges(uint64_t since_generation,
+                                     UniverseChangesCallback *callback) {
+  m_core->FetchUniverseChanges(since_generation, callback);
+}
+
+void OlaClient::FetchDeviceChanges(uint64_t since_generation,
+                                   DeviceChangesCallback *callback) {
+  m_core->FetchDeviceChanges(since_generation, callback);
+}
+
 void OlaClient::SendDMX(unsigned int universe,
                         const DmxBuffer &data,
                         const SendDMXArgs &args) {
   m_core->SendDMX(universe, data, args);
 }
 
+void OlaClient::EnableDMXCoalescing(
+    ola::thread::SchedulerInterface *scheduler,
+    const TimeInterval &interval) {
+  m_core->EnableDMXCoalescing(scheduler, interval);
+}
+
+void OlaClient::DisableDMXCoalescing() {
+  m_core->DisableDMXCoalescing();
+}
+
+void OlaClient::FlushDMX() {
+  m_core->FlushDMX();
+}
+
+const SendDMXCounters &OlaClient::DMXCounters() const {
+  return m_core->DMXCounters();
+}
+
+void OlaClient::FadeDMX(unsigned int universe,
+                        const DmxBuffer &data,
+                        unsigned int duration_ms,
+                        const FadeDMXArgs &args) {
+  m_core->FadeDMX(universe, data, duration_ms, args);
+}
+
 void OlaClient::FetchDMX(unsigned int universe, DMXCallback *callback) {
   m_core->FetchDMX(universe, callback);
 }
 
+void OlaClient::FetchDMXBatch(const FetchDMXBatchArgs &args) {
+  m_core->FetchDMXBatch(args);
+}
+
+void OlaClient::FetchUniverseStats(const FetchUniverseStatsArgs &args) {
+  m_core->FetchUniverseStats(args);
+}
+
 void OlaClient::RunDiscovery(unsigned int universe,
                              DiscoveryType discovery_type,
                              DiscoveryCallback *callback) {
@@ -203,5 +292,9 @@ void OlaClient::RDMSet(unsigned int universe,
                        const SendRDMArgs& args) {
   m_core->RDMSet(universe, uid, sub_device, pid, data, data_length, args);
 }
+
+void OlaClient::SendRDMBatch(const SendRDMBatchArgs &args) {
+  m_core->SendRDMBatch(args);
+}
 }  // namespace client
 }  // namespace ola
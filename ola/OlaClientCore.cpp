@@ -24,10 +24,12 @@
 #include <sys/types.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "common/dmx/DmxDelta.h"
 #include "common/protocol/Ola.pb.h"
 #include "ola/Callback.h"
 #include "ola/ClientTypesFactory.h"
@@ -39,6 +41,7 @@
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/RDMFrame.h"
+#include "ola/stl/STLUtils.h"
 
 namespace ola {
 namespace client {
@@ -50,6 +53,7 @@ using ola::rdm::UIDSet;
 using ola::rpc::RpcChannel;
 using ola::rpc::RpcController;
 using std::auto_ptr;
+using std::map;
 using std::string;
 using std::vector;
 
@@ -57,7 +61,13 @@ const char OlaClientCore::NOT_CONNECTED_ERROR[] = "Not connected";
 
 OlaClientCore::OlaClientCore(ConnectedDescriptor *descriptor)
     : m_descriptor(descriptor),
-      m_connected(false) {
+      m_view_start_slot(0),
+      m_view_slot_count(DMX_UNIVERSE_SIZE),
+      m_connected(false),
+      m_delta_encoding(false),
+      m_coalesce_dmx(false),
+      m_scheduler(NULL),
+      m_next_rdm_batch_id(0) {
 }
 
 
@@ -65,6 +75,7 @@ OlaClientCore::~OlaClientCore() {
   if (m_connected) {
     Stop();
   }
+  ClearCoalescedUniverses();
 }
 
 
@@ -89,6 +100,28 @@ bool OlaClientCore::Setup() {
     return false;
   }
   m_connected = true;
+
+  // Ask for delta encoded updates. Older servers will fail the request, in
+  // which case we keep sending full frames.
+  RpcController *controller = new RpcController();
+  ola::proto::DeltaEncodingRequest request;
+  ola::proto::Ack *reply = new ola::proto::Ack();
+  request.set_enable(true);
+  m_stub->SetDeltaEncoding(
+      controller, &request, reply,
+      ola::NewSingleCallback(this, &OlaClientCore::HandleDeltaEncoding,
+                             controller, reply));
+
+  // Ask for the updates for all our universes to be sent together. Older
+  // servers don't know about this and keep sending them one at a time.
+  RpcController *batch_controller = new RpcController();
+  ola::proto::DmxBatchingRequest batch_request;
+  ola::proto::Ack *batch_reply = new ola::proto::Ack();
+  batch_request.set_enable(true);
+  m_stub->SetDmxBatching(
+      batch_controller, &batch_request, batch_reply,
+      ola::NewSingleCallback(this, &OlaClientCore::HandleDmxBatching,
+                             batch_controller, batch_reply));
   return true;
 }
 
@@ -104,6 +137,11 @@ bool OlaClientCore::Stop() {
     m_stub.reset();
   }
   m_connected = false;
+  m_delta_encoding = false;
+  m_last_sent.clear();
+  m_last_received.clear();
+  ClearCoalescedUniverses();
+  FailRDMBatches(NOT_CONNECTED_ERROR);
   return 0;
 }
 
@@ -123,6 +161,24 @@ void OlaClientCore::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_dmx_callback.reset(callback);
 }
 
+void OlaClientCore::SetDMXViewCallback(RepeatableDMXViewCallback *callback,
+                                       unsigned int start_slot,
+                                       unsigned int slot_count) {
+  m_dmx_view_callback.reset(callback);
+  m_view_start_slot = start_slot;
+  m_view_slot_count = std::min(slot_count,
+                               static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+}
+
+void OlaClientCore::SetRDMPollCallback(RepeatableRDMPollCallback *callback) {
+  m_rdm_poll_callback.reset(callback);
+}
+
+void OlaClientCore::SetInfoChangesCallback(
+    RepeatableInfoChangesCallback *callback) {
+  m_info_changes_callback.reset(callback);
+}
+
 void OlaClientCore::ReloadPlugins(SetCallback *callback) {
   ola::proto::PluginReloadRequest request;
   RpcController *controller = new RpcController();
@@ -140,6 +196,25 @@ void OlaClientCore::ReloadPlugins(SetCallback *callback) {
   }
 }
 
+void OlaClientCore::ReloadPlugin(ola_plugin_id plugin_id,
+                                 SetCallback *callback) {
+  ola::proto::PluginReloadRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+  request.set_plugin_id(plugin_id);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->ReloadPlugins(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::FetchPluginList(PluginListCallback *callback) {
   RpcController *controller = new RpcController();
   ola::proto::PluginListRequest request;
@@ -441,9 +516,77 @@ void OlaClientCore::Patch(unsigned int device_alias,
   }
 }
 
+void OlaClientCore::PatchPorts(const vector<PortPatch> &patches,
+                               SetCallback *callback) {
+  ola::proto::PatchPortsRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  vector<PortPatch>::const_iterator iter = patches.begin();
+  for (; iter != patches.end(); ++iter) {
+    ola::proto::PatchPortRequest *patch = request.add_patches();
+    patch->set_universe(iter->universe);
+    patch->set_device_alias(iter->device_alias);
+    patch->set_port_id(iter->port);
+    patch->set_is_output(iter->direction == OUTPUT_PORT);
+    patch->set_action(
+        iter->action == PATCH ? ola::proto::PATCH : ola::proto::UNPATCH);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->PatchPorts(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::ConfigureUniverses(
+    const vector<UniverseConfig> &universes,
+    SetCallback *callback) {
+  ola::proto::ConfigureUniversesRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  vector<UniverseConfig>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    ola::proto::UniverseConfig *config = request.add_universes();
+    config->set_universe(iter->universe);
+    if (iter->has_name) {
+      config->set_name(iter->name);
+    }
+    if (iter->has_merge_mode) {
+      config->set_merge_mode(iter->merge_mode == OlaUniverse::MERGE_HTP ?
+          ola::proto::HTP : ola::proto::LTP);
+    }
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->ConfigureUniverses(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::RegisterUniverse(unsigned int universe,
                                      RegisterAction register_action,
                                      SetCallback *callback) {
+  RegisterUniverse(universe, register_action, RegisterArgs(callback));
+}
+
+void OlaClientCore::RegisterUniverse(unsigned int universe,
+                                     RegisterAction register_action,
+                                     const RegisterArgs &args) {
+  SetCallback *callback = args.callback;
   ola::proto::RegisterDmxRequest request;
   RpcController *controller = new RpcController();
   ola::proto::Ack *reply = new ola::proto::Ack();
@@ -453,6 +596,18 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
         ola::proto::UNREGISTER);
   request.set_universe(universe);
   request.set_action(action);
+  if (args.max_fps) {
+    request.set_max_fps(args.max_fps);
+  }
+  if (args.only_on_change) {
+    request.set_only_on_change(true);
+  }
+  if (args.start_slot) {
+    request.set_start_slot(args.start_slot);
+  }
+  if (args.slot_count) {
+    request.set_slot_count(args.slot_count);
+  }
 
   if (m_connected) {
     CompletionCallback *cb = ola::NewSingleCallback(
@@ -466,13 +621,111 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
   }
 }
 
+void OlaClientCore::RegisterForRDMPoll(unsigned int universe,
+                                       RegisterAction register_action,
+                                       const RDMPollArgs &args) {
+  ola::proto::RDMPollRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  request.set_universe(universe);
+  if (register_action == REGISTER) {
+    request.set_action(ola::proto::REGISTER);
+    request.set_interval(args.interval_ms);
+    vector<RDMPollItem>::const_iterator iter = args.items.begin();
+    for (; iter != args.items.end(); ++iter) {
+      ola::proto::RDMPollItem *item = request.add_item();
+      item->set_param_id(iter->pid);
+      item->set_sub_device(iter->sub_device);
+      item->set_data(iter->data);
+    }
+  } else {
+    request.set_action(ola::proto::UNREGISTER);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, args.callback);
+    m_stub->RegisterForRDMPoll(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, args.callback);
+  }
+}
+
+void OlaClientCore::RegisterForInfoUpdates(RegisterAction register_action,
+                                           SetCallback *callback) {
+  ola::proto::RegisterInfoRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  request.set_action(register_action == REGISTER ? ola::proto::REGISTER :
+                     ola::proto::UNREGISTER);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->RegisterForInfoUpdates(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::FetchUniverseChanges(uint64_t since_generation,
+                                         UniverseChangesCallback *callback) {
+  RpcController *controller = new RpcController();
+  ola::proto::OptionalUniverseRequest request;
+  ola::proto::UniverseInfoReply *reply = new ola::proto::UniverseInfoReply();
+
+  request.set_since_generation(since_generation);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleUniverseChanges,
+        controller, reply, callback);
+    m_stub->GetUniverseInfo(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleUniverseChanges(controller, reply, callback);
+  }
+}
+
+void OlaClientCore::FetchDeviceChanges(uint64_t since_generation,
+                                       DeviceChangesCallback *callback) {
+  RpcController *controller = new RpcController();
+  ola::proto::DeviceInfoRequest request;
+  ola::proto::DeviceInfoReply *reply = new ola::proto::DeviceInfoReply();
+
+  request.set_since_generation(since_generation);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleDeviceChanges,
+        controller, reply, callback);
+    m_stub->GetDeviceInfo(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleDeviceChanges(controller, reply, callback);
+  }
+}
+
 void OlaClientCore::SendDMX(unsigned int universe,
                             const DmxBuffer &data,
                             const SendDMXArgs &args) {
+  if (m_coalesce_dmx && m_connected) {
+    CoalesceDMX(universe, data, args);
+    return;
+  }
+
   ola::proto::DmxData request;
-  request.set_universe(universe);
-  request.set_data(data.Get());
-  request.set_priority(args.priority);
+  BuildDmxRequest(universe, data, args.priority, &request);
 
   if (args.callback) {
     // Full request
@@ -495,6 +748,67 @@ void OlaClientCore::SendDMX(unsigned int universe,
   }
 }
 
+void OlaClientCore::EnableDMXCoalescing(
+    ola::thread::SchedulerInterface *scheduler,
+    const TimeInterval &interval) {
+  m_coalesce_dmx = true;
+  m_scheduler = scheduler;
+  m_coalesce_interval = interval;
+}
+
+void OlaClientCore::DisableDMXCoalescing() {
+  FlushDMX();
+  m_coalesce_dmx = false;
+}
+
+void OlaClientCore::FlushDMX() {
+  if (!m_connected) {
+    return;
+  }
+  CoalescedUniverseMap::iterator iter = m_coalesced_universes.begin();
+  for (; iter != m_coalesced_universes.end(); ++iter) {
+    SendCoalescedDMX(iter->first, iter->second);
+  }
+}
+
+void OlaClientCore::FadeDMX(unsigned int universe,
+                            const DmxBuffer &data,
+                            unsigned int duration_ms,
+                            const FadeDMXArgs &args) {
+  ola::proto::FadeRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  ola::proto::FadeCurve curve = ola::proto::FADE_LINEAR;
+  if (args.curve == FADE_EASE_IN_OUT) {
+    curve = ola::proto::FADE_EASE_IN_OUT;
+  } else if (args.curve == FADE_SQUARE) {
+    curve = ola::proto::FADE_SQUARE;
+  }
+
+  request.set_universe(universe);
+  request.set_data(data.Get());
+  request.set_duration(duration_ms);
+  request.set_start_slot(args.start_slot);
+  request.set_curve(curve);
+  request.set_priority(args.priority);
+
+  // The server changes our data as the fade runs, so the next frame we send
+  // can't be a delta.
+  m_last_sent.erase(universe);
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, args.callback);
+    m_stub->FadeDmx(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, args.callback);
+  }
+}
+
 void OlaClientCore::FetchDMX(unsigned int universe,
                              DMXCallback *callback) {
   ola::proto::UniverseRequest request;
@@ -515,6 +829,62 @@ void OlaClientCore::FetchDMX(unsigned int universe,
   }
 }
 
+void OlaClientCore::FetchDMXBatch(const FetchDMXBatchArgs &args) {
+  ola::proto::DmxBatchRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::DmxBatchReply *reply = new ola::proto::DmxBatchReply();
+
+  vector<unsigned int>::const_iterator iter = args.universes.begin();
+  for (; iter != args.universes.end(); ++iter) {
+    request.add_universes(*iter);
+  }
+  if (args.use_range) {
+    request.set_first_universe(args.first_universe);
+    request.set_last_universe(args.last_universe);
+  }
+  if (args.since_generation) {
+    request.set_since_generation(args.since_generation);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = NewSingleCallback(
+        this,
+        &OlaClientCore::HandleGetDmxBatch,
+        controller, reply, args.callback);
+    m_stub->GetDmxBatch(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleGetDmxBatch(controller, reply, args.callback);
+  }
+}
+
+void OlaClientCore::FetchUniverseStats(const FetchUniverseStatsArgs &args) {
+  ola::proto::UniverseStatsRequest request;
+  RpcController *controller = new RpcController();
+  ola::proto::UniverseStatsReply *reply =
+      new ola::proto::UniverseStatsReply();
+
+  vector<unsigned int>::const_iterator iter = args.universes.begin();
+  for (; iter != args.universes.end(); ++iter) {
+    request.add_universes(*iter);
+  }
+  if (args.use_range) {
+    request.set_first_universe(args.first_universe);
+    request.set_last_universe(args.last_universe);
+  }
+
+  if (m_connected) {
+    CompletionCallback *cb = NewSingleCallback(
+        this,
+        &OlaClientCore::HandleGetUniverseStats,
+        controller, reply, args.callback);
+    m_stub->GetUniverseStats(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleGetUniverseStats(controller, reply, args.callback);
+  }
+}
+
 void OlaClientCore::RunDiscovery(unsigned int universe,
                                  DiscoveryType discovery_type,
                                  DiscoveryCallback *callback) {
@@ -625,25 +995,308 @@ void OlaClientCore::UpdateDmxData(ola::rpc::RpcController*,
                                   const ola::proto::DmxData *request,
                                   ola::proto::Ack*,
                                   CompletionCallback *done) {
-  if (m_dmx_callback.get()) {
-    DmxBuffer buffer;
-    buffer.Set(request->data());
+  HandleDmxData(*request);
+  done->Run();
+}
+
+void OlaClientCore::UpdateDmxDataBatch(ola::rpc::RpcController*,
+                                       const ola::proto::DmxDataBatch *request,
+                                       ola::proto::Ack*,
+                                       CompletionCallback *done) {
+  for (int i = 0; i < request->data_size(); i++) {
+    HandleDmxData(request->data(i));
+  }
+  done->Run();
+}
 
-    uint8_t priority = 0;
-    if (request->has_priority()) {
-      priority = request->priority();
+/*
+ * Run the DMX callbacks for an update from the server.
+ */
+void OlaClientCore::HandleDmxData(const ola::proto::DmxData &request) {
+  uint8_t priority = 0;
+  if (request.has_priority()) {
+    priority = request.priority();
+  }
+  DMXMetadata metadata(request.universe(), priority);
+
+  // Without delta encoding the frame doesn't need to be kept, so if only the
+  // view callback is set it can read straight from the request.
+  if (!m_delta_encoding && !request.has_delta_length() &&
+      !m_dmx_callback.get()) {
+    if (m_dmx_view_callback.get()) {
+      const string &data = request.data();
+      RunDMXViewCallback(metadata,
+                         reinterpret_cast<const uint8_t*>(data.data()),
+                         data.size());
     }
-    DMXMetadata metadata(request->universe(), priority);
+    return;
+  }
+
+  // Otherwise the frame is always decoded so the next delta has the right
+  // base.
+  DmxBuffer &buffer = m_last_received[request.universe()];
+  const unsigned int previous_size = buffer.Size();
+  if (!ola::dmx::DecodeDmxData(buffer, request, &buffer)) {
+    OLA_WARN << "Invalid delta encoded data for universe "
+             << request.universe();
+    return;
+  }
+
+  if (m_dmx_callback.get()) {
     m_dmx_callback->Run(metadata, buffer);
   }
+  if (m_dmx_view_callback.get() &&
+      (previous_size != buffer.Size() || ViewChanged(request))) {
+    RunDMXViewCallback(metadata, buffer.GetRaw(), buffer.Size());
+  }
+}
+
+void OlaClientCore::RDMPollUpdate(ola::rpc::RpcController*,
+                                  const ola::proto::RDMPollResult *request,
+                                  ola::proto::Ack*,
+                                  CompletionCallback *done) {
+  if (m_rdm_poll_callback.get()) {
+    RDMPollResult result(
+        request->universe(),
+        UID(request->uid().esta_id(), request->uid().device_id()),
+        RDMPollItem(request->item().sub_device(), request->item().param_id(),
+                    request->item().data()));
+    result.response_code = static_cast<ola::rdm::rdm_response_code>(
+        request->response_code());
+    if (request->has_response_type()) {
+      result.response_type = static_cast<ola::rdm::rdm_response_type>(
+          request->response_type());
+    }
+    result.data = request->data();
+    m_rdm_poll_callback->Run(result);
+  }
+  done->Run();
+}
+
+void OlaClientCore::RDMBatchUpdate(ola::rpc::RpcController*,
+                                   const ola::proto::RDMBatchResult *request,
+                                   ola::proto::Ack*,
+                                   CompletionCallback *done) {
+  RDMMetadata metadata;
+  auto_ptr<ola::rdm::RDMResponse> response(
+      ParseRDMReply(request->response(), &metadata));
+  CompleteRDMBatchRequest(request->batch_id(), request->index(), Result(""),
+                          metadata, response.get());
+  done->Run();
+}
+
+void OlaClientCore::InfoUpdate(ola::rpc::RpcController*,
+                               const ola::proto::InfoChanges *request,
+                               ola::proto::Ack*,
+                               CompletionCallback *done) {
+  if (m_info_changes_callback.get()) {
+    InfoChanges changes;
+    changes.universe_generation = request->universe_generation();
+    changes.device_generation = request->device_generation();
+    changes.changed_universes.assign(request->changed_universe().begin(),
+                                     request->changed_universe().end());
+    changes.removed_universes.assign(request->removed_universe().begin(),
+                                     request->removed_universe().end());
+    changes.changed_devices.assign(request->changed_device().begin(),
+                                   request->changed_device().end());
+    changes.removed_devices.assign(request->removed_device().begin(),
+                                   request->removed_device().end());
+    m_info_changes_callback->Run(changes);
+  }
   done->Run();
 }
 
+/*
+ * Returns false if the request is a delta that doesn't touch any of the slots
+ * in the view.
+ */
+bool OlaClientCore::ViewChanged(const ola::proto::DmxData &request) const {
+  if (!request.has_delta_length()) {
+    return true;
+  }
+  for (int i = 0; i < request.changed_slots_size(); i++) {
+    const ola::proto::DmxSlotRange &range = request.changed_slots(i);
+    const unsigned int start = range.offset();
+    const unsigned int end = start + range.data().size();
+    if (start < m_view_start_slot + m_view_slot_count &&
+        end > m_view_start_slot) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void OlaClientCore::RunDMXViewCallback(const DMXMetadata &metadata,
+                                       const uint8_t *data,
+                                       unsigned int size) {
+  if (m_view_start_slot >= size) {
+    return;
+  }
+  DMXView view;
+  view.data = data + m_view_start_slot;
+  view.offset = m_view_start_slot;
+  view.length = std::min(size - m_view_start_slot, m_view_slot_count);
+  view.frame_size = size;
+  m_dmx_view_callback->Run(metadata, view);
+}
+
+void OlaClientCore::BuildDmxRequest(unsigned int universe,
+                                    const DmxBuffer &data,
+                                    uint8_t priority,
+                                    ola::proto::DmxData *request) {
+  request->set_universe(universe);
+  request->set_priority(priority);
+  if (m_delta_encoding) {
+    DmxBuffer &last_sent = m_last_sent[universe];
+    ola::dmx::EncodeDmxData(last_sent, data, request);
+    last_sent = data;
+  } else {
+    request->set_data(data.Get());
+  }
+}
+
+/*
+ * Keep only the newest frame for the universe. It's sent once the previous
+ * frame has been acked, or the interval has passed.
+ */
+void OlaClientCore::CoalesceDMX(unsigned int universe,
+                                const DmxBuffer &data,
+                                const SendDMXArgs &args) {
+  CoalescedUniverse *state = STLFindOrNull(m_coalesced_universes, universe);
+  if (!state) {
+    state = new CoalescedUniverse();
+    m_coalesced_universes[universe] = state;
+  }
+
+  m_dmx_counters.frames_queued++;
+  if (state->pending) {
+    m_dmx_counters.frames_coalesced++;
+  }
+  state->data.Set(data);
+  state->priority = args.priority;
+  state->pending = true;
+  if (args.callback) {
+    state->callbacks.push_back(args.callback);
+  }
+
+  if (!state->in_flight) {
+    if (!m_scheduler) {
+      SendCoalescedDMX(universe, state);
+    } else if (state->timeout == ola::thread::INVALID_TIMEOUT) {
+      // Wait until the end of this loop iteration, so all the frames sent
+      // before then go in one RPC.
+      state->timeout = m_scheduler->RegisterSingleTimeout(
+          0,
+          NewSingleCallback(this, &OlaClientCore::CoalesceTimeout, universe));
+    }
+    return;
+  }
+
+  if (!m_scheduler || m_coalesce_interval.IsZero() ||
+      state->timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  const TimeStamp send_time = state->last_sent + m_coalesce_interval;
+  if (now >= send_time) {
+    SendCoalescedDMX(universe, state);
+  } else {
+    state->timeout = m_scheduler->RegisterSingleTimeout(
+        send_time - now,
+        NewSingleCallback(this, &OlaClientCore::CoalesceTimeout, universe));
+  }
+}
+
+void OlaClientCore::SendCoalescedDMX(unsigned int universe,
+                                     CoalescedUniverse *state) {
+  if (state->timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->timeout);
+    state->timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  if (!state->pending) {
+    return;
+  }
+
+  ola::proto::DmxData request;
+  BuildDmxRequest(universe, state->data, state->priority, &request);
+  vector<GeneralSetCallback*> *callbacks = new vector<GeneralSetCallback*>();
+  callbacks->swap(state->callbacks);
+  state->pending = false;
+  state->in_flight++;
+  m_clock.CurrentTime(&state->last_sent);
+  m_dmx_counters.frames_sent++;
+
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+  CompletionCallback *cb = ola::NewSingleCallback(
+      this,
+      &OlaClientCore::HandleCoalescedAck,
+      universe, controller, reply, callbacks);
+  m_stub->UpdateDmxData(controller, &request, reply, cb);
+}
+
+void OlaClientCore::CoalesceTimeout(unsigned int universe) {
+  CoalescedUniverse *state = STLFindOrNull(m_coalesced_universes, universe);
+  if (state) {
+    state->timeout = ola::thread::INVALID_TIMEOUT;
+    SendCoalescedDMX(universe, state);
+  }
+}
+
+/*
+ * Run the callbacks for any frames that haven't been sent and free the
+ * state.
+ */
+void OlaClientCore::ClearCoalescedUniverses() {
+  // The callbacks may call back into us, so work from a copy.
+  CoalescedUniverseMap universes;
+  universes.swap(m_coalesced_universes);
+
+  const Result result(NOT_CONNECTED_ERROR);
+  CoalescedUniverseMap::iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    CoalescedUniverse *state = iter->second;
+    if (state->timeout != ola::thread::INVALID_TIMEOUT) {
+      m_scheduler->RemoveTimeout(state->timeout);
+    }
+    vector<GeneralSetCallback*>::iterator cb_iter = state->callbacks.begin();
+    for (; cb_iter != state->callbacks.end(); ++cb_iter) {
+      (*cb_iter)->Run(result);
+    }
+  }
+  STLDeleteValues(&universes);
+}
+
 void OlaClientCore::ChannelClosed(ClosedCallback *callback,
                                   OLA_UNUSED ola::rpc::RpcSession *session) {
   callback->Run();
 }
 
+void OlaClientCore::HandleDeltaEncoding(RpcController *controller_ptr,
+                                        ola::proto::Ack *reply_ptr) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::Ack> reply(reply_ptr);
+  if (controller->Failed()) {
+    OLA_DEBUG << "Server doesn't support delta encoding: "
+              << controller->ErrorText();
+    return;
+  }
+  m_delta_encoding = true;
+}
+
+void OlaClientCore::HandleDmxBatching(RpcController *controller_ptr,
+                                      ola::proto::Ack *reply_ptr) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::Ack> reply(reply_ptr);
+  if (controller->Failed()) {
+    OLA_DEBUG << "Server doesn't support DMX batching: "
+              << controller->ErrorText();
+  }
+}
+
 
 // The following are RPC callbacks
 
@@ -759,6 +1412,34 @@ void OlaClientCore::HandleDeviceInfo(RpcController *controller_ptr,
   callback->Run(result, ola_devices);
 }
 
+void OlaClientCore::HandleDeviceChanges(RpcController *controller_ptr,
+                                        ola::proto::DeviceInfoReply *reply_ptr,
+                                        DeviceChangesCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::DeviceInfoReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<OlaDevice> ola_devices;
+  vector<unsigned int> removed;
+  uint64_t generation = 0;
+
+  if (!controller->Failed()) {
+    for (int i = 0; i < reply->device_size(); ++i) {
+      ola_devices.push_back(
+          ClientTypesFactory::DeviceFromProtobuf(reply->device(i)));
+    }
+    removed.assign(reply->removed_device().begin(),
+                   reply->removed_device().end());
+    generation = reply->generation();
+  }
+  std::sort(ola_devices.begin(), ola_devices.end());
+  callback->Run(result, ola_devices, removed, generation);
+}
+
 void OlaClientCore::HandleDeviceConfig(RpcController *controller_ptr,
                                        ola::proto::DeviceConfigReply *reply_ptr,
                                        ConfigureDeviceCallback *callback) {
@@ -806,6 +1487,34 @@ void OlaClientCore::HandleGeneralAck(RpcController *controller_ptr,
   callback->Run(result);
 }
 
+void OlaClientCore::HandleCoalescedAck(
+    unsigned int universe,
+    RpcController *controller_ptr,
+    ola::proto::Ack *reply_ptr,
+    vector<GeneralSetCallback*> *callbacks_ptr) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::Ack> reply(reply_ptr);
+  auto_ptr<vector<GeneralSetCallback*> > callbacks(callbacks_ptr);
+
+  // Send the next frame before running the callbacks, so frames they send
+  // are coalesced.
+  CoalescedUniverse *state = STLFindOrNull(m_coalesced_universes, universe);
+  if (state) {
+    if (state->in_flight) {
+      state->in_flight--;
+    }
+    if (!state->in_flight && m_connected) {
+      SendCoalescedDMX(universe, state);
+    }
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<GeneralSetCallback*>::iterator iter = callbacks->begin();
+  for (; iter != callbacks->end(); ++iter) {
+    (*iter)->Run(result);
+  }
+}
+
 void OlaClientCore::HandleUniverseList(RpcController *controller_ptr,
                                        ola::proto::UniverseInfoReply *reply_ptr,
                                        UniverseListCallback *callback) {
@@ -829,6 +1538,34 @@ void OlaClientCore::HandleUniverseList(RpcController *controller_ptr,
   callback->Run(result, ola_universes);
 }
 
+void OlaClientCore::HandleUniverseChanges(
+    RpcController *controller_ptr,
+    ola::proto::UniverseInfoReply *reply_ptr,
+    UniverseChangesCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::UniverseInfoReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<OlaUniverse> ola_universes;
+  vector<unsigned int> removed;
+  uint64_t generation = 0;
+
+  if (!controller->Failed()) {
+    for (int i = 0; i < reply->universe_size(); ++i) {
+      ola_universes.push_back(
+          ClientTypesFactory::UniverseFromProtobuf(reply->universe(i)));
+    }
+    removed.assign(reply->removed_universe().begin(),
+                   reply->removed_universe().end());
+    generation = reply->generation();
+  }
+  callback->Run(result, ola_universes, removed, generation);
+}
+
 void OlaClientCore::HandleUniverseInfo(RpcController *controller_ptr,
                                        ola::proto::UniverseInfoReply *reply_ptr,
                                        UniverseInfoCallback *callback) {
@@ -886,6 +1623,68 @@ void OlaClientCore::HandleGetDmx(RpcController *controller_ptr,
   callback->Run(result, metadata, buffer);
 }
 
+void OlaClientCore::HandleGetDmxBatch(RpcController *controller_ptr,
+                                      ola::proto::DmxBatchReply *reply_ptr,
+                                      DMXBatchCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::DmxBatchReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<DMXFrame> frames;
+  uint64_t generation = 0;
+
+  if (!controller->Failed()) {
+    frames.reserve(reply->data_size());
+    for (int i = 0; i < reply->data_size(); i++) {
+      const ola::proto::DmxData &data = reply->data(i);
+      frames.push_back(DMXFrame(
+          DMXMetadata(data.universe(), data.priority()),
+          DmxBuffer(data.data())));
+    }
+    generation = reply->generation();
+  }
+  callback->Run(result, frames, generation);
+}
+
+void OlaClientCore::HandleGetUniverseStats(
+    RpcController *controller_ptr,
+    ola::proto::UniverseStatsReply *reply_ptr,
+    UniverseStatsCallback *callback) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::UniverseStatsReply> reply(reply_ptr);
+
+  if (!callback) {
+    return;
+  }
+
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  vector<UniverseStats> stats;
+
+  if (!controller->Failed()) {
+    stats.reserve(reply->stats_size());
+    for (int i = 0; i < reply->stats_size(); i++) {
+      const ola::proto::UniverseStats &proto_stats = reply->stats(i);
+      UniverseStats universe_stats;
+      universe_stats.universe = proto_stats.universe();
+      universe_stats.input_frames = proto_stats.input_frames();
+      universe_stats.output_frames = proto_stats.output_frames();
+      universe_stats.active_sources = proto_stats.active_sources();
+      universe_stats.active_priority = proto_stats.active_priority();
+      universe_stats.priority_changes = proto_stats.priority_changes();
+      universe_stats.interval_count = proto_stats.interval_count();
+      universe_stats.interval_sum = proto_stats.interval_sum();
+      universe_stats.interval_sum_squares =
+          proto_stats.interval_sum_squares();
+      stats.push_back(universe_stats);
+    }
+  }
+  callback->Run(result, stats);
+}
+
 void OlaClientCore::HandleUIDList(RpcController *controller_ptr,
                                   ola::proto::UIDListReply *reply_ptr,
                                   DiscoveryCallback *callback) {
@@ -924,24 +1723,25 @@ void OlaClientCore::HandleRDM(RpcController *controller_ptr,
   ola::rdm::RDMResponse *response = NULL;
 
   if (!controller->Failed()) {
-    response = BuildRDMResponse(reply.get(), &metadata.response_code);
-    for (int i = 0; i < reply->raw_frame_size(); i++) {
-      const ola::proto::RDMFrame &proto_frame = reply->raw_frame(i);
-
-      ola::rdm::RDMFrame frame(
-          reinterpret_cast<const uint8_t*>(proto_frame.raw_response().data()),
-          proto_frame.raw_response().size());
-      frame.timing.response_time = proto_frame.timing().response_delay();
-      frame.timing.break_time = proto_frame.timing().break_time();
-      frame.timing.mark_time = proto_frame.timing().mark_time();
-      frame.timing.data_time = proto_frame.timing().data_time();
-      metadata.frames.push_back(frame);
-    }
+    response = ParseRDMReply(*reply, &metadata);
   }
 
   callback->Run(result, metadata, response);
 }
 
+void OlaClientCore::HandleRDMBatchAck(RpcController *controller_ptr,
+                                      ola::proto::Ack *reply_ptr,
+                                      unsigned int batch_id) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::Ack> reply(reply_ptr);
+
+  // The results arrive as separate RDMBatchUpdate calls. If the server
+  // couldn't take the batch, none of them will.
+  if (controller->Failed()) {
+    FailRDMBatch(batch_id, controller->ErrorText());
+  }
+}
+
 void OlaClientCore::GenericFetchCandidatePorts(
     unsigned int universe_id,
     bool include_universe,
@@ -1013,12 +1813,132 @@ void OlaClientCore::SendRDMCommand(bool is_set,
   m_stub->RDMCommand(controller, &request, reply, cb);
 }
 
+/*
+ * Send a batch of rdm commands
+ */
+void OlaClientCore::SendRDMBatch(const SendRDMBatchArgs &args) {
+  if (!args.callback) {
+    OLA_WARN << "RDM batch callback was null, batch won't be sent";
+    return;
+  }
+
+  const unsigned int batch_id = m_next_rdm_batch_id++;
+  PendingRDMBatch *batch = new PendingRDMBatch();
+  batch->callback = args.callback;
+  batch->completed.assign(args.requests.size(), false);
+  batch->outstanding = args.requests.size();
+  m_rdm_batches[batch_id] = batch;
+
+  if (args.requests.empty()) {
+    FailRDMBatch(batch_id, "");
+    return;
+  }
+
+  if (!m_connected) {
+    FailRDMBatch(batch_id, NOT_CONNECTED_ERROR);
+    return;
+  }
+
+  ola::proto::RDMBatchRequest request;
+  request.set_batch_id(batch_id);
+  vector<RDMBatchItem>::const_iterator iter = args.requests.begin();
+  for (; iter != args.requests.end(); ++iter) {
+    ola::proto::RDMRequest *rdm_request = request.add_request();
+    rdm_request->set_universe(iter->universe);
+    ola::proto::UID *pb_uid = rdm_request->mutable_uid();
+    pb_uid->set_esta_id(iter->uid.ManufacturerId());
+    pb_uid->set_device_id(iter->uid.DeviceId());
+    rdm_request->set_sub_device(iter->sub_device);
+    rdm_request->set_param_id(iter->pid);
+    rdm_request->set_is_set(iter->is_set);
+    rdm_request->set_data(iter->data);
+    if (args.include_raw_frames) {
+      rdm_request->set_include_raw_response(true);
+    }
+  }
+
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+  CompletionCallback *cb = NewSingleCallback(
+      this,
+      &OlaClientCore::HandleRDMBatchAck,
+      controller, reply, batch_id);
+  m_stub->RDMCommandBatch(controller, &request, reply, cb);
+}
+
+/*
+ * Run the callback for a request in a batch, deleting the batch once all the
+ * requests have completed.
+ */
+void OlaClientCore::CompleteRDMBatchRequest(
+    unsigned int batch_id,
+    unsigned int index,
+    const Result &result,
+    const RDMMetadata &metadata,
+    const ola::rdm::RDMResponse *response) {
+  PendingRDMBatchMap::iterator iter = m_rdm_batches.find(batch_id);
+  if (iter == m_rdm_batches.end()) {
+    OLA_WARN << "Result for unknown RDM batch " << batch_id;
+    return;
+  }
+
+  PendingRDMBatch *batch = iter->second;
+  if (index >= batch->completed.size() || batch->completed[index]) {
+    OLA_WARN << "Unexpected result " << index << " for RDM batch "
+             << batch_id;
+    return;
+  }
+  batch->completed[index] = true;
+  // The callback may stop the client, which fails the rest of the batch, so
+  // don't touch the batch after running it unless this was the last request.
+  const bool last = --batch->outstanding == 0;
+  if (last) {
+    m_rdm_batches.erase(iter);
+  }
+
+  batch->callback->Run(index, result, metadata, response);
+
+  if (last) {
+    delete batch->callback;
+    delete batch;
+  }
+}
+
+/*
+ * Fail the requests in a batch that haven't completed yet.
+ */
+void OlaClientCore::FailRDMBatch(unsigned int batch_id, const string &error) {
+  PendingRDMBatchMap::iterator iter = m_rdm_batches.find(batch_id);
+  if (iter == m_rdm_batches.end()) {
+    return;
+  }
+
+  PendingRDMBatch *batch = iter->second;
+  m_rdm_batches.erase(iter);
+
+  Result result(error);
+  RDMMetadata metadata;
+  for (unsigned int i = 0; i < batch->completed.size(); i++) {
+    if (!batch->completed[i]) {
+      batch->callback->Run(i, result, metadata, NULL);
+    }
+  }
+  delete batch->callback;
+  delete batch;
+}
+
+void OlaClientCore::FailRDMBatches(const string &error) {
+  while (!m_rdm_batches.empty()) {
+    FailRDMBatch(m_rdm_batches.begin()->first, error);
+  }
+}
+
 /**
  * This constructs a ola::rdm::RDMResponse object from the information in a
  * ola::proto::RDMResponse.
  */
 ola::rdm::RDMResponse *OlaClientCore::BuildRDMResponse(
-    ola::proto::RDMResponse *reply,
+    const ola::proto::RDMResponse *reply,
     ola::rdm::RDMStatusCode *status_code) {
   // Get the response code, if it's not RDM_COMPLETED_OK don't bother with the
   // rest of the response data.
@@ -1075,5 +1995,25 @@ ola::rdm::RDMResponse *OlaClientCore::BuildRDMResponse(
       reinterpret_cast<const uint8_t*>(reply->data().c_str()),
       reply->data().size());
 }
+
+ola::rdm::RDMResponse *OlaClientCore::ParseRDMReply(
+    const ola::proto::RDMResponse &reply,
+    RDMMetadata *metadata) {
+  ola::rdm::RDMResponse *response = BuildRDMResponse(
+      &reply, &metadata->response_code);
+  for (int i = 0; i < reply.raw_frame_size(); i++) {
+    const ola::proto::RDMFrame &proto_frame = reply.raw_frame(i);
+
+    ola::rdm::RDMFrame frame(
+        reinterpret_cast<const uint8_t*>(proto_frame.raw_response().data()),
+        proto_frame.raw_response().size());
+    frame.timing.response_time = proto_frame.timing().response_delay();
+    frame.timing.break_time = proto_frame.timing().break_time();
+    frame.timing.mark_time = proto_frame.timing().mark_time();
+    frame.timing.data_time = proto_frame.timing().data_time();
+    metadata->frames.push_back(frame);
+  }
+  return response;
+}
 }  // namespace client
 }  // namespace ola
@@ -21,14 +21,17 @@
 #ifndef OLA_OLACLIENTCORE_H_
 #define OLA_OLACLIENTCORE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "common/rpc/RpcChannel.h"
 #include "common/rpc/RpcController.h"
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/client/CallbackTypes.h"
 #include "ola/client/ClientArgs.h"
@@ -39,6 +42,7 @@
 #include "ola/plugin_id.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "ola/timecode/TimeCode.h"
 
 namespace ola {
@@ -74,12 +78,35 @@ class OlaClientCore: public ola::proto::OlaClientService {
    */
   void SetDMXCallback(RepeatableDMXCallback *callback);
 
+  /**
+   * @brief Set the callback to be run with a view of the new DMX data.
+   * @param callback the callback to run upon receiving new DMX data, or NULL.
+   * @param start_slot the first slot to include in the view.
+   * @param slot_count the maximum number of slots to include in the view.
+   */
+  void SetDMXViewCallback(RepeatableDMXViewCallback *callback,
+                          unsigned int start_slot,
+                          unsigned int slot_count);
+
+  /**
+   * @brief Set the callback to be run when a polled RDM item changes.
+   * @param callback the callback to run, or NULL. Ownership is transferred.
+   */
+  void SetRDMPollCallback(RepeatableRDMPollCallback *callback);
+
   /**
    * @brief Trigger a plugin reload.
    * @param callback the SetCallback to invoke upon completion.
    */
   void ReloadPlugins(SetCallback *callback);
 
+  /**
+   * @brief Reload a single plugin, leaving the others running.
+   * @param plugin_id the id of the plugin to reload.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ReloadPlugin(ola_plugin_id plugin_id, SetCallback *callback);
+
   /**
    * @brief Fetch the list of plugins loaded.
    * @param callback the PluginListCallback to be invoked upon completion.
@@ -225,6 +252,28 @@ class OlaClientCore: public ola::proto::OlaClientService {
              unsigned int universe,
              SetCallback *callback);
 
+  /**
+   * @brief Patch or unpatch a set of ports.
+   *
+   * Either all of the changes are made or none of them are. The changes are
+   * checked against the patching as it will be once they're all made, so
+   * ports can be swapped between universes.
+   * @param patches the changes to make.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void PatchPorts(const std::vector<PortPatch> &patches,
+                  SetCallback *callback);
+
+  /**
+   * @brief Set the name and merge mode of a set of universes.
+   *
+   * If any of the universes don't exist, no changes are made.
+   * @param universes the universes to configure.
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void ConfigureUniverses(const std::vector<UniverseConfig> &universes,
+                          SetCallback *callback);
+
   /**
    * @brief Register our interest in a universe. The callback set by
    * SetDMXCallback() will be called when new DMX data arrives.
@@ -236,6 +285,61 @@ class OlaClientCore: public ola::proto::OlaClientService {
                         RegisterAction register_action,
                         SetCallback *callback);
 
+  /**
+   * @brief Register our interest in a universe, with limits on the data
+   * that's sent.
+   * @param universe the id of the universe to register for.
+   * @param register_action the action (register or unregister)
+   * @param args the RegisterArgs to use for this call.
+   */
+  void RegisterUniverse(unsigned int universe,
+                        RegisterAction register_action,
+                        const RegisterArgs &args);
+
+  /**
+   * @brief Ask the server to poll the responders in a universe. The callback
+   * set by SetRDMPollCallback() is run when a result changes.
+   * @param universe the id of the universe to poll.
+   * @param register_action the action (register or unregister)
+   * @param args the RDMPollArgs to use for this call.
+   */
+  void RegisterForRDMPoll(unsigned int universe,
+                          RegisterAction register_action,
+                          const RDMPollArgs &args);
+
+  /**
+   * @brief Set the callback to be run when universes or devices change.
+   * @param callback the callback to run, or NULL. Ownership is transferred.
+   */
+  void SetInfoChangesCallback(RepeatableInfoChangesCallback *callback);
+
+  /**
+   * @brief Ask the server to tell us when universes or devices change. The
+   * callback set by SetInfoChangesCallback() is run with the changes.
+   * @param register_action the action (register or unregister)
+   * @param callback the SetCallback to invoke upon completion.
+   */
+  void RegisterForInfoUpdates(RegisterAction register_action,
+                              SetCallback *callback);
+
+  /**
+   * @brief Fetch the universes that changed since a generation.
+   * @param since_generation the generation from a previous call, or from
+   *   InfoChanges.
+   * @param callback the UniverseChangesCallback to invoke upon completion.
+   */
+  void FetchUniverseChanges(uint64_t since_generation,
+                            UniverseChangesCallback *callback);
+
+  /**
+   * @brief Fetch the devices that changed since a generation.
+   * @param since_generation the generation from a previous call, or from
+   *   InfoChanges.
+   * @param callback the DeviceChangesCallback to invoke upon completion.
+   */
+  void FetchDeviceChanges(uint64_t since_generation,
+                          DeviceChangesCallback *callback);
+
   /**
    * @brief Send DMX data.
    * @param universe the universe to send to.
@@ -246,6 +350,49 @@ class OlaClientCore: public ola::proto::OlaClientService {
                const DmxBuffer &data,
                const SendDMXArgs &args);
 
+  /**
+   * @brief Coalesce the frames passed to SendDMX().
+   * @param scheduler the scheduler used to combine the frames sent in one
+   *   loop iteration, and to send a frame if the previous one hasn't been
+   *   acked within interval. May be NULL, ownership isn't transferred.
+   * @param interval how long to wait for the ack. Zero means wait for the
+   *   ack.
+   *
+   * See OlaClient::EnableDMXCoalescing().
+   */
+  void EnableDMXCoalescing(ola::thread::SchedulerInterface *scheduler,
+                           const TimeInterval &interval);
+
+  /**
+   * @brief Send any coalesced frames, and go back to sending every frame.
+   */
+  void DisableDMXCoalescing();
+
+  /**
+   * @brief Send the coalesced frames now, without waiting for the acks.
+   */
+  void FlushDMX();
+
+  /**
+   * @brief Return the counters for the frames sent with coalescing enabled.
+   */
+  const SendDMXCounters &DMXCounters() const { return m_dmx_counters; }
+
+  /**
+   * @brief Ask the server to fade our data for a universe to new values.
+   * @param universe the universe to fade.
+   * @param data the values to fade to, starting at args.start_slot.
+   * @param duration_ms the length of the fade in milliseconds.
+   * @param args the FadeDMXArgs to use for this call.
+   *
+   * The fade starts from the last data we sent for the universe. Sending DMX
+   * data for the universe stops the fade.
+   */
+  void FadeDMX(unsigned int universe,
+               const DmxBuffer &data,
+               unsigned int duration_ms,
+               const FadeDMXArgs &args);
+
   /**
    * @brief Fetch the latest DMX data for a universe.
    * @param universe the universe id to get data for.
@@ -253,6 +400,18 @@ class OlaClientCore: public ola::proto::OlaClientService {
    */
   void FetchDMX(unsigned int universe, DMXCallback *callback);
 
+  /**
+   * @brief Fetch the latest DMX data for a set of universes in one request.
+   * @param args the FetchDMXBatchArgs.
+   */
+  void FetchDMXBatch(const FetchDMXBatchArgs &args);
+
+  /**
+   * @brief Fetch the counters for a set of universes in one request.
+   * @param args the FetchUniverseStatsArgs.
+   */
+  void FetchUniverseStats(const FetchUniverseStatsArgs &args);
+
   /**
    * @brief Trigger discovery for a universe.
    * @param universe the universe id to run discovery on.
@@ -306,6 +465,17 @@ class OlaClientCore: public ola::proto::OlaClientService {
               unsigned int data_length,
               const SendRDMArgs& args);
 
+  /**
+   * @brief Send a batch of RDM Get and Set Commands in a single call.
+   *
+   * This avoids a round trip to the server for each request. The requests
+   * are sent to the responders in order, and the callback is run as each one
+   * completes.
+   * @param args the batch arguments which includes the requests and the
+   *   callback to run.
+   */
+  void SendRDMBatch(const SendRDMBatchArgs &args);
+
   /**
    * @brief Send TimeCode data.
    * @param timecode The timecode data.
@@ -322,15 +492,142 @@ class OlaClientCore: public ola::proto::OlaClientService {
                      ola::proto::Ack* response,
                      CompletionCallback* done);
 
+  /**
+   * @brief This is called by the channel when new DMX data for more than
+   * one universe arrives.
+   */
+  void UpdateDmxDataBatch(ola::rpc::RpcController* controller,
+                          const ola::proto::DmxDataBatch* request,
+                          ola::proto::Ack* response,
+                          CompletionCallback* done);
+
+  /**
+   * @brief This is called by the channel when a polled RDM item changes.
+   */
+  void RDMPollUpdate(ola::rpc::RpcController* controller,
+                     const ola::proto::RDMPollResult* request,
+                     ola::proto::Ack* response,
+                     CompletionCallback* done);
+
+  /**
+   * @brief This is called by the channel when a request in a batch
+   * completes.
+   */
+  void RDMBatchUpdate(ola::rpc::RpcController* controller,
+                      const ola::proto::RDMBatchResult* request,
+                      ola::proto::Ack* response,
+                      CompletionCallback* done);
+
+  /**
+   * @brief This is called by the channel when universes or devices change.
+   */
+  void InfoUpdate(ola::rpc::RpcController* controller,
+                  const ola::proto::InfoChanges* request,
+                  ola::proto::Ack* response,
+                  CompletionCallback* done);
+
  private:
   ola::io::ConnectedDescriptor *m_descriptor;
   std::auto_ptr<RepeatableDMXCallback> m_dmx_callback;
+  std::auto_ptr<RepeatableDMXViewCallback> m_dmx_view_callback;
+  std::auto_ptr<RepeatableRDMPollCallback> m_rdm_poll_callback;
+  std::auto_ptr<RepeatableInfoChangesCallback> m_info_changes_callback;
+  unsigned int m_view_start_slot;
+  unsigned int m_view_slot_count;
   std::auto_ptr<ola::rpc::RpcChannel> m_channel;
   std::auto_ptr<ola::proto::OlaServerService_Stub> m_stub;
   int m_connected;
+  // True once the server has accepted delta encoded updates.
+  bool m_delta_encoding;
+  // The last frame sent and received for each universe, the bases for delta
+  // encoding.
+  std::map<unsigned int, DmxBuffer> m_last_sent;
+  std::map<unsigned int, DmxBuffer> m_last_received;
+
+  // The coalescing state of a universe.
+  struct CoalescedUniverse {
+    // The newest frame, if pending is true it hasn't been sent yet.
+    DmxBuffer data;
+    uint8_t priority;
+    bool pending;
+    // The callbacks to run once the pending frame is acked.
+    std::vector<GeneralSetCallback*> callbacks;
+    unsigned int in_flight;
+    TimeStamp last_sent;
+    ola::thread::timeout_id timeout;
+
+    CoalescedUniverse()
+        : priority(0),
+          pending(false),
+          in_flight(0),
+          timeout(ola::thread::INVALID_TIMEOUT) {
+    }
+  };
+  typedef std::map<unsigned int, CoalescedUniverse*> CoalescedUniverseMap;
+
+  bool m_coalesce_dmx;
+  ola::thread::SchedulerInterface *m_scheduler;
+  TimeInterval m_coalesce_interval;
+  CoalescedUniverseMap m_coalesced_universes;
+  SendDMXCounters m_dmx_counters;
+  ola::Clock m_clock;
+
+  // A batch of RDM requests waiting for results from the server.
+  struct PendingRDMBatch {
+    RDMBatchCallback *callback;
+    std::vector<bool> completed;
+    unsigned int outstanding;
+  };
+  typedef std::map<unsigned int, PendingRDMBatch*> PendingRDMBatchMap;
+
+  PendingRDMBatchMap m_rdm_batches;
+  unsigned int m_next_rdm_batch_id;
+
+  void BuildDmxRequest(unsigned int universe,
+                       const DmxBuffer &data,
+                       uint8_t priority,
+                       ola::proto::DmxData *request);
+  void CoalesceDMX(unsigned int universe,
+                   const DmxBuffer &data,
+                   const SendDMXArgs &args);
+  void SendCoalescedDMX(unsigned int universe, CoalescedUniverse *state);
+  void CoalesceTimeout(unsigned int universe);
+  void ClearCoalescedUniverses();
+  void CompleteRDMBatchRequest(unsigned int batch_id,
+                               unsigned int index,
+                               const Result &result,
+                               const RDMMetadata &metadata,
+                               const ola::rdm::RDMResponse *response);
+  void FailRDMBatch(unsigned int batch_id, const std::string &error);
+  void FailRDMBatches(const std::string &error);
+  void HandleDmxData(const ola::proto::DmxData &request);
+  bool ViewChanged(const ola::proto::DmxData &request) const;
+  void RunDMXViewCallback(const DMXMetadata &metadata,
+                          const uint8_t *data,
+                          unsigned int size);
+
+  /**
+   * @brief Called when a coalesced frame is acked.
+   */
+  void HandleCoalescedAck(unsigned int universe,
+                          ola::rpc::RpcController *controller,
+                          ola::proto::Ack *reply,
+                          std::vector<GeneralSetCallback*> *callbacks);
 
   void ChannelClosed(ClosedCallback *callback, ola::rpc::RpcSession *session);
 
+  /**
+   * @brief Called when SetDeltaEncoding() completes.
+   */
+  void HandleDeltaEncoding(ola::rpc::RpcController *controller,
+                           ola::proto::Ack *reply);
+
+  /**
+   * @brief Called when SetDmxBatching() completes.
+   */
+  void HandleDmxBatching(ola::rpc::RpcController *controller,
+                         ola::proto::Ack *reply);
+
   /**
    * @brief Called when GetPlugins() completes.
    */
@@ -387,6 +684,20 @@ class OlaClientCore: public ola::proto::OlaClientService {
                           ola::proto::UniverseInfoReply *reply,
                           UniverseListCallback *callback);
 
+  /**
+   * @brief Called when a GetUniverseInfo() request for changes completes.
+   */
+  void HandleUniverseChanges(ola::rpc::RpcController *controller,
+                             ola::proto::UniverseInfoReply *reply,
+                             UniverseChangesCallback *callback);
+
+  /**
+   * @brief Called when a GetDeviceInfo() request for changes completes.
+   */
+  void HandleDeviceChanges(ola::rpc::RpcController *controller,
+                           ola::proto::DeviceInfoReply *reply,
+                           DeviceChangesCallback *callback);
+
   /**
    * @brief Called when a GetUniverseInfo() request completes.
    */
@@ -401,6 +712,20 @@ class OlaClientCore: public ola::proto::OlaClientService {
                     ola::proto::DmxData *reply,
                     DMXCallback *callback);
 
+  /**
+   * @brief Called when a GetDmxBatch() request completes.
+   */
+  void HandleGetDmxBatch(ola::rpc::RpcController *controller,
+                         ola::proto::DmxBatchReply *reply,
+                         DMXBatchCallback *callback);
+
+  /**
+   * @brief Called when a GetUniverseStats() request completes.
+   */
+  void HandleGetUniverseStats(ola::rpc::RpcController *controller,
+                              ola::proto::UniverseStatsReply *reply,
+                              UniverseStatsCallback *callback);
+
   /**
    * @brief Called when a RunDiscovery() request completes.
    */
@@ -415,6 +740,13 @@ class OlaClientCore: public ola::proto::OlaClientService {
                  ola::proto::RDMResponse *reply,
                  RDMCallback *callback);
 
+  /**
+   * @brief Called when the server acknowledges a batch of RDM requests.
+   */
+  void HandleRDMBatchAck(ola::rpc::RpcController *controller,
+                         ola::proto::Ack *reply,
+                         unsigned int batch_id);
+
   /**
    * @brief Fetch a list of candidate ports, with or without a universe
    */
@@ -438,9 +770,16 @@ class OlaClientCore: public ola::proto::OlaClientService {
    * @brief Builds a RDMResponse from the server's RDM reply message.
    */
   ola::rdm::RDMResponse *BuildRDMResponse(
-      ola::proto::RDMResponse *reply,
+      const ola::proto::RDMResponse *reply,
       ola::rdm::RDMStatusCode *status_code);
 
+  /**
+   * @brief Fills in the RDMMetadata from the server's RDM reply message.
+   * @returns the RDMResponse, which the caller owns.
+   */
+  ola::rdm::RDMResponse *ParseRDMReply(const ola::proto::RDMResponse &reply,
+                                       RDMMetadata *metadata);
+
   static const char NOT_CONNECTED_ERROR[];
 
   DISALLOW_COPY_AND_ASSIGN(OlaClientCore);
@@ -21,46 +21,75 @@
 #include <ola/AutoStart.h>  // NOLINT(build/include)
 // ola/StreamingClient.h deprecated
 #include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <ola/client/StreamingClient.h>
 #include <ola/io/SelectServer.h>
 #include <ola/network/IPV4Address.h>
+#include <ola/network/Socket.h>
 #include <ola/network/SocketAddress.h>
-#include <ola/network/TCPSocket.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "common/dmx/SharedDmxRegion.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
 
 namespace ola {
 namespace client {
 
 using ola::io::SelectServer;
-using ola::network::TCPSocket;
 using ola::proto::OlaServerService_Stub;
+using ola::dmx::SharedDmxRegion;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
 using ola::rpc::RpcChannel;
 
+const unsigned int StreamingClient::SHARED_DMX_SLOTS = 512;
+const unsigned int StreamingClient::SETUP_TIMEOUT_MS = 1000;
+// Keep datagrams within a typical Ethernet MTU.
+const unsigned int StreamingClient::MAX_UDP_FRAME_SIZE = 1400;
+
 StreamingClient::StreamingClient(bool auto_start)
     : m_auto_start(auto_start),
       m_server_port(OLA_DEFAULT_PORT),
+      m_use_shared_memory(false),
+      m_use_udp(false),
       m_socket(NULL),
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_socket_closed(false),
+      m_shared_dmx(NULL),
+      m_udp_socket(NULL),
+      m_udp_port(0),
+      m_udp_token(0),
+      m_udp_sequence(0) {
 }
 
 StreamingClient::StreamingClient(const Options &options)
     : m_auto_start(options.auto_start),
       m_server_port(options.server_port),
+      m_use_shared_memory(options.use_shared_memory),
+      m_use_udp(options.use_udp),
       m_socket(NULL),
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_socket_closed(false),
+      m_shared_dmx(NULL),
+      m_udp_socket(NULL),
+      m_udp_port(0),
+      m_udp_token(0),
+      m_udp_sequence(0) {
 }
 
 StreamingClient::~StreamingClient() {
@@ -74,9 +103,7 @@ bool StreamingClient::Setup() {
   if (m_auto_start)
     m_socket = ola::client::ConnectToServer(m_server_port);
   else
-    m_socket = TCPSocket::Connect(
-      ola::network::IPV4SocketAddress(ola::network::IPV4Address::Loopback(),
-                                      m_server_port));
+    m_socket = ola::client::ConnectToRunningServer(m_server_port);
 
   if (!m_socket)
     return false;
@@ -105,10 +132,30 @@ bool StreamingClient::Setup() {
   m_channel->SetChannelCloseHandler(
       NewSingleCallback(this, &StreamingClient::ChannelClosed));
 
+  if (m_use_shared_memory && !SetupSharedDmx()) {
+    if (!m_stub) {
+      // the connection was closed
+      return false;
+    }
+    OLA_INFO << "Shared memory isn't available, falling back to RPCs";
+  }
+
+  if (m_use_udp && !SetupUdp()) {
+    if (!m_stub) {
+      return false;
+    }
+    OLA_INFO << "UDP streaming isn't available, falling back to RPCs";
+  }
   return true;
 }
 
 void StreamingClient::Stop() {
+  if (m_shared_dmx)
+    delete m_shared_dmx;
+
+  if (m_udp_socket)
+    delete m_udp_socket;
+
   if (m_stub)
     delete m_stub;
 
@@ -125,6 +172,9 @@ void StreamingClient::Stop() {
   m_socket = NULL;
   m_ss = NULL;
   m_stub = NULL;
+  m_shared_dmx = NULL;
+  m_shared_slots.clear();
+  m_udp_socket = NULL;
 }
 
 bool StreamingClient::SendDmx(unsigned int universe,
@@ -138,8 +188,123 @@ bool StreamingClient::SendDMX(unsigned int universe,
   return Send(universe, args.priority, data);
 }
 
+bool StreamingClient::SendBatch(const std::vector<DmxUpdate> &updates) {
+  if (!CheckConnection())
+    return false;
+
+  // Anything that doesn't fit in the shared region goes over UDP or the RPC
+  // connection.
+  ola::proto::DmxDataBatch request;
+  ola::proto::UdpDmxFrame frame;
+  unsigned int frame_size = 0;
+  bool shared_updated = false;
+  unsigned int first_slot = 0, last_slot = 0;
+  std::vector<DmxUpdate>::const_iterator iter = updates.begin();
+  for (; iter != updates.end(); ++iter) {
+    unsigned int slot;
+    if (WriteSharedDmx(iter->universe, iter->priority, iter->data, &slot)) {
+      if (!shared_updated) {
+        first_slot = last_slot = slot;
+        shared_updated = true;
+      } else {
+        first_slot = std::min(first_slot, slot);
+        last_slot = std::max(last_slot, slot);
+      }
+      continue;
+    }
+    if (m_udp_socket) {
+      // Allow a few bytes for the field tags and lengths.
+      const unsigned int size = iter->data.Size() + 16;
+      if (frame.data_size() && frame_size + size > MAX_UDP_FRAME_SIZE) {
+        SendUdpFrame(&frame);
+        frame_size = 0;
+      }
+      ola::proto::DmxData *data = frame.add_data();
+      data->set_universe(iter->universe);
+      data->set_data(iter->data.Get());
+      data->set_priority(iter->priority);
+      frame_size += size;
+      continue;
+    }
+    ola::proto::DmxData *data = request.add_data();
+    data->set_universe(iter->universe);
+    data->set_data(iter->data.Get());
+    data->set_priority(iter->priority);
+  }
+
+  if (shared_updated) {
+    NotifySharedDmx(first_slot, last_slot);
+  }
+  if (frame.data_size()) {
+    SendUdpFrame(&frame);
+  }
+  if (request.data_size()) {
+    m_stub->StreamDmxDataBatch(NULL, &request, NULL, NULL);
+  }
+
+  if (m_socket_closed) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+bool StreamingClient::SendRange(unsigned int first_universe,
+                                const uint8_t *data,
+                                unsigned int length,
+                                unsigned int slots_per_universe,
+                                const SendArgs &args) {
+  if (!CheckConnection())
+    return false;
+
+  ola::proto::DmxRange request;
+  request.set_first_universe(first_universe);
+  request.set_data(data, length);
+  request.set_priority(args.priority);
+  request.set_slots_per_universe(slots_per_universe);
+  m_stub->StreamDmxRange(NULL, &request, NULL, NULL);
+
+  if (m_socket_closed) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
 bool StreamingClient::Send(unsigned int universe, uint8_t priority,
                            const DmxBuffer &data) {
+  if (!CheckConnection())
+    return false;
+
+  unsigned int slot;
+  if (WriteSharedDmx(universe, priority, data, &slot)) {
+    NotifySharedDmx(slot, slot);
+  } else if (m_udp_socket) {
+    ola::proto::UdpDmxFrame frame;
+    ola::proto::DmxData *request = frame.add_data();
+    request->set_universe(universe);
+    request->set_data(data.Get());
+    request->set_priority(priority);
+    SendUdpFrame(&frame);
+  } else {
+    ola::proto::DmxData request;
+    request.set_universe(universe);
+    request.set_data(data.Get());
+    request.set_priority(priority);
+    m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+  }
+
+  if (m_socket_closed) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Check if the connection to the server is still valid.
+ */
+bool StreamingClient::CheckConnection() {
   if (!m_stub || !m_socket->ValidReadDescriptor())
     return false;
 
@@ -153,20 +318,145 @@ bool StreamingClient::Send(unsigned int universe, uint8_t priority,
     Stop();
     return false;
   }
+  return true;
+}
 
-  ola::proto::DmxData request;
-  request.set_universe(universe);
-  request.set_data(data.Get());
-  request.set_priority(priority);
-  m_stub->StreamDmxData(NULL, &request, NULL, NULL);
+/*
+ * Wait for the reply to one of the setup RPCs.
+ */
+bool StreamingClient::WaitForSetup(const bool *done) {
+  Clock clock;
+  TimeStamp now, deadline;
+  clock.CurrentTime(&now);
+  deadline = now + TimeInterval(SETUP_TIMEOUT_MS * 1000);
+  while (!*done && !m_socket_closed && now < deadline) {
+    m_ss->RunOnce(deadline - now);
+    clock.CurrentTime(&now);
+  }
 
-  if (m_socket_closed) {
+  if (!*done) {
+    // The callback references our stack, so we can't carry on using this
+    // connection.
+    OLA_WARN << "Timeout waiting for the setup reply";
     Stop();
     return false;
   }
   return true;
 }
 
+void StreamingClient::SetupComplete(bool *done) {
+  *done = true;
+}
+
+/*
+ * Ask olad for a shared memory region, and wait for the reply.
+ */
+bool StreamingClient::SetupSharedDmx() {
+  if (!SharedDmxRegion::IsSupported())
+    return false;
+
+  ola::rpc::RpcController controller;
+  ola::proto::SharedDmxRequest request;
+  ola::proto::SharedDmxReply reply;
+  bool done = false;
+  request.set_slots(SHARED_DMX_SLOTS);
+  m_stub->SetupSharedDmx(
+      &controller, &request, &reply,
+      NewSingleCallback(this, &StreamingClient::SetupComplete, &done));
+
+  if (!WaitForSetup(&done)) {
+    return false;
+  }
+  if (controller.Failed()) {
+    OLA_INFO << "Failed to setup shared memory: " << controller.ErrorText();
+    return false;
+  }
+
+  m_shared_dmx = SharedDmxRegion::Open(reply.name());
+  // Once we have it open, the name isn't needed anymore.
+  SharedDmxRegion::Unlink(reply.name());
+  return m_shared_dmx != NULL;
+}
+
+
+/*
+ * Write a universe to the shared region, if there's space for it.
+ */
+bool StreamingClient::WriteSharedDmx(unsigned int universe,
+                                     uint8_t priority,
+                                     const DmxBuffer &data,
+                                     unsigned int *slot) {
+  if (!m_shared_dmx)
+    return false;
+
+  SharedSlotMap::const_iterator iter = m_shared_slots.find(universe);
+  if (iter == m_shared_slots.end()) {
+    if (m_shared_slots.size() >= m_shared_dmx->SlotCount())
+      return false;
+    *slot = m_shared_slots.size();
+    m_shared_slots[universe] = *slot;
+  } else {
+    *slot = iter->second;
+  }
+  return m_shared_dmx->Write(*slot, universe, priority, data);
+}
+
+/*
+ * Tell olad which slots were written, so it only has to check those.
+ */
+void StreamingClient::NotifySharedDmx(unsigned int first_slot,
+                                      unsigned int last_slot) {
+  ola::proto::SharedDmxNotification notification;
+  notification.set_first_slot(first_slot);
+  notification.set_slot_count(last_slot - first_slot + 1);
+  m_stub->StreamSharedDmx(NULL, &notification, NULL, NULL);
+}
+
+/*
+ * Ask olad for a UDP port and token, and wait for the reply.
+ */
+bool StreamingClient::SetupUdp() {
+  ola::rpc::RpcController controller;
+  ola::proto::UdpStreamRequest request;
+  ola::proto::UdpStreamReply reply;
+  bool done = false;
+  m_stub->SetupUdpStream(
+      &controller, &request, &reply,
+      NewSingleCallback(this, &StreamingClient::SetupComplete, &done));
+
+  if (!WaitForSetup(&done)) {
+    return false;
+  }
+  if (controller.Failed()) {
+    OLA_INFO << "Failed to setup UDP streaming: " << controller.ErrorText();
+    return false;
+  }
+
+  UDPSocket *socket = new UDPSocket();
+  if (!socket->Init()) {
+    delete socket;
+    return false;
+  }
+  m_udp_socket = socket;
+  m_udp_port = static_cast<uint16_t>(reply.port());
+  m_udp_token = reply.token();
+  m_udp_sequence = 0;
+  return true;
+}
+
+void StreamingClient::SendUdpFrame(ola::proto::UdpDmxFrame *frame) {
+  frame->set_token(m_udp_token);
+  frame->set_sequence(m_udp_sequence++);
+  std::string output;
+  frame->SerializeToString(&output);
+  // olad only accepts RPCs on the loopback interface.
+  m_udp_socket->SendTo(reinterpret_cast<const uint8_t*>(output.data()),
+                       static_cast<unsigned int>(output.size()),
+                       IPV4SocketAddress(IPV4Address::Loopback(),
+                                         m_udp_port));
+  frame->clear_data();
+}
+
 void StreamingClient::ChannelClosed(OLA_UNUSED ola::rpc::RpcSession *session) {
   m_socket_closed = true;
   OLA_WARN << "The RPC socket has been closed, this is more than likely due"
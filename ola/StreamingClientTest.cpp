@@ -21,12 +21,20 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/StreamingClient.h"
+#include "ola/client/OlaClient.h"
+#include "ola/client/ThreadedStreamingClient.h"
 #include "ola/base/Flags.h"
+#include "ola/io/SelectServer.h"
 #include "ola/network/SocketAddress.h"
+#include "ola/network/TCPSocket.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "ola/thread/Thread.h"
 #include "olad/OlaDaemon.h"
@@ -35,25 +43,92 @@ DECLARE_uint16(rpc_port);
 
 static unsigned int TEST_UNIVERSE = 1;
 
+using ola::DmxBuffer;
+using ola::NewCallback;
+using ola::NewSingleCallback;
 using ola::OlaDaemon;
 using ola::StreamingClient;
+using ola::TimeInterval;
+using ola::client::DMXMetadata;
+using ola::client::OlaClient;
+using ola::client::RDMBatchItem;
+using ola::client::RDMMetadata;
+using ola::client::Result;
+using ola::client::SendDMXArgs;
+using ola::client::SendRDMBatchArgs;
+using ola::client::SendDMXCounters;
+using ola::client::ThreadedStreamingClient;
+using ola::io::SelectServer;
 using ola::network::GenericSocketAddress;
+using ola::network::TCPSocket;
+using ola::rdm::UID;
 using ola::thread::ConditionVariable;
 using ola::thread::Mutex;
 using std::auto_ptr;
+using std::string;
+using std::vector;
 
 class StreamingClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(StreamingClientTest);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testThreadedClient);
+  CPPUNIT_TEST(testCoalescedDMX);
+  CPPUNIT_TEST(testRDMBatch);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void setUp();
     void tearDown();
     void testSendDMX();
+    void testThreadedClient();
+    void testCoalescedDMX();
+    void testRDMBatch();
 
  private:
     class OlaServerThread *m_server_thread;
+    SelectServer *m_client_ss;
+    unsigned int m_outstanding;
+    unsigned int m_failures;
+    DmxBuffer m_fetched[2];
+    vector<unsigned int> m_rdm_calls;
+    vector<ola::rdm::rdm_response_code> m_rdm_codes;
+
+    void FatalTimeout() {
+      OLA_FAIL("Fatal Timeout");
+    }
+
+    void CompleteSet(const Result &result) {
+      CompleteCall(result);
+    }
+
+    void CompleteFetch(unsigned int index, const Result &result,
+                       const DMXMetadata&, const DmxBuffer &data) {
+      m_fetched[index] = data;
+      CompleteCall(result);
+    }
+
+    void CompleteRDMBatchRequest(unsigned int index, const Result &result,
+                                 const RDMMetadata &metadata,
+                                 const ola::rdm::RDMResponse*) {
+      if (index < m_rdm_calls.size()) {
+        m_rdm_calls[index]++;
+        m_rdm_codes[index] = metadata.response_code;
+      }
+      CompleteCall(result);
+    }
+
+    // This doesn't assert, since the client runs the callbacks that are
+    // still pending when it's destroyed.
+    void CompleteCall(const Result &result) {
+      if (!result.Success()) {
+        m_failures++;
+      }
+      if (m_outstanding && --m_outstanding == 0) {
+        m_client_ss->Terminate();
+      }
+    }
+
+    void RunUntilComplete(unsigned int calls);
 };
 
 
@@ -94,6 +169,13 @@ bool OlaServerThread::Setup() {
   ola_options.http_enable_quit = false;
   ola_options.http_port = 0;
   ola_options.http_data_dir = "";
+  ola_options.http_threads = 0;
+  ola_options.http_connection_limit = 0;
+  ola_options.http_connection_timeout = 0;
+  ola_options.max_universe_frame_rate = 0;
+  ola_options.worker_loops = 0;
+  ola_options.worker_loop_numa = false;
+  ola_options.use_timer_wheel = true;
 
   // pick an unused port
   auto_ptr<OlaDaemon> olad(new OlaDaemon(ola_options, NULL));
@@ -203,7 +285,40 @@ void StreamingClientTest::testSendDMX() {
   OLA_ASSERT_FALSE(ola_client.Setup());
 
   OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+
+  // Send a batch
+  std::vector<StreamingClient::DmxUpdate> updates;
+  updates.push_back(StreamingClient::DmxUpdate(TEST_UNIVERSE, buffer));
+  updates.push_back(
+      StreamingClient::DmxUpdate(TEST_UNIVERSE + 1, buffer, 150));
+  OLA_ASSERT_TRUE(ola_client.SendBatch(updates));
+
+  // And a range of universes
+  std::vector<uint8_t> range(3 * ola::DMX_UNIVERSE_SIZE, 0);
+  OLA_ASSERT_TRUE(ola_client.SendRange(TEST_UNIVERSE, &range[0],
+                                       range.size()));
   ola_client.Stop();
+  OLA_ASSERT_FALSE(ola_client.SendBatch(updates));
+  OLA_ASSERT_FALSE(ola_client.SendRange(TEST_UNIVERSE, &range[0],
+                                        range.size()));
+
+  // Try again with shared memory, this falls back to RPCs if shared memory
+  // isn't available.
+  options.use_shared_memory = true;
+  StreamingClient shared_client(options);
+  OLA_ASSERT_TRUE(shared_client.Setup());
+  OLA_ASSERT_TRUE(shared_client.SendDmx(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_TRUE(shared_client.SendBatch(updates));
+  shared_client.Stop();
+
+  // And over UDP.
+  options.use_shared_memory = false;
+  options.use_udp = true;
+  StreamingClient udp_client(options);
+  OLA_ASSERT_TRUE(udp_client.Setup());
+  OLA_ASSERT_TRUE(udp_client.SendDmx(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_TRUE(udp_client.SendBatch(updates));
+  udp_client.Stop();
 
   // Now reconnect
   OLA_ASSERT_TRUE(ola_client.Setup());
@@ -221,3 +336,174 @@ void StreamingClientTest::testSendDMX() {
 
   OLA_ASSERT_FALSE(ola_client.Setup());
 }
+
+
+/*
+ * Check the ThreadedStreamingClient.
+ */
+void StreamingClientTest::testThreadedClient() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+  ThreadedStreamingClient::Options options;
+  options.client_options.auto_start = false;
+  options.client_options.server_port = server_address.V4Addr().Port();
+  ThreadedStreamingClient ola_client(options);
+
+  ola::DmxBuffer buffer;
+  buffer.Blackout();
+
+  OLA_ASSERT_TRUE(ola_client.AddUniverse(TEST_UNIVERSE));
+  OLA_ASSERT_TRUE(ola_client.Setup());
+  OLA_ASSERT_FALSE(ola_client.Setup());
+  // Universes can't be added once the client is running.
+  OLA_ASSERT_FALSE(ola_client.AddUniverse(TEST_UNIVERSE + 1));
+
+  OLA_ASSERT_TRUE(ola_client.SendDMX(TEST_UNIVERSE, buffer));
+  buffer.SetChannel(0, 255);
+  OLA_ASSERT_TRUE(ola_client.SendDMX(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_FALSE(ola_client.SendDMX(TEST_UNIVERSE + 1, buffer));
+  ola_client.Stop();
+
+  // Frames can still be queued once the client has stopped.
+  OLA_ASSERT_TRUE(ola_client.SendDMX(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_TRUE(ola_client.Setup());
+  ola_client.Stop();
+}
+
+
+/*
+ * Check that OlaClient coalesces the frames sent for a universe in one loop
+ * iteration into a single RPC, without merging different universes.
+ */
+void StreamingClientTest::testCoalescedDMX() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+
+  SelectServer ss;
+  m_client_ss = &ss;
+  m_outstanding = 0;
+  auto_ptr<TCPSocket> socket(TCPSocket::Connect(server_address));
+  OLA_ASSERT_NOT_NULL(socket.get());
+  OlaClient client(socket.get());
+  OLA_ASSERT_TRUE(ss.AddReadDescriptor(socket.get()));
+  OLA_ASSERT_TRUE(client.Setup());
+
+  // Registering creates the universes, so the data can be fetched back.
+  client.RegisterUniverse(
+      TEST_UNIVERSE, ola::client::REGISTER,
+      NewSingleCallback(this, &StreamingClientTest::CompleteSet));
+  client.RegisterUniverse(
+      TEST_UNIVERSE + 1, ola::client::REGISTER,
+      NewSingleCallback(this, &StreamingClientTest::CompleteSet));
+  RunUntilComplete(2);
+
+  client.EnableDMXCoalescing(&ss, TimeInterval());
+  DmxBuffer buffer;
+  for (uint8_t value = 1; value <= 3; value++) {
+    buffer.SetChannel(0, value);
+    client.SendDMX(TEST_UNIVERSE, buffer, SendDMXArgs(
+        NewSingleCallback(this, &StreamingClientTest::CompleteSet)));
+  }
+  buffer.SetChannel(0, 10);
+  client.SendDMX(TEST_UNIVERSE + 1, buffer, SendDMXArgs(
+      NewSingleCallback(this, &StreamingClientTest::CompleteSet)));
+
+  const SendDMXCounters &counters = client.DMXCounters();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), counters.frames_queued);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), counters.frames_sent);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.frames_coalesced);
+
+  // Every callback runs, once the frame that replaced it is acked.
+  RunUntilComplete(4);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.frames_sent);
+
+  client.FetchDMX(TEST_UNIVERSE, NewSingleCallback(
+      this, &StreamingClientTest::CompleteFetch, 0u));
+  client.FetchDMX(TEST_UNIVERSE + 1, NewSingleCallback(
+      this, &StreamingClientTest::CompleteFetch, 1u));
+  RunUntilComplete(2);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(3), m_fetched[0].Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(10), m_fetched[1].Get(0));
+
+  client.Stop();
+  ss.RemoveReadDescriptor(socket.get());
+  m_client_ss = NULL;
+}
+
+
+void StreamingClientTest::RunUntilComplete(unsigned int calls) {
+  m_outstanding = calls;
+  m_failures = 0;
+  ola::thread::timeout_id timeout = m_client_ss->RegisterSingleTimeout(
+      2000, NewSingleCallback(this, &StreamingClientTest::FatalTimeout));
+  m_client_ss->Run();
+  m_client_ss->RemoveTimeout(timeout);
+  OLA_ASSERT_EQ(0u, m_outstanding);
+  OLA_ASSERT_EQ(0u, m_failures);
+}
+
+
+/*
+ * Check that OlaClient::SendRDMBatch runs the callback exactly once for each
+ * request, when some of the requests in the batch fail.
+ */
+void StreamingClientTest::testRDMBatch() {
+  m_server_thread->WaitForStart();
+  GenericSocketAddress server_address = m_server_thread->RPCAddress();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(AF_INET), server_address.Family());
+
+  SelectServer ss;
+  m_client_ss = &ss;
+  m_outstanding = 0;
+  auto_ptr<TCPSocket> socket(TCPSocket::Connect(server_address));
+  OLA_ASSERT_NOT_NULL(socket.get());
+  OlaClient client(socket.get());
+  OLA_ASSERT_TRUE(ss.AddReadDescriptor(socket.get()));
+  OLA_ASSERT_TRUE(client.Setup());
+
+  client.RegisterUniverse(
+      TEST_UNIVERSE, ola::client::REGISTER,
+      NewSingleCallback(this, &StreamingClientTest::CompleteSet));
+  RunUntilComplete(1);
+
+  // The universe has no ports, so the broadcast completes, the unicast
+  // request finds no responder, and the missing universe fails to send.
+  const UID uid(0x7a70, 1);
+  SendRDMBatchArgs args(NewCallback(
+      this, &StreamingClientTest::CompleteRDMBatchRequest));
+  args.requests.push_back(RDMBatchItem(
+      TEST_UNIVERSE, UID::AllDevices(), 0, ola::rdm::PID_IDENTIFY_DEVICE,
+      true, string(1, 1)));
+  args.requests.push_back(RDMBatchItem(TEST_UNIVERSE + 10, uid, 0,
+                                       ola::rdm::PID_DEVICE_INFO));
+  args.requests.push_back(RDMBatchItem(TEST_UNIVERSE, uid, 0,
+                                       ola::rdm::PID_DEVICE_INFO));
+  m_rdm_calls.assign(args.requests.size(), 0);
+  m_rdm_codes.assign(args.requests.size(), ola::rdm::RDM_INVALID_RESPONSE);
+  client.SendRDMBatch(args);
+  RunUntilComplete(3);
+
+  for (unsigned int i = 0; i < m_rdm_calls.size(); i++) {
+    OLA_ASSERT_EQ(1u, m_rdm_calls[i]);
+  }
+  OLA_ASSERT_EQ(ola::rdm::RDM_WAS_BROADCAST, m_rdm_codes[0]);
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_rdm_codes[1]);
+  OLA_ASSERT_EQ(ola::rdm::RDM_UNKNOWN_UID, m_rdm_codes[2]);
+
+  // Once the client has stopped, every request fails straight away.
+  client.Stop();
+  ss.RemoveReadDescriptor(socket.get());
+  SendRDMBatchArgs failed_args(NewCallback(
+      this, &StreamingClientTest::CompleteRDMBatchRequest));
+  failed_args.requests = args.requests;
+  m_rdm_calls.assign(failed_args.requests.size(), 0);
+  m_failures = 0;
+  client.SendRDMBatch(failed_args);
+  for (unsigned int i = 0; i < m_rdm_calls.size(); i++) {
+    OLA_ASSERT_EQ(1u, m_rdm_calls[i]);
+  }
+  OLA_ASSERT_EQ(3u, m_failures);
+  m_client_ss = NULL;
+}
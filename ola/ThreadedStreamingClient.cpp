@@ -0,0 +1,189 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * ThreadedStreamingClient.cpp
+ * A StreamingClient that can be fed from other threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/Logging.h>
+#include <ola/client/ThreadedStreamingClient.h>
+#include <ola/stl/STLUtils.h>
+
+#include <map>
+#include <vector>
+
+namespace ola {
+namespace client {
+
+using ola::thread::Thread;
+
+namespace {
+Thread::Options ClientThreadOptions(
+    const ThreadedStreamingClient::Options &options) {
+  Thread::Options thread_options("ola-streaming-client");
+  thread_options.cpu_affinity = options.cpu_affinity;
+  return thread_options;
+}
+}  // namespace
+
+ThreadedStreamingClient::ThreadedStreamingClient(const Options &options)
+    : Thread(ClientThreadOptions(options)),
+      m_tick_interval(options.tick_interval),
+      m_client(options.client_options),
+      m_started(false),
+      m_connected(false),
+      m_tick_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+ThreadedStreamingClient::~ThreadedStreamingClient() {
+  Stop();
+  STLDeleteValues(&m_slots);
+}
+
+bool ThreadedStreamingClient::AddUniverse(unsigned int universe) {
+  if (m_started) {
+    return false;
+  }
+  if (!STLContains(m_slots, universe)) {
+    m_slots[universe] = new UniverseSlot();
+  }
+  return true;
+}
+
+bool ThreadedStreamingClient::Setup() {
+  if (m_started || !m_client.Setup()) {
+    return false;
+  }
+
+  m_connected = true;
+  m_batch.reserve(m_slots.size());
+  m_tick_timeout = m_ss.RegisterRepeatingTimeout(
+      m_tick_interval,
+      NewCallback(this, &ThreadedStreamingClient::Tick));
+  m_started = Start();
+  if (!m_started) {
+    m_client.Stop();
+    m_connected = false;
+  }
+  return m_started;
+}
+
+void ThreadedStreamingClient::Stop() {
+  if (!m_started) {
+    return;
+  }
+  // Terminate() is a no-op if the SelectServer hasn't started running yet,
+  // so queue it instead.
+  m_ss.Execute(NewSingleCallback(&m_ss, &ola::io::SelectServer::Terminate));
+  Join();
+  m_started = false;
+  m_ss.RemoveTimeout(m_tick_timeout);
+  m_tick_timeout = ola::thread::INVALID_TIMEOUT;
+  m_client.Stop();
+  m_connected = false;
+}
+
+bool ThreadedStreamingClient::SendDMX(
+    unsigned int universe,
+    const DmxBuffer &data,
+    const StreamingClientInterface::SendArgs &args) {
+  UniverseSlot *slot = STLFindOrNull(m_slots, universe);
+  if (!slot) {
+    return false;
+  }
+
+  // Copy the data, since the DmxBuffer reference counts aren't thread safe.
+  Frame *frame = slot->frames.WriteBuffer();
+  if (!frame->data.Set(data)) {
+    frame->data.Reset();
+  }
+  frame->priority = args.priority;
+  slot->frames.Publish();
+  return true;
+}
+
+void *ThreadedStreamingClient::Run() {
+  m_ss.Run();
+  // Pick up anything sent since the last tick.
+  if (m_connected) {
+    SendUpdates(false);
+  }
+  return NULL;
+}
+
+bool ThreadedStreamingClient::Tick() {
+  if (m_connected) {
+    SendUpdates(false);
+  } else if (Reconnect()) {
+    SendUpdates(true);
+  }
+  return true;
+}
+
+/*
+ * Send the frames that changed since the last tick, or if send_all is true,
+ * the latest frame for every universe.
+ */
+void ThreadedStreamingClient::SendUpdates(bool send_all) {
+  m_batch.clear();
+  SlotMap::iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    UniverseSlot *slot = iter->second;
+    if (slot->frames.Update()) {
+      const Frame &frame = slot->frames.ReadBuffer();
+      // Copy rather than share the buffer, the producer reuses it.
+      if (!slot->last_sent.Set(frame.data.GetRaw(), frame.data.Size())) {
+        slot->last_sent.Reset();
+      }
+      slot->last_priority = frame.priority;
+      slot->has_data = true;
+    } else if (!(send_all && slot->has_data)) {
+      continue;
+    }
+    m_batch.push_back(StreamingClient::DmxUpdate(
+        iter->first, slot->last_sent, slot->last_priority));
+  }
+
+  if (m_batch.empty()) {
+    return;
+  }
+
+  if (!m_client.SendBatch(m_batch)) {
+    OLA_WARN << "Lost the connection to olad";
+    m_connected = false;
+  }
+  // Release the references to the last_sent buffers.
+  m_batch.clear();
+}
+
+bool ThreadedStreamingClient::Reconnect() {
+  TimeStamp now = *m_ss.WakeUpTime();
+  if (m_last_connect_attempt.IsSet() &&
+      now < m_last_connect_attempt + TimeInterval(RECONNECT_INTERVAL_S, 0)) {
+    return false;
+  }
+  m_last_connect_attempt = now;
+  m_connected = m_client.Setup();
+  if (m_connected) {
+    OLA_INFO << "Reconnected to olad";
+  }
+  return m_connected;
+}
+}  // namespace client
+}  // namespace ola
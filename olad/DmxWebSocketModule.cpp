@@ -0,0 +1,309 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxWebSocketModule.cpp
+ * Pushes live DMX data to the web UI over WebSockets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/network/NetworkUtils.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxWebSocketModule.h"
+
+namespace ola {
+
+using ola::client::DMXMetadata;
+using ola::client::OlaClient;
+using ola::client::RegisterArgs;
+using ola::client::Result;
+using ola::http::HTTPServer;
+using ola::http::WebSocket;
+using ola::network::HostToNetwork;
+using std::set;
+using std::string;
+
+const char DmxWebSocketModule::WEBSOCKET_PATH[] = "/ws/dmx";
+const char DmxWebSocketModule::SUBSCRIBE_COMMAND[] = "subscribe";
+const char DmxWebSocketModule::UNSUBSCRIBE_COMMAND[] = "unsubscribe";
+
+namespace {
+void DeleteWebSocket(WebSocket *socket) {
+  delete socket;
+}
+}  // namespace
+
+
+DmxWebSocketModule::DmxWebSocketModule(HTTPServer *http_server,
+                                       OlaClient *client)
+    : m_server(http_server),
+      m_client(client) {
+  m_client->SetDMXCallback(NewCallback(this, &DmxWebSocketModule::NewDmx));
+  m_server->RegisterWebSocketHandler(
+      WEBSOCKET_PATH,
+      NewCallback(this, &DmxWebSocketModule::NewConnection));
+}
+
+
+DmxWebSocketModule::~DmxWebSocketModule() {
+  UniverseMap::iterator uni_iter = m_universes.begin();
+  for (; uni_iter != m_universes.end(); ++uni_iter) {
+    if (uni_iter->second->timeout != ola::thread::INVALID_TIMEOUT) {
+      m_server->SelectServer()->RemoveTimeout(uni_iter->second->timeout);
+    }
+  }
+  STLDeleteValues(&m_universes);
+  SocketMap::iterator iter = m_sockets.begin();
+  for (; iter != m_sockets.end(); ++iter) {
+    delete iter->first;
+  }
+  m_sockets.clear();
+}
+
+
+/*
+ * Called when a new client connects.
+ */
+void DmxWebSocketModule::NewConnection(WebSocket *socket) {
+  m_sockets[socket];
+  socket->SetOnMessage(
+      NewCallback(this, &DmxWebSocketModule::HandleMessage, socket));
+  socket->SetOnClose(
+      NewSingleCallback(this, &DmxWebSocketModule::ConnectionClosed, socket));
+}
+
+
+/*
+ * Handle a subscribe / unsubscribe message.
+ */
+void DmxWebSocketModule::HandleMessage(WebSocket *socket,
+                                       const string &message) {
+  string::size_type pos = message.find(' ');
+  unsigned int universe_id;
+  if (pos == string::npos ||
+      !StringToInt(message.substr(pos + 1), &universe_id)) {
+    OLA_INFO << "Invalid WebSocket message: " << message;
+    return;
+  }
+
+  const string command = message.substr(0, pos);
+  if (command == SUBSCRIBE_COMMAND) {
+    Subscribe(socket, universe_id);
+  } else if (command == UNSUBSCRIBE_COMMAND) {
+    Unsubscribe(socket, universe_id);
+  } else {
+    OLA_INFO << "Unknown WebSocket command: " << command;
+  }
+}
+
+
+/*
+ * Called when the client goes away. The WebSocket is deleted once we've
+ * returned from the callback.
+ */
+void DmxWebSocketModule::ConnectionClosed(WebSocket *socket) {
+  SocketMap::iterator iter = m_sockets.find(socket);
+  if (iter == m_sockets.end()) {
+    return;
+  }
+
+  // Copy since Unsubscribe modifies the set
+  const set<unsigned int> universes = iter->second;
+  set<unsigned int>::const_iterator uni_iter = universes.begin();
+  for (; uni_iter != universes.end(); ++uni_iter) {
+    Unsubscribe(socket, *uni_iter);
+  }
+  m_sockets.erase(socket);
+  m_server->SelectServer()->Execute(
+      NewSingleCallback(DeleteWebSocket, socket));
+}
+
+
+void DmxWebSocketModule::Subscribe(WebSocket *socket,
+                                   unsigned int universe_id) {
+  set<unsigned int> &subscriptions = m_sockets[socket];
+  if (STLContains(subscriptions, universe_id)) {
+    return;
+  }
+  if (subscriptions.size() >= MAX_SUBSCRIPTIONS) {
+    OLA_INFO << "WebSocket subscription limit reached";
+    return;
+  }
+  subscriptions.insert(universe_id);
+
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (state) {
+    state->subscribers.insert(socket);
+    if (state->buffer.Size()) {
+      SendFrame(socket, universe_id, state->buffer);
+    }
+    return;
+  }
+
+  state = new UniverseState();
+  state->subscribers.insert(socket);
+  m_universes[universe_id] = state;
+
+  RegisterArgs args(NewSingleCallback(this,
+                                      &DmxWebSocketModule::RegisterComplete));
+  args.only_on_change = true;
+  m_client->RegisterUniverse(universe_id, ola::client::REGISTER, args);
+  // Send the current state, after that we only get changes.
+  m_client->FetchDMX(
+      universe_id,
+      NewSingleCallback(this, &DmxWebSocketModule::HandleFetchDmx,
+                        universe_id));
+}
+
+
+void DmxWebSocketModule::Unsubscribe(WebSocket *socket,
+                                     unsigned int universe_id) {
+  SocketMap::iterator iter = m_sockets.find(socket);
+  if (iter == m_sockets.end() || !iter->second.erase(universe_id)) {
+    return;
+  }
+
+  UniverseMap::iterator uni_iter = m_universes.find(universe_id);
+  if (uni_iter == m_universes.end()) {
+    return;
+  }
+
+  UniverseState *state = uni_iter->second;
+  state->subscribers.erase(socket);
+  if (!state->subscribers.empty()) {
+    return;
+  }
+
+  if (state->timeout != ola::thread::INVALID_TIMEOUT) {
+    m_server->SelectServer()->RemoveTimeout(state->timeout);
+  }
+  delete state;
+  m_universes.erase(uni_iter);
+  m_client->RegisterUniverse(
+      universe_id, ola::client::UNREGISTER,
+      NewSingleCallback(this, &DmxWebSocketModule::RegisterComplete));
+}
+
+
+void DmxWebSocketModule::HandleFetchDmx(unsigned int universe_id,
+                                        const Result &result,
+                                        const DMXMetadata&,
+                                        const DmxBuffer &buffer) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to fetch DMX for universe " << universe_id << ": "
+             << result.Error();
+    return;
+  }
+  UpdateUniverse(universe_id, buffer);
+}
+
+
+void DmxWebSocketModule::NewDmx(const DMXMetadata &metadata,
+                                const DmxBuffer &buffer) {
+  UpdateUniverse(metadata.universe, buffer);
+}
+
+
+/*
+ * Send the new data now, or if we sent a frame recently, schedule it to be
+ * sent once the interval has passed.
+ */
+void DmxWebSocketModule::UpdateUniverse(unsigned int universe_id,
+                                        const DmxBuffer &buffer) {
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (!state) {
+    return;
+  }
+
+  state->buffer.Set(buffer);
+  state->pending = true;
+  if (state->timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+
+  const TimeInterval interval(0, USEC_IN_SECONDS / MAX_FPS);
+  const TimeStamp now = *m_server->SelectServer()->WakeUpTime();
+  const TimeStamp next_send = state->last_sent + interval;
+  if (state->last_sent.IsSet() && now < next_send) {
+    state->timeout = m_server->SelectServer()->RegisterSingleTimeout(
+        next_send - now,
+        NewSingleCallback(this, &DmxWebSocketModule::SendPending,
+                          universe_id));
+    return;
+  }
+  SendPending(universe_id);
+}
+
+
+void DmxWebSocketModule::SendPending(unsigned int universe_id) {
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (!state) {
+    return;
+  }
+
+  state->timeout = ola::thread::INVALID_TIMEOUT;
+  if (!state->pending) {
+    return;
+  }
+
+  state->pending = false;
+  state->last_sent = *m_server->SelectServer()->WakeUpTime();
+  // A failed send closes the socket, which can unsubscribe it and free the
+  // state, so work from copies.
+  const set<WebSocket*> subscribers = state->subscribers;
+  const DmxBuffer buffer(state->buffer);
+  set<WebSocket*>::const_iterator iter = subscribers.begin();
+  for (; iter != subscribers.end(); ++iter) {
+    SendFrame(*iter, universe_id, buffer);
+  }
+}
+
+
+/*
+ * Each frame is a complete copy of the universe, so if a client can't keep
+ * up we drop frames for it rather than queueing them.
+ */
+void DmxWebSocketModule::SendFrame(WebSocket *socket,
+                                   unsigned int universe_id,
+                                   const DmxBuffer &buffer) {
+  if (socket->IsClosed() || socket->LimitReached()) {
+    return;
+  }
+
+  uint8_t frame[sizeof(uint32_t) + DMX_UNIVERSE_SIZE];
+  const uint32_t id = HostToNetwork(static_cast<uint32_t>(universe_id));
+  memcpy(frame, &id, sizeof(id));
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(frame + sizeof(id), &length);
+  socket->SendBinary(frame, sizeof(id) + length);
+}
+
+
+void DmxWebSocketModule::RegisterComplete(const Result &result) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to register universe: " << result.Error();
+  }
+}
+}  // namespace ola
@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxWebSocketModule.h
+ * Pushes live DMX data to the web UI over WebSockets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_DMXWEBSOCKETMODULE_H_
+#define OLAD_DMXWEBSOCKETMODULE_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/client/OlaClient.h"
+#include "ola/http/HTTPServer.h"
+#include "ola/http/WebSocket.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+/*
+ * The module that streams DMX to WebSocket clients.
+ *
+ * Clients connect to /ws/dmx and send "subscribe <universe>" or
+ * "unsubscribe <universe>" text messages. Each update is sent as a binary
+ * message: the universe id as a 4 byte big endian integer, followed by the
+ * slot data.
+ *
+ * olad only sends us frames that have changed, and we limit each universe to
+ * MAX_FPS. Changes that arrive faster than that are coalesced, so the last
+ * frame of a burst is always delivered.
+ */
+class DmxWebSocketModule {
+ public:
+  DmxWebSocketModule(ola::http::HTTPServer *http_server,
+                     ola::client::OlaClient *client);
+  ~DmxWebSocketModule();
+
+ private:
+  struct UniverseState {
+    std::set<ola::http::WebSocket*> subscribers;
+    DmxBuffer buffer;
+    TimeStamp last_sent;
+    ola::thread::timeout_id timeout;
+    bool pending;
+
+    UniverseState()
+        : timeout(ola::thread::INVALID_TIMEOUT),
+          pending(false) {
+    }
+  };
+
+  typedef std::map<unsigned int, UniverseState*> UniverseMap;
+  typedef std::map<ola::http::WebSocket*, std::set<unsigned int> >
+    SocketMap;
+
+  ola::http::HTTPServer *m_server;
+  ola::client::OlaClient *m_client;
+  UniverseMap m_universes;
+  SocketMap m_sockets;
+
+  void NewConnection(ola::http::WebSocket *socket);
+  void HandleMessage(ola::http::WebSocket *socket, const std::string &message);
+  void ConnectionClosed(ola::http::WebSocket *socket);
+
+  void Subscribe(ola::http::WebSocket *socket, unsigned int universe_id);
+  void Unsubscribe(ola::http::WebSocket *socket, unsigned int universe_id);
+
+  void HandleFetchDmx(unsigned int universe_id,
+                      const client::Result &result,
+                      const client::DMXMetadata &metadata,
+                      const DmxBuffer &buffer);
+  void NewDmx(const client::DMXMetadata &metadata, const DmxBuffer &buffer);
+  void UpdateUniverse(unsigned int universe_id, const DmxBuffer &buffer);
+  void SendPending(unsigned int universe_id);
+  void SendFrame(ola::http::WebSocket *socket, unsigned int universe_id,
+                 const DmxBuffer &buffer);
+  void RegisterComplete(const client::Result &result);
+
+  static const char WEBSOCKET_PATH[];
+  static const char SUBSCRIBE_COMMAND[];
+  static const char UNSUBSCRIBE_COMMAND[];
+  // The maximum number of frames per second sent for each universe.
+  static const unsigned int MAX_FPS = 25;
+  // The maximum number of universes a single client can subscribe to.
+  static const unsigned int MAX_SUBSCRIPTIONS = 64;
+
+  DISALLOW_COPY_AND_ASSIGN(DmxWebSocketModule);
+};
+}  // namespace ola
+#endif  // OLAD_DMXWEBSOCKETMODULE_H_
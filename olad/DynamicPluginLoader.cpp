@@ -22,9 +22,11 @@
 #include <config.h>
 #endif  // HAVE_CONFIG_H
 
+#include <string>
 #include <vector>
 #include "ola/stl/STLUtils.h"
 #include "olad/DynamicPluginLoader.h"
+#include "olad/LazyPlugin.h"
 #include "olad/Plugin.h"
 
 #ifdef USE_ARTNET
@@ -43,6 +45,10 @@
 #include "plugins/espnet/EspNetPlugin.h"
 #endif  // USE_ESPNET
 
+#ifdef USE_FEDERATION
+#include "plugins/federation/FederationPlugin.h"
+#endif  // USE_FEDERATION
+
 #ifdef USE_GPIO
 #include "plugins/gpio/GPIOPlugin.h"
 #endif  // USE_GPIO
@@ -117,6 +123,7 @@
 
 namespace ola {
 
+using std::string;
 using std::vector;
 
 DynamicPluginLoader::~DynamicPluginLoader() {
@@ -131,113 +138,136 @@ vector<AbstractPlugin*> DynamicPluginLoader::LoadPlugins() {
 }
 
 /*
- * Setup the plugin list
+ * Setup the plugin list. Each plugin is wrapped in a LazyPlugin so it's only
+ * constructed if it's enabled or queried.
  */
 void DynamicPluginLoader::PopulatePlugins() {
 #ifdef USE_DMX4LINUX
-  m_plugins.push_back(
-      new ola::plugin::dmx4linux::Dmx4LinuxPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::dmx4linux::Dmx4LinuxPlugin>,
+            OLA_PLUGIN_DMX4LINUX, "Dmx4Linux", "dmx4linux");
 #endif  // USE_DMX4LINUX
 
 #ifdef USE_ARTNET
-  m_plugins.push_back(new ola::plugin::artnet::ArtNetPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::artnet::ArtNetPlugin>,
+            OLA_PLUGIN_ARTNET, "ArtNet", "artnet");
 #endif  // USE_ARTNET
 
 #ifdef USE_DUMMY
-  m_plugins.push_back(new ola::plugin::dummy::DummyPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::dummy::DummyPlugin>,
+            OLA_PLUGIN_DUMMY, "Dummy", "dummy");
 #endif  // USE_DUMMY
 
 #ifdef USE_E131
-  m_plugins.push_back(new ola::plugin::e131::E131Plugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::e131::E131Plugin>,
+            OLA_PLUGIN_E131, "E1.31 (sACN)", "e131");
 #endif  // USE_E131
 
 #ifdef USE_ESPNET
-  m_plugins.push_back(new ola::plugin::espnet::EspNetPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::espnet::EspNetPlugin>,
+            OLA_PLUGIN_ESPNET, "ESP Net", "espnet");
 #endif  // USE_ESPNET
 
+#ifdef USE_FEDERATION
+  AddPlugin(&NewPlugin<ola::plugin::federation::FederationPlugin>,
+            OLA_PLUGIN_FEDERATION, "Federation", "federation");
+#endif  // USE_FEDERATION
+
 #ifdef USE_GPIO
-  m_plugins.push_back(new ola::plugin::gpio::GPIOPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::gpio::GPIOPlugin>,
+            OLA_PLUGIN_GPIO, "GPIO", "gpio");
 #endif  // USE_GPIO
 
 #ifdef USE_KARATE
-  m_plugins.push_back(
-      new ola::plugin::karate::KaratePlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::karate::KaratePlugin>,
+            OLA_PLUGIN_KARATE, "KarateLight", "karate");
 #endif  // USE_KARATE
 
 #ifdef USE_KINET
-  m_plugins.push_back(new ola::plugin::kinet::KiNetPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::kinet::KiNetPlugin>,
+            OLA_PLUGIN_KINET, "KiNET", "kinet");
 #endif  // USE_KINET
 
 #ifdef USE_MILINST
-  m_plugins.push_back(
-      new ola::plugin::milinst::MilInstPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::milinst::MilInstPlugin>,
+            OLA_PLUGIN_MILINST, "Milford Instruments", "milinst");
 #endif  // USE_MILINST
 
 #ifdef USE_OPENDMX
-  m_plugins.push_back(
-      new ola::plugin::opendmx::OpenDmxPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::opendmx::OpenDmxPlugin>,
+            OLA_PLUGIN_OPENDMX, "Enttec Open DMX", "opendmx");
 #endif  // USE_OPENDMX
 
 #ifdef USE_OPENPIXELCONTROL
-  m_plugins.push_back(
-      new ola::plugin::openpixelcontrol::OPCPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::openpixelcontrol::OPCPlugin>,
+            OLA_PLUGIN_OPENPIXELCONTROL, "Open Pixel Control",
+            "openpixelcontrol");
 #endif  // USE_OPENPIXELCONTROL
 
 #ifdef USE_OSC
-  m_plugins.push_back(
-      new ola::plugin::osc::OSCPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::osc::OSCPlugin>,
+            OLA_PLUGIN_OSC, "OSC", "osc");
 #endif  // USE_OSC
 
 #ifdef USE_RENARD
-  m_plugins.push_back(
-      new ola::plugin::renard::RenardPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::renard::RenardPlugin>,
+            OLA_PLUGIN_RENARD, "Renard", "renard");
 #endif  // USE_RENARD
 
 #ifdef USE_SANDNET
-  m_plugins.push_back(
-      new ola::plugin::sandnet::SandNetPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::sandnet::SandNetPlugin>,
+            OLA_PLUGIN_SANDNET, "SandNet", "sandnet");
 #endif  // USE_SANDNET
 
 #ifdef USE_SHOWNET
-  m_plugins.push_back(
-      new ola::plugin::shownet::ShowNetPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::shownet::ShowNetPlugin>,
+            OLA_PLUGIN_SHOWNET, "ShowNet", "shownet");
 #endif  // USE_SHOWNET
 
 #ifdef USE_SPI
-  m_plugins.push_back(
-      new ola::plugin::spi::SPIPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::spi::SPIPlugin>,
+            OLA_PLUGIN_SPI, "SPI", "spi");
 #endif  // USE_SPI
 
 #ifdef USE_STAGEPROFI
-  m_plugins.push_back(
-      new ola::plugin::stageprofi::StageProfiPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::stageprofi::StageProfiPlugin>,
+            OLA_PLUGIN_STAGEPROFI, "StageProfi", "stageprofi");
 #endif  // USE_STAGEPROFI
 
 #ifdef USE_USBPRO
-  m_plugins.push_back(
-      new ola::plugin::usbpro::UsbSerialPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::usbpro::UsbSerialPlugin>,
+            OLA_PLUGIN_USBPRO, "Serial USB", "usbserial");
 #endif  // USE_USBPRO
 
 #ifdef USE_LIBUSB
-  m_plugins.push_back(new ola::plugin::usbdmx::UsbDmxPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::usbdmx::UsbDmxPlugin>,
+            OLA_PLUGIN_USBDMX, "USB", "usbdmx");
 #endif  // USE_LIBUSB
 
 #ifdef USE_PATHPORT
-  m_plugins.push_back(
-      new ola::plugin::pathport::PathportPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::pathport::PathportPlugin>,
+            OLA_PLUGIN_PATHPORT, "Pathport", "pathport");
 #endif  // USE_PATHPORT
 
 #ifdef USE_FTDI
-  m_plugins.push_back(
-      new ola::plugin::ftdidmx::FtdiDmxPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::ftdidmx::FtdiDmxPlugin>,
+            OLA_PLUGIN_FTDIDMX, "FTDI USB DMX", "ftdidmx", false);
 #endif  // USE_FTDI
 
 #ifdef USE_UART
-  m_plugins.push_back(
-      new ola::plugin::uartdmx::UartDmxPlugin(m_plugin_adaptor));
+  AddPlugin(&NewPlugin<ola::plugin::uartdmx::UartDmxPlugin>,
+            OLA_PLUGIN_UARTDMX, "UART native DMX", "uartdmx", false);
 #endif  // USE_UART
 }
 
+void DynamicPluginLoader::AddPlugin(PluginFactory *factory,
+                                    ola_plugin_id plugin_id,
+                                    const string &name,
+                                    const string &prefix,
+                                    bool default_mode) {
+  m_plugins.push_back(new LazyPlugin(m_plugin_adaptor, factory, plugin_id,
+                                     name, prefix, default_mode));
+}
+
 void DynamicPluginLoader::UnloadPlugins() {
   STLDeleteElements(&m_plugins);
 }
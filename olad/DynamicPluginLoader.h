@@ -21,8 +21,11 @@
 #ifndef OLAD_DYNAMICPLUGINLOADER_H_
 #define OLAD_DYNAMICPLUGINLOADER_H_
 
+#include <string>
 #include <vector>
 #include "ola/base/Macro.h"
+#include "ola/plugin_id.h"
+#include "olad/LazyPlugin.h"
 #include "olad/PluginLoader.h"
 
 namespace ola {
@@ -41,6 +44,11 @@ class DynamicPluginLoader: public PluginLoader {
 
  private:
   void PopulatePlugins();
+  void AddPlugin(PluginFactory *factory,
+                 ola_plugin_id plugin_id,
+                 const std::string &name,
+                 const std::string &prefix,
+                 bool default_mode = true);
 
   std::vector<class AbstractPlugin*> m_plugins;
 
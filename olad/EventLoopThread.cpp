@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * EventLoopThread.cpp
+ * A thread that runs a SelectServer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/EventLoopThread.h"
+
+#include <string>
+
+#include "ola/thread/Utils.h"
+
+namespace ola {
+
+using std::string;
+
+EventLoopThread::EventLoopThread(const string &name)
+    : ola::thread::Thread(ola::thread::Thread::Options(name)),
+      m_memory_node(-1) {
+}
+
+EventLoopThread::EventLoopThread(
+    const ola::thread::Thread::Options &options,
+    const ola::io::SelectServer::Options &ss_options)
+    : ola::thread::Thread(options),
+      m_ss(ss_options),
+      m_memory_node(-1) {
+}
+
+void *EventLoopThread::Run() {
+  // The loop carries on with the default policy if this fails.
+  if (m_memory_node >= 0) {
+    ola::thread::SetMemoryNode(m_memory_node);
+  }
+  m_ss.Run();
+  // Run anything that was queued after we were told to stop.
+  m_ss.DrainCallbacks();
+  return NULL;
+}
+
+bool EventLoopThread::Join(void *ptr) {
+  m_ss.Terminate();
+  return ola::thread::Thread::Join(ptr);
+}
+}  // namespace ola
@@ -0,0 +1,89 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * EventLoopThread.h
+ * A thread that runs a SelectServer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_EVENTLOOPTHREAD_H_
+#define OLAD_EVENTLOOPTHREAD_H_
+
+#include <string>
+
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServer.h"
+#include "ola/thread/Thread.h"
+
+namespace ola {
+
+/**
+ * @brief An extra event loop for olad.
+ *
+ * Plugins that are sharded onto this loop have their descriptors and timeouts
+ * serviced by this thread rather than the main SelectServer. Anything that
+ * touches the rest of olad must be passed back to the main loop with
+ * Execute().
+ */
+class EventLoopThread : public ola::thread::Thread {
+ public:
+  /**
+   * @brief Create a new EventLoopThread.
+   * @param name the name of the thread.
+   */
+  explicit EventLoopThread(const std::string &name);
+
+  /**
+   * @brief Create a new EventLoopThread.
+   * @param options the thread options, e.g. to set the CPU affinity.
+   * @param ss_options the options for the SelectServer.
+   */
+  explicit EventLoopThread(const ola::thread::Thread::Options &options,
+                           const ola::io::SelectServer::Options &ss_options =
+                               ola::io::SelectServer::Options());
+
+  /**
+   * @brief The SelectServer run by this thread.
+   */
+  ola::io::SelectServer *GetSelectServer() { return &m_ss; }
+
+  /**
+   * @brief Prefer memory from a NUMA node for the allocations made on this
+   *   loop. This must be called before Start().
+   * @param node the NUMA node, this should contain the CPUs the thread is
+   *   pinned to.
+   */
+  void SetMemoryNode(unsigned int node) { m_memory_node = node; }
+
+  /**
+   * @brief The NUMA node set with SetMemoryNode(), or -1 if there isn't one.
+   */
+  int MemoryNode() const { return m_memory_node; }
+
+  void *Run();
+
+  /**
+   * @brief Stop the SelectServer and wait for the thread to exit.
+   */
+  bool Join(void *ptr = NULL);
+
+ private:
+  ola::io::SelectServer m_ss;
+  int m_memory_node;
+
+  DISALLOW_COPY_AND_ASSIGN(EventLoopThread);
+};
+}  // namespace ola
+#endif  // OLAD_EVENTLOOPTHREAD_H_
@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * EventLoopThreadTest.cpp
+ * Test fixture for the EventLoopThread class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/ExportMap.h"
+#include "ola/StringUtils.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/thread/Future.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/EventLoopThread.h"
+#include "olad/PluginAdaptor.h"
+
+using ola::EventLoopThread;
+using ola::NewSingleCallback;
+using ola::PluginAdaptor;
+using ola::io::SelectServerInterface;
+using ola::thread::Future;
+using ola::thread::Thread;
+using ola::thread::ThreadId;
+using std::vector;
+
+
+class EventLoopThreadTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(EventLoopThreadTest);
+  CPPUNIT_TEST(testExecute);
+  CPPUNIT_TEST(testWorkerLoops);
+  CPPUNIT_TEST(testNumaPlacement);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testExecute();
+    void testWorkerLoops();
+    void testNumaPlacement();
+
+ private:
+    static void RecordThread(Future<ThreadId> *future) {
+      future->Set(Thread::Self());
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EventLoopThreadTest);
+
+
+/*
+ * Check that callbacks run on the loop's thread.
+ */
+void EventLoopThreadTest::testExecute() {
+  EventLoopThread loop("test-loop");
+  OLA_ASSERT_TRUE(loop.Start());
+
+  Future<ThreadId> future;
+  loop.GetSelectServer()->Execute(
+      NewSingleCallback(&EventLoopThreadTest::RecordThread, &future));
+  ThreadId loop_thread = future.Get();
+  OLA_ASSERT_FALSE(pthread_equal(loop_thread, Thread::Self()));
+  OLA_ASSERT_TRUE(pthread_equal(loop_thread, loop.Id()));
+  OLA_ASSERT_TRUE(loop.Join());
+}
+
+
+/*
+ * Check plugins are spread across the worker loops.
+ */
+void EventLoopThreadTest::testWorkerLoops() {
+  PluginAdaptor adaptor(NULL, NULL, NULL, NULL, NULL, NULL);
+  OLA_ASSERT_NULL(adaptor.WorkerLoop(ola::OLA_PLUGIN_E131));
+
+  EventLoopThread loop1("test-loop-1");
+  EventLoopThread loop2("test-loop-2");
+  vector<SelectServerInterface*> loops;
+  loops.push_back(loop1.GetSelectServer());
+  loops.push_back(loop2.GetSelectServer());
+  adaptor.SetWorkerLoops(loops);
+
+  SelectServerInterface *e131_loop = adaptor.WorkerLoop(ola::OLA_PLUGIN_E131);
+  OLA_ASSERT_NOT_NULL(e131_loop);
+  OLA_ASSERT_EQ(e131_loop, adaptor.WorkerLoop(ola::OLA_PLUGIN_E131));
+  OLA_ASSERT_NE(e131_loop,
+                adaptor.WorkerLoop(
+                    static_cast<ola::ola_plugin_id>(ola::OLA_PLUGIN_E131 + 1)));
+}
+
+
+/*
+ * Check plugins are placed on a loop on their NUMA node.
+ */
+void EventLoopThreadTest::testNumaPlacement() {
+  ola::ExportMap export_map;
+  PluginAdaptor adaptor(NULL, NULL, &export_map, NULL, NULL, NULL);
+  OLA_ASSERT_NULL(adaptor.WorkerLoopOnNode(ola::OLA_PLUGIN_E131, 0));
+
+  // Setting the memory node shouldn't stop the loop from running, even if it
+  // can't be applied.
+  EventLoopThread loop0("test-loop-0");
+  EventLoopThread loop1("test-loop-1");
+  EventLoopThread loop2("test-loop-2");
+  OLA_ASSERT_EQ(-1, loop0.MemoryNode());
+  loop0.SetMemoryNode(0);
+  OLA_ASSERT_EQ(0, loop0.MemoryNode());
+  OLA_ASSERT_TRUE(loop0.Start());
+  Future<ThreadId> future;
+  loop0.GetSelectServer()->Execute(
+      NewSingleCallback(&EventLoopThreadTest::RecordThread, &future));
+  future.Get();
+  OLA_ASSERT_TRUE(loop0.Join());
+
+  vector<SelectServerInterface*> loops;
+  loops.push_back(loop0.GetSelectServer());
+  loops.push_back(loop1.GetSelectServer());
+  loops.push_back(loop2.GetSelectServer());
+
+  // Without nodes, the plugin's usual loop is used.
+  adaptor.SetWorkerLoops(loops);
+  OLA_ASSERT_EQ(adaptor.WorkerLoop(ola::OLA_PLUGIN_E131),
+                adaptor.WorkerLoopOnNode(ola::OLA_PLUGIN_E131, 1));
+
+  vector<unsigned int> nodes;
+  nodes.push_back(0);
+  nodes.push_back(1);
+  nodes.push_back(0);
+  adaptor.SetWorkerLoops(loops, nodes);
+  OLA_ASSERT_EQ(static_cast<SelectServerInterface*>(loop1.GetSelectServer()),
+                adaptor.WorkerLoopOnNode(ola::OLA_PLUGIN_E131, 1));
+  SelectServerInterface *loop = adaptor.WorkerLoopOnNode(
+      ola::OLA_PLUGIN_ARTNET, 0);
+  OLA_ASSERT_TRUE(loop == loop0.GetSelectServer() ||
+                  loop == loop2.GetSelectServer());
+
+  // There aren't any loops on node 2.
+  OLA_ASSERT_EQ(adaptor.WorkerLoop(ola::OLA_PLUGIN_DUMMY),
+                adaptor.WorkerLoopOnNode(ola::OLA_PLUGIN_DUMMY, 2));
+
+  // An interface without a node uses the plugin's usual loop.
+  OLA_ASSERT_EQ(adaptor.WorkerLoop(ola::OLA_PLUGIN_E131),
+                adaptor.WorkerLoop(ola::OLA_PLUGIN_E131, ""));
+
+  ola::UIntMap *nic_nodes = export_map.GetUIntMapVar(
+      PluginAdaptor::K_PLUGIN_NIC_NODE_VAR);
+  ola::UIntMap *loop_nodes = export_map.GetUIntMapVar(
+      PluginAdaptor::K_PLUGIN_LOOP_NODE_VAR);
+  const std::string e131 = ola::IntToString(ola::OLA_PLUGIN_E131);
+  OLA_ASSERT_EQ(1u, (*nic_nodes)[e131]);
+  OLA_ASSERT_EQ(1u, (*loop_nodes)[e131]);
+  const std::string dummy = ola::IntToString(ola::OLA_PLUGIN_DUMMY);
+  OLA_ASSERT_EQ(2u, (*nic_nodes)[dummy]);
+}
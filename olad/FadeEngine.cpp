@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FadeEngine.cpp
+ * Runs fades requested by clients.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/FadeEngine.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+namespace {
+// Fade progress and weights are 16 bit fixed point.
+const unsigned int WEIGHT_SHIFT = 16;
+const int32_t WEIGHT_ONE = 1 << WEIGHT_SHIFT;
+}  // namespace
+
+// Slightly faster than the DMX refresh rate.
+const unsigned int FadeEngine::TICK_INTERVAL_MS = 20;
+
+FadeEngine::FadeEngine(UniverseStore *universe_store,
+                       ola::thread::SchedulerInterface *scheduler,
+                       const TimeStamp *wake_up_time)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_wake_up_time(wake_up_time),
+      m_tick_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+FadeEngine::~FadeEngine() {
+  if (m_tick_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_tick_timeout);
+  }
+  STLDeleteValues(&m_fades);
+}
+
+bool FadeEngine::StartFade(Client *client,
+                           unsigned int universe_id,
+                           const DmxBuffer &target,
+                           unsigned int start_slot,
+                           const TimeInterval &duration,
+                           Curve curve,
+                           uint8_t priority) {
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (!universe) {
+    return false;
+  }
+
+  const DmxSource source = client->SourceData(universe_id);
+  DmxBuffer start = source.IsSet() ? source.Data() : universe->GetDMX();
+  unsigned int end_slot = std::min(
+      start_slot + target.Size(), static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  if (start.Size() < end_slot) {
+    start.SetRangeToValue(start.Size(), 0, end_slot - start.Size());
+  }
+
+  DmxBuffer end(start);
+  end.SetRange(start_slot, target.GetRaw(), target.Size());
+
+  FadeKey key(client, universe_id);
+  if (duration.IsZero()) {
+    CancelFade(client, universe_id);
+    Apply(client, universe_id, end, priority);
+    return true;
+  }
+
+  Fade *fade = STLFindOrNull(m_fades, key);
+  if (!fade) {
+    fade = new Fade();
+    m_fades[key] = fade;
+  }
+  fade->start = start;
+  fade->end = end;
+  fade->start_time = *m_wake_up_time;
+  fade->duration = duration;
+  fade->curve = curve;
+  fade->priority = priority;
+
+  if (m_tick_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_tick_timeout = m_scheduler->RegisterRepeatingTimeout(
+        TICK_INTERVAL_MS, NewCallback(this, &FadeEngine::RunFades));
+  }
+  return true;
+}
+
+void FadeEngine::CancelFade(const Client *client, unsigned int universe_id) {
+  FadeKey key(const_cast<Client*>(client), universe_id);
+  STLRemoveAndDelete(&m_fades, key);
+}
+
+void FadeEngine::RemoveClient(const Client *client) {
+  FadeMap::iterator iter = m_fades.begin();
+  while (iter != m_fades.end()) {
+    if (iter->first.first == client) {
+      delete iter->second;
+      m_fades.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+bool FadeEngine::RunFades() {
+  const TimeStamp &now = *m_wake_up_time;
+  FadeMap::iterator iter = m_fades.begin();
+  while (iter != m_fades.end()) {
+    Fade *fade = iter->second;
+    TimeInterval elapsed = now - fade->start_time;
+    if (elapsed >= fade->duration) {
+      Apply(iter->first.first, iter->first.second, fade->end, fade->priority);
+      delete fade;
+      m_fades.erase(iter++);
+      continue;
+    }
+
+    int64_t elapsed_us = std::max(elapsed.AsInt(), static_cast<int64_t>(0));
+    uint32_t progress = static_cast<uint32_t>(
+        (elapsed_us << WEIGHT_SHIFT) / fade->duration.AsInt());
+    Interpolate(*fade, Weight(fade->curve, progress), &fade->current);
+    Apply(iter->first.first, iter->first.second, fade->current,
+          fade->priority);
+    ++iter;
+  }
+
+  if (m_fades.empty()) {
+    m_tick_timeout = ola::thread::INVALID_TIMEOUT;
+    return false;
+  }
+  return true;
+}
+
+void FadeEngine::Apply(Client *client, unsigned int universe_id,
+                       const DmxBuffer &frame, uint8_t priority) {
+  client->DMXReceived(universe_id, frame.GetRaw(), frame.Size(),
+                      *m_wake_up_time, priority);
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (universe) {
+    universe->SourceClientDataChanged(client);
+  }
+}
+
+/*
+ * Set output to start + (end - start) * weight.
+ */
+void FadeEngine::Interpolate(const Fade &fade, uint32_t weight,
+                             DmxBuffer *output) {
+  const uint8_t *start = fade.start.GetRaw();
+  const uint8_t *end = fade.end.GetRaw();
+  uint8_t frame[DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < fade.start.Size(); i++) {
+    int32_t delta = static_cast<int32_t>(end[i]) - start[i];
+    frame[i] = static_cast<uint8_t>(
+        start[i] + ((delta * static_cast<int32_t>(weight)) / WEIGHT_ONE));
+  }
+  output->Set(frame, fade.start.Size());
+}
+
+/*
+ * Map the fraction of the duration that has passed to the fraction of the
+ * change to apply.
+ */
+uint32_t FadeEngine::Weight(Curve curve, uint32_t progress) {
+  uint64_t t = progress;
+  switch (curve) {
+    case EASE_IN_OUT:
+      // smoothstep, 3t^2 - 2t^3
+      return static_cast<uint32_t>(
+          (t * t * (3 * WEIGHT_ONE - 2 * t)) >> (2 * WEIGHT_SHIFT));
+    case SQUARE:
+      return static_cast<uint32_t>((t * t) >> WEIGHT_SHIFT);
+    case LINEAR:
+    default:
+      return progress;
+  }
+}
+}  // namespace ola
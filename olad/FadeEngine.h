@@ -0,0 +1,151 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FadeEngine.h
+ * Runs fades requested by clients.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_FADEENGINE_H_
+#define OLAD_FADEENGINE_H_
+
+#include <stdint.h>
+#include <map>
+#include <utility>
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class Client;
+class UniverseStore;
+
+/**
+ * @brief Fades a client's DMX data between two frames.
+ *
+ * Rather than streaming every intermediate frame, a client can ask the server
+ * to fade its data for a universe to a new set of values. On each tick the
+ * engine updates the client's source data and merges the universe, just as if
+ * the client had sent the frame itself.
+ *
+ * Each client has at most one fade per universe. Starting a new fade replaces
+ * the old one, and the fade starts from wherever the old one had reached.
+ */
+class FadeEngine {
+ public:
+  /**
+   * @brief The timing of a fade.
+   */
+  enum Curve {
+    LINEAR,  /**< Constant rate of change */
+    EASE_IN_OUT,  /**< Slow at the start and end */
+    SQUARE,  /**< Slow at the start, fast at the end */
+  };
+
+  /**
+   * @brief Create a new FadeEngine.
+   * @param universe_store the UniverseStore to look universes up in.
+   * @param scheduler the scheduler to run the fade tick on.
+   * @param wake_up_time the time of the current event loop iteration.
+   */
+  FadeEngine(UniverseStore *universe_store,
+             ola::thread::SchedulerInterface *scheduler,
+             const TimeStamp *wake_up_time);
+  ~FadeEngine();
+
+  /**
+   * @brief Start a fade.
+   * @param client the client the data belongs to.
+   * @param universe_id the universe to fade.
+   * @param target the values to fade to.
+   * @param start_slot the slot the target values start from.
+   * @param duration the length of the fade. A duration of 0 sets the target
+   *   values immediately.
+   * @param curve the timing of the fade.
+   * @param priority the priority of the data.
+   * @returns false if the universe doesn't exist.
+   *
+   * The fade starts from the client's current data for the universe, or the
+   * universe's output if the client hasn't sent any. Slots outside the range
+   * are left as they are.
+   */
+  bool StartFade(Client *client,
+                 unsigned int universe_id,
+                 const DmxBuffer &target,
+                 unsigned int start_slot,
+                 const TimeInterval &duration,
+                 Curve curve,
+                 uint8_t priority);
+
+  /**
+   * @brief Stop a fade, the client's data is left where the fade reached.
+   * @param client the client that started the fade.
+   * @param universe_id the universe being faded.
+   */
+  void CancelFade(const Client *client, unsigned int universe_id);
+
+  /**
+   * @brief Stop all fades for a client.
+   * @param client the client to remove.
+   */
+  void RemoveClient(const Client *client);
+
+  /**
+   * @brief The number of fades in progress.
+   */
+  unsigned int ActiveFades() const {
+    return static_cast<unsigned int>(m_fades.size());
+  }
+
+  /**
+   * @brief Move all the fades on to the current time.
+   * @returns true if there are fades still in progress.
+   */
+  bool RunFades();
+
+  static const unsigned int TICK_INTERVAL_MS;
+
+ private:
+  struct Fade {
+    DmxBuffer start;
+    DmxBuffer end;
+    DmxBuffer current;
+    TimeStamp start_time;
+    TimeInterval duration;
+    Curve curve;
+    uint8_t priority;
+  };
+
+  typedef std::pair<Client*, unsigned int> FadeKey;
+  typedef std::map<FadeKey, Fade*> FadeMap;
+
+  UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  const TimeStamp *m_wake_up_time;
+  FadeMap m_fades;
+  ola::thread::timeout_id m_tick_timeout;
+
+  void Apply(Client *client, unsigned int universe_id,
+             const DmxBuffer &frame, uint8_t priority);
+  static void Interpolate(const Fade &fade, uint32_t weight,
+                          DmxBuffer *output);
+  static uint32_t Weight(Curve curve, uint32_t progress);
+
+  DISALLOW_COPY_AND_ASSIGN(FadeEngine);
+};
+}  // namespace ola
+#endif  // OLAD_FADEENGINE_H_
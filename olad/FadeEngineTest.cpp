@@ -0,0 +1,213 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FadeEngineTest.cpp
+ * Test fixture for the FadeEngine class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/FadeEngine.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Client;
+using ola::DmxBuffer;
+using ola::FadeEngine;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using ola::UniverseStore;
+
+class FadeEngineTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FadeEngineTest);
+  CPPUNIT_TEST(testLinearFade);
+  CPPUNIT_TEST(testCurves);
+  CPPUNIT_TEST(testCancel);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    FadeEngineTest()
+        : m_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {
+    }
+
+    void setUp() {
+      ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+      m_store.reset(new UniverseStore(NULL, &m_export_map));
+      m_clock.CurrentTime(&m_now);
+      m_engine.reset(new FadeEngine(m_store.get(), &m_ss, &m_now));
+    }
+
+    void tearDown() {
+      m_engine.reset();
+      m_store->DeleteAll();
+      m_store.reset();
+    }
+
+    void testLinearFade();
+    void testCurves();
+    void testCancel();
+
+ private:
+    ola::rdm::UID m_uid;
+    ola::ExportMap m_export_map;
+    ola::io::SelectServer m_ss;
+    ola::Clock m_clock;
+    TimeStamp m_now;
+    std::auto_ptr<UniverseStore> m_store;
+    std::auto_ptr<FadeEngine> m_engine;
+
+    void Send(Client *client, Universe *universe, const DmxBuffer &data) {
+      client->DMXReceived(universe->UniverseId(), data.GetRaw(), data.Size(),
+                          m_now, ola::dmx::SOURCE_PRIORITY_DEFAULT);
+      universe->SourceClientDataChanged(client);
+    }
+
+    bool Advance(unsigned int ms) {
+      m_now += TimeInterval(static_cast<int64_t>(ms) * 1000);
+      return m_engine->RunFades();
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FadeEngineTest);
+
+/*
+ * Check a linear fade over part of a universe.
+ */
+void FadeEngineTest::testLinearFade() {
+  Client client(NULL, m_uid);
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+  const uint8_t start[] = {10, 0, 200, 30};
+  Send(&client, universe, DmxBuffer(start, sizeof(start)));
+
+  const uint8_t target[] = {200, 100};
+  OLA_ASSERT_TRUE(m_engine->StartFade(
+      &client, 1, DmxBuffer(target, sizeof(target)), 1, TimeInterval(1, 0),
+      FadeEngine::LINEAR, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  OLA_ASSERT_EQ(1u, m_engine->ActiveFades());
+  OLA_ASSERT_EQ(DmxBuffer(start, sizeof(start)), universe->GetDMX());
+
+  OLA_ASSERT_TRUE(Advance(250));
+  const uint8_t quarter[] = {10, 50, 175, 30};
+  OLA_ASSERT_DATA_EQUALS(quarter, sizeof(quarter),
+                         universe->GetDMX().GetRaw(),
+                         universe->GetDMX().Size());
+
+  OLA_ASSERT_TRUE(Advance(250));
+  const uint8_t half[] = {10, 100, 150, 30};
+  OLA_ASSERT_DATA_EQUALS(half, sizeof(half), universe->GetDMX().GetRaw(),
+                         universe->GetDMX().Size());
+
+  // The last tick sets the target exactly and ends the fade.
+  OLA_ASSERT_FALSE(Advance(600));
+  const uint8_t end[] = {10, 200, 100, 30};
+  OLA_ASSERT_DATA_EQUALS(end, sizeof(end), universe->GetDMX().GetRaw(),
+                         universe->GetDMX().Size());
+  OLA_ASSERT_EQ(0u, m_engine->ActiveFades());
+
+  // Fades fail for universes that don't exist.
+  OLA_ASSERT_FALSE(m_engine->StartFade(
+      &client, 2, DmxBuffer(target, sizeof(target)), 0, TimeInterval(1, 0),
+      FadeEngine::LINEAR, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+}
+
+/*
+ * Check the timing curves.
+ */
+void FadeEngineTest::testCurves() {
+  Client client(NULL, m_uid);
+  Universe *linear = m_store->GetUniverseOrCreate(1);
+  Universe *ease = m_store->GetUniverseOrCreate(2);
+  Universe *square = m_store->GetUniverseOrCreate(3);
+
+  // With no data from the client, the fade starts from zero.
+  const uint8_t target[] = {200};
+  DmxBuffer target_buffer(target, sizeof(target));
+  m_engine->StartFade(&client, 1, target_buffer, 0, TimeInterval(1, 0),
+                      FadeEngine::LINEAR, ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  m_engine->StartFade(&client, 2, target_buffer, 0, TimeInterval(1, 0),
+                      FadeEngine::EASE_IN_OUT,
+                      ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  m_engine->StartFade(&client, 3, target_buffer, 0, TimeInterval(1, 0),
+                      FadeEngine::SQUARE, ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  OLA_ASSERT_EQ(3u, m_engine->ActiveFades());
+
+  OLA_ASSERT_TRUE(Advance(250));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(50), linear->GetDMX().Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(31), ease->GetDMX().Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(12), square->GetDMX().Get(0));
+
+  OLA_ASSERT_TRUE(Advance(250));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), linear->GetDMX().Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), ease->GetDMX().Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(50), square->GetDMX().Get(0));
+
+  OLA_ASSERT_FALSE(Advance(500));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(200), linear->GetDMX().Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(200), ease->GetDMX().Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(200), square->GetDMX().Get(0));
+}
+
+/*
+ * Check fades can be cancelled, and zero length fades apply immediately.
+ */
+void FadeEngineTest::testCancel() {
+  Client client1(NULL, m_uid);
+  Client client2(NULL, m_uid);
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+  const uint8_t start[] = {0, 0};
+  Send(&client1, universe, DmxBuffer(start, sizeof(start)));
+
+  const uint8_t target[] = {100, 100};
+  DmxBuffer target_buffer(target, sizeof(target));
+  OLA_ASSERT_TRUE(m_engine->StartFade(
+      &client1, 1, target_buffer, 0, TimeInterval(0, 0),
+      FadeEngine::LINEAR, ola::dmx::SOURCE_PRIORITY_DEFAULT));
+  OLA_ASSERT_EQ(0u, m_engine->ActiveFades());
+  OLA_ASSERT_EQ(target_buffer, client1.SourceData(1).Data());
+
+  // Fade back down, then cancel half way.
+  m_engine->StartFade(&client1, 1, DmxBuffer(start, sizeof(start)), 0,
+                      TimeInterval(1, 0), FadeEngine::LINEAR,
+                      ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  Advance(500);
+  m_engine->CancelFade(&client1, 1);
+  OLA_ASSERT_EQ(0u, m_engine->ActiveFades());
+  OLA_ASSERT_FALSE(Advance(500));
+  const uint8_t half[] = {50, 50};
+  OLA_ASSERT_EQ(DmxBuffer(half, sizeof(half)), client1.SourceData(1).Data());
+
+  // Removing a client only stops its own fades.
+  m_engine->StartFade(&client1, 1, target_buffer, 0, TimeInterval(1, 0),
+                      FadeEngine::LINEAR, ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  m_engine->StartFade(&client2, 1, target_buffer, 0, TimeInterval(1, 0),
+                      FadeEngine::LINEAR, ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  OLA_ASSERT_EQ(2u, m_engine->ActiveFades());
+  m_engine->RemoveClient(&client1);
+  OLA_ASSERT_EQ(1u, m_engine->ActiveFades());
+  universe->RemoveSourceClient(&client1);
+  universe->RemoveSourceClient(&client2);
+}
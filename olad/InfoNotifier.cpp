@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InfoNotifier.cpp
+ * Tells clients when universes, ports or devices change.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <set>
+#include <vector>
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "olad/InfoNotifier.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using std::set;
+using std::vector;
+
+const unsigned int InfoNotifier::CHECK_INTERVAL_MS = 250;
+
+InfoNotifier::InfoNotifier(UniverseStore *universe_store,
+                           DeviceManager *device_manager,
+                           ola::thread::SchedulerInterface *scheduler)
+    : m_universe_store(universe_store),
+      m_device_manager(device_manager),
+      m_scheduler(scheduler),
+      m_universe_generation(universe_store->InfoGeneration()),
+      m_device_generation(device_manager->Generation()),
+      m_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+InfoNotifier::~InfoNotifier() {
+  if (m_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout);
+  }
+}
+
+void InfoNotifier::AddClient(Client *client) {
+  if (m_clients.empty()) {
+    // Changes made while no one was listening aren't sent.
+    m_universe_generation = m_universe_store->InfoGeneration();
+    m_device_generation = m_device_manager->Generation();
+    m_timeout = m_scheduler->RegisterRepeatingTimeout(
+        CHECK_INTERVAL_MS, NewCallback(this, &InfoNotifier::SendChanges));
+  }
+  m_clients.insert(client);
+}
+
+void InfoNotifier::RemoveClient(Client *client) {
+  if (!m_clients.erase(client) || !m_clients.empty()) {
+    return;
+  }
+  m_scheduler->RemoveTimeout(m_timeout);
+  m_timeout = ola::thread::INVALID_TIMEOUT;
+}
+
+bool InfoNotifier::SendChanges() {
+  const uint64_t universe_generation = m_universe_store->InfoGeneration();
+  const uint64_t device_generation = m_device_manager->Generation();
+  if (universe_generation == m_universe_generation &&
+      device_generation == m_device_generation) {
+    return true;
+  }
+
+  ola::proto::InfoChanges changes;
+  changes.set_universe_generation(universe_generation);
+  changes.set_device_generation(device_generation);
+
+  vector<Universe*> universes;
+  vector<unsigned int> removed;
+  m_universe_store->GetInfoChanges(m_universe_generation, &universes,
+                                   &removed);
+  vector<Universe*>::const_iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    changes.add_changed_universe((*universe_iter)->UniverseId());
+  }
+  vector<unsigned int>::const_iterator iter = removed.begin();
+  for (; iter != removed.end(); ++iter) {
+    changes.add_removed_universe(*iter);
+  }
+
+  vector<device_alias_pair> devices;
+  removed.clear();
+  m_device_manager->GetChanges(m_device_generation, &devices, &removed);
+  vector<device_alias_pair>::const_iterator device_iter = devices.begin();
+  for (; device_iter != devices.end(); ++device_iter) {
+    changes.add_changed_device(device_iter->alias);
+  }
+  for (iter = removed.begin(); iter != removed.end(); ++iter) {
+    changes.add_removed_device(*iter);
+  }
+
+  m_universe_generation = universe_generation;
+  m_device_generation = device_generation;
+
+  set<Client*>::const_iterator client_iter = m_clients.begin();
+  for (; client_iter != m_clients.end(); ++client_iter) {
+    (*client_iter)->SendInfoChanges(changes);
+  }
+  return true;
+}
+}  // namespace ola
@@ -0,0 +1,99 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InfoNotifier.h
+ * Tells clients when universes, ports or devices change.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_INFONOTIFIER_H_
+#define OLAD_INFONOTIFIER_H_
+
+#include <stdint.h>
+#include <set>
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class Client;
+class DeviceManager;
+class UniverseStore;
+
+/**
+ * @brief Sends the universe and device changes to the clients that asked for
+ * them.
+ *
+ * The web UI and management tools used to poll GetUniverseInfo and
+ * GetDeviceInfo for the complete state, which is expensive with thousands of
+ * universes. Instead a client registers for updates, and is sent the ids of
+ * the universes and devices which changed, along with the generations to
+ * pass to GetUniverseInfo and GetDeviceInfo to fetch just those.
+ *
+ * Changes are checked for every CHECK_INTERVAL_MS while there are
+ * registered clients, so a burst of changes, e.g. a plugin reload, results
+ * in a single update.
+ */
+class InfoNotifier {
+ public:
+  /**
+   * @brief Create a new InfoNotifier.
+   * @param universe_store the UniverseStore to watch.
+   * @param device_manager the DeviceManager to watch.
+   * @param scheduler the scheduler to run the checks on.
+   */
+  InfoNotifier(UniverseStore *universe_store,
+               DeviceManager *device_manager,
+               ola::thread::SchedulerInterface *scheduler);
+  ~InfoNotifier();
+
+  /**
+   * @brief Send a client the changes from now on.
+   */
+  void AddClient(Client *client);
+
+  /**
+   * @brief Stop sending a client the changes.
+   */
+  void RemoveClient(Client *client);
+
+  /**
+   * @brief Send any changes since the last check to the clients now.
+   * @returns true, so it can be used as a repeating timeout.
+   */
+  bool SendChanges();
+
+  /**
+   * @brief The number of registered clients.
+   */
+  unsigned int ClientCount() const {
+    return static_cast<unsigned int>(m_clients.size());
+  }
+
+  static const unsigned int CHECK_INTERVAL_MS;
+
+ private:
+  UniverseStore *m_universe_store;
+  DeviceManager *m_device_manager;
+  ola::thread::SchedulerInterface *m_scheduler;
+  std::set<Client*> m_clients;
+  uint64_t m_universe_generation;
+  uint64_t m_device_generation;
+  ola::thread::timeout_id m_timeout;
+
+  DISALLOW_COPY_AND_ASSIGN(InfoNotifier);
+};
+}  // namespace ola
+#endif  // OLAD_INFONOTIFIER_H_
@@ -0,0 +1,255 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InfoNotifierTest.cpp
+ * Test fixture for the InfoNotifier class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/InfoNotifier.h"
+#include "olad/PortBroker.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/PortManager.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Client;
+using ola::DeviceManager;
+using ola::InfoNotifier;
+using ola::PortManager;
+using ola::Universe;
+using ola::UniverseStore;
+using ola::device_alias_pair;
+using ola::rdm::UID;
+using std::vector;
+
+namespace {
+
+class MockClient: public Client {
+ public:
+  MockClient() : Client(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 0)) {}
+
+  bool SendInfoChanges(const ola::proto::InfoChanges &changes) {
+    updates.push_back(changes);
+    return true;
+  }
+
+  vector<ola::proto::InfoChanges> updates;
+};
+}  // namespace
+
+class InfoNotifierTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(InfoNotifierTest);
+  CPPUNIT_TEST(testUniverseChanges);
+  CPPUNIT_TEST(testDeviceChanges);
+  CPPUNIT_TEST(testNotify);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  InfoNotifierTest()
+      : m_store(NULL, NULL),
+        m_port_manager(&m_store, &m_broker),
+        m_device_manager(NULL, &m_port_manager),
+        m_plugin(NULL, ola::OLA_PLUGIN_ARTNET),
+        m_device(&m_plugin, "test device"),
+        m_port(&m_device, 1) {
+    m_device.AddPort(&m_port);
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void tearDown() {
+    m_device_manager.UnregisterAllDevices();
+    m_store.DeleteAll();
+  }
+
+  void testUniverseChanges();
+  void testDeviceChanges();
+  void testNotify();
+
+ private:
+  ola::io::SelectServer m_ss;
+  UniverseStore m_store;
+  ola::PortBroker m_broker;
+  PortManager m_port_manager;
+  DeviceManager m_device_manager;
+  TestMockPlugin m_plugin;
+  MockDevice m_device;
+  TestMockOutputPort m_port;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(InfoNotifierTest);
+
+
+/*
+ * Check the UniverseStore tracks which universes have changed.
+ */
+void InfoNotifierTest::testUniverseChanges() {
+  Universe *universe1 = m_store.GetUniverseOrCreate(1);
+  Universe *universe2 = m_store.GetUniverseOrCreate(2);
+  const uint64_t generation = m_store.InfoGeneration();
+  OLA_ASSERT_TRUE(generation > 0);
+
+  vector<Universe*> changed;
+  vector<unsigned int> removed;
+  m_store.GetInfoChanges(generation, &changed, &removed);
+  OLA_ASSERT_TRUE(changed.empty());
+  OLA_ASSERT_TRUE(removed.empty());
+
+  // Sending DMX doesn't change the info.
+  universe1->SetDMX(ola::DmxBuffer("abc"));
+  OLA_ASSERT_EQ(generation, m_store.InfoGeneration());
+
+  universe2->SetName("foo");
+  m_store.GetInfoChanges(generation, &changed, &removed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changed.size());
+  OLA_ASSERT_EQ(universe2, changed[0]);
+  OLA_ASSERT_TRUE(removed.empty());
+
+  // Patching a port changes the universe.
+  const uint64_t generation2 = m_store.InfoGeneration();
+  OLA_ASSERT_TRUE(m_port_manager.PatchPort(&m_port, 1));
+  changed.clear();
+  m_store.GetInfoChanges(generation2, &changed, &removed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changed.size());
+  OLA_ASSERT_EQ(universe1, changed[0]);
+
+  // Unpatching it removes the universe.
+  const uint64_t generation3 = m_store.InfoGeneration();
+  OLA_ASSERT_TRUE(m_port_manager.UnPatchPort(&m_port));
+  m_store.GarbageCollectUniverses();
+  OLA_ASSERT_NULL(m_store.GetUniverse(1));
+  changed.clear();
+  m_store.GetInfoChanges(generation3, &changed, &removed);
+  OLA_ASSERT_TRUE(changed.empty());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), removed.size());
+  OLA_ASSERT_EQ(1u, removed[0]);
+
+  // Creating it again means it's no longer removed.
+  m_store.GetUniverseOrCreate(1);
+  removed.clear();
+  m_store.GetInfoChanges(generation3, &changed, &removed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changed.size());
+  OLA_ASSERT_TRUE(removed.empty());
+}
+
+
+/*
+ * Check the DeviceManager tracks which devices have changed.
+ */
+void InfoNotifierTest::testDeviceChanges() {
+  MockDevice device2(&m_plugin, "test device 2");
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), m_device_manager.Generation());
+
+  OLA_ASSERT_TRUE(m_device_manager.RegisterDevice(&m_device));
+  const uint64_t generation = m_device_manager.Generation();
+  OLA_ASSERT_TRUE(m_device_manager.RegisterDevice(&device2));
+
+  vector<device_alias_pair> changed;
+  vector<unsigned int> removed;
+  m_device_manager.GetChanges(generation, &changed, &removed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changed.size());
+  OLA_ASSERT_EQ(static_cast<ola::AbstractDevice*>(&device2),
+                changed[0].device);
+  const unsigned int alias2 = changed[0].alias;
+  OLA_ASSERT_TRUE(removed.empty());
+
+  const uint64_t generation2 = m_device_manager.Generation();
+  m_device_manager.DeviceChanged(&m_device);
+  OLA_ASSERT_TRUE(m_device_manager.UnregisterDevice(&device2));
+  changed.clear();
+  m_device_manager.GetChanges(generation2, &changed, &removed);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), changed.size());
+  OLA_ASSERT_EQ(static_cast<ola::AbstractDevice*>(&m_device),
+                changed[0].device);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), removed.size());
+  OLA_ASSERT_EQ(alias2, removed[0]);
+
+  // Changes to unregistered devices are ignored.
+  const uint64_t generation3 = m_device_manager.Generation();
+  m_device_manager.DeviceChanged(&device2);
+  OLA_ASSERT_EQ(generation3, m_device_manager.Generation());
+}
+
+
+/*
+ * Check registered clients are sent the changes.
+ */
+void InfoNotifierTest::testNotify() {
+  MockClient client1, client2;
+  m_store.GetUniverseOrCreate(1);
+  OLA_ASSERT_TRUE(m_device_manager.RegisterDevice(&m_device));
+
+  InfoNotifier notifier(&m_store, &m_device_manager, &m_ss);
+  notifier.AddClient(&client1);
+  OLA_ASSERT_EQ(1u, notifier.ClientCount());
+
+  // Nothing has changed since the client registered.
+  notifier.SendChanges();
+  OLA_ASSERT_TRUE(client1.updates.empty());
+
+  // Changes are coalesced.
+  Universe *universe2 = m_store.GetUniverseOrCreate(2);
+  universe2->SetName("foo");
+  universe2->SetMergeMode(Universe::MERGE_HTP);
+  OLA_ASSERT_TRUE(m_port_manager.PatchPort(&m_port, 3));
+  m_device_manager.DeviceChanged(&m_device);
+  notifier.SendChanges();
+
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client1.updates.size());
+  const ola::proto::InfoChanges &changes = client1.updates[0];
+  OLA_ASSERT_EQ(m_store.InfoGeneration(), changes.universe_generation());
+  OLA_ASSERT_EQ(m_device_manager.Generation(), changes.device_generation());
+  OLA_ASSERT_EQ(2, changes.changed_universe_size());
+  OLA_ASSERT_EQ(2, changes.changed_universe(0));
+  OLA_ASSERT_EQ(3, changes.changed_universe(1));
+  OLA_ASSERT_EQ(0, changes.removed_universe_size());
+  OLA_ASSERT_EQ(1, changes.changed_device_size());
+  OLA_ASSERT_EQ(0, changes.removed_device_size());
+
+  notifier.AddClient(&client2);
+  notifier.SendChanges();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client1.updates.size());
+  OLA_ASSERT_TRUE(client2.updates.empty());
+
+  notifier.RemoveClient(&client1);
+  OLA_ASSERT_TRUE(m_port_manager.UnPatchPort(&m_port));
+  OLA_ASSERT_TRUE(m_device_manager.UnregisterDevice(&m_device));
+  m_store.GarbageCollectUniverses();
+  notifier.SendChanges();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client1.updates.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client2.updates.size());
+  OLA_ASSERT_EQ(1, client2.updates[0].removed_device_size());
+  OLA_ASSERT_EQ(1, client2.updates[0].removed_universe_size());
+  OLA_ASSERT_EQ(3, client2.updates[0].removed_universe(0));
+
+  notifier.RemoveClient(&client2);
+  OLA_ASSERT_EQ(0u, notifier.ClientCount());
+}
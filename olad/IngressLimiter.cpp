@@ -0,0 +1,226 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * IngressLimiter.cpp
+ * Limits the rate clients can send DMX data at.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include "ola/Callback.h"
+#include "ola/strings/Format.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/IngressLimiter.h"
+#include "olad/TokenBucket.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using std::set;
+
+// Held frames are merged a little faster than the DMX refresh rate.
+const unsigned int IngressLimiter::TICK_INTERVAL_MS = 10;
+
+const char IngressLimiter::K_THROTTLED_FRAMES_VAR[] =
+    "ingress-throttled-frames";
+const char IngressLimiter::K_COALESCED_FRAMES_VAR[] =
+    "ingress-coalesced-frames";
+const char IngressLimiter::K_THROTTLED_CLIENTS_VAR[] =
+    "ingress-throttled-clients";
+const char IngressLimiter::K_THROTTLED_UNIVERSE_VAR[] =
+    "ingress-throttled-universe";
+
+IngressLimiter::IngressLimiter(UniverseStore *universe_store,
+                               ola::thread::SchedulerInterface *scheduler,
+                               const TimeStamp *wake_up_time,
+                               const Options &options,
+                               ExportMap *export_map)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_wake_up_time(wake_up_time),
+      m_options(options),
+      m_universe_rate(options.universe_rate),
+      m_tick_timeout(ola::thread::INVALID_TIMEOUT),
+      m_throttled_var(NULL),
+      m_coalesced_var(NULL),
+      m_throttled_clients_var(NULL),
+      m_throttled_universe_var(NULL) {
+  if (export_map) {
+    m_throttled_var = export_map->GetCounterVar(K_THROTTLED_FRAMES_VAR);
+    m_coalesced_var = export_map->GetCounterVar(K_COALESCED_FRAMES_VAR);
+    m_throttled_clients_var = export_map->GetIntegerVar(
+        K_THROTTLED_CLIENTS_VAR);
+    m_throttled_universe_var = export_map->GetUIntMapVar(
+        K_THROTTLED_UNIVERSE_VAR, "universe");
+  }
+}
+
+IngressLimiter::~IngressLimiter() {
+  if (m_tick_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_tick_timeout);
+  }
+  STLDeleteValues(&m_client_buckets);
+  STLDeleteValues(&m_universe_buckets);
+}
+
+bool IngressLimiter::Admit(Client *client, unsigned int universe_id) {
+  HeldKey key(client, universe_id);
+  if (TakeToken(client, universe_id)) {
+    // This frame supersedes any that was held.
+    if (m_held.erase(key)) {
+      UpdateThrottledClients();
+    }
+    return true;
+  }
+
+  if (m_throttled_var) {
+    (*m_throttled_var)++;
+  }
+  if (m_throttled_universe_var) {
+    m_throttled_universe_var->Increment(strings::IntToString(universe_id));
+  }
+
+  if (m_held.insert(key).second) {
+    UpdateThrottledClients();
+  } else if (m_coalesced_var) {
+    (*m_coalesced_var)++;
+  }
+
+  if (m_tick_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_tick_timeout = m_scheduler->RegisterRepeatingTimeout(
+        TICK_INTERVAL_MS,
+        NewCallback(this, &IngressLimiter::MergeHeldFrames));
+  }
+  return false;
+}
+
+void IngressLimiter::RemoveClient(const Client *client) {
+  set<HeldKey>::iterator iter = m_held.begin();
+  while (iter != m_held.end()) {
+    if (iter->first == client) {
+      m_held.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  STLRemoveAndDelete(&m_client_buckets, client);
+  UpdateThrottledClients();
+}
+
+void IngressLimiter::SetUniverseCap(unsigned int cap) {
+  unsigned int rate = m_options.universe_rate;
+  if (cap && (!rate || cap < rate)) {
+    rate = cap;
+  }
+  if (rate == m_universe_rate) {
+    return;
+  }
+  // The buckets are created again at the new rate.
+  m_universe_rate = rate;
+  STLDeleteValues(&m_universe_buckets);
+}
+
+bool IngressLimiter::MergeHeldFrames() {
+  set<HeldKey>::iterator iter = m_held.begin();
+  while (iter != m_held.end()) {
+    if (!TakeToken(iter->first, iter->second)) {
+      ++iter;
+      continue;
+    }
+
+    // The client's latest data is merged, which covers all the frames that
+    // were coalesced.
+    Universe *universe = m_universe_store->GetUniverse(iter->second);
+    if (universe) {
+      universe->SourceClientDataChanged(iter->first);
+    }
+    m_held.erase(iter++);
+  }
+  UpdateThrottledClients();
+
+  if (m_held.empty()) {
+    m_tick_timeout = ola::thread::INVALID_TIMEOUT;
+    return false;
+  }
+  return true;
+}
+
+/*
+ * A frame needs a token from both the client's and the universe's bucket.
+ */
+bool IngressLimiter::TakeToken(const Client *client,
+                               unsigned int universe_id) {
+  const TimeStamp &now = *m_wake_up_time;
+  TokenBucket *client_bucket = NULL;
+  if (m_options.client_rate) {
+    client_bucket = STLFindOrNull(m_client_buckets, client);
+    if (!client_bucket) {
+      client_bucket = NewBucket(m_options.client_rate);
+      m_client_buckets[client] = client_bucket;
+    }
+  }
+
+  TokenBucket *universe_bucket = NULL;
+  if (m_universe_rate) {
+    universe_bucket = STLFindOrNull(m_universe_buckets, universe_id);
+    if (!universe_bucket) {
+      universe_bucket = NewBucket(m_universe_rate);
+      m_universe_buckets[universe_id] = universe_bucket;
+    }
+  }
+
+  if ((client_bucket && !client_bucket->Count(now)) ||
+      (universe_bucket && !universe_bucket->Count(now))) {
+    return false;
+  }
+
+  if (client_bucket) {
+    client_bucket->GetToken(now);
+  }
+  if (universe_bucket) {
+    universe_bucket->GetToken(now);
+  }
+  return true;
+}
+
+/*
+ * Buckets hold a tenth of a second of frames, so short bursts get through.
+ */
+TokenBucket *IngressLimiter::NewBucket(unsigned int rate) const {
+  const unsigned int burst = std::max(1u, rate / 10);
+  return new TokenBucket(burst, rate, burst, *m_wake_up_time);
+}
+
+void IngressLimiter::UpdateThrottledClients() {
+  if (!m_throttled_clients_var) {
+    return;
+  }
+
+  int clients = 0;
+  const Client *last = NULL;
+  set<HeldKey>::const_iterator iter = m_held.begin();
+  for (; iter != m_held.end(); ++iter) {
+    if (iter->first != last) {
+      clients++;
+      last = iter->first;
+    }
+  }
+  m_throttled_clients_var->Set(clients);
+}
+}  // namespace ola
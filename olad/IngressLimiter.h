@@ -0,0 +1,150 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * IngressLimiter.h
+ * Limits the rate clients can send DMX data at.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_INGRESSLIMITER_H_
+#define OLAD_INGRESSLIMITER_H_
+
+#include <map>
+#include <set>
+#include <utility>
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class Client;
+class TokenBucket;
+class UniverseStore;
+
+/**
+ * @brief Limits the rate at which clients' DMX frames are merged.
+ *
+ * Each client, and each universe, has a token bucket. A frame is merged
+ * straight away if both buckets have a token, otherwise it's held. The
+ * client's data is still stored, so if more frames arrive while one is held
+ * they're coalesced, and only the latest is merged once tokens are
+ * available again. This stops one client flooding the event loop with merges
+ * at the expense of everyone else.
+ */
+class IngressLimiter {
+ public:
+  /**
+   * @brief The limits to apply.
+   */
+  struct Options {
+    /** @brief Frames per second for each client, 0 means no limit. */
+    unsigned int client_rate;
+    /** @brief Frames per second for each universe, 0 means no limit. */
+    unsigned int universe_rate;
+
+    Options() : client_rate(0), universe_rate(0) {}
+  };
+
+  /**
+   * @brief Create a new IngressLimiter.
+   * @param universe_store the UniverseStore to look universes up in.
+   * @param scheduler the scheduler to run the tick that merges held frames.
+   * @param wake_up_time the time of the current event loop iteration.
+   * @param options the limits to apply.
+   * @param export_map the ExportMap to use for the throttling metrics, may be
+   *   NULL.
+   */
+  IngressLimiter(UniverseStore *universe_store,
+                 ola::thread::SchedulerInterface *scheduler,
+                 const TimeStamp *wake_up_time,
+                 const Options &options,
+                 ExportMap *export_map);
+  ~IngressLimiter();
+
+  /**
+   * @brief Check if a client's frame for a universe can be merged now.
+   * @param client the client that sent the frame.
+   * @param universe_id the universe the frame is for.
+   * @returns true if the caller should merge the frame, false if it's been
+   *   held and will be merged later.
+   */
+  bool Admit(Client *client, unsigned int universe_id);
+
+  /**
+   * @brief Drop the state for a client, including any held frames.
+   * @param client the client to remove.
+   */
+  void RemoveClient(const Client *client);
+
+  /**
+   * @brief Cap the frames per second for each universe, on top of the
+   *   configured universe_rate.
+   * @param cap the cap, 0 removes it.
+   *
+   * This is used as a last resort when olad is overloaded. Frames held
+   * because of the cap are merged on the next tick once it's removed.
+   */
+  void SetUniverseCap(unsigned int cap);
+
+  /**
+   * @brief The number of frames waiting to be merged.
+   */
+  unsigned int HeldFrames() const {
+    return static_cast<unsigned int>(m_held.size());
+  }
+
+  /**
+   * @brief Merge the held frames that there are now tokens for.
+   * @returns true if there are frames still held.
+   */
+  bool MergeHeldFrames();
+
+  static const unsigned int TICK_INTERVAL_MS;
+
+  static const char K_THROTTLED_FRAMES_VAR[];
+  static const char K_COALESCED_FRAMES_VAR[];
+  static const char K_THROTTLED_CLIENTS_VAR[];
+  static const char K_THROTTLED_UNIVERSE_VAR[];
+
+ private:
+  typedef std::pair<Client*, unsigned int> HeldKey;
+  typedef std::map<const Client*, TokenBucket*> ClientBuckets;
+  typedef std::map<unsigned int, TokenBucket*> UniverseBuckets;
+
+  UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  const TimeStamp *m_wake_up_time;
+  const Options m_options;
+  unsigned int m_universe_rate;  // the universe_rate with the cap applied
+  ClientBuckets m_client_buckets;
+  UniverseBuckets m_universe_buckets;
+  std::set<HeldKey> m_held;
+  ola::thread::timeout_id m_tick_timeout;
+
+  CounterVariable *m_throttled_var;
+  CounterVariable *m_coalesced_var;
+  IntegerVariable *m_throttled_clients_var;
+  UIntMap *m_throttled_universe_var;
+
+  bool TakeToken(const Client *client, unsigned int universe_id);
+  TokenBucket *NewBucket(unsigned int rate) const;
+  void UpdateThrottledClients();
+
+  DISALLOW_COPY_AND_ASSIGN(IngressLimiter);
+};
+}  // namespace ola
+#endif  // OLAD_INGRESSLIMITER_H_
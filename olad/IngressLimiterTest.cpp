@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * IngressLimiterTest.cpp
+ * Test fixture for the IngressLimiter class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/IngressLimiter.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Client;
+using ola::DmxBuffer;
+using ola::IngressLimiter;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::Universe;
+using ola::UniverseStore;
+
+class IngressLimiterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(IngressLimiterTest);
+  CPPUNIT_TEST(testClientLimit);
+  CPPUNIT_TEST(testUniverseLimit);
+  CPPUNIT_TEST(testRemoveClient);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    IngressLimiterTest()
+        : m_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {
+    }
+
+    void setUp() {
+      ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+      m_store.reset(new UniverseStore(NULL, &m_export_map));
+      m_clock.CurrentTime(&m_now);
+    }
+
+    void tearDown() {
+      m_limiter.reset();
+      m_store->DeleteAll();
+      m_store.reset();
+    }
+
+    void testClientLimit();
+    void testUniverseLimit();
+    void testRemoveClient();
+
+ private:
+    ola::rdm::UID m_uid;
+    ola::ExportMap m_export_map;
+    ola::io::SelectServer m_ss;
+    ola::Clock m_clock;
+    TimeStamp m_now;
+    std::auto_ptr<UniverseStore> m_store;
+    std::auto_ptr<IngressLimiter> m_limiter;
+
+    void CreateLimiter(unsigned int client_rate, unsigned int universe_rate) {
+      IngressLimiter::Options options;
+      options.client_rate = client_rate;
+      options.universe_rate = universe_rate;
+      m_limiter.reset(new IngressLimiter(m_store.get(), &m_ss, &m_now,
+                                         options, &m_export_map));
+    }
+
+    // Returns true if the frame was merged straight away.
+    bool Send(Client *client, Universe *universe, uint8_t value) {
+      DmxBuffer data;
+      data.SetRangeToValue(0, value, 4);
+      client->DMXReceived(universe->UniverseId(), data.GetRaw(), data.Size(),
+                          m_now, ola::dmx::SOURCE_PRIORITY_DEFAULT);
+      if (!m_limiter->Admit(client, universe->UniverseId())) {
+        return false;
+      }
+      universe->SourceClientDataChanged(client);
+      return true;
+    }
+
+    bool Advance(unsigned int ms) {
+      m_now += TimeInterval(static_cast<int64_t>(ms) * 1000);
+      return m_limiter->MergeHeldFrames();
+    }
+
+    unsigned int Counter(const char *name) {
+      return m_export_map.GetCounterVar(name)->Get();
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IngressLimiterTest);
+
+/*
+ * Check a client sending too fast is held back, and that the frames it sends
+ * while held are coalesced.
+ */
+void IngressLimiterTest::testClientLimit() {
+  // 20 fps allows a burst of 2 frames.
+  CreateLimiter(20, 0);
+  Client client(NULL, m_uid);
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+
+  OLA_ASSERT_TRUE(Send(&client, universe, 1));
+  OLA_ASSERT_TRUE(Send(&client, universe, 2));
+  OLA_ASSERT_FALSE(Send(&client, universe, 3));
+  OLA_ASSERT_FALSE(Send(&client, universe, 4));
+  OLA_ASSERT_EQ(1u, m_limiter->HeldFrames());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), universe->GetDMX().Get(0));
+  OLA_ASSERT_EQ(2u, Counter(IngressLimiter::K_THROTTLED_FRAMES_VAR));
+  OLA_ASSERT_EQ(1u, Counter(IngressLimiter::K_COALESCED_FRAMES_VAR));
+  OLA_ASSERT_EQ(1, m_export_map.GetIntegerVar(
+      IngressLimiter::K_THROTTLED_CLIENTS_VAR)->Get());
+
+  // There isn't a token yet.
+  OLA_ASSERT_TRUE(Advance(10));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), universe->GetDMX().Get(0));
+
+  // Only the latest frame is merged.
+  OLA_ASSERT_FALSE(Advance(50));
+  OLA_ASSERT_EQ(0u, m_limiter->HeldFrames());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(4), universe->GetDMX().Get(0));
+  OLA_ASSERT_EQ(0, m_export_map.GetIntegerVar(
+      IngressLimiter::K_THROTTLED_CLIENTS_VAR)->Get());
+
+  // Another client has its own bucket.
+  Client client2(NULL, m_uid);
+  Universe *universe2 = m_store->GetUniverseOrCreate(2);
+  OLA_ASSERT_TRUE(Send(&client2, universe2, 5));
+  OLA_ASSERT_TRUE(Send(&client2, universe2, 6));
+}
+
+/*
+ * Check the limit for a universe applies across all clients.
+ */
+void IngressLimiterTest::testUniverseLimit() {
+  // 10 fps allows a burst of 1 frame.
+  CreateLimiter(0, 10);
+  Client client1(NULL, m_uid);
+  Client client2(NULL, m_uid);
+  Universe *universe1 = m_store->GetUniverseOrCreate(1);
+  Universe *universe2 = m_store->GetUniverseOrCreate(2);
+
+  OLA_ASSERT_TRUE(Send(&client1, universe1, 10));
+  OLA_ASSERT_FALSE(Send(&client2, universe1, 20));
+  OLA_ASSERT_TRUE(Send(&client2, universe2, 30));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(10), universe1->GetDMX().Get(0));
+
+  OLA_ASSERT_FALSE(Advance(100));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(20), universe1->GetDMX().Get(0));
+  OLA_ASSERT_EQ(2u, universe1->SourceClientCount());
+}
+
+/*
+ * Check held frames are dropped when a client goes away.
+ */
+void IngressLimiterTest::testRemoveClient() {
+  CreateLimiter(10, 0);
+  Client client(NULL, m_uid);
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+
+  OLA_ASSERT_TRUE(Send(&client, universe, 1));
+  OLA_ASSERT_FALSE(Send(&client, universe, 2));
+  OLA_ASSERT_EQ(1u, m_limiter->HeldFrames());
+
+  m_limiter->RemoveClient(&client);
+  OLA_ASSERT_EQ(0u, m_limiter->HeldFrames());
+  OLA_ASSERT_FALSE(Advance(100));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), universe->GetDMX().Get(0));
+  universe->RemoveSourceClient(&client);
+}
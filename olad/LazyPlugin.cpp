@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * LazyPlugin.cpp
+ * A plugin which isn't constructed until it's needed.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/LazyPlugin.h"
+
+#include <set>
+#include <string>
+
+#include "ola/Logging.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/Preferences.h"
+
+namespace ola {
+
+using std::set;
+using std::string;
+
+// This matches Plugin::ENABLED_KEY.
+static const char ENABLED_KEY[] = "enabled";
+
+LazyPlugin::LazyPlugin(PluginAdaptor *plugin_adaptor,
+                       PluginFactory *factory,
+                       ola_plugin_id plugin_id,
+                       const string &name,
+                       const string &prefix,
+                       bool default_mode)
+    : AbstractPlugin(),
+      m_plugin_adaptor(plugin_adaptor),
+      m_factory(factory),
+      m_plugin_id(plugin_id),
+      m_name(name),
+      m_prefix(prefix),
+      m_default_mode(default_mode),
+      m_preferences(NULL) {
+}
+
+/*
+ * Load just enough of the preferences to tell if the plugin is enabled. The
+ * plugin sets the rest of its defaults when it's built.
+ */
+bool LazyPlugin::LoadPreferences() {
+  if (m_plugin.get()) {
+    return m_plugin->LoadPreferences();
+  }
+
+  if (m_preferences) {
+    return true;
+  }
+
+  if (m_prefix.empty()) {
+    OLA_WARN << m_name << ", no prefix provided";
+    return false;
+  }
+
+  m_preferences = m_plugin_adaptor->NewPreference(m_prefix);
+  if (!m_preferences) {
+    return false;
+  }
+
+  return ReloadPreferences();
+}
+
+bool LazyPlugin::ReloadPreferences() {
+  if (m_plugin.get()) {
+    return m_plugin->ReloadPreferences();
+  }
+
+  if (!m_preferences) {
+    return LoadPreferences();
+  }
+
+  m_preferences->Load();
+  bool save = m_preferences->SetDefaultValue(ENABLED_KEY, BoolValidator(),
+                                             m_default_mode);
+  if (save) {
+    m_preferences->Save();
+  }
+  return true;
+}
+
+string LazyPlugin::PreferenceConfigLocation() const {
+  if (m_plugin.get()) {
+    return m_plugin->PreferenceConfigLocation();
+  }
+  return m_preferences ? m_preferences->ConfigLocation() : "";
+}
+
+bool LazyPlugin::IsEnabled() const {
+  if (m_plugin.get()) {
+    return m_plugin->IsEnabled();
+  }
+  return m_preferences && m_preferences->GetValueAsBool(ENABLED_KEY);
+}
+
+void LazyPlugin::SetEnabledState(bool enable) {
+  if (m_plugin.get()) {
+    m_plugin->SetEnabledState(enable);
+  } else if (m_preferences) {
+    m_preferences->SetValueAsBool(ENABLED_KEY, enable);
+    m_preferences->Save();
+  }
+}
+
+bool LazyPlugin::CanPrepareOffMainThread() const {
+  Plugin *plugin = GetPlugin();
+  return plugin && plugin->CanPrepareOffMainThread();
+}
+
+bool LazyPlugin::PrepareStart() {
+  Plugin *plugin = GetPlugin();
+  return plugin && plugin->PrepareStart();
+}
+
+bool LazyPlugin::Start() {
+  Plugin *plugin = GetPlugin();
+  return plugin && plugin->Start();
+}
+
+bool LazyPlugin::Stop() {
+  // If it was never built, it was never started.
+  return m_plugin.get() && m_plugin->Stop();
+}
+
+string LazyPlugin::Description() const {
+  Plugin *plugin = GetPlugin();
+  return plugin ? plugin->Description() : "";
+}
+
+void LazyPlugin::ConflictsWith(set<ola_plugin_id> *conflict_set) const {
+  Plugin *plugin = GetPlugin();
+  if (plugin) {
+    plugin->ConflictsWith(conflict_set);
+  }
+}
+
+/*
+ * Build the plugin if we haven't already.
+ * @returns the plugin, or NULL if it couldn't be built.
+ */
+Plugin *LazyPlugin::GetPlugin() const {
+  if (m_plugin.get()) {
+    return m_plugin.get();
+  }
+
+  std::auto_ptr<Plugin> plugin(m_factory(m_plugin_adaptor));
+  if (!plugin.get()) {
+    return NULL;
+  }
+
+  if (plugin->Id() != m_plugin_id || plugin->Name() != m_name ||
+      plugin->PluginPrefix() != m_prefix) {
+    OLA_WARN << "Plugin " << plugin->Name() << " doesn't match the descriptor "
+             << "for " << m_name;
+    return NULL;
+  }
+
+  if (!plugin->LoadPreferences()) {
+    OLA_WARN << "Failed to load preferences for " << m_name;
+    return NULL;
+  }
+  OLA_DEBUG << "Built plugin " << m_name;
+  m_plugin.reset(plugin.release());
+  return m_plugin.get();
+}
+}  // namespace ola
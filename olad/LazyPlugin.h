@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * LazyPlugin.h
+ * A plugin which isn't constructed until it's needed.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_LAZYPLUGIN_H_
+#define OLAD_LAZYPLUGIN_H_
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "ola/base/Macro.h"
+#include "ola/plugin_id.h"
+#include "olad/Plugin.h"
+
+namespace ola {
+
+/**
+ * @brief A function which creates a new Plugin.
+ */
+typedef Plugin *PluginFactory(PluginAdaptor *plugin_adaptor);
+
+/**
+ * @brief Create a new plugin of the given type.
+ * @tparam PluginClass the type of plugin to create.
+ * @param plugin_adaptor the PluginAdaptor to pass to the plugin.
+ */
+template <typename PluginClass>
+Plugin *NewPlugin(PluginAdaptor *plugin_adaptor) {
+  return new PluginClass(plugin_adaptor);
+}
+
+/**
+ * @brief A proxy for a Plugin which delays constructing it.
+ *
+ * Until the plugin is started, or something is asked of it that only the
+ * plugin itself can answer, like the description or conflicts, only the
+ * descriptor is held. This means disabled plugins only cost a Preferences
+ * object, with the enabled key, rather than a full plugin with default
+ * preferences.
+ */
+class LazyPlugin: public AbstractPlugin {
+ public:
+  /**
+   * @brief Create a new LazyPlugin.
+   * @param plugin_adaptor the PluginAdaptor to use.
+   * @param factory the function used to create the plugin.
+   * @param plugin_id the id of the plugin, this must match the plugin's Id().
+   * @param name the name of the plugin, this must match the plugin's Name().
+   * @param prefix the preferences prefix, this must match the plugin's
+   *   PluginPrefix().
+   * @param default_mode true if the plugin is enabled by default.
+   */
+  LazyPlugin(PluginAdaptor *plugin_adaptor,
+             PluginFactory *factory,
+             ola_plugin_id plugin_id,
+             const std::string &name,
+             const std::string &prefix,
+             bool default_mode = true);
+  ~LazyPlugin() {}
+
+  bool LoadPreferences();
+  bool ReloadPreferences();
+  std::string PreferenceConfigLocation() const;
+  bool IsEnabled() const;
+  void SetEnabledState(bool enable);
+  bool CanPrepareOffMainThread() const;
+  bool PrepareStart();
+  bool Start();
+  bool Stop();
+  ola_plugin_id Id() const { return m_plugin_id; }
+  std::string Name() const { return m_name; }
+  std::string Description() const;
+  void ConflictsWith(std::set<ola_plugin_id> *conflict_set) const;
+
+  bool operator<(const AbstractPlugin &other) const {
+    return Id() < other.Id();
+  }
+
+  /**
+   * @brief Check if the plugin has been constructed.
+   * @returns true if the plugin has been constructed.
+   */
+  bool IsBuilt() const { return m_plugin.get() != NULL; }
+
+ private:
+  PluginAdaptor *m_plugin_adaptor;
+  PluginFactory *m_factory;
+  const ola_plugin_id m_plugin_id;
+  const std::string m_name;
+  const std::string m_prefix;
+  const bool m_default_mode;
+  class Preferences *m_preferences;
+  mutable std::auto_ptr<Plugin> m_plugin;
+
+  Plugin *GetPlugin() const;
+
+  DISALLOW_COPY_AND_ASSIGN(LazyPlugin);
+};
+}  // namespace ola
+#endif  // OLAD_LAZYPLUGIN_H_
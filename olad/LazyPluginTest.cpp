@@ -0,0 +1,209 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * LazyPluginTest.cpp
+ * Test fixture for the LazyPlugin class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "olad/LazyPlugin.h"
+#include "olad/Plugin.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/PluginLoader.h"
+#include "olad/PluginManager.h"
+#include "olad/Preferences.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::AbstractPlugin;
+using ola::LazyPlugin;
+using ola::NewPlugin;
+using ola::PluginLoader;
+using ola::PluginManager;
+using std::set;
+using std::string;
+using std::vector;
+
+
+class LazyPluginTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(LazyPluginTest);
+  CPPUNIT_TEST(testDisabledPlugin);
+  CPPUNIT_TEST(testQueryBuildsPlugin);
+  CPPUNIT_TEST(testMismatchedDescriptor);
+  CPPUNIT_TEST(testPluginManager);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testDisabledPlugin();
+    void testQueryBuildsPlugin();
+    void testMismatchedDescriptor();
+    void testPluginManager();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LazyPluginTest);
+
+
+/*
+ * A plugin that can be created by NewPlugin<>.
+ */
+template <ola::ola_plugin_id plugin_id>
+class LazyMockPlugin: public TestMockPlugin {
+ public:
+    explicit LazyMockPlugin(ola::PluginAdaptor *plugin_adaptor)
+        : TestMockPlugin(plugin_adaptor, plugin_id) {
+    }
+
+    std::string PluginPrefix() const { return "test" + Name(); }
+
+    // TestMockPlugin is always enabled, so use the preferences like a real
+    // plugin does.
+    bool IsEnabled() const { return Plugin::IsEnabled(); }
+    bool LoadPreferences() { return Plugin::LoadPreferences(); }
+};
+
+
+typedef LazyMockPlugin<ola::OLA_PLUGIN_DUMMY> DummyMockPlugin;
+typedef LazyMockPlugin<ola::OLA_PLUGIN_ARTNET> ArtNetMockPlugin;
+
+
+/*
+ * A Mock Loader
+ */
+class LazyMockLoader: public ola::PluginLoader {
+ public:
+    explicit LazyMockLoader(const vector<AbstractPlugin*> &plugins):
+      PluginLoader(),
+      m_plugins(plugins) {
+    }
+
+    vector<AbstractPlugin*> LoadPlugins() {
+      return m_plugins;
+    }
+    void UnloadPlugins() {}
+
+ private:
+    vector<AbstractPlugin*> m_plugins;
+};
+
+
+/*
+ * Check a disabled plugin isn't built until it's started.
+ */
+void LazyPluginTest::testDisabledPlugin() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  LazyPlugin plugin(&adaptor, &NewPlugin<DummyMockPlugin>,
+                    ola::OLA_PLUGIN_DUMMY, "1", "test1", false);
+  OLA_ASSERT_EQ(ola::OLA_PLUGIN_DUMMY, plugin.Id());
+  OLA_ASSERT_EQ(string("1"), plugin.Name());
+
+  OLA_ASSERT_TRUE(plugin.LoadPreferences());
+  OLA_ASSERT_FALSE(plugin.IsEnabled());
+  OLA_ASSERT_FALSE(plugin.IsBuilt());
+
+  // The enabled key was saved with the default.
+  ola::Preferences *preferences = factory.NewPreference("test1");
+  OLA_ASSERT_EQ(string("false"), preferences->GetValue("enabled"));
+
+  OLA_ASSERT_FALSE(plugin.Stop());
+  OLA_ASSERT_FALSE(plugin.IsBuilt());
+
+  plugin.SetEnabledState(true);
+  OLA_ASSERT_TRUE(plugin.IsEnabled());
+  OLA_ASSERT_FALSE(plugin.IsBuilt());
+  OLA_ASSERT_EQ(string("true"), preferences->GetValue("enabled"));
+
+  OLA_ASSERT_TRUE(plugin.Start());
+  OLA_ASSERT_TRUE(plugin.IsBuilt());
+  OLA_ASSERT_TRUE(plugin.IsEnabled());
+  OLA_ASSERT_TRUE(plugin.Stop());
+}
+
+
+/*
+ * Check that asking for things only the plugin knows builds it.
+ */
+void LazyPluginTest::testQueryBuildsPlugin() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  LazyPlugin plugin(&adaptor, &NewPlugin<DummyMockPlugin>,
+                    ola::OLA_PLUGIN_DUMMY, "1", "test1");
+  OLA_ASSERT_TRUE(plugin.LoadPreferences());
+  OLA_ASSERT_TRUE(plugin.IsEnabled());
+  OLA_ASSERT_FALSE(plugin.IsBuilt());
+
+  OLA_ASSERT_EQ(string("bar"), plugin.Description());
+  OLA_ASSERT_TRUE(plugin.IsBuilt());
+
+  set<ola::ola_plugin_id> conflicts;
+  plugin.ConflictsWith(&conflicts);
+  OLA_ASSERT_TRUE(conflicts.empty());
+  OLA_ASSERT_TRUE(plugin.IsEnabled());
+}
+
+
+/*
+ * Check a descriptor that doesn't match the plugin is rejected.
+ */
+void LazyPluginTest::testMismatchedDescriptor() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  LazyPlugin plugin(&adaptor, &NewPlugin<DummyMockPlugin>,
+                    ola::OLA_PLUGIN_ARTNET, "1", "test1");
+  OLA_ASSERT_TRUE(plugin.LoadPreferences());
+  OLA_ASSERT_FALSE(plugin.Start());
+  OLA_ASSERT_FALSE(plugin.IsBuilt());
+  OLA_ASSERT_EQ(string(""), plugin.Description());
+}
+
+
+/*
+ * Check the PluginManager only builds enabled plugins.
+ */
+void LazyPluginTest::testPluginManager() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  LazyPlugin plugin1(&adaptor, &NewPlugin<DummyMockPlugin>,
+                     ola::OLA_PLUGIN_DUMMY, "1", "test1");
+  LazyPlugin plugin2(&adaptor, &NewPlugin<ArtNetMockPlugin>,
+                     ola::OLA_PLUGIN_ARTNET, "2", "test2", false);
+  vector<AbstractPlugin*> our_plugins;
+  our_plugins.push_back(&plugin1);
+  our_plugins.push_back(&plugin2);
+
+  LazyMockLoader loader(our_plugins);
+  vector<PluginLoader*> loaders;
+  loaders.push_back(&loader);
+
+  PluginManager manager(loaders, &adaptor);
+  manager.LoadAll();
+
+  OLA_ASSERT_TRUE(manager.IsActive(ola::OLA_PLUGIN_DUMMY));
+  OLA_ASSERT_TRUE(plugin1.IsBuilt());
+  OLA_ASSERT_FALSE(manager.IsEnabled(ola::OLA_PLUGIN_ARTNET));
+  OLA_ASSERT_FALSE(plugin2.IsBuilt());
+  manager.UnloadAll();
+}
@@ -13,16 +13,35 @@ ola_server_sources = \
     olad/ClientBroker.h \
     olad/DiscoveryAgent.cpp \
     olad/DiscoveryAgent.h \
+    olad/DmxWebSocketModule.h \
     olad/DynamicPluginLoader.cpp \
     olad/DynamicPluginLoader.h \
+    olad/EventLoopThread.cpp \
+    olad/EventLoopThread.h \
+    olad/FadeEngine.cpp \
+    olad/FadeEngine.h \
     olad/HttpServerActions.h \
+    olad/InfoNotifier.cpp \
+    olad/InfoNotifier.h \
+    olad/IngressLimiter.cpp \
+    olad/IngressLimiter.h \
+    olad/LazyPlugin.cpp \
+    olad/LazyPlugin.h \
     olad/OlaServerServiceImpl.cpp \
     olad/OlaServerServiceImpl.h \
     olad/OladHTTPServer.h \
+    olad/OverloadController.cpp \
+    olad/OverloadController.h \
     olad/PluginLoader.h \
     olad/PluginManager.cpp \
     olad/PluginManager.h \
-    olad/RDMHTTPModule.h
+    olad/RDMHTTPModule.h \
+    olad/RDMPoller.cpp \
+    olad/RDMPoller.h \
+    olad/StartupTrace.cpp \
+    olad/StartupTrace.h \
+    olad/UdpStreamServer.cpp \
+    olad/UdpStreamServer.h
 ola_server_additional_libs =
 
 if HAVE_DNSSD
@@ -36,7 +55,8 @@ ola_server_additional_libs += $(avahi_LIBS)
 endif
 
 if HAVE_LIBMICROHTTPD
-ola_server_sources += olad/HttpServerActions.cpp \
+ola_server_sources += olad/DmxWebSocketModule.cpp \
+                      olad/HttpServerActions.cpp \
                       olad/OladHTTPServer.cpp \
                       olad/RDMHTTPModule.cpp
 ola_server_additional_libs += common/http/libolahttp.la
@@ -87,8 +107,17 @@ COMMON_OLAD_TEST_LDADD = $(COMMON_TESTING_LIBS) $(libprotobuf_LIBS) \
                          common/libolacommon.la
 
 olad_OlaTester_SOURCES = \
+    olad/EventLoopThreadTest.cpp \
+    olad/FadeEngineTest.cpp \
+    olad/InfoNotifierTest.cpp \
+    olad/IngressLimiterTest.cpp \
+    olad/LazyPluginTest.cpp \
     olad/PluginManagerTest.cpp \
-    olad/OlaServerServiceImplTest.cpp
+    olad/OlaServerServiceImplTest.cpp \
+    olad/OverloadControllerTest.cpp \
+    olad/RDMPollerTest.cpp \
+    olad/StartupTraceTest.cpp \
+    olad/UdpStreamServerTest.cpp
 olad_OlaTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
 olad_OlaTester_LDADD = $(COMMON_OLAD_TEST_LDADD)
 
@@ -61,6 +61,16 @@ using ola::thread::MutexLocker;
 using std::auto_ptr;
 using std::string;
 
+namespace {
+SelectServer::Options SelectServerOptions(const OlaServer::Options &options,
+                                          ExportMap *export_map) {
+  SelectServer::Options ss_options;
+  ss_options.use_timer_wheel = options.use_timer_wheel;
+  ss_options.export_map = export_map;
+  return ss_options;
+}
+}  // namespace
+
 const char OlaDaemon::OLA_CONFIG_DIR[] = ".ola";
 const char OlaDaemon::CONFIG_DIR_KEY[] = "config-dir";
 const char OlaDaemon::UID_KEY[] = "uid";
@@ -72,7 +82,7 @@ OlaDaemon::OlaDaemon(const OlaServer::Options &options,
                      ExportMap *export_map)
     : m_options(options),
       m_export_map(export_map),
-      m_ss(m_export_map) {
+      m_ss(SelectServerOptions(options, export_map)) {
   if (m_export_map) {
     uid_t uid;
     if (GetUID(&uid)) {
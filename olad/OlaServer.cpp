@@ -26,7 +26,13 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <set>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -35,16 +41,25 @@
 #include "common/rpc/RpcServer.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Flags.h"
+#include "ola/io/SharedMemoryBlockPool.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
+#include "ola/thread/Utils.h"
 #include "olad/ClientBroker.h"
+#include "olad/Device.h"
 #include "olad/DiscoveryAgent.h"
+#include "olad/EventLoopThread.h"
+#include "olad/FadeEngine.h"
+#include "olad/InfoNotifier.h"
+#include "olad/IngressLimiter.h"
 #include "olad/OlaServer.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/Plugin.h"
@@ -53,6 +68,10 @@
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
+#include "olad/OverloadController.h"
+#include "olad/RDMPoller.h"
+#include "olad/StartupTrace.h"
+#include "olad/UdpStreamServer.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
@@ -65,8 +84,13 @@
 
 DEFINE_s_uint16(rpc_port, r, ola::OlaServer::DEFAULT_RPC_PORT,
                 "The port to listen for RPCs on. Defaults to 9010.");
+DEFINE_default_bool(rpc_unix_socket, true,
+                    "Don't listen for RPCs from local clients on a unix "
+                    "domain socket.");
 DEFINE_default_bool(register_with_dns_sd, true,
                     "Don't register the web service using DNS-SD (Bonjour).");
+DEFINE_default_bool(udp_streaming, true,
+                    "Don't let clients stream DMX data over UDP.");
 
 namespace ola {
 
@@ -76,18 +100,57 @@ using ola::rpc::RpcChannel;
 using ola::rpc::RpcSession;
 using ola::rpc::RpcServer;
 using std::auto_ptr;
+using std::map;
+using std::ostringstream;
 using std::pair;
+using std::set;
+using std::string;
 using std::vector;
 
+const char OlaServer::CLIENT_INGRESS_RATE_KEY[] = "client-ingress-rate";
 const char OlaServer::INSTANCE_NAME_KEY[] = "instance-name";
 const char OlaServer::K_INSTANCE_NAME_VAR[] = "server-instance-name";
 const char OlaServer::K_UID_VAR[] = "server-uid";
+const char OlaServer::K_MEMORY_VAR[] = "memory-bytes";
+const char OlaServer::K_TRACE_CATEGORY[] = "olad";
+const char OlaServer::K_PLUGIN_MEMORY_VAR[] = "plugin-memory-bytes";
+const char OlaServer::K_UNIVERSE_MEMORY_VAR[] = "universe-memory-bytes";
+const char OlaServer::K_WORKER_LOOP_NODE_VAR[] = "worker-loop-node";
+const char OlaServer::OVERLOAD_INPUT_CAP_KEY[] = "overload-input-cap";
+const char OlaServer::OVERLOAD_LAG_KEY[] = "overload-lag-threshold";
+const char OlaServer::OVERLOAD_SINK_RATE_KEY[] = "overload-sink-rate";
 const char OlaServer::SERVER_PREFERENCES[] = "server";
+const char OlaServer::UNIVERSE_INGRESS_RATE_KEY[] = "universe-ingress-rate";
 const char OlaServer::UNIVERSE_PREFERENCES[] = "universe";
 // The Bonjour API expects <service>[,<sub-type>] so we use that form here.
 const char OlaServer::K_DISCOVERY_SERVICE_TYPE[] = "_http._tcp,_ola";
 const unsigned int OlaServer::K_HOUSEKEEPING_TIMEOUT_MS = 10000;
 
+namespace {
+/*
+ * Pick the NUMA node for an extra event loop. A loop that's pinned to a CPU
+ * uses that CPU's node. The others are spread across the nodes, and pinned to
+ * all of the node's CPUs.
+ */
+unsigned int PlaceWorkerLoop(const ola::thread::NumaNodeMap &nodes,
+                             unsigned int index,
+                             vector<unsigned int> *cpus) {
+  ola::thread::NumaNodeMap::const_iterator iter = nodes.begin();
+  if (!cpus->empty()) {
+    for (; iter != nodes.end(); ++iter) {
+      if (std::binary_search(iter->second.begin(), iter->second.end(),
+                             (*cpus)[0])) {
+        return iter->first;
+      }
+    }
+    iter = nodes.begin();
+  }
+  std::advance(iter, index % nodes.size());
+  *cpus = iter->second;
+  return iter->first;
+}
+}  // namespace
+
 OlaServer::OlaServer(const vector<PluginLoader*> &plugin_loaders,
                      PreferencesFactory *preferences_factory,
                      ola::io::SelectServer *select_server,
@@ -103,7 +166,8 @@ OlaServer::OlaServer(const vector<PluginLoader*> &plugin_loaders,
       m_default_uid(OPEN_LIGHTING_ESTA_CODE, 0),
       m_server_preferences(NULL),
       m_universe_preferences(NULL),
-      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT) {
+      m_housekeeping_timeout(ola::thread::INVALID_TIMEOUT),
+      m_flush_registered(false) {
   if (!m_export_map) {
     m_our_export_map.reset(new ExportMap());
     m_export_map = m_our_export_map.get();
@@ -123,12 +187,19 @@ OlaServer::~OlaServer() {
   // Order is important during shutdown.
   // Shutdown the RPC server first since it depends on almost everything else.
   m_rpc_server.reset();
+  m_overload_controller.reset();
+  m_fade_engine.reset();
+  m_ingress_limiter.reset();
+  m_info_notifier.reset();
+  m_udp_stream_server.reset();
 
   if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
     m_ss->RemoveTimeout(m_housekeeping_timeout);
   }
 
   StopPlugins();
+  StopWorkerLoops();
+  m_interface_monitor.reset();
 
   m_broker.reset();
   m_port_broker.reset();
@@ -137,6 +208,8 @@ OlaServer::~OlaServer() {
     m_universe_store->DeleteAll();
     m_universe_store.reset();
   }
+  // Deleting the ports may complete requests the poller has in flight.
+  m_rdm_poller.reset();
 
   if (m_server_preferences) {
     m_server_preferences->Save();
@@ -167,50 +240,89 @@ bool OlaServer::Init() {
     return false;
   }
 
+  if (!m_options.startup_trace_file.empty() && !m_startup_trace.get()) {
+    m_startup_trace.reset(new StartupTrace());
+  }
+  StartupTrace *trace = m_startup_trace.get();
+  StartupTrace::Span init_span(trace, "init", K_TRACE_CATEGORY);
+
+  StartupTrace::Span pid_span(trace, "pid-store", K_TRACE_CATEGORY);
   auto_ptr<const RootPidStore> pid_store(
       RootPidStore::LoadFromDirectory(m_options.pid_data_dir));
   if (!pid_store.get()) {
     OLA_WARN << "No PID definitions loaded";
   }
+  pid_span.End();
 
 #ifndef _WIN32
   signal(SIGPIPE, SIG_IGN);
 #endif  // _WIN32
 
-  // fetch the interface info
+  // fetch the interface info, the monitor keeps it up to date from now on
+  StartupTrace::Span interface_span(trace, "interfaces", K_TRACE_CATEGORY);
+  auto_ptr<ola::network::InterfaceMonitor> interface_monitor(
+      new ola::network::InterfaceMonitor(
+          m_ss, ola::network::InterfacePicker::NewPicker()));
+  interface_monitor->Init();
   ola::network::Interface iface;
-  {
-    auto_ptr<ola::network::InterfacePicker> picker(
-        ola::network::InterfacePicker::NewPicker());
-    if (!picker->ChooseInterface(&iface, m_options.network_interface)) {
-      OLA_WARN << "No network interface found";
-    } else {
-      // default to using the ip as a id
-      m_default_uid = ola::rdm::UID(OPEN_LIGHTING_ESTA_CODE,
-                                    iface.ip_address.AsInt());
-    }
+  if (!interface_monitor->ChooseInterface(&iface,
+                                          m_options.network_interface)) {
+    OLA_WARN << "No network interface found";
+  } else {
+    // default to using the ip as a id
+    m_default_uid = ola::rdm::UID(OPEN_LIGHTING_ESTA_CODE,
+                                  iface.ip_address.AsInt());
   }
   m_export_map->GetStringVar(K_UID_VAR)->Set(m_default_uid.ToString());
   OLA_INFO << "Server UID is " << m_default_uid;
+  interface_span.End();
 
+  StartupTrace::Span preferences_span(trace, "server-preferences",
+                                      K_TRACE_CATEGORY);
   m_server_preferences = m_preferences_factory->NewPreference(
       SERVER_PREFERENCES);
   m_server_preferences->Load();
-  if (m_server_preferences->SetDefaultValue(INSTANCE_NAME_KEY,
-                                            StringValidator(),
-                                            OLA_DEFAULT_INSTANCE_NAME)) {
+  bool save = m_server_preferences->SetDefaultValue(
+      INSTANCE_NAME_KEY, StringValidator(), OLA_DEFAULT_INSTANCE_NAME);
+  // Frames per second, 0 means there's no limit.
+  save |= m_server_preferences->SetDefaultValue(
+      CLIENT_INGRESS_RATE_KEY, UIntValidator(0, 1000000), 0u);
+  save |= m_server_preferences->SetDefaultValue(
+      UNIVERSE_INGRESS_RATE_KEY, UIntValidator(0, 1000000), 0u);
+  // The average loop lag in ms that sheds load, 0 disables load shedding.
+  save |= m_server_preferences->SetDefaultValue(
+      OVERLOAD_LAG_KEY, UIntValidator(0, 10000), 50u);
+  save |= m_server_preferences->SetDefaultValue(
+      OVERLOAD_SINK_RATE_KEY, UIntValidator(0, 1000), 10u);
+  save |= m_server_preferences->SetDefaultValue(
+      OVERLOAD_INPUT_CAP_KEY, UIntValidator(0, 1000), 25u);
+  if (save) {
     m_server_preferences->Save();
   }
   m_instance_name = m_server_preferences->GetValue(INSTANCE_NAME_KEY);
   m_export_map->GetStringVar(K_INSTANCE_NAME_VAR)->Set(m_instance_name);
   OLA_INFO << "Server instance name is " << m_instance_name;
+  preferences_span.End();
 
+  StartupTrace::Span universe_span(trace, "universe-store", K_TRACE_CATEGORY);
   Preferences *universe_preferences = m_preferences_factory->NewPreference(
       UNIVERSE_PREFERENCES);
   universe_preferences->Load();
 
   auto_ptr<UniverseStore> universe_store(
       new UniverseStore(universe_preferences, m_export_map));
+  universe_store->SetMaxFrameRate(m_options.max_universe_frame_rate);
+  universe_store->SetScheduler(m_ss);
+  if (!m_options.dmx_snapshot_file.empty() &&
+      !universe_store->OpenSnapshot(m_options.dmx_snapshot_file)) {
+    OLA_WARN << "Failed to open DMX snapshot " << m_options.dmx_snapshot_file
+             << ", outputs won't be restored on restart";
+  }
+  if (!m_options.capture_file.empty() &&
+      !universe_store->OpenCapture(m_options.capture_file)) {
+    OLA_WARN << "Failed to open capture file " << m_options.capture_file;
+  }
+  universe_span.End();
 
   auto_ptr<PortBroker> port_broker(new PortBroker());
 
@@ -226,9 +338,62 @@ bool OlaServer::Init() {
       new PluginAdaptor(device_manager.get(), m_ss, m_export_map,
                         m_preferences_factory, port_broker.get(),
                         &m_instance_name));
+  plugin_adaptor->SetInterfaceMonitor(interface_monitor.get());
+
+  if (m_worker_loops.empty() && m_options.worker_loops) {
+    StartupTrace::Span loops_span(trace, "worker-loops", K_TRACE_CATEGORY);
+    ola::thread::NumaNodeMap numa_nodes;
+    if (m_options.worker_loop_numa &&
+        !ola::thread::GetNumaNodes(&numa_nodes)) {
+      OLA_WARN << "The NUMA topology isn't available, the event loops won't "
+               << "be placed on nodes";
+    }
+
+    vector<ola::io::SelectServerInterface*> loops;
+    vector<unsigned int> loop_nodes;
+    for (unsigned int i = 0; i < m_options.worker_loops; i++) {
+      ostringstream name;
+      name << "olad-loop-" << i;
+      ola::thread::Thread::Options thread_options(name.str());
+      if (!m_options.worker_loop_cpus.empty()) {
+        thread_options.cpu_affinity.push_back(
+            m_options.worker_loop_cpus[i % m_options.worker_loop_cpus.size()]);
+      }
+      unsigned int node = 0;
+      if (!numa_nodes.empty()) {
+        node = PlaceWorkerLoop(numa_nodes, i, &thread_options.cpu_affinity);
+      }
+
+      ola::io::SelectServer::Options ss_options;
+      ss_options.use_timer_wheel = m_options.use_timer_wheel;
+      EventLoopThread *loop = new EventLoopThread(thread_options, ss_options);
+      if (!numa_nodes.empty()) {
+        loop->SetMemoryNode(node);
+      }
+      if (!loop->Start()) {
+        OLA_WARN << "Failed to start event loop " << i;
+        delete loop;
+        break;
+      }
+      m_worker_loops.push_back(loop);
+      loops.push_back(loop->GetSelectServer());
+      if (!numa_nodes.empty()) {
+        OLA_INFO << name.str() << " is on NUMA node " << node << ", CPUs "
+                 << ola::thread::CPUListToString(thread_options.cpu_affinity);
+        loop_nodes.push_back(node);
+        (*m_export_map->GetUIntMapVar(K_WORKER_LOOP_NODE_VAR, "loop"))[
+            name.str()] = node;
+      }
+    }
+    OLA_INFO << "Running plugins across " << loops.size()
+             << " extra event loops";
+    plugin_adaptor->SetWorkerLoops(loops, loop_nodes);
+  }
 
   auto_ptr<PluginManager> plugin_manager(
     new PluginManager(m_plugin_loaders, plugin_adaptor.get()));
+  plugin_manager->SetStartupTrace(trace);
+  interface_monitor->AddListener(plugin_manager.get());
 
   auto_ptr<OlaServerServiceImpl> service_impl(new OlaServerServiceImpl(
       universe_store.get(),
@@ -239,12 +404,91 @@ bool OlaServer::Init() {
       m_ss->WakeUpTime(),
       NewCallback(this, &OlaServer::ReloadPluginsInternal)));
 
+  auto_ptr<FadeEngine> fade_engine(
+      new FadeEngine(universe_store.get(), m_ss, m_ss->WakeUpTime()));
+  service_impl->SetFadeEngine(fade_engine.get());
+
+  IngressLimiter::Options ingress_options;
+  StringToInt(m_server_preferences->GetValue(CLIENT_INGRESS_RATE_KEY),
+              &ingress_options.client_rate);
+  StringToInt(m_server_preferences->GetValue(UNIVERSE_INGRESS_RATE_KEY),
+              &ingress_options.universe_rate);
+  OverloadController::Options overload_options;
+  StringToInt(m_server_preferences->GetValue(OVERLOAD_LAG_KEY),
+              &overload_options.lag_threshold_ms);
+  StringToInt(m_server_preferences->GetValue(OVERLOAD_SINK_RATE_KEY),
+              &overload_options.sink_rate);
+  StringToInt(m_server_preferences->GetValue(OVERLOAD_INPUT_CAP_KEY),
+              &overload_options.input_cap);
+
+  // The overload controller caps the input with the IngressLimiter, so it's
+  // needed even if there are no configured limits.
+  auto_ptr<IngressLimiter> ingress_limiter;
+  if (ingress_options.client_rate || ingress_options.universe_rate ||
+      (overload_options.lag_threshold_ms && overload_options.input_cap)) {
+    if (ingress_options.client_rate || ingress_options.universe_rate) {
+      OLA_INFO << "Limiting client DMX to " << ingress_options.client_rate
+               << " fps per client, " << ingress_options.universe_rate
+               << " fps per universe";
+    }
+    ingress_limiter.reset(new IngressLimiter(
+        universe_store.get(), m_ss, m_ss->WakeUpTime(), ingress_options,
+        m_export_map));
+    service_impl->SetIngressLimiter(ingress_limiter.get());
+  }
+
+  auto_ptr<RDMPoller> rdm_poller(
+      new RDMPoller(universe_store.get(), m_ss, m_default_uid));
+  service_impl->SetRDMPoller(rdm_poller.get());
+
+  auto_ptr<OverloadController> overload_controller;
+  if (overload_options.lag_threshold_ms) {
+    overload_controller.reset(new OverloadController(
+        universe_store.get(), m_ss, m_ss->WakeUpTime(), overload_options,
+        m_export_map));
+    overload_controller->SetRDMPoller(rdm_poller.get());
+    overload_controller->SetIngressLimiter(ingress_limiter.get());
+    overload_controller->Start();
+  }
+
+  auto_ptr<InfoNotifier> info_notifier(
+      new InfoNotifier(universe_store.get(), device_manager.get(), m_ss));
+  service_impl->SetInfoNotifier(info_notifier.get());
+
+  // The RPC server only listens on the loopback interface, so the UDP
+  // streaming socket does too.
+  auto_ptr<UdpStreamServer> udp_stream_server;
+  if (FLAGS_udp_streaming) {
+    udp_stream_server.reset(new UdpStreamServer(
+        m_ss,
+        NewCallback(service_impl.get(),
+                    &OlaServerServiceImpl::ReceiveClientBatch),
+        m_export_map));
+    if (udp_stream_server->Init(ola::network::IPV4SocketAddress(
+            ola::network::IPV4Address::Loopback(), 0))) {
+      service_impl->SetUdpStreamServer(udp_stream_server.get());
+    } else {
+      udp_stream_server.reset();
+    }
+  }
+
   // Initialize the RPC server.
   RpcServer::Options rpc_options;
   rpc_options.listen_socket = m_accepting_socket;
   rpc_options.listen_port = FLAGS_rpc_port;
   rpc_options.export_map = m_export_map;
+  // The socket path is tied to the port, so we can only use it if we opened
+  // the port ourselves.
+  if (FLAGS_rpc_unix_socket && !m_accepting_socket) {
+    if (!ola::rpc::SetupLocalSocketDirectory()) {
+      OLA_WARN << "Can't create the RPC socket, pass --no-rpc-unix-socket to "
+               << "only use TCP";
+      return false;
+    }
+    rpc_options.listen_path = ola::rpc::LocalSocketPath(FLAGS_rpc_port);
+  }
 
+  StartupTrace::Span rpc_span(trace, "rpc-server", K_TRACE_CATEGORY);
   auto_ptr<ola::rpc::RpcServer> rpc_server(
       new RpcServer(m_ss, service_impl.get(), this, rpc_options));
 
@@ -252,10 +496,12 @@ bool OlaServer::Init() {
     OLA_WARN << "Failed to init RPC server";
     return false;
   }
+  rpc_span.End();
 
   // Discovery
   auto_ptr<DiscoveryAgentInterface> discovery_agent;
   if (FLAGS_register_with_dns_sd) {
+    StartupTrace::Span discovery_span(trace, "discovery", K_TRACE_CATEGORY);
     DiscoveryAgentFactory discovery_agent_factory;
     discovery_agent.reset(discovery_agent_factory.New());
     if (discovery_agent.get()) {
@@ -274,6 +520,7 @@ bool OlaServer::Init() {
 
 #ifdef HAVE_LIBMICROHTTPD
   if (m_options.http_enable) {
+    StartupTrace::Span http_span(trace, "http-server", K_TRACE_CATEGORY);
     if (StartHttpServer(rpc_server.get(), iface)) {
       web_server_started = true;
     } else {
@@ -296,8 +543,15 @@ bool OlaServer::Init() {
 
   // Ok, we've created and initialized everything correctly by this point. Now
   // we save all the pointers and schedule the last of the callbacks.
+  m_interface_monitor.reset(interface_monitor.release());
   m_device_manager.reset(device_manager.release());
   m_discovery_agent.reset(discovery_agent.release());
+  m_fade_engine.reset(fade_engine.release());
+  m_ingress_limiter.reset(ingress_limiter.release());
+  m_rdm_poller.reset(rdm_poller.release());
+  m_overload_controller.reset(overload_controller.release());
+  m_info_notifier.reset(info_notifier.release());
+  m_udp_stream_server.reset(udp_stream_server.release());
   m_plugin_adaptor.reset(plugin_adaptor.release());
   m_plugin_manager.reset(plugin_manager.release());
   m_port_broker.reset(port_broker.release());
@@ -316,9 +570,20 @@ bool OlaServer::Init() {
       K_HOUSEKEEPING_TIMEOUT_MS,
       ola::NewCallback(this, &OlaServer::RunHousekeeping));
 
+  // Clients which batch DMX updates get everything from a loop iteration in
+  // one message. The SelectServer can't remove this, so it's only added once.
+  if (!m_flush_registered) {
+    m_ss->RunInLoop(ola::NewCallback(this, &OlaServer::FlushClientDMX));
+    m_flush_registered = true;
+  }
+
   // The plugin load procedure can take a while so we run it in the main loop.
   m_ss->Execute(
       ola::NewSingleCallback(m_plugin_manager.get(), &PluginManager::LoadAll));
+  if (trace) {
+    // Callbacks run in order, so this runs once the plugins have started.
+    m_ss->Execute(ola::NewSingleCallback(this, &OlaServer::FinishStartupTrace));
+  }
 
   return true;
 }
@@ -356,16 +621,34 @@ ola::network::GenericSocketAddress OlaServer::LocalRPCAddress() const {
 
 void OlaServer::NewClient(RpcSession *session) {
   OlaClientService_Stub *stub = new OlaClientService_Stub(session->Channel());
-  Client *client = new Client(stub, m_default_uid);
+  Client *client = new Client(stub, m_default_uid, m_export_map);
+  client->SetScheduler(m_ss);
   session->SetData(static_cast<void*>(client));
   m_broker->AddClient(client);
+  m_clients[client] = session;
 }
 
 void OlaServer::ClientRemoved(RpcSession *session) {
   auto_ptr<Client> client(reinterpret_cast<Client*>(session->GetData()));
   session->SetData(NULL);
 
+  m_clients.erase(client.get());
   m_broker->RemoveClient(client.get());
+  if (m_fade_engine.get()) {
+    m_fade_engine->RemoveClient(client.get());
+  }
+  if (m_ingress_limiter.get()) {
+    m_ingress_limiter->RemoveClient(client.get());
+  }
+  if (m_rdm_poller.get()) {
+    m_rdm_poller->RemoveClient(client.get());
+  }
+  if (m_info_notifier.get()) {
+    m_info_notifier->RemoveClient(client.get());
+  }
+  if (m_udp_stream_server.get()) {
+    m_udp_stream_server->RemoveClient(client.get());
+  }
 
   vector<Universe*> universe_list;
   m_universe_store->GetList(&universe_list);
@@ -378,6 +661,16 @@ void OlaServer::ClientRemoved(RpcSession *session) {
   }
 }
 
+/*
+ * Send the DMX updates held for each client over the last loop iteration.
+ */
+void OlaServer::FlushClientDMX() {
+  ClientSessionMap::iterator iter = m_clients.begin();
+  for (; iter != m_clients.end(); ++iter) {
+    iter->first->FlushDMX();
+  }
+}
+
 /*
  * Run the garbage collector
  */
@@ -385,6 +678,15 @@ bool OlaServer::RunHousekeeping() {
   OLA_DEBUG << "Garbage collecting";
   m_universe_store->GarbageCollectUniverses();
 
+  // Memory accounting and incremental discovery wait until we're no longer
+  // overloaded.
+  if (m_overload_controller.get() &&
+      m_overload_controller->BackgroundDeferred()) {
+    return true;
+  }
+
+  UpdateMemoryStats();
+
   // Give the universes an opportunity to run discovery
   vector<Universe*> universes;
   m_universe_store->GetList(&universes);
@@ -392,7 +694,6 @@ bool OlaServer::RunHousekeeping() {
   vector<Universe*>::iterator iter = universes.begin();
   const TimeStamp *now = m_ss->WakeUpTime();
   for (; iter != universes.end(); ++iter) {
-    (*iter)->CleanStaleSourceClients();
     if ((*iter)->IsActive() &&
         (*iter)->RDMDiscoveryInterval().Seconds() &&
         *now - (*iter)->LastRDMDiscovery() > (*iter)->RDMDiscoveryInterval()) {
@@ -403,6 +704,109 @@ bool OlaServer::RunHousekeeping() {
   return true;
 }
 
+/*
+ * Write out the startup trace once the plugins have started.
+ */
+void OlaServer::FinishStartupTrace() {
+  if (!m_startup_trace.get()) {
+    return;
+  }
+  if (m_plugin_manager.get()) {
+    m_plugin_manager->SetStartupTrace(NULL);
+  }
+  m_startup_trace->LogSummary();
+  if (m_startup_trace->WriteChromeTrace(m_options.startup_trace_file)) {
+    OLA_INFO << "Wrote the startup trace to " << m_options.startup_trace_file;
+  }
+  m_startup_trace.reset();
+}
+
+/*
+ * Set the values in a memory map, removing the keys that no longer exist.
+ */
+static void UpdateMemoryMap(UIntMap *var,
+                            const map<string, size_t> &values,
+                            set<string> *keys) {
+  set<string>::const_iterator key_iter = keys->begin();
+  for (; key_iter != keys->end(); ++key_iter) {
+    if (!STLContains(values, *key_iter)) {
+      var->Remove(*key_iter);
+    }
+  }
+
+  keys->clear();
+  map<string, size_t>::const_iterator iter = values.begin();
+  for (; iter != values.end(); ++iter) {
+    var->Set(iter->first, static_cast<unsigned int>(iter->second));
+    keys->insert(iter->first);
+  }
+}
+
+/*
+ * Update the estimates of the memory used by each part of the server.
+ *
+ * The pools in K_MEMORY_VAR don't overlap, apart from DmxBuffer frames which
+ * are counted both in the "dmx-frames" pool and by the universes, clients
+ * and plugins that reference them.
+ */
+void OlaServer::UpdateMemoryStats() {
+  size_t universe_bytes = 0;
+  size_t rdm_cache_bytes = 0;
+  map<string, size_t> universe_memory;
+  vector<Universe*> universes;
+  m_universe_store->GetList(&universes);
+  vector<Universe*>::const_iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    const size_t bytes = (*universe_iter)->MemoryUsage();
+    const size_t cache_bytes = (*universe_iter)->RDMCacheMemoryUsage();
+    universe_bytes += bytes;
+    rdm_cache_bytes += cache_bytes;
+    universe_memory[IntToString((*universe_iter)->UniverseId())] =
+        bytes + cache_bytes;
+  }
+
+  size_t client_bytes = 0;
+  size_t rpc_bytes = 0;
+  ClientSessionMap::const_iterator client_iter = m_clients.begin();
+  for (; client_iter != m_clients.end(); ++client_iter) {
+    client_bytes += client_iter->first->MemoryUsage();
+    rpc_bytes += client_iter->second->Channel()->ReceiveBufferSize();
+  }
+
+  size_t plugin_bytes = 0;
+  map<string, size_t> plugin_memory;
+  const vector<device_alias_pair> devices = m_device_manager->Devices();
+  vector<device_alias_pair>::const_iterator device_iter = devices.begin();
+  for (; device_iter != devices.end(); ++device_iter) {
+    AbstractDevice *device = device_iter->device;
+    const size_t bytes = device->MemoryUsage();
+    plugin_bytes += bytes;
+    if (device->Owner()) {
+      plugin_memory[device->Owner()->Name()] += bytes;
+    }
+  }
+
+  const ola::io::SharedMemoryBlockPool *packet_pool =
+      ola::io::SharedMemoryBlockPool::PacketPool();
+
+  UIntMap *pools = m_export_map->GetUIntMapVar(K_MEMORY_VAR, "pool");
+  pools->Set("universes", static_cast<unsigned int>(universe_bytes));
+  pools->Set("rdm-cache", static_cast<unsigned int>(rdm_cache_bytes));
+  pools->Set("client-sources", static_cast<unsigned int>(client_bytes));
+  pools->Set("rpc-buffers", static_cast<unsigned int>(rpc_bytes));
+  pools->Set("plugins", static_cast<unsigned int>(plugin_bytes));
+  pools->Set("packet-pool",
+             packet_pool->BlocksAllocated() * packet_pool->BlockSize());
+  pools->Set("dmx-frames",
+             static_cast<unsigned int>(DmxBuffer::PoolMemoryUsage()));
+
+  UpdateMemoryMap(
+      m_export_map->GetUIntMapVar(K_UNIVERSE_MEMORY_VAR, "universe"),
+      universe_memory, &m_universe_memory_keys);
+  UpdateMemoryMap(m_export_map->GetUIntMapVar(K_PLUGIN_MEMORY_VAR, "plugin"),
+                  plugin_memory, &m_plugin_memory_keys);
+}
+
 #ifdef HAVE_LIBMICROHTTPD
 bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
                                 const ola::network::Interface &iface) {
@@ -424,6 +828,9 @@ bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
   options.data_dir = (m_options.http_data_dir.empty() ? HTTP_DATA_DIR :
                       m_options.http_data_dir);
   options.enable_quit = m_options.http_enable_quit;
+  options.thread_pool_size = m_options.http_threads;
+  options.connection_limit = m_options.http_connection_limit;
+  options.connection_timeout = m_options.http_connection_timeout;
 
   auto_ptr<OladHTTPServer> httpd(
       new OladHTTPServer(m_export_map, options,
@@ -443,6 +850,20 @@ bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
 }
 #endif  // HAVE_LIBMICROHTTPD
 
+/*
+ * Stop the extra event loops. This must be called after the plugins have been
+ * stopped.
+ */
+void OlaServer::StopWorkerLoops() {
+  vector<EventLoopThread*>::iterator iter = m_worker_loops.begin();
+  for (; iter != m_worker_loops.end(); ++iter) {
+    (*iter)->Join();
+  }
+  STLDeleteElements(&m_worker_loops);
+  // Run anything the loops handed back to us before they stopped.
+  m_ss->DrainCallbacks();
+}
+
 void OlaServer::StopPlugins() {
   if (m_plugin_manager.get()) {
     m_plugin_manager->UnloadAll();
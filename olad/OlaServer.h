@@ -29,6 +29,7 @@
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
 #include <ola/io/SelectServer.h>
+#include <ola/network/InterfaceMonitor.h>
 #include <ola/network/InterfacePicker.h>
 #include <ola/network/Socket.h>
 #include <ola/network/TCPSocketFactory.h>
@@ -39,6 +40,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -70,8 +72,60 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
     unsigned int http_port;  /** @brief Port to run the HTTP server on */
     /** @brief Directory that contains the static content */
     std::string http_data_dir;
+    /**
+     * @brief The number of threads to process HTTP connections on, 0 uses
+     * the HTTP server thread.
+     */
+    unsigned int http_threads;
+    /** @brief The maximum number of HTTP connections, 0 means the default */
+    unsigned int http_connection_limit;
+    /** @brief Close idle HTTP connections after this many seconds */
+    unsigned int http_connection_timeout;
     std::string network_interface;
     std::string pid_data_dir;  /** @brief Directory with the PID definitions */
+    /**
+     * @brief The default max frame rate for universe updates, 0 means no
+     * limit.
+     */
+    unsigned int max_universe_frame_rate;
+    /**
+     * @brief The number of extra event loops to shard plugins across, 0 runs
+     * everything on the main loop.
+     */
+    unsigned int worker_loops;
+    /**
+     * @brief The CPUs to pin the extra event loops to. The loops are spread
+     * across the CPUs, one CPU per loop. Empty means any CPU.
+     */
+    std::vector<unsigned int> worker_loop_cpus;
+    /**
+     * @brief Place each extra event loop on a NUMA node. The loops are
+     * spread across the nodes and pinned to the node's CPUs, or to the
+     * worker_loop_cpus if they're set. Each loop prefers memory from its
+     * node, and plugins are sharded onto a loop on the same node as their
+     * network interface.
+     */
+    bool worker_loop_numa;
+    /**
+     * @brief Use a timer wheel rather than a priority queue for the
+     * timeouts on the main and extra event loops.
+     */
+    bool use_timer_wheel;
+    /**
+     * @brief The file to record the last frame of each universe in, so
+     * outputs can be restored after a restart. Empty disables this.
+     */
+    std::string dmx_snapshot_file;
+    /**
+     * @brief The pcapng file to record the data received by input ports in.
+     * Empty disables this.
+     */
+    std::string capture_file;
+    /**
+     * @brief The file to write a Chrome trace of the time each startup phase
+     * took to. Empty disables tracing.
+     */
+    std::string startup_trace_file;
   };
 
   /**
@@ -182,9 +236,11 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   ola::rdm::UID m_default_uid;
 
   // These are all populated in Init.
+  std::auto_ptr<ola::network::InterfaceMonitor> m_interface_monitor;
   std::auto_ptr<class DeviceManager> m_device_manager;
   std::auto_ptr<class PluginManager> m_plugin_manager;
   std::auto_ptr<class PluginAdaptor> m_plugin_adaptor;
+  std::vector<class EventLoopThread*> m_worker_loops;
   std::auto_ptr<class UniverseStore> m_universe_store;
   std::auto_ptr<class PortManager> m_port_manager;
   std::auto_ptr<class OlaServerServiceImpl> m_service_impl;
@@ -192,6 +248,12 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   std::auto_ptr<class PortBroker> m_port_broker;
   std::auto_ptr<const ola::rdm::RootPidStore> m_pid_store;
   std::auto_ptr<class DiscoveryAgentInterface> m_discovery_agent;
+  std::auto_ptr<class FadeEngine> m_fade_engine;
+  std::auto_ptr<class RDMPoller> m_rdm_poller;
+  std::auto_ptr<class InfoNotifier> m_info_notifier;
+  std::auto_ptr<class UdpStreamServer> m_udp_stream_server;
+  std::auto_ptr<class IngressLimiter> m_ingress_limiter;
+  std::auto_ptr<class OverloadController> m_overload_controller;
   std::auto_ptr<ola::rpc::RpcServer> m_rpc_server;
   class Preferences *m_server_preferences;
   class Preferences *m_universe_preferences;
@@ -199,8 +261,22 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
 
   ola::thread::timeout_id m_housekeeping_timeout;
   std::auto_ptr<OladHTTPServer_t> m_httpd;
+  typedef std::map<class Client*, ola::rpc::RpcSession*> ClientSessionMap;
+
+  // The connected clients and their sessions, so their batched DMX updates
+  // can be flushed.
+  ClientSessionMap m_clients;
+  bool m_flush_registered;
+  // The keys of the per-universe and per-plugin memory variables.
+  std::set<std::string> m_universe_memory_keys;
+  std::set<std::string> m_plugin_memory_keys;
+  // Only set while starting up, if tracing is enabled.
+  std::auto_ptr<class StartupTrace> m_startup_trace;
 
   bool RunHousekeeping();
+  void FlushClientDMX();
+  void UpdateMemoryStats();
+  void FinishStartupTrace();
 
 #ifdef HAVE_LIBMICROHTTPD
   bool StartHttpServer(ola::rpc::RpcServer *server,
@@ -210,6 +286,7 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
    * @brief Stop and unload all the plugins
    */
   void StopPlugins();
+  void StopWorkerLoops();
   bool InternalNewConnection(ola::rpc::RpcServer *server,
                              ola::io::ConnectedDescriptor *descriptor);
   void ReloadPluginsInternal();
@@ -218,11 +295,21 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
    */
   void UpdatePidStore(const ola::rdm::RootPidStore *pid_store);
 
+  static const char CLIENT_INGRESS_RATE_KEY[];
   static const char INSTANCE_NAME_KEY[];
   static const char K_INSTANCE_NAME_VAR[];
   static const char K_DISCOVERY_SERVICE_TYPE[];
   static const char K_UID_VAR[];
+  static const char K_MEMORY_VAR[];
+  static const char K_TRACE_CATEGORY[];
+  static const char K_PLUGIN_MEMORY_VAR[];
+  static const char K_UNIVERSE_MEMORY_VAR[];
+  static const char K_WORKER_LOOP_NODE_VAR[];
+  static const char OVERLOAD_INPUT_CAP_KEY[];
+  static const char OVERLOAD_LAG_KEY[];
+  static const char OVERLOAD_SINK_RATE_KEY[];
   static const char SERVER_PREFERENCES[];
+  static const char UNIVERSE_INGRESS_RATE_KEY[];
   static const char UNIVERSE_PREFERENCES[];
   static const unsigned int K_HOUSEKEEPING_TIMEOUT_MS;
 
@@ -19,13 +19,22 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
+#include "common/dmx/DmxDelta.h"
+#include "common/dmx/SharedDmxRegion.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Callback.h"
 #include "ola/CallbackRunner.h"
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/rdm/RDMCommand.h"
@@ -35,11 +44,15 @@
 #include "ola/timecode/TimeCodeEnums.h"
 #include "olad/ClientBroker.h"
 #include "olad/Device.h"
-#include "olad/DmxSource.h"
+#include "olad/FadeEngine.h"
+#include "olad/InfoNotifier.h"
+#include "olad/IngressLimiter.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/Plugin.h"
 #include "olad/PluginManager.h"
 #include "olad/Port.h"
+#include "olad/RDMPoller.h"
+#include "olad/UdpStreamServer.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
@@ -50,31 +63,41 @@ namespace ola {
 
 using ola::CallbackRunner;
 using ola::proto::Ack;
+using ola::proto::ConfigureUniversesRequest;
 using ola::proto::DeviceConfigReply;
 using ola::proto::DeviceConfigRequest;
 using ola::proto::DeviceInfo;
 using ola::proto::DeviceInfoReply;
 using ola::proto::DeviceInfoRequest;
+using ola::proto::DmxBatchReply;
+using ola::proto::DmxBatchRequest;
 using ola::proto::DmxData;
+using ola::proto::FadeRequest;
 using ola::proto::MergeModeRequest;
 using ola::proto::OptionalUniverseRequest;
 using ola::proto::PatchPortRequest;
+using ola::proto::PatchPortsRequest;
 using ola::proto::PluginDescriptionReply;
 using ola::proto::PluginDescriptionRequest;
 using ola::proto::PluginInfo;
 using ola::proto::PluginListReply;
 using ola::proto::PluginListRequest;
 using ola::proto::PortInfo;
+using ola::proto::RDMPollRequest;
 using ola::proto::RegisterDmxRequest;
 using ola::proto::UniverseInfo;
 using ola::proto::UniverseInfoReply;
 using ola::proto::UniverseNameRequest;
 using ola::proto::UniverseRequest;
+using ola::proto::UniverseStatsReply;
+using ola::proto::UniverseStatsRequest;
 using ola::rdm::RDMRequest;
 using ola::rdm::RDMResponse;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
 using ola::rpc::RpcController;
+using std::map;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -106,6 +129,80 @@ RDMRequest::OverrideOptions RDMRequestOptionsFromProto(
   }
   return options;
 }
+
+/*
+ * Build the GET or SET for an RDMRequest message.
+ */
+ola::rdm::RDMRequest *NewRDMRequest(const UID &source_uid,
+                                    const ola::proto::RDMRequest &request) {
+  UID destination(request.uid().esta_id(),
+                  request.uid().device_id());
+
+  RDMRequest::OverrideOptions options = RDMRequestOptionsFromProto(request);
+
+  if (request.is_set()) {
+    return new ola::rdm::RDMSetRequest(
+        source_uid,
+        destination,
+        0,  // transaction #
+        1,  // port id
+        request.sub_device(),
+        request.param_id(),
+        reinterpret_cast<const uint8_t*>(request.data().data()),
+        request.data().size(),
+        options);
+  } else {
+    return new ola::rdm::RDMGetRequest(
+        source_uid,
+        destination,
+        0,  // transaction #
+        1,  // port id
+        request.sub_device(),
+        request.param_id(),
+        reinterpret_cast<const uint8_t*>(request.data().data()),
+        request.data().size(),
+        options);
+  }
+}
+
+/*
+ * Find the universes for a batch request, sorted by id and without
+ * duplicates. See DmxBatchRequest.
+ */
+template<typename RequestType>
+void SelectUniverses(const UniverseStore *store, const RequestType &request,
+                     vector<Universe*> *universes) {
+  // Keyed by id so the result is in order and without duplicates.
+  map<unsigned int, Universe*> selected;
+  vector<Universe*> found;
+
+  if (request.has_first_universe() || request.has_last_universe()) {
+    store->GetRange(
+        request.first_universe(),
+        request.has_last_universe() ? request.last_universe() : UINT_MAX,
+        &found);
+  } else if (request.universes_size() == 0) {
+    store->GetList(&found);
+  }
+
+  for (int i = 0; i < request.universes_size(); i++) {
+    Universe *universe = store->GetUniverse(request.universes(i));
+    if (universe) {
+      found.push_back(universe);
+    }
+  }
+
+  vector<Universe*>::const_iterator iter = found.begin();
+  for (; iter != found.end(); ++iter) {
+    selected[(*iter)->UniverseId()] = *iter;
+  }
+
+  map<unsigned int, Universe*>::const_iterator selected_iter =
+      selected.begin();
+  for (; selected_iter != selected.end(); ++selected_iter) {
+    universes->push_back(selected_iter->second);
+  }
+}
 }  // namespace
 
 typedef CallbackRunner<ola::rpc::RpcService::CompletionCallback> ClosureRunner;
@@ -124,7 +221,13 @@ OlaServerServiceImpl::OlaServerServiceImpl(
       m_port_manager(port_manager),
       m_broker(broker),
       m_wake_up_time(wake_up_time),
-      m_reload_plugins_callback(reload_plugins_callback) {
+      m_fade_engine(NULL),
+      m_rdm_poller(NULL),
+      m_info_notifier(NULL),
+      m_udp_stream_server(NULL),
+      m_ingress_limiter(NULL),
+      m_reload_plugins_callback(reload_plugins_callback),
+      m_shared_dmx_count(0) {
 }
 
 void OlaServerServiceImpl::GetDmx(
@@ -143,6 +246,56 @@ void OlaServerServiceImpl::GetDmx(
   response->set_universe(request->universe());
 }
 
+void OlaServerServiceImpl::GetDmxBatch(
+    RpcController*,
+    const DmxBatchRequest* request,
+    DmxBatchReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  vector<Universe*> universes;
+  SelectUniverses(m_universe_store, *request, &universes);
+
+  const uint64_t since = request->since_generation();
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    const Universe *universe = *iter;
+    if (request->has_since_generation() && universe->Generation() <= since) {
+      continue;
+    }
+    DmxData *data = response->add_data();
+    data->set_universe(universe->UniverseId());
+    data->set_data(universe->GetDMX().Get());
+    data->set_priority(universe->ActivePriority());
+  }
+  response->set_generation(m_universe_store->Generation());
+}
+
+void OlaServerServiceImpl::GetUniverseStats(
+    RpcController*,
+    const UniverseStatsRequest* request,
+    UniverseStatsReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  vector<Universe*> universes;
+  SelectUniverses(m_universe_store, *request, &universes);
+
+  vector<Universe*>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    const Universe *universe = *iter;
+    const Universe::Counters &counters = universe->GetCounters();
+    ola::proto::UniverseStats *stats = response->add_stats();
+    stats->set_universe(universe->UniverseId());
+    stats->set_input_frames(counters.input_frames);
+    stats->set_output_frames(counters.output_frames);
+    stats->set_active_sources(universe->ActiveSourceCount());
+    stats->set_active_priority(universe->ActivePriority());
+    stats->set_priority_changes(counters.priority_changes);
+    stats->set_interval_count(counters.interval_count);
+    stats->set_interval_sum(counters.interval_sum);
+    stats->set_interval_sum_squares(counters.interval_sum_squares);
+  }
+}
+
 void OlaServerServiceImpl::RegisterForDmx(
     RpcController* controller,
     const RegisterDmxRequest* request,
@@ -155,10 +308,23 @@ void OlaServerServiceImpl::RegisterForDmx(
     return MissingUniverseError(controller);
   }
 
+  if (request->max_fps() < 0 || request->start_slot() < 0 ||
+      request->slot_count() < 0) {
+    controller->SetFailed("Invalid subscription");
+    return;
+  }
+
   Client *client = GetClient(controller);
+  Client::DmxSubscription subscription;
   if (request->action() == ola::proto::REGISTER) {
+    subscription.max_fps = request->max_fps();
+    subscription.only_on_change = request->only_on_change();
+    subscription.start_slot = request->start_slot();
+    subscription.slot_count = request->slot_count();
+    client->SetDmxSubscription(universe->UniverseId(), subscription);
     universe->AddSinkClient(client);
   } else {
+    client->SetDmxSubscription(universe->UniverseId(), subscription);
     universe->RemoveSinkClient(client);
   }
 }
@@ -169,26 +335,19 @@ void OlaServerServiceImpl::UpdateDmxData(
     Ack*,
     ola::rpc::RpcService::CompletionCallback* done) {
   ClosureRunner runner(done);
+  // The data is stored even if the universe doesn't exist, so it stays in
+  // sync with the client's delta encoding.
+  Client *client = GetClient(controller);
+  if (!ReceiveClientData(client, *request)) {
+    controller->SetFailed("Invalid delta encoded DMX data");
+    return;
+  }
+
   Universe *universe = m_universe_store->GetUniverse(request->universe());
   if (!universe) {
     return MissingUniverseError(controller);
   }
-
-  Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
-
-  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
-  if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
-  }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
-  universe->SourceClientDataChanged(client);
+  MergeClientData(client, universe);
 }
 
 void OlaServerServiceImpl::StreamDmxData(
@@ -196,27 +355,200 @@ void OlaServerServiceImpl::StreamDmxData(
     const ola::proto::DmxData* request,
     ola::proto::STREAMING_NO_RESPONSE*,
     ola::rpc::RpcService::CompletionCallback*) {
-  Universe *universe = m_universe_store->GetUniverse(request->universe());
+  Client *client = GetClient(controller);
+  if (!ReceiveClientData(client, *request)) {
+    return;
+  }
 
+  Universe *universe = m_universe_store->GetUniverse(request->universe());
   if (!universe) {
     return;
   }
+  MergeClientData(client, universe);
+}
+
+void OlaServerServiceImpl::StreamDmxDataBatch(
+    RpcController *controller,
+    const ola::proto::DmxDataBatch* request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    ola::rpc::RpcService::CompletionCallback*) {
+  ReceiveClientBatch(GetClient(controller), *request);
+}
+
+void OlaServerServiceImpl::ReceiveClientBatch(
+    Client *client,
+    const ola::proto::DmxDataBatch &batch) {
+  set<Universe*> universes;
+
+  for (int i = 0; i < batch.data_size(); i++) {
+    const DmxData &data = batch.data(i);
+    if (!ReceiveClientData(client, data)) {
+      continue;
+    }
+    Universe *universe = m_universe_store->GetUniverse(data.universe());
+    if (universe) {
+      universes.insert(universe);
+    }
+  }
+
+  set<Universe*>::iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    MergeClientData(client, *iter);
+  }
+}
+
+void OlaServerServiceImpl::SetupSharedDmx(
+    RpcController* controller,
+    const ola::proto::SharedDmxRequest* request,
+    ola::proto::SharedDmxReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (request->slots() <= 0) {
+    controller->SetFailed("Invalid slot count");
+    return;
+  }
+
+  unsigned int slots = std::min(
+      static_cast<unsigned int>(request->slots()),
+      ola::dmx::SharedDmxRegion::MAX_SLOTS);
+  std::ostringstream str;
+  str << "/ola-" << getpid() << "-" << m_shared_dmx_count++;
+
+  Client *client = GetClient(controller);
+  if (!client->SetupSharedDmx(str.str(), slots)) {
+    controller->SetFailed("Shared memory isn't available");
+    return;
+  }
+  response->set_name(str.str());
+  response->set_slots(slots);
+}
+
+void OlaServerServiceImpl::SetupUdpStream(
+    RpcController* controller,
+    const ola::proto::UdpStreamRequest*,
+    ola::proto::UdpStreamReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_udp_stream_server || !m_udp_stream_server->Port()) {
+    controller->SetFailed("UDP streaming isn't available");
+    return;
+  }
+
+  response->set_port(m_udp_stream_server->Port());
+  response->set_token(m_udp_stream_server->AddClient(GetClient(controller)));
+}
+
+void OlaServerServiceImpl::StreamSharedDmx(
+    RpcController *controller,
+    const ola::proto::SharedDmxNotification* request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    ola::rpc::RpcService::CompletionCallback*) {
+  // Older clients don't send the range, so check every slot.
+  unsigned int first_slot = 0;
+  unsigned int slot_count = ola::dmx::SharedDmxRegion::MAX_SLOTS;
+  if (request->has_first_slot() && request->has_slot_count()) {
+    if (request->first_slot() < 0 || request->slot_count() <= 0) {
+      return;
+    }
+    first_slot = request->first_slot();
+    slot_count = request->slot_count();
+  }
 
   Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
+  vector<unsigned int> updated;
+  client->ReadSharedDmx(first_slot, slot_count, *m_wake_up_time, &updated);
+  MergeClientUniverses(client, updated);
+}
+
+void OlaServerServiceImpl::StreamDmxRange(
+    RpcController *controller,
+    const ola::proto::DmxRange* request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    ola::rpc::RpcService::CompletionCallback*) {
+  if (request->first_universe() < 0 || request->slots_per_universe() <= 0) {
+    return;
+  }
 
   uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
   if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
-  }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
-  universe->SourceClientDataChanged(client);
+    priority = ClampPriority(request->priority());
+  }
+
+  Client *client = GetClient(controller);
+  const string &data = request->data();
+  vector<unsigned int> updated;
+  if (!client->ReceiveRange(
+          request->first_universe(), request->slots_per_universe(),
+          reinterpret_cast<const uint8_t*>(data.data()),
+          static_cast<unsigned int>(data.size()), *m_wake_up_time, priority,
+          &updated)) {
+    OLA_WARN << "Invalid DMX range starting at universe "
+             << request->first_universe();
+    return;
+  }
+  MergeClientUniverses(client, updated);
+}
+
+void OlaServerServiceImpl::SetDeltaEncoding(
+    RpcController* controller,
+    const ola::proto::DeltaEncodingRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  GetClient(controller)->SetDeltaEncoding(request->enable());
+}
+
+void OlaServerServiceImpl::SetDmxBatching(
+    RpcController* controller,
+    const ola::proto::DmxBatchingRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  GetClient(controller)->SetDmxBatching(request->enable());
+}
+
+void OlaServerServiceImpl::FadeDmx(
+    RpcController* controller,
+    const FadeRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_fade_engine) {
+    controller->SetFailed("Fades aren't supported");
+    return;
+  }
+
+  if (request->duration() < 0 || request->start_slot() < 0 ||
+      request->start_slot() >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+    controller->SetFailed("Invalid fade");
+    return;
+  }
+
+  FadeEngine::Curve curve = FadeEngine::LINEAR;
+  switch (request->curve()) {
+    case ola::proto::FADE_EASE_IN_OUT:
+      curve = FadeEngine::EASE_IN_OUT;
+      break;
+    case ola::proto::FADE_SQUARE:
+      curve = FadeEngine::SQUARE;
+      break;
+    case ola::proto::FADE_LINEAR:
+    default:
+      break;
+  }
+
+  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (request->has_priority()) {
+    priority = ClampPriority(request->priority());
+  }
+
+  DmxBuffer target(request->data());
+  TimeInterval duration(static_cast<int64_t>(request->duration()) * 1000);
+  if (!m_fade_engine->StartFade(GetClient(controller), request->universe(),
+                                target, request->start_slot(), duration,
+                                curve, priority)) {
+    return MissingUniverseError(controller);
+  }
 }
 
 void OlaServerServiceImpl::SetUniverseName(
@@ -287,11 +619,91 @@ void OlaServerServiceImpl::PatchPort(
     }
   }
 
-  if (!result) {
+  if (result) {
+    m_device_manager->DeviceChanged(device);
+  } else {
     controller->SetFailed("Patch port request failed");
   }
 }
 
+void OlaServerServiceImpl::PatchPorts(
+    RpcController* controller,
+    const PatchPortsRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  vector<PortManager::PortPatch> patches;
+  set<AbstractDevice*> devices;
+  patches.reserve(request->patches_size());
+
+  for (int i = 0; i < request->patches_size(); i++) {
+    const PatchPortRequest &patch = request->patches(i);
+    AbstractDevice *device =
+      m_device_manager->GetDevice(patch.device_alias());
+    if (!device) {
+      return MissingDeviceError(controller);
+    }
+    devices.insert(device);
+
+    const bool patch_port = patch.action() == ola::proto::PATCH;
+    if (patch.is_output()) {
+      OutputPort *port = device->GetOutputPort(patch.port_id());
+      if (!port) {
+        return MissingPortError(controller);
+      }
+      patches.push_back(
+          PortManager::PortPatch(port, patch_port, patch.universe()));
+    } else {
+      InputPort *port = device->GetInputPort(patch.port_id());
+      if (!port) {
+        return MissingPortError(controller);
+      }
+      patches.push_back(
+          PortManager::PortPatch(port, patch_port, patch.universe()));
+    }
+  }
+
+  string error;
+  if (!m_port_manager->PatchPorts(patches, &error)) {
+    controller->SetFailed(error);
+    return;
+  }
+
+  set<AbstractDevice*>::iterator iter = devices.begin();
+  for (; iter != devices.end(); ++iter) {
+    m_device_manager->DeviceChanged(*iter);
+  }
+}
+
+void OlaServerServiceImpl::ConfigureUniverses(
+    RpcController* controller,
+    const ConfigureUniversesRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  vector<Universe*> universes;
+  universes.reserve(request->universes_size());
+  for (int i = 0; i < request->universes_size(); i++) {
+    Universe *universe = m_universe_store->GetUniverse(
+        request->universes(i).universe());
+    if (!universe) {
+      return MissingUniverseError(controller);
+    }
+    universes.push_back(universe);
+  }
+
+  for (int i = 0; i < request->universes_size(); i++) {
+    const ola::proto::UniverseConfig &config = request->universes(i);
+    if (config.has_name()) {
+      universes[i]->SetName(config.name());
+    }
+    if (config.has_merge_mode()) {
+      universes[i]->SetMergeMode(config.merge_mode() == ola::proto::HTP ?
+          Universe::MERGE_HTP : Universe::MERGE_LTP);
+    }
+  }
+}
+
 void OlaServerServiceImpl::SetPortPriority(
     RpcController* controller,
     const ola::proto::PortPriorityRequest* request,
@@ -306,6 +718,7 @@ void OlaServerServiceImpl::SetPortPriority(
   }
 
   bool status;
+  Universe *universe;
 
   bool inherit_mode = true;
   uint8_t value = 0;
@@ -333,6 +746,7 @@ void OlaServerServiceImpl::SetPortPriority(
     } else {
       status = m_port_manager->SetPriorityStatic(port, value);
     }
+    universe = port->GetUniverse();
   } else {
     InputPort *port = device->GetInputPort(request->port_id());
     if (!port) {
@@ -344,11 +758,19 @@ void OlaServerServiceImpl::SetPortPriority(
     } else {
       status = m_port_manager->SetPriorityStatic(port, value);
     }
+    universe = port->GetUniverse();
   }
 
   if (!status) {
     controller->SetFailed(
         "Invalid SetPortPriority request, see logs for more info");
+    return;
+  }
+
+  // The port's priority is included in both the device and universe info.
+  m_device_manager->DeviceChanged(device);
+  if (universe) {
+    universe->InfoChanged();
   }
 }
 
@@ -391,6 +813,7 @@ void OlaServerServiceImpl::GetUniverseInfo(
     UniverseInfoReply* response,
     ola::rpc::RpcService::CompletionCallback* done) {
   ClosureRunner runner(done);
+  response->set_generation(m_universe_store->InfoGeneration());
 
   if (request->has_universe()) {
     // return info for a single universe
@@ -400,6 +823,20 @@ void OlaServerServiceImpl::GetUniverseInfo(
     }
 
     AddUniverse(universe, response);
+  } else if (request->has_since_generation()) {
+    // return the changes
+    vector<Universe*> uni_list;
+    vector<unsigned int> removed;
+    m_universe_store->GetInfoChanges(request->since_generation(), &uni_list,
+                                     &removed);
+    vector<Universe*>::const_iterator iter = uni_list.begin();
+    for (; iter != uni_list.end(); ++iter) {
+      AddUniverse(*iter, response);
+    }
+    vector<unsigned int>::const_iterator removed_iter = removed.begin();
+    for (; removed_iter != removed.end(); ++removed_iter) {
+      response->add_removed_universe(*removed_iter);
+    }
   } else {
     // return all
     vector<Universe*> uni_list;
@@ -429,12 +866,20 @@ void OlaServerServiceImpl::GetPlugins(
 }
 
 void OlaServerServiceImpl::ReloadPlugins(
-    RpcController*,
-    const ::ola::proto::PluginReloadRequest*,
+    RpcController* controller,
+    const ::ola::proto::PluginReloadRequest* request,
     Ack*,
     ola::rpc::RpcService::CompletionCallback* done) {
   ClosureRunner runner(done);
-  if (m_reload_plugins_callback.get()) {
+  if (request->has_plugin_id()) {
+    ola_plugin_id plugin_id = (ola_plugin_id) request->plugin_id();
+    AbstractPlugin *plugin = m_plugin_manager->GetPlugin(plugin_id);
+    if (!plugin) {
+      controller->SetFailed("Plugin not loaded");
+    } else if (!m_plugin_manager->ReloadPlugin(plugin_id)) {
+      controller->SetFailed("Failed to reload plugin: " + plugin->Name());
+    }
+  } else if (m_reload_plugins_callback.get()) {
     m_reload_plugins_callback->Run();
   } else {
     OLA_WARN << "No plugin reload callback provided!";
@@ -512,7 +957,19 @@ void OlaServerServiceImpl::GetDeviceInfo(
     DeviceInfoReply* response,
     ola::rpc::RpcService::CompletionCallback* done) {
   ClosureRunner runner(done);
-  vector<device_alias_pair> device_list = m_device_manager->Devices();
+  response->set_generation(m_device_manager->Generation());
+  vector<device_alias_pair> device_list;
+  if (request->has_since_generation()) {
+    vector<unsigned int> removed;
+    m_device_manager->GetChanges(request->since_generation(), &device_list,
+                                 &removed);
+    vector<unsigned int>::const_iterator removed_iter = removed.begin();
+    for (; removed_iter != removed.end(); ++removed_iter) {
+      response->add_removed_device(*removed_iter);
+    }
+  } else {
+    device_list = m_device_manager->Devices();
+  }
   vector<device_alias_pair>::const_iterator iter;
 
   for (iter = device_list.begin(); iter != device_list.end(); ++iter) {
@@ -721,37 +1178,8 @@ void OlaServerServiceImpl::RDMCommand(
   }
 
   Client *client = GetClient(controller);
-  UID source_uid = client->GetUID();
-
-  UID destination(request->uid().esta_id(),
-                  request->uid().device_id());
-
-  RDMRequest::OverrideOptions options = RDMRequestOptionsFromProto(*request);
-
-  ola::rdm::RDMRequest *rdm_request = NULL;
-  if (request->is_set()) {
-    rdm_request = new ola::rdm::RDMSetRequest(
-        source_uid,
-        destination,
-        0,  // transaction #
-        1,  // port id
-        request->sub_device(),
-        request->param_id(),
-        reinterpret_cast<const uint8_t*>(request->data().data()),
-        request->data().size(),
-        options);
-  } else {
-    rdm_request = new ola::rdm::RDMGetRequest(
-        source_uid,
-        destination,
-        0,  // transaction #
-        1,  // port id
-        request->sub_device(),
-        request->param_id(),
-        reinterpret_cast<const uint8_t*>(request->data().data()),
-        request->data().size(),
-        options);
-  }
+  ola::rdm::RDMRequest *rdm_request = NewRDMRequest(client->GetUID(),
+                                                    *request);
 
   ola::rdm::RDMCallback *callback =
     NewSingleCallback(
@@ -806,6 +1234,100 @@ void OlaServerServiceImpl::RDMDiscoveryCommand(
   m_broker->SendRDMRequest(client, universe, rdm_request, callback);
 }
 
+void OlaServerServiceImpl::RDMCommandBatch(
+    RpcController* controller,
+    const ola::proto::RDMBatchRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  Client *client = GetClient(controller);
+  const UID source_uid = client->GetUID();
+
+  // Each universe queues its own requests, so the requests for different
+  // universes are sent concurrently.
+  for (int i = 0; i < request->request_size(); i++) {
+    const ola::proto::RDMRequest &rdm_request = request->request(i);
+    ola::rdm::RDMCallback *callback = NewSingleCallback(
+        this,
+        &OlaServerServiceImpl::HandleRDMBatchResponse,
+        client,
+        request->batch_id(),
+        static_cast<unsigned int>(i),
+        rdm_request.include_raw_response());
+
+    Universe *universe = m_universe_store->GetUniverse(
+        rdm_request.universe());
+    if (!universe) {
+      ola::rdm::RunRDMCallback(callback, ola::rdm::RDM_FAILED_TO_SEND);
+      continue;
+    }
+    m_broker->SendRDMRequest(client, universe,
+                             NewRDMRequest(source_uid, rdm_request),
+                             callback);
+  }
+}
+
+void OlaServerServiceImpl::RegisterForRDMPoll(
+    RpcController* controller,
+    const RDMPollRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_rdm_poller) {
+    controller->SetFailed("RDM polling isn't supported");
+    return;
+  }
+
+  Universe *universe = m_universe_store->GetUniverse(request->universe());
+  if (!universe) {
+    return MissingUniverseError(controller);
+  }
+
+  Client *client = GetClient(controller);
+  if (request->action() == ola::proto::UNREGISTER) {
+    m_rdm_poller->Unsubscribe(client, universe->UniverseId());
+    return;
+  }
+
+  RDMPoller::PollItems items;
+  for (int i = 0; i < request->item_size(); i++) {
+    const ola::proto::RDMPollItem &item = request->item(i);
+    if (item.param_id() < 0 || item.param_id() > 0xffff ||
+        item.sub_device() < 0 || item.sub_device() > 0xffff) {
+      controller->SetFailed("Invalid poll item");
+      return;
+    }
+    items.insert(RDMPoller::PollItem(item.sub_device(), item.param_id(),
+                                     item.data()));
+  }
+
+  TimeInterval interval(
+      static_cast<int64_t>(std::max(request->interval(), 0)) * 1000);
+  if (!m_rdm_poller->Subscribe(client, universe->UniverseId(), interval,
+                               items)) {
+    controller->SetFailed("No items to poll");
+  }
+}
+
+void OlaServerServiceImpl::RegisterForInfoUpdates(
+    RpcController* controller,
+    const ola::proto::RegisterInfoRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  if (!m_info_notifier) {
+    controller->SetFailed("Info updates aren't supported");
+    return;
+  }
+
+  Client *client = GetClient(controller);
+  if (request->action() == ola::proto::REGISTER) {
+    m_info_notifier->AddClient(client);
+  } else {
+    m_info_notifier->RemoveClient(client);
+  }
+}
+
 void OlaServerServiceImpl::SetSourceUID(
     RpcController *controller,
     const ola::proto::UID* request,
@@ -850,6 +1372,30 @@ void OlaServerServiceImpl::HandleRDMResponse(
     bool include_raw_packets,
     ola::rdm::RDMReply *reply) {
   ClosureRunner runner(done);
+  RDMReplyToProto(reply, include_raw_packets, response);
+}
+
+/*
+ * Send the response to a request in a batch to the client. The ClientBroker
+ * only runs this if the client still exists.
+ */
+void OlaServerServiceImpl::HandleRDMBatchResponse(
+    Client *client,
+    unsigned int batch_id,
+    unsigned int index,
+    bool include_raw_packets,
+    ola::rdm::RDMReply *reply) {
+  ola::proto::RDMBatchResult result;
+  result.set_batch_id(batch_id);
+  result.set_index(index);
+  RDMReplyToProto(reply, include_raw_packets, result.mutable_response());
+  client->SendRDMBatchResult(result);
+}
+
+void OlaServerServiceImpl::RDMReplyToProto(
+    const ola::rdm::RDMReply *reply,
+    bool include_raw_packets,
+    ola::proto::RDMResponse* response) {
   response->set_response_code(
       static_cast<ola::proto::RDMResponseCode>(reply->StatusCode()));
 
@@ -1035,6 +1581,86 @@ void OlaServerServiceImpl::SetProtoUID(const ola::rdm::UID &uid,
   pb_uid->set_device_id(uid.DeviceId());
 }
 
+/*
+ * Update a client's data for a universe. This copies straight from the
+ * request into the client's existing buffer. The caller is responsible for
+ * notifying the universe.
+ * @returns false if the request was delta encoded and couldn't be decoded.
+ */
+/*
+ * Merge a client's new data into a universe, unless the IngressLimiter holds
+ * it back. Held data is merged by the IngressLimiter later.
+ */
+void OlaServerServiceImpl::MergeClientData(Client *client,
+                                           Universe *universe) {
+  if (m_ingress_limiter &&
+      !m_ingress_limiter->Admit(client, universe->UniverseId())) {
+    return;
+  }
+  universe->SourceClientDataChanged(client);
+}
+
+void OlaServerServiceImpl::MergeClientUniverses(
+    Client *client,
+    const vector<unsigned int> &universe_ids) {
+  // A universe may be listed more than once, only update it once.
+  set<Universe*> universes;
+  vector<unsigned int>::const_iterator iter = universe_ids.begin();
+  for (; iter != universe_ids.end(); ++iter) {
+    if (m_fade_engine) {
+      m_fade_engine->CancelFade(client, *iter);
+    }
+    Universe *universe = m_universe_store->GetUniverse(*iter);
+    if (universe) {
+      universes.insert(universe);
+    }
+  }
+
+  set<Universe*>::iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    MergeClientData(client, *universe_iter);
+  }
+}
+
+bool OlaServerServiceImpl::ReceiveClientData(Client *client,
+                                             const DmxData &request) {
+  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (request.has_priority()) {
+    priority = ClampPriority(request.priority());
+  }
+
+  // New data from the client replaces any fade it was running.
+  if (m_fade_engine) {
+    m_fade_engine->CancelFade(client, request.universe());
+  }
+
+  if (request.has_delta_length()) {
+    DmxBuffer frame;
+    if (!ola::dmx::DecodeDmxData(client->SourceData(request.universe()).Data(),
+                                 request, &frame)) {
+      OLA_WARN << "Invalid delta encoded data for universe "
+               << request.universe();
+      return false;
+    }
+    client->DMXReceived(request.universe(), frame.GetRaw(), frame.Size(),
+                        *m_wake_up_time, priority);
+    return true;
+  }
+
+  const string &data = request.data();
+  client->DMXReceived(request.universe(),
+                      reinterpret_cast<const uint8_t*>(data.data()),
+                      static_cast<unsigned int>(data.size()), *m_wake_up_time,
+                      priority);
+  return true;
+}
+
+uint8_t OlaServerServiceImpl::ClampPriority(int priority) {
+  uint8_t value = priority;
+  value = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN), value);
+  return std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX), value);
+}
+
 Client* OlaServerServiceImpl::GetClient(ola::rpc::RpcController *controller) {
   return reinterpret_cast<Client*>(controller->Session()->GetData());
 }
@@ -67,6 +67,62 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
 
   ~OlaServerServiceImpl() {}
 
+  /**
+   * @brief Set the FadeEngine used to run client fades.
+   * @param fade_engine the FadeEngine, ownership is not transferred. If this
+   *   isn't set, FadeDmx requests fail.
+   */
+  void SetFadeEngine(class FadeEngine *fade_engine) {
+    m_fade_engine = fade_engine;
+  }
+
+  /**
+   * @brief Set the RDMPoller used to poll responders for clients.
+   * @param rdm_poller the RDMPoller, ownership is not transferred. If this
+   *   isn't set, RegisterForRDMPoll requests fail.
+   */
+  void SetRDMPoller(class RDMPoller *rdm_poller) {
+    m_rdm_poller = rdm_poller;
+  }
+
+  /**
+   * @brief Set the InfoNotifier used to send clients universe and device
+   *   changes.
+   * @param info_notifier the InfoNotifier, ownership is not transferred. If
+   *   this isn't set, RegisterForInfoUpdates requests fail.
+   */
+  void SetInfoNotifier(class InfoNotifier *info_notifier) {
+    m_info_notifier = info_notifier;
+  }
+
+  /**
+   * @brief Set the UdpStreamServer clients can stream DMX data to.
+   * @param udp_stream_server the UdpStreamServer, ownership is not
+   *   transferred. If this isn't set, SetupUdpStream requests fail.
+   */
+  void SetUdpStreamServer(class UdpStreamServer *udp_stream_server) {
+    m_udp_stream_server = udp_stream_server;
+  }
+
+  /**
+   * @brief Set the IngressLimiter used to rate limit clients' DMX data.
+   * @param ingress_limiter the IngressLimiter, ownership is not transferred.
+   *   If this isn't set, every frame is merged as it arrives.
+   */
+  void SetIngressLimiter(class IngressLimiter *ingress_limiter) {
+    m_ingress_limiter = ingress_limiter;
+  }
+
+  /**
+   * @brief Apply a batch of DMX data from a client.
+   *
+   * All the updates are applied before any of the universes are merged, so
+   * each universe is updated at most once per batch. This is used for the
+   * StreamDmxDataBatch RPC and the data streamed over UDP.
+   */
+  void ReceiveClientBatch(class Client *client,
+                          const ola::proto::DmxDataBatch &batch);
+
   /**
    * @brief Returns the current DMX values for a particular universe.
    */
@@ -75,6 +131,22 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
               ola::proto::DmxData* response,
               ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Returns the current DMX values for a set of universes, optionally
+   *   only those which have changed since a generation.
+   */
+  void GetDmxBatch(ola::rpc::RpcController* controller,
+                   const ola::proto::DmxBatchRequest* request,
+                   ola::proto::DmxBatchReply* response,
+                   ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Returns the counters for a set of universes.
+   */
+  void GetUniverseStats(ola::rpc::RpcController* controller,
+                        const ola::proto::UniverseStatsRequest* request,
+                        ola::proto::UniverseStatsReply* response,
+                        ola::rpc::RpcService::CompletionCallback* done);
 
   /**
    * @brief Register a client to receive DMX data.
@@ -99,6 +171,78 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                      ::ola::proto::STREAMING_NO_RESPONSE* response,
                      ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Handle a batch of streaming DMX updates, no response is sent.
+   *
+   * All the updates are applied before any of the universes are merged, so
+   * each universe is updated at most once per batch.
+   */
+  void StreamDmxDataBatch(ola::rpc::RpcController* controller,
+                          const ::ola::proto::DmxDataBatch* request,
+                          ::ola::proto::STREAMING_NO_RESPONSE* response,
+                          ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Create a shared memory region for a local client to send DMX data
+   * through.
+   */
+  void SetupSharedDmx(ola::rpc::RpcController* controller,
+                      const ::ola::proto::SharedDmxRequest* request,
+                      ::ola::proto::SharedDmxReply* response,
+                      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Give a client a token to stream DMX data over UDP with.
+   */
+  void SetupUdpStream(ola::rpc::RpcController* controller,
+                      const ::ola::proto::UdpStreamRequest* request,
+                      ::ola::proto::UdpStreamReply* response,
+                      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Handle the data for a run of consecutive universes, no response is
+   * sent.
+   *
+   * Only the universes whose data has changed are merged.
+   */
+  void StreamDmxRange(ola::rpc::RpcController* controller,
+                      const ::ola::proto::DmxRange* request,
+                      ::ola::proto::STREAMING_NO_RESPONSE* response,
+                      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Handle a notification that a client's shared memory region has
+   * been updated, no response is sent.
+   */
+  void StreamSharedDmx(ola::rpc::RpcController* controller,
+                       const ::ola::proto::SharedDmxNotification* request,
+                       ::ola::proto::STREAMING_NO_RESPONSE* response,
+                       ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Enable or disable delta encoding of the DMX updates sent to the
+   * client.
+   */
+  void SetDeltaEncoding(ola::rpc::RpcController* controller,
+                        const ::ola::proto::DeltaEncodingRequest* request,
+                        ::ola::proto::Ack* response,
+                        ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Enable or disable batching of the DMX updates sent to the client.
+   */
+  void SetDmxBatching(ola::rpc::RpcController* controller,
+                      const ::ola::proto::DmxBatchingRequest* request,
+                      ::ola::proto::Ack* response,
+                      ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Fade the client's data for a universe to new values.
+   */
+  void FadeDmx(ola::rpc::RpcController* controller,
+               const ::ola::proto::FadeRequest* request,
+               ::ola::proto::Ack* response,
+               ola::rpc::RpcService::CompletionCallback* done);
 
   /**
    * @brief Sets the name of a universe.
@@ -124,6 +268,23 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                  ola::proto::Ack* response,
                  ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Patch or unpatch a set of ports, either all of them or none.
+   */
+  void PatchPorts(ola::rpc::RpcController* controller,
+                  const ola::proto::PatchPortsRequest* request,
+                  ola::proto::Ack* response,
+                  ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Set the name and merge mode of a set of universes.
+   */
+  void ConfigureUniverses(
+      ola::rpc::RpcController* controller,
+      const ola::proto::ConfigureUniversesRequest* request,
+      ola::proto::Ack* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
   /**
    * @brief Set the priority of one or more ports.
    */
@@ -243,6 +404,35 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                            ola::proto::RDMResponse* response,
                            ola::rpc::RpcService::CompletionCallback* done);
 
+  /**
+   * @brief Handle a batch of RDM Commands.
+   *
+   * Each response is sent to the client with RDMBatchUpdate as it arrives.
+   */
+  void RDMCommandBatch(ola::rpc::RpcController* controller,
+                       const ::ola::proto::RDMBatchRequest* request,
+                       ola::proto::Ack* response,
+                       ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Register a client to receive the results of polling the
+   * responders in a universe.
+   */
+  void RegisterForRDMPoll(ola::rpc::RpcController* controller,
+                          const ::ola::proto::RDMPollRequest* request,
+                          ola::proto::Ack* response,
+                          ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Register a client to be told when universes, ports or devices
+   * change.
+   */
+  void RegisterForInfoUpdates(
+      ola::rpc::RpcController* controller,
+      const ::ola::proto::RegisterInfoRequest* request,
+      ola::proto::Ack* response,
+      ola::rpc::RpcService::CompletionCallback* done);
+
   /**
    * @brief Set this client's source UID.
    */
@@ -264,6 +454,14 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                          ola::rpc::RpcService::CompletionCallback* done,
                          bool include_raw_packets,
                          ola::rdm::RDMReply *reply);
+  void HandleRDMBatchResponse(class Client *client,
+                              unsigned int batch_id,
+                              unsigned int index,
+                              bool include_raw_packets,
+                              ola::rdm::RDMReply *reply);
+  void RDMReplyToProto(const ola::rdm::RDMReply *reply,
+                       bool include_raw_packets,
+                       ola::proto::RDMResponse* response);
   void RDMDiscoveryComplete(unsigned int universe,
                             ola::rpc::RpcService::CompletionCallback* done,
                             ola::proto::UIDListReply *response,
@@ -288,6 +486,12 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
 
   void SetProtoUID(const ola::rdm::UID &uid, ola::proto::UID *pb_uid);
 
+  bool ReceiveClientData(class Client *client,
+                         const ola::proto::DmxData &request);
+  void MergeClientData(class Client *client, Universe *universe);
+  void MergeClientUniverses(class Client *client,
+                            const std::vector<unsigned int> &universe_ids);
+  static uint8_t ClampPriority(int priority);
   class Client* GetClient(ola::rpc::RpcController *controller);
 
   UniverseStore *m_universe_store;
@@ -296,7 +500,13 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
   class PortManager *m_port_manager;
   class ClientBroker *m_broker;
   const class TimeStamp *m_wake_up_time;
+  class FadeEngine *m_fade_engine;
+  class RDMPoller *m_rdm_poller;
+  class InfoNotifier *m_info_notifier;
+  class UdpStreamServer *m_udp_stream_server;
+  class IngressLimiter *m_ingress_limiter;
   std::auto_ptr<ReloadPluginsCallback> m_reload_plugins_callback;
+  unsigned int m_shared_dmx_count;
 };
 }  // namespace ola
 #endif  // OLAD_OLASERVERSERVICEIMPL_H_
@@ -23,8 +23,11 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <memory>
 #include <string>
 
+#include "common/dmx/DmxDelta.h"
+#include "common/dmx/SharedDmxRegion.h"
 #include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Callback.h"
@@ -56,10 +59,17 @@ using std::string;
 class OlaServerServiceImplTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OlaServerServiceImplTest);
   CPPUNIT_TEST(testGetDmx);
+  CPPUNIT_TEST(testGetDmxBatch);
+  CPPUNIT_TEST(testGetUniverseStats);
   CPPUNIT_TEST(testRegisterForDmx);
   CPPUNIT_TEST(testUpdateDmxData);
+  CPPUNIT_TEST(testStreamDmxDataBatch);
+  CPPUNIT_TEST(testStreamDmxRange);
+  CPPUNIT_TEST(testDeltaDmxData);
+  CPPUNIT_TEST(testSharedDmx);
   CPPUNIT_TEST(testSetUniverseName);
   CPPUNIT_TEST(testSetMergeMode);
+  CPPUNIT_TEST(testConfigureUniverses);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -72,10 +82,17 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
     }
 
     void testGetDmx();
+    void testGetDmxBatch();
+    void testGetUniverseStats();
     void testRegisterForDmx();
     void testUpdateDmxData();
+    void testStreamDmxDataBatch();
+    void testStreamDmxRange();
+    void testDeltaDmxData();
+    void testSharedDmx();
     void testSetUniverseName();
     void testSetMergeMode();
+    void testConfigureUniverses();
 
  private:
     ola::rdm::UID m_uid;
@@ -85,6 +102,7 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
                     int universe_id,
                     class GetDmxCheck *check);
     void CallRegisterForDmx(OlaServerServiceImpl *service,
+                            Client *client,
                             int universe_id,
                             ola::proto::RegisterAction action,
                             class RegisterForDmxCheck *check);
@@ -107,6 +125,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION(OlaServerServiceImplTest);
 
 static const uint8_t SAMPLE_DMX_DATA[] = {1, 2, 3, 4, 5};
 
+static void NoOp() {}
+
 /*
  * The GetDmx Checks
  */
@@ -212,6 +232,19 @@ class GenericAckCheck: public parent {
 };
 
 
+/*
+ * Assert that a delta encoded update was rejected
+ */
+class InvalidDeltaCheck: public UpdateDmxDataCheck {
+ public:
+  void Check(RpcController *controller, OLA_UNUSED ola::proto::Ack *r) {
+    OLA_ASSERT(controller->Failed());
+    OLA_ASSERT_EQ(string("Invalid delta encoded DMX data"),
+                  controller->ErrorText());
+  }
+};
+
+
 /*
  * Check that the GetDmx method works
  */
@@ -272,65 +305,206 @@ void OlaServerServiceImplTest::CallGetDmx(OlaServerServiceImpl *service,
 /*
  * Check the RegisterForDmx method works
  */
+/*
+ * Check GetDmxBatch returns the requested universes, and only those that
+ * changed since the generation.
+ */
+void OlaServerServiceImplTest::testGetDmxBatch() {
+  UniverseStore store(NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+
+  DmxBuffer buffer1(SAMPLE_DMX_DATA, sizeof(SAMPLE_DMX_DATA));
+  DmxBuffer buffer2("different data");
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+  store.GetUniverseOrCreate(10);
+  universe1->SetDMX(buffer1);
+  universe2->SetDMX(buffer2);
+
+  // An empty request returns all universes.
+  ola::proto::DmxBatchRequest request;
+  ola::proto::DmxBatchReply reply;
+  service.GetDmxBatch(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(3, reply.data_size());
+  OLA_ASSERT_EQ(1, reply.data(0).universe());
+  OLA_ASSERT_EQ(buffer1.Get(), reply.data(0).data());
+  OLA_ASSERT_EQ(2, reply.data(1).universe());
+  OLA_ASSERT_EQ(buffer2.Get(), reply.data(1).data());
+  OLA_ASSERT_EQ(10, reply.data(2).universe());
+  OLA_ASSERT_EQ(string(), reply.data(2).data());
+  const uint64_t generation = reply.generation();
+  OLA_ASSERT_EQ(store.Generation(), generation);
+
+  // A list, with a duplicate and a missing universe.
+  request.add_universes(2);
+  request.add_universes(5);
+  request.add_universes(1);
+  request.add_universes(2);
+  reply.Clear();
+  service.GetDmxBatch(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(2, reply.data_size());
+  OLA_ASSERT_EQ(1, reply.data(0).universe());
+  OLA_ASSERT_EQ(2, reply.data(1).universe());
+
+  // A range
+  request.Clear();
+  request.set_first_universe(2);
+  request.set_last_universe(10);
+  reply.Clear();
+  service.GetDmxBatch(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(2, reply.data_size());
+  OLA_ASSERT_EQ(2, reply.data(0).universe());
+  OLA_ASSERT_EQ(10, reply.data(1).universe());
+
+  // Nothing has changed since the last generation.
+  request.Clear();
+  request.set_since_generation(generation);
+  reply.Clear();
+  service.GetDmxBatch(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(0, reply.data_size());
+  OLA_ASSERT_EQ(generation, reply.generation());
+
+  // Only the changed universe is returned.
+  universe2->SetDMX(buffer1);
+  reply.Clear();
+  service.GetDmxBatch(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(1, reply.data_size());
+  OLA_ASSERT_EQ(2, reply.data(0).universe());
+  OLA_ASSERT_EQ(buffer1.Get(), reply.data(0).data());
+  OLA_ASSERT_TRUE(reply.generation() > generation);
+}
+
+/*
+ * Check GetUniverseStats returns the counters for the requested universes.
+ */
+void OlaServerServiceImplTest::testGetUniverseStats() {
+  UniverseStore store(NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  store.GetUniverseOrCreate(2);
+  ola::Client client(NULL, m_uid);
+  DmxBuffer buffer(SAMPLE_DMX_DATA, sizeof(SAMPLE_DMX_DATA));
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  client.DMXReceived(1, ola::DmxSource(buffer, now, 120));
+  universe1->SourceClientDataChanged(&client);
+  universe1->SourceClientDataChanged(&client);
+
+  ola::proto::UniverseStatsRequest request;
+  ola::proto::UniverseStatsReply reply;
+  service.GetUniverseStats(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(2, reply.stats_size());
+  const ola::proto::UniverseStats &stats = reply.stats(0);
+  OLA_ASSERT_EQ(1, stats.universe());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.input_frames());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), stats.output_frames());
+  OLA_ASSERT_EQ(1, stats.active_sources());
+  OLA_ASSERT_EQ(120, stats.active_priority());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats.priority_changes());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), stats.interval_count());
+  OLA_ASSERT_EQ(2, reply.stats(1).universe());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), reply.stats(1).input_frames());
+
+  // A range
+  request.set_first_universe(2);
+  reply.Clear();
+  service.GetUniverseStats(NULL, &request, &reply, NewSingleCallback(&NoOp));
+  OLA_ASSERT_EQ(1, reply.stats_size());
+  OLA_ASSERT_EQ(2, reply.stats(0).universe());
+  universe1->RemoveSourceClient(&client);
+}
+
 void OlaServerServiceImplTest::testRegisterForDmx() {
   UniverseStore store(NULL, NULL);
   OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+  ola::Client client(NULL, m_uid);
 
   // Register for a universe that doesn't exist
   unsigned int universe_id = 0;
   unsigned int second_universe_id = 99;
   GenericAckCheck<RegisterForDmxCheck> ack_check;
-  CallRegisterForDmx(&service, universe_id, ola::proto::REGISTER, &ack_check);
+  CallRegisterForDmx(&service, &client, universe_id, ola::proto::REGISTER,
+                     &ack_check);
 
   // The universe should exist now and the client should be bound
   Universe *universe = store.GetUniverse(universe_id);
   OLA_ASSERT_NOT_NULL(universe);
-  OLA_ASSERT(universe->ContainsSinkClient(NULL));
+  OLA_ASSERT(universe->ContainsSinkClient(&client));
   OLA_ASSERT_EQ((unsigned int) 1, universe->SinkClientCount());
 
   // Try to register again
-  CallRegisterForDmx(&service, universe_id, ola::proto::REGISTER, &ack_check);
-  OLA_ASSERT(universe->ContainsSinkClient(NULL));
+  CallRegisterForDmx(&service, &client, universe_id, ola::proto::REGISTER,
+                     &ack_check);
+  OLA_ASSERT(universe->ContainsSinkClient(&client));
   OLA_ASSERT_EQ((unsigned int) 1, universe->SinkClientCount());
 
   // Register a second universe
-  CallRegisterForDmx(&service, second_universe_id, ola::proto::REGISTER,
-                     &ack_check);
+  CallRegisterForDmx(&service, &client, second_universe_id,
+                     ola::proto::REGISTER, &ack_check);
   Universe *second_universe = store.GetUniverse(universe_id);
-  OLA_ASSERT(second_universe->ContainsSinkClient(NULL));
+  OLA_ASSERT(second_universe->ContainsSinkClient(&client));
   OLA_ASSERT_EQ((unsigned int) 1, second_universe->SinkClientCount());
 
   // Unregister the first universe
-  CallRegisterForDmx(&service, universe_id, ola::proto::UNREGISTER, &ack_check);
-  OLA_ASSERT_FALSE(universe->ContainsSinkClient(NULL));
+  CallRegisterForDmx(&service, &client, universe_id, ola::proto::UNREGISTER,
+                     &ack_check);
+  OLA_ASSERT_FALSE(universe->ContainsSinkClient(&client));
   OLA_ASSERT_EQ((unsigned int) 0, universe->SinkClientCount());
 
   // Unregister the second universe
-  CallRegisterForDmx(&service, second_universe_id, ola::proto::UNREGISTER,
-                     &ack_check);
-  OLA_ASSERT_FALSE(second_universe->ContainsSinkClient(NULL));
+  CallRegisterForDmx(&service, &client, second_universe_id,
+                     ola::proto::UNREGISTER, &ack_check);
+  OLA_ASSERT_FALSE(second_universe->ContainsSinkClient(&client));
   OLA_ASSERT_EQ((unsigned int) 0, second_universe->SinkClientCount());
 
   // Unregister again
-  CallRegisterForDmx(&service, universe_id, ola::proto::UNREGISTER, &ack_check);
-  OLA_ASSERT_FALSE(universe->ContainsSinkClient(NULL));
+  CallRegisterForDmx(&service, &client, universe_id, ola::proto::UNREGISTER,
+                     &ack_check);
+  OLA_ASSERT_FALSE(universe->ContainsSinkClient(&client));
   OLA_ASSERT_EQ((unsigned int) 0, universe->SinkClientCount());
+
+  // Register with a slot range
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  ola::proto::RegisterDmxRequest request;
+  ola::proto::Ack response;
+  request.set_universe(universe_id);
+  request.set_action(ola::proto::REGISTER);
+  request.set_start_slot(5);
+  request.set_slot_count(2);
+  service.RegisterForDmx(
+      &controller, &request, &response,
+      NewSingleCallback(
+          static_cast<RegisterForDmxCheck*>(&ack_check),
+          &RegisterForDmxCheck::Check, &controller, &response));
+  OLA_ASSERT(universe->ContainsSinkClient(&client));
+
+  DmxBuffer buffer("0123456789");
+  ola::TimeStamp now;
+  const DmxBuffer *frame = client.FilterDMX(universe_id, 100, buffer, now);
+  OLA_ASSERT_NOT_NULL(frame);
+  OLA_ASSERT_EQ(string("56"), frame->Get());
 }
 
 
 /*
  * Call the RegisterForDmx method
  * @param impl the OlaServerServiceImpl to use
+ * @param client the client to register
  * @param universe_id the universe_id in the request
  * @param action the action to use REGISTER or UNREGISTER
  * @param check the RegisterForDmxCheck to use for the callback check
  */
 void OlaServerServiceImplTest::CallRegisterForDmx(
     OlaServerServiceImpl *service,
+    Client *client,
     int universe_id,
     ola::proto::RegisterAction action,
     RegisterForDmxCheck *check) {
   RpcSession session(NULL);
+  session.SetData(client);
   RpcController controller(&session);
   ola::proto::RegisterDmxRequest request;
   ola::proto::Ack response;
@@ -422,6 +596,243 @@ void OlaServerServiceImplTest::CallUpdateDmxData(
   service->UpdateDmxData(&controller, &request, &response, closure);
 }
 
+/*
+ * Check the StreamDmxDataBatch method works
+ */
+void OlaServerServiceImplTest::testStreamDmxDataBatch() {
+  ola::ExportMap export_map;
+  UniverseStore store(NULL, &export_map);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+
+  DmxBuffer dmx_data("this is a test");
+  DmxBuffer dmx_data2("different data hmm");
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+
+  // Universe 3 doesn't exist and universe 1 is updated twice.
+  ola::proto::DmxDataBatch request;
+  const int universes[] = {1, 2, 3, 1};
+  const DmxBuffer *data[] = {&dmx_data, &dmx_data, &dmx_data, &dmx_data2};
+  for (unsigned int i = 0; i < sizeof(universes) / sizeof(universes[0]);
+       i++) {
+    ola::proto::DmxData *update = request.add_data();
+    update->set_universe(universes[i]);
+    update->set_data(data[i]->Get());
+  }
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  m_clock.CurrentTime(&time1);
+  service.StreamDmxDataBatch(&controller, &request, NULL, NULL);
+
+  OLA_ASSERT_EQ(dmx_data2, universe1->GetDMX());
+  OLA_ASSERT_EQ(dmx_data, universe2->GetDMX());
+  OLA_ASSERT_FALSE(store.GetUniverse(3));
+
+  // each universe should only have been updated once
+  ola::UIntMap *frames = export_map.GetUIntMapVar(Universe::K_FPS_VAR);
+  OLA_ASSERT_EQ(1u, (*frames)["1"]);
+  OLA_ASSERT_EQ(1u, (*frames)["2"]);
+}
+
+/*
+ * Check StreamDmxRange only updates the universes which change.
+ */
+void OlaServerServiceImplTest::testStreamDmxRange() {
+  ola::ExportMap export_map;
+  UniverseStore store(NULL, &export_map);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+  Universe *universe3 = store.GetUniverseOrCreate(3);
+
+  // Three universes of 4 slots, the last one is short.
+  ola::proto::DmxRange request;
+  request.set_first_universe(1);
+  request.set_slots_per_universe(4);
+  request.set_data(string("\001\002\003\004\005\006\007\010\011\012", 10));
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  m_clock.CurrentTime(&time1);
+  service.StreamDmxRange(&controller, &request, NULL, NULL);
+
+  DmxBuffer expected;
+  expected.SetFromString("1,2,3,4");
+  OLA_ASSERT_EQ(expected, universe1->GetDMX());
+  expected.SetFromString("5,6,7,8");
+  OLA_ASSERT_EQ(expected, universe2->GetDMX());
+  expected.SetFromString("9,10");
+  OLA_ASSERT_EQ(expected, universe3->GetDMX());
+
+  ola::UIntMap *frames = export_map.GetUIntMapVar(Universe::K_FPS_VAR);
+  OLA_ASSERT_EQ(1u, (*frames)["1"]);
+  OLA_ASSERT_EQ(1u, (*frames)["2"]);
+  OLA_ASSERT_EQ(1u, (*frames)["3"]);
+
+  // Only universe 2 changes.
+  request.set_data(string("\001\002\003\004\005\006\077\010\011\012", 10));
+  service.StreamDmxRange(&controller, &request, NULL, NULL);
+  expected.SetFromString("5,6,63,8");
+  OLA_ASSERT_EQ(expected, universe2->GetDMX());
+  OLA_ASSERT_EQ(1u, (*frames)["1"]);
+  OLA_ASSERT_EQ(2u, (*frames)["2"]);
+  OLA_ASSERT_EQ(1u, (*frames)["3"]);
+
+  // Every universe is refreshed once a second so the sources don't time out.
+  time1 += ola::TimeInterval(1, 0);
+  service.StreamDmxRange(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(2u, (*frames)["1"]);
+  OLA_ASSERT_EQ(3u, (*frames)["2"]);
+  OLA_ASSERT_EQ(2u, (*frames)["3"]);
+
+  // Invalid ranges are ignored.
+  request.set_slots_per_universe(0);
+  service.StreamDmxRange(&controller, &request, NULL, NULL);
+  request.set_slots_per_universe(ola::DMX_UNIVERSE_SIZE + 1);
+  service.StreamDmxRange(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(2u, (*frames)["1"]);
+}
+
+/*
+ * Check that delta encoded updates are applied to the client's last frame.
+ */
+void OlaServerServiceImplTest::testDeltaDmxData() {
+  ola::ExportMap export_map;
+  UniverseStore store(NULL, &export_map);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  m_clock.CurrentTime(&time1);
+
+  DmxBuffer frame1;
+  frame1.SetRangeToValue(0, 10, ola::DMX_UNIVERSE_SIZE);
+  DmxBuffer frame2(frame1);
+  frame2.SetChannel(5, 200);
+  DmxBuffer empty;
+
+  // The first frame arrives before the universe exists, it's still used as
+  // the base for the next delta.
+  ola::proto::DmxData request;
+  request.set_universe(1);
+  OLA_ASSERT_FALSE(ola::dmx::EncodeDmxData(empty, frame1, &request));
+  RpcController controller(&session);
+  service.StreamDmxData(&controller, &request, NULL, NULL);
+  OLA_ASSERT_FALSE(store.GetUniverse(1));
+
+  Universe *universe = store.GetUniverseOrCreate(1);
+  OLA_ASSERT_TRUE(ola::dmx::EncodeDmxData(frame1, frame2, &request));
+  service.StreamDmxData(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(frame2, universe->GetDMX());
+  OLA_ASSERT_EQ(frame2, client.SourceData(1).Data());
+
+  // An invalid delta is rejected and the frame is unchanged.
+  request.mutable_changed_slots(0)->set_offset(ola::DMX_UNIVERSE_SIZE);
+  service.StreamDmxData(&controller, &request, NULL, NULL);
+  OLA_ASSERT_EQ(frame2, universe->GetDMX());
+  OLA_ASSERT_EQ(frame2, client.SourceData(1).Data());
+
+  InvalidDeltaCheck invalid_check;
+  RpcController controller2(&session);
+  ola::proto::Ack ack;
+  service.UpdateDmxData(
+      &controller2, &request, &ack,
+      NewSingleCallback(
+          static_cast<UpdateDmxDataCheck*>(&invalid_check),
+          &UpdateDmxDataCheck::Check,
+          &controller2, &ack));
+  OLA_ASSERT_TRUE(controller2.Failed());
+}
+
+/*
+ * Check that clients can send data through shared memory.
+ */
+void OlaServerServiceImplTest::testSharedDmx() {
+  if (!ola::dmx::SharedDmxRegion::IsSupported()) {
+    return;
+  }
+
+  UniverseStore store(NULL, NULL);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+  Universe *universe = store.GetUniverseOrCreate(1);
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  ola::proto::SharedDmxRequest request;
+  ola::proto::SharedDmxReply reply;
+
+  // an invalid slot count
+  RpcController controller(&session);
+  request.set_slots(0);
+  service.SetupSharedDmx(&controller, &request, &reply,
+                         NewSingleCallback(&NoOp));
+  OLA_ASSERT_TRUE(controller.Failed());
+  OLA_ASSERT_FALSE(client.HasSharedDmx());
+
+  RpcController controller2(&session);
+  request.set_slots(4);
+  service.SetupSharedDmx(&controller2, &request, &reply,
+                         NewSingleCallback(&NoOp));
+  OLA_ASSERT_FALSE(controller2.Failed());
+  OLA_ASSERT_TRUE(client.HasSharedDmx());
+  OLA_ASSERT_EQ(4, reply.slots());
+
+  std::auto_ptr<ola::dmx::SharedDmxRegion> region(
+      ola::dmx::SharedDmxRegion::Open(reply.name()));
+  OLA_ASSERT_NOT_NULL(region.get());
+
+  // universe 2 doesn't exist.
+  DmxBuffer dmx_data("this is a test");
+  DmxBuffer dmx_data2("different data hmm");
+  OLA_ASSERT_TRUE(region->Write(0, 1, 100, dmx_data));
+  OLA_ASSERT_TRUE(region->Write(1, 2, 100, dmx_data2));
+
+  // without a range, all slots are checked
+  RpcController controller3(&session);
+  ola::proto::SharedDmxNotification notification;
+  m_clock.CurrentTime(&time1);
+  service.StreamSharedDmx(&controller3, &notification, NULL, NULL);
+  OLA_ASSERT_EQ(dmx_data, universe->GetDMX());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), universe->ActivePriority());
+  OLA_ASSERT_FALSE(store.GetUniverse(2));
+
+  // slot 0 is outside the range, so it isn't read
+  OLA_ASSERT_TRUE(region->Write(0, 1, 100, dmx_data2));
+  notification.set_first_slot(1);
+  notification.set_slot_count(3);
+  m_clock.CurrentTime(&time1);
+  service.StreamSharedDmx(&controller3, &notification, NULL, NULL);
+  OLA_ASSERT_EQ(dmx_data, universe->GetDMX());
+
+  // a range past the end of the region is ignored
+  notification.set_first_slot(4);
+  notification.set_slot_count(1);
+  service.StreamSharedDmx(&controller3, &notification, NULL, NULL);
+  OLA_ASSERT_EQ(dmx_data, universe->GetDMX());
+
+  notification.set_first_slot(0);
+  notification.set_slot_count(1);
+  m_clock.CurrentTime(&time1);
+  service.StreamSharedDmx(&controller3, &notification, NULL, NULL);
+  OLA_ASSERT_EQ(dmx_data2, universe->GetDMX());
+}
+
 /*
  * Check the SetUniverseName method works
  */
@@ -509,6 +920,56 @@ void OlaServerServiceImplTest::testSetMergeMode() {
   OLA_ASSERT_EQ(Universe::MERGE_LTP, universe->MergeMode());
 }
 
+/*
+ * Check ConfigureUniverses changes either all of the universes or none.
+ */
+void OlaServerServiceImplTest::testConfigureUniverses() {
+  UniverseStore store(NULL, NULL);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL, NULL, NULL);
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+  const string name1 = universe1->Name();
+
+  ola::proto::ConfigureUniversesRequest request;
+  ola::proto::UniverseConfig *config = request.add_universes();
+  config->set_universe(1);
+  config->set_name("foo");
+  config = request.add_universes();
+  config->set_universe(3);
+  config->set_merge_mode(ola::proto::HTP);
+
+  GenericMissingUniverseCheck<SetMergeModeCheck, ola::proto::Ack>
+    missing_universe_check;
+  {
+    RpcSession session(NULL);
+    RpcController controller(&session);
+    ola::proto::Ack response;
+    service.ConfigureUniverses(
+        &controller, &request, &response,
+        NewSingleCallback(
+            static_cast<SetMergeModeCheck*>(&missing_universe_check),
+            &SetMergeModeCheck::Check, &controller, &response));
+  }
+  OLA_ASSERT_EQ(name1, universe1->Name());
+  OLA_ASSERT_EQ(Universe::MERGE_LTP, universe2->MergeMode());
+
+  config->set_universe(2);
+  GenericAckCheck<SetMergeModeCheck> ack_check;
+  {
+    RpcSession session(NULL);
+    RpcController controller(&session);
+    ola::proto::Ack response;
+    service.ConfigureUniverses(
+        &controller, &request, &response,
+        NewSingleCallback(static_cast<SetMergeModeCheck*>(&ack_check),
+                          &SetMergeModeCheck::Check, &controller,
+                          &response));
+  }
+  OLA_ASSERT_EQ(string("foo"), universe1->Name());
+  OLA_ASSERT_EQ(Universe::MERGE_LTP, universe1->MergeMode());
+  OLA_ASSERT_EQ(Universe::MERGE_HTP, universe2->MergeMode());
+}
+
 /*
  * Call the SetMergeMode method
  * @param impl the OlaServerServiceImpl to use
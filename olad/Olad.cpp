@@ -38,7 +38,9 @@
 #include "ola/base/Init.h"
 #include "ola/base/SysExits.h"
 #include "ola/base/Version.h"
+#include "ola/io/SharedMemoryBlockPool.h"
 #include "ola/thread/SignalThread.h"
+#include "ola/thread/Utils.h"
 #include "olad/OlaDaemon.h"
 
 using ola::OlaDaemon;
@@ -57,6 +59,46 @@ DEFINE_s_string(interface, i, "",
                 "to use.");
 DEFINE_string(pid_location, "",
               "The directory containing the PID definitions.");
+DEFINE_uint16(max_universe_frame_rate, 0,
+              "The maximum rate at which universes send updates, in frames "
+              "per second. 0 means no limit.");
+DEFINE_uint16(worker_loops, 0,
+              "The number of extra event loops to run plugins on. 0 means "
+              "everything runs on the main loop.");
+DEFINE_string(worker_loop_cpus, "",
+              "The CPUs to pin the extra event loops to, e.g. 2-3. Each loop "
+              "runs on one of the CPUs.");
+DEFINE_default_bool(worker_loop_numa, false,
+                    "Spread the extra event loops across the NUMA nodes, and "
+                    "run plugins on the node their network interface is "
+                    "attached to.");
+DEFINE_default_bool(timer_wheel, true,
+                    "Disable the timer wheel, use a priority queue for "
+                    "timeouts.");
+DEFINE_string(dmx_snapshot_file, "",
+              "A file to record the last frame of each universe in, outputs "
+              "are restored from it when olad restarts.");
+DEFINE_string(capture_file, "",
+              "A pcapng file to record the DMX data received by input ports "
+              "in.");
+DEFINE_string(startup_trace, "",
+              "Write a Chrome trace of the time each startup phase takes to "
+              "this file.");
+DEFINE_uint16(http_threads, 0,
+              "The number of threads to handle HTTP connections on. 0 "
+              "handles them all on the HTTP server thread.");
+DEFINE_uint16(http_connection_limit, 0,
+              "The maximum number of open HTTP connections. 0 uses the "
+              "libmicrohttpd default.");
+DEFINE_uint16(http_connection_timeout, 30,
+              "Close idle HTTP keep-alive connections after this many "
+              "seconds. 0 means never.");
+DEFINE_uint16(packet_pool_cache,
+              ola::io::SharedMemoryBlockPool::DEFAULT_THREAD_CACHE_SIZE,
+              "The number of free packet buffers each thread holds on to.");
+DEFINE_uint16(packet_pool_size,
+              ola::io::SharedMemoryBlockPool::DEFAULT_DEPOT_SIZE,
+              "The number of free packet buffers shared between threads.");
 DEFINE_s_uint16(http_port, p, ola::OlaServer::DEFAULT_HTTP_PORT,
                 "The port to run the http server on. Defaults to 9090.");
 
@@ -130,8 +172,29 @@ int main(int argc, char *argv[]) {
   options.http_enable_quit = FLAGS_http_quit;
   options.http_port = FLAGS_http_port;
   options.http_data_dir = FLAGS_http_data_dir.str();
+  options.http_threads = FLAGS_http_threads;
+  options.http_connection_limit = FLAGS_http_connection_limit;
+  options.http_connection_timeout = FLAGS_http_connection_timeout;
   options.network_interface = FLAGS_interface.str();
   options.pid_data_dir = FLAGS_pid_location.str();
+  options.max_universe_frame_rate = FLAGS_max_universe_frame_rate;
+  options.worker_loops = FLAGS_worker_loops;
+  options.worker_loop_numa = FLAGS_worker_loop_numa;
+  options.use_timer_wheel = FLAGS_timer_wheel;
+  if (!ola::thread::ParseCPUList(FLAGS_worker_loop_cpus.str(),
+                                 &options.worker_loop_cpus)) {
+    OLA_FATAL << "Invalid --worker-loop-cpus: " << FLAGS_worker_loop_cpus.str();
+    return ola::EXIT_USAGE;
+  }
+  options.dmx_snapshot_file = FLAGS_dmx_snapshot_file.str();
+  options.capture_file = FLAGS_capture_file.str();
+  options.startup_trace_file = FLAGS_startup_trace.str();
+
+  // This must be done before anything uses the pool.
+  ola::io::SharedMemoryBlockPool::Options pool_options;
+  pool_options.thread_cache_size = FLAGS_packet_pool_cache;
+  pool_options.depot_size = FLAGS_packet_pool_size;
+  ola::io::SharedMemoryBlockPool::ConfigurePacketPool(pool_options);
 
   std::auto_ptr<OlaDaemon> olad(new OlaDaemon(options, &export_map));
   if (!olad.get()) {
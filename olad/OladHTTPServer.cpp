@@ -29,14 +29,18 @@
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/base/Version.h"
+#include "ola/dmx/BinaryFrame.h"
 #include "ola/dmx/SourcePriorities.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/web/Json.h"
+#include "ola/web/JsonStreamWriter.h"
 #include "olad/DmxSource.h"
 #include "olad/HttpServerActions.h"
 #include "olad/OladHTTPServer.h"
 #include "olad/OlaServer.h"
+#include "olad/OverloadController.h"
 #include "olad/Preferences.h"
+#include "olad/plugin_api/InputFrameStats.h"
 
 namespace ola {
 
@@ -50,8 +54,10 @@ using ola::http::HTTPRequest;
 using ola::http::HTTPResponse;
 using ola::http::HTTPServer;
 using ola::io::ConnectedDescriptor;
+using ola::io::IOQueue;
 using ola::web::JsonArray;
 using ola::web::JsonObject;
+using ola::web::JsonStreamWriter;
 using std::cout;
 using std::endl;
 using std::ostringstream;
@@ -85,10 +91,14 @@ OladHTTPServer::OladHTTPServer(ExportMap *export_map,
       m_ola_server(ola_server),
       m_enable_quit(options.enable_quit),
       m_interface(iface),
-      m_rdm_module(&m_server, &m_client) {
+      m_overload_level(export_map->GetIntegerVar(
+          OverloadController::K_OVERLOAD_LEVEL_VAR)),
+      m_rdm_module(&m_server, &m_client),
+      m_websocket_module(&m_server, &m_client) {
   // The main handlers
   RegisterHandler("/quit", &OladHTTPServer::DisplayQuit);
   RegisterHandler("/reload", &OladHTTPServer::ReloadPlugins);
+  RegisterHandler("/reload_plugin", &OladHTTPServer::ReloadPlugin);
   RegisterHandler("/reload_pids", &OladHTTPServer::ReloadPidStore);
   RegisterHandler("/new_universe", &OladHTTPServer::CreateNewUniverse);
   RegisterHandler("/modify_universe", &OladHTTPServer::ModifyUniverse);
@@ -453,6 +463,12 @@ int OladHTTPServer::JsonServerStats(const HTTPRequest*,
   json.Add("version", ola::base::Version::GetVersion());
   json.Add("up_since", start_time_str);
   json.Add("quit_enabled", m_enable_quit);
+  // The variable is read rather than the OverloadController, since this runs
+  // in the HTTP server's thread.
+  const int level = m_overload_level->Get();
+  json.Add("overload_level", level);
+  json.Add("load_state", OverloadController::LevelName(
+      static_cast<OverloadController::Level>(level)));
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
@@ -718,9 +734,30 @@ int OladHTTPServer::SetPluginState(const HTTPRequest *request,
 int OladHTTPServer::GetDmx(const HTTPRequest *request,
                            HTTPResponse *response) {
   if (request->CheckParameterExists(HELP_PARAMETER)) {
-    return ServeUsage(response, "?u=[universe]");
+    return ServeUsage(response,
+        "?u=[universe], or ?u=[universe,...]&binary for binary frames");
   }
   string uni_id = request->GetParameter("u");
+
+  if (request->CheckParameterExists("binary")) {
+    vector<string> universes;
+    StringSplit(uni_id, &universes, ",");
+    ola::client::FetchDMXBatchArgs args(
+        NewSingleCallback(this, &OladHTTPServer::HandleGetDmxBinary,
+                          response));
+    for (vector<string>::const_iterator iter = universes.begin();
+         iter != universes.end(); ++iter) {
+      unsigned int universe_id;
+      if (!StringToInt(*iter, &universe_id)) {
+        delete args.callback;
+        return ServeHelpRedirect(response);
+      }
+      args.universes.push_back(universe_id);
+    }
+    m_client.FetchDMXBatch(args);
+    return MHD_YES;
+  }
+
   unsigned int universe_id;
   if (!StringToInt(uni_id, &universe_id)) {
     return ServeHelpRedirect(response);
@@ -743,7 +780,11 @@ int OladHTTPServer::HandleSetDmx(const HTTPRequest *request,
                                  HTTPResponse *response) {
   if (request->CheckParameterExists(HELP_PARAMETER)) {
     return ServeUsage(response,
-        "POST u=[universe], d=[DMX data (a comma separated list of values)]");
+        "POST u=[universe], d=[DMX data (a comma separated list of values)], "
+        "or POST binary frames as application/octet-stream");
+  }
+  if (request->HasRawBody()) {
+    return SetDmxBinary(request, response);
   }
   string dmx_data_str = request->GetPostParameter("d");
   string uni_id = request->GetPostParameter("u");
@@ -765,6 +806,38 @@ int OladHTTPServer::HandleSetDmx(const HTTPRequest *request,
 }
 
 
+/**
+ * @brief Handle a set DMX command with a body of binary frames.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ *
+ * Only the last frame is sent with a callback. The updates are sent in order
+ * on the same connection, so once it completes the others have been applied.
+ */
+int OladHTTPServer::SetDmxBinary(const HTTPRequest *request,
+                                 HTTPResponse *response) {
+  const string &body = request->Body();
+  vector<ola::dmx::BinaryFrame> frames;
+  if (!ola::dmx::BinaryFrame::Parse(
+          reinterpret_cast<const uint8_t*>(body.data()), body.size(),
+          &frames) ||
+      frames.empty()) {
+    return m_server.ServeError(response, "Invalid binary DMX frames");
+  }
+
+  vector<ola::dmx::BinaryFrame>::const_iterator iter = frames.begin();
+  for (; iter + 1 != frames.end(); ++iter) {
+    m_client.SendDMX(iter->universe, iter->data,
+                     ola::client::SendDMXArgs());
+  }
+  ola::client::SendDMXArgs args(
+      NewSingleCallback(this, &OladHTTPServer::HandleBoolResponse, response));
+  m_client.SendDMX(iter->universe, iter->data, args);
+  return MHD_YES;
+}
+
+
 /**
  * @brief Cause the server to shutdown
  * @param request the HTTPRequest
@@ -803,6 +876,32 @@ int OladHTTPServer::ReloadPlugins(const HTTPRequest*,
 }
 
 
+/**
+ * @brief Reload a single plugin
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int OladHTTPServer::ReloadPlugin(const HTTPRequest *request,
+                                 HTTPResponse *response) {
+  if (request->CheckParameterExists(HELP_PARAMETER)) {
+    return ServeUsage(response, "POST plugin_id=[a plugin id]");
+  }
+
+  string plugin_id_string = request->GetPostParameter("plugin_id");
+  unsigned int plugin_id;
+  if (!StringToInt(plugin_id_string, &plugin_id)) {
+    OLA_INFO << "Invalid plugin id " << plugin_id_string;
+    return ServeHelpRedirect(response);
+  }
+
+  m_client.ReloadPlugin(
+      (ola_plugin_id) plugin_id,
+      NewSingleCallback(this, &OladHTTPServer::HandleBoolResponse, response));
+  return MHD_YES;
+}
+
+
 /**
  * @brief Reload the PID Store.
  * @param request the HTTPRequest
@@ -835,7 +934,20 @@ void OladHTTPServer::HandlePluginList(HTTPResponse *response,
     return;
   }
 
-  JsonObject *json = new JsonObject();
+  IOQueue *output = new IOQueue();
+  JsonStreamWriter *writer = new JsonStreamWriter(output);
+  writer->StartObject();
+  writer->StartArray("plugins");
+  vector<OlaPlugin>::const_iterator iter;
+  for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
+    writer->StartObject();
+    writer->Add("active", iter->IsActive());
+    writer->Add("enabled", iter->IsEnabled());
+    writer->Add("id", iter->Id());
+    writer->Add("name", iter->Name());
+    writer->EndObject();
+  }
+  writer->EndArray();
 
   // fire off the universe request now. the main server is running in a
   // separate thread.
@@ -843,50 +955,47 @@ void OladHTTPServer::HandlePluginList(HTTPResponse *response,
       NewSingleCallback(this,
                         &OladHTTPServer::HandleUniverseList,
                         response,
-                        json));
-
-  JsonArray *plugins_json = json->AddArray("plugins");
-  vector<OlaPlugin>::const_iterator iter;
-  for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
-    JsonObject *plugin = plugins_json->AppendObject();
-    plugin->Add("name", iter->Name());
-    plugin->Add("id", iter->Id());
-    plugin->Add("active", iter->IsActive());
-    plugin->Add("enabled", iter->IsEnabled());
-  }
+                        output,
+                        writer));
 }
 
 
 /**
  * @brief Handle the universe list callback
  * @param response the HTTPResponse that is associated with the request.
- * @param json the JsonObject to add the data to
+ * @param output the IOQueue the JSON is being written to
+ * @param writer the JsonStreamWriter with the open object
  * @param result the result of the API call
  * @param universes the vector of OlaUniverse
  */
 void OladHTTPServer::HandleUniverseList(HTTPResponse *response,
-                                        JsonObject *json,
+                                        IOQueue *output,
+                                        JsonStreamWriter *writer,
                                         const client::Result &result,
                                         const vector<OlaUniverse> &universes) {
   if (result.Success()) {
-    JsonArray *universe_json = json->AddArray("universes");
+    writer->StartArray("universes");
 
     vector<OlaUniverse>::const_iterator iter;
     for (iter = universes.begin(); iter != universes.end(); ++iter) {
-      JsonObject *universe = universe_json->AppendObject();
-      universe->Add("id", iter->Id());
-      universe->Add("input_ports", iter->InputPortCount());
-      universe->Add("name", iter->Name());
-      universe->Add("output_ports", iter->OutputPortCount());
-      universe->Add("rdm_devices", iter->RDMDeviceCount());
+      writer->StartObject();
+      writer->Add("id", iter->Id());
+      writer->Add("input_ports", iter->InputPortCount());
+      writer->Add("name", iter->Name());
+      writer->Add("output_ports", iter->OutputPortCount());
+      writer->Add("rdm_devices", iter->RDMDeviceCount());
+      writer->EndObject();
     }
+    writer->EndArray();
   }
+  writer->EndObject();
+  delete writer;
 
   response->SetNoCache();
+  response->EnableContentETag();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->SendJson(*json);
+  response->Send(output);
   delete response;
-  delete json;
 }
 
 
@@ -948,6 +1057,7 @@ void OladHTTPServer::HandlePluginInfo(HTTPResponse *response,
   }
 
   response->SetNoCache();
+  response->EnableContentETag();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
   response->SendJson(json);
   delete response;
@@ -1024,6 +1134,7 @@ void OladHTTPServer::HandlePortsForUniverse(
   }
 
   response->SetNoCache();
+  response->EnableContentETag();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
   response->SendJson(*json);
   delete json;
@@ -1068,6 +1179,7 @@ void OladHTTPServer::HandleCandidatePorts(
   }
 
   response->SetNoCache();
+  response->EnableContentETag();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
   response->SendJson(json);
   delete response;
@@ -1195,6 +1307,34 @@ void OladHTTPServer::HandleGetDmx(HTTPResponse *response,
 }
 
 
+/**
+ * @brief Callback for m_client.FetchDMXBatch called by GetDmx
+ * @param response the HTTPResponse
+ * @param result the result of the API call
+ * @param frames the DMX frames
+ */
+void OladHTTPServer::HandleGetDmxBinary(HTTPResponse *response,
+                                        const client::Result &result,
+                                        const vector<client::DMXFrame> &frames,
+                                        uint64_t) {
+  if (!result.Success()) {
+    m_server.ServeError(response, result.Error());
+    return;
+  }
+
+  string output;
+  vector<client::DMXFrame>::const_iterator iter = frames.begin();
+  for (; iter != frames.end(); ++iter) {
+    ola::dmx::BinaryFrame::Write(iter->metadata.universe, iter->data, &output);
+  }
+  response->SetNoCache();
+  response->SetContentType(HTTPServer::CONTENT_TYPE_OCT);
+  response->Append(output);
+  response->Send();
+  delete response;
+}
+
+
 /**
  * @brief Handle the set DMX response.
  * @param response the HTTPResponse that is associated with the request.
@@ -1245,6 +1385,18 @@ void OladHTTPServer::PortToJson(JsonObject *json,
     priority_json->Add("priority_capability",
       (port.PriorityCapability() == CAPABILITY_STATIC ? "static" : "full"));
   }
+
+  InputFrameStats::Summary summary;
+  if (!is_output &&
+      InputFrameStats::ReadSummary(
+          m_export_map, device.Id() + "-I-" + IntToString(port.Id()),
+          &summary)) {
+    JsonObject *stats_json = json->AddObject("frame_stats");
+    stats_json->Add("frames", summary.frames);
+    stats_json->Add("fps", summary.fps);
+    stats_json->Add("jitter_us", summary.jitter_us);
+    stats_json->Add("gaps", summary.gaps);
+  }
 }
 
 
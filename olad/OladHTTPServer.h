@@ -29,8 +29,11 @@
 #include "ola/base/Macro.h"
 #include "ola/http/HTTPServer.h"
 #include "ola/http/OlaHTTPServer.h"
+#include "ola/io/IOQueue.h"
 #include "ola/network/Interface.h"
 #include "ola/rdm/PidStore.h"
+#include "ola/web/JsonStreamWriter.h"
+#include "olad/DmxWebSocketModule.h"
 #include "olad/RDMHTTPModule.h"
 
 namespace ola {
@@ -83,8 +86,12 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
              ola::http::HTTPResponse *response);
   int HandleSetDmx(const ola::http::HTTPRequest *request,
                    ola::http::HTTPResponse *response);
+  int SetDmxBinary(const ola::http::HTTPRequest *request,
+                   ola::http::HTTPResponse *response);
   int DisplayQuit(const ola::http::HTTPRequest *request,
                   ola::http::HTTPResponse *response);
+  int ReloadPlugin(const ola::http::HTTPRequest *request,
+                   ola::http::HTTPResponse *response);
   int ReloadPlugins(const ola::http::HTTPRequest *request,
                     ola::http::HTTPResponse *response);
   int ReloadPidStore(const ola::http::HTTPRequest *request,
@@ -95,7 +102,8 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
                         const std::vector<client::OlaPlugin> &plugins);
 
   void HandleUniverseList(ola::http::HTTPResponse *response,
-                          ola::web::JsonObject *json,
+                          ola::io::IOQueue *output,
+                          ola::web::JsonStreamWriter *writer,
                           const client::Result &result,
                           const std::vector<client::OlaUniverse> &universes);
 
@@ -156,7 +164,9 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
   class OlaServer *m_ola_server;
   bool m_enable_quit;
   ola::network::Interface m_interface;
+  IntegerVariable *m_overload_level;
   RDMHTTPModule m_rdm_module;
+  DmxWebSocketModule m_websocket_module;
   time_t m_start_time_t;
 
   void HandleGetDmx(ola::http::HTTPResponse *response,
@@ -164,6 +174,11 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
                     const client::DMXMetadata &metadata,
                     const DmxBuffer &buffer);
 
+  void HandleGetDmxBinary(ola::http::HTTPResponse *response,
+                          const client::Result &result,
+                          const std::vector<client::DMXFrame> &frames,
+                          uint64_t generation);
+
   void HandleBoolResponse(ola::http::HTTPResponse *response,
                           const client::Result &result);
 
@@ -0,0 +1,180 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OverloadController.cpp
+ * Sheds load when the event loop falls behind.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "olad/IngressLimiter.h"
+#include "olad/OverloadController.h"
+#include "olad/RDMPoller.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+const unsigned int OverloadController::SAMPLE_INTERVAL_MS = 100;
+// Raise the level after half a second of lag, and lower it after three
+// seconds without.
+const unsigned int OverloadController::RAISE_SAMPLES = 5;
+const unsigned int OverloadController::LOWER_SAMPLES = 30;
+
+const char OverloadController::K_OVERLOAD_LEVEL_VAR[] = "olad-overload-level";
+const char OverloadController::K_OVERLOAD_STATE_VAR[] = "olad-overload-state";
+const char OverloadController::K_LOOP_LAG_VAR[] = "olad-loop-lag-us";
+const char OverloadController::K_LEVEL_CHANGES_VAR[] =
+    "olad-overload-level-changes";
+
+OverloadController::OverloadController(
+    UniverseStore *universe_store,
+    ola::thread::SchedulerInterface *scheduler,
+    const TimeStamp *wake_up_time,
+    const Options &options,
+    ExportMap *export_map)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_wake_up_time(wake_up_time),
+      m_options(options),
+      m_rdm_poller(NULL),
+      m_limiter(NULL),
+      m_sample_timeout(ola::thread::INVALID_TIMEOUT),
+      m_level(LOAD_NORMAL),
+      m_average_lag(0),
+      m_busy_samples(0),
+      m_idle_samples(0),
+      m_level_var(NULL),
+      m_state_var(NULL),
+      m_lag_var(NULL),
+      m_changes_var(NULL) {
+  if (export_map) {
+    m_level_var = export_map->GetIntegerVar(K_OVERLOAD_LEVEL_VAR);
+    m_state_var = export_map->GetStringVar(K_OVERLOAD_STATE_VAR);
+    m_lag_var = export_map->GetIntegerVar(K_LOOP_LAG_VAR);
+    m_changes_var = export_map->GetCounterVar(K_LEVEL_CHANGES_VAR);
+    m_state_var->Set(LevelName(m_level));
+  }
+}
+
+OverloadController::~OverloadController() {
+  if (m_sample_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_sample_timeout);
+  }
+}
+
+void OverloadController::Start() {
+  if (m_sample_timeout != ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  m_last_sample = *m_wake_up_time;
+  m_sample_timeout = m_scheduler->RegisterRepeatingTimeout(
+      SAMPLE_INTERVAL_MS,
+      NewCallback(this, &OverloadController::SampleTimeout));
+}
+
+void OverloadController::Sample(const TimeInterval &lag) {
+  // An exponentially weighted average, so a single slow callback doesn't
+  // change the level.
+  m_average_lag = (m_average_lag * 7 + lag.AsInt()) / 8;
+  if (m_lag_var) {
+    m_lag_var->Set(static_cast<int>(m_average_lag));
+  }
+
+  const int64_t threshold = m_options.lag_threshold_ms * 1000;
+  if (m_average_lag > threshold) {
+    m_idle_samples = 0;
+    if (++m_busy_samples >= RAISE_SAMPLES && m_level < LOAD_CAP_INPUT) {
+      m_busy_samples = 0;
+      SetLevel(static_cast<Level>(m_level + 1));
+    }
+  } else if (m_average_lag < threshold / 2) {
+    m_busy_samples = 0;
+    if (++m_idle_samples >= LOWER_SAMPLES && m_level > LOAD_NORMAL) {
+      m_idle_samples = 0;
+      SetLevel(static_cast<Level>(m_level - 1));
+    }
+  } else {
+    m_busy_samples = 0;
+    m_idle_samples = 0;
+  }
+}
+
+const char *OverloadController::LevelName(Level level) {
+  switch (level) {
+    case LOAD_NORMAL:
+      return "normal";
+    case LOAD_SHED_SINKS:
+      return "shedding sink client updates";
+    case LOAD_DEFER_BACKGROUND:
+      return "deferring RDM polling and discovery";
+    case LOAD_CAP_INPUT:
+      return "capping universe input";
+  }
+  return "unknown";
+}
+
+/*
+ * The timeout is rescheduled from the time it runs, so the time since the
+ * last sample, less the interval, is how late it was.
+ */
+bool OverloadController::SampleTimeout() {
+  const TimeStamp now = *m_wake_up_time;
+  TimeInterval lag;
+  const TimeInterval interval(
+      static_cast<int64_t>(SAMPLE_INTERVAL_MS) * 1000);
+  if (now - m_last_sample > interval) {
+    lag = TimeInterval((now - m_last_sample).AsInt() - interval.AsInt());
+  }
+  m_last_sample = now;
+  Sample(lag);
+  return true;
+}
+
+void OverloadController::SetLevel(Level level) {
+  if (level == m_level) {
+    return;
+  }
+
+  if (level > m_level) {
+    OLA_WARN << "Loop lag is " << m_average_lag << "us, load level is now "
+             << LevelName(level);
+  } else {
+    OLA_INFO << "Load level is now " << LevelName(level);
+  }
+  m_level = level;
+
+  if (m_universe_store) {
+    TimeInterval sink_interval;
+    if (level >= LOAD_SHED_SINKS && m_options.sink_rate) {
+      sink_interval = TimeInterval(1000000 / m_options.sink_rate);
+    }
+    m_universe_store->SetSinkInterval(sink_interval);
+  }
+  if (m_rdm_poller) {
+    m_rdm_poller->SetDeferred(level >= LOAD_DEFER_BACKGROUND);
+  }
+  if (m_limiter) {
+    m_limiter->SetUniverseCap(level >= LOAD_CAP_INPUT ?
+                              m_options.input_cap : 0);
+  }
+
+  if (m_level_var) {
+    m_level_var->Set(level);
+    m_state_var->Set(LevelName(level));
+    (*m_changes_var)++;
+  }
+}
+}  // namespace ola
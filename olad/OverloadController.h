@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OverloadController.h
+ * Sheds load when the event loop falls behind.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_OVERLOADCONTROLLER_H_
+#define OLAD_OVERLOADCONTROLLER_H_
+
+#include <stdint.h>
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class IngressLimiter;
+class RDMPoller;
+class UniverseStore;
+
+/**
+ * @brief Sheds load when the event loop falls behind.
+ *
+ * The controller runs a timeout every SAMPLE_INTERVAL_MS and measures how
+ * late it runs, which is how far behind the loop is. When the average lag
+ * stays above the threshold, the load level is raised one step at a time:
+ *  - LOAD_SHED_SINKS: sink clients are sent fewer frames.
+ *  - LOAD_DEFER_BACKGROUND: RDM polling and incremental RDM discovery are
+ *    deferred as well.
+ *  - LOAD_CAP_INPUT: the frames merged for each universe are capped as well.
+ *
+ * The output ports are always sent every frame. Once the lag falls below
+ * half the threshold for long enough the level is lowered again, one step at
+ * a time.
+ */
+class OverloadController {
+ public:
+  enum Level {
+    LOAD_NORMAL,
+    LOAD_SHED_SINKS,
+    LOAD_DEFER_BACKGROUND,
+    LOAD_CAP_INPUT
+  };
+
+  /**
+   * @brief The thresholds and limits to apply.
+   */
+  struct Options {
+    /** @brief The average lag that counts as overloaded. */
+    unsigned int lag_threshold_ms;
+    /** @brief Frames per second for sink clients once shedding, 0 means no
+     * limit. */
+    unsigned int sink_rate;
+    /** @brief Frames per second for each universe at LOAD_CAP_INPUT, 0 means
+     * no limit. */
+    unsigned int input_cap;
+
+    Options() : lag_threshold_ms(20), sink_rate(10), input_cap(25) {}
+  };
+
+  /**
+   * @brief Create a new OverloadController.
+   * @param universe_store the UniverseStore to limit the sink updates of.
+   * @param scheduler the scheduler to run the sample timeout on.
+   * @param wake_up_time the time of the current event loop iteration.
+   * @param options the thresholds and limits to apply.
+   * @param export_map the ExportMap to record the load level in, may be NULL.
+   */
+  OverloadController(UniverseStore *universe_store,
+                     ola::thread::SchedulerInterface *scheduler,
+                     const TimeStamp *wake_up_time,
+                     const Options &options,
+                     ExportMap *export_map);
+  ~OverloadController();
+
+  /**
+   * @brief Set the RDMPoller to defer, ownership is not transferred.
+   */
+  void SetRDMPoller(RDMPoller *poller) { m_rdm_poller = poller; }
+
+  /**
+   * @brief Set the IngressLimiter to cap the input with, ownership is not
+   *   transferred.
+   */
+  void SetIngressLimiter(IngressLimiter *limiter) { m_limiter = limiter; }
+
+  /**
+   * @brief Start sampling the loop lag.
+   */
+  void Start();
+
+  /**
+   * @brief Record a measurement of the loop lag, this is called by the sample
+   *   timeout.
+   * @param lag how late the sample timeout ran.
+   */
+  void Sample(const TimeInterval &lag);
+
+  /**
+   * @brief The current load level.
+   */
+  Level CurrentLevel() const { return m_level; }
+
+  /**
+   * @brief Check if background work, such as RDM discovery, should be put
+   *   off.
+   */
+  bool BackgroundDeferred() const { return m_level >= LOAD_DEFER_BACKGROUND; }
+
+  /**
+   * @brief The average lag, in microseconds.
+   */
+  int64_t AverageLag() const { return m_average_lag; }
+
+  /**
+   * @brief A description of a level, for the logs and the web UI.
+   */
+  static const char *LevelName(Level level);
+
+  static const unsigned int SAMPLE_INTERVAL_MS;
+  static const unsigned int RAISE_SAMPLES;
+  static const unsigned int LOWER_SAMPLES;
+
+  static const char K_OVERLOAD_LEVEL_VAR[];
+  static const char K_OVERLOAD_STATE_VAR[];
+  static const char K_LOOP_LAG_VAR[];
+  static const char K_LEVEL_CHANGES_VAR[];
+
+ private:
+  UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  const TimeStamp *m_wake_up_time;
+  const Options m_options;
+  RDMPoller *m_rdm_poller;
+  IngressLimiter *m_limiter;
+  ola::thread::timeout_id m_sample_timeout;
+  TimeStamp m_last_sample;
+  Level m_level;
+  int64_t m_average_lag;
+  // The number of samples in a row above, or below, the threshold.
+  unsigned int m_busy_samples;
+  unsigned int m_idle_samples;
+
+  IntegerVariable *m_level_var;
+  StringVariable *m_state_var;
+  IntegerVariable *m_lag_var;
+  CounterVariable *m_changes_var;
+
+  bool SampleTimeout();
+  void SetLevel(Level level);
+
+  DISALLOW_COPY_AND_ASSIGN(OverloadController);
+};
+}  // namespace ola
+#endif  // OLAD_OVERLOADCONTROLLER_H_
@@ -0,0 +1,206 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OverloadControllerTest.cpp
+ * Test fixture for the OverloadController class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/IngressLimiter.h"
+#include "olad/OverloadController.h"
+#include "olad/RDMPoller.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Client;
+using ola::IngressLimiter;
+using ola::OverloadController;
+using ola::RDMPoller;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::UniverseStore;
+
+class OverloadControllerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OverloadControllerTest);
+  CPPUNIT_TEST(testLevels);
+  CPPUNIT_TEST(testHysteresis);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    OverloadControllerTest()
+        : m_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {
+    }
+
+    void setUp() {
+      ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+      m_store.reset(new UniverseStore(NULL, &m_export_map));
+      m_clock.CurrentTime(&m_now);
+      m_poller.reset(new RDMPoller(m_store.get(), &m_ss, m_uid));
+      m_limiter.reset(new IngressLimiter(m_store.get(), &m_ss, &m_now,
+                                         IngressLimiter::Options(),
+                                         &m_export_map));
+      OverloadController::Options options;
+      options.lag_threshold_ms = 20;
+      options.sink_rate = 10;
+      options.input_cap = 10;
+      m_controller.reset(new OverloadController(
+          m_store.get(), &m_ss, &m_now, options, &m_export_map));
+      m_controller->SetRDMPoller(m_poller.get());
+      m_controller->SetIngressLimiter(m_limiter.get());
+    }
+
+    void tearDown() {
+      m_controller.reset();
+      m_limiter.reset();
+      m_poller.reset();
+      m_store->DeleteAll();
+      m_store.reset();
+    }
+
+    void testLevels();
+    void testHysteresis();
+
+ private:
+    ola::rdm::UID m_uid;
+    ola::ExportMap m_export_map;
+    ola::io::SelectServer m_ss;
+    ola::Clock m_clock;
+    TimeStamp m_now;
+    std::auto_ptr<UniverseStore> m_store;
+    std::auto_ptr<RDMPoller> m_poller;
+    std::auto_ptr<IngressLimiter> m_limiter;
+    std::auto_ptr<OverloadController> m_controller;
+
+    void Sample(unsigned int count, unsigned int lag_ms) {
+      for (unsigned int i = 0; i < count; i++) {
+        m_controller->Sample(TimeInterval(
+            static_cast<int64_t>(lag_ms) * 1000));
+      }
+    }
+
+    // Returns true if a frame sent just after another would reach the sink
+    // clients.
+    bool SinksUpdated() {
+      return m_store->SinkUpdateDue(m_now, m_now + TimeInterval(1000));
+    }
+
+    int Level() {
+      return m_export_map.GetIntegerVar(
+          OverloadController::K_OVERLOAD_LEVEL_VAR)->Get();
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OverloadControllerTest);
+
+/*
+ * Check the level rises one step at a time while the loop lags, and falls
+ * again once it recovers.
+ */
+void OverloadControllerTest::testLevels() {
+  OLA_ASSERT_EQ(OverloadController::LOAD_NORMAL,
+                m_controller->CurrentLevel());
+  OLA_ASSERT_TRUE(SinksUpdated());
+
+  // The average takes a few samples to pass the threshold.
+  Sample(OverloadController::RAISE_SAMPLES, 100);
+  OLA_ASSERT_EQ(OverloadController::LOAD_NORMAL,
+                m_controller->CurrentLevel());
+  Sample(OverloadController::RAISE_SAMPLES, 100);
+  OLA_ASSERT_EQ(OverloadController::LOAD_SHED_SINKS,
+                m_controller->CurrentLevel());
+  OLA_ASSERT_EQ(1, Level());
+  OLA_ASSERT_FALSE(SinksUpdated());
+  OLA_ASSERT_TRUE(m_store->SinkUpdateDue(
+      m_now, m_now + TimeInterval(100000)));
+  OLA_ASSERT_FALSE(m_poller->Deferred());
+  OLA_ASSERT_EQ(1u, m_export_map.GetCounterVar(
+      "sink-frames-shed")->Get());
+
+  Sample(OverloadController::RAISE_SAMPLES, 100);
+  OLA_ASSERT_EQ(OverloadController::LOAD_DEFER_BACKGROUND,
+                m_controller->CurrentLevel());
+  OLA_ASSERT_TRUE(m_poller->Deferred());
+  OLA_ASSERT_TRUE(m_controller->BackgroundDeferred());
+
+  // At the last level a client's frames are capped.
+  Client client(NULL, m_uid);
+  ola::Universe *universe = m_store->GetUniverseOrCreate(1);
+  ola::DmxBuffer data;
+  data.SetRangeToValue(0, 1, 4);
+  client.DMXReceived(1, data.GetRaw(), data.Size(), m_now,
+                     ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  OLA_ASSERT_TRUE(m_limiter->Admit(&client, 1));
+  OLA_ASSERT_TRUE(m_limiter->Admit(&client, 1));
+
+  Sample(OverloadController::RAISE_SAMPLES * 2, 100);
+  OLA_ASSERT_EQ(OverloadController::LOAD_CAP_INPUT,
+                m_controller->CurrentLevel());
+  OLA_ASSERT_EQ(3, Level());
+  OLA_ASSERT_TRUE(m_limiter->Admit(&client, 1));
+  OLA_ASSERT_FALSE(m_limiter->Admit(&client, 1));
+
+  // Once the lag is gone, the level falls a step at a time.
+  Sample(OverloadController::LOWER_SAMPLES + 20, 0);
+  OLA_ASSERT_EQ(OverloadController::LOAD_DEFER_BACKGROUND,
+                m_controller->CurrentLevel());
+  // The held frame is merged on the next tick.
+  OLA_ASSERT_FALSE(m_limiter->MergeHeldFrames());
+  OLA_ASSERT_TRUE(m_limiter->Admit(&client, 1));
+  OLA_ASSERT_TRUE(m_limiter->Admit(&client, 1));
+
+  Sample(OverloadController::LOWER_SAMPLES * 2, 0);
+  OLA_ASSERT_EQ(OverloadController::LOAD_NORMAL,
+                m_controller->CurrentLevel());
+  OLA_ASSERT_FALSE(m_poller->Deferred());
+  OLA_ASSERT_TRUE(SinksUpdated());
+  OLA_ASSERT_EQ(0, Level());
+  OLA_ASSERT_EQ(6u, m_export_map.GetCounterVar(
+      OverloadController::K_LEVEL_CHANGES_VAR)->Get());
+  universe->RemoveSourceClient(&client);
+}
+
+/*
+ * Check a lag between half the threshold and the threshold doesn't change
+ * the level either way.
+ */
+void OverloadControllerTest::testHysteresis() {
+  Sample(8, 50);
+  OLA_ASSERT_EQ(OverloadController::LOAD_SHED_SINKS,
+                m_controller->CurrentLevel());
+  // Bring the average down to just under the threshold.
+  Sample(4, 0);
+  OLA_ASSERT_EQ(OverloadController::LOAD_SHED_SINKS,
+                m_controller->CurrentLevel());
+
+  Sample(OverloadController::LOWER_SAMPLES * 3, 15);
+  OLA_ASSERT_EQ(OverloadController::LOAD_SHED_SINKS,
+                m_controller->CurrentLevel());
+
+  Sample(OverloadController::LOWER_SAMPLES * 2, 1);
+  OLA_ASSERT_EQ(OverloadController::LOAD_NORMAL,
+                m_controller->CurrentLevel());
+}
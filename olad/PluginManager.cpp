@@ -21,22 +21,61 @@
 #include "olad/PluginManager.h"
 
 #include <set>
+#include <string>
 #include <vector>
 #include "ola/Logging.h"
+#include "ola/base/Macro.h"
 #include "ola/stl/STLUtils.h"
+#include "ola/thread/Thread.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/PluginLoader.h"
+#include "olad/StartupTrace.h"
 
 namespace ola {
 
-using std::vector;
 using std::set;
+using std::vector;
+
+namespace {
+
+/*
+ * Runs PrepareStart() for a plugin on a separate thread.
+ */
+class PrepareThread: public ola::thread::Thread {
+ public:
+  PrepareThread(AbstractPlugin *plugin, StartupTrace *trace)
+      : Thread(Thread::Options("prepare-" + plugin->Name())),
+        m_plugin(plugin),
+        m_trace(trace),
+        m_prepared(false) {
+  }
+
+  void *Run() {
+    StartupTrace::Span span(m_trace, m_plugin->Name(), "plugin-prepare");
+    m_prepared = m_plugin->PrepareStart();
+    return NULL;
+  }
+
+  AbstractPlugin *Plugin() const { return m_plugin; }
+
+  // Only valid once the thread has been joined.
+  bool Prepared() const { return m_prepared; }
+
+ private:
+  AbstractPlugin *m_plugin;
+  StartupTrace *m_trace;
+  bool m_prepared;
+
+  DISALLOW_COPY_AND_ASSIGN(PrepareThread);
+};
+}  // namespace
 
 PluginManager::PluginManager(const vector<PluginLoader*> &plugin_loaders,
                              class PluginAdaptor *plugin_adaptor)
     : m_plugin_loaders(plugin_loaders),
-      m_plugin_adaptor(plugin_adaptor) {
+      m_plugin_adaptor(plugin_adaptor),
+      m_startup_trace(NULL) {
 }
 
 PluginManager::~PluginManager() {
@@ -52,7 +91,9 @@ void PluginManager::LoadAll() {
   for (iter = m_plugin_loaders.begin(); iter != m_plugin_loaders.end();
        ++iter) {
     (*iter)->SetPluginAdaptor(m_plugin_adaptor);
+    StartupTrace::Span load_span(m_startup_trace, "load-plugins", "olad");
     vector<AbstractPlugin*> plugins = (*iter)->LoadPlugins();
+    load_span.End();
 
     vector<AbstractPlugin*>::iterator plugin_iter = plugins.begin();
     for (; plugin_iter != plugins.end(); ++plugin_iter) {
@@ -64,6 +105,8 @@ void PluginManager::LoadAll() {
         continue;
       }
 
+      StartupTrace::Span preferences_span(m_startup_trace, plugin->Name(),
+                                          "plugin-preferences");
       if (!plugin->LoadPreferences()) {
         OLA_WARN << "Failed to load preferences for " << plugin->Name();
         continue;
@@ -77,10 +120,50 @@ void PluginManager::LoadAll() {
     }
   }
 
-  // The second pass checks for conflicts and starts each plugin
+  // The second pass kicks off the slow setup for plugins which can do it off
+  // the main thread. These plugins don't conflict with anything that's
+  // enabled, so the order they start in doesn't matter.
+  vector<PrepareThread*> threads;
+  set<ola_plugin_id> preparing;
   PluginMap::iterator plugin_iter = m_enabled_plugins.begin();
   for (; plugin_iter != m_enabled_plugins.end(); ++plugin_iter) {
-    StartIfSafe(plugin_iter->second);
+    AbstractPlugin *plugin = plugin_iter->second;
+    if (!plugin->CanPrepareOffMainThread() || ConflictsWithEnabled(plugin)) {
+      continue;
+    }
+
+    OLA_INFO << "Preparing " << plugin->Name();
+    PrepareThread *thread = new PrepareThread(plugin, m_startup_trace);
+    if (!thread->Start()) {
+      OLA_WARN << "Failed to start thread for " << plugin->Name();
+      delete thread;
+      continue;
+    }
+    threads.push_back(thread);
+    preparing.insert(plugin->Id());
+  }
+
+  // The third pass checks for conflicts and starts the remaining plugins in
+  // order.
+  for (plugin_iter = m_enabled_plugins.begin();
+       plugin_iter != m_enabled_plugins.end(); ++plugin_iter) {
+    if (!STLContains(preparing, plugin_iter->first)) {
+      StartIfSafe(plugin_iter->second);
+    }
+  }
+
+  // Finally, wait for the prepared plugins and start them here, so they
+  // register their devices from this thread.
+  vector<PrepareThread*>::iterator thread_iter = threads.begin();
+  for (; thread_iter != threads.end(); ++thread_iter) {
+    PrepareThread *thread = *thread_iter;
+    thread->Join();
+    if (thread->Prepared()) {
+      StartPrepared(thread->Plugin());
+    } else {
+      OLA_WARN << "Failed to start " << thread->Plugin()->Name();
+    }
+    delete thread;
   }
 }
 
@@ -110,6 +193,14 @@ void PluginManager::ActivePlugins(vector<AbstractPlugin*> *plugins) const {
   STLValues(m_active_plugins, plugins);
 }
 
+void PluginManager::InterfacesChanged(
+    const ola::network::InterfaceChanges &changes) {
+  PluginMap::iterator iter = m_active_plugins.begin();
+  for (; iter != m_active_plugins.end(); ++iter) {
+    iter->second->InterfacesChanged(changes);
+  }
+}
+
 void PluginManager::EnabledPlugins(vector<AbstractPlugin*> *plugins) const {
   plugins->clear();
   STLValues(m_enabled_plugins, plugins);
@@ -129,7 +220,7 @@ bool PluginManager::IsEnabled(ola_plugin_id plugin_id) const {
 
 void PluginManager::DisableAndStopPlugin(ola_plugin_id plugin_id) {
   AbstractPlugin *plugin = STLFindOrNull(m_loaded_plugins, plugin_id);
-  if (!plugin_id) {
+  if (!plugin) {
     return;
   }
 
@@ -160,6 +251,34 @@ bool PluginManager::EnableAndStartPlugin(ola_plugin_id plugin_id) {
   return StartIfSafe(plugin);
 }
 
+bool PluginManager::ReloadPlugin(ola_plugin_id plugin_id) {
+  AbstractPlugin *plugin = STLFindOrNull(m_loaded_plugins, plugin_id);
+  if (!plugin) {
+    return false;
+  }
+
+  OLA_INFO << "Reloading " << plugin->Name();
+  if (STLRemove(&m_active_plugins, plugin_id)) {
+    plugin->Stop();
+  }
+
+  if (!plugin->ReloadPreferences()) {
+    OLA_WARN << "Failed to reload preferences for " << plugin->Name();
+    STLRemove(&m_enabled_plugins, plugin_id);
+    return false;
+  }
+
+  if (!plugin->IsEnabled()) {
+    OLA_INFO << "Not restarting " << plugin->Name()
+             << " because it was disabled";
+    STLRemove(&m_enabled_plugins, plugin_id);
+    return true;
+  }
+
+  STLReplace(&m_enabled_plugins, plugin_id, plugin);
+  return StartIfSafe(plugin);
+}
+
 void PluginManager::GetConflictList(ola_plugin_id plugin_id,
                                     vector<AbstractPlugin*> *plugins) {
   PluginMap::iterator iter = m_loaded_plugins.begin();
@@ -193,7 +312,19 @@ bool PluginManager::StartIfSafe(AbstractPlugin *plugin) {
   }
 
   OLA_INFO << "Trying to start " << plugin->Name();
+  StartupTrace::Span span(m_startup_trace, plugin->Name(), "plugin-prepare");
+  if (!plugin->PrepareStart()) {
+    OLA_WARN << "Failed to start " << plugin->Name();
+    return false;
+  }
+  span.End();
+  return StartPrepared(plugin);
+}
+
+bool PluginManager::StartPrepared(AbstractPlugin *plugin) {
+  StartupTrace::Span span(m_startup_trace, plugin->Name(), "plugin-start");
   bool ok = plugin->Start();
+  span.End();
   if (!ok) {
     OLA_WARN << "Failed to start " << plugin->Name();
   } else {
@@ -231,4 +362,29 @@ AbstractPlugin* PluginManager::CheckForRunningConflicts(
   }
   return NULL;
 }
+
+/*
+ * @brief Check if this plugin conflicts with any of the enabled plugins.
+ * @param plugin The plugin to check
+ * @returns true if there is a conflict, false otherwise.
+ */
+bool PluginManager::ConflictsWithEnabled(const AbstractPlugin *plugin) const {
+  set<ola_plugin_id> conflict_list;
+  plugin->ConflictsWith(&conflict_list);
+  PluginMap::const_iterator iter = m_enabled_plugins.begin();
+  for (; iter != m_enabled_plugins.end(); ++iter) {
+    if (iter->second == plugin) {
+      continue;
+    }
+    if (STLContains(conflict_list, iter->first)) {
+      return true;
+    }
+    set<ola_plugin_id> other_conflicts;
+    iter->second->ConflictsWith(&other_conflicts);
+    if (STLContains(other_conflicts, plugin->Id())) {
+      return true;
+    }
+  }
+  return false;
+}
 }  // namespace ola
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "ola/base/Macro.h"
+#include "ola/network/InterfaceMonitor.h"
 #include "ola/plugin_id.h"
 
 namespace ola {
@@ -32,6 +33,7 @@ namespace ola {
 class PluginLoader;
 class PluginAdaptor;
 class AbstractPlugin;
+class StartupTrace;
 
 /**
  * @brief The manager of plugins.
@@ -48,8 +50,15 @@ class AbstractPlugin;
  *
  * Plugins are active if they weren't disabled, there were no conflicts that
  * prevented them from loading, and the call to Start() was successfull.
+ *
+ * When loading, plugins that can prepare off the main thread, and that don't
+ * conflict with any other enabled plugin, have PrepareStart() run in
+ * parallel while the remaining plugins are started in order. Start() is
+ * always called from the thread calling LoadAll().
+ *
+ * Changes to the network interfaces are passed on to the active plugins.
  */
-class PluginManager {
+class PluginManager: public ola::network::InterfaceMonitor::Listener {
  public:
   /**
    * @brief Create a new PluginManager.
@@ -76,6 +85,13 @@ class PluginManager {
    */
   void UnloadAll();
 
+  /**
+   * @brief Record the time spent loading and starting each plugin.
+   * @param trace the StartupTrace to record to, or NULL to stop recording.
+   *   Ownership isn't transferred.
+   */
+  void SetStartupTrace(StartupTrace *trace) { m_startup_trace = trace; }
+
   /**
    * @brief Return the list of loaded plugins.
    * @param[out] plugins the list of plugins.
@@ -134,6 +150,18 @@ class PluginManager {
    */
   void DisableAndStopPlugin(ola_plugin_id plugin_id);
 
+  /**
+   * @brief Stop a single plugin, reload its preferences and start it again.
+   * @param plugin_id the id of the plugin to reload.
+   * @returns true if the plugin was reloaded, false if it isn't loaded or
+   *   couldn't be started again.
+   *
+   * The other plugins keep running. The plugin's devices are unregistered and
+   * registered again, so its ports are re-patched to their universes. If the
+   * preferences now disable the plugin, it's left stopped.
+   */
+  bool ReloadPlugin(ola_plugin_id plugin_id);
+
   /**
    * @brief Return a list of plugins that conflict with this particular plugin.
    * @param plugin_id the id of the plugin to check.
@@ -142,6 +170,8 @@ class PluginManager {
   void GetConflictList(ola_plugin_id plugin_id,
                        std::vector<AbstractPlugin*> *plugins);
 
+  void InterfacesChanged(const ola::network::InterfaceChanges &changes);
+
  private:
   typedef std::map<ola_plugin_id, AbstractPlugin*> PluginMap;
 
@@ -150,8 +180,11 @@ class PluginManager {
   PluginMap m_active_plugins;  // active plugins
   PluginMap m_enabled_plugins;  // enabled plugins
   PluginAdaptor *m_plugin_adaptor;
+  StartupTrace *m_startup_trace;
 
   bool StartIfSafe(AbstractPlugin *plugin);
+  bool StartPrepared(AbstractPlugin *plugin);
+  bool ConflictsWithEnabled(const AbstractPlugin *plugin) const;
   AbstractPlugin* CheckForRunningConflicts(const AbstractPlugin *plugin) const;
 
   DISALLOW_COPY_AND_ASSIGN(PluginManager);
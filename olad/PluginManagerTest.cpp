@@ -30,11 +30,14 @@
 #include "olad/Preferences.h"
 #include "olad/plugin_api/TestCommon.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
 
 
 using ola::AbstractPlugin;
 using ola::PluginLoader;
 using ola::PluginManager;
+using ola::thread::Thread;
+using ola::thread::ThreadId;
 using std::set;
 using std::string;
 using std::vector;
@@ -44,11 +47,15 @@ class PluginManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(PluginManagerTest);
   CPPUNIT_TEST(testPluginManager);
   CPPUNIT_TEST(testConflictingPlugins);
+  CPPUNIT_TEST(testParallelPrepare);
+  CPPUNIT_TEST(testReloadPlugin);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testPluginManager();
     void testConflictingPlugins();
+    void testParallelPrepare();
+    void testReloadPlugin();
 
     void setUp() {
       ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
@@ -98,6 +105,47 @@ class MockLoader: public ola::PluginLoader {
 };
 
 
+/*
+ * A plugin which prepares off the main thread.
+ */
+class ThreadedMockPlugin: public TestMockPlugin {
+ public:
+    ThreadedMockPlugin(ola::PluginAdaptor *plugin_adaptor,
+                       ola::ola_plugin_id plugin_id,
+                       const set<ola::ola_plugin_id> &conflict_set,
+                       bool prepare_ok = true)
+      : TestMockPlugin(plugin_adaptor, plugin_id, conflict_set),
+        m_prepare_ok(prepare_ok),
+        m_prepare_count(0),
+        m_prepare_thread(Thread::Self()),
+        m_start_thread(Thread::Self()) {
+    }
+
+    bool CanPrepareOffMainThread() const { return true; }
+
+    bool PrepareStart() {
+      m_prepare_count++;
+      m_prepare_thread = Thread::Self();
+      return m_prepare_ok;
+    }
+
+    bool StartHook() {
+      m_start_thread = Thread::Self();
+      return TestMockPlugin::StartHook();
+    }
+
+    unsigned int PrepareCount() const { return m_prepare_count; }
+    ThreadId PrepareThread() const { return m_prepare_thread; }
+    ThreadId StartThread() const { return m_start_thread; }
+
+ private:
+    bool m_prepare_ok;
+    unsigned int m_prepare_count;
+    ThreadId m_prepare_thread;
+    ThreadId m_start_thread;
+};
+
+
 /*
  * Check that we can load & unload plugins correctly.
  */
@@ -181,3 +229,113 @@ void PluginManagerTest::testConflictingPlugins() {
   manager.UnloadAll();
   VerifyPluginCounts(&manager, 0, 0, OLA_SOURCELINE());
 }
+
+
+/*
+ * Check that plugins are prepared off the main thread, unless they conflict
+ * with another enabled plugin.
+ */
+void PluginManagerTest::testParallelPrepare() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  set<ola::ola_plugin_id> no_conflicts, conflict_set;
+  ThreadedMockPlugin plugin1(&adaptor, ola::OLA_PLUGIN_ARTNET, no_conflicts);
+  ThreadedMockPlugin plugin2(&adaptor, ola::OLA_PLUGIN_ESPNET, no_conflicts,
+                             false);
+  // These two conflict, so they're prepared on this thread, in order.
+  conflict_set.insert(ola::OLA_PLUGIN_SANDNET);
+  ThreadedMockPlugin plugin3(&adaptor, ola::OLA_PLUGIN_DUMMY, conflict_set);
+  ThreadedMockPlugin plugin4(&adaptor, ola::OLA_PLUGIN_SANDNET, no_conflicts);
+  TestMockPlugin plugin5(&adaptor, ola::OLA_PLUGIN_SHOWNET);
+
+  vector<AbstractPlugin*> our_plugins;
+  our_plugins.push_back(&plugin1);
+  our_plugins.push_back(&plugin2);
+  our_plugins.push_back(&plugin3);
+  our_plugins.push_back(&plugin4);
+  our_plugins.push_back(&plugin5);
+
+  MockLoader loader(our_plugins);
+  vector<PluginLoader*> loaders;
+  loaders.push_back(&loader);
+
+  PluginManager manager(loaders, &adaptor);
+  manager.LoadAll();
+
+  VerifyPluginCounts(&manager, 5, 3, OLA_SOURCELINE());
+  ThreadId self = Thread::Self();
+
+  OLA_ASSERT_TRUE(plugin1.IsRunning());
+  OLA_ASSERT_EQ(1u, plugin1.PrepareCount());
+  OLA_ASSERT_FALSE(pthread_equal(self, plugin1.PrepareThread()));
+  OLA_ASSERT_TRUE(pthread_equal(self, plugin1.StartThread()));
+
+  // Failing to prepare means the plugin isn't started.
+  OLA_ASSERT_FALSE(plugin2.IsRunning());
+  OLA_ASSERT_EQ(1u, plugin2.PrepareCount());
+  OLA_ASSERT_FALSE(pthread_equal(self, plugin2.PrepareThread()));
+
+  OLA_ASSERT_TRUE(plugin3.IsRunning());
+  OLA_ASSERT_EQ(1u, plugin3.PrepareCount());
+  OLA_ASSERT_TRUE(pthread_equal(self, plugin3.PrepareThread()));
+  OLA_ASSERT_TRUE(pthread_equal(self, plugin3.StartThread()));
+
+  OLA_ASSERT_FALSE(plugin4.IsRunning());
+  OLA_ASSERT_EQ(0u, plugin4.PrepareCount());
+
+  OLA_ASSERT_TRUE(plugin5.IsRunning());
+
+  manager.UnloadAll();
+  VerifyPluginCounts(&manager, 0, 0, OLA_SOURCELINE());
+}
+
+
+/*
+ * Check that reloading a plugin only restarts that plugin.
+ */
+void PluginManagerTest::testReloadPlugin() {
+  ola::MemoryPreferencesFactory factory;
+  ola::PluginAdaptor adaptor(NULL, NULL, NULL, &factory, NULL, NULL);
+
+  set<ola::ola_plugin_id> no_conflicts;
+  ThreadedMockPlugin plugin1(&adaptor, ola::OLA_PLUGIN_ARTNET, no_conflicts);
+  ThreadedMockPlugin plugin2(&adaptor, ola::OLA_PLUGIN_ESPNET, no_conflicts);
+  TestMockPlugin plugin3(&adaptor, ola::OLA_PLUGIN_SHOWNET, false);
+
+  vector<AbstractPlugin*> our_plugins;
+  our_plugins.push_back(&plugin1);
+  our_plugins.push_back(&plugin2);
+  our_plugins.push_back(&plugin3);
+
+  MockLoader loader(our_plugins);
+  vector<PluginLoader*> loaders;
+  loaders.push_back(&loader);
+
+  PluginManager manager(loaders, &adaptor);
+  manager.LoadAll();
+  VerifyPluginCounts(&manager, 3, 2, OLA_SOURCELINE());
+  OLA_ASSERT_EQ(1u, plugin1.PrepareCount());
+  OLA_ASSERT_EQ(1u, plugin2.PrepareCount());
+
+  OLA_ASSERT_TRUE(manager.ReloadPlugin(ola::OLA_PLUGIN_ARTNET));
+  VerifyPluginCounts(&manager, 3, 2, OLA_SOURCELINE());
+  OLA_ASSERT_TRUE(plugin1.IsRunning());
+  OLA_ASSERT_TRUE(manager.IsActive(ola::OLA_PLUGIN_ARTNET));
+  OLA_ASSERT_EQ(2u, plugin1.PrepareCount());
+  // The other plugin wasn't touched.
+  OLA_ASSERT_TRUE(plugin2.IsRunning());
+  OLA_ASSERT_EQ(1u, plugin2.PrepareCount());
+
+  // A disabled plugin stays stopped.
+  OLA_ASSERT_TRUE(manager.ReloadPlugin(ola::OLA_PLUGIN_SHOWNET));
+  OLA_ASSERT_FALSE(plugin3.IsRunning());
+  OLA_ASSERT_FALSE(manager.IsEnabled(ola::OLA_PLUGIN_SHOWNET));
+  VerifyPluginCounts(&manager, 3, 2, OLA_SOURCELINE());
+
+  // Unknown plugins can't be reloaded.
+  OLA_ASSERT_FALSE(manager.ReloadPlugin(ola::OLA_PLUGIN_DUMMY));
+
+  manager.UnloadAll();
+  VerifyPluginCounts(&manager, 0, 0, OLA_SOURCELINE());
+}
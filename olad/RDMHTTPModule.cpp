@@ -35,6 +35,7 @@
 #include "ola/Logging.h"
 #include "ola/OlaCallbackClient.h"
 #include "ola/StringUtils.h"
+#include "ola/io/IOQueue.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/RDMHelper.h"
 #include "ola/rdm/UID.h"
@@ -42,6 +43,7 @@
 #include "ola/thread/Mutex.h"
 #include "ola/web/Json.h"
 #include "ola/web/JsonSections.h"
+#include "ola/web/JsonStreamWriter.h"
 #include "olad/OlaServer.h"
 #include "olad/OladHTTPServer.h"
 #include "olad/RDMHTTPModule.h"
@@ -54,6 +56,7 @@ using ola::client::Result;
 using ola::http::HTTPRequest;
 using ola::http::HTTPResponse;
 using ola::http::HTTPServer;
+using ola::io::IOQueue;
 using ola::rdm::UID;
 using ola::thread::MutexLocker;
 using ola::web::BoolItem;
@@ -62,6 +65,7 @@ using ola::web::HiddenItem;
 using ola::web::JsonArray;
 using ola::web::JsonObject;
 using ola::web::JsonSection;
+using ola::web::JsonStreamWriter;
 using ola::web::SelectItem;
 using ola::web::StringItem;
 using ola::web::UIntItem;
@@ -455,6 +459,12 @@ int RDMHTTPModule::JsonSupportedSections(const HTTPRequest *request,
     return OladHTTPServer::ServeHelpRedirect(response);
   }
 
+  supported_sections_state *state = new supported_sections_state();
+  state->response = response;
+  state->outstanding = 2;
+  state->failed = false;
+  state->device_ok = false;
+
   string error;
   bool ok = m_rdm_api.GetSupportedParameters(
       universe_id,
@@ -462,15 +472,28 @@ int RDMHTTPModule::JsonSupportedSections(const HTTPRequest *request,
       ola::rdm::ROOT_RDM_DEVICE,
       NewSingleCallback(this,
                         &RDMHTTPModule::SupportedSectionsHandler,
-                        response,
-                        universe_id,
-                        *uid),
+                        state),
       &error);
-  delete uid;
-
   if (!ok) {
+    delete uid;
+    delete state;
     return m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR);
   }
+
+  ok = m_rdm_api.GetDeviceInfo(
+      universe_id,
+      *uid,
+      ola::rdm::ROOT_RDM_DEVICE,
+      NewSingleCallback(this,
+                        &RDMHTTPModule::SupportedSectionsDeviceInfoHandler,
+                        state),
+      &error);
+  delete uid;
+  if (!ok) {
+    // The SUPPORTED_PARAMETERS callback serves the error.
+    state->failed = true;
+    state->outstanding--;
+  }
   return MHD_YES;
 }
 
@@ -706,6 +729,7 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
   }
   ola::rdm::UIDSet::Iterator iter = uids.Begin();
   uid_resolution_state *uid_state = GetUniverseUidsOrCreate(universe_id);
+  vector<UID> new_uids;
 
   // mark all uids as inactive so we can remove the unused ones at the end
   map<UID, resolved_uid>::iterator uid_iter;
@@ -713,9 +737,10 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
        uid_iter != uid_state->resolved_uids.end(); ++uid_iter)
     uid_iter->second.active = false;
 
-  JsonObject json;
-  json.Add("universe", universe_id);
-  JsonArray *json_uids = json.AddArray("uids");
+  IOQueue *output = new IOQueue();
+  JsonStreamWriter writer(output);
+  writer.StartObject();
+  writer.StartArray("uids");
 
   for (; iter != uids.End(); ++iter) {
     uid_iter = uid_state->resolved_uids.find(*iter);
@@ -729,6 +754,7 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
       uid_state->pending_uids.push(std::make_pair(*iter, RESOLVE_DEVICE));
       resolved_uid uid_descriptor = {"", "", true};
       uid_state->resolved_uids[*iter] = uid_descriptor;
+      new_uids.push_back(*iter);
       OLA_INFO << "Adding UID " << *iter << " to resolution queue";
     } else {
       manufacturer = uid_iter->second.manufacturer;
@@ -736,17 +762,21 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
       uid_iter->second.active = true;
     }
 
-    JsonObject *json_uid = json_uids->AppendObject();
-    json_uid->Add("manufacturer_id", iter->ManufacturerId());
-    json_uid->Add("device_id", iter->DeviceId());
-    json_uid->Add("device", device);
-    json_uid->Add("manufacturer", manufacturer);
-    json_uid->Add("uid", iter->ToString());
+    writer.StartObject();
+    writer.Add("device", device);
+    writer.Add("device_id", iter->DeviceId());
+    writer.Add("manufacturer", manufacturer);
+    writer.Add("manufacturer_id", iter->ManufacturerId());
+    writer.Add("uid", iter->ToString());
+    writer.EndObject();
   }
+  writer.EndArray();
+  writer.Add("universe", universe_id);
+  writer.EndObject();
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
-  response->SendJson(json);
+  response->Send(output);
   delete response;
 
   // remove any old UIDs
@@ -760,18 +790,28 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
     }
   }
 
-  if (!uid_state->uid_resolution_running) {
-    ResolveNextUID(universe_id);
+  // The labels for the list come first, then the requests that warm the
+  // cache for the supported sections.
+  vector<UID>::const_iterator new_iter = new_uids.begin();
+  for (; new_iter != new_uids.end(); ++new_iter) {
+    uid_state->pending_uids.push(
+        std::make_pair(*new_iter, RESOLVE_SUPPORTED_PARAMETERS));
+    uid_state->pending_uids.push(
+        std::make_pair(*new_iter, RESOLVE_DEVICE_INFO));
   }
+
+  ResolveUIDs(universe_id);
 }
 
 
 /*
- * @brief Send the RDM command needed to resolve the next uid in the queue
- * @param universe_id the universe id to resolve the next UID for.
+ * @brief Send the RDM commands needed to resolve the uids in the queue
+ * @param universe_id the universe id to resolve the UIDs for.
+ *
+ * Up to MAX_RESOLVE_REQUESTS are sent at once, rather than waiting for each
+ * response before sending the next request.
  */
-void RDMHTTPModule::ResolveNextUID(unsigned int universe_id) {
-  bool sent_request = false;
+void RDMHTTPModule::ResolveUIDs(unsigned int universe_id) {
   string error;
   uid_resolution_state *uid_state = GetUniverseUids(universe_id);
 
@@ -779,15 +819,12 @@ void RDMHTTPModule::ResolveNextUID(unsigned int universe_id) {
     return;
   }
 
-  while (!sent_request) {
-    if (uid_state->pending_uids.empty()) {
-      uid_state->uid_resolution_running = false;
-      return;
-    }
-    uid_state->uid_resolution_running = true;
-
-    pair<UID, uid_resolve_action> &uid_action_pair =
+  while (uid_state->requests_in_flight < MAX_RESOLVE_REQUESTS &&
+         !uid_state->pending_uids.empty()) {
+    bool sent_request = false;
+    pair<UID, uid_resolve_action> uid_action_pair =
       uid_state->pending_uids.front();
+    uid_state->pending_uids.pop();
     if (uid_action_pair.second == RESOLVE_MANUFACTURER) {
       OLA_INFO << "sending manufacturer request for " << uid_action_pair.first;
       sent_request = m_rdm_api.GetManufacturerLabel(
@@ -799,7 +836,6 @@ void RDMHTTPModule::ResolveNextUID(unsigned int universe_id) {
                             universe_id,
                             uid_action_pair.first),
           &error);
-      uid_state->pending_uids.pop();
     } else if (uid_action_pair.second == RESOLVE_DEVICE) {
       OLA_INFO << "sending device request for " << uid_action_pair.first;
       sent_request = m_rdm_api.GetDeviceLabel(
@@ -811,12 +847,50 @@ void RDMHTTPModule::ResolveNextUID(unsigned int universe_id) {
                             universe_id,
                             uid_action_pair.first),
           &error);
-      uid_state->pending_uids.pop();
+    } else if (uid_action_pair.second == RESOLVE_SUPPORTED_PARAMETERS) {
+      sent_request = m_rdm_api.GetSupportedParameters(
+          universe_id,
+          uid_action_pair.first,
+          ola::rdm::ROOT_RDM_DEVICE,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::UIDSupportedParamsFetched,
+                            universe_id),
+          &error);
+    } else if (uid_action_pair.second == RESOLVE_DEVICE_INFO) {
+      sent_request = m_rdm_api.GetDeviceInfo(
+          universe_id,
+          uid_action_pair.first,
+          ola::rdm::ROOT_RDM_DEVICE,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::UIDDeviceInfoFetched,
+                            universe_id),
+          &error);
     } else {
       OLA_WARN << "Unknown UID resolve action " <<
         static_cast<int>(uid_action_pair.second);
     }
+
+    if (sent_request) {
+      uid_state->requests_in_flight++;
+    }
+  }
+}
+
+
+/*
+ * @brief Called when a UID resolution request completes.
+ */
+void RDMHTTPModule::ResolveRequestComplete(unsigned int universe_id) {
+  uid_resolution_state *uid_state = GetUniverseUids(universe_id);
+  if (!uid_state) {
+    return;
+  }
+
+  // The state may have been replaced while the request was in flight.
+  if (uid_state->requests_in_flight) {
+    uid_state->requests_in_flight--;
   }
+  ResolveUIDs(universe_id);
 }
 
 /*
@@ -840,7 +914,7 @@ void RDMHTTPModule::UpdateUIDManufacturerLabel(
       uid_iter->second.manufacturer = manufacturer_label;
     }
   }
-  ResolveNextUID(universe);
+  ResolveRequestComplete(universe);
 }
 
 
@@ -865,7 +939,31 @@ void RDMHTTPModule::UpdateUIDDeviceLabel(
       uid_iter->second.device = device_label;
     }
   }
-  ResolveNextUID(universe);
+  ResolveRequestComplete(universe);
+}
+
+
+/*
+ * @brief Handle the SUPPORTED_PARAMETERS response, the reply is now in the
+ *   server's cache.
+ */
+void RDMHTTPModule::UIDSupportedParamsFetched(
+    unsigned int universe,
+    const ola::rdm::ResponseStatus&,
+    const vector<uint16_t>&) {
+  ResolveRequestComplete(universe);
+}
+
+
+/*
+ * @brief Handle the DEVICE_INFO response, the reply is now in the server's
+ *   cache.
+ */
+void RDMHTTPModule::UIDDeviceInfoFetched(
+    unsigned int universe,
+    const ola::rdm::ResponseStatus&,
+    const ola::rdm::DeviceDescriptor&) {
+  ResolveRequestComplete(universe);
 }
 
 
@@ -894,7 +992,7 @@ RDMHTTPModule::uid_resolution_state *RDMHTTPModule::GetUniverseUidsOrCreate(
   if (iter == m_universe_uids.end()) {
     OLA_DEBUG << "Adding a new state entry for " << universe;
     uid_resolution_state *state  = new uid_resolution_state();
-    state->uid_resolution_running = false;
+    state->requests_in_flight = 0;
     state->active = true;
     pair<unsigned int, uid_resolution_state*> p(universe, state);
     iter = m_universe_uids.insert(p).first;
@@ -1005,44 +1103,53 @@ void RDMHTTPModule::SupportedParamsHandler(
  * sections to display in the RDM panel
  */
 void RDMHTTPModule::SupportedSectionsHandler(
-    HTTPResponse *response,
-    unsigned int universe_id,
-    UID uid,
+    supported_sections_state *state,
     const ola::rdm::ResponseStatus &status,
     const vector<uint16_t> &pid_list) {
-  string error;
-
   // nacks here are ok if the device doesn't support SUPPORTED_PARAMS
   if (!CheckForRDMSuccess(status) && !status.WasNacked()) {
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
-    return;
+    state->failed = true;
+  } else {
+    state->pids = pid_list;
   }
-
-  m_rdm_api.GetDeviceInfo(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::SupportedSectionsDeviceInfoHandler,
-                        response,
-                        pid_list),
-      &error);
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+  SendSupportedSections(state);
 }
 
 
 /**
- * @brief Handle the second part of the supported sections request.
+ * @brief Handle the DEVICE_INFO part of the supported sections request.
  */
 void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
-    HTTPResponse *response,
-    const vector<uint16_t> pid_list,
+    supported_sections_state *state,
     const ola::rdm::ResponseStatus &status,
     const ola::rdm::DeviceDescriptor &device) {
+  if (CheckForRDMSuccess(status)) {
+    state->device_ok = true;
+    state->device = device;
+  }
+  SendSupportedSections(state);
+}
+
+
+/**
+ * @brief Build the list of sections once both responses have arrived.
+ */
+void RDMHTTPModule::SendSupportedSections(supported_sections_state *state) {
+  if (--state->outstanding) {
+    return;
+  }
+
+  HTTPResponse *response = state->response;
+  if (state->failed) {
+    delete state;
+    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR);
+    return;
+  }
+
+  const ola::rdm::DeviceDescriptor &device = state->device;
   vector<section_info> sections;
   std::set<uint16_t> pids;
-  copy(pid_list.begin(), pid_list.end(), inserter(pids, pids.end()));
+  copy(state->pids.begin(), state->pids.end(), inserter(pids, pids.end()));
 
   // PID_DEVICE_INFO is required so we always add it
   string hint;
@@ -1161,7 +1268,7 @@ void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
     AddSection(&sections, BOOT_SOFTWARE_SECTION, BOOT_SOFTWARE_SECTION_NAME);
   }
 
-  if (CheckForRDMSuccess(status)) {
+  if (state->device_ok) {
     if (device.dmx_footprint && !dmx_address_added) {
       AddSection(&sections, DMX_ADDRESS_SECTION, DMX_ADDRESS_SECTION_NAME);
     }
@@ -1188,6 +1295,7 @@ void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
     json_obj->Add("name", section_iter->name);
     json_obj->Add("hint",  section_iter->hint);
   }
+  delete state;
 
   response->SetNoCache();
   response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
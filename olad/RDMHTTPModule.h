@@ -83,15 +83,19 @@ class RDMHTTPModule {
       bool active;
     } resolved_uid;
 
+    // The SUPPORTED_PARAMETERS and DEVICE_INFO requests aren't used here,
+    // they fill olad's RDM response cache so the sections load quickly.
     typedef enum {
       RESOLVE_MANUFACTURER,
       RESOLVE_DEVICE,
+      RESOLVE_SUPPORTED_PARAMETERS,
+      RESOLVE_DEVICE_INFO,
     } uid_resolve_action;
 
     typedef struct {
       std::map<ola::rdm::UID, resolved_uid> resolved_uids;
       std::queue<std::pair<ola::rdm::UID, uid_resolve_action> > pending_uids;
-      bool uid_resolution_running;
+      unsigned int requests_in_flight;
       bool active;
     } uid_resolution_state;
 
@@ -116,6 +120,18 @@ class RDMHTTPModule {
       }
     };
 
+    // The SUPPORTED_PARAMETERS and DEVICE_INFO requests for a
+    // supported_sections request are sent together, the response is built
+    // once both have completed.
+    typedef struct {
+      ola::http::HTTPResponse *response;
+      unsigned int outstanding;
+      bool failed;
+      std::vector<uint16_t> pids;
+      bool device_ok;
+      ola::rdm::DeviceDescriptor device;
+    } supported_sections_state;
+
     typedef struct {
       unsigned int universe_id;
       const ola::rdm::UID uid;
@@ -141,7 +157,8 @@ class RDMHTTPModule {
                        const client::Result &result,
                        const ola::rdm::UIDSet &uids);
 
-    void ResolveNextUID(unsigned int universe_id);
+    void ResolveUIDs(unsigned int universe_id);
+    void ResolveRequestComplete(unsigned int universe_id);
 
     void UpdateUIDManufacturerLabel(unsigned int universe,
                                     ola::rdm::UID uid,
@@ -153,6 +170,14 @@ class RDMHTTPModule {
                               const ola::rdm::ResponseStatus &status,
                               const std::string &device_label);
 
+    void UIDSupportedParamsFetched(unsigned int universe,
+                                   const ola::rdm::ResponseStatus &status,
+                                   const std::vector<uint16_t> &pids);
+
+    void UIDDeviceInfoFetched(unsigned int universe,
+                              const ola::rdm::ResponseStatus &status,
+                              const ola::rdm::DeviceDescriptor &device);
+
     uid_resolution_state *GetUniverseUids(unsigned int universe);
     uid_resolution_state *GetUniverseUidsOrCreate(unsigned int universe);
 
@@ -175,16 +200,14 @@ class RDMHTTPModule {
     void SupportedParamsHandler(ola::http::HTTPResponse *response,
                                 const ola::rdm::ResponseStatus &status,
                                 const std::vector<uint16_t> &pids);
-    void SupportedSectionsHandler(ola::http::HTTPResponse *response,
-                                  unsigned int universe,
-                                  ola::rdm::UID uid,
+    void SupportedSectionsHandler(supported_sections_state *state,
                                   const ola::rdm::ResponseStatus &status,
                                   const std::vector<uint16_t> &pids);
     void SupportedSectionsDeviceInfoHandler(
-        ola::http::HTTPResponse *response,
-        const std::vector<uint16_t> pids,
+        supported_sections_state *state,
         const ola::rdm::ResponseStatus &status,
         const ola::rdm::DeviceDescriptor &device);
+    void SendSupportedSections(supported_sections_state *state);
 
     // section methods
     std::string GetCommStatus(ola::http::HTTPResponse *response,
@@ -619,6 +642,10 @@ class RDMHTTPModule {
                     const std::string &hint = "");
 
     static const uint32_t INVALID_PERSONALITY = 0xffff;
+    // The number of UID resolution requests to have in flight for each
+    // universe. olad's RDM scheduler limits what's sent to each port, this
+    // just needs to keep its queue from running dry.
+    static const unsigned int MAX_RESOLVE_REQUESTS = 8;
     static const char BACKEND_DISCONNECTED_ERROR[];
 
     static const char HINT_KEY[];
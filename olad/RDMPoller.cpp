@@ -0,0 +1,405 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPoller.cpp
+ * Polls RDM responders on behalf of clients.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/RDMPoller.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+
+// Polling faster than this would crowd out the interactive requests.
+const unsigned int RDMPoller::MIN_INTERVAL_MS = 1000;
+
+bool RDMPoller::PollItem::operator<(const PollItem &other) const {
+  if (sub_device != other.sub_device) {
+    return sub_device < other.sub_device;
+  }
+  if (pid != other.pid) {
+    return pid < other.pid;
+  }
+  return data < other.data;
+}
+
+bool RDMPoller::PollItem::operator==(const PollItem &other) const {
+  return (sub_device == other.sub_device && pid == other.pid &&
+          data == other.data);
+}
+
+RDMPoller::RDMPoller(UniverseStore *universe_store,
+                     ola::thread::SchedulerInterface *scheduler,
+                     const UID &source_uid)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_source_uid(source_uid),
+      m_next_state_id(0),
+      m_deferred(false) {
+}
+
+RDMPoller::~RDMPoller() {
+  while (!m_universes.empty()) {
+    RemoveUniverse(m_universes.begin());
+  }
+}
+
+bool RDMPoller::Subscribe(Client *client,
+                          unsigned int universe_id,
+                          const TimeInterval &interval,
+                          const PollItems &items) {
+  if (items.empty() || !m_universe_store->GetUniverse(universe_id)) {
+    return false;
+  }
+
+  const TimeInterval min_interval(
+      static_cast<int64_t>(MIN_INTERVAL_MS) * ONE_THOUSAND);
+
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  const bool new_universe = (state == NULL);
+  if (new_universe) {
+    state = new UniverseState();
+    state->id = m_next_state_id++;
+    m_universes[universe_id] = state;
+  }
+
+  Subscription &subscription = state->subscribers[client];
+  subscription.interval = interval < min_interval ? min_interval : interval;
+  subscription.items = items;
+
+  const PollItems old_items = state->items;
+  UpdateUniverse(universe_id, state);
+  SendCachedResults(client, *state, items);
+
+  if (new_universe || state->items != old_items) {
+    // Don't make the subscriber wait for the next cycle to see new items.
+    StartCycle(universe_id);
+  }
+  return true;
+}
+
+void RDMPoller::Unsubscribe(Client *client, unsigned int universe_id) {
+  UniverseMap::iterator iter = m_universes.find(universe_id);
+  if (iter == m_universes.end() ||
+      !iter->second->subscribers.erase(client)) {
+    return;
+  }
+
+  if (iter->second->subscribers.empty()) {
+    RemoveUniverse(iter);
+  } else {
+    UpdateUniverse(universe_id, iter->second);
+  }
+}
+
+void RDMPoller::RemoveClient(const Client *client) {
+  UniverseMap::iterator iter = m_universes.begin();
+  while (iter != m_universes.end()) {
+    UniverseState *state = iter->second;
+    SubscriberMap::iterator sub_iter = state->subscribers.begin();
+    bool removed = false;
+    while (sub_iter != state->subscribers.end()) {
+      if (sub_iter->first == client) {
+        state->subscribers.erase(sub_iter++);
+        removed = true;
+      } else {
+        ++sub_iter;
+      }
+    }
+
+    if (state->subscribers.empty()) {
+      RemoveUniverse(iter++);
+    } else {
+      if (removed) {
+        UpdateUniverse(iter->first, state);
+      }
+      ++iter;
+    }
+  }
+}
+
+bool RDMPoller::StartCycle(unsigned int universe_id) {
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (!state) {
+    return false;
+  }
+
+  if (state->in_flight || !state->pending.empty()) {
+    OLA_DEBUG << "Previous RDM poll cycle for universe " << universe_id
+              << " is still running, skipping this one";
+    return false;
+  }
+
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (!universe) {
+    return false;
+  }
+
+  UIDSet uids;
+  universe->GetUIDs(&uids);
+
+  // Forget the results for responders that have gone away.
+  ResultMap::iterator result_iter = state->results.begin();
+  while (result_iter != state->results.end()) {
+    if (uids.Contains(result_iter->first.first)) {
+      ++result_iter;
+    } else {
+      state->results.erase(result_iter++);
+    }
+  }
+
+  for (UIDSet::Iterator uid_iter = uids.Begin(); uid_iter != uids.End();
+       ++uid_iter) {
+    PollItems::const_iterator item_iter = state->items.begin();
+    for (; item_iter != state->items.end(); ++item_iter) {
+      state->pending.push_back(ResultKey(*uid_iter, *item_iter));
+    }
+  }
+
+  SendNextRequest(universe_id, state);
+  return true;
+}
+
+/*
+ * Recalculate the items and interval for a universe after the subscribers
+ * change.
+ */
+void RDMPoller::UpdateUniverse(unsigned int universe_id,
+                               UniverseState *state) {
+  PollItems items;
+  TimeInterval interval;
+  SubscriberMap::const_iterator iter = state->subscribers.begin();
+  for (; iter != state->subscribers.end(); ++iter) {
+    items.insert(iter->second.items.begin(), iter->second.items.end());
+    if (iter == state->subscribers.begin() ||
+        iter->second.interval < interval) {
+      interval = iter->second.interval;
+    }
+  }
+  state->items = items;
+
+  // Drop anything for items that no one wants any more.
+  ResultMap::iterator result_iter = state->results.begin();
+  while (result_iter != state->results.end()) {
+    if (STLContains(items, result_iter->first.second)) {
+      ++result_iter;
+    } else {
+      state->results.erase(result_iter++);
+    }
+  }
+
+  std::deque<ResultKey>::iterator pending_iter = state->pending.begin();
+  while (pending_iter != state->pending.end()) {
+    if (STLContains(items, pending_iter->second)) {
+      ++pending_iter;
+    } else {
+      pending_iter = state->pending.erase(pending_iter);
+    }
+  }
+
+  if (state->cycle_timeout != ola::thread::INVALID_TIMEOUT &&
+      interval == state->interval) {
+    return;
+  }
+
+  if (state->cycle_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->cycle_timeout);
+  }
+  state->interval = interval;
+  state->cycle_timeout = m_scheduler->RegisterRepeatingTimeout(
+      interval, NewCallback(this, &RDMPoller::RunCycle, universe_id));
+}
+
+void RDMPoller::RemoveUniverse(UniverseMap::iterator iter) {
+  UniverseState *state = iter->second;
+  if (state->cycle_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->cycle_timeout);
+  }
+  // A request still in flight is ignored when it completes, since the state
+  // id won't match.
+  delete state;
+  m_universes.erase(iter);
+}
+
+bool RDMPoller::RunCycle(unsigned int universe_id) {
+  if (!m_deferred) {
+    StartCycle(universe_id);
+  }
+  return true;
+}
+
+/*
+ * Send the next request in the cycle. This loops rather than recursing, since
+ * requests to a port without RDM support complete straight away.
+ */
+void RDMPoller::SendNextRequest(unsigned int universe_id,
+                                UniverseState *state) {
+  if (state->sending) {
+    return;
+  }
+
+  const unsigned int state_id = state->id;
+  state->sending = true;
+  while (!state->in_flight && !state->pending.empty()) {
+    Universe *universe = m_universe_store->GetUniverse(universe_id);
+    if (!universe) {
+      state->pending.clear();
+      break;
+    }
+
+    const ResultKey key = state->pending.front();
+    state->pending.pop_front();
+
+    const PollItem &item = key.second;
+    RDMGetRequest *request = new RDMGetRequest(
+        m_source_uid,
+        key.first,
+        0,  // transaction #
+        1,  // port id
+        item.sub_device,
+        item.pid,
+        reinterpret_cast<const uint8_t*>(item.data.data()),
+        item.data.size());
+
+    state->in_flight = true;
+    universe->SendRDMRequest(
+        request,
+        NewSingleCallback(this, &RDMPoller::RequestComplete, universe_id,
+                          state_id, key));
+
+    // Publishing the result can't change the subscriptions, but be careful
+    // anyway.
+    state = STLFindOrNull(m_universes, universe_id);
+    if (!state || state->id != state_id) {
+      return;
+    }
+  }
+  state->sending = false;
+}
+
+void RDMPoller::RequestComplete(unsigned int universe_id,
+                                unsigned int state_id,
+                                ResultKey key,
+                                RDMReply *reply) {
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (!state || state->id != state_id) {
+    return;
+  }
+  state->in_flight = false;
+
+  const RDMResponse *response = reply->Response();
+  const bool ack_timer = (
+      reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK && response &&
+      response->ResponseType() == ola::rdm::RDM_ACK_TIMER);
+
+  // An ACK_TIMER means the data isn't ready yet, it'll be picked up next
+  // cycle.
+  if (!ack_timer && STLContains(state->items, key.second)) {
+    ola::proto::RDMPollResult result;
+    FillResult(universe_id, key, *reply, &result);
+
+    ResultMap::iterator iter = state->results.find(key);
+    if (iter == state->results.end() || ResultChanged(iter->second, result)) {
+      state->results[key] = result;
+
+      SubscriberMap::iterator sub_iter = state->subscribers.begin();
+      for (; sub_iter != state->subscribers.end(); ++sub_iter) {
+        if (STLContains(sub_iter->second.items, key.second)) {
+          sub_iter->first->SendRDMPollResult(result);
+        }
+      }
+    }
+  }
+
+  SendNextRequest(universe_id, state);
+}
+
+void RDMPoller::SendCachedResults(Client *client,
+                                  const UniverseState &state,
+                                  const PollItems &items) {
+  ResultMap::const_iterator iter = state.results.begin();
+  for (; iter != state.results.end(); ++iter) {
+    if (STLContains(items, iter->first.second)) {
+      client->SendRDMPollResult(iter->second);
+    }
+  }
+}
+
+void RDMPoller::FillResult(unsigned int universe_id,
+                           const ResultKey &key,
+                           const RDMReply &reply,
+                           ola::proto::RDMPollResult *result) {
+  result->set_universe(universe_id);
+  result->mutable_uid()->set_esta_id(key.first.ManufacturerId());
+  result->mutable_uid()->set_device_id(key.first.DeviceId());
+
+  ola::proto::RDMPollItem *item = result->mutable_item();
+  item->set_param_id(key.second.pid);
+  item->set_sub_device(key.second.sub_device);
+  item->set_data(key.second.data);
+
+  result->set_response_code(
+      static_cast<ola::proto::RDMResponseCode>(reply.StatusCode()));
+
+  if (reply.StatusCode() != ola::rdm::RDM_COMPLETED_OK) {
+    return;
+  }
+
+  const RDMResponse *response = reply.Response();
+  if (!response || response->ResponseType() > ola::rdm::RDM_NACK_REASON) {
+    result->set_response_code(static_cast<ola::proto::RDMResponseCode>(
+        ola::rdm::RDM_INVALID_RESPONSE));
+    return;
+  }
+
+  result->set_response_type(
+      static_cast<ola::proto::RDMResponseType>(response->ResponseType()));
+  if (response->ParamData() && response->ParamDataSize()) {
+    result->set_data(
+        reinterpret_cast<const char*>(response->ParamData()),
+        response->ParamDataSize());
+  }
+}
+
+bool RDMPoller::ResultChanged(const ola::proto::RDMPollResult &old_result,
+                              const ola::proto::RDMPollResult &new_result) {
+  return (old_result.response_code() != new_result.response_code() ||
+          old_result.response_type() != new_result.response_type() ||
+          old_result.data() != new_result.data());
+}
+}  // namespace ola
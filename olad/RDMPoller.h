@@ -0,0 +1,211 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPoller.h
+ * Polls RDM responders on behalf of clients.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_RDMPOLLER_H_
+#define OLAD_RDMPOLLER_H_
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include "common/protocol/Ola.pb.h"
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class Client;
+class UniverseStore;
+
+/**
+ * @brief Polls PIDs from the responders in a universe, and sends the changes
+ * to the clients that asked for them.
+ *
+ * Monitoring clients used to poll SENSOR_VALUE, STATUS_MESSAGES and the like
+ * from every responder themselves, so N clients cost N times the RDM traffic.
+ * Instead a client subscribes to a set of items for a universe, and the
+ * poller polls the union of the items from all the subscribers, at the
+ * shortest of their intervals.
+ *
+ * Each universe has at most one poll request in flight, so polling only uses
+ * the gaps between the interactive requests the universe's RDMScheduler
+ * sends first. If a cycle hasn't finished when the next one is due, the next
+ * one is skipped.
+ *
+ * The latest result for each responder and item is cached. A client is sent
+ * the cached results when it subscribes, and then each result that changes.
+ */
+class RDMPoller {
+ public:
+  /**
+   * @brief Something to GET from each responder.
+   */
+  struct PollItem {
+    PollItem() : sub_device(0), pid(0) {}
+
+    PollItem(uint16_t sub_device, uint16_t pid,
+             const std::string &data = "")
+        : sub_device(sub_device),
+          pid(pid),
+          data(data) {
+    }
+
+    uint16_t sub_device;
+    uint16_t pid;
+    std::string data;  // the param data sent with the GET
+
+    bool operator<(const PollItem &other) const;
+    bool operator==(const PollItem &other) const;
+  };
+
+  typedef std::set<PollItem> PollItems;
+
+  /**
+   * @brief Create a new RDMPoller.
+   * @param universe_store the UniverseStore to look universes up in.
+   * @param scheduler the scheduler to run the poll cycles on.
+   * @param source_uid the UID to send the poll requests from.
+   */
+  RDMPoller(UniverseStore *universe_store,
+            ola::thread::SchedulerInterface *scheduler,
+            const ola::rdm::UID &source_uid);
+  ~RDMPoller();
+
+  /**
+   * @brief Add or replace a client's subscription to a universe.
+   * @param client the client to send the results to.
+   * @param universe_id the universe to poll.
+   * @param interval the time between the start of each poll cycle, this is
+   *   raised to MIN_INTERVAL_MS if it's smaller.
+   * @param items the items to poll.
+   * @returns false if the universe doesn't exist or items is empty.
+   */
+  bool Subscribe(Client *client,
+                 unsigned int universe_id,
+                 const TimeInterval &interval,
+                 const PollItems &items);
+
+  /**
+   * @brief Remove a client's subscription to a universe.
+   */
+  void Unsubscribe(Client *client, unsigned int universe_id);
+
+  /**
+   * @brief Remove all the subscriptions for a client.
+   */
+  void RemoveClient(const Client *client);
+
+  /**
+   * @brief Start a poll cycle for a universe now.
+   * @returns false if the universe isn't being polled, or the previous cycle
+   *   hasn't finished.
+   */
+  bool StartCycle(unsigned int universe_id);
+
+  /**
+   * @brief Skip the scheduled poll cycles, this is used to shed load when
+   *   olad is overloaded.
+   * @param deferred true to skip the cycles, false to resume polling.
+   *
+   * Cycles already in progress finish, and StartCycle() still works.
+   */
+  void SetDeferred(bool deferred) { m_deferred = deferred; }
+
+  /**
+   * @brief Check if the scheduled poll cycles are being skipped.
+   */
+  bool Deferred() const { return m_deferred; }
+
+  /**
+   * @brief The number of universes being polled.
+   */
+  unsigned int PolledUniverses() const {
+    return static_cast<unsigned int>(m_universes.size());
+  }
+
+  static const unsigned int MIN_INTERVAL_MS;
+
+ private:
+  typedef std::pair<ola::rdm::UID, PollItem> ResultKey;
+  typedef std::map<ResultKey, ola::proto::RDMPollResult> ResultMap;
+
+  struct Subscription {
+    TimeInterval interval;
+    PollItems items;
+  };
+
+  typedef std::map<Client*, Subscription> SubscriberMap;
+
+  struct UniverseState {
+    UniverseState()
+        : id(0),
+          in_flight(false),
+          sending(false),
+          cycle_timeout(ola::thread::INVALID_TIMEOUT) {
+    }
+
+    unsigned int id;  // unique for each UniverseState
+    SubscriberMap subscribers;
+    // The union of the subscribers' items, and the shortest interval.
+    PollItems items;
+    TimeInterval interval;
+    // The requests left in the current cycle.
+    std::deque<ResultKey> pending;
+    bool in_flight;
+    bool sending;  // true while SendNextRequest is running
+    ola::thread::timeout_id cycle_timeout;
+    ResultMap results;
+  };
+
+  typedef std::map<unsigned int, UniverseState*> UniverseMap;
+
+  UniverseStore *m_universe_store;
+  ola::thread::SchedulerInterface *m_scheduler;
+  const ola::rdm::UID m_source_uid;
+  UniverseMap m_universes;
+  unsigned int m_next_state_id;
+  bool m_deferred;
+
+  void UpdateUniverse(unsigned int universe_id, UniverseState *state);
+  void RemoveUniverse(UniverseMap::iterator iter);
+  bool RunCycle(unsigned int universe_id);
+  void SendNextRequest(unsigned int universe_id, UniverseState *state);
+  void RequestComplete(unsigned int universe_id,
+                       unsigned int state_id,
+                       ResultKey key,
+                       ola::rdm::RDMReply *reply);
+  void SendCachedResults(Client *client, const UniverseState &state,
+                         const PollItems &items);
+
+  static void FillResult(unsigned int universe_id, const ResultKey &key,
+                         const ola::rdm::RDMReply &reply,
+                         ola::proto::RDMPollResult *result);
+  static bool ResultChanged(const ola::proto::RDMPollResult &old_result,
+                            const ola::proto::RDMPollResult &new_result);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMPoller);
+};
+}  // namespace ola
+#endif  // OLAD_RDMPOLLER_H_
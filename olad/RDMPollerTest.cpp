@@ -0,0 +1,284 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMPollerTest.cpp
+ * Test fixture for the RDMPoller class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/RDMPoller.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Client;
+using ola::NewCallback;
+using ola::RDMPoller;
+using ola::TimeInterval;
+using ola::Universe;
+using ola::UniverseStore;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::deque;
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+class MockClient: public Client {
+ public:
+  MockClient() : Client(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 0)) {}
+
+  bool SendRDMPollResult(const ola::proto::RDMPollResult &result) {
+    results.push_back(result);
+    return true;
+  }
+
+  vector<ola::proto::RDMPollResult> results;
+};
+}  // namespace
+
+class RDMPollerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMPollerTest);
+  CPPUNIT_TEST(testPublishChanges);
+  CPPUNIT_TEST(testSkipBusyCycle);
+  CPPUNIT_TEST(testRemoveClient);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMPollerTest()
+      : m_source(ola::OPEN_LIGHTING_ESTA_CODE, 0),
+        m_uid1(0x7a70, 1),
+        m_uid2(0x7a70, 2) {
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+    m_store.reset(new UniverseStore(NULL, &m_export_map));
+    m_poller.reset(new RDMPoller(m_store.get(), &m_ss, m_source));
+    m_uids.AddUID(m_uid1);
+    m_uids.AddUID(m_uid2);
+    m_values.clear();
+  }
+
+  void tearDown() {
+    m_poller.reset();
+    m_store->DeleteAll();
+    m_store.reset();
+  }
+
+  void testPublishChanges();
+  void testSkipBusyCycle();
+  void testRemoveClient();
+
+ private:
+  typedef deque<RDMCallback*> HeldRequests;
+
+  const UID m_source;
+  const UID m_uid1;
+  const UID m_uid2;
+  UIDSet m_uids;
+  ola::ExportMap m_export_map;
+  ola::io::SelectServer m_ss;
+  std::auto_ptr<UniverseStore> m_store;
+  std::auto_ptr<RDMPoller> m_poller;
+  map<UID, string> m_values;
+
+  RDMPoller::PollItems SensorItems() {
+    RDMPoller::PollItems items;
+    items.insert(RDMPoller::PollItem(0, ola::rdm::PID_SENSOR_VALUE,
+                                     string(1, '\0')));
+    return items;
+  }
+
+  // Respond straight away with the value for the responder.
+  void Respond(const RDMRequest *request, RDMCallback *callback) {
+    const string &value = m_values[request->DestinationUID()];
+    RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                   ola::rdm::GetResponseFromData(
+                       request,
+                       reinterpret_cast<const uint8_t*>(value.data()),
+                       value.size()));
+    delete request;
+    callback->Run(&reply);
+  }
+
+  void Hold(HeldRequests *held, const RDMRequest *request,
+            RDMCallback *callback) {
+    held->push_back(callback);
+    delete request;
+  }
+
+  void CompleteNext(HeldRequests *held) {
+    OLA_ASSERT_FALSE(held->empty());
+    RDMCallback *callback = held->front();
+    held->pop_front();
+    RDMReply reply(ola::rdm::RDM_TIMEOUT);
+    callback->Run(&reply);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMPollerTest);
+
+/*
+ * Check that results are cached, and only the changes are sent.
+ */
+void RDMPollerTest::testPublishChanges() {
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true,
+                             NewCallback(this, &RDMPollerTest::Respond));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  m_values[m_uid1] = "a";
+  m_values[m_uid2] = "b";
+
+  MockClient client1;
+  OLA_ASSERT_TRUE(m_poller->Subscribe(&client1, 1, TimeInterval(1, 0),
+                                      SensorItems()));
+  OLA_ASSERT_EQ(1u, m_poller->PolledUniverses());
+
+  // Subscribing starts a cycle, which gets a result from each responder.
+  OLA_ASSERT_EQ(static_cast<size_t>(2), client1.results.size());
+  const ola::proto::RDMPollResult &result = client1.results[0];
+  OLA_ASSERT_EQ(1, result.universe());
+  OLA_ASSERT_EQ(static_cast<int>(ola::rdm::PID_SENSOR_VALUE),
+                result.item().param_id());
+  OLA_ASSERT_EQ(ola::proto::RDM_COMPLETED_OK, result.response_code());
+  OLA_ASSERT_EQ(ola::proto::RDM_ACK, result.response_type());
+  OLA_ASSERT_EQ(string("a"), result.data());
+
+  // Nothing has changed, so nothing is sent.
+  client1.results.clear();
+  OLA_ASSERT_TRUE(m_poller->StartCycle(1));
+  OLA_ASSERT_TRUE(client1.results.empty());
+
+  m_values[m_uid2] = "c";
+  OLA_ASSERT_TRUE(m_poller->StartCycle(1));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client1.results.size());
+  OLA_ASSERT_EQ(static_cast<int>(m_uid2.DeviceId()),
+                static_cast<int>(client1.results[0].uid().device_id()));
+  OLA_ASSERT_EQ(string("c"), client1.results[0].data());
+
+  // A new subscriber gets the cached results straight away.
+  MockClient client2;
+  OLA_ASSERT_TRUE(m_poller->Subscribe(&client2, 1, TimeInterval(5, 0),
+                                      SensorItems()));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), client2.results.size());
+
+  // Universes which don't exist can't be polled, and neither can nothing.
+  OLA_ASSERT_FALSE(m_poller->Subscribe(&client1, 2, TimeInterval(1, 0),
+                                       SensorItems()));
+  OLA_ASSERT_FALSE(m_poller->Subscribe(&client1, 1, TimeInterval(1, 0),
+                                       RDMPoller::PollItems()));
+
+  m_poller->Unsubscribe(&client1, 1);
+  OLA_ASSERT_EQ(1u, m_poller->PolledUniverses());
+  m_poller->Unsubscribe(&client2, 1);
+  OLA_ASSERT_EQ(0u, m_poller->PolledUniverses());
+  OLA_ASSERT_FALSE(m_poller->StartCycle(1));
+
+  universe->RemovePort(&port);
+}
+
+/*
+ * Check only one request is in flight, and a cycle is skipped if the last one
+ * hasn't finished.
+ */
+void RDMPollerTest::testSkipBusyCycle() {
+  HeldRequests held;
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true,
+                             NewCallback(this, &RDMPollerTest::Hold, &held));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  MockClient client;
+  OLA_ASSERT_TRUE(m_poller->Subscribe(&client, 1, TimeInterval(1, 0),
+                                      SensorItems()));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), held.size());
+  OLA_ASSERT_FALSE(m_poller->StartCycle(1));
+
+  CompleteNext(&held);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), held.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), client.results.size());
+  OLA_ASSERT_EQ(ola::proto::RDM_TIMEOUT, client.results[0].response_code());
+  OLA_ASSERT_FALSE(m_poller->StartCycle(1));
+
+  CompleteNext(&held);
+  OLA_ASSERT_TRUE(held.empty());
+  OLA_ASSERT_EQ(static_cast<size_t>(2), client.results.size());
+
+  // The cycle is over, so the next one can start.
+  OLA_ASSERT_TRUE(m_poller->StartCycle(1));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), held.size());
+  CompleteNext(&held);
+  CompleteNext(&held);
+  // The timeouts haven't changed.
+  OLA_ASSERT_EQ(static_cast<size_t>(2), client.results.size());
+
+  universe->RemovePort(&port);
+}
+
+/*
+ * Check a request that completes after the client has gone is ignored.
+ */
+void RDMPollerTest::testRemoveClient() {
+  HeldRequests held;
+  Universe *universe = m_store->GetUniverseOrCreate(1);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true,
+                             NewCallback(this, &RDMPollerTest::Hold, &held));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  std::auto_ptr<MockClient> client(new MockClient());
+  OLA_ASSERT_TRUE(m_poller->Subscribe(client.get(), 1, TimeInterval(1, 0),
+                                      SensorItems()));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), held.size());
+
+  m_poller->RemoveClient(client.get());
+  client.reset();
+  OLA_ASSERT_EQ(0u, m_poller->PolledUniverses());
+
+  CompleteNext(&held);
+  OLA_ASSERT_TRUE(held.empty());
+
+  universe->RemovePort(&port);
+}
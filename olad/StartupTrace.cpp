@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * StartupTrace.cpp
+ * Records how long each phase of olad's startup takes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/StartupTrace.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonWriter.h"
+
+namespace ola {
+
+using ola::thread::MutexLocker;
+using ola::thread::ThreadId;
+using ola::web::JsonArray;
+using ola::web::JsonInt64;
+using ola::web::JsonObject;
+using ola::web::JsonWriter;
+using std::string;
+using std::vector;
+
+StartupTrace::Span::Span(StartupTrace *trace, const string &name,
+                         const string &category)
+    : m_trace(trace),
+      m_name(name),
+      m_category(category) {
+  if (m_trace) {
+    m_trace->GetClock()->CurrentTime(&m_start);
+  }
+}
+
+StartupTrace::Span::~Span() {
+  End();
+}
+
+void StartupTrace::Span::End() {
+  if (m_trace) {
+    TimeStamp end;
+    m_trace->GetClock()->CurrentTime(&end);
+    m_trace->AddSpan(m_name, m_category, m_start, end);
+    m_trace = NULL;
+  }
+}
+
+StartupTrace::StartupTrace(const Clock *clock)
+    : m_clock(clock ? clock : &m_real_clock) {
+  m_clock->CurrentTime(&m_created);
+  // The thread that creates the trace gets the first track.
+  m_threads.push_back(ola::thread::Thread::Self());
+}
+
+void StartupTrace::AddSpan(const string &name, const string &category,
+                           const TimeStamp &start, const TimeStamp &end) {
+  MutexLocker locker(&m_mutex);
+  SpanRecord span;
+  span.name = name;
+  span.category = category;
+  span.start = start;
+  span.end = end;
+  span.thread = ThreadIndex(ola::thread::Thread::Self());
+  m_spans.push_back(span);
+}
+
+unsigned int StartupTrace::SpanCount() const {
+  MutexLocker locker(&m_mutex);
+  return m_spans.size();
+}
+
+string StartupTrace::ChromeTrace() const {
+  MutexLocker locker(&m_mutex);
+  JsonObject trace;
+  trace.Add("displayTimeUnit", "ms");
+  JsonArray *events = trace.AddArray("traceEvents");
+
+  for (unsigned int i = 0; i < m_threads.size(); i++) {
+    JsonObject *event = events->AppendObject();
+    event->Add("name", "thread_name");
+    event->Add("ph", "M");
+    event->Add("pid", 1);
+    event->Add("tid", i);
+    JsonObject *args = event->AddObject("args");
+    args->Add("name", i ? "thread-" + IntToString(i) : string("main"));
+  }
+
+  vector<SpanRecord>::const_iterator iter = m_spans.begin();
+  for (; iter != m_spans.end(); ++iter) {
+    JsonObject *event = events->AppendObject();
+    event->Add("name", iter->name);
+    event->Add("cat", iter->category);
+    event->Add("ph", "X");
+    event->AddValue("ts", new JsonInt64(Offset(iter->start)));
+    event->AddValue("dur", new JsonInt64((iter->end - iter->start).AsInt()));
+    event->Add("pid", 1);
+    event->Add("tid", iter->thread);
+  }
+  return JsonWriter::AsString(trace);
+}
+
+bool StartupTrace::WriteChromeTrace(const string &path) const {
+  std::ofstream file(path.c_str());
+  if (!file.is_open()) {
+    OLA_WARN << "Failed to open " << path << " to write the startup trace";
+    return false;
+  }
+  file << ChromeTrace() << std::endl;
+  file.close();
+  if (file.fail()) {
+    OLA_WARN << "Failed to write the startup trace to " << path;
+    return false;
+  }
+  return true;
+}
+
+namespace {
+// Orders spans by start time, with enclosing spans before the spans in them.
+struct SpanStart {
+  template <typename T>
+  bool operator()(const T &left, const T &right) const {
+    if (left.start == right.start) {
+      return right.end < left.end;
+    }
+    return left.start < right.start;
+  }
+};
+}  // namespace
+
+void StartupTrace::LogSummary() const {
+  vector<SpanRecord> spans;
+  {
+    MutexLocker locker(&m_mutex);
+    spans = m_spans;
+  }
+  std::stable_sort(spans.begin(), spans.end(), SpanStart());
+
+  TimeStamp last_end = m_created;
+  vector<SpanRecord>::const_iterator iter = spans.begin();
+  for (; iter != spans.end(); ++iter) {
+    last_end = std::max(last_end, iter->end);
+  }
+
+  OLA_INFO << "Startup took " << FormatMilliseconds(Offset(last_end))
+           << " ms:";
+  for (iter = spans.begin(); iter != spans.end(); ++iter) {
+    OLA_INFO << "  " << iter->category << " " << iter->name << ": "
+             << FormatMilliseconds((iter->end - iter->start).AsInt())
+             << " ms, at " << FormatMilliseconds(Offset(iter->start))
+             << " ms";
+  }
+}
+
+unsigned int StartupTrace::ThreadIndex(ThreadId thread) {
+  for (unsigned int i = 0; i < m_threads.size(); i++) {
+    if (pthread_equal(m_threads[i], thread)) {
+      return i;
+    }
+  }
+  m_threads.push_back(thread);
+  return m_threads.size() - 1;
+}
+
+int64_t StartupTrace::Offset(const TimeStamp &time) const {
+  return (time - m_created).AsInt();
+}
+
+string StartupTrace::FormatMilliseconds(int64_t microseconds) {
+  std::ostringstream str;
+  str << microseconds / 1000 << "." << (microseconds % 1000) / 100;
+  return str.str();
+}
+}  // namespace ola
@@ -0,0 +1,139 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * StartupTrace.h
+ * Records how long each phase of olad's startup takes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_STARTUPTRACE_H_
+#define OLAD_STARTUPTRACE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+
+namespace ola {
+
+/**
+ * @brief Records a timed span for each phase of olad's startup.
+ *
+ * The spans can be written as a Chrome trace event file, which can be loaded
+ * into chrome://tracing or Perfetto, and summarized in the log.
+ *
+ * Spans can be added from any thread, e.g. by plugins preparing off the main
+ * thread, and each thread gets its own track in the trace.
+ */
+class StartupTrace {
+ public:
+  /**
+   * @brief Records a span from construction until destruction.
+   *
+   * The trace may be NULL, in which case nothing is recorded, so callers
+   * don't need to check if tracing is enabled.
+   */
+  class Span {
+   public:
+    Span(StartupTrace *trace, const std::string &name,
+         const std::string &category);
+    ~Span();
+
+    /**
+     * @brief End the span before it's destroyed.
+     */
+    void End();
+
+   private:
+    StartupTrace *m_trace;
+    const std::string m_name;
+    const std::string m_category;
+    TimeStamp m_start;
+
+    DISALLOW_COPY_AND_ASSIGN(Span);
+  };
+
+  /**
+   * @brief Create a new StartupTrace.
+   * @param clock the clock to use, ownership isn't transferred. If NULL the
+   *   real time clock is used.
+   */
+  explicit StartupTrace(const Clock *clock = NULL);
+
+  /**
+   * @brief Record a span.
+   * @param name the name of the span, e.g. the plugin name.
+   * @param category the kind of span, e.g. "plugin-start".
+   * @param start the time the span started.
+   * @param end the time the span ended.
+   */
+  void AddSpan(const std::string &name, const std::string &category,
+               const TimeStamp &start, const TimeStamp &end);
+
+  /**
+   * @brief The number of spans recorded.
+   */
+  unsigned int SpanCount() const;
+
+  /**
+   * @brief Return the spans in the Chrome trace event format.
+   */
+  std::string ChromeTrace() const;
+
+  /**
+   * @brief Write the spans to a file in the Chrome trace event format.
+   * @param path the file to write.
+   * @returns true if the file was written.
+   */
+  bool WriteChromeTrace(const std::string &path) const;
+
+  /**
+   * @brief Log the total startup time, and the spans in the order they
+   *   started with the time each took.
+   */
+  void LogSummary() const;
+
+  const Clock *GetClock() const { return m_clock; }
+
+ private:
+  struct SpanRecord {
+    std::string name;
+    std::string category;
+    TimeStamp start;
+    TimeStamp end;
+    unsigned int thread;
+  };
+
+  Clock m_real_clock;
+  const Clock *m_clock;
+  TimeStamp m_created;
+  std::vector<SpanRecord> m_spans;
+  // The threads that have added spans, the index is the thread's track.
+  std::vector<ola::thread::ThreadId> m_threads;
+  mutable ola::thread::Mutex m_mutex;
+
+  unsigned int ThreadIndex(ola::thread::ThreadId thread);
+  int64_t Offset(const TimeStamp &time) const;
+
+  static std::string FormatMilliseconds(int64_t microseconds);
+
+  DISALLOW_COPY_AND_ASSIGN(StartupTrace);
+};
+}  // namespace ola
+#endif  // OLAD_STARTUPTRACE_H_
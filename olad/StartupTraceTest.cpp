@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * StartupTraceTest.cpp
+ * Test fixture for the StartupTrace class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
+#include "ola/web/Json.h"
+#include "ola/web/JsonParser.h"
+#include "ola/web/JsonPointer.h"
+#include "ola/web/JsonWriter.h"
+#include "olad/StartupTrace.h"
+
+using ola::MockClock;
+using ola::StartupTrace;
+using ola::web::JsonParser;
+using ola::web::JsonPointer;
+using ola::web::JsonValue;
+using ola::web::JsonWriter;
+using std::auto_ptr;
+using std::string;
+
+class StartupTraceTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(StartupTraceTest);
+  CPPUNIT_TEST(testSpans);
+  CPPUNIT_TEST(testNullTrace);
+  CPPUNIT_TEST(testChromeTrace);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testSpans();
+  void testNullTrace();
+  void testChromeTrace();
+
+ private:
+  static const unsigned int SLACK_US = 100000;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StartupTraceTest);
+
+namespace {
+/*
+ * Adds a span from another thread.
+ */
+class SpanThread: public ola::thread::Thread {
+ public:
+  explicit SpanThread(StartupTrace *trace) : m_trace(trace) {}
+
+  void *Run() {
+    StartupTrace::Span span(m_trace, "artnet", "plugin-prepare");
+    return NULL;
+  }
+
+ private:
+  StartupTrace *m_trace;
+};
+
+string Lookup(JsonValue *value, const string &path) {
+  const JsonValue *element = value->LookupElement(JsonPointer(path));
+  return element ? JsonWriter::AsString(*element) : "";
+}
+
+unsigned int LookupUInt(JsonValue *value, const string &path) {
+  unsigned int i = 0;
+  ola::StringToInt(Lookup(value, path), &i);
+  return i;
+}
+}  // namespace
+
+
+/*
+ * Check spans are recorded when they end.
+ */
+void StartupTraceTest::testSpans() {
+  MockClock clock;
+  StartupTrace trace(&clock);
+
+  {
+    StartupTrace::Span outer(&trace, "init", "olad");
+    StartupTrace::Span inner(&trace, "pid-store", "olad");
+    clock.AdvanceTime(0, 5000);
+    inner.End();
+    OLA_ASSERT_EQ(1u, trace.SpanCount());
+
+    // Ending a span twice only records it once.
+    inner.End();
+    OLA_ASSERT_EQ(1u, trace.SpanCount());
+    clock.AdvanceTime(0, 1000);
+  }
+  OLA_ASSERT_EQ(2u, trace.SpanCount());
+  trace.LogSummary();
+}
+
+
+/*
+ * Check a span with no trace does nothing.
+ */
+void StartupTraceTest::testNullTrace() {
+  StartupTrace::Span span(NULL, "init", "olad");
+  span.End();
+}
+
+
+/*
+ * Check the Chrome trace output.
+ */
+void StartupTraceTest::testChromeTrace() {
+  MockClock clock;
+  StartupTrace trace(&clock);
+
+  clock.AdvanceTime(0, 2000);
+  {
+    StartupTrace::Span span(&trace, "pid-store", "olad");
+    clock.AdvanceTime(0, 1500);
+  }
+
+  SpanThread thread(&trace);
+  OLA_ASSERT_TRUE(thread.Start());
+  thread.Join();
+  OLA_ASSERT_EQ(2u, trace.SpanCount());
+
+  string error;
+  auto_ptr<JsonValue> value(JsonParser::Parse(trace.ChromeTrace(), &error));
+  OLA_ASSERT_NOT_NULL(value.get());
+
+  // The two threads are named first, then the spans follow.
+  OLA_ASSERT_EQ(string("\"thread_name\""),
+                Lookup(value.get(), "/traceEvents/0/name"));
+  OLA_ASSERT_EQ(string("\"main\""),
+                Lookup(value.get(), "/traceEvents/0/args/name"));
+  OLA_ASSERT_EQ(string("\"thread-1\""),
+                Lookup(value.get(), "/traceEvents/1/args/name"));
+
+  OLA_ASSERT_EQ(string("\"pid-store\""),
+                Lookup(value.get(), "/traceEvents/2/name"));
+  OLA_ASSERT_EQ(string("\"olad\""), Lookup(value.get(), "/traceEvents/2/cat"));
+  OLA_ASSERT_EQ(string("\"X\""), Lookup(value.get(), "/traceEvents/2/ph"));
+  // The MockClock still moves with the real time, so allow some slack.
+  const unsigned int ts = LookupUInt(value.get(), "/traceEvents/2/ts");
+  OLA_ASSERT_TRUE(ts >= 2000 && ts < 2000 + SLACK_US);
+  const unsigned int duration = LookupUInt(value.get(),
+                                           "/traceEvents/2/dur");
+  OLA_ASSERT_TRUE(duration >= 1500 && duration < 1500 + SLACK_US);
+  OLA_ASSERT_EQ(string("0"), Lookup(value.get(), "/traceEvents/2/tid"));
+
+  OLA_ASSERT_EQ(string("\"artnet\""),
+                Lookup(value.get(), "/traceEvents/3/name"));
+  OLA_ASSERT_EQ(string("1"), Lookup(value.get(), "/traceEvents/3/tid"));
+}
@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UdpStreamServer.cpp
+ * Receives DMX data streamed by clients over UDP.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <map>
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/math/Random.h"
+#include "olad/UdpStreamServer.h"
+
+namespace ola {
+
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
+using std::map;
+
+/**
+ * @brief The number of datagrams received.
+ */
+const char UdpStreamServer::K_UDP_FRAMES_VAR[] = "udp-stream-frames";
+
+/**
+ * @brief The datagrams, or universes within them, which were dropped.
+ */
+const char UdpStreamServer::K_UDP_DROPPED_VAR[] = "udp-stream-dropped";
+
+UdpStreamServer::UdpStreamServer(ola::io::SelectServerInterface *ss,
+                                 DataHandler *handler,
+                                 ExportMap *export_map)
+    : m_ss(ss),
+      m_handler(handler),
+      m_frames(NULL),
+      m_dropped(NULL) {
+  if (export_map) {
+    m_frames = export_map->GetCounterVar(K_UDP_FRAMES_VAR);
+    m_dropped = export_map->GetUIntMapVar(K_UDP_DROPPED_VAR, "reason");
+  }
+}
+
+UdpStreamServer::~UdpStreamServer() {
+  if (m_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_socket.get());
+  }
+}
+
+bool UdpStreamServer::Init(const IPV4SocketAddress &address) {
+  if (m_socket.get()) {
+    return false;
+  }
+
+  std::auto_ptr<UDPSocket> socket(new UDPSocket());
+  if (!socket->Init() || !socket->Bind(address)) {
+    OLA_WARN << "Failed to open the UDP streaming socket on " << address;
+    return false;
+  }
+  socket->SetOnData(NewCallback(this, &UdpStreamServer::SocketReady));
+  m_ss->AddReadDescriptor(socket.get());
+  m_socket.reset(socket.release());
+  return true;
+}
+
+uint16_t UdpStreamServer::Port() const {
+  IPV4SocketAddress address;
+  if (!m_socket.get() || !m_socket->GetSocketAddress(&address)) {
+    return 0;
+  }
+  return address.Port();
+}
+
+uint64_t UdpStreamServer::AddClient(Client *client) {
+  map<Client*, uint64_t>::const_iterator iter = m_tokens.find(client);
+  if (iter != m_tokens.end()) {
+    return iter->second;
+  }
+
+  uint64_t token;
+  do {
+    token = NewToken();
+  } while (m_clients.find(token) != m_clients.end());
+
+  ClientState &state = m_clients[token];
+  state.client = client;
+  m_tokens[client] = token;
+  return token;
+}
+
+void UdpStreamServer::RemoveClient(Client *client) {
+  map<Client*, uint64_t>::iterator iter = m_tokens.find(client);
+  if (iter == m_tokens.end()) {
+    return;
+  }
+  m_clients.erase(iter->second);
+  m_tokens.erase(iter);
+}
+
+void UdpStreamServer::HandleDatagram(const uint8_t *data, unsigned int size) {
+  if (m_frames) {
+    (*m_frames)++;
+  }
+
+  ola::proto::UdpDmxFrame frame;
+  if (!frame.ParseFromArray(data, size)) {
+    Dropped("invalid");
+    return;
+  }
+
+  ClientMap::iterator iter = m_clients.find(frame.token());
+  if (iter == m_clients.end()) {
+    Dropped("unknown-token");
+    return;
+  }
+
+  ClientState &state = iter->second;
+  const uint32_t sequence = frame.sequence();
+  ola::proto::DmxDataBatch batch;
+  for (int i = 0; i < frame.data_size(); i++) {
+    ola::proto::DmxData *universe_data = frame.mutable_data(i);
+    if (universe_data->has_delta_length()) {
+      Dropped("delta-encoded");
+      continue;
+    }
+
+    std::pair<SequenceMap::iterator, bool> result =
+        state.sequences.insert(
+            SequenceMap::value_type(universe_data->universe(), sequence));
+    // Serial number arithmetic, so the sequence number can wrap.
+    if (!result.second) {
+      if (static_cast<int32_t>(sequence - result.first->second) <= 0) {
+        Dropped("stale");
+        continue;
+      }
+      result.first->second = sequence;
+    }
+    batch.add_data()->Swap(universe_data);
+  }
+
+  if (batch.data_size()) {
+    m_handler->Run(state.client, batch);
+  }
+}
+
+void UdpStreamServer::SocketReady() {
+  uint8_t buffer[MAX_DATAGRAM_SIZE];
+  ssize_t size = sizeof(buffer);
+  if (!m_socket->RecvFrom(buffer, &size)) {
+    return;
+  }
+  HandleDatagram(buffer, static_cast<unsigned int>(size));
+}
+
+void UdpStreamServer::Dropped(const char *reason) {
+  if (m_dropped) {
+    m_dropped->Increment(reason);
+  }
+}
+
+uint64_t UdpStreamServer::NewToken() {
+  uint64_t token = 0;
+  for (unsigned int i = 0; i < 4; i++) {
+    token = (token << 16) | ola::math::Random(0, 0xffff);
+  }
+  return token;
+}
+}  // namespace ola
@@ -0,0 +1,142 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UdpStreamServer.h
+ * Receives DMX data streamed by clients over UDP.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_UDPSTREAMSERVER_H_
+#define OLAD_UDPSTREAMSERVER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include "ola/Callback.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+
+namespace ola {
+
+namespace proto { class DmxDataBatch; }
+
+class Client;
+
+/**
+ * @brief Receives DMX data streamed by clients over UDP.
+ *
+ * Streaming over the RPC connection means one lost TCP segment holds up all
+ * the frames behind it. Instead a client can ask for a token with the
+ * SetupUdpStream RPC, and then send UdpDmxFrame datagrams to the port.
+ *
+ * Each datagram has a sequence number, and the last sequence number applied
+ * to each of the client's universes is kept. Data older than that is dropped,
+ * so lost or reordered datagrams are skipped rather than waited for. The
+ * rest of the data is passed to the handler, which applies it the same way
+ * as the StreamDmxDataBatch RPC.
+ *
+ * The token is only valid while the client's RPC connection is open.
+ */
+class UdpStreamServer {
+ public:
+  /**
+   * @brief Called with the new data from a client.
+   */
+  typedef Callback2<void, Client*, const ola::proto::DmxDataBatch&>
+      DataHandler;
+
+  /**
+   * @brief Create a new UdpStreamServer.
+   * @param ss the SelectServer to receive datagrams on.
+   * @param handler the DataHandler to call, ownership is transferred.
+   * @param export_map the ExportMap to record the counters in, may be NULL.
+   */
+  UdpStreamServer(ola::io::SelectServerInterface *ss,
+                  DataHandler *handler,
+                  ExportMap *export_map = NULL);
+  ~UdpStreamServer();
+
+  /**
+   * @brief Open the UDP socket.
+   * @param address the address to listen on, the port may be 0.
+   * @returns true if the socket was opened.
+   */
+  bool Init(const ola::network::IPV4SocketAddress &address);
+
+  /**
+   * @brief The port datagrams should be sent to.
+   */
+  uint16_t Port() const;
+
+  /**
+   * @brief Allow a client to stream over UDP.
+   * @returns the token the client puts in each datagram. If the client
+   *   already has a token, the same one is returned.
+   */
+  uint64_t AddClient(Client *client);
+
+  /**
+   * @brief Stop accepting datagrams from a client.
+   */
+  void RemoveClient(Client *client);
+
+  /**
+   * @brief Handle a datagram.
+   * @param data the datagram.
+   * @param size the size of the datagram.
+   */
+  void HandleDatagram(const uint8_t *data, unsigned int size);
+
+  /**
+   * @brief The number of clients that can stream.
+   */
+  unsigned int ClientCount() const {
+    return static_cast<unsigned int>(m_clients.size());
+  }
+
+  static const char K_UDP_FRAMES_VAR[];
+  static const char K_UDP_DROPPED_VAR[];
+
+ private:
+  typedef std::map<unsigned int, uint32_t> SequenceMap;
+
+  struct ClientState {
+    Client *client;
+    SequenceMap sequences;  // universe -> last sequence number applied
+  };
+
+  typedef std::map<uint64_t, ClientState> ClientMap;
+
+  ola::io::SelectServerInterface *m_ss;
+  std::auto_ptr<DataHandler> m_handler;
+  std::auto_ptr<ola::network::UDPSocket> m_socket;
+  ClientMap m_clients;
+  std::map<Client*, uint64_t> m_tokens;
+  CounterVariable *m_frames;
+  UIntMap *m_dropped;
+
+  void SocketReady();
+  void Dropped(const char *reason);
+  static uint64_t NewToken();
+
+  static const unsigned int MAX_DATAGRAM_SIZE = 8192;
+
+  DISALLOW_COPY_AND_ASSIGN(UdpStreamServer);
+};
+}  // namespace ola
+#endif  // OLAD_UDPSTREAMSERVER_H_
@@ -0,0 +1,241 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UdpStreamServerTest.cpp
+ * Test fixture for the UdpStreamServer class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/ExportMap.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/UdpStreamServer.h"
+#include "olad/plugin_api/Client.h"
+
+using ola::Client;
+using ola::ExportMap;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::UdpStreamServer;
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPSocket;
+using ola::rdm::UID;
+using std::string;
+using std::vector;
+
+class UdpStreamServerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UdpStreamServerTest);
+  CPPUNIT_TEST(testTokens);
+  CPPUNIT_TEST(testStaleData);
+  CPPUNIT_TEST(testInvalidDatagrams);
+  CPPUNIT_TEST(testSocket);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  UdpStreamServerTest()
+      : m_client1(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 1)),
+        m_client2(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, 2)),
+        m_server(&m_ss,
+                 NewCallback(this, &UdpStreamServerTest::DataReceived),
+                 &m_export_map) {
+  }
+
+  void testTokens();
+  void testStaleData();
+  void testInvalidDatagrams();
+  void testSocket();
+
+ private:
+  struct Update {
+    Client *client;
+    vector<unsigned int> universes;
+  };
+
+  SelectServer m_ss;
+  ExportMap m_export_map;
+  Client m_client1, m_client2;
+  UdpStreamServer m_server;
+  vector<Update> m_updates;
+
+  void DataReceived(Client *client, const ola::proto::DmxDataBatch &batch) {
+    Update update;
+    update.client = client;
+    for (int i = 0; i < batch.data_size(); i++) {
+      update.universes.push_back(batch.data(i).universe());
+    }
+    m_updates.push_back(update);
+    m_ss.Terminate();
+  }
+
+  string Frame(uint64_t token, uint32_t sequence,
+               const vector<unsigned int> &universes,
+               bool delta = false) {
+    ola::proto::UdpDmxFrame frame;
+    frame.set_token(token);
+    frame.set_sequence(sequence);
+    vector<unsigned int>::const_iterator iter = universes.begin();
+    for (; iter != universes.end(); ++iter) {
+      ola::proto::DmxData *data = frame.add_data();
+      data->set_universe(*iter);
+      data->set_data(string(4, 1));
+      if (delta) {
+        data->set_delta_length(4);
+      }
+    }
+    string output;
+    frame.SerializeToString(&output);
+    return output;
+  }
+
+  void Send(const string &datagram) {
+    m_server.HandleDatagram(
+        reinterpret_cast<const uint8_t*>(datagram.data()),
+        static_cast<unsigned int>(datagram.size()));
+  }
+
+  unsigned int Dropped(const string &reason) {
+    return (*m_export_map.GetUIntMapVar(UdpStreamServer::K_UDP_DROPPED_VAR))
+        [reason];
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UdpStreamServerTest);
+
+
+/*
+ * Check each client gets its own token, and only while it's registered.
+ */
+void UdpStreamServerTest::testTokens() {
+  const uint64_t token1 = m_server.AddClient(&m_client1);
+  const uint64_t token2 = m_server.AddClient(&m_client2);
+  OLA_ASSERT_NE(token1, token2);
+  OLA_ASSERT_EQ(token1, m_server.AddClient(&m_client1));
+  OLA_ASSERT_EQ(2u, m_server.ClientCount());
+
+  vector<unsigned int> universes;
+  universes.push_back(1);
+  Send(Frame(token2, 0, universes));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_updates.size());
+  OLA_ASSERT_EQ(&m_client2, m_updates[0].client);
+
+  m_server.RemoveClient(&m_client2);
+  OLA_ASSERT_EQ(1u, m_server.ClientCount());
+  Send(Frame(token2, 1, universes));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_updates.size());
+  OLA_ASSERT_EQ(1u, Dropped("unknown-token"));
+}
+
+
+/*
+ * Check old data for a universe is dropped.
+ */
+void UdpStreamServerTest::testStaleData() {
+  const uint64_t token = m_server.AddClient(&m_client1);
+
+  vector<unsigned int> both;
+  both.push_back(1);
+  both.push_back(2);
+  vector<unsigned int> first;
+  first.push_back(1);
+
+  Send(Frame(token, 10, first));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_updates.size());
+
+  // Datagram 9 arrives late, only universe 2 hasn't been updated since.
+  Send(Frame(token, 9, both));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_updates.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_updates[1].universes.size());
+  OLA_ASSERT_EQ(2u, m_updates[1].universes[0]);
+  OLA_ASSERT_EQ(1u, Dropped("stale"));
+
+  // A duplicate is dropped entirely.
+  Send(Frame(token, 9, both));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_updates.size());
+  OLA_ASSERT_EQ(3u, Dropped("stale"));
+
+  // Skipping datagrams is fine.
+  Send(Frame(token, 20, both));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_updates.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_updates[2].universes.size());
+
+  // Each client has its own sequence numbers.
+  Send(Frame(m_server.AddClient(&m_client2), 0, both));
+  OLA_ASSERT_EQ(static_cast<size_t>(4), m_updates.size());
+  OLA_ASSERT_EQ(&m_client2, m_updates[3].client);
+}
+
+
+/*
+ * Check datagrams we can't use are dropped.
+ */
+void UdpStreamServerTest::testInvalidDatagrams() {
+  const uint64_t token = m_server.AddClient(&m_client1);
+
+  Send("garbage");
+  OLA_ASSERT_EQ(1u, Dropped("invalid"));
+
+  vector<unsigned int> universes;
+  universes.push_back(1);
+  Send(Frame(token, 0, universes, true));
+  OLA_ASSERT_EQ(1u, Dropped("delta-encoded"));
+  OLA_ASSERT_TRUE(m_updates.empty());
+
+  // The sequence number wraps.
+  Send(Frame(token, 0xffffffff, universes));
+  Send(Frame(token, 0, universes));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_updates.size());
+  OLA_ASSERT_EQ(4u, (*m_export_map.GetCounterVar(
+      UdpStreamServer::K_UDP_FRAMES_VAR)).Get());
+}
+
+
+/*
+ * Check datagrams are received on the socket.
+ */
+void UdpStreamServerTest::testSocket() {
+  OLA_ASSERT_TRUE(m_server.Init(
+      IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT_NE(static_cast<uint16_t>(0), m_server.Port());
+
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  vector<unsigned int> universes;
+  universes.push_back(3);
+  const string datagram = Frame(m_server.AddClient(&m_client1), 0, universes);
+  socket.SendTo(reinterpret_cast<const uint8_t*>(datagram.data()),
+                static_cast<unsigned int>(datagram.size()),
+                IPV4SocketAddress(IPV4Address::Loopback(), m_server.Port()));
+
+  m_ss.RegisterSingleTimeout(
+      2000, NewSingleCallback(&m_ss, &SelectServer::Terminate));
+  m_ss.Run();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_updates.size());
+  OLA_ASSERT_EQ(3u, m_updates[0].universes[0]);
+}
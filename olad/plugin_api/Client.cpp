@@ -18,11 +18,16 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <algorithm>
 #include <map>
+#include <string>
 #include <utility>
+#include <vector>
+#include "common/dmx/DmxDelta.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "ola/Callback.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
@@ -33,15 +38,58 @@ namespace ola {
 using ola::rdm::UID;
 using ola::rpc::RpcController;
 using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+struct UniverseLessThan {
+  bool operator()(const std::pair<unsigned int, DmxSource> &entry,
+                  unsigned int universe) const {
+    return entry.first < universe;
+  }
+};
+}  // namespace
+
+const char Client::K_DMX_COALESCED_VAR[] = "client-dmx-coalesced";
+const char Client::K_DMX_DROPPED_VAR[] = "client-dmx-dropped";
+// Less than the DmxSource timeout.
+const TimeInterval Client::RANGE_REFRESH_INTERVAL(1, 0);
 
 Client::Client(ola::proto::OlaClientService_Stub *client_stub,
-               const ola::rdm::UID &uid)
+               const ola::rdm::UID &uid,
+               ExportMap *export_map)
     : m_client_stub(client_stub),
-      m_uid(uid) {
+      m_export_map(export_map),
+      m_scheduler(NULL),
+      m_uid(uid),
+      m_delta_encoding(false),
+      m_dmx_batching(false),
+      m_batch_in_flight(false),
+      m_range_priority(0) {
+  if (m_export_map) {
+    m_export_map->GetCounterVar(K_DMX_COALESCED_VAR);
+    m_export_map->GetCounterVar(K_DMX_DROPPED_VAR);
+  }
 }
 
 Client::~Client() {
-  m_data_map.clear();
+  if (m_export_map) {
+    map<unsigned int, OutboundDMX>::const_iterator iter =
+        m_outbound_dmx.begin();
+    for (; iter != m_outbound_dmx.end(); ++iter) {
+      if (iter->second.held) {
+        (*m_export_map->GetCounterVar(K_DMX_DROPPED_VAR))++;
+      }
+    }
+  }
+  map<unsigned int, SubscriptionState>::iterator sub_iter =
+      m_subscriptions.begin();
+  for (; sub_iter != m_subscriptions.end(); ++sub_iter) {
+    CancelHeldFrame(&sub_iter->second);
+  }
+  RemoveSharedDmx();
+  m_sources.clear();
 }
 
 bool Client::SendDMX(unsigned int universe, uint8_t priority,
@@ -51,39 +99,293 @@ bool Client::SendDMX(unsigned int universe, uint8_t priority,
     return false;
   }
 
+  OutboundDMX &outbound = m_outbound_dmx[universe];
+  if (m_dmx_batching) {
+    // Hold the frame until the next FlushDMX(), latest value wins.
+    if (outbound.held) {
+      if (m_export_map) {
+        (*m_export_map->GetCounterVar(K_DMX_DROPPED_VAR))++;
+      }
+    } else {
+      if (m_batch_in_flight && m_export_map) {
+        (*m_export_map->GetCounterVar(K_DMX_COALESCED_VAR))++;
+      }
+      m_batch_universes.push_back(universe);
+    }
+    outbound.held = true;
+    outbound.priority = priority;
+    outbound.buffer = buffer;
+    return true;
+  }
+
+  if (outbound.in_flight) {
+    // Latest value wins, replace any frame that's already waiting.
+    if (m_export_map) {
+      (*m_export_map->GetCounterVar(
+          outbound.held ? K_DMX_DROPPED_VAR : K_DMX_COALESCED_VAR))++;
+    }
+    outbound.held = true;
+    outbound.priority = priority;
+    outbound.buffer = buffer;
+    return true;
+  }
+
+  SendDMXNow(universe, priority, buffer);
+  return true;
+}
+
+bool Client::SendRDMPollResult(const ola::proto::RDMPollResult &result) {
+  if (!m_client_stub.get()) {
+    OLA_FATAL << "client_stub is null";
+    return false;
+  }
+
   RpcController *controller = new RpcController();
-  ola::proto::DmxData dmx_data;
   ola::proto::Ack *ack = new ola::proto::Ack();
+  m_client_stub->RDMPollUpdate(
+      controller,
+      &result,
+      ack,
+      ola::NewSingleCallback(this, &ola::Client::NotificationCallback,
+                             controller, ack));
+  return true;
+}
 
-  dmx_data.set_priority(priority);
-  dmx_data.set_universe(universe);
-  dmx_data.set_data(buffer.Get());
+bool Client::SendRDMBatchResult(const ola::proto::RDMBatchResult &result) {
+  if (!m_client_stub.get()) {
+    OLA_FATAL << "client_stub is null";
+    return false;
+  }
 
-  m_client_stub->UpdateDmxData(
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *ack = new ola::proto::Ack();
+  m_client_stub->RDMBatchUpdate(
       controller,
-      &dmx_data,
+      &result,
       ack,
-      ola::NewSingleCallback(this, &ola::Client::SendDMXCallback,
+      ola::NewSingleCallback(this, &ola::Client::NotificationCallback,
                              controller, ack));
   return true;
 }
 
+bool Client::SendInfoChanges(const ola::proto::InfoChanges &changes) {
+  if (!m_client_stub.get()) {
+    OLA_FATAL << "client_stub is null";
+    return false;
+  }
+
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *ack = new ola::proto::Ack();
+  m_client_stub->InfoUpdate(
+      controller,
+      &changes,
+      ack,
+      ola::NewSingleCallback(this, &ola::Client::NotificationCallback,
+                             controller, ack));
+  return true;
+}
+
+void Client::SetDmxSubscription(unsigned int universe,
+                                const DmxSubscription &subscription) {
+  map<unsigned int, SubscriptionState>::iterator iter =
+      m_subscriptions.find(universe);
+  if (iter != m_subscriptions.end()) {
+    CancelHeldFrame(&iter->second);
+  }
+
+  if (!subscription.max_fps && !subscription.only_on_change &&
+      !subscription.start_slot && !subscription.slot_count) {
+    m_subscriptions.erase(universe);
+    return;
+  }
+
+  SubscriptionState &state = m_subscriptions[universe];
+  state = SubscriptionState();
+  state.options = subscription;
+  if (subscription.max_fps) {
+    state.frame_interval = TimeInterval(
+        static_cast<int64_t>(USEC_IN_SECONDS) / subscription.max_fps);
+  }
+}
+
+const DmxBuffer *Client::FilterDMX(unsigned int universe,
+                                   uint8_t priority,
+                                   const DmxBuffer &buffer,
+                                   const TimeStamp &now) {
+  map<unsigned int, SubscriptionState>::iterator iter =
+      m_subscriptions.find(universe);
+  if (iter == m_subscriptions.end()) {
+    return &buffer;
+  }
+
+  SubscriptionState &state = iter->second;
+  const DmxSubscription &options = state.options;
+  if (options.max_fps && state.sent &&
+      now - state.last_sent < state.frame_interval) {
+    // Hold the latest frame and send it once the interval is up, so the
+    // client catches up even if the universe doesn't change again.
+    state.held = true;
+    state.held_priority = priority;
+    state.held_frame = buffer;
+    if (m_scheduler &&
+        state.trailing_timeout == ola::thread::INVALID_TIMEOUT) {
+      state.trailing_timeout = m_scheduler->RegisterSingleTimeout(
+          state.last_sent + state.frame_interval - now,
+          NewSingleCallback(this, &Client::SendHeldFrame, universe));
+    }
+    return NULL;
+  }
+
+  // This frame is newer than any held frame.
+  CancelHeldFrame(&state);
+
+  const DmxBuffer *frame = &buffer;
+  if (options.start_slot || options.slot_count) {
+    if (options.start_slot >= buffer.Size()) {
+      return NULL;
+    }
+    unsigned int length = buffer.Size() - options.start_slot;
+    if (options.slot_count && options.slot_count < length) {
+      length = options.slot_count;
+    }
+    state.slots.Set(buffer.GetRaw() + options.start_slot, length);
+    frame = &state.slots;
+  }
+
+  if (options.only_on_change) {
+    if (state.sent && *frame == state.last_frame) {
+      return NULL;
+    }
+    state.last_frame = *frame;
+  }
+
+  state.sent = true;
+  state.last_sent = now;
+  return frame;
+}
+
+void Client::SendHeldFrame(unsigned int universe) {
+  map<unsigned int, SubscriptionState>::iterator iter =
+      m_subscriptions.find(universe);
+  if (iter == m_subscriptions.end()) {
+    return;
+  }
+
+  SubscriptionState &state = iter->second;
+  state.trailing_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!state.held) {
+    return;
+  }
+
+  const uint8_t priority = state.held_priority;
+  const DmxBuffer held_frame = state.held_frame;
+  const DmxBuffer *frame = FilterDMX(universe, priority, held_frame,
+                                     state.last_sent + state.frame_interval);
+  if (frame) {
+    SendDMX(universe, priority, *frame);
+  }
+}
+
+void Client::CancelHeldFrame(SubscriptionState *state) {
+  if (state->trailing_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->trailing_timeout);
+    state->trailing_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+  state->held = false;
+  // Drop our reference, so the universe doesn't have to copy its data.
+  state->held_frame = DmxBuffer();
+}
+
 void Client::DMXReceived(unsigned int universe, const DmxSource &source) {
-  STLReplace(&m_data_map, universe, source);
+  *FindOrAddSource(universe) = source;
 }
 
-const DmxSource Client::SourceData(unsigned int universe) const {
-  map<unsigned int, DmxSource>::const_iterator iter =
-    m_data_map.find(universe);
+void Client::DMXReceived(unsigned int universe, const uint8_t *data,
+                         unsigned int length, const TimeStamp &timestamp,
+                         uint8_t priority) {
+  FindOrAddSource(universe)->UpdateData(data, length, timestamp, priority);
+}
 
-  if (iter != m_data_map.end()) {
-    return iter->second;
-  } else {
-    DmxSource source;
-    return source;
+bool Client::SetupSharedDmx(const string &name, unsigned int slot_count) {
+  RemoveSharedDmx();
+  m_shared_dmx.reset(ola::dmx::SharedDmxRegion::Create(name, slot_count));
+  if (!m_shared_dmx.get()) {
+    return false;
+  }
+  m_shared_dmx_name = name;
+  m_shared_dmx_sequences.assign(slot_count, 0);
+  return true;
+}
+
+void Client::ReadSharedDmx(unsigned int first_slot, unsigned int slot_count,
+                           const TimeStamp &timestamp,
+                           vector<unsigned int> *universes) {
+  if (!m_shared_dmx.get() || first_slot >= m_shared_dmx->SlotCount()) {
+    return;
+  }
+
+  const unsigned int end = first_slot + std::min(
+      slot_count, m_shared_dmx->SlotCount() - first_slot);
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  for (unsigned int i = first_slot; i < end; i++) {
+    unsigned int universe, length;
+    uint8_t priority;
+    if (m_shared_dmx->Read(i, &m_shared_dmx_sequences[i], &universe,
+                           &priority, data, &length)) {
+      priority = std::min(
+          static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX), priority);
+      DMXReceived(universe, data, length, timestamp, priority);
+      universes->push_back(universe);
+    }
   }
 }
 
+bool Client::ReceiveRange(unsigned int first_universe,
+                          unsigned int slots_per_universe,
+                          const uint8_t *data,
+                          unsigned int length,
+                          const TimeStamp &timestamp,
+                          uint8_t priority,
+                          vector<unsigned int> *universes) {
+  if (!slots_per_universe || slots_per_universe > DMX_UNIVERSE_SIZE ||
+      !length) {
+    return false;
+  }
+  const unsigned int universe_count =
+      (length + slots_per_universe - 1) / slots_per_universe;
+  if (universe_count > MAX_RANGE_UNIVERSES ||
+      first_universe + universe_count < first_universe) {
+    return false;
+  }
+
+  if (!m_range.get() ||
+      !m_range->Matches(first_universe, universe_count, slots_per_universe)) {
+    m_range.reset(new UniverseRange(first_universe, universe_count,
+                                    slots_per_universe));
+    m_range_refresh = timestamp;
+  }
+  if (priority != m_range_priority || timestamp >= m_range_refresh) {
+    m_range->MarkAllDirty();
+    m_range_priority = priority;
+    m_range_refresh = timestamp + RANGE_REFRESH_INTERVAL;
+  }
+  m_range->Write(0, data, length);
+
+  for (unsigned int i = m_range->NextDirty(0); i < universe_count;
+       i = m_range->NextDirty(i + 1)) {
+    DMXReceived(first_universe + i, m_range->Data(i), m_range->Length(i),
+                timestamp, priority);
+    universes->push_back(first_universe + i);
+  }
+  m_range->ClearDirty();
+  return true;
+}
+
+const DmxSource Client::SourceData(unsigned int universe) const {
+  const DmxSource *source = FindSource(universe);
+  return source ? *source : DmxSource();
+}
+
 ola::rdm::UID Client::GetUID() const {
   return m_uid;
 }
@@ -92,11 +394,193 @@ void Client::SetUID(const ola::rdm::UID &uid) {
   m_uid = uid;
 }
 
+size_t Client::MemoryUsage() const {
+  // Buffers which hold data each reference a frame from the DmxBuffer pool.
+  size_t bytes = sizeof(*this) +
+      STLVectorMemoryUsage(m_sources) +
+      STLNodeMemoryUsage(m_outbound_dmx) +
+      STLNodeMemoryUsage(m_subscriptions) +
+      STLVectorMemoryUsage(m_batch_universes) +
+      STLVectorMemoryUsage(m_shared_dmx_sequences) +
+      (m_range.get() ? m_range->MemoryUsage() : 0);
+
+  SourceTable::const_iterator source_iter = m_sources.begin();
+  for (; source_iter != m_sources.end(); ++source_iter) {
+    if (source_iter->second.Data().Size()) {
+      bytes += DMX_UNIVERSE_SIZE;
+    }
+  }
+
+  map<unsigned int, OutboundDMX>::const_iterator outbound_iter =
+      m_outbound_dmx.begin();
+  for (; outbound_iter != m_outbound_dmx.end(); ++outbound_iter) {
+    bytes += (outbound_iter->second.buffer.Size() ? DMX_UNIVERSE_SIZE : 0) +
+        (outbound_iter->second.last_sent.Size() ? DMX_UNIVERSE_SIZE : 0);
+  }
+
+  map<unsigned int, SubscriptionState>::const_iterator subscription_iter =
+      m_subscriptions.begin();
+  for (; subscription_iter != m_subscriptions.end(); ++subscription_iter) {
+    const SubscriptionState &state = subscription_iter->second;
+    bytes += (state.last_frame.Size() ? DMX_UNIVERSE_SIZE : 0) +
+        (state.slots.Size() ? DMX_UNIVERSE_SIZE : 0);
+  }
+  return bytes;
+}
+
+void Client::SetDeltaEncoding(bool enable) {
+  m_delta_encoding = enable;
+  if (!enable) {
+    map<unsigned int, OutboundDMX>::iterator iter = m_outbound_dmx.begin();
+    for (; iter != m_outbound_dmx.end(); ++iter) {
+      iter->second.last_sent.Reset();
+    }
+  }
+}
+
+void Client::SetDmxBatching(bool enable) {
+  if (enable == m_dmx_batching) {
+    return;
+  }
+  m_dmx_batching = enable;
+  if (enable) {
+    return;
+  }
+
+  // Send anything that was waiting for the next batch on its own.
+  vector<unsigned int> universes;
+  universes.swap(m_batch_universes);
+  vector<unsigned int>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    OutboundDMX &outbound = m_outbound_dmx[*iter];
+    outbound.held = false;
+    DmxBuffer buffer(outbound.buffer);
+    outbound.buffer.Reset();
+    SendDMX(*iter, outbound.priority, buffer);
+  }
+}
+
+void Client::FlushDMX() {
+  if (!m_dmx_batching || m_batch_in_flight || m_batch_universes.empty() ||
+      !m_client_stub.get()) {
+    return;
+  }
+
+  ola::proto::DmxDataBatch batch;
+  vector<unsigned int>::const_iterator iter = m_batch_universes.begin();
+  for (; iter != m_batch_universes.end(); ++iter) {
+    OutboundDMX &outbound = m_outbound_dmx[*iter];
+    BuildDmxData(*iter, outbound.priority, outbound.buffer, &outbound,
+                 batch.add_data());
+    outbound.held = false;
+    outbound.buffer.Reset();
+  }
+  m_batch_universes.clear();
+
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *ack = new ola::proto::Ack();
+  // This must be set first, the stub may run the callback before returning.
+  m_batch_in_flight = true;
+  m_client_stub->UpdateDmxDataBatch(
+      controller,
+      &batch,
+      ack,
+      ola::NewSingleCallback(this, &ola::Client::SendDMXBatchCallback,
+                             controller, ack));
+}
+
+const DmxSource *Client::FindSource(unsigned int universe) const {
+  SourceTable::const_iterator iter = std::lower_bound(
+      m_sources.begin(), m_sources.end(), universe, UniverseLessThan());
+  if (iter != m_sources.end() && iter->first == universe) {
+    return &iter->second;
+  }
+  return NULL;
+}
+
+DmxSource *Client::FindOrAddSource(unsigned int universe) {
+  SourceTable::iterator iter = std::lower_bound(
+      m_sources.begin(), m_sources.end(), universe, UniverseLessThan());
+  if (iter == m_sources.end() || iter->first != universe) {
+    iter = m_sources.insert(iter, std::make_pair(universe, DmxSource()));
+  }
+  return &iter->second;
+}
+
+void Client::RemoveSharedDmx() {
+  if (!m_shared_dmx_name.empty()) {
+    ola::dmx::SharedDmxRegion::Unlink(m_shared_dmx_name);
+    m_shared_dmx_name.clear();
+  }
+  m_shared_dmx.reset();
+  m_shared_dmx_sequences.clear();
+}
+
+void Client::SendDMXNow(unsigned int universe, uint8_t priority,
+                        const DmxBuffer &buffer) {
+  RpcController *controller = new RpcController();
+  ola::proto::DmxData dmx_data;
+  ola::proto::Ack *ack = new ola::proto::Ack();
+
+  OutboundDMX &outbound = m_outbound_dmx[universe];
+  BuildDmxData(universe, priority, buffer, &outbound, &dmx_data);
+
+  // This must be set first, the stub may run the callback before returning.
+  outbound.in_flight = true;
+  m_client_stub->UpdateDmxData(
+      controller,
+      &dmx_data,
+      ack,
+      ola::NewSingleCallback(this, &ola::Client::SendDMXCallback,
+                             controller, ack, universe));
+}
+
 /*
- * Called when UpdateDmxData completes.
+ * Called when UpdateDmxData completes, send the held frame if there is one.
  */
 void Client::SendDMXCallback(RpcController *controller,
-                             ola::proto::Ack *reply) {
+                             ola::proto::Ack *reply,
+                             unsigned int universe) {
+  delete controller;
+  delete reply;
+
+  OutboundDMX &outbound = m_outbound_dmx[universe];
+  outbound.in_flight = false;
+  if (outbound.held) {
+    outbound.held = false;
+    DmxBuffer buffer(outbound.buffer);
+    outbound.buffer.Reset();
+    SendDMXNow(universe, outbound.priority, buffer);
+  }
+}
+
+/*
+ * Called when UpdateDmxDataBatch completes. Anything held since is sent by
+ * the next FlushDMX().
+ */
+void Client::SendDMXBatchCallback(RpcController *controller,
+                                  ola::proto::Ack *reply) {
+  delete controller;
+  delete reply;
+  m_batch_in_flight = false;
+}
+
+void Client::BuildDmxData(unsigned int universe, uint8_t priority,
+                          const DmxBuffer &buffer, OutboundDMX *outbound,
+                          ola::proto::DmxData *dmx_data) {
+  dmx_data->set_priority(priority);
+  dmx_data->set_universe(universe);
+
+  if (m_delta_encoding) {
+    ola::dmx::EncodeDmxData(outbound->last_sent, buffer, dmx_data);
+    outbound->last_sent = buffer;
+  } else {
+    dmx_data->set_data(buffer.Get());
+  }
+}
+
+void Client::NotificationCallback(RpcController *controller,
+                                  ola::proto::Ack *reply) {
   delete controller;
   delete reply;
 }
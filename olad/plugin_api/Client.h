@@ -23,15 +23,28 @@
 
 #include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/dmx/SharedDmxRegion.h"
 #include "common/rpc/RpcController.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/base/Macro.h"
 #include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/DmxSource.h"
+#include "olad/plugin_api/UniverseRange.h"
 
 namespace ola {
 namespace proto {
 class OlaClientService_Stub;
 class Ack;
+class DmxData;
+class RDMPollResult;
+class RDMBatchResult;
+class InfoChanges;
 }
 }
 
@@ -42,18 +55,49 @@ namespace ola {
  *
  * This stores the state of the client (i.e. DMX data) and allows us to push
  * DMX updates to the client via the OlaClientService_Stub.
+ *
+ * Only one DMX update per universe is sent to the client at once. If SendDMX()
+ * is called before the previous update for the universe has been acked, the
+ * new frame is held and replaces any frame already waiting. This stops a slow
+ * client from building up an unbounded queue in olad, the client always gets
+ * the latest data once it catches up.
+ *
+ * Clients which enable DMX batching instead have their updates held until
+ * FlushDMX() is called, then all of the held universes are sent in one
+ * UpdateDmxDataBatch message. Only one batch is sent at once, frames which
+ * arrive while a batch is waiting for an ack are held for the next one.
  */
 class Client {
  public :
+  /**
+   * @brief Limits on the DMX data sent to a client for a universe.
+   */
+  struct DmxSubscription {
+    DmxSubscription()
+        : max_fps(0),
+        only_on_change(false),
+        start_slot(0),
+        slot_count(0) {
+    }
+
+    unsigned int max_fps;  // 0 is unlimited
+    bool only_on_change;
+    unsigned int start_slot;
+    unsigned int slot_count;  // 0 is to the end of the frame
+  };
+
   /**
    * @brief Create a new client.
    * @param client_stub The OlaClientService_Stub to use to communicate with
    *   the client. Ownership is transferred to the client.
    * @param uid The default UID to use for this client. The client may set its
    *   own UID later.
+   * @param export_map the ExportMap to update with the coalesced and dropped
+   *   frame counts, may be NULL.
    */
   Client(ola::proto::OlaClientService_Stub *client_stub,
-         const ola::rdm::UID &uid);
+         const ola::rdm::UID &uid,
+         ExportMap *export_map = NULL);
 
   virtual ~Client();
 
@@ -62,11 +106,68 @@ class Client {
    * @param universe_id the universe the DMX data belongs to
    * @param priority the priority of the DMX data
    * @param buffer the DMX data.
-   * @return true if the update was sent, false otherwise
+   * @return true if the update was sent or held until the previous update is
+   *   acked, false otherwise
    */
   virtual bool SendDMX(unsigned int universe_id, uint8_t priority,
                        const DmxBuffer &buffer);
 
+  /**
+   * @brief Push an RDM poll result to this client.
+   * @param result the result to send.
+   * @return true if the result was sent, false otherwise
+   */
+  virtual bool SendRDMPollResult(const ola::proto::RDMPollResult &result);
+
+  /**
+   * @brief Push the response to a request in an RDM batch to this client.
+   * @param result the result to send.
+   * @return true if the result was sent, false otherwise
+   */
+  virtual bool SendRDMBatchResult(const ola::proto::RDMBatchResult &result);
+
+  /**
+   * @brief Tell this client that universes, ports or devices have changed.
+   * @param changes the changes to send.
+   * @return true if the changes were sent, false otherwise
+   */
+  virtual bool SendInfoChanges(const ola::proto::InfoChanges &changes);
+
+  /**
+   * @brief Set the limits on the DMX data sent for a universe.
+   * @param universe the id of the universe.
+   * @param subscription the limits to apply. The default DmxSubscription
+   *   removes any limits.
+   */
+  void SetDmxSubscription(unsigned int universe,
+                          const DmxSubscription &subscription);
+
+  /**
+   * @brief Set the scheduler used to send frames held back by max_fps.
+   * @param scheduler the scheduler to use, ownership isn't transferred. If
+   *   this is NULL, the default, held frames are only replaced by the next
+   *   frame for the universe.
+   */
+  void SetScheduler(ola::thread::SchedulerInterface *scheduler) {
+    m_scheduler = scheduler;
+  }
+
+  /**
+   * @brief Apply the subscription for a universe to a frame.
+   * @param universe the id of the universe the frame is for.
+   * @param priority the priority of the frame.
+   * @param buffer the frame.
+   * @param now the current time.
+   * @returns the frame to pass to SendDMX(), or NULL if the frame shouldn't
+   *   be sent. The pointer is valid until the next call for the universe.
+   *
+   * A frame skipped because of max_fps is held, and sent once the interval
+   * is up unless a newer frame is sent first. This needs a scheduler, see
+   * SetScheduler().
+   */
+  const DmxBuffer *FilterDMX(unsigned int universe, uint8_t priority,
+                             const DmxBuffer &buffer, const TimeStamp &now);
+
   /**
    * @brief Called when this client sends us new data
    * @param universe the id of the universe for the new data
@@ -74,6 +175,75 @@ class Client {
    */
   void DMXReceived(unsigned int universe, const DmxSource &source);
 
+  /**
+   * @brief Called when this client sends us new data.
+   * @param universe the id of the universe for the new data
+   * @param data the new DMX data.
+   * @param length the length of the DMX data.
+   * @param timestamp the time the data was received.
+   * @param priority the priority of the data.
+   *
+   * Unlike the DmxSource version, this re-uses the existing buffer for the
+   * universe, which avoids allocating memory for each update.
+   */
+  void DMXReceived(unsigned int universe, const uint8_t *data,
+                   unsigned int length, const TimeStamp &timestamp,
+                   uint8_t priority);
+
+  /**
+   * @brief Create a shared memory region this client can write DMX data to.
+   * @param name the name of the region.
+   * @param slot_count the number of universes the region can hold.
+   * @return true if the region was created, false otherwise.
+   *
+   * Any existing region is removed. The name is unlinked when the client is
+   * destroyed.
+   */
+  bool SetupSharedDmx(const std::string &name, unsigned int slot_count);
+
+  /**
+   * @brief Check if this client has a shared memory region.
+   */
+  bool HasSharedDmx() const { return m_shared_dmx.get() != NULL; }
+
+  /**
+   * @brief Read any updated universes from a range of slots in the shared
+   *   memory region.
+   * @param first_slot the first slot to check.
+   * @param slot_count the number of slots to check, this is clamped to the
+   *   size of the region.
+   * @param timestamp the time the data was received.
+   * @param[out] universes the universes that were updated.
+   */
+  void ReadSharedDmx(unsigned int first_slot, unsigned int slot_count,
+                     const TimeStamp &timestamp,
+                     std::vector<unsigned int> *universes);
+
+  /**
+   * @brief Receive the DMX data for a run of consecutive universes.
+   * @param first_universe the id of the first universe.
+   * @param slots_per_universe the number of slots in each universe, the last
+   *   universe may be shorter.
+   * @param data the data for the universes, packed one after another.
+   * @param length the length of the data.
+   * @param timestamp the time the data was received.
+   * @param priority the priority of the data.
+   * @param[out] universes the universes whose data changed.
+   * @returns false if the range is invalid.
+   *
+   * Only the universes that have changed since the last range are updated,
+   * so they're the only ones that need to be merged. Every universe in the
+   * range is updated once per RANGE_REFRESH_INTERVAL, so the sources don't
+   * time out.
+   */
+  bool ReceiveRange(unsigned int first_universe,
+                    unsigned int slots_per_universe,
+                    const uint8_t *data,
+                    unsigned int length,
+                    const TimeStamp &timestamp,
+                    uint8_t priority,
+                    std::vector<unsigned int> *universes);
+
   /**
    * @brief Get the most recent DMX data received from this client.
    * @param universe the id of the universe we're interested in
@@ -95,13 +265,138 @@ class Client {
    */
   void SetUID(const ola::rdm::UID &uid);
 
+  /**
+   * @brief Estimate the memory used by this client's sources, outbound
+   * updates and subscriptions, in bytes.
+   */
+  size_t MemoryUsage() const;
+
+  /**
+   * @brief Enable or disable delta encoding of the DMX updates sent to this
+   * client.
+   * @param enable true to send only the changed slots, false to always send
+   *   full frames.
+   *
+   * Clients enable this with the SetDeltaEncoding RPC. Clients that don't
+   * know about it always get full frames.
+   */
+  void SetDeltaEncoding(bool enable);
+
+  /**
+   * @brief Enable or disable batching of the DMX updates sent to this client.
+   * @param enable true to hold updates until FlushDMX() is called, false to
+   *   send each update as it arrives.
+   *
+   * Clients enable this with the SetDmxBatching RPC. Any held updates are
+   * sent individually if batching is disabled.
+   */
+  void SetDmxBatching(bool enable);
+
+  /**
+   * @brief Send the held updates as a batch.
+   *
+   * This does nothing unless batching is enabled, there are updates held and
+   * the previous batch has been acked. olad calls this once per event loop
+   * iteration.
+   */
+  void FlushDMX();
+
+  /**
+   * @brief The number of frames which were held because the previous frame
+   * for the universe hadn't been acked.
+   */
+  static const char K_DMX_COALESCED_VAR[];
+
+  /**
+   * @brief The number of held frames which were replaced by a newer frame, or
+   * discarded, before they were sent.
+   */
+  static const char K_DMX_DROPPED_VAR[];
+
+  /**
+   * @brief The maximum number of universes in a range.
+   */
+  static const unsigned int MAX_RANGE_UNIVERSES = 4096;
+
  private:
+  // The state of DMX updates sent to the client for a universe.
+  struct OutboundDMX {
+    OutboundDMX() : in_flight(false), held(false), priority(0) {}
+
+    bool in_flight;  // true if we're waiting for an ack
+    bool held;  // true if buffer and priority are waiting to be sent
+    uint8_t priority;
+    DmxBuffer buffer;
+    DmxBuffer last_sent;  // the base for the next delta encoded update
+  };
+
+  // The state of a client's subscription to a universe.
+  struct SubscriptionState {
+    SubscriptionState()
+        : sent(false),
+          held(false),
+          held_priority(0),
+          trailing_timeout(ola::thread::INVALID_TIMEOUT) {
+    }
+
+    DmxSubscription options;
+    TimeInterval frame_interval;
+    bool sent;  // true if a frame has been sent
+    TimeStamp last_sent;
+    DmxBuffer last_frame;  // the last frame sent, for only_on_change
+    DmxBuffer slots;  // the slots in the range for the current frame
+    bool held;  // true if a frame was skipped because of max_fps
+    uint8_t held_priority;
+    DmxBuffer held_frame;
+    // sends the held frame once frame_interval is up
+    ola::thread::timeout_id trailing_timeout;
+  };
+
+  // The latest data from the client for each universe, sorted by universe.
+  // This is a vector rather than a map so that a client which sends
+  // thousands of universes doesn't pay for a tree node per universe.
+  typedef std::vector<std::pair<unsigned int, DmxSource> > SourceTable;
+
+  const DmxSource *FindSource(unsigned int universe) const;
+  DmxSource *FindOrAddSource(unsigned int universe);
+
+  void SendDMXNow(unsigned int universe, uint8_t priority,
+                  const DmxBuffer &buffer);
+  void BuildDmxData(unsigned int universe, uint8_t priority,
+                    const DmxBuffer &buffer, OutboundDMX *outbound,
+                    ola::proto::DmxData *dmx_data);
   void SendDMXCallback(ola::rpc::RpcController *controller,
-                       ola::proto::Ack *ack);
+                       ola::proto::Ack *ack,
+                       unsigned int universe);
+  void SendDMXBatchCallback(ola::rpc::RpcController *controller,
+                            ola::proto::Ack *ack);
+  void NotificationCallback(ola::rpc::RpcController *controller,
+                            ola::proto::Ack *ack);
+  void SendHeldFrame(unsigned int universe);
+  void CancelHeldFrame(SubscriptionState *state);
 
   std::auto_ptr<class ola::proto::OlaClientService_Stub> m_client_stub;
-  std::map<unsigned int, DmxSource> m_data_map;
+  ExportMap *m_export_map;
+  ola::thread::SchedulerInterface *m_scheduler;
+  std::map<unsigned int, OutboundDMX> m_outbound_dmx;
+  std::map<unsigned int, SubscriptionState> m_subscriptions;
+  SourceTable m_sources;
   ola::rdm::UID m_uid;
+  bool m_delta_encoding;
+  bool m_dmx_batching;
+  bool m_batch_in_flight;
+  // The universes with held updates for the next batch, in arrival order.
+  std::vector<unsigned int> m_batch_universes;
+  std::auto_ptr<ola::dmx::SharedDmxRegion> m_shared_dmx;
+  std::string m_shared_dmx_name;
+  std::vector<uint32_t> m_shared_dmx_sequences;
+  std::auto_ptr<UniverseRange> m_range;
+  uint8_t m_range_priority;
+  TimeStamp m_range_refresh;  // when every universe in the range is updated
+
+  void RemoveSharedDmx();
+
+  static const TimeInterval RANGE_REFRESH_INTERVAL;
 
   DISALLOW_COPY_AND_ASSIGN(Client);
 };
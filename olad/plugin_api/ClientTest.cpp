@@ -19,7 +19,9 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
@@ -28,8 +30,11 @@
 #include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Array.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/DmxSource.h"
 #include "olad/plugin_api/Client.h"
 
@@ -41,18 +46,30 @@ static const char TEST_DATA2[] = "another set of test data";
 
 using ola::Client;
 using ola::DmxBuffer;
+using ola::ExportMap;
+using ola::TimeInterval;
+using ola::thread::timeout_id;
 using std::string;
+using std::vector;
 
 class ClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ClientTest);
   CPPUNIT_TEST(testSendDMX);
   CPPUNIT_TEST(testGetSetDMX);
+  CPPUNIT_TEST(testCoalescing);
+  CPPUNIT_TEST(testBatching);
+  CPPUNIT_TEST(testDmxSubscription);
+  CPPUNIT_TEST(testHeldFrame);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   ClientTest() : m_test_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {}
   void testSendDMX();
   void testGetSetDMX();
+  void testCoalescing();
+  void testBatching();
+  void testDmxSubscription();
+  void testHeldFrame();
 
  private:
   ola::Clock m_clock;
@@ -87,6 +104,94 @@ void MockClientStub::UpdateDmxData(
   done->Run();
 }
 
+/*
+ * A ClientStub which holds on to the requests until they're acked.
+ */
+class DeferredClientStub: public ola::proto::OlaClientService_Stub {
+ public:
+  DeferredClientStub(): ola::proto::OlaClientService_Stub(NULL) {}
+
+  void UpdateDmxData(ola::rpc::RpcController*,
+                     const ola::proto::DmxData *request,
+                     ola::proto::Ack*,
+                     ola::rpc::RpcService::CompletionCallback *done) {
+    m_data.push_back(request->data());
+    m_callbacks.push_back(done);
+  }
+
+  void UpdateDmxDataBatch(ola::rpc::RpcController*,
+                          const ola::proto::DmxDataBatch *request,
+                          ola::proto::Ack*,
+                          ola::rpc::RpcService::CompletionCallback *done) {
+    m_batches.push_back(*request);
+    m_callbacks.push_back(done);
+  }
+
+  // Ack the oldest outstanding request
+  void Ack() {
+    ola::rpc::RpcService::CompletionCallback *done = m_callbacks.front();
+    m_callbacks.erase(m_callbacks.begin());
+    done->Run();
+  }
+
+  vector<string> m_data;
+  vector<ola::proto::DmxDataBatch> m_batches;
+  vector<ola::rpc::RpcService::CompletionCallback*> m_callbacks;
+};
+
+/*
+ * Captures a single timeout, so the test can choose when it runs.
+ */
+class FakeScheduler: public ola::thread::SchedulerInterface {
+ public:
+  FakeScheduler() : m_registrations(0) {}
+
+  timeout_id RegisterRepeatingTimeout(unsigned int,
+                                      ola::Callback0<bool> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  timeout_id RegisterRepeatingTimeout(const TimeInterval&,
+                                      ola::Callback0<bool> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  timeout_id RegisterSingleTimeout(unsigned int delay,
+                                   ola::SingleUseCallback0<void> *callback) {
+    return RegisterSingleTimeout(TimeInterval(0, delay * 1000), callback);
+  }
+
+  timeout_id RegisterSingleTimeout(const TimeInterval &delay,
+                                   ola::SingleUseCallback0<void> *callback) {
+    OLA_ASSERT_NULL(m_callback.get());
+    m_delay = delay;
+    m_callback.reset(callback);
+    m_registrations++;
+    return &m_callback;
+  }
+
+  void RemoveTimeout(timeout_id id) {
+    OLA_ASSERT_EQ(static_cast<timeout_id>(&m_callback), id);
+    m_callback.reset();
+  }
+
+  void Fire() {
+    OLA_ASSERT_NOT_NULL(m_callback.get());
+    m_callback.release()->Run();
+  }
+
+  bool Registered() const { return m_callback.get() != NULL; }
+  const TimeInterval &Delay() const { return m_delay; }
+  unsigned int Registrations() const { return m_registrations; }
+
+ private:
+  std::auto_ptr<ola::SingleUseCallback0<void> > m_callback;
+  TimeInterval m_delay;
+  unsigned int m_registrations;
+};
+
 /*
  * Check that the SendDMX method works correctly.
  */
@@ -137,8 +242,251 @@ void ClientTest::testGetSetDMX() {
   OLA_ASSERT_EQ(timestamp, source3.Timestamp());
   OLA_ASSERT_EQ((uint8_t) 120, source3.Priority());
 
+  // check the raw data version updates in place, without changing any
+  // buffers the data was shared with.
+  const uint8_t raw_data[] = {1, 2, 3, 4, 5};
+  client.DMXReceived(TEST_UNIVERSE, raw_data, sizeof(raw_data), timestamp,
+                     140);
+  const ola::DmxSource source5 = client.SourceData(TEST_UNIVERSE);
+  OLA_ASSERT(source5.IsSet());
+  OLA_ASSERT_DATA_EQUALS(raw_data, sizeof(raw_data), source5.Data().GetRaw(),
+                         source5.Data().Size());
+  OLA_ASSERT_EQ((uint8_t) 140, source5.Priority());
+  OLA_ASSERT(buffer == source3.Data());
+  OLA_ASSERT_EQ(string(TEST_DATA2), buffer.Get());
+
   // check fetching an unknown universe results in an empty buffer
   const ola::DmxSource source4 = client.SourceData(TEST_UNIVERSE2);
   OLA_ASSERT_FALSE(source4.IsSet());
   OLA_ASSERT(empty == source4.Data());
+
+  // Universes can arrive in any order.
+  const unsigned int universes[] = {900, 3, 2000, 4};
+  for (unsigned int i = 0; i < arraysize(universes); i++) {
+    client.DMXReceived(universes[i],
+                       ola::DmxSource(buffer, timestamp, 10 + i));
+  }
+  for (unsigned int i = 0; i < arraysize(universes); i++) {
+    const ola::DmxSource source6 = client.SourceData(universes[i]);
+    OLA_ASSERT(source6.IsSet());
+    OLA_ASSERT_EQ(static_cast<uint8_t>(10 + i), source6.Priority());
+  }
+  OLA_ASSERT_EQ((uint8_t) 140, client.SourceData(TEST_UNIVERSE).Priority());
+  OLA_ASSERT_FALSE(client.SourceData(5).IsSet());
+}
+
+
+/*
+ * Check that frames sent while waiting for an ack are coalesced.
+ */
+void ClientTest::testCoalescing() {
+  ExportMap export_map;
+  DeferredClientStub *stub = new DeferredClientStub();
+  Client client(stub, m_test_uid, &export_map);
+  ola::CounterVariable *coalesced = export_map.GetCounterVar(
+      Client::K_DMX_COALESCED_VAR);
+  ola::CounterVariable *dropped = export_map.GetCounterVar(
+      Client::K_DMX_DROPPED_VAR);
+
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("1")));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub->m_data.size());
+
+  // These are held until the first frame is acked, only the last is sent.
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("2")));
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("3")));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub->m_data.size());
+  OLA_ASSERT_EQ(1u, coalesced->Get());
+  OLA_ASSERT_EQ(1u, dropped->Get());
+
+  // Other universes aren't affected.
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE2, 100, DmxBuffer("a")));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), stub->m_data.size());
+
+  stub->Ack();
+  OLA_ASSERT_EQ(static_cast<size_t>(3), stub->m_data.size());
+  OLA_ASSERT_EQ(string("3"), stub->m_data[2]);
+
+  // Nothing is held now, so the next ack doesn't send anything.
+  stub->Ack();
+  stub->Ack();
+  OLA_ASSERT_EQ(static_cast<size_t>(3), stub->m_data.size());
+
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("4")));
+  OLA_ASSERT_EQ(static_cast<size_t>(4), stub->m_data.size());
+  OLA_ASSERT_EQ(string("4"), stub->m_data[3]);
+  stub->Ack();
+  OLA_ASSERT_EQ(1u, coalesced->Get());
+  OLA_ASSERT_EQ(1u, dropped->Get());
+}
+
+
+/*
+ * Check that frames are held and sent together when batching is enabled.
+ */
+void ClientTest::testBatching() {
+  ExportMap export_map;
+  DeferredClientStub *stub = new DeferredClientStub();
+  Client client(stub, m_test_uid, &export_map);
+  ola::CounterVariable *coalesced = export_map.GetCounterVar(
+      Client::K_DMX_COALESCED_VAR);
+  ola::CounterVariable *dropped = export_map.GetCounterVar(
+      Client::K_DMX_DROPPED_VAR);
+  client.SetDmxBatching(true);
+
+  // Nothing is sent until the flush, and then only the latest frame for
+  // each universe.
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE2, 100, DmxBuffer("a")));
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("1")));
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 90, DmxBuffer("2")));
+  OLA_ASSERT_TRUE(stub->m_batches.empty());
+  OLA_ASSERT_EQ(1u, dropped->Get());
+
+  client.FlushDMX();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub->m_batches.size());
+  const ola::proto::DmxDataBatch &batch = stub->m_batches[0];
+  OLA_ASSERT_EQ(2, batch.data_size());
+  OLA_ASSERT_EQ(static_cast<int>(TEST_UNIVERSE2), batch.data(0).universe());
+  OLA_ASSERT_EQ(string("a"), batch.data(0).data());
+  OLA_ASSERT_EQ(static_cast<int>(TEST_UNIVERSE), batch.data(1).universe());
+  OLA_ASSERT_EQ(string("2"), batch.data(1).data());
+  OLA_ASSERT_EQ(90, batch.data(1).priority());
+
+  // Nothing is held, so this doesn't send anything.
+  client.FlushDMX();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub->m_batches.size());
+
+  // Frames are held while the batch is waiting for an ack.
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("3")));
+  client.FlushDMX();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub->m_batches.size());
+  OLA_ASSERT_EQ(1u, coalesced->Get());
+
+  stub->Ack();
+  client.FlushDMX();
+  OLA_ASSERT_EQ(static_cast<size_t>(2), stub->m_batches.size());
+  OLA_ASSERT_EQ(1, stub->m_batches[1].data_size());
+  OLA_ASSERT_EQ(string("3"), stub->m_batches[1].data(0).data());
+  stub->Ack();
+
+  // Disabling batching sends held frames individually.
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, DmxBuffer("4")));
+  client.SetDmxBatching(false);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), stub->m_data.size());
+  OLA_ASSERT_EQ(string("4"), stub->m_data[0]);
+  stub->Ack();
+  OLA_ASSERT_EQ(1u, coalesced->Get());
+  OLA_ASSERT_EQ(1u, dropped->Get());
+}
+
+
+/*
+ * Check the subscription limits are applied to frames.
+ */
+void ClientTest::testDmxSubscription() {
+  Client client(NULL, m_test_uid);
+  DmxBuffer buffer(TEST_DATA);
+  DmxBuffer buffer2(TEST_DATA2);
+  const DmxBuffer *original = &buffer;
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+
+  // No subscription, everything is sent as is.
+  OLA_ASSERT_EQ(original, client.FilterDMX(TEST_UNIVERSE, 100, buffer, now));
+  OLA_ASSERT_EQ(original, client.FilterDMX(TEST_UNIVERSE, 100, buffer, now));
+
+  // Limit to 5 fps, and only send changes to slots 2 - 5.
+  Client::DmxSubscription subscription;
+  subscription.max_fps = 5;
+  subscription.only_on_change = true;
+  subscription.start_slot = 2;
+  subscription.slot_count = 4;
+  client.SetDmxSubscription(TEST_UNIVERSE, subscription);
+
+  const DmxBuffer *frame = client.FilterDMX(TEST_UNIVERSE, 100, buffer, now);
+  OLA_ASSERT_NOT_NULL(frame);
+  OLA_ASSERT_EQ(string(TEST_DATA + 2, 4), frame->Get());
+
+  // The other universe isn't affected.
+  OLA_ASSERT_EQ(original, client.FilterDMX(TEST_UNIVERSE2, 100, buffer, now));
+
+  // Too soon.
+  now += ola::TimeInterval(0, 100000);
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, buffer2, now));
+
+  // Unchanged.
+  now += ola::TimeInterval(0, 200000);
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, buffer, now));
+
+  // Changed, slot 2 onwards differs.
+  frame = client.FilterDMX(TEST_UNIVERSE, 100, buffer2, now);
+  OLA_ASSERT_NOT_NULL(frame);
+  OLA_ASSERT_EQ(string(TEST_DATA2 + 2, 4), frame->Get());
+
+  // Frames that don't reach the start slot aren't sent.
+  now += ola::TimeInterval(1, 0);
+  DmxBuffer short_buffer("ab");
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, short_buffer, now));
+
+  // Removing the subscription.
+  client.SetDmxSubscription(TEST_UNIVERSE, Client::DmxSubscription());
+  OLA_ASSERT_EQ(original, client.FilterDMX(TEST_UNIVERSE, 100, buffer, now));
+}
+
+
+/*
+ * Check a frame held back by max_fps is sent once the interval is up, so the
+ * client catches up even if the universe stops changing.
+ */
+void ClientTest::testHeldFrame() {
+  DeferredClientStub *stub = new DeferredClientStub();
+  Client client(stub, m_test_uid);
+  FakeScheduler scheduler;
+  client.SetScheduler(&scheduler);
+
+  // 10 fps, one frame every 100ms.
+  Client::DmxSubscription subscription;
+  subscription.max_fps = 10;
+  client.SetDmxSubscription(TEST_UNIVERSE, subscription);
+
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  DmxBuffer buffer1("1"), buffer2("2"), buffer3("3");
+  const DmxBuffer *frame = client.FilterDMX(TEST_UNIVERSE, 100, buffer1, now);
+  OLA_ASSERT_NOT_NULL(frame);
+  OLA_ASSERT_TRUE(client.SendDMX(TEST_UNIVERSE, 100, *frame));
+  stub->Ack();
+
+  // Two frames inside the interval, then silence.
+  now += TimeInterval(0, 20000);
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, buffer2, now));
+  OLA_ASSERT_TRUE(scheduler.Registered());
+  OLA_ASSERT_EQ(TimeInterval(0, 80000), scheduler.Delay());
+  now += TimeInterval(0, 20000);
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, buffer3, now));
+  OLA_ASSERT_EQ(1u, scheduler.Registrations());
+
+  // The latest frame is sent when the timeout runs.
+  scheduler.Fire();
+  OLA_ASSERT_EQ(static_cast<size_t>(2), stub->m_data.size());
+  OLA_ASSERT_EQ(string("3"), stub->m_data[1]);
+  stub->Ack();
+
+  // The held frame counts as sent at 100ms, so 120ms is too soon. A newer
+  // frame that's sent first cancels the held one.
+  now += TimeInterval(0, 80000);
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, buffer1, now));
+  OLA_ASSERT_TRUE(scheduler.Registered());
+  now += TimeInterval(0, 100000);
+  frame = client.FilterDMX(TEST_UNIVERSE, 100, buffer2, now);
+  OLA_ASSERT_NOT_NULL(frame);
+  OLA_ASSERT_EQ(buffer2, *frame);
+  OLA_ASSERT_FALSE(scheduler.Registered());
+
+  // Removing the subscription cancels the held frame.
+  now += TimeInterval(0, 10000);
+  OLA_ASSERT_NULL(client.FilterDMX(TEST_UNIVERSE, 100, buffer3, now));
+  OLA_ASSERT_TRUE(scheduler.Registered());
+  client.SetDmxSubscription(TEST_UNIVERSE, Client::DmxSubscription());
+  OLA_ASSERT_FALSE(scheduler.Registered());
+  OLA_ASSERT_EQ(static_cast<size_t>(2), stub->m_data.size());
 }
@@ -22,16 +22,20 @@
 #include "olad/plugin_api/DeviceManager.h"
 
 #include <stdio.h>
-#include <errno.h>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/Port.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+#include "olad/plugin_api/OutputCurve.h"
 #include "olad/plugin_api/PortManager.h"
 
 namespace ola {
@@ -45,6 +49,11 @@ const unsigned int DeviceManager::MISSING_DEVICE_ALIAS = 0;
 const char DeviceManager::PORT_PREFERENCES[] = "port";
 const char DeviceManager::PRIORITY_VALUE_SUFFIX[] = "_priority_value";
 const char DeviceManager::PRIORITY_MODE_SUFFIX[] = "_priority_mode";
+const char DeviceManager::OUTPUT_CURVE_SUFFIX[] = "_output_curve";
+const char DeviceManager::REFRESH_INTERVAL_SUFFIX[] = "_refresh_interval";
+const char DeviceManager::SUPPRESS_DUPLICATES_SUFFIX[] =
+    "_suppress_duplicates";
+const char DeviceManager::UIDS_SUFFIX[] = "_uids";
 
 bool operator <(const device_alias_pair& left,
                 const device_alias_pair &right) {
@@ -57,7 +66,8 @@ DeviceManager::DeviceManager(PreferencesFactory *prefs_factory,
                              PortManager *port_manager)
     : m_port_preferences(NULL),
       m_port_manager(port_manager),
-      m_next_device_alias(FIRST_DEVICE_ALIAS) {
+      m_next_device_alias(FIRST_DEVICE_ALIAS),
+      m_generation(0) {
   if (prefs_factory) {
     m_port_preferences = prefs_factory->NewPreference(PORT_PREFERENCES);
     m_port_preferences->Load();
@@ -107,10 +117,23 @@ bool DeviceManager::RegisterDevice(AbstractDevice *device) {
 
   vector<InputPort*> input_ports;
   device->InputPorts(&input_ports);
+  vector<InputPort*>::const_iterator input_iter = input_ports.begin();
+  for (; input_iter != input_ports.end(); ++input_iter) {
+    RestoreSuppressDuplicates(*input_iter);
+  }
   RestorePortSettings(input_ports);
 
   vector<OutputPort*> output_ports;
   device->OutputPorts(&output_ports);
+  // The curve and frame filter are set first so that data sent as the port
+  // is patched is corrected. The UIDs are restored before patching so the
+  // discovery run on patching only has to check them.
+  vector<OutputPort*>::const_iterator curve_iter = output_ports.begin();
+  for (; curve_iter != output_ports.end(); ++curve_iter) {
+    RestoreOutputCurve(*curve_iter);
+    RestoreFrameFilter(*curve_iter);
+    RestoreUIDs(*curve_iter);
+  }
   RestorePortSettings(output_ports);
 
   // look for timecode ports and add them to the set
@@ -121,6 +144,7 @@ bool DeviceManager::RegisterDevice(AbstractDevice *device) {
     }
   }
 
+  m_alias_generations[alias] = ++m_generation;
   return true;
 }
 
@@ -133,6 +157,7 @@ bool DeviceManager::UnregisterDevice(const string &device_id) {
 
   ReleaseDevice(pair->device);
   STLRemove(&m_alias_map, pair->alias);
+  m_alias_generations[pair->alias] = ++m_generation;
 
   pair->device = NULL;
   return true;
@@ -182,12 +207,41 @@ device_alias_pair DeviceManager::GetDevice(const string &unique_id) const {
 void DeviceManager::UnregisterAllDevices() {
   DeviceIdMap::iterator iter;
   for (iter = m_devices.begin(); iter != m_devices.end(); ++iter) {
+    if (iter->second.device) {
+      m_alias_generations[iter->second.alias] = ++m_generation;
+    }
     ReleaseDevice(iter->second.device);
     iter->second.device = NULL;
   }
   m_alias_map.clear();
 }
 
+void DeviceManager::DeviceChanged(const AbstractDevice *device) {
+  const device_alias_pair *pair = device ?
+      STLFind(&m_devices, device->UniqueId()) : NULL;
+  if (pair && pair->device) {
+    m_alias_generations[pair->alias] = ++m_generation;
+  }
+}
+
+void DeviceManager::GetChanges(uint64_t since,
+                               vector<device_alias_pair> *changed,
+                               vector<unsigned int> *removed) const {
+  map<unsigned int, uint64_t>::const_iterator iter =
+      m_alias_generations.begin();
+  for (; iter != m_alias_generations.end(); ++iter) {
+    if (iter->second <= since) {
+      continue;
+    }
+    AbstractDevice *device = STLFindOrNull(m_alias_map, iter->first);
+    if (device) {
+      changed->push_back(device_alias_pair(iter->first, device));
+    } else {
+      removed->push_back(iter->first);
+    }
+  }
+}
+
 void DeviceManager::SendTimeCode(const ola::timecode::TimeCode &timecode) {
   set<OutputPort*>::iterator iter = m_timecode_ports.begin();
   for (; iter != m_timecode_ports.end(); iter++) {
@@ -219,6 +273,7 @@ void DeviceManager::ReleaseDevice(const AbstractDevice *device) {
   vector<OutputPort*>::const_iterator output_iter = output_ports.begin();
   for (; output_iter != output_ports.end(); ++output_iter) {
     SavePortPriority(**output_iter);
+    SaveUIDs(**output_iter);
 
     // remove from the timecode port set
     STLRemove(&m_timecode_ports, *output_iter);
@@ -273,6 +328,28 @@ void DeviceManager::SavePortPriority(const Port &port) const {
 }
 
 
+/*
+ * Save the UIDs that were discovered on an output port.
+ */
+void DeviceManager::SaveUIDs(const OutputPort &port) const {
+  string port_id = port.UniqueId();
+  if (port_id.empty() || !port.SupportsRDM()) {
+    return;
+  }
+
+  ola::rdm::UIDSet uids;
+  if (port.GetUniverse()) {
+    port.GetUniverse()->GetUIDs(&port, &uids);
+  }
+
+  if (uids.Empty()) {
+    m_port_preferences->RemoveValue(port_id + UIDS_SUFFIX);
+  } else {
+    m_port_preferences->SetValue(port_id + UIDS_SUFFIX, uids.ToString());
+  }
+}
+
+
 /*
  * Restore the priority settings for a port
  */
@@ -310,6 +387,119 @@ void DeviceManager::RestorePortPriority(Port *port) const {
 }
 
 
+/*
+ * Restore the curve for an output port.
+ */
+void DeviceManager::RestoreOutputCurve(OutputPort *port) const {
+  if (!m_port_preferences) {
+    return;
+  }
+
+  string port_id = port->UniqueId();
+  if (port_id.empty()) {
+    return;
+  }
+
+  string description = m_port_preferences->GetValue(
+      port_id + OUTPUT_CURVE_SUFFIX);
+  if (description.empty()) {
+    port->SetOutputCurve(NULL);
+    return;
+  }
+
+  OutputCurve *curve = OutputCurve::FromString(description);
+  if (!curve) {
+    OLA_WARN << "Invalid output curve for " << port_id << ": "
+             << description;
+  }
+  port->SetOutputCurve(curve);
+}
+
+
+/*
+ * Restore the DuplicateFrameFilter for an output port.
+ */
+void DeviceManager::RestoreFrameFilter(OutputPort *port) const {
+  if (!m_port_preferences) {
+    return;
+  }
+
+  string port_id = port->UniqueId();
+  if (port_id.empty()) {
+    return;
+  }
+
+  string interval = m_port_preferences->GetValue(
+      port_id + REFRESH_INTERVAL_SUFFIX);
+  if (interval.empty()) {
+    port->SetDuplicateFrameFilter(NULL);
+    return;
+  }
+
+  DuplicateFrameFilter *filter = DuplicateFrameFilter::FromString(interval);
+  if (!filter) {
+    OLA_WARN << "Invalid refresh interval for " << port_id << ": "
+             << interval;
+  }
+  port->SetDuplicateFrameFilter(filter);
+}
+
+
+/*
+ * Restore duplicate frame suppression for an input port.
+ */
+void DeviceManager::RestoreSuppressDuplicates(InputPort *port) const {
+  if (!m_port_preferences) {
+    return;
+  }
+
+  string port_id = port->UniqueId();
+  if (port_id.empty()) {
+    return;
+  }
+
+  port->SetSuppressDuplicates(m_port_preferences->GetValueAsBool(
+      port_id + SUPPRESS_DUPLICATES_SUFFIX));
+}
+
+
+/*
+ * Restore the UIDs for an output port.
+ */
+void DeviceManager::RestoreUIDs(OutputPort *port) const {
+  if (!m_port_preferences || !port->SupportsRDM()) {
+    return;
+  }
+
+  string port_id = port->UniqueId();
+  if (port_id.empty()) {
+    return;
+  }
+
+  vector<string> tokens;
+  StringSplit(m_port_preferences->GetValue(port_id + UIDS_SUFFIX), &tokens,
+              ",");
+  ola::rdm::UIDSet uids;
+  vector<string>::const_iterator iter = tokens.begin();
+  for (; iter != tokens.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+    std::auto_ptr<ola::rdm::UID> uid(ola::rdm::UID::FromString(*iter));
+    if (uid.get()) {
+      uids.AddUID(*uid);
+    } else {
+      OLA_WARN << "Invalid UID for " << port_id << ": " << *iter;
+    }
+  }
+
+  if (!uids.Empty()) {
+    OLA_INFO << "Restored " << uids.Size() << " UIDs for " << port_id;
+    port->RestoreUIDs(uids);
+  }
+}
+
+
 /*
  * Restore the patching information for a port.
  */
@@ -329,13 +519,8 @@ void DeviceManager::RestorePortSettings(const vector<PortClass*> &ports) const {
     if (port_id.empty())
       continue;
 
-    string uni_id = m_port_preferences->GetValue(port_id);
-    if (uni_id.empty())
-      continue;
-
-    errno = 0;
-    int id = static_cast<int>(strtol(uni_id.c_str(), NULL, 10));
-    if ((id == 0 && errno) || id < 0)
+    unsigned int id;
+    if (!m_port_preferences->GetValueAsUInt(port_id, &id))
       continue;
 
     m_port_manager->PatchPort(port, id);
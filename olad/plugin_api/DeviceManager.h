@@ -21,6 +21,8 @@
 #ifndef OLAD_PLUGIN_API_DEVICEMANAGER_H_
 #define OLAD_PLUGIN_API_DEVICEMANAGER_H_
 
+#include <stdint.h>
+
 #include <map>
 #include <set>
 #include <string>
@@ -128,6 +130,30 @@ class DeviceManager {
    */
   void UnregisterAllDevices();
 
+  /**
+   * @brief Mark a device as changed, e.g. when one of its ports is patched.
+   * @param device the device that changed.
+   */
+  void DeviceChanged(const AbstractDevice *device);
+
+  /**
+   * @brief The current generation.
+   *
+   * The generation is incremented each time a device is registered,
+   * unregistered or changed.
+   */
+  uint64_t Generation() const { return m_generation; }
+
+  /**
+   * @brief Find the devices that changed since a generation.
+   * @param since the generation.
+   * @param[out] changed the devices that were registered or changed.
+   * @param[out] removed the aliases of the devices that were unregistered.
+   */
+  void GetChanges(uint64_t since,
+                  std::vector<device_alias_pair> *changed,
+                  std::vector<unsigned int> *removed) const;
+
 
   /**
    * @brief Send timecode to all ports which support timecode.
@@ -148,6 +174,9 @@ class DeviceManager {
   DeviceAliasMap m_alias_map;
 
   unsigned int m_next_device_alias;
+  uint64_t m_generation;
+  // The generation each alias last changed at, including unregistered ones.
+  std::map<unsigned int, uint64_t> m_alias_generations;
   std::set<class OutputPort*> m_timecode_ports;
 
   void ReleaseDevice(const AbstractDevice *device);
@@ -158,6 +187,11 @@ class DeviceManager {
 
   void SavePortPriority(const Port &port) const;
   void RestorePortPriority(Port *port) const;
+  void RestoreOutputCurve(OutputPort *port) const;
+  void RestoreFrameFilter(OutputPort *port) const;
+  void RestoreSuppressDuplicates(InputPort *port) const;
+  void SaveUIDs(const OutputPort &port) const;
+  void RestoreUIDs(OutputPort *port) const;
 
   template <class PortClass>
   void RestorePortSettings(const std::vector<PortClass*> &ports) const;
@@ -166,6 +200,10 @@ class DeviceManager {
   static const unsigned int FIRST_DEVICE_ALIAS = 1;
   static const char PRIORITY_VALUE_SUFFIX[];
   static const char PRIORITY_MODE_SUFFIX[];
+  static const char OUTPUT_CURVE_SUFFIX[];
+  static const char REFRESH_INTERVAL_SUFFIX[];
+  static const char SUPPRESS_DUPLICATES_SUFFIX[];
+  static const char UIDS_SUFFIX[];
 
   DISALLOW_COPY_AND_ASSIGN(DeviceManager);
 };
@@ -24,11 +24,15 @@
 
 #include "ola/Logging.h"
 #include "ola/DmxBuffer.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
 #include "olad/Plugin.h"
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
 #include "olad/plugin_api/DeviceManager.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+#include "olad/plugin_api/OutputCurve.h"
 #include "olad/plugin_api/PortManager.h"
 #include "olad/plugin_api/TestCommon.h"
 #include "olad/plugin_api/UniverseStore.h"
@@ -43,6 +47,8 @@ using ola::Port;
 using ola::PortManager;
 using ola::Universe;
 using ola::UniverseStore;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
 using std::string;
 using std::vector;
 
@@ -52,12 +58,18 @@ class DeviceManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testDeviceManager);
   CPPUNIT_TEST(testRestorePatchings);
   CPPUNIT_TEST(testRestorePriorities);
+  CPPUNIT_TEST(testRestoreOutputCurves);
+  CPPUNIT_TEST(testRestoreFrameFilters);
+  CPPUNIT_TEST(testRestoreUIDs);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testDeviceManager();
     void testRestorePatchings();
     void testRestorePriorities();
+    void testRestoreOutputCurves();
+    void testRestoreFrameFilters();
+    void testRestoreUIDs();
 };
 
 
@@ -291,3 +303,151 @@ void DeviceManagerTest::testRestorePriorities() {
   OLA_ASSERT_EQ(string("60"),
                 prefs->GetValue("2-test_device_1-O-3_priority_value"));
 }
+
+
+/*
+ * Test that output curves are restored and applied to data sent on patch.
+ */
+void DeviceManagerTest::testRestoreOutputCurves() {
+  ola::MemoryPreferencesFactory prefs_factory;
+  UniverseStore uni_store(NULL, NULL);
+  ola::PortBroker broker;
+  PortManager port_manager(&uni_store, &broker);
+  DeviceManager manager(&prefs_factory, &port_manager);
+
+  ola::Preferences *prefs = prefs_factory.NewPreference("port");
+  OLA_ASSERT(prefs);
+  prefs->SetValue("2-test_device_1-O-1", "1");
+  prefs->SetValue("2-test_device_1-O-1_output_curve", "square");
+  prefs->SetValue("2-test_device_1-O-2_output_curve", "gamma foo");
+
+  // there is data waiting in universe 1
+  Universe *universe = uni_store.GetUniverseOrCreate(1);
+  DmxBuffer buffer;
+  buffer.SetFromString("0,128,255");
+  OLA_ASSERT(universe->SetDMX(buffer));
+
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device1(&plugin, "test_device_1");
+  TestMockOutputPort output_port(&device1, 1);
+  TestMockOutputPort output_port2(&device1, 2);
+  TestMockOutputPort output_port3(&device1, 3);
+  device1.AddPort(&output_port);
+  device1.AddPort(&output_port2);
+  device1.AddPort(&output_port3);
+
+  OLA_ASSERT(manager.RegisterDevice(&device1));
+  OLA_ASSERT_NOT_NULL(output_port.GetOutputCurve());
+  OLA_ASSERT_EQ(string("square"),
+                output_port.GetOutputCurve()->Description());
+  // invalid curves are ignored
+  OLA_ASSERT_NULL(output_port2.GetOutputCurve());
+  OLA_ASSERT_NULL(output_port3.GetOutputCurve());
+
+  OLA_ASSERT(universe->SetDMX(buffer));
+  DmxBuffer expected;
+  expected.SetFromString("0,64,255");
+  OLA_ASSERT(expected == output_port.ReadDMX());
+  // the universe itself is unchanged
+  OLA_ASSERT(buffer == universe->GetDMX());
+
+  OLA_ASSERT(manager.UnregisterDevice(&device1));
+}
+
+
+/*
+ * Test that the UIDs on RDM ports are saved & restored.
+ */
+void DeviceManagerTest::testRestoreUIDs() {
+  ola::MemoryPreferencesFactory prefs_factory;
+  UniverseStore uni_store(NULL, NULL);
+  ola::PortBroker broker;
+  PortManager port_manager(&uni_store, &broker);
+  DeviceManager manager(&prefs_factory, &port_manager);
+
+  ola::Preferences *prefs = prefs_factory.NewPreference("port");
+  OLA_ASSERT(prefs);
+  prefs->SetValue("2-test_device_1-O-1", "1");
+  prefs->SetValue("2-test_device_1-O-1_uids",
+                  "7a70:00000001,foo,7a70:00000002");
+  prefs->SetValue("2-test_device_1-O-2", "1");
+  prefs->SetValue("2-test_device_1-O-2_uids", "7a70:00000003");
+
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device1(&plugin, "test_device_1");
+  TestMockOutputPort output_port(&device1, 1, false, true);
+  // this port doesn't support RDM, so the UIDs are ignored
+  TestMockOutputPort output_port2(&device1, 2);
+  device1.AddPort(&output_port);
+  device1.AddPort(&output_port2);
+
+  OLA_ASSERT(manager.RegisterDevice(&device1));
+  Universe *universe = uni_store.GetUniverse(1);
+  OLA_ASSERT_NOT_NULL(universe);
+
+  // the UIDs are available before discovery has run
+  UIDSet expected;
+  expected.AddUID(UID(0x7a70, 1));
+  expected.AddUID(UID(0x7a70, 2));
+  UIDSet uids;
+  universe->GetUIDs(&uids);
+  OLA_ASSERT_EQ(expected, uids);
+
+  // discovery finds a different set of UIDs
+  UIDSet discovered;
+  discovered.AddUID(UID(0x7a70, 1));
+  discovered.AddUID(UID(0x7a70, 4));
+  universe->NewUIDList(&output_port, discovered);
+
+  OLA_ASSERT(manager.UnregisterDevice(&device1));
+  OLA_ASSERT_EQ(string("7a70:00000001,7a70:00000004"),
+                prefs->GetValue("2-test_device_1-O-1_uids"));
+}
+
+
+/*
+ * Test that the frame filters are restored from the refresh intervals.
+ */
+void DeviceManagerTest::testRestoreFrameFilters() {
+  ola::MemoryPreferencesFactory prefs_factory;
+  UniverseStore uni_store(NULL, NULL);
+  ola::PortBroker broker;
+  PortManager port_manager(&uni_store, &broker);
+  DeviceManager manager(&prefs_factory, &port_manager);
+
+  ola::Preferences *prefs = prefs_factory.NewPreference("port");
+  OLA_ASSERT(prefs);
+  prefs->SetValue("2-test_device_1-O-1", "1");
+  prefs->SetValue("2-test_device_1-O-1_refresh_interval", "1000");
+  prefs->SetValue("2-test_device_1-O-2_refresh_interval", "0");
+
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device1(&plugin, "test_device_1");
+  TestMockOutputPort output_port(&device1, 1);
+  TestMockOutputPort output_port2(&device1, 2);
+  TestMockOutputPort output_port3(&device1, 3);
+  device1.AddPort(&output_port);
+  device1.AddPort(&output_port2);
+  device1.AddPort(&output_port3);
+
+  OLA_ASSERT(manager.RegisterDevice(&device1));
+  const ola::DuplicateFrameFilter *filter =
+      output_port.GetDuplicateFrameFilter();
+  OLA_ASSERT_NOT_NULL(filter);
+  OLA_ASSERT_EQ(ola::TimeInterval(1, 0), filter->RefreshInterval());
+  // invalid intervals are ignored
+  OLA_ASSERT_NULL(output_port2.GetDuplicateFrameFilter());
+  OLA_ASSERT_NULL(output_port3.GetDuplicateFrameFilter());
+
+  // the port was patched, so repeated frames are now suppressed
+  Universe *universe = uni_store.GetUniverse(1);
+  OLA_ASSERT_NOT_NULL(universe);
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(universe->SetDMX(buffer));
+  OLA_ASSERT(universe->SetDMX(buffer));
+  OLA_ASSERT(buffer == output_port.ReadDMX());
+  OLA_ASSERT_EQ(1u, filter->SuppressedFrames());
+
+  OLA_ASSERT(manager.UnregisterDevice(&device1));
+}
@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DuplicateFrameFilter.cpp
+ * Suppresses unchanged frames on an output port.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <string>
+
+#include "ola/StringUtils.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+
+namespace ola {
+
+using std::string;
+
+DuplicateFrameFilter::DuplicateFrameFilter(
+    const TimeInterval &refresh_interval)
+    : m_refresh_interval(refresh_interval),
+      m_has_frame(false),
+      m_priority(0),
+      m_length(0),
+      m_suppressed(0) {
+}
+
+DuplicateFrameFilter *DuplicateFrameFilter::FromString(
+    const string &description) {
+  unsigned int interval_ms;
+  if (!StringToInt(description, &interval_ms) || interval_ms == 0) {
+    return NULL;
+  }
+  return new DuplicateFrameFilter(
+      TimeInterval(static_cast<int64_t>(interval_ms) * ONE_THOUSAND));
+}
+
+bool DuplicateFrameFilter::ShouldSend(const DmxBuffer &buffer,
+                                      uint8_t priority,
+                                      const TimeStamp &now) {
+  const unsigned int length = buffer.Size();
+  // memcmp is vectorized by the C library, and stops at the first change.
+  if (m_has_frame && priority == m_priority && length == m_length &&
+      now < m_last_sent + m_refresh_interval &&
+      (length == 0 || 0 == memcmp(m_frame, buffer.GetRaw(), length))) {
+    m_suppressed++;
+    return false;
+  }
+
+  if (length) {
+    memcpy(m_frame, buffer.GetRaw(), length);
+  }
+  m_length = length;
+  m_priority = priority;
+  m_last_sent = now;
+  m_has_frame = true;
+  return true;
+}
+}  // namespace ola
@@ -0,0 +1,97 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DuplicateFrameFilter.h
+ * Suppresses unchanged frames on an output port.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_DUPLICATEFRAMEFILTER_H_
+#define OLAD_PLUGIN_API_DUPLICATEFRAMEFILTER_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief Drops frames that are the same as the last one written to an output
+ * port.
+ *
+ * An unchanged frame is still written once the refresh interval has passed
+ * since the last write, so devices that time out without data keep their
+ * levels. A change in the data, length or priority is always written.
+ *
+ * Filters are created from the "<port id>_refresh_interval" port
+ * preferences, which hold the refresh interval in milliseconds.
+ */
+class DuplicateFrameFilter {
+ public:
+  /**
+   * @brief Create a new filter.
+   * @param refresh_interval how often to write unchanged frames.
+   */
+  explicit DuplicateFrameFilter(const TimeInterval &refresh_interval);
+
+  /**
+   * @brief Create a filter from a preference value.
+   * @param description the refresh interval in milliseconds.
+   * @returns a new DuplicateFrameFilter, or NULL if the description wasn't a
+   *   positive number.
+   */
+  static DuplicateFrameFilter *FromString(const std::string &description);
+
+  /**
+   * @brief Check if a frame should be written to the port.
+   * @param buffer the frame, after any OutputCurve has been applied.
+   * @param priority the priority the frame would be written with.
+   * @param now the current time.
+   * @returns true if the frame should be written, false if it's suppressed.
+   */
+  bool ShouldSend(const DmxBuffer &buffer, uint8_t priority,
+                  const TimeStamp &now);
+
+  /**
+   * @brief Forget the last frame, so the next one is always written.
+   */
+  void Reset() { m_has_frame = false; }
+
+  const TimeInterval &RefreshInterval() const { return m_refresh_interval; }
+
+  /**
+   * @brief The number of frames that have been suppressed.
+   */
+  unsigned int SuppressedFrames() const { return m_suppressed; }
+
+ private:
+  const TimeInterval m_refresh_interval;
+  bool m_has_frame;
+  uint8_t m_priority;
+  unsigned int m_length;
+  TimeStamp m_last_sent;
+  unsigned int m_suppressed;
+  // A plain copy rather than a DmxBuffer, sharing the universe's buffer would
+  // force a copy on each write to it.
+  uint8_t m_frame[DMX_UNIVERSE_SIZE];
+
+  DISALLOW_COPY_AND_ASSIGN(DuplicateFrameFilter);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_DUPLICATEFRAMEFILTER_H_
@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DuplicateFrameFilterTest.cpp
+ * Test fixture for the DuplicateFrameFilter class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::DmxBuffer;
+using ola::DuplicateFrameFilter;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using std::auto_ptr;
+
+class DuplicateFrameFilterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DuplicateFrameFilterTest);
+  CPPUNIT_TEST(testFromString);
+  CPPUNIT_TEST(testSuppression);
+  CPPUNIT_TEST(testRefresh);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testFromString();
+    void testSuppression();
+    void testRefresh();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DuplicateFrameFilterTest);
+
+
+/*
+ * Check filters are created from the preference values.
+ */
+void DuplicateFrameFilterTest::testFromString() {
+  auto_ptr<DuplicateFrameFilter> filter(
+      DuplicateFrameFilter::FromString("1500"));
+  OLA_ASSERT_NOT_NULL(filter.get());
+  OLA_ASSERT_EQ(TimeInterval(1, 500000), filter->RefreshInterval());
+
+  filter.reset(DuplicateFrameFilter::FromString("0"));
+  OLA_ASSERT_NULL(filter.get());
+  filter.reset(DuplicateFrameFilter::FromString("-1"));
+  OLA_ASSERT_NULL(filter.get());
+  filter.reset(DuplicateFrameFilter::FromString("foo"));
+  OLA_ASSERT_NULL(filter.get());
+  filter.reset(DuplicateFrameFilter::FromString(""));
+  OLA_ASSERT_NULL(filter.get());
+}
+
+
+/*
+ * Check that only changes in the data or priority are sent.
+ */
+void DuplicateFrameFilterTest::testSuppression() {
+  DuplicateFrameFilter filter(TimeInterval(1, 0));
+  struct timeval tv = {1000, 0};
+  TimeStamp now(tv);
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 100, now));
+  OLA_ASSERT_FALSE(filter.ShouldSend(buffer, 100, now));
+  OLA_ASSERT_EQ(1u, filter.SuppressedFrames());
+
+  // a copy of the same data is still a duplicate
+  DmxBuffer copy(buffer.GetRaw(), buffer.Size());
+  OLA_ASSERT_FALSE(filter.ShouldSend(copy, 100, now));
+
+  // changes to the priority, data or length are always sent
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 50, now));
+  buffer.SetChannel(2, 4);
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 50, now));
+  buffer.SetChannel(3, 0);
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 50, now));
+  OLA_ASSERT_FALSE(filter.ShouldSend(buffer, 50, now));
+
+  DmxBuffer full;
+  full.Blackout();
+  OLA_ASSERT_TRUE(filter.ShouldSend(full, 50, now));
+  OLA_ASSERT_FALSE(filter.ShouldSend(full, 50, now));
+  full.SetChannel(511, 1);
+  OLA_ASSERT_TRUE(filter.ShouldSend(full, 50, now));
+
+  // empty frames
+  DmxBuffer empty;
+  OLA_ASSERT_TRUE(filter.ShouldSend(empty, 50, now));
+  OLA_ASSERT_FALSE(filter.ShouldSend(empty, 50, now));
+  OLA_ASSERT_EQ(5u, filter.SuppressedFrames());
+
+  // after a reset the next frame is always sent
+  filter.Reset();
+  OLA_ASSERT_TRUE(filter.ShouldSend(empty, 50, now));
+}
+
+
+/*
+ * Check unchanged frames are sent once the refresh interval passes.
+ */
+void DuplicateFrameFilterTest::testRefresh() {
+  DuplicateFrameFilter filter(TimeInterval(1, 0));
+  struct timeval tv = {1000, 0};
+  TimeStamp now(tv);
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 100, now));
+  now += TimeInterval(0, 999999);
+  OLA_ASSERT_FALSE(filter.ShouldSend(buffer, 100, now));
+  now += TimeInterval(0, 1);
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 100, now));
+
+  // the interval runs from the last frame sent
+  now += TimeInterval(0, 500000);
+  OLA_ASSERT_FALSE(filter.ShouldSend(buffer, 100, now));
+  now += TimeInterval(0, 500000);
+  OLA_ASSERT_TRUE(filter.ShouldSend(buffer, 100, now));
+  OLA_ASSERT_EQ(2u, filter.SuppressedFrames());
+}
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InputFrameStats.cpp
+ * Tracks the interval between the frames received on an input port.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/InputFrameStats.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/base/Array.h"
+
+namespace ola {
+
+using std::string;
+using std::vector;
+
+namespace {
+/*
+ * The bucket bounds in microseconds. DMX512 at full speed is ~23ms a frame,
+ * and E1.31 and Art-Net send at least every second or so when the data
+ * doesn't change.
+ */
+vector<uint64_t> IntervalBounds() {
+  const uint64_t bounds[] = {
+    5000, 10000, 15000, 20000, 23000, 25000, 30000, 40000, 50000, 75000,
+    100000, 250000, 500000, 1000000, 2500000
+  };
+  return vector<uint64_t>(bounds, bounds + arraysize(bounds));
+}
+
+// The gain of the smoothed mean and jitter, from RFC 3550.
+const int64_t SMOOTHING_DIVISOR = 16;
+}  // namespace
+
+const char InputFrameStats::K_FRAME_INTERVAL_VAR[] = "input-frame-interval-us";
+const char InputFrameStats::K_FRAMES_VAR[] = "input-frames";
+const char InputFrameStats::K_GAPS_VAR[] = "input-frame-gaps";
+const char InputFrameStats::K_FPS_VAR[] = "input-fps";
+const char InputFrameStats::K_JITTER_VAR[] = "input-frame-jitter-us";
+
+InputFrameStats::InputFrameStats(ExportMap *export_map, const string &port_id)
+    : m_port_id(port_id),
+      m_export_map(export_map),
+      m_interval_var(NULL),
+      m_frames_var(NULL),
+      m_gaps_var(NULL),
+      m_fps_var(NULL),
+      m_jitter_var(NULL),
+      m_window_frames(0),
+      m_intervals(0),
+      m_frames(0),
+      m_gaps(0),
+      m_fps(0),
+      m_mean_us(0),
+      m_jitter_us(0),
+      m_last_interval_us(0) {
+  if (m_export_map) {
+    m_interval_var = IntervalMap(m_export_map)->Get(m_port_id);
+    m_frames_var = &(*m_export_map->GetUIntMapVar(K_FRAMES_VAR, "port"))[
+        m_port_id];
+    m_gaps_var = &(*m_export_map->GetUIntMapVar(K_GAPS_VAR, "port"))[
+        m_port_id];
+    m_fps_var = &(*m_export_map->GetUIntMapVar(K_FPS_VAR, "port"))[
+        m_port_id];
+    m_jitter_var = &(*m_export_map->GetUIntMapVar(K_JITTER_VAR, "port"))[
+        m_port_id];
+  }
+}
+
+InputFrameStats::~InputFrameStats() {
+  if (!m_export_map) {
+    return;
+  }
+  IntervalMap(m_export_map)->Remove(m_port_id);
+  const char *vars[] = {K_FRAMES_VAR, K_GAPS_VAR, K_FPS_VAR, K_JITTER_VAR};
+  for (unsigned int i = 0; i < arraysize(vars); i++) {
+    m_export_map->GetUIntMapVar(vars[i], "port")->Remove(m_port_id);
+  }
+}
+
+void InputFrameStats::RecordFrame(const TimeStamp &now) {
+  m_frames++;
+
+  if (!m_window_start.IsSet()) {
+    m_window_start = now;
+  } else if (now - m_window_start >= TimeInterval(1, 0)) {
+    const int64_t window_us = (now - m_window_start).AsInt();
+    m_fps = static_cast<unsigned int>(
+        (static_cast<int64_t>(m_window_frames) * USEC_IN_SECONDS +
+         window_us / 2) / window_us);
+    m_window_start = now;
+    m_window_frames = 0;
+  }
+  m_window_frames++;
+
+  if (m_last_frame.IsSet() && now >= m_last_frame) {
+    const int64_t interval = (now - m_last_frame).AsInt();
+    if (m_interval_var) {
+      m_interval_var->Observe(interval);
+    }
+
+    if (m_intervals == 0) {
+      m_mean_us = static_cast<unsigned int>(interval);
+      m_last_interval_us = static_cast<unsigned int>(interval);
+      m_intervals++;
+    } else if (m_intervals >= MIN_INTERVALS &&
+               interval > static_cast<int64_t>(GAP_FACTOR) * m_mean_us) {
+      m_gaps++;
+    } else {
+      const int64_t mean = m_mean_us;
+      m_mean_us = static_cast<unsigned int>(
+          mean + (interval - mean) / SMOOTHING_DIVISOR);
+
+      int64_t delta = interval - m_last_interval_us;
+      if (delta < 0) {
+        delta = -delta;
+      }
+      const int64_t jitter = m_jitter_us;
+      m_jitter_us = static_cast<unsigned int>(
+          jitter + (delta - jitter) / SMOOTHING_DIVISOR);
+      m_last_interval_us = static_cast<unsigned int>(interval);
+      m_intervals++;
+    }
+  }
+  m_last_frame = now;
+
+  if (m_frames_var) {
+    *m_frames_var = m_frames;
+    *m_gaps_var = m_gaps;
+    *m_fps_var = m_fps;
+    *m_jitter_var = m_jitter_us;
+  }
+}
+
+void InputFrameStats::Reset() {
+  m_last_frame = TimeStamp();
+  m_window_start = TimeStamp();
+  m_window_frames = 0;
+}
+
+bool InputFrameStats::ReadSummary(ExportMap *export_map,
+                                  const string &port_id,
+                                  Summary *summary) {
+  // The histogram exists for as long as the port has stats, checking it
+  // first avoids adding entries to the maps for ports without them.
+  if (!IntervalMap(export_map)->Find(port_id)) {
+    return false;
+  }
+  summary->frames = (*export_map->GetUIntMapVar(K_FRAMES_VAR, "port"))[
+      port_id];
+  summary->gaps = (*export_map->GetUIntMapVar(K_GAPS_VAR, "port"))[port_id];
+  summary->fps = (*export_map->GetUIntMapVar(K_FPS_VAR, "port"))[port_id];
+  summary->jitter_us = (*export_map->GetUIntMapVar(K_JITTER_VAR, "port"))[
+      port_id];
+  return true;
+}
+
+HistogramMap *InputFrameStats::IntervalMap(ExportMap *export_map) {
+  return export_map->GetHistogramMapVar(K_FRAME_INTERVAL_VAR, "port",
+                                        IntervalBounds());
+}
+}  // namespace ola
@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InputFrameStats.h
+ * Tracks the interval between the frames received on an input port.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_INPUTFRAMESTATS_H_
+#define OLAD_PLUGIN_API_INPUTFRAMESTATS_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief Tracks the interval between the frames received on an input port.
+ *
+ * Each interval is recorded in a histogram in the ExportMap, in
+ * microseconds. The mean interval and the jitter are smoothed as in RFC 3550,
+ * so a console that sends in bursts, or a network that delays some packets,
+ * shows up as jitter rather than just a lower frame rate.
+ *
+ * An interval more than GAP_FACTOR times the mean is counted as a gap, and
+ * isn't included in the mean or jitter.
+ */
+class InputFrameStats {
+ public:
+  /**
+   * @brief The stats for a port, as read from the ExportMap.
+   */
+  struct Summary {
+    unsigned int frames;
+    unsigned int gaps;
+    unsigned int fps;
+    unsigned int jitter_us;
+  };
+
+  /**
+   * @brief Create a new InputFrameStats.
+   * @param export_map the ExportMap to update, may be NULL.
+   * @param port_id the UniqueId() of the port.
+   */
+  InputFrameStats(ExportMap *export_map, const std::string &port_id);
+
+  /**
+   * @brief Destructor, this removes the variables for the port.
+   */
+  ~InputFrameStats();
+
+  /**
+   * @brief Record a frame.
+   * @param now the time the frame arrived.
+   */
+  void RecordFrame(const TimeStamp &now);
+
+  /**
+   * @brief Forget the last frame, e.g. when the port is patched to a new
+   * universe. The counts are kept.
+   */
+  void Reset();
+
+  unsigned int Frames() const { return m_frames; }
+  unsigned int Gaps() const { return m_gaps; }
+
+  /**
+   * @brief The frame rate over the last complete second.
+   */
+  unsigned int FramesPerSecond() const { return m_fps; }
+
+  /**
+   * @brief The smoothed interval between frames, in microseconds.
+   */
+  unsigned int MeanIntervalUs() const { return m_mean_us; }
+
+  /**
+   * @brief The smoothed variation of the interval, in microseconds.
+   */
+  unsigned int JitterUs() const { return m_jitter_us; }
+
+  /**
+   * @brief Read the exported stats for a port.
+   * @param export_map the ExportMap the stats were exported to.
+   * @param port_id the UniqueId() of the port.
+   * @param[out] summary the stats.
+   * @returns false if no frames have been recorded for the port.
+   */
+  static bool ReadSummary(ExportMap *export_map, const std::string &port_id,
+                          Summary *summary);
+
+  static const char K_FRAME_INTERVAL_VAR[];
+  static const char K_FRAMES_VAR[];
+  static const char K_GAPS_VAR[];
+  static const char K_FPS_VAR[];
+  static const char K_JITTER_VAR[];
+
+  /**
+   * @brief How many times the mean an interval has to be to be a gap.
+   */
+  static const unsigned int GAP_FACTOR = 4;
+
+  /**
+   * @brief The number of intervals needed before gaps are counted.
+   */
+  static const unsigned int MIN_INTERVALS = 8;
+
+ private:
+  const std::string m_port_id;
+  ExportMap *m_export_map;
+  HistogramVariable *m_interval_var;
+  // The entries for this port in the UIntMaps.
+  unsigned int *m_frames_var;
+  unsigned int *m_gaps_var;
+  unsigned int *m_fps_var;
+  unsigned int *m_jitter_var;
+  TimeStamp m_last_frame;
+  TimeStamp m_window_start;
+  unsigned int m_window_frames;
+  unsigned int m_intervals;
+  unsigned int m_frames;
+  unsigned int m_gaps;
+  unsigned int m_fps;
+  unsigned int m_mean_us;
+  unsigned int m_jitter_us;
+  unsigned int m_last_interval_us;
+
+  static HistogramMap *IntervalMap(ExportMap *export_map);
+
+  DISALLOW_COPY_AND_ASSIGN(InputFrameStats);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_INPUTFRAMESTATS_H_
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * InputFrameStatsTest.cpp
+ * Test fixture for the InputFrameStats class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/plugin_api/InputFrameStats.h"
+
+using ola::ExportMap;
+using ola::HistogramVariable;
+using ola::InputFrameStats;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using std::auto_ptr;
+using std::string;
+
+class InputFrameStatsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(InputFrameStatsTest);
+  CPPUNIT_TEST(testSteadyRate);
+  CPPUNIT_TEST(testJitterAndGaps);
+  CPPUNIT_TEST(testExport);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  InputFrameStatsTest()
+      : m_port_id("1-1-I-1") {
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+    struct timeval tv;
+    tv.tv_sec = 1000;
+    tv.tv_usec = 0;
+    m_now = TimeStamp(tv);
+  }
+
+  void testSteadyRate();
+  void testJitterAndGaps();
+  void testExport();
+
+ private:
+  const string m_port_id;
+  TimeStamp m_now;
+
+  void RecordAfter(InputFrameStats *stats, unsigned int ms) {
+    m_now += TimeInterval(0, ms * 1000);
+    stats->RecordFrame(m_now);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(InputFrameStatsTest);
+
+/*
+ * Check a source sending every 25ms.
+ */
+void InputFrameStatsTest::testSteadyRate() {
+  InputFrameStats stats(NULL, m_port_id);
+  OLA_ASSERT_EQ(0u, stats.FramesPerSecond());
+
+  for (unsigned int i = 0; i < 81; i++) {
+    RecordAfter(&stats, 25);
+  }
+  OLA_ASSERT_EQ(81u, stats.Frames());
+  OLA_ASSERT_EQ(0u, stats.Gaps());
+  OLA_ASSERT_EQ(40u, stats.FramesPerSecond());
+  OLA_ASSERT_EQ(25000u, stats.MeanIntervalUs());
+  OLA_ASSERT_EQ(0u, stats.JitterUs());
+
+  // A repatch doesn't count as a gap.
+  stats.Reset();
+  RecordAfter(&stats, 5000);
+  RecordAfter(&stats, 25);
+  OLA_ASSERT_EQ(0u, stats.Gaps());
+  OLA_ASSERT_EQ(25000u, stats.MeanIntervalUs());
+}
+
+/*
+ * Check jitter and gaps are tracked.
+ */
+void InputFrameStatsTest::testJitterAndGaps() {
+  InputFrameStats stats(NULL, m_port_id);
+
+  // Alternate between 20ms and 30ms.
+  for (unsigned int i = 0; i < 200; i++) {
+    RecordAfter(&stats, i % 2 ? 30 : 20);
+  }
+  OLA_ASSERT_EQ(0u, stats.Gaps());
+  // The jitter converges on the 10ms difference between intervals.
+  OLA_ASSERT_TRUE(stats.JitterUs() > 9900);
+  OLA_ASSERT_TRUE(stats.JitterUs() <= 10000);
+  OLA_ASSERT_TRUE(stats.MeanIntervalUs() >= 24000);
+  OLA_ASSERT_TRUE(stats.MeanIntervalUs() <= 26000);
+
+  // A pause of half a second is a gap, and doesn't change the mean.
+  const unsigned int mean = stats.MeanIntervalUs();
+  const unsigned int jitter = stats.JitterUs();
+  RecordAfter(&stats, 500);
+  OLA_ASSERT_EQ(1u, stats.Gaps());
+  OLA_ASSERT_EQ(mean, stats.MeanIntervalUs());
+  OLA_ASSERT_EQ(jitter, stats.JitterUs());
+
+  // An interval just below the threshold isn't.
+  RecordAfter(&stats, 90);
+  OLA_ASSERT_EQ(1u, stats.Gaps());
+}
+
+/*
+ * Check the stats are exported, and removed when the stats are deleted.
+ */
+void InputFrameStatsTest::testExport() {
+  ExportMap export_map;
+  InputFrameStats::Summary summary;
+  OLA_ASSERT_FALSE(InputFrameStats::ReadSummary(&export_map, m_port_id,
+                                                &summary));
+
+  auto_ptr<InputFrameStats> stats(new InputFrameStats(&export_map,
+                                                      m_port_id));
+  for (unsigned int i = 0; i < 50; i++) {
+    RecordAfter(stats.get(), 25);
+  }
+
+  OLA_ASSERT_TRUE(InputFrameStats::ReadSummary(&export_map, m_port_id,
+                                               &summary));
+  OLA_ASSERT_EQ(50u, summary.frames);
+  OLA_ASSERT_EQ(0u, summary.gaps);
+  OLA_ASSERT_EQ(40u, summary.fps);
+  OLA_ASSERT_EQ(0u, summary.jitter_us);
+
+  const HistogramVariable *intervals = export_map.GetHistogramMapVar(
+      InputFrameStats::K_FRAME_INTERVAL_VAR, "port",
+      std::vector<uint64_t>())->Find(m_port_id);
+  OLA_ASSERT_NOT_NULL(intervals);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(49), intervals->Count());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(49 * 25000), intervals->Sum());
+
+  stats.reset();
+  OLA_ASSERT_FALSE(InputFrameStats::ReadSummary(&export_map, m_port_id,
+                                                &summary));
+  OLA_ASSERT_EQ(string::npos,
+                export_map.GetUIntMapVar(InputFrameStats::K_FRAMES_VAR,
+                                         "port")->Value().find(m_port_id));
+}
@@ -18,6 +18,12 @@ olad_plugin_api_libolaserverplugininterface_la_SOURCES = \
     olad/plugin_api/DeviceManager.cpp \
     olad/plugin_api/DeviceManager.h \
     olad/plugin_api/DmxSource.cpp \
+    olad/plugin_api/DuplicateFrameFilter.cpp \
+    olad/plugin_api/DuplicateFrameFilter.h \
+    olad/plugin_api/InputFrameStats.cpp \
+    olad/plugin_api/InputFrameStats.h \
+    olad/plugin_api/OutputCurve.cpp \
+    olad/plugin_api/OutputCurve.h \
     olad/plugin_api/Plugin.cpp \
     olad/plugin_api/PluginAdaptor.cpp \
     olad/plugin_api/Port.cpp \
@@ -25,7 +31,22 @@ olad_plugin_api_libolaserverplugininterface_la_SOURCES = \
     olad/plugin_api/PortManager.cpp \
     olad/plugin_api/PortManager.h \
     olad/plugin_api/Preferences.cpp \
+    olad/plugin_api/RDMResponseCache.cpp \
+    olad/plugin_api/RDMResponseCache.h \
+    olad/plugin_api/RDMScheduler.cpp \
+    olad/plugin_api/RDMScheduler.h \
+    olad/plugin_api/RDMTimingStats.cpp \
+    olad/plugin_api/RDMTimingStats.h \
+    olad/plugin_api/SoftPatch.cpp \
+    olad/plugin_api/SoftPatch.h \
+    olad/plugin_api/SpanFrame.cpp \
+    olad/plugin_api/ThreadPreferences.cpp \
+    olad/plugin_api/UDPSocketMonitor.cpp \
     olad/plugin_api/Universe.cpp \
+    olad/plugin_api/UniverseRange.cpp \
+    olad/plugin_api/UniverseRange.h \
+    olad/plugin_api/UniverseSnapshot.cpp \
+    olad/plugin_api/UniverseSnapshot.h \
     olad/plugin_api/UniverseStore.cpp \
     olad/plugin_api/UniverseStore.h
 olad_plugin_api_libolaserverplugininterface_la_CXXFLAGS = \
@@ -56,7 +77,8 @@ olad_plugin_api_ClientTester_CXXFLAGS = $(COMMON_TESTING_PROTOBUF_FLAGS)
 olad_plugin_api_ClientTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
 olad_plugin_api_DeviceTester_SOURCES = olad/plugin_api/DeviceManagerTest.cpp \
-                                       olad/plugin_api/DeviceTest.cpp
+                                       olad/plugin_api/DeviceTest.cpp \
+                                       olad/plugin_api/UDPSocketMonitorTest.cpp
 olad_plugin_api_DeviceTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_DeviceTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
@@ -64,8 +86,13 @@ olad_plugin_api_DmxSourceTester_SOURCES = olad/plugin_api/DmxSourceTest.cpp
 olad_plugin_api_DmxSourceTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_DmxSourceTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_PortTester_SOURCES = olad/plugin_api/PortTest.cpp \
-                                     olad/plugin_api/PortManagerTest.cpp
+olad_plugin_api_PortTester_SOURCES = \
+    olad/plugin_api/DuplicateFrameFilterTest.cpp \
+    olad/plugin_api/InputFrameStatsTest.cpp \
+    olad/plugin_api/OutputCurveTest.cpp \
+    olad/plugin_api/PortTest.cpp \
+    olad/plugin_api/PortManagerTest.cpp \
+    olad/plugin_api/SpanFrameTest.cpp
 olad_plugin_api_PortTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PortTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
@@ -73,6 +100,26 @@ olad_plugin_api_PreferencesTester_SOURCES = olad/plugin_api/PreferencesTest.cpp
 olad_plugin_api_PreferencesTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PreferencesTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_UniverseTester_SOURCES = olad/plugin_api/UniverseTest.cpp
+olad_plugin_api_UniverseTester_SOURCES = \
+    olad/plugin_api/RDMResponseCacheTest.cpp \
+    olad/plugin_api/RDMSchedulerTest.cpp \
+    olad/plugin_api/RDMTimingStatsTest.cpp \
+    olad/plugin_api/SoftPatchTest.cpp \
+    olad/plugin_api/UniverseRangeTest.cpp \
+    olad/plugin_api/UniverseSnapshotTest.cpp \
+    olad/plugin_api/UniverseTest.cpp
 olad_plugin_api_UniverseTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_UniverseTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
+
+# BENCHMARKS
+##################################################
+benchmark_programs += olad/plugin_api/UniverseBenchmark
+
+olad_plugin_api_UniverseBenchmark_SOURCES = \
+    olad/plugin_api/UniverseBenchmark.cpp
+olad_plugin_api_UniverseBenchmark_CXXFLAGS = $(COMMON_PROTOBUF_CXXFLAGS)
+olad_plugin_api_UniverseBenchmark_LDADD = \
+    $(COMMON_BENCHMARK_LIBS) \
+    $(libprotobuf_LIBS) \
+    olad/plugin_api/libolaserverplugininterface.la \
+    common/libolacommon.la
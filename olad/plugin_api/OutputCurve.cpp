@@ -0,0 +1,105 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputCurve.cpp
+ * A lookup table applied to the data sent on an output port.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/OutputCurve.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/StringUtils.h"
+
+namespace ola {
+
+using std::string;
+using std::vector;
+
+OutputCurve *OutputCurve::FromString(const string &description) {
+  string input = description;
+  StringTrim(&input);
+  string type = input.substr(0, input.find(' '));
+  string args;
+  if (type.size() < input.size()) {
+    args = input.substr(type.size() + 1);
+    StringTrim(&args);
+  }
+
+  OutputCurve *curve = new OutputCurve(input);
+  if (type == "gamma") {
+    char *end = NULL;
+    double gamma = strtod(args.c_str(), &end);
+    if (args.empty() || *end || gamma <= 0.0 || gamma > 10.0) {
+      delete curve;
+      return NULL;
+    }
+    for (unsigned int i = 0; i < 256; i++) {
+      curve->m_table[i] = static_cast<uint8_t>(
+          floor(255.0 * pow(i / 255.0, gamma) + 0.5));
+    }
+  } else if (type == "square" && args.empty()) {
+    for (unsigned int i = 0; i < 256; i++) {
+      curve->m_table[i] = static_cast<uint8_t>((i * i + 127) / 255);
+    }
+  } else if (type == "table") {
+    vector<string> values;
+    StringSplit(args, &values, ",");
+    if (values.size() != 256) {
+      delete curve;
+      return NULL;
+    }
+    for (unsigned int i = 0; i < 256; i++) {
+      StringTrim(&values[i]);
+      if (!StringToInt(values[i], &curve->m_table[i])) {
+        delete curve;
+        return NULL;
+      }
+    }
+  } else {
+    delete curve;
+    return NULL;
+  }
+  return curve;
+}
+
+/*
+ * A 256 entry table doesn't fit in vector registers, a shuffle based kernel
+ * needs 16 shuffles and blends per vector. At 512 slots a frame the table
+ * lookup is just as quick, so we unroll it instead.
+ */
+void OutputCurve::Apply(const DmxBuffer &input, DmxBuffer *output) const {
+  const uint8_t *in = input.GetRaw();
+  const unsigned int length = input.Size();
+  uint8_t frame[DMX_UNIVERSE_SIZE];
+
+  unsigned int i = 0;
+  for (; i + 4 <= length; i += 4) {
+    frame[i] = m_table[in[i]];
+    frame[i + 1] = m_table[in[i + 1]];
+    frame[i + 2] = m_table[in[i + 2]];
+    frame[i + 3] = m_table[in[i + 3]];
+  }
+  for (; i < length; i++) {
+    frame[i] = m_table[in[i]];
+  }
+  output->Set(frame, length);
+}
+}  // namespace ola
@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputCurve.h
+ * A lookup table applied to the data sent on an output port.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_OUTPUTCURVE_H_
+#define OLAD_PLUGIN_API_OUTPUTCURVE_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief A 256 entry lookup table that corrects the levels sent on an output
+ * port, e.g. for LED gamma or a dimmer curve.
+ *
+ * Curves are described by strings, which are used in the
+ * "<port id>_output_curve" port preferences:
+ *  - "gamma <exponent>", e.g. "gamma 2.2".
+ *  - "square", a square law dimmer curve.
+ *  - "table <v0>,<v1>,...,<v255>", an explicit value for each level.
+ */
+class OutputCurve {
+ public:
+  /**
+   * @brief Create a curve from a description.
+   * @param description the curve, as described above.
+   * @returns a new OutputCurve, or NULL if the description was invalid.
+   */
+  static OutputCurve *FromString(const std::string &description);
+
+  /**
+   * @brief Look up the corrected value for a level.
+   */
+  uint8_t Lookup(uint8_t level) const { return m_table[level]; }
+
+  /**
+   * @brief Correct a frame.
+   * @param input the frame to correct.
+   * @param[out] output the corrected frame.
+   */
+  void Apply(const DmxBuffer &input, DmxBuffer *output) const;
+
+  /**
+   * @brief The description this curve was created from.
+   */
+  const std::string &Description() const { return m_description; }
+
+ private:
+  uint8_t m_table[256];
+  std::string m_description;
+
+  explicit OutputCurve(const std::string &description)
+      : m_description(description) {
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(OutputCurve);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_OUTPUTCURVE_H_
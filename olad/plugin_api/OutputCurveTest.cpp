@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputCurveTest.cpp
+ * Test fixture for the OutputCurve class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "olad/plugin_api/OutputCurve.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::DmxBuffer;
+using ola::OutputCurve;
+using std::auto_ptr;
+using std::ostringstream;
+using std::string;
+
+class OutputCurveTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OutputCurveTest);
+  CPPUNIT_TEST(testGamma);
+  CPPUNIT_TEST(testSquare);
+  CPPUNIT_TEST(testTable);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST(testApply);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testGamma();
+    void testSquare();
+    void testTable();
+    void testInvalid();
+    void testApply();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OutputCurveTest);
+
+
+/*
+ * Check gamma curves.
+ */
+void OutputCurveTest::testGamma() {
+  auto_ptr<OutputCurve> curve(OutputCurve::FromString("gamma 2.2"));
+  OLA_ASSERT_NOT_NULL(curve.get());
+  OLA_ASSERT_EQ(string("gamma 2.2"), curve->Description());
+  OLA_ASSERT_EQ((uint8_t) 0, curve->Lookup(0));
+  OLA_ASSERT_EQ((uint8_t) 56, curve->Lookup(128));
+  OLA_ASSERT_EQ((uint8_t) 255, curve->Lookup(255));
+
+  // a gamma of 1 doesn't change anything
+  curve.reset(OutputCurve::FromString("  gamma   1 "));
+  OLA_ASSERT_NOT_NULL(curve.get());
+  for (unsigned int i = 0; i < 256; i++) {
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i),
+                  curve->Lookup(static_cast<uint8_t>(i)));
+  }
+}
+
+
+/*
+ * Check the square law curve.
+ */
+void OutputCurveTest::testSquare() {
+  auto_ptr<OutputCurve> curve(OutputCurve::FromString("square"));
+  OLA_ASSERT_NOT_NULL(curve.get());
+  OLA_ASSERT_EQ((uint8_t) 0, curve->Lookup(0));
+  OLA_ASSERT_EQ((uint8_t) 64, curve->Lookup(128));
+  OLA_ASSERT_EQ((uint8_t) 255, curve->Lookup(255));
+}
+
+
+/*
+ * Check explicit tables.
+ */
+void OutputCurveTest::testTable() {
+  ostringstream str;
+  str << "table ";
+  for (unsigned int i = 0; i < 256; i++) {
+    str << (i ? "," : "") << (255 - i);
+  }
+  auto_ptr<OutputCurve> curve(OutputCurve::FromString(str.str()));
+  OLA_ASSERT_NOT_NULL(curve.get());
+  OLA_ASSERT_EQ((uint8_t) 255, curve->Lookup(0));
+  OLA_ASSERT_EQ((uint8_t) 155, curve->Lookup(100));
+  OLA_ASSERT_EQ((uint8_t) 0, curve->Lookup(255));
+}
+
+
+/*
+ * Check invalid descriptions are rejected.
+ */
+void OutputCurveTest::testInvalid() {
+  OLA_ASSERT_NULL(OutputCurve::FromString(""));
+  OLA_ASSERT_NULL(OutputCurve::FromString("foo"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("gamma"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("gamma 0"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("gamma -1"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("gamma 11"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("gamma 2.2x"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("square 2"));
+  OLA_ASSERT_NULL(OutputCurve::FromString("table 1,2,3"));
+
+  ostringstream str;
+  str << "table ";
+  for (unsigned int i = 0; i < 256; i++) {
+    str << (i ? "," : "") << (i == 10 ? 256 : i);
+  }
+  OLA_ASSERT_NULL(OutputCurve::FromString(str.str()));
+}
+
+
+/*
+ * Check frames are corrected.
+ */
+void OutputCurveTest::testApply() {
+  auto_ptr<OutputCurve> curve(OutputCurve::FromString("square"));
+  OLA_ASSERT_NOT_NULL(curve.get());
+
+  DmxBuffer input, output;
+  curve->Apply(input, &output);
+  OLA_ASSERT_EQ(0u, output.Size());
+
+  // an odd length checks the tail of the loop
+  const uint8_t data[] = {0, 128, 255, 1, 16, 200, 64};
+  input.Set(data, sizeof(data));
+  curve->Apply(input, &output);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(sizeof(data)), output.Size());
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    OLA_ASSERT_EQ(curve->Lookup(data[i]), output.Get(i));
+  }
+
+  input.Blackout();
+  input.SetChannel(511, 128);
+  curve->Apply(input, &output);
+  OLA_ASSERT_EQ(512u, output.Size());
+  OLA_ASSERT_EQ((uint8_t) 0, output.Get(0));
+  OLA_ASSERT_EQ((uint8_t) 64, output.Get(511));
+}
@@ -20,6 +20,7 @@
 
 #include <string>
 #include "ola/Logging.h"
+#include "ola/network/InterfaceMonitor.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
@@ -45,6 +46,13 @@ bool Plugin::LoadPreferences() {
   if (!m_preferences) {
     return false;
   }
+  return ReloadPreferences();
+}
+
+bool Plugin::ReloadPreferences() {
+  if (!m_preferences) {
+    return LoadPreferences();
+  }
 
   m_preferences->Load();
 
@@ -96,6 +104,19 @@ bool Plugin::Start() {
   return true;
 }
 
+void Plugin::InterfacesChanged(
+    const ola::network::InterfaceChanges &changes) {
+  if (!m_enabled || !AffectedBy(changes)) {
+    return;
+  }
+
+  OLA_INFO << "Restarting " << Name() << " after an interface change";
+  StopHook();
+  if (!StartHook()) {
+    OLA_WARN << "Failed to restart " << Name();
+  }
+}
+
 bool Plugin::Stop() {
   if (!m_enabled) {
     return false;
@@ -20,7 +20,10 @@
  */
 
 #include <string>
+#include <vector>
 #include "ola/Callback.h"
+#include "ola/StringUtils.h"
+#include "ola/thread/Utils.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
@@ -31,6 +34,10 @@ namespace ola {
 using ola::io::SelectServerInterface;
 using ola::thread::timeout_id;
 using std::string;
+using std::vector;
+
+const char PluginAdaptor::K_PLUGIN_NIC_NODE_VAR[] = "plugin-nic-node";
+const char PluginAdaptor::K_PLUGIN_LOOP_NODE_VAR[] = "plugin-loop-node";
 
 PluginAdaptor::PluginAdaptor(DeviceManager *device_manager,
                              SelectServerInterface *select_server,
@@ -43,7 +50,8 @@ PluginAdaptor::PluginAdaptor(DeviceManager *device_manager,
   m_export_map(export_map),
   m_preferences_factory(preferences_factory),
   m_port_broker(port_broker),
-  m_instance_name(instance_name) {
+  m_instance_name(instance_name),
+  m_interface_monitor(NULL) {
 }
 
 bool PluginAdaptor::AddReadDescriptor(
@@ -105,6 +113,16 @@ void PluginAdaptor::RemoveTimeout(timeout_id id) {
   m_ss->RemoveTimeout(id);
 }
 
+void PluginAdaptor::SetDescriptorName(
+    const ola::io::ReadFileDescriptor *descriptor,
+    const string &name) {
+  m_ss->SetDescriptorName(descriptor, name);
+}
+
+void PluginAdaptor::SetTimeoutName(timeout_id id, const string &name) {
+  m_ss->SetTimeoutName(id, name);
+}
+
 void PluginAdaptor::Execute(ola::BaseCallback0<void> *closure) {
   m_ss->Execute(closure);
 }
@@ -113,6 +131,62 @@ void PluginAdaptor::DrainCallbacks() {
   m_ss->DrainCallbacks();
 }
 
+void PluginAdaptor::SetWorkerLoops(
+    const vector<SelectServerInterface*> &loops,
+    const vector<unsigned int> &loop_nodes) {
+  m_worker_loops = loops;
+  m_worker_loop_nodes = loop_nodes;
+}
+
+SelectServerInterface *PluginAdaptor::WorkerLoop(
+    ola_plugin_id plugin_id) const {
+  if (m_worker_loops.empty()) {
+    return NULL;
+  }
+  return m_worker_loops[plugin_id % m_worker_loops.size()];
+}
+
+SelectServerInterface *PluginAdaptor::WorkerLoop(
+    ola_plugin_id plugin_id,
+    const string &interface_name) const {
+  unsigned int node;
+  if (m_worker_loop_nodes.empty() ||
+      !ola::thread::GetInterfaceNumaNode(interface_name, &node)) {
+    return WorkerLoop(plugin_id);
+  }
+  return WorkerLoopOnNode(plugin_id, node);
+}
+
+SelectServerInterface *PluginAdaptor::WorkerLoopOnNode(
+    ola_plugin_id plugin_id,
+    unsigned int node) const {
+  if (m_worker_loops.empty() ||
+      m_worker_loop_nodes.size() != m_worker_loops.size()) {
+    return WorkerLoop(plugin_id);
+  }
+
+  vector<unsigned int> local_loops;
+  for (unsigned int i = 0; i < m_worker_loop_nodes.size(); i++) {
+    if (m_worker_loop_nodes[i] == node) {
+      local_loops.push_back(i);
+    }
+  }
+
+  unsigned int index = plugin_id % m_worker_loops.size();
+  if (!local_loops.empty()) {
+    index = local_loops[plugin_id % local_loops.size()];
+  }
+
+  if (m_export_map) {
+    const string key = IntToString(plugin_id);
+    (*m_export_map->GetUIntMapVar(K_PLUGIN_NIC_NODE_VAR, "plugin"))[key] =
+        node;
+    (*m_export_map->GetUIntMapVar(K_PLUGIN_LOOP_NODE_VAR, "plugin"))[key] =
+        m_worker_loop_nodes[index];
+  }
+  return m_worker_loops[index];
+}
+
 bool PluginAdaptor::RegisterDevice(AbstractDevice *device) const {
   return m_device_manager->RegisterDevice(device);
 }
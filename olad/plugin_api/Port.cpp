@@ -28,6 +28,10 @@
 #include "olad/Device.h"
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+#include "olad/plugin_api/InputFrameStats.h"
+#include "olad/plugin_api/OutputCurve.h"
 
 namespace ola {
 
@@ -35,6 +39,8 @@ using std::auto_ptr;
 using std::string;
 using std::vector;
 
+const char BasicInputPort::K_DUPLICATE_FRAMES_VAR[] = "port-duplicate-frames";
+
 BasicInputPort::BasicInputPort(AbstractDevice *parent,
                                unsigned int port_id,
                                const PluginAdaptor *plugin_adaptor,
@@ -46,7 +52,15 @@ BasicInputPort::BasicInputPort(AbstractDevice *parent,
     m_universe(NULL),
     m_device(parent),
     m_plugin_adaptor(plugin_adaptor),
-    m_supports_rdm(supports_rdm) {
+    m_supports_rdm(supports_rdm),
+    m_suppress_duplicates(false),
+    m_duplicate_frames(0),
+    m_duplicate_frames_var(NULL),
+    m_frame_stats(NULL) {
+}
+
+BasicInputPort::~BasicInputPort() {
+  delete m_frame_stats;
 }
 
 bool BasicInputPort::SetUniverse(Universe *new_universe) {
@@ -56,6 +70,10 @@ bool BasicInputPort::SetUniverse(Universe *new_universe) {
 
   if (PreSetUniverse(old_universe, new_universe)) {
     m_universe = new_universe;
+    m_last_merge = TimeStamp();
+    if (m_frame_stats) {
+      m_frame_stats->Reset();
+    }
     PostSetUniverse(old_universe, new_universe);
     return true;
   }
@@ -81,17 +99,74 @@ bool BasicInputPort::SetPriority(uint8_t priority) {
 }
 
 void BasicInputPort::DmxChanged() {
+  DmxChangedAt(TimeStamp());
+}
+
+void BasicInputPort::DmxChangedAt(const TimeStamp &ingress_time) {
   if (GetUniverse()) {
     const DmxBuffer &buffer = ReadDMX();
     uint8_t priority = (PriorityCapability() == CAPABILITY_FULL &&
                         GetPriorityMode() == PRIORITY_MODE_INHERIT ?
                         InheritedPriority() :
                         GetPriority());
-    m_dmx_source.UpdateData(buffer, *m_plugin_adaptor->WakeUpTime(), priority);
+    const TimeStamp &now = *m_plugin_adaptor->WakeUpTime();
+    if (!m_frame_stats) {
+      m_frame_stats = new InputFrameStats(m_plugin_adaptor->GetExportMap(),
+                                          UniqueId());
+    }
+    // Prefer the time the packet arrived, it doesn't include the time the
+    // loop took to get to it.
+    m_frame_stats->RecordFrame(ingress_time.IsSet() ? ingress_time : now);
+
+    if (m_suppress_duplicates && IsDuplicate(buffer, priority, now)) {
+      // Keep the source alive, the merged data can't have changed.
+      m_dmx_source.Refresh(now);
+      m_duplicate_frames++;
+      if (m_duplicate_frames_var) {
+        (*m_duplicate_frames_var)++;
+      }
+      return;
+    }
+    m_dmx_source.UpdateData(buffer, now, priority);
+    if (ingress_time.IsSet()) {
+      m_dmx_source.SetIngressTime(ingress_time);
+    }
+    m_last_merge = now;
     GetUniverse()->PortDataChanged(this);
   }
 }
 
+void BasicInputPort::SetSuppressDuplicates(bool suppress) {
+  m_suppress_duplicates = suppress;
+  m_last_merge = TimeStamp();
+  m_duplicate_frames_var = NULL;
+  ExportMap *export_map = m_plugin_adaptor ?
+      m_plugin_adaptor->GetExportMap() : NULL;
+  if (suppress && export_map) {
+    m_duplicate_frames_var = &(*export_map->GetUIntMapVar(
+        K_DUPLICATE_FRAMES_VAR, "port"))[UniqueId()];
+  }
+}
+
+/*
+ * A frame is only a duplicate if the previous one was merged into the same
+ * universe and is still active. In LTP mode a repeated frame can take the
+ * universe back from another source, so it's only a duplicate if the universe
+ * is still outputting it.
+ */
+bool BasicInputPort::IsDuplicate(const DmxBuffer &buffer, uint8_t priority,
+                                 const TimeStamp &now) const {
+  return (m_last_merge.IsSet() &&
+          now - m_last_merge <
+              TimeInterval(static_cast<int64_t>(DUPLICATE_REFRESH_MS) *
+                           ONE_THOUSAND) &&
+          m_dmx_source.IsActive(now) &&
+          m_dmx_source.Priority() == priority &&
+          m_dmx_source.Data() == buffer &&
+          (GetUniverse()->MergeMode() == Universe::MERGE_HTP ||
+           GetUniverse()->GetDMX() == buffer));
+}
+
 void BasicInputPort::HandleRDMRequest(ola::rdm::RDMRequest *request_ptr,
                                       ola::rdm::RDMCallback *callback) {
   auto_ptr<ola::rdm::RDMRequest> request(request_ptr);
@@ -128,7 +203,28 @@ BasicOutputPort::BasicOutputPort(AbstractDevice *parent,
     m_port_string(""),
     m_universe(NULL),
     m_device(parent),
-    m_supports_rdm(supports_rdm) {
+    m_supports_rdm(supports_rdm),
+    m_output_curve(NULL),
+    m_frame_filter(NULL) {
+}
+
+BasicOutputPort::~BasicOutputPort() {
+  delete m_output_curve;
+  delete m_frame_filter;
+}
+
+void BasicOutputPort::SetOutputCurve(OutputCurve *curve) {
+  if (curve != m_output_curve) {
+    delete m_output_curve;
+    m_output_curve = curve;
+  }
+}
+
+void BasicOutputPort::SetDuplicateFrameFilter(DuplicateFrameFilter *filter) {
+  if (filter != m_frame_filter) {
+    delete m_frame_filter;
+    m_frame_filter = filter;
+  }
 }
 
 bool BasicOutputPort::SetUniverse(Universe *new_universe) {
@@ -139,6 +235,10 @@ bool BasicOutputPort::SetUniverse(Universe *new_universe) {
   if (PreSetUniverse(old_universe, new_universe)) {
     m_universe = new_universe;
     PostSetUniverse(old_universe, new_universe);
+    if (new_universe && !m_restored_uids.Empty()) {
+      new_universe->NewUIDList(this, m_restored_uids);
+      m_restored_uids.Clear();
+    }
     if (m_discover_on_patch)
       RunIncrementalDiscovery(
           NewSingleCallback(this, &BasicOutputPort::UpdateUIDs));
@@ -191,6 +291,10 @@ void BasicOutputPort::RunIncrementalDiscovery(
   on_complete->Run(uids);
 }
 
+void BasicOutputPort::RestoreUIDs(const ola::rdm::UIDSet &uids) {
+  m_restored_uids = uids;
+}
+
 void BasicOutputPort::UpdateUIDs(const ola::rdm::UIDSet &uids) {
   Universe *universe = GetUniverse();
   if (universe)
@@ -18,17 +18,109 @@
  * Copyright (C) 2005 Simon Newton
  */
 
-#include "olad/plugin_api/PortManager.h"
-
+#include <config.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
+#include "olad/plugin_api/PortManager.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "olad/Port.h"
 
+#include HASH_MAP_H
+
 namespace ola {
 
+using std::map;
+using std::set;
+using std::string;
 using std::vector;
 
+namespace {
+
+typedef map<const Port*, const PortManager::PortPatch*> ChangeMap;
+// The number of a device's ports patched to each universe.
+typedef HASH_NAMESPACE::HASH_MAP_CLASS<unsigned int, unsigned int>
+    UniverseCounts;
+
+/*
+ * Find the universe a port will be patched to once the changes are made.
+ * @returns false if the port will be unpatched.
+ */
+bool FinalUniverse(const Port *port, const ChangeMap &changes,
+                   unsigned int *universe) {
+  ChangeMap::const_iterator iter = changes.find(port);
+  if (iter != changes.end()) {
+    *universe = iter->second->universe;
+    return iter->second->patch;
+  }
+  if (port->GetUniverse()) {
+    *universe = port->GetUniverse()->UniverseId();
+    return true;
+  }
+  return false;
+}
+
+template<class PortClass>
+void CountPatchedPorts(const vector<PortClass*> &ports,
+                       const ChangeMap &changes,
+                       UniverseCounts *counts) {
+  typename vector<PortClass*>::const_iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    unsigned int universe;
+    if (FinalUniverse(*iter, changes, &universe)) {
+      (*counts)[universe]++;
+    }
+  }
+}
+
+unsigned int CountFor(const UniverseCounts &counts, unsigned int universe) {
+  UniverseCounts::const_iterator iter = counts.find(universe);
+  return iter == counts.end() ? 0 : iter->second;
+}
+
+/*
+ * Check the ports of one type on a device that are being patched.
+ * @param same_counts the counts for ports of this type.
+ * @param other_counts the counts for ports of the opposite type.
+ */
+template<class PortClass>
+bool CheckPatchedPorts(const AbstractDevice *device,
+                       const vector<PortClass*> &ports,
+                       const ChangeMap &changes,
+                       const UniverseCounts &same_counts,
+                       const UniverseCounts &other_counts,
+                       string *error) {
+  typename vector<PortClass*>::const_iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    ChangeMap::const_iterator change = changes.find(*iter);
+    if (change == changes.end() || !change->second->patch) {
+      continue;
+    }
+    const unsigned int universe = change->second->universe;
+    if ((*iter)->GetUniverse() &&
+        (*iter)->GetUniverse()->UniverseId() == universe) {
+      continue;
+    }
+    if (!device->AllowLooping() && CountFor(other_counts, universe)) {
+      *error = "Patching " + (*iter)->UniqueId() + " to universe " +
+               IntToString(universe) + " would create a loop";
+      return false;
+    }
+    if (!device->AllowMultiPortPatching() &&
+        CountFor(same_counts, universe) > 1) {
+      *error = "Patching " + (*iter)->UniqueId() + " to universe " +
+               IntToString(universe) +
+               " would patch more than one port on the device";
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
 bool PortManager::PatchPort(InputPort *port,
                             unsigned int universe) {
   return GenericPatchPort(port, universe);
@@ -47,6 +139,60 @@ bool PortManager::UnPatchPort(OutputPort *port) {
   return GenericUnPatchPort(port);
 }
 
+bool PortManager::PatchPorts(const vector<PortPatch> &patches,
+                             string *error) {
+  ChangeMap changes;
+  set<const AbstractDevice*> devices;
+  vector<PortPatch>::const_iterator iter = patches.begin();
+  for (; iter != patches.end(); ++iter) {
+    const Port *port = iter->input_port ?
+        static_cast<const Port*>(iter->input_port) : iter->output_port;
+    if (!port) {
+      *error = "Missing port";
+      return false;
+    }
+    if (!changes.insert(std::make_pair(port, &(*iter))).second) {
+      *error = "Port " + port->UniqueId() + " is changed more than once";
+      return false;
+    }
+    if (port->GetDevice()) {
+      devices.insert(port->GetDevice());
+    }
+  }
+
+  set<const AbstractDevice*>::const_iterator device_iter = devices.begin();
+  for (; device_iter != devices.end(); ++device_iter) {
+    const AbstractDevice *device = *device_iter;
+    if (device->AllowLooping() && device->AllowMultiPortPatching()) {
+      continue;
+    }
+    vector<InputPort*> input_ports;
+    vector<OutputPort*> output_ports;
+    device->InputPorts(&input_ports);
+    device->OutputPorts(&output_ports);
+
+    UniverseCounts input_counts, output_counts;
+    CountPatchedPorts(input_ports, changes, &input_counts);
+    CountPatchedPorts(output_ports, changes, &output_counts);
+    if (!CheckPatchedPorts(device, input_ports, changes, input_counts,
+                           output_counts, error) ||
+        !CheckPatchedPorts(device, output_ports, changes, output_counts,
+                           input_counts, error)) {
+      return false;
+    }
+  }
+
+  for (iter = patches.begin(); iter != patches.end(); ++iter) {
+    const bool ok = iter->input_port ? ApplyChange(iter->input_port, *iter) :
+                                       ApplyChange(iter->output_port, *iter);
+    if (!ok) {
+      *error = "Failed to patch to universe " + IntToString(iter->universe);
+      return false;
+    }
+  }
+  return true;
+}
+
 bool PortManager::SetPriorityInherit(Port *port) {
   if (port->PriorityCapability() != CAPABILITY_FULL)
     return true;
@@ -102,6 +248,16 @@ bool PortManager::GenericPatchPort(PortClass *port,
         return false;
     }
   }
+  return ApplyPatch(port, new_universe_id);
+}
+
+
+/*
+ * Patch a port without checking the device's rules.
+ */
+template<class PortClass>
+bool PortManager::ApplyPatch(PortClass *port, unsigned int new_universe_id) {
+  Universe *universe = port->GetUniverse();
 
   // unpatch if required
   if (universe) {
@@ -128,6 +284,19 @@ bool PortManager::GenericPatchPort(PortClass *port,
 }
 
 
+template<class PortClass>
+bool PortManager::ApplyChange(PortClass *port, const PortPatch &change) {
+  if (!change.patch) {
+    return GenericUnPatchPort(port);
+  }
+  Universe *universe = port->GetUniverse();
+  if (universe && universe->UniverseId() == change.universe) {
+    return true;
+  }
+  return ApplyPatch(port, change.universe);
+}
+
+
 template<class PortClass>
 bool PortManager::GenericUnPatchPort(PortClass *port) {
   if (!port)
@@ -21,6 +21,7 @@
 #ifndef OLAD_PLUGIN_API_PORTMANAGER_H_
 #define OLAD_PLUGIN_API_PORTMANAGER_H_
 
+#include <string>
 #include <vector>
 #include "olad/Device.h"
 #include "olad/PortBroker.h"
@@ -36,6 +37,31 @@ namespace ola {
  */
 class PortManager {
  public:
+  /**
+   * @brief A change to the patching of a port, used with PatchPorts().
+   */
+  struct PortPatch {
+    PortPatch(InputPort *port, bool patch, unsigned int universe)
+        : input_port(port),
+          output_port(NULL),
+          patch(patch),
+          universe(universe) {
+    }
+
+    PortPatch(OutputPort *port, bool patch, unsigned int universe)
+        : input_port(NULL),
+          output_port(port),
+          patch(patch),
+          universe(universe) {
+    }
+
+    // One of these is set.
+    InputPort *input_port;
+    OutputPort *output_port;
+    bool patch;  // false to unpatch the port
+    unsigned int universe;
+  };
+
   /**
    * @brief Create a new PortManager.
    * @param universe_store the UniverseStore used to lookup / create Universes.
@@ -82,6 +108,19 @@ class PortManager {
    */
   bool UnPatchPort(OutputPort *port);
 
+  /**
+   * @brief Make a set of patch changes, either all of them or none.
+   * @param patches the changes to make.
+   * @param[out] error the reason the changes were rejected.
+   * @returns true if all the changes were made, false if none were.
+   *
+   * The looping and multi-port rules of each device are checked against the
+   * patching as it will be once all the changes are made, so ports can be
+   * moved between universes in any order. Each device's ports are only
+   * examined once, rather than once per change.
+   */
+  bool PatchPorts(const std::vector<PortPatch> &patches, std::string *error);
+
   /**
    * @brief Set a port to 'inherit' priority mode.
    * @param port the port to configure
@@ -100,6 +139,12 @@ class PortManager {
   bool GenericPatchPort(PortClass *port,
                         unsigned int new_universe_id);
 
+  template<class PortClass>
+  bool ApplyPatch(PortClass *port, unsigned int new_universe_id);
+
+  template<class PortClass>
+  bool ApplyChange(PortClass *port, const PortPatch &change);
+
   template<class PortClass>
   bool GenericUnPatchPort(PortClass *port);
 
@@ -20,6 +20,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <string>
+#include <vector>
 
 #include "olad/DmxSource.h"
 #include "olad/PortBroker.h"
@@ -34,12 +35,14 @@ using ola::PortManager;
 using ola::Port;
 using ola::Universe;
 using std::string;
+using std::vector;
 
 
 class PortManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(PortManagerTest);
   CPPUNIT_TEST(testPortPatching);
   CPPUNIT_TEST(testPortPatchingLoopMulti);
+  CPPUNIT_TEST(testBatchPatching);
   CPPUNIT_TEST(testInputPortSetPriority);
   CPPUNIT_TEST(testOutputPortSetPriority);
   CPPUNIT_TEST_SUITE_END();
@@ -47,6 +50,7 @@ class PortManagerTest: public CppUnit::TestFixture {
  public:
     void testPortPatching();
     void testPortPatchingLoopMulti();
+    void testBatchPatching();
     void testInputPortSetPriority();
     void testOutputPortSetPriority();
 };
@@ -122,6 +126,65 @@ void PortManagerTest::testPortPatching() {
 }
 
 
+/*
+ * Check that a set of patches is checked against the final patching, and is
+ * applied either in full or not at all.
+ */
+void PortManagerTest::testBatchPatching() {
+  typedef PortManager::PortPatch PortPatch;
+  ola::UniverseStore uni_store(NULL, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&uni_store, &broker);
+
+  // mock device, this doesn't allow looping or multiport patching
+  MockDevice device1(NULL, "test_device_1");
+  TestMockInputPort input_port(&device1, 1, NULL);
+  TestMockOutputPort output_port(&device1, 1);
+  TestMockOutputPort output_port2(&device1, 2);
+  device1.AddPort(&input_port);
+  device1.AddPort(&output_port);
+  device1.AddPort(&output_port2);
+
+  OLA_ASSERT(port_manager.PatchPort(&output_port, 1));
+  OLA_ASSERT(port_manager.PatchPort(&output_port2, 2));
+
+  // Swapping the universes one port at a time would break the multiport rule
+  // part way through.
+  OLA_ASSERT_FALSE(port_manager.PatchPort(&output_port, 2));
+  vector<PortPatch> patches;
+  patches.push_back(PortPatch(&output_port, true, 2));
+  patches.push_back(PortPatch(&output_port2, true, 1));
+  string error;
+  OLA_ASSERT(port_manager.PatchPorts(patches, &error));
+  OLA_ASSERT_EQ(2u, output_port.GetUniverse()->UniverseId());
+  OLA_ASSERT_EQ(1u, output_port2.GetUniverse()->UniverseId());
+
+  // The input port would loop, so nothing changes.
+  patches.clear();
+  patches.push_back(PortPatch(&output_port, false, 0));
+  patches.push_back(PortPatch(&input_port, true, 1));
+  OLA_ASSERT_FALSE(port_manager.PatchPorts(patches, &error));
+  OLA_ASSERT_FALSE(error.empty());
+  OLA_ASSERT_EQ(2u, output_port.GetUniverse()->UniverseId());
+  OLA_ASSERT_EQ(static_cast<Universe*>(NULL), input_port.GetUniverse());
+
+  // A port can only be changed once.
+  patches.clear();
+  patches.push_back(PortPatch(&output_port, true, 3));
+  patches.push_back(PortPatch(&output_port, true, 4));
+  OLA_ASSERT_FALSE(port_manager.PatchPorts(patches, &error));
+  OLA_ASSERT_EQ(2u, output_port.GetUniverse()->UniverseId());
+
+  // Unpatching the other output port lets the input port take universe 1.
+  patches.clear();
+  patches.push_back(PortPatch(&output_port2, false, 0));
+  patches.push_back(PortPatch(&input_port, true, 1));
+  OLA_ASSERT(port_manager.PatchPorts(patches, &error));
+  OLA_ASSERT_EQ(1u, input_port.GetUniverse()->UniverseId());
+  OLA_ASSERT_EQ(static_cast<Universe*>(NULL), output_port2.GetUniverse());
+}
+
+
 /*
  * test that patching works correctly for devices with looping and multiport
  * patching enabled.
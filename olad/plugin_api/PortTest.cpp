@@ -25,6 +25,7 @@
 #include "olad/PluginAdaptor.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
+#include "olad/plugin_api/InputFrameStats.h"
 #include "olad/plugin_api/TestCommon.h"
 #include "olad/plugin_api/UniverseStore.h"
 #include "ola/testing/TestUtils.h"
@@ -38,11 +39,13 @@ class PortTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(PortTest);
   CPPUNIT_TEST(testOutputPortPriorities);
   CPPUNIT_TEST(testInputPortPriorities);
+  CPPUNIT_TEST(testSuppressDuplicates);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testOutputPortPriorities();
     void testInputPortPriorities();
+    void testSuppressDuplicates();
 
  private:
     Clock m_clock;
@@ -150,3 +153,83 @@ void PortTest::testInputPortPriorities() {
   input_port2.DmxChanged();
   OLA_ASSERT_EQ(new_priority,  universe->ActivePriority());
 }
+
+
+/*
+ * Check that repeated frames from an input port are only merged when the
+ * port suppresses duplicates.
+ */
+void PortTest::testSuppressDuplicates() {
+  unsigned int universe_id = 1;
+  ola::MemoryPreferences preferences("foo");
+  ola::UniverseStore store(&preferences, NULL);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+
+  MockDevice device(NULL, "foo");
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  TestMockInputPort input_port(&device, 1, &plugin_adaptor);
+  port_manager.PatchPort(&input_port, universe_id);
+  ola::Universe *universe = store.GetUniverseOrCreate(universe_id);
+  OLA_ASSERT(universe);
+  const ola::Universe::Counters &counters = universe->GetCounters();
+
+  ola::DmxBuffer buffer("foo bar baz");
+  m_clock.CurrentTime(&time_stamp);
+  input_port.WriteDMX(buffer);
+  input_port.DmxChanged();
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.input_frames);
+
+  input_port.SetSuppressDuplicates(true);
+  OLA_ASSERT_TRUE(input_port.GetSuppressDuplicates());
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), counters.input_frames);
+
+  // The same data is dropped, but keeps the source alive.
+  time_stamp += ola::TimeInterval(0, 100000);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), counters.input_frames);
+  OLA_ASSERT_EQ(1u, input_port.DuplicateFrames());
+  OLA_ASSERT_EQ(time_stamp, input_port.SourceData().Timestamp());
+  // Duplicates still count as received frames.
+  OLA_ASSERT_NOT_NULL(input_port.FrameStats());
+  OLA_ASSERT_EQ(4u, input_port.FrameStats()->Frames());
+
+  // New data, or a new priority, is merged.
+  input_port.WriteDMX(ola::DmxBuffer("foo bar"));
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), counters.input_frames);
+  OLA_ASSERT(ola::DmxBuffer("foo bar") == universe->GetDMX());
+  port_manager.SetPriorityStatic(&input_port, 120);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(5), counters.input_frames);
+  OLA_ASSERT_EQ((uint8_t) 120, universe->ActivePriority());
+
+  // Duplicates are merged once the refresh interval has passed.
+  time_stamp += ola::TimeInterval(0, 900000);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(5), counters.input_frames);
+  time_stamp += ola::TimeInterval(0, 100000);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(6), counters.input_frames);
+  OLA_ASSERT_EQ(2u, input_port.DuplicateFrames());
+
+  // In LTP mode, a duplicate is merged if another source has taken over.
+  TestMockInputPort input_port2(&device, 2, &plugin_adaptor);
+  port_manager.PatchPort(&input_port2, universe_id);
+  port_manager.SetPriorityStatic(&input_port2, 120);
+  time_stamp += ola::TimeInterval(0, 100000);
+  input_port2.WriteDMX(ola::DmxBuffer("other"));
+  input_port2.DmxChanged();
+  OLA_ASSERT(ola::DmxBuffer("other") == universe->GetDMX());
+  time_stamp += ola::TimeInterval(0, 100000);
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(8), counters.input_frames);
+  OLA_ASSERT(ola::DmxBuffer("foo bar") == universe->GetDMX());
+  OLA_ASSERT_EQ(2u, input_port.DuplicateFrames());
+  port_manager.UnPatchPort(&input_port2);
+  port_manager.UnPatchPort(&input_port);
+}
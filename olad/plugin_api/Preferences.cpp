@@ -19,6 +19,7 @@
  */
 
 #define __STDC_LIMIT_MACROS  // for UINT8_MAX & friends
+#include <config.h>
 #include <dirent.h>
 #include <errno.h>
 #include <pthread.h>
@@ -44,6 +45,20 @@
 #include "ola/thread/Thread.h"
 #include "olad/Preferences.h"
 
+#include HASH_MAP_H
+
+#ifndef HAVE_UNORDERED_MAP
+// This adds support for hashing strings if it's not present
+namespace HASH_NAMESPACE {
+
+template<> struct hash<std::string> {
+  size_t operator()(const std::string& x) const {
+    return hash<const char*>()(x.c_str());
+  }
+};
+}  // namespace HASH_NAMESPACE
+#endif  // HAVE_UNORDERED_MAP
+
 namespace ola {
 
 using ola::thread::Mutex;
@@ -56,26 +71,40 @@ using std::string;
 using std::vector;
 
 namespace {
+/*
+ * Write the preferences to a temporary file, and then rename it over the
+ * original so readers never see a partially written file.
+ */
 void SavePreferencesToFile(
-    const string *filename_ptr,
-    const FilePreferenceSaverThread::PreferencesMap *pref_map_ptr) {
-  std::auto_ptr<const string> filename(filename_ptr);
-  std::auto_ptr<const FilePreferenceSaverThread::PreferencesMap> pref_map(
-      pref_map_ptr);
-
-  FilePreferenceSaverThread::PreferencesMap::const_iterator iter;
-  ofstream pref_file(filename->data());
+    const string &filename,
+    const FilePreferenceSaverThread::PreferencesMap &pref_map) {
+  const string temp_filename = filename + ".new";
+  ofstream pref_file(temp_filename.data());
 
   if (!pref_file.is_open()) {
-    OLA_WARN << "Could not open " << *filename_ptr << ": " << strerror(errno);
+    OLA_WARN << "Could not open " << temp_filename << ": " << strerror(errno);
     return;
   }
 
-  for (iter = pref_map->begin(); iter != pref_map->end(); ++iter) {
+  FilePreferenceSaverThread::PreferencesMap::const_iterator iter;
+  for (iter = pref_map.begin(); iter != pref_map.end(); ++iter) {
     pref_file << iter->first << " = " << iter->second << std::endl;
   }
   pref_file.flush();
+  const bool ok = pref_file.good();
   pref_file.close();
+
+  if (!ok) {
+    OLA_WARN << "Failed to write " << temp_filename;
+    unlink(temp_filename.c_str());
+    return;
+  }
+
+  if (rename(temp_filename.c_str(), filename.c_str())) {
+    OLA_WARN << "Could not rename " << temp_filename << " to " << filename
+             << ": " << strerror(errno);
+    unlink(temp_filename.c_str());
+  }
 }
 }  // namespace
 
@@ -202,20 +231,78 @@ Preferences *PreferencesFactory::NewPreference(const string &name) {
 // Memory Preferences
 //-----------------------------------------------------------------------------
 
+/*
+ * The index of keys in m_pref_map.
+ */
+class MemoryPreferences::KeyIndex {
+ public:
+  class Entry {
+   public:
+    enum UIntState {
+      UINT_UNPARSED,
+      UINT_VALID,
+      UINT_INVALID
+    };
+
+    Entry()
+        : uint_state(UINT_UNPARSED),
+          uint_value(0) {
+    }
+
+    explicit Entry(PreferencesMap::const_iterator first_value)
+        : first(first_value),
+          uint_state(UINT_UNPARSED),
+          uint_value(0) {
+    }
+
+    // The first value for the key.
+    PreferencesMap::const_iterator first;
+    // The value parsed as an unsigned int, filled in on first use.
+    UIntState uint_state;
+    unsigned int uint_value;
+  };
+
+  typedef HASH_NAMESPACE::HASH_MAP_CLASS<string, Entry> EntryMap;
+
+  EntryMap entries;
+};
+
+
+MemoryPreferences::MemoryPreferences(const string name)
+    : Preferences(name),
+      m_dirty(true),
+      m_index(new KeyIndex()) {
+}
+
+
 MemoryPreferences::~MemoryPreferences() {
   m_pref_map.clear();
+  delete m_index;
 }
 
 
 void MemoryPreferences::Clear() {
   m_pref_map.clear();
+  m_index->entries.clear();
+  m_dirty = true;
 }
 
 
 void MemoryPreferences::SetValue(const string &key,
                                  const string &value) {
+  PreferencesMap::const_iterator iter = FindFirst(key);
+  if (iter != m_pref_map.end() && iter->second == value) {
+    PreferencesMap::const_iterator next = iter;
+    ++next;
+    if (next == m_pref_map.end() || next->first != key) {
+      // This is the only value for the key, and it hasn't changed.
+      return;
+    }
+  }
   m_pref_map.erase(key);
-  m_pref_map.insert(make_pair(key, value));
+  m_index->entries[key] = KeyIndex::Entry(
+      m_pref_map.insert(make_pair(key, value)));
+  m_dirty = true;
 }
 
 
@@ -232,6 +319,8 @@ void MemoryPreferences::SetValue(const string &key, int value) {
 void MemoryPreferences::SetMultipleValue(const string &key,
                                          const string &value) {
   m_pref_map.insert(make_pair(key, value));
+  IndexKey(key);
+  m_dirty = true;
 }
 
 
@@ -249,8 +338,7 @@ void MemoryPreferences::SetMultipleValue(const string &key, int value) {
 bool MemoryPreferences::SetDefaultValue(const string &key,
                                         const Validator &validator,
                                         const string &value) {
-  PreferencesMap::const_iterator iter;
-  iter = m_pref_map.find(key);
+  PreferencesMap::const_iterator iter = FindFirst(key);
 
   if (iter == m_pref_map.end() || !validator.IsValid(iter->second)) {
     SetValue(key, value);
@@ -291,8 +379,7 @@ bool MemoryPreferences::SetDefaultValue(const string &key,
 
 
 string MemoryPreferences::GetValue(const string &key) const {
-  PreferencesMap::const_iterator iter;
-  iter = m_pref_map.find(key);
+  PreferencesMap::const_iterator iter = FindFirst(key);
 
   if (iter != m_pref_map.end())
     return iter->second;
@@ -300,11 +387,33 @@ string MemoryPreferences::GetValue(const string &key) const {
 }
 
 
+bool MemoryPreferences::GetValueAsUInt(const string &key,
+                                       unsigned int *value) const {
+  KeyIndex::EntryMap::iterator iter = m_index->entries.find(key);
+  if (iter == m_index->entries.end()) {
+    return false;
+  }
+
+  KeyIndex::Entry *entry = &iter->second;
+  if (entry->uint_state == KeyIndex::Entry::UINT_UNPARSED) {
+    entry->uint_state = StringToInt(entry->first->second, &entry->uint_value,
+                                    true) ?
+        KeyIndex::Entry::UINT_VALID : KeyIndex::Entry::UINT_INVALID;
+  }
+
+  if (entry->uint_state != KeyIndex::Entry::UINT_VALID) {
+    return false;
+  }
+  *value = entry->uint_value;
+  return true;
+}
+
+
 vector<string> MemoryPreferences::GetMultipleValue(const string &key) const {
   vector<string> values;
   PreferencesMap::const_iterator iter;
 
-  for (iter = m_pref_map.find(key);
+  for (iter = FindFirst(key);
        iter != m_pref_map.end() && iter->first == key; ++iter) {
     values.push_back(iter->second);
   }
@@ -313,18 +422,20 @@ vector<string> MemoryPreferences::GetMultipleValue(const string &key) const {
 
 
 bool MemoryPreferences::HasKey(const string &key) const {
-  return STLContains(m_pref_map, key);
+  return STLContains(m_index->entries, key);
 }
 
 
 void MemoryPreferences::RemoveValue(const string &key) {
-  m_pref_map.erase(key);
+  if (m_pref_map.erase(key)) {
+    m_index->entries.erase(key);
+    m_dirty = true;
+  }
 }
 
 
 bool MemoryPreferences::GetValueAsBool(const string &key) const {
-  PreferencesMap::const_iterator iter;
-  iter = m_pref_map.find(key);
+  PreferencesMap::const_iterator iter = FindFirst(key);
 
   if (iter != m_pref_map.end())
     return iter->second == BoolValidator::ENABLED;
@@ -333,9 +444,30 @@ bool MemoryPreferences::GetValueAsBool(const string &key) const {
 
 
 void MemoryPreferences::SetValueAsBool(const string &key, bool value) {
-  m_pref_map.erase(key);
-  m_pref_map.insert(make_pair(key, (value ? BoolValidator::ENABLED :
-                                            BoolValidator::DISABLED)));
+  SetValue(key, value ? BoolValidator::ENABLED : BoolValidator::DISABLED);
+}
+
+
+MemoryPreferences::PreferencesMap::const_iterator MemoryPreferences::FindFirst(
+    const string &key) const {
+  KeyIndex::EntryMap::const_iterator iter = m_index->entries.find(key);
+  if (iter == m_index->entries.end()) {
+    return m_pref_map.end();
+  }
+  return iter->second.first;
+}
+
+
+/*
+ * Point the index entry for key at the first value in m_pref_map.
+ */
+void MemoryPreferences::IndexKey(const string &key) {
+  PreferencesMap::const_iterator iter = m_pref_map.lower_bound(key);
+  if (iter == m_pref_map.end() || iter->first != key) {
+    m_index->entries.erase(key);
+  } else {
+    m_index->entries[key] = KeyIndex::Entry(iter);
+  }
 }
 
 
@@ -344,8 +476,11 @@ void MemoryPreferences::SetValueAsBool(const string &key, bool value) {
 // FilePreferenceSaverThread
 //-----------------------------------------------------------------------------
 
-FilePreferenceSaverThread::FilePreferenceSaverThread()
-    : Thread(Thread::Options("pref-saver")) {
+FilePreferenceSaverThread::FilePreferenceSaverThread(
+    const TimeInterval &save_delay)
+    : Thread(Thread::Options("pref-saver")),
+      m_save_delay(save_delay),
+      m_flush_scheduled(false) {
   // set a long poll interval so we don't spin
   m_ss.SetDefaultInterval(TimeInterval(60, 0));
 }
@@ -353,16 +488,25 @@ FilePreferenceSaverThread::FilePreferenceSaverThread()
 void FilePreferenceSaverThread::SavePreferences(
     const string &file_name,
     const PreferencesMap &preferences) {
-  const string *file_name_ptr = new string(file_name);
-  const PreferencesMap *save_map = new PreferencesMap(preferences);
-  SingleUseCallback0<void> *cb =
-      NewSingleCallback(SavePreferencesToFile, file_name_ptr, save_map);
-  m_ss.Execute(cb);
+  bool schedule_flush;
+  {
+    ola::thread::MutexLocker locker(&m_pending_mutex);
+    // Replaces any earlier save to the same file that hasn't been written.
+    m_pending_saves[file_name] = preferences;
+    schedule_flush = !m_flush_scheduled;
+    m_flush_scheduled = true;
+  }
+  if (schedule_flush) {
+    m_ss.Execute(NewSingleCallback(this,
+                                   &FilePreferenceSaverThread::ScheduleFlush));
+  }
 }
 
 
 void *FilePreferenceSaverThread::Run() {
   m_ss.Run();
+  // Write anything still waiting for the save delay.
+  FlushPendingSaves();
   return NULL;
 }
 
@@ -386,9 +530,32 @@ void FilePreferenceSaverThread::Syncronize() {
 }
 
 
+void FilePreferenceSaverThread::ScheduleFlush() {
+  m_ss.RegisterSingleTimeout(
+      m_save_delay,
+      NewSingleCallback(this, &FilePreferenceSaverThread::FlushPendingSaves));
+}
+
+
+void FilePreferenceSaverThread::FlushPendingSaves() {
+  PendingSaves pending_saves;
+  {
+    ola::thread::MutexLocker locker(&m_pending_mutex);
+    pending_saves.swap(m_pending_saves);
+    m_flush_scheduled = false;
+  }
+
+  PendingSaves::const_iterator iter = pending_saves.begin();
+  for (; iter != pending_saves.end(); ++iter) {
+    SavePreferencesToFile(iter->first, iter->second);
+  }
+}
+
+
 void FilePreferenceSaverThread::CompleteSyncronization(
     ConditionVariable *condition,
     Mutex *mutex) {
+  FlushPendingSaves();
   // calling lock here forces us to block until Wait() is called on the
   // condition_var.
   mutex->Lock();
@@ -406,7 +573,11 @@ bool FileBackedPreferences::Load() {
 
 
 bool FileBackedPreferences::Save() const {
+  if (!m_dirty) {
+    return true;
+  }
   m_saver_thread->SavePreferences(FileName(), m_pref_map);
+  m_dirty = false;
   return true;
 }
 
@@ -426,7 +597,7 @@ bool FileBackedPreferences::LoadFromFile(const string &filename) {
     return false;
   }
 
-  m_pref_map.clear();
+  Clear();
   string line;
   while (getline(pref_file, line)) {
     StringTrim(&line);
@@ -447,9 +618,10 @@ bool FileBackedPreferences::LoadFromFile(const string &filename) {
     string value = tokens[1];
     StringTrim(&key);
     StringTrim(&value);
-    m_pref_map.insert(make_pair(key, value));
+    SetMultipleValue(key, value);
   }
   pref_file.close();
+  m_dirty = false;
   return true;
 }
 }  // namespace ola
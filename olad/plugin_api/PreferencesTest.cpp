@@ -18,6 +18,7 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <unistd.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include <set>
 #include <string>
@@ -26,10 +27,12 @@
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
 #include "ola/testing/TestUtils.h"
 
 
 using ola::BoolValidator;
+using ola::CPUListValidator;
 using ola::FileBackedPreferences;
 using ola::FileBackedPreferencesFactory;
 using ola::IntToString;
@@ -39,6 +42,7 @@ using ola::MemoryPreferencesFactory;
 using ola::Preferences;
 using ola::SetValidator;
 using ola::StringValidator;
+using ola::ThreadPreferences;
 using ola::IPv4Validator;
 using std::string;
 using std::vector;
@@ -52,6 +56,8 @@ class PreferencesTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testFactory);
   CPPUNIT_TEST(testLoad);
   CPPUNIT_TEST(testSave);
+  CPPUNIT_TEST(testCoalescedSave);
+  CPPUNIT_TEST(testThreadPreferences);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -64,6 +70,8 @@ class PreferencesTest: public CppUnit::TestFixture {
     void testFactory();
     void testLoad();
     void testSave();
+    void testCoalescedSave();
+    void testThreadPreferences();
 };
 
 
@@ -172,9 +180,21 @@ void PreferencesTest::testGetSetRemove() {
   preferences->SetValue(key1, value4);
   OLA_ASSERT_EQ(IntToString(value4), preferences->GetValue(key1));
 
+  // test GetValueAsUInt
+  unsigned int uint_value = 0;
+  OLA_ASSERT_TRUE(preferences->GetValueAsUInt(key1, &uint_value));
+  OLA_ASSERT_EQ(value4, uint_value);
+  preferences->SetValue(key1, value3);
+  OLA_ASSERT_TRUE(preferences->GetValueAsUInt(key1, &uint_value));
+  OLA_ASSERT_EQ(value3, uint_value);
+  preferences->SetValue(key1, value1);
+  OLA_ASSERT_FALSE(preferences->GetValueAsUInt(key1, &uint_value));
+  OLA_ASSERT_FALSE(preferences->GetValueAsUInt(key2, &uint_value));
+
   preferences->RemoveValue(key1);
   OLA_ASSERT_EQ(string(""), preferences->GetValue(key1));
   OLA_ASSERT_FALSE(preferences->HasKey(key1));
+  OLA_ASSERT_FALSE(preferences->GetValueAsUInt(key1, &uint_value));
 
   // test get/set/has single values int
   OLA_ASSERT_EQ(string(""), preferences->GetValue(key1));
@@ -377,3 +397,98 @@ void PreferencesTest::testSave() {
 
   saver_thread.Join();
 }
+
+
+/*
+ * Check that saves are coalesced, and only written when something changed.
+ */
+void PreferencesTest::testCoalescedSave() {
+  const string data_path = TEST_BUILD_DIR "/olad/ola-coalesced.conf";
+  unlink(data_path.c_str());
+
+  // A long delay, so nothing is written unless we ask for it.
+  ola::FilePreferenceSaverThread saver_thread(ola::TimeInterval(3600, 0));
+  saver_thread.Start();
+  FileBackedPreferences *preferences = new FileBackedPreferences(
+      TEST_BUILD_DIR "/olad", "coalesced", &saver_thread);
+  preferences->Clear();
+
+  for (unsigned int i = 0; i < 100; i++) {
+    preferences->SetValue("port", i);
+    preferences->Save();
+  }
+  OLA_ASSERT_EQ(-1, access(data_path.c_str(), F_OK));
+
+  // Only the latest values are written.
+  saver_thread.Syncronize();
+  FileBackedPreferences input_preferences("", "input", NULL);
+  OLA_ASSERT_TRUE(input_preferences.LoadFromFile(data_path));
+  OLA_ASSERT_EQ(string("99"), input_preferences.GetValue("port"));
+  OLA_ASSERT_EQ(-1, access((data_path + ".new").c_str(), F_OK));
+
+  // Nothing changed, so this doesn't write the file.
+  unlink(data_path.c_str());
+  preferences->SetValue("port", 99);
+  preferences->Save();
+  saver_thread.Syncronize();
+  OLA_ASSERT_EQ(-1, access(data_path.c_str(), F_OK));
+
+  // Pending saves are written when the thread stops.
+  preferences->SetValue("port", "last");
+  preferences->Save();
+  saver_thread.Join();
+  OLA_ASSERT_TRUE(input_preferences.LoadFromFile(data_path));
+  OLA_ASSERT_EQ(string("last"), input_preferences.GetValue("port"));
+  delete preferences;
+}
+
+
+/*
+ * Check the thread preferences.
+ */
+void PreferencesTest::testThreadPreferences() {
+  CPUListValidator cpu_validator;
+  OLA_ASSERT_TRUE(cpu_validator.IsValid("-1"));
+  OLA_ASSERT_TRUE(cpu_validator.IsValid("3"));
+  OLA_ASSERT_TRUE(cpu_validator.IsValid("0,2-3"));
+  OLA_ASSERT_FALSE(cpu_validator.IsValid("foo"));
+  OLA_ASSERT_FALSE(cpu_validator.IsValid("3-1"));
+
+  MemoryPreferencesFactory factory;
+  Preferences *preferences = factory.NewPreference("dummy");
+
+  // The defaults leave the scheduling alone.
+  OLA_ASSERT_TRUE(ThreadPreferences::SetDefaults(preferences));
+  OLA_ASSERT_FALSE(ThreadPreferences::SetDefaults(preferences));
+  OLA_ASSERT_EQ(string("0"), preferences->GetValue("rt-priority"));
+  OLA_ASSERT_EQ(string("fifo"), preferences->GetValue("rt-policy"));
+  OLA_ASSERT_EQ(string("-1"), preferences->GetValue("cpu"));
+
+  ola::thread::SchedulingOptions options = ThreadPreferences::Load(
+      preferences);
+  OLA_ASSERT_EQ(0, options.priority);
+  OLA_ASSERT_EQ(SCHED_FIFO, options.policy);
+  OLA_ASSERT_TRUE(options.cpus.empty());
+
+  // Prefixed keys, as used for per-device threads.
+  const string prefix = "/dev/ttyAMA0-";
+  preferences->SetValue(prefix + "rt-priority", 80);
+  preferences->SetValue(prefix + "rt-policy", "rr");
+  preferences->SetValue(prefix + "cpu", "2-3");
+  OLA_ASSERT_FALSE(ThreadPreferences::SetDefaults(preferences, prefix));
+  options = ThreadPreferences::Load(preferences, prefix);
+  OLA_ASSERT_EQ(80, options.priority);
+  OLA_ASSERT_EQ(SCHED_RR, options.policy);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), options.cpus.size());
+  OLA_ASSERT_EQ(2u, options.cpus[0]);
+  OLA_ASSERT_EQ(3u, options.cpus[1]);
+
+  // Invalid values are replaced by the defaults.
+  preferences->SetValue(prefix + "rt-priority", "high");
+  preferences->SetValue(prefix + "cpu", "all");
+  options = ThreadPreferences::Load(preferences, prefix);
+  OLA_ASSERT_EQ(0, options.priority);
+  OLA_ASSERT_TRUE(options.cpus.empty());
+  OLA_ASSERT_TRUE(ThreadPreferences::SetDefaults(preferences, prefix));
+  OLA_ASSERT_EQ(string("-1"), preferences->GetValue(prefix + "cpu"));
+}
@@ -0,0 +1,227 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCache.cpp
+ * Caches the responses to GETs of RDM PIDs that rarely change.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/RDMResponseCache.h"
+
+#include <string>
+
+#include "ola/Logging.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/stl/STLUtils.h"
+
+namespace ola {
+
+using ola::rdm::RDMCommand;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using std::string;
+
+const unsigned int RDMResponseCache::MAX_ENTRIES;
+
+bool RDMResponseCache::Key::operator<(const Key &other) const {
+  if (uid != other.uid) {
+    return uid < other.uid;
+  }
+  if (sub_device != other.sub_device) {
+    return sub_device < other.sub_device;
+  }
+  if (pid != other.pid) {
+    return pid < other.pid;
+  }
+  return param_data < other.param_data;
+}
+
+RDMResponseCache::RDMResponseCache(Clock *clock)
+    : m_clock(clock) {
+}
+
+RDMResponseCache::~RDMResponseCache() {}
+
+void RDMResponseCache::SetTTL(const TimeInterval &ttl) {
+  m_ttl = ttl;
+  if (m_ttl.IsZero()) {
+    Clear();
+  }
+}
+
+RDMReply *RDMResponseCache::Lookup(const RDMRequest &request) {
+  if (!Enabled() || request.CommandClass() != RDMCommand::GET_COMMAND ||
+      !IsCacheable(request.ParamId())) {
+    return NULL;
+  }
+
+  EntryMap::iterator iter = m_entries.find(MakeKey(request));
+  if (iter == m_entries.end()) {
+    return NULL;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (now >= iter->second.expiry) {
+    m_entries.erase(iter);
+    return NULL;
+  }
+
+  const string &data = iter->second.param_data;
+  RDMResponse *response = ola::rdm::GetResponseFromData(
+      &request, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  return new RDMReply(ola::rdm::RDM_COMPLETED_OK, response);
+}
+
+void RDMResponseCache::RequestSent(const RDMRequest &request) {
+  if (Enabled() && request.CommandClass() == RDMCommand::SET_COMMAND) {
+    Invalidate(request.DestinationUID());
+  }
+}
+
+void RDMResponseCache::ReplyReceived(const RDMRequest &request,
+                                     const RDMReply &reply) {
+  if (!Enabled()) {
+    return;
+  }
+
+  const UID &uid = request.DestinationUID();
+  if (request.CommandClass() == RDMCommand::SET_COMMAND ||
+      request.ParamId() == ola::rdm::PID_QUEUED_MESSAGE) {
+    // A SET may have been partly applied even if it failed.
+    Invalidate(uid);
+    return;
+  }
+
+  const RDMResponse *response = reply.Response();
+  if (reply.StatusCode() != ola::rdm::RDM_COMPLETED_OK || !response) {
+    return;
+  }
+
+  if (response->ResponseType() == ola::rdm::RDM_ACK_TIMER ||
+      response->MessageCount()) {
+    Invalidate(uid);
+    return;
+  }
+
+  if (request.CommandClass() != RDMCommand::GET_COMMAND ||
+      uid.IsBroadcast() ||
+      !IsCacheable(request.ParamId()) ||
+      response->ResponseType() != ola::rdm::RDM_ACK ||
+      response->ParamId() != request.ParamId() ||
+      response->SubDevice() != request.SubDevice()) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (m_entries.size() >= MAX_ENTRIES) {
+    RemoveExpired(now);
+    if (m_entries.size() >= MAX_ENTRIES) {
+      OLA_DEBUG << "RDM response cache is full";
+      return;
+    }
+  }
+
+  Entry &entry = m_entries[MakeKey(request)];
+  entry.expiry = now + m_ttl;
+  entry.param_data = ParamData(*response);
+}
+
+void RDMResponseCache::Invalidate(const UID &uid) {
+  if (uid.IsBroadcast()) {
+    EntryMap::iterator iter = m_entries.begin();
+    while (iter != m_entries.end()) {
+      if (uid.DirectedToUID(iter->first.uid)) {
+        m_entries.erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+    return;
+  }
+
+  // The entries for a UID are next to each other, starting with the one for
+  // the root device, PID 0 & no param data.
+  EntryMap::iterator iter = m_entries.lower_bound(Key(uid, 0, 0, ""));
+  while (iter != m_entries.end() && iter->first.uid == uid) {
+    m_entries.erase(iter++);
+  }
+}
+
+void RDMResponseCache::Clear() {
+  m_entries.clear();
+}
+
+size_t RDMResponseCache::MemoryUsage() const {
+  size_t bytes = STLNodeMemoryUsage(m_entries);
+  EntryMap::const_iterator iter = m_entries.begin();
+  for (; iter != m_entries.end(); ++iter) {
+    bytes += iter->first.param_data.capacity() +
+             iter->second.param_data.capacity();
+  }
+  return bytes;
+}
+
+bool RDMResponseCache::IsCacheable(uint16_t pid) {
+  switch (pid) {
+    case ola::rdm::PID_DEVICE_INFO:
+    case ola::rdm::PID_DEVICE_MODEL_DESCRIPTION:
+    case ola::rdm::PID_MANUFACTURER_LABEL:
+    case ola::rdm::PID_SUPPORTED_PARAMETERS:
+    case ola::rdm::PID_PARAMETER_DESCRIPTION:
+    case ola::rdm::PID_PRODUCT_DETAIL_ID_LIST:
+    case ola::rdm::PID_SOFTWARE_VERSION_LABEL:
+    case ola::rdm::PID_BOOT_SOFTWARE_VERSION_ID:
+    case ola::rdm::PID_BOOT_SOFTWARE_VERSION_LABEL:
+    case ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION:
+    case ola::rdm::PID_SLOT_INFO:
+    case ola::rdm::PID_SLOT_DESCRIPTION:
+    case ola::rdm::PID_DEFAULT_SLOT_VALUE:
+    case ola::rdm::PID_SENSOR_DEFINITION:
+    case ola::rdm::PID_STATUS_ID_DESCRIPTION:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void RDMResponseCache::RemoveExpired(const TimeStamp &now) {
+  EntryMap::iterator iter = m_entries.begin();
+  while (iter != m_entries.end()) {
+    if (now >= iter->second.expiry) {
+      m_entries.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+RDMResponseCache::Key RDMResponseCache::MakeKey(const RDMRequest &request) {
+  return Key(request.DestinationUID(), request.SubDevice(),
+             request.ParamId(), ParamData(request));
+}
+
+string RDMResponseCache::ParamData(const RDMCommand &command) {
+  if (!command.ParamDataSize()) {
+    return string();
+  }
+  return string(reinterpret_cast<const char*>(command.ParamData()),
+                command.ParamDataSize());
+}
+}  // namespace ola
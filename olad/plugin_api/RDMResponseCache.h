@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCache.h
+ * Caches the responses to GETs of RDM PIDs that rarely change.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
+#define OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+
+namespace ola {
+
+/**
+ * @brief Caches the responses to GETs of RDM PIDs that rarely change.
+ *
+ * Only ACKs for the PIDs in IsCacheable() are stored, e.g. DEVICE_INFO,
+ * SUPPORTED_PARAMETERS & the personality and slot descriptions. The entries
+ * for a UID are invalidated when:
+ *  - a SET is sent to the UID, or as a broadcast.
+ *  - the responder sends an ACK_TIMER, or has queued messages.
+ *  - a QUEUED_MESSAGE GET is sent to the UID, since the reply could be for
+ *    any PID.
+ *  - the TTL passes.
+ */
+class RDMResponseCache {
+ public:
+  /**
+   * @brief Create a new cache.
+   * @param clock the clock to use, ownership is not transferred.
+   */
+  explicit RDMResponseCache(Clock *clock);
+  ~RDMResponseCache();
+
+  /**
+   * @brief Set how long responses are kept for.
+   * @param ttl the time to keep responses for, 0 disables the cache.
+   */
+  void SetTTL(const TimeInterval &ttl);
+
+  bool Enabled() const { return !m_ttl.IsZero(); }
+
+  /**
+   * @brief Look up the response for a request.
+   * @param request the request.
+   * @returns a new RDMReply for the request, or NULL if there isn't a fresh
+   *   response. Ownership is transferred.
+   */
+  ola::rdm::RDMReply *Lookup(const ola::rdm::RDMRequest &request);
+
+  /**
+   * @brief Called before a request is sent, this invalidates the UIDs a SET
+   *   applies to.
+   */
+  void RequestSent(const ola::rdm::RDMRequest &request);
+
+  /**
+   * @brief Called with the reply to a request, this stores cacheable
+   *   responses and handles the invalidation.
+   */
+  void ReplyReceived(const ola::rdm::RDMRequest &request,
+                     const ola::rdm::RDMReply &reply);
+
+  /**
+   * @brief Remove the responses from a UID, or every UID if it's a
+   *   broadcast UID.
+   */
+  void Invalidate(const ola::rdm::UID &uid);
+
+  void Clear();
+
+  unsigned int Size() const { return m_entries.size(); }
+
+  /**
+   * @brief Estimate the memory used by the cached responses, in bytes.
+   */
+  size_t MemoryUsage() const;
+
+  /**
+   * @brief Returns true if the responses to GETs of a PID can be cached.
+   */
+  static bool IsCacheable(uint16_t pid);
+
+  // The max number of responses to store.
+  static const unsigned int MAX_ENTRIES = 20000;
+
+ private:
+  struct Key {
+    ola::rdm::UID uid;
+    uint16_t sub_device;
+    uint16_t pid;
+    std::string param_data;
+
+    Key(const ola::rdm::UID &uid, uint16_t sub_device, uint16_t pid,
+        const std::string &param_data)
+        : uid(uid),
+          sub_device(sub_device),
+          pid(pid),
+          param_data(param_data) {
+    }
+
+    bool operator<(const Key &other) const;
+  };
+
+  struct Entry {
+    TimeStamp expiry;
+    std::string param_data;
+  };
+
+  typedef std::map<Key, Entry> EntryMap;
+
+  Clock *m_clock;
+  TimeInterval m_ttl;
+  EntryMap m_entries;
+
+  void RemoveExpired(const TimeStamp &now);
+
+  static Key MakeKey(const ola::rdm::RDMRequest &request);
+  static std::string ParamData(const ola::rdm::RDMCommand &command);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMResponseCache);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
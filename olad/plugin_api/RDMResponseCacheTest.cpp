@@ -0,0 +1,284 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCacheTest.cpp
+ * Test fixture for the RDMResponseCache class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/rdm/UID.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::MockClock;
+using ola::RDMResponseCache;
+using ola::TimeInterval;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using std::auto_ptr;
+
+class RDMResponseCacheTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMResponseCacheTest);
+  CPPUNIT_TEST(testDisabled);
+  CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testNotCacheable);
+  CPPUNIT_TEST(testExpiry);
+  CPPUNIT_TEST(testSetInvalidates);
+  CPPUNIT_TEST(testQueuedMessages);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMResponseCacheTest()
+      : m_source(1, 2),
+        m_destination(3, 4),
+        m_other_destination(3, 5) {
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testDisabled();
+  void testLookup();
+  void testNotCacheable();
+  void testExpiry();
+  void testSetInvalidates();
+  void testQueuedMessages();
+
+ private:
+  const UID m_source;
+  const UID m_destination;
+  const UID m_other_destination;
+  MockClock m_clock;
+
+  RDMRequest *NewGet(const UID &destination, uint8_t transaction_number,
+                     uint16_t pid) {
+    return new RDMGetRequest(m_source, destination, transaction_number, 1,
+                             0, pid, NULL, 0);
+  }
+
+  // Pass an ACK with some data for the request to the cache.
+  void Reply(RDMResponseCache *cache, const RDMRequest &request,
+             ola::rdm::rdm_response_type type = ola::rdm::RDM_ACK,
+             uint8_t outstanding_messages = 0) {
+    const uint8_t data[] = {0x12, 0x34};
+    RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                   ola::rdm::GetResponseFromData(&request, data,
+                                                 sizeof(data), type,
+                                                 outstanding_messages));
+    cache->ReplyReceived(request, reply);
+  }
+
+  // Populate the cache with DEVICE_INFO for both responders.
+  void Populate(RDMResponseCache *cache) {
+    auto_ptr<RDMRequest> request(
+        NewGet(m_destination, 1, ola::rdm::PID_DEVICE_INFO));
+    Reply(cache, *request);
+    request.reset(NewGet(m_other_destination, 2, ola::rdm::PID_DEVICE_INFO));
+    Reply(cache, *request);
+    OLA_ASSERT_EQ(2u, cache->Size());
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMResponseCacheTest);
+
+
+/*
+ * Check nothing is stored until a TTL is set.
+ */
+void RDMResponseCacheTest::testDisabled() {
+  RDMResponseCache cache(&m_clock);
+  OLA_ASSERT_FALSE(cache.Enabled());
+
+  auto_ptr<RDMRequest> request(
+      NewGet(m_destination, 1, ola::rdm::PID_DEVICE_INFO));
+  Reply(&cache, *request);
+  OLA_ASSERT_EQ(0u, cache.Size());
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+
+  cache.SetTTL(TimeInterval(10, 0));
+  Reply(&cache, *request);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  // setting the TTL to 0 empties the cache
+  cache.SetTTL(TimeInterval(0, 0));
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check cached replies match the request they're returned for.
+ */
+void RDMResponseCacheTest::testLookup() {
+  RDMResponseCache cache(&m_clock);
+  cache.SetTTL(TimeInterval(10, 0));
+
+  auto_ptr<RDMRequest> request(
+      NewGet(m_destination, 1, ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+  Reply(&cache, *request);
+
+  request.reset(NewGet(m_destination, 42, ola::rdm::PID_DEVICE_INFO));
+  auto_ptr<RDMReply> reply(cache.Lookup(*request));
+  OLA_ASSERT_NOT_NULL(reply.get());
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, reply->StatusCode());
+  const RDMResponse *response = reply->Response();
+  OLA_ASSERT_NOT_NULL(response);
+  OLA_ASSERT_EQ(42, static_cast<int>(response->TransactionNumber()));
+  OLA_ASSERT_EQ(m_destination, response->SourceUID());
+  OLA_ASSERT_EQ(m_source, response->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_INFO),
+                response->ParamId());
+  OLA_ASSERT_EQ(2u, response->ParamDataSize());
+  OLA_ASSERT_EQ(0x12, static_cast<int>(response->ParamData()[0]));
+  OLA_ASSERT_EQ(0x34, static_cast<int>(response->ParamData()[1]));
+
+  // a different responder isn't cached
+  request.reset(NewGet(m_other_destination, 3, ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+
+  // nor is a request with different param data
+  const uint8_t personality = 1;
+  request.reset(new RDMGetRequest(m_source, m_destination, 4, 1, 0,
+                                  ola::rdm::PID_DEVICE_INFO, &personality,
+                                  sizeof(personality)));
+  OLA_ASSERT_NULL(cache.Lookup(*request));
+}
+
+
+/*
+ * Check PIDs that change, and replies other than ACKs, aren't stored.
+ */
+void RDMResponseCacheTest::testNotCacheable() {
+  RDMResponseCache cache(&m_clock);
+  cache.SetTTL(TimeInterval(10, 0));
+
+  OLA_ASSERT_TRUE(RDMResponseCache::IsCacheable(ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(ola::rdm::PID_SENSOR_VALUE));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(ola::rdm::PID_DEVICE_LABEL));
+
+  auto_ptr<RDMRequest> request(
+      NewGet(m_destination, 1, ola::rdm::PID_SENSOR_VALUE));
+  Reply(&cache, *request);
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  request.reset(NewGet(m_destination, 2, ola::rdm::PID_DEVICE_INFO));
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  cache.ReplyReceived(*request, timeout);
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  RDMReply nack(ola::rdm::RDM_COMPLETED_OK,
+                ola::rdm::NackWithReason(request.get(),
+                                         ola::rdm::NR_UNKNOWN_PID));
+  cache.ReplyReceived(*request, nack);
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check entries expire after the TTL.
+ */
+void RDMResponseCacheTest::testExpiry() {
+  RDMResponseCache cache(&m_clock);
+  cache.SetTTL(TimeInterval(10, 0));
+
+  auto_ptr<RDMRequest> request(
+      NewGet(m_destination, 1, ola::rdm::PID_DEVICE_INFO));
+  Reply(&cache, *request);
+
+  m_clock.AdvanceTime(9, 0);
+  auto_ptr<RDMReply> reply(cache.Lookup(*request));
+  OLA_ASSERT_NOT_NULL(reply.get());
+
+  m_clock.AdvanceTime(1, 0);
+  reply.reset(cache.Lookup(*request));
+  OLA_ASSERT_NULL(reply.get());
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check SETs remove the entries for the responders they're sent to.
+ */
+void RDMResponseCacheTest::testSetInvalidates() {
+  RDMResponseCache cache(&m_clock);
+  cache.SetTTL(TimeInterval(10, 0));
+  Populate(&cache);
+
+  RDMSetRequest set(m_source, m_destination, 3, 1, 0,
+                    ola::rdm::PID_DMX_PERSONALITY, NULL, 0);
+  cache.RequestSent(set);
+  OLA_ASSERT_EQ(1u, cache.Size());
+  auto_ptr<RDMRequest> request(
+      NewGet(m_other_destination, 4, ola::rdm::PID_DEVICE_INFO));
+  auto_ptr<RDMReply> reply(cache.Lookup(*request));
+  OLA_ASSERT_NOT_NULL(reply.get());
+
+  // a broadcast to the manufacturer clears both
+  Populate(&cache);
+  RDMSetRequest vendorcast(m_source, UID::VendorcastAddress(3), 5, 1, 0,
+                           ola::rdm::PID_DMX_PERSONALITY, NULL, 0);
+  cache.RequestSent(vendorcast);
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  // a broadcast to another manufacturer doesn't
+  Populate(&cache);
+  RDMSetRequest other_vendorcast(m_source, UID::VendorcastAddress(7), 6, 1, 0,
+                                 ola::rdm::PID_DMX_PERSONALITY, NULL, 0);
+  cache.RequestSent(other_vendorcast);
+  OLA_ASSERT_EQ(2u, cache.Size());
+
+  cache.Invalidate(UID::AllDevices());
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check responders with queued messages or an ACK_TIMER are invalidated.
+ */
+void RDMResponseCacheTest::testQueuedMessages() {
+  RDMResponseCache cache(&m_clock);
+  cache.SetTTL(TimeInterval(10, 0));
+
+  Populate(&cache);
+  auto_ptr<RDMRequest> request(
+      NewGet(m_destination, 3, ola::rdm::PID_SUPPORTED_PARAMETERS));
+  Reply(&cache, *request, ola::rdm::RDM_ACK, 1);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  Populate(&cache);
+  Reply(&cache, *request, ola::rdm::RDM_ACK_TIMER);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  Populate(&cache);
+  request.reset(NewGet(m_destination, 4, ola::rdm::PID_QUEUED_MESSAGE));
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  cache.ReplyReceived(*request, timeout);
+  OLA_ASSERT_EQ(1u, cache.Size());
+}
@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMScheduler.cpp
+ * Schedules the RDM requests a universe sends to its output ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/RDMScheduler.h"
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/Port.h"
+
+namespace ola {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMCommand;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RunRDMCallback;
+
+const unsigned int RDMScheduler::MAX_IN_FLIGHT;
+const unsigned int RDMScheduler::MAX_QUEUED_REQUESTS;
+const unsigned int RDMScheduler::BACKGROUND_INTERVAL;
+
+RDMScheduler::~RDMScheduler() {
+  PortMap::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    FailRequests(&iter->second->queues[INTERACTIVE_REQUEST]);
+    FailRequests(&iter->second->queues[BACKGROUND_REQUEST]);
+  }
+  STLDeleteValues(&m_ports);
+}
+
+void RDMScheduler::SendRDMRequest(OutputPort *port, RDMRequest *request,
+                                  RDMCallback *callback) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  if (!state) {
+    state = new PortState();
+    m_ports[port] = state;
+  }
+
+  RequestQueue *queue = &state->queues[Classify(*request)];
+  if (queue->size() >= MAX_QUEUED_REQUESTS) {
+    OLA_WARN << "RDM queue for " << port->UniqueId()
+             << " is full, dropping request";
+    delete request;
+    RunRDMCallback(callback, ola::rdm::RDM_FAILED_TO_SEND);
+    return;
+  }
+
+  PendingRequest pending = {request, callback};
+  queue->push_back(pending);
+  Dispatch(port);
+}
+
+void RDMScheduler::RemovePort(OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return;
+  }
+  PortState *state = iter->second;
+  m_ports.erase(iter);
+  FailRequests(&state->queues[INTERACTIVE_REQUEST]);
+  FailRequests(&state->queues[BACKGROUND_REQUEST]);
+  delete state;
+}
+
+unsigned int RDMScheduler::QueuedRequests(OutputPort *port) const {
+  const PortState *state = STLFindOrNull(m_ports, port);
+  if (!state) {
+    return 0;
+  }
+  return state->queues[INTERACTIVE_REQUEST].size() +
+         state->queues[BACKGROUND_REQUEST].size();
+}
+
+RDMScheduler::RequestClass RDMScheduler::Classify(const RDMRequest &request) {
+  if (request.CommandClass() != RDMCommand::GET_COMMAND) {
+    return INTERACTIVE_REQUEST;
+  }
+
+  switch (request.ParamId()) {
+    case ola::rdm::PID_QUEUED_MESSAGE:
+    case ola::rdm::PID_STATUS_MESSAGES:
+    case ola::rdm::PID_SENSOR_VALUE:
+    case ola::rdm::PID_LAMP_HOURS:
+    case ola::rdm::PID_DEVICE_HOURS:
+      return BACKGROUND_REQUEST;
+    default:
+      return INTERACTIVE_REQUEST;
+  }
+}
+
+/*
+ * Pass requests to the port until it has MAX_IN_FLIGHT of them.
+ *
+ * The port may run the callback before SendRDMRequest() returns, and the
+ * callback may remove the port, so the state is looked up after each request.
+ */
+void RDMScheduler::Dispatch(OutputPort *port) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  if (!state || state->dispatching) {
+    return;
+  }
+
+  state->dispatching = true;
+  while (state->in_flight < MAX_IN_FLIGHT) {
+    RequestQueue *interactive = &state->queues[INTERACTIVE_REQUEST];
+    RequestQueue *background = &state->queues[BACKGROUND_REQUEST];
+    RequestQueue *queue;
+    if (background->empty() ||
+        (!interactive->empty() &&
+         state->interactive_run < BACKGROUND_INTERVAL)) {
+      queue = interactive;
+    } else {
+      queue = background;
+    }
+
+    if (queue->empty()) {
+      break;
+    }
+
+    state->interactive_run = (queue == interactive) ?
+        state->interactive_run + 1 : 0;
+    PendingRequest pending = queue->front();
+    queue->pop_front();
+    state->in_flight++;
+
+    port->SendRDMRequest(
+        pending.request,
+        NewSingleCallback(this, &RDMScheduler::RequestComplete, port,
+                          pending.callback));
+
+    state = STLFindOrNull(m_ports, port);
+    if (!state) {
+      return;
+    }
+    state->dispatching = true;
+  }
+  state->dispatching = false;
+}
+
+void RDMScheduler::RequestComplete(OutputPort *port, RDMCallback *callback,
+                                   RDMReply *reply) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  // If the port was removed & added again, this request isn't counted.
+  if (state && state->in_flight) {
+    state->in_flight--;
+  }
+  callback->Run(reply);
+  Dispatch(port);
+}
+
+void RDMScheduler::FailRequests(RequestQueue *queue) {
+  while (!queue->empty()) {
+    PendingRequest pending = queue->front();
+    queue->pop_front();
+    delete pending.request;
+    RunRDMCallback(pending.callback, ola::rdm::RDM_FAILED_TO_SEND);
+  }
+}
+}  // namespace ola
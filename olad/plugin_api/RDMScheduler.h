@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMScheduler.h
+ * Schedules the RDM requests a universe sends to its output ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMSCHEDULER_H_
+#define OLAD_PLUGIN_API_RDMSCHEDULER_H_
+
+#include <deque>
+#include <map>
+
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+
+namespace ola {
+
+class OutputPort;
+
+/**
+ * @brief Schedules the RDM requests a universe sends to its output ports.
+ *
+ * Each port is scheduled on its own, so requests for different ports run in
+ * parallel. Up to MAX_IN_FLIGHT requests are passed to a port at once, the
+ * rest wait here in one of two queues:
+ *  - background requests, the GETs that monitoring tools poll for, like
+ *    SENSOR_VALUE and STATUS_MESSAGES.
+ *  - interactive requests, everything else.
+ *
+ * Interactive requests are sent first, so a user changing settings doesn't
+ * wait behind the polling of thousands of fixtures. Every
+ * BACKGROUND_INTERVAL requests a background one is sent, even if there are
+ * interactive ones waiting, so monitoring isn't starved.
+ */
+class RDMScheduler {
+ public:
+  enum RequestClass {
+    INTERACTIVE_REQUEST,
+    BACKGROUND_REQUEST,
+  };
+
+  RDMScheduler() {}
+
+  /**
+   * @brief Destructor, this fails any requests that are still queued.
+   */
+  ~RDMScheduler();
+
+  /**
+   * @brief Send a request to a port.
+   * @param port the port to send the request on.
+   * @param request the request, ownership is transferred.
+   * @param callback the callback to run when the request completes.
+   */
+  void SendRDMRequest(OutputPort *port, ola::rdm::RDMRequest *request,
+                      ola::rdm::RDMCallback *callback);
+
+  /**
+   * @brief Fail the queued requests for a port that is being removed.
+   *
+   * The callbacks for requests the port already has are still run.
+   */
+  void RemovePort(OutputPort *port);
+
+  /**
+   * @brief Return the number of requests queued for a port.
+   *
+   * This doesn't include the requests that have been passed to the port.
+   */
+  unsigned int QueuedRequests(OutputPort *port) const;
+
+  /**
+   * @brief Return the class a request is scheduled with.
+   */
+  static RequestClass Classify(const ola::rdm::RDMRequest &request);
+
+  // The max number of requests passed to a port at once.
+  static const unsigned int MAX_IN_FLIGHT = 2;
+  // The max number of requests queued for a port, in each class.
+  static const unsigned int MAX_QUEUED_REQUESTS = 1000;
+  // Send a background request after this many interactive ones.
+  static const unsigned int BACKGROUND_INTERVAL = 4;
+
+ private:
+  struct PendingRequest {
+    ola::rdm::RDMRequest *request;
+    ola::rdm::RDMCallback *callback;
+  };
+
+  typedef std::deque<PendingRequest> RequestQueue;
+
+  struct PortState {
+    PortState()
+        : in_flight(0),
+          interactive_run(0),
+          dispatching(false) {
+    }
+
+    unsigned int in_flight;
+    // The number of interactive requests sent since the last background one.
+    unsigned int interactive_run;
+    // True while Dispatch() is sending requests for this port.
+    bool dispatching;
+    RequestQueue queues[2];
+  };
+
+  typedef std::map<OutputPort*, PortState*> PortMap;
+
+  PortMap m_ports;
+
+  void Dispatch(OutputPort *port);
+  void RequestComplete(OutputPort *port, ola::rdm::RDMCallback *callback,
+                       ola::rdm::RDMReply *reply);
+
+  static void FailRequests(RequestQueue *queue);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMScheduler);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMSCHEDULER_H_
@@ -0,0 +1,280 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMSchedulerTest.cpp
+ * Test fixture for the RDMScheduler class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <deque>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "olad/plugin_api/RDMScheduler.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::RDMScheduler;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::deque;
+using std::vector;
+
+class RDMSchedulerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMSchedulerTest);
+  CPPUNIT_TEST(testClassify);
+  CPPUNIT_TEST(testPriorities);
+  CPPUNIT_TEST(testParallelPorts);
+  CPPUNIT_TEST(testSynchronousPort);
+  CPPUNIT_TEST(testRemovePort);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMSchedulerTest()
+      : m_source(1, 2),
+        m_destination(3, 4) {
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+    m_completed.clear();
+  }
+
+  void testClassify();
+  void testPriorities();
+  void testParallelPorts();
+  void testSynchronousPort();
+  void testRemovePort();
+
+ private:
+  struct SentRequest {
+    uint8_t transaction_number;
+    RDMCallback *callback;
+  };
+
+  typedef deque<SentRequest> SentRequests;
+
+  const UID m_source;
+  const UID m_destination;
+  vector<uint8_t> m_completed;
+
+  RDMRequest *NewGet(uint8_t transaction_number, uint16_t pid) {
+    return new RDMGetRequest(m_source, m_destination, transaction_number, 1,
+                             0, pid, NULL, 0);
+  }
+
+  RDMCallback *NewComplete(uint8_t transaction_number) {
+    return NewSingleCallback(this, &RDMSchedulerTest::RequestComplete,
+                             transaction_number);
+  }
+
+  void RequestComplete(uint8_t transaction_number, RDMReply *reply) {
+    (void) reply;
+    m_completed.push_back(transaction_number);
+  }
+
+  void HandleRequest(SentRequests *sent, const RDMRequest *request,
+                     RDMCallback *callback) {
+    SentRequest sent_request = {request->TransactionNumber(), callback};
+    sent->push_back(sent_request);
+    delete request;
+  }
+
+  // Complete the oldest request sent to a port, returns its transaction #.
+  uint8_t CompleteNext(SentRequests *sent) {
+    OLA_ASSERT_FALSE(sent->empty());
+    SentRequest sent_request = sent->front();
+    sent->pop_front();
+    RDMReply reply(ola::rdm::RDM_TIMEOUT);
+    sent_request.callback->Run(&reply);
+    return sent_request.transaction_number;
+  }
+
+  TestMockRDMOutputPort::RDMRequestHandler *NewHandler(SentRequests *sent) {
+    return NewCallback(this, &RDMSchedulerTest::HandleRequest, sent);
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMSchedulerTest);
+
+
+/*
+ * Check that polled GETs are background requests.
+ */
+void RDMSchedulerTest::testClassify() {
+  RDMGetRequest sensor(m_source, m_destination, 0, 1, 0,
+                       ola::rdm::PID_SENSOR_VALUE, NULL, 0);
+  OLA_ASSERT_EQ(RDMScheduler::BACKGROUND_REQUEST,
+                RDMScheduler::Classify(sensor));
+
+  RDMGetRequest status(m_source, m_destination, 0, 1, 0,
+                       ola::rdm::PID_STATUS_MESSAGES, NULL, 0);
+  OLA_ASSERT_EQ(RDMScheduler::BACKGROUND_REQUEST,
+                RDMScheduler::Classify(status));
+
+  RDMGetRequest lamp_hours(m_source, m_destination, 0, 1, 0,
+                           ola::rdm::PID_LAMP_HOURS, NULL, 0);
+  OLA_ASSERT_EQ(RDMScheduler::BACKGROUND_REQUEST,
+                RDMScheduler::Classify(lamp_hours));
+
+  RDMGetRequest device_info(m_source, m_destination, 0, 1, 0,
+                            ola::rdm::PID_DEVICE_INFO, NULL, 0);
+  OLA_ASSERT_EQ(RDMScheduler::INTERACTIVE_REQUEST,
+                RDMScheduler::Classify(device_info));
+
+  // recording a sensor is a SET, which the user is waiting for
+  RDMSetRequest record(m_source, m_destination, 0, 1, 0,
+                       ola::rdm::PID_SENSOR_VALUE, NULL, 0);
+  OLA_ASSERT_EQ(RDMScheduler::INTERACTIVE_REQUEST,
+                RDMScheduler::Classify(record));
+}
+
+
+/*
+ * Check interactive requests jump the queue, without starving the background
+ * ones.
+ */
+void RDMSchedulerTest::testPriorities() {
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "test_device");
+  UIDSet uids;
+  SentRequests sent;
+  TestMockRDMOutputPort port(&device, 1, &uids, false, NewHandler(&sent));
+
+  RDMScheduler scheduler;
+  // Background requests are 1 - 7, interactive ones 10 - 15.
+  for (uint8_t i = 1; i <= 7; i++) {
+    scheduler.SendRDMRequest(&port, NewGet(i, ola::rdm::PID_SENSOR_VALUE),
+                             NewComplete(i));
+  }
+  for (uint8_t i = 10; i <= 15; i++) {
+    scheduler.SendRDMRequest(&port, NewGet(i, ola::rdm::PID_DEVICE_INFO),
+                             NewComplete(i));
+  }
+
+  OLA_ASSERT_EQ(static_cast<size_t>(RDMScheduler::MAX_IN_FLIGHT),
+                sent.size());
+  OLA_ASSERT_EQ(11u, scheduler.QueuedRequests(&port));
+
+  const uint8_t expected[] = {
+    1, 2, 10, 11, 12, 13, 3, 14, 15, 4, 5, 6, 7
+  };
+  for (unsigned int i = 0; i < sizeof(expected); i++) {
+    OLA_ASSERT_EQ(static_cast<int>(expected[i]),
+                  static_cast<int>(CompleteNext(&sent)));
+  }
+  OLA_ASSERT_TRUE(sent.empty());
+  OLA_ASSERT_EQ(0u, scheduler.QueuedRequests(&port));
+  OLA_ASSERT_EQ(static_cast<size_t>(13), m_completed.size());
+}
+
+
+/*
+ * Check that a busy port doesn't hold up another one.
+ */
+void RDMSchedulerTest::testParallelPorts() {
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "test_device");
+  UIDSet uids;
+  SentRequests sent1, sent2;
+  TestMockRDMOutputPort port1(&device, 1, &uids, false, NewHandler(&sent1));
+  TestMockRDMOutputPort port2(&device, 2, &uids, false, NewHandler(&sent2));
+
+  RDMScheduler scheduler;
+  for (uint8_t i = 1; i <= 5; i++) {
+    scheduler.SendRDMRequest(&port1, NewGet(i, ola::rdm::PID_DEVICE_INFO),
+                             NewComplete(i));
+  }
+  scheduler.SendRDMRequest(&port2, NewGet(20, ola::rdm::PID_DEVICE_INFO),
+                           NewComplete(20));
+
+  OLA_ASSERT_EQ(static_cast<size_t>(RDMScheduler::MAX_IN_FLIGHT),
+                sent1.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), sent2.size());
+  OLA_ASSERT_EQ(20, static_cast<int>(CompleteNext(&sent2)));
+  OLA_ASSERT_EQ(3u, scheduler.QueuedRequests(&port1));
+  OLA_ASSERT_EQ(0u, scheduler.QueuedRequests(&port2));
+
+  while (!sent1.empty()) {
+    CompleteNext(&sent1);
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(6), m_completed.size());
+}
+
+
+/*
+ * Check ports that run the callback straight away.
+ */
+void RDMSchedulerTest::testSynchronousPort() {
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "test_device");
+  UIDSet uids;
+  // with no handler the requests fail immediately
+  TestMockRDMOutputPort port(&device, 1, &uids);
+
+  RDMScheduler scheduler;
+  for (uint8_t i = 1; i <= 10; i++) {
+    scheduler.SendRDMRequest(&port, NewGet(i, ola::rdm::PID_SENSOR_VALUE),
+                             NewComplete(i));
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(10), m_completed.size());
+  OLA_ASSERT_EQ(0u, scheduler.QueuedRequests(&port));
+}
+
+
+/*
+ * Check the queued requests are failed when a port is removed.
+ */
+void RDMSchedulerTest::testRemovePort() {
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "test_device");
+  UIDSet uids;
+  SentRequests sent;
+  TestMockRDMOutputPort port(&device, 1, &uids, false, NewHandler(&sent));
+
+  RDMScheduler scheduler;
+  for (uint8_t i = 1; i <= 5; i++) {
+    scheduler.SendRDMRequest(&port, NewGet(i, ola::rdm::PID_DEVICE_INFO),
+                             NewComplete(i));
+  }
+
+  scheduler.RemovePort(&port);
+  OLA_ASSERT_EQ(0u, scheduler.QueuedRequests(&port));
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_completed.size());
+  OLA_ASSERT_EQ(3, static_cast<int>(m_completed[0]));
+  OLA_ASSERT_EQ(5, static_cast<int>(m_completed[2]));
+
+  // the requests the port had still complete
+  OLA_ASSERT_EQ(1, static_cast<int>(CompleteNext(&sent)));
+  OLA_ASSERT_EQ(2, static_cast<int>(CompleteNext(&sent)));
+  OLA_ASSERT_EQ(static_cast<size_t>(5), m_completed.size());
+  OLA_ASSERT_TRUE(sent.empty());
+}
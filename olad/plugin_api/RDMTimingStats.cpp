@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMTimingStats.cpp
+ * Collects the timing of the RDM responses a universe receives.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/RDMTimingStats.h"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/base/Array.h"
+#include "ola/rdm/RDMFrame.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/strings/Format.h"
+
+namespace ola {
+
+using ola::rdm::RDMFrames;
+using ola::rdm::RDMReply;
+using ola::rdm::UID;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+/*
+ * The bucket bounds in microseconds. These include the limits from E1.20,
+ * e.g. a responder must start its response within 2ms, and its break is
+ * between 88us and 352us.
+ */
+vector<uint64_t> TimingBounds() {
+  const uint64_t bounds[] = {
+    12, 20, 50, 88, 100, 176, 200, 352, 500, 1000, 2000, 2800, 5000, 10000
+  };
+  return vector<uint64_t>(bounds, bounds + arraysize(bounds));
+}
+}  // namespace
+
+const char RDMTimingStats::K_PORT_TURNAROUND_VAR[] = "rdm-port-turnaround-us";
+const char RDMTimingStats::K_PORT_BREAK_VAR[] = "rdm-port-break-us";
+const char RDMTimingStats::K_PORT_MARK_VAR[] = "rdm-port-mark-us";
+const char RDMTimingStats::K_UID_TURNAROUND_VAR[] = "rdm-uid-turnaround-us";
+const char RDMTimingStats::K_UID_BREAK_VAR[] = "rdm-uid-break-us";
+const char RDMTimingStats::K_UID_MARK_VAR[] = "rdm-uid-mark-us";
+const char RDMTimingStats::K_UID_TIMEOUTS_VAR[] = "rdm-uid-timeouts";
+const char RDMTimingStats::K_PID_TIMEOUTS_VAR[] = "rdm-pid-timeouts";
+
+RDMTimingStats::RDMTimingStats(ExportMap *export_map)
+    : m_export_map(export_map) {
+  const char *port_vars[] = {
+    K_PORT_TURNAROUND_VAR,
+    K_PORT_BREAK_VAR,
+    K_PORT_MARK_VAR,
+  };
+  const char *uid_vars[] = {
+    K_UID_TURNAROUND_VAR,
+    K_UID_BREAK_VAR,
+    K_UID_MARK_VAR,
+  };
+
+  const vector<uint64_t> bounds = TimingBounds();
+  for (unsigned int i = 0; i < MEASUREMENT_COUNT; i++) {
+    m_port_histograms[i] = NULL;
+    m_uid_histograms[i] = NULL;
+    if (m_export_map) {
+      m_port_histograms[i] = m_export_map->GetHistogramMapVar(
+          port_vars[i], "port", bounds);
+      m_uid_histograms[i] = m_export_map->GetHistogramMapVar(
+          uid_vars[i], "uid", bounds);
+    }
+  }
+}
+
+RDMTimingStats::~RDMTimingStats() {
+  // Copy the sets, since the Remove methods modify them.
+  const set<string> ports = m_ports;
+  set<string>::const_iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    RemovePort(*iter);
+  }
+
+  const set<string> uids = m_uids;
+  for (iter = uids.begin(); iter != uids.end(); ++iter) {
+    RemoveUIDKey(*iter);
+  }
+}
+
+void RDMTimingStats::RecordReply(const string &port_id,
+                                 const UID &uid,
+                                 uint16_t pid,
+                                 const RDMReply &reply) {
+  if (!m_export_map) {
+    return;
+  }
+
+  const string uid_str = uid.ToString();
+  if (reply.StatusCode() == ola::rdm::RDM_TIMEOUT) {
+    m_export_map->GetUIntMapVar(K_UID_TIMEOUTS_VAR, "uid")->Increment(
+        uid_str);
+    std::ostringstream pid_str;
+    pid_str << strings::ToHex(pid);
+    m_export_map->GetUIntMapVar(K_PID_TIMEOUTS_VAR, "pid")->Increment(
+        pid_str.str());
+    m_uids.insert(uid_str);
+    return;
+  }
+
+  const RDMFrames &frames = reply.Frames();
+  RDMFrames::const_iterator iter = frames.begin();
+  for (; iter != frames.end(); ++iter) {
+    const uint32_t values[] = {
+      iter->timing.response_time,
+      iter->timing.break_time,
+      iter->timing.mark_time,
+    };
+    for (unsigned int i = 0; i < MEASUREMENT_COUNT; i++) {
+      // 0 means the widget didn't measure it.
+      if (values[i]) {
+        Observe(m_port_histograms[i], port_id, values[i]);
+        Observe(m_uid_histograms[i], uid_str, values[i]);
+        m_ports.insert(port_id);
+        m_uids.insert(uid_str);
+      }
+    }
+  }
+}
+
+void RDMTimingStats::RemovePort(const string &port_id) {
+  if (!m_ports.erase(port_id)) {
+    return;
+  }
+  for (unsigned int i = 0; i < MEASUREMENT_COUNT; i++) {
+    m_port_histograms[i]->Remove(port_id);
+  }
+}
+
+void RDMTimingStats::RemoveUID(const UID &uid) {
+  RemoveUIDKey(uid.ToString());
+}
+
+void RDMTimingStats::RemoveUIDKey(const string &uid_str) {
+  if (!m_uids.erase(uid_str)) {
+    return;
+  }
+  for (unsigned int i = 0; i < MEASUREMENT_COUNT; i++) {
+    m_uid_histograms[i]->Remove(uid_str);
+  }
+  m_export_map->GetUIntMapVar(K_UID_TIMEOUTS_VAR, "uid")->Remove(uid_str);
+}
+
+void RDMTimingStats::Observe(HistogramMap *histograms, const string &key,
+                             uint32_t nanoseconds) {
+  histograms->Get(key)->Observe(nanoseconds / 1000);
+}
+}  // namespace ola
@@ -0,0 +1,114 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMTimingStats.h
+ * Collects the timing of the RDM responses a universe receives.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMTIMINGSTATS_H_
+#define OLAD_PLUGIN_API_RDMTIMINGSTATS_H_
+
+#include <stdint.h>
+#include <set>
+#include <string>
+
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+
+namespace ola {
+
+/**
+ * @brief Collects the timing of RDM responses, for each port and each UID.
+ *
+ * Widgets like Ja Rule measure the response time (turnaround), break and
+ * mark of each response frame. These are recorded in histograms in the
+ * ExportMap, in microseconds, so slow responders and timeouts that are
+ * longer than they need to be show up in /metrics. Timeouts are counted for
+ * each UID and each PID.
+ *
+ * Frames without timing information, which is most widgets, aren't
+ * recorded.
+ */
+class RDMTimingStats {
+ public:
+  /**
+   * @brief Create a new RDMTimingStats.
+   * @param export_map the ExportMap to update, may be NULL.
+   */
+  explicit RDMTimingStats(ExportMap *export_map);
+
+  /**
+   * @brief Destructor, this removes the variables for the ports and UIDs
+   * seen.
+   */
+  ~RDMTimingStats();
+
+  /**
+   * @brief Record the reply to a request.
+   * @param port_id the UniqueId() of the port the request was sent on.
+   * @param uid the UID the request was sent to.
+   * @param pid the PID of the request.
+   * @param reply the reply.
+   */
+  void RecordReply(const std::string &port_id,
+                   const ola::rdm::UID &uid,
+                   uint16_t pid,
+                   const ola::rdm::RDMReply &reply);
+
+  /**
+   * @brief Remove the histograms for a port.
+   */
+  void RemovePort(const std::string &port_id);
+
+  /**
+   * @brief Remove the histograms and timeout count for a UID.
+   */
+  void RemoveUID(const ola::rdm::UID &uid);
+
+  static const char K_PORT_TURNAROUND_VAR[];
+  static const char K_PORT_BREAK_VAR[];
+  static const char K_PORT_MARK_VAR[];
+  static const char K_UID_TURNAROUND_VAR[];
+  static const char K_UID_BREAK_VAR[];
+  static const char K_UID_MARK_VAR[];
+  static const char K_UID_TIMEOUTS_VAR[];
+  static const char K_PID_TIMEOUTS_VAR[];
+
+ private:
+  enum {
+    TURNAROUND,
+    BREAK,
+    MARK,
+    MEASUREMENT_COUNT
+  };
+
+  ExportMap *m_export_map;
+  HistogramMap *m_port_histograms[MEASUREMENT_COUNT];
+  HistogramMap *m_uid_histograms[MEASUREMENT_COUNT];
+  std::set<std::string> m_ports;
+  std::set<std::string> m_uids;
+
+  void RemoveUIDKey(const std::string &uid_str);
+
+  static void Observe(HistogramMap *histograms, const std::string &key,
+                      uint32_t nanoseconds);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMTimingStats);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMTIMINGSTATS_H_
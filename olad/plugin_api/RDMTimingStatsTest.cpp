@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMTimingStatsTest.cpp
+ * Test fixture for the RDMTimingStats class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMFrame.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/RDMResponseCodes.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/plugin_api/RDMTimingStats.h"
+
+using ola::ExportMap;
+using ola::HistogramMap;
+using ola::RDMTimingStats;
+using ola::rdm::RDMFrame;
+using ola::rdm::RDMFrames;
+using ola::rdm::RDMReply;
+using ola::rdm::UID;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+class RDMTimingStatsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMTimingStatsTest);
+  CPPUNIT_TEST(testRecordTiming);
+  CPPUNIT_TEST(testTimeouts);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMTimingStatsTest()
+      : m_uid(0x7a70, 1),
+        m_port_id("1-1-O-1") {
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testRecordTiming();
+  void testTimeouts();
+  void testRemove();
+
+ private:
+  const UID m_uid;
+  const string m_port_id;
+
+  RDMFrames TimedFrame(uint32_t response_time, uint32_t break_time,
+                       uint32_t mark_time) {
+    const uint8_t data[] = {0xcc, 1, 24};
+    RDMFrame frame(data, sizeof(data));
+    frame.timing.response_time = response_time;
+    frame.timing.break_time = break_time;
+    frame.timing.mark_time = mark_time;
+    return RDMFrames(1, frame);
+  }
+
+  uint64_t Count(ExportMap *export_map, const char *var,
+                 const string &key) {
+    const vector<uint64_t> bounds;
+    HistogramMap *histograms = export_map->GetHistogramMapVar(var, "", bounds);
+    return histograms->Get(key)->Count();
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMTimingStatsTest);
+
+/*
+ * Check the timing of each frame is recorded for the port and UID.
+ */
+void RDMTimingStatsTest::testRecordTiming() {
+  ExportMap export_map;
+  RDMTimingStats stats(&export_map);
+
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK, NULL,
+                 TimedFrame(500000, 176000, 12000));
+  stats.RecordReply(m_port_id, m_uid, ola::rdm::PID_DEVICE_INFO, reply);
+
+  HistogramMap *turnaround = export_map.GetHistogramMapVar(
+      RDMTimingStats::K_PORT_TURNAROUND_VAR, "", vector<uint64_t>());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), turnaround->Get(m_port_id)->Count());
+  // Recorded in microseconds.
+  OLA_ASSERT_EQ(static_cast<uint64_t>(500), turnaround->Get(m_port_id)->Sum());
+
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                Count(&export_map, RDMTimingStats::K_UID_TURNAROUND_VAR,
+                      m_uid.ToString()));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                Count(&export_map, RDMTimingStats::K_UID_BREAK_VAR,
+                      m_uid.ToString()));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                Count(&export_map, RDMTimingStats::K_PORT_MARK_VAR,
+                      m_port_id));
+
+  // DUB responses have no break or mark, those aren't recorded.
+  RDMReply dub_reply(ola::rdm::RDM_DUB_RESPONSE, NULL,
+                     TimedFrame(300000, 0, 0));
+  stats.RecordReply(m_port_id, m_uid, 0, dub_reply);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2),
+                Count(&export_map, RDMTimingStats::K_PORT_TURNAROUND_VAR,
+                      m_port_id));
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1),
+                Count(&export_map, RDMTimingStats::K_PORT_BREAK_VAR,
+                      m_port_id));
+
+  // Without timing, nothing is recorded.
+  RDMReply untimed_reply(ola::rdm::RDM_COMPLETED_OK);
+  stats.RecordReply(m_port_id, m_uid, ola::rdm::PID_DEVICE_INFO,
+                    untimed_reply);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2),
+                Count(&export_map, RDMTimingStats::K_PORT_TURNAROUND_VAR,
+                      m_port_id));
+}
+
+/*
+ * Check timeouts are counted for each UID and PID.
+ */
+void RDMTimingStatsTest::testTimeouts() {
+  ExportMap export_map;
+  RDMTimingStats stats(&export_map);
+
+  RDMReply reply(ola::rdm::RDM_TIMEOUT);
+  stats.RecordReply(m_port_id, m_uid, ola::rdm::PID_SENSOR_VALUE, reply);
+  stats.RecordReply(m_port_id, m_uid, ola::rdm::PID_SENSOR_VALUE, reply);
+  stats.RecordReply(m_port_id, UID(0x7a70, 2), ola::rdm::PID_DEVICE_INFO,
+                    reply);
+
+  OLA_ASSERT_EQ(2u, (*export_map.GetUIntMapVar(
+      RDMTimingStats::K_UID_TIMEOUTS_VAR))[m_uid.ToString()]);
+  OLA_ASSERT_EQ(2u, (*export_map.GetUIntMapVar(
+      RDMTimingStats::K_PID_TIMEOUTS_VAR))["0x0201"]);
+  OLA_ASSERT_EQ(1u, (*export_map.GetUIntMapVar(
+      RDMTimingStats::K_PID_TIMEOUTS_VAR))["0x0060"]);
+}
+
+/*
+ * Check the variables are removed with the port or UID, or when the stats
+ * are deleted.
+ */
+void RDMTimingStatsTest::testRemove() {
+  ExportMap export_map;
+  auto_ptr<RDMTimingStats> stats(new RDMTimingStats(&export_map));
+
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK, NULL,
+                 TimedFrame(500000, 176000, 12000));
+  stats->RecordReply(m_port_id, m_uid, ola::rdm::PID_DEVICE_INFO, reply);
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  stats->RecordReply(m_port_id, m_uid, ola::rdm::PID_DEVICE_INFO, timeout);
+
+  const string turnaround = RDMTimingStats::K_UID_TURNAROUND_VAR;
+  const string timeouts = RDMTimingStats::K_UID_TIMEOUTS_VAR;
+  OLA_ASSERT_NE(string::npos,
+                export_map.GetHistogramMapVar(
+                    turnaround, "", vector<uint64_t>())->Value().find(
+                        m_uid.ToString()));
+
+  stats->RemoveUID(m_uid);
+  OLA_ASSERT_EQ(string::npos,
+                export_map.GetHistogramMapVar(
+                    turnaround, "", vector<uint64_t>())->Value().find(
+                        m_uid.ToString()));
+  OLA_ASSERT_EQ(string("map:uid"),
+                export_map.GetUIntMapVar(timeouts)->Value());
+
+  stats->RecordReply(m_port_id, m_uid, ola::rdm::PID_DEVICE_INFO, reply);
+  stats.reset();
+  OLA_ASSERT_EQ(string("map:port"),
+                export_map.GetHistogramMapVar(
+                    RDMTimingStats::K_PORT_TURNAROUND_VAR, "",
+                    vector<uint64_t>())->Value());
+  OLA_ASSERT_EQ(string("map:uid"),
+                export_map.GetHistogramMapVar(
+                    turnaround, "", vector<uint64_t>())->Value());
+}
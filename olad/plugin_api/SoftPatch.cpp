@@ -0,0 +1,278 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SoftPatch.cpp
+ * Maps slots from source universes onto destination universes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/SoftPatch.h"
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
+
+// The AVX2 gather is checked for at runtime, like the HTP merge in DmxBuffer.
+#if defined(__x86_64__) && (defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define OLA_SOFT_PATCH_AVX2 1
+#endif  // defined(__x86_64__) && ...
+
+namespace ola {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+/*
+ * Set dst[i] to src[indices[i]].
+ */
+typedef void (*GatherFunction)(uint8_t *dst, const uint8_t *src,
+                               const uint32_t *indices, unsigned int length);
+
+void ScalarGather(uint8_t *dst, const uint8_t *src, const uint32_t *indices,
+                  unsigned int length) {
+  for (unsigned int i = 0; i < length; i++) {
+    dst[i] = src[indices[i]];
+  }
+}
+
+#ifdef OLA_SOFT_PATCH_AVX2
+/*
+ * This loads 4 bytes from each index, so src must have 3 bytes of padding
+ * after the highest index.
+ */
+__attribute__((target("avx2")))
+void AVX2Gather(uint8_t *dst, const uint8_t *src, const uint32_t *indices,
+                unsigned int length) {
+  // Take the low byte of each 32 bit word, then move the two 32 bit results
+  // in each lane to the bottom of the register.
+  const __m256i bytes = _mm256_setr_epi8(
+      0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i lanes = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+  const int *base = reinterpret_cast<const int*>(src);
+
+  unsigned int i = 0;
+  for (; i + 8 <= length; i += 8) {
+    __m256i offsets = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(indices + i));
+    __m256i words = _mm256_i32gather_epi32(base, offsets, 1);
+    __m256i packed = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(words, bytes), lanes);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i),
+                     _mm256_castsi256_si128(packed));
+  }
+  ScalarGather(dst + i, src, indices + i, length - i);
+}
+#endif  // OLA_SOFT_PATCH_AVX2
+
+GatherFunction ChooseGatherFunction() {
+#ifdef OLA_SOFT_PATCH_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return AVX2Gather;
+  }
+#endif  // OLA_SOFT_PATCH_AVX2
+  return ScalarGather;
+}
+
+void Gather(uint8_t *dst, const uint8_t *src, const uint32_t *indices,
+            unsigned int length) {
+  static const GatherFunction gather_function = ChooseGatherFunction();
+  gather_function(dst, src, indices, length);
+}
+
+bool ParseAddress(const string &input, unsigned int *universe,
+                  unsigned int *slot) {
+  vector<string> tokens;
+  StringSplit(input, &tokens, ":");
+  if (tokens.size() != 2 || !StringToInt(tokens[0], universe) ||
+      !StringToInt(tokens[1], slot) || *slot == 0) {
+    return false;
+  }
+  (*slot)--;
+  return true;
+}
+}  // namespace
+
+const unsigned int SoftPatch::BLOCK_SIZE = DMX_UNIVERSE_SIZE / 64;
+const unsigned int SoftPatch::GATHER_PADDING = 4;
+
+bool SoftPatch::AddRoute(const Route &route) {
+  if (route.length == 0 ||
+      route.source_slot + route.length > DMX_UNIVERSE_SIZE ||
+      route.destination_slot + route.length > DMX_UNIVERSE_SIZE) {
+    OLA_WARN << "Invalid soft patch route from universe "
+             << route.source_universe << " to " << route.destination_universe;
+    return false;
+  }
+
+  if (route.source_universe == route.destination_universe ||
+      STLContains(m_sources, route.destination_universe) ||
+      STLContains(m_destinations, route.source_universe)) {
+    OLA_WARN << "Universe " << route.source_universe << " or "
+             << route.destination_universe
+             << " would be both a soft patch source and destination";
+    return false;
+  }
+
+  m_routes.push_back(route);
+  Compile();
+  return true;
+}
+
+bool SoftPatch::ParseRoute(const string &input, Route *route) {
+  vector<string> tokens;
+  StringSplit(input, &tokens, " ");
+  tokens.erase(std::remove(tokens.begin(), tokens.end(), string()),
+               tokens.end());
+  if (tokens.size() < 2 || tokens.size() > 3) {
+    return false;
+  }
+
+  route->length = 1;
+  return ParseAddress(tokens[0], &route->source_universe,
+                      &route->source_slot) &&
+         ParseAddress(tokens[1], &route->destination_universe,
+                      &route->destination_slot) &&
+         (tokens.size() == 2 || StringToInt(tokens[2], &route->length));
+}
+
+bool SoftPatch::UpdateSource(unsigned int universe_id, const DmxBuffer &data,
+                             vector<unsigned int> *destinations) {
+  IndexMap::const_iterator source_iter = m_sources.find(universe_id);
+  if (source_iter == m_sources.end()) {
+    return false;
+  }
+  const unsigned int source = source_iter->second;
+
+  uint8_t frame[DMX_UNIVERSE_SIZE];
+  unsigned int size = DMX_UNIVERSE_SIZE;
+  data.Get(frame, &size);
+  memset(frame + size, 0, DMX_UNIVERSE_SIZE - size);
+
+  // Find the blocks of slots that changed.
+  uint8_t *slots = &m_source_data[source * DMX_UNIVERSE_SIZE];
+  uint64_t changed = 0;
+  for (unsigned int block = 0; block < DMX_UNIVERSE_SIZE / BLOCK_SIZE;
+       block++) {
+    if (memcmp(frame + block * BLOCK_SIZE, slots + block * BLOCK_SIZE,
+               BLOCK_SIZE)) {
+      changed |= static_cast<uint64_t>(1) << block;
+    }
+  }
+  if (!changed) {
+    return true;
+  }
+  memcpy(slots, frame, DMX_UNIVERSE_SIZE);
+
+  const vector<unsigned int> &dependants = m_dependants[source];
+  vector<unsigned int>::const_iterator iter = dependants.begin();
+  for (; iter != dependants.end(); ++iter) {
+    Destination *destination = &m_destination_tables[*iter];
+    if (!(destination->source_blocks[source] & changed)) {
+      continue;
+    }
+
+    unsigned int length = destination->gather.size();
+    Gather(frame, &m_source_data[0], &destination->gather[0], length);
+    if (destination->output.Size() == length &&
+        !memcmp(destination->output.GetRaw(), frame, length)) {
+      // A slot next to a patched one changed.
+      continue;
+    }
+    destination->output.Set(frame, length);
+    destinations->push_back(destination->universe);
+  }
+  return true;
+}
+
+const DmxBuffer *SoftPatch::Output(unsigned int universe_id) const {
+  IndexMap::const_iterator iter = m_destinations.find(universe_id);
+  if (iter == m_destinations.end()) {
+    return NULL;
+  }
+  return &m_destination_tables[iter->second].output;
+}
+
+/*
+ * Build the gather tables from the routes.
+ */
+void SoftPatch::Compile() {
+  m_sources.clear();
+  m_destinations.clear();
+  vector<Route>::const_iterator iter = m_routes.begin();
+  for (; iter != m_routes.end(); ++iter) {
+    STLInsertIfNotPresent(&m_sources, iter->source_universe,
+                          static_cast<unsigned int>(m_sources.size()));
+    STLInsertIfNotPresent(&m_destinations, iter->destination_universe,
+                          static_cast<unsigned int>(m_destinations.size()));
+  }
+
+  const unsigned int source_count = m_sources.size();
+  const uint32_t zero_slot = source_count * DMX_UNIVERSE_SIZE;
+  m_source_data.assign(zero_slot + GATHER_PADDING, 0);
+  m_dependants.assign(source_count, vector<unsigned int>());
+  m_destination_tables.assign(m_destinations.size(), Destination());
+  IndexMap::const_iterator index_iter = m_destinations.begin();
+  for (; index_iter != m_destinations.end(); ++index_iter) {
+    Destination *destination = &m_destination_tables[index_iter->second];
+    destination->universe = index_iter->first;
+    destination->source_blocks.assign(source_count, 0);
+  }
+
+  for (iter = m_routes.begin(); iter != m_routes.end(); ++iter) {
+    unsigned int source = m_sources[iter->source_universe];
+    unsigned int index = m_destinations[iter->destination_universe];
+    Destination *destination = &m_destination_tables[index];
+
+    unsigned int end = iter->destination_slot + iter->length;
+    if (destination->gather.size() < end) {
+      destination->gather.resize(end, zero_slot);
+    }
+
+    for (unsigned int i = 0; i < iter->length; i++) {
+      unsigned int slot = iter->source_slot + i;
+      destination->gather[iter->destination_slot + i] =
+          source * DMX_UNIVERSE_SIZE + slot;
+      destination->source_blocks[source] |=
+          static_cast<uint64_t>(1) << (slot / BLOCK_SIZE);
+    }
+
+    vector<unsigned int> &dependants = m_dependants[source];
+    if (std::find(dependants.begin(), dependants.end(), index) ==
+        dependants.end()) {
+      dependants.push_back(index);
+    }
+  }
+
+  uint8_t zeros[DMX_UNIVERSE_SIZE];
+  memset(zeros, 0, sizeof(zeros));
+  vector<Destination>::iterator dest_iter = m_destination_tables.begin();
+  for (; dest_iter != m_destination_tables.end(); ++dest_iter) {
+    dest_iter->output.Set(zeros, dest_iter->gather.size());
+  }
+}
+}  // namespace ola
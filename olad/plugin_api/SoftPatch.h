@@ -0,0 +1,136 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SoftPatch.h
+ * Maps slots from source universes onto destination universes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_SOFTPATCH_H_
+#define OLAD_PLUGIN_API_SOFTPATCH_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief Maps slots from source universes onto destination universes.
+ *
+ * Each route copies a range of slots from one universe to another. A source
+ * slot may be copied to several destinations, and a destination universe may
+ * be built from several sources. If routes overlap on a destination slot, the
+ * last one added wins. Destination slots without a route are 0.
+ *
+ * The routes are compiled into a gather table for each destination universe,
+ * which holds the offset of each slot in a flat array of the source frames.
+ * Each destination also records which blocks of source slots it reads, so
+ * only the destinations affected by a change are rebuilt.
+ *
+ * A universe can't be both a source and a destination, so updates can't
+ * loop.
+ */
+class SoftPatch {
+ public:
+  /**
+   * @brief A range of slots to copy. Slots are numbered from 0.
+   */
+  struct Route {
+    unsigned int source_universe;
+    unsigned int source_slot;
+    unsigned int destination_universe;
+    unsigned int destination_slot;
+    unsigned int length;
+  };
+
+  SoftPatch() {}
+
+  /**
+   * @brief Add a route.
+   * @param route the Route to add.
+   * @returns false if the route is invalid, or would make a universe both a
+   *   source and a destination.
+   *
+   * This rebuilds the tables and clears the source data, so it should only be
+   * used while configuring the patch.
+   */
+  bool AddRoute(const Route &route);
+
+  /**
+   * @brief Parse a route from a string.
+   * @param input the route, as "<universe>:<slot> <universe>:<slot> [count]".
+   *   The first pair is the source, the second the destination. Slots are
+   *   numbered from 1 and count defaults to 1.
+   * @param[out] route the parsed Route.
+   * @returns true if the string was valid, false otherwise.
+   */
+  static bool ParseRoute(const std::string &input, Route *route);
+
+  /**
+   * @brief Check if there are any routes.
+   */
+  bool Empty() const { return m_routes.empty(); }
+
+  /**
+   * @brief Update the data for a source universe.
+   * @param universe_id the universe whose data has changed.
+   * @param data the new data for the universe.
+   * @param[out] destinations the destination universes whose data changed.
+   * @returns false if the universe isn't a source, true otherwise.
+   */
+  bool UpdateSource(unsigned int universe_id, const DmxBuffer &data,
+                    std::vector<unsigned int> *destinations);
+
+  /**
+   * @brief Get the data for a destination universe.
+   * @param universe_id the destination universe.
+   * @returns the data, or NULL if the universe isn't a destination.
+   */
+  const DmxBuffer *Output(unsigned int universe_id) const;
+
+ private:
+  struct Destination {
+    unsigned int universe;
+    std::vector<uint32_t> gather;
+    // For each source, a bit for each block of source slots this reads.
+    std::vector<uint64_t> source_blocks;
+    DmxBuffer output;
+  };
+
+  typedef std::map<unsigned int, unsigned int> IndexMap;
+
+  std::vector<Route> m_routes;
+  IndexMap m_sources;
+  IndexMap m_destinations;
+  std::vector<Destination> m_destination_tables;
+  // The destinations that read from each source.
+  std::vector<std::vector<unsigned int> > m_dependants;
+  // The frame for each source, then a zero slot and gather padding.
+  std::vector<uint8_t> m_source_data;
+
+  void Compile();
+
+  static const unsigned int BLOCK_SIZE;
+  static const unsigned int GATHER_PADDING;
+
+  DISALLOW_COPY_AND_ASSIGN(SoftPatch);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_SOFTPATCH_H_
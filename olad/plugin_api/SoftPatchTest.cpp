@@ -0,0 +1,246 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SoftPatchTest.cpp
+ * Test fixture for the SoftPatch class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "olad/plugin_api/SoftPatch.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DMX_UNIVERSE_SIZE;
+using ola::DmxBuffer;
+using ola::SoftPatch;
+using std::vector;
+
+class SoftPatchTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SoftPatchTest);
+  CPPUNIT_TEST(testParseRoute);
+  CPPUNIT_TEST(testInvalidRoutes);
+  CPPUNIT_TEST(testSplitAndCombine);
+  CPPUNIT_TEST(testChangedSlots);
+  CPPUNIT_TEST(testLargeGather);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testParseRoute();
+  void testInvalidRoutes();
+  void testSplitAndCombine();
+  void testChangedSlots();
+  void testLargeGather();
+
+ private:
+  static SoftPatch::Route NewRoute(unsigned int source_universe,
+                                   unsigned int source_slot,
+                                   unsigned int destination_universe,
+                                   unsigned int destination_slot,
+                                   unsigned int length) {
+    SoftPatch::Route route;
+    route.source_universe = source_universe;
+    route.source_slot = source_slot;
+    route.destination_universe = destination_universe;
+    route.destination_slot = destination_slot;
+    route.length = length;
+    return route;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SoftPatchTest);
+
+/*
+ * Check routes are parsed correctly.
+ */
+void SoftPatchTest::testParseRoute() {
+  SoftPatch::Route route;
+  OLA_ASSERT_TRUE(SoftPatch::ParseRoute("1:1 2:101 16", &route));
+  OLA_ASSERT_EQ(1u, route.source_universe);
+  OLA_ASSERT_EQ(0u, route.source_slot);
+  OLA_ASSERT_EQ(2u, route.destination_universe);
+  OLA_ASSERT_EQ(100u, route.destination_slot);
+  OLA_ASSERT_EQ(16u, route.length);
+
+  OLA_ASSERT_TRUE(SoftPatch::ParseRoute("  3:512  4:1 ", &route));
+  OLA_ASSERT_EQ(3u, route.source_universe);
+  OLA_ASSERT_EQ(511u, route.source_slot);
+  OLA_ASSERT_EQ(4u, route.destination_universe);
+  OLA_ASSERT_EQ(0u, route.destination_slot);
+  OLA_ASSERT_EQ(1u, route.length);
+
+  OLA_ASSERT_FALSE(SoftPatch::ParseRoute("", &route));
+  OLA_ASSERT_FALSE(SoftPatch::ParseRoute("1:1", &route));
+  OLA_ASSERT_FALSE(SoftPatch::ParseRoute("1:0 2:1", &route));
+  OLA_ASSERT_FALSE(SoftPatch::ParseRoute("1 2:1", &route));
+  OLA_ASSERT_FALSE(SoftPatch::ParseRoute("1:1 2:1 foo", &route));
+  OLA_ASSERT_FALSE(SoftPatch::ParseRoute("1:1 2:1 3 4", &route));
+}
+
+/*
+ * Check invalid routes are rejected.
+ */
+void SoftPatchTest::testInvalidRoutes() {
+  SoftPatch patch;
+  OLA_ASSERT_TRUE(patch.Empty());
+  OLA_ASSERT_FALSE(patch.AddRoute(NewRoute(1, 0, 2, 0, 0)));
+  OLA_ASSERT_FALSE(patch.AddRoute(NewRoute(1, 500, 2, 0, 13)));
+  OLA_ASSERT_FALSE(patch.AddRoute(NewRoute(1, 0, 2, 500, 13)));
+  OLA_ASSERT_FALSE(patch.AddRoute(NewRoute(1, 0, 1, 10, 1)));
+  OLA_ASSERT_TRUE(patch.Empty());
+
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, 0, 2, 0, 512)));
+  // 2 is a destination, and 1 is a source.
+  OLA_ASSERT_FALSE(patch.AddRoute(NewRoute(2, 0, 3, 0, 1)));
+  OLA_ASSERT_FALSE(patch.AddRoute(NewRoute(3, 0, 1, 0, 1)));
+  OLA_ASSERT_FALSE(patch.Empty());
+
+  vector<unsigned int> destinations;
+  OLA_ASSERT_FALSE(patch.UpdateSource(2, DmxBuffer("foo"), &destinations));
+  OLA_ASSERT_TRUE(destinations.empty());
+  OLA_ASSERT_NULL(patch.Output(1));
+}
+
+/*
+ * Check a source can feed several destinations, and a destination can be
+ * built from several sources.
+ */
+void SoftPatchTest::testSplitAndCombine() {
+  SoftPatch patch;
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, 0, 10, 0, 2)));
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, 0, 11, 4, 2)));
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(2, 1, 10, 2, 2)));
+
+  // Unpatched slots are 0.
+  const uint8_t empty[] = {0, 0, 0, 0, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(empty, 4, patch.Output(10)->GetRaw(),
+                         patch.Output(10)->Size());
+  OLA_ASSERT_DATA_EQUALS(empty, 6, patch.Output(11)->GetRaw(),
+                         patch.Output(11)->Size());
+
+  const uint8_t data1[] = {1, 2, 3};
+  vector<unsigned int> destinations;
+  OLA_ASSERT_TRUE(patch.UpdateSource(1, DmxBuffer(data1, sizeof(data1)),
+                                     &destinations));
+  OLA_ASSERT_EQ(static_cast<size_t>(2), destinations.size());
+  OLA_ASSERT_EQ(10u, destinations[0]);
+  OLA_ASSERT_EQ(11u, destinations[1]);
+
+  const uint8_t data2[] = {4, 5, 6};
+  destinations.clear();
+  OLA_ASSERT_TRUE(patch.UpdateSource(2, DmxBuffer(data2, sizeof(data2)),
+                                     &destinations));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), destinations.size());
+  OLA_ASSERT_EQ(10u, destinations[0]);
+
+  const uint8_t expected10[] = {1, 2, 5, 6};
+  OLA_ASSERT_DATA_EQUALS(expected10, sizeof(expected10),
+                         patch.Output(10)->GetRaw(),
+                         patch.Output(10)->Size());
+  const uint8_t expected11[] = {0, 0, 0, 0, 1, 2};
+  OLA_ASSERT_DATA_EQUALS(expected11, sizeof(expected11),
+                         patch.Output(11)->GetRaw(),
+                         patch.Output(11)->Size());
+
+  // A shorter frame sets the missing slots to 0.
+  destinations.clear();
+  OLA_ASSERT_TRUE(patch.UpdateSource(1, DmxBuffer(data1, 1), &destinations));
+  const uint8_t short10[] = {1, 0, 5, 6};
+  OLA_ASSERT_DATA_EQUALS(short10, sizeof(short10),
+                         patch.Output(10)->GetRaw(),
+                         patch.Output(10)->Size());
+}
+
+/*
+ * Check that only the destinations that read the changed slots are updated.
+ */
+void SoftPatchTest::testChangedSlots() {
+  SoftPatch patch;
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, 0, 10, 0, 1)));
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, 1, 11, 0, 1)));
+  OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, 100, 12, 0, 1)));
+
+  uint8_t data[DMX_UNIVERSE_SIZE] = {0};
+  data[100] = 50;
+  vector<unsigned int> destinations;
+  patch.UpdateSource(1, DmxBuffer(data, sizeof(data)), &destinations);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), destinations.size());
+  OLA_ASSERT_EQ(12u, destinations[0]);
+
+  // Slots 0 & 1 are in the same block, only 11 reads slot 1.
+  data[1] = 10;
+  destinations.clear();
+  patch.UpdateSource(1, DmxBuffer(data, sizeof(data)), &destinations);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), destinations.size());
+  OLA_ASSERT_EQ(11u, destinations[0]);
+
+  // An unpatched slot.
+  data[300] = 10;
+  destinations.clear();
+  patch.UpdateSource(1, DmxBuffer(data, sizeof(data)), &destinations);
+  OLA_ASSERT_TRUE(destinations.empty());
+
+  // No change at all.
+  patch.UpdateSource(1, DmxBuffer(data, sizeof(data)), &destinations);
+  OLA_ASSERT_TRUE(destinations.empty());
+}
+
+/*
+ * Check full universe routes, which use the vector gather where available.
+ */
+void SoftPatchTest::testLargeGather() {
+  SoftPatch patch;
+  // Reverse universe 1 into universe 10, and interleave 1 & 2 in 11.
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+    OLA_ASSERT_TRUE(patch.AddRoute(
+        NewRoute(1, i, 10, DMX_UNIVERSE_SIZE - 1 - i, 1)));
+  }
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE / 2; i++) {
+    OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(1, i, 11, 2 * i, 1)));
+    OLA_ASSERT_TRUE(patch.AddRoute(NewRoute(2, i, 11, 2 * i + 1, 1)));
+  }
+
+  uint8_t data1[DMX_UNIVERSE_SIZE];
+  uint8_t data2[DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+    data1[i] = i;
+    data2[i] = 255 - i;
+  }
+
+  vector<unsigned int> destinations;
+  patch.UpdateSource(1, DmxBuffer(data1, sizeof(data1)), &destinations);
+  patch.UpdateSource(2, DmxBuffer(data2, sizeof(data2)), &destinations);
+
+  const DmxBuffer *reversed = patch.Output(10);
+  const DmxBuffer *interleaved = patch.Output(11);
+  const unsigned int size = DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_EQ(size, reversed->Size());
+  OLA_ASSERT_EQ(size, interleaved->Size());
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+    OLA_ASSERT_EQ(data1[DMX_UNIVERSE_SIZE - 1 - i], reversed->Get(i));
+    const uint8_t *source = (i % 2) ? data2 : data1;
+    OLA_ASSERT_EQ(source[i / 2], interleaved->Get(i));
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SpanFrame.cpp
+ * Assembles the universes of a port that spans several universes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/SpanFrame.h"
+
+#include <algorithm>
+
+namespace ola {
+
+SpanFrame::SpanFrame(unsigned int universe_count,
+                     FrameCallback *callback,
+                     unsigned int slots_per_universe)
+    : m_universe_count(universe_count),
+      m_slots_per_universe(
+          std::min(slots_per_universe,
+                   static_cast<unsigned int>(DMX_UNIVERSE_SIZE))),
+      m_callback(callback),
+      m_frame(universe_count * m_slots_per_universe, 0),
+      m_updated(universe_count, false),
+      m_updated_count(0) {
+}
+
+bool SpanFrame::Update(unsigned int index, const DmxBuffer &buffer) {
+  if (index >= m_universe_count) {
+    return false;
+  }
+
+  if (m_updated[index]) {
+    Sync();
+  }
+
+  unsigned int length = m_slots_per_universe;
+  buffer.GetRange(0, &m_frame[index * m_slots_per_universe], &length);
+  m_updated[index] = true;
+  if (++m_updated_count == m_universe_count) {
+    Sync();
+  }
+  return true;
+}
+
+void SpanFrame::Sync() {
+  if (!m_updated_count) {
+    return;
+  }
+  std::fill(m_updated.begin(), m_updated.end(), false);
+  m_updated_count = 0;
+  m_callback->Run(&m_frame[0], Size());
+}
+}  // namespace ola
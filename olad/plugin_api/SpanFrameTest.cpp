@@ -0,0 +1,133 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SpanFrameTest.cpp
+ * Test fixture for the SpanFrame class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "olad/SpanFrame.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::DmxBuffer;
+using ola::NewCallback;
+using ola::SpanFrame;
+using std::string;
+using std::vector;
+
+class SpanFrameTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SpanFrameTest);
+  CPPUNIT_TEST(testAssembly);
+  CPPUNIT_TEST(testRepeatedUniverse);
+  CPPUNIT_TEST(testSync);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testAssembly();
+    void testRepeatedUniverse();
+    void testSync();
+
+ private:
+    vector<string> m_frames;
+
+    void NewFrame(const uint8_t *data, unsigned int length) {
+      m_frames.push_back(string(reinterpret_cast<const char*>(data), length));
+    }
+
+    SpanFrame::FrameCallback *Callback() {
+      return NewCallback(this, &SpanFrameTest::NewFrame);
+    }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SpanFrameTest);
+
+
+/*
+ * Check the frame is sent once all the universes arrive.
+ */
+void SpanFrameTest::testAssembly() {
+  SpanFrame frame(3, Callback(), 4);
+  OLA_ASSERT_EQ(3u, frame.UniverseCount());
+  OLA_ASSERT_EQ(12u, frame.Size());
+
+  DmxBuffer first, second, third;
+  first.SetFromString("1,2,3,4,5");
+  second.SetFromString("6,7");
+  third.SetFromString("8,9,10,11");
+
+  OLA_ASSERT_FALSE(frame.Update(3, first));
+  OLA_ASSERT_TRUE(frame.Update(2, third));
+  OLA_ASSERT_TRUE(frame.Update(0, first));
+  OLA_ASSERT_TRUE(m_frames.empty());
+  OLA_ASSERT_TRUE(frame.Update(1, second));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_frames.size());
+
+  // The 5th slot of the first universe is past the end of its slice, and the
+  // end of the second universe's slice hasn't been set.
+  const uint8_t expected[] = {1, 2, 3, 4, 6, 7, 0, 0, 8, 9, 10, 11};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                         reinterpret_cast<const uint8_t*>(m_frames[0].data()),
+                         m_frames[0].size());
+}
+
+
+/*
+ * Check that a universe arriving twice sends the frame with the data so far.
+ */
+void SpanFrameTest::testRepeatedUniverse() {
+  SpanFrame frame(2, Callback(), 2);
+  DmxBuffer first, second;
+  first.SetFromString("1,2");
+  second.SetFromString("3,4");
+
+  frame.Update(0, first);
+  first.SetFromString("5,6");
+  frame.Update(0, first);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_frames.size());
+  OLA_ASSERT_EQ(string("\x01\x02\x00\x00", 4), m_frames[0]);
+
+  frame.Update(1, second);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_frames.size());
+  OLA_ASSERT_EQ(string("\x05\x06\x03\x04", 4), m_frames[1]);
+}
+
+
+/*
+ * Check Sync() sends partial frames.
+ */
+void SpanFrameTest::testSync() {
+  SpanFrame frame(2, Callback(), 2);
+  frame.Sync();
+  OLA_ASSERT_TRUE(m_frames.empty());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2");
+  frame.Update(1, buffer);
+  frame.Sync();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_frames.size());
+  OLA_ASSERT_EQ(string("\x00\x00\x01\x02", 4), m_frames[0]);
+
+  frame.Sync();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_frames.size());
+}
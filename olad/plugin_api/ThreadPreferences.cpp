@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ThreadPreferences.cpp
+ * The common preferences for plugins that run their own output threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <pthread.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/thread/Utils.h"
+#include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
+
+namespace ola {
+
+using ola::thread::SchedulingOptions;
+using std::string;
+using std::vector;
+
+const char ThreadPreferences::RT_PRIORITY_KEY[] = "rt-priority";
+const char ThreadPreferences::RT_POLICY_KEY[] = "rt-policy";
+const char ThreadPreferences::CPU_KEY[] = "cpu";
+const char ThreadPreferences::FIFO_POLICY[] = "fifo";
+const char ThreadPreferences::RR_POLICY[] = "rr";
+
+bool CPUListValidator::IsValid(const string &value) const {
+  vector<unsigned int> cpus;
+  return ola::thread::ParseCPUList(value, &cpus);
+}
+
+
+bool ThreadPreferences::SetDefaults(Preferences *preferences,
+                                    const string &prefix) {
+  std::set<string> policies;
+  policies.insert(FIFO_POLICY);
+  policies.insert(RR_POLICY);
+
+  bool save = false;
+  save |= preferences->SetDefaultValue(prefix + RT_PRIORITY_KEY,
+                                       UIntValidator(0, 99), 0);
+  save |= preferences->SetDefaultValue(prefix + RT_POLICY_KEY,
+                                       SetValidator<string>(policies),
+                                       FIFO_POLICY);
+  save |= preferences->SetDefaultValue(prefix + CPU_KEY, CPUListValidator(),
+                                       -1);
+  return save;
+}
+
+
+SchedulingOptions ThreadPreferences::Load(const Preferences *preferences,
+                                          const string &prefix) {
+  SchedulingOptions options;
+
+  const string priority = preferences->GetValue(prefix + RT_PRIORITY_KEY);
+  unsigned int rt_priority = 0;
+  if (!priority.empty() &&
+      (!StringToInt(priority, &rt_priority) || rt_priority > 99)) {
+    OLA_WARN << "Invalid " << prefix << RT_PRIORITY_KEY << ": " << priority;
+    rt_priority = 0;
+  }
+  options.priority = rt_priority;
+
+  const string policy = preferences->GetValue(prefix + RT_POLICY_KEY);
+  if (policy == RR_POLICY) {
+    options.policy = SCHED_RR;
+  } else if (!policy.empty() && policy != FIFO_POLICY) {
+    OLA_WARN << "Invalid " << prefix << RT_POLICY_KEY << ": " << policy;
+  }
+
+  const string cpus = preferences->GetValue(prefix + CPU_KEY);
+  if (!ola::thread::ParseCPUList(cpus, &options.cpus)) {
+    OLA_WARN << "Invalid " << prefix << CPU_KEY << ": " << cpus;
+  }
+  return options;
+}
+}  // namespace ola
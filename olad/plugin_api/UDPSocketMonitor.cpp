@@ -0,0 +1,216 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UDPSocketMonitor.cpp
+ * Configures the UDP sockets of a network plugin and exports their stats.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/UDPSocketMonitor.h"
+
+#include <limits>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+
+namespace ola {
+
+using ola::network::UDPSocketInterface;
+using ola::network::UDPSocketStats;
+using std::string;
+
+const char UDPSocketMonitor::RECEIVE_BUFFER_SIZE_KEY[] = "receive_buffer_size";
+const char UDPSocketMonitor::SEND_BUFFER_SIZE_KEY[] = "send_buffer_size";
+
+const char UDPSocketMonitor::K_PACKETS_RECEIVED_VAR[] =
+    "udp-packets-received-per-second";
+const char UDPSocketMonitor::K_BYTES_RECEIVED_VAR[] =
+    "udp-bytes-received-per-second";
+const char UDPSocketMonitor::K_PACKETS_SENT_VAR[] =
+    "udp-packets-sent-per-second";
+const char UDPSocketMonitor::K_BYTES_SENT_VAR[] = "udp-bytes-sent-per-second";
+const char UDPSocketMonitor::K_KERNEL_DROPS_VAR[] = "udp-kernel-drops";
+
+namespace {
+const char PLUGIN_LABEL[] = "plugin";
+// Allow up to 64MB, Linux caps this at net.core.rmem_max / wmem_max anyway.
+const unsigned int MAX_BUFFER_SIZE = 64 * 1024 * 1024;
+}  // namespace
+
+UDPSocketMonitor::UDPSocketMonitor(
+    ola::io::SelectServerInterface *socket_loop,
+    ExportMap *export_map,
+    const string &plugin_name,
+    const Options &options,
+    ola::thread::ExecutorInterface *export_executor)
+    : m_socket_loop(socket_loop),
+      m_export_map(export_map),
+      m_plugin_name(plugin_name),
+      m_options(options),
+      m_export_executor(export_executor),
+      m_last_update(*socket_loop->WakeUpTime()) {
+  m_timeout_id = m_socket_loop->RegisterRepeatingTimeout(
+      UPDATE_INTERVAL_MS, NewCallback(this, &UDPSocketMonitor::Update));
+}
+
+UDPSocketMonitor::~UDPSocketMonitor() {
+  m_socket_loop->RemoveTimeout(m_timeout_id);
+  if (!m_export_map) {
+    return;
+  }
+
+  if (m_export_executor) {
+    m_export_executor->Execute(NewSingleCallback(
+        &UDPSocketMonitor::RemoveStats, m_export_map, m_plugin_name));
+  } else {
+    RemoveStats(m_export_map, m_plugin_name);
+  }
+}
+
+void UDPSocketMonitor::AddSocket(UDPSocketInterface *socket) {
+  if (m_options.receive_buffer_size) {
+    socket->SetReceiveBufferSize(m_options.receive_buffer_size);
+  }
+  if (m_options.send_buffer_size) {
+    socket->SetSendBufferSize(m_options.send_buffer_size);
+  }
+  if (!socket->EnableDropCounting()) {
+    OLA_DEBUG << "Kernel drops won't be counted for " << m_plugin_name;
+  }
+  m_sockets.insert(socket);
+}
+
+void UDPSocketMonitor::RemoveSocket(UDPSocketInterface *socket) {
+  if (m_sockets.erase(socket)) {
+    AddStats(socket->Stats(), &m_removed);
+  }
+}
+
+bool UDPSocketMonitor::SetDefaultPreferences(Preferences *preferences) {
+  bool save = preferences->SetDefaultValue(
+      RECEIVE_BUFFER_SIZE_KEY,
+      UIntValidator(0, MAX_BUFFER_SIZE),
+      0u);
+  save |= preferences->SetDefaultValue(
+      SEND_BUFFER_SIZE_KEY,
+      UIntValidator(0, MAX_BUFFER_SIZE),
+      0u);
+  return save;
+}
+
+UDPSocketMonitor::Options UDPSocketMonitor::OptionsFromPreferences(
+    const Preferences *preferences) {
+  Options options;
+  if (!preferences->GetValueAsUInt(RECEIVE_BUFFER_SIZE_KEY,
+                                   &options.receive_buffer_size)) {
+    options.receive_buffer_size = 0;
+  }
+  if (!preferences->GetValueAsUInt(SEND_BUFFER_SIZE_KEY,
+                                   &options.send_buffer_size)) {
+    options.send_buffer_size = 0;
+  }
+  return options;
+}
+
+bool UDPSocketMonitor::Update() {
+  const TimeStamp now = *m_socket_loop->WakeUpTime();
+  // If the loop hadn't run when this was created, assume a full interval.
+  const int64_t elapsed_ms = m_last_update.IsSet() ?
+      (now - m_last_update).InMilliSeconds() : UPDATE_INTERVAL_MS;
+  const UDPSocketStats totals = Totals();
+
+  ExportedStats stats;
+  stats.packets_received = PerSecond(
+      totals.packets_received - m_last.packets_received, elapsed_ms);
+  stats.bytes_received = PerSecond(
+      totals.bytes_received - m_last.bytes_received, elapsed_ms);
+  stats.packets_sent = PerSecond(
+      totals.packets_sent - m_last.packets_sent, elapsed_ms);
+  stats.bytes_sent = PerSecond(
+      totals.bytes_sent - m_last.bytes_sent, elapsed_ms);
+  stats.kernel_drops = totals.kernel_drops;
+
+  m_last = totals;
+  m_last_update = now;
+
+  if (m_export_map) {
+    if (m_export_executor) {
+      m_export_executor->Execute(NewSingleCallback(
+          &UDPSocketMonitor::Publish, m_export_map, m_plugin_name, stats));
+    } else {
+      Publish(m_export_map, m_plugin_name, stats);
+    }
+  }
+  return true;
+}
+
+UDPSocketStats UDPSocketMonitor::Totals() const {
+  UDPSocketStats totals = m_removed;
+  SocketSet::const_iterator iter = m_sockets.begin();
+  for (; iter != m_sockets.end(); ++iter) {
+    AddStats((*iter)->Stats(), &totals);
+  }
+  return totals;
+}
+
+void UDPSocketMonitor::AddStats(const UDPSocketStats &stats,
+                                UDPSocketStats *total) {
+  total->packets_received += stats.packets_received;
+  total->bytes_received += stats.bytes_received;
+  total->packets_sent += stats.packets_sent;
+  total->bytes_sent += stats.bytes_sent;
+  total->kernel_drops += stats.kernel_drops;
+}
+
+unsigned int UDPSocketMonitor::PerSecond(uint64_t delta, int64_t elapsed_ms) {
+  if (elapsed_ms <= 0) {
+    return 0;
+  }
+  const uint64_t rate = delta * 1000 / elapsed_ms;
+  return rate > std::numeric_limits<unsigned int>::max() ?
+      std::numeric_limits<unsigned int>::max() :
+      static_cast<unsigned int>(rate);
+}
+
+void UDPSocketMonitor::Publish(ExportMap *export_map, string plugin_name,
+                               ExportedStats stats) {
+  export_map->GetUIntMapVar(K_PACKETS_RECEIVED_VAR, PLUGIN_LABEL)->Set(
+      plugin_name, stats.packets_received);
+  export_map->GetUIntMapVar(K_BYTES_RECEIVED_VAR, PLUGIN_LABEL)->Set(
+      plugin_name, stats.bytes_received);
+  export_map->GetUIntMapVar(K_PACKETS_SENT_VAR, PLUGIN_LABEL)->Set(
+      plugin_name, stats.packets_sent);
+  export_map->GetUIntMapVar(K_BYTES_SENT_VAR, PLUGIN_LABEL)->Set(
+      plugin_name, stats.bytes_sent);
+  export_map->GetUIntMapVar(K_KERNEL_DROPS_VAR, PLUGIN_LABEL)->Set(
+      plugin_name, stats.kernel_drops);
+}
+
+void UDPSocketMonitor::RemoveStats(ExportMap *export_map,
+                                   string plugin_name) {
+  const char *vars[] = {
+    K_PACKETS_RECEIVED_VAR,
+    K_BYTES_RECEIVED_VAR,
+    K_PACKETS_SENT_VAR,
+    K_BYTES_SENT_VAR,
+    K_KERNEL_DROPS_VAR,
+  };
+  for (unsigned int i = 0; i < arraysize(vars); i++) {
+    export_map->GetUIntMapVar(vars[i], PLUGIN_LABEL)->Remove(plugin_name);
+  }
+}
+}  // namespace ola
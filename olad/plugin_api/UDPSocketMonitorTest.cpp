@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UDPSocketMonitorTest.cpp
+ * Test fixture for the UDPSocketMonitor class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/Socket.h"
+#include "ola/testing/MockUDPSocket.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
+
+using ola::ExportMap;
+using ola::MemoryPreferences;
+using ola::MockClock;
+using ola::TimeInterval;
+using ola::UDPSocketMonitor;
+using ola::UIntMap;
+using ola::io::SelectServer;
+using ola::network::UDPSocketStats;
+using ola::testing::MockUDPSocket;
+using std::auto_ptr;
+using std::string;
+
+namespace {
+
+class FakeSocket: public MockUDPSocket {
+ public:
+  FakeSocket()
+      : receive_buffer_size(0),
+        send_buffer_size(0),
+        count_drops(false) {
+  }
+
+  bool SetReceiveBufferSize(unsigned int size) {
+    receive_buffer_size = size;
+    return true;
+  }
+
+  bool SetSendBufferSize(unsigned int size) {
+    send_buffer_size = size;
+    return true;
+  }
+
+  bool EnableDropCounting() {
+    count_drops = true;
+    return true;
+  }
+
+  UDPSocketStats Stats() const { return stats; }
+
+  unsigned int receive_buffer_size;
+  unsigned int send_buffer_size;
+  bool count_drops;
+  UDPSocketStats stats;
+};
+}  // namespace
+
+class UDPSocketMonitorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UDPSocketMonitorTest);
+  CPPUNIT_TEST(testConfigureSockets);
+  CPPUNIT_TEST(testRates);
+  CPPUNIT_TEST(testPreferences);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  UDPSocketMonitorTest()
+      : m_ss(NULL, &m_clock) {
+  }
+
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testConfigureSockets();
+  void testRates();
+  void testPreferences();
+
+ private:
+  MockClock m_clock;
+  SelectServer m_ss;
+  ExportMap m_export_map;
+
+  unsigned int Value(const char *var) {
+    return (*m_export_map.GetUIntMapVar(var))["ArtNet"];
+  }
+
+  void RunForOneSecond() {
+    m_clock.AdvanceTime(1, 0);
+    m_ss.RunOnce(TimeInterval(0, 0));
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UDPSocketMonitorTest);
+
+/*
+ * Check the buffer sizes are applied, and drop counting is enabled.
+ */
+void UDPSocketMonitorTest::testConfigureSockets() {
+  UDPSocketMonitor::Options options;
+  options.receive_buffer_size = 1 << 20;
+  UDPSocketMonitor monitor(&m_ss, &m_export_map, "ArtNet", options);
+
+  FakeSocket socket;
+  monitor.AddSocket(&socket);
+  OLA_ASSERT_EQ(1u << 20, socket.receive_buffer_size);
+  // 0 leaves the system default.
+  OLA_ASSERT_EQ(0u, socket.send_buffer_size);
+  OLA_ASSERT_TRUE(socket.count_drops);
+  monitor.RemoveSocket(&socket);
+}
+
+/*
+ * Check the per second rates and the drops are exported.
+ */
+void UDPSocketMonitorTest::testRates() {
+  auto_ptr<UDPSocketMonitor> monitor(new UDPSocketMonitor(
+      &m_ss, &m_export_map, "ArtNet", UDPSocketMonitor::Options()));
+
+  FakeSocket socket1, socket2;
+  monitor->AddSocket(&socket1);
+  monitor->AddSocket(&socket2);
+
+  socket1.stats.packets_received = 10;
+  socket1.stats.bytes_received = 5300;
+  socket2.stats.packets_sent = 40;
+  socket2.stats.bytes_sent = 21200;
+  socket2.stats.kernel_drops = 3;
+  RunForOneSecond();
+
+  OLA_ASSERT_EQ(10u, Value(UDPSocketMonitor::K_PACKETS_RECEIVED_VAR));
+  OLA_ASSERT_EQ(5300u, Value(UDPSocketMonitor::K_BYTES_RECEIVED_VAR));
+  OLA_ASSERT_EQ(40u, Value(UDPSocketMonitor::K_PACKETS_SENT_VAR));
+  OLA_ASSERT_EQ(21200u, Value(UDPSocketMonitor::K_BYTES_SENT_VAR));
+  OLA_ASSERT_EQ(3u, Value(UDPSocketMonitor::K_KERNEL_DROPS_VAR));
+
+  // The traffic of a removed socket still counts towards the totals, so the
+  // rate doesn't go negative.
+  socket1.stats.packets_received = 15;
+  monitor->RemoveSocket(&socket1);
+  socket2.stats.packets_sent = 60;
+  RunForOneSecond();
+  OLA_ASSERT_EQ(5u, Value(UDPSocketMonitor::K_PACKETS_RECEIVED_VAR));
+  OLA_ASSERT_EQ(20u, Value(UDPSocketMonitor::K_PACKETS_SENT_VAR));
+  OLA_ASSERT_EQ(3u, Value(UDPSocketMonitor::K_KERNEL_DROPS_VAR));
+
+  RunForOneSecond();
+  OLA_ASSERT_EQ(0u, Value(UDPSocketMonitor::K_PACKETS_RECEIVED_VAR));
+  OLA_ASSERT_EQ(0u, Value(UDPSocketMonitor::K_PACKETS_SENT_VAR));
+
+  monitor->RemoveSocket(&socket2);
+  monitor.reset();
+  OLA_ASSERT_EQ(
+      string("map:plugin"),
+      m_export_map.GetUIntMapVar(UDPSocketMonitor::K_KERNEL_DROPS_VAR)
+          ->Value());
+}
+
+/*
+ * Check the options are read from the preferences.
+ */
+void UDPSocketMonitorTest::testPreferences() {
+  MemoryPreferences preferences("test");
+  OLA_ASSERT_TRUE(UDPSocketMonitor::SetDefaultPreferences(&preferences));
+  OLA_ASSERT_FALSE(UDPSocketMonitor::SetDefaultPreferences(&preferences));
+
+  UDPSocketMonitor::Options options =
+      UDPSocketMonitor::OptionsFromPreferences(&preferences);
+  OLA_ASSERT_EQ(0u, options.receive_buffer_size);
+  OLA_ASSERT_EQ(0u, options.send_buffer_size);
+
+  preferences.SetValue(UDPSocketMonitor::SEND_BUFFER_SIZE_KEY, 262144u);
+  options = UDPSocketMonitor::OptionsFromPreferences(&preferences);
+  OLA_ASSERT_EQ(262144u, options.send_buffer_size);
+}
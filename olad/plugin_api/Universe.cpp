@@ -28,6 +28,9 @@
  *   A list of source clients. which provide us with data for updating the
  *     DmxBuffer per the merge mode.
  *   A list of sink clients, which we update whenever the DmxBuffer changes.
+ *   An optional maximum frame rate. If set, updates to the ports and sink
+ *     clients are limited to one per frame interval, with any data that
+ *     arrives in between being merged and sent as a single frame.
  */
 
 #include <algorithm>
@@ -40,15 +43,23 @@
 #include <vector>
 
 #include "ola/base/Array.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/MultiCallback.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/stl/STLUtils.h"
 #include "ola/strings/Format.h"
+#include "olad/Device.h"
+#include "olad/Plugin.h"
 #include "olad/Port.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+#include "olad/plugin_api/OutputCurve.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+#include "olad/plugin_api/RDMScheduler.h"
+#include "olad/plugin_api/RDMTimingStats.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 namespace ola {
@@ -66,6 +77,23 @@ using std::set;
 using std::string;
 using std::vector;
 
+namespace {
+
+/*
+ * Log scale buckets for the latency histograms, from 10us to 1s.
+ */
+vector<uint64_t> LatencyBounds() {
+  vector<uint64_t> bounds;
+  for (uint64_t decade = 10; decade <= 100000; decade *= 10) {
+    bounds.push_back(decade);
+    bounds.push_back(2 * decade);
+    bounds.push_back(5 * decade);
+  }
+  bounds.push_back(1000000);
+  return bounds;
+}
+}  // namespace
+
 const char Universe::K_UNIVERSE_UID_COUNT_VAR[] = "universe-uids";
 const char Universe::K_FPS_VAR[] = "universe-dmx-frames";
 const char Universe::K_MERGE_HTP_STR[] = "htp";
@@ -75,9 +103,40 @@ const char Universe::K_UNIVERSE_MODE_VAR[] = "universe-mode";
 const char Universe::K_UNIVERSE_NAME_VAR[] = "universe-name";
 const char Universe::K_UNIVERSE_OUTPUT_PORT_VAR[] = "universe-output-ports";
 const char Universe::K_UNIVERSE_RDM_REQUESTS[] = "universe-rdm-requests";
+const char Universe::K_UNIVERSE_OUTPUT_LATENCY_VAR[] =
+    "universe-output-latency-usecs";
+const char Universe::K_PLUGIN_OUTPUT_LATENCY_VAR[] =
+    "plugin-output-latency-usecs";
+const char Universe::K_PORT_SUPPRESSED_FRAMES_VAR[] =
+    "port-suppressed-frames";
+
+const char *const Universe::K_STAT_VARS[] = {
+  K_FPS_VAR,
+  K_UNIVERSE_INPUT_PORT_VAR,
+  K_UNIVERSE_OUTPUT_PORT_VAR,
+  K_UNIVERSE_RDM_REQUESTS,
+  K_UNIVERSE_SINK_CLIENTS_VAR,
+  K_UNIVERSE_SOURCE_CLIENTS_VAR,
+  K_UNIVERSE_UID_COUNT_VAR,
+};
 const char Universe::K_UNIVERSE_SINK_CLIENTS_VAR[] = "universe-sink-clients";
 const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
     "universe-source-clients";
+const int64_t Universe::MAX_FRAME_INTERVAL_US;
+
+struct Universe::RDMState {
+  RDMState(Clock *clock, ExportMap *export_map)
+      : cache(clock),
+        timing(export_map) {
+  }
+
+  map<UID, OutputPort*> output_uids;
+  // Queues the requests for output_uids, so each port has its own queue.
+  RDMScheduler scheduler;
+  RDMResponseCache cache;
+  RDMTimingStats timing;
+};
+
 
 /*
  * Create a new universe
@@ -94,9 +153,17 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
       m_merge_mode(Universe::MERGE_LTP),
       m_universe_store(store),
       m_export_map(export_map),
+      m_output_latency(NULL),
+      m_rdm(NULL),
       m_clock(clock),
       m_rdm_discovery_interval(),
-      m_last_discovery_time() {
+      m_last_discovery_time(),
+      m_max_frame_rate(0),
+      m_update_pending(false),
+      m_restored(false),
+      m_sent_priority(ola::dmx::SOURCE_PRIORITY_MIN),
+      m_generation(0),
+      m_info_generation(0) {
   ostringstream universe_id_str, universe_name_str;
   universe_id_str << universe_id;
   m_universe_id_str = universe_id_str.str();
@@ -106,19 +173,15 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
   UpdateName();
   UpdateMode();
 
-  const char *vars[] = {
-    K_FPS_VAR,
-    K_UNIVERSE_INPUT_PORT_VAR,
-    K_UNIVERSE_OUTPUT_PORT_VAR,
-    K_UNIVERSE_RDM_REQUESTS,
-    K_UNIVERSE_SINK_CLIENTS_VAR,
-    K_UNIVERSE_SOURCE_CLIENTS_VAR,
-    K_UNIVERSE_UID_COUNT_VAR,
-  };
-
-  if (m_export_map) {
-    for (unsigned int i = 0; i < arraysize(vars); ++i) {
-      (*m_export_map->GetUIntMapVar(vars[i]))[m_universe_id_str] = 0;
+  for (unsigned int i = 0; i < STAT_COUNT; ++i) {
+    m_stats[i] = NULL;
+    if (m_export_map) {
+      // Entries in a std::map stay put until they're erased, which only
+      // happens in our destructor.
+      unsigned int &value =
+          (*m_export_map->GetUIntMapVar(K_STAT_VARS[i]))[m_universe_id_str];
+      value = 0;
+      m_stats[i] = &value;
     }
   }
 
@@ -132,27 +195,24 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
  * Delete this universe
  */
 Universe::~Universe() {
+  delete m_rdm;
+
   const char *string_vars[] = {
     K_UNIVERSE_NAME_VAR,
     K_UNIVERSE_MODE_VAR,
   };
 
-  const char *uint_vars[] = {
-    K_FPS_VAR,
-    K_UNIVERSE_INPUT_PORT_VAR,
-    K_UNIVERSE_OUTPUT_PORT_VAR,
-    K_UNIVERSE_RDM_REQUESTS,
-    K_UNIVERSE_SINK_CLIENTS_VAR,
-    K_UNIVERSE_SOURCE_CLIENTS_VAR,
-    K_UNIVERSE_UID_COUNT_VAR,
-  };
-
   if (m_export_map) {
     for (unsigned int i = 0; i < arraysize(string_vars); ++i) {
       m_export_map->GetStringMapVar(string_vars[i])->Remove(m_universe_id_str);
     }
-    for (unsigned int i = 0; i < arraysize(uint_vars); ++i) {
-      m_export_map->GetUIntMapVar(uint_vars[i])->Remove(m_universe_id_str);
+    for (unsigned int i = 0; i < STAT_COUNT; ++i) {
+      m_export_map->GetUIntMapVar(K_STAT_VARS[i])->Remove(m_universe_id_str);
+    }
+    if (m_output_latency) {
+      m_export_map->GetHistogramMapVar(
+          K_UNIVERSE_OUTPUT_LATENCY_VAR, "universe",
+          LatencyBounds())->Remove(m_universe_id_str);
     }
   }
 }
@@ -165,6 +225,7 @@ Universe::~Universe() {
 void Universe::SetName(const string &name) {
   m_universe_name = name;
   UpdateName();
+  InfoChanged();
 
   // notify ports
   vector<OutputPort*>::const_iterator iter;
@@ -181,6 +242,31 @@ void Universe::SetName(const string &name) {
 void Universe::SetMergeMode(enum merge_mode merge_mode) {
   m_merge_mode = merge_mode;
   UpdateMode();
+  InfoChanged();
+}
+
+
+/*
+ * Set the maximum frame rate for this universe.
+ * @param frame_rate the max frames per second, 0 means no limit.
+ */
+void Universe::SetMaxFrameRate(unsigned int frame_rate) {
+  m_max_frame_rate = frame_rate;
+  if (frame_rate) {
+    m_frame_interval = TimeInterval(
+        static_cast<int64_t>(USEC_IN_SECONDS / frame_rate));
+    if (m_update_pending && m_universe_store) {
+      // The pending update may now be due sooner.
+      m_universe_store->AddPendingUpdate(this);
+    }
+  } else {
+    m_frame_interval = TimeInterval();
+    if (m_update_pending) {
+      TimeStamp now;
+      m_clock->CurrentTime(&now);
+      SendUpdate(now);
+    }
+  }
 }
 
 
@@ -198,7 +284,36 @@ bool Universe::AddPort(InputPort *port) {
  * @param port the port to add
  */
 bool Universe::AddPort(OutputPort *port) {
-  return GenericAddPort(port, &m_output_ports);
+  if (m_export_map && port->GetDevice() && port->GetDevice()->Owner()) {
+    // The plugin histograms are shared between universes, and are never
+    // removed.
+    m_port_latency[port] = m_export_map->GetHistogramMapVar(
+        K_PLUGIN_OUTPUT_LATENCY_VAR, "plugin",
+        LatencyBounds())->Get(port->GetDevice()->Owner()->Name());
+  }
+  if (!GenericAddPort(port, &m_output_ports)) {
+    return false;
+  }
+  if (port->UniverseCount() > 1 && m_universe_store) {
+    m_universe_store->AddSpanPort(port, m_universe_id);
+  }
+  DuplicateFrameFilter *filter = port->GetDuplicateFrameFilter();
+  if (filter) {
+    // The first frame after patching is always written.
+    filter->Reset();
+    if (m_export_map) {
+      unsigned int &suppressed = (*m_export_map->GetUIntMapVar(
+          K_PORT_SUPPRESSED_FRAMES_VAR, "port"))[port->UniqueId()];
+      suppressed = 0;
+      m_port_suppressed[port] = &suppressed;
+    }
+  }
+  if (m_restored) {
+    TimeStamp now;
+    m_clock->CurrentTime(&now);
+    WriteToPort(port, now);
+  }
+  return true;
 }
 
 
@@ -208,6 +323,7 @@ bool Universe::AddPort(OutputPort *port) {
  * @return true if the port was removed, false if it didn't exist
  */
 bool Universe::RemovePort(InputPort *port) {
+  UntrackSource(SourceKey(port, NULL));
   return GenericRemovePort(port, &m_input_ports);
 }
 
@@ -218,16 +334,43 @@ bool Universe::RemovePort(InputPort *port) {
  * @return true if the port was removed, false if it didn't exist
  */
 bool Universe::RemovePort(OutputPort *port) {
-  bool ret = GenericRemovePort(port, &m_output_ports, &m_output_uids);
-
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
-        = m_output_uids.size();
+  m_port_latency.erase(port);
+  if (STLRemove(&m_port_suppressed, port)) {
+    m_export_map->GetUIntMapVar(K_PORT_SUPPRESSED_FRAMES_VAR, "port")->Remove(
+        port->UniqueId());
+  }
+  if (m_rdm) {
+    m_rdm->scheduler.RemovePort(port);
+    m_rdm->timing.RemovePort(port->UniqueId());
+    map<UID, OutputPort*>::const_iterator uid_iter =
+        m_rdm->output_uids.begin();
+    for (; uid_iter != m_rdm->output_uids.end(); ++uid_iter) {
+      if (uid_iter->second == port) {
+        m_rdm->timing.RemoveUID(uid_iter->first);
+      }
+    }
   }
+  bool ret = GenericRemovePort(port, &m_output_ports,
+                               m_rdm ? &m_rdm->output_uids : NULL);
+  if (ret && port->UniverseCount() > 1 && m_universe_store) {
+    m_universe_store->RemoveSpanPort(port, m_universe_id);
+  }
+
+  SafeSet(UID_COUNT_STAT, UIDCount());
   return ret;
 }
 
 
+void Universe::AddSpanPort(OutputPort *port, unsigned int index) {
+  m_span_ports[port] = index;
+}
+
+
+void Universe::RemoveSpanPort(OutputPort *port) {
+  m_span_ports.erase(port);
+}
+
+
 /*
  * Check if this port is bound to this universe
  * @param port the port to check for
@@ -278,14 +421,14 @@ void Universe::OutputPorts(vector<OutputPort*> *ports) const {
 bool Universe::AddSourceClient(Client *client) {
   // Check to see if it exists already. It doesn't make sense to have multiple
   //  clients
-  if (STLReplace(&m_source_clients, client, false)) {
+  if (!m_source_clients.insert(client).second) {
     return true;
   }
 
   OLA_INFO << "Added source client, " << client << " to universe "
            << m_universe_id;
 
-  SafeIncrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
+  SafeIncrement(SOURCE_CLIENTS_STAT);
   return true;
 }
 
@@ -301,8 +444,9 @@ bool Universe::RemoveSourceClient(Client *client) {
   if (!STLRemove(&m_source_clients, client)) {
     return false;
   }
+  UntrackSource(SourceKey(NULL, client));
 
-  SafeDecrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
+  SafeDecrement(SOURCE_CLIENTS_STAT);
 
   OLA_INFO << "Source client " << client << " has been removed from uni "
            << m_universe_id;
@@ -337,7 +481,7 @@ bool Universe::AddSinkClient(Client *client) {
   OLA_INFO << "Added sink client, " << client << " to universe "
            << m_universe_id;
 
-  SafeIncrement(K_UNIVERSE_SINK_CLIENTS_VAR);
+  SafeIncrement(SINK_CLIENTS_STAT);
   return true;
 }
 
@@ -354,7 +498,7 @@ bool Universe::RemoveSinkClient(Client *client) {
     return false;
   }
 
-  SafeDecrement(K_UNIVERSE_SINK_CLIENTS_VAR);
+  SafeDecrement(SINK_CLIENTS_STAT);
 
   OLA_INFO << "Sink client " << client << " has been removed from uni "
            << m_universe_id;
@@ -388,10 +532,29 @@ bool Universe::SetDMX(const DmxBuffer &buffer) {
     return true;
   }
   m_buffer.Set(buffer);
+  m_ingress_time = TimeStamp();
   return UpdateDependants();
 }
 
 
+void Universe::RestoreDMX(const DmxBuffer &buffer) {
+  if (!buffer.Size()) {
+    return;
+  }
+  m_buffer.Set(buffer);
+  m_restored = true;
+  if (m_universe_store) {
+    m_generation = m_universe_store->NextGeneration();
+  }
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  vector<OutputPort*>::const_iterator iter = m_output_ports.begin();
+  for (; iter != m_output_ports.end(); ++iter) {
+    WriteToPort(*iter, now);
+  }
+}
+
+
 /*
  * Call this when the dmx in a port that is part of this universe changes
  * @param port the port that has changed
@@ -402,7 +565,18 @@ bool Universe::PortDataChanged(InputPort *port) {
              << UniverseId();
     return false;
   }
-  if (MergeAll(port, NULL)) {
+  if (m_universe_store && port->SourceData().IsSet()) {
+    m_universe_store->ScheduleSourceExpiry(this, port->SourceData().Expiry());
+  }
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  RecordInput(now);
+  if (m_universe_store) {
+    m_universe_store->CaptureInput(m_universe_id, port->SourceData().Data(),
+                                   now);
+  }
+  if (MergeAll(port, NULL, now)) {
+    m_ingress_time = port->SourceData().IngressTime();
     UpdateDependants();
   }
   return true;
@@ -418,33 +592,81 @@ bool Universe::SourceClientDataChanged(Client *client) {
   }
 
   AddSourceClient(client);   // always add since this may be the first call
-  if (MergeAll(NULL, client)) {
+  const DmxSource source = client->SourceData(UniverseId());
+  if (m_universe_store && source.IsSet()) {
+    m_universe_store->ScheduleSourceExpiry(this, source.Expiry());
+  }
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  RecordInput(now);
+  if (MergeAll(NULL, client, now)) {
+    m_ingress_time = source.IngressTime();
     UpdateDependants();
   }
   return true;
 }
 
 
-/**
- * @brief Clean old source clients
- */
-void Universe::CleanStaleSourceClients() {
-  SourceClientMap::iterator iter = m_source_clients.begin();
-  while (iter != m_source_clients.end()) {
-    if (iter->second) {
-      // if stale remove it
-      m_source_clients.erase(iter++);
-      SafeDecrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
-      OLA_INFO << "Removed Stale Client";
-      if (!IsActive()) {
-        m_universe_store->AddUniverseGarbageCollection(this);
+/*
+ * Send the pending update if the frame interval has passed.
+ * @param now the current time
+ * @return true if nothing is pending anymore, false otherwise
+ */
+bool Universe::SendPendingUpdate(const TimeStamp &now) {
+  if (!m_update_pending) {
+    return true;
+  }
+  if (now - m_last_update_time < m_frame_interval) {
+    return false;
+  }
+  SendUpdate(now);
+  return true;
+}
+
+
+TimeStamp Universe::ExpireSources(const TimeStamp &now) {
+  TimeStamp next_expiry;
+  bool remerge = false;
+
+  vector<Client*> expired_clients;
+  SourceClientSet::const_iterator client_iter = m_source_clients.begin();
+  for (; client_iter != m_source_clients.end(); ++client_iter) {
+    const DmxSource source = (*client_iter)->SourceData(UniverseId());
+    if (source.IsSet() && source.IsActive(now)) {
+      if (!next_expiry.IsSet() || source.Expiry() < next_expiry) {
+        next_expiry = source.Expiry();
       }
     } else {
-      // clear the stale flag
-      iter->second = true;
-      ++iter;
+      expired_clients.push_back(*client_iter);
     }
   }
+
+  vector<Client*>::const_iterator expired_iter = expired_clients.begin();
+  for (; expired_iter != expired_clients.end(); ++expired_iter) {
+    remerge |= IsMerged(SourceKey(NULL, *expired_iter));
+    OLA_INFO << "Source client " << *expired_iter << " timed out on uni "
+             << m_universe_id;
+    RemoveSourceClient(*expired_iter);
+  }
+
+  // Ports stay patched, but they no longer take part in the merge.
+  vector<InputPort*>::const_iterator port_iter = m_input_ports.begin();
+  for (; port_iter != m_input_ports.end(); ++port_iter) {
+    const DmxSource &source = (*port_iter)->SourceData();
+    if (source.IsSet() && source.IsActive(now)) {
+      if (!next_expiry.IsSet() || source.Expiry() < next_expiry) {
+        next_expiry = source.Expiry();
+      }
+    } else if (IsMerged(SourceKey(*port_iter, NULL))) {
+      remerge = true;
+      UntrackSource(SourceKey(*port_iter, NULL));
+    }
+  }
+
+  if (remerge) {
+    Remerge(now);
+  }
+  return next_expiry;
 }
 
 
@@ -463,7 +685,9 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
            << ToHex(request->ParamId()) << ", PDL: "
            << request->ParamDataSize();
 
-  SafeIncrement(K_UNIVERSE_RDM_REQUESTS);
+  SafeIncrement(RDM_REQUESTS_STAT);
+  RDMState *rdm = GetRDMState();
+  rdm->cache.RequestSent(*request);
 
   if (request->DestinationUID().IsBroadcast()) {
     if (m_output_ports.empty()) {
@@ -501,15 +725,50 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
     }
   } else {
     map<UID, OutputPort*>::iterator iter =
-        m_output_uids.find(request->DestinationUID());
+        rdm->output_uids.find(request->DestinationUID());
 
-    if (iter == m_output_uids.end()) {
+    if (iter == rdm->output_uids.end()) {
       OLA_WARN << "Can't find UID " << request->DestinationUID()
                << " in the output universe map, dropping request";
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
-    } else {
-      iter->second->SendRDMRequest(request.release(), callback);
+      return;
+    }
+
+    if (rdm->cache.Enabled()) {
+      auto_ptr<RDMReply> reply(rdm->cache.Lookup(*request));
+      if (reply.get()) {
+        OLA_DEBUG << "Using the cached response for "
+                  << ToHex(request->ParamId()) << " from "
+                  << request->DestinationUID();
+        callback->Run(reply.get());
+        return;
+      }
+    }
+
+    // Cached replies didn't use the line, so only these are timed.
+    callback = NewSingleCallback(this, &Universe::RecordRDMTiming,
+                                 iter->second->UniqueId(),
+                                 request->DestinationUID(),
+                                 request->ParamId(), callback);
+
+    if (!rdm->cache.Enabled()) {
+      rdm->scheduler.SendRDMRequest(iter->second, request.release(),
+                                    callback);
+      return;
     }
+
+    RDMRequest *copy = request->Duplicate();
+    rdm->scheduler.SendRDMRequest(
+        iter->second, request.release(),
+        NewSingleCallback(this, &Universe::HandleRDMReply, copy, callback));
+  }
+}
+
+
+void Universe::SetRDMCacheTTL(const TimeInterval &ttl) {
+  m_rdm_cache_ttl = ttl;
+  if (m_rdm) {
+    m_rdm->cache.SetTTL(ttl);
   }
 }
 
@@ -563,10 +822,19 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
  * Update the UID : port mapping with this new data
  */
 void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
-  map<UID, OutputPort*>::iterator iter = m_output_uids.begin();
-  while (iter != m_output_uids.end()) {
+  if (!m_rdm && uids.Size() == 0) {
+    return;
+  }
+
+  RDMState *rdm = GetRDMState();
+  const size_t old_count = rdm->output_uids.size();
+  map<UID, OutputPort*>::iterator iter = rdm->output_uids.begin();
+  while (iter != rdm->output_uids.end()) {
     if (iter->second == port && !uids.Contains(iter->first)) {
-      m_output_uids.erase(iter++);
+      // The responder may be changed before it comes back.
+      rdm->cache.Invalidate(iter->first);
+      rdm->timing.RemoveUID(iter->first);
+      rdm->output_uids.erase(iter++);
     } else {
       ++iter;
     }
@@ -574,17 +842,17 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
 
   ola::rdm::UIDSet::Iterator set_iter = uids.Begin();
   for (; set_iter != uids.End(); ++set_iter) {
-    iter = m_output_uids.find(*set_iter);
-    if (iter == m_output_uids.end()) {
-      m_output_uids[*set_iter] = port;
+    iter = rdm->output_uids.find(*set_iter);
+    if (iter == rdm->output_uids.end()) {
+      rdm->output_uids[*set_iter] = port;
     } else if (iter->second != port) {
       OLA_WARN << "UID " << *set_iter << " seen on more than one port";
     }
   }
 
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
-        = m_output_uids.size();
+  SafeSet(UID_COUNT_STAT, rdm->output_uids.size());
+  if (rdm->output_uids.size() != old_count) {
+    InfoChanged();
   }
 }
 
@@ -593,18 +861,78 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
  * Returns the complete UIDSet for this universe
  */
 void Universe::GetUIDs(ola::rdm::UIDSet *uids) const {
-  map<UID, OutputPort*>::const_iterator iter = m_output_uids.begin();
-  for (; iter != m_output_uids.end(); ++iter) {
+  if (!m_rdm) {
+    return;
+  }
+  map<UID, OutputPort*>::const_iterator iter = m_rdm->output_uids.begin();
+  for (; iter != m_rdm->output_uids.end(); ++iter) {
     uids->AddUID(iter->first);
   }
 }
 
 
+/*
+ * Returns the UIDs that were discovered on a port
+ */
+void Universe::GetUIDs(const OutputPort *port, ola::rdm::UIDSet *uids) const {
+  if (!m_rdm) {
+    return;
+  }
+  map<UID, OutputPort*>::const_iterator iter = m_rdm->output_uids.begin();
+  for (; iter != m_rdm->output_uids.end(); ++iter) {
+    if (iter->second == port) {
+      uids->AddUID(iter->first);
+    }
+  }
+}
+
+
 /**
  * Return the number of uids in the universe
  */
 unsigned int Universe::UIDCount() const {
-  return m_output_uids.size();
+  return m_rdm ? m_rdm->output_uids.size() : 0;
+}
+
+
+size_t Universe::MemoryUsage() const {
+  // Buffers which hold data each reference a frame from the DmxBuffer pool.
+  size_t bytes = sizeof(*this) +
+      (m_buffer.Size() ? DMX_UNIVERSE_SIZE : 0) +
+      (m_curve_buffer.Size() ? DMX_UNIVERSE_SIZE : 0) +
+      m_universe_name.capacity() +
+      m_universe_id_str.capacity() +
+      STLVectorMemoryUsage(m_input_ports) +
+      STLVectorMemoryUsage(m_output_ports) +
+      STLNodeMemoryUsage(m_span_ports) +
+      STLNodeMemoryUsage(m_sink_clients) +
+      STLNodeMemoryUsage(m_source_clients) +
+      STLNodeMemoryUsage(m_source_priorities) +
+      STLNodeMemoryUsage(m_priority_buckets) +
+      STLNodeMemoryUsage(m_port_latency) +
+      STLNodeMemoryUsage(m_port_suppressed);
+
+  PriorityBuckets::const_iterator iter = m_priority_buckets.begin();
+  for (; iter != m_priority_buckets.end(); ++iter) {
+    bytes += STLNodeMemoryUsage(iter->second);
+  }
+
+  if (m_rdm) {
+    bytes += sizeof(RDMState) + STLNodeMemoryUsage(m_rdm->output_uids);
+  }
+  return bytes;
+}
+
+
+size_t Universe::RDMCacheMemoryUsage() const {
+  return m_rdm ? m_rdm->cache.MemoryUsage() : 0;
+}
+
+
+void Universe::InfoChanged() {
+  if (m_universe_store) {
+    m_info_generation = m_universe_store->NextInfoGeneration();
+  }
 }
 
 
@@ -614,7 +942,8 @@ unsigned int Universe::UIDCount() const {
 bool Universe::IsActive() const {
   // any of the following means the port is active
   return !(m_output_ports.empty() && m_input_ports.empty() &&
-           m_source_clients.empty() && m_sink_clients.empty());
+           m_span_ports.empty() && m_source_clients.empty() &&
+           m_sink_clients.empty());
 }
 
 
@@ -623,27 +952,152 @@ bool Universe::IsActive() const {
 
 
 /*
- * Called when the dmx data for this universe changes,
- * updates everyone who needs to know (patched ports and network clients)
+ * Return the RDM state, creating it if this is the first time it's needed.
+ */
+Universe::RDMState *Universe::GetRDMState() {
+  if (!m_rdm) {
+    m_rdm = new RDMState(m_clock, m_export_map);
+    m_rdm->cache.SetTTL(m_rdm_cache_ttl);
+  }
+  return m_rdm;
+}
+
+
+/*
+ * Called when the dmx data for this universe changes. If we're not rate
+ * limited, or the frame interval has passed this updates everyone who needs to
+ * know, otherwise the universe is marked as dirty and the update is sent by
+ * SendPendingUpdate(). Updates are only deferred if the UniverseStore has a
+ * scheduler to send them later.
  */
 bool Universe::UpdateDependants() {
+  if (m_universe_store) {
+    m_universe_store->ApplySoftPatch(this);
+    m_generation = m_universe_store->NextGeneration();
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  if (m_max_frame_rate && m_universe_store &&
+      m_universe_store->CanDeferUpdates() &&
+      (m_update_pending || now - m_last_update_time < m_frame_interval)) {
+    if (!m_update_pending) {
+      m_update_pending = true;
+      m_universe_store->AddPendingUpdate(this);
+    }
+    return true;
+  }
+  SendUpdate(now);
+  return true;
+}
+
+
+/*
+ * Send the current data to the patched ports and network clients.
+ */
+void Universe::SendUpdate(const TimeStamp &now) {
   vector<OutputPort*>::const_iterator iter;
   set<Client*>::const_iterator client_iter;
 
   // write to all ports assigned to this universe
+  const bool record_latency = m_ingress_time.IsSet() && m_export_map &&
+                              !m_output_ports.empty();
+  if (record_latency) {
+    if (!m_output_latency) {
+      m_output_latency = m_export_map->GetHistogramMapVar(
+          K_UNIVERSE_OUTPUT_LATENCY_VAR, "universe",
+          LatencyBounds())->Get(m_universe_id_str);
+    }
+    RecordLatency(m_output_latency, now);
+  }
+  if (m_universe_store) {
+    m_universe_store->BeginFrame();
+  }
   for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
-    (*iter)->WriteDMX(m_buffer, m_active_priority);
+    WriteToPort(*iter, now);
+    if (record_latency) {
+      TimeStamp sent;
+      m_clock->CurrentTime(&sent);
+      RecordLatency(STLFindOrNull(m_port_latency, *iter), sent);
+    }
+  }
+  map<OutputPort*, unsigned int>::const_iterator span_iter =
+      m_span_ports.begin();
+  for (; span_iter != m_span_ports.end(); ++span_iter) {
+    AbstractDevice *device = span_iter->first->GetDevice();
+    if (device && m_universe_store) {
+      m_universe_store->AddToFrame(device);
+    }
+    span_iter->first->WriteSpanDMX(span_iter->second, m_buffer,
+                                   m_active_priority);
+  }
+  if (m_universe_store) {
+    m_universe_store->EndFrame();
+  }
+  // Each arrival is only recorded once, later updates that aren't caused by
+  // new data, e.g. a source timing out, aren't measured.
+  m_ingress_time = TimeStamp();
+
+  // write to all clients, unless they're being shed because of overload
+  if (!m_sink_clients.empty() &&
+      (!m_universe_store ||
+       m_universe_store->SinkUpdateDue(m_last_sink_update, now))) {
+    for (client_iter = m_sink_clients.begin();
+         client_iter != m_sink_clients.end();
+         ++client_iter) {
+      const DmxBuffer *buffer = (*client_iter)->FilterDMX(
+          m_universe_id, m_active_priority, m_buffer, now);
+      if (buffer) {
+        (*client_iter)->SendDMX(m_universe_id, m_active_priority, *buffer);
+      }
+    }
+    m_last_sink_update = now;
   }
 
-  // write to all clients
-  for (client_iter = m_sink_clients.begin();
-       client_iter != m_sink_clients.end();
-       ++client_iter) {
-    (*client_iter)->SendDMX(m_universe_id, m_active_priority, m_buffer);
+  if (m_universe_store) {
+    m_universe_store->UpdateSnapshot(m_universe_id, m_buffer);
   }
 
-  SafeIncrement(K_FPS_VAR);
-  return true;
+  m_last_update_time = now;
+  m_update_pending = false;
+  m_restored = false;
+  SafeIncrement(FPS_STAT);
+  m_counters.output_frames++;
+  if (m_active_priority != m_sent_priority) {
+    m_counters.priority_changes++;
+    m_sent_priority = m_active_priority;
+  }
+}
+
+
+/*
+ * Write the current data to a port, applying the port's curve if it has one.
+ * Frames that the port's DuplicateFrameFilter suppresses aren't written, and
+ * the port's device only joins the frame if something is written to it.
+ */
+void Universe::WriteToPort(OutputPort *port, const TimeStamp &now) {
+  const OutputCurve *curve = port->GetOutputCurve();
+  const DmxBuffer *buffer = &m_buffer;
+  if (curve) {
+    curve->Apply(m_buffer, &m_curve_buffer);
+    buffer = &m_curve_buffer;
+  }
+
+  DuplicateFrameFilter *filter = port->GetDuplicateFrameFilter();
+  if (filter && !filter->ShouldSend(*buffer, m_active_priority, now)) {
+    unsigned int *suppressed = STLFindOrNull(m_port_suppressed, port);
+    if (suppressed) {
+      (*suppressed)++;
+    }
+    return;
+  }
+
+  AbstractDevice *device = port->GetDevice();
+  if (device && m_universe_store) {
+    m_universe_store->AddToFrame(device);
+  }
+  port->WriteDMX(*buffer, m_active_priority);
 }
 
 
@@ -673,17 +1127,19 @@ void Universe::UpdateMode() {
 
 
 /*
- * HTP Merge all sources (clients/ports)
- * @pre sources.size >= 2
- * @param sources the list of DmxSources to merge
+ * HTP Merge all sources (clients/ports) in m_active_sources.
+ * @pre m_active_sources.size >= 2
  */
-void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
+void Universe::HTPMergeSources() {
+  m_merge_buffers.clear();
   vector<DmxSource>::const_iterator iter;
-  m_buffer.Reset();
-
-  for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    m_buffer.HTPMerge(iter->Data());
+  for (iter = m_active_sources.begin(); iter != m_active_sources.end();
+       ++iter) {
+    m_merge_buffers.push_back(&iter->Data());
   }
+
+  m_buffer.Reset();
+  m_buffer.HTPMerge(m_merge_buffers);
 }
 
 
@@ -695,15 +1151,38 @@ void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
  * @param client the client that changed or NULL
  * @returns true if the data for this universe changed, false otherwise
  */
-bool Universe::MergeAll(const InputPort *port, const Client *client) {
-  vector<DmxSource> active_sources;
+bool Universe::MergeAll(const InputPort *port, const Client *client,
+                        const TimeStamp &now) {
+  // The copies in m_active_sources share the sources' data, so drop them once
+  // the merge is done. Otherwise each source has to copy its data on the next
+  // update.
+  bool changed = MergeActiveSources(port, client, now);
+  m_active_sources.clear();
+  return changed;
+}
+
+
+/*
+ * Find the active sources with the highest priority, and merge them into
+ * m_buffer.
+ */
+bool Universe::MergeActiveSources(const InputPort *port, const Client *client,
+                                  const TimeStamp &now) {
+  vector<DmxSource> &active_sources = m_active_sources;
 
   vector<InputPort*>::const_iterator iter;
-  SourceClientMap::const_iterator client_iter;
+  SourceClientSet::const_iterator client_iter;
+
+  // A source below the active priority can't change the merged data, so if
+  // a higher priority source is still active there is nothing to do. This
+  // avoids scanning every source when idle backup sources send data.
+  const DmxSource changed_source = LookupSource(SourceKey(port, client));
+  TrackSource(SourceKey(port, client), changed_source);
+  if (changed_source.IsSet() && IsOutranked(changed_source.Priority(), now)) {
+    return false;
+  }
 
   m_active_priority = ola::dmx::SOURCE_PRIORITY_MIN;
-  TimeStamp now;
-  m_clock->CurrentTime(&now);
   bool changed_source_is_active = false;
 
   // Find the highest active ports
@@ -731,7 +1210,7 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
   for (client_iter = m_source_clients.begin();
        client_iter != m_source_clients.end();
        ++client_iter) {
-    const DmxSource &source = client_iter->first->SourceData(UniverseId());
+    const DmxSource &source = (*client_iter)->SourceData(UniverseId());
 
     if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
       continue;
@@ -745,7 +1224,7 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
 
     if (source.Priority() == m_active_priority) {
       active_sources.push_back(source);
-      if (client_iter->first == client) {
+      if (*client_iter == client) {
         changed_source_is_active = true;
       }
     }
@@ -769,13 +1248,6 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
     // multi source merge
     if (m_merge_mode == Universe::MERGE_LTP) {
       vector<DmxSource>::const_iterator source_iter = active_sources.begin();
-      DmxSource changed_source;
-      if (port) {
-        changed_source = port->SourceData();
-      } else {
-        changed_source = client->SourceData(UniverseId());
-      }
-
       // check that the current port/client is newer than all other active
       // sources
       for (; source_iter != active_sources.end(); source_iter++) {
@@ -786,13 +1258,135 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
       // if we made it to here this is the newest source
       m_buffer.Set(changed_source.Data());
     } else {
-      HTPMergeSources(active_sources);
+      HTPMergeSources();
     }
   }
   return true;
 }
 
 
+/*
+ * Get the current data for a source.
+ */
+DmxSource Universe::LookupSource(const SourceKey &key) const {
+  if (key.first) {
+    return key.first->SourceData();
+  }
+  return key.second->SourceData(UniverseId());
+}
+
+
+/*
+ * Record the priority of a source, sources without data aren't tracked.
+ */
+void Universe::TrackSource(const SourceKey &key, const DmxSource &source) {
+  if (!source.IsSet() || !source.Data().Size()) {
+    UntrackSource(key);
+    return;
+  }
+
+  std::pair<map<SourceKey, uint8_t>::iterator, bool> result =
+      m_source_priorities.insert(std::make_pair(key, source.Priority()));
+  if (!result.second) {
+    if (result.first->second == source.Priority()) {
+      return;
+    }
+    PriorityBuckets::iterator bucket = m_priority_buckets.find(
+        result.first->second);
+    bucket->second.erase(key);
+    if (bucket->second.empty()) {
+      m_priority_buckets.erase(bucket);
+    }
+    result.first->second = source.Priority();
+  }
+  m_priority_buckets[source.Priority()].insert(key);
+}
+
+
+/*
+ * Stop tracking a source.
+ */
+void Universe::UntrackSource(const SourceKey &key) {
+  map<SourceKey, uint8_t>::iterator iter = m_source_priorities.find(key);
+  if (iter == m_source_priorities.end()) {
+    return;
+  }
+  PriorityBuckets::iterator bucket = m_priority_buckets.find(iter->second);
+  bucket->second.erase(key);
+  if (bucket->second.empty()) {
+    m_priority_buckets.erase(bucket);
+  }
+  m_source_priorities.erase(iter);
+}
+
+
+/*
+ * Check if a source with a priority higher than the one given is active. Only
+ * the buckets above the priority are examined, and each source is checked
+ * against its current data. The buckets are examined from the highest down, so
+ * the first active source found sets m_active_priority.
+ * @returns true if a higher priority source is active.
+ */
+bool Universe::IsOutranked(uint8_t priority, const TimeStamp &now) {
+  PriorityBuckets::reverse_iterator bucket = m_priority_buckets.rbegin();
+  for (; bucket != m_priority_buckets.rend() && bucket->first > priority;
+       ++bucket) {
+    set<SourceKey>::const_iterator iter = bucket->second.begin();
+    for (; iter != bucket->second.end(); ++iter) {
+      const DmxSource source = LookupSource(*iter);
+      if (source.IsSet() && source.IsActive(now) && source.Data().Size() &&
+          source.Priority() > priority) {
+        m_active_priority = source.Priority();
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+
+/*
+ * Merge again after a source that was being used has timed out. The newest
+ * active source at the highest priority is treated as the one that changed.
+ * If there are no active sources the data is left as it is.
+ */
+void Universe::Remerge(const TimeStamp &now) {
+  PriorityBuckets::const_reverse_iterator bucket = m_priority_buckets.rbegin();
+  for (; bucket != m_priority_buckets.rend(); ++bucket) {
+    SourceKey newest;
+    TimeStamp newest_time;
+    set<SourceKey>::const_iterator iter = bucket->second.begin();
+    for (; iter != bucket->second.end(); ++iter) {
+      const DmxSource source = LookupSource(*iter);
+      if (source.IsSet() && source.IsActive(now) && source.Data().Size() &&
+          (!newest_time.IsSet() || newest_time < source.Timestamp())) {
+        newest = *iter;
+        newest_time = source.Timestamp();
+      }
+    }
+
+    if (newest_time.IsSet()) {
+      if (MergeAll(newest.first, newest.second, now)) {
+        // This data didn't just arrive, so there's no latency to record.
+        m_ingress_time = TimeStamp();
+        UpdateDependants();
+      }
+      return;
+    }
+  }
+}
+
+
+/*
+ * Check if a source was at the active priority when it last sent data.
+ */
+bool Universe::IsMerged(const SourceKey &key) const {
+  map<SourceKey, uint8_t>::const_iterator iter = m_source_priorities.find(key);
+  return (iter != m_source_priorities.end() &&
+          iter->second >= m_active_priority);
+}
+
+
 /**
  * Called when discovery completes on a single ports.
  */
@@ -837,6 +1431,29 @@ void Universe::HandleBroadcastAck(broadcast_request_tracker *tracker,
 }
 
 
+/*
+ * Called with the reply to a request to a single UID, when the cache is
+ * enabled.
+ */
+void Universe::HandleRDMReply(RDMRequest *request_ptr,
+                              ola::rdm::RDMCallback *callback,
+                              RDMReply *reply) {
+  auto_ptr<RDMRequest> request(request_ptr);
+  GetRDMState()->cache.ReplyReceived(*request, *reply);
+  callback->Run(reply);
+}
+
+
+void Universe::RecordRDMTiming(string port_id,
+                               UID uid,
+                               uint16_t pid,
+                               ola::rdm::RDMCallback *callback,
+                               RDMReply *reply) {
+  GetRDMState()->timing.RecordReply(port_id, uid, pid, *reply);
+  callback->Run(reply);
+}
+
+
 /**
  * Handle the DUB responses. This is unique because unlike an RDM splitter can
  * can return the DUB responses from each port (485 line in the splitter
@@ -885,18 +1502,59 @@ void Universe::HandleBroadcastDiscovery(
 /*
  * Helper function to increment an Export Map variable
  */
-void Universe::SafeIncrement(const string &name) {
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(name))[m_universe_id_str]++;
+void Universe::SafeIncrement(universe_stat stat) {
+  if (m_stats[stat]) {
+    (*m_stats[stat])++;
   }
 }
 
 /*
  * Helper function to decrement an Export Map variable
  */
-void Universe::SafeDecrement(const string &name) {
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(name))[m_universe_id_str]--;
+void Universe::SafeDecrement(universe_stat stat) {
+  if (m_stats[stat]) {
+    (*m_stats[stat])--;
+  }
+}
+
+/*
+ * Count an input frame, and the interval since the previous one.
+ */
+void Universe::RecordInput(const TimeStamp &now) {
+  m_counters.input_frames++;
+  if (m_last_input_time.IsSet()) {
+    int64_t interval = (now - m_last_input_time).AsInt();
+    if (interval >= 0 && interval <= MAX_FRAME_INTERVAL_US) {
+      m_counters.interval_count++;
+      m_counters.interval_sum += interval;
+      m_counters.interval_sum_squares += interval * interval;
+    }
+  }
+  m_last_input_time = now;
+}
+
+
+/*
+ * Record the time since the current data arrived.
+ */
+void Universe::RecordLatency(HistogramVariable *histogram,
+                             const TimeStamp &now) {
+  if (!histogram) {
+    return;
+  }
+  int64_t latency = (now - m_ingress_time).AsInt();
+  if (latency >= 0) {
+    histogram->Observe(static_cast<uint64_t>(latency));
+  }
+}
+
+
+/*
+ * Helper function to set an Export Map variable
+ */
+void Universe::SafeSet(universe_stat stat, unsigned int value) {
+  if (m_stats[stat]) {
+    *m_stats[stat] = value;
   }
 }
 
@@ -913,12 +1571,8 @@ bool Universe::GenericAddPort(PortClass *port, vector<PortClass*> *ports) {
   }
 
   ports->push_back(port);
-  if (m_export_map) {
-    UIntMap *map = m_export_map->GetUIntMapVar(
-        IsInputPort<PortClass>() ? K_UNIVERSE_INPUT_PORT_VAR :
-        K_UNIVERSE_OUTPUT_PORT_VAR);
-    (*map)[m_universe_id_str]++;
-  }
+  SafeIncrement(IsInputPort<PortClass>() ? INPUT_PORT_STAT : OUTPUT_PORT_STAT);
+  InfoChanged();
   return true;
 }
 
@@ -942,12 +1596,8 @@ bool Universe::GenericRemovePort(PortClass *port,
   }
 
   ports->erase(iter);
-  if (m_export_map) {
-    UIntMap *map = m_export_map->GetUIntMapVar(
-        IsInputPort<PortClass>() ? K_UNIVERSE_INPUT_PORT_VAR :
-        K_UNIVERSE_OUTPUT_PORT_VAR);
-    (*map)[m_universe_id_str]--;
-  }
+  SafeDecrement(IsInputPort<PortClass>() ? INPUT_PORT_STAT : OUTPUT_PORT_STAT);
+  InfoChanged();
 
   if (!IsActive()) {
     m_universe_store->AddUniverseGarbageCollection(this);
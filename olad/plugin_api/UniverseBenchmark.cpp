@@ -0,0 +1,126 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseBenchmark.cpp
+ * Microbenchmarks for merging in the Universe.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/rdm/UID.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/testing/Benchmark.h"
+#include "olad/Preferences.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::Client;
+using ola::Clock;
+using ola::MemoryPreferences;
+using ola::TimeStamp;
+using ola::Universe;
+using ola::UniverseStore;
+using ola::rdm::UID;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using std::vector;
+
+namespace {
+
+const unsigned int TEST_UNIVERSE = 1;
+
+/*
+ * K clients sending to one universe. Each iteration one client sends a new
+ * frame, which causes the universe to merge all the sources.
+ */
+void RunMerge(BenchmarkState *state, Universe::merge_mode merge_mode,
+              unsigned int source_count) {
+  MemoryPreferences preferences("benchmark");
+  UniverseStore store(&preferences, NULL);
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  universe->SetMergeMode(merge_mode);
+
+  Clock clock;
+  TimeStamp now;
+  clock.CurrentTime(&now);
+
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  vector<Client*> clients;
+  for (unsigned int i = 0; i < source_count; i++) {
+    Client *client = new Client(NULL, UID(ola::OPEN_LIGHTING_ESTA_CODE, i));
+    for (unsigned int j = 0; j < sizeof(data); j++) {
+      data[j] = static_cast<uint8_t>(i * 31 + j * 7);
+    }
+    client->DMXReceived(TEST_UNIVERSE, data, sizeof(data), now,
+                        ola::dmx::SOURCE_PRIORITY_DEFAULT);
+    universe->AddSourceClient(client);
+    clients.push_back(client);
+  }
+  universe->SourceClientDataChanged(clients[0]);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    Client *client = clients[i % source_count];
+    data[0] = static_cast<uint8_t>(i);
+    // The timestamp keeps the sources from going stale on long runs.
+    if (i % 1024 == 0) {
+      clock.CurrentTime(&now);
+    }
+    client->DMXReceived(TEST_UNIVERSE, data, sizeof(data), now,
+                        ola::dmx::SOURCE_PRIORITY_DEFAULT);
+    universe->SourceClientDataChanged(client);
+    DoNotOptimize(universe->GetDMX());
+  }
+  state->PauseTiming();
+
+  vector<Client*>::iterator iter = clients.begin();
+  for (; iter != clients.end(); ++iter) {
+    universe->RemoveSourceClient(*iter);
+  }
+  ola::STLDeleteElements(&clients);
+}
+
+void BenchmarkMergeHTP1(BenchmarkState *state) {
+  RunMerge(state, Universe::MERGE_HTP, 1);
+}
+OLA_BENCHMARK(BenchmarkMergeHTP1);
+
+void BenchmarkMergeHTP2(BenchmarkState *state) {
+  RunMerge(state, Universe::MERGE_HTP, 2);
+}
+OLA_BENCHMARK(BenchmarkMergeHTP2);
+
+void BenchmarkMergeHTP8(BenchmarkState *state) {
+  RunMerge(state, Universe::MERGE_HTP, 8);
+}
+OLA_BENCHMARK(BenchmarkMergeHTP8);
+
+void BenchmarkMergeHTP32(BenchmarkState *state) {
+  RunMerge(state, Universe::MERGE_HTP, 32);
+}
+OLA_BENCHMARK(BenchmarkMergeHTP32);
+
+void BenchmarkMergeLTP8(BenchmarkState *state) {
+  RunMerge(state, Universe::MERGE_LTP, 8);
+}
+OLA_BENCHMARK(BenchmarkMergeLTP8);
+}  // namespace
@@ -0,0 +1,161 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseRange.cpp
+ * The DMX data for a run of consecutive universes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "olad/plugin_api/UniverseRange.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <algorithm>
+
+#include "ola/Logging.h"
+
+namespace ola {
+
+UniverseRange::UniverseRange(unsigned int first_universe,
+                             unsigned int universe_count,
+                             unsigned int slots_per_universe)
+    : m_first_universe(first_universe),
+      m_universe_count(universe_count),
+      m_slots_per_universe(
+          std::min(slots_per_universe,
+                   static_cast<unsigned int>(DMX_UNIVERSE_SIZE))),
+      m_size(static_cast<size_t>(universe_count) * m_slots_per_universe),
+      m_data(Allocate(m_size)),
+      m_lengths(universe_count, 0),
+      m_dirty((universe_count + BITS_PER_WORD - 1) / BITS_PER_WORD, 0),
+      m_dirty_count(0) {
+}
+
+UniverseRange::~UniverseRange() {
+  Free(m_data);
+}
+
+unsigned int UniverseRange::Write(unsigned int offset, const uint8_t *data,
+                                  unsigned int length) {
+  if (!m_data || offset >= m_size) {
+    return 0;
+  }
+  length = static_cast<unsigned int>(
+      std::min(static_cast<size_t>(length), m_size - offset));
+
+  const unsigned int dirty_count = m_dirty_count;
+  while (length) {
+    const unsigned int index = offset / m_slots_per_universe;
+    const unsigned int slot = offset % m_slots_per_universe;
+    const unsigned int chunk = std::min(length, m_slots_per_universe - slot);
+    uint8_t *target = m_data + offset;
+
+    const unsigned int end = slot + chunk;
+    if (end > m_lengths[index] || memcmp(target, data, chunk)) {
+      memcpy(target, data, chunk);
+      m_lengths[index] = std::max(m_lengths[index],
+                                  static_cast<uint16_t>(end));
+      MarkDirty(index);
+    }
+    offset += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+  return m_dirty_count - dirty_count;
+}
+
+unsigned int UniverseRange::NextDirty(unsigned int index) const {
+  if (index >= m_universe_count) {
+    return m_universe_count;
+  }
+
+  unsigned int word = index / BITS_PER_WORD;
+  uint64_t bits = m_dirty[word] &
+      (~static_cast<uint64_t>(0) << (index % BITS_PER_WORD));
+  while (!bits) {
+    if (++word == m_dirty.size()) {
+      return m_universe_count;
+    }
+    bits = m_dirty[word];
+  }
+  return word * BITS_PER_WORD + __builtin_ctzll(bits);
+}
+
+void UniverseRange::MarkAllDirty() {
+  for (unsigned int i = 0; i < m_universe_count; i++) {
+    if (m_lengths[i]) {
+      MarkDirty(i);
+    }
+  }
+}
+
+void UniverseRange::ClearDirty() {
+  std::fill(m_dirty.begin(), m_dirty.end(), 0);
+  m_dirty_count = 0;
+}
+
+size_t UniverseRange::MemoryUsage() const {
+  return sizeof(*this) + m_size +
+      m_lengths.capacity() * sizeof(uint16_t) +
+      m_dirty.capacity() * sizeof(uint64_t);
+}
+
+void UniverseRange::MarkDirty(unsigned int index) {
+  uint64_t *word = &m_dirty[index / BITS_PER_WORD];
+  if (!(*word & Bit(index))) {
+    *word |= Bit(index);
+    m_dirty_count++;
+  }
+}
+
+uint8_t *UniverseRange::Allocate(size_t size) {
+  if (!size) {
+    return NULL;
+  }
+
+  void *data = NULL;
+#ifdef _WIN32
+  data = _aligned_malloc(size, DEFAULT_PAGE_SIZE);
+#else
+  long page_size = sysconf(_SC_PAGESIZE);  // NOLINT(runtime/int)
+  if (page_size <= 0) {
+    page_size = DEFAULT_PAGE_SIZE;
+  }
+  if (posix_memalign(&data, page_size, size)) {
+    data = NULL;
+  }
+#endif  // _WIN32
+  if (!data) {
+    OLA_WARN << "Failed to allocate " << size << " bytes for a universe range";
+    return NULL;
+  }
+  memset(data, 0, size);
+  return static_cast<uint8_t*>(data);
+}
+
+void UniverseRange::Free(uint8_t *data) {
+#ifdef _WIN32
+  _aligned_free(data);
+#else
+  free(data);
+#endif  // _WIN32
+}
+}  // namespace ola
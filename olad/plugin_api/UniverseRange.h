@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseRange.h
+ * The DMX data for a run of consecutive universes.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_UNIVERSERANGE_H_
+#define OLAD_PLUGIN_API_UNIVERSERANGE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief Holds the DMX data for a run of consecutive universes in a single
+ * buffer, with a dirty bit for each universe.
+ *
+ * Pixel mapping sends hundreds of universes each frame, but often only a few
+ * of them change. The producer writes the whole run with one call to Write(),
+ * which marks the universes whose data changed. The consumer then visits only
+ * the dirty universes with NextDirty().
+ *
+ * The universes are packed one after another, slots_per_universe slots each,
+ * so the producer's data is compared and copied as it arrives. The buffer is
+ * page aligned.
+ */
+class UniverseRange {
+ public:
+  /**
+   * @brief Create a new UniverseRange.
+   * @param first_universe the id of the first universe.
+   * @param universe_count the number of universes in the range.
+   * @param slots_per_universe the number of slots in each universe.
+   */
+  UniverseRange(unsigned int first_universe,
+                unsigned int universe_count,
+                unsigned int slots_per_universe = DMX_UNIVERSE_SIZE);
+  ~UniverseRange();
+
+  unsigned int FirstUniverse() const { return m_first_universe; }
+  unsigned int UniverseCount() const { return m_universe_count; }
+  unsigned int SlotsPerUniverse() const { return m_slots_per_universe; }
+
+  /**
+   * @brief Check if the range has the given layout.
+   */
+  bool Matches(unsigned int first_universe,
+               unsigned int universe_count,
+               unsigned int slots_per_universe) const {
+    return (first_universe == m_first_universe &&
+            universe_count == m_universe_count &&
+            slots_per_universe == m_slots_per_universe);
+  }
+
+  /**
+   * @brief Write data to the range.
+   * @param offset the slot to start at, counting from the first slot of the
+   *   first universe.
+   * @param data the data to write.
+   * @param length the length of the data, anything past the end of the range
+   *   is ignored.
+   * @returns the number of universes that became dirty.
+   *
+   * A universe is marked dirty if its data changes, or if the write extends
+   * it.
+   */
+  unsigned int Write(unsigned int offset, const uint8_t *data,
+                     unsigned int length);
+
+  /**
+   * @brief The data for a universe.
+   * @param index the index of the universe in the range, from 0.
+   */
+  const uint8_t *Data(unsigned int index) const {
+    return m_data + index * m_slots_per_universe;
+  }
+
+  /**
+   * @brief The number of slots that have been written to a universe.
+   * @param index the index of the universe in the range, from 0.
+   */
+  unsigned int Length(unsigned int index) const { return m_lengths[index]; }
+
+  /**
+   * @brief Check if a universe is dirty.
+   * @param index the index of the universe in the range, from 0.
+   */
+  bool IsDirty(unsigned int index) const {
+    return m_dirty[index / BITS_PER_WORD] & Bit(index);
+  }
+
+  /**
+   * @brief The number of dirty universes.
+   */
+  unsigned int DirtyCount() const { return m_dirty_count; }
+
+  /**
+   * @brief Find the next dirty universe.
+   * @param index the index to start searching at.
+   * @returns the index of the first dirty universe at or after index, or
+   *   UniverseCount() if there isn't one.
+   */
+  unsigned int NextDirty(unsigned int index) const;
+
+  /**
+   * @brief Mark every universe that has been written to as dirty.
+   */
+  void MarkAllDirty();
+
+  /**
+   * @brief Clear all the dirty bits.
+   */
+  void ClearDirty();
+
+  /**
+   * @brief The approximate number of bytes used by the range.
+   */
+  size_t MemoryUsage() const;
+
+ private:
+  const unsigned int m_first_universe;
+  const unsigned int m_universe_count;
+  const unsigned int m_slots_per_universe;
+  size_t m_size;
+  uint8_t *m_data;
+  std::vector<uint16_t> m_lengths;
+  std::vector<uint64_t> m_dirty;
+  unsigned int m_dirty_count;
+
+  void MarkDirty(unsigned int index);
+
+  static uint64_t Bit(unsigned int index) {
+    return static_cast<uint64_t>(1) << (index % BITS_PER_WORD);
+  }
+
+  static uint8_t *Allocate(size_t size);
+  static void Free(uint8_t *data);
+
+  static const unsigned int BITS_PER_WORD = 64;
+  // Used if the page size can't be found.
+  static const unsigned int DEFAULT_PAGE_SIZE = 4096;
+
+  DISALLOW_COPY_AND_ASSIGN(UniverseRange);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_UNIVERSERANGE_H_
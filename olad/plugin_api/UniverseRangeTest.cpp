@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseRangeTest.cpp
+ * Test fixture for the UniverseRange class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <vector>
+
+#include "olad/plugin_api/UniverseRange.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::UniverseRange;
+using std::vector;
+
+class UniverseRangeTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UniverseRangeTest);
+  CPPUNIT_TEST(testWrite);
+  CPPUNIT_TEST(testPartialWrite);
+  CPPUNIT_TEST(testNextDirty);
+  CPPUNIT_TEST(testAlignment);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testWrite();
+    void testPartialWrite();
+    void testNextDirty();
+    void testAlignment();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UniverseRangeTest);
+
+
+/*
+ * Check only the universes that change are marked dirty.
+ */
+void UniverseRangeTest::testWrite() {
+  UniverseRange range(10, 3, 4);
+  OLA_ASSERT_EQ(10u, range.FirstUniverse());
+  OLA_ASSERT_EQ(3u, range.UniverseCount());
+  OLA_ASSERT_EQ(4u, range.SlotsPerUniverse());
+  OLA_ASSERT_TRUE(range.Matches(10, 3, 4));
+  OLA_ASSERT_FALSE(range.Matches(10, 4, 4));
+  OLA_ASSERT_EQ(0u, range.DirtyCount());
+
+  // The first write marks every universe, even if the data is all 0.
+  uint8_t data[] = {1, 2, 3, 4, 0, 0, 0, 0, 9, 10, 11, 12};
+  OLA_ASSERT_EQ(3u, range.Write(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(3u, range.DirtyCount());
+  OLA_ASSERT_EQ(4u, range.Length(1));
+  OLA_ASSERT_DATA_EQUALS(data + 8, 4, range.Data(2), range.Length(2));
+  range.ClearDirty();
+  OLA_ASSERT_EQ(0u, range.DirtyCount());
+
+  // The same data again changes nothing.
+  OLA_ASSERT_EQ(0u, range.Write(0, data, sizeof(data)));
+
+  data[5] = 100;
+  OLA_ASSERT_EQ(1u, range.Write(0, data, sizeof(data)));
+  OLA_ASSERT_FALSE(range.IsDirty(0));
+  OLA_ASSERT_TRUE(range.IsDirty(1));
+  OLA_ASSERT_FALSE(range.IsDirty(2));
+  OLA_ASSERT_DATA_EQUALS(data + 4, 4, range.Data(1), range.Length(1));
+
+  // Writing to a dirty universe doesn't count it again.
+  data[6] = 101;
+  OLA_ASSERT_EQ(0u, range.Write(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, range.DirtyCount());
+
+  range.ClearDirty();
+  range.MarkAllDirty();
+  OLA_ASSERT_EQ(3u, range.DirtyCount());
+}
+
+
+/*
+ * Check writes that start part way through, or run past the end.
+ */
+void UniverseRangeTest::testPartialWrite() {
+  UniverseRange range(1, 3, 4);
+
+  // Only universes that have been written to are marked by MarkAllDirty.
+  const uint8_t data[] = {5, 6, 7};
+  OLA_ASSERT_EQ(2u, range.Write(3, data, sizeof(data)));
+  OLA_ASSERT_EQ(4u, range.Length(0));
+  OLA_ASSERT_EQ(2u, range.Length(1));
+  OLA_ASSERT_EQ(0u, range.Length(2));
+  range.ClearDirty();
+  range.MarkAllDirty();
+  OLA_ASSERT_EQ(2u, range.DirtyCount());
+  OLA_ASSERT_FALSE(range.IsDirty(2));
+  range.ClearDirty();
+
+  // Extending a universe marks it, even with matching data.
+  const uint8_t zeros[] = {0, 0, 0, 0};
+  OLA_ASSERT_EQ(1u, range.Write(6, zeros, 1));
+  OLA_ASSERT_EQ(3u, range.Length(1));
+
+  // Anything past the end is dropped.
+  range.ClearDirty();
+  OLA_ASSERT_EQ(1u, range.Write(10, data, sizeof(data)));
+  OLA_ASSERT_EQ(4u, range.Length(2));
+  OLA_ASSERT_EQ(0u, range.Write(12, data, sizeof(data)));
+}
+
+
+/*
+ * Check NextDirty() visits each dirty universe, across words.
+ */
+void UniverseRangeTest::testNextDirty() {
+  const unsigned int count = 200;
+  UniverseRange range(1, count, 1);
+  OLA_ASSERT_EQ(count, range.NextDirty(0));
+
+  vector<uint8_t> frame(count, 0);
+  range.Write(0, &frame[0], count);
+  range.ClearDirty();
+
+  const unsigned int changed[] = {0, 63, 64, 130, 199};
+  for (unsigned int i = 0; i < sizeof(changed) / sizeof(changed[0]); i++) {
+    frame[changed[i]] = 1;
+  }
+  OLA_ASSERT_EQ(5u, range.Write(0, &frame[0], count));
+
+  unsigned int visited = 0;
+  for (unsigned int i = range.NextDirty(0); i < count;
+       i = range.NextDirty(i + 1)) {
+    OLA_ASSERT_EQ(changed[visited++], i);
+  }
+  OLA_ASSERT_EQ(5u, visited);
+  OLA_ASSERT_EQ(count, range.NextDirty(count));
+}
+
+
+/*
+ * Check the buffer is page aligned.
+ */
+void UniverseRangeTest::testAlignment() {
+  UniverseRange range(1, 8);
+  OLA_ASSERT_EQ(
+      0u,
+      static_cast<unsigned int>(reinterpret_cast<uintptr_t>(range.Data(0)) %
+                                4096));
+  OLA_ASSERT_EQ(static_cast<const uint8_t*>(range.Data(0)) +
+                ola::DMX_UNIVERSE_SIZE, range.Data(1));
+  OLA_ASSERT_TRUE(range.MemoryUsage() > 8 * ola::DMX_UNIVERSE_SIZE);
+}
@@ -0,0 +1,234 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseSnapshot.cpp
+ * A file backed record of the last frame sent on each universe.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif  // HAVE_SYS_MMAN_H
+
+#include <algorithm>
+#include <string>
+
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/plugin_api/UniverseSnapshot.h"
+
+namespace ola {
+
+using std::string;
+
+struct UniverseSnapshot::FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+};
+
+struct UniverseSnapshot::Slot {
+  uint32_t universe;
+  uint16_t length;
+  uint8_t in_use;
+  uint8_t reserved;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+};
+
+const uint32_t UniverseSnapshot::FILE_MAGIC = 0x4f4c4153;  // OLAS
+const uint32_t UniverseSnapshot::FILE_VERSION = 1;
+const unsigned int UniverseSnapshot::MAX_SLOTS;
+
+UniverseSnapshot::UniverseSnapshot(void *memory, size_t size,
+                                   unsigned int slot_count)
+    : m_memory(memory),
+      m_size(size),
+      m_slot_count(slot_count),
+      m_slots(reinterpret_cast<Slot*>(
+          reinterpret_cast<uint8_t*>(memory) + sizeof(FileHeader))),
+      m_used_slots(0),
+      m_dirty(false),
+      m_full_warned(false) {
+  LoadSlots();
+}
+
+UniverseSnapshot::~UniverseSnapshot() {
+#ifdef HAVE_SYS_MMAN_H
+  Sync();
+  munmap(m_memory, m_size);
+#endif  // HAVE_SYS_MMAN_H
+}
+
+UniverseSnapshot *UniverseSnapshot::Open(const string &path,
+                                         unsigned int slot_count) {
+#ifdef HAVE_SYS_MMAN_H
+  if (slot_count == 0 || slot_count > MAX_SLOTS) {
+    OLA_WARN << "Invalid slot count for snapshot: " << slot_count;
+    return NULL;
+  }
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    OLA_WARN << "open(" << path << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  const size_t size = FileSize(slot_count);
+  struct stat stat_buf;
+  bool reset = (fstat(fd, &stat_buf) < 0 ||
+                static_cast<size_t>(stat_buf.st_size) != size);
+  if (reset) {
+    // ftruncate zero fills, so all the slots start unused.
+    if (ftruncate(fd, 0) < 0 || ftruncate(fd, size) < 0) {
+      OLA_WARN << "ftruncate(" << path << ") failed: " << strerror(errno);
+      close(fd);
+      return NULL;
+    }
+  }
+
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "mmap(" << path << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  FileHeader *header = reinterpret_cast<FileHeader*>(memory);
+  if (!reset && (header->magic != FILE_MAGIC ||
+                 header->version != FILE_VERSION ||
+                 header->slot_count != slot_count ||
+                 header->slot_size != sizeof(Slot))) {
+    OLA_WARN << "Snapshot " << path << " has an invalid header, clearing it";
+    reset = true;
+  }
+
+  if (reset) {
+    memset(memory, 0, size);
+    header->magic = FILE_MAGIC;
+    header->version = FILE_VERSION;
+    header->slot_count = slot_count;
+    header->slot_size = sizeof(Slot);
+  }
+  return new UniverseSnapshot(memory, size, slot_count);
+#else
+  OLA_WARN << "mmap isn't supported, can't open snapshot " << path << " ("
+           << slot_count << " slots)";
+  return NULL;
+#endif  // HAVE_SYS_MMAN_H
+}
+
+bool UniverseSnapshot::IsSupported() {
+#ifdef HAVE_SYS_MMAN_H
+  return true;
+#else
+  return false;
+#endif  // HAVE_SYS_MMAN_H
+}
+
+bool UniverseSnapshot::Update(unsigned int universe_id,
+                              const DmxBuffer &data) {
+  SlotMap::const_iterator iter = m_slot_map.find(universe_id);
+  unsigned int index;
+  if (iter == m_slot_map.end()) {
+    index = m_used_slots;
+    if (index >= m_slot_count) {
+      if (!m_full_warned) {
+        OLA_WARN << "Snapshot is full, universe " << universe_id
+                 << " won't be recorded";
+        m_full_warned = true;
+      }
+      return false;
+    }
+    m_slot_map[universe_id] = index;
+    m_used_slots++;
+    m_slots[index].universe = universe_id;
+    m_slots[index].length = 0;
+    m_slots[index].in_use = 1;
+  } else {
+    index = iter->second;
+  }
+
+  Slot *slot = &m_slots[index];
+  const unsigned int length = std::min(
+      data.Size(), static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  // Most frames repeat the last one, skip the write so the page stays clean.
+  if (slot->length == length &&
+      memcmp(slot->data, data.GetRaw(), length) == 0) {
+    return true;
+  }
+  memcpy(slot->data, data.GetRaw(), length);
+  slot->length = static_cast<uint16_t>(length);
+  m_dirty = true;
+  return true;
+}
+
+bool UniverseSnapshot::Get(unsigned int universe_id, DmxBuffer *data) const {
+  const unsigned int *index = STLFind(&m_slot_map, universe_id);
+  if (!index || !m_slots[*index].length) {
+    return false;
+  }
+  data->Set(m_slots[*index].data,
+            std::min(static_cast<unsigned int>(m_slots[*index].length),
+                     static_cast<unsigned int>(DMX_UNIVERSE_SIZE)));
+  return true;
+}
+
+void UniverseSnapshot::Sync() {
+  if (!m_dirty) {
+    return;
+  }
+#ifdef HAVE_SYS_MMAN_H
+  if (msync(m_memory, m_size, MS_ASYNC) < 0) {
+    OLA_WARN << "msync failed: " << strerror(errno);
+  }
+#endif  // HAVE_SYS_MMAN_H
+  m_dirty = false;
+}
+
+/*
+ * Build the map of universe ids to slots. Slots are assigned in order, so
+ * the first unused slot marks the end.
+ */
+void UniverseSnapshot::LoadSlots() {
+  for (unsigned int i = 0; i < m_slot_count; i++) {
+    const Slot &slot = m_slots[i];
+    if (!slot.in_use) {
+      break;
+    }
+    m_used_slots++;
+    if (!STLInsertIfNotPresent(&m_slot_map, slot.universe, i)) {
+      OLA_WARN << "Universe " << slot.universe
+               << " appears more than once in the snapshot";
+    }
+  }
+}
+
+size_t UniverseSnapshot::FileSize(unsigned int slot_count) {
+  return sizeof(FileHeader) + slot_count * sizeof(Slot);
+}
+}  // namespace ola
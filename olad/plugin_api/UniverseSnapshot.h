@@ -0,0 +1,130 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseSnapshot.h
+ * A file backed record of the last frame sent on each universe.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_UNIVERSESNAPSHOT_H_
+#define OLAD_PLUGIN_API_UNIVERSESNAPSHOT_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+
+namespace ola {
+
+/**
+ * @brief A memory mapped file holding the last frame sent on each universe.
+ *
+ * The file is divided into slots, each of which holds the data for a single
+ * universe. Slots are assigned as universes are first seen and are never
+ * reused, so the snapshot survives universes being removed and re-created.
+ *
+ * Because the file is mapped shared, an update is in the page cache as soon
+ * as it's written, and survives the process crashing. Sync() only needs to be
+ * called to limit what's lost if the machine itself goes down.
+ */
+class UniverseSnapshot {
+ public:
+  ~UniverseSnapshot();
+
+  /**
+   * @brief Open a snapshot file, creating it if it doesn't exist.
+   * @param path the path to the file.
+   * @param slot_count the number of universes the file can hold.
+   * @returns a new UniverseSnapshot, or NULL if the file couldn't be opened.
+   *   Ownership is transferred to the caller.
+   *
+   * If the existing file doesn't match slot_count, or is corrupt, it's
+   * cleared.
+   */
+  static UniverseSnapshot *Open(const std::string &path,
+                                unsigned int slot_count);
+
+  /**
+   * @brief Check if snapshots are supported on this platform.
+   */
+  static bool IsSupported();
+
+  /**
+   * @brief The number of slots in the file.
+   */
+  unsigned int SlotCount() const { return m_slot_count; }
+
+  /**
+   * @brief The number of universes held in the file.
+   */
+  unsigned int UniverseCount() const { return m_slot_map.size(); }
+
+  /**
+   * @brief Record the data for a universe.
+   * @param universe_id the universe the data is for.
+   * @param data the DMX data.
+   * @returns true if the data was recorded, false if the file is full.
+   */
+  bool Update(unsigned int universe_id, const DmxBuffer &data);
+
+  /**
+   * @brief Fetch the data for a universe.
+   * @param universe_id the universe to fetch.
+   * @param[out] data the DMX data.
+   * @returns true if there was data for the universe, false otherwise.
+   */
+  bool Get(unsigned int universe_id, DmxBuffer *data) const;
+
+  /**
+   * @brief Schedule any changes to be written to disk.
+   *
+   * This doesn't block.
+   */
+  void Sync();
+
+  /**
+   * @brief The maximum number of slots in a file.
+   */
+  static const unsigned int MAX_SLOTS = 65536;
+
+ private:
+  struct FileHeader;
+  struct Slot;
+  typedef std::map<unsigned int, unsigned int> SlotMap;
+
+  void *m_memory;
+  size_t m_size;
+  unsigned int m_slot_count;
+  Slot *m_slots;
+  SlotMap m_slot_map;  // universe id to slot index
+  unsigned int m_used_slots;
+  bool m_dirty;
+  bool m_full_warned;
+
+  UniverseSnapshot(void *memory, size_t size, unsigned int slot_count);
+
+  void LoadSlots();
+
+  static size_t FileSize(unsigned int slot_count);
+
+  static const uint32_t FILE_MAGIC;
+  static const uint32_t FILE_VERSION;
+
+  DISALLOW_COPY_AND_ASSIGN(UniverseSnapshot);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_UNIVERSESNAPSHOT_H_
@@ -0,0 +1,209 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UniverseSnapshotTest.cpp
+ * Test fixture for the UniverseSnapshot class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "olad/plugin_api/UniverseSnapshot.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::UniverseSnapshot;
+using std::auto_ptr;
+using std::string;
+
+class UniverseSnapshotTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UniverseSnapshotTest);
+  CPPUNIT_TEST(testUpdateAndGet);
+  CPPUNIT_TEST(testReopen);
+  CPPUNIT_TEST(testInvalidFile);
+  CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void tearDown();
+
+  void testUpdateAndGet();
+  void testReopen();
+  void testInvalidFile();
+  void testFull();
+
+ private:
+  string m_path;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UniverseSnapshotTest);
+
+void UniverseSnapshotTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  std::ostringstream str;
+  str << "/tmp/ola-snapshot-test-" << getpid();
+  m_path = str.str();
+  unlink(m_path.c_str());
+}
+
+void UniverseSnapshotTest::tearDown() {
+  unlink(m_path.c_str());
+}
+
+/*
+ * Check frames can be recorded and fetched.
+ */
+void UniverseSnapshotTest::testUpdateAndGet() {
+  if (!UniverseSnapshot::IsSupported()) {
+    return;
+  }
+
+  auto_ptr<UniverseSnapshot> snapshot(UniverseSnapshot::Open(m_path, 4));
+  OLA_ASSERT_NOT_NULL(snapshot.get());
+  OLA_ASSERT_EQ(4u, snapshot->SlotCount());
+  OLA_ASSERT_EQ(0u, snapshot->UniverseCount());
+
+  DmxBuffer output;
+  OLA_ASSERT_FALSE(snapshot->Get(1, &output));
+
+  DmxBuffer frame1;
+  frame1.SetFromString("1,2,3,4");
+  OLA_ASSERT_TRUE(snapshot->Update(1, frame1));
+  DmxBuffer frame2;
+  frame2.SetFromString("255,128");
+  OLA_ASSERT_TRUE(snapshot->Update(100000, frame2));
+  OLA_ASSERT_EQ(2u, snapshot->UniverseCount());
+
+  OLA_ASSERT_TRUE(snapshot->Get(1, &output));
+  OLA_ASSERT(frame1 == output);
+  OLA_ASSERT_TRUE(snapshot->Get(100000, &output));
+  OLA_ASSERT(frame2 == output);
+
+  // A new frame replaces the old one, even if it's shorter.
+  DmxBuffer frame3;
+  frame3.SetFromString("9");
+  OLA_ASSERT_TRUE(snapshot->Update(1, frame3));
+  OLA_ASSERT_TRUE(snapshot->Get(1, &output));
+  OLA_ASSERT(frame3 == output);
+  OLA_ASSERT_EQ(2u, snapshot->UniverseCount());
+
+  // An empty frame means there's nothing to restore.
+  OLA_ASSERT_TRUE(snapshot->Update(1, DmxBuffer()));
+  OLA_ASSERT_FALSE(snapshot->Get(1, &output));
+  snapshot->Sync();
+}
+
+/*
+ * Check the frames survive the file being closed and opened again.
+ */
+void UniverseSnapshotTest::testReopen() {
+  if (!UniverseSnapshot::IsSupported()) {
+    return;
+  }
+
+  DmxBuffer frame1;
+  frame1.SetFromString("10,20,30");
+  DmxBuffer frame2;
+  frame2.SetFromString("40,50");
+
+  auto_ptr<UniverseSnapshot> snapshot(UniverseSnapshot::Open(m_path, 4));
+  OLA_ASSERT_NOT_NULL(snapshot.get());
+  OLA_ASSERT_TRUE(snapshot->Update(5, frame1));
+  OLA_ASSERT_TRUE(snapshot->Update(6, frame2));
+  snapshot.reset();
+
+  snapshot.reset(UniverseSnapshot::Open(m_path, 4));
+  OLA_ASSERT_NOT_NULL(snapshot.get());
+  OLA_ASSERT_EQ(2u, snapshot->UniverseCount());
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(snapshot->Get(5, &output));
+  OLA_ASSERT(frame1 == output);
+  OLA_ASSERT_TRUE(snapshot->Get(6, &output));
+  OLA_ASSERT(frame2 == output);
+
+  // New universes go after the existing ones.
+  DmxBuffer frame3;
+  frame3.SetFromString("60");
+  OLA_ASSERT_TRUE(snapshot->Update(7, frame3));
+  OLA_ASSERT_TRUE(snapshot->Get(5, &output));
+  OLA_ASSERT(frame1 == output);
+  OLA_ASSERT_EQ(3u, snapshot->UniverseCount());
+
+  // Opening with a different size clears the file.
+  snapshot.reset(UniverseSnapshot::Open(m_path, 8));
+  OLA_ASSERT_NOT_NULL(snapshot.get());
+  OLA_ASSERT_EQ(0u, snapshot->UniverseCount());
+  OLA_ASSERT_FALSE(snapshot->Get(5, &output));
+}
+
+/*
+ * Check a file that isn't a snapshot is cleared.
+ */
+void UniverseSnapshotTest::testInvalidFile() {
+  if (!UniverseSnapshot::IsSupported()) {
+    return;
+  }
+
+  {
+    auto_ptr<UniverseSnapshot> snapshot(UniverseSnapshot::Open(m_path, 2));
+    OLA_ASSERT_NOT_NULL(snapshot.get());
+    DmxBuffer frame;
+    frame.SetFromString("1,2");
+    OLA_ASSERT_TRUE(snapshot->Update(1, frame));
+  }
+
+  // Overwrite the header.
+  FILE *file = fopen(m_path.c_str(), "r+");
+  OLA_ASSERT_NOT_NULL(file);
+  fputs("junk", file);
+  fclose(file);
+
+  auto_ptr<UniverseSnapshot> snapshot(UniverseSnapshot::Open(m_path, 2));
+  OLA_ASSERT_NOT_NULL(snapshot.get());
+  OLA_ASSERT_EQ(0u, snapshot->UniverseCount());
+  DmxBuffer output;
+  OLA_ASSERT_FALSE(snapshot->Get(1, &output));
+
+  OLA_ASSERT_NULL(UniverseSnapshot::Open(m_path, 0));
+}
+
+/*
+ * Check what happens when the file is full.
+ */
+void UniverseSnapshotTest::testFull() {
+  if (!UniverseSnapshot::IsSupported()) {
+    return;
+  }
+
+  auto_ptr<UniverseSnapshot> snapshot(UniverseSnapshot::Open(m_path, 2));
+  OLA_ASSERT_NOT_NULL(snapshot.get());
+  DmxBuffer frame;
+  frame.SetFromString("1,2");
+  OLA_ASSERT_TRUE(snapshot->Update(1, frame));
+  OLA_ASSERT_TRUE(snapshot->Update(2, frame));
+  OLA_ASSERT_FALSE(snapshot->Update(3, frame));
+  // Existing universes can still be updated.
+  OLA_ASSERT_TRUE(snapshot->Update(1, frame));
+  OLA_ASSERT_EQ(2u, snapshot->UniverseCount());
+}
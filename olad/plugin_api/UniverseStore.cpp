@@ -21,33 +21,55 @@
 
 #include "olad/plugin_api/UniverseStore.h"
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <set>
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Constants.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
+#include "olad/Device.h"
+#include "olad/Port.h"
 #include "olad/Preferences.h"
 #include "olad/Universe.h"
 
 namespace ola {
 
+using std::map;
 using std::pair;
 using std::set;
 using std::string;
 using std::vector;
 
 const unsigned int UniverseStore::MINIMUM_RDM_DISCOVERY_INTERVAL = 30;
+const unsigned int UniverseStore::INDEX_PAGE_BITS = 8;
+const unsigned int UniverseStore::INDEX_PAGE_SIZE = 1 << INDEX_PAGE_BITS;
+const unsigned int UniverseStore::INDEX_PAGES = 256;
+const unsigned int UniverseStore::SNAPSHOT_SLOTS = 1024;
+const unsigned int UniverseStore::SNAPSHOT_SYNC_INTERVAL_MS = 1000;
+const char UniverseStore::SOFT_PATCH_KEY[] = "soft_patch";
+const char UniverseStore::K_SINK_FRAMES_SHED_VAR[] = "sink-frames-shed";
 
 UniverseStore::UniverseStore(Preferences *preferences,
                              ExportMap *export_map)
     : m_preferences(preferences),
-      m_export_map(export_map) {
+      m_export_map(export_map),
+      m_index(INDEX_PAGES, static_cast<Universe**>(NULL)),
+      m_frame_depth(0),
+      m_generation(0),
+      m_info_generation(0),
+      m_max_frame_rate(0),
+      m_scheduler(NULL),
+      m_update_timeout(ola::thread::INVALID_TIMEOUT),
+      m_snapshot_timeout(ola::thread::INVALID_TIMEOUT) {
   if (export_map) {
     export_map->GetStringMapVar(Universe::K_UNIVERSE_NAME_VAR, "universe");
     export_map->GetStringMapVar(Universe::K_UNIVERSE_MODE_VAR, "universe");
@@ -65,46 +87,97 @@ UniverseStore::UniverseStore(Preferences *preferences,
       export_map->GetUIntMapVar(string(vars[i]), "universe");
     }
   }
+
+  if (m_preferences) {
+    LoadSoftPatch();
+  }
 }
 
 UniverseStore::~UniverseStore() {
+  SetScheduler(NULL);
   DeleteAll();
+
+  vector<Universe**>::iterator iter = m_index.begin();
+  for (; iter != m_index.end(); ++iter) {
+    delete[] *iter;
+  }
 }
 
 Universe *UniverseStore::GetUniverse(unsigned int universe_id) const {
+  unsigned int page = universe_id >> INDEX_PAGE_BITS;
+  if (page < INDEX_PAGES) {
+    Universe **slots = m_index[page];
+    return slots ? slots[universe_id & (INDEX_PAGE_SIZE - 1)] : NULL;
+  }
   return STLFindOrNull(m_universe_map, universe_id);
 }
 
 Universe *UniverseStore::GetUniverseOrCreate(unsigned int universe_id) {
-  UniverseMap::iterator iter = STLLookupOrInsertNull(
-      &m_universe_map, universe_id);
-
-  if (!iter->second) {
-    iter->second = new Universe(universe_id, this, m_export_map, &m_clock);
+  Universe *universe = GetUniverse(universe_id);
+  if (universe) {
+    return universe;
+  }
 
-    if (iter->second) {
-      if (m_preferences) {
-        RestoreUniverseSettings(iter->second);
-      }
-    } else {
-      OLA_WARN << "Failed to create universe " << universe_id;
+  universe = new Universe(universe_id, this, m_export_map, &m_clock);
+  universe->SetMaxFrameRate(m_max_frame_rate);
+  if (m_preferences) {
+    RestoreUniverseSettings(universe);
+  }
+  if (m_snapshot.get()) {
+    DmxBuffer buffer;
+    if (m_snapshot->Get(universe_id, &buffer)) {
+      universe->RestoreDMX(buffer);
     }
   }
-  return iter->second;
+  m_universe_map[universe_id] = universe;
+  SetIndex(universe_id, universe);
+  m_removed_universes.erase(universe_id);
+  universe->InfoChanged();
+  return universe;
 }
 
 void UniverseStore::GetList(vector<Universe*> *universes) const {
   STLValues(m_universe_map, universes);
 }
 
+void UniverseStore::GetRange(unsigned int first, unsigned int last,
+                             vector<Universe*> *universes) const {
+  UniverseMap::const_iterator iter = m_universe_map.lower_bound(first);
+  for (; iter != m_universe_map.end() && iter->first <= last; ++iter) {
+    universes->push_back(iter->second);
+  }
+}
+
+void UniverseStore::GetInfoChanges(uint64_t since,
+                                   vector<Universe*> *changed,
+                                   vector<unsigned int> *removed) const {
+  UniverseMap::const_iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    if (iter->second->InfoGeneration() > since) {
+      changed->push_back(iter->second);
+    }
+  }
+
+  map<unsigned int, uint64_t>::const_iterator removed_iter =
+      m_removed_universes.begin();
+  for (; removed_iter != m_removed_universes.end(); ++removed_iter) {
+    if (removed_iter->second > since) {
+      removed->push_back(removed_iter->first);
+    }
+  }
+}
+
 void UniverseStore::DeleteAll() {
   UniverseMap::iterator iter;
 
   for (iter = m_universe_map.begin(); iter != m_universe_map.end(); iter++) {
     SaveUniverseSettings(iter->second);
+    SetIndex(iter->first, NULL);
+    CancelSourceExpiry(iter->second);
     delete iter->second;
   }
   m_deletion_candiates.clear();
+  m_pending_updates.clear();
   m_universe_map.clear();
 }
 
@@ -121,36 +194,336 @@ void UniverseStore::GarbageCollectUniverses() {
     if (!(*iter)->IsActive()) {
       SaveUniverseSettings(*iter);
       m_universe_map.erase((*iter)->UniverseId());
+      m_removed_universes[(*iter)->UniverseId()] = ++m_info_generation;
+      SetIndex((*iter)->UniverseId(), NULL);
+      m_pending_updates.erase(*iter);
+      CancelSourceExpiry(*iter);
       delete *iter;
     }
   }
   m_deletion_candiates.clear();
 }
 
+void UniverseStore::SetMaxFrameRate(unsigned int frame_rate) {
+  m_max_frame_rate = frame_rate;
+}
+
+bool UniverseStore::SinkUpdateDue(const TimeStamp &last_sent,
+                                  const TimeStamp &now) {
+  if (m_sink_interval.IsZero() || now - last_sent >= m_sink_interval) {
+    return true;
+  }
+  if (m_export_map) {
+    (*m_export_map->GetCounterVar(K_SINK_FRAMES_SHED_VAR))++;
+  }
+  return false;
+}
+
+void UniverseStore::SetScheduler(ola::thread::SchedulerInterface *scheduler) {
+  if (m_scheduler && m_update_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_update_timeout);
+  }
+  if (m_scheduler && m_snapshot_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_snapshot_timeout);
+  }
+  map<Universe*, ola::thread::timeout_id>::iterator expiry_iter =
+      m_expiry_timeouts.begin();
+  for (; expiry_iter != m_expiry_timeouts.end(); ++expiry_iter) {
+    m_scheduler->RemoveTimeout(expiry_iter->second);
+  }
+  m_expiry_timeouts.clear();
+  m_update_timeout = ola::thread::INVALID_TIMEOUT;
+  m_snapshot_timeout = ola::thread::INVALID_TIMEOUT;
+  m_scheduler = scheduler;
+}
+
+void UniverseStore::AddPendingUpdate(Universe *universe) {
+  m_pending_updates.insert(universe);
+  SchedulePendingUpdates(universe->NextUpdateTime());
+}
+
+void UniverseStore::ScheduleSourceExpiry(Universe *universe,
+                                         const TimeStamp &expiry) {
+  if (!m_scheduler || STLContains(m_expiry_timeouts, universe)) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  // Round up, so the source has expired when the timeout runs.
+  const int64_t delay_ms = now < expiry ?
+      (expiry - now).InMilliSeconds() + 1 : 1;
+  m_expiry_timeouts[universe] = m_scheduler->RegisterSingleTimeout(
+      static_cast<unsigned int>(delay_ms),
+      NewSingleCallback(this, &UniverseStore::ExpireSources, universe));
+}
+
+void UniverseStore::SendPendingUpdates(const TimeStamp &now) {
+  // All the universes sent here share a frame, so a device with ports on
+  // several of them sees a single BeginFrame() / EndFrame().
+  BeginFrame();
+  set<Universe*>::iterator iter = m_pending_updates.begin();
+  while (iter != m_pending_updates.end()) {
+    if ((*iter)->SendPendingUpdate(now)) {
+      m_pending_updates.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  EndFrame();
+}
+
+void UniverseStore::BeginFrame() {
+  m_frame_depth++;
+}
+
+void UniverseStore::AddToFrame(AbstractDevice *device) {
+  if (std::find(m_frame_devices.begin(), m_frame_devices.end(), device) !=
+      m_frame_devices.end()) {
+    return;
+  }
+  m_frame_devices.push_back(device);
+  device->BeginFrame();
+}
+
+void UniverseStore::EndFrame() {
+  if (!m_frame_depth || --m_frame_depth) {
+    return;
+  }
+
+  vector<AbstractDevice*> devices;
+  devices.swap(m_frame_devices);
+  vector<AbstractDevice*>::iterator iter = devices.begin();
+  for (; iter != devices.end(); ++iter) {
+    (*iter)->EndFrame();
+  }
+}
+
+
+/*
+ * Make sure the pending updates timeout runs no later than deadline.
+ */
+void UniverseStore::SchedulePendingUpdates(const TimeStamp &deadline) {
+  if (!m_scheduler) {
+    return;
+  }
+  if (m_update_timeout != ola::thread::INVALID_TIMEOUT) {
+    if (m_update_deadline <= deadline) {
+      return;
+    }
+    m_scheduler->RemoveTimeout(m_update_timeout);
+  }
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  // Round up, so the frame interval has passed when the timeout runs.
+  const int64_t delay_ms = now < deadline ?
+      (deadline - now).InMilliSeconds() + 1 : 1;
+  m_update_deadline = deadline;
+  m_update_timeout = m_scheduler->RegisterSingleTimeout(
+      static_cast<unsigned int>(delay_ms),
+      NewSingleCallback(this, &UniverseStore::RunPendingUpdates));
+}
+
+
+/*
+ * Called when the earliest pending update is due. Sends everything that can
+ * be sent and waits for the next deadline, if any.
+ */
+void UniverseStore::RunPendingUpdates() {
+  m_update_timeout = ola::thread::INVALID_TIMEOUT;
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  SendPendingUpdates(now);
+
+  set<Universe*>::const_iterator iter = m_pending_updates.begin();
+  if (iter == m_pending_updates.end()) {
+    return;
+  }
+  TimeStamp deadline = (*iter)->NextUpdateTime();
+  for (++iter; iter != m_pending_updates.end(); ++iter) {
+    deadline = std::min(deadline, (*iter)->NextUpdateTime());
+  }
+  SchedulePendingUpdates(deadline);
+}
+
+
+/*
+ * Called when the first of a universe's sources may have timed out.
+ */
+void UniverseStore::ExpireSources(Universe *universe) {
+  m_expiry_timeouts.erase(universe);
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  const TimeStamp next_expiry = universe->ExpireSources(now);
+  if (next_expiry.IsSet()) {
+    ScheduleSourceExpiry(universe, next_expiry);
+  }
+}
+
+
+void UniverseStore::CancelSourceExpiry(Universe *universe) {
+  map<Universe*, ola::thread::timeout_id>::iterator iter =
+      m_expiry_timeouts.find(universe);
+  if (iter == m_expiry_timeouts.end()) {
+    return;
+  }
+  m_scheduler->RemoveTimeout(iter->second);
+  m_expiry_timeouts.erase(iter);
+}
+
+
+bool UniverseStore::OpenSnapshot(const string &path) {
+  m_snapshot.reset(UniverseSnapshot::Open(path, SNAPSHOT_SLOTS));
+  if (!m_snapshot.get()) {
+    return false;
+  }
+  OLA_INFO << "Opened DMX snapshot " << path << " with "
+           << m_snapshot->UniverseCount() << " universes";
+  return true;
+}
+
+void UniverseStore::UpdateSnapshot(unsigned int universe_id,
+                                   const DmxBuffer &buffer) {
+  if (!m_snapshot.get()) {
+    return;
+  }
+  m_snapshot->Update(universe_id, buffer);
+  if (m_scheduler && m_snapshot_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_snapshot_timeout = m_scheduler->RegisterSingleTimeout(
+        SNAPSHOT_SYNC_INTERVAL_MS,
+        NewSingleCallback(this, &UniverseStore::SyncSnapshot));
+  }
+}
+
+
+/*
+ * Called a while after the snapshot was updated, so that the disk writes from
+ * a busy universe are batched.
+ */
+void UniverseStore::SyncSnapshot() {
+  m_snapshot_timeout = ola::thread::INVALID_TIMEOUT;
+  if (m_snapshot.get()) {
+    m_snapshot->Sync();
+  }
+}
+
+
+bool UniverseStore::OpenCapture(const string &path) {
+  m_capture.reset(ola::dmx::PcapWriter::Open(path));
+  m_capture_interfaces.clear();
+  if (!m_capture.get()) {
+    return false;
+  }
+  OLA_INFO << "Capturing input to " << path;
+  return true;
+}
+
+
+void UniverseStore::WriteCapture(unsigned int universe_id,
+                                 const DmxBuffer &buffer,
+                                 const TimeStamp &time) {
+  map<unsigned int, unsigned int>::iterator iter =
+      m_capture_interfaces.find(universe_id);
+  if (iter == m_capture_interfaces.end()) {
+    const unsigned int interface_id = m_capture->AddInterface(
+        ola::dmx::PcapWriter::LINKTYPE_DMX,
+        "universe " + IntToString(universe_id));
+    iter = m_capture_interfaces.insert(
+        std::make_pair(universe_id, interface_id)).first;
+  }
+  m_capture->WriteFrame(iter->second, time, DMX512_START_CODE,
+                        buffer.GetRaw(), buffer.Size());
+}
+
+
+void UniverseStore::AddSpanPort(OutputPort *port,
+                                unsigned int first_universe) {
+  for (unsigned int i = 1; i < port->UniverseCount(); i++) {
+    Universe *universe = GetUniverseOrCreate(first_universe + i);
+    if (universe) {
+      universe->AddSpanPort(port, i);
+    }
+  }
+}
+
+
+void UniverseStore::RemoveSpanPort(OutputPort *port,
+                                   unsigned int first_universe) {
+  for (unsigned int i = 1; i < port->UniverseCount(); i++) {
+    Universe *universe = GetUniverse(first_universe + i);
+    if (!universe) {
+      continue;
+    }
+    universe->RemoveSpanPort(port);
+    if (!universe->IsActive()) {
+      AddUniverseGarbageCollection(universe);
+    }
+  }
+}
+
+
+void UniverseStore::ApplySoftPatch(const Universe *universe) {
+  if (m_soft_patch.Empty()) {
+    return;
+  }
+
+  vector<unsigned int> destinations;
+  if (!m_soft_patch.UpdateSource(universe->UniverseId(), universe->GetDMX(),
+                                 &destinations)) {
+    return;
+  }
+
+  vector<unsigned int>::const_iterator iter = destinations.begin();
+  for (; iter != destinations.end(); ++iter) {
+    Universe *destination = GetUniverse(*iter);
+    if (destination) {
+      destination->SetDMX(*m_soft_patch.Output(*iter));
+    }
+  }
+}
+
+
+/*
+ * Load the soft patch routes from the preferences.
+ */
+void UniverseStore::LoadSoftPatch() {
+  vector<string> routes = m_preferences->GetMultipleValue(SOFT_PATCH_KEY);
+  vector<string>::const_iterator iter = routes.begin();
+  for (; iter != routes.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+    SoftPatch::Route route;
+    if (!SoftPatch::ParseRoute(*iter, &route)) {
+      OLA_WARN << "Invalid " << SOFT_PATCH_KEY << " value: " << *iter;
+      continue;
+    }
+    m_soft_patch.AddRoute(route);
+  }
+}
+
 
 /*
  * Restore a universe's settings
  * @param uni  the universe to update
  */
 bool UniverseStore::RestoreUniverseSettings(Universe *universe) const {
-  string key, value;
-  std::ostringstream oss;
-
   if (!universe)
     return 0;
 
-  oss << std::dec << universe->UniverseId();
+  // All the keys for this universe share the same prefix.
+  const string prefix = "uni_" + IntToString(universe->UniverseId()) + "_";
+  string value;
 
   // load name
-  key = "uni_" + oss.str() + "_name";
-  value = m_preferences->GetValue(key);
+  value = m_preferences->GetValue(prefix + "name");
 
   if (!value.empty())
     universe->SetName(value);
 
   // load merge mode
-  key = "uni_" + oss.str() + "_merge";
-  value = m_preferences->GetValue(key);
+  value = m_preferences->GetValue(prefix + "merge");
 
   if (!value.empty()) {
     if (value == "HTP")
@@ -160,58 +533,106 @@ bool UniverseStore::RestoreUniverseSettings(Universe *universe) const {
   }
 
   // load RDM discovery interval
-  key = "uni_" + oss.str() + "_rdm_discovery_interval";
-  value = m_preferences->GetValue(key);
-
-  if (!value.empty()) {
-    unsigned int interval;
-    if (StringToInt(value, &interval, true)) {
-      if (interval != 0 && interval < MINIMUM_RDM_DISCOVERY_INTERVAL) {
-        OLA_WARN << "RDM Discovery interval for universe " <<
-          universe->UniverseId() << " less than the minimum of " <<
-          MINIMUM_RDM_DISCOVERY_INTERVAL;
-        interval = MINIMUM_RDM_DISCOVERY_INTERVAL;
-      }
-      OLA_DEBUG << "RDM Discovery interval for " << oss.str() << " is " <<
-        interval;
-      TimeInterval discovery_interval(interval, 0);
-      universe->SetRDMDiscoveryInterval(discovery_interval);
-    } else {
-      OLA_WARN << "Invalid RDM discovery interval for universe " <<
-        universe->UniverseId() << ", value was " << value;
+  string key = prefix + "rdm_discovery_interval";
+  unsigned int interval;
+  if (m_preferences->GetValueAsUInt(key, &interval)) {
+    if (interval != 0 && interval < MINIMUM_RDM_DISCOVERY_INTERVAL) {
+      OLA_WARN << "RDM Discovery interval for universe " <<
+        universe->UniverseId() << " less than the minimum of " <<
+        MINIMUM_RDM_DISCOVERY_INTERVAL;
+      interval = MINIMUM_RDM_DISCOVERY_INTERVAL;
     }
+    OLA_DEBUG << "RDM Discovery interval for " << universe->UniverseId() <<
+      " is " << interval;
+    TimeInterval discovery_interval(interval, 0);
+    universe->SetRDMDiscoveryInterval(discovery_interval);
+  } else {
+    WarnIfSet(universe, key, "RDM discovery interval");
+  }
+
+  // load the RDM response cache TTL
+  key = prefix + "rdm_cache_ttl";
+  unsigned int ttl;
+  if (m_preferences->GetValueAsUInt(key, &ttl)) {
+    OLA_DEBUG << "RDM cache TTL for " << universe->UniverseId() << " is " <<
+      ttl;
+    universe->SetRDMCacheTTL(TimeInterval(ttl, 0));
+  } else {
+    WarnIfSet(universe, key, "RDM cache TTL");
+  }
+
+  // load the max frame rate
+  key = prefix + "max_frame_rate";
+  unsigned int frame_rate;
+  if (m_preferences->GetValueAsUInt(key, &frame_rate)) {
+    OLA_DEBUG << "Max frame rate for " << universe->UniverseId() << " is " <<
+      frame_rate;
+    universe->SetMaxFrameRate(frame_rate);
+  } else {
+    WarnIfSet(universe, key, "max frame rate");
   }
   return 0;
 }
 
 
+/*
+ * Warn about a universe setting that isn't a valid unsigned int. Missing and
+ * empty settings are ignored.
+ */
+void UniverseStore::WarnIfSet(const Universe *universe, const string &key,
+                              const string &description) const {
+  string value = m_preferences->GetValue(key);
+  if (!value.empty()) {
+    OLA_WARN << "Invalid " << description << " for universe " <<
+      universe->UniverseId() << ", value was " << value;
+  }
+}
+
+
 /*
  * Save this universe's settings.
  * @param universe, the universe to save
  */
 bool UniverseStore::SaveUniverseSettings(Universe *universe) const {
-  string key, mode;
-  std::ostringstream oss;
-
   if (!universe || !m_preferences)
     return 0;
 
-  oss << std::dec << universe->UniverseId();
+  const string prefix = "uni_" + IntToString(universe->UniverseId()) + "_";
 
   // save name
-  key = "uni_" + oss.str() + "_name";
-  m_preferences->SetValue(key, universe->Name());
+  m_preferences->SetValue(prefix + "name", universe->Name());
 
   // save merge mode
-  key = "uni_" + oss.str() + "_merge";
-  mode = (universe->MergeMode() == Universe::MERGE_HTP ? "HTP" : "LTP");
-  m_preferences->SetValue(key, mode);
+  string mode = (universe->MergeMode() == Universe::MERGE_HTP ? "HTP" : "LTP");
+  m_preferences->SetValue(prefix + "merge", mode);
 
-  // We don't save the RDM Discovery interval since it can only be set in the
-  // config files for now.
+  // We don't save the RDM Discovery interval, RDM cache TTL or max frame rate
+  // since they can only be set in the config files for now.
 
   m_preferences->Save();
 
   return 0;
 }
+
+/*
+ * Update the index entry for a universe id. Pages are allocated the first
+ * time a universe in them is created, and kept until we're destroyed.
+ */
+void UniverseStore::SetIndex(unsigned int universe_id, Universe *universe) {
+  unsigned int page = universe_id >> INDEX_PAGE_BITS;
+  if (page >= INDEX_PAGES) {
+    return;
+  }
+
+  Universe **slots = m_index[page];
+  if (!slots) {
+    if (!universe) {
+      return;
+    }
+    slots = new Universe*[INDEX_PAGE_SIZE];
+    std::fill(slots, slots + INDEX_PAGE_SIZE, static_cast<Universe*>(NULL));
+    m_index[page] = slots;
+  }
+  slots[universe_id & (INDEX_PAGE_SIZE - 1)] = universe;
+}
 }  // namespace ola
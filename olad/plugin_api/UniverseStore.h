@@ -21,20 +21,33 @@
 #ifndef OLAD_PLUGIN_API_UNIVERSESTORE_H_
 #define OLAD_PLUGIN_API_UNIVERSESTORE_H_
 
+#include <stdint.h>
+
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "ola/Clock.h"
 #include "ola/base/Macro.h"
+#include "ola/dmx/PcapWriter.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/plugin_api/SoftPatch.h"
+#include "olad/plugin_api/UniverseSnapshot.h"
 
 namespace ola {
 
+class AbstractDevice;
+class OutputPort;
 class Universe;
 
 /**
  * @brief Maintains a collection of Universe objects.
+ *
+ * Universes with ids below 65536 are also held in a two level array index, so
+ * that GetUniverse(), which is called for every DMX update from a client,
+ * doesn't need to walk a tree. Universes with larger ids fall back to the map.
  */
 class UniverseStore {
  public:
@@ -76,6 +89,53 @@ class UniverseStore {
    */
   void GetList(std::vector<Universe*> *universes) const;
 
+  /**
+   * @brief Returns the universes with ids in a range.
+   * @param first the first universe id.
+   * @param last the last universe id, inclusive.
+   * @param[out] universes a pointer to a vector of Universes.
+   */
+  void GetRange(unsigned int first, unsigned int last,
+                std::vector<Universe*> *universes) const;
+
+  /**
+   * @brief The current generation.
+   *
+   * The generation is incremented each time the data for any universe
+   * changes, see Universe::Generation().
+   */
+  uint64_t Generation() const { return m_generation; }
+
+  /**
+   * @brief Increment and return the generation, called by the universes
+   *   when their data changes.
+   */
+  uint64_t NextGeneration() { return ++m_generation; }
+
+  /**
+   * @brief The current info generation.
+   *
+   * The info generation is incremented each time a universe's name, merge
+   * mode, ports or RDM devices change, or a universe is created or removed.
+   */
+  uint64_t InfoGeneration() const { return m_info_generation; }
+
+  /**
+   * @brief Increment and return the info generation, called by a universe
+   *   when its info changes.
+   */
+  uint64_t NextInfoGeneration() { return ++m_info_generation; }
+
+  /**
+   * @brief Find the universes that changed since an info generation.
+   * @param since the info generation.
+   * @param[out] changed the universes that were created or changed.
+   * @param[out] removed the ids of the universes that were removed.
+   */
+  void GetInfoChanges(uint64_t since,
+                      std::vector<Universe*> *changed,
+                      std::vector<unsigned int> *removed) const;
+
   /**
    * @brief Delete all universes.
    */
@@ -87,25 +147,228 @@ class UniverseStore {
    */
   void AddUniverseGarbageCollection(Universe *universe);
 
+  /**
+   * @brief Send the universes after the first to a port which spans
+   *   several universes.
+   * @param port the OutputPort, see OutputPort::UniverseCount().
+   * @param first_universe the universe the port is patched to.
+   *
+   * The universes are created if they don't exist.
+   */
+  void AddSpanPort(OutputPort *port, unsigned int first_universe);
+
+  /**
+   * @brief Stop sending the universes after the first to a port.
+   * @param port the OutputPort.
+   * @param first_universe the universe the port was patched to.
+   */
+  void RemoveSpanPort(OutputPort *port, unsigned int first_universe);
+
   /**
    * @brief Garbage collect any pending universes.
    */
   void GarbageCollectUniverses();
 
+  /**
+   * @brief Set the default maximum frame rate for universes.
+   * @param frame_rate the max frames per second, 0 means no limit.
+   *
+   * This can be overridden on a per-universe basis with the
+   * uni_[id]_max_frame_rate preference.
+   */
+  void SetMaxFrameRate(unsigned int frame_rate);
+
+  /**
+   * @brief Set the minimum time between the frames sent to sink clients.
+   * @param interval the interval, zero sends every frame.
+   *
+   * This is used to shed load when olad is overloaded, the output ports are
+   * still sent every frame. Like DmxSubscription::max_fps, a frame that's
+   * skipped isn't sent later.
+   */
+  void SetSinkInterval(const TimeInterval &interval) {
+    m_sink_interval = interval;
+  }
+
+  /**
+   * @brief Check if a universe's sink clients should be sent a frame.
+   * @param last_sent the time the universe last sent its sink clients a
+   *   frame.
+   * @param now the current time.
+   * @returns false if the frame should be skipped, see SetSinkInterval().
+   */
+  bool SinkUpdateDue(const TimeStamp &last_sent, const TimeStamp &now);
+
+  /**
+   * @brief Set the scheduler used to send pending updates.
+   * @param scheduler the SchedulerInterface to use, ownership is not
+   *   transferred. If this is NULL, universes with a max frame rate send
+   *   every update straight away, since nothing would send a deferred one.
+   */
+  void SetScheduler(ola::thread::SchedulerInterface *scheduler);
+
+  /**
+   * @brief Check if updates held back by a max frame rate will be sent later.
+   * @returns true if a scheduler has been set.
+   */
+  bool CanDeferUpdates() const { return m_scheduler != NULL; }
+
+  /**
+   * @brief Mark a universe as having an update waiting to be sent.
+   * @param universe the Universe with the pending update.
+   *
+   * A single timeout is kept, for the earliest Universe::NextUpdateTime() of
+   * the pending universes.
+   */
+  void AddPendingUpdate(Universe *universe);
+
+  /**
+   * @brief Check a universe's sources for timeouts when one of them expires.
+   * @param universe the Universe with a source which sent data.
+   * @param expiry the time the source times out.
+   *
+   * Each universe has at most one timeout. If one is already scheduled it's
+   * left alone, Universe::ExpireSources() returns the next expiry time when
+   * it runs. This does nothing if there is no scheduler.
+   */
+  void ScheduleSourceExpiry(Universe *universe, const TimeStamp &expiry);
+
+  /**
+   * @brief Send the pending updates for any universes whose frame interval
+   * has passed.
+   * @param now the current time.
+   */
+  void SendPendingUpdates(const TimeStamp &now);
+
+  /**
+   * @brief Start a frame, which may span several universes.
+   *
+   * Frames nest, devices added with AddToFrame() aren't ended until the
+   * outermost frame ends.
+   */
+  void BeginFrame();
+
+  /**
+   * @brief Add a device to the current frame.
+   * @param device the device that is about to be written to. If it's not
+   *   already part of the frame, AbstractDevice::BeginFrame() is called.
+   */
+  void AddToFrame(AbstractDevice *device);
+
+  /**
+   * @brief End a frame.
+   *
+   * If this is the outermost frame, AbstractDevice::EndFrame() is called on
+   * each device that was written to.
+   */
+  void EndFrame();
+
+  /**
+   * @brief Record the last frame sent on each universe in a file.
+   * @param path the path to the snapshot file.
+   * @returns true if the snapshot was opened, false otherwise.
+   *
+   * This should be called before any universes are created. Universes
+   * created afterwards start with, and send to their output ports, the frame
+   * from the snapshot until new data arrives.
+   */
+  bool OpenSnapshot(const std::string &path);
+
+  /**
+   * @brief Record a frame in the snapshot, if there is one.
+   * @param universe_id the universe the frame was sent on.
+   * @param buffer the DMX data.
+   */
+  void UpdateSnapshot(unsigned int universe_id, const DmxBuffer &buffer);
+
+  /**
+   * @brief Record the data received by input ports in a pcapng file.
+   * @param path the path to the capture file, it's replaced if it exists.
+   * @returns true if the capture file was opened, false otherwise.
+   *
+   * Each universe is an interface in the capture.
+   */
+  bool OpenCapture(const std::string &path);
+
+  /**
+   * @brief Record a frame received by an input port, if capturing.
+   * @param universe_id the universe the port is patched to.
+   * @param buffer the DMX data.
+   * @param time the time the frame was received.
+   */
+  void CaptureInput(unsigned int universe_id, const DmxBuffer &buffer,
+                    const TimeStamp &time) {
+    if (m_capture.get()) {
+      WriteCapture(universe_id, buffer, time);
+    }
+  }
+
+  /**
+   * @brief Copy a universe's data to the universes soft patched from it.
+   * @param universe the Universe whose data has changed.
+   *
+   * The soft patch is loaded from the soft_patch preferences, see
+   * SoftPatch::ParseRoute() for the format. The destination universes are
+   * updated with Universe::SetDMX(), so data from their own sources replaces
+   * the patched data until the next change.
+   */
+  void ApplySoftPatch(const Universe *universe);
+
  private:
   typedef std::map<unsigned int, Universe*> UniverseMap;
 
   Preferences *m_preferences;
   ExportMap *m_export_map;
-  UniverseMap m_universe_map;
+  UniverseMap m_universe_map;  // all universes, ordered by id
+  // Pages of INDEX_PAGE_SIZE universe pointers, allocated on demand.
+  std::vector<Universe**> m_index;
   std::set<Universe*> m_deletion_candiates;  // list of universes we may be
                                              // able to delete
+  std::set<Universe*> m_pending_updates;  // universes with unsent data
+  // The timeout to expire the sources of each universe.
+  std::map<Universe*, ola::thread::timeout_id> m_expiry_timeouts;
+  // The devices written to in the current frame, in the order they were added.
+  std::vector<AbstractDevice*> m_frame_devices;
+  unsigned int m_frame_depth;
+  uint64_t m_generation;
+  uint64_t m_info_generation;
+  // The info generation each universe was removed at.
+  std::map<unsigned int, uint64_t> m_removed_universes;
+  unsigned int m_max_frame_rate;
+  TimeInterval m_sink_interval;
+  ola::thread::SchedulerInterface *m_scheduler;
+  ola::thread::timeout_id m_update_timeout;
+  TimeStamp m_update_deadline;
+  std::auto_ptr<UniverseSnapshot> m_snapshot;
+  ola::thread::timeout_id m_snapshot_timeout;
+  std::auto_ptr<ola::dmx::PcapWriter> m_capture;
+  // The capture interface for each universe.
+  std::map<unsigned int, unsigned int> m_capture_interfaces;
+  SoftPatch m_soft_patch;
   Clock m_clock;
 
   bool RestoreUniverseSettings(Universe *universe) const;
   bool SaveUniverseSettings(Universe *universe) const;
+  void WarnIfSet(const Universe *universe, const std::string &key,
+                 const std::string &description) const;
+  void LoadSoftPatch();
+  void SchedulePendingUpdates(const TimeStamp &deadline);
+  void RunPendingUpdates();
+  void ExpireSources(Universe *universe);
+  void CancelSourceExpiry(Universe *universe);
+  void SetIndex(unsigned int universe_id, Universe *universe);
+  void SyncSnapshot();
+  void WriteCapture(unsigned int universe_id, const DmxBuffer &buffer,
+                    const TimeStamp &time);
 
   static const unsigned int MINIMUM_RDM_DISCOVERY_INTERVAL;
+  static const unsigned int INDEX_PAGE_BITS;
+  static const unsigned int INDEX_PAGE_SIZE;
+  static const unsigned int INDEX_PAGES;
+  static const unsigned int SNAPSHOT_SLOTS;
+  static const unsigned int SNAPSHOT_SYNC_INTERVAL_MS;
+  static const char SOFT_PATCH_KEY[];
+  static const char K_SINK_FRAMES_SHED_VAR[];
 
   DISALLOW_COPY_AND_ASSIGN(UniverseStore);
 };
@@ -19,7 +19,13 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -27,10 +33,14 @@
 #include "ola/Constants.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/StringUtils.h"
+#include "ola/io/SelectServer.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMReply.h"
 #include "ola/rdm/RDMResponseCodes.h"
 #include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/DmxSource.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
@@ -38,8 +48,11 @@
 #include "olad/Preferences.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/DuplicateFrameFilter.h"
+#include "olad/plugin_api/OutputCurve.h"
 #include "olad/plugin_api/PortManager.h"
 #include "olad/plugin_api/TestCommon.h"
+#include "olad/plugin_api/UniverseSnapshot.h"
 #include "olad/plugin_api/UniverseStore.h"
 #include "ola/testing/TestUtils.h"
 
@@ -49,6 +62,7 @@ using ola::Clock;
 using ola::DmxBuffer;
 using ola::NewCallback;
 using ola::NewSingleCallback;
+using ola::TimeInterval;
 using ola::TimeStamp;
 using ola::Universe;
 using ola::rdm::NewDiscoveryUniqueBranchRequest;
@@ -59,6 +73,7 @@ using ola::rdm::RDMResponse;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
 using ola::rdm::RDMStatusCode;
+using ola::thread::timeout_id;
 using std::string;
 using std::vector;
 
@@ -69,13 +84,25 @@ static const char TEST_DATA[] = "this is some test data";
 class UniverseTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(UniverseTest);
   CPPUNIT_TEST(testLifecycle);
+  CPPUNIT_TEST(testUniverseIndex);
   CPPUNIT_TEST(testSetGetDmx);
   CPPUNIT_TEST(testSendDmx);
+  CPPUNIT_TEST(testSpanPorts);
+  CPPUNIT_TEST(testMaxFrameRate);
+  CPPUNIT_TEST(testDeviceFrames);
   CPPUNIT_TEST(testReceiveDmx);
+  CPPUNIT_TEST(testCaptureInput);
+  CPPUNIT_TEST(testOutputLatency);
+  CPPUNIT_TEST(testSuppressDuplicates);
+  CPPUNIT_TEST(testRestoreFromSnapshot);
+  CPPUNIT_TEST(testSoftPatch);
   CPPUNIT_TEST(testSourceClients);
   CPPUNIT_TEST(testSinkClients);
   CPPUNIT_TEST(testLtpMerging);
   CPPUNIT_TEST(testHtpMerging);
+  CPPUNIT_TEST(testOutrankedSources);
+  CPPUNIT_TEST(testCounters);
+  CPPUNIT_TEST(testSourceExpiry);
   CPPUNIT_TEST(testRDMDiscovery);
   CPPUNIT_TEST(testRDMSend);
   CPPUNIT_TEST_SUITE_END();
@@ -84,13 +111,25 @@ class UniverseTest: public CppUnit::TestFixture {
   void setUp();
   void tearDown();
   void testLifecycle();
+  void testUniverseIndex();
   void testSetGetDmx();
   void testSendDmx();
+  void testSpanPorts();
+  void testMaxFrameRate();
+  void testDeviceFrames();
   void testReceiveDmx();
+  void testCaptureInput();
+  void testOutputLatency();
+  void testSuppressDuplicates();
+  void testRestoreFromSnapshot();
+  void testSoftPatch();
   void testSourceClients();
   void testSinkClients();
   void testLtpMerging();
   void testHtpMerging();
+  void testOutrankedSources();
+  void testCounters();
+  void testSourceExpiry();
   void testRDMDiscovery();
   void testRDMSend();
 
@@ -135,6 +174,58 @@ class MockClient: public ola::Client {
 };
 
 
+/*
+ * A device that counts its frames.
+ */
+class MockFrameDevice: public MockDevice {
+ public:
+  MockFrameDevice()
+      : MockDevice(NULL, "frames"),
+        begin_count(0),
+        end_count(0),
+        in_frame(false) {
+  }
+
+  void BeginFrame() {
+    OLA_ASSERT_FALSE(in_frame);
+    in_frame = true;
+    begin_count++;
+  }
+
+  void EndFrame() {
+    OLA_ASSERT(in_frame);
+    in_frame = false;
+    end_count++;
+  }
+
+  unsigned int begin_count;
+  unsigned int end_count;
+  bool in_frame;
+};
+
+
+/*
+ * An output port that takes several universes.
+ */
+class MockSpanPort: public TestMockOutputPort {
+ public:
+  explicit MockSpanPort(unsigned int universes)
+      : TestMockOutputPort(NULL, 1),
+        universes(universes) {
+  }
+
+  unsigned int UniverseCount() const { return universes; }
+
+  bool WriteSpanDMX(unsigned int index, const DmxBuffer &buffer, uint8_t) {
+    span_data[index] = buffer;
+    return true;
+  }
+
+  const unsigned int universes;
+  std::map<unsigned int, DmxBuffer> span_data;
+};
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(UniverseTest);
 
 
@@ -191,6 +282,48 @@ void UniverseTest::testLifecycle() {
 }
 
 
+/*
+ * Check lookups work across index pages and for ids beyond the index.
+ */
+void UniverseTest::testUniverseIndex() {
+  const unsigned int ids[] = {0, 255, 256, 65535, 65536, 4000000000u};
+  const unsigned int id_count = sizeof(ids) / sizeof(ids[0]);
+
+  // Create them in reverse, GetList() should still be ordered by id.
+  for (unsigned int i = id_count; i > 0; i--) {
+    Universe *universe = m_store->GetUniverseOrCreate(ids[i - 1]);
+    OLA_ASSERT(universe);
+    OLA_ASSERT_EQ(universe, m_store->GetUniverseOrCreate(ids[i - 1]));
+  }
+  OLA_ASSERT_EQ(id_count, m_store->UniverseCount());
+
+  vector<Universe*> universes;
+  m_store->GetList(&universes);
+  OLA_ASSERT_EQ(static_cast<size_t>(id_count), universes.size());
+  for (unsigned int i = 0; i < id_count; i++) {
+    OLA_ASSERT_EQ(ids[i], universes[i]->UniverseId());
+    OLA_ASSERT_EQ(universes[i], m_store->GetUniverse(ids[i]));
+  }
+  OLA_ASSERT_NULL(m_store->GetUniverse(1));
+  OLA_ASSERT_NULL(m_store->GetUniverse(65537));
+  OLA_ASSERT_NULL(m_store->GetUniverse(4000000001u));
+
+  // Garbage collection removes universes from the index.
+  m_store->AddUniverseGarbageCollection(universes[1]);
+  m_store->AddUniverseGarbageCollection(universes[5]);
+  m_store->GarbageCollectUniverses();
+  OLA_ASSERT_EQ(id_count - 2, m_store->UniverseCount());
+  OLA_ASSERT_NULL(m_store->GetUniverse(255));
+  OLA_ASSERT_NULL(m_store->GetUniverse(4000000000u));
+  OLA_ASSERT_EQ(universes[2], m_store->GetUniverse(256));
+
+  m_store->DeleteAll();
+  for (unsigned int i = 0; i < id_count; i++) {
+    OLA_ASSERT_NULL(m_store->GetUniverse(ids[i]));
+  }
+}
+
+
 /*
  * Check that SetDMX/GetDMX works
  */
@@ -208,6 +341,94 @@ void UniverseTest::testSetGetDmx() {
 }
 
 
+/*
+ * Check that outputs are restored from the snapshot after a restart.
+ */
+void UniverseTest::testRestoreFromSnapshot() {
+  if (!ola::UniverseSnapshot::IsSupported()) {
+    return;
+  }
+
+  std::ostringstream str;
+  str << "/tmp/ola-universe-snapshot-test-" << getpid();
+  const string path = str.str();
+  unlink(path.c_str());
+
+  {
+    ola::UniverseStore store(NULL, NULL);
+    OLA_ASSERT_TRUE(store.OpenSnapshot(path));
+    Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+    OLA_ASSERT(universe);
+    TestMockOutputPort port(NULL, 1);
+    universe->AddPort(&port);
+    OLA_ASSERT(universe->SetDMX(m_buffer));
+    universe->RemovePort(&port);
+  }
+
+  ola::UniverseStore store(NULL, NULL);
+  OLA_ASSERT_TRUE(store.OpenSnapshot(path));
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  OLA_ASSERT(m_buffer == universe->GetDMX());
+
+  // The restored frame is written to ports as they're patched.
+  TestMockOutputPort port(NULL, 1);
+  universe->AddPort(&port);
+  OLA_ASSERT(m_buffer == port.ReadDMX());
+
+  // Once new data arrives, ports added later don't get the restored frame.
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(universe->SetDMX(buffer));
+  OLA_ASSERT(buffer == port.ReadDMX());
+  TestMockOutputPort port2(NULL, 2);
+  universe->AddPort(&port2);
+  OLA_ASSERT_EQ(0u, port2.ReadDMX().Size());
+
+  // Universes that weren't in the snapshot start empty.
+  Universe *universe2 = store.GetUniverseOrCreate(TEST_UNIVERSE + 1);
+  OLA_ASSERT_EQ(0u, universe2->GetDMX().Size());
+
+  universe->RemovePort(&port);
+  universe->RemovePort(&port2);
+  unlink(path.c_str());
+}
+
+
+/*
+ * Check the soft patch copies data to the destination universes.
+ */
+void UniverseTest::testSoftPatch() {
+  ola::MemoryPreferences preferences("soft-patch");
+  preferences.SetMultipleValue("soft_patch", "1:2 10:1 2");
+  preferences.SetMultipleValue("soft_patch", "1:1 11:3");
+  preferences.SetMultipleValue("soft_patch", "not a route");
+  ola::UniverseStore store(&preferences, NULL);
+
+  Universe *source = store.GetUniverseOrCreate(1);
+  Universe *destination1 = store.GetUniverseOrCreate(10);
+  Universe *destination2 = store.GetUniverseOrCreate(11);
+  TestMockOutputPort port(NULL, 1);
+  destination1->AddPort(&port);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  OLA_ASSERT(source->SetDMX(buffer));
+  OLA_ASSERT_EQ(string("2,3"), destination1->GetDMX().ToString());
+  OLA_ASSERT_EQ(string("2,3"), port.ReadDMX().ToString());
+  OLA_ASSERT_EQ(string("0,0,1"), destination2->GetDMX().ToString());
+
+  // Only the destinations that read the changed slots are updated.
+  destination2->SetDMX(DmxBuffer("x"));
+  buffer.SetFromString("1,2,5,4");
+  OLA_ASSERT(source->SetDMX(buffer));
+  OLA_ASSERT_EQ(string("2,5"), destination1->GetDMX().ToString());
+  OLA_ASSERT_EQ(string("x"), destination2->GetDMX().Get());
+
+  destination1->RemovePort(&port);
+}
+
+
 /*
  * Check that SendDmx updates all ports
  */
@@ -225,6 +446,20 @@ void UniverseTest::testSendDmx() {
   OLA_ASSERT(universe->SetDMX(m_buffer));
   OLA_ASSERT(m_buffer == port.ReadDMX());
 
+  // a port with a curve gets the corrected data, the universe is unchanged
+  TestMockOutputPort curve_port(NULL, 2);
+  curve_port.SetOutputCurve(ola::OutputCurve::FromString("square"));
+  universe->AddPort(&curve_port);
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(m_buffer == port.ReadDMX());
+  OLA_ASSERT(m_buffer == universe->GetDMX());
+  OLA_ASSERT_EQ(m_buffer.Size(), curve_port.ReadDMX().Size());
+  const ola::OutputCurve *curve = curve_port.GetOutputCurve();
+  for (unsigned int i = 0; i < m_buffer.Size(); i++) {
+    OLA_ASSERT_EQ(curve->Lookup(m_buffer.Get(i)), curve_port.ReadDMX().Get(i));
+  }
+  universe->RemovePort(&curve_port);
+
   // remove the port from the universe
   universe->RemovePort(&port);
   OLA_ASSERT_EQ((unsigned int) 0, universe->InputPortCount());
@@ -233,6 +468,247 @@ void UniverseTest::testSendDmx() {
 }
 
 
+/*
+ * Check a port that spans several universes is sent each of them.
+ */
+void UniverseTest::testSpanPorts() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  MockSpanPort port(3);
+  universe->AddPort(&port);
+
+  // The following universes are created, and stay active while the port is
+  // patched.
+  OLA_ASSERT_EQ(3u, m_store->UniverseCount());
+  Universe *second = m_store->GetUniverse(TEST_UNIVERSE + 1);
+  Universe *third = m_store->GetUniverse(TEST_UNIVERSE + 2);
+  OLA_ASSERT_NOT_NULL(second);
+  OLA_ASSERT_NOT_NULL(third);
+  OLA_ASSERT_EQ(1u, second->SpanPortCount());
+  OLA_ASSERT_EQ(0u, second->OutputPortCount());
+  OLA_ASSERT_TRUE(third->IsActive());
+
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(m_buffer == port.ReadDMX());
+  OLA_ASSERT_TRUE(port.span_data.empty());
+
+  DmxBuffer data;
+  data.SetFromString("1,2,3");
+  OLA_ASSERT(third->SetDMX(data));
+  OLA_ASSERT_EQ(static_cast<size_t>(1), port.span_data.size());
+  OLA_ASSERT(data == port.span_data[2]);
+
+  universe->RemovePort(&port);
+  OLA_ASSERT_EQ(0u, second->SpanPortCount());
+  OLA_ASSERT_FALSE(third->IsActive());
+  m_store->GarbageCollectUniverses();
+  OLA_ASSERT_NULL(m_store->GetUniverse(TEST_UNIVERSE + 2));
+}
+
+
+/*
+ * A scheduler that holds on to a single timeout until Fire() is called.
+ */
+class FakeScheduler: public ola::thread::SchedulerInterface {
+ public:
+  FakeScheduler() : m_registrations(0), m_repeating_registrations(0) {}
+
+  timeout_id RegisterRepeatingTimeout(unsigned int,
+                                      ola::Callback0<bool> *callback) {
+    delete callback;
+    m_repeating_registrations++;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  timeout_id RegisterRepeatingTimeout(const TimeInterval&,
+                                      ola::Callback0<bool> *callback) {
+    delete callback;
+    m_repeating_registrations++;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  timeout_id RegisterSingleTimeout(unsigned int delay,
+                                   ola::SingleUseCallback0<void> *callback) {
+    return RegisterSingleTimeout(TimeInterval(0, delay * 1000), callback);
+  }
+
+  timeout_id RegisterSingleTimeout(const TimeInterval &delay,
+                                   ola::SingleUseCallback0<void> *callback) {
+    OLA_ASSERT_NULL(m_callback.get());
+    m_delay = delay;
+    m_callback.reset(callback);
+    m_registrations++;
+    return &m_callback;
+  }
+
+  void RemoveTimeout(timeout_id id) {
+    OLA_ASSERT_EQ(static_cast<timeout_id>(&m_callback), id);
+    m_callback.reset();
+  }
+
+  void Fire() {
+    OLA_ASSERT_NOT_NULL(m_callback.get());
+    m_callback.release()->Run();
+  }
+
+  bool Registered() const { return m_callback.get() != NULL; }
+  const TimeInterval &Delay() const { return m_delay; }
+  unsigned int Registrations() const { return m_registrations; }
+  unsigned int RepeatingRegistrations() const {
+    return m_repeating_registrations;
+  }
+
+ private:
+  std::auto_ptr<ola::SingleUseCallback0<void> > m_callback;
+  TimeInterval m_delay;
+  unsigned int m_registrations;
+  unsigned int m_repeating_registrations;
+};
+
+
+/*
+ * Check that updates are coalesced when a max frame rate is set.
+ */
+void UniverseTest::testMaxFrameRate() {
+  FakeScheduler scheduler;
+  m_store->SetScheduler(&scheduler);
+
+  m_preferences->SetValue("uni_2_max_frame_rate", "40");
+  Universe *universe = m_store->GetUniverseOrCreate(2);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_EQ(40u, universe->MaxFrameRate());
+
+  universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_EQ(0u, universe->MaxFrameRate());
+  universe->SetMaxFrameRate(1);
+
+  TestMockOutputPort port(NULL, 1);  // output port
+  universe->AddPort(&port);
+
+  // the first frame is sent straight away
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(m_buffer == port.ReadDMX());
+  OLA_ASSERT_FALSE(universe->UpdatePending());
+
+  // subsequent frames are held until the interval passes
+  DmxBuffer buffer1, buffer2;
+  buffer1.SetFromString("1,2,3");
+  buffer2.SetFromString("4,5,6");
+  OLA_ASSERT(universe->SetDMX(buffer1));
+  OLA_ASSERT(universe->SetDMX(buffer2));
+  OLA_ASSERT(m_buffer == port.ReadDMX());
+  OLA_ASSERT(universe->UpdatePending());
+
+  // a single timeout is registered for when the frame interval is up
+  OLA_ASSERT(scheduler.Registered());
+  OLA_ASSERT_EQ(1u, scheduler.Registrations());
+  OLA_ASSERT_EQ(0u, scheduler.RepeatingRegistrations());
+  OLA_ASSERT(scheduler.Delay() > TimeInterval(0, 900000));
+  OLA_ASSERT(scheduler.Delay() <= TimeInterval(1, 1000));
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  m_store->SendPendingUpdates(now);
+  OLA_ASSERT(m_buffer == port.ReadDMX());
+  OLA_ASSERT(universe->UpdatePending());
+
+  m_store->SendPendingUpdates(now + ola::TimeInterval(2, 0));
+  OLA_ASSERT(buffer2 == port.ReadDMX());
+  OLA_ASSERT_FALSE(universe->UpdatePending());
+
+  // with nothing left to send, the timeout isn't registered again
+  scheduler.Fire();
+  OLA_ASSERT_FALSE(scheduler.Registered());
+  OLA_ASSERT_EQ(1u, scheduler.Registrations());
+
+  // a timeout that runs before the frame is due waits for the deadline again
+  OLA_ASSERT(universe->SetDMX(buffer1));
+  OLA_ASSERT(universe->UpdatePending());
+  OLA_ASSERT_EQ(2u, scheduler.Registrations());
+  scheduler.Fire();
+  OLA_ASSERT(universe->UpdatePending());
+  OLA_ASSERT(scheduler.Registered());
+  OLA_ASSERT_EQ(3u, scheduler.Registrations());
+  OLA_ASSERT(scheduler.Delay() > TimeInterval(0, 900000));
+
+  // removing the limit sends anything that is pending
+  universe->SetMaxFrameRate(0);
+  OLA_ASSERT(buffer1 == port.ReadDMX());
+  OLA_ASSERT_FALSE(universe->UpdatePending());
+  OLA_ASSERT_EQ(0u, scheduler.RepeatingRegistrations());
+
+  // without a scheduler nothing would send a held frame, so it isn't held
+  m_store->SetScheduler(NULL);
+  OLA_ASSERT_FALSE(scheduler.Registered());
+  universe->SetMaxFrameRate(1);
+  OLA_ASSERT(universe->SetDMX(buffer2));
+  OLA_ASSERT(buffer2 == port.ReadDMX());
+  OLA_ASSERT(universe->SetDMX(buffer1));
+  OLA_ASSERT(buffer1 == port.ReadDMX());
+  OLA_ASSERT_FALSE(universe->UpdatePending());
+
+  universe->RemovePort(&port);
+}
+
+
+/*
+ * Check that a device's output ports are written within a single frame.
+ */
+void UniverseTest::testDeviceFrames() {
+  FakeScheduler scheduler;
+  m_store->SetScheduler(&scheduler);
+  MockFrameDevice device;
+  TestMockOutputPort port1(&device, 1);
+  TestMockOutputPort port2(&device, 2);
+  TestMockOutputPort port3(&device, 3);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->AddPort(&port1);
+  universe->AddPort(&port2);
+
+  // both ports of the universe share a frame
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(m_buffer == port1.ReadDMX());
+  OLA_ASSERT(m_buffer == port2.ReadDMX());
+  OLA_ASSERT_EQ(1u, device.begin_count);
+  OLA_ASSERT_EQ(1u, device.end_count);
+
+  // pending updates for several universes are sent in one frame
+  Universe *universe2 = m_store->GetUniverseOrCreate(TEST_UNIVERSE + 1);
+  OLA_ASSERT(universe2);
+  universe2->AddPort(&port3);
+  universe->SetMaxFrameRate(1);
+  universe2->SetMaxFrameRate(1);
+  OLA_ASSERT(universe2->SetDMX(m_buffer));
+  OLA_ASSERT_EQ(2u, device.begin_count);
+  OLA_ASSERT_EQ(2u, device.end_count);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(universe->SetDMX(buffer));
+  OLA_ASSERT(universe2->SetDMX(buffer));
+  OLA_ASSERT(universe->UpdatePending());
+  OLA_ASSERT(universe2->UpdatePending());
+  OLA_ASSERT_EQ(2u, device.begin_count);
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  m_store->SendPendingUpdates(now + ola::TimeInterval(2, 0));
+  OLA_ASSERT(buffer == port1.ReadDMX());
+  OLA_ASSERT(buffer == port2.ReadDMX());
+  OLA_ASSERT(buffer == port3.ReadDMX());
+  OLA_ASSERT_EQ(3u, device.begin_count);
+  OLA_ASSERT_EQ(3u, device.end_count);
+  OLA_ASSERT_FALSE(device.in_frame);
+
+  universe->RemovePort(&port1);
+  universe->RemovePort(&port2);
+  universe2->RemovePort(&port3);
+  m_store->SetScheduler(NULL);
+}
+
+
 /*
  * Check that we update when ports have new data
  */
@@ -271,6 +747,149 @@ void UniverseTest::testReceiveDmx() {
 }
 
 
+/*
+ * Check the data from input ports is written to the capture file.
+ */
+void UniverseTest::testCaptureInput() {
+  std::ostringstream str;
+  str << "/tmp/ola-universe-capture-test-" << getpid();
+  const string path = str.str();
+
+  {
+    ola::UniverseStore store(NULL, NULL);
+    OLA_ASSERT_TRUE(store.OpenCapture(path));
+    ola::PortBroker broker;
+    ola::PortManager port_manager(&store, &broker);
+    TimeStamp time_stamp;
+    MockSelectServer ss(&time_stamp);
+    ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+
+    MockDevice device(NULL, "foo");
+    TestMockInputPort port(&device, 1, &plugin_adaptor);
+    port_manager.PatchPort(&port, TEST_UNIVERSE);
+    m_clock.CurrentTime(&time_stamp);
+    port.WriteDMX(m_buffer);
+    port.DmxChanged();
+    port.DmxChanged();
+    port_manager.UnPatchPort(&port);
+  }
+
+  // The capture has the section header, an interface for the universe, and
+  // the two frames, which start with the DMX start code.
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  const string capture((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  string frame(1, static_cast<char>(ola::DMX512_START_CODE));
+  frame.append(reinterpret_cast<const char*>(m_buffer.GetRaw()),
+               m_buffer.Size());
+  const string::size_type first = capture.find(frame);
+  OLA_ASSERT_NE(string::npos, first);
+  OLA_ASSERT_NE(string::npos, capture.find(frame, first + 1));
+  OLA_ASSERT_NE(string::npos, capture.find("universe 1"));
+  unlink(path.c_str());
+}
+
+
+/*
+ * Check the latency from ingress to output is recorded.
+ */
+void UniverseTest::testOutputLatency() {
+  ola::ExportMap export_map;
+  ola::UniverseStore store(m_preferences, &export_map);
+  ola::PortBroker broker;
+  ola::PortManager port_manager(&store, &broker);
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+
+  TestMockPlugin plugin(&plugin_adaptor, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "foo");
+  TestMockInputPort input_port(&device, 1, &plugin_adaptor);
+  TestMockOutputPort output_port(&device, 1);
+  port_manager.PatchPort(&input_port, TEST_UNIVERSE);
+  port_manager.PatchPort(&output_port, TEST_UNIVERSE);
+
+  ola::HistogramVariable *universe_latency = export_map.GetHistogramMapVar(
+      Universe::K_UNIVERSE_OUTPUT_LATENCY_VAR, "",
+      vector<uint64_t>())->Get(ola::IntToString(TEST_UNIVERSE));
+  ola::HistogramVariable *plugin_latency = export_map.GetHistogramMapVar(
+      Universe::K_PLUGIN_OUTPUT_LATENCY_VAR, "",
+      vector<uint64_t>())->Get(plugin.Name());
+  OLA_ASSERT_EQ((uint64_t) 0, universe_latency->Count());
+
+  // The data arrived 5ms ago.
+  m_clock.CurrentTime(&time_stamp);
+  TimeStamp ingress_time = time_stamp - ola::TimeInterval(0, 5000);
+  input_port.WriteDMX(m_buffer);
+  input_port.DmxChangedAt(ingress_time);
+  OLA_ASSERT(m_buffer == output_port.ReadDMX());
+
+  OLA_ASSERT_EQ((uint64_t) 1, universe_latency->Count());
+  OLA_ASSERT_TRUE(universe_latency->Sum() >= 5000);
+  OLA_ASSERT_EQ((uint64_t) 1, plugin_latency->Count());
+  OLA_ASSERT_TRUE(plugin_latency->Sum() >= universe_latency->Sum());
+
+  // Without an ingress time, the time the event loop woke up is used.
+  input_port.DmxChanged();
+  OLA_ASSERT_EQ((uint64_t) 2, universe_latency->Count());
+
+  port_manager.UnPatchPort(&input_port);
+  port_manager.UnPatchPort(&output_port);
+}
+
+
+/*
+ * Check that unchanged frames are suppressed for ports with a filter.
+ */
+void UniverseTest::testSuppressDuplicates() {
+  ola::ExportMap export_map;
+  ola::UniverseStore store(m_preferences, &export_map);
+  Universe *universe = store.GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device(&plugin, "foo");
+  TestMockOutputPort port(&device, 1);
+  TestMockOutputPort filtered_port(&device, 2);
+  // Long enough that the refresh never happens during the test.
+  filtered_port.SetDuplicateFrameFilter(
+      new ola::DuplicateFrameFilter(ola::TimeInterval(60, 0)));
+  const ola::DuplicateFrameFilter *filter =
+      filtered_port.GetDuplicateFrameFilter();
+  universe->AddPort(&port);
+  universe->AddPort(&filtered_port);
+
+  const unsigned int &suppressed = (*export_map.GetUIntMapVar(
+      Universe::K_PORT_SUPPRESSED_FRAMES_VAR))[filtered_port.UniqueId()];
+
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(m_buffer == filtered_port.ReadDMX());
+  OLA_ASSERT_EQ(0u, filter->SuppressedFrames());
+
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT(universe->SetDMX(m_buffer));
+  OLA_ASSERT_EQ(2u, filter->SuppressedFrames());
+  OLA_ASSERT_EQ(2u, suppressed);
+
+  // A change is always written, and ports without a filter get every frame.
+  DmxBuffer changed;
+  changed.SetFromString("1,2,3");
+  OLA_ASSERT(universe->SetDMX(changed));
+  OLA_ASSERT(changed == filtered_port.ReadDMX());
+  OLA_ASSERT(changed == port.ReadDMX());
+  OLA_ASSERT_EQ(2u, filter->SuppressedFrames());
+
+  // Repatching the port writes the current data again.
+  universe->RemovePort(&filtered_port);
+  universe->AddPort(&filtered_port);
+  OLA_ASSERT(universe->SetDMX(changed));
+  OLA_ASSERT_EQ(2u, filter->SuppressedFrames());
+
+  universe->RemovePort(&port);
+  universe->RemovePort(&filtered_port);
+}
+
+
 /*
  * Check that we can add/remove source clients from this universes
  */
@@ -521,6 +1140,175 @@ void UniverseTest::testHtpMerging() {
 }
 
 
+/*
+ * Check that data from a lower priority source is ignored until the higher
+ * priority sources go away.
+ */
+void UniverseTest::testOutrankedSources() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+
+  DmxBuffer main_buffer, backup_buffer;
+  main_buffer.SetFromString("1,2,3");
+  backup_buffer.SetFromString("4,5,6");
+  const uint8_t main_priority = 150;
+  const uint8_t backup_priority = 100;
+
+  TimeStamp time_stamp;
+  m_clock.CurrentTime(&time_stamp);
+  MockClient main_client, backup_client;
+  main_client.DMXReceived(
+      TEST_UNIVERSE, ola::DmxSource(main_buffer, time_stamp, main_priority));
+  universe->SourceClientDataChanged(&main_client);
+  OLA_ASSERT_EQ(main_priority, universe->ActivePriority());
+  OLA_ASSERT(main_buffer == universe->GetDMX());
+
+  // The backup is outranked.
+  backup_client.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(backup_buffer, time_stamp, backup_priority));
+  universe->SourceClientDataChanged(&backup_client);
+  OLA_ASSERT_EQ(main_priority, universe->ActivePriority());
+  OLA_ASSERT(main_buffer == universe->GetDMX());
+
+  // Lowering the priority of the main source makes it outranked.
+  main_client.DMXReceived(
+      TEST_UNIVERSE, ola::DmxSource(main_buffer, time_stamp, 50));
+  universe->SourceClientDataChanged(&main_client);
+  backup_client.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(backup_buffer, time_stamp, backup_priority));
+  universe->SourceClientDataChanged(&backup_client);
+  OLA_ASSERT_EQ(backup_priority, universe->ActivePriority());
+  OLA_ASSERT(backup_buffer == universe->GetDMX());
+
+  // Once the backup has gone, the main source takes over.
+  universe->RemoveSourceClient(&backup_client);
+  universe->SourceClientDataChanged(&main_client);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(50), universe->ActivePriority());
+  OLA_ASSERT(main_buffer == universe->GetDMX());
+
+  universe->RemoveSourceClient(&main_client);
+  OLA_ASSERT_FALSE(universe->IsActive());
+}
+
+
+/*
+ * Check the input, output and priority counters.
+ */
+void UniverseTest::testCounters() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  OLA_ASSERT_EQ(0u, universe->ActiveSourceCount());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0),
+                universe->GetCounters().input_frames);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  TimeStamp time_stamp;
+  m_clock.CurrentTime(&time_stamp);
+  MockClient main_client, backup_client;
+  main_client.DMXReceived(
+      TEST_UNIVERSE, ola::DmxSource(buffer, time_stamp, 150));
+  universe->SourceClientDataChanged(&main_client);
+
+  // An outranked source is counted as input, but doesn't cause output.
+  backup_client.DMXReceived(
+      TEST_UNIVERSE, ola::DmxSource(buffer, time_stamp, 100));
+  universe->SourceClientDataChanged(&backup_client);
+  OLA_ASSERT_EQ(2u, universe->ActiveSourceCount());
+
+  const Universe::Counters &counters = universe->GetCounters();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), counters.output_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), counters.priority_changes);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), counters.interval_count);
+  OLA_ASSERT_TRUE(counters.interval_sum_squares >=
+                  counters.interval_sum * counters.interval_sum);
+
+  // The main source drops below the backup, which takes over.
+  main_client.DMXReceived(
+      TEST_UNIVERSE, ola::DmxSource(buffer, time_stamp, 50));
+  universe->SourceClientDataChanged(&main_client);
+  universe->SourceClientDataChanged(&backup_client);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(4), counters.input_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.output_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.priority_changes);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), counters.interval_count);
+
+  // Output at the same priority isn't a change.
+  universe->SourceClientDataChanged(&backup_client);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), counters.output_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(2), counters.priority_changes);
+
+  universe->RemoveSourceClient(&backup_client);
+  OLA_ASSERT_EQ(1u, universe->ActiveSourceCount());
+  universe->RemoveSourceClient(&main_client);
+}
+
+
+/*
+ * Check that sources are removed once they time out, and the remaining
+ * sources take over.
+ */
+void UniverseTest::testSourceExpiry() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+
+  DmxBuffer main_buffer, backup_buffer;
+  main_buffer.SetFromString("1,2,3");
+  backup_buffer.SetFromString("4,5,6");
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  const TimeStamp later = now + TimeInterval(1, 0);
+  MockClient main_client, backup_client;
+  main_client.DMXReceived(TEST_UNIVERSE,
+                          ola::DmxSource(main_buffer, now, 150));
+  universe->SourceClientDataChanged(&main_client);
+  backup_client.DMXReceived(TEST_UNIVERSE,
+                            ola::DmxSource(backup_buffer, later, 100));
+  universe->SourceClientDataChanged(&backup_client);
+  OLA_ASSERT(main_buffer == universe->GetDMX());
+
+  // Nothing has timed out yet.
+  TimeStamp next_expiry = universe->ExpireSources(now + TimeInterval(2, 0));
+  OLA_ASSERT_EQ(2u, universe->SourceClientCount());
+  OLA_ASSERT_EQ(now + TimeInterval(2, 500000), next_expiry);
+
+  // The main source times out, so the backup takes over.
+  next_expiry = universe->ExpireSources(next_expiry);
+  OLA_ASSERT_EQ(1u, universe->SourceClientCount());
+  OLA_ASSERT_FALSE(universe->ContainsSourceClient(&main_client));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), universe->ActivePriority());
+  OLA_ASSERT(backup_buffer == universe->GetDMX());
+  OLA_ASSERT_EQ(later + TimeInterval(2, 500000), next_expiry);
+
+  // Once all the sources have gone, the data is held.
+  next_expiry = universe->ExpireSources(next_expiry);
+  OLA_ASSERT_EQ(0u, universe->SourceClientCount());
+  OLA_ASSERT_FALSE(next_expiry.IsSet());
+  OLA_ASSERT(backup_buffer == universe->GetDMX());
+  OLA_ASSERT_FALSE(universe->IsActive());
+
+  // With a scheduler, the store expires the sources when they time out.
+  ola::io::SelectServer ss;
+  m_store->SetScheduler(&ss);
+  m_clock.CurrentTime(&now);
+  main_client.DMXReceived(
+      TEST_UNIVERSE,
+      ola::DmxSource(main_buffer, now - TimeInterval(2, 450000), 150));
+  universe->SourceClientDataChanged(&main_client);
+  OLA_ASSERT_EQ(1u, universe->SourceClientCount());
+
+  ss.RegisterSingleTimeout(
+      500, NewSingleCallback(&ss, &ola::io::SelectServer::Terminate));
+  ss.Run();
+  OLA_ASSERT_EQ(0u, universe->SourceClientCount());
+  m_store->SetScheduler(NULL);
+}
+
+
 /**
  * Test RDM discovery for a universe/
  */
@@ -143,3 +143,28 @@ dist_bootfonts_DATA = \
     olad/www/new/libs/bootstrap/fonts/glyphicons-halflings-regular.woff2
 dist_bootcss_DATA = \
     olad/www/new/libs/bootstrap/css/bootstrap.min.css
+
+# The text assets, these are installed with a gzip copy which olad serves to
+# clients that accept it.
+www_compressed_files = \
+    $(dist_www_DATA) $(dist_new_DATA) $(dist_views_DATA) $(dist_js_DATA) \
+    $(dist_css_DATA) $(dist_jquery_DATA) $(dist_angularroute_DATA) \
+    $(dist_angular_DATA) $(dist_marked_DATA) $(dist_angularmarked_DATA) \
+    $(dist_bootjs_DATA) $(dist_bootcss_DATA)
+
+install-data-hook-www:
+	for file in $(www_compressed_files); do \
+	  case $$file in \
+	    *.css|*.html|*.js|*.map) \
+	      gzip -9 -n -c $(srcdir)/$$file > \
+	        $(DESTDIR)$(www_datadir)/$${file#olad/www/}.gz ;; \
+	  esac; \
+	done
+
+uninstall-hook-www:
+	for file in $(www_compressed_files); do \
+	  rm -f $(DESTDIR)$(www_datadir)/$${file#olad/www/}.gz; \
+	done
+
+INSTALL_DATA_HOOKS += install-data-hook-www
+UNINSTALL_HOOKS += uninstall-hook-www
@@ -36,6 +36,7 @@
 #include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/NetworkUtils.h"
+#include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
 #include "olad/Preferences.h"
@@ -58,17 +59,26 @@ using std::vector;
 
 const char ArtNetDevice::K_ALWAYS_BROADCAST_KEY[] = "always_broadcast";
 const char ArtNetDevice::K_DEVICE_NAME[] = "ArtNet";
+const char ArtNetDevice::K_HOLD_FOR_SYNC_KEY[] = "hold_for_sync";
+const char ArtNetDevice::K_INPUT_PORT_KEY[] = "input_ports";
 const char ArtNetDevice::K_IP_KEY[] = "ip";
 const char ArtNetDevice::K_LIMITED_BROADCAST_KEY[] = "use_limited_broadcast";
 const char ArtNetDevice::K_LONG_NAME_KEY[] = "long_name";
 const char ArtNetDevice::K_LOOPBACK_KEY[] = "use_loopback";
+const char ArtNetDevice::K_MAX_MERGE_SOURCES_KEY[] = "max_merge_sources";
 const char ArtNetDevice::K_NET_KEY[] = "net";
 const char ArtNetDevice::K_OUTPUT_PORT_KEY[] = "output_ports";
+const char ArtNetDevice::K_RDM_MAX_IN_FLIGHT_KEY[] = "rdm_max_in_flight";
+const char ArtNetDevice::K_SEND_SYNC_KEY[] = "send_sync";
 const char ArtNetDevice::K_SHORT_NAME_KEY[] = "short_name";
 const char ArtNetDevice::K_SUBNET_KEY[] = "subnet";
+const char ArtNetDevice::K_VIRTUAL_NODES_KEY[] = "virtual_nodes";
 const unsigned int ArtNetDevice::K_ARTNET_NET = 0;
 const unsigned int ArtNetDevice::K_ARTNET_SUBNET = 0;
+const unsigned int ArtNetDevice::K_DEFAULT_INPUT_PORT_COUNT = 4;
+const unsigned int ArtNetDevice::K_DEFAULT_MAX_MERGE_SOURCES = 2;
 const unsigned int ArtNetDevice::K_DEFAULT_OUTPUT_PORT_COUNT = 4;
+const unsigned int ArtNetDevice::K_DEFAULT_RDM_MAX_IN_FLIGHT = 1;
 
 ArtNetDevice::ArtNetDevice(AbstractPlugin *owner,
                            ola::Preferences *preferences,
@@ -87,9 +97,15 @@ bool ArtNetDevice::StartHook() {
   unsigned int net = StringToIntOrDefault(
       m_preferences->GetValue(K_NET_KEY), K_ARTNET_NET);
 
+  // Use olad's cached interfaces if we can.
   ola::network::Interface iface;
-  auto_ptr<ola::network::InterfacePicker> picker(
-      ola::network::InterfacePicker::NewPicker());
+  auto_ptr<ola::network::InterfacePicker> our_picker;
+  ola::network::InterfacePicker *picker =
+      m_plugin_adaptor->GetInterfaceMonitor();
+  if (!picker) {
+    our_picker.reset(ola::network::InterfacePicker::NewPicker());
+    picker = our_picker.get();
+  }
   ola::network::InterfacePicker::Options options;
   options.include_loopback = m_preferences->GetValueAsBool(K_LOOPBACK_KEY);
   if (!picker->ChooseInterface(&iface,
@@ -104,10 +120,25 @@ bool ArtNetDevice::StartHook() {
       K_ALWAYS_BROADCAST_KEY);
   node_options.use_limited_broadcast_address = m_preferences->GetValueAsBool(
       K_LIMITED_BROADCAST_KEY);
+  node_options.send_sync = m_preferences->GetValueAsBool(K_SEND_SYNC_KEY);
+  node_options.hold_for_sync = m_preferences->GetValueAsBool(
+      K_HOLD_FOR_SYNC_KEY);
   // OLA Output ports are ArtNet input ports
   node_options.input_port_count = StringToIntOrDefault(
       m_preferences->GetValue(K_OUTPUT_PORT_KEY),
       K_DEFAULT_OUTPUT_PORT_COUNT);
+  // OLA Input ports are ArtNet output ports
+  node_options.output_port_count = StringToIntOrDefault(
+      m_preferences->GetValue(K_INPUT_PORT_KEY),
+      K_DEFAULT_INPUT_PORT_COUNT);
+  node_options.virtual_nodes = m_preferences->GetValueAsBool(
+      K_VIRTUAL_NODES_KEY);
+  node_options.max_merge_sources = StringToIntOrDefault(
+      m_preferences->GetValue(K_MAX_MERGE_SOURCES_KEY),
+      K_DEFAULT_MAX_MERGE_SOURCES);
+  node_options.rdm_max_in_flight = StringToIntOrDefault(
+      m_preferences->GetValue(K_RDM_MAX_IN_FLIGHT_KEY),
+      K_DEFAULT_RDM_MAX_IN_FLIGHT);
 
   m_node = new ArtNetNode(iface, m_plugin_adaptor, node_options);
   m_node->SetNetAddress(net);
@@ -119,7 +150,7 @@ bool ArtNetDevice::StartHook() {
     AddPort(new ArtNetOutputPort(this, i, m_node));
   }
 
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
+  for (unsigned int i = 0; i < node_options.output_port_count; i++) {
     AddPort(new ArtNetInputPort(this, i, m_plugin_adaptor, m_node));
   }
 
@@ -134,6 +165,11 @@ bool ArtNetDevice::StartHook() {
   str << K_DEVICE_NAME << " [" << iface.ip_address << "]";
   SetName(str.str());
 
+  m_socket_monitor.reset(new UDPSocketMonitor(
+      m_plugin_adaptor, m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences)));
+  m_socket_monitor->AddSocket(m_node->GetSocket());
+
   m_timeout_id = m_plugin_adaptor->RegisterRepeatingTimeout(
       POLL_INTERVAL,
       NewCallback(m_node, &ArtNetNode::SendPoll));
@@ -145,6 +181,10 @@ void ArtNetDevice::PrePortStop() {
     m_plugin_adaptor->RemoveTimeout(m_timeout_id);
     m_timeout_id = ola::thread::INVALID_TIMEOUT;
   }
+  if (m_socket_monitor.get()) {
+    m_socket_monitor->RemoveSocket(m_node->GetSocket());
+    m_socket_monitor.reset();
+  }
   m_node->Stop();
 }
 
@@ -153,6 +193,12 @@ void ArtNetDevice::PostPortStop() {
   m_node = NULL;
 }
 
+void ArtNetDevice::EndFrame() {
+  if (m_node) {
+    m_node->FlushSync();
+  }
+}
+
 void ArtNetDevice::Configure(RpcController *controller,
                              const string &request,
                              string *response,
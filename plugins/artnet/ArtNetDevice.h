@@ -31,9 +31,11 @@
 #ifndef PLUGINS_ARTNET_ARTNETDEVICE_H_
 #define PLUGINS_ARTNET_ARTNETDEVICE_H_
 
+#include <memory>
 #include <string>
 
 #include "olad/Device.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/artnet/messages/ArtNetConfigMessages.pb.h"
 #include "plugins/artnet/ArtNetNode.h"
 
@@ -59,6 +61,12 @@ class ArtNetDevice: public Device {
   void EnterConfigurationMode() { m_node->EnterConfigurationMode(); }
   void ExitConfigurationMode() { m_node->ExitConfigurationMode(); }
 
+  const ola::network::Interface &GetInterface() const {
+    return m_node->GetInterface();
+  }
+
+  size_t MemoryUsage() { return m_node ? m_node->MemoryUsage() : 0; }
+
   /**
    * Handle device config messages
    * @param controller An RpcController
@@ -71,19 +79,33 @@ class ArtNetDevice: public Device {
                  std::string *response,
                  ConfigureCallback *done);
 
+  /**
+   * Send the ArtSync as soon as the data for all the ports has been sent.
+   */
+  void EndFrame();
+
   static const char K_ALWAYS_BROADCAST_KEY[];
   static const char K_DEVICE_NAME[];
+  static const char K_HOLD_FOR_SYNC_KEY[];
+  static const char K_INPUT_PORT_KEY[];
   static const char K_IP_KEY[];
   static const char K_LIMITED_BROADCAST_KEY[];
   static const char K_LONG_NAME_KEY[];
   static const char K_LOOPBACK_KEY[];
+  static const char K_MAX_MERGE_SOURCES_KEY[];
   static const char K_NET_KEY[];
   static const char K_OUTPUT_PORT_KEY[];
+  static const char K_RDM_MAX_IN_FLIGHT_KEY[];
+  static const char K_SEND_SYNC_KEY[];
   static const char K_SHORT_NAME_KEY[];
   static const char K_SUBNET_KEY[];
+  static const char K_VIRTUAL_NODES_KEY[];
   static const unsigned int K_ARTNET_NET;
   static const unsigned int K_ARTNET_SUBNET;
+  static const unsigned int K_DEFAULT_INPUT_PORT_COUNT;
+  static const unsigned int K_DEFAULT_MAX_MERGE_SOURCES;
   static const unsigned int K_DEFAULT_OUTPUT_PORT_COUNT;
+  static const unsigned int K_DEFAULT_RDM_MAX_IN_FLIGHT;
   // 10s between polls when we're sending data, DMX-workshop uses 8s;
   static const unsigned int POLL_INTERVAL = 10000;
 
@@ -109,6 +131,7 @@ class ArtNetDevice: public Device {
   ArtNetNode *m_node;
   class PluginAdaptor *m_plugin_adaptor;
   ola::thread::timeout_id m_timeout_id;
+  std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
 
   /**
    * Handle an options request
@@ -75,6 +75,8 @@ using std::vector;
 
 
 const char ArtNetNodeImpl::ARTNET_ID[] = "Art-Net";
+const unsigned int ArtNetNodeImpl::PORT_ADDRESS_COUNT;
+const uint16_t ArtNetNodeImpl::NO_PORT;
 
 
 // UID to the IP Address it came from, and the number of times since we last
@@ -85,13 +87,11 @@ typedef map<UID, std::pair<IPV4Address, uint8_t> > uid_map;
 class ArtNetNodeImpl::InputPort {
  public:
   InputPort()
-      : enabled(false),
+      : net(0),
+        enabled(false),
         sequence_number(0),
         discovery_callback(NULL),
         discovery_timeout(ola::thread::INVALID_TIMEOUT),
-        rdm_request_callback(NULL),
-        pending_request(NULL),
-        rdm_send_timeout(ola::thread::INVALID_TIMEOUT),
         m_port_address(0),
         m_tod_callback(NULL) {
   }
@@ -105,13 +105,70 @@ class ArtNetNodeImpl::InputPort {
     }
 
     m_port_address = ((m_port_address & 0xf0) | universe_address);
-    uids.clear();
-    subscribed_nodes.clear();
+    ClearTod();
+    ClearSubscribedNodes();
     return true;
   }
 
   void ClearSubscribedNodes() {
     subscribed_nodes.clear();
+    destinations.clear();
+  }
+
+  void ClearTod() {
+    uids.clear();
+    tod_nodes.clear();
+  }
+
+  // Returns true if every node for this port has sent a complete TOD since
+  // the threshold.
+  bool HasCachedTod(const TimeStamp &threshold) const {
+    if (subscribed_nodes.empty()) {
+      return false;
+    }
+    map<IPV4Address, TimeStamp>::const_iterator iter =
+        subscribed_nodes.begin();
+    for (; iter != subscribed_nodes.end(); ++iter) {
+      map<IPV4Address, TimeStamp>::const_iterator tod_iter =
+          tod_nodes.find(iter->first);
+      if (tod_iter == tod_nodes.end() || tod_iter->second < threshold) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void UpdateSubscribedNode(const IPV4Address &address,
+                            const TimeStamp &now) {
+    pair<map<IPV4Address, TimeStamp>::iterator, bool> result =
+        subscribed_nodes.insert(std::make_pair(address, now));
+    if (result.second) {
+      destinations.push_back(address);
+    } else {
+      result.first->second = now;
+    }
+  }
+
+  void ExpireSubscribedNodes(const TimeStamp &last_heard_threshold) {
+    bool removed = false;
+    map<IPV4Address, TimeStamp>::iterator iter = subscribed_nodes.begin();
+    while (iter != subscribed_nodes.end()) {
+      if (iter->second < last_heard_threshold) {
+        tod_nodes.erase(iter->first);
+        subscribed_nodes.erase(iter++);
+        removed = true;
+      } else {
+        ++iter;
+      }
+    }
+
+    if (removed) {
+      destinations.clear();
+      for (iter = subscribed_nodes.begin(); iter != subscribed_nodes.end();
+           ++iter) {
+        destinations.push_back(iter->first);
+      }
+    }
   }
 
   // Returns true if the address changed.
@@ -122,8 +179,8 @@ class ArtNetNodeImpl::InputPort {
     }
 
     m_port_address = subnet_address | (m_port_address & 0x0f);
-    uids.clear();
-    subscribed_nodes.clear();
+    ClearTod();
+    ClearSubscribedNodes();
     return true;
   }
 
@@ -157,10 +214,28 @@ class ArtNetNodeImpl::InputPort {
     }
   }
 
+  // Returns true if the net changed.
+  bool SetNet(uint8_t net_address) {
+    if (net == net_address) {
+      return false;
+    }
+    net = net_address;
+    ClearTod();
+    ClearSubscribedNodes();
+    return true;
+  }
+
+  uint8_t net;
   bool enabled;
   uint8_t sequence_number;
+  // The nodes that have sent an ArtPollReply for this port's address, and
+  // when we last heard from them.
   map<IPV4Address, TimeStamp> subscribed_nodes;
+  // The subscribed nodes in the order they were added, used for sending.
+  vector<IPV4Address> destinations;
   uid_map uids;  // used to keep track of the UIDs
+  // When each node last sent a complete TOD for this port.
+  map<IPV4Address, TimeStamp> tod_nodes;
   // NULL if discovery isn't running, otherwise the callback to run when it
   // finishes
   RDMDiscoveryCallback *discovery_callback;
@@ -168,13 +243,16 @@ class ArtNetNodeImpl::InputPort {
   set<IPV4Address> discovery_node_set;
   // the timeout_id for the discovery timer
   ola::thread::timeout_id discovery_timeout;
-  // the in-flight request and it's callback
-  RDMCallback *rdm_request_callback;
-  const RDMRequest *pending_request;
-  IPV4Address rdm_ip_destination;
-
-  // these control the sending of RDM requests.
-  ola::thread::timeout_id rdm_send_timeout;
+  // A request that is waiting for a response.
+  struct PendingRDMRequest {
+    const RDMRequest *request;
+    RDMCallback *callback;
+    IPV4Address destination;
+    ola::thread::timeout_id timeout;
+  };
+  // The in-flight requests, by destination UID. There can be one request for
+  // each UID.
+  map<UID, PendingRDMRequest> pending_requests;
 
  private:
   uint8_t m_port_address;
@@ -199,6 +277,7 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
                                ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_net_address(0),
+      m_subnet_address(0),
       m_send_reply_on_change(true),
       m_short_name(""),
       m_long_name(""),
@@ -207,9 +286,16 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
       m_ss(ss),
       m_always_broadcast(options.always_broadcast),
       m_use_limited_broadcast_address(options.use_limited_broadcast_address),
+      m_virtual_nodes(options.virtual_nodes),
+      m_send_sync(options.send_sync),
+      m_hold_for_sync(options.hold_for_sync),
+      m_max_merge_sources(std::max(options.max_merge_sources, 1u)),
+      m_sync_timeout(ola::thread::INVALID_TIMEOUT),
+      m_expiry_timeout(ola::thread::INVALID_TIMEOUT),
       m_in_configuration_mode(false),
       m_artpoll_required(false),
       m_artpollreply_required(false),
+      m_output_port_table(PORT_ADDRESS_COUNT, NO_PORT),
       m_interface(iface),
       m_socket(socket) {
 
@@ -222,18 +308,23 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
   }
 
   // reset all the port structures
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    m_output_ports[i].universe_address = 0;
-    m_output_ports[i].sequence_number = 0;
-    m_output_ports[i].enabled = false;
-    m_output_ports[i].is_merging = false;
-    m_output_ports[i].merge_mode = ARTNET_MERGE_HTP;
-    m_output_ports[i].buffer = NULL;
-    m_output_ports[i].on_data = NULL;
-    m_output_ports[i].on_discover = NULL;
-    m_output_ports[i].on_flush = NULL;
-    m_output_ports[i].on_rdm_request = NULL;
-  }
+  for (unsigned int i = 0; i < options.output_port_count; i++) {
+    m_output_ports.push_back(new OutputPort());
+    m_output_ports[i]->net = 0;
+    m_output_ports[i]->universe_address = 0;
+    m_output_ports[i]->sequence_number = 0;
+    m_output_ports[i]->enabled = false;
+    m_output_ports[i]->is_merging = false;
+    m_output_ports[i]->merge_mode = ARTNET_MERGE_HTP;
+    m_output_ports[i]->buffer = NULL;
+    m_output_ports[i]->sync_pending = false;
+    m_output_ports[i]->on_data = NULL;
+    m_output_ports[i]->on_discover = NULL;
+    m_output_ports[i]->on_flush = NULL;
+    m_output_ports[i]->on_rdm_request = NULL;
+    m_output_ports[i]->next_port = NO_PORT;
+  }
+  UpdatePortAddresses();
 }
 
 ArtNetNodeImpl::~ArtNetNodeImpl() {
@@ -241,20 +332,21 @@ ArtNetNodeImpl::~ArtNetNodeImpl() {
 
   STLDeleteElements(&m_input_ports);
 
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    if (m_output_ports[i].on_data) {
-      delete m_output_ports[i].on_data;
+  for (unsigned int i = 0; i < m_output_ports.size(); i++) {
+    if (m_output_ports[i]->on_data) {
+      delete m_output_ports[i]->on_data;
     }
-    if (m_output_ports[i].on_discover) {
-      delete m_output_ports[i].on_discover;
+    if (m_output_ports[i]->on_discover) {
+      delete m_output_ports[i]->on_discover;
     }
-    if (m_output_ports[i].on_flush) {
-      delete m_output_ports[i].on_flush;
+    if (m_output_ports[i]->on_flush) {
+      delete m_output_ports[i]->on_flush;
     }
-    if (m_output_ports[i].on_rdm_request) {
-      delete m_output_ports[i].on_rdm_request;
+    if (m_output_ports[i]->on_rdm_request) {
+      delete m_output_ports[i]->on_rdm_request;
     }
   }
+  STLDeleteElements(&m_output_ports);
 }
 
 bool ArtNetNodeImpl::Start() {
@@ -262,6 +354,9 @@ bool ArtNetNodeImpl::Start() {
     return false;
   }
 
+  m_expiry_timeout = m_ss->RegisterRepeatingTimeout(
+      SUBSCRIBER_EXPIRY_INTERVAL_MS,
+      NewCallback(this, &ArtNetNodeImpl::ExpireSubscribedNodes));
   m_running = true;
   return true;
 }
@@ -285,21 +380,25 @@ bool ArtNetNodeImpl::Stop() {
     port->RunDiscoveryCallback();
 
     // clean up request state
-    if (port->rdm_send_timeout != ola::thread::INVALID_TIMEOUT) {
-      m_ss->RemoveTimeout(port->rdm_send_timeout);
-      port->rdm_send_timeout = ola::thread::INVALID_TIMEOUT;
+    map<UID, InputPort::PendingRDMRequest> pending_requests;
+    pending_requests.swap(port->pending_requests);
+    map<UID, InputPort::PendingRDMRequest>::iterator pending_iter =
+        pending_requests.begin();
+    for (; pending_iter != pending_requests.end(); ++pending_iter) {
+      m_ss->RemoveTimeout(pending_iter->second.timeout);
+      delete pending_iter->second.request;
+      RunRDMCallback(pending_iter->second.callback, ola::rdm::RDM_TIMEOUT);
     }
+  }
 
-    if (port->pending_request) {
-      delete port->pending_request;
-      port->pending_request = NULL;
-    }
+  if (m_sync_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_sync_timeout);
+    m_sync_timeout = ola::thread::INVALID_TIMEOUT;
+  }
 
-    if (port->rdm_request_callback) {
-      RDMCallback *callback = port->rdm_request_callback;
-      port->rdm_request_callback = NULL;
-      RunRDMCallback(callback, ola::rdm::RDM_TIMEOUT);
-    }
+  if (m_expiry_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_expiry_timeout);
+    m_expiry_timeout = ola::thread::INVALID_TIMEOUT;
   }
 
   m_ss->RemoveReadDescriptor(m_socket.get());
@@ -362,6 +461,7 @@ bool ArtNetNodeImpl::SetNetAddress(uint8_t net_address) {
   }
 
   m_net_address = net_address;
+  UpdatePortAddresses();
 
   bool input_ports_enabled = false;
   vector<InputPort*>::iterator iter = m_input_ports.begin();
@@ -377,31 +477,23 @@ bool ArtNetNodeImpl::SetNetAddress(uint8_t net_address) {
 }
 
 bool ArtNetNodeImpl::SetSubnetAddress(uint8_t subnet_address) {
-  // Set for all input ports.
-  bool changed = false;
+  subnet_address = subnet_address & 0x0f;
+  if (subnet_address == m_subnet_address) {
+    return true;
+  }
+  m_subnet_address = subnet_address;
+
+  // Set for all ports.
+  bool changed = UpdatePortAddresses();
   bool input_ports_enabled = false;
   vector<InputPort*>::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
     input_ports_enabled |= (*iter)->enabled;
-    changed |= (*iter)->SetSubNetAddress(subnet_address);
   }
 
   if (input_ports_enabled && changed) {
     SendPollIfAllowed();
   }
-
-  // set for all output ports.
-  uint8_t old_address = m_output_ports[0].universe_address >> 4;
-  if (old_address == subnet_address && !changed) {
-    return true;
-  }
-
-  subnet_address = subnet_address << 4;
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    m_output_ports[i].universe_address = subnet_address |
-        (m_output_ports[i].universe_address & 0x0f);
-  }
-
   return SendPollReplyIfRequired();
 }
 
@@ -409,6 +501,42 @@ uint8_t ArtNetNodeImpl::InputPortCount() const {
   return m_input_ports.size();
 }
 
+uint8_t ArtNetNodeImpl::OutputPortCount() const {
+  return m_output_ports.size();
+}
+
+size_t ArtNetNodeImpl::MemoryUsage() const {
+  // Buffers which hold data each reference a frame from the DmxBuffer pool.
+  size_t bytes = STLVectorMemoryUsage(m_output_port_table) +
+      STLVectorMemoryUsage(m_send_batch);
+
+  InputPorts::const_iterator input_iter = m_input_ports.begin();
+  for (; input_iter != m_input_ports.end(); ++input_iter) {
+    const InputPort *port = *input_iter;
+    bytes += sizeof(*port) +
+        STLNodeMemoryUsage(port->subscribed_nodes) +
+        STLVectorMemoryUsage(port->destinations) +
+        STLNodeMemoryUsage(port->uids) +
+        STLNodeMemoryUsage(port->tod_nodes);
+  }
+
+  OutputPorts::const_iterator output_iter = m_output_ports.begin();
+  for (; output_iter != m_output_ports.end(); ++output_iter) {
+    const OutputPort *port = *output_iter;
+    bytes += sizeof(*port) +
+        STLNodeMemoryUsage(port->sources) +
+        STLNodeMemoryUsage(port->uid_map) +
+        (port->sync_buffer.Size() ? DMX_UNIVERSE_SIZE : 0);
+    DMXSourceMap::const_iterator source_iter = port->sources.begin();
+    for (; source_iter != port->sources.end(); ++source_iter) {
+      if (source_iter->second.buffer.Size()) {
+        bytes += DMX_UNIVERSE_SIZE;
+      }
+    }
+  }
+  return bytes;
+}
+
 bool ArtNetNodeImpl::SetInputPortUniverse(uint8_t port_id,
                                           uint8_t universe_id) {
   InputPort *port = GetInputPort(port_id);
@@ -429,6 +557,11 @@ uint8_t ArtNetNodeImpl::GetInputPortUniverse(uint8_t port_id) const {
   return port ? port->PortAddress() : 0;
 }
 
+uint8_t ArtNetNodeImpl::GetInputPortNet(uint8_t port_id) const {
+  const InputPort *port = GetInputPort(port_id);
+  return port ? port->net : 0;
+}
+
 void ArtNetNodeImpl::DisableInputPort(uint8_t port_id) {
   InputPort *port = GetInputPort(port_id);
   bool was_enabled = false;
@@ -461,6 +594,7 @@ bool ArtNetNodeImpl::SetOutputPortUniverse(uint8_t port_id,
   port->universe_address = (
       (universe_id & 0x0f) | (port->universe_address & 0xf0));
   port->enabled = true;
+  RebuildOutputPortTable();
   return SendPollReplyIfRequired();
 }
 
@@ -469,6 +603,11 @@ uint8_t ArtNetNodeImpl::GetOutputPortUniverse(uint8_t port_id) {
   return port ? port->universe_address : 0;
 }
 
+uint8_t ArtNetNodeImpl::GetOutputPortNet(uint8_t port_id) const {
+  const OutputPort *port = GetOutputPort(port_id);
+  return port ? port->net : 0;
+}
+
 void ArtNetNodeImpl::DisableOutputPort(uint8_t port_id) {
   OutputPort *port = GetOutputPort(port_id);
   if (!port) {
@@ -478,6 +617,7 @@ void ArtNetNodeImpl::DisableOutputPort(uint8_t port_id) {
   bool was_enabled = port->enabled;
   port->enabled = false;
   if (was_enabled) {
+    RebuildOutputPortTable();
     SendPollReplyIfRequired();
   }
 }
@@ -544,7 +684,7 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
   packet.data.dmx.sequence = port->sequence_number;
   packet.data.dmx.physical = port_id;
   packet.data.dmx.universe = port->PortAddress();
-  packet.data.dmx.net = m_net_address;
+  packet.data.dmx.net = port->net;
 
   unsigned int buffer_size = buffer.Size();
   buffer.Get(packet.data.dmx.data, &buffer_size);
@@ -570,20 +710,9 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
         m_interface.bcast_address);
     port->sequence_number++;
   } else {
-    map<IPV4Address, TimeStamp>::iterator iter = port->subscribed_nodes.begin();
-    TimeStamp last_heard_threshold = (
-        *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
-    while (iter != port->subscribed_nodes.end()) {
-      // if this node has timed out, remove it from the set
-      if (iter->second < last_heard_threshold) {
-        port->subscribed_nodes.erase(iter++);
-        continue;
-      }
-      sent_ok |= SendPacket(packet, size, iter->first);
-      ++iter;
-    }
+    sent_ok = SendPacketToNodes(packet, size, port->destinations);
 
-    if (port->subscribed_nodes.empty()) {
+    if (port->destinations.empty()) {
       OLA_DEBUG << "Suppressing data transmit due to no active nodes for "
                    "universe "
                 << static_cast<int>(port->PortAddress());
@@ -597,9 +726,24 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
   if (!sent_ok) {
     OLA_WARN << "Failed to send ArtNet DMX packet";
   }
+
+  // The sync is sent once control returns to the event loop, after the data
+  // for all the ports has been sent, or by FlushSync() at the end of a frame.
+  if (m_send_sync && m_sync_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_sync_timeout = m_ss->RegisterSingleTimeout(
+        0, NewSingleCallback(this, &ArtNetNodeImpl::SendSync));
+  }
   return sent_ok;
 }
 
+void ArtNetNodeImpl::FlushSync() {
+  if (m_sync_timeout == ola::thread::INVALID_TIMEOUT) {
+    return;
+  }
+  m_ss->RemoveTimeout(m_sync_timeout);
+  SendSync();
+}
+
 void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
                                       RDMDiscoveryCallback *callback) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtTodControl");
@@ -613,12 +757,15 @@ void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
     return;
   }
 
+  // The nodes will run discovery again, so the cached TODs are out of date.
+  port->tod_nodes.clear();
+
   OLA_DEBUG << "Sending ArtTodControl";
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_TODCONTROL);
   memset(&packet.data.tod_control, 0, sizeof(packet.data.tod_control));
   packet.data.tod_control.version = HostToNetwork(ARTNET_VERSION);
-  packet.data.tod_control.net = m_net_address;
+  packet.data.tod_control.net = port->net;
   packet.data.tod_control.command = TOD_FLUSH_COMMAND;
   packet.data.tod_control.address = port->PortAddress();
   unsigned int size = sizeof(packet.data.tod_control);
@@ -637,6 +784,18 @@ void ArtNetNodeImpl::RunIncrementalDiscovery(
     return;
   }
 
+  // Nodes send an ArtTodData when their TOD changes, so if every node has
+  // sent one recently there's no need to ask again.
+  if (!port->discovery_callback &&
+      port->HasCachedTod(*m_ss->WakeUpTime() -
+                         TimeInterval(RDM_TOD_CACHE_TIMEOUT, 0))) {
+    OLA_DEBUG << "Using the cached TOD for address "
+              << static_cast<int>(port->PortAddress());
+    port->discovery_callback = callback;
+    port->RunDiscoveryCallback();
+    return;
+  }
+
   if (!StartDiscoveryProcess(port, callback)) {
     return;
   }
@@ -647,7 +806,7 @@ void ArtNetNodeImpl::RunIncrementalDiscovery(
   PopulatePacketHeader(&packet, ARTNET_TODREQUEST);
   memset(&packet.data.tod_request, 0, sizeof(packet.data.tod_request));
   packet.data.tod_request.version = HostToNetwork(ARTNET_VERSION);
-  packet.data.tod_request.net = m_net_address;
+  packet.data.tod_request.net = port->net;
   packet.data.tod_request.address_count = 1;  // only one universe address
   packet.data.tod_request.addresses[0] = port->PortAddress();
   unsigned int size = sizeof(packet.data.tod_request);
@@ -671,14 +830,15 @@ void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
     return;
   }
 
-  if (port->rdm_request_callback) {
-    OLA_FATAL << "Previous request hasn't completed yet, dropping request";
+  const UID uid_destination = request->DestinationUID();
+  if (STLContains(port->pending_requests, uid_destination)) {
+    OLA_FATAL << "Previous request to " << uid_destination
+              << " hasn't completed yet, dropping request";
     RunRDMCallback(on_complete, ola::rdm::RDM_FAILED_TO_SEND);
     return;
   }
 
-  port->rdm_ip_destination = m_interface.bcast_address;
-  const UID &uid_destination = request->DestinationUID();
+  IPV4Address destination = m_interface.bcast_address;
   uid_map::const_iterator iter = port->uids.find(uid_destination);
   if (iter == port->uids.end()) {
     if (!uid_destination.IsBroadcast()) {
@@ -686,23 +846,23 @@ void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
                << " in the uid map, broadcasting packet";
     }
   } else {
-    port->rdm_ip_destination = iter->second.first;
+    destination = iter->second.first;
   }
 
-  port->rdm_request_callback = on_complete;
-  port->pending_request = request.release();
-  bool r = SendRDMCommand(*port->pending_request,
-                          port->rdm_ip_destination,
+  bool r = SendRDMCommand(*request, destination, port->net,
                           port->PortAddress());
 
   if (r && !uid_destination.IsBroadcast()) {
-    port->rdm_send_timeout = m_ss->RegisterSingleTimeout(
+    InputPort::PendingRDMRequest &pending =
+        port->pending_requests[uid_destination];
+    pending.request = request.release();
+    pending.callback = on_complete;
+    pending.destination = destination;
+    pending.timeout = m_ss->RegisterSingleTimeout(
       RDM_REQUEST_TIMEOUT_MS,
-      ola::NewSingleCallback(this, &ArtNetNodeImpl::TimeoutRDMRequest, port));
+      ola::NewSingleCallback(this, &ArtNetNodeImpl::TimeoutRDMRequest, port,
+                             uid_destination));
   } else {
-    delete port->pending_request;
-    port->pending_request = NULL;
-    port->rdm_request_callback = NULL;
     RunRDMCallback(
         on_complete,
         uid_destination.IsBroadcast() ? ola::rdm::RDM_WAS_BROADCAST :
@@ -748,7 +908,7 @@ bool ArtNetNodeImpl::SetDMXHandler(uint8_t port_id,
   }
 
   if (port->on_data) {
-    delete m_output_ports[port_id].on_data;
+    delete m_output_ports[port_id]->on_data;
   }
   port->buffer = buffer;
   port->on_data = on_data;
@@ -767,8 +927,8 @@ bool ArtNetNodeImpl::SendTod(uint8_t port_id, const UIDSet &uid_set) {
   memset(&packet.data.tod_data, 0, sizeof(packet.data.tod_data));
   packet.data.tod_data.version = HostToNetwork(ARTNET_VERSION);
   packet.data.tod_data.rdm_version = RDM_VERSION;
-  packet.data.tod_data.port = 1 + port_id;
-  packet.data.tod_request.net = m_net_address;
+  packet.data.tod_data.port = 1 + port_id % ARTNET_MAX_PORTS;
+  packet.data.tod_request.net = port->net;
   packet.data.tod_data.address = port->universe_address;
   uint16_t uids = std::min(uid_set.Size(),
                            (unsigned int) MAX_UIDS_PER_UNIVERSE);
@@ -850,18 +1010,35 @@ bool ArtNetNodeImpl::SendTimeCode(const ola::timecode::TimeCode &timecode) {
   return true;
 }
 
-void ArtNetNodeImpl::SocketReady() {
+void ArtNetNodeImpl::SendSync() {
+  m_sync_timeout = ola::thread::INVALID_TIMEOUT;
+
   artnet_packet packet;
-  ssize_t packet_size = sizeof(packet);
-  ola::network::IPV4SocketAddress source;
+  PopulatePacketHeader(&packet, ARTNET_SYNC);
+  memset(&packet.data.sync, 0, sizeof(packet.data.sync));
+  packet.data.sync.version = HostToNetwork(ARTNET_VERSION);
 
-  if (!m_socket->RecvFrom(reinterpret_cast<uint8_t*>(&packet),
-                          &packet_size,
-                          &source)) {
-    return;
+  if (!SendPacket(packet,
+                  sizeof(packet.data.sync),
+                  m_use_limited_broadcast_address ?
+                  IPV4Address::Broadcast() :
+                  m_interface.bcast_address)) {
+    OLA_INFO << "Failed to send ArtSync";
   }
+}
 
-  HandlePacket(source.Host(), packet, packet_size);
+void ArtNetNodeImpl::SocketReady() {
+  artnet_packet packets[RECV_BATCH_SIZE];
+  ola::network::UDPDatagram datagrams[RECV_BATCH_SIZE];
+  for (unsigned int i = 0; i < RECV_BATCH_SIZE; i++) {
+    datagrams[i].data = reinterpret_cast<uint8_t*>(&packets[i]);
+    datagrams[i].length = sizeof(packets[i]);
+  }
+
+  unsigned int received = m_socket->RecvBatch(datagrams, RECV_BATCH_SIZE);
+  for (unsigned int i = 0; i < received; i++) {
+    HandlePacket(datagrams[i].address.Host(), packets[i], datagrams[i].length);
+  }
 }
 
 bool ArtNetNodeImpl::SendPollIfAllowed() {
@@ -890,14 +1067,26 @@ bool ArtNetNodeImpl::SendPollReplyIfRequired() {
 }
 
 bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
+  bool ok = true;
+  for (unsigned int page = 0; page < PageCount(); page++) {
+    ok &= SendPollReplyPage(destination, page);
+  }
+  return ok;
+}
+
+bool ArtNetNodeImpl::SendPollReplyPage(const IPV4Address &destination,
+                                       unsigned int page) {
+  const uint16_t page_address = PageAddress(page);
+  const unsigned int first_port = page * ARTNET_MAX_PORTS;
+
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_REPLY);
   memset(&packet.data.reply, 0, sizeof(packet.data.reply));
 
   m_interface.ip_address.Get(packet.data.reply.ip);
   packet.data.reply.port = HostToLittleEndian(ARTNET_PORT);
-  packet.data.reply.net_address = m_net_address;
-  packet.data.reply.subnet_address = m_output_ports[0].universe_address >> 4;
+  packet.data.reply.net_address = page_address >> 4;
+  packet.data.reply.subnet_address = page_address & 0x0f;
   packet.data.reply.oem = HostToNetwork(OEM_CODE);
   packet.data.reply.status1 = 0xd2;  // normal indicators, rdm enabled
   packet.data.reply.esta_id = HostToLittleEndian(OPEN_LIGHTING_ESTA_CODE);
@@ -910,18 +1099,34 @@ bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
   str << "#0001 [" << m_unsolicited_replies << "] OLA";
   CopyToFixedLengthBuffer(str.str(), packet.data.reply.node_report,
                           arraysize(packet.data.reply.node_report));
-  packet.data.reply.number_ports[1] = ARTNET_MAX_PORTS;
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    InputPort *iport = GetInputPort(i, false);
-    packet.data.reply.port_types[i] = iport ? 0xc0 : 0x80;
+  unsigned int port_count = ARTNET_MAX_PORTS;
+  if (m_virtual_nodes) {
+    port_count = std::min(
+        static_cast<unsigned int>(ARTNET_MAX_PORTS),
+        static_cast<unsigned int>(
+            std::max(m_input_ports.size(), m_output_ports.size())) -
+        first_port);
+    packet.data.reply.bind_index = static_cast<uint8_t>(page + 1);
+  }
+  packet.data.reply.number_ports[1] = static_cast<uint8_t>(port_count);
+  for (unsigned int i = 0; i < port_count; i++) {
+    const unsigned int port_id = first_port + i;
+    InputPort *iport = port_id < m_input_ports.size() ?
+        m_input_ports[port_id] : NULL;
+    OutputPort *oport = port_id < m_output_ports.size() ?
+        m_output_ports[port_id] : NULL;
+    packet.data.reply.port_types[i] = ((iport ? 0x40 : 0x00) |
+                                       (oport ? 0x80 : 0x00));
     packet.data.reply.good_input[i] = iport && iport->enabled ? 0x0 : 0x8;
     packet.data.reply.sw_in[i] = iport ? iport->PortAddress() : 0;
 
-    packet.data.reply.good_output[i] = (
-        (m_output_ports[i].enabled ? 0x80 : 0x00) |
-        (m_output_ports[i].merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
-        (m_output_ports[i].is_merging ? 0x8 : 0x0));
-    packet.data.reply.sw_out[i] = m_output_ports[i].universe_address;
+    if (oport) {
+      packet.data.reply.good_output[i] = (
+          (oport->enabled ? 0x80 : 0x00) |
+          (oport->merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
+          (oport->is_merging ? 0x8 : 0x0));
+      packet.data.reply.sw_out[i] = oport->universe_address;
+    }
   }
   packet.data.reply.style = NODE_CODE;
   m_interface.hw_address.Get(packet.data.reply.mac);
@@ -935,6 +1140,58 @@ bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
   return true;
 }
 
+unsigned int ArtNetNodeImpl::PageCount() const {
+  if (!m_virtual_nodes) {
+    return 1;
+  }
+  size_t ports = std::max(m_input_ports.size(), m_output_ports.size());
+  return std::max(static_cast<unsigned int>(
+      (ports + ARTNET_MAX_PORTS - 1) / ARTNET_MAX_PORTS), 1u);
+}
+
+bool ArtNetNodeImpl::UpdatePortAddresses() {
+  bool changed = false;
+  for (unsigned int i = 0; i < m_input_ports.size(); i++) {
+    uint16_t address = PageAddress(PortPage(i));
+    changed |= m_input_ports[i]->SetNet(address >> 4);
+    changed |= m_input_ports[i]->SetSubNetAddress(address & 0x0f);
+  }
+
+  for (unsigned int i = 0; i < m_output_ports.size(); i++) {
+    uint16_t address = PageAddress(PortPage(i));
+    OutputPort *port = m_output_ports[i];
+    port->net = address >> 4;
+    port->universe_address = static_cast<uint8_t>(
+        ((address & 0x0f) << 4) | (port->universe_address & 0x0f));
+  }
+  RebuildOutputPortTable();
+  return changed;
+}
+
+void ArtNetNodeImpl::RebuildOutputPortTable() {
+  std::fill(m_output_port_table.begin(), m_output_port_table.end(), NO_PORT);
+  // Walk backwards so each chain is in port order.
+  for (unsigned int i = m_output_ports.size(); i-- > 0;) {
+    OutputPort *port = m_output_ports[i];
+    port->next_port = NO_PORT;
+    if (!port->enabled) {
+      continue;
+    }
+    uint16_t &entry = m_output_port_table[
+        (port->net << 8) | port->universe_address];
+    port->next_port = entry;
+    entry = static_cast<uint16_t>(i);
+  }
+}
+
+uint16_t ArtNetNodeImpl::LookupOutputPort(uint8_t net,
+                                          uint8_t address) const {
+  if (net & 0x80) {
+    return NO_PORT;
+  }
+  return m_output_port_table[(net << 8) | address];
+}
+
 bool ArtNetNodeImpl::SendIPReply(const IPV4Address &destination) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_REPLY);
@@ -978,6 +1235,11 @@ void ArtNetNodeImpl::HandlePacket(const IPV4Address &source_address,
                        packet.data.dmx,
                        packet_size - header_size);
       break;
+    case ARTNET_SYNC:
+      HandleSyncPacket(source_address,
+                       packet.data.sync,
+                       packet_size - header_size);
+      break;
     case ARTNET_TODREQUEST:
       HandleTodRequest(source_address,
                        packet.data.tod_request,
@@ -1055,14 +1317,6 @@ void ArtNetNodeImpl::HandleReplyPacket(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net_address != m_net_address) {
-    OLA_DEBUG << "Received ArtPollReply for net "
-              << static_cast<int>(packet.net_address)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   // Update the subscribed nodes list
   unsigned int port_limit = std::min((uint8_t) ARTNET_MAX_PORTS,
                                      packet.number_ports[1]);
@@ -1072,9 +1326,9 @@ void ArtNetNodeImpl::HandleReplyPacket(const IPV4Address &source_address,
       uint8_t universe_id = packet.sw_out[i];
       InputPorts::iterator iter = m_input_ports.begin();
       for (; iter != m_input_ports.end(); ++iter) {
-        if ((*iter)->enabled && (*iter)->PortAddress() == universe_id) {
-          STLReplace(&(*iter)->subscribed_nodes, source_address,
-                     *m_ss->WakeUpTime());
+        if ((*iter)->enabled && (*iter)->net == packet.net_address &&
+            (*iter)->PortAddress() == universe_id) {
+          (*iter)->UpdateSubscribedNode(source_address, *m_ss->WakeUpTime());
         }
       }
     }
@@ -1097,29 +1351,56 @@ void ArtNetNodeImpl::HandleDataPacket(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtDmx for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
+  uint16_t port_id = LookupOutputPort(packet.net, packet.universe);
+  if (port_id == NO_PORT) {
+    OLA_DEBUG << "Received ArtDmx for " << static_cast<int>(packet.net) << ":"
+              << static_cast<int>(packet.universe)
+              << " which doesn't match any of our ports, discarding";
     return;
   }
 
-  uint16_t universe_id = LittleEndianToHost(packet.universe);
   uint16_t data_size = std::min(
       (unsigned int) ((packet.length[0] << 8) + packet.length[1]),
       packet_size - header_size);
 
-  for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-    if (m_output_ports[port_id].enabled &&
-        m_output_ports[port_id].universe_address == universe_id &&
-        m_output_ports[port_id].on_data &&
-        m_output_ports[port_id].buffer) {
+  for (; port_id != NO_PORT; port_id = m_output_ports[port_id]->next_port) {
+    OutputPort *port = m_output_ports[port_id];
+    if (port->on_data && port->buffer) {
       // update this port, doing a merge if necessary
       DMXSource source;
       source.address = source_address;
       source.timestamp = *m_ss->WakeUpTime();
       source.buffer.Set(packet.data, data_size);
-      UpdatePortFromSource(&m_output_ports[port_id], source);
+      UpdatePortFromSource(port, source);
+    }
+  }
+}
+
+void ArtNetNodeImpl::HandleSyncPacket(const IPV4Address &source_address,
+                                      const artnet_sync_t &packet,
+                                      unsigned int packet_size) {
+  if (!m_hold_for_sync) {
+    return;
+  }
+
+  if (!CheckPacketSize(source_address, "ArtSync", packet_size,
+                       sizeof(packet))) {
+    return;
+  }
+
+  if (!CheckPacketVersion(source_address, "ArtSync", packet.version)) {
+    return;
+  }
+
+  m_last_sync = *m_ss->WakeUpTime();
+  m_sync_source = source_address;
+
+  for (unsigned int port_id = 0; port_id < m_output_ports.size(); port_id++) {
+    OutputPort *port = m_output_ports[port_id];
+    if (port->sync_pending) {
+      port->sync_pending = false;
+      *port->buffer = port->sync_buffer;
+      port->on_data->Run();
     }
   }
 }
@@ -1137,14 +1418,6 @@ void ArtNetNodeImpl::HandleTodRequest(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodRequest for net "
-              << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   if (packet.command) {
     OLA_INFO << "ArtTodRequest received but command field was "
              << static_cast<int>(packet.command);
@@ -1159,16 +1432,14 @@ void ArtNetNodeImpl::HandleTodRequest(const IPV4Address &source_address,
       static_cast<unsigned int>(ARTNET_MAX_RDM_ADDRESS_COUNT),
       addresses);
 
-  bool handler_called[ARTNET_MAX_PORTS];
-  memset(handler_called, 0, sizeof(handler_called));
+  vector<bool> handler_called(m_output_ports.size(), false);
 
   for (unsigned int i = 0; i < addresses; i++) {
-    for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-      if (m_output_ports[port_id].enabled &&
-          m_output_ports[port_id].universe_address == packet.addresses[i] &&
-          m_output_ports[port_id].on_discover &&
-          !handler_called[port_id]) {
-        m_output_ports[port_id].on_discover->Run();
+    uint16_t port_id = LookupOutputPort(packet.net, packet.addresses[i]);
+    for (; port_id != NO_PORT; port_id = m_output_ports[port_id]->next_port) {
+      OutputPort *port = m_output_ports[port_id];
+      if (port->on_discover && !handler_called[port_id]) {
+        port->on_discover->Run();
         handler_called[port_id] = true;
       }
     }
@@ -1194,13 +1465,6 @@ void ArtNetNodeImpl::HandleTodData(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodData for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   if (packet.command_response) {
     OLA_WARN << "Command response " << ToHex(packet.command_response)
              << " != 0x0";
@@ -1209,7 +1473,8 @@ void ArtNetNodeImpl::HandleTodData(const IPV4Address &source_address,
 
   InputPorts::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
+    if ((*iter)->enabled && (*iter)->net == packet.net &&
+        (*iter)->PortAddress() == packet.address) {
       UpdatePortFromTodPacket(*iter, source_address, packet, packet_size);
     }
   }
@@ -1227,23 +1492,14 @@ void ArtNetNodeImpl::HandleTodControl(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodControl for net "
-              << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   if (packet.command != TOD_FLUSH_COMMAND) {
     return;
   }
 
-  for (unsigned int port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-    if (m_output_ports[port_id].enabled &&
-        m_output_ports[port_id].universe_address == packet.address &&
-        m_output_ports[port_id].on_flush) {
-      m_output_ports[port_id].on_flush->Run();
+  uint16_t port_id = LookupOutputPort(packet.net, packet.address);
+  for (; port_id != NO_PORT; port_id = m_output_ports[port_id]->next_port) {
+    if (m_output_ports[port_id]->on_flush) {
+      m_output_ports[port_id]->on_flush->Run();
     }
   }
 }
@@ -1271,13 +1527,6 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtRDM for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   unsigned int rdm_length = packet_size - header_size;
   if (!rdm_length) {
     return;
@@ -1285,21 +1534,20 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
 
   // look for the port that this was sent to, once we know the port we can try
   // to parse the message
-  for (uint8_t port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
-    if (m_output_ports[port_id].enabled &&
-        m_output_ports[port_id].universe_address == packet.address &&
-        m_output_ports[port_id].on_rdm_request) {
+  uint16_t port_id = LookupOutputPort(packet.net, packet.address);
+  for (; port_id != NO_PORT; port_id = m_output_ports[port_id]->next_port) {
+    if (m_output_ports[port_id]->on_rdm_request) {
       RDMRequest *request = RDMRequest::InflateFromData(packet.data,
                                                         rdm_length);
 
       if (request) {
-        m_output_ports[port_id].on_rdm_request->Run(
+        m_output_ports[port_id]->on_rdm_request->Run(
             request,
             NewSingleCallback(this,
                               &ArtNetNodeImpl::RDMRequestCompletion,
                               source_address,
-                              port_id,
-                              m_output_ports[port_id].universe_address));
+                              static_cast<uint8_t>(port_id),
+                              m_output_ports[port_id]->universe_address));
       }
     }
   }
@@ -1309,7 +1557,8 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
 
   InputPorts::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
+    if ((*iter)->enabled && (*iter)->net == packet.net &&
+        (*iter)->PortAddress() == packet.address) {
       HandleRDMResponse(*iter, rdm_response, source_address);
     }
   }
@@ -1328,7 +1577,8 @@ void ArtNetNodeImpl::RDMRequestCompletion(
   if (port->universe_address == universe_address) {
     if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK) {
       // TODO(simon): handle fragmenation here
-      SendRDMCommand(*reply->Response(), destination, universe_address);
+      SendRDMCommand(*reply->Response(), destination, port->net,
+                     universe_address);
     } else if (reply->StatusCode() == ola::rdm::RDM_UNKNOWN_UID) {
       // call the on discovery handler, which will send a new TOD and
       // hopefully update the remote controller
@@ -1353,11 +1603,13 @@ void ArtNetNodeImpl::HandleRDMResponse(InputPort *port,
     return;
   }
 
-  if (!port->pending_request) {
+  map<UID, InputPort::PendingRDMRequest>::iterator pending_iter =
+      port->pending_requests.find(reply->Response()->SourceUID());
+  if (pending_iter == port->pending_requests.end()) {
     return;
   }
 
-  const RDMRequest *request = port->pending_request;
+  const RDMRequest *request = pending_iter->second.request;
   if (request->SourceUID() != reply->Response()->DestinationUID() ||
       request->DestinationUID() != reply->Response()->SourceUID()) {
     OLA_INFO << "Got response from/to unexpected UID: req "
@@ -1399,23 +1651,17 @@ void ArtNetNodeImpl::HandleRDMResponse(InputPort *port,
     return;
   }
 
-  if (port->rdm_ip_destination != m_interface.bcast_address &&
-      port->rdm_ip_destination != source_address) {
+  if (pending_iter->second.destination != m_interface.bcast_address &&
+      pending_iter->second.destination != source_address) {
     OLA_INFO << "IP address of RDM response didn't match";
     return;
   }
 
   // at this point we've decided it's for us
-  port->pending_request = NULL;
+  RDMCallback *callback = pending_iter->second.callback;
+  m_ss->RemoveTimeout(pending_iter->second.timeout);
+  port->pending_requests.erase(pending_iter);
   delete request;
-  RDMCallback *callback = port->rdm_request_callback;
-  port->rdm_request_callback = NULL;
-
-  // remove the timeout
-  if (port->rdm_send_timeout != ola::thread::INVALID_TIMEOUT) {
-    m_ss->RemoveTimeout(port->rdm_send_timeout);
-    port->rdm_send_timeout = ola::thread::INVALID_TIMEOUT;
-  }
 
   callback->Run(reply.get());
 }
@@ -1459,25 +1705,65 @@ bool ArtNetNodeImpl::SendPacket(const artnet_packet &packet,
   return true;
 }
 
-void ArtNetNodeImpl::TimeoutRDMRequest(InputPort *port) {
-  OLA_INFO << "RDM Request timed out.";
-  port->rdm_send_timeout = ola::thread::INVALID_TIMEOUT;
-  delete port->pending_request;
-  port->pending_request = NULL;
-  RDMCallback *callback = port->rdm_request_callback;
-  port->rdm_request_callback = NULL;
+bool ArtNetNodeImpl::SendPacketToNodes(
+    const artnet_packet &packet,
+    unsigned int size,
+    const vector<IPV4Address> &destinations) {
+  if (destinations.empty()) {
+    return false;
+  }
+
+  size += sizeof(packet.id) + sizeof(packet.op_code);
+  m_send_batch.resize(destinations.size());
+  for (unsigned int i = 0; i < destinations.size(); i++) {
+    m_send_batch[i].data = const_cast<uint8_t*>(
+        reinterpret_cast<const uint8_t*>(&packet));
+    m_send_batch[i].length = size;
+    m_send_batch[i].address = IPV4SocketAddress(destinations[i], ARTNET_PORT);
+  }
+
+  unsigned int sent = m_socket->SendBatch(&m_send_batch[0],
+                                          m_send_batch.size());
+  if (sent != m_send_batch.size()) {
+    OLA_INFO << "Only sent " << sent << " of " << m_send_batch.size()
+             << " packets";
+  }
+  return sent > 0;
+}
+
+bool ArtNetNodeImpl::ExpireSubscribedNodes() {
+  TimeStamp last_heard_threshold = (
+      *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
+  InputPorts::iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    (*iter)->ExpireSubscribedNodes(last_heard_threshold);
+  }
+  return true;
+}
+
+void ArtNetNodeImpl::TimeoutRDMRequest(InputPort *port, UID uid) {
+  map<UID, InputPort::PendingRDMRequest>::iterator iter =
+      port->pending_requests.find(uid);
+  if (iter == port->pending_requests.end()) {
+    return;
+  }
+  OLA_INFO << "RDM Request to " << uid << " timed out.";
+  RDMCallback *callback = iter->second.callback;
+  delete iter->second.request;
+  port->pending_requests.erase(iter);
   RunRDMCallback(callback, ola::rdm::RDM_TIMEOUT);
 }
 
 bool ArtNetNodeImpl::SendRDMCommand(const RDMCommand &command,
                                     const IPV4Address &destination,
+                                    uint8_t net,
                                     uint8_t universe) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_RDM);
   memset(&packet.data.rdm, 0, sizeof(packet.data.rdm));
   packet.data.rdm.version = HostToNetwork(ARTNET_VERSION);
   packet.data.rdm.rdm_version = RDM_VERSION;
-  packet.data.rdm.net = m_net_address;
+  packet.data.rdm.net = net;
   packet.data.rdm.address = universe;
   unsigned int rdm_size = ARTNET_MAX_RDM_DATA;
   if (!RDMCommandSerializer::Pack(command, packet.data.rdm.data, &rdm_size)) {
@@ -1493,75 +1779,72 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
                                           const DMXSource &source) {
   TimeStamp merge_time_threshold = (
       *m_ss->WakeUpTime() - TimeInterval(MERGE_TIMEOUT, 0));
-  // the index of the first empty slot, of MAX_MERGE_SOURCES if we're already
-  // tracking MAX_MERGE_SOURCES sources.
-  unsigned int first_empty_slot = MAX_MERGE_SOURCES;
-  // the index for this source, or MAX_MERGE_SOURCES if it wasn't found
-  unsigned int source_slot = MAX_MERGE_SOURCES;
-  unsigned int active_sources = 0;
-
-  // locate the source within the list of tracked sources, also find the first
-  // empty source location in case this source is new, and timeout any sources
-  // we haven't heard from.
-  for (unsigned int i = 0; i < MAX_MERGE_SOURCES; i++) {
-    if (port->sources[i].address == source.address) {
-      source_slot = i;
-      continue;
-    }
-
-    // timeout old sources
-    if (port->sources[i].timestamp < merge_time_threshold) {
-      port->sources[i].address = IPV4Address();
-    }
 
-    if (!port->sources[i].address.IsWildcard()) {
-      active_sources++;
-    } else if (i < first_empty_slot) {
-      first_empty_slot = i;
+  // timeout any sources we haven't heard from.
+  DMXSourceMap::iterator iter = port->sources.begin();
+  while (iter != port->sources.end()) {
+    if (iter->first != source.address &&
+        iter->second.timestamp < merge_time_threshold) {
+      port->sources.erase(iter++);
+    } else {
+      ++iter;
     }
   }
 
-  if (source_slot == MAX_MERGE_SOURCES) {
+  iter = port->sources.find(source.address);
+  if (iter == port->sources.end()) {
     // this is a new source
-    if (first_empty_slot == MAX_MERGE_SOURCES) {
+    if (port->sources.size() >= m_max_merge_sources) {
       // No room at the inn
       OLA_WARN << "Max merge sources reached, ignoring";
       return;
     }
-    if (active_sources == 0) {
-      port->is_merging = false;
-    } else {
-      OLA_INFO << "Entered merge mode for universe "
-               << static_cast<int>(port->universe_address);
-      port->is_merging = true;
-      SendPollReplyIfRequired();
-    }
-    source_slot = first_empty_slot;
-  } else if (active_sources == 1) {
-    port->is_merging = false;
+    port->sources[source.address] = source;
+  } else {
+    iter->second = source;
   }
 
-  port->sources[source_slot] = source;
+  const bool was_merging = port->is_merging;
+  port->is_merging = port->sources.size() > 1;
+  if (port->is_merging && !was_merging) {
+    OLA_INFO << "Entered merge mode for universe "
+             << static_cast<int>(port->universe_address);
+    SendPollReplyIfRequired();
+  }
+
+  const bool hold = HoldForSync(*port, source);
+  DmxBuffer *output = hold ? &port->sync_buffer : port->buffer;
+  port->sync_pending = hold;
 
   // Now we need to merge
-  if (port->merge_mode == ARTNET_MERGE_LTP) {
+  if (port->merge_mode == ARTNET_MERGE_LTP || !port->is_merging) {
     // the current source is the latest
-    (*port->buffer) = source.buffer;
+    (*output) = source.buffer;
   } else {
     // HTP merge
-    bool first = true;
-    for (unsigned int i = 0; i < MAX_MERGE_SOURCES; i++) {
-      if (!port->sources[i].address.IsWildcard()) {
-        if (first) {
-          (*port->buffer) = port->sources[i].buffer;
-          first = false;
-        } else {
-          port->buffer->HTPMerge(port->sources[i].buffer);
-        }
-      }
+    vector<const DmxBuffer*> buffers;
+    buffers.reserve(port->sources.size());
+    for (iter = port->sources.begin(); iter != port->sources.end(); ++iter) {
+      buffers.push_back(&iter->second.buffer);
     }
+    output->Reset();
+    output->HTPMerge(buffers);
+  }
+
+  if (!hold) {
+    port->on_data->Run();
   }
-  port->on_data->Run();
+}
+
+bool ArtNetNodeImpl::HoldForSync(const OutputPort &port,
+                                 const DMXSource &source) const {
+  // The spec says ArtSync is ignored while merging, or if it hasn't been
+  // received for SYNC_TIMEOUT.
+  return (m_hold_for_sync &&
+          !port.is_merging &&
+          m_last_sync.IsSet() &&
+          source.address == m_sync_source &&
+          source.timestamp - m_last_sync < TimeInterval(SYNC_TIMEOUT, 0));
 }
 
 bool ArtNetNodeImpl::CheckPacketVersion(const IPV4Address &source_address,
@@ -1626,22 +1909,22 @@ ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetEnabledInputPort(
 }
 
 ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetOutputPort(uint8_t port_id) {
-  if (port_id >= ARTNET_MAX_PORTS) {
+  if (port_id >= m_output_ports.size()) {
     OLA_WARN << "Port index of out bounds: "
-             << static_cast<int>(port_id) << " >= " << ARTNET_MAX_PORTS;
+             << static_cast<int>(port_id) << " >= " << m_output_ports.size();
     return NULL;
   }
-  return &m_output_ports[port_id];
+  return m_output_ports[port_id];
 }
 
 const ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetOutputPort(
     uint8_t port_id) const {
-  if (port_id >= ARTNET_MAX_PORTS) {
+  if (port_id >= m_output_ports.size()) {
     OLA_WARN << "Port index of out bounds: "
-             << static_cast<int>(port_id) << " >= " << ARTNET_MAX_PORTS;
+             << static_cast<int>(port_id) << " >= " << m_output_ports.size();
     return NULL;
   }
-  return &m_output_ports[port_id];
+  return m_output_ports[port_id];
 }
 
 ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetEnabledOutputPort(
@@ -1677,6 +1960,7 @@ bool ArtNetNodeImpl::InitNetwork() {
 
   m_socket->SetOnData(NewCallback(this, &ArtNetNodeImpl::SocketReady));
   m_ss->AddReadDescriptor(m_socket.get());
+  m_ss->SetDescriptorName(m_socket.get(), "artnet");
   return true;
 }
 
@@ -1722,6 +2006,8 @@ void ArtNetNodeImpl::UpdatePortFromTodPacket(InputPort *port,
       }
     }
 
+    port->tod_nodes[source_address] = *m_ss->WakeUpTime();
+
     // mark this node as complete
     if (port->discovery_node_set.erase(source_address)) {
       // if the set is now 0, and it was non-0 initally and we have a
@@ -1802,7 +2088,7 @@ ArtNetNode::ArtNetNode(const ola::network::Interface &iface,
                                                                      i);
     m_wrappers.push_back(wrapper);
     m_controllers.push_back(new ola::rdm::DiscoverableQueueingRDMController(
-        wrapper, options.rdm_queue_size));
+        wrapper, options.rdm_queue_size, options.rdm_max_in_flight));
   }
 }
 
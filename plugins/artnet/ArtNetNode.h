@@ -68,15 +68,37 @@ class ArtNetNodeOptions {
       : always_broadcast(false),
         use_limited_broadcast_address(false),
         rdm_queue_size(20),
+        rdm_max_in_flight(1),
         broadcast_threshold(30),
-        input_port_count(4) {
+        input_port_count(4),
+        output_port_count(ARTNET_MAX_PORTS),
+        virtual_nodes(false),
+        send_sync(false),
+        hold_for_sync(false),
+        max_merge_sources(2) {
   }
 
   bool always_broadcast;
   bool use_limited_broadcast_address;
   unsigned int rdm_queue_size;
+  // The number of RDM requests to different UIDs that can be outstanding on
+  // each port at once.
+  unsigned int rdm_max_in_flight;
   unsigned int broadcast_threshold;
   uint8_t input_port_count;
+  uint8_t output_port_count;
+  // Group the ports into virtual nodes of ARTNET_MAX_PORTS ports each. Each
+  // virtual node has its own bind index & ArtPollReply, and uses the sub-net
+  // after the previous one.
+  bool virtual_nodes;
+  // Broadcast an ArtSync after the ArtDmx packets sent during an iteration of
+  // the event loop.
+  bool send_sync;
+  // Hold received ArtDmx data until the next ArtSync, once one has been seen.
+  bool hold_for_sync;
+  // The number of senders merged on each port, the spec allows 2. Data from
+  // any more is ignored until one of them times out.
+  unsigned int max_merge_sources;
 };
 
 
@@ -109,6 +131,16 @@ class ArtNetNodeImpl {
    */
   bool Stop();
 
+  /**
+   * @brief Return the socket this node uses.
+   */
+  ola::network::UDPSocketInterface *GetSocket() { return m_socket.get(); }
+
+  /**
+   * @brief Return the interface this node is bound to.
+   */
+  const ola::network::Interface &GetInterface() const { return m_interface; }
+
   /**
    * @brief Start the configuration transaction.
    *
@@ -162,9 +194,7 @@ class ArtNetNodeImpl {
    * @param subnet_address the ArtNet 'subnet' address, 4 bits.
    */
   bool SetSubnetAddress(uint8_t subnet_address);
-  uint8_t SubnetAddress() const {
-    return m_output_ports[0].universe_address >> 4;
-  }
+  uint8_t SubnetAddress() const { return m_subnet_address; }
 
   /**
    * Get the number of input ports
@@ -172,6 +202,19 @@ class ArtNetNodeImpl {
    */
   uint8_t InputPortCount() const;
 
+  /**
+   * Get the number of output ports
+   * @returns the number of output ports
+   */
+  uint8_t OutputPortCount() const;
+
+  /**
+   * @brief Estimate the memory used by the subscribed nodes, merge sources
+   * and RDM tables.
+   * @returns the estimate in bytes.
+   */
+  size_t MemoryUsage() const;
+
   /**
    * Set the universe address of an input port
    */
@@ -187,6 +230,15 @@ class ArtNetNodeImpl {
    */
   uint8_t GetInputPortUniverse(uint8_t port_id) const;
 
+  /**
+   * @brief Return the net address for an input port.
+   *
+   * This is the node's net address, unless virtual nodes are enabled.
+   * @param port_id the port id.
+   * @return The net address for the port. Invalid port_ids return 0.
+   */
+  uint8_t GetInputPortNet(uint8_t port_id) const;
+
   /**
    * @brief Disable an input port.
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
@@ -215,6 +267,13 @@ class ArtNetNodeImpl {
    */
   uint8_t GetOutputPortUniverse(uint8_t port_id);
 
+  /**
+   * @brief Return the net address for an output port.
+   * @param port_id the port id.
+   * @return The net address for the port. Invalid port_ids return 0.
+   */
+  uint8_t GetOutputPortNet(uint8_t port_id) const;
+
   /**
    * @brief Disable an output port.
    * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
@@ -256,6 +315,15 @@ class ArtNetNodeImpl {
    */
   bool SendDMX(uint8_t port_id, const ola::DmxBuffer &buffer);
 
+  /**
+   * @brief Send the pending ArtSync now, rather than once control returns to
+   * the event loop.
+   *
+   * This does nothing if no ArtDmx packets have been sent since the last
+   * ArtSync.
+   */
+  void FlushSync();
+
   /**
    * @brief Flush the TOD and force a full discovery.
    *
@@ -361,23 +429,28 @@ class ArtNetNodeImpl {
   typedef std::map<ola::rdm::UID,
                    std::pair<ola::network::IPV4Address, uint8_t> > uid_map;
 
-  enum { MAX_MERGE_SOURCES = 2 };
-
   struct DMXSource {
     DmxBuffer buffer;
     TimeStamp timestamp;
     ola::network::IPV4Address address;
   };
 
+  // The senders for a port, by address.
+  typedef std::map<ola::network::IPV4Address, DMXSource> DMXSourceMap;
+
   // Output Ports receive ArtNet data
   struct OutputPort {
+    uint8_t net;
     uint8_t universe_address;
     uint8_t sequence_number;
     bool enabled;
     artnet_merge_mode merge_mode;
     bool is_merging;
-    DMXSource sources[MAX_MERGE_SOURCES];
+    DMXSourceMap sources;
     DmxBuffer *buffer;
+    // The merged data waiting for an ArtSync.
+    DmxBuffer sync_buffer;
+    bool sync_pending;
     std::map<ola::rdm::UID, ola::network::IPV4Address> uid_map;
     Callback0<void> *on_data;
     Callback0<void> *on_discover;
@@ -385,10 +458,15 @@ class ArtNetNodeImpl {
     ola::Callback2<void,
                    ola::rdm::RDMRequest*,
                    ola::rdm::RDMCallback*> *on_rdm_request;
+    // The next enabled port with the same port address, or NO_PORT.
+    uint16_t next_port;
   };
 
+  typedef std::vector<OutputPort*> OutputPorts;
+
   bool m_running;
   uint8_t m_net_address;  // this is the 'net' portion of the Artnet address
+  uint8_t m_subnet_address;  // the sub-net of the first virtual node
   bool m_send_reply_on_change;
   std::string m_short_name;
   std::string m_long_name;
@@ -397,6 +475,15 @@ class ArtNetNodeImpl {
   ola::io::SelectServerInterface *m_ss;
   bool m_always_broadcast;
   bool m_use_limited_broadcast_address;
+  bool m_virtual_nodes;
+  bool m_send_sync;
+  bool m_hold_for_sync;
+  unsigned int m_max_merge_sources;
+  ola::thread::timeout_id m_sync_timeout;
+  ola::thread::timeout_id m_expiry_timeout;
+  // The last ArtSync received, data is only held while these are arriving.
+  TimeStamp m_last_sync;
+  ola::network::IPV4Address m_sync_source;
 
   // The following keep track of "Configuration mode"
   bool m_in_configuration_mode;
@@ -404,9 +491,13 @@ class ArtNetNodeImpl {
   bool m_artpollreply_required;
 
   InputPorts m_input_ports;
-  OutputPort m_output_ports[ARTNET_MAX_PORTS];
+  OutputPorts m_output_ports;
+  // Maps a 15 bit port address to the first enabled output port using it.
+  std::vector<uint16_t> m_output_port_table;
   ola::network::Interface m_interface;
   std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+  // Reused for each unicast fan-out
+  std::vector<ola::network::UDPDatagram> m_send_batch;
 
   /**
    * @brief Called when there is data on this socket
@@ -430,10 +521,53 @@ class ArtNetNodeImpl {
   bool SendPollReplyIfRequired();
 
   /**
-   * @brief Send an ArtPollReply message
+   * @brief Send an ArtPollReply message for each virtual node
    */
   bool SendPollReply(const ola::network::IPV4Address &destination);
 
+  /**
+   * @brief Send the ArtPollReply for a virtual node
+   */
+  bool SendPollReplyPage(const ola::network::IPV4Address &destination,
+                         unsigned int page);
+
+  /**
+   * @brief The number of virtual nodes.
+   */
+  unsigned int PageCount() const;
+
+  /**
+   * @brief The virtual node a port belongs to.
+   */
+  unsigned int PortPage(unsigned int port_id) const {
+    return m_virtual_nodes ? port_id / ARTNET_MAX_PORTS : 0;
+  }
+
+  /**
+   * @brief The 11 bit net & sub-net address of a virtual node.
+   */
+  uint16_t PageAddress(unsigned int page) const {
+    return static_cast<uint16_t>(
+        (((m_net_address << 4) | m_subnet_address) + page) & 0x7ff);
+  }
+
+  /**
+   * @brief Update the net & sub-net of each port from its virtual node.
+   * @returns true if any input port address changed.
+   */
+  bool UpdatePortAddresses();
+
+  /**
+   * @brief Rebuild the port address to output port table.
+   */
+  void RebuildOutputPortTable();
+
+  /**
+   * @brief Find the first enabled output port for a net & port address.
+   * @returns the port index, or NO_PORT.
+   */
+  uint16_t LookupOutputPort(uint8_t net, uint8_t address) const;
+
   /**
    * @brief Send an IPProgReply
    */
@@ -467,6 +601,13 @@ class ArtNetNodeImpl {
                         const artnet_dmx_t &packet,
                         unsigned int packet_size);
 
+  /**
+   * @brief Handle an ArtSync packet, this outputs any held data.
+   */
+  void HandleSyncPacket(const ola::network::IPV4Address &source_address,
+                        const artnet_sync_t &packet,
+                        unsigned int packet_size);
+
   /**
    * @brief Handle a TOD Request packet
    */
@@ -523,6 +664,17 @@ class ArtNetNodeImpl {
                        const artnet_ip_prog_t &packet,
                        unsigned int packet_size);
 
+  /**
+   * @brief Broadcast an ArtSync, this is run once the ArtDmx packets for a
+   * frame have been sent.
+   */
+  void SendSync();
+
+  /**
+   * @brief Check if data for a port should be held until an ArtSync arrives.
+   */
+  bool HoldForSync(const OutputPort &port, const DMXSource &source) const;
+
   /**
    * @brief Fill in the header for a packet
    */
@@ -538,17 +690,38 @@ class ArtNetNodeImpl {
                   unsigned int size,
                   const ola::network::IPV4Address &destination);
 
+  /**
+   * @brief Send an ArtNet packet to a list of nodes, using a single batch.
+   * @param packet the packet to send
+   * @param size the size of the packet, excluding the header portion
+   * @param destinations the nodes to send the packet to
+   * @returns true if the packet was sent to at least one node.
+   */
+  bool SendPacketToNodes(
+      const artnet_packet &packet,
+      unsigned int size,
+      const std::vector<ola::network::IPV4Address> &destinations);
+
+  /**
+   * @brief Remove subscribed nodes we haven't heard from in NODE_TIMEOUT.
+   *
+   * This runs every SUBSCRIBER_EXPIRY_INTERVAL_MS, so sending doesn't need to
+   * check the timestamps.
+   */
+  bool ExpireSubscribedNodes();
+
   /**
    * @brief Timeout a pending RDM request
    * @param port the id of the port to timeout.
    */
-  void TimeoutRDMRequest(InputPort *port);
+  void TimeoutRDMRequest(InputPort *port, ola::rdm::UID uid);
 
   /**
    * @brief Send a generic ArtRdm message
    */
   bool SendRDMCommand(const ola::rdm::RDMCommand &command,
                       const ola::network::IPV4Address &destination,
+                      uint8_t net,
                       uint8_t universe);
 
   /**
@@ -642,8 +815,14 @@ class ArtNetNodeImpl {
   static const unsigned int MERGE_TIMEOUT = 10;  // As per the spec
   // seconds after which a node is marked as inactive for the dmx merging
   static const unsigned int NODE_TIMEOUT = 31;
+  // mseconds between checks for nodes that have timed out
+  static const unsigned int SUBSCRIBER_EXPIRY_INTERVAL_MS = 1000;
+  // seconds without an ArtSync before we stop holding data, as per the spec
+  static const unsigned int SYNC_TIMEOUT = 4;
   // mseconds we wait for a TodData packet before declaring a node missing
   static const unsigned int RDM_TOD_TIMEOUT_MS = 4000;
+  // seconds a node's TOD is used for, without asking for it again
+  static const unsigned int RDM_TOD_CACHE_TIMEOUT = 30;
   // Number of missed TODs before we decide a UID has gone
   static const unsigned int RDM_MISSED_TODDATA_LIMIT = 3;
   // The maximum number of requests we'll allow in the queue. This is a per
@@ -651,6 +830,11 @@ class ArtNetNodeImpl {
   static const unsigned int RDM_REQUEST_QUEUE_LIMIT = 100;
   // How long to wait for a response to an RDM Request
   static const unsigned int RDM_REQUEST_TIMEOUT_MS = 2000;
+  // The max number of packets we'll read each time the socket is ready
+  static const unsigned int RECV_BATCH_SIZE = 8;
+  // The number of 15 bit port addresses
+  static const unsigned int PORT_ADDRESS_COUNT = 1 << 15;
+  static const uint16_t NO_PORT = 0xffff;
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNodeImpl);
 };
@@ -703,6 +887,12 @@ class ArtNetNode {
 
   bool Start() { return m_impl.Start(); }
   bool Stop() { return m_impl.Stop(); }
+  ola::network::UDPSocketInterface *GetSocket() {
+    return m_impl.GetSocket();
+  }
+  const ola::network::Interface &GetInterface() const {
+    return m_impl.GetInterface();
+  }
 
   bool EnterConfigurationMode() {
     return m_impl.EnterConfigurationMode();
@@ -737,6 +927,10 @@ class ArtNetNode {
   uint8_t InputPortCount() const {
     return m_impl.InputPortCount();
   }
+  uint8_t OutputPortCount() const {
+    return m_impl.OutputPortCount();
+  }
+  size_t MemoryUsage() const { return m_impl.MemoryUsage(); }
 
   bool SetInputPortUniverse(uint8_t port_id, uint8_t universe_id) {
     return m_impl.SetInputPortUniverse(port_id, universe_id);
@@ -744,6 +938,9 @@ class ArtNetNode {
   uint8_t GetInputPortUniverse(uint8_t port_id) const {
     return m_impl.GetInputPortUniverse(port_id);
   }
+  uint8_t GetInputPortNet(uint8_t port_id) const {
+    return m_impl.GetInputPortNet(port_id);
+  }
   void DisableInputPort(uint8_t port_id) {
     m_impl.DisableInputPort(port_id);
   }
@@ -757,6 +954,9 @@ class ArtNetNode {
   uint8_t GetOutputPortUniverse(uint8_t port_id) {
     return m_impl.GetOutputPortUniverse(port_id);
   }
+  uint8_t GetOutputPortNet(uint8_t port_id) const {
+    return m_impl.GetOutputPortNet(port_id);
+  }
   void DisableOutputPort(uint8_t port_id) {
     m_impl.DisableOutputPort(port_id);
   }
@@ -782,6 +982,8 @@ class ArtNetNode {
     return m_impl.SendDMX(port_id, buffer);
   }
 
+  void FlushSync() { m_impl.FlushSync(); }
+
   /**
    * @brief Trigger full discovery for a port
    */
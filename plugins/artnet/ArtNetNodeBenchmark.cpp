@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ArtNetNodeBenchmark.cpp
+ * Microbenchmarks for packing and parsing ArtDmx packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Interface.h"
+#include "ola/network/MACAddress.h"
+#include "ola/testing/Benchmark.h"
+#include "ola/testing/MockUDPSocket.h"
+#include "plugins/artnet/ArtNetNode.h"
+
+using ola::DmxBuffer;
+using ola::network::IPV4Address;
+using ola::network::Interface;
+using ola::network::InterfaceBuilder;
+using ola::network::MACAddress;
+using ola::plugin::artnet::ArtNetNode;
+using ola::plugin::artnet::ArtNetNodeOptions;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using ola::testing::MockUDPSocket;
+
+namespace {
+
+const uint8_t PORT_ID = 1;
+const uint16_t ARTNET_PORT = 6454;
+const unsigned int ARTDMX_HEADER_SIZE = 18;
+
+Interface TestInterface() {
+  InterfaceBuilder interface_builder;
+  interface_builder.SetAddress("10.0.0.1");
+  interface_builder.SetSubnetMask("255.0.0.0");
+  interface_builder.SetBroadcast("10.255.255.255");
+  interface_builder.SetHardwareAddress(
+      MACAddress::FromStringOrDie("0a:0b:0c:12:34:56"));
+  return interface_builder.Construct();
+}
+
+DmxBuffer TestFrame() {
+  uint8_t data[ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>(i * 7);
+  }
+  return DmxBuffer(data, sizeof(data));
+}
+
+void NoOp() {}
+
+/*
+ * Pack and send an ArtDmx packet, the socket discards the data.
+ */
+void BenchmarkArtNetSendDMX(BenchmarkState *state) {
+  ola::io::SelectServer ss;
+  MockUDPSocket *socket = new MockUDPSocket();
+  socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.always_broadcast = true;
+  ArtNetNode node(TestInterface(), &ss, node_options, socket);
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  node.SetInputPortUniverse(PORT_ID, 3);
+  node.Start();
+  ss.RemoveReadDescriptor(socket);
+
+  const DmxBuffer frame = TestFrame();
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    node.SendDMX(PORT_ID, frame);
+  }
+  state->SetBytesProcessed(state->Iterations() * frame.Size());
+}
+OLA_BENCHMARK(BenchmarkArtNetSendDMX);
+
+/*
+ * Receive an ArtDmx packet for an output port.
+ */
+void BenchmarkArtNetReceiveDMX(BenchmarkState *state) {
+  ola::io::SelectServer ss;
+  MockUDPSocket *socket = new MockUDPSocket();
+  socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(TestInterface(), &ss, node_options, socket);
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  node.SetOutputPortUniverse(PORT_ID, 3);
+  DmxBuffer output;
+  node.SetDMXHandler(PORT_ID, &output, ola::NewCallback(&NoOp));
+  node.Start();
+  ss.RemoveReadDescriptor(socket);
+
+  uint8_t packet[ARTDMX_HEADER_SIZE + ola::DMX_UNIVERSE_SIZE] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0x02, 0x00,  // dmx length
+  };
+  const DmxBuffer frame = TestFrame();
+  memcpy(packet + ARTDMX_HEADER_SIZE, frame.GetRaw(), frame.Size());
+
+  IPV4Address peer;
+  IPV4Address::FromString("10.0.0.10", &peer);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    packet[12] = static_cast<uint8_t>(i);
+    socket->InjectData(packet, sizeof(packet), peer, ARTNET_PORT);
+    DoNotOptimize(output);
+  }
+  state->SetBytesProcessed(state->Iterations() * frame.Size());
+}
+OLA_BENCHMARK(BenchmarkArtNetReceiveDMX);
+}  // namespace
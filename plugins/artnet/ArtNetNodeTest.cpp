@@ -73,16 +73,22 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testBasicBehaviour);
   CPPUNIT_TEST(testConfigurationMode);
   CPPUNIT_TEST(testExtendedInputPorts);
+  CPPUNIT_TEST(testVirtualNodes);
   CPPUNIT_TEST(testBroadcastSendDMX);
   CPPUNIT_TEST(testBroadcastSendDMXZeroUniverse);
   CPPUNIT_TEST(testLimitedBroadcastDMX);
   CPPUNIT_TEST(testNonBroadcastSendDMX);
+  CPPUNIT_TEST(testSubscriberExpiry);
+  CPPUNIT_TEST(testSendSync);
   CPPUNIT_TEST(testReceiveDMX);
   CPPUNIT_TEST(testReceiveDMXZeroUniverse);
+  CPPUNIT_TEST(testReceiveSync);
   CPPUNIT_TEST(testHTPMerge);
+  CPPUNIT_TEST(testMaxMergeSources);
   CPPUNIT_TEST(testLTPMerge);
   CPPUNIT_TEST(testControllerDiscovery);
   CPPUNIT_TEST(testControllerIncrementalDiscovery);
+  CPPUNIT_TEST(testCachedTod);
   CPPUNIT_TEST(testUnsolicitedTod);
   CPPUNIT_TEST(testResponderDiscovery);
   CPPUNIT_TEST(testRDMResponder);
@@ -90,6 +96,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRDMRequestTimeout);
   CPPUNIT_TEST(testRDMRequestIPMismatch);
   CPPUNIT_TEST(testRDMRequestUIDMismatch);
+  CPPUNIT_TEST(testConcurrentRDMRequests);
   CPPUNIT_TEST(testTimeCode);
   CPPUNIT_TEST_SUITE_END();
 
@@ -114,16 +121,22 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   void testBasicBehaviour();
   void testConfigurationMode();
   void testExtendedInputPorts();
+  void testVirtualNodes();
   void testBroadcastSendDMX();
   void testBroadcastSendDMXZeroUniverse();
   void testLimitedBroadcastDMX();
   void testNonBroadcastSendDMX();
+  void testSubscriberExpiry();
+  void testSendSync();
   void testReceiveDMX();
   void testReceiveDMXZeroUniverse();
+  void testReceiveSync();
   void testHTPMerge();
+  void testMaxMergeSources();
   void testLTPMerge();
   void testControllerDiscovery();
   void testControllerIncrementalDiscovery();
+  void testCachedTod();
   void testUnsolicitedTod();
   void testResponderDiscovery();
   void testRDMResponder();
@@ -131,6 +144,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   void testRDMRequestTimeout();
   void testRDMRequestIPMismatch();
   void testRDMRequestUIDMismatch();
+  void testConcurrentRDMRequests();
   void testTimeCode();
 
  private:
@@ -269,6 +283,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   }
 
   static const uint8_t POLL_MESSAGE[];
+  static const uint8_t SYNC_MESSAGE[];
   static const uint8_t POLL_REPLY_MESSAGE[];
   static const uint8_t TOD_CONTROL[];
   static const uint16_t ARTNET_PORT = 6454;
@@ -277,6 +292,13 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ArtNetNodeTest);
 
+const uint8_t ArtNetNodeTest::SYNC_MESSAGE[] = {
+  'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+  0x00, 0x52,
+  0x0, 14,
+  0, 0,  // aux
+};
+
 
 const uint8_t ArtNetNodeTest::POLL_MESSAGE[] = {
   'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
@@ -632,6 +654,86 @@ void ArtNetNodeTest::testExtendedInputPorts() {
 /**
  * Check sending DMX using broadcast works.
  */
+/**
+ * Check that virtual nodes send a reply for each page of ports, and that
+ * ports in the second page use the next sub-net.
+ */
+void ArtNetNodeTest::testVirtualNodes() {
+  ArtNetNodeOptions node_options;
+  node_options.output_port_count = 8;
+  node_options.virtual_nodes = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+
+  node.SetShortName("Short Name");
+  node.SetLongName("This is the very long name");
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  OLA_ASSERT_EQ((uint8_t) 8, node.OutputPortCount());
+  OLA_ASSERT_EQ((uint8_t) 0x20, node.GetOutputPortUniverse(0));
+  OLA_ASSERT_EQ((uint8_t) 0x30, node.GetOutputPortUniverse(4));
+  OLA_ASSERT_EQ((uint8_t) 4, node.GetOutputPortNet(4));
+
+  DmxBuffer input_buffer;
+  node.SetDMXHandler(5, &input_buffer,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+
+  uint8_t first_reply[sizeof(POLL_REPLY_MESSAGE)];
+  memcpy(first_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+  first_reply[115] = '1';  // node report
+  first_reply[182] = 0;  // good output
+  first_reply[190] = 0x20;  // swout
+  first_reply[211] = 1;  // bind index
+
+  uint8_t second_reply[sizeof(POLL_REPLY_MESSAGE)];
+  memcpy(second_reply, first_reply, sizeof(first_reply));
+  second_reply[19] = 3;  // subnet address
+  memset(second_reply + 174, 0x80, 4);  // port types
+  second_reply[183] = 0x80;  // good output
+  memset(second_reply + 186, 0, 4);  // swin
+  memset(second_reply + 190, 0x30, 4);  // swout
+  second_reply[191] = 0x33;
+  second_reply[211] = 2;  // bind index
+
+  {
+    SocketVerifier verifer(m_socket);
+    ExpectedBroadcast(first_reply, sizeof(first_reply));
+    ExpectedBroadcast(second_reply, sizeof(second_reply));
+    OLA_ASSERT(node.SetOutputPortUniverse(5, 3));
+    OLA_ASSERT_EQ((uint8_t) 0x33, node.GetOutputPortUniverse(5));
+  }
+
+  uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+
+  // data for the first virtual node doesn't reach port 5
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+  }
+
+  {
+    SocketVerifier verifer(m_socket);
+    DMX_MESSAGE[14] = 0x33;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
+  }
+}
+
+
 void ArtNetNodeTest::testBroadcastSendDMX() {
   m_socket->SetDiscardMode(true);
 
@@ -1019,6 +1121,123 @@ void ArtNetNodeTest::testNonBroadcastSendDMX() {
   }
 }
 
+/**
+ * Check that an ArtSync is sent after the DMX for a frame.
+ */
+/**
+ * Check that nodes we haven't heard from are removed by the expiry timer.
+ */
+void ArtNetNodeTest::testSubscriberExpiry() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  const uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+  DmxBuffer dmx;
+  dmx.SetFromString("0,1,2,3,4,5");
+
+  // The poll reply has an output port for 4:2:3
+  vector<IPV4Address> node_addresses;
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE), peer_ip);
+    node.GetSubscribedNodes(m_port_id, &node_addresses);
+    OLA_ASSERT_EQ(static_cast<size_t>(1), node_addresses.size());
+
+    ExpectedSend(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+  }
+
+  // once the node times out, nothing is sent
+  {
+    SocketVerifier verifer(m_socket);
+    // Timeouts run before the wake up time is updated, so the node isn't
+    // removed until the sweep after the one on the first iteration.
+    m_clock.AdvanceTime(32, 0);
+    ss.RunOnce();
+    m_clock.AdvanceTime(1, 0);
+    ss.RunOnce();
+    node_addresses.clear();
+    node.GetSubscribedNodes(m_port_id, &node_addresses);
+    OLA_ASSERT(node_addresses.empty());
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+  }
+}
+
+
+void ArtNetNodeTest::testSendSync() {
+  m_socket->SetDiscardMode(true);
+
+  ArtNetNodeOptions node_options;
+  node_options.always_broadcast = true;
+  node_options.send_sync = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+  node.SetInputPortUniverse(0, 2);
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  DmxBuffer dmx;
+  dmx.SetFromString("0,1,2,3,4,5");
+
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t DMX_MESSAGE[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      1,  // physical port
+      0x23, 4,  // subnet & net address
+      0, 6,  // dmx length
+      0, 1, 2, 3, 4, 5
+    };
+    const uint8_t DMX_MESSAGE2[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      0,  // physical port
+      0x22, 4,  // subnet & net address
+      0, 6,  // dmx length
+      0, 1, 2, 3, 4, 5
+    };
+    ExpectedBroadcast(DMX_MESSAGE, sizeof(DMX_MESSAGE));
+    ExpectedBroadcast(DMX_MESSAGE2, sizeof(DMX_MESSAGE2));
+    OLA_ASSERT(node.SendDMX(m_port_id, dmx));
+    OLA_ASSERT(node.SendDMX(0, dmx));
+    m_socket->Verify();
+
+    // a single sync follows once we return to the event loop
+    ExpectedBroadcast(SYNC_MESSAGE, sizeof(SYNC_MESSAGE));
+    ss.RunOnce();
+  }
+
+  // nothing more is sent until the next frame
+  {
+    SocketVerifier verifer(m_socket);
+    ss.RunOnce();
+  }
+}
+
+
 /**
  * Check that receiving DMX works
  */
@@ -1093,6 +1312,75 @@ void ArtNetNodeTest::testReceiveDMX() {
   }
 }
 
+/**
+ * Check that data is held until an ArtSync arrives.
+ */
+void ArtNetNodeTest::testReceiveSync() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.hold_for_sync = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupOutputPort(&node);
+  DmxBuffer input_buffer;
+  node.SetDMXHandler(m_port_id,
+                     &input_buffer,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  uint8_t DMX_MESSAGE[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 6,  // dmx length
+    0, 1, 2, 3, 4, 5
+  };
+
+  // Until we've seen an ArtSync the data is used immediately
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
+
+    m_got_dmx = false;
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+  }
+
+  // Now the data is held until the next ArtSync
+  {
+    SocketVerifier verifer(m_socket);
+    DMX_MESSAGE[12] = 1;
+    DMX_MESSAGE[18] = 10;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT_FALSE(m_got_dmx);
+    OLA_ASSERT_EQ(string("0,1,2,3,4,5"), input_buffer.ToString());
+
+    ReceiveFromPeer(SYNC_MESSAGE, sizeof(SYNC_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("10,1,2,3,4,5"), input_buffer.ToString());
+  }
+
+  // If the ArtSyncs stop, we go back to using the data immediately
+  {
+    SocketVerifier verifer(m_socket);
+    m_clock.AdvanceTime(5, 0);
+    m_got_dmx = false;
+    DMX_MESSAGE[12] = 2;
+    DMX_MESSAGE[18] = 20;
+    ReceiveFromPeer(DMX_MESSAGE, sizeof(DMX_MESSAGE), peer_ip);
+    OLA_ASSERT(m_got_dmx);
+    OLA_ASSERT_EQ(string("20,1,2,3,4,5"), input_buffer.ToString());
+  }
+}
+
 /**
  * Check that receiving DMX for universe 0 works.
  */
@@ -1359,6 +1647,73 @@ void ArtNetNodeTest::testHTPMerge() {
 }
 
 
+/**
+ * Check that more than two sources can be merged.
+ */
+void ArtNetNodeTest::testMaxMergeSources() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.max_merge_sources = 3;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupOutputPort(&node);
+  DmxBuffer input_buffer;
+  node.SetDMXHandler(m_port_id,
+                     &input_buffer,
+                     ola::NewCallback(this, &ArtNetNodeTest::NewDmx));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+
+  uint8_t message[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x50,
+    0x0, 14,
+    0,  // seq #
+    1,  // physical port
+    0x23, 4,  // subnet & net address
+    0, 4,  // dmx length
+    0, 0, 0, 0
+  };
+  // each source sets one slot
+  uint8_t *data = message + sizeof(message) - 4;
+
+  data[0] = 10;
+  ReceiveFromPeer(message, sizeof(message), peer_ip);
+  data[0] = 0;
+  data[1] = 20;
+  ReceiveFromPeer(message, sizeof(message), peer_ip2);
+  data[1] = 0;
+  data[2] = 30;
+  ReceiveFromPeer(message, sizeof(message), peer_ip3);
+  OLA_ASSERT_EQ(string("10,20,30,0"), input_buffer.ToString());
+
+  // a fourth source is ignored
+  IPV4Address peer_ip4;
+  ola::network::IPV4Address::FromString("10.0.0.13", &peer_ip4);
+  m_got_dmx = false;
+  data[2] = 0;
+  data[3] = 40;
+  ReceiveFromPeer(message, sizeof(message), peer_ip4);
+  OLA_ASSERT_FALSE(m_got_dmx);
+  OLA_ASSERT_EQ(string("10,20,30,0"), input_buffer.ToString());
+
+  // once the first source times out, the fourth takes its place
+  m_clock.AdvanceTime(6, 0);
+  data[3] = 0;
+  data[1] = 20;
+  ReceiveFromPeer(message, sizeof(message), peer_ip2);
+  data[1] = 0;
+  data[2] = 30;
+  ReceiveFromPeer(message, sizeof(message), peer_ip3);
+  m_clock.AdvanceTime(6, 0);
+  data[2] = 0;
+  data[3] = 40;
+  ReceiveFromPeer(message, sizeof(message), peer_ip4);
+  OLA_ASSERT(m_got_dmx);
+  OLA_ASSERT_EQ(string("0,20,30,40"), input_buffer.ToString());
+}
+
+
 /**
  * Check that LTP merging works
  */
@@ -1778,6 +2133,116 @@ void ArtNetNodeTest::testControllerIncrementalDiscovery() {
 }
 
 
+/**
+ * Check that incremental discovery uses the TODs the nodes have sent.
+ */
+void ArtNetNodeTest::testCachedTod() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  const uint8_t poll_reply_message[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x21,
+    10, 0, 0, 10,
+    0x36, 0x19,
+    0, 0,
+    4, 2,  // subnet address
+    0x4, 0x31,  // oem
+    0,
+    0xd2,
+    0x70, 0x7a,  // esta
+    'P', 'e', 'e', 'r', ' ', '1', 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,  // short name
+    'T', 'h', 'i', 's', ' ', 'i', 's', ' ', 't', 'h', 'e', ' ',
+    'v', 'e', 'r', 'y', ' ', 'l', 'o', 'n', 'g', ' ',
+    'n', 'a', 'm', 'e',
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // long name
+    '#', '0', '0', '0', '1', ' ', '[', '0', ']', ' ', 'O', 'L', 'A',
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0,
+    0,  // node report
+    0, 4,  // num ports
+    0x80, 0x80, 0x80, 0x80,  // 4 output ports
+    8, 8, 8, 8,
+    0, 0, 0, 0,
+    0x0, 0x0, 0x0, 0x0,  // swin
+    0x23, 0x0, 0x0, 0x0,  // swout
+    0, 0, 0, 0, 0, 0, 0,  // video, macro, remote, spare, style
+    0x12, 0x34, 0x56, 0x12, 0x34, 0x56,  // mac address
+    0xa, 0x0, 0x0, 0xa,
+    0,
+    8,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0  // filler
+  };
+
+  // a node subscribes to the port, and sends its TOD
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(poll_reply_message, sizeof(poll_reply_message), peer_ip);
+  }
+  PopulateTod();
+
+  UIDSet uids;
+  uids.AddUID(UID(0x7a70, 0));
+
+  // discovery completes straight away, without sending anything
+  {
+    SocketVerifier verifer(m_socket);
+    node.RunIncrementalDiscovery(
+        m_port_id,
+        ola::NewSingleCallback(this, &ArtNetNodeTest::DiscoveryComplete));
+    OLA_ASSERT(m_discovery_done);
+    OLA_ASSERT_EQ(uids, m_uids);
+  }
+
+  // once the TOD is old, we ask for it again
+  m_clock.AdvanceTime(20, 0);
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(poll_reply_message, sizeof(poll_reply_message), peer_ip);
+  }
+  m_clock.AdvanceTime(20, 0);
+  ss.RunOnce();  // update the wake up time
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t tod_request[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x80,
+      0x0, 14,
+      0, 0,
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // full
+      1,  // universe array size
+      0x23,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    };
+
+    ExpectedBroadcast(tod_request, sizeof(tod_request));
+    m_discovery_done = false;
+    node.RunIncrementalDiscovery(
+        m_port_id,
+        ola::NewSingleCallback(this, &ArtNetNodeTest::DiscoveryComplete));
+    OLA_ASSERT_FALSE(m_discovery_done);
+  }
+
+  // the node responds, which completes discovery
+  PopulateTod();
+  OLA_ASSERT(m_discovery_done);
+  OLA_ASSERT_EQ(uids, m_uids);
+}
+
+
 /**
  * Check that unsolicated TOD messages work
  */
@@ -2259,6 +2724,124 @@ void ArtNetNodeTest::testRDMRequestUIDMismatch() {
 }
 
 
+/**
+ * Check that requests to different UIDs can be in flight at once.
+ */
+void ArtNetNodeTest::testConcurrentRDMRequests() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.rdm_max_in_flight = 2;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  SetupInputPort(&node);
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  PopulateTod();
+
+  {
+    SocketVerifier verifer(m_socket);
+    SendRDMRequest(
+        &node,
+        ola::NewSingleCallback(this, &ArtNetNodeTest::FinalizeRDM));
+  }
+
+  // a second request to the same UID waits for the first to complete
+  {
+    SocketVerifier verifer(m_socket);
+    RDMGetRequest *request = new RDMGetRequest(
+        UID(1, 2), UID(0x7a70, 0), 1, 1, 10, 296, NULL, 0);
+    node.SendRDMRequest(
+        m_port_id, request,
+        ola::NewSingleCallback(this, &ArtNetNodeTest::ExpectTimeout));
+  }
+
+  // a request to a different UID is sent, it isn't in the TOD so it's
+  // broadcast
+  {
+    SocketVerifier verifer(m_socket);
+    RDMGetRequest *request = new RDMGetRequest(
+        UID(1, 2), UID(0x7a70, 1), 0, 1, 10, 296, NULL, 0);
+
+    const uint8_t rdm_request[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x83,
+      0x0, 14,
+      1, 0,
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // process
+      0x23,
+      // rdm data
+      1, 24,  // sub code & length
+      0x7a, 0x70, 0, 0, 0, 1,   // dst uid
+      0, 1, 0, 0, 0, 2,   // src uid
+      0, 1, 0, 0, 10,  // transaction, port id, msg count & sub device
+      0x20, 0x1, 0x28, 0,  // command, param id, param data length
+      0x02, 0x27
+    };
+
+    ExpectedBroadcast(rdm_request, sizeof(rdm_request));
+    node.SendRDMRequest(
+        m_port_id, request,
+        ola::NewSingleCallback(this, &ArtNetNodeTest::ExpectTimeout));
+  }
+
+  // the response to the first request arrives, and the queued request is sent
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t rdm_request[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x83,
+      0x0, 14,
+      1, 0,
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // process
+      0x23,
+      // rdm data
+      1, 24,  // sub code & length
+      0x7a, 0x70, 0, 0, 0, 0,   // dst uid
+      0, 1, 0, 0, 0, 2,   // src uid
+      1, 1, 0, 0, 10,  // transaction, port id, msg count & sub device
+      0x20, 0x1, 0x28, 0,  // command, param id, param data length
+      0x02, 0x27
+    };
+    ExpectedSend(rdm_request, sizeof(rdm_request), peer_ip);
+
+    const uint8_t rdm_response[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x83,
+      0x0, 14,
+      1, 0,
+      0, 0, 0, 0, 0, 0, 0,
+      4,  // net
+      0,  // process
+      0x23,
+      // rdm data
+      1, 28,  // sub code & length
+      0, 1, 0, 0, 0, 2,   // dst uid
+      0x7a, 0x70, 0, 0, 0, 0,   // src uid
+      0, 0, 0, 0, 10,  // transaction, port id, msg count & sub device
+      0x21, 1, 40, 4,  // command, param id, param data length
+      0x5a, 0xa5, 0x5a, 0xa5,  // param data
+      0x4, 0x2c  // checksum
+    };
+
+    ReceiveFromPeer(rdm_response, sizeof(rdm_response), peer_ip);
+    OLA_ASSERT(m_rdm_response);
+    delete m_rdm_response;
+    OLA_ASSERT_FALSE(m_got_rdm_timeout);
+  }
+
+  // the other two time out
+  m_clock.AdvanceTime(3, 0);  // timeout is 2s
+  ss.RunOnce();
+  OLA_ASSERT(m_got_rdm_timeout);
+}
+
+
 /**
  * Check Timecode sending works
  */
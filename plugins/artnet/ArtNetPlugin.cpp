@@ -23,8 +23,10 @@
 #include <string>
 
 #include "ola/Logging.h"
+#include "ola/network/InterfaceMonitor.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/artnet/ArtNetPlugin.h"
 #include "plugins/artnet/ArtNetPluginDescription.h"
 #include "plugins/artnet/ArtNetDevice.h"
@@ -48,6 +50,7 @@ bool ArtNetPlugin::StartHook() {
 
   if (!m_device->Start()) {
     delete m_device;
+    m_device = NULL;
     return false;
   }
   // Register device will restore the port settings. To avoid a flurry of
@@ -65,12 +68,22 @@ bool ArtNetPlugin::StopHook() {
     m_plugin_adaptor->UnregisterDevice(m_device);
     bool ret = m_device->Stop();
     delete m_device;
+    m_device = NULL;
     return ret;
   }
   return true;
 }
 
 
+/*
+ * Rebind if the interface the node is using has changed.
+ */
+bool ArtNetPlugin::AffectedBy(
+    const ola::network::InterfaceChanges &changes) const {
+  return m_device && changes.Affects(m_device->GetInterface());
+}
+
+
 string ArtNetPlugin::Description() const {
   return plugin_description;
 }
@@ -99,8 +112,12 @@ bool ArtNetPlugin::SetDefaultPreferences() {
                                          ArtNetDevice::K_ARTNET_SUBNET);
   save |= m_preferences->SetDefaultValue(
       ArtNetDevice::K_OUTPUT_PORT_KEY,
-      UIntValidator(0, 16),
+      UIntValidator(0, 255),
       ArtNetDevice::K_DEFAULT_OUTPUT_PORT_COUNT);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_INPUT_PORT_KEY,
+      UIntValidator(0, 255),
+      ArtNetDevice::K_DEFAULT_INPUT_PORT_COUNT);
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_ALWAYS_BROADCAST_KEY,
                                          BoolValidator(),
                                          false);
@@ -110,6 +127,24 @@ bool ArtNetPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_LOOPBACK_KEY,
                                          BoolValidator(),
                                          false);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_SEND_SYNC_KEY,
+                                         BoolValidator(),
+                                         false);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_HOLD_FOR_SYNC_KEY,
+                                         BoolValidator(),
+                                         false);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_VIRTUAL_NODES_KEY,
+                                         BoolValidator(),
+                                         false);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_MAX_MERGE_SOURCES_KEY,
+      UIntValidator(1, 32),
+      ArtNetDevice::K_DEFAULT_MAX_MERGE_SOURCES);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_RDM_MAX_IN_FLIGHT_KEY,
+      UIntValidator(1, 16),
+      ArtNetDevice::K_DEFAULT_RDM_MAX_IN_FLIGHT);
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
 
   if (save) {
     m_preferences->Save();
@@ -53,6 +53,7 @@ class ArtNetPlugin : public Plugin {
   bool StartHook();
   bool StopHook();
   bool SetDefaultPreferences();
+  bool AffectedBy(const ola::network::InterfaceChanges &changes) const;
 
   ArtNetDevice *m_device;  // only have one device
 
@@ -93,8 +93,9 @@ string ArtNetInputPort::Description() const {
 
   std::ostringstream str;
   str << "ArtNet Universe "
-      << static_cast<int>(m_node->NetAddress()) << ":"
-      << static_cast<int>(m_node->SubnetAddress()) << ":"
+      << static_cast<int>(m_node->GetOutputPortNet(PortId())) << ":"
+      << static_cast<int>(m_node->GetOutputPortUniverse(PortId()) >> 4)
+      << ":"
       << static_cast<int>(m_node->GetOutputPortUniverse(PortId()));
   return str.str();
 }
@@ -110,11 +111,6 @@ void ArtNetInputPort::TriggerDiscovery() {
 
 bool ArtNetOutputPort::WriteDMX(const DmxBuffer &buffer,
                                 OLA_UNUSED uint8_t priority) {
-  if (PortId() >= ARTNET_MAX_PORTS) {
-    OLA_WARN << "Invalid artnet port id " << PortId();
-    return false;
-  }
-
   return m_node->SendDMX(PortId(), buffer);
 }
 
@@ -171,8 +167,9 @@ string ArtNetOutputPort::Description() const {
 
   std::ostringstream str;
   str << "ArtNet Universe "
-      << static_cast<int>(m_node->NetAddress()) << ":"
-      << static_cast<int>(m_node->SubnetAddress()) << ":"
+      << static_cast<int>(m_node->GetInputPortNet(PortId())) << ":"
+      << static_cast<int>(m_node->GetInputPortUniverse(PortId()) >> 4)
+      << ":"
       << static_cast<int>(m_node->GetInputPortUniverse(PortId()));
   return str.str();
 }
@@ -48,6 +48,20 @@ plugins_artnet_ArtNetTester_SOURCES = plugins/artnet/ArtNetNodeTest.cpp
 plugins_artnet_ArtNetTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 plugins_artnet_ArtNetTester_LDADD = $(COMMON_TESTING_LIBS) \
                                     plugins/artnet/libolaartnetnode.la
+
+# BENCHMARKS
+##################################################
+# These use the MockUDPSocket from libolatesting.
+if BUILD_TESTS
+benchmark_programs += plugins/artnet/ArtNetBenchmark
+
+plugins_artnet_ArtNetBenchmark_SOURCES = plugins/artnet/ArtNetNodeBenchmark.cpp
+plugins_artnet_ArtNetBenchmark_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+plugins_artnet_ArtNetBenchmark_LDADD = plugins/artnet/libolaartnetnode.la \
+                                       common/testing/libolatesting.la \
+                                       $(COMMON_BENCHMARK_LIBS) \
+                                       $(CPPUNIT_LIBS)
+endif
 endif
 
 EXTRA_DIST += plugins/artnet/README.md
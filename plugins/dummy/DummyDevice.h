@@ -22,6 +22,7 @@
 #define PLUGINS_DUMMY_DUMMYDEVICE_H_
 
 #include <string>
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/Device.h"
 #include "plugins/dummy/DummyPort.h"
 
@@ -37,15 +38,18 @@ class DummyDevice: public Device {
   DummyDevice(
       AbstractPlugin *owner,
       const std::string &name,
-      const DummyPort::Options &port_options)
+      const DummyPort::Options &port_options,
+      ola::thread::SchedulerInterface *scheduler = NULL)
       : Device(owner, name),
-        m_port_options(port_options) {
+        m_port_options(port_options),
+        m_scheduler(scheduler) {
   }
 
   std::string DeviceId() const { return "1"; }
 
  protected:
   const DummyPort::Options m_port_options;
+  ola::thread::SchedulerInterface *m_scheduler;
 
   bool StartHook();
 };
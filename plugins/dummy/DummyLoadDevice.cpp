@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DummyLoadDevice.cpp
+ * A device that generates and sinks DMX load, for benchmarking olad.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "olad/PluginAdaptor.h"
+#include "plugins/dummy/DummyLoadDevice.h"
+#include "plugins/dummy/DummyLoadPort.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using std::string;
+using std::vector;
+
+const char DummyLoadDevice::GENERATED_FRAMES_VAR[] =
+    "dummy-load-generated-frames";
+const char DummyLoadDevice::RECEIVED_FRAMES_VAR[] =
+    "dummy-load-received-frames";
+
+DummyLoadDevice::DummyLoadDevice(AbstractPlugin *owner,
+                                 const string &name,
+                                 PluginAdaptor *plugin_adaptor,
+                                 const Options &options)
+    : Device(owner, name),
+      m_plugin_adaptor(plugin_adaptor),
+      m_options(options),
+      m_timeout_id(ola::thread::INVALID_TIMEOUT) {
+}
+
+
+/*
+ * Start this device
+ */
+bool DummyLoadDevice::StartHook() {
+  if (!m_options.frame_rate) {
+    return false;
+  }
+
+  ExportMap *export_map = m_plugin_adaptor->GetExportMap();
+  CounterVariable *received = export_map ?
+      export_map->GetCounterVar(RECEIVED_FRAMES_VAR) : NULL;
+
+  for (unsigned int i = 0; i < m_options.port_count; i++) {
+    DummyLoadInputPort *input_port = new DummyLoadInputPort(
+        this, i, m_plugin_adaptor, m_options.change_density);
+    if (!AddPort(input_port)) {
+      delete input_port;
+      return false;
+    }
+    m_input_ports.push_back(input_port);
+
+    DummyLoadOutputPort *output_port = new DummyLoadOutputPort(
+        this, i, received);
+    if (!AddPort(output_port)) {
+      delete output_port;
+      return false;
+    }
+  }
+
+  // One timer for all the ports, so thousands of them stay cheap.
+  m_timeout_id = m_plugin_adaptor->RegisterRepeatingTimeout(
+      TimeInterval(
+          static_cast<int64_t>(USEC_IN_SECONDS / m_options.frame_rate)),
+      NewCallback(this, &DummyLoadDevice::SendFrames));
+  return true;
+}
+
+
+/*
+ * Stop this device
+ */
+void DummyLoadDevice::PrePortStop() {
+  if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
+    m_plugin_adaptor->RemoveTimeout(m_timeout_id);
+    m_timeout_id = ola::thread::INVALID_TIMEOUT;
+  }
+  m_input_ports.clear();
+}
+
+
+bool DummyLoadDevice::SendFrames() {
+  vector<DummyLoadInputPort*>::iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    (*iter)->NextFrame();
+  }
+  ExportMap *export_map = m_plugin_adaptor->GetExportMap();
+  if (export_map) {
+    (*export_map->GetCounterVar(GENERATED_FRAMES_VAR)) += m_input_ports.size();
+  }
+  return true;
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DummyLoadDevice.h
+ * A device that generates and sinks DMX load, for benchmarking olad.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_DUMMY_DUMMYLOADDEVICE_H_
+#define PLUGINS_DUMMY_DUMMYLOADDEVICE_H_
+
+#include <string>
+#include <vector>
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/Device.h"
+
+namespace ola {
+
+class AbstractPlugin;
+class PluginAdaptor;
+
+namespace plugin {
+namespace dummy {
+
+class DummyLoadInputPort;
+
+/**
+ * A device with a number of input ports that produce frames at a fixed rate,
+ * and the same number of output ports that count the frames they receive.
+ */
+class DummyLoadDevice: public Device {
+ public:
+  struct Options {
+   public:
+    Options()
+        : port_count(0),
+          frame_rate(40),
+          change_density(10) {
+    }
+
+    // The number of input ports, and of output ports.
+    unsigned int port_count;
+    // The frames per second produced by each input port.
+    unsigned int frame_rate;
+    // The percentage of slots changed in each frame.
+    unsigned int change_density;
+  };
+
+  DummyLoadDevice(AbstractPlugin *owner,
+                  const std::string &name,
+                  PluginAdaptor *plugin_adaptor,
+                  const Options &options);
+
+  std::string DeviceId() const { return "2"; }
+
+  // Each universe is normally fed by one of our input ports and sent to one
+  // of our output ports.
+  bool AllowLooping() const { return true; }
+
+ protected:
+  bool StartHook();
+  void PrePortStop();
+
+ private:
+  PluginAdaptor *m_plugin_adaptor;
+  const Options m_options;
+  std::vector<DummyLoadInputPort*> m_input_ports;
+  ola::thread::timeout_id m_timeout_id;
+
+  bool SendFrames();
+
+  static const char GENERATED_FRAMES_VAR[];
+  static const char RECEIVED_FRAMES_VAR[];
+};
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_DUMMY_DUMMYLOADDEVICE_H_
@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DummyLoadPort.cpp
+ * The ports used by the Dummy load generator.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "ola/Constants.h"
+#include "ola/strings/Format.h"
+#include "plugins/dummy/DummyLoadPort.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using std::string;
+
+DummyLoadInputPort::DummyLoadInputPort(AbstractDevice *parent,
+                                       unsigned int id,
+                                       PluginAdaptor *plugin_adaptor,
+                                       unsigned int change_density)
+    : BasicInputPort(parent, id, plugin_adaptor),
+      m_changed_slots(
+          (DMX_UNIVERSE_SIZE * std::min(change_density, 100u) + 99) / 100),
+      m_step(static_cast<uint8_t>(1 + 2 * (id % 8))),
+      m_offset(0) {
+  m_buffer.Blackout();
+}
+
+void DummyLoadInputPort::NextFrame() {
+  // Building the frame in an array is cheaper than SetChannel() per slot.
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  unsigned int length = sizeof(data);
+  m_buffer.Get(data, &length);
+  for (unsigned int i = 0; i < m_changed_slots; i++) {
+    unsigned int slot = (m_offset + i) % DMX_UNIVERSE_SIZE;
+    data[slot] = static_cast<uint8_t>(data[slot] + m_step);
+  }
+  m_offset = (m_offset + m_changed_slots) % DMX_UNIVERSE_SIZE;
+  m_buffer.Set(data, length);
+  DmxChanged();
+}
+
+
+DummyLoadOutputPort::DummyLoadOutputPort(AbstractDevice *parent,
+                                         unsigned int id,
+                                         CounterVariable *frame_counter)
+    : BasicOutputPort(parent, id),
+      m_frame_counter(frame_counter),
+      m_frame_count(0),
+      m_last_checksum(0) {
+}
+
+bool DummyLoadOutputPort::WriteDMX(const DmxBuffer &buffer,
+                                   uint8_t priority) {
+  m_frame_count++;
+  m_last_checksum = Checksum(buffer);
+  if (m_frame_counter) {
+    (*m_frame_counter)++;
+  }
+  (void) priority;
+  return true;
+}
+
+string DummyLoadOutputPort::Description() const {
+  std::ostringstream str;
+  str << "Load Sink, " << m_frame_count << " frames, checksum "
+      << strings::ToHex(m_last_checksum);
+  return str.str();
+}
+
+uint32_t DummyLoadOutputPort::Checksum(const DmxBuffer &buffer) {
+  return buffer.Hash();
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,105 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DummyLoadPort.h
+ * The ports used by the Dummy load generator.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_DUMMY_DUMMYLOADPORT_H_
+#define PLUGINS_DUMMY_DUMMYLOADPORT_H_
+
+#include <stdint.h>
+#include <string>
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "olad/Port.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+/**
+ * An input port that produces animated frames. Each call to NextFrame()
+ * changes a window of slots, which moves through the universe from frame to
+ * frame.
+ */
+class DummyLoadInputPort: public BasicInputPort {
+ public:
+  /**
+   * Create a new DummyLoadInputPort
+   * @param parent the parent device for this port
+   * @param id the ID of this port
+   * @param plugin_adaptor the PluginAdaptor to use
+   * @param change_density the percentage of slots changed in each frame
+   */
+  DummyLoadInputPort(AbstractDevice *parent,
+                     unsigned int id,
+                     PluginAdaptor *plugin_adaptor,
+                     unsigned int change_density);
+
+  std::string Description() const { return "Load Generator"; }
+  const DmxBuffer &ReadDMX() const { return m_buffer; }
+
+  /**
+   * Update the frame and pass it on to the universe.
+   */
+  void NextFrame();
+
+ private:
+  const unsigned int m_changed_slots;
+  // Odd, so each slot cycles through every value.
+  const uint8_t m_step;
+  unsigned int m_offset;
+  DmxBuffer m_buffer;
+};
+
+
+/**
+ * An output port that counts and checksums the frames written to it.
+ */
+class DummyLoadOutputPort: public BasicOutputPort {
+ public:
+  /**
+   * Create a new DummyLoadOutputPort
+   * @param parent the parent device for this port
+   * @param id the ID of this port
+   * @param frame_counter incremented for each frame, may be NULL.
+   */
+  DummyLoadOutputPort(AbstractDevice *parent,
+                      unsigned int id,
+                      CounterVariable *frame_counter);
+
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
+  std::string Description() const;
+
+  unsigned int FrameCount() const { return m_frame_count; }
+
+  /**
+   * The FNV-1a hash of the last frame, or 0 if no frames have been written.
+   */
+  uint32_t LastChecksum() const { return m_last_checksum; }
+
+  static uint32_t Checksum(const DmxBuffer &buffer);
+
+ private:
+  CounterVariable *m_frame_counter;
+  unsigned int m_frame_count;
+  uint32_t m_last_checksum;
+};
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_DUMMY_DUMMYLOADPORT_H_
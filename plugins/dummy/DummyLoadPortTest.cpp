@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DummyLoadPortTest.cpp
+ * Test fixture for the Dummy load generator ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/dummy/DummyLoadPort.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+class DummyLoadPortTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DummyLoadPortTest);
+  CPPUNIT_TEST(testGenerator);
+  CPPUNIT_TEST(testFullDensity);
+  CPPUNIT_TEST(testSink);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testGenerator();
+  void testFullDensity();
+  void testSink();
+
+ private:
+  unsigned int ChangedSlots(const DmxBuffer &before, const DmxBuffer &after);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DummyLoadPortTest);
+
+
+unsigned int DummyLoadPortTest::ChangedSlots(const DmxBuffer &before,
+                                             const DmxBuffer &after) {
+  unsigned int changed = 0;
+  for (unsigned int i = 0; i < after.Size(); i++) {
+    if (before.Get(i) != after.Get(i)) {
+      changed++;
+    }
+  }
+  return changed;
+}
+
+
+/*
+ * Check the generator changes the right number of slots.
+ */
+void DummyLoadPortTest::testGenerator() {
+  DummyLoadInputPort port(NULL, 0, NULL, 10);
+  OLA_ASSERT_EQ(512u, port.ReadDMX().Size());
+
+  // 10% of 512, rounded up
+  DmxBuffer last(port.ReadDMX());
+  port.NextFrame();
+  OLA_ASSERT_EQ(52u, ChangedSlots(last, port.ReadDMX()));
+  OLA_ASSERT_EQ((uint8_t) 1, port.ReadDMX().Get(0));
+  OLA_ASSERT_EQ((uint8_t) 0, port.ReadDMX().Get(52));
+
+  // the window moves on
+  last = port.ReadDMX();
+  port.NextFrame();
+  OLA_ASSERT_EQ(52u, ChangedSlots(last, port.ReadDMX()));
+  OLA_ASSERT_EQ((uint8_t) 1, port.ReadDMX().Get(0));
+  OLA_ASSERT_EQ((uint8_t) 1, port.ReadDMX().Get(52));
+
+  // a density of 0 sends the same frame each time
+  DummyLoadInputPort static_port(NULL, 1, NULL, 0);
+  last = static_port.ReadDMX();
+  static_port.NextFrame();
+  OLA_ASSERT(last == static_port.ReadDMX());
+}
+
+
+/*
+ * Check every slot changes with a density of 100.
+ */
+void DummyLoadPortTest::testFullDensity() {
+  DummyLoadInputPort port(NULL, 2, NULL, 100);
+  for (unsigned int i = 0; i < 300; i++) {
+    DmxBuffer last(port.ReadDMX());
+    port.NextFrame();
+    OLA_ASSERT_EQ(512u, ChangedSlots(last, port.ReadDMX()));
+  }
+}
+
+
+/*
+ * Check the sink counts and checksums frames.
+ */
+void DummyLoadPortTest::testSink() {
+  ExportMap export_map;
+  CounterVariable *counter = export_map.GetCounterVar("frames");
+  DummyLoadOutputPort port(NULL, 0, counter);
+  OLA_ASSERT_EQ(0u, port.FrameCount());
+  OLA_ASSERT_EQ(0u, port.LastChecksum());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(port.WriteDMX(buffer, 100));
+  OLA_ASSERT_EQ(1u, port.FrameCount());
+  OLA_ASSERT_EQ(1u, counter->Get());
+  const uint32_t checksum = port.LastChecksum();
+  OLA_ASSERT_EQ(DummyLoadOutputPort::Checksum(buffer), checksum);
+
+  buffer.SetChannel(1, 4);
+  OLA_ASSERT(port.WriteDMX(buffer, 100));
+  OLA_ASSERT_EQ(2u, port.FrameCount());
+  OLA_ASSERT_EQ(2u, counter->Get());
+  OLA_ASSERT_NE(checksum, port.LastChecksum());
+
+  // the empty frame hashes to the FNV offset basis
+  OLA_ASSERT_EQ(2166136261u, DummyLoadOutputPort::Checksum(DmxBuffer()));
+  OLA_ASSERT_EQ(std::string("Load Sink, 2 frames, checksum 0x"),
+                port.Description().substr(0, 32));
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
@@ -22,10 +22,12 @@
 #include <stdio.h>
 #include <string>
 
+#include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
 #include "plugins/dummy/DummyDevice.h"
+#include "plugins/dummy/DummyLoadDevice.h"
 #include "plugins/dummy/DummyPort.h"
 #include "plugins/dummy/DummyPlugin.h"
 #include "plugins/dummy/DummyPluginDescription.h"
@@ -46,11 +48,27 @@ const char DummyPlugin::DEVICE_NAME[] = "Dummy Device";
 const char DummyPlugin::DIMMER_COUNT_KEY[] = "dimmer_count";
 const char DummyPlugin::DIMMER_SUBDEVICE_COUNT_KEY[] = "dimmer_subdevice_count";
 const char DummyPlugin::DUMMY_DEVICE_COUNT_KEY[] = "dummy_device_count";
+const unsigned int DummyPlugin::DEFAULT_LOAD_CHANGE_DENSITY = 10;
+const unsigned int DummyPlugin::DEFAULT_LOAD_FRAME_RATE = 40;
+// The load generator is off by default.
+const unsigned int DummyPlugin::DEFAULT_LOAD_PORT_COUNT = 0;
+const char DummyPlugin::LOAD_CHANGE_DENSITY_KEY[] = "load_change_density";
+const char DummyPlugin::LOAD_DEVICE_NAME[] = "Dummy Load Generator";
+const char DummyPlugin::LOAD_FRAME_RATE_KEY[] = "load_frame_rate";
+const char DummyPlugin::LOAD_PORT_COUNT_KEY[] = "load_port_count";
+const unsigned int DummyPlugin::MAX_LOAD_PORT_COUNT = 10000;
 const char DummyPlugin::MOVING_LIGHT_COUNT_KEY[] = "moving_light_count";
 const char DummyPlugin::NETWORK_COUNT_KEY[] = "network_device_count";
 const char DummyPlugin::PLUGIN_NAME[] = "Dummy";
 const char DummyPlugin::PLUGIN_PREFIX[] = "dummy";
 const char DummyPlugin::SENSOR_COUNT_KEY[] = "sensor_device_count";
+const char DummyPlugin::SIMULATED_ACK_TIMER_PERCENT_KEY[] =
+    "simulated_ack_timer_percent";
+const char DummyPlugin::SIMULATED_RESPONDER_COUNT_KEY[] =
+    "simulated_responder_count";
+const char DummyPlugin::SIMULATED_RESPONSE_DELAY_KEY[] =
+    "simulated_response_delay";
+const uint16_t DummyPlugin::MAX_SIMULATED_RESPONDER_COUNT = 20000;
 
 /*
  * Start the plugin
@@ -100,13 +118,26 @@ bool DummyPlugin::StartHook() {
     options.number_of_network_responders = DEFAULT_DEVICE_COUNT;
   }
 
+  // The simulated line is off unless all the settings are valid.
+  SimulatedRDMLine::Options &line_options = options.simulated_line;
+  if (!StringToInt(m_preferences->GetValue(SIMULATED_RESPONDER_COUNT_KEY),
+                   &line_options.responder_count) ||
+      !StringToInt(m_preferences->GetValue(SIMULATED_ACK_TIMER_PERCENT_KEY),
+                   &line_options.ack_timer_percent) ||
+      !StringToInt(m_preferences->GetValue(SIMULATED_RESPONSE_DELAY_KEY),
+                   &line_options.response_delay_ms)) {
+    line_options.responder_count = 0;
+  }
+
   std::auto_ptr<DummyDevice> device(
-      new DummyDevice(this, DEVICE_NAME, options));
+      new DummyDevice(this, DEVICE_NAME, options, m_plugin_adaptor));
   if (!device->Start()) {
     return false;
   }
   m_device = device.release();
   m_plugin_adaptor->RegisterDevice(m_device);
+
+  StartLoadDevice();
   return true;
 }
 
@@ -116,6 +147,13 @@ bool DummyPlugin::StartHook() {
  * @return true on success, false on failure
  */
 bool DummyPlugin::StopHook() {
+  if (m_load_device) {
+    m_plugin_adaptor->UnregisterDevice(m_load_device);
+    m_load_device->Stop();
+    delete m_load_device;
+    m_load_device = NULL;
+  }
+
   if (m_device) {
     m_plugin_adaptor->UnregisterDevice(m_device);
     bool ret = m_device->Stop();
@@ -126,6 +164,38 @@ bool DummyPlugin::StopHook() {
 }
 
 
+/*
+ * Start the load generator, if it's enabled.
+ */
+void DummyPlugin::StartLoadDevice() {
+  DummyLoadDevice::Options options;
+  if (!StringToInt(m_preferences->GetValue(LOAD_PORT_COUNT_KEY),
+                   &options.port_count) ||
+      options.port_count == 0) {
+    return;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(LOAD_FRAME_RATE_KEY),
+                   &options.frame_rate)) {
+    options.frame_rate = DEFAULT_LOAD_FRAME_RATE;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(LOAD_CHANGE_DENSITY_KEY),
+                   &options.change_density)) {
+    options.change_density = DEFAULT_LOAD_CHANGE_DENSITY;
+  }
+
+  std::auto_ptr<DummyLoadDevice> device(
+      new DummyLoadDevice(this, LOAD_DEVICE_NAME, m_plugin_adaptor, options));
+  if (!device->Start()) {
+    OLA_WARN << "Failed to start the dummy load generator";
+    return;
+  }
+  m_load_device = device.release();
+  m_plugin_adaptor->RegisterDevice(m_load_device);
+}
+
+
 string DummyPlugin::Description() const {
   return plugin_description;
 }
@@ -173,6 +243,31 @@ bool DummyPlugin::SetDefaultPreferences() {
                                          IntValidator(0, 254),
                                          DEFAULT_DEVICE_COUNT);
 
+  save |= m_preferences->SetDefaultValue(
+      SIMULATED_RESPONDER_COUNT_KEY,
+      UIntValidator(0, MAX_SIMULATED_RESPONDER_COUNT),
+      0);
+
+  save |= m_preferences->SetDefaultValue(SIMULATED_ACK_TIMER_PERCENT_KEY,
+                                         UIntValidator(0, 100),
+                                         0);
+
+  save |= m_preferences->SetDefaultValue(SIMULATED_RESPONSE_DELAY_KEY,
+                                         UIntValidator(0, 1000),
+                                         0);
+
+  save |= m_preferences->SetDefaultValue(LOAD_PORT_COUNT_KEY,
+                                         UIntValidator(0, MAX_LOAD_PORT_COUNT),
+                                         DEFAULT_LOAD_PORT_COUNT);
+
+  save |= m_preferences->SetDefaultValue(LOAD_FRAME_RATE_KEY,
+                                         UIntValidator(1, 1000),
+                                         DEFAULT_LOAD_FRAME_RATE);
+
+  save |= m_preferences->SetDefaultValue(LOAD_CHANGE_DENSITY_KEY,
+                                         UIntValidator(0, 100),
+                                         DEFAULT_LOAD_CHANGE_DENSITY);
+
   if (save) {
     m_preferences->Save();
   }
@@ -31,12 +31,14 @@ namespace plugin {
 namespace dummy {
 
 class DummyDevice;
+class DummyLoadDevice;
 
 class DummyPlugin: public Plugin {
  public:
     explicit DummyPlugin(PluginAdaptor *plugin_adaptor):
       Plugin(plugin_adaptor),
-      m_device(NULL) {}
+      m_device(NULL),
+      m_load_device(NULL) {}
 
     std::string Name() const { return PLUGIN_NAME; }
     std::string Description() const;
@@ -49,6 +51,9 @@ class DummyPlugin: public Plugin {
     bool SetDefaultPreferences();
 
     DummyDevice *m_device;  // the dummy device
+    DummyLoadDevice *m_load_device;  // the load generator, may be NULL
+
+    void StartLoadDevice();
     static const char ACK_TIMER_COUNT_KEY[];
     static const char ADVANCED_DIMMER_KEY[];
     static const uint8_t DEFAULT_DEVICE_COUNT;
@@ -58,11 +63,23 @@ class DummyPlugin: public Plugin {
     static const char DIMMER_COUNT_KEY[];
     static const char DIMMER_SUBDEVICE_COUNT_KEY[];
     static const char DUMMY_DEVICE_COUNT_KEY[];
+    static const unsigned int DEFAULT_LOAD_CHANGE_DENSITY;
+    static const unsigned int DEFAULT_LOAD_FRAME_RATE;
+    static const unsigned int DEFAULT_LOAD_PORT_COUNT;
+    static const char LOAD_CHANGE_DENSITY_KEY[];
+    static const char LOAD_DEVICE_NAME[];
+    static const char LOAD_FRAME_RATE_KEY[];
+    static const char LOAD_PORT_COUNT_KEY[];
+    static const unsigned int MAX_LOAD_PORT_COUNT;
     static const char MOVING_LIGHT_COUNT_KEY[];
     static const char NETWORK_COUNT_KEY[];
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char SENSOR_COUNT_KEY[];
+    static const char SIMULATED_ACK_TIMER_PERCENT_KEY[];
+    static const char SIMULATED_RESPONDER_COUNT_KEY[];
+    static const char SIMULATED_RESPONSE_DELAY_KEY[];
+    static const uint16_t MAX_SIMULATED_RESPONDER_COUNT;
     static const char SUBDEVICE_COUNT_KEY[];
 };
 }  // namespace dummy
@@ -72,7 +72,8 @@ void AddResponders(map<UID, ola::rdm::RDMControllerInterface*> *responders,
 
 DummyPort::DummyPort(DummyDevice *parent,
                      const Options &options,
-                     unsigned int id)
+                     unsigned int id,
+                     ola::thread::SchedulerInterface *scheduler)
     : BasicOutputPort(parent, id, true, true) {
   UID first_uid(OPEN_LIGHTING_ESTA_CODE, DummyPort::kStartAddress);
   ola::rdm::UIDAllocator allocator(first_uid);
@@ -103,6 +104,13 @@ DummyPort::DummyPort(DummyDevice *parent,
       &m_responders, &allocator, options.number_of_sensor_responders);
   AddResponders<ola::rdm::NetworkResponder>(
       &m_responders, &allocator, options.number_of_network_responders);
+
+  if (scheduler && options.simulated_line.responder_count) {
+    m_simulated_line.reset(
+        new SimulatedRDMLine(scheduler, options.simulated_line));
+    m_discovery_agent.reset(
+        new ola::rdm::DiscoveryAgent(m_simulated_line.get()));
+  }
 }
 
 
@@ -121,11 +129,19 @@ bool DummyPort::WriteDMX(const DmxBuffer &buffer,
 }
 
 void DummyPort::RunFullDiscovery(RDMDiscoveryCallback *callback) {
-  RunDiscovery(callback);
+  if (m_discovery_agent.get()) {
+    RunLineDiscovery(true, callback);
+  } else {
+    RunDiscovery(callback);
+  }
 }
 
 void DummyPort::RunIncrementalDiscovery(RDMDiscoveryCallback *callback) {
-  RunDiscovery(callback);
+  if (m_discovery_agent.get()) {
+    RunLineDiscovery(false, callback);
+  } else {
+    RunDiscovery(callback);
+  }
 }
 
 void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
@@ -134,7 +150,7 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
 
   UID dest = request->DestinationUID();
   if (dest.IsBroadcast()) {
-    if (m_responders.empty()) {
+    if (m_responders.empty() && !m_simulated_line.get()) {
       RunRDMCallback(callback, ola::rdm::RDM_WAS_BROADCAST);
     } else {
       broadcast_request_tracker *tracker = new broadcast_request_tracker;
@@ -142,18 +158,30 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
       tracker->current_count = 0;
       tracker->failed = false;
       tracker->callback = callback;
+      // The simulated line acks once all of its responders have the request.
+      if (m_simulated_line.get()) {
+        tracker->expected_count++;
+      }
       for (ResponderMap::iterator i = m_responders.begin();
            i != m_responders.end(); i++) {
         i->second->SendRDMRequest(
           request->Duplicate(),
           NewSingleCallback(this, &DummyPort::HandleBroadcastAck, tracker));
       }
+      if (m_simulated_line.get()) {
+        m_simulated_line->SendRDMRequest(
+          request->Duplicate(),
+          NewSingleCallback(this, &DummyPort::HandleBroadcastAck, tracker));
+      }
     }
   } else {
     ola::rdm::RDMControllerInterface *controller = STLFindOrNull(
         m_responders, dest);
     if (controller) {
       controller->SendRDMRequest(request.release(), callback);
+    } else if (m_simulated_line.get() &&
+               m_simulated_line->HasResponder(dest)) {
+      m_simulated_line->SendRDMRequest(request.release(), callback);
     } else {
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
     }
@@ -163,11 +191,42 @@ void DummyPort::SendRDMRequest(ola::rdm::RDMRequest *request_ptr,
 
 void DummyPort::RunDiscovery(RDMDiscoveryCallback *callback) {
   ola::rdm::UIDSet uid_set;
+  AddResponderUIDs(&uid_set);
+  callback->Run(uid_set);
+}
+
+
+/*
+ * The simulated responders are found with DUB, like a real line.
+ */
+void DummyPort::RunLineDiscovery(bool full, RDMDiscoveryCallback *callback) {
+  ola::rdm::DiscoveryAgent::DiscoveryCompleteCallback *on_complete =
+      NewSingleCallback(this, &DummyPort::LineDiscoveryComplete, callback);
+  if (full) {
+    m_discovery_agent->StartFullDiscovery(on_complete);
+  } else {
+    m_discovery_agent->StartIncrementalDiscovery(on_complete);
+  }
+}
+
+
+void DummyPort::LineDiscoveryComplete(RDMDiscoveryCallback *callback,
+                                      bool status,
+                                      const ola::rdm::UIDSet &uids) {
+  if (!status) {
+    OLA_WARN << "Discovery of the simulated RDM line failed";
+  }
+  ola::rdm::UIDSet uid_set(uids);
+  AddResponderUIDs(&uid_set);
+  callback->Run(uid_set);
+}
+
+
+void DummyPort::AddResponderUIDs(ola::rdm::UIDSet *uids) {
   for (ResponderMap::iterator i = m_responders.begin();
     i != m_responders.end(); i++) {
-    uid_set.AddUID(i->first);
+    uids->AddUID(i->first);
   }
-  callback->Run(uid_set);
 }
 
 
@@ -190,6 +249,9 @@ void DummyPort::HandleBroadcastAck(broadcast_request_tracker *tracker,
 
 
 DummyPort::~DummyPort() {
+  // Aborting discovery runs the callback, which uses m_responders.
+  m_discovery_agent.reset();
+  m_simulated_line.reset();
   STLDeleteValues(&m_responders);
 }
 }  // namespace dummy
@@ -24,13 +24,18 @@
 #include <stdint.h>
 #include <string>
 #include <map>
+#include <memory>
 #include <vector>
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/rdm/DiscoveryAgent.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/Port.h"
+#include "plugins/dummy/SimulatedRDMLine.h"
 
 namespace ola {
 namespace plugin {
@@ -59,6 +64,8 @@ class DummyPort: public BasicOutputPort {
     uint8_t number_of_advanced_dimmers;
     uint8_t number_of_sensor_responders;
     uint8_t number_of_network_responders;
+    // Off unless responder_count is set.
+    SimulatedRDMLine::Options simulated_line;
   };
 
 
@@ -68,10 +75,13 @@ class DummyPort: public BasicOutputPort {
    * @param options the config for the DummyPort such as the number of fake RDM
    * devices to create
    * @param id the ID of this port
+   * @param scheduler the scheduler used by the simulated RDM line, if this is
+   *   NULL the simulated line isn't created.
    */
   DummyPort(class DummyDevice *parent,
             const Options &options,
-            unsigned int id);
+            unsigned int id,
+            ola::thread::SchedulerInterface *scheduler = NULL);
   virtual ~DummyPort();
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
   std::string Description() const { return "Dummy Port"; }
@@ -97,8 +107,15 @@ class DummyPort: public BasicOutputPort {
 
   DmxBuffer m_buffer;
   ResponderMap m_responders;
+  std::auto_ptr<SimulatedRDMLine> m_simulated_line;
+  std::auto_ptr<ola::rdm::DiscoveryAgent> m_discovery_agent;
 
   void RunDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
+  void RunLineDiscovery(bool full, ola::rdm::RDMDiscoveryCallback *callback);
+  void LineDiscoveryComplete(ola::rdm::RDMDiscoveryCallback *callback,
+                             bool status,
+                             const ola::rdm::UIDSet &uids);
+  void AddResponderUIDs(ola::rdm::UIDSet *uids);
   void HandleBroadcastAck(broadcast_request_tracker *tracker,
                           ola::rdm::RDMReply *reply);
 
@@ -13,10 +13,16 @@ plugins/dummy/DummyPluginDescription.h: plugins/dummy/README.md plugins/dummy/Ma
 plugins_dummy_liboladummy_la_SOURCES = \
     plugins/dummy/DummyDevice.cpp \
     plugins/dummy/DummyDevice.h \
+    plugins/dummy/DummyLoadDevice.cpp \
+    plugins/dummy/DummyLoadDevice.h \
+    plugins/dummy/DummyLoadPort.cpp \
+    plugins/dummy/DummyLoadPort.h \
     plugins/dummy/DummyPlugin.cpp \
     plugins/dummy/DummyPlugin.h \
     plugins/dummy/DummyPort.cpp \
-    plugins/dummy/DummyPort.h
+    plugins/dummy/DummyPort.h \
+    plugins/dummy/SimulatedRDMLine.cpp \
+    plugins/dummy/SimulatedRDMLine.h
 plugins_dummy_liboladummy_la_LIBADD = \
     common/libolacommon.la \
     olad/plugin_api/libolaserverplugininterface.la
@@ -25,7 +31,10 @@ plugins_dummy_liboladummy_la_LIBADD = \
 ##################################################
 test_programs += plugins/dummy/DummyPluginTester
 
-plugins_dummy_DummyPluginTester_SOURCES = plugins/dummy/DummyPortTest.cpp
+plugins_dummy_DummyPluginTester_SOURCES = \
+    plugins/dummy/DummyLoadPortTest.cpp \
+    plugins/dummy/DummyPortTest.cpp \
+    plugins/dummy/SimulatedRDMLineTest.cpp
 plugins_dummy_DummyPluginTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 # it's unclear to me why liboladummyresponder has to be included here
 # but if it isn't, the test breaks with gcc 4.6.1
@@ -36,6 +45,16 @@ plugins_dummy_DummyPluginTester_LDADD = \
     plugins/dummy/liboladummy.la \
     common/libolacommon.la
 
+# BENCHMARKS
+##################################################
+benchmark_programs += plugins/dummy/SimulatedRDMLineBenchmark
+
+plugins_dummy_SimulatedRDMLineBenchmark_SOURCES = \
+    plugins/dummy/SimulatedRDMLineBenchmark.cpp
+plugins_dummy_SimulatedRDMLineBenchmark_LDADD = \
+    plugins/dummy/liboladummy.la \
+    $(COMMON_BENCHMARK_LIBS)
+
 endif
 
 EXTRA_DIST += plugins/dummy/README.md
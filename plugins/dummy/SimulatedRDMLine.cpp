@@ -0,0 +1,317 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SimulatedRDMLine.cpp
+ * A simulated RDM line with a large number of responders.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ola/rdm/AckTimerResponder.h"
+#include "ola/rdm/DummyResponder.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMReply.h"
+#include "plugins/dummy/SimulatedRDMLine.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::auto_ptr;
+using std::set;
+using std::string;
+
+const uint16_t SimulatedRDMLine::SIMULATED_ESTA_CODE;
+
+SimulatedRDMLine::SimulatedRDMLine(
+    ola::thread::SchedulerInterface *scheduler,
+    const Options &options)
+    : m_scheduler(scheduler),
+      m_options(options),
+      m_next_reply(0) {
+  // A fixed seed means the same UIDs, and so the same discovery tree, on
+  // every run.
+  set<UID> uids;
+  uint32_t seed = 0x2a;
+  while (uids.size() < options.responder_count) {
+    seed = seed * 1664525 + 1013904223;
+    if (seed != UID::ALL_DEVICES) {
+      uids.insert(UID(SIMULATED_ESTA_CODE, seed));
+    }
+  }
+
+  m_responders.reserve(uids.size());
+  unsigned int i = 0;
+  for (set<UID>::const_iterator iter = uids.begin(); iter != uids.end();
+       ++iter, ++i) {
+    ola::rdm::RDMControllerInterface *controller;
+    if (i % 100 < options.ack_timer_percent) {
+      controller = new ola::rdm::AckTimerResponder(*iter);
+    } else {
+      controller = new ola::rdm::DummyResponder(*iter);
+    }
+    m_responders.push_back(Responder(*iter, controller));
+  }
+}
+
+SimulatedRDMLine::~SimulatedRDMLine() {
+  PendingReplies::iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    m_scheduler->RemoveTimeout(iter->second.timeout);
+    delete iter->second.discovery_callback;
+    if (iter->second.rdm_callback) {
+      delete iter->second.rdm_reply;
+      ola::rdm::RunRDMCallback(iter->second.rdm_callback,
+                               ola::rdm::RDM_TIMEOUT);
+    }
+  }
+
+  Responders::iterator responder = m_responders.begin();
+  for (; responder != m_responders.end(); ++responder) {
+    delete responder->controller;
+  }
+}
+
+void SimulatedRDMLine::GetUIDs(UIDSet *uids) const {
+  Responders::const_iterator iter = m_responders.begin();
+  for (; iter != m_responders.end(); ++iter) {
+    uids->AddUID(iter->uid);
+  }
+}
+
+bool SimulatedRDMLine::HasResponder(const UID &uid) const {
+  return const_cast<SimulatedRDMLine*>(this)->FindResponder(uid) !=
+      m_responders.end();
+}
+
+void SimulatedRDMLine::SendRDMRequest(RDMRequest *request_ptr,
+                                      RDMCallback *callback) {
+  auto_ptr<RDMRequest> request(request_ptr);
+  m_stats.requests++;
+
+  if (request->DestinationUID().IsBroadcast()) {
+    Responders::iterator iter = m_responders.begin();
+    for (; iter != m_responders.end(); ++iter) {
+      if (request->DestinationUID().DirectedToUID(iter->uid)) {
+        iter->controller->SendRDMRequest(
+            request->Duplicate(),
+            NewSingleCallback(this, &SimulatedRDMLine::IgnoreReply));
+      }
+    }
+    ScheduleRDMReply(callback, new RDMReply(ola::rdm::RDM_WAS_BROADCAST));
+    return;
+  }
+
+  Responders::iterator iter = FindResponder(request->DestinationUID());
+  if (iter == m_responders.end()) {
+    ScheduleRDMReply(callback, new RDMReply(ola::rdm::RDM_TIMEOUT));
+    return;
+  }
+  iter->controller->SendRDMRequest(
+      request.release(),
+      NewSingleCallback(this, &SimulatedRDMLine::ResponderReplied, callback));
+}
+
+void SimulatedRDMLine::MuteDevice(const UID &target,
+                                  MuteDeviceCallback *mute_complete) {
+  m_stats.mutes++;
+  // A collision can produce a UID that doesn't exist, in which case the mute
+  // times out.
+  Responders::iterator iter = FindResponder(target);
+  bool found = iter != m_responders.end();
+  if (found) {
+    iter->muted = true;
+  }
+  ScheduleDiscoveryReply(
+      NewSingleCallback(mute_complete, &MuteDeviceCallback::Run, found));
+}
+
+void SimulatedRDMLine::UnMuteAll(UnMuteDeviceCallback *unmute_complete) {
+  Responders::iterator iter = m_responders.begin();
+  for (; iter != m_responders.end(); ++iter) {
+    iter->muted = false;
+  }
+  ScheduleDiscoveryReply(
+      NewSingleCallback(unmute_complete, &UnMuteDeviceCallback::Run));
+}
+
+/*
+ * Every unmuted responder in the range replies. If there's more than one the
+ * responses are OR'ed together and, since colliding responses usually cause
+ * framing errors, cut short. Without that a collision can decode to a valid
+ * but non-existent UID, which would mark the discovery tree as corrupt.
+ */
+void SimulatedRDMLine::Branch(const UID &lower,
+                              const UID &upper,
+                              BranchCallback *callback) {
+  m_stats.branches++;
+
+  uint8_t data[DUB_RESPONSE_SIZE];
+  memset(data, 0, sizeof(data));
+  unsigned int responses = 0;
+
+  Responders::iterator iter = std::lower_bound(
+      m_responders.begin(), m_responders.end(), lower,
+      ResponderLessThan);
+  for (; iter != m_responders.end() && !(upper < iter->uid); ++iter) {
+    if (!iter->muted) {
+      OrDUBResponse(iter->uid, data);
+      responses++;
+    }
+  }
+
+  string response;
+  if (responses == 1) {
+    response.assign(reinterpret_cast<char*>(data), sizeof(data));
+  } else if (responses > 1) {
+    m_stats.collisions++;
+    response.assign(reinterpret_cast<char*>(data), COLLISION_SIZE);
+  }
+  ScheduleDiscoveryReply(
+      NewSingleCallback(this, &SimulatedRDMLine::RunBranchCallback, callback,
+                        response));
+}
+
+SimulatedRDMLine::Responders::iterator SimulatedRDMLine::FindResponder(
+    const UID &uid) {
+  Responders::iterator iter = std::lower_bound(
+      m_responders.begin(), m_responders.end(), uid, ResponderLessThan);
+  if (iter != m_responders.end() && iter->uid == uid) {
+    return iter;
+  }
+  return m_responders.end();
+}
+
+void SimulatedRDMLine::ScheduleDiscoveryReply(
+    ola::SingleUseCallback0<void> *callback) {
+  PendingReply reply;
+  reply.discovery_callback = callback;
+  reply.rdm_callback = NULL;
+  reply.rdm_reply = NULL;
+  Schedule(reply);
+}
+
+void SimulatedRDMLine::ScheduleRDMReply(RDMCallback *callback,
+                                        RDMReply *rdm_reply) {
+  PendingReply reply;
+  reply.discovery_callback = NULL;
+  reply.rdm_callback = callback;
+  reply.rdm_reply = rdm_reply;
+  Schedule(reply);
+}
+
+/*
+ * Replies are always delivered from the scheduler, even without a delay, so
+ * the DiscoveryAgent doesn't recurse once per DUB.
+ */
+void SimulatedRDMLine::Schedule(const PendingReply &reply) {
+  unsigned int id = m_next_reply++;
+  PendingReply &pending = m_pending[id];
+  pending = reply;
+  pending.timeout = m_scheduler->RegisterSingleTimeout(
+      m_options.response_delay_ms,
+      NewSingleCallback(this, &SimulatedRDMLine::RunPendingReply, id));
+}
+
+void SimulatedRDMLine::RunPendingReply(unsigned int id) {
+  PendingReplies::iterator iter = m_pending.find(id);
+  if (iter == m_pending.end()) {
+    return;
+  }
+  PendingReply reply = iter->second;
+  m_pending.erase(iter);
+
+  if (reply.discovery_callback) {
+    reply.discovery_callback->Run();
+  } else {
+    auto_ptr<RDMReply> rdm_reply(reply.rdm_reply);
+    reply.rdm_callback->Run(rdm_reply.get());
+  }
+}
+
+/*
+ * The responders reply straight away, so copy the reply and deliver it
+ * later.
+ */
+void SimulatedRDMLine::ResponderReplied(RDMCallback *callback,
+                                        RDMReply *reply) {
+  const RDMResponse *response = reply->Response();
+  ScheduleRDMReply(
+      callback,
+      new RDMReply(reply->StatusCode(),
+                   response ? response->Duplicate() : NULL,
+                   reply->Frames()));
+}
+
+void SimulatedRDMLine::IgnoreReply(RDMReply*) {}
+
+bool SimulatedRDMLine::ResponderLessThan(const Responder &responder,
+                                         const UID &uid) {
+  return responder.uid < uid;
+}
+
+void SimulatedRDMLine::RunBranchCallback(BranchCallback *callback,
+                                         string data) {
+  if (data.empty()) {
+    callback->Run(NULL, 0);
+  } else {
+    callback->Run(reinterpret_cast<const uint8_t*>(data.data()),
+                  data.size());
+  }
+}
+
+/*
+ * OR the DUB response for uid into data, which must be at least
+ * DUB_RESPONSE_SIZE bytes.
+ */
+void SimulatedRDMLine::OrDUBResponse(const UID &uid, uint8_t *data) {
+  uint8_t euid[UID::UID_SIZE];
+  uid.Pack(euid, sizeof(euid));
+
+  unsigned int offset = 0;
+  for (; offset < 7; offset++) {
+    data[offset] |= 0xfe;
+  }
+  data[offset++] |= 0xaa;
+
+  uint16_t checksum = 0;
+  for (unsigned int i = 0; i < UID::UID_SIZE; i++) {
+    uint8_t high = euid[i] | 0xaa;
+    uint8_t low = euid[i] | 0x55;
+    data[offset++] |= high;
+    data[offset++] |= low;
+    checksum += high + low;
+  }
+
+  data[offset++] |= (checksum >> 8) | 0xaa;
+  data[offset++] |= (checksum >> 8) | 0x55;
+  data[offset++] |= (checksum & 0xff) | 0xaa;
+  data[offset++] |= (checksum & 0xff) | 0x55;
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
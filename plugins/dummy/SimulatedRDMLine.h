@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SimulatedRDMLine.h
+ * A simulated RDM line with a large number of responders.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_DUMMY_SIMULATEDRDMLINE_H_
+#define PLUGINS_DUMMY_SIMULATEDRDMLINE_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/DiscoveryAgent.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+/**
+ * @brief Simulates an RDM line with thousands of responders.
+ *
+ * The responders have pseudo random device IDs, so DUB requests collide the
+ * way they do on a real line and the DiscoveryAgent has to walk the tree.
+ * Every reply, including the DUB and mute responses, is delivered by the
+ * scheduler after response_delay_ms, so discovery and RDM requests are
+ * always asynchronous.
+ *
+ * Some of the responders are AckTimerResponders, which reply to SETs with
+ * ACK_TIMER and then make the response available as a queued message.
+ */
+class SimulatedRDMLine: public ola::rdm::DiscoveryTargetInterface {
+ public:
+  struct Options {
+    Options()
+        : responder_count(0),
+          ack_timer_percent(0),
+          response_delay_ms(0) {
+    }
+
+    // The number of responders on the line.
+    uint16_t responder_count;
+    // The percentage of responders that reply with ACK_TIMER.
+    uint8_t ack_timer_percent;
+    // The time taken for each reply.
+    unsigned int response_delay_ms;
+  };
+
+  struct Stats {
+    Stats() : branches(0), collisions(0), mutes(0), requests(0) {}
+
+    unsigned int branches;
+    unsigned int collisions;
+    unsigned int mutes;
+    unsigned int requests;
+  };
+
+  SimulatedRDMLine(ola::thread::SchedulerInterface *scheduler,
+                   const Options &options);
+  ~SimulatedRDMLine();
+
+  unsigned int ResponderCount() const { return m_responders.size(); }
+  void GetUIDs(ola::rdm::UIDSet *uids) const;
+  bool HasResponder(const ola::rdm::UID &uid) const;
+  const Stats& GetStats() const { return m_stats; }
+
+  /**
+   * @brief Send an RDM request to the responders.
+   *
+   * Broadcast requests are sent to every responder, otherwise the
+   * destination must be one of the responders on this line.
+   */
+  void SendRDMRequest(ola::rdm::RDMRequest *request,
+                      ola::rdm::RDMCallback *callback);
+
+  void MuteDevice(const ola::rdm::UID &target,
+                  MuteDeviceCallback *mute_complete);
+  void UnMuteAll(UnMuteDeviceCallback *unmute_complete);
+  void Branch(const ola::rdm::UID &lower,
+              const ola::rdm::UID &upper,
+              BranchCallback *callback);
+
+  // The ESTA prototyping ID, so the UIDs don't overlap with real devices.
+  static const uint16_t SIMULATED_ESTA_CODE = 0x7ff0;
+
+ private:
+  struct Responder {
+    Responder(const ola::rdm::UID &_uid,
+              ola::rdm::RDMControllerInterface *_controller)
+        : uid(_uid),
+          controller(_controller),
+          muted(false) {
+    }
+
+    ola::rdm::UID uid;
+    ola::rdm::RDMControllerInterface *controller;
+    bool muted;
+  };
+
+  struct PendingReply {
+    ola::thread::timeout_id timeout;
+    // Set for discovery replies.
+    ola::SingleUseCallback0<void> *discovery_callback;
+    // Set for RDM replies.
+    ola::rdm::RDMCallback *rdm_callback;
+    ola::rdm::RDMReply *rdm_reply;
+  };
+
+  typedef std::vector<Responder> Responders;
+  typedef std::map<unsigned int, PendingReply> PendingReplies;
+
+  ola::thread::SchedulerInterface *m_scheduler;
+  const Options m_options;
+  Responders m_responders;
+  PendingReplies m_pending;
+  unsigned int m_next_reply;
+  Stats m_stats;
+
+  Responders::iterator FindResponder(const ola::rdm::UID &uid);
+  void ScheduleDiscoveryReply(ola::SingleUseCallback0<void> *callback);
+  void ScheduleRDMReply(ola::rdm::RDMCallback *callback,
+                        ola::rdm::RDMReply *reply);
+  void Schedule(const PendingReply &reply);
+  void RunPendingReply(unsigned int id);
+
+  void ResponderReplied(ola::rdm::RDMCallback *callback,
+                        ola::rdm::RDMReply *reply);
+  void IgnoreReply(ola::rdm::RDMReply *reply);
+  void RunBranchCallback(BranchCallback *callback, std::string data);
+
+  static bool ResponderLessThan(const Responder &responder,
+                                const ola::rdm::UID &uid);
+  static void OrDUBResponse(const ola::rdm::UID &uid, uint8_t *data);
+
+  static const unsigned int DUB_RESPONSE_SIZE = 24;
+  // The amount of a collision that's received.
+  static const unsigned int COLLISION_SIZE = 12;
+
+  DISALLOW_COPY_AND_ASSIGN(SimulatedRDMLine);
+};
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_DUMMY_SIMULATEDRDMLINE_H_
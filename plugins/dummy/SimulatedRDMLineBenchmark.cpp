@@ -0,0 +1,68 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SimulatedRDMLineBenchmark.cpp
+ * Benchmarks RDM discovery against a simulated line.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include "ola/Callback.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/DiscoveryAgent.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/Benchmark.h"
+#include "plugins/dummy/SimulatedRDMLine.h"
+
+using ola::io::SelectServer;
+using ola::plugin::dummy::SimulatedRDMLine;
+using ola::rdm::DiscoveryAgent;
+using ola::rdm::UIDSet;
+using ola::testing::BenchmarkState;
+
+namespace {
+
+void DiscoveryComplete(SelectServer *ss, bool, const UIDSet&) {
+  ss->Terminate();
+}
+
+/*
+ * Each iteration is a full discovery of the line.
+ */
+void Discover(BenchmarkState *state, uint16_t responder_count) {
+  SelectServer ss;
+  SimulatedRDMLine::Options options;
+  options.responder_count = responder_count;
+  SimulatedRDMLine line(&ss, options);
+  DiscoveryAgent agent(&line);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    agent.StartFullDiscovery(ola::NewSingleCallback(DiscoveryComplete, &ss));
+    ss.Run();
+  }
+}
+
+void BenchmarkDiscovery100(BenchmarkState *state) {
+  Discover(state, 100);
+}
+OLA_BENCHMARK(BenchmarkDiscovery100);
+
+void BenchmarkDiscovery5000(BenchmarkState *state) {
+  Discover(state, 5000);
+}
+OLA_BENCHMARK(BenchmarkDiscovery5000);
+}  // namespace
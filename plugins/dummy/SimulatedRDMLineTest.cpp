@@ -0,0 +1,200 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SimulatedRDMLineTest.cpp
+ * Test fixture for the SimulatedRDMLine class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/DiscoveryAgent.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/dummy/SimulatedRDMLine.h"
+
+namespace ola {
+namespace plugin {
+namespace dummy {
+
+using ola::io::SelectServer;
+using ola::rdm::DiscoveryAgent;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+
+class SimulatedRDMLineTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SimulatedRDMLineTest);
+  CPPUNIT_TEST(testDiscovery);
+  CPPUNIT_TEST(testRDMRequests);
+  CPPUNIT_TEST(testAckTimer);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  SimulatedRDMLineTest()
+      : m_source(1, 2),
+        m_status(ola::rdm::RDM_FAILED_TO_SEND),
+        m_response_type(0),
+        m_discovery_ok(false) {
+    ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+  }
+
+  void setUp();
+
+  void testDiscovery();
+  void testRDMRequests();
+  void testAckTimer();
+
+ private:
+  SelectServer m_ss;
+  UID m_source;
+  ola::rdm::RDMStatusCode m_status;
+  uint8_t m_response_type;
+  bool m_discovery_ok;
+  UIDSet m_uids;
+
+  void DiscoveryComplete(bool ok, const UIDSet &uids) {
+    m_discovery_ok = ok;
+    m_uids = uids;
+    m_ss.Terminate();
+  }
+
+  void HandleReply(RDMReply *reply) {
+    m_status = reply->StatusCode();
+    m_response_type = reply->Response() ?
+        reply->Response()->ResponseType() : 0;
+    m_ss.Terminate();
+  }
+
+  void Send(SimulatedRDMLine *line, ola::rdm::RDMRequest *request) {
+    line->SendRDMRequest(
+        request,
+        NewSingleCallback(this, &SimulatedRDMLineTest::HandleReply));
+    m_ss.Run();
+  }
+
+  static const unsigned int ABORT_TIMEOUT_IN_MS = 10000;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SimulatedRDMLineTest);
+
+
+void SimulatedRDMLineTest::setUp() {
+  m_ss.RegisterSingleTimeout(
+      ABORT_TIMEOUT_IN_MS,
+      NewSingleCallback(&m_ss, &SelectServer::Terminate));
+}
+
+
+/*
+ * Check the DiscoveryAgent finds every responder, despite the collisions.
+ */
+void SimulatedRDMLineTest::testDiscovery() {
+  SimulatedRDMLine::Options options;
+  options.responder_count = 2000;
+  SimulatedRDMLine line(&m_ss, options);
+  OLA_ASSERT_EQ(2000u, line.ResponderCount());
+
+  UIDSet expected_uids;
+  line.GetUIDs(&expected_uids);
+
+  DiscoveryAgent agent(&line);
+  agent.StartFullDiscovery(
+      NewSingleCallback(this, &SimulatedRDMLineTest::DiscoveryComplete));
+  m_ss.Run();
+
+  OLA_ASSERT_TRUE(m_discovery_ok);
+  OLA_ASSERT_EQ(expected_uids, m_uids);
+  OLA_ASSERT_EQ(2000u, line.GetStats().mutes);
+  OLA_ASSERT_TRUE(line.GetStats().collisions > 1000);
+
+  // Incremental discovery mutes the known responders first, so there are no
+  // collisions.
+  unsigned int collisions = line.GetStats().collisions;
+  agent.StartIncrementalDiscovery(
+      NewSingleCallback(this, &SimulatedRDMLineTest::DiscoveryComplete));
+  m_ss.Run();
+  OLA_ASSERT_TRUE(m_discovery_ok);
+  OLA_ASSERT_EQ(expected_uids, m_uids);
+  OLA_ASSERT_EQ(collisions, line.GetStats().collisions);
+}
+
+
+/*
+ * Check requests are answered by the responders.
+ */
+void SimulatedRDMLineTest::testRDMRequests() {
+  SimulatedRDMLine::Options options;
+  options.responder_count = 10;
+  options.response_delay_ms = 1;
+  SimulatedRDMLine line(&m_ss, options);
+
+  UIDSet uids;
+  line.GetUIDs(&uids);
+  UID uid = *uids.Begin();
+  OLA_ASSERT_EQ(SimulatedRDMLine::SIMULATED_ESTA_CODE, uid.ManufacturerId());
+  OLA_ASSERT_TRUE(line.HasResponder(uid));
+
+  Send(&line, new RDMGetRequest(m_source, uid, 0, 1, 0,
+                                ola::rdm::PID_DEVICE_INFO, NULL, 0));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, m_status);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::RDM_ACK), m_response_type);
+
+  UID missing_uid(SimulatedRDMLine::SIMULATED_ESTA_CODE, 0);
+  OLA_ASSERT_FALSE(line.HasResponder(missing_uid));
+  Send(&line, new RDMGetRequest(m_source, missing_uid, 0, 1, 0,
+                                ola::rdm::PID_DEVICE_INFO, NULL, 0));
+  OLA_ASSERT_EQ(ola::rdm::RDM_TIMEOUT, m_status);
+
+  uint8_t identify = 1;
+  Send(&line, new RDMSetRequest(m_source, UID::AllDevices(), 0, 1, 0,
+                                ola::rdm::PID_IDENTIFY_DEVICE, &identify,
+                                sizeof(identify)));
+  OLA_ASSERT_EQ(ola::rdm::RDM_WAS_BROADCAST, m_status);
+  OLA_ASSERT_EQ(3u, line.GetStats().requests);
+}
+
+
+/*
+ * Check the ack timer responders reply with ACK_TIMER.
+ */
+void SimulatedRDMLineTest::testAckTimer() {
+  SimulatedRDMLine::Options options;
+  options.responder_count = 2;
+  options.ack_timer_percent = 100;
+  SimulatedRDMLine line(&m_ss, options);
+
+  UIDSet uids;
+  line.GetUIDs(&uids);
+  uint8_t identify = 1;
+  Send(&line, new RDMSetRequest(m_source, *uids.Begin(), 0, 1, 0,
+                                ola::rdm::PID_IDENTIFY_DEVICE, &identify,
+                                sizeof(identify)));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, m_status);
+  OLA_ASSERT_EQ(static_cast<int>(ola::rdm::RDM_ACK_TIMER),
+                static_cast<int>(m_response_type));
+}
+}  // namespace dummy
+}  // namespace plugin
+}  // namespace ola
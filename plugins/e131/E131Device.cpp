@@ -24,14 +24,21 @@
 #include <google/protobuf/service.h>
 #include <google/protobuf/stubs/common.h>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "common/rpc/RpcController.h"
 #include "ola/CallbackRunner.h"
+#include "ola/Clock.h"
 #include "ola/Logging.h"
+#include "ola/acn/ACNPort.h"
+#include "ola/network/IPV4Address.h"
 #include "ola/network/NetworkUtils.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/thread/Future.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
@@ -44,9 +51,21 @@ namespace plugin {
 namespace e131 {
 
 const char E131Device::DEVICE_NAME[] = "E1.31 (DMX over ACN)";
+const char E131Device::DISCOVERED_SOURCES_VAR[] = "e131-discovered-sources";
+const char E131Device::DISCOVERED_UNIVERSES_VAR[] =
+    "e131-discovered-universes";
+const char E131Device::DISCOVERY_GENERATION_VAR[] =
+    "e131-discovery-generation";
 
+using ola::acn::CID;
 using ola::acn::E131Node;
+using ola::acn::UniverseDiscoveryIndex;
+using ola::io::SelectServerInterface;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
 using ola::rpc::RpcController;
+using ola::thread::Future;
+using std::auto_ptr;
 using std::ostringstream;
 using std::set;
 using std::string;
@@ -59,12 +78,17 @@ E131Device::E131Device(Plugin *owner,
                        const ola::acn::CID &cid,
                        string ip_addr,
                        PluginAdaptor *plugin_adaptor,
-                       const E131DeviceOptions &options)
+                       const E131DeviceOptions &options,
+                       SelectServerInterface *node_loop)
     : Device(owner, DEVICE_NAME),
       m_plugin_adaptor(plugin_adaptor),
+      m_node_loop(node_loop),
       m_options(options),
       m_ip_addr(ip_addr),
-      m_cid(cid) {
+      m_cid(cid),
+      m_discovered_sources_var(NULL),
+      m_discovered_universes_var(NULL),
+      m_discovery_generation_var(NULL) {
 }
 
 
@@ -72,10 +96,19 @@ E131Device::E131Device(Plugin *owner,
  * Start this device
  */
 bool E131Device::StartHook() {
-  m_node.reset(new E131Node(m_plugin_adaptor, m_ip_addr, m_options, m_cid));
+  ExportMap *export_map = m_plugin_adaptor->GetExportMap();
+  if (m_options.enable_draft_discovery && export_map) {
+    m_discovered_sources_var = export_map->GetIntegerVar(
+        DISCOVERED_SOURCES_VAR);
+    m_discovered_universes_var = export_map->GetIntegerVar(
+        DISCOVERED_UNIVERSES_VAR);
+    m_discovery_generation_var = export_map->GetIntegerVar(
+        DISCOVERY_GENERATION_VAR);
+  }
 
-  if (!m_node->Start()) {
-    m_node.reset();
+  bool started = false;
+  RunOnNodeLoop(NewSingleCallback(this, &E131Device::StartNode, &started));
+  if (!started) {
     DeleteAllPorts();
     return false;
   }
@@ -85,20 +118,16 @@ bool E131Device::StartHook() {
   SetName(str.str());
 
   for (unsigned int i = 0; i < m_options.input_ports; i++) {
-    E131InputPort *input_port = new E131InputPort(
-        this, i, m_node.get(), m_plugin_adaptor);
+    E131InputPort *input_port = new E131InputPort(this, i, m_plugin_adaptor);
     AddPort(input_port);
     m_input_ports.push_back(input_port);
   }
 
   for (unsigned int i = 0; i < m_options.output_ports; i++) {
-    E131OutputPort *output_port = new E131OutputPort(
-        this, i, m_node.get());
+    E131OutputPort *output_port = new E131OutputPort(this, i);
     AddPort(output_port);
     m_output_ports.push_back(output_port);
   }
-
-  m_plugin_adaptor->AddReadDescriptor(m_node->GetSocket());
   return true;
 }
 
@@ -107,7 +136,20 @@ bool E131Device::StartHook() {
  * Stop this device
  */
 void E131Device::PrePortStop() {
-  m_plugin_adaptor->RemoveReadDescriptor(m_node->GetSocket());
+  vector<uint16_t> universes;
+  vector<E131InputPort*>::iterator iter = m_input_ports.begin();
+  for (; iter != m_input_ports.end(); ++iter) {
+    if ((*iter)->GetUniverse()) {
+      universes.push_back((*iter)->GetUniverse()->UniverseId());
+    }
+  }
+  RunOnNodeLoop(
+      NewSingleCallback(this, &E131Device::StopNodeInput, &universes));
+
+  if (m_node_loop) {
+    // Run any data handed off by the node while the ports still exist.
+    m_plugin_adaptor->DrainCallbacks();
+  }
 }
 
 
@@ -115,8 +157,53 @@ void E131Device::PrePortStop() {
  * Stop this device
  */
 void E131Device::PostPortStop() {
-  m_node->Stop();
-  m_node.reset();
+  RunOnNodeLoop(NewSingleCallback(this, &E131Device::StopNode));
+}
+
+
+void E131Device::StartStream(uint16_t universe) {
+  RunOnNodeLoop(
+      NewSingleCallback(this, &E131Device::NodeStartStream, universe));
+}
+
+
+void E131Device::TerminateStream(uint16_t universe, uint8_t priority) {
+  RunOnNodeLoop(NewSingleCallback(this, &E131Device::NodeTerminateStream,
+                                  universe, priority));
+}
+
+
+/*
+ * Send DMX data. If the node is on a worker loop, this returns once the data
+ * has been queued.
+ */
+bool E131Device::SendDMX(uint16_t universe, const DmxBuffer &buffer,
+                         uint8_t priority, bool preview) {
+  if (!m_node_loop) {
+    return m_node->SendDMX(universe, buffer, priority, preview);
+  }
+
+  // DmxBuffer copies share data with a non-atomic refcount, so we take a
+  // deep copy for the other thread.
+  m_node_loop->Execute(NewSingleCallback(
+      this, &E131Device::NodeSendDMX, universe,
+      static_cast<const DmxBuffer*>(
+          new DmxBuffer(buffer.GetRaw(), buffer.Size())),
+      priority, preview));
+  return true;
+}
+
+
+void E131Device::SetHandler(uint16_t universe, DmxBuffer *buffer,
+                            uint8_t *priority, Callback0<void> *handler) {
+  RunOnNodeLoop(NewSingleCallback(this, &E131Device::NodeSetHandler,
+                                  universe, buffer, priority, handler));
+}
+
+
+void E131Device::RemoveHandler(uint16_t universe) {
+  RunOnNodeLoop(
+      NewSingleCallback(this, &E131Device::NodeRemoveHandler, universe));
 }
 
 
@@ -146,7 +233,10 @@ void E131Device::Configure(RpcController *controller,
       HandlePreviewMode(&request_pb, response);
       break;
     case ola::plugin::e131::Request::E131_SOURCES_LIST:
-      HandleSourceListRequest(&request_pb, response);
+      HandleSourceListRequest(controller, &request_pb, response);
+      break;
+    case ola::plugin::e131::Request::E131_UNICAST_DESTINATIONS:
+      HandleUnicastDestinations(controller, &request_pb, response);
       break;
     default:
       controller->SetFailed("Invalid Request");
@@ -208,10 +298,9 @@ void E131Device::HandlePortStatusRequest(string *response) {
   reply.SerializeToString(response);
 }
 
-void E131Device::HandleSourceListRequest(const Request *request,
+void E131Device::HandleSourceListRequest(RpcController *controller,
+                                         const Request *request,
                                          string *response) {
-  typedef std::vector<E131Node::KnownController> KnownControllerList;
-  (void) request;
   ola::plugin::e131::Reply reply;
   reply.set_type(ola::plugin::e131::Reply::E131_SOURCES_LIST);
   ola::plugin::e131::SourceListReply *sources_reply =
@@ -221,15 +310,55 @@ void E131Device::HandleSourceListRequest(const Request *request,
     sources_reply->set_unsupported(true);
   } else {
     sources_reply->set_unsupported(false);
-    KnownControllerList controllers;
-    m_node->GetKnownControllers(&controllers);
 
-    KnownControllerList::const_iterator iter = controllers.begin();
-    for (; iter != controllers.end(); ++iter) {
+    UniverseDiscoveryIndex::Query query;
+    if (request->has_source_list()) {
+      const ola::plugin::e131::SourceListRequest &list_request =
+          request->source_list();
+      query.since_generation = list_request.since_generation();
+      query.limit = list_request.page_size();
+      if (list_request.has_page_token()) {
+        query.start_after = CID::FromString(list_request.page_token());
+        if (query.start_after.IsNil()) {
+          controller->SetFailed("Invalid page token");
+          return;
+        }
+      }
+      if (list_request.has_universe()) {
+        query.filter_universe = true;
+        query.universe = static_cast<uint16_t>(list_request.universe());
+      }
+    }
+
+    UniverseDiscoveryIndex::Page page;
+    RunOnNodeLoop(NewSingleCallback(
+        m_node.get(), &E131Node::GetDiscoveredSources,
+        static_cast<const UniverseDiscoveryIndex::Query*>(&query), &page));
+
+    TimeStamp now;
+    Clock clock;
+    clock.CurrentTime(&now);
+
+    sources_reply->set_generation(page.generation);
+    sources_reply->set_resync(page.resync);
+    if (!page.next.IsNil()) {
+      sources_reply->set_next_page_token(page.next.ToString());
+    }
+    vector<CID>::const_iterator removed_iter = page.removed.begin();
+    for (; removed_iter != page.removed.end(); ++removed_iter) {
+      sources_reply->add_removed_cid(removed_iter->ToString());
+    }
+
+    vector<UniverseDiscoveryIndex::Source>::const_iterator iter =
+        page.sources.begin();
+    for (; iter != page.sources.end(); ++iter) {
       ola::plugin::e131::SourceEntry *entry = sources_reply->add_source();
       entry->set_cid(iter->cid.ToString());
       entry->set_ip_address(iter->ip_address.ToString());
       entry->set_source_name(iter->source_name);
+      entry->set_last_seen_ms(static_cast<uint32_t>(
+          (now - iter->last_seen).InMilliSeconds()));
+      entry->set_generation(iter->generation);
 
       set<uint16_t>::const_iterator uni_iter = iter->universes.begin();
       for (; uni_iter != iter->universes.end(); ++uni_iter) {
@@ -241,6 +370,252 @@ void E131Device::HandleSourceListRequest(const Request *request,
   reply.SerializeToString(response);
 }
 
+
+/*
+ * Get or replace the unicast destinations for a universe. Changes made this
+ * way aren't saved to the preferences.
+ */
+void E131Device::HandleUnicastDestinations(RpcController *controller,
+                                           const Request *request,
+                                           string *response) {
+  if (!request->has_unicast_destinations()) {
+    controller->SetFailed("Missing UnicastDestinationsRequest");
+    return;
+  }
+  const ola::plugin::e131::UnicastDestinationsRequest &unicast_request =
+      request->unicast_destinations();
+  const uint16_t universe = unicast_request.universe();
+
+  if (unicast_request.update()) {
+    vector<IPV4SocketAddress> destinations;
+    for (int i = 0; i < unicast_request.destination_size(); i++) {
+      IPV4SocketAddress destination;
+      if (!StringToDestination(unicast_request.destination(i),
+                               &destination)) {
+        controller->SetFailed("Invalid destination " +
+                              unicast_request.destination(i));
+        return;
+      }
+      destinations.push_back(destination);
+    }
+
+    bool ok = false;
+    RunOnNodeLoop(NewSingleCallback(
+        this, &E131Device::NodeSetUnicastDestinations, universe,
+        static_cast<const vector<IPV4SocketAddress>*>(&destinations), &ok));
+    if (!ok) {
+      controller->SetFailed("Invalid universe");
+      return;
+    }
+  }
+
+  vector<IPV4SocketAddress> destinations;
+  RunOnNodeLoop(NewSingleCallback(
+      this, &E131Device::NodeGetUnicastDestinations, universe,
+      &destinations));
+
+  ola::plugin::e131::Reply reply;
+  reply.set_type(ola::plugin::e131::Reply::E131_UNICAST_DESTINATIONS);
+  ola::plugin::e131::UnicastDestinationsReply *unicast_reply =
+      reply.mutable_unicast_destinations();
+  unicast_reply->set_universe(universe);
+  vector<IPV4SocketAddress>::const_iterator iter = destinations.begin();
+  for (; iter != destinations.end(); ++iter) {
+    unicast_reply->add_destination(iter->ToString());
+  }
+  reply.SerializeToString(response);
+}
+
+
+bool E131Device::StringToDestination(const string &input,
+                                     IPV4SocketAddress *destination) {
+  if (input.find(':') != string::npos) {
+    return IPV4SocketAddress::FromString(input, destination);
+  }
+  IPV4Address ip;
+  if (!IPV4Address::FromString(input, &ip)) {
+    return false;
+  }
+  *destination = IPV4SocketAddress(ip, ola::acn::ACN_PORT);
+  return true;
+}
+
+SelectServerInterface *E131Device::NodeLoop() const {
+  if (m_node_loop) {
+    return m_node_loop;
+  }
+  return m_plugin_adaptor;
+}
+
+
+/*
+ * Run a callback on the node's loop, and wait for it to complete.
+ */
+void E131Device::RunOnNodeLoop(BaseCallback0<void> *callback) {
+  if (!m_node_loop) {
+    callback->Run();
+    return;
+  }
+
+  // The Future is a shared handle, the node loop gets its own copy so it
+  // never touches this stack frame.
+  Future<void> done;
+  m_node_loop->Execute(
+      NewSingleCallback(&E131Device::RunAndSignal, callback, done));
+  done.Get();
+}
+
+
+void E131Device::StartNode(bool *started) {
+  m_node.reset(new E131Node(NodeLoop(), m_ip_addr, m_options, m_cid));
+  *started = m_node->Start();
+  if (*started) {
+    // The node sizes the receive buffers itself.
+    UDPSocketMonitor::Options socket_options;
+    socket_options.send_buffer_size = m_options.send_buffer_size;
+    m_socket_monitor.reset(new UDPSocketMonitor(
+        NodeLoop(), m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+        socket_options, m_node_loop ? m_plugin_adaptor : NULL));
+
+    NodeLoop()->AddReadDescriptor(m_node->GetSocket());
+    NodeLoop()->SetDescriptorName(m_node->GetSocket(), "e131");
+    m_socket_monitor->AddSocket(m_node->GetSocket());
+    vector<ola::network::UDPSocket*> sockets;
+    m_node->GetReceiveSockets(&sockets);
+    vector<ola::network::UDPSocket*>::iterator iter = sockets.begin();
+    for (; iter != sockets.end(); ++iter) {
+      NodeLoop()->AddReadDescriptor(*iter);
+      NodeLoop()->SetDescriptorName(*iter, "e131-receive");
+      m_socket_monitor->AddSocket(*iter);
+    }
+    if (m_node->GetPacketRing()) {
+      NodeLoop()->AddReadDescriptor(m_node->GetPacketRing());
+    }
+
+    std::map<uint16_t, vector<IPV4SocketAddress> >::const_iterator
+        unicast_iter = m_options.unicast_destinations.begin();
+    for (; unicast_iter != m_options.unicast_destinations.end();
+         ++unicast_iter) {
+      if (!m_node->SetUnicastDestinations(unicast_iter->first,
+                                          unicast_iter->second)) {
+        OLA_WARN << "Invalid unicast universe " << unicast_iter->first;
+      }
+    }
+
+    if (m_discovered_sources_var) {
+      m_node->SetDiscoveryHandler(
+          NewCallback(this, &E131Device::NodeDiscoveryChanged));
+    }
+  } else {
+    m_node.reset();
+  }
+}
+
+
+void E131Device::StopNodeInput(vector<uint16_t> *universes) {
+  m_node->SetDiscoveryHandler(NULL);
+  NodeLoop()->RemoveReadDescriptor(m_node->GetSocket());
+  m_socket_monitor->RemoveSocket(m_node->GetSocket());
+  vector<ola::network::UDPSocket*> sockets;
+  m_node->GetReceiveSockets(&sockets);
+  vector<ola::network::UDPSocket*>::iterator socket_iter = sockets.begin();
+  for (; socket_iter != sockets.end(); ++socket_iter) {
+    NodeLoop()->RemoveReadDescriptor(*socket_iter);
+    m_socket_monitor->RemoveSocket(*socket_iter);
+  }
+  m_socket_monitor.reset();
+  if (m_node->GetPacketRing()) {
+    NodeLoop()->RemoveReadDescriptor(m_node->GetPacketRing());
+  }
+
+  vector<uint16_t>::const_iterator iter = universes->begin();
+  for (; iter != universes->end(); ++iter) {
+    m_node->RemoveHandler(*iter);
+  }
+}
+
+
+void E131Device::StopNode() {
+  m_node->Stop();
+  m_node.reset();
+}
+
+
+void E131Device::NodeStartStream(uint16_t universe) {
+  m_node->StartStream(universe);
+}
+
+
+void E131Device::NodeTerminateStream(uint16_t universe, uint8_t priority) {
+  m_node->TerminateStream(universe, priority);
+}
+
+
+void E131Device::NodeSendDMX(uint16_t universe, const DmxBuffer *buffer,
+                             uint8_t priority, bool preview) {
+  auto_ptr<const DmxBuffer> data(buffer);
+  m_node->SendDMX(universe, *data, priority, preview);
+}
+
+
+void E131Device::NodeSetHandler(uint16_t universe, DmxBuffer *buffer,
+                                uint8_t *priority, Callback0<void> *handler) {
+  m_node->SetHandler(universe, buffer, priority, handler);
+}
+
+
+void E131Device::NodeRemoveHandler(uint16_t universe) {
+  m_node->RemoveHandler(universe);
+}
+
+
+size_t E131Device::MemoryUsage() {
+  size_t bytes = 0;
+  RunOnNodeLoop(
+      NewSingleCallback(this, &E131Device::NodeMemoryUsage, &bytes));
+  return bytes;
+}
+
+
+void E131Device::NodeMemoryUsage(size_t *bytes) {
+  *bytes = m_node.get() ? m_node->MemoryUsage() : 0;
+}
+
+
+/*
+ * Called on the node's loop when the discovered sources change. The
+ * variables are set atomically, so this doesn't need to hop threads.
+ */
+void E131Device::NodeDiscoveryChanged(
+    const UniverseDiscoveryIndex::Stats &stats) {
+  m_discovered_sources_var->Set(static_cast<int>(stats.sources));
+  m_discovered_universes_var->Set(static_cast<int>(stats.universes));
+  m_discovery_generation_var->Set(static_cast<int>(stats.generation));
+}
+
+
+void E131Device::NodeSetUnicastDestinations(
+    uint16_t universe,
+    const vector<IPV4SocketAddress> *destinations,
+    bool *ok) {
+  *ok = m_node->SetUnicastDestinations(universe, *destinations);
+}
+
+
+void E131Device::NodeGetUnicastDestinations(
+    uint16_t universe,
+    vector<IPV4SocketAddress> *destinations) {
+  m_node->GetUnicastDestinations(universe, destinations);
+}
+
+
+void E131Device::RunAndSignal(BaseCallback0<void> *callback,
+                              Future<void> done) {
+  callback->Run();
+  done.Set();
+}
+
+
 E131InputPort *E131Device::GetE131InputPort(unsigned int port_id) {
   return (port_id < m_input_ports.size()) ? m_input_ports[port_id] : NULL;
 }
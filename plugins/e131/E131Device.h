@@ -21,13 +21,21 @@
 #ifndef PLUGINS_E131_E131DEVICE_H_
 #define PLUGINS_E131_E131DEVICE_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include "libs/acn/E131Node.h"
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/acn/CID.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/thread/Future.h"
 #include "olad/Device.h"
 #include "olad/Plugin.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/e131/messages/E131ConfigMessages.pb.h"
 
 namespace ola {
@@ -44,25 +52,93 @@ class E131Device: public ola::Device {
     E131DeviceOptions()
       : ola::acn::E131Node::Options(),
         input_ports(0),
-        output_ports(0) {
+        output_ports(0),
+        send_buffer_size(0) {
     }
     unsigned int input_ports;
     unsigned int output_ports;
+    // The size of the kernel send buffer, 0 uses the system default.
+    unsigned int send_buffer_size;
+    // The unicast destinations to apply once the node starts, by universe.
+    std::map<uint16_t, std::vector<ola::network::IPV4SocketAddress> >
+        unicast_destinations;
   };
 
+  /**
+   * @brief Create a new E131Device.
+   * @param owner the plugin that owns this device.
+   * @param cid the CID to use.
+   * @param ip_addr the IP address or interface to listen on.
+   * @param plugin_adaptor the PluginAdaptor to use.
+   * @param options the options for the device.
+   * @param node_loop the event loop to run the E131Node on, or NULL to run it
+   *   on the PluginAdaptor's loop.
+   */
   E131Device(ola::Plugin *owner,
              const ola::acn::CID &cid,
              std::string ip_addr,
              class PluginAdaptor *plugin_adaptor,
-             const E131DeviceOptions &options);
+             const E131DeviceOptions &options,
+             ola::io::SelectServerInterface *node_loop = NULL);
 
   std::string DeviceId() const { return "1"; }
 
+  /**
+   * @brief Check if the node runs on a different event loop to the ports.
+   *
+   * If so, data received by the node must be copied and handed back to the
+   * PluginAdaptor's loop.
+   */
+  bool NodeOnWorkerLoop() const { return m_node_loop != NULL; }
+
+  /**
+   * @brief Return the interface the node is bound to.
+   *
+   * The interface doesn't change once the node has started, so this is safe
+   * to call from any thread.
+   */
+  const ola::network::Interface &GetInterface() const {
+    return m_node->GetInterface();
+  }
+
+  // These are called by the ports, and run on the node's loop.
+  void StartStream(uint16_t universe);
+  void TerminateStream(uint16_t universe, uint8_t priority);
+  bool SendDMX(uint16_t universe, const ola::DmxBuffer &buffer,
+               uint8_t priority, bool preview);
+  void SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
+                  uint8_t *priority, ola::Callback0<void> *handler);
+  void RemoveHandler(uint16_t universe);
+
+  /**
+   * @brief The time the packet being handled was received.
+   *
+   * This must be called on the node's loop, from within a handler set with
+   * SetHandler().
+   */
+  const TimeStamp &NodeReceiveTime() const { return m_node->ReceiveTime(); }
+
+  /**
+   * @brief Estimate the memory used by the node. If the node is on a worker
+   * loop this blocks until the worker has run the estimate.
+   */
+  size_t MemoryUsage();
+
   void Configure(ola::rpc::RpcController *controller,
                  const std::string &request,
                  std::string *response,
                  ConfigureCallback *done);
 
+  /**
+   * @brief Convert an ip[:port] string to a unicast destination.
+   * @param input the string to convert, the port defaults to the ACN port.
+   * @param destination the address to populate.
+   * @returns true if the string was valid, false otherwise.
+   */
+  static bool StringToDestination(
+      const std::string &input,
+      ola::network::IPV4SocketAddress *destination);
+
  protected:
   bool StartHook();
   void PrePortStop();
@@ -70,23 +146,63 @@ class E131Device: public ola::Device {
 
  private:
   class PluginAdaptor *m_plugin_adaptor;
+  ola::io::SelectServerInterface *m_node_loop;
   std::auto_ptr<ola::acn::E131Node> m_node;
+  // Created on, and only used from, the node's loop.
+  std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
   const E131DeviceOptions m_options;
   std::vector<E131InputPort*> m_input_ports;
   std::vector<E131OutputPort*> m_output_ports;
   std::string m_ip_addr;
   ola::acn::CID m_cid;
+  // Set from the node's loop.
+  IntegerVariable *m_discovered_sources_var;
+  IntegerVariable *m_discovered_universes_var;
+  IntegerVariable *m_discovery_generation_var;
+
+  ola::io::SelectServerInterface *NodeLoop() const;
+  void RunOnNodeLoop(ola::BaseCallback0<void> *callback);
+  void StartNode(bool *started);
+  void StopNodeInput(std::vector<uint16_t> *universes);
+  void StopNode();
+  void NodeStartStream(uint16_t universe);
+  void NodeTerminateStream(uint16_t universe, uint8_t priority);
+  void NodeSendDMX(uint16_t universe, const ola::DmxBuffer *buffer,
+                   uint8_t priority, bool preview);
+  void NodeSetHandler(uint16_t universe, ola::DmxBuffer *buffer,
+                      uint8_t *priority, ola::Callback0<void> *handler);
+  void NodeRemoveHandler(uint16_t universe);
+  void NodeMemoryUsage(size_t *bytes);
+  void NodeDiscoveryChanged(
+      const ola::acn::UniverseDiscoveryIndex::Stats &stats);
+  void NodeSetUnicastDestinations(
+      uint16_t universe,
+      const std::vector<ola::network::IPV4SocketAddress> *destinations,
+      bool *ok);
+  void NodeGetUnicastDestinations(
+      uint16_t universe,
+      std::vector<ola::network::IPV4SocketAddress> *destinations);
 
   void HandlePreviewMode(const ola::plugin::e131::Request *request,
                          std::string *response);
   void HandlePortStatusRequest(std::string *response);
-  void HandleSourceListRequest(const ola::plugin::e131::Request *request,
+  void HandleSourceListRequest(ola::rpc::RpcController *controller,
+                               const ola::plugin::e131::Request *request,
                                std::string *response);
+  void HandleUnicastDestinations(ola::rpc::RpcController *controller,
+                                 const ola::plugin::e131::Request *request,
+                                 std::string *response);
 
   E131InputPort *GetE131InputPort(unsigned int port_id);
   E131OutputPort *GetE131OutputPort(unsigned int port_id);
 
+  static void RunAndSignal(ola::BaseCallback0<void> *callback,
+                           ola::thread::Future<void> done);
+
   static const char DEVICE_NAME[];
+  static const char DISCOVERED_SOURCES_VAR[];
+  static const char DISCOVERED_UNIVERSES_VAR[];
+  static const char DISCOVERY_GENERATION_VAR[];
 };
 }  // namespace e131
 }  // namespace plugin
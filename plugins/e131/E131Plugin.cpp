@@ -20,13 +20,16 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include "ola/Logging.h"
+#include "ola/network/InterfaceMonitor.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/StringUtils.h"
 #include "ola/acn/CID.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/e131/E131Device.h"
 #include "plugins/e131/E131Plugin.h"
 #include "plugins/e131/E131PluginDescription.h"
@@ -37,21 +40,31 @@ namespace e131 {
 
 using ola::acn::CID;
 using std::string;
+using std::vector;
 
+const char E131Plugin::BATCH_OUTPUT_KEY[] = "batch_output";
 const char E131Plugin::CID_KEY[] = "cid";
 const unsigned int E131Plugin::DEFAULT_DSCP_VALUE = 0;
+const char E131Plugin::DEDICATED_THREAD_KEY[] = "dedicated_thread";
 const char E131Plugin::DSCP_KEY[] = "dscp";
 const char E131Plugin::DRAFT_DISCOVERY_KEY[] = "draft_discovery";
 const char E131Plugin::IGNORE_PREVIEW_DATA_KEY[] = "ignore_preview";
 const char E131Plugin::INPUT_PORT_COUNT_KEY[] = "input_ports";
 const char E131Plugin::IP_KEY[] = "ip";
 const char E131Plugin::OUTPUT_PORT_COUNT_KEY[] = "output_ports";
+const char E131Plugin::PACKET_RING_KEY[] = "packet_ring";
+const char E131Plugin::PER_SLOT_PRIORITY_KEY[] = "per_slot_priority";
 const char E131Plugin::PLUGIN_NAME[] = "E1.31 (sACN)";
 const char E131Plugin::PLUGIN_PREFIX[] = "e131";
 const char E131Plugin::PREPEND_HOSTNAME_KEY[] = "prepend_hostname";
+const char E131Plugin::RECEIVE_BUFFER_SIZE_KEY[] = "receive_buffer_size";
+const char E131Plugin::RECEIVE_SOCKETS_KEY[] = "receive_sockets";
 const char E131Plugin::REVISION_0_2[] = "0.2";
 const char E131Plugin::REVISION_0_46[] = "0.46";
 const char E131Plugin::REVISION_KEY[] = "revision";
+const char E131Plugin::SUPPRESS_MULTICAST_KEY[] = "suppress_multicast";
+const char E131Plugin::SYNC_UNIVERSE_KEY[] = "sync_universe";
+const char E131Plugin::UNICAST_DESTINATION_KEY[] = "unicast_destination";
 const unsigned int E131Plugin::DEFAULT_PORT_COUNT = 5;
 
 
@@ -68,6 +81,12 @@ bool E131Plugin::StartHook() {
       IGNORE_PREVIEW_DATA_KEY);
   options.enable_draft_discovery = m_preferences->GetValueAsBool(
       DRAFT_DISCOVERY_KEY);
+  options.per_slot_priority = m_preferences->GetValueAsBool(
+      PER_SLOT_PRIORITY_KEY);
+  options.batch_output = m_preferences->GetValueAsBool(BATCH_OUTPUT_KEY);
+  options.packet_ring = m_preferences->GetValueAsBool(PACKET_RING_KEY);
+  options.suppress_multicast = m_preferences->GetValueAsBool(
+      SUPPRESS_MULTICAST_KEY);
   if (m_preferences->GetValueAsBool(PREPEND_HOSTNAME_KEY)) {
     std::ostringstream str;
     str << ola::network::Hostname() << "-" << m_plugin_adaptor->InstanceName();
@@ -86,6 +105,45 @@ bool E131Plugin::StartHook() {
     options.dscp = dscp << 2;
   }
 
+  if (!StringToInt(m_preferences->GetValue(RECEIVE_SOCKETS_KEY),
+                   &options.receive_sockets)) {
+    OLA_WARN << "Invalid value for " << RECEIVE_SOCKETS_KEY;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(RECEIVE_BUFFER_SIZE_KEY),
+                   &options.receive_buffer_size)) {
+    OLA_WARN << "Invalid value for " << RECEIVE_BUFFER_SIZE_KEY;
+  }
+  options.send_buffer_size =
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences).send_buffer_size;
+
+  if (!StringToInt(m_preferences->GetValue(SYNC_UNIVERSE_KEY),
+                   &options.sync_universe)) {
+    OLA_WARN << "Invalid value for " << SYNC_UNIVERSE_KEY;
+  }
+
+  // Each destination is <universe>:<ip>[:<port>]
+  vector<string> destinations = m_preferences->GetMultipleValue(
+      UNICAST_DESTINATION_KEY);
+  vector<string>::const_iterator iter = destinations.begin();
+  for (; iter != destinations.end(); ++iter) {
+    if (iter->empty()) {
+      continue;
+    }
+    const string::size_type separator = iter->find(':');
+    uint16_t universe;
+    ola::network::IPV4SocketAddress destination;
+    if (separator == string::npos ||
+        !StringToInt(iter->substr(0, separator), &universe) ||
+        !E131Device::StringToDestination(iter->substr(separator + 1),
+                                         &destination)) {
+      OLA_WARN << "Invalid value for " << UNICAST_DESTINATION_KEY << ": "
+               << *iter;
+      continue;
+    }
+    options.unicast_destinations[universe].push_back(destination);
+  }
+
   if (!StringToInt(m_preferences->GetValue(INPUT_PORT_COUNT_KEY),
                    &options.input_ports)) {
     OLA_WARN << "Invalid value for input_ports";
@@ -96,10 +154,29 @@ bool E131Plugin::StartHook() {
     OLA_WARN << "Invalid value for input_ports";
   }
 
-  m_device = new E131Device(this, cid, ip_addr, m_plugin_adaptor, options);
+  ola::io::SelectServerInterface *node_loop = m_plugin_adaptor->WorkerLoop(
+      Id());
+  // Prefer a loop on the same NUMA node as the NIC the node reads from.
+  ola::network::InterfaceMonitor *monitor =
+      m_plugin_adaptor->GetInterfaceMonitor();
+  ola::network::Interface iface;
+  if (node_loop && monitor && monitor->ChooseInterface(&iface, ip_addr)) {
+    node_loop = m_plugin_adaptor->WorkerLoop(Id(), iface.name);
+  }
+  if (m_preferences->GetValueAsBool(DEDICATED_THREAD_KEY)) {
+    node_loop = StartNodeThread();
+    if (!node_loop) {
+      return false;
+    }
+  }
+
+  m_device = new E131Device(this, cid, ip_addr, m_plugin_adaptor, options,
+                            node_loop);
 
   if (!m_device->Start()) {
     delete m_device;
+    m_device = NULL;
+    StopNodeThread();
     return false;
   }
 
@@ -117,12 +194,23 @@ bool E131Plugin::StopHook() {
     m_plugin_adaptor->UnregisterDevice(m_device);
     bool ret = m_device->Stop();
     delete m_device;
+    m_device = NULL;
+    StopNodeThread();
     return ret;
   }
   return true;
 }
 
 
+/*
+ * Rebind if the interface the node is using has changed.
+ */
+bool E131Plugin::AffectedBy(
+    const ola::network::InterfaceChanges &changes) const {
+  return m_device && changes.Affects(m_device->GetInterface());
+}
+
+
 /*
  * Return the description for this plugin
  */
@@ -148,6 +236,16 @@ bool E131Plugin::SetDefaultPreferences() {
     save = true;
   }
 
+  save |= m_preferences->SetDefaultValue(
+      BATCH_OUTPUT_KEY,
+      BoolValidator(),
+      false);
+
+  save |= m_preferences->SetDefaultValue(
+      DEDICATED_THREAD_KEY,
+      BoolValidator(),
+      false);
+
   save |= m_preferences->SetDefaultValue(
       DSCP_KEY,
       UIntValidator(0, 63),
@@ -175,11 +273,26 @@ bool E131Plugin::SetDefaultPreferences() {
 
   save |= m_preferences->SetDefaultValue(IP_KEY, StringValidator(true), "");
 
+  save |= m_preferences->SetDefaultValue(
+      PACKET_RING_KEY,
+      BoolValidator(),
+      false);
+
+  save |= m_preferences->SetDefaultValue(
+      PER_SLOT_PRIORITY_KEY,
+      BoolValidator(),
+      false);
+
   save |= m_preferences->SetDefaultValue(
       PREPEND_HOSTNAME_KEY,
       BoolValidator(),
       true);
 
+  save |= m_preferences->SetDefaultValue(
+      RECEIVE_SOCKETS_KEY,
+      UIntValidator(0, 64),
+      0u);
+
   std::set<string> revision_values;
   revision_values.insert(REVISION_0_2);
   revision_values.insert(REVISION_0_46);
@@ -189,6 +302,17 @@ bool E131Plugin::SetDefaultPreferences() {
       SetValidator<string>(revision_values),
       REVISION_0_46);
 
+  save |= m_preferences->SetDefaultValue(
+      SUPPRESS_MULTICAST_KEY,
+      BoolValidator(),
+      false);
+
+  save |= m_preferences->SetDefaultValue(
+      SYNC_UNIVERSE_KEY,
+      UIntValidator(0, 63999),
+      0u);
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
+
   if (save) {
     m_preferences->Save();
   }
@@ -203,6 +327,44 @@ bool E131Plugin::SetDefaultPreferences() {
 
   return true;
 }
+
+
+/*
+ * Start a thread to run the E131Node on.
+ * @returns the thread's SelectServer, or NULL if the thread couldn't be
+ *   started.
+ */
+ola::io::SelectServerInterface *E131Plugin::StartNodeThread() {
+  m_node_ss.reset(new ola::io::SelectServer());
+  m_node_thread.reset(new ola::thread::CallbackThread(
+      NewSingleCallback(this, &E131Plugin::RunNodeLoop),
+      ola::thread::Thread::Options("e131-node")));
+  if (!m_node_thread->Start()) {
+    OLA_WARN << "Failed to start the E1.31 node thread";
+    m_node_thread.reset();
+    m_node_ss.reset();
+    return NULL;
+  }
+  return m_node_ss.get();
+}
+
+
+void E131Plugin::StopNodeThread() {
+  if (!m_node_thread.get()) {
+    return;
+  }
+  m_node_ss->Terminate();
+  m_node_thread->Join();
+  m_node_thread.reset();
+  m_node_ss.reset();
+}
+
+
+void E131Plugin::RunNodeLoop() {
+  m_node_ss->Run();
+  // Run anything that was queued after we were told to stop.
+  m_node_ss->DrainCallbacks();
+}
 }  // namespace e131
 }  // namespace plugin
 }  // namespace ola
@@ -21,9 +21,12 @@
 #ifndef PLUGINS_E131_E131PLUGIN_H_
 #define PLUGINS_E131_E131PLUGIN_H_
 
+#include <memory>
 #include <string>
 #include "olad/Plugin.h"
+#include "ola/io/SelectServer.h"
 #include "ola/plugin_id.h"
+#include "ola/thread/CallbackThread.h"
 
 namespace ola {
 namespace plugin {
@@ -47,23 +50,40 @@ class E131Plugin: public ola::Plugin {
     bool StartHook();
     bool StopHook();
     bool SetDefaultPreferences();
+    bool AffectedBy(const ola::network::InterfaceChanges &changes) const;
+    ola::io::SelectServerInterface *StartNodeThread();
+    void StopNodeThread();
+    void RunNodeLoop();
 
     E131Device *m_device;
+    // Only used if the node runs on its own thread.
+    std::auto_ptr<ola::io::SelectServer> m_node_ss;
+    std::auto_ptr<ola::thread::CallbackThread> m_node_thread;
+
+    static const char BATCH_OUTPUT_KEY[];
     static const char CID_KEY[];
     static const unsigned int DEFAULT_DSCP_VALUE;
     static const unsigned int DEFAULT_PORT_COUNT;
+    static const char DEDICATED_THREAD_KEY[];
     static const char DRAFT_DISCOVERY_KEY[];
     static const char DSCP_KEY[];
     static const char IGNORE_PREVIEW_DATA_KEY[];
     static const char INPUT_PORT_COUNT_KEY[];
     static const char IP_KEY[];
     static const char OUTPUT_PORT_COUNT_KEY[];
+    static const char PACKET_RING_KEY[];
+    static const char PER_SLOT_PRIORITY_KEY[];
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char PREPEND_HOSTNAME_KEY[];
+    static const char RECEIVE_BUFFER_SIZE_KEY[];
+    static const char RECEIVE_SOCKETS_KEY[];
     static const char REVISION_0_2[];
     static const char REVISION_0_46[];
     static const char REVISION_KEY[];
+    static const char SUPPRESS_MULTICAST_KEY[];
+    static const char SYNC_UNIVERSE_KEY[];
+    static const char UNICAST_DESTINATION_KEY[];
 };
 }  // namespace e131
 }  // namespace plugin
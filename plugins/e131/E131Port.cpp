@@ -19,7 +19,10 @@
  */
 
 #include <string>
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "olad/PluginAdaptor.h"
 #include "olad/Universe.h"
 #include "plugins/e131/E131Port.h"
 #include "plugins/e131/E131Device.h"
@@ -58,20 +61,84 @@ string E131PortHelper::Description(Universe *universe) const {
 void E131InputPort::PostSetUniverse(Universe *old_universe,
                                     Universe *new_universe) {
   if (old_universe)
-    m_node->RemoveHandler(old_universe->UniverseId());
+    m_device->RemoveHandler(old_universe->UniverseId());
 
-  if (new_universe)
-    m_node->SetHandler(
+  if (!new_universe)
+    return;
+
+  if (m_device->NodeOnWorkerLoop()) {
+    m_device->SetHandler(
+        new_universe->UniverseId(),
+        &m_node_buffer,
+        &m_node_priority,
+        NewCallback(this, &E131InputPort::HandOffData));
+  } else {
+    m_device->SetHandler(
         new_universe->UniverseId(),
         &m_buffer,
         &m_priority,
-        NewCallback<E131InputPort, void>(this, &E131InputPort::DmxChanged));
+        NewCallback(this, &E131InputPort::HandleData));
+  }
+}
+
+
+/*
+ * Called when new data arrives, if the node is on the PluginAdaptor's loop.
+ */
+void E131InputPort::HandleData() {
+  DmxChangedAt(m_device->NodeReceiveTime());
+}
+
+
+/*
+ * Called on the node's loop when new data arrives. The DmxBuffer refcount
+ * isn't thread safe, so the merged frame is copied into the triple buffer.
+ *
+ * The PluginAdaptor's loop is only woken if it isn't already due to pick up
+ * a frame, so a burst of packets for a universe results in a single update,
+ * with the newest data.
+ */
+void E131InputPort::HandOffData() {
+  Frame *frame = m_frames.WriteBuffer();
+  frame->length = sizeof(frame->data);
+  m_node_buffer.Get(frame->data, &frame->length);
+  frame->priority = m_node_priority;
+  frame->receive_time = m_device->NodeReceiveTime();
+  m_frames.Publish();
+
+  if (!__atomic_exchange_n(&m_drain_pending, true, __ATOMIC_SEQ_CST)) {
+    m_plugin_adaptor->Execute(
+        NewSingleCallback(this, &E131InputPort::DrainFrames));
+  }
+}
+
+
+/*
+ * Called on the PluginAdaptor's loop to pick up the newest frame.
+ */
+void E131InputPort::DrainFrames() {
+  // This must be cleared before we pick up the frame, so that frames
+  // published after this point schedule another drain.
+  __atomic_store_n(&m_drain_pending, false, __ATOMIC_SEQ_CST);
+
+  if (!m_frames.Update()) {
+    return;
+  }
+
+  const Frame &frame = m_frames.ReadBuffer();
+  if (frame.length) {
+    m_buffer.Set(frame.data, frame.length);
+  } else {
+    m_buffer.Reset();
+  }
+  m_priority = frame.priority;
+  DmxChangedAt(frame.receive_time);
 }
 
 E131OutputPort::~E131OutputPort() {
   Universe *universe = GetUniverse();
   if (universe) {
-    m_node->TerminateStream(universe->UniverseId(), m_last_priority);
+    m_device->TerminateStream(universe->UniverseId(), m_last_priority);
   }
 }
 
@@ -81,10 +148,10 @@ E131OutputPort::~E131OutputPort() {
 void E131OutputPort::PostSetUniverse(Universe *old_universe,
                                      Universe *new_universe) {
   if (old_universe) {
-    m_node->TerminateStream(old_universe->UniverseId(), m_last_priority);
+    m_device->TerminateStream(old_universe->UniverseId(), m_last_priority);
   }
   if (new_universe) {
-    m_node->StartStream(new_universe->UniverseId());
+    m_device->StartStream(new_universe->UniverseId());
   }
 }
 
@@ -99,8 +166,8 @@ bool E131OutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
 
   m_last_priority = (GetPriorityMode() == PRIORITY_MODE_STATIC) ?
       GetPriority() : priority;
-  return m_node->SendDMX(universe->UniverseId(), buffer, m_last_priority,
-                         m_preview_on);
+  return m_device->SendDMX(universe->UniverseId(), buffer, m_last_priority,
+                           m_preview_on);
 }
 }  // namespace e131
 }  // namespace plugin
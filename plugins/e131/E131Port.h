@@ -22,6 +22,9 @@
 #define PLUGINS_E131_E131PORT_H_
 
 #include <string>
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/thread/TripleBuffer.h"
 #include "olad/Port.h"
 #include "plugins/e131/E131Device.h"
 #include "libs/acn/E131Node.h"
@@ -41,11 +44,14 @@ class E131PortHelper {
 
 class E131InputPort: public BasicInputPort {
  public:
-  E131InputPort(E131Device *parent, int id, ola::acn::E131Node *node,
+  E131InputPort(E131Device *parent, int id,
                 class PluginAdaptor *plugin_adaptor)
       : BasicInputPort(parent, id, plugin_adaptor),
-        m_node(node),
-        m_priority(ola::dmx::SOURCE_PRIORITY_DEFAULT) {
+        m_device(parent),
+        m_plugin_adaptor(plugin_adaptor),
+        m_priority(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+        m_node_priority(ola::dmx::SOURCE_PRIORITY_DEFAULT),
+        m_drain_pending(false) {
     SetPriorityMode(PRIORITY_MODE_INHERIT);
   }
 
@@ -61,19 +67,41 @@ class E131InputPort: public BasicInputPort {
   uint8_t InheritedPriority() const { return m_priority; }
 
  private:
+  E131Device *m_device;
+  class PluginAdaptor *m_plugin_adaptor;
   ola::DmxBuffer m_buffer;
-  ola::acn::E131Node *m_node;
   E131PortHelper m_helper;
   uint8_t m_priority;
+  // Only used if the node is on a worker loop, these are owned by that loop.
+  ola::DmxBuffer m_node_buffer;
+  uint8_t m_node_priority;
+
+  // A merged frame, passed from the node's loop to the PluginAdaptor's loop.
+  struct Frame {
+    uint8_t data[DMX_UNIVERSE_SIZE];
+    unsigned int length;
+    uint8_t priority;
+    TimeStamp receive_time;
+  };
+
+  // The newest frame always wins, older ones that weren't picked up are
+  // overwritten.
+  ola::thread::TripleBuffer<Frame> m_frames;
+  // True if DrainFrames() has been scheduled but hasn't run yet.
+  bool m_drain_pending;
+
+  void HandleData();
+  void HandOffData();
+  void DrainFrames();
 };
 
 
 class E131OutputPort: public BasicOutputPort {
  public:
-  E131OutputPort(E131Device *parent, int id, ola::acn::E131Node *node)
+  E131OutputPort(E131Device *parent, int id)
       : BasicOutputPort(parent, id),
-        m_preview_on(false),
-        m_node(node) {
+        m_device(parent),
+        m_preview_on(false) {
     m_last_priority = GetPriority();
   }
 
@@ -94,10 +122,10 @@ class E131OutputPort: public BasicOutputPort {
   bool SupportsPriorities() const { return true; }
 
  private:
+  E131Device *m_device;
   bool m_preview_on;
   uint8_t m_last_priority;
   ola::DmxBuffer m_buffer;
-  ola::acn::E131Node *m_node;
   E131PortHelper m_helper;
 };
 }  // namespace e131
@@ -87,6 +87,10 @@ bool EspNetDevice::StartHook() {
   }
 
   m_plugin_adaptor->AddReadDescriptor(m_node->GetSocket());
+  m_socket_monitor.reset(new UDPSocketMonitor(
+      m_plugin_adaptor, m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences)));
+  m_socket_monitor->AddSocket(m_node->GetSocket());
   return true;
 }
 
@@ -96,6 +100,8 @@ bool EspNetDevice::StartHook() {
  */
 void EspNetDevice::PrePortStop() {
   m_plugin_adaptor->RemoveReadDescriptor(m_node->GetSocket());
+  m_socket_monitor->RemoveSocket(m_node->GetSocket());
+  m_socket_monitor.reset();
 }
 
 /*
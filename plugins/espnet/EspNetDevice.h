@@ -21,8 +21,10 @@
 #ifndef PLUGINS_ESPNET_ESPNETDEVICE_H_
 #define PLUGINS_ESPNET_ESPNETDEVICE_H_
 
+#include <memory>
 #include <string>
 #include "olad/Device.h"
+#include "olad/UDPSocketMonitor.h"
 #include "olad/Plugin.h"
 
 namespace ola {
@@ -49,6 +51,7 @@ class EspNetDevice: public Device {
     class Preferences *m_preferences;
     class PluginAdaptor *m_plugin_adaptor;
     class EspNetNode *m_node;
+    std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
 
     static const char ESPNET_DEVICE_NAME[];
 };
@@ -20,6 +20,7 @@
 
 #include <string>
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/espnet/EspNetPlugin.h"
 #include "plugins/espnet/EspNetPluginDescription.h"
 #include "plugins/espnet/EspNetDevice.h"
@@ -93,6 +94,7 @@ bool EspNetPlugin::SetDefaultPreferences() {
 
   save |= m_preferences->SetDefaultValue(EspNetDevice::NODE_NAME_KEY,
                                          StringValidator(), ESPNET_NODE_NAME);
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
 
   if (save) {
     m_preferences->Save();
@@ -18,10 +18,17 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <string.h>
 #include <ola/Constants.h>
-#include <ola/base/Macro.h>
+#include <algorithm>
 #include "plugins/espnet/RunLengthDecoder.h"
 
+// SSE2 is part of the x86-64 baseline, so it's selected at compile time.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define OLA_RLE_SSE2 1
+#endif  // defined(__SSE2__)
+
 namespace ola {
 namespace plugin {
 namespace espnet {
@@ -31,32 +38,77 @@ namespace espnet {
  * @param dst the DmxBuffer to store the result
  * @param src_data the data to decode
  * @param length the length of the data to decode
+ *
+ * The slots are decoded into a local frame, so runs of literal values can be
+ * copied in one go.
  */
 void RunLengthDecoder::Decode(DmxBuffer *dst,
                               const uint8_t *src_data,
                               unsigned int length) {
-  dst->Reset();
+  uint8_t frame[DMX_UNIVERSE_SIZE];
   unsigned int i = 0;
   const uint8_t *value = src_data;
-  uint8_t count;
-  while (i < DMX_UNIVERSE_SIZE && value < src_data + length) {
+  const uint8_t *end = src_data + length;
+  while (i < DMX_UNIVERSE_SIZE && value < end) {
     switch (*value) {
       case REPEAT_VALUE:
-        value++;
-        count = *(value++);
-        dst->SetRangeToValue(i, *value, count);
-        i+= count;
+        if (end - value < 3) {
+          // truncated
+          value = end;
+        } else {
+          unsigned int count = std::min(static_cast<unsigned int>(value[1]),
+                                        DMX_UNIVERSE_SIZE - i);
+          memset(frame + i, value[2], count);
+          i += count;
+          value += 3;
+        }
         break;
       case ESCAPE_VALUE:
-        value++;
-        // fall through
-        OLA_FALLTHROUGH
-      default:
-        dst->SetChannel(i, *value);
-        i++;
+        if (end - value < 2) {
+          value = end;
+        } else {
+          frame[i++] = value[1];
+          value += 2;
+        }
+        break;
+      default: {
+        const uint8_t *literal_end = FindEscape(
+            value, std::min(end, value + (DMX_UNIVERSE_SIZE - i)));
+        memcpy(frame + i, value, literal_end - value);
+        i += static_cast<unsigned int>(literal_end - value);
+        value = literal_end;
+      }
+    }
+  }
+  dst->Set(frame, i);
+}
+
+/*
+ * Find the next escape or repeat value.
+ * @returns a pointer to the first escape or repeat value in [start, end), or
+ *   end if there isn't one.
+ */
+const uint8_t *RunLengthDecoder::FindEscape(const uint8_t *start,
+                                            const uint8_t *end) {
+  const uint8_t *ptr = start;
+#ifdef OLA_RLE_SSE2
+  const __m128i escape = _mm_set1_epi8(static_cast<char>(ESCAPE_VALUE));
+  const __m128i repeat = _mm_set1_epi8(static_cast<char>(REPEAT_VALUE));
+  for (; end - ptr >= static_cast<int>(sizeof(__m128i));
+       ptr += sizeof(__m128i)) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    unsigned int matches = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, escape),
+                     _mm_cmpeq_epi8(chunk, repeat)));
+    if (matches) {
+      return ptr + __builtin_ctz(matches);
     }
-    value++;
   }
+#endif  // OLA_RLE_SSE2
+  while (ptr < end && *ptr != ESCAPE_VALUE && *ptr != REPEAT_VALUE) {
+    ptr++;
+  }
+  return ptr;
 }
 }  // namespace espnet
 }  // namespace plugin
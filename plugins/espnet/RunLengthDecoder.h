@@ -38,6 +38,8 @@ class RunLengthDecoder {
  private:
   static const uint8_t ESCAPE_VALUE = 0xFD;
   static const uint8_t REPEAT_VALUE = 0xFE;
+
+  static const uint8_t *FindEscape(const uint8_t *start, const uint8_t *end);
 };
 }  // namespace espnet
 }  // namespace plugin
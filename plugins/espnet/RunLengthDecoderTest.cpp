@@ -19,7 +19,11 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
 
 #include "ola/testing/TestUtils.h"
 #include "plugins/espnet/RunLengthDecoder.h"
@@ -27,10 +31,14 @@
 class RunLengthDecoderTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RunLengthDecoderTest);
   CPPUNIT_TEST(testDecode);
+  CPPUNIT_TEST(testTruncated);
+  CPPUNIT_TEST(testRandomData);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testDecode();
+    void testTruncated();
+    void testRandomData();
  private:
 };
 
@@ -56,3 +64,71 @@ void RunLengthDecoderTest::testDecode() {
   decoder.Decode(&buffer, data, sizeof(data));
   OLA_ASSERT(buffer == expected);
 }
+
+
+/*
+ * Check that a truncated escape or repeat is dropped.
+ */
+void RunLengthDecoderTest::testTruncated() {
+  ola::plugin::espnet::RunLengthDecoder decoder;
+  const uint8_t expected_data[] = {0x78, 0x56};
+  ola::DmxBuffer expected(expected_data, sizeof(expected_data));
+  ola::DmxBuffer buffer;
+
+  const uint8_t repeat[] = {0x78, 0x56, 0xFE, 0x5};
+  decoder.Decode(&buffer, repeat, sizeof(repeat));
+  OLA_ASSERT(buffer == expected);
+
+  const uint8_t escape[] = {0x78, 0x56, 0xFD};
+  decoder.Decode(&buffer, escape, sizeof(escape));
+  OLA_ASSERT(buffer == expected);
+}
+
+
+/*
+ * Decode random data made up of literals, escapes & repeats.
+ */
+void RunLengthDecoderTest::testRandomData() {
+  ola::plugin::espnet::RunLengthDecoder decoder;
+  uint32_t state = 0x12345678;
+  for (unsigned int iteration = 0; iteration < 2000; iteration++) {
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> expected;
+    while (expected.size() < ola::DMX_UNIVERSE_SIZE + 16) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      uint8_t value = state & 0xff;
+      switch ((state >> 8) % 8) {
+        case 0:
+          // a repeat
+          encoded.push_back(0xFE);
+          encoded.push_back((state >> 16) & 0x1f);
+          encoded.push_back(value);
+          expected.insert(expected.end(), (state >> 16) & 0x1f, value);
+          break;
+        case 1:
+          // an escaped value
+          encoded.push_back(0xFD);
+          encoded.push_back(value);
+          expected.push_back(value);
+          break;
+        default:
+          if (value != 0xFD && value != 0xFE) {
+            encoded.push_back(value);
+            expected.push_back(value);
+          }
+      }
+      if (!expected.empty() && (state >> 24) == 0) {
+        break;
+      }
+    }
+
+    ola::DmxBuffer buffer;
+    decoder.Decode(&buffer, &encoded[0], encoded.size());
+    expected.resize(std::min(expected.size(),
+                             static_cast<size_t>(ola::DMX_UNIVERSE_SIZE)));
+    OLA_ASSERT_DATA_EQUALS(&expected[0], expected.size(), buffer.GetRaw(),
+                           buffer.Size());
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationDevice.cpp
+ * The Federation Device.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/federation/FederationDevice.h"
+
+#include <vector>
+
+#include "ola/Logging.h"
+#include "olad/PluginAdaptor.h"
+#include "plugins/federation/FederationPort.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+using ola::network::IPV4SocketAddress;
+using std::vector;
+
+FederationDevice::FederationDevice(AbstractPlugin *owner,
+                                   PluginAdaptor *plugin_adaptor,
+                                   const IPV4SocketAddress &listen_addr,
+                                   const vector<IPV4SocketAddress> &peers,
+                                   unsigned int input_ports,
+                                   unsigned int output_ports)
+    : Device(owner, "Federation Device"),
+      m_plugin_adaptor(plugin_adaptor),
+      m_input_port_count(input_ports),
+      m_output_port_count(output_ports),
+      m_node(new FederationNode(plugin_adaptor, listen_addr, peers)) {
+}
+
+bool FederationDevice::StartHook() {
+  if (!m_node->Start()) {
+    OLA_WARN << "Failed to start the federation node";
+    return false;
+  }
+  OLA_INFO << "Federation listening on " << m_node->ListenAddress();
+
+  for (unsigned int i = 0; i < m_input_port_count; i++) {
+    AddPort(new FederationInputPort(this, i, m_plugin_adaptor, m_node.get()));
+  }
+
+  for (unsigned int i = 0; i < m_output_port_count; i++) {
+    AddPort(new FederationOutputPort(this, i, m_node.get()));
+  }
+  return true;
+}
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
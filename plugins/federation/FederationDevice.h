@@ -0,0 +1,73 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationDevice.h
+ * The Federation Device.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_FEDERATION_FEDERATIONDEVICE_H_
+#define PLUGINS_FEDERATION_FEDERATIONDEVICE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/network/SocketAddress.h"
+#include "olad/Device.h"
+#include "plugins/federation/FederationNode.h"
+
+namespace ola {
+
+class AbstractPlugin;
+
+namespace plugin {
+namespace federation {
+
+class FederationDevice: public ola::Device {
+ public:
+  /**
+   * @brief Create a new Federation device.
+   * @param owner the Plugin that owns this device
+   * @param plugin_adaptor the PluginAdaptor to use
+   * @param listen_addr the IP:port to listen on.
+   * @param peers the IP:ports of the peers to connect to.
+   * @param input_ports the number of input ports to create.
+   * @param output_ports the number of output ports to create.
+   */
+  FederationDevice(AbstractPlugin *owner,
+                   PluginAdaptor *plugin_adaptor,
+                   const ola::network::IPV4SocketAddress &listen_addr,
+                   const std::vector<ola::network::IPV4SocketAddress> &peers,
+                   unsigned int input_ports,
+                   unsigned int output_ports);
+
+  std::string DeviceId() const { return "1"; }
+
+ protected:
+  bool StartHook();
+
+ private:
+  PluginAdaptor* const m_plugin_adaptor;
+  const unsigned int m_input_port_count;
+  const unsigned int m_output_port_count;
+  std::auto_ptr<FederationNode> m_node;
+
+  DISALLOW_COPY_AND_ASSIGN(FederationDevice);
+};
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_FEDERATION_FEDERATIONDEVICE_H_
@@ -0,0 +1,231 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationLink.cpp
+ * A TCP connection to a federated olad instance.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/federation/FederationLink.h"
+
+#include <string.h>
+
+#include "ola/Logging.h"
+#include "ola/io/BigEndianStream.h"
+#include "ola/network/SocketAddress.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+using ola::network::TCPSocket;
+
+namespace {
+// Enough for a few full frames.
+const unsigned int BLOCK_SIZE = 4096;
+}  // namespace
+
+FederationLink::FederationLink(ola::io::SelectServerInterface *ss,
+                               TCPSocket *socket)
+    : m_ss(ss),
+      m_socket(socket),
+      m_peer_address(socket->GetPeerAddress().V4Addr()),
+      m_on_close(NULL),
+      m_closed(false),
+      m_pool(BLOCK_SIZE),
+      m_output_queue(&m_pool),
+      m_write_registered(false),
+      m_dropped_frames(0),
+      m_rx_offset(0) {
+  m_socket->SetNoDelay();
+  m_socket->SetOnData(NewCallback(this, &FederationLink::SocketReady));
+  m_socket->SetOnClose(NewSingleCallback(this, &FederationLink::Close));
+  m_socket->SetOnWritable(NewCallback(this, &FederationLink::SocketWritable));
+  m_ss->AddReadDescriptor(m_socket.get());
+}
+
+FederationLink::~FederationLink() {
+  if (!m_closed) {
+    StopWriting();
+    m_ss->RemoveReadDescriptor(m_socket.get());
+  }
+  if (m_on_close) {
+    delete m_on_close;
+  }
+}
+
+void FederationLink::SetOnClose(SingleUseCallback0<void> *callback) {
+  if (m_on_close) {
+    delete m_on_close;
+  }
+  m_on_close = callback;
+}
+
+void FederationLink::SendFrame(uint32_t universe, uint8_t priority,
+                               const DmxBuffer &frame) {
+  PendingFrame pending;
+  pending.frame = frame;
+  pending.priority = priority;
+  pending.release = false;
+  Queue(universe, pending);
+}
+
+void FederationLink::SendRelease(uint32_t universe) {
+  PendingFrame pending;
+  pending.priority = 0;
+  pending.release = true;
+  Queue(universe, pending);
+}
+
+void FederationLink::Queue(uint32_t universe, const PendingFrame &pending) {
+  if (m_closed) {
+    return;
+  }
+
+  std::pair<PendingFrames::iterator, bool> result = m_pending.insert(
+      PendingFrames::value_type(universe, pending));
+  if (!result.second) {
+    if (!result.first->second.release) {
+      m_dropped_frames++;
+    }
+    result.first->second = pending;
+  }
+
+  if (!m_write_registered) {
+    m_write_registered = m_ss->AddWriteDescriptor(m_socket.get());
+  }
+}
+
+/*
+ * Read what's available and handle each complete message. The frames are
+ * decoded straight from the receive buffer.
+ */
+void FederationLink::SocketReady() {
+  unsigned int data_received = 0;
+  if (m_socket->Receive(m_rx_buffer + m_rx_offset,
+                        RX_BUFFER_SIZE - m_rx_offset,
+                        data_received) < 0) {
+    OLA_WARN << "Bad read from federation peer " << m_peer_address;
+    Close();
+    return;
+  }
+  m_rx_offset += data_received;
+
+  unsigned int message_start = 0;
+  while (m_rx_offset - message_start >= protocol::HEADER_SIZE) {
+    const uint8_t *message = m_rx_buffer + message_start;
+    protocol::Header header;
+    if (!protocol::ParseHeader(message, &header)) {
+      OLA_WARN << "Invalid message from federation peer " << m_peer_address;
+      Close();
+      return;
+    }
+
+    unsigned int message_size = protocol::HEADER_SIZE + header.body_length;
+    if (m_rx_offset - message_start < message_size) {
+      break;
+    }
+
+    if (!HandleMessage(header, message + protocol::HEADER_SIZE)) {
+      OLA_WARN << "Invalid frame for universe " << header.universe
+               << " from federation peer " << m_peer_address;
+      Close();
+      return;
+    }
+    message_start += message_size;
+  }
+
+  if (message_start) {
+    m_rx_offset -= message_start;
+    memmove(m_rx_buffer, m_rx_buffer + message_start, m_rx_offset);
+  }
+}
+
+bool FederationLink::HandleMessage(const protocol::Header &header,
+                                   const uint8_t *body) {
+  if (header.type == protocol::RELEASE) {
+    m_received.erase(header.universe);
+    if (m_on_release.get()) {
+      m_on_release->Run(header.universe);
+    }
+    return true;
+  }
+
+  DmxBuffer &frame = m_received[header.universe];
+  if (!protocol::ApplyFrame(header, body, &frame)) {
+    return false;
+  }
+  if (m_on_frame.get()) {
+    m_on_frame->Run(header.universe, header.priority, frame);
+  }
+  return true;
+}
+
+/*
+ * Called when the socket is writable. Any partially written messages are
+ * finished first, then all the queued frames are encoded and written with a
+ * single call.
+ */
+void FederationLink::SocketWritable() {
+  if (m_output_queue.Empty()) {
+    ola::io::BigEndianOutputStream stream(&m_output_queue);
+    PendingFrames::const_iterator iter = m_pending.begin();
+    for (; iter != m_pending.end(); ++iter) {
+      const PendingFrame &pending = iter->second;
+      if (pending.release) {
+        protocol::WriteRelease(&stream, iter->first);
+        m_sent.erase(iter->first);
+      } else {
+        DmxBuffer &sent = m_sent[iter->first];
+        protocol::WriteFrame(&stream, iter->first, pending.priority, sent,
+                             pending.frame);
+        sent = pending.frame;
+      }
+    }
+    m_pending.clear();
+  }
+
+  m_socket->Send(&m_output_queue);
+  if (m_output_queue.Empty() && m_pending.empty()) {
+    StopWriting();
+  }
+}
+
+void FederationLink::StopWriting() {
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_socket.get());
+    m_write_registered = false;
+  }
+}
+
+void FederationLink::Close() {
+  if (m_closed) {
+    return;
+  }
+  m_closed = true;
+  StopWriting();
+  m_ss->RemoveReadDescriptor(m_socket.get());
+  m_pending.clear();
+  m_output_queue.Clear();
+
+  SingleUseCallback0<void> *on_close = m_on_close;
+  m_on_close = NULL;
+  if (on_close) {
+    on_close->Run();
+  }
+}
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
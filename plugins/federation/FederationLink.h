@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationLink.h
+ * A TCP connection to a federated olad instance.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_FEDERATION_FEDERATIONLINK_H_
+#define PLUGINS_FEDERATION_FEDERATIONLINK_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/io/IOQueue.h"
+#include "ola/io/MemoryBlockPool.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/network/TCPSocket.h"
+#include "plugins/federation/FederationProtocol.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+/**
+ * @brief A TCP connection to a federated olad instance.
+ *
+ * Frames are queued per universe until the socket is writable, and a newer
+ * frame for a universe replaces one that hasn't been written yet. All the
+ * queued frames are then encoded and written together, each one as a delta
+ * against the last frame written for the universe where that's smaller.
+ *
+ * Received frames are decoded against the last frame received for the
+ * universe and passed to the frame callback.
+ */
+class FederationLink {
+ public:
+  /**
+   * @brief Called with the universe, priority and frame.
+   */
+  typedef Callback3<void, uint32_t, uint8_t, const DmxBuffer&> FrameCallback;
+
+  /**
+   * @brief Called when the peer releases a universe.
+   */
+  typedef Callback1<void, uint32_t> ReleaseCallback;
+
+  /**
+   * @brief Create a new FederationLink.
+   * @param ss the SelectServer to use.
+   * @param socket the connected socket, ownership is transferred.
+   */
+  FederationLink(ola::io::SelectServerInterface *ss,
+                 ola::network::TCPSocket *socket);
+  ~FederationLink();
+
+  /**
+   * @brief Set the callback run when a frame is received.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void SetOnFrame(FrameCallback *callback) { m_on_frame.reset(callback); }
+
+  /**
+   * @brief Set the callback run when the peer releases a universe.
+   * @param callback the callback to run, ownership is transferred.
+   */
+  void SetOnRelease(ReleaseCallback *callback) {
+    m_on_release.reset(callback);
+  }
+
+  /**
+   * @brief Set the callback run when the link closes.
+   * @param callback the callback to run, ownership is transferred.
+   *
+   * This is run when the socket is closed, or the peer sends something
+   * invalid. The link must not be deleted from within the callback.
+   */
+  void SetOnClose(SingleUseCallback0<void> *callback);
+
+  /**
+   * @brief The address of the peer.
+   */
+  const ola::network::IPV4SocketAddress &PeerAddress() const {
+    return m_peer_address;
+  }
+
+  /**
+   * @brief Queue a frame for a universe.
+   */
+  void SendFrame(uint32_t universe, uint8_t priority, const DmxBuffer &frame);
+
+  /**
+   * @brief Queue a release for a universe.
+   *
+   * This replaces any frame that hasn't been written yet.
+   */
+  void SendRelease(uint32_t universe);
+
+  /**
+   * @brief The number of universes waiting for the socket to become
+   *   writable.
+   */
+  unsigned int QueueDepth() const { return m_pending.size(); }
+
+  /**
+   * @brief The number of frames replaced by a newer frame before they were
+   *   sent.
+   */
+  uint64_t DroppedFrames() const { return m_dropped_frames; }
+
+ private:
+  static const unsigned int RX_BUFFER_SIZE = 16384;
+
+  struct PendingFrame {
+    DmxBuffer frame;
+    uint8_t priority;
+    bool release;
+  };
+
+  typedef std::map<uint32_t, PendingFrame> PendingFrames;
+  typedef std::map<uint32_t, DmxBuffer> FrameMap;
+
+  ola::io::SelectServerInterface *m_ss;
+  std::auto_ptr<ola::network::TCPSocket> m_socket;
+  const ola::network::IPV4SocketAddress m_peer_address;
+  std::auto_ptr<FrameCallback> m_on_frame;
+  std::auto_ptr<ReleaseCallback> m_on_release;
+  SingleUseCallback0<void> *m_on_close;
+  bool m_closed;
+
+  ola::io::MemoryBlockPool m_pool;
+  ola::io::IOQueue m_output_queue;
+  PendingFrames m_pending;
+  // The last frame written for each universe, the base for the next delta.
+  FrameMap m_sent;
+  bool m_write_registered;
+  uint64_t m_dropped_frames;
+
+  uint8_t m_rx_buffer[RX_BUFFER_SIZE];
+  unsigned int m_rx_offset;
+  // The last frame received for each universe.
+  FrameMap m_received;
+
+  void Queue(uint32_t universe, const PendingFrame &pending);
+  void SocketReady();
+  bool HandleMessage(const protocol::Header &header, const uint8_t *body);
+  void SocketWritable();
+  void StopWriting();
+  void Close();
+
+  DISALLOW_COPY_AND_ASSIGN(FederationLink);
+};
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_FEDERATION_FEDERATIONLINK_H_
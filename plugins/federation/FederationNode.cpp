@@ -0,0 +1,250 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationNode.cpp
+ * Exchanges universes with other olad instances.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/federation/FederationNode.h"
+
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "plugins/federation/FederationLink.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+using ola::TimeInterval;
+using ola::network::GenericSocketAddress;
+using ola::network::IPV4SocketAddress;
+using ola::network::TCPAcceptingSocket;
+using ola::network::TCPSocket;
+using std::vector;
+
+namespace {
+
+void CleanupLink(FederationLink *link) {
+  delete link;
+}
+}  // namespace
+
+FederationNode::FederationNode(ola::io::SelectServerInterface *ss,
+                               const IPV4SocketAddress &listen_addr,
+                               const vector<IPV4SocketAddress> &peers)
+    : m_ss(ss),
+      m_listen_addr(listen_addr),
+      m_peers(peers),
+      m_listen_socket_factory(
+          NewCallback(this, &FederationNode::NewInboundConnection)),
+      m_connect_socket_factory(
+          NewCallback(this, &FederationNode::NewOutboundConnection)),
+      m_backoff(TimeInterval(1, 0), TimeInterval(300, 0)),
+      m_connector(ss, &m_connect_socket_factory, TimeInterval(3, 0)) {
+}
+
+FederationNode::~FederationNode() {
+  if (m_listening_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_listening_socket.get());
+    m_listening_socket.reset();
+  }
+
+  LinkSet::iterator iter = m_links.begin();
+  for (; iter != m_links.end(); ++iter) {
+    delete *iter;
+  }
+  m_links.clear();
+  m_outbound.clear();
+
+  vector<IPV4SocketAddress>::const_iterator peer_iter = m_peers.begin();
+  for (; peer_iter != m_peers.end(); ++peer_iter) {
+    m_connector.RemoveEndpoint(*peer_iter);
+  }
+  STLDeleteValues(&m_handlers);
+}
+
+bool FederationNode::Start() {
+  std::auto_ptr<TCPAcceptingSocket> listening_socket(
+      new TCPAcceptingSocket(&m_listen_socket_factory));
+  if (!listening_socket->Listen(m_listen_addr)) {
+    return false;
+  }
+  m_ss->AddReadDescriptor(listening_socket.get());
+  m_listening_socket.reset(listening_socket.release());
+
+  vector<IPV4SocketAddress>::const_iterator iter = m_peers.begin();
+  for (; iter != m_peers.end(); ++iter) {
+    m_connector.AddEndpoint(*iter, &m_backoff);
+  }
+  return true;
+}
+
+IPV4SocketAddress FederationNode::ListenAddress() const {
+  if (m_listening_socket.get()) {
+    GenericSocketAddress addr = m_listening_socket->GetLocalAddress();
+    if (addr.Family() == AF_INET) {
+      return addr.V4Addr();
+    }
+  }
+  return IPV4SocketAddress();
+}
+
+void FederationNode::SendFrame(uint32_t universe, uint8_t priority,
+                               const DmxBuffer &frame) {
+  ExportedUniverse &exported = m_exported[universe];
+  exported.frame = frame;
+  exported.priority = priority;
+
+  LinkSet::iterator iter = m_links.begin();
+  for (; iter != m_links.end(); ++iter) {
+    (*iter)->SendFrame(universe, priority, frame);
+  }
+}
+
+void FederationNode::StopExport(uint32_t universe) {
+  if (!m_exported.erase(universe)) {
+    return;
+  }
+
+  LinkSet::iterator iter = m_links.begin();
+  for (; iter != m_links.end(); ++iter) {
+    (*iter)->SendRelease(universe);
+  }
+}
+
+void FederationNode::SetHandler(uint32_t universe, FrameHandler *handler) {
+  if (!handler) {
+    STLRemoveAndDelete(&m_handlers, universe);
+    return;
+  }
+
+  STLReplaceAndDelete(&m_handlers, universe, handler);
+  RemoteMap::const_iterator iter = m_remote.find(universe);
+  if (iter != m_remote.end()) {
+    handler->Run(iter->second.priority, iter->second.frame);
+  }
+}
+
+void FederationNode::NewInboundConnection(TCPSocket *socket) {
+  if (!socket) {
+    return;
+  }
+  FederationLink *link = AddLink(socket);
+  OLA_INFO << "Federation peer " << link->PeerAddress() << " connected";
+}
+
+void FederationNode::NewOutboundConnection(TCPSocket *socket) {
+  FederationLink *link = AddLink(socket);
+  m_outbound[link] = link->PeerAddress();
+  OLA_INFO << "Connected to federation peer " << link->PeerAddress();
+}
+
+/*
+ * Create a link for a new connection and send it all the exported universes.
+ */
+FederationLink *FederationNode::AddLink(TCPSocket *socket) {
+  FederationLink *link = new FederationLink(m_ss, socket);
+  link->SetOnFrame(NewCallback(this, &FederationNode::LinkFrame, link));
+  link->SetOnRelease(NewCallback(this, &FederationNode::LinkRelease, link));
+  link->SetOnClose(NewSingleCallback(this, &FederationNode::LinkClosed, link));
+  m_links.insert(link);
+
+  ExportedMap::const_iterator iter = m_exported.begin();
+  for (; iter != m_exported.end(); ++iter) {
+    link->SendFrame(iter->first, iter->second.priority, iter->second.frame);
+  }
+  return link;
+}
+
+void FederationNode::LinkFrame(FederationLink *link, uint32_t universe,
+                               uint8_t priority, const DmxBuffer &frame) {
+  RemoteMap::iterator iter = m_remote.find(universe);
+  if (iter == m_remote.end()) {
+    RemoteUniverse remote;
+    remote.owner = link;
+    iter = m_remote.insert(RemoteMap::value_type(universe, remote)).first;
+    OLA_INFO << "Universe " << universe << " is owned by federation peer "
+             << link->PeerAddress();
+  } else if (iter->second.owner != link) {
+    if (m_conflicts.insert(universe).second) {
+      OLA_WARN << "Ignoring universe " << universe << " from federation peer "
+               << link->PeerAddress() << ", it's already owned by "
+               << iter->second.owner->PeerAddress();
+    }
+    return;
+  }
+
+  iter->second.frame = frame;
+  iter->second.priority = priority;
+  RunHandler(universe, priority, frame);
+}
+
+void FederationNode::LinkRelease(FederationLink *link, uint32_t universe) {
+  RemoteMap::iterator iter = m_remote.find(universe);
+  if (iter == m_remote.end() || iter->second.owner != link) {
+    return;
+  }
+  m_remote.erase(iter);
+  m_conflicts.erase(universe);
+  RunHandler(universe, 0, DmxBuffer());
+}
+
+void FederationNode::LinkClosed(FederationLink *link) {
+  OLA_INFO << "Federation link to " << link->PeerAddress() << " closed";
+  m_links.erase(link);
+
+  // Release the universes this link owned.
+  vector<uint32_t> released;
+  RemoteMap::iterator iter = m_remote.begin();
+  while (iter != m_remote.end()) {
+    if (iter->second.owner == link) {
+      released.push_back(iter->first);
+      m_conflicts.erase(iter->first);
+      m_remote.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+
+  EndpointMap::iterator endpoint_iter = m_outbound.find(link);
+  if (endpoint_iter != m_outbound.end()) {
+    // This starts the reconnect.
+    m_connector.Disconnect(endpoint_iter->second);
+    m_outbound.erase(endpoint_iter);
+  }
+
+  // We're in the call stack of the link, so delete it on the next run of the
+  // event loop.
+  m_ss->Execute(NewSingleCallback(&CleanupLink, link));
+
+  vector<uint32_t>::const_iterator released_iter = released.begin();
+  for (; released_iter != released.end(); ++released_iter) {
+    RunHandler(*released_iter, 0, DmxBuffer());
+  }
+}
+
+void FederationNode::RunHandler(uint32_t universe, uint8_t priority,
+                                const DmxBuffer &frame) {
+  FrameHandler *handler = STLFindOrNull(m_handlers, universe);
+  if (handler) {
+    handler->Run(priority, frame);
+  }
+}
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,168 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationNode.h
+ * Exchanges universes with other olad instances.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_FEDERATION_FEDERATIONNODE_H_
+#define PLUGINS_FEDERATION_FEDERATIONNODE_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/io/SelectServerInterface.h"
+#include "ola/network/AdvancedTCPConnector.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/network/TCPSocket.h"
+#include "ola/network/TCPSocketFactory.h"
+#include "ola/util/Backoff.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+class FederationLink;
+
+/**
+ * @brief Exchanges universes with other olad instances.
+ *
+ * The node listens for connections from its peers, and connects to each of
+ * the configured peers. Each exported universe is sent over every link.
+ *
+ * A universe is owned by a single node. The first link to send a universe
+ * owns it until the peer releases it or the link closes, and frames for the
+ * universe from any other link are ignored.
+ */
+class FederationNode {
+ public:
+  /**
+   * @brief Called with the priority and frame of a remote universe.
+   *
+   * An empty frame means the universe was released by its owner.
+   */
+  typedef Callback2<void, uint8_t, const DmxBuffer&> FrameHandler;
+
+  /**
+   * @brief Create a new FederationNode.
+   * @param ss the SelectServer to use.
+   * @param listen_addr the IP:port to listen on.
+   * @param peers the IP:ports of the peers to connect to.
+   */
+  FederationNode(ola::io::SelectServerInterface *ss,
+                 const ola::network::IPV4SocketAddress &listen_addr,
+                 const std::vector<ola::network::IPV4SocketAddress> &peers);
+  ~FederationNode();
+
+  /**
+   * @brief Start listening and connecting to the peers.
+   * @returns false if the listening socket couldn't be set up.
+   */
+  bool Start();
+
+  /**
+   * @brief The address the node is listening on.
+   */
+  ola::network::IPV4SocketAddress ListenAddress() const;
+
+  /**
+   * @brief Export a frame for a universe to all peers.
+   *
+   * The last frame for each exported universe is sent to peers that connect
+   * later.
+   */
+  void SendFrame(uint32_t universe, uint8_t priority, const DmxBuffer &frame);
+
+  /**
+   * @brief Stop exporting a universe.
+   */
+  void StopExport(uint32_t universe);
+
+  /**
+   * @brief Set the handler for a remote universe.
+   * @param universe the universe id.
+   * @param handler the handler to run, ownership is transferred. NULL
+   *   removes the existing handler.
+   *
+   * If the universe already has an owner the handler is run with the current
+   * frame.
+   */
+  void SetHandler(uint32_t universe, FrameHandler *handler);
+
+  /**
+   * @brief The number of open links.
+   */
+  unsigned int LinkCount() const { return m_links.size(); }
+
+ private:
+  struct ExportedUniverse {
+    DmxBuffer frame;
+    uint8_t priority;
+  };
+
+  struct RemoteUniverse {
+    FederationLink *owner;
+    DmxBuffer frame;
+    uint8_t priority;
+  };
+
+  typedef std::set<FederationLink*> LinkSet;
+  typedef std::map<FederationLink*, ola::network::IPV4SocketAddress>
+      EndpointMap;
+  typedef std::map<uint32_t, ExportedUniverse> ExportedMap;
+  typedef std::map<uint32_t, RemoteUniverse> RemoteMap;
+  typedef std::map<uint32_t, FrameHandler*> HandlerMap;
+
+  ola::io::SelectServerInterface* const m_ss;
+  const ola::network::IPV4SocketAddress m_listen_addr;
+  const std::vector<ola::network::IPV4SocketAddress> m_peers;
+
+  ola::network::TCPSocketFactory m_listen_socket_factory;
+  ola::network::TCPSocketFactory m_connect_socket_factory;
+  std::auto_ptr<ola::network::TCPAcceptingSocket> m_listening_socket;
+  ola::ExponentialBackoffPolicy m_backoff;
+  ola::network::AdvancedTCPConnector m_connector;
+
+  LinkSet m_links;
+  // The endpoint for each link we opened, so it can be reconnected.
+  EndpointMap m_outbound;
+  ExportedMap m_exported;
+  RemoteMap m_remote;
+  HandlerMap m_handlers;
+  // Universes we've already logged a conflicting owner for.
+  std::set<uint32_t> m_conflicts;
+
+  void NewInboundConnection(ola::network::TCPSocket *socket);
+  void NewOutboundConnection(ola::network::TCPSocket *socket);
+  FederationLink *AddLink(ola::network::TCPSocket *socket);
+  void LinkFrame(FederationLink *link, uint32_t universe, uint8_t priority,
+                 const DmxBuffer &frame);
+  void LinkRelease(FederationLink *link, uint32_t universe);
+  void LinkClosed(FederationLink *link);
+  void RunHandler(uint32_t universe, uint8_t priority,
+                  const DmxBuffer &frame);
+
+  DISALLOW_COPY_AND_ASSIGN(FederationNode);
+};
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_FEDERATION_FEDERATIONNODE_H_
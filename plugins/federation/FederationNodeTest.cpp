@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationNodeTest.cpp
+ * Test fixture for the FederationNode class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/federation/FederationNode.h"
+
+using ola::DmxBuffer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::plugin::federation::FederationNode;
+using std::auto_ptr;
+using std::map;
+using std::vector;
+
+class FederationNodeTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FederationNodeTest);
+  CPPUNIT_TEST(testMirror);
+  CPPUNIT_TEST(testOwnership);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  FederationNodeTest()
+      : CppUnit::TestFixture(),
+        m_ss(NULL) {
+  }
+  void setUp();
+
+  void testMirror();
+  void testOwnership();
+
+ private:
+  ola::io::SelectServer m_ss;
+  auto_ptr<FederationNode> m_owner;
+  auto_ptr<FederationNode> m_mirror;
+  map<uint32_t, DmxBuffer> m_frames;
+  uint8_t m_priority;
+
+  void CaptureFrame(uint32_t universe, uint8_t priority,
+                    const DmxBuffer &frame) {
+    m_frames[universe] = frame;
+    m_priority = priority;
+    m_ss.Terminate();
+  }
+
+  FederationNode *NewNode(const vector<IPV4SocketAddress> &peers) {
+    FederationNode *node = new FederationNode(
+        &m_ss, IPV4SocketAddress(IPV4Address::Loopback(), 0), peers);
+    OLA_ASSERT_TRUE(node->Start());
+    return node;
+  }
+
+  static const uint32_t UNIVERSE = 1;
+  static const uint32_t OTHER_UNIVERSE = 2;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FederationNodeTest);
+
+const uint32_t FederationNodeTest::UNIVERSE;
+const uint32_t FederationNodeTest::OTHER_UNIVERSE;
+
+void FederationNodeTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_DEBUG, ola::OLA_LOG_STDERR);
+  m_owner.reset(NewNode(vector<IPV4SocketAddress>()));
+
+  vector<IPV4SocketAddress> peers;
+  peers.push_back(m_owner->ListenAddress());
+  m_mirror.reset(NewNode(peers));
+  m_mirror->SetHandler(
+      UNIVERSE,
+      ola::NewCallback(this, &FederationNodeTest::CaptureFrame, UNIVERSE));
+}
+
+/*
+ * Check frames, including ones exported before the peer connected, are
+ * mirrored and the release is passed on.
+ */
+void FederationNodeTest::testMirror() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  m_owner->SendFrame(UNIVERSE, 150, buffer);
+
+  m_ss.Run();
+  OLA_ASSERT_EQ(buffer, m_frames[UNIVERSE]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), m_priority);
+  OLA_ASSERT_EQ(1u, m_owner->LinkCount());
+  OLA_ASSERT_EQ(1u, m_mirror->LinkCount());
+
+  // This is sent as a delta.
+  buffer.SetChannel(2, 10);
+  m_owner->SendFrame(UNIVERSE, 100, buffer);
+  m_ss.Run();
+  OLA_ASSERT_EQ(buffer, m_frames[UNIVERSE]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), m_priority);
+
+  m_owner->StopExport(UNIVERSE);
+  m_ss.Run();
+  OLA_ASSERT_EQ(0u, m_frames[UNIVERSE].Size());
+
+  // A new handler is run with the current frame.
+  m_owner->SendFrame(UNIVERSE, 100, buffer);
+  m_ss.Run();
+  m_frames.clear();
+  m_mirror->SetHandler(
+      UNIVERSE,
+      ola::NewCallback(this, &FederationNodeTest::CaptureFrame, UNIVERSE));
+  OLA_ASSERT_EQ(buffer, m_frames[UNIVERSE]);
+
+  // Closing the owner releases the universe.
+  m_owner.reset();
+  m_ss.Run();
+  OLA_ASSERT_EQ(0u, m_frames[UNIVERSE].Size());
+}
+
+/*
+ * Check frames for a universe from a second peer are ignored.
+ */
+void FederationNodeTest::testOwnership() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  m_owner->SendFrame(UNIVERSE, 100, buffer);
+  m_ss.Run();
+  OLA_ASSERT_EQ(buffer, m_frames[UNIVERSE]);
+
+  // The other peer's universes are sent in order, so once OTHER_UNIVERSE
+  // arrives, the frame for UNIVERSE has been handled.
+  m_mirror->SetHandler(
+      OTHER_UNIVERSE,
+      ola::NewCallback(this, &FederationNodeTest::CaptureFrame,
+                       OTHER_UNIVERSE));
+  vector<IPV4SocketAddress> peers;
+  peers.push_back(m_mirror->ListenAddress());
+  auto_ptr<FederationNode> other(NewNode(peers));
+  DmxBuffer other_buffer;
+  other_buffer.SetFromString("9,9");
+  other->SendFrame(UNIVERSE, 200, other_buffer);
+  other->SendFrame(OTHER_UNIVERSE, 200, other_buffer);
+
+  m_ss.Run();
+  OLA_ASSERT_EQ(other_buffer, m_frames[OTHER_UNIVERSE]);
+  OLA_ASSERT_EQ(buffer, m_frames[UNIVERSE]);
+  OLA_ASSERT_EQ(2u, m_mirror->LinkCount());
+}
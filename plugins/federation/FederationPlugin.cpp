@@ -0,0 +1,130 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationPlugin.cpp
+ * The Federation Plugin.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/federation/FederationPlugin.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/network/SocketAddress.h"
+#include "olad/PluginAdaptor.h"
+#include "olad/Preferences.h"
+#include "plugins/federation/FederationDevice.h"
+#include "plugins/federation/FederationPluginDescription.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+using ola::network::IPV4SocketAddress;
+using std::string;
+using std::vector;
+
+const char FederationPlugin::INPUT_PORTS_KEY[] = "input_ports";
+const char FederationPlugin::LISTEN_KEY[] = "listen";
+const char FederationPlugin::OUTPUT_PORTS_KEY[] = "output_ports";
+const char FederationPlugin::PEER_KEY[] = "peer";
+const char FederationPlugin::PLUGIN_NAME[] = "Federation";
+const char FederationPlugin::PLUGIN_PREFIX[] = "federation";
+
+bool FederationPlugin::StartHook() {
+  IPV4SocketAddress listen_addr;
+  if (!IPV4SocketAddress::FromString(m_preferences->GetValue(LISTEN_KEY),
+                                     &listen_addr)) {
+    OLA_WARN << "Invalid federation listen address: "
+             << m_preferences->GetValue(LISTEN_KEY);
+    return false;
+  }
+
+  vector<IPV4SocketAddress> peers;
+  vector<string> peer_strings = m_preferences->GetMultipleValue(PEER_KEY);
+  vector<string>::const_iterator iter = peer_strings.begin();
+  for (; iter != peer_strings.end(); ++iter) {
+    IPV4SocketAddress peer;
+    if (!IPV4SocketAddress::FromString(*iter, &peer)) {
+      OLA_WARN << "Invalid federation peer: " << *iter;
+      continue;
+    }
+    peers.push_back(peer);
+  }
+
+  unsigned int input_ports = StringToIntOrDefault(
+      m_preferences->GetValue(INPUT_PORTS_KEY), DEFAULT_PORT_COUNT);
+  unsigned int output_ports = StringToIntOrDefault(
+      m_preferences->GetValue(OUTPUT_PORTS_KEY), DEFAULT_PORT_COUNT);
+
+  m_device = new FederationDevice(this, m_plugin_adaptor, listen_addr, peers,
+                                  input_ports, output_ports);
+  if (!m_device->Start()) {
+    delete m_device;
+    m_device = NULL;
+    return false;
+  }
+  m_plugin_adaptor->RegisterDevice(m_device);
+  return true;
+}
+
+bool FederationPlugin::StopHook() {
+  if (m_device) {
+    m_plugin_adaptor->UnregisterDevice(m_device);
+    bool ret = m_device->Stop();
+    delete m_device;
+    m_device = NULL;
+    return ret;
+  }
+  return true;
+}
+
+string FederationPlugin::Description() const {
+  return plugin_description;
+}
+
+bool FederationPlugin::SetDefaultPreferences() {
+  if (!m_preferences) {
+    return false;
+  }
+
+  std::ostringstream listen;
+  listen << "0.0.0.0:" << DEFAULT_PORT;
+
+  bool save = false;
+  save |= m_preferences->SetDefaultValue(LISTEN_KEY, StringValidator(),
+                                         listen.str());
+  save |= m_preferences->SetDefaultValue(INPUT_PORTS_KEY,
+                                         UIntValidator(0, MAX_PORT_COUNT),
+                                         DEFAULT_PORT_COUNT);
+  save |= m_preferences->SetDefaultValue(OUTPUT_PORTS_KEY,
+                                         UIntValidator(0, MAX_PORT_COUNT),
+                                         DEFAULT_PORT_COUNT);
+  if (save) {
+    m_preferences->Save();
+  }
+
+  if (m_preferences->GetValue(LISTEN_KEY).empty()) {
+    return false;
+  }
+  return true;
+}
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationPlugin.h
+ * The Federation Plugin.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_FEDERATION_FEDERATIONPLUGIN_H_
+#define PLUGINS_FEDERATION_FEDERATIONPLUGIN_H_
+
+#include <stdint.h>
+#include <string>
+#include "ola/plugin_id.h"
+#include "olad/Plugin.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+class FederationDevice;
+
+class FederationPlugin: public Plugin {
+ public:
+  explicit FederationPlugin(PluginAdaptor *plugin_adaptor)
+      : Plugin(plugin_adaptor),
+        m_device(NULL) {}
+
+  std::string Name() const { return PLUGIN_NAME; }
+  ola_plugin_id Id() const { return OLA_PLUGIN_FEDERATION; }
+  std::string Description() const;
+  std::string PluginPrefix() const { return PLUGIN_PREFIX; }
+  // This plugin is disabled unless explicitly enabled by a user.
+  bool DefaultMode() const { return false; }
+
+ private:
+  FederationDevice *m_device;
+
+  bool StartHook();
+  bool StopHook();
+  bool SetDefaultPreferences();
+
+  static const uint16_t DEFAULT_PORT = 9030;
+  static const unsigned int DEFAULT_PORT_COUNT = 4;
+  static const unsigned int MAX_PORT_COUNT = 512;
+
+  static const char INPUT_PORTS_KEY[];
+  static const char LISTEN_KEY[];
+  static const char OUTPUT_PORTS_KEY[];
+  static const char PEER_KEY[];
+  static const char PLUGIN_NAME[];
+  static const char PLUGIN_PREFIX[];
+};
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_FEDERATION_FEDERATIONPLUGIN_H_
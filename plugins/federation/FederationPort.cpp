@@ -0,0 +1,126 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationPort.cpp
+ * Ports for the Federation plugin.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/federation/FederationPort.h"
+
+#include <sstream>
+#include <string>
+#include "ola/Constants.h"
+#include "olad/Universe.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+using std::string;
+
+FederationInputPort::FederationInputPort(FederationDevice *parent,
+                                         unsigned int id,
+                                         class PluginAdaptor *plugin_adaptor,
+                                         FederationNode *node)
+    : BasicInputPort(parent, id, plugin_adaptor),
+      m_node(node),
+      m_priority(ola::dmx::SOURCE_PRIORITY_DEFAULT) {
+  SetPriorityMode(PRIORITY_MODE_INHERIT);
+}
+
+FederationInputPort::~FederationInputPort() {
+  Universe *universe = GetUniverse();
+  if (universe) {
+    m_node->SetHandler(universe->UniverseId(), NULL);
+  }
+}
+
+void FederationInputPort::PostSetUniverse(Universe *old_universe,
+                                          Universe *new_universe) {
+  if (old_universe) {
+    m_node->SetHandler(old_universe->UniverseId(), NULL);
+  }
+  m_buffer.Reset();
+  if (new_universe) {
+    m_node->SetHandler(
+        new_universe->UniverseId(),
+        NewCallback(this, &FederationInputPort::NewFrame));
+  }
+}
+
+string FederationInputPort::Description() const {
+  Universe *universe = GetUniverse();
+  if (!universe) {
+    return "";
+  }
+  std::ostringstream str;
+  str << "Mirror of universe " << universe->UniverseId();
+  return str.str();
+}
+
+void FederationInputPort::NewFrame(uint8_t priority, const DmxBuffer &frame) {
+  m_buffer = frame;
+  m_priority = priority;
+  DmxChanged();
+}
+
+FederationOutputPort::FederationOutputPort(FederationDevice *parent,
+                                           unsigned int id,
+                                           FederationNode *node)
+    : BasicOutputPort(parent, id),
+      m_node(node) {
+}
+
+FederationOutputPort::~FederationOutputPort() {
+  Universe *universe = GetUniverse();
+  if (universe) {
+    m_node->StopExport(universe->UniverseId());
+  }
+}
+
+void FederationOutputPort::PostSetUniverse(Universe *old_universe,
+                                           Universe *) {
+  if (old_universe) {
+    m_node->StopExport(old_universe->UniverseId());
+  }
+}
+
+bool FederationOutputPort::WriteDMX(const DmxBuffer &buffer,
+                                    uint8_t priority) {
+  Universe *universe = GetUniverse();
+  if (!universe) {
+    return false;
+  }
+
+  if (GetPriorityMode() == PRIORITY_MODE_STATIC) {
+    priority = GetPriority();
+  }
+  m_node->SendFrame(universe->UniverseId(), priority, buffer);
+  return true;
+}
+
+string FederationOutputPort::Description() const {
+  Universe *universe = GetUniverse();
+  if (!universe) {
+    return "";
+  }
+  std::ostringstream str;
+  str << "Exporting universe " << universe->UniverseId();
+  return str.str();
+}
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationPort.h
+ * Ports for the Federation plugin.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_FEDERATION_FEDERATIONPORT_H_
+#define PLUGINS_FEDERATION_FEDERATIONPORT_H_
+
+#include <string>
+#include "ola/DmxBuffer.h"
+#include "olad/Port.h"
+#include "plugins/federation/FederationDevice.h"
+#include "plugins/federation/FederationNode.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+/**
+ * @brief An InputPort for the Federation plugin.
+ *
+ * The port mirrors the universe it's patched to from the peer that owns it.
+ */
+class FederationInputPort: public BasicInputPort {
+ public:
+  /**
+   * @brief Create a new Federation Input Port.
+   * @param parent the FederationDevice this port belongs to
+   * @param id the port id.
+   * @param plugin_adaptor the PluginAdaptor to use
+   * @param node the FederationNode to use, ownership is not transferred.
+   */
+  FederationInputPort(FederationDevice *parent,
+                      unsigned int id,
+                      class PluginAdaptor *plugin_adaptor,
+                      FederationNode *node);
+  ~FederationInputPort();
+
+  void PostSetUniverse(Universe *old_universe, Universe *new_universe);
+  const DmxBuffer &ReadDMX() const { return m_buffer; }
+  bool SupportsPriorities() const { return true; }
+  uint8_t InheritedPriority() const { return m_priority; }
+  std::string Description() const;
+
+ private:
+  FederationNode* const m_node;
+  DmxBuffer m_buffer;
+  uint8_t m_priority;
+
+  void NewFrame(uint8_t priority, const DmxBuffer &frame);
+
+  DISALLOW_COPY_AND_ASSIGN(FederationInputPort);
+};
+
+/**
+ * @brief An OutputPort for the Federation plugin.
+ *
+ * The port exports the universe it's patched to, which makes this node the
+ * owner of the universe.
+ */
+class FederationOutputPort: public BasicOutputPort {
+ public:
+  /**
+   * @brief Create a new Federation Output Port.
+   * @param parent the FederationDevice this port belongs to
+   * @param id the port id.
+   * @param node the FederationNode to use, ownership is not transferred.
+   */
+  FederationOutputPort(FederationDevice *parent,
+                       unsigned int id,
+                       FederationNode *node);
+  ~FederationOutputPort();
+
+  void PostSetUniverse(Universe *old_universe, Universe *new_universe);
+  bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
+  bool SupportsPriorities() const { return true; }
+  std::string Description() const;
+
+ private:
+  FederationNode* const m_node;
+
+  DISALLOW_COPY_AND_ASSIGN(FederationOutputPort);
+};
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_FEDERATION_FEDERATIONPORT_H_
@@ -0,0 +1,150 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationProtocol.cpp
+ * The messages sent between federated olad instances.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/federation/FederationProtocol.h"
+
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/util/Utils.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+namespace protocol {
+
+using ola::io::BigEndianOutputStreamInterface;
+using ola::utils::JoinUInt8;
+using std::vector;
+
+namespace {
+// The offset and length of each range.
+const unsigned int RANGE_OVERHEAD = 4;
+// Runs of unchanged slots shorter than this are included in a range rather
+// than starting a new one, since they cost no more than the range overhead.
+const unsigned int MERGE_GAP = RANGE_OVERHEAD;
+
+void WriteHeader(BigEndianOutputStreamInterface *stream, MessageType type,
+                 uint32_t universe, uint8_t priority, unsigned int length) {
+  *stream << static_cast<uint8_t>(type);
+  *stream << universe;
+  *stream << priority;
+  *stream << static_cast<uint16_t>(length);
+}
+}  // namespace
+
+bool ParseHeader(const uint8_t *data, Header *header) {
+  header->type = data[0];
+  header->universe = JoinUInt8(data[1], data[2], data[3], data[4]);
+  header->priority = data[5];
+  header->body_length = JoinUInt8(data[6], data[7]);
+  if (header->body_length > MAX_BODY_SIZE) {
+    return false;
+  }
+
+  switch (header->type) {
+    case FULL_FRAME:
+    case DELTA_FRAME:
+      return true;
+    case RELEASE:
+      return header->body_length == 0;
+    default:
+      return false;
+  }
+}
+
+bool WriteFrame(BigEndianOutputStreamInterface *stream,
+                uint32_t universe,
+                uint8_t priority,
+                const DmxBuffer &previous,
+                const DmxBuffer &frame) {
+  const unsigned int size = frame.Size();
+  const uint8_t *new_slots = frame.GetRaw();
+
+  // Deltas are only used if the size hasn't changed.
+  unsigned int delta_size = 0;
+  bool use_delta = size && previous.Size() == size;
+  vector<DmxBuffer::SlotRange> ranges;
+  if (use_delta) {
+    frame.Diff(previous, &ranges, MERGE_GAP);
+  }
+  vector<DmxBuffer::SlotRange>::const_iterator iter = ranges.begin();
+  for (; use_delta && iter != ranges.end(); ++iter) {
+    delta_size += iter->length + RANGE_OVERHEAD;
+    use_delta = delta_size < size;
+  }
+
+  if (!use_delta) {
+    WriteHeader(stream, FULL_FRAME, universe, priority, size);
+    stream->Write(new_slots, size);
+    return false;
+  }
+
+  WriteHeader(stream, DELTA_FRAME, universe, priority, delta_size);
+  for (iter = ranges.begin(); iter != ranges.end(); ++iter) {
+    *stream << static_cast<uint16_t>(iter->offset);
+    *stream << static_cast<uint16_t>(iter->length);
+    stream->Write(new_slots + iter->offset, iter->length);
+  }
+  return true;
+}
+
+void WriteRelease(BigEndianOutputStreamInterface *stream, uint32_t universe) {
+  WriteHeader(stream, RELEASE, universe, 0, 0);
+}
+
+bool ApplyFrame(const Header &header, const uint8_t *body, DmxBuffer *frame) {
+  if (header.type == FULL_FRAME) {
+    return frame->Set(body, header.body_length);
+  }
+  if (header.type != DELTA_FRAME) {
+    return false;
+  }
+
+  // Check all the ranges before applying any of them.
+  const unsigned int size = frame->Size();
+  unsigned int offset = 0;
+  while (offset < header.body_length) {
+    if (header.body_length - offset < RANGE_OVERHEAD) {
+      return false;
+    }
+    const unsigned int start = JoinUInt8(body[offset], body[offset + 1]);
+    const unsigned int length = JoinUInt8(body[offset + 2], body[offset + 3]);
+    offset += RANGE_OVERHEAD;
+    if (length > header.body_length - offset || start + length > size) {
+      return false;
+    }
+    offset += length;
+  }
+
+  offset = 0;
+  while (offset < header.body_length) {
+    const unsigned int start = JoinUInt8(body[offset], body[offset + 1]);
+    const unsigned int length = JoinUInt8(body[offset + 2], body[offset + 3]);
+    offset += RANGE_OVERHEAD;
+    frame->SetRange(start, body + offset, length);
+    offset += length;
+  }
+  return true;
+}
+}  // namespace protocol
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationProtocol.h
+ * The messages sent between federated olad instances.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_FEDERATION_FEDERATIONPROTOCOL_H_
+#define PLUGINS_FEDERATION_FEDERATIONPROTOCOL_H_
+
+#include <stdint.h>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/io/BigEndianStream.h"
+
+namespace ola {
+namespace plugin {
+namespace federation {
+
+/**
+ * @brief The messages sent over a federation link.
+ *
+ * Each message has an 8 byte header, all fields are big endian:
+ *  - uint8 type
+ *  - uint32 universe
+ *  - uint8 priority
+ *  - uint16 body length
+ *
+ * A FULL_FRAME body is the slot data. A DELTA_FRAME body is a list of
+ * changed ranges, each a uint16 offset, a uint16 length and then the slot
+ * data, to apply to the previous frame sent for the universe on the link. A
+ * RELEASE message has no body, and means the sender no longer owns the
+ * universe.
+ */
+namespace protocol {
+
+enum MessageType {
+  FULL_FRAME = 1,
+  DELTA_FRAME = 2,
+  RELEASE = 3,
+};
+
+const unsigned int HEADER_SIZE = 8;
+const unsigned int MAX_BODY_SIZE = DMX_UNIVERSE_SIZE;
+const unsigned int MAX_MESSAGE_SIZE = HEADER_SIZE + MAX_BODY_SIZE;
+
+/**
+ * @brief A message header.
+ */
+struct Header {
+  uint8_t type;
+  uint32_t universe;
+  uint8_t priority;
+  uint16_t body_length;
+};
+
+/**
+ * @brief Parse a message header.
+ * @param data the data, at least HEADER_SIZE bytes long.
+ * @param[out] header the header to populate.
+ * @returns false if the header is invalid.
+ */
+bool ParseHeader(const uint8_t *data, Header *header);
+
+/**
+ * @brief Write a frame, delta encoding it if that's smaller.
+ * @param stream the stream to write to.
+ * @param universe the universe id.
+ * @param priority the priority of the frame.
+ * @param previous the previous frame written for this universe on this
+ *   stream, may be empty.
+ * @param frame the frame to write.
+ * @returns true if the frame was delta encoded, false if the full frame was
+ *   written.
+ *
+ * Changed slots separated by only a few unchanged slots are sent as a single
+ * range, since each range has a few bytes of overhead.
+ */
+bool WriteFrame(ola::io::BigEndianOutputStreamInterface *stream,
+                uint32_t universe,
+                uint8_t priority,
+                const DmxBuffer &previous,
+                const DmxBuffer &frame);
+
+/**
+ * @brief Write a RELEASE message.
+ */
+void WriteRelease(ola::io::BigEndianOutputStreamInterface *stream,
+                  uint32_t universe);
+
+/**
+ * @brief Apply the body of a frame message.
+ * @param header the message header.
+ * @param body the message body, header.body_length bytes long.
+ * @param[in,out] frame the previous frame for the universe, this is updated
+ *   in place.
+ * @returns false if the body was invalid, in which case frame is unchanged.
+ */
+bool ApplyFrame(const Header &header, const uint8_t *body, DmxBuffer *frame);
+}  // namespace protocol
+}  // namespace federation
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_FEDERATION_FEDERATIONPROTOCOL_H_
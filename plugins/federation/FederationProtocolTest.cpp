@@ -0,0 +1,205 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * FederationProtocolTest.cpp
+ * Test fixture for the federation messages.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/io/BigEndianStream.h"
+#include "ola/io/IOQueue.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/federation/FederationProtocol.h"
+
+using ola::DmxBuffer;
+using ola::io::BigEndianOutputStream;
+using ola::io::IOQueue;
+using ola::plugin::federation::protocol::ApplyFrame;
+using ola::plugin::federation::protocol::Header;
+using ola::plugin::federation::protocol::ParseHeader;
+using ola::plugin::federation::protocol::WriteFrame;
+using ola::plugin::federation::protocol::WriteRelease;
+
+namespace protocol = ola::plugin::federation::protocol;
+
+class FederationProtocolTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FederationProtocolTest);
+  CPPUNIT_TEST(testFullFrame);
+  CPPUNIT_TEST(testDeltaFrame);
+  CPPUNIT_TEST(testRelease);
+  CPPUNIT_TEST(testInvalidMessages);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_DEBUG, ola::OLA_LOG_STDERR);
+  }
+
+  void testFullFrame();
+  void testDeltaFrame();
+  void testRelease();
+  void testInvalidMessages();
+
+ private:
+  IOQueue m_queue;
+  uint8_t m_message[protocol::MAX_MESSAGE_SIZE];
+
+  unsigned int ReadMessage(Header *header);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FederationProtocolTest);
+
+/*
+ * Read the next message from the queue.
+ */
+unsigned int FederationProtocolTest::ReadMessage(Header *header) {
+  unsigned int size = m_queue.Peek(m_message, protocol::HEADER_SIZE);
+  OLA_ASSERT_EQ(protocol::HEADER_SIZE, size);
+  OLA_ASSERT_TRUE(ParseHeader(m_message, header));
+  size = m_queue.Read(m_message, protocol::HEADER_SIZE + header->body_length);
+  OLA_ASSERT_EQ(protocol::HEADER_SIZE + header->body_length, size);
+  return size;
+}
+
+/*
+ * Check the first frame, and frames that change size, are sent in full.
+ */
+void FederationProtocolTest::testFullFrame() {
+  BigEndianOutputStream stream(&m_queue);
+  DmxBuffer previous;
+  DmxBuffer frame;
+  frame.SetFromString("1,2,3,4");
+  OLA_ASSERT_FALSE(WriteFrame(&stream, 70000, 150, previous, frame));
+
+  const uint8_t expected[] = {
+    1, 0, 1, 0x11, 0x70, 150, 0, 4,
+    1, 2, 3, 4,
+  };
+  Header header;
+  unsigned int size = ReadMessage(&header);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), m_message, size);
+  OLA_ASSERT_EQ(static_cast<uint32_t>(70000), header.universe);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), header.priority);
+
+  DmxBuffer received;
+  OLA_ASSERT_TRUE(ApplyFrame(header, m_message + protocol::HEADER_SIZE,
+                             &received));
+  OLA_ASSERT_EQ(frame, received);
+
+  // A larger frame is sent in full.
+  previous = frame;
+  frame.SetFromString("1,2,3,4,5");
+  OLA_ASSERT_FALSE(WriteFrame(&stream, 70000, 150, previous, frame));
+  ReadMessage(&header);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(protocol::FULL_FRAME), header.type);
+  OLA_ASSERT_TRUE(ApplyFrame(header, m_message + protocol::HEADER_SIZE,
+                             &received));
+  OLA_ASSERT_EQ(frame, received);
+
+  // As is a frame where most slots changed.
+  previous = frame;
+  frame.SetFromString("2,3,4,5,6");
+  OLA_ASSERT_FALSE(WriteFrame(&stream, 70000, 150, previous, frame));
+  ReadMessage(&header);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(protocol::FULL_FRAME), header.type);
+}
+
+/*
+ * Check a frame with a few changes is delta encoded.
+ */
+void FederationProtocolTest::testDeltaFrame() {
+  BigEndianOutputStream stream(&m_queue);
+  DmxBuffer previous;
+  previous.Blackout();
+  DmxBuffer frame(previous);
+  frame.SetChannel(10, 255);
+  frame.SetChannel(12, 128);
+  frame.SetChannel(500, 1);
+  OLA_ASSERT_TRUE(WriteFrame(&stream, 1, 100, previous, frame));
+
+  // The first two changes are close enough to be a single range.
+  const uint8_t expected[] = {
+    2, 0, 0, 0, 1, 100, 0, 12,
+    0, 10, 0, 3, 255, 0, 128,
+    1, 0xf4, 0, 1, 1,
+  };
+  Header header;
+  unsigned int size = ReadMessage(&header);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), m_message, size);
+
+  DmxBuffer received(previous);
+  OLA_ASSERT_TRUE(ApplyFrame(header, m_message + protocol::HEADER_SIZE,
+                             &received));
+  OLA_ASSERT_EQ(frame, received);
+
+  // An unchanged frame is an empty delta.
+  OLA_ASSERT_TRUE(WriteFrame(&stream, 1, 100, frame, frame));
+  ReadMessage(&header);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(protocol::DELTA_FRAME), header.type);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0), header.body_length);
+  OLA_ASSERT_TRUE(ApplyFrame(header, m_message + protocol::HEADER_SIZE,
+                             &received));
+  OLA_ASSERT_EQ(frame, received);
+}
+
+void FederationProtocolTest::testRelease() {
+  BigEndianOutputStream stream(&m_queue);
+  WriteRelease(&stream, 2);
+
+  const uint8_t expected[] = {3, 0, 0, 0, 2, 0, 0, 0};
+  Header header;
+  unsigned int size = ReadMessage(&header);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), m_message, size);
+  OLA_ASSERT_EQ(static_cast<uint32_t>(2), header.universe);
+}
+
+void FederationProtocolTest::testInvalidMessages() {
+  Header header;
+  // Unknown type
+  const uint8_t unknown[] = {4, 0, 0, 0, 1, 0, 0, 0};
+  OLA_ASSERT_FALSE(ParseHeader(unknown, &header));
+
+  // Too large
+  const uint8_t too_large[] = {1, 0, 0, 0, 1, 0, 2, 1};
+  OLA_ASSERT_FALSE(ParseHeader(too_large, &header));
+
+  // A release with a body
+  const uint8_t release[] = {3, 0, 0, 0, 1, 0, 0, 1};
+  OLA_ASSERT_FALSE(ParseHeader(release, &header));
+
+  // A delta that runs past the end of the frame leaves the frame unchanged.
+  DmxBuffer frame;
+  frame.SetFromString("1,2,3,4");
+  const DmxBuffer original(frame);
+  const uint8_t delta[] = {
+    0, 0, 0, 1, 9,
+    0, 3, 0, 2, 9, 9,
+  };
+  header.type = protocol::DELTA_FRAME;
+  header.universe = 1;
+  header.priority = 100;
+  header.body_length = sizeof(delta);
+  OLA_ASSERT_FALSE(ApplyFrame(header, delta, &frame));
+  OLA_ASSERT_EQ(original, frame);
+
+  // A truncated range.
+  header.body_length = 7;
+  OLA_ASSERT_FALSE(ApplyFrame(header, delta, &frame));
+  OLA_ASSERT_EQ(original, frame);
+}
@@ -0,0 +1,60 @@
+# LIBRARIES
+##################################################
+if USE_FEDERATION
+
+# This is a library which isn't coupled to olad
+noinst_LTLIBRARIES += plugins/federation/libolafederationcore.la
+plugins_federation_libolafederationcore_la_SOURCES = \
+    plugins/federation/FederationLink.cpp \
+    plugins/federation/FederationLink.h \
+    plugins/federation/FederationNode.cpp \
+    plugins/federation/FederationNode.h \
+    plugins/federation/FederationProtocol.cpp \
+    plugins/federation/FederationProtocol.h
+plugins_federation_libolafederationcore_la_LIBADD = \
+    common/libolacommon.la
+
+lib_LTLIBRARIES += plugins/federation/libolafederation.la
+
+# Plugin description is generated from README.md
+built_sources += plugins/federation/FederationPluginDescription.h
+nodist_plugins_federation_libolafederation_la_SOURCES = \
+    plugins/federation/FederationPluginDescription.h
+plugins/federation/FederationPluginDescription.h: plugins/federation/README.md plugins/federation/Makefile.mk plugins/convert_README_to_header.sh
+	sh $(top_srcdir)/plugins/convert_README_to_header.sh $(top_srcdir)/plugins/federation $(top_builddir)/plugins/federation/FederationPluginDescription.h
+
+plugins_federation_libolafederation_la_SOURCES = \
+    plugins/federation/FederationDevice.cpp \
+    plugins/federation/FederationDevice.h \
+    plugins/federation/FederationPlugin.cpp \
+    plugins/federation/FederationPlugin.h \
+    plugins/federation/FederationPort.cpp \
+    plugins/federation/FederationPort.h
+
+plugins_federation_libolafederation_la_LIBADD = \
+    common/libolacommon.la \
+    olad/plugin_api/libolaserverplugininterface.la \
+    plugins/federation/libolafederationcore.la
+
+# TESTS
+##################################################
+test_programs += \
+    plugins/federation/FederationNodeTester \
+    plugins/federation/FederationProtocolTester
+
+plugins_federation_FederationNodeTester_SOURCES = \
+    plugins/federation/FederationNodeTest.cpp
+plugins_federation_FederationNodeTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+plugins_federation_FederationNodeTester_LDADD = \
+    $(COMMON_TESTING_LIBS) \
+    plugins/federation/libolafederationcore.la
+
+plugins_federation_FederationProtocolTester_SOURCES = \
+    plugins/federation/FederationProtocolTest.cpp
+plugins_federation_FederationProtocolTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+plugins_federation_FederationProtocolTester_LDADD = \
+    $(COMMON_TESTING_LIBS) \
+    plugins/federation/libolafederationcore.la
+endif
+
+EXTRA_DIST += plugins/federation/README.md
@@ -29,8 +29,10 @@
 #include <string>
 #include <memory>
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "olad/Device.h"
 #include "olad/Preferences.h"
+#include "plugins/ftdidmx/FtdiDmxThread.h"
 #include "plugins/ftdidmx/FtdiWidget.h"
 
 namespace ola {
@@ -41,7 +43,8 @@ class FtdiDmxDevice : public Device {
  public:
   FtdiDmxDevice(AbstractPlugin *owner,
                 const FtdiWidgetInfo &widget_info,
-                unsigned int frequency);
+                const FtdiDmxThread::Options &options,
+                ExportMap *export_map);
   ~FtdiDmxDevice();
 
   std::string DeviceId() const { return m_widget->Serial(); }
@@ -54,7 +57,8 @@ class FtdiDmxDevice : public Device {
  private:
   FtdiWidget *m_widget;
   const FtdiWidgetInfo m_widget_info;
-  unsigned int m_frequency;
+  const FtdiDmxThread::Options m_options;
+  ExportMap *m_export_map;
 };
 }  // namespace ftdidmx
 }  // namespace plugin
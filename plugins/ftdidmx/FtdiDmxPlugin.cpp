@@ -29,6 +29,7 @@
 #include "ola/StringUtils.h"
 #include "olad/Preferences.h"
 #include "olad/PluginAdaptor.h"
+#include "olad/ThreadPreferences.h"
 #include "plugins/ftdidmx/FtdiDmxPlugin.h"
 #include "plugins/ftdidmx/FtdiDmxPluginDescription.h"
 #include "plugins/ftdidmx/FtdiDmxDevice.h"
@@ -42,6 +43,8 @@ using std::string;
 using std::vector;
 
 const char FtdiDmxPlugin::K_FREQUENCY[] = "frequency";
+const char FtdiDmxPlugin::K_SPIN_TIME[] = "spin-time";
+const char FtdiDmxPlugin::K_BAUD_RATE_BREAK[] = "baud-rate-break";
 const char FtdiDmxPlugin::PLUGIN_NAME[] = "FTDI USB DMX";
 const char FtdiDmxPlugin::PLUGIN_PREFIX[] = "ftdidmx";
 
@@ -62,20 +65,39 @@ void FtdiDmxPlugin::AddDevice(FtdiDmxDevice *device) {
 
 
 /**
- * @brief Fetch a list of all FTDI widgets and create a new device for each of them.
+ * @brief Fetch a list of all FTDI widgets.
+ *
+ * This may be run off the main thread.
+ */
+bool FtdiDmxPlugin::PrepareStart() {
+  m_widgets.clear();
+  FtdiWidget::Widgets(&m_widgets);
+  return true;
+}
+
+
+/**
+ * @brief Create a new device for each of the FTDI widgets found by
+ * PrepareStart().
  */
 bool FtdiDmxPlugin::StartHook() {
   typedef vector<FtdiWidgetInfo> FtdiWidgetInfoVector;
   FtdiWidgetInfoVector widgets;
-  FtdiWidget::Widgets(&widgets);
+  widgets.swap(m_widgets);
 
-  unsigned int frequency = StringToIntOrDefault(
+  FtdiDmxThread::Options options;
+  options.frequency = StringToIntOrDefault(
       m_preferences->GetValue(K_FREQUENCY),
       DEFAULT_FREQUENCY);
+  options.spin_time = StringToIntOrDefault(
+      m_preferences->GetValue(K_SPIN_TIME), 0u);
+  options.baud_rate_break = m_preferences->GetValueAsBool(K_BAUD_RATE_BREAK);
+  options.scheduling = ThreadPreferences::Load(m_preferences);
 
   FtdiWidgetInfoVector::const_iterator iter;
   for (iter = widgets.begin(); iter != widgets.end(); ++iter) {
-    AddDevice(new FtdiDmxDevice(this, *iter, frequency));
+    AddDevice(new FtdiDmxDevice(this, *iter, options,
+                                m_plugin_adaptor->GetExportMap()));
   }
   return true;
 }
@@ -112,9 +134,16 @@ bool FtdiDmxPlugin::SetDefaultPreferences() {
     return false;
   }
 
-  if (m_preferences->SetDefaultValue(FtdiDmxPlugin::K_FREQUENCY,
-                                     UIntValidator(1, 44),
-                                     DEFAULT_FREQUENCY)) {
+  bool save = false;
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_FREQUENCY,
+                                         UIntValidator(1, 44),
+                                         DEFAULT_FREQUENCY);
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_SPIN_TIME,
+                                         UIntValidator(0, 10000), 0);
+  save |= m_preferences->SetDefaultValue(FtdiDmxPlugin::K_BAUD_RATE_BREAK,
+                                         BoolValidator(), false);
+  save |= ThreadPreferences::SetDefaults(m_preferences);
+  if (save) {
     m_preferences->Save();
   }
 
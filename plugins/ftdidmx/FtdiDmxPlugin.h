@@ -54,9 +54,14 @@ class FtdiDmxPlugin : public Plugin {
 
   std::string Description() const;
 
+  // Probing the USB bus is slow, so do it off the main thread.
+  bool CanPrepareOffMainThread() const { return true; }
+  bool PrepareStart();
+
  private:
   typedef std::vector<FtdiDmxDevice*> FtdiDeviceVector;
   FtdiDeviceVector m_devices;
+  std::vector<FtdiWidgetInfo> m_widgets;
 
   void AddDevice(FtdiDmxDevice *device);
   bool StartHook();
@@ -66,6 +71,8 @@ class FtdiDmxPlugin : public Plugin {
   static const uint8_t DEFAULT_FREQUENCY = 30;
 
   static const char K_FREQUENCY[];
+  static const char K_SPIN_TIME[];
+  static const char K_BAUD_RATE_BREAK[];
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
 };
@@ -29,6 +29,8 @@
 #include <string>
 
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/StringUtils.h"
 #include "olad/Port.h"
 #include "olad/Preferences.h"
 #include "plugins/ftdidmx/FtdiDmxDevice.h"
@@ -44,10 +46,12 @@ class FtdiDmxOutputPort : public ola::BasicOutputPort {
     FtdiDmxOutputPort(FtdiDmxDevice *parent,
                       FtdiInterface *interface,
                       unsigned int id,
-                      unsigned int freq)
+                      const FtdiDmxThread::Options &options,
+                      ExportMap *export_map)
         : BasicOutputPort(parent, id),
           m_interface(interface),
-          m_thread(interface, freq) {
+          m_thread(interface, options, export_map,
+                   parent->DeviceId() + ":" + IntToString(id)) {
       m_thread.Start();
     }
     ~FtdiDmxOutputPort() {
@@ -31,6 +31,7 @@
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/Utils.h"
 #include "plugins/ftdidmx/FtdiWidget.h"
 #include "plugins/ftdidmx/FtdiDmxThread.h"
 
@@ -38,11 +39,36 @@ namespace ola {
 namespace plugin {
 namespace ftdidmx {
 
-FtdiDmxThread::FtdiDmxThread(FtdiInterface *interface, unsigned int frequency)
+using ola::thread::FramePacer;
+using std::string;
+
+const char FtdiDmxThread::FRAME_RATE_VAR[] = "ftdidmx-frame-rate";
+const char FtdiDmxThread::JITTER_VAR[] = "ftdidmx-frame-jitter-us";
+const char FtdiDmxThread::MAX_JITTER_VAR[] = "ftdidmx-frame-max-jitter-us";
+const char FtdiDmxThread::OVERRUN_VAR[] = "ftdidmx-frame-overruns";
+const char FtdiDmxThread::INTERFACE_KEY[] = "interface";
+
+FtdiDmxThread::FtdiDmxThread(FtdiInterface *interface, const Options &options,
+                             ExportMap *export_map, const string &export_key)
   : m_granularity(UNKNOWN),
     m_interface(interface),
     m_term(false),
-    m_frequency(frequency) {
+    m_options(options),
+    m_pacer(options.spin_time),
+    m_export_key(export_key),
+    m_frame_rate_map(NULL),
+    m_jitter_map(NULL),
+    m_max_jitter_map(NULL),
+    m_overrun_map(NULL) {
+  if (export_map) {
+    m_frame_rate_map = export_map->GetUIntMapVar(FRAME_RATE_VAR,
+                                                 INTERFACE_KEY);
+    m_jitter_map = export_map->GetUIntMapVar(JITTER_VAR, INTERFACE_KEY);
+    m_max_jitter_map = export_map->GetUIntMapVar(MAX_JITTER_VAR,
+                                                 INTERFACE_KEY);
+    m_overrun_map = export_map->GetUIntMapVar(OVERRUN_VAR, INTERFACE_KEY);
+    UpdateExportedStats();
+  }
 }
 
 FtdiDmxThread::~FtdiDmxThread() {
@@ -64,13 +90,17 @@ bool FtdiDmxThread::Stop() {
 
 /**
  * @brief Copy a DMXBuffer to the output thread
+ *
+ * This runs in the main thread, so it also updates the exported frame
+ * statistics. It never blocks, a frame the thread hasn't sent yet is
+ * replaced.
  */
 bool FtdiDmxThread::WriteDMX(const DmxBuffer &buffer) {
-  {
-    ola::thread::MutexLocker locker(&m_buffer_mutex);
-    m_buffer.Set(buffer);
-    return true;
-  }
+  // Set() copies the data, rather than sharing it with the caller.
+  m_frames.WriteBuffer()->Set(buffer);
+  m_frames.Publish();
+  UpdateExportedStats();
+  return true;
 }
 
 
@@ -78,13 +108,14 @@ bool FtdiDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * @brief The method called by the thread
  */
 void *FtdiDmxThread::Run() {
-  TimeStamp ts1, ts2, ts3;
+  TimeStamp ts1, ts2;
   Clock clock;
+  ola::thread::ApplySchedulingOptions(m_options.scheduling,
+                                      "FTDI thread for " + m_export_key);
   CheckTimeGranularity();
-  DmxBuffer buffer;
 
-  int frameTime = static_cast<int>(floor(
-    (static_cast<double>(1000) / m_frequency) + static_cast<double>(0.5)));
+  const unsigned int frame_time = static_cast<unsigned int>(floor(
+    (static_cast<double>(1000000) / m_options.frequency) + 0.5));
 
   // Setup the interface
   if (!m_interface->IsOpen()) {
@@ -99,27 +130,34 @@ void *FtdiDmxThread::Run() {
       }
     }
 
-    {
-      ola::thread::MutexLocker locker(&m_buffer_mutex);
-      buffer.Set(m_buffer);
-    }
+    // The frame stays valid until the next Update().
+    m_frames.Update();
+    const DmxBuffer &buffer = m_frames.ReadBuffer();
 
-    clock.CurrentTime(&ts1);
+    // Each deadline is measured from the start of the frame, so a late
+    // wakeup doesn't push out the rest of the frame, or the next one.
+    m_pacer.StartFrame(frame_time);
 
-    if (!m_interface->SetBreak(true)) {
-      goto framesleep;
-    }
+    if (m_options.baud_rate_break) {
+      if (!SendBaudRateBreak()) {
+        goto framesleep;
+      }
+    } else {
+      if (!m_interface->SetBreak(true)) {
+        goto framesleep;
+      }
 
-    if (m_granularity == GOOD) {
-      usleep(DMX_BREAK);
-    }
+      if (m_granularity == GOOD) {
+        m_pacer.SleepUntil(DMX_BREAK);
+      }
 
-    if (!m_interface->SetBreak(false)) {
-      goto framesleep;
-    }
+      if (!m_interface->SetBreak(false)) {
+        goto framesleep;
+      }
 
-    if (m_granularity == GOOD) {
-      usleep(DMX_MAB);
+      if (m_granularity == GOOD) {
+        m_pacer.SleepUntil(DMX_BREAK + DMX_MAB);
+      }
     }
 
     if (!m_interface->Write(buffer)) {
@@ -127,32 +165,20 @@ void *FtdiDmxThread::Run() {
     }
 
   framesleep:
-    // Sleep for the remainder of the DMX frame time
-    clock.CurrentTime(&ts2);
-    TimeInterval elapsed = ts2 - ts1;
-
-    if (m_granularity == GOOD) {
-      while (elapsed.InMilliSeconds() < frameTime) {
-        usleep(1000);
-        clock.CurrentTime(&ts2);
-        elapsed = ts2 - ts1;
-      }
-    } else {
+    if (m_granularity == BAD) {
       // See if we can drop out of bad mode.
-      usleep(1000);
-      clock.CurrentTime(&ts3);
-      TimeInterval interval = ts3 - ts2;
+      clock.CurrentTime(&ts1);
+      m_pacer.Sleep(1000);
+      clock.CurrentTime(&ts2);
+      TimeInterval interval = ts2 - ts1;
       if (interval.InMilliSeconds() < BAD_GRANULARITY_LIMIT) {
         m_granularity = GOOD;
         OLA_INFO << "Switching from BAD to GOOD granularity for ftdi thread";
       }
-
-      elapsed = ts3 - ts1;
-      while (elapsed.InMilliSeconds() < frameTime) {
-        clock.CurrentTime(&ts2);
-        elapsed = ts2 - ts1;
-      }
     }
+
+    // Sleep for the remainder of the DMX frame time
+    m_pacer.WaitForFrameEnd();
   }
   return NULL;
 }
@@ -166,7 +192,7 @@ void FtdiDmxThread::CheckTimeGranularity() {
   Clock clock;
 
   clock.CurrentTime(&ts1);
-  usleep(1000);
+  m_pacer.Sleep(1000);
   clock.CurrentTime(&ts2);
 
   TimeInterval interval = ts2 - ts1;
@@ -175,6 +201,78 @@ void FtdiDmxThread::CheckTimeGranularity() {
   OLA_INFO << "Granularity for FTDI thread is "
            << ((m_granularity == GOOD) ? "GOOD" : "BAD");
 }
+
+
+/**
+ * @brief Send the break & MAB by writing a 0x00 byte at a lower baud rate.
+ *
+ * The start bit and data bits form the break and the stop bits the MAB, so
+ * their lengths are set by the UART rather than by how accurately this thread
+ * sleeps. The MAB is then stretched by the time taken to switch back to
+ * 250k.
+ */
+bool FtdiDmxThread::SendBaudRateBreak() {
+  if (!m_interface->SetBaudRate(BREAK_BAUD_RATE)) {
+    return false;
+  }
+
+  if (!m_interface->WriteBreak()) {
+    return false;
+  }
+
+  // The byte has to leave the UART before the baud rate changes back,
+  // otherwise the break is cut short. This doesn't sleep, so it's needed
+  // whatever the timer granularity.
+  WaitForBreakByte();
+  return m_interface->SetBaudRate();
+}
+
+
+/**
+ * @brief Wait until the break byte has left the UART.
+ *
+ * The FIFO is polled until the transmitter is empty. If the status can't be
+ * read, we busy wait for the time the byte takes to send instead.
+ */
+void FtdiDmxThread::WaitForBreakByte() {
+  const FramePacer::Nanoseconds start = FramePacer::Now();
+  const FramePacer::Nanoseconds deadline = start +
+      BREAK_DRAIN_TIMEOUT * FramePacer::NANOSECONDS_IN_MICROSECOND;
+
+  bool empty = false;
+  while (!empty) {
+    if (!m_interface->TransmitterEmpty(&empty)) {
+      const FramePacer::Nanoseconds sent = start +
+          BREAK_BYTE_TIME * FramePacer::NANOSECONDS_IN_MICROSECOND;
+      while (FramePacer::Now() < sent) {}
+      return;
+    }
+    if (!empty && FramePacer::Now() > deadline) {
+      OLA_WARN << "Timeout waiting for the break to be sent on "
+               << m_interface->Description();
+      return;
+    }
+  }
+}
+
+
+/**
+ * @brief Copy the frame statistics to the ExportMap.
+ */
+void FtdiDmxThread::UpdateExportedStats() {
+  if (!m_frame_rate_map) {
+    return;
+  }
+
+  FramePacer::Stats stats;
+  m_pacer.GetStats(&stats);
+  (*m_frame_rate_map)[m_export_key] = static_cast<unsigned int>(
+      stats.frame_rate + 0.5);
+  (*m_jitter_map)[m_export_key] = stats.mean_jitter;
+  (*m_max_jitter_map)[m_export_key] = stats.max_jitter;
+  (*m_overrun_map)[m_export_key] = static_cast<unsigned int>(
+      stats.overruns);
+}
 }  // namespace ftdidmx
 }  // namespace plugin
 }  // namespace ola
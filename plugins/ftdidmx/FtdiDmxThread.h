@@ -26,8 +26,14 @@
 #ifndef PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 #define PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 
+#include <string>
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/thread/FramePacer.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/thread/Utils.h"
+#include "plugins/ftdidmx/FtdiWidget.h"
 
 namespace ola {
 namespace plugin {
@@ -35,7 +41,31 @@ namespace ftdidmx {
 
 class FtdiDmxThread : public ola::thread::Thread {
  public:
-    FtdiDmxThread(FtdiInterface *interface, unsigned int frequency);
+    struct Options {
+      unsigned int frequency;  // frames per second
+      unsigned int spin_time;  // time to busy wait before each deadline, in us
+      // Send the break as a 0x00 byte at a lower baud rate, rather than
+      // toggling the line's break condition.
+      bool baud_rate_break;
+      ola::thread::SchedulingOptions scheduling;
+
+      Options()
+          : frequency(30),
+            spin_time(0),
+            baud_rate_break(false) {
+      }
+    };
+
+    /**
+     * @brief Create a new FtdiDmxThread.
+     * @param interface the interface to send on.
+     * @param options the timing options.
+     * @param export_map the ExportMap to publish the frame statistics to,
+     *   may be NULL.
+     * @param export_key the key to use for the frame statistics.
+     */
+    FtdiDmxThread(FtdiInterface *interface, const Options &options,
+                  ExportMap *export_map, const std::string &export_key);
     ~FtdiDmxThread();
 
     bool Stop();
@@ -48,16 +78,37 @@ class FtdiDmxThread : public ola::thread::Thread {
     TimerGranularity m_granularity;
     FtdiInterface *m_interface;
     bool m_term;
-    unsigned int m_frequency;
-    DmxBuffer m_buffer;
+    const Options m_options;
+    ola::thread::TripleBuffer<DmxBuffer> m_frames;
+    ola::thread::FramePacer m_pacer;
     ola::thread::Mutex m_term_mutex;
-    ola::thread::Mutex m_buffer_mutex;
+
+    const std::string m_export_key;
+    UIntMap *m_frame_rate_map;
+    UIntMap *m_jitter_map;
+    UIntMap *m_max_jitter_map;
+    UIntMap *m_overrun_map;
 
     void CheckTimeGranularity();
+    bool SendBaudRateBreak();
+    void WaitForBreakByte();
+    void UpdateExportedStats();
 
     static const uint32_t DMX_MAB = 16;
     static const uint32_t DMX_BREAK = 110;
+    // At this rate, a 0x00 byte is a 90us break followed by a 20us MAB.
+    static const int BREAK_BAUD_RATE = 100000;
+    // The time it takes the break byte to leave the UART, in us.
+    static const uint32_t BREAK_BYTE_TIME = 110;
+    // The longest we'll wait for the UART to report the break byte was sent,
+    // in us.
+    static const uint32_t BREAK_DRAIN_TIMEOUT = 2000;
     static const uint32_t BAD_GRANULARITY_LIMIT = 3;
+    static const char FRAME_RATE_VAR[];
+    static const char JITTER_VAR[];
+    static const char MAX_JITTER_VAR[];
+    static const char OVERRUN_VAR[];
+    static const char INTERFACE_KEY[];
 };
 }  // namespace ftdidmx
 }  // namespace plugin
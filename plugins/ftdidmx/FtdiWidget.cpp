@@ -335,6 +335,28 @@ bool FtdiInterface::SetBreak(bool on) {
   }
 }
 
+bool FtdiInterface::WriteBreak() {
+  unsigned char break_byte = 0;
+  if (ftdi_write_data(&m_handle, &break_byte, sizeof(break_byte)) < 0) {
+    OLA_WARN << m_parent->Description() << " "
+             << ftdi_get_error_string(&m_handle);
+    return false;
+  } else {
+    return true;
+  }
+}
+
+bool FtdiInterface::TransmitterEmpty(bool *empty) {
+  unsigned short status;  // NOLINT(runtime/int)
+  if (ftdi_poll_modem_status(&m_handle, &status) < 0) {
+    OLA_WARN << m_parent->Description() << " "
+             << ftdi_get_error_string(&m_handle);
+    return false;
+  }
+  *empty = status & TRANSMITTER_EMPTY;
+  return true;
+}
+
 bool FtdiInterface::Write(const ola::DmxBuffer& data) {
   unsigned char buffer[DMX_UNIVERSE_SIZE + 1];
   unsigned int length = DMX_UNIVERSE_SIZE;
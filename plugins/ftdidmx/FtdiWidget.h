@@ -215,6 +215,12 @@ class FtdiInterface {
   /** @brief Toggle communications line BREAK condition on/off */
   bool SetBreak(bool on);
 
+  /** @brief Write a single 0x00 byte, used to emulate a BREAK */
+  bool WriteBreak();
+
+  /** @brief Check if the UART has sent all the data written to it */
+  bool TransmitterEmpty(bool *empty);
+
   /** @brief Write data to a previously-opened line */
   bool Write(const ola::DmxBuffer &data);
 
@@ -228,6 +234,10 @@ class FtdiInterface {
   const FtdiWidget * m_parent;
   struct ftdi_context m_handle;
   const ftdi_interface m_interface;
+
+  // The TEMT bit of the line status, in the status from
+  // ftdi_poll_modem_status().
+  static const uint16_t TRANSMITTER_EMPTY = 0x4000;
 };  // FtdiInterface
 }  // namespace ftdidmx
 }  // namespace plugin
@@ -18,6 +18,10 @@
  * Copyright (C) 2014 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
 #include "plugins/gpio/GPIODriver.h"
 
 #include <errno.h>
@@ -27,6 +31,10 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef HAVE_LINUX_GPIO_H
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#endif  // HAVE_LINUX_GPIO_H
 
 #include <sstream>
 #include <string>
@@ -48,6 +56,7 @@ using std::vector;
 
 GPIODriver::GPIODriver(const Options &options)
     : m_options(options),
+      m_line_handle_fd(-1),
       m_term(false),
       m_dmx_changed(false) {
 }
@@ -116,6 +125,10 @@ void *GPIODriver::Run() {
 }
 
 bool GPIODriver::SetupGPIO() {
+  if (!m_options.gpio_chip.empty()) {
+    return SetupGPIOChip();
+  }
+
   /**
    * This relies on the pins being exported:
    *   echo N > /sys/class/gpio/export
@@ -160,6 +173,49 @@ bool GPIODriver::SetupGPIO() {
   return true;
 }
 
+bool GPIODriver::SetupGPIOChip() {
+#ifdef HAVE_LINUX_GPIO_H
+  if (m_options.gpio_pins.size() > GPIOHANDLES_MAX) {
+    OLA_WARN << "At most " << GPIOHANDLES_MAX << " lines can be used with "
+             << m_options.gpio_chip;
+    return false;
+  }
+
+  int chip_fd;
+  if (!ola::io::Open(m_options.gpio_chip, O_RDWR, &chip_fd)) {
+    return false;
+  }
+
+  struct gpiohandle_request request;
+  memset(&request, 0, sizeof(request));
+  request.flags = GPIOHANDLE_REQUEST_OUTPUT;
+  request.lines = m_options.gpio_pins.size();
+  strncpy(request.consumer_label, "olad", sizeof(request.consumer_label) - 1);
+  for (unsigned int i = 0; i < m_options.gpio_pins.size(); i++) {
+    request.lineoffsets[i] = m_options.gpio_pins[i];
+  }
+
+  int r = ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &request);
+  close(chip_fd);
+  if (r < 0) {
+    OLA_WARN << "Failed to request the lines from " << m_options.gpio_chip
+             << ": " << strerror(errno);
+    return false;
+  }
+
+  m_line_handle_fd = request.fd;
+  for (unsigned int i = 0; i < m_options.gpio_pins.size(); i++) {
+    GPIOPin pin = {-1, UNDEFINED, false};
+    m_gpio_pins.push_back(pin);
+  }
+  return true;
+#else
+  OLA_WARN << "GPIO character devices aren't supported on this platform, "
+           << "can't use " << m_options.gpio_chip;
+  return false;
+#endif  // HAVE_LINUX_GPIO_H
+}
+
 bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
   enum Action {
     TURN_ON,
@@ -167,6 +223,7 @@ bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
     NO_CHANGE,
   };
 
+  bool changed = false;
   for (uint16_t i = 0;
        i < m_gpio_pins.size() && (i + m_options.start_address < dmx.Size());
        i++) {
@@ -187,27 +244,68 @@ bool GPIODriver::UpdateGPIOPins(const DmxBuffer &dmx) {
         action = (slot_value >= m_options.turn_on ? TURN_ON : TURN_OFF);
     }
 
-    // Change the pin state if required.
-    if (action != NO_CHANGE) {
-      char data = (action == TURN_ON ? '1' : '0');
-      if (write(m_gpio_pins[i].fd, &data, sizeof(data)) < 0) {
-        OLA_WARN << "Failed to toggle GPIO pin " << i << ", fd "
-                 << static_cast<int>(m_gpio_pins[i].fd) << ": "
-                 << strerror(errno);
-        return false;
-      }
+    if (action == NO_CHANGE) {
+      continue;
+    }
+
+    if (m_line_handle_fd >= 0) {
+      // The lines are all set together once we know every new state.
       m_gpio_pins[i].state = (action == TURN_ON ? ON : OFF);
+      changed = true;
+      continue;
+    }
+
+    // Change the pin state.
+    char data = (action == TURN_ON ? '1' : '0');
+    if (write(m_gpio_pins[i].fd, &data, sizeof(data)) < 0) {
+      OLA_WARN << "Failed to toggle GPIO pin " << i << ", fd "
+               << static_cast<int>(m_gpio_pins[i].fd) << ": "
+               << strerror(errno);
+      return false;
+    }
+    m_gpio_pins[i].state = (action == TURN_ON ? ON : OFF);
+  }
+
+  if (changed) {
+    return SetLineValues();
+  }
+  return true;
+}
+
+bool GPIODriver::SetLineValues() {
+#ifdef HAVE_LINUX_GPIO_H
+  struct gpiohandle_data data;
+  memset(&data, 0, sizeof(data));
+  for (unsigned int i = 0; i < m_gpio_pins.size(); i++) {
+    data.values[i] = (m_gpio_pins[i].state == ON);
+  }
+
+  if (ioctl(m_line_handle_fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+    OLA_WARN << "Failed to set the GPIO lines on " << m_options.gpio_chip
+             << ": " << strerror(errno);
+    // Make sure the next update sets every line.
+    for (unsigned int i = 0; i < m_gpio_pins.size(); i++) {
+      m_gpio_pins[i].state = UNDEFINED;
     }
+    return false;
   }
+#endif  // HAVE_LINUX_GPIO_H
   return true;
 }
 
 void GPIODriver::CloseGPIOFDs() {
   GPIOPins::iterator iter = m_gpio_pins.begin();
   for (; iter != m_gpio_pins.end(); ++iter) {
-    close(iter->fd);
+    if (iter->fd >= 0) {
+      close(iter->fd);
+    }
   }
   m_gpio_pins.clear();
+
+  if (m_line_handle_fd >= 0) {
+    close(m_line_handle_fd);
+    m_line_handle_fd = -1;
+  }
 }
 }  // namespace gpio
 }  // namespace plugin
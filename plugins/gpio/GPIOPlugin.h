@@ -54,6 +54,7 @@ class GPIOPlugin: public ola::Plugin {
   bool StopHook();
   bool SetDefaultPreferences();
 
+  static const char GPIO_CHIP_KEY[];
   static const char GPIO_PINS_KEY[];
   static const char GPIO_SLOT_OFFSET_KEY[];
   static const char GPIO_TURN_OFF_KEY[];
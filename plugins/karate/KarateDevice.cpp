@@ -37,9 +37,11 @@ using std::string;
 KarateDevice::KarateDevice(AbstractPlugin *owner,
                            const string &name,
                            const string &path,
-                           unsigned int device_id)
+                           unsigned int device_id,
+                           const ola::thread::SchedulingOptions &scheduling)
     : Device(owner, name),
-      m_path(path) {
+      m_path(path),
+      m_scheduling(scheduling) {
   std::ostringstream str;
   str << device_id;
   m_device_id = str.str();
@@ -49,7 +51,7 @@ KarateDevice::KarateDevice(AbstractPlugin *owner,
  * @brief Start this device
  */
 bool KarateDevice::StartHook() {
-  AddPort(new KarateOutputPort(this, 0, m_path));
+  AddPort(new KarateOutputPort(this, 0, m_path, m_scheduling));
   return true;
 }
 }  // namespace karate
@@ -31,6 +31,7 @@
 #include "ola/io/IOUtils.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
 #include "plugins/karate/KarateDevice.h"
 #include "plugins/karate/KaratePlugin.h"
 #include "plugins/karate/KaratePluginDescription.h"
@@ -54,6 +55,8 @@ const char KaratePlugin::DEVICE_KEY[] = "device";
  */
 bool KaratePlugin::StartHook() {
   vector<string> devices = m_preferences->GetMultipleValue(DEVICE_KEY);
+  const ola::thread::SchedulingOptions scheduling =
+      ThreadPreferences::Load(m_preferences);
   vector<string>::const_iterator iter = devices.begin();
 
   // start counting device ids from 0
@@ -68,7 +71,8 @@ bool KaratePlugin::StartHook() {
           this,
           KARATE_DEVICE_NAME,
           *iter,
-          device_id++);
+          device_id++,
+          scheduling);
       if (device->Start()) {
         m_devices.push_back(device);
         m_plugin_adaptor->RegisterDevice(device);
@@ -117,8 +121,10 @@ bool KaratePlugin::SetDefaultPreferences() {
     return false;
   }
 
-  if (m_preferences->SetDefaultValue(DEVICE_KEY, StringValidator(),
-                                     KARATE_DEVICE_PATH)) {
+  bool save = m_preferences->SetDefaultValue(DEVICE_KEY, StringValidator(),
+                                             KARATE_DEVICE_PATH);
+  save |= ThreadPreferences::SetDefaults(m_preferences);
+  if (save) {
     m_preferences->Save();
   }
 
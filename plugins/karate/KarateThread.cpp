@@ -42,16 +42,17 @@ namespace ola {
 namespace plugin {
 namespace karate {
 
-using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using std::string;
 
 /**
  * @brief Create a new KarateThread object
  */
-KarateThread::KarateThread(const string &path)
+KarateThread::KarateThread(const string &path,
+                           const ola::thread::SchedulingOptions &scheduling)
     : ola::thread::Thread(),
       m_path(path),
+      m_scheduling(scheduling),
       m_term(false) {
 }
 
@@ -62,6 +63,8 @@ KarateThread::KarateThread(const string &path)
 void *KarateThread::Run() {
   bool write_success;
   Clock clock;
+  ola::thread::ApplySchedulingOptions(m_scheduling,
+                                      "KarateLight thread for " + m_path);
 
   KarateLight k(m_path);
   k.Init();
@@ -90,10 +93,10 @@ void *KarateThread::Run() {
       k.Init();
 
     } else {
-      {
-        MutexLocker locker(&m_mutex);
-        write_success = k.SetColors(m_buffer);
-      }
+      // The frame stays valid until the next Update(), so the write doesn't
+      // hold up WriteDmx().
+      m_frames.Update();
+      write_success = k.SetColors(m_frames.ReadBuffer());
       if (!write_success) {
         OLA_WARN << "Failed to write color data";
       }  else {
@@ -110,7 +113,7 @@ void *KarateThread::Run() {
  */
 bool KarateThread::Stop() {
   {
-    MutexLocker locker(&m_mutex);
+    MutexLocker locker(&m_term_mutex);
     m_term = true;
   }
   m_term_cond.Signal();
@@ -120,11 +123,13 @@ bool KarateThread::Stop() {
 
 /**
  * @brief Store the data in the shared buffer.
+ *
+ * This never blocks, a frame the thread hasn't sent yet is replaced.
  */
 bool KarateThread::WriteDmx(const DmxBuffer &buffer) {
-  MutexLocker locker(&m_mutex);
   // avoid the reference counting
-  m_buffer.Set(buffer);
+  m_frames.WriteBuffer()->Set(buffer);
+  m_frames.Publish();
   return true;
 }
 }  // namespace karate
@@ -24,6 +24,8 @@
 #include <string>
 #include "ola/DmxBuffer.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/thread/Utils.h"
 
 namespace ola {
 namespace plugin {
@@ -31,7 +33,9 @@ namespace karate {
 
 class KarateThread: public ola::thread::Thread {
  public:
-    explicit KarateThread(const std::string &path);
+    KarateThread(const std::string &path,
+                 const ola::thread::SchedulingOptions &scheduling =
+                     ola::thread::SchedulingOptions());
 
     bool Stop();
     bool WriteDmx(const DmxBuffer &buffer);
@@ -39,9 +43,9 @@ class KarateThread: public ola::thread::Thread {
 
  private:
     std::string m_path;
-    DmxBuffer m_buffer;
+    const ola::thread::SchedulingOptions m_scheduling;
+    ola::thread::TripleBuffer<DmxBuffer> m_frames;
     bool m_term;
-    ola::thread::Mutex m_mutex;
     ola::thread::Mutex m_term_mutex;
     ola::thread::ConditionVariable m_term_cond;
 };
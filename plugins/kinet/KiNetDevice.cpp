@@ -28,6 +28,7 @@
 #include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/NetworkUtils.h"
+#include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
 #include "plugins/kinet/KiNetDevice.h"
@@ -43,15 +44,21 @@ using std::vector;
 
 /*
  * Create a new KiNet Device
+ * @param ports_per_supply the number of ports to create for each power supply
+ *   when using PORTOUT, or 0 to use DMXOUT with a single port per supply.
  */
 KiNetDevice::KiNetDevice(
     AbstractPlugin *owner,
     const vector<ola::network::IPV4Address> &power_supplies,
-    PluginAdaptor *plugin_adaptor)
+    PluginAdaptor *plugin_adaptor,
+    unsigned int ports_per_supply,
+    const UDPSocketMonitor::Options &socket_options)
     : Device(owner, "KiNet Device"),
       m_power_supplies(power_supplies),
       m_node(NULL),
-      m_plugin_adaptor(plugin_adaptor) {
+      m_plugin_adaptor(plugin_adaptor),
+      m_ports_per_supply(ports_per_supply),
+      m_socket_options(socket_options) {
 }
 
 
@@ -68,10 +75,22 @@ bool KiNetDevice::StartHook() {
     return false;
   }
 
+  m_socket_monitor.reset(new UDPSocketMonitor(
+      m_plugin_adaptor, m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+      m_socket_options));
+  m_socket_monitor->AddSocket(m_node->GetSocket());
+
   vector<IPV4Address>::const_iterator iter = m_power_supplies.begin();
   unsigned int port_id = 0;
   for (; iter != m_power_supplies.end(); ++iter) {
-    AddPort(new KiNetOutputPort(this, *iter, m_node, port_id++));
+    if (!m_ports_per_supply) {
+      AddPort(new KiNetOutputPort(this, *iter, m_node, port_id++));
+      continue;
+    }
+    for (unsigned int i = 1; i <= m_ports_per_supply; i++) {
+      AddPort(new KiNetOutputPort(this, *iter, m_node, port_id++,
+                                  static_cast<uint8_t>(i)));
+    }
   }
   return true;
 }
@@ -81,6 +100,8 @@ bool KiNetDevice::StartHook() {
  * Stop this device. This is called before the ports are deleted
  */
 void KiNetDevice::PrePortStop() {
+  m_socket_monitor->RemoveSocket(m_node->GetSocket());
+  m_socket_monitor.reset();
   m_node->Stop();
 }
 
@@ -21,11 +21,13 @@
 #ifndef PLUGINS_KINET_KINETDEVICE_H_
 #define PLUGINS_KINET_KINETDEVICE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "ola/network/IPV4Address.h"
 #include "olad/Device.h"
+#include "olad/UDPSocketMonitor.h"
 
 namespace ola {
 namespace plugin {
@@ -35,7 +37,10 @@ class KiNetDevice: public ola::Device {
  public:
     KiNetDevice(AbstractPlugin *owner,
                 const std::vector<ola::network::IPV4Address> &power_supplies,
-                class PluginAdaptor *plugin_adaptor);
+                class PluginAdaptor *plugin_adaptor,
+                unsigned int ports_per_supply = 0,
+                const UDPSocketMonitor::Options &socket_options =
+                    UDPSocketMonitor::Options());
 
     // Only one KiNet device
     std::string DeviceId() const { return "1"; }
@@ -49,6 +54,10 @@ class KiNetDevice: public ola::Device {
     const std::vector<ola::network::IPV4Address> m_power_supplies;
     class KiNetNode *m_node;
     class PluginAdaptor *m_plugin_adaptor;
+    // 0 to use DMXOUT, otherwise the number of PORTOUT ports per supply.
+    const unsigned int m_ports_per_supply;
+    const UDPSocketMonitor::Options m_socket_options;
+    std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
 };
 }  // namespace kinet
 }  // namespace plugin
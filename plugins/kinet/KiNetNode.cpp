@@ -18,10 +18,12 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <map>
 #include <memory>
 
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/io/SharedMemoryBlockPool.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/SocketAddress.h"
 #include "plugins/kinet/KiNetNode.h"
@@ -44,8 +46,11 @@ KiNetNode::KiNetNode(ola::io::SelectServerInterface *ss,
                      ola::network::UDPSocketInterface *socket)
     : m_running(false),
       m_ss(ss),
+      m_output_queue(ola::io::SharedMemoryBlockPool::PacketPool()),
       m_output_stream(&m_output_queue),
-      m_socket(socket) {
+      m_socket(socket),
+      m_pending_portout_count(0),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
 }
 
 
@@ -78,6 +83,13 @@ bool KiNetNode::Stop() {
   if (!m_running)
     return false;
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+  m_pending_portout.clear();
+  m_pending_portout_count = 0;
+
   m_ss->RemoveReadDescriptor(m_socket.get());
   m_socket.reset();
   m_running = false;
@@ -100,7 +112,7 @@ bool KiNetNode::SendDMX(const IPV4Address &target_ip, const DmxBuffer &buffer) {
   }
 
   m_output_queue.Clear();
-  PopulatePacketHeader(KINET_DMX_MSG);
+  PopulatePacketHeader(KINET_VERSION_ONE, KINET_DMX_MSG);
   m_output_stream << port << flags << timer_val << universe;
   m_output_stream << DMX512_START_CODE;
   m_output_stream.Write(buffer.GetRaw(), buffer.Size());
@@ -118,6 +130,90 @@ bool KiNetNode::SendDMX(const IPV4Address &target_ip, const DmxBuffer &buffer) {
 }
 
 
+bool KiNetNode::SendPortOut(const IPV4Address &target_ip,
+                            uint8_t port,
+                            const DmxBuffer &buffer) {
+  if (!m_running)
+    return false;
+
+  if (port == 0 || port > MAX_PORTOUT_PORT) {
+    OLA_WARN << "Invalid KiNet port " << static_cast<int>(port);
+    return false;
+  }
+
+  if (!buffer.Size()) {
+    OLA_DEBUG << "Not sending 0 length packet";
+    return true;
+  }
+
+  PortDataMap &ports = m_pending_portout[target_ip];
+  PortDataMap::iterator iter = ports.find(port);
+  if (iter == ports.end()) {
+    ports.insert(PortDataMap::value_type(port, buffer));
+    m_pending_portout_count++;
+  } else {
+    iter->second = buffer;
+  }
+
+  if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_flush_timeout = m_ss->RegisterSingleTimeout(
+        0, NewSingleCallback(this, &KiNetNode::FlushPortOut));
+  }
+  return true;
+}
+
+
+/*
+ * Send the queued PORTOUT messages. The messages for each power supply are
+ * grouped together and the whole lot is handed to the socket in one batch.
+ */
+void KiNetNode::FlushPortOut() {
+  static const uint8_t pad = 0;
+  static const uint16_t flags = 0;
+  static const uint32_t universe = 0xffffffff;
+
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!m_pending_portout_count)
+    return;
+
+  m_batch_data.resize(m_pending_portout_count * MAX_PORTOUT_SIZE);
+  m_send_batch.clear();
+  uint8_t *ptr = &m_batch_data[0];
+
+  PendingPortOutMap::iterator target_iter = m_pending_portout.begin();
+  for (; target_iter != m_pending_portout.end(); ++target_iter) {
+    IPV4SocketAddress target(target_iter->first, KINET_PORT);
+    PortDataMap::const_iterator iter = target_iter->second.begin();
+    for (; iter != target_iter->second.end(); ++iter) {
+      const DmxBuffer &buffer = iter->second;
+      m_output_queue.Clear();
+      PopulatePacketHeader(KINET_VERSION_TWO, KINET_PORTOUT_MSG);
+      m_output_stream << universe << iter->first << pad << flags;
+      m_output_stream << static_cast<uint16_t>(buffer.Size());
+      m_output_stream << static_cast<uint16_t>(DMX512_START_CODE);
+      m_output_stream.Write(buffer.GetRaw(), buffer.Size());
+
+      ola::network::UDPDatagram datagram;
+      datagram.data = ptr;
+      datagram.length = m_output_queue.Read(ptr, MAX_PORTOUT_SIZE);
+      datagram.address = target;
+      m_send_batch.push_back(datagram);
+      ptr += MAX_PORTOUT_SIZE;
+    }
+    target_iter->second.clear();
+  }
+  m_output_queue.Clear();
+  m_pending_portout_count = 0;
+
+  unsigned int sent = m_socket->SendBatch(&m_send_batch[0],
+                                          m_send_batch.size());
+  if (sent != m_send_batch.size()) {
+    OLA_WARN << "Only sent " << sent << " of " << m_send_batch.size()
+             << " KiNet PORTOUT packets";
+  }
+}
+
+
 /*
  * Called when there is data on this socket. Right now we discard all packets.
  */
@@ -138,9 +234,9 @@ void KiNetNode::SocketReady() {
 /*
  * Fill in the header for a packet
  */
-void KiNetNode::PopulatePacketHeader(uint16_t msg_type) {
+void KiNetNode::PopulatePacketHeader(uint16_t version, uint16_t msg_type) {
   uint32_t sequence_number = 0;  // everything seems to set this to 0.
-  m_output_stream << KINET_MAGIC_NUMBER << KINET_VERSION_ONE;
+  m_output_stream << KINET_MAGIC_NUMBER << version;
   m_output_stream << msg_type << sequence_number;
 }
 
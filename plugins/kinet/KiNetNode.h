@@ -21,8 +21,11 @@
 #ifndef PLUGINS_KINET_KINETNODE_H_
 #define PLUGINS_KINET_KINETNODE_H_
 
+#include <map>
 #include <memory>
+#include <vector>
 
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/io/BigEndianStream.h"
 #include "ola/io/IOQueue.h"
@@ -43,29 +46,62 @@ class KiNetNode {
     bool Start();
     bool Stop();
 
+    ola::network::UDPSocketInterface *GetSocket() { return m_socket.get(); }
+
     // The following apply to Input Ports (those which send data)
     bool SendDMX(const ola::network::IPV4Address &target,
                  const ola::DmxBuffer &buffer);
 
+    /**
+     * @brief Queue a KiNet v2 PORTOUT message for a port on a power supply.
+     * @param target the IP of the power supply.
+     * @param port the port on the power supply, starting from 1.
+     * @param buffer the DMX data.
+     * @returns true if the data was queued.
+     *
+     * The messages for all the ports are sent together once control returns
+     * to the event loop. If a port is written to more than once before then,
+     * only the latest data is sent.
+     */
+    bool SendPortOut(const ola::network::IPV4Address &target,
+                     uint8_t port,
+                     const ola::DmxBuffer &buffer);
+
+    static const uint8_t MAX_PORTOUT_PORT = 16;
+
  private:
+    // The pending data for each port on a power supply.
+    typedef std::map<uint8_t, ola::DmxBuffer> PortDataMap;
+    typedef std::map<ola::network::IPV4Address, PortDataMap> PendingPortOutMap;
+
     bool m_running;
     ola::io::SelectServerInterface *m_ss;
     ola::io::IOQueue m_output_queue;
     ola::io::BigEndianOutputStream m_output_stream;
     ola::network::Interface m_interface;
     std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+    PendingPortOutMap m_pending_portout;
+    unsigned int m_pending_portout_count;
+    ola::thread::timeout_id m_flush_timeout;
+    std::vector<uint8_t> m_batch_data;
+    std::vector<ola::network::UDPDatagram> m_send_batch;
 
     KiNetNode(const KiNetNode&);
     KiNetNode& operator=(const KiNetNode&);
 
     void SocketReady();
-    void PopulatePacketHeader(uint16_t msg_type);
+    void PopulatePacketHeader(uint16_t version, uint16_t msg_type);
+    void FlushPortOut();
     bool InitNetwork();
 
     static const uint16_t KINET_PORT = 6038;
     static const uint32_t KINET_MAGIC_NUMBER = 0x0401dc4a;
     static const uint16_t KINET_VERSION_ONE = 0x0100;
+    static const uint16_t KINET_VERSION_TWO = 0x0200;
     static const uint16_t KINET_DMX_MSG = 0x0101;
+    static const uint16_t KINET_PORTOUT_MSG = 0x0108;
+    // header + universe + port + pad + flags + length + start code + data
+    static const unsigned int MAX_PORTOUT_SIZE = 24 + DMX_UNIVERSE_SIZE;
 };
 }  // namespace kinet
 }  // namespace plugin
@@ -37,6 +37,7 @@ using ola::testing::MockUDPSocket;
 class KiNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(KiNetNodeTest);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testSendPortOut);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -48,10 +49,12 @@ class KiNetNodeTest: public CppUnit::TestFixture {
     void setUp();
 
     void testSendDMX();
+    void testSendPortOut();
 
  private:
     ola::io::SelectServer ss;
     IPV4Address target_ip;
+    IPV4Address target_ip2;
     MockUDPSocket *m_socket;
 
     static const uint16_t KINET_PORT = 6038;
@@ -63,6 +66,7 @@ CPPUNIT_TEST_SUITE_REGISTRATION(KiNetNodeTest);
 void KiNetNodeTest::setUp() {
   ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
   ola::network::IPV4Address::FromString("10.0.0.10", &target_ip);
+  ola::network::IPV4Address::FromString("10.0.0.11", &target_ip2);
 }
 
 /**
@@ -88,3 +92,59 @@ void KiNetNodeTest::testSendDMX() {
   m_socket->Verify();
   OLA_ASSERT(node.Stop());
 }
+
+
+/**
+ * Check that PORTOUT messages are queued and sent together.
+ */
+void KiNetNodeTest::testSendPortOut() {
+  KiNetNode node(&ss, m_socket);
+  OLA_ASSERT_TRUE(node.Start());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,5,8");
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip2, 1, buffer));
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip, 2, buffer));
+  buffer.SetFromString("255,0");
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip, 1, buffer));
+  // only the latest data for a port is sent
+  buffer.SetFromString("10,14,45,100");
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip, 2, buffer));
+
+  OLA_ASSERT_FALSE(node.SendPortOut(target_ip, 0, buffer));
+  OLA_ASSERT_FALSE(node.SendPortOut(target_ip, 17, buffer));
+
+  // The packets are grouped by power supply, and ordered by port.
+  const uint8_t expected_port1[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x02, 0x00,
+    0x01, 0x08, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff, 1, 0, 0, 0,
+    0, 2, 0, 0, 255, 0
+  };
+  const uint8_t expected_port2[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x02, 0x00,
+    0x01, 0x08, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff, 2, 0, 0, 0,
+    0, 4, 0, 0, 10, 14, 45, 100
+  };
+  const uint8_t expected_supply2[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x02, 0x00,
+    0x01, 0x08, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff, 1, 0, 0, 0,
+    0, 3, 0, 0, 1, 5, 8
+  };
+  m_socket->AddExpectedData(expected_port1, sizeof(expected_port1), target_ip,
+                            KINET_PORT);
+  m_socket->AddExpectedData(expected_port2, sizeof(expected_port2), target_ip,
+                            KINET_PORT);
+  m_socket->AddExpectedData(expected_supply2, sizeof(expected_supply2),
+                            target_ip2, KINET_PORT);
+
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  m_socket->Verify();
+
+  // nothing more is sent until the next update
+  ss.RunOnce(ola::TimeInterval(0, 0));
+  m_socket->Verify();
+  OLA_ASSERT(node.Stop());
+}
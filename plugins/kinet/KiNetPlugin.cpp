@@ -18,14 +18,18 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <set>
 #include <string>
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/network/IPV4Address.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/kinet/KiNetDevice.h"
+#include "plugins/kinet/KiNetNode.h"
 #include "plugins/kinet/KiNetPlugin.h"
 #include "plugins/kinet/KiNetPluginDescription.h"
 
@@ -35,9 +39,14 @@ namespace plugin {
 namespace kinet {
 
 using ola::network::IPV4Address;
+using std::set;
 using std::string;
 using std::vector;
 
+const char KiNetPlugin::MODE_KEY[] = "mode";
+const char KiNetPlugin::MODE_DMXOUT[] = "dmxout";
+const char KiNetPlugin::MODE_PORTOUT[] = "portout";
+const char KiNetPlugin::PORTS_PER_SUPPLY_KEY[] = "ports_per_power_supply";
 const char KiNetPlugin::POWER_SUPPLY_KEY[] = "power_supply";
 const char KiNetPlugin::PLUGIN_NAME[] = "KiNET";
 const char KiNetPlugin::PLUGIN_PREFIX[] = "kinet";
@@ -68,7 +77,16 @@ bool KiNetPlugin::StartHook() {
       OLA_WARN << "Invalid power supply IP address : " << *iter;
     }
   }
-  m_device.reset(new KiNetDevice(this, power_supplies, m_plugin_adaptor));
+
+  unsigned int ports_per_supply = 0;
+  if (m_preferences->GetValue(MODE_KEY) == MODE_PORTOUT) {
+    ports_per_supply = StringToIntOrDefault(
+        m_preferences->GetValue(PORTS_PER_SUPPLY_KEY),
+        DEFAULT_PORTS_PER_SUPPLY);
+  }
+  m_device.reset(new KiNetDevice(
+      this, power_supplies, m_plugin_adaptor, ports_per_supply,
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences)));
 
   if (!m_device->Start()) {
     m_device.reset();
@@ -117,6 +135,18 @@ bool KiNetPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(POWER_SUPPLY_KEY,
                                          StringValidator(true), "");
 
+  set<string> valid_modes;
+  valid_modes.insert(MODE_DMXOUT);
+  valid_modes.insert(MODE_PORTOUT);
+  save |= m_preferences->SetDefaultValue(MODE_KEY,
+                                         SetValidator<string>(valid_modes),
+                                         MODE_DMXOUT);
+  save |= m_preferences->SetDefaultValue(
+      PORTS_PER_SUPPLY_KEY,
+      UIntValidator(1, KiNetNode::MAX_PORTOUT_PORT),
+      DEFAULT_PORTS_PER_SUPPLY);
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
+
   if (save) {
     m_preferences->Save();
   }
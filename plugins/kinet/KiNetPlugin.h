@@ -49,7 +49,12 @@ class KiNetPlugin : public Plugin {
 
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
+    static const char MODE_KEY[];
+    static const char MODE_DMXOUT[];
+    static const char MODE_PORTOUT[];
+    static const char PORTS_PER_SUPPLY_KEY[];
     static const char POWER_SUPPLY_KEY[];
+    static const unsigned int DEFAULT_PORTS_PER_SUPPLY = 1;
 };
 }  // namespace kinet
 }  // namespace plugin
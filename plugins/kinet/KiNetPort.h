@@ -23,6 +23,7 @@
 
 #include <string>
 #include "ola/network/IPV4Address.h"
+#include "ola/strings/Format.h"
 #include "olad/Port.h"
 #include "plugins/kinet/KiNetDevice.h"
 #include "plugins/kinet/KiNetNode.h"
@@ -36,23 +37,35 @@ class KiNetOutputPort: public BasicOutputPort {
   KiNetOutputPort(KiNetDevice *device,
                   const ola::network::IPV4Address &target,
                   KiNetNode *node,
-                  unsigned int port_id)
+                  unsigned int port_id,
+                  uint8_t kinet_port = 0)
       : BasicOutputPort(device, port_id),
         m_node(node),
-        m_target(target) {
+        m_target(target),
+        m_kinet_port(kinet_port) {
   }
 
   bool WriteDMX(const DmxBuffer &buffer, OLA_UNUSED uint8_t priority) {
+    if (m_kinet_port) {
+      return m_node->SendPortOut(m_target, m_kinet_port, buffer);
+    }
     return m_node->SendDMX(m_target, buffer);
   }
 
   std::string Description() const {
-    return "Power Supply: " + m_target.ToString();
+    std::string description = "Power Supply: " + m_target.ToString();
+    if (m_kinet_port) {
+      description += ", Port: " + ola::strings::IntToString(
+          static_cast<unsigned int>(m_kinet_port));
+    }
+    return description;
   }
 
  private:
   KiNetNode *m_node;
   const ola::network::IPV4Address m_target;
+  // The PORTOUT port, or 0 to use DMXOUT.
+  const uint8_t m_kinet_port;
 };
 }  // namespace kinet
 }  // namespace plugin
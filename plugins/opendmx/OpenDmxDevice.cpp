@@ -40,13 +40,16 @@ using std::string;
  * @param owner
  * @param name
  * @param path to device
+ * @param scheduling the scheduling options for the output thread
  */
 OpenDmxDevice::OpenDmxDevice(AbstractPlugin *owner,
                              const string &name,
                              const string &path,
-                             unsigned int device_id)
+                             unsigned int device_id,
+                             const ola::thread::SchedulingOptions &scheduling)
     : Device(owner, name),
-      m_path(path) {
+      m_path(path),
+      m_scheduling(scheduling) {
   std::ostringstream str;
   str << device_id;
   m_device_id = str.str();
@@ -58,7 +61,7 @@ OpenDmxDevice::OpenDmxDevice(AbstractPlugin *owner,
  * Start this device
  */
 bool OpenDmxDevice::StartHook() {
-  AddPort(new OpenDmxOutputPort(this, 0, m_path));
+  AddPort(new OpenDmxOutputPort(this, 0, m_path, m_scheduling));
   return true;
 }
 }  // namespace opendmx
@@ -22,6 +22,7 @@
 #define PLUGINS_OPENDMX_OPENDMXDEVICE_H_
 
 #include <string>
+#include "ola/thread/Utils.h"
 #include "olad/Device.h"
 
 namespace ola {
@@ -33,7 +34,8 @@ class OpenDmxDevice: public ola::Device {
     OpenDmxDevice(ola::AbstractPlugin *owner,
                   const std::string &name,
                   const std::string &path,
-                  unsigned int device_id);
+                  unsigned int device_id,
+                  const ola::thread::SchedulingOptions &scheduling);
 
     // we only support one widget for now
     std::string DeviceId() const { return m_device_id; }
@@ -44,6 +46,7 @@ class OpenDmxDevice: public ola::Device {
  private:
     std::string m_path;
     std::string m_device_id;
+    const ola::thread::SchedulingOptions m_scheduling;
 };
 }  // namespace opendmx
 }  // namespace plugin
@@ -30,6 +30,7 @@
 #include "ola/io/IOUtils.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
 #include "plugins/opendmx/OpenDmxDevice.h"
 #include "plugins/opendmx/OpenDmxPlugin.h"
 #include "plugins/opendmx/OpenDmxPluginDescription.h"
@@ -55,6 +56,8 @@ const char OpenDmxPlugin::DEVICE_KEY[] = "device";
  */
 bool OpenDmxPlugin::StartHook() {
   vector<string> devices = m_preferences->GetMultipleValue(DEVICE_KEY);
+  const ola::thread::SchedulingOptions scheduling =
+      ThreadPreferences::Load(m_preferences);
   vector<string>::const_iterator iter = devices.begin();
 
   // start counting device ids from 0
@@ -69,7 +72,8 @@ bool OpenDmxPlugin::StartHook() {
           this,
           OPENDMX_DEVICE_NAME,
           *iter,
-          device_id++);
+          device_id++,
+          scheduling);
       if (device->Start()) {
         m_devices.push_back(device);
         m_plugin_adaptor->RegisterDevice(device);
@@ -118,8 +122,10 @@ bool OpenDmxPlugin::SetDefaultPreferences() {
     return false;
   }
 
-  if (m_preferences->SetDefaultValue(DEVICE_KEY, StringValidator(),
-                                     OPENDMX_DEVICE_PATH)) {
+  bool save = m_preferences->SetDefaultValue(DEVICE_KEY, StringValidator(),
+                                             OPENDMX_DEVICE_PATH);
+  save |= ThreadPreferences::SetDefaults(m_preferences);
+  if (save) {
     m_preferences->Save();
   }
 
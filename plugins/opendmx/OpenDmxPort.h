@@ -35,9 +35,10 @@ class OpenDmxOutputPort: public BasicOutputPort {
  public:
   OpenDmxOutputPort(OpenDmxDevice *parent,
                     unsigned int id,
-                    const std::string &path)
+                    const std::string &path,
+                    const ola::thread::SchedulingOptions &scheduling)
       : BasicOutputPort(parent, id),
-        m_thread(path),
+        m_thread(path, scheduling),
         m_path(path) {
     m_thread.Start();
   }
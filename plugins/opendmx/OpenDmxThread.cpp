@@ -42,16 +42,17 @@ namespace plugin {
 namespace opendmx {
 
 using std::string;
-using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 
 /*
  * Create a new OpenDmxThread object
  */
-OpenDmxThread::OpenDmxThread(const string &path)
+OpenDmxThread::OpenDmxThread(const string &path,
+                             const ola::thread::SchedulingOptions &scheduling)
     : ola::thread::Thread(),
     m_fd(INVALID_FD),
     m_path(path),
+    m_scheduling(scheduling),
     m_term(false) {
 }
 
@@ -60,14 +61,12 @@ OpenDmxThread::OpenDmxThread(const string &path)
  * Run this thread
  */
 void *OpenDmxThread::Run() {
-  uint8_t buffer[DMX_UNIVERSE_SIZE+1];
-  unsigned int length = DMX_UNIVERSE_SIZE;
   Clock clock;
+  ola::thread::ApplySchedulingOptions(m_scheduling,
+                                      "Open DMX thread for " + m_path);
 
   // should close other fd here
 
-  // start code
-  buffer[0] = 0x00;
   ola::io::Open(m_path, O_WRONLY, &m_fd);
 
   while (true) {
@@ -92,13 +91,12 @@ void *OpenDmxThread::Run() {
       ola::io::Open(m_path, O_WRONLY, &m_fd);
 
     } else {
-      length = DMX_UNIVERSE_SIZE;
-      {
-        MutexLocker locker(&m_mutex);
-        m_buffer.Get(buffer + 1, &length);
-      }
+      // The frame is written straight from the shared buffer, it stays
+      // valid until the next Update().
+      m_frames.Update();
+      const Frame &frame = m_frames.ReadBuffer();
 
-      if (write(m_fd, buffer, length + 1) < 0) {
+      if (write(m_fd, frame.data, frame.length) < 0) {
         // if you unplug the dongle
         OLA_WARN << "Error writing to device: " << strerror(errno);
 
@@ -117,7 +115,7 @@ void *OpenDmxThread::Run() {
  */
 bool OpenDmxThread::Stop() {
   {
-    MutexLocker locker(&m_mutex);
+    MutexLocker locker(&m_term_mutex);
     m_term = true;
   }
   m_term_cond.Signal();
@@ -126,13 +124,15 @@ bool OpenDmxThread::Stop() {
 
 
 /*
- * Store the data in the shared buffer
- *
+ * Store the data in the shared buffer. This never blocks, if the thread
+ * hasn't sent the previous frame yet it's replaced.
  */
 bool OpenDmxThread::WriteDmx(const DmxBuffer &buffer) {
-  MutexLocker locker(&m_mutex);
-  // avoid the reference counting
-  m_buffer.Set(buffer);
+  Frame *frame = m_frames.WriteBuffer();
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(frame->data + 1, &length);
+  frame->length = length + 1;
+  m_frames.Publish();
   return true;
 }
 }  // namespace opendmx
@@ -21,9 +21,13 @@
 #ifndef PLUGINS_OPENDMX_OPENDMXTHREAD_H_
 #define PLUGINS_OPENDMX_OPENDMXTHREAD_H_
 
+#include <stdint.h>
 #include <string>
+#include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/thread/Utils.h"
 
 namespace ola {
 namespace plugin {
@@ -31,7 +35,9 @@ namespace opendmx {
 
 class OpenDmxThread: public ola::thread::Thread {
  public:
-    explicit OpenDmxThread(const std::string &path);
+    OpenDmxThread(const std::string &path,
+                  const ola::thread::SchedulingOptions &scheduling =
+                      ola::thread::SchedulingOptions());
     ~OpenDmxThread() {}
 
     bool Stop();
@@ -39,11 +45,19 @@ class OpenDmxThread: public ola::thread::Thread {
     void *Run();
 
  private:
+    // A frame as it's written to the device, with the start code.
+    struct Frame {
+      Frame() : length(1) { data[0] = DMX512_START_CODE; }
+
+      uint8_t data[DMX_UNIVERSE_SIZE + 1];
+      unsigned int length;
+    };
+
     int m_fd;
     std::string m_path;
-    DmxBuffer m_buffer;
+    const ola::thread::SchedulingOptions m_scheduling;
+    ola::thread::TripleBuffer<Frame> m_frames;
     bool m_term;
-    ola::thread::Mutex m_mutex;
     ola::thread::Mutex m_term_mutex;
     ola::thread::ConditionVariable m_term_cond;
 
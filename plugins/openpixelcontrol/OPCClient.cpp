@@ -20,12 +20,16 @@
 
 #include "plugins/openpixelcontrol/OPCClient.h"
 
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <string>
+
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
 #include "ola/io/BigEndianStream.h"
 #include "ola/io/IOQueue.h"
-#include "ola/io/NonBlockingSender.h"
 #include "ola/network/SocketAddress.h"
 #include "ola/util/Utils.h"
 #include "plugins/openpixelcontrol/OPCConstants.h"
@@ -36,6 +40,8 @@ namespace openpixelcontrol {
 
 using ola::TimeInterval;
 using ola::network::TCPSocket;
+using std::map;
+using std::string;
 
 OPCClient::OPCClient(ola::io::SelectServerInterface *ss,
                      const ola::network::IPV4SocketAddress &target)
@@ -44,29 +50,44 @@ OPCClient::OPCClient(ola::io::SelectServerInterface *ss,
       m_backoff(TimeInterval(1, 0), TimeInterval(300, 0)),
       m_pool(OPC_FRAME_SIZE),
       m_socket_factory(NewCallback(this, &OPCClient::SocketConnected)),
-      m_tcp_connector(ss, &m_socket_factory, TimeInterval(3, 0)) {
+      m_tcp_connector(ss, &m_socket_factory, TimeInterval(3, 0)),
+      m_output_queue(&m_pool),
+      m_write_registered(false),
+      m_dropped_frames(0) {
   m_tcp_connector.AddEndpoint(target, &m_backoff);
 }
 
 OPCClient::~OPCClient() {
   if (m_client_socket.get()) {
+    StopWriting();
     m_ss->RemoveReadDescriptor(m_client_socket.get());
     m_tcp_connector.Disconnect(m_target, true);
   }
 }
 
 bool OPCClient::SendDmx(uint8_t channel, const DmxBuffer &buffer) {
-  if (!m_sender.get()) {
+  return SendFrame(channel, buffer.GetRaw(), buffer.Size());
+}
+
+bool OPCClient::SendFrame(uint8_t channel, const uint8_t *data,
+                          unsigned int length) {
+  if (!m_client_socket.get()) {
     return false;  // not connected
   }
 
-  ola::io::IOQueue queue(&m_pool);
-  ola::io::BigEndianOutputStream stream(&queue);
-  stream << channel;
-  stream << SET_PIXEL_COMMAND;
-  stream << static_cast<uint16_t>(buffer.Size());
-  stream.Write(buffer.GetRaw(), buffer.Size());
-  return m_sender->SendMessage(&queue);
+  length = std::min(length, static_cast<unsigned int>(OPC_MAX_DATA_SIZE));
+  map<uint8_t, string>::iterator iter = m_pending_frames.find(channel);
+  if (iter == m_pending_frames.end()) {
+    iter = m_pending_frames.insert(std::make_pair(channel, string())).first;
+  } else {
+    m_dropped_frames++;
+  }
+  iter->second.assign(reinterpret_cast<const char*>(data), length);
+
+  if (!m_write_registered) {
+    m_write_registered = m_ss->AddWriteDescriptor(m_client_socket.get());
+  }
+  return true;
 }
 
 void OPCClient::SetSocketCallback(SocketEventCallback *callback) {
@@ -78,10 +99,10 @@ void OPCClient::SocketConnected(TCPSocket *socket) {
   m_client_socket->SetOnData(NewCallback(this, &OPCClient::NewData));
   m_client_socket->SetOnClose(
       NewSingleCallback(this, &OPCClient::SocketClosed));
+  m_client_socket->SetOnWritable(
+      NewCallback(this, &OPCClient::SocketWritable));
   m_ss->AddReadDescriptor(socket);
 
-  m_sender.reset(
-      new ola::io::NonBlockingSender(socket, m_ss, &m_pool, OPC_FRAME_SIZE));
   if (m_socket_callback.get()) {
     m_socket_callback->Run(true);
   }
@@ -99,13 +120,46 @@ void OPCClient::NewData() {
 }
 
 void OPCClient::SocketClosed() {
-  m_sender.reset();
+  StopWriting();
   m_client_socket.reset();
+  m_pending_frames.clear();
+  m_output_queue.Clear();
 
   if (m_socket_callback.get()) {
     m_socket_callback->Run(false);
   }
 }
+
+/*
+ * Called when the socket is writable. Any partially written frames are
+ * finished first, then all the queued frames are written with a single call.
+ */
+void OPCClient::SocketWritable() {
+  if (m_output_queue.Empty()) {
+    ola::io::BigEndianOutputStream stream(&m_output_queue);
+    map<uint8_t, string>::const_iterator iter = m_pending_frames.begin();
+    for (; iter != m_pending_frames.end(); ++iter) {
+      stream << iter->first;
+      stream << SET_PIXEL_COMMAND;
+      stream << static_cast<uint16_t>(iter->second.size());
+      stream.Write(reinterpret_cast<const uint8_t*>(iter->second.data()),
+                   static_cast<unsigned int>(iter->second.size()));
+    }
+    m_pending_frames.clear();
+  }
+
+  m_client_socket->Send(&m_output_queue);
+  if (m_output_queue.Empty() && m_pending_frames.empty()) {
+    StopWriting();
+  }
+}
+
+void OPCClient::StopWriting() {
+  if (m_write_registered) {
+    m_ss->RemoveWriteDescriptor(m_client_socket.get());
+    m_write_registered = false;
+  }
+}
 }  // namespace openpixelcontrol
 }  // namespace plugin
 }  // namespace ola
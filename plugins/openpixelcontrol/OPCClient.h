@@ -21,10 +21,13 @@
 #ifndef PLUGINS_OPENPIXELCONTROL_OPCCLIENT_H_
 #define PLUGINS_OPENPIXELCONTROL_OPCCLIENT_H_
 
+#include <stdint.h>
+#include <map>
 #include <memory>
 #include <string>
 
 #include "ola/DmxBuffer.h"
+#include "ola/io/IOQueue.h"
 #include "ola/io/MemoryBlockPool.h"
 #include "ola/io/SelectServerInterface.h"
 #include "ola/network/AdvancedTCPConnector.h"
@@ -34,10 +37,6 @@
 
 namespace ola {
 
-namespace io {
-class NonBlockingSender;
-}  // namespace io
-
 namespace plugin {
 namespace openpixelcontrol {
 
@@ -45,6 +44,11 @@ namespace openpixelcontrol {
  * @brief An Open Pixel Control client.
  *
  * The OPC client connects to a remote IP:port and sends OPC messages.
+ *
+ * Frames are queued per channel until the socket is writable. If a new frame
+ * for a channel arrives before the previous one was written, the old one is
+ * dropped, since stale pixel data is worse than missing data. All the queued
+ * frames are written together.
  */
 class OPCClient {
  public:
@@ -76,9 +80,30 @@ class OPCClient {
    * @brief Send a DMX frame.
    * @param channel the OPC channel to use.
    * @param buffer the DMX data.
+   * @returns true if the frame was queued, false if we're not connected.
    */
   bool SendDmx(uint8_t channel, const DmxBuffer &buffer);
 
+  /**
+   * @brief Send a frame, which may be longer than a universe.
+   * @param channel the OPC channel to use.
+   * @param data the pixel data.
+   * @param length the length of the data, at most 65535 bytes.
+   * @returns true if the frame was queued, false if we're not connected.
+   */
+  bool SendFrame(uint8_t channel, const uint8_t *data, unsigned int length);
+
+  /**
+   * @brief The number of frames waiting for the socket to become writable.
+   */
+  unsigned int QueueDepth() const { return m_pending_frames.size(); }
+
+  /**
+   * @brief The number of frames replaced by a newer frame before they were
+   *   sent.
+   */
+  uint64_t DroppedFrames() const { return m_dropped_frames; }
+
   /**
    * @brief Set the callback to be run when the socket state changes.
    * @param callback the callback to run when the socket state changes.
@@ -95,12 +120,19 @@ class OPCClient {
   ola::network::TCPSocketFactory m_socket_factory;
   ola::network::AdvancedTCPConnector m_tcp_connector;
   std::auto_ptr<ola::network::TCPSocket> m_client_socket;
-  std::auto_ptr<ola::io::NonBlockingSender> m_sender;
   std::auto_ptr<SocketEventCallback> m_socket_callback;
+  // The latest frame for each channel that hasn't been written yet.
+  std::map<uint8_t, std::string> m_pending_frames;
+  // Frames that have been partially written to the socket.
+  ola::io::IOQueue m_output_queue;
+  bool m_write_registered;
+  uint64_t m_dropped_frames;
 
   void SocketConnected(ola::network::TCPSocket *socket);
   void NewData();
   void SocketClosed();
+  void SocketWritable();
+  void StopWriting();
 
   DISALLOW_COPY_AND_ASSIGN(OPCClient);
 };
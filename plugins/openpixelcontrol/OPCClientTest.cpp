@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
 
 #include <memory>
 #include "ola/base/Array.h"
@@ -44,25 +45,32 @@ using std::auto_ptr;
 class OPCClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OPCClientTest);
   CPPUNIT_TEST(testTransmit);
+  CPPUNIT_TEST(testLatestFrameWins);
+  CPPUNIT_TEST(testLargeFrame);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   OPCClientTest()
       : CppUnit::TestFixture(),
-        m_ss(NULL) {
+        m_ss(NULL),
+        m_received_length(0) {
   }
   void setUp();
 
   void testTransmit();
+  void testLatestFrameWins();
+  void testLargeFrame();
 
  private:
   ola::io::SelectServer m_ss;
   auto_ptr<OPCServer> m_server;
   DmxBuffer m_received_data;
   uint8_t m_command;
+  unsigned int m_received_length;
 
   void CaptureData(uint8_t command, const uint8_t *data, unsigned int length) {
     m_received_data.Set(data, length);
+    m_received_length = length;
     m_command = command;
     m_ss.Terminate();
   }
@@ -75,7 +83,33 @@ class OPCClientTest: public CppUnit::TestFixture {
     }
   }
 
+  void SendFrames(OPCClient *client, bool connected) {
+    if (!connected) {
+      m_ss.Terminate();
+      return;
+    }
+    DmxBuffer buffer;
+    buffer.SetFromString("1,2,3,4");
+    OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, buffer));
+    OLA_ASSERT_TRUE(client->SendDmx(OTHER_CHANNEL, buffer));
+    buffer.SetFromString("5,6,7");
+    OLA_ASSERT_TRUE(client->SendDmx(CHANNEL, buffer));
+    OLA_ASSERT_EQ(2u, client->QueueDepth());
+    OLA_ASSERT_EQ(static_cast<uint64_t>(1), client->DroppedFrames());
+  }
+
+  void SendLargeFrame(OPCClient *client, bool connected) {
+    if (!connected) {
+      m_ss.Terminate();
+      return;
+    }
+    uint8_t frame[3 * ola::DMX_UNIVERSE_SIZE];
+    memset(frame, 7, sizeof(frame));
+    OLA_ASSERT_TRUE(client->SendFrame(CHANNEL, frame, sizeof(frame)));
+  }
+
   static const uint8_t CHANNEL = 1;
+  static const uint8_t OTHER_CHANNEL = 2;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OPCClientTest);
@@ -111,3 +145,32 @@ void OPCClientTest::testTransmit() {
   // Now sends should fail since there is no connection
   OLA_ASSERT_FALSE(client.SendDmx(CHANNEL, buffer));
 }
+
+/*
+ * Check that only the latest frame for a channel is sent.
+ */
+void OPCClientTest::testLatestFrameWins() {
+  OPCClient client(&m_ss, m_server->ListenAddress());
+  client.SetSocketCallback(
+      ola::NewCallback(this, &OPCClientTest::SendFrames, &client));
+
+  m_ss.Run();
+  DmxBuffer expected;
+  expected.SetFromString("5,6,7");
+  OLA_ASSERT_EQ(expected, m_received_data);
+  OLA_ASSERT_EQ(0u, client.QueueDepth());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), client.DroppedFrames());
+}
+
+/*
+ * Check frames longer than a universe are sent whole.
+ */
+void OPCClientTest::testLargeFrame() {
+  OPCClient client(&m_ss, m_server->ListenAddress());
+  client.SetSocketCallback(
+      ola::NewCallback(this, &OPCClientTest::SendLargeFrame, &client));
+
+  m_ss.Run();
+  OLA_ASSERT_EQ(3u * ola::DMX_UNIVERSE_SIZE, m_received_length);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(7), m_received_data.Get(511));
+}
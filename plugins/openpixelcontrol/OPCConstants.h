@@ -39,6 +39,11 @@ enum {
    * @brief The size of an OPC frame with DMX512 data.
    */
   OPC_FRAME_SIZE = DMX_UNIVERSE_SIZE + OPC_HEADER_SIZE,
+
+  /**
+   * @brief The maximum length of the data in an OPC frame.
+   */
+  OPC_MAX_DATA_SIZE = 0xffff,
 };
 
 /**
@@ -26,7 +26,9 @@
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "olad/Preferences.h"
+#include "plugins/openpixelcontrol/OPCConstants.h"
 #include "plugins/openpixelcontrol/OPCPort.h"
 
 namespace ola {
@@ -82,15 +84,76 @@ bool OPCServerDevice::StartHook() {
   str << "listen_" << m_listen_addr << "_channel";
   set<uint8_t> channels = DeDupChannels(
       m_preferences->GetMultipleValue(str.str()));
+
+  str.str("");
+  str << "listen_" << m_listen_addr << "_universes_per_channel";
+  unsigned int universes = StringToIntOrDefault(
+      m_preferences->GetValue(str.str()), 1u);
+  if (universes == 0 || universes > MAX_UNIVERSES_PER_CHANNEL) {
+    OLA_WARN << "Invalid value for " << str.str() << ", must be between 1 and "
+             << MAX_UNIVERSES_PER_CHANNEL;
+    universes = 1;
+  }
+
   set<uint8_t>::const_iterator iter = channels.begin();
   for (; iter != channels.end(); ++iter) {
-    OPCInputPort *port = new OPCInputPort(this, *iter, m_plugin_adaptor,
-                                          m_server.get());
-    AddPort(port);
+    if (universes == 1) {
+      OPCInputPort *port = new OPCInputPort(this, *iter, m_plugin_adaptor,
+                                            m_server.get());
+      AddPort(port);
+      continue;
+    }
+
+    // The port ids for the first universe match the unsplit case.
+    PortList &ports = m_split_channels[*iter];
+    for (unsigned int i = 0; i < universes; i++) {
+      OPCInputPort *port = new OPCInputPort(
+          this, (i << 8) | *iter, *iter, i * DMX_UNIVERSE_SIZE,
+          m_plugin_adaptor, m_server.get());
+      ports.push_back(port);
+      AddPort(port);
+    }
+    m_server->SetCallback(
+        *iter, NewCallback(this, &OPCServerDevice::NewFrame,
+                           static_cast<const PortList*>(&ports)));
   }
   return true;
 }
 
+void OPCServerDevice::PrePortStop() {
+  SplitChannelMap::const_iterator iter = m_split_channels.begin();
+  for (; iter != m_split_channels.end(); ++iter) {
+    m_server->SetCallback(iter->first, NULL);
+  }
+  m_split_channels.clear();
+}
+
+/*
+ * Pass a frame to each of the ports for a split channel. All the ports are
+ * updated before any of them signal the change, so the universes are
+ * consistent when the first one is merged.
+ */
+void OPCServerDevice::NewFrame(const PortList *ports,
+                               uint8_t command,
+                               const uint8_t *data,
+                               unsigned int length) {
+  if (command != SET_PIXEL_COMMAND) {
+    OLA_DEBUG << "Received an unknown OPC command: "
+              << static_cast<int>(command);
+    return;
+  }
+
+  unsigned int updated = 0;
+  PortList::const_iterator iter = ports->begin();
+  for (; iter != ports->end() && (*iter)->SetFrame(data, length); ++iter) {
+    updated++;
+  }
+
+  for (unsigned int i = 0; i < updated; i++) {
+    (*ports)[i]->DmxChanged();
+  }
+}
+
 OPCClientDevice::OPCClientDevice(AbstractPlugin *owner,
                                  PluginAdaptor *plugin_adaptor,
                                  Preferences *preferences,
@@ -111,9 +174,22 @@ bool OPCClientDevice::StartHook() {
   str << "target_" << m_target << "_channel";
   set<uint8_t> channels = DeDupChannels(
       m_preferences->GetMultipleValue(str.str()));
+
+  str.str("");
+  str << "target_" << m_target << "_universes_per_channel";
+  unsigned int universes = StringToIntOrDefault(
+      m_preferences->GetValue(str.str()), 1u);
+  if (universes == 0 ||
+      universes > OPCServerDevice::MAX_UNIVERSES_PER_CHANNEL) {
+    OLA_WARN << "Invalid value for " << str.str() << ", must be between 1 and "
+             << OPCServerDevice::MAX_UNIVERSES_PER_CHANNEL;
+    universes = 1;
+  }
+
   set<uint8_t>::const_iterator iter = channels.begin();
   for (; iter != channels.end(); ++iter) {
-    OPCOutputPort *port = new OPCOutputPort(this, *iter, m_client.get());
+    OPCOutputPort *port = new OPCOutputPort(this, *iter, universes,
+                                            m_client.get());
     AddPort(port);
   }
   return true;
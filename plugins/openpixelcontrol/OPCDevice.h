@@ -21,8 +21,10 @@
 #ifndef PLUGINS_OPENPIXELCONTROL_OPCDEVICE_H_
 #define PLUGINS_OPENPIXELCONTROL_OPCDEVICE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ola/network/Socket.h"
 #include "olad/Device.h"
@@ -54,14 +56,30 @@ class OPCServerDevice: public ola::Device {
 
   bool AllowMultiPortPatching() const { return true; }
 
+  /**
+   * @brief The maximum number of universes a channel can be split across.
+   *
+   * This is enough for the largest OPC frame.
+   */
+  static const unsigned int MAX_UNIVERSES_PER_CHANNEL = 128;
+
  protected:
   bool StartHook();
+  void PrePortStop();
 
  private:
+  typedef std::vector<class OPCInputPort*> PortList;
+  typedef std::map<uint8_t, PortList> SplitChannelMap;
+
   PluginAdaptor* const m_plugin_adaptor;
   Preferences* const m_preferences;
   const ola::network::IPV4SocketAddress m_listen_addr;
   std::auto_ptr<class OPCServer> m_server;
+  // The ports for each channel that's split across universes.
+  SplitChannelMap m_split_channels;
+
+  void NewFrame(const PortList *ports, uint8_t command, const uint8_t *data,
+                unsigned int length);
 
   DISALLOW_COPY_AND_ASSIGN(OPCServerDevice);
 };
@@ -20,7 +20,9 @@
 
 #include "plugins/openpixelcontrol/OPCPort.h"
 
+#include <algorithm>
 #include <string>
+#include "ola/Constants.h"
 #include "ola/base/Macro.h"
 #include "plugins/openpixelcontrol/OPCClient.h"
 #include "plugins/openpixelcontrol/OPCConstants.h"
@@ -39,10 +41,35 @@ OPCInputPort::OPCInputPort(OPCServerDevice *parent,
                            class OPCServer *server)
     : BasicInputPort(parent, channel, plugin_adaptor),
       m_channel(channel),
+      m_slot_offset(0),
+      m_split(false),
       m_server(server) {
   m_server->SetCallback(channel, NewCallback(this, &OPCInputPort::NewData));
 }
 
+OPCInputPort::OPCInputPort(OPCServerDevice *parent,
+                           unsigned int port_id,
+                           uint8_t channel,
+                           unsigned int slot_offset,
+                           class PluginAdaptor *plugin_adaptor,
+                           class OPCServer *server)
+    : BasicInputPort(parent, port_id, plugin_adaptor),
+      m_channel(channel),
+      m_slot_offset(slot_offset),
+      m_split(true),
+      m_server(server) {
+}
+
+bool OPCInputPort::SetFrame(const uint8_t *data, unsigned int length) {
+  if (length <= m_slot_offset) {
+    return false;
+  }
+  m_buffer.Set(data + m_slot_offset,
+               std::min(length - m_slot_offset,
+                        static_cast<unsigned int>(DMX_UNIVERSE_SIZE)));
+  return true;
+}
+
 void OPCInputPort::NewData(uint8_t command,
                            const uint8_t *data,
                            unsigned int length) {
@@ -59,6 +86,10 @@ string OPCInputPort::Description() const {
   std::ostringstream str;
   str << m_server->ListenAddress() << ", Channel "
       << static_cast<int>(m_channel);
+  if (m_split) {
+    str << ", Slots " << m_slot_offset << " - "
+        << m_slot_offset + DMX_UNIVERSE_SIZE - 1;
+  }
   return str.str();
 }
 
@@ -70,15 +101,48 @@ OPCOutputPort::OPCOutputPort(OPCClientDevice *parent,
       m_channel(channel) {
 }
 
+OPCOutputPort::OPCOutputPort(OPCClientDevice *parent,
+                             uint8_t channel,
+                             unsigned int universes,
+                             OPCClient *client)
+    : BasicOutputPort(parent, channel),
+      m_client(client),
+      m_channel(channel) {
+  if (universes > 1) {
+    m_span.reset(new SpanFrame(
+        universes, NewCallback(this, &OPCOutputPort::SendFrame)));
+  }
+}
+
 bool OPCOutputPort::WriteDMX(const DmxBuffer &buffer,
                              OLA_UNUSED uint8_t priority) {
+  if (m_span.get()) {
+    return m_span->Update(0, buffer);
+  }
   return m_client->SendDmx(m_channel, buffer);
 }
 
+unsigned int OPCOutputPort::UniverseCount() const {
+  return m_span.get() ? m_span->UniverseCount() : 1;
+}
+
+bool OPCOutputPort::WriteSpanDMX(unsigned int index,
+                                 const DmxBuffer &buffer,
+                                 OLA_UNUSED uint8_t priority) {
+  return m_span.get() && m_span->Update(index, buffer);
+}
+
+void OPCOutputPort::SendFrame(const uint8_t *data, unsigned int length) {
+  m_client->SendFrame(m_channel, data, length);
+}
+
 string OPCOutputPort::Description() const {
   std::ostringstream str;
   str << m_client->GetRemoteAddress() << ", Channel "
       << static_cast<int>(m_channel);
+  if (m_span.get()) {
+    str << ", " << m_span->UniverseCount() << " universes";
+  }
   return str.str();
 }
 }  // namespace openpixelcontrol
@@ -21,9 +21,11 @@
 #ifndef PLUGINS_OPENPIXELCONTROL_OPCPORT_H_
 #define PLUGINS_OPENPIXELCONTROL_OPCPORT_H_
 
+#include <memory>
 #include <string>
 #include "ola/DmxBuffer.h"
 #include "olad/Port.h"
+#include "olad/SpanFrame.h"
 #include "plugins/openpixelcontrol/OPCDevice.h"
 
 namespace ola {
@@ -49,14 +51,45 @@ class OPCInputPort: public BasicInputPort {
                class PluginAdaptor *plugin_adaptor,
                class OPCServer *server);
 
+  /**
+   * @brief Create a new OPC Input Port for part of a channel's frame.
+   * @param parent the OPCDevice this port belongs to
+   * @param port_id the id of the port.
+   * @param channel the OPC channel for the port.
+   * @param slot_offset the offset of this port's data in the frame.
+   * @param plugin_adaptor the PluginAdaptor to use
+   * @param server the OPCServer to use, ownership is not transferred.
+   *
+   * Ports created this way don't register a callback with the server, the
+   * device passes each frame to SetFrame() instead.
+   */
+  OPCInputPort(OPCServerDevice *parent,
+               unsigned int port_id,
+               uint8_t channel,
+               unsigned int slot_offset,
+               class PluginAdaptor *plugin_adaptor,
+               class OPCServer *server);
+
   const DmxBuffer &ReadDMX() const { return m_buffer; }
 
+  /**
+   * @brief Update the port's data from a frame.
+   * @param data the frame data, starting from the first pixel.
+   * @param length the length of the frame data.
+   * @returns true if the frame contained data for this port.
+   *
+   * This doesn't call DmxChanged().
+   */
+  bool SetFrame(const uint8_t *data, unsigned int length);
+
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
 
   std::string Description() const;
 
  private:
   const uint8_t m_channel;
+  const unsigned int m_slot_offset;
+  const bool m_split;
   class OPCServer* const m_server;
   DmxBuffer m_buffer;
 
@@ -81,13 +114,36 @@ class OPCOutputPort: public BasicOutputPort {
                 uint8_t channel,
                 class OPCClient *client);
 
+  /**
+   * @brief Create a new OPC Output Port which spans several universes.
+   * @param parent the OPCDevice this port belongs to
+   * @param channel the OPC channel for the port.
+   * @param universes the number of universes the port takes, each one is
+   *   512 bytes of the frame.
+   * @param client the OPCClient to use for this port, ownership is not
+   *   transferred.
+   */
+  OPCOutputPort(OPCClientDevice *parent,
+                uint8_t channel,
+                unsigned int universes,
+                class OPCClient *client);
+
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
 
+  unsigned int UniverseCount() const;
+  bool WriteSpanDMX(unsigned int index,
+                    const DmxBuffer &buffer,
+                    uint8_t priority);
+
   std::string Description() const;
 
  private:
   class OPCClient* const m_client;
   const uint8_t m_channel;
+  // Only set if the port spans more than one universe.
+  std::auto_ptr<SpanFrame> m_span;
+
+  void SendFrame(const uint8_t *data, unsigned int length);
 
   DISALLOW_COPY_AND_ASSIGN(OPCOutputPort);
 };
@@ -20,6 +20,7 @@
 
 #include "plugins/openpixelcontrol/OPCServer.h"
 
+#include <string.h>
 #include <string>
 #include "ola/Callback.h"
 #include "ola/Logging.h"
@@ -132,26 +133,36 @@ void OPCServer::SocketReady(TCPSocket *socket, RxState *rx_state) {
   }
 
   rx_state->offset += data_received;
-  if (rx_state->offset < OPC_HEADER_SIZE) {
-    return;
+
+  // A single read may contain more than one frame, the callbacks are passed a
+  // pointer into the receive buffer so the frame data isn't copied here.
+  unsigned int frame_start = 0;
+  while (rx_state->offset - frame_start >= OPC_HEADER_SIZE) {
+    const uint8_t *frame = rx_state->data + frame_start;
+    unsigned int frame_size = OPC_HEADER_SIZE +
+                              utils::JoinUInt8(frame[2], frame[3]);
+    if (rx_state->offset - frame_start < frame_size) {
+      break;
+    }
+
+    ChannelCallback *cb = STLFindOrNull(m_callbacks, frame[0]);
+    if (cb) {
+      cb->Run(frame[1], frame + OPC_HEADER_SIZE,
+              frame_size - OPC_HEADER_SIZE);
+    }
+    frame_start += frame_size;
   }
 
-  rx_state->CheckSize();
-  if (rx_state->offset <
-      static_cast<unsigned int>(rx_state->expected_size) + OPC_HEADER_SIZE) {
-    return;
+  if (frame_start) {
+    rx_state->offset -= frame_start;
+    memmove(rx_state->data, rx_state->data + frame_start, rx_state->offset);
   }
 
-  ChannelCallback *cb = STLFindOrNull(m_callbacks, rx_state->data[0]);
-  if (cb) {
-    DmxBuffer buffer(rx_state->data + OPC_HEADER_SIZE,
-                     rx_state->offset - OPC_HEADER_SIZE);
-    cb->Run(rx_state->data[1],
-            rx_state->data + OPC_HEADER_SIZE,
-            rx_state->expected_size);
+  if (rx_state->offset >= OPC_HEADER_SIZE) {
+    rx_state->CheckSize();
+  } else {
+    rx_state->expected_size = 0;
   }
-  rx_state->offset = 0;
-  rx_state->expected_size = 0;
 }
 
 void OPCServer::SocketClosed(TCPSocket *socket) {
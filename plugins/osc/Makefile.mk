@@ -6,6 +6,7 @@ noinst_LTLIBRARIES += plugins/osc/libolaoscnode.la
 plugins_osc_libolaoscnode_la_SOURCES = \
     plugins/osc/OSCAddressTemplate.cpp \
     plugins/osc/OSCAddressTemplate.h \
+    plugins/osc/OSCAddressTrie.h \
     plugins/osc/OSCNode.cpp \
     plugins/osc/OSCNode.h \
     plugins/osc/OSCTarget.h
@@ -39,6 +40,7 @@ test_programs += plugins/osc/OSCTester
 
 plugins_osc_OSCTester_SOURCES = \
     plugins/osc/OSCAddressTemplateTest.cpp \
+    plugins/osc/OSCAddressTrieTest.cpp \
     plugins/osc/OSCNodeTest.cpp
 plugins_osc_OSCTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 plugins_osc_OSCTester_LDADD = $(COMMON_TESTING_LIBS) \
@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OSCAddressTrie.h
+ * Map OSC addresses to values without copying the address.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_OSC_OSCADDRESSTRIE_H_
+#define PLUGINS_OSC_OSCADDRESSTRIE_H_
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace plugin {
+namespace osc {
+
+/**
+ * A trie of OSC addresses, with one level for each part of the address.
+ *
+ * The registered addresses are split into parts when they're added, so a
+ * lookup walks the received address in place rather than building strings
+ * from it. The children of each node are kept sorted, so each level is a
+ * binary search. Empty parts are ignored, so "/dmx//1/" is the same address
+ * as "/dmx/1".
+ *
+ * The trie doesn't own the values.
+ */
+template <typename T>
+class OSCAddressTrie {
+ public:
+  OSCAddressTrie() : m_root(std::string()) {}
+  ~OSCAddressTrie() { m_root.DeleteChildren(); }
+
+  /**
+   * @brief Add an address.
+   * @param address the OSC address.
+   * @param value the value for the address, ownership is not transferred.
+   * @returns false if the address already has a value.
+   */
+  bool Insert(const std::string &address, T *value) {
+    Node *node = &m_root;
+    const char *ptr = address.c_str();
+    const char *end = ptr + address.size();
+    const char *part;
+    size_t length;
+    while (NextPart(&ptr, end, &part, &length)) {
+      node = node->AddChild(part, length);
+    }
+    if (node->value) {
+      return false;
+    }
+    node->value = value;
+    return true;
+  }
+
+  /**
+   * @brief Remove an address.
+   * @param address the OSC address.
+   * @returns the value for the address, or NULL if it wasn't present.
+   */
+  T *Remove(const std::string &address) {
+    Node *node = const_cast<Node*>(Walk(address.c_str(),
+                                        address.c_str() + address.size()));
+    if (!node) {
+      return NULL;
+    }
+    T *value = node->value;
+    node->value = NULL;
+    return value;
+  }
+
+  /**
+   * @brief Lookup an address.
+   * @param address the start of the OSC address.
+   * @param length the length of the address.
+   * @returns the value for the address, or NULL if it isn't present.
+   */
+  T *Find(const char *address, size_t length) const {
+    const Node *node = Walk(address, address + length);
+    return node ? node->value : NULL;
+  }
+
+  T *Find(const char *address) const {
+    return Find(address, strlen(address));
+  }
+
+  /**
+   * @brief Remove all addresses.
+   */
+  void Clear() {
+    m_root.DeleteChildren();
+    m_root.value = NULL;
+  }
+
+ private:
+  struct Node {
+    explicit Node(const std::string &part) : part(part), value(NULL) {}
+
+    std::string part;
+    T *value;
+    std::vector<Node*> children;  // sorted by part
+
+    typename std::vector<Node*>::const_iterator Search(
+        const char *key, size_t length) const {
+      return std::lower_bound(children.begin(), children.end(),
+                              PartKey(key, length), ComparePart());
+    }
+
+    const Node *Child(const char *key, size_t length) const {
+      typename std::vector<Node*>::const_iterator iter = Search(key, length);
+      if (iter == children.end() || (*iter)->part.compare(0, std::string::npos,
+                                                          key, length)) {
+        return NULL;
+      }
+      return *iter;
+    }
+
+    Node *AddChild(const char *key, size_t length) {
+      const Node *child = Child(key, length);
+      if (child) {
+        return const_cast<Node*>(child);
+      }
+      Node *node = new Node(std::string(key, length));
+      children.insert(children.begin() + (Search(key, length) -
+                                          children.begin()),
+                      node);
+      return node;
+    }
+
+    void DeleteChildren() {
+      typename std::vector<Node*>::iterator iter = children.begin();
+      for (; iter != children.end(); ++iter) {
+        (*iter)->DeleteChildren();
+        delete *iter;
+      }
+      children.clear();
+    }
+  };
+
+  struct PartKey {
+    PartKey(const char *data, size_t length) : data(data), length(length) {}
+    const char *data;
+    size_t length;
+  };
+
+  struct ComparePart {
+    bool operator()(const Node *node, const PartKey &key) const {
+      return node->part.compare(0, std::string::npos, key.data,
+                                key.length) < 0;
+    }
+  };
+
+  Node m_root;
+
+  const Node *Walk(const char *ptr, const char *end) const {
+    const Node *node = &m_root;
+    const char *part;
+    size_t length;
+    while (node && NextPart(&ptr, end, &part, &length)) {
+      node = node->Child(part, length);
+    }
+    return node;
+  }
+
+  /*
+   * Find the next part of an address, skipping any leading '/'. Returns false
+   * once the end of the address has been reached.
+   */
+  static bool NextPart(const char **ptr, const char *end, const char **part,
+                       size_t *length) {
+    while (*ptr != end && **ptr == '/') {
+      (*ptr)++;
+    }
+    if (*ptr == end) {
+      return false;
+    }
+    *part = *ptr;
+    while (*ptr != end && **ptr != '/') {
+      (*ptr)++;
+    }
+    *length = *ptr - *part;
+    return true;
+  }
+
+  OSCAddressTrie(const OSCAddressTrie&);
+  OSCAddressTrie& operator=(const OSCAddressTrie&);
+};
+}  // namespace osc
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_OSC_OSCADDRESSTRIE_H_
@@ -0,0 +1,97 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OSCAddressTrieTest.cpp
+ * Test fixture for the OSCAddressTrie class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+
+#include "ola/testing/TestUtils.h"
+#include "plugins/osc/OSCAddressTrie.h"
+
+using ola::plugin::osc::OSCAddressTrie;
+using std::string;
+
+class OSCAddressTrieTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OSCAddressTrieTest);
+  CPPUNIT_TEST(testInsertAndFind);
+  CPPUNIT_TEST(testRemove);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testInsertAndFind();
+    void testRemove();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OSCAddressTrieTest);
+
+/**
+ * Check that addresses can be added and found.
+ */
+void OSCAddressTrieTest::testInsertAndFind() {
+  OSCAddressTrie<int> trie;
+  int values[] = {1, 2, 3, 4};
+
+  OLA_ASSERT_NULL(trie.Find("/dmx/1"));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/1", &values[0]));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/10", &values[1]));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/universe/2", &values[2]));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx", &values[3]));
+  OLA_ASSERT_FALSE(trie.Insert("/dmx/universe/2", &values[0]));
+
+  OLA_ASSERT_EQ(&values[0], trie.Find("/dmx/universe/1"));
+  OLA_ASSERT_EQ(&values[1], trie.Find("/dmx/universe/10"));
+  OLA_ASSERT_EQ(&values[2], trie.Find("/dmx/universe/2"));
+  OLA_ASSERT_EQ(&values[3], trie.Find("/dmx"));
+  OLA_ASSERT_EQ(&values[3], trie.Find("/dmx/"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe/3"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/universe/1/1"));
+  OLA_ASSERT_NULL(trie.Find("/foo"));
+
+  // Lookups don't need the address to be terminated.
+  const char address[] = "/dmx/universe/10/512";
+  OLA_ASSERT_EQ(&values[1], trie.Find(address, strlen(address) - 4));
+  OLA_ASSERT_EQ(&values[0], trie.Find(address, strlen(address) - 5));
+  OLA_ASSERT_NULL(trie.Find(address, strlen(address)));
+}
+
+/**
+ * Check that addresses can be removed.
+ */
+void OSCAddressTrieTest::testRemove() {
+  OSCAddressTrie<int> trie;
+  int values[] = {1, 2};
+
+  OLA_ASSERT_NULL(trie.Remove("/dmx/1"));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/1", &values[0]));
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/1/2", &values[1]));
+
+  OLA_ASSERT_EQ(&values[0], trie.Remove("/dmx/1"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/1"));
+  OLA_ASSERT_EQ(&values[1], trie.Find("/dmx/1/2"));
+  OLA_ASSERT_NULL(trie.Remove("/dmx/1"));
+
+  OLA_ASSERT_TRUE(trie.Insert("/dmx/1", &values[1]));
+  OLA_ASSERT_EQ(&values[1], trie.Find("/dmx/1"));
+
+  trie.Clear();
+  OLA_ASSERT_NULL(trie.Find("/dmx/1"));
+  OLA_ASSERT_NULL(trie.Find("/dmx/1/2"));
+}
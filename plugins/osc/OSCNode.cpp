@@ -28,6 +28,7 @@
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
 #include <ola/stl/STLUtils.h>
+#include <string.h>
 #include <algorithm>
 #include <string>
 #include <utility>
@@ -80,28 +81,38 @@ void OSCErrorHandler(int error_code, const char *msg, const char *stack) {
 
 
 /**
- * Extract the slot number and group address from an OSC address
+ * Extract the slot number and group address from an OSC address. This runs
+ * for every slot message, so it works on the address in place.
+ * @param osc_address the OSC address.
+ * @param[out] group_length the length of the group address, which is the
+ *   start of osc_address.
+ * @param[out] slot the slot offset.
  */
-bool ExtractSlotFromPath(const string &osc_address,
-                         string *group_address,
+bool ExtractSlotFromPath(const char *osc_address,
+                         size_t *group_length,
                          uint16_t *slot) {
-  size_t pos = osc_address.find_last_of("/");
-  if (pos == string::npos) {
+  const char *pos = strrchr(osc_address, '/');
+  if (!pos) {
     OLA_WARN << "Got invalid OSC message to " << osc_address;
     return false;
   }
-  if (!StringToInt(osc_address.substr(pos + 1), slot, true)) {
-    OLA_WARN << "Unable to extract slot from " << osc_address.substr(pos + 1);
+
+  const char *ptr = pos + 1;
+  unsigned int value = 0;
+  for (; *ptr >= '0' && *ptr <= '9' && value <= DMX_UNIVERSE_SIZE; ptr++) {
+    value = value * 10 + (*ptr - '0');
+  }
+  if (ptr == pos + 1 || *ptr) {
+    OLA_WARN << "Unable to extract slot from " << pos + 1;
     return false;
   }
 
-  if (*slot == 0 || *slot > DMX_UNIVERSE_SIZE) {
-    OLA_WARN << "Ignoring slot " << *slot;
-    return 0;
+  if (value == 0 || value > DMX_UNIVERSE_SIZE) {
+    OLA_WARN << "Ignoring slot " << value;
+    return false;
   }
-  (*slot)--;
-
-  *group_address = osc_address.substr(0, pos);
+  *slot = static_cast<uint16_t>(value - 1);
+  *group_length = pos - osc_address;
   return true;
 }
 
@@ -154,23 +165,25 @@ int OSCDataHandler(const char *osc_address, const char *types, lo_arg **argv,
       unsigned int size = min(static_cast<uint32_t>(DMX_UNIVERSE_SIZE),
                               lo_blob_datasize(blob));
       node->SetUniverse(
-          osc_address, static_cast<uint8_t*>(lo_blob_dataptr(blob)), size);
+          osc_address, strlen(osc_address),
+          static_cast<uint8_t*>(lo_blob_dataptr(blob)), size);
       return 0;
     } else if (type == "f") {
       float val = max(0.0f, min(1.0f, argv[0]->f));
-      string group_address;
-      if (!ExtractSlotFromPath(osc_address, &group_address, &slot))
+      size_t group_length;
+      if (!ExtractSlotFromPath(osc_address, &group_length, &slot))
         return 0;
 
-      node->SetSlot(group_address, slot,  val * DMX_MAX_SLOT_VALUE);
+      node->SetSlot(osc_address, group_length, slot,
+                    val * DMX_MAX_SLOT_VALUE);
       return 0;
     } else if (type == "i") {
       int val = min(static_cast<int>(DMX_MAX_SLOT_VALUE), max(0, argv[0]->i));
-      string group_address;
-      if (!ExtractSlotFromPath(osc_address, &group_address, &slot))
+      size_t group_length;
+      if (!ExtractSlotFromPath(osc_address, &group_length, &slot))
         return 0;
 
-      node->SetSlot(group_address, slot,  val);
+      node->SetSlot(osc_address, group_length, slot, val);
       return 0;
     }
   } else if (argc == 2) {
@@ -179,7 +192,7 @@ int OSCDataHandler(const char *osc_address, const char *types, lo_arg **argv,
       return 0;
     }
 
-    node->SetSlot(osc_address, slot,  value);
+    node->SetSlot(osc_address, strlen(osc_address), slot, value);
     return 0;
   }
   OLA_WARN << "Unknown OSC message type " << type;
@@ -285,6 +298,7 @@ void OSCNode::Stop() {
   m_output_map.clear();
 
   // Delete all the RX callbacks.
+  m_input_trie.Clear();
   STLDeleteValues(&m_input_map);
 
   if (m_descriptor.get()) {
@@ -388,6 +402,10 @@ bool OSCNode::SendData(unsigned int group, DataFormat data_format,
       return SendIndividualFloats(dmx_data, output_group);
     case FORMAT_FLOAT_ARRAY:
       return SendFloatArray(dmx_data, output_group->targets);
+    case FORMAT_INT_BUNDLE:
+      return SendIndividualMessages(dmx_data, output_group, "i", true);
+    case FORMAT_FLOAT_BUNDLE:
+      return SendIndividualMessages(dmx_data, output_group, "f", true);
     default:
       OLA_WARN << "Unimplemented data format";
       return false;
@@ -418,11 +436,13 @@ bool OSCNode::RegisterAddress(const string &osc_address,
     } else {
       // This is a new registration, insert into the AddressCallbackMap and
       // register with liblo.
-      m_input_map.insert(
-          make_pair(osc_address, new OSCInputGroup(callback)));
+      universe_data = new OSCInputGroup(callback);
+      m_input_map.insert(make_pair(osc_address, universe_data));
+      m_input_trie.Insert(osc_address, universe_data);
     }
   } else {
     // deregister
+    m_input_trie.Remove(osc_address);
     STLRemoveAndDelete(&m_input_map, osc_address);
   }
   return true;
@@ -432,12 +452,14 @@ bool OSCNode::RegisterAddress(const string &osc_address,
 /**
  * Called by OSCDataHandler when there is new data.
  * @param osc_address the OSC address this data arrived on
+ * @param address_length the length of the OSC address.
  * @param data the DmxBuffer containing the data.
  * @param size the number of slots.
  */
-void OSCNode::SetUniverse(const string &osc_address, const uint8_t *data,
-                          unsigned int size) {
-  OSCInputGroup *universe_data = STLFindOrNull(m_input_map, osc_address);
+void OSCNode::SetUniverse(const char *osc_address, size_t address_length,
+                          const uint8_t *data, unsigned int size) {
+  OSCInputGroup *universe_data = m_input_trie.Find(osc_address,
+                                                   address_length);
   if (!universe_data)
     return;
 
@@ -450,11 +472,14 @@ void OSCNode::SetUniverse(const string &osc_address, const uint8_t *data,
 /**
  * Called by OSCDataHandler when there is new data.
  * @param osc_address the OSC address this data arrived on
+ * @param address_length the length of the OSC address.
  * @param slot the slot offset to set.
  * @param value the DMX value for the slot
  */
-void OSCNode::SetSlot(const string &osc_address, uint16_t slot, uint8_t value) {
-  OSCInputGroup *universe_data = STLFindOrNull(m_input_map, osc_address);
+void OSCNode::SetSlot(const char *osc_address, size_t address_length,
+                      uint16_t slot, uint8_t value) {
+  OSCInputGroup *universe_data = m_input_trie.Find(osc_address,
+                                                   address_length);
   if (!universe_data)
     return;
 
@@ -518,7 +543,7 @@ bool OSCNode::SendBlob(const DmxBuffer &dmx_data,
  */
 bool OSCNode::SendIndividualFloats(const DmxBuffer &dmx_data,
                                    OSCOutputGroup *group) {
-  return SendIndividualMessages(dmx_data, group, "f");
+  return SendIndividualMessages(dmx_data, group, "f", false);
 }
 
 /**
@@ -526,7 +551,7 @@ bool OSCNode::SendIndividualFloats(const DmxBuffer &dmx_data,
  */
 bool OSCNode::SendIndividualInts(const DmxBuffer &dmx_data,
                                  OSCOutputGroup *group) {
-  return SendIndividualMessages(dmx_data, group, "i");
+  return SendIndividualMessages(dmx_data, group, "i", false);
 }
 
 /**
@@ -587,19 +612,32 @@ bool OSCNode::SendMessageToTargets(lo_message message,
  * @param dmx_data the DmxBuffer to send
  * @param group the OSCOutputGroup with the targets.
  * @param osc_type the type of OSC message, either "i" or "f"
+ * @param bundle true to send the messages to each target in a single bundle.
  */
 bool OSCNode::SendIndividualMessages(const DmxBuffer &dmx_data,
                                      OSCOutputGroup *group,
-                                     const string &osc_type) {
+                                     const string &osc_type,
+                                     bool bundle) {
   bool ok = true;
   const OSCTargetVector &targets = group->targets;
 
   vector<SlotMessage> messages;
 
   // We only send the slots that have changed.
-  for (unsigned int i = 0; i < dmx_data.Size(); ++i) {
-    if (i > group->dmx.Size() || dmx_data.Get(i) != group->dmx.Get(i)) {
-      SlotMessage message = {i, lo_message_new()};
+  vector<DmxBuffer::SlotRange> changed;
+  dmx_data.Diff(group->dmx, &changed);
+  vector<DmxBuffer::SlotRange>::const_iterator range = changed.begin();
+  for (; range != changed.end(); ++range) {
+    const unsigned int end = range->offset + range->length;
+    for (unsigned int i = range->offset; i < end; ++i) {
+      SlotMessage message = {i, dmx_data.Get(i), NULL};
+      if (bundle) {
+        // The bundles take ownership of their messages, so these are built
+        // per target in SendBundles().
+        messages.push_back(message);
+        continue;
+      }
+      message.message = lo_message_new();
       if (osc_type == "i") {
         lo_message_add_int32(message.message, dmx_data.Get(i));
       } else {
@@ -610,6 +648,10 @@ bool OSCNode::SendIndividualMessages(const DmxBuffer &dmx_data,
   }
   group->dmx.Set(dmx_data);
 
+  if (bundle) {
+    return messages.empty() || SendBundles(messages, targets, osc_type);
+  }
+
   // Send all messages to each target.
   OSCTargetVector::const_iterator target_iter = targets.begin();
   for (; target_iter != targets.end(); ++target_iter) {
@@ -636,6 +678,52 @@ bool OSCNode::SendIndividualMessages(const DmxBuffer &dmx_data,
 
   return ok;
 }
+
+
+/**
+ * Send a bundle containing a message for each slot to each target.
+ * @param messages the slots to send, the message member isn't used.
+ * @param targets the list of targets to send the bundle to.
+ * @param osc_type the type of OSC message, either "i" or "f"
+ */
+bool OSCNode::SendBundles(const vector<SlotMessage> &messages,
+                          const OSCTargetVector &targets,
+                          const string &osc_type) {
+  bool ok = true;
+
+  OSCTargetVector::const_iterator target_iter = targets.begin();
+  for (; target_iter != targets.end(); ++target_iter) {
+    OLA_DEBUG << "Sending bundle to " << (*target_iter)->socket_address;
+
+    // Older versions of liblo don't copy the paths, so they need to outlive
+    // the bundle.
+    vector<string> paths;
+    paths.reserve(messages.size());
+    lo_bundle osc_bundle = lo_bundle_new(LO_TT_IMMEDIATE);
+
+    vector<SlotMessage>::const_iterator message_iter = messages.begin();
+    for (; message_iter != messages.end(); ++message_iter) {
+      lo_message message = lo_message_new();
+      if (osc_type == "i") {
+        lo_message_add_int32(message, message_iter->value);
+      } else {
+        lo_message_add_float(message, message_iter->value / 255.0f);
+      }
+
+      std::ostringstream path;
+      path << (*target_iter)->osc_address << "/" << message_iter->slot + 1;
+      paths.push_back(path.str());
+      lo_bundle_add_message(osc_bundle, paths.back().c_str(), message);
+    }
+
+    int ret = lo_send_bundle_from((*target_iter)->liblo_address,
+                                  m_osc_server,
+                                  osc_bundle);
+    ok &= (ret > 0);
+    lo_bundle_free_recursive(osc_bundle);
+  }
+  return ok;
+}
 }  // namespace osc
 }  // namespace plugin
 }  // namespace ola
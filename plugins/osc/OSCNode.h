@@ -32,6 +32,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "plugins/osc/OSCAddressTrie.h"
 #include "plugins/osc/OSCTarget.h"
 
 namespace ola {
@@ -75,6 +76,10 @@ class OSCNode {
     FORMAT_INT_INDIVIDUAL,
     FORMAT_FLOAT_ARRAY,
     FORMAT_FLOAT_INDIVIDUAL,
+    // The individual formats, with all the messages for a frame sent in one
+    // OSC bundle to each target.
+    FORMAT_INT_BUNDLE,
+    FORMAT_FLOAT_BUNDLE,
   };
 
   // The options for the OSCNode object.
@@ -104,10 +109,12 @@ class OSCNode {
   // Receiving methods
   bool RegisterAddress(const std::string &osc_address, DMXCallback *callback);
 
-  // Called by the liblo handlers.
-  void SetUniverse(const std::string &osc_address, const uint8_t *data,
-                   unsigned int size);
-  void SetSlot(const std::string &osc_address, uint16_t slot, uint8_t value);
+  // Called by the liblo handlers. The address doesn't need to be NULL
+  // terminated.
+  void SetUniverse(const char *osc_address, size_t address_length,
+                   const uint8_t *data, unsigned int size);
+  void SetSlot(const char *osc_address, size_t address_length, uint16_t slot,
+               uint8_t value);
 
   // The port OSC is listening on.
   uint16_t ListeningPort() const;
@@ -156,6 +163,7 @@ class OSCNode {
 
   struct SlotMessage {
     unsigned int slot;
+    uint8_t value;
     lo_message message;
   };
 
@@ -165,6 +173,9 @@ class OSCNode {
   lo_server m_osc_server;
   OutputGroupMap m_output_map;
   InputUniverseMap m_input_map;
+  // Used to lookup the received addresses, the groups are owned by
+  // m_input_map.
+  OSCAddressTrie<OSCInputGroup> m_input_trie;
 
   void DescriptorReady();
   bool SendBlob(const DmxBuffer &data, const OSCTargetVector &targets);
@@ -180,7 +191,11 @@ class OSCNode {
                             const OSCTargetVector &targets);
   bool SendIndividualMessages(const DmxBuffer &data,
                               OSCOutputGroup *group,
-                              const std::string &osc_type);
+                              const std::string &osc_type,
+                              bool bundle);
+  bool SendBundles(const std::vector<SlotMessage> &messages,
+                   const OSCTargetVector &targets,
+                   const std::string &osc_type);
 
   static const uint16_t DEFAULT_OSC_PORT = 7770;
   static const char OSC_PORT_VARIABLE[];
@@ -57,8 +57,10 @@ const char OSCPlugin::UDP_PORT_KEY[] = "udp_listen_port";
 
 const char OSCPlugin::BLOB_FORMAT[] = "blob";
 const char OSCPlugin::FLOAT_ARRAY_FORMAT[] = "float_array";
+const char OSCPlugin::FLOAT_BUNDLE_FORMAT[] = "individual_float_bundle";
 const char OSCPlugin::FLOAT_INDIVIDUAL_FORMAT[] = "individual_float";
 const char OSCPlugin::INT_ARRAY_FORMAT[] = "int_array";
+const char OSCPlugin::INT_BUNDLE_FORMAT[] = "individual_int_bundle";
 const char OSCPlugin::INT_INDIVIDUAL_FORMAT[] = "individual_int";
 
 /*
@@ -165,8 +167,10 @@ bool OSCPlugin::SetDefaultPreferences() {
   set<string> valid_formats;
   valid_formats.insert(BLOB_FORMAT);
   valid_formats.insert(FLOAT_ARRAY_FORMAT);
+  valid_formats.insert(FLOAT_BUNDLE_FORMAT);
   valid_formats.insert(FLOAT_INDIVIDUAL_FORMAT);
   valid_formats.insert(INT_ARRAY_FORMAT);
+  valid_formats.insert(INT_BUNDLE_FORMAT);
   valid_formats.insert(INT_INDIVIDUAL_FORMAT);
 
   SetValidator<string> format_validator = SetValidator<string>(valid_formats);
@@ -233,10 +237,14 @@ void OSCPlugin::SetDataFormat(const string &format_option,
     port_config->data_format = OSCNode::FORMAT_BLOB;
   } else if (format_option == FLOAT_ARRAY_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_FLOAT_ARRAY;
+  } else if (format_option == FLOAT_BUNDLE_FORMAT) {
+    port_config->data_format = OSCNode::FORMAT_FLOAT_BUNDLE;
   } else if (format_option == FLOAT_INDIVIDUAL_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_FLOAT_INDIVIDUAL;
   } else if (format_option == INT_ARRAY_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_INT_ARRAY;
+  } else if (format_option == INT_BUNDLE_FORMAT) {
+    port_config->data_format = OSCNode::FORMAT_INT_BUNDLE;
   } else if (format_option == INT_INDIVIDUAL_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_INT_INDIVIDUAL;
   } else {
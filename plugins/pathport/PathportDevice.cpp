@@ -38,6 +38,7 @@ namespace pathport {
 using std::ostringstream;
 using std::vector;
 
+const char PathportDevice::K_BATCH_OUTPUT_KEY[] = "batch-output";
 const char PathportDevice::K_DEFAULT_NODE_NAME[] = "ola-Pathport";
 const char PathportDevice::K_DSCP_KEY[] = "dscp";
 const char PathportDevice::K_NODE_ID_KEY[] = "node-id";
@@ -81,8 +82,12 @@ bool PathportDevice::StartHook() {
     dscp = dscp << 2;
   }
 
-  m_node = new PathportNode(m_preferences->GetValue(K_NODE_IP_KEY),
-                            product_id, dscp);
+  m_node = new PathportNode(
+      m_plugin_adaptor,
+      m_preferences->GetValue(K_NODE_IP_KEY),
+      product_id,
+      dscp,
+      m_preferences->GetValueAsBool(K_BATCH_OUTPUT_KEY));
 
   if (!m_node->Start()) {
     delete m_node;
@@ -110,6 +115,11 @@ bool PathportDevice::StartHook() {
   }
 
   m_plugin_adaptor->AddReadDescriptor(m_node->GetSocket());
+  m_socket_monitor.reset(new UDPSocketMonitor(
+      m_plugin_adaptor, m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences)));
+  m_socket_monitor->AddSocket(m_node->GetSocket());
+
   m_timeout_id = m_plugin_adaptor->RegisterRepeatingTimeout(
       ADVERTISTMENT_PERIOD_MS,
       NewCallback(this, &PathportDevice::SendArpReply));
@@ -123,6 +133,8 @@ bool PathportDevice::StartHook() {
  */
 void PathportDevice::PrePortStop() {
   m_plugin_adaptor->RemoveReadDescriptor(m_node->GetSocket());
+  m_socket_monitor->RemoveSocket(m_node->GetSocket());
+  m_socket_monitor.reset();
 
   if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
     m_plugin_adaptor->RemoveTimeout(m_timeout_id);
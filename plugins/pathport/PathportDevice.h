@@ -21,8 +21,10 @@
 #ifndef PLUGINS_PATHPORT_PATHPORTDEVICE_H_
 #define PLUGINS_PATHPORT_PATHPORTDEVICE_H_
 
+#include <memory>
 #include <string>
 #include "olad/Device.h"
+#include "olad/UDPSocketMonitor.h"
 #include "ola/io/SelectServer.h"
 #include "plugins/pathport/PathportNode.h"
 
@@ -40,6 +42,7 @@ class PathportDevice: public ola::Device {
     PathportNode *GetNode() const { return m_node; }
     bool SendArpReply();
 
+    static const char K_BATCH_OUTPUT_KEY[];
     static const char K_DEFAULT_NODE_NAME[];
     static const char K_DSCP_KEY[];
     static const char K_NODE_ID_KEY[];
@@ -55,6 +58,7 @@ class PathportDevice: public ola::Device {
     class Preferences *m_preferences;
     class PluginAdaptor *m_plugin_adaptor;
     PathportNode *m_node;
+    std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
     ola::thread::timeout_id m_timeout_id;
 
     static const char PATHPORT_DEVICE_NAME[];
@@ -49,14 +49,19 @@ using ola::Callback0;
  * @param ip_address the IP address to prefer to listen on, if NULL we choose
  * one.
  */
-PathportNode::PathportNode(const string &ip_address,
+PathportNode::PathportNode(ola::io::SelectServerInterface *ss,
+                           const string &ip_address,
                            uint32_t device_id,
-                           uint8_t dscp)
-    : m_running(false),
+                           uint8_t dscp,
+                           bool batch_output)
+    : m_ss(ss),
+      m_running(false),
+      m_batch_output(batch_output),
       m_dscp(dscp),
       m_preferred_ip(ip_address),
       m_device_id(device_id),
-      m_sequence_number(1) {
+      m_sequence_number(1),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
 }
 
 
@@ -112,6 +117,12 @@ bool PathportNode::Stop() {
   if (!m_running)
     return false;
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+  m_pending_dmx.clear();
+
   m_socket.Close();
   m_running = false;
   return true;
@@ -157,28 +168,41 @@ void PathportNode::SocketReady(UDPSocket *socket) {
     return;
   }
 
-  // TODO(simon): Handle multiple pdus here
-  pathport_packet_pdu *pdu = &packet.d.pdu;
-
   if (packet_size < static_cast<ssize_t>(sizeof(pathport_pdu_header))) {
     OLA_WARN << "Pathport packet too small to fit a pdu header";
     return;
   }
-  packet_size -= sizeof(pathport_pdu_header);
 
-  switch (NetworkToHost(pdu->head.type)) {
-    case PATHPORT_DATA:
-      HandleDmxData(pdu->d.data, packet_size);
-      break;
-    case PATHPORT_ARP_REQUEST:
-      SendArpReply();
-      break;
-    case PATHPORT_ARP_REPLY:
-      OLA_DEBUG << "Got pathport arp reply";
+  // A packet may carry several pdus, each one is padded to 4 bytes.
+  const uint8_t *ptr = packet.d.data;
+  while (packet_size >= static_cast<ssize_t>(sizeof(pathport_pdu_header))) {
+    const pathport_packet_pdu *pdu =
+        reinterpret_cast<const pathport_packet_pdu*>(ptr);
+    packet_size -= sizeof(pathport_pdu_header);
+    unsigned int pdu_size = std::min(
+        static_cast<unsigned int>((NetworkToHost(pdu->head.len) + 3) & ~3),
+        static_cast<unsigned int>(packet_size));
+
+    switch (NetworkToHost(pdu->head.type)) {
+      case PATHPORT_DATA:
+        HandleDmxData(pdu->d.data, pdu_size);
+        break;
+      case PATHPORT_ARP_REQUEST:
+        SendArpReply();
+        break;
+      case PATHPORT_ARP_REPLY:
+        OLA_DEBUG << "Got pathport arp reply";
+        break;
+      default:
+        OLA_INFO << "Unhandled pathport packet with id: " <<
+          NetworkToHost(pdu->head.type);
+    }
+
+    // pdus without a length, like ARP requests, end the packet.
+    if (pdu->head.len == 0)
       break;
-    default:
-      OLA_INFO << "Unhandled pathport packet with id: " <<
-        NetworkToHost(pdu->head.type);
+    ptr += sizeof(pathport_pdu_header) + pdu_size;
+    packet_size -= pdu_size;
   }
 }
 
@@ -272,32 +296,22 @@ bool PathportNode::SendDMX(unsigned int universe, const DmxBuffer &buffer) {
     return false;
   }
 
-  pathport_packet_s packet;
+  if (m_batch_output) {
+    // The data is sent once control returns to the event loop, by which time
+    // all the ports have been written to.
+    m_pending_dmx[universe] = buffer;
+    if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+      m_flush_timeout = m_ss->RegisterSingleTimeout(
+          0, NewSingleCallback(this, &PathportNode::FlushDMX));
+    }
+    return true;
+  }
 
-  // pad to a multiple of 4 bytes
-  unsigned int padded_size = (buffer.Size() + 3) & ~3;
+  pathport_packet_s packet;
   PopulateHeader(&packet.header, PATHPORT_DATA_GROUP);
+  PackDmxPdu(universe, buffer, packet.d.data);
 
-  pathport_packet_pdu *pdu = &packet.d.pdu;
-  pdu->head.type = HostToNetwork((uint16_t) PATHPORT_DATA);
-  pdu->head.len = HostToNetwork(
-      (uint16_t) (padded_size + sizeof(pathport_pdu_data)));
-
-  pdu->d.data.type = HostToNetwork((uint16_t) XDMX_DATA_FLAT);
-  pdu->d.data.channel_count = HostToNetwork((uint16_t) buffer.Size());
-  pdu->d.data.universe = 0;
-  pdu->d.data.start_code = 0;
-  pdu->d.data.offset = HostToNetwork(
-      (uint16_t) (DMX_UNIVERSE_SIZE * universe));
-
-  unsigned int length = padded_size;
-  buffer.Get(pdu->d.data.data, &length);
-
-  // pad data to multiple of 4 bytes
-  length = sizeof(pathport_packet_header) +
-           sizeof(pathport_pdu_header) +
-           sizeof(pathport_pdu_data) + padded_size;
-
+  unsigned int length = sizeof(pathport_packet_header) + DmxPduSize(buffer);
   return SendPacket(packet, length, m_data_addr);
 }
 
@@ -417,6 +431,74 @@ void PathportNode::HandleDmxData(const pathport_pdu_data &packet,
 }
 
 
+/*
+ * Send the queued DMX data, packing as many pdus into each packet as will fit.
+ */
+void PathportNode::FlushDMX() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+
+  pathport_packet_s packet;
+  PopulateHeader(&packet.header, PATHPORT_DATA_GROUP);
+  unsigned int offset = 0;
+
+  pending_dmx_map::const_iterator iter = m_pending_dmx.begin();
+  for (; iter != m_pending_dmx.end(); ++iter) {
+    unsigned int pdu_size = DmxPduSize(iter->second);
+    if (offset + pdu_size > sizeof(packet.d.data)) {
+      SendPacket(packet, sizeof(pathport_packet_header) + offset, m_data_addr);
+      offset = 0;
+    }
+    PackDmxPdu(iter->first, iter->second, packet.d.data + offset);
+    offset += pdu_size;
+  }
+
+  if (offset) {
+    SendPacket(packet, sizeof(pathport_packet_header) + offset, m_data_addr);
+  }
+  m_pending_dmx.clear();
+}
+
+
+/*
+ * The size of the data pdu for a buffer, including the padding.
+ */
+unsigned int PathportNode::DmxPduSize(const DmxBuffer &buffer) {
+  return (sizeof(pathport_pdu_header) + sizeof(pathport_pdu_data) +
+          ((buffer.Size() + 3) & ~3));
+}
+
+
+/*
+ * Write a data pdu for a universe.
+ * @param universe the universe the buffer is for
+ * @param buffer the DMX data
+ * @param data the location to write the pdu to, this must have at least
+ *   DmxPduSize(buffer) bytes available.
+ */
+void PathportNode::PackDmxPdu(unsigned int universe,
+                              const DmxBuffer &buffer,
+                              uint8_t *data) {
+  // pad to a multiple of 4 bytes
+  unsigned int padded_size = (buffer.Size() + 3) & ~3;
+
+  pathport_packet_pdu *pdu = reinterpret_cast<pathport_packet_pdu*>(data);
+  pdu->head.type = HostToNetwork((uint16_t) PATHPORT_DATA);
+  pdu->head.len = HostToNetwork(
+      (uint16_t) (padded_size + sizeof(pathport_pdu_data)));
+
+  pdu->d.data.type = HostToNetwork((uint16_t) XDMX_DATA_FLAT);
+  pdu->d.data.channel_count = HostToNetwork((uint16_t) buffer.Size());
+  pdu->d.data.universe = 0;
+  pdu->d.data.start_code = 0;
+  pdu->d.data.offset = HostToNetwork(
+      (uint16_t) (DMX_UNIVERSE_SIZE * universe));
+
+  unsigned int length = padded_size;
+  buffer.Get(pdu->d.data.data, &length);
+  memset(pdu->d.data.data + length, 0, padded_size - length);
+}
+
+
 /*
  * @param destination the destination to target
  */
@@ -25,6 +25,7 @@
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
@@ -36,8 +37,20 @@ namespace pathport {
 
 class PathportNode {
  public:
-    explicit PathportNode(const std::string &preferred_ip, uint32_t device_id,
-                          uint8_t dscp);
+    /**
+     * @brief Create a new PathportNode.
+     * @param ss the SelectServer to use for the batched output timer.
+     * @param preferred_ip the IP address or interface to listen on.
+     * @param device_id the pathport device id.
+     * @param dscp the DSCP value to set on outgoing packets.
+     * @param batch_output if true, the data for all universes sent during an
+     *   event loop iteration is packed into as few packets as possible.
+     */
+    PathportNode(ola::io::SelectServerInterface *ss,
+                 const std::string &preferred_ip,
+                 uint32_t device_id,
+                 uint8_t dscp,
+                 bool batch_output = false);
     ~PathportNode();
 
     bool Start();
@@ -99,6 +112,8 @@ class PathportNode {
     };
 
     typedef std::map<uint8_t, universe_handler> universe_handlers;
+    // Ordered by universe so adjacent universes end up in the same packet.
+    typedef std::map<unsigned int, DmxBuffer> pending_dmx_map;
 
     bool InitNetwork();
     void PopulateHeader(pathport_packet_header *header, uint32_t destination);
@@ -106,17 +121,25 @@ class PathportNode {
     void HandleDmxData(const pathport_pdu_data &packet,
                        unsigned int size);
     bool SendArpRequest(uint32_t destination = PATHPORT_ID_BROADCAST);
+    void FlushDMX();
+    static unsigned int DmxPduSize(const DmxBuffer &buffer);
+    static void PackDmxPdu(unsigned int universe, const DmxBuffer &buffer,
+                           uint8_t *data);
     bool SendPacket(const pathport_packet_s &packet,
                     unsigned int size,
                     ola::network::IPV4Address dest);
 
+    ola::io::SelectServerInterface *m_ss;
     bool m_running;
+    bool m_batch_output;
     uint8_t m_dscp;
     std::string m_preferred_ip;
     uint32_t m_device_id;  // the pathport device id
     uint16_t m_sequence_number;
 
     universe_handlers m_handlers;
+    pending_dmx_map m_pending_dmx;
+    ola::thread::timeout_id m_flush_timeout;
     ola::network::Interface m_interface;
     ola::network::UDPSocket m_socket;
     ola::network::IPV4Address m_config_addr;
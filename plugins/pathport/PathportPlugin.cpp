@@ -25,6 +25,7 @@
 #include "ola/math/Random.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/pathport/PathportDevice.h"
 #include "plugins/pathport/PathportPlugin.h"
 #include "plugins/pathport/PathportPluginDescription.h"
@@ -96,6 +97,8 @@ bool PathportPlugin::SetDefaultPreferences() {
     return false;
   }
 
+  save |= m_preferences->SetDefaultValue(PathportDevice::K_BATCH_OUTPUT_KEY,
+                                         BoolValidator(), false);
   save |= m_preferences->SetDefaultValue(PathportDevice::K_DSCP_KEY,
                                          UIntValidator(0, 63),
                                          DEFAULT_DSCP_VALUE);
@@ -112,6 +115,7 @@ bool PathportPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(PathportDevice::K_NODE_ID_KEY,
                                          UIntValidator(0, UINT_MAX),
                                          product_id);
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
 
   if (save) {
     m_preferences->Save();
@@ -85,9 +85,22 @@ RenardDevice::RenardDevice(AbstractPlugin *owner,
   m_widget.reset(new RenardWidget(m_dev_path, dmxOffset, channels, baudrate,
                                   RENARD_START_ADDRESS));
 
+  bool delta_updates = false;
+  if (!StringToBool(m_preferences->GetValue(DeviceDeltaUpdatesKey()),
+                    &delta_updates)) {
+    delta_updates = false;
+  }
+  unsigned int full_refresh_ms;
+  if (!StringToInt(m_preferences->GetValue(DeviceFullRefreshKey()),
+                   &full_refresh_ms)) {
+    full_refresh_ms = DEFAULT_FULL_REFRESH_MS;
+  }
+  m_widget->SetDeltaUpdates(delta_updates, full_refresh_ms);
+
   OLA_DEBUG << "DMX offset set to " << static_cast<int>(dmxOffset);
   OLA_DEBUG << "Channels set to " << static_cast<int>(channels);
   OLA_DEBUG << "Baudrate set to " << static_cast<uint32_t>(baudrate);
+  OLA_DEBUG << "Delta updates " << (delta_updates ? "enabled" : "disabled");
 }
 
 
@@ -145,6 +158,14 @@ string RenardDevice::DeviceDmxOffsetKey() const {
   return m_dev_path + "-dmx-offset";
 }
 
+string RenardDevice::DeviceDeltaUpdatesKey() const {
+  return m_dev_path + "-delta-updates";
+}
+
+string RenardDevice::DeviceFullRefreshKey() const {
+  return m_dev_path + "-full-refresh-ms";
+}
+
 void RenardDevice::SetDefaults() {
   set<unsigned int> valid_baudrates;
   valid_baudrates.insert(ola::io::BAUD_RATE_19200);
@@ -167,6 +188,12 @@ void RenardDevice::SetDefaults() {
       UIntValidator(
           0, DMX_UNIVERSE_SIZE - RenardWidget::RENARD_CHANNELS_IN_BANK),
       DEFAULT_DMX_OFFSET);
+  m_preferences->SetDefaultValue(DeviceDeltaUpdatesKey(), BoolValidator(),
+                                 false);
+  m_preferences->SetDefaultValue(
+      DeviceFullRefreshKey(),
+      UIntValidator(0, MAX_FULL_REFRESH_MS),
+      DEFAULT_FULL_REFRESH_MS);
 }
 
 /*
@@ -56,6 +56,8 @@ class RenardDevice: public ola::Device {
     std::string DeviceBaudrateKey() const;
     std::string DeviceChannelsKey() const;
     std::string DeviceDmxOffsetKey() const;
+    std::string DeviceDeltaUpdatesKey() const;
+    std::string DeviceFullRefreshKey() const;
 
     void SetDefaults();
 
@@ -65,6 +67,8 @@ class RenardDevice: public ola::Device {
     static const uint8_t DEFAULT_DMX_OFFSET;
     static const uint8_t DEFAULT_NUM_CHANNELS;
     static const uint32_t DEFAULT_BAUDRATE;
+    static const unsigned int DEFAULT_FULL_REFRESH_MS = 1000;
+    static const unsigned int MAX_FULL_REFRESH_MS = 60000;
 };
 }  // namespace renard
 }  // namespace plugin
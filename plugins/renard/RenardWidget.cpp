@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "ola/Logging.h"
 #include "ola/io/IOUtils.h"
@@ -127,6 +128,18 @@ bool RenardWidget::DetectDevice() {
 }
 
 
+/*
+ * Enable or disable delta updates.
+ */
+void RenardWidget::SetDeltaUpdates(bool enable, unsigned int full_refresh_ms) {
+  m_delta_updates = enable;
+  m_full_refresh_interval = TimeInterval(
+      static_cast<int64_t>(full_refresh_ms) * 1000);
+  m_last_frame.Reset();
+  m_last_full_refresh = TimeStamp();
+}
+
+
 /*
  * Send a DMX msg.
  */
@@ -136,7 +149,28 @@ bool RenardWidget::SendDmx(const DmxBuffer &buffer) {
                                             m_dmxOffset, buffer.Size()) -
                                    m_dmxOffset);
 
-  OLA_DEBUG << "Sending " << static_cast<int>(channels) << " channels";
+  // In delta mode, decide if this needs to be a full frame.
+  bool full_frame = true;
+  if (m_delta_updates) {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    if (m_last_full_refresh.IsSet() && channels == m_last_channels &&
+        (m_full_refresh_interval.IsZero() ||
+         now - m_last_full_refresh < m_full_refresh_interval)) {
+      full_frame = false;
+    } else {
+      m_last_full_refresh = now;
+    }
+  }
+
+  OLA_DEBUG << "Sending " << static_cast<int>(channels) << " channels"
+            << (full_frame ? "" : ", changes only");
+
+  // The banks are visited in order, so the changed ranges are walked once.
+  unsigned int range_index = 0;
+  if (!full_frame) {
+    buffer.Diff(m_last_frame, &m_changed_ranges);
+  }
 
   // Max buffer size for worst case scenario (escaping + padding)
   unsigned int bufferSize = channels * 2 + 10;
@@ -146,6 +180,13 @@ bool RenardWidget::SendDmx(const DmxBuffer &buffer) {
 
   for (unsigned int i = 0; i < channels; i++) {
     if ((i % RENARD_CHANNELS_IN_BANK) == 0) {
+      if (!full_frame && !BankChanged(i, channels, &range_index)) {
+        // Each bank is addressed separately, so unchanged ones can be
+        // skipped.
+        i += RENARD_CHANNELS_IN_BANK - 1;
+        continue;
+      }
+
       if (m_byteCounter >= RENARD_BYTES_BETWEEN_PADDING) {
         // Send PAD every 100 (or so) bytes. Note that the counter is per
         // device, so the counter should span multiple calls to SendDMX.
@@ -193,12 +234,44 @@ bool RenardWidget::SendDmx(const DmxBuffer &buffer) {
       static_cast<int>(b);
   }
 
+  if (m_delta_updates) {
+    m_last_frame = buffer;
+    m_last_channels = channels;
+  }
+
+  if (!dataToSend) {
+    return true;
+  }
+
   int bytes_sent = m_socket->Send(msg, dataToSend);
 
   OLA_DEBUG << "Sending DMX, sent " << bytes_sent << " bytes";
 
   return true;
 }
+
+
+/*
+ * Check if any channel in the bank starting at first_channel differs from the
+ * last frame sent, using the ranges found by DmxBuffer::Diff().
+ * @param range_index the first range that may overlap this bank, this is
+ *   moved past the ranges that end before the bank.
+ */
+bool RenardWidget::BankChanged(unsigned int first_channel,
+                               unsigned int channels,
+                               unsigned int *range_index) const {
+  const unsigned int start = m_dmxOffset + first_channel;
+  const unsigned int end = m_dmxOffset + std::min(
+      first_channel + RENARD_CHANNELS_IN_BANK, channels);
+  while (*range_index < m_changed_ranges.size()) {
+    const DmxBuffer::SlotRange &range = m_changed_ranges[*range_index];
+    if (range.offset + range.length > start) {
+      return range.offset < end;
+    }
+    (*range_index)++;
+  }
+  return false;
+}
 }  // namespace renard
 }  // namespace plugin
 }  // namespace ola
@@ -24,7 +24,9 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <string>
+#include <vector>
 
+#include "ola/Clock.h"
 #include "ola/io/SelectServer.h"
 #include "ola/io/Serial.h"
 #include "ola/DmxBuffer.h"
@@ -61,7 +63,9 @@ class RenardWidget {
         m_dmxOffset(dmxOffset),
         m_channels(channels),
         m_baudrate(baudrate),
-        m_startAddress(startAddress) {}
+        m_startAddress(startAddress),
+        m_delta_updates(false),
+        m_last_channels(0) {}
     virtual ~RenardWidget();
 
     // these methods are for communicating with the device
@@ -72,6 +76,11 @@ class RenardWidget {
     bool SendDmx(const DmxBuffer &buffer);
     bool DetectDevice();
 
+    // In delta mode only the banks of 8 channels that differ from the last
+    // frame sent are transmitted. Every full_refresh_ms the whole frame is
+    // sent, in case a board missed an update, 0 disables the full refresh.
+    void SetDeltaUpdates(bool enable, unsigned int full_refresh_ms);
+
     static const uint8_t RENARD_CHANNELS_IN_BANK;
 
  private:
@@ -86,6 +95,18 @@ class RenardWidget {
     uint32_t m_baudrate;
     uint8_t m_startAddress;
 
+    // delta updates
+    bool m_delta_updates;
+    ola::Clock m_clock;
+    TimeInterval m_full_refresh_interval;
+    TimeStamp m_last_full_refresh;
+    DmxBuffer m_last_frame;
+    unsigned int m_last_channels;
+    std::vector<DmxBuffer::SlotRange> m_changed_ranges;
+
+    bool BankChanged(unsigned int first_channel, unsigned int channels,
+                     unsigned int *range_index) const;
+
     static const uint8_t RENARD_COMMAND_PAD;
     static const uint8_t RENARD_COMMAND_START_PACKET;
     static const uint8_t RENARD_COMMAND_ESCAPE;
@@ -79,6 +79,8 @@ bool SandNetDevice::StartHook() {
       delete m_node;
       return false;
     }
+    m_node->SetPortCompression(
+        i, m_preferences->GetValueAsBool(CompressKey(i)));
   }
 
   if (!m_node->Start()) {
@@ -106,9 +108,14 @@ bool SandNetDevice::StartHook() {
     AddPort(port);
   }
 
+  m_socket_monitor.reset(new UDPSocketMonitor(
+      m_plugin_adaptor, m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences)));
   sockets = m_node->GetSockets();
-  for (iter = sockets.begin(); iter != sockets.end(); ++iter)
+  for (iter = sockets.begin(); iter != sockets.end(); ++iter) {
     m_plugin_adaptor->AddReadDescriptor(*iter);
+    m_socket_monitor->AddSocket(*iter);
+  }
 
   m_timeout_id = m_plugin_adaptor->RegisterRepeatingTimeout(
       ADVERTISTMENT_PERIOD_MS,
@@ -124,8 +131,11 @@ bool SandNetDevice::StartHook() {
 void SandNetDevice::PrePortStop() {
   vector<ola::network::UDPSocket*> sockets = m_node->GetSockets();
   vector<ola::network::UDPSocket*>::iterator iter;
-  for (iter = sockets.begin(); iter != sockets.end(); ++iter)
+  for (iter = sockets.begin(); iter != sockets.end(); ++iter) {
     m_plugin_adaptor->RemoveReadDescriptor(*iter);
+    m_socket_monitor->RemoveSocket(*iter);
+  }
+  m_socket_monitor.reset();
 
   if (m_timeout_id != ola::thread::INVALID_TIMEOUT) {
     m_plugin_adaptor->RemoveTimeout(m_timeout_id);
@@ -144,6 +154,16 @@ void SandNetDevice::PostPortStop() {
 }
 
 
+/*
+ * The preference that enables compressed DMX for an output port.
+ */
+string SandNetDevice::CompressKey(unsigned int port_id) {
+  ostringstream str;
+  str << "port_" << port_id << "_compress";
+  return str.str();
+}
+
+
 /*
  * Called periodically to send advertisements.
  */
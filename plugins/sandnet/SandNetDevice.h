@@ -21,10 +21,12 @@
 #ifndef PLUGINS_SANDNET_SANDNETDEVICE_H_
 #define PLUGINS_SANDNET_SANDNETDEVICE_H_
 
+#include <memory>
 #include <string>
 #include "olad/Device.h"
 #include "olad/Plugin.h"
 #include "olad/PluginAdaptor.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/sandnet/SandNetCommon.h"
 #include "plugins/sandnet/SandNetNode.h"
 
@@ -43,6 +45,8 @@ class SandNetDevice: public ola::Device {
 
     bool SendAdvertisement();
 
+    static std::string CompressKey(unsigned int port_id);
+
     static const char IP_KEY[];
     static const char NAME_KEY[];
 
@@ -55,6 +59,7 @@ class SandNetDevice: public ola::Device {
     class Preferences *m_preferences;
     class PluginAdaptor *m_plugin_adaptor;
     SandNetNode *m_node;
+    std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
     ola::thread::timeout_id m_timeout_id;
 
     static const char SANDNET_DEVICE_NAME[];
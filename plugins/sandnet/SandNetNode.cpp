@@ -63,6 +63,7 @@ SandNetNode::SandNetNode(const string &ip_address)
   for (unsigned int i = 0; i < SANDNET_MAX_PORTS; i++) {
     m_ports[i].group = 0;
     m_ports[i].universe = i;
+    m_ports[i].compress = false;
   }
 }
 
@@ -245,6 +246,20 @@ bool SandNetNode::SetPortParameters(uint8_t port_id, sandnet_port_type type,
 }
 
 
+/*
+ * Enable or disable compressed DMX for a port.
+ * @param port_id the port to change
+ * @param compress true to send compressed DMX when it's smaller
+ */
+bool SandNetNode::SetPortCompression(uint8_t port_id, bool compress) {
+  if (port_id >= SANDNET_MAX_PORTS)
+    return false;
+
+  m_ports[port_id].compress = compress;
+  return true;
+}
+
+
 /*
  * Send a Sandnet Advertisement.
  */
@@ -297,7 +312,10 @@ bool SandNetNode::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
   if (!m_running || port_id >= SANDNET_MAX_PORTS)
     return false;
 
-  // Sandnet doesn't seem to understand compressed DMX
+  // Not all Sandnet devices understand compressed DMX, so it's only sent on
+  // ports it's been enabled for.
+  if (m_ports[port_id].compress && SendCompressedDMX(port_id, buffer))
+    return true;
   return SendUncompressedDMX(port_id, buffer);
 }
 
@@ -423,6 +441,43 @@ bool SandNetNode::HandleDMX(const sandnet_dmx &dmx_packet,
 }
 
 
+/*
+ * Send a compressed DMX packet, if it's smaller than the uncompressed one.
+ * @return true if the packet was sent, false if it wasn't smaller or couldn't
+ *   be sent.
+ */
+bool SandNetNode::SendCompressedDMX(uint8_t port_id,
+                                    const DmxBuffer &buffer) {
+  sandnet_packet packet;
+  sandnet_compressed_dmx *dmx_packet = &packet.contents.compressed_dmx;
+
+  unsigned int header_size = sizeof(sandnet_compressed_dmx) -
+                             sizeof(dmx_packet->dmx);
+  unsigned int uncompressed_size = sizeof(sandnet_dmx) -
+                                   sizeof(packet.contents.dmx.dmx) +
+                                   buffer.Size();
+  if (uncompressed_size <= header_size + 1)
+    return false;
+
+  // The encoder stops once it runs out of space, so limiting the space to
+  // less than the uncompressed size gives up early on frames that don't
+  // compress.
+  unsigned int length = std::min(uncompressed_size - header_size - 1,
+                                 static_cast<unsigned int>(DMX_UNIVERSE_SIZE));
+  if (!m_encoder.Encode(buffer, dmx_packet->dmx, &length))
+    return false;
+
+  packet.opcode = HostToNetwork(static_cast<uint16_t>(SANDNET_COMPRESSED_DMX));
+  dmx_packet->group = m_ports[port_id].group;
+  dmx_packet->universe = m_ports[port_id].universe;
+  dmx_packet->port = port_id;
+  memset(dmx_packet->zero1, 0, sizeof(dmx_packet->zero1));
+  dmx_packet->two = 0x02;
+  dmx_packet->length = HostToNetwork(static_cast<uint16_t>(length));
+  return SendPacket(packet, sizeof(packet.opcode) + header_size + length);
+}
+
+
 /*
  * Send an uncompressed DMX packet
  */
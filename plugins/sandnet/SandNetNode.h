@@ -71,6 +71,7 @@ class SandNetNode {
 
     bool SetPortParameters(uint8_t port_id, sandnet_port_type type,
                            uint8_t group, uint8_t universe);
+    bool SetPortCompression(uint8_t port_id, bool compress);
     bool SendAdvertisement();
     bool SendDMX(uint8_t port_id, const DmxBuffer &buffer);
 
@@ -79,6 +80,7 @@ class SandNetNode {
       uint8_t group;
       uint8_t universe;
       sandnet_port_type type;
+      bool compress;
     } sandnet_port;
 
     typedef struct {
@@ -96,6 +98,7 @@ class SandNetNode {
 
     bool HandleDMX(const sandnet_dmx &dmx_packet,
                    unsigned int size);
+    bool SendCompressedDMX(uint8_t port_id, const DmxBuffer &buffer);
     bool SendUncompressedDMX(uint8_t port_id, const DmxBuffer &buffer);
     bool SendPacket(const sandnet_packet &packet,
                     unsigned int size,
@@ -20,6 +20,7 @@
 
 #include <string>
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/sandnet/SandNetDevice.h"
 #include "plugins/sandnet/SandNetPlugin.h"
 #include "plugins/sandnet/SandNetPluginDescription.h"
@@ -93,6 +94,11 @@ bool SandNetPlugin::SetDefaultPreferences() {
                                          StringValidator(true), "");
   save |= m_preferences->SetDefaultValue(SandNetDevice::NAME_KEY,
                                          StringValidator(), SANDNET_NODE_NAME);
+  for (unsigned int i = 0; i < SANDNET_MAX_PORTS; i++) {
+    save |= m_preferences->SetDefaultValue(SandNetDevice::CompressKey(i),
+                                           BoolValidator(), false);
+  }
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
 
   if (save) {
     m_preferences->Save();
@@ -34,6 +34,15 @@ plugins_shownet_ShowNetTester_SOURCES = \
 plugins_shownet_ShowNetTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 plugins_shownet_ShowNetTester_LDADD = $(COMMON_TESTING_LIBS) \
                                       common/libolacommon.la
+
+# BENCHMARKS
+##################################################
+benchmark_programs += plugins/shownet/ShowNetBenchmark
+
+plugins_shownet_ShowNetBenchmark_SOURCES = \
+    plugins/shownet/ShowNetNode.cpp \
+    plugins/shownet/ShowNetNodeBenchmark.cpp
+plugins_shownet_ShowNetBenchmark_LDADD = $(COMMON_BENCHMARK_LIBS)
 endif
 
 EXTRA_DIST += plugins/shownet/README.md
@@ -84,15 +84,26 @@ bool ShowNetDevice::StartHook() {
   }
 
   m_plugin_adaptor->AddReadDescriptor(m_node->GetSocket());
+  m_socket_monitor.reset(new UDPSocketMonitor(
+      m_plugin_adaptor, m_plugin_adaptor->GetExportMap(), Owner()->Name(),
+      UDPSocketMonitor::OptionsFromPreferences(m_preferences)));
+  m_socket_monitor->AddSocket(m_node->GetSocket());
   return true;
 }
 
 
+const ola::network::Interface &ShowNetDevice::GetInterface() const {
+  return m_node->GetInterface();
+}
+
+
 /*
  * Stop this device
  */
 void ShowNetDevice::PrePortStop() {
   m_plugin_adaptor->RemoveReadDescriptor(m_node->GetSocket());
+  m_socket_monitor->RemoveSocket(m_node->GetSocket());
+  m_socket_monitor.reset();
 }
 
 
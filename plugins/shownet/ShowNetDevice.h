@@ -21,8 +21,11 @@
 #ifndef PLUGINS_SHOWNET_SHOWNETDEVICE_H_
 #define PLUGINS_SHOWNET_SHOWNETDEVICE_H_
 
+#include <memory>
 #include <string>
+#include "ola/network/Interface.h"
 #include "olad/Device.h"
+#include "olad/UDPSocketMonitor.h"
 #include "olad/Plugin.h"
 
 namespace ola {
@@ -39,6 +42,7 @@ class ShowNetDevice: public ola::Device {
 
     bool AllowMultiPortPatching() const { return true; }
     std::string DeviceId() const { return "1"; }
+    const ola::network::Interface &GetInterface() const;
 
     static const char IP_KEY[];
 
@@ -51,6 +55,7 @@ class ShowNetDevice: public ola::Device {
     class Preferences *m_preferences;
     class PluginAdaptor *m_plugin_adaptor;
     class ShowNetNode *m_node;
+    std::auto_ptr<UDPSocketMonitor> m_socket_monitor;
 
     static const char SHOWNET_DEVICE_NAME[];
 };
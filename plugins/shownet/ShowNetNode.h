@@ -60,6 +60,7 @@ class ShowNetNode {
     static const uint16_t SHOWNET_MAX_UNIVERSES = 8;
 
     friend class ShowNetNodeTest;
+    friend class ShowNetNodeBenchmark;
 
  private:
     typedef struct {
@@ -0,0 +1,100 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ShowNetNodeBenchmark.cpp
+ * Microbenchmarks for packing and parsing ShowNet packets.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/Benchmark.h"
+#include "plugins/shownet/ShowNetNode.h"
+#include "plugins/shownet/ShowNetPackets.h"
+
+namespace ola {
+namespace plugin {
+namespace shownet {
+
+using ola::DmxBuffer;
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+
+/*
+ * The packing and parsing methods are private, so they're benchmarked from the
+ * friend class.
+ */
+class ShowNetNodeBenchmark {
+ public:
+  static void Pack(BenchmarkState *state) {
+    ShowNetNode node("");
+    const DmxBuffer frame = TestFrame();
+    shownet_packet packet;
+    state->StartTiming();
+    for (uint64_t i = 0; i < state->Iterations(); i++) {
+      DoNotOptimize(node.BuildCompressedPacket(&packet, UNIVERSE, frame));
+      DoNotOptimize(packet);
+    }
+    state->SetBytesProcessed(state->Iterations() * frame.Size());
+  }
+
+  static void Parse(BenchmarkState *state) {
+    ShowNetNode node("");
+    DmxBuffer output;
+    node.SetHandler(UNIVERSE, &output, NewCallback(&NoOp));
+    const DmxBuffer frame = TestFrame();
+    shownet_packet packet;
+    const unsigned int size = node.BuildCompressedPacket(&packet, UNIVERSE,
+                                                         frame);
+    state->StartTiming();
+    for (uint64_t i = 0; i < state->Iterations(); i++) {
+      node.HandlePacket(&packet, size);
+      DoNotOptimize(output);
+    }
+    state->SetBytesProcessed(state->Iterations() * frame.Size());
+  }
+
+ private:
+  static const unsigned int UNIVERSE = 1;
+
+  static DmxBuffer TestFrame() {
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    for (unsigned int i = 0; i < sizeof(data); i++) {
+      data[i] = static_cast<uint8_t>(i * 7);
+    }
+    return DmxBuffer(data, sizeof(data));
+  }
+
+  static void NoOp() {}
+};
+
+namespace {
+
+void BenchmarkShowNetPack(BenchmarkState *state) {
+  ShowNetNodeBenchmark::Pack(state);
+}
+OLA_BENCHMARK(BenchmarkShowNetPack);
+
+void BenchmarkShowNetParse(BenchmarkState *state) {
+  ShowNetNodeBenchmark::Parse(state);
+}
+OLA_BENCHMARK(BenchmarkShowNetParse);
+}  // namespace
+}  // namespace shownet
+}  // namespace plugin
+}  // namespace ola
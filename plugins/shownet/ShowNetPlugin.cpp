@@ -19,8 +19,10 @@
  */
 
 #include <string>
+#include "ola/network/InterfaceMonitor.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/UDPSocketMonitor.h"
 #include "plugins/shownet/ShowNetDevice.h"
 #include "plugins/shownet/ShowNetPlugin.h"
 #include "plugins/shownet/ShowNetPluginDescription.h"
@@ -45,6 +47,7 @@ bool ShowNetPlugin::StartHook() {
 
   if (!m_device->Start()) {
     delete m_device;
+    m_device = NULL;
     return false;
   }
 
@@ -62,12 +65,22 @@ bool ShowNetPlugin::StopHook() {
     m_plugin_adaptor->UnregisterDevice(m_device);
     bool ret = m_device->Stop();
     delete m_device;
+    m_device = NULL;
     return ret;
   }
   return true;
 }
 
 
+/*
+ * Rebind if the interface the node is using has changed.
+ */
+bool ShowNetPlugin::AffectedBy(
+    const ola::network::InterfaceChanges &changes) const {
+  return m_device && changes.Affects(m_device->GetInterface());
+}
+
+
 /*
  * return the description for this plugin
  *
@@ -91,6 +104,7 @@ bool ShowNetPlugin::SetDefaultPreferences() {
                                          StringValidator(true), "");
   save |= m_preferences->SetDefaultValue(SHOWNET_NAME_KEY, StringValidator(),
                                          SHOWNET_NODE_NAME);
+  save |= UDPSocketMonitor::SetDefaultPreferences(m_preferences);
 
   if (save) {
     m_preferences->Save();
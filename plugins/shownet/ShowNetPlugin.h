@@ -47,6 +47,7 @@ class ShowNetPlugin: public Plugin {
     bool StartHook();
     bool StopHook();
     bool SetDefaultPreferences();
+    bool AffectedBy(const ola::network::InterfaceChanges &changes) const;
 
     ShowNetDevice *m_device;
     static const char SHOWNET_NODE_NAME[];
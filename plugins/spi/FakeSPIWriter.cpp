@@ -32,18 +32,34 @@ namespace spi {
 using ola::thread::MutexLocker;
 
 bool FakeSPIWriter::WriteSPIData(const uint8_t *data, unsigned int length) {
+  SPITransfer transfer = {data, length};
+  return WriteSPIData(&transfer, 1);
+}
+
+bool FakeSPIWriter::WriteSPIData(const SPITransfer *transfers,
+                                 unsigned int count) {
   {
     MutexLocker lock(&m_mutex);
 
+    unsigned int length = 0;
+    for (unsigned int i = 0; i < count; i++) {
+      length += transfers[i].length;
+    }
+
     if (m_last_write_size != length) {
       delete[] m_data;
       m_data = new uint8_t[length];
     }
-    memcpy(m_data, data, length);
+    uint8_t *ptr = m_data;
+    for (unsigned int i = 0; i < count; i++) {
+      memcpy(ptr, transfers[i].data, transfers[i].length);
+      ptr += transfers[i].length;
+    }
 
     m_writes++;
     m_write_pending = true;
     m_last_write_size = length;
+    m_last_transfer_count = count;
   }
   m_cond_var.Signal();
 
@@ -81,6 +97,11 @@ unsigned int FakeSPIWriter::LastWriteSize() const {
   return m_last_write_size;
 }
 
+unsigned int FakeSPIWriter::LastTransferCount() const {
+  MutexLocker lock(&m_mutex);
+  return m_last_transfer_count;
+}
+
 void FakeSPIWriter::CheckDataMatches(
     const ola::testing::SourceLine &source_line,
     const uint8_t *expected,
@@ -4,6 +4,8 @@ if USE_SPI
 # This is a library which isn't coupled to olad
 lib_LTLIBRARIES += plugins/spi/libolaspicore.la plugins/spi/libolaspi.la
 plugins_spi_libolaspicore_la_SOURCES = \
+    plugins/spi/PixelConverter.cpp \
+    plugins/spi/PixelConverter.h \
     plugins/spi/SPIBackend.cpp \
     plugins/spi/SPIBackend.h \
     plugins/spi/SPIOutput.cpp \
@@ -31,11 +33,19 @@ plugins_spi_libolaspi_la_LIBADD = \
     olad/plugin_api/libolaserverplugininterface.la \
     plugins/spi/libolaspicore.la
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += plugins/spi/spi_pixel_benchmark
+plugins_spi_spi_pixel_benchmark_SOURCES = plugins/spi/spi_pixel_benchmark.cpp
+plugins_spi_spi_pixel_benchmark_LDADD = plugins/spi/libolaspicore.la \
+                                        common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += plugins/spi/SPITester
 
 plugins_spi_SPITester_SOURCES = \
+    plugins/spi/PixelConverterTest.cpp \
     plugins/spi/SPIBackendTest.cpp \
     plugins/spi/SPIOutputTest.cpp \
     plugins/spi/FakeSPIWriter.cpp \
@@ -45,6 +55,14 @@ plugins_spi_SPITester_LDADD = $(COMMON_TESTING_LIBS) \
                               plugins/spi/libolaspicore.la \
                               common/libolacommon.la
 
+# BENCHMARKS
+##################################################
+benchmark_programs += plugins/spi/SPIBenchmark
+
+plugins_spi_SPIBenchmark_SOURCES = plugins/spi/PixelConverterBenchmark.cpp
+plugins_spi_SPIBenchmark_LDADD = plugins/spi/libolaspicore.la \
+                                 $(COMMON_BENCHMARK_LIBS)
+
 endif
 
 EXTRA_DIST += plugins/spi/README.md
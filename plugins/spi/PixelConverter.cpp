@@ -0,0 +1,329 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverter.cpp
+ * Converts RGB DMX data to the wire format used by each type of pixel.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * Each format is described by an entry in FORMATS, which the scalar code
+ * works from. The SIMD versions convert several pixels at once by shuffling
+ * the bytes into place & then adding the header byte or high bit. The
+ * remaining pixels are handed to the scalar code.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif  // HAVE_CONFIG_H
+
+#include <string.h>
+#include <algorithm>
+#include "plugins/spi/PixelConverter.h"
+
+// SSSE3 isn't part of the x86-64 baseline, so we check for it at runtime.
+#if defined(__x86_64__) && (defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#include <immintrin.h>
+#define OLA_SPI_PIXEL_SSSE3 1
+#endif  // defined(__x86_64__) && ...
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OLA_SPI_PIXEL_NEON 1
+#endif  // defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+using std::min;
+
+namespace {
+
+typedef enum {
+  HEADER_NONE,
+  HEADER_P9813,  // the inverted top two bits of each color
+  HEADER_APA102,  // 3 bits of start mark & 5 bits of brightness
+} HeaderType;
+
+typedef struct {
+  uint8_t wire_bytes;
+  HeaderType header;
+  uint8_t order[RGB_BYTES_PER_PIXEL];  // the RGB byte to send in each slot
+  bool high_bit;  // send as 0x80 | (value >> 1)
+} FormatInfo;
+
+// Indexed by PixelFormat.
+const FormatInfo FORMATS[] = {
+  {3, HEADER_NONE, {0, 1, 2}, false},  // WS2801
+  {3, HEADER_NONE, {1, 0, 2}, true},  // LPD8806
+  {4, HEADER_P9813, {2, 1, 0}, false},  // P9813
+  {4, HEADER_APA102, {2, 1, 0}, false},  // APA102
+};
+
+/*
+ * For more information please visit:
+ * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
+ */
+inline uint8_t P9813Flag(const uint8_t *rgb) {
+  uint8_t flag = (rgb[0] & 0xc0) >> 6;
+  flag |= (rgb[1] & 0xc0) >> 4;
+  flag |= (rgb[2] & 0xc0) >> 2;
+  return ~flag;
+}
+
+void ScalarConvert(const FormatInfo &info, const uint8_t *rgb,
+                   unsigned int pixel_count, uint8_t *output) {
+  const uint8_t mask = info.high_bit ? 0x80 : 0;
+  const unsigned int shift = info.high_bit ? 1 : 0;
+  for (unsigned int i = 0; i < pixel_count; i++) {
+    switch (info.header) {
+      case HEADER_P9813:
+        *output++ = P9813Flag(rgb);
+        break;
+      case HEADER_APA102:
+        // Global brightness is fixed to 31, that reduces flickering.
+        *output++ = 0xff;
+        break;
+      default:
+        break;
+    }
+    for (unsigned int j = 0; j < RGB_BYTES_PER_PIXEL; j++) {
+      *output++ = mask | (rgb[info.order[j]] >> shift);
+    }
+    rgb += RGB_BYTES_PER_PIXEL;
+  }
+}
+
+typedef void (*ConvertFunction)(PixelFormat format, const uint8_t *rgb,
+                                unsigned int pixel_count, uint8_t *output);
+
+#ifdef OLA_SPI_PIXEL_SSSE3
+/*
+ * The formats with a header byte are done 4 pixels at a time, the others 5
+ * pixels at a time. In both cases all 16 bytes are loaded & stored, so we
+ * need at least 6 pixels left.
+ */
+__attribute__((target("ssse3")))
+void SSSE3ConvertPixels(PixelFormat format, const uint8_t *rgb,
+                        unsigned int pixel_count, uint8_t *output) {
+  const FormatInfo &info = FORMATS[format];
+  const unsigned int MIN_PIXELS = 6;
+  unsigned int i = 0;
+
+  if (format == PIXEL_FORMAT_WS2801) {
+    memcpy(output, rgb, pixel_count * RGB_BYTES_PER_PIXEL);
+    return;
+  } else if (format == PIXEL_FORMAT_LPD8806) {
+    const __m128i shuffle = _mm_setr_epi8(
+        1, 0, 2, 4, 3, 5, 7, 6, 8, 10, 9, 11, 13, 12, 14, -1);
+    const __m128i high_bit = _mm_set1_epi8(static_cast<char>(0x80));
+    for (; i + MIN_PIXELS <= pixel_count; i += 5) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb));
+      v = _mm_shuffle_epi8(v, shuffle);
+      // The shift moves a bit from the next byte into bit 7, but the OR
+      // sets it anyway.
+      v = _mm_or_si128(_mm_srli_epi16(v, 1), high_bit);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), v);
+      rgb += 5 * RGB_BYTES_PER_PIXEL;
+      output += 5 * info.wire_bytes;
+    }
+  } else {
+    // Each 32 bit lane is one pixel: header, B, G, R.
+    const __m128i shuffle = _mm_setr_epi8(
+        -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+    const __m128i low_byte = _mm_set1_epi32(0xff);
+    const __m128i red_bits = _mm_set1_epi32(0x03);
+    const __m128i green_bits = _mm_set1_epi32(0x0c);
+    const __m128i blue_bits = _mm_set1_epi32(0x30);
+    for (; i + MIN_PIXELS <= pixel_count; i += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb));
+      v = _mm_shuffle_epi8(v, shuffle);
+      if (info.header == HEADER_P9813) {
+        __m128i flag = _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(v, 30), red_bits),
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 20), green_bits),
+                         _mm_and_si128(_mm_srli_epi32(v, 10), blue_bits)));
+        v = _mm_or_si128(v, _mm_xor_si128(flag, low_byte));
+      } else {
+        v = _mm_or_si128(v, low_byte);
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), v);
+      rgb += 4 * RGB_BYTES_PER_PIXEL;
+      output += 4 * info.wire_bytes;
+    }
+  }
+  ScalarConvert(info, rgb, pixel_count - i, output);
+}
+#endif  // OLA_SPI_PIXEL_SSSE3
+
+#ifdef OLA_SPI_PIXEL_NEON
+/*
+ * vld3q_u8 splits 16 pixels into red, green & blue vectors, so we can work
+ * on each color & then interleave them again on the way out.
+ */
+void NeonConvertPixels(PixelFormat format, const uint8_t *rgb,
+                       unsigned int pixel_count, uint8_t *output) {
+  const FormatInfo &info = FORMATS[format];
+  const unsigned int PIXELS_PER_LOOP = 16;
+  unsigned int i = 0;
+
+  if (format == PIXEL_FORMAT_WS2801) {
+    memcpy(output, rgb, pixel_count * RGB_BYTES_PER_PIXEL);
+    return;
+  }
+
+  for (; i + PIXELS_PER_LOOP <= pixel_count; i += PIXELS_PER_LOOP) {
+    const uint8x16x3_t in = vld3q_u8(rgb);
+    if (format == PIXEL_FORMAT_LPD8806) {
+      const uint8x16_t high_bit = vdupq_n_u8(0x80);
+      uint8x16x3_t out;
+      out.val[0] = vorrq_u8(vshrq_n_u8(in.val[1], 1), high_bit);
+      out.val[1] = vorrq_u8(vshrq_n_u8(in.val[0], 1), high_bit);
+      out.val[2] = vorrq_u8(vshrq_n_u8(in.val[2], 1), high_bit);
+      vst3q_u8(output, out);
+    } else {
+      uint8x16x4_t out;
+      if (info.header == HEADER_P9813) {
+        uint8x16_t flag = vshrq_n_u8(in.val[0], 6);
+        flag = vorrq_u8(flag, vshlq_n_u8(vshrq_n_u8(in.val[1], 6), 2));
+        flag = vorrq_u8(flag, vshlq_n_u8(vshrq_n_u8(in.val[2], 6), 4));
+        out.val[0] = vmvnq_u8(flag);
+      } else {
+        out.val[0] = vdupq_n_u8(0xff);
+      }
+      out.val[1] = in.val[2];
+      out.val[2] = in.val[1];
+      out.val[3] = in.val[0];
+      vst4q_u8(output, out);
+    }
+    rgb += PIXELS_PER_LOOP * RGB_BYTES_PER_PIXEL;
+    output += PIXELS_PER_LOOP * info.wire_bytes;
+  }
+  ScalarConvert(info, rgb, pixel_count - i, output);
+}
+#endif  // OLA_SPI_PIXEL_NEON
+
+/*
+ * The SPI bytes for each value of a data byte, for 3 & 4 bit symbols.
+ */
+class WS2812Tables {
+ public:
+  WS2812Tables() {
+    for (unsigned int value = 0; value < 256; value++) {
+      uint32_t three = 0;
+      uint32_t four = 0;
+      for (int bit = 7; bit >= 0; bit--) {
+        const bool set = value & (1 << bit);
+        three = (three << 3) | (set ? 0x6 : 0x4);
+        four = (four << 4) | (set ? 0xe : 0x8);
+      }
+      for (unsigned int i = 0; i < 3; i++) {
+        three_bit[value][i] = static_cast<uint8_t>(three >> (8 * (2 - i)));
+      }
+      for (unsigned int i = 0; i < 4; i++) {
+        four_bit[value][i] = static_cast<uint8_t>(four >> (8 * (3 - i)));
+      }
+    }
+  }
+
+  uint8_t three_bit[256][3];
+  uint8_t four_bit[256][4];
+};
+
+const WS2812Tables &GetWS2812Tables() {
+  static const WS2812Tables tables;
+  return tables;
+}
+
+template <unsigned int symbol_bits>
+void EncodeWS2812(const uint8_t (*table)[symbol_bits], const uint8_t *data,
+                  unsigned int pixel_count, unsigned int slots_per_pixel,
+                  uint8_t *output) {
+  // The first two slots are swapped to get from RGB(W) to GRB(W).
+  const unsigned int order[] = {1, 0, 2, 3};
+  for (unsigned int i = 0; i < pixel_count; i++) {
+    for (unsigned int j = 0; j < slots_per_pixel; j++) {
+      memcpy(output, table[data[order[j]]], symbol_bits);
+      output += symbol_bits;
+    }
+    data += slots_per_pixel;
+  }
+}
+
+ConvertFunction ChooseConvertFunction() {
+#ifdef OLA_SPI_PIXEL_SSSE3
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {
+    return SSSE3ConvertPixels;
+  }
+#endif  // OLA_SPI_PIXEL_SSSE3
+
+#ifdef OLA_SPI_PIXEL_NEON
+  return NeonConvertPixels;
+#else
+  return ScalarConvertPixels;
+#endif  // OLA_SPI_PIXEL_NEON
+}
+}  // namespace
+
+unsigned int PixelWireBytes(PixelFormat format) {
+  return FORMATS[format].wire_bytes;
+}
+
+void ConvertPixels(PixelFormat format, const uint8_t *rgb,
+                   unsigned int pixel_count, uint8_t *output) {
+  static const ConvertFunction convert_function = ChooseConvertFunction();
+  convert_function(format, rgb, pixel_count, output);
+}
+
+void FillPixels(PixelFormat format, const uint8_t *rgb,
+                unsigned int pixel_count, uint8_t *output) {
+  if (!pixel_count) {
+    return;
+  }
+
+  // Convert one pixel, then keep doubling what's been written.
+  const unsigned int length = pixel_count * FORMATS[format].wire_bytes;
+  ScalarConvert(FORMATS[format], rgb, 1, output);
+  unsigned int written = FORMATS[format].wire_bytes;
+  while (written < length) {
+    unsigned int chunk = min(written, length - written);
+    memcpy(output + written, output, chunk);
+    written += chunk;
+  }
+}
+
+void EncodeWS2812Pixels(const uint8_t *data, unsigned int pixel_count,
+                        unsigned int slots_per_pixel,
+                        unsigned int symbol_bits, uint8_t *output) {
+  const WS2812Tables &tables = GetWS2812Tables();
+  slots_per_pixel = min(slots_per_pixel, 4u);
+  if (symbol_bits == 4) {
+    EncodeWS2812<4>(tables.four_bit, data, pixel_count, slots_per_pixel,
+                    output);
+  } else {
+    EncodeWS2812<3>(tables.three_bit, data, pixel_count, slots_per_pixel,
+                    output);
+  }
+}
+
+void ScalarConvertPixels(PixelFormat format, const uint8_t *rgb,
+                         unsigned int pixel_count, uint8_t *output) {
+  ScalarConvert(FORMATS[format], rgb, pixel_count, output);
+}
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
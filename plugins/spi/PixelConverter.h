@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverter.h
+ * Converts RGB DMX data to the wire format used by each type of pixel.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_SPI_PIXELCONVERTER_H_
+#define PLUGINS_SPI_PIXELCONVERTER_H_
+
+#include <stdint.h>
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+/**
+ * The wire formats for the pixel types we support.
+ */
+typedef enum {
+  PIXEL_FORMAT_WS2801,  /**< R, G, B */
+  PIXEL_FORMAT_LPD8806,  /**< G, R, B, each as 0x80 | (value >> 1) */
+  PIXEL_FORMAT_P9813,  /**< flag, B, G, R */
+  PIXEL_FORMAT_APA102,  /**< 0xff, B, G, R */
+} PixelFormat;
+
+/**
+ * @brief The number of RGB bytes used for each pixel.
+ */
+static const unsigned int RGB_BYTES_PER_PIXEL = 3;
+
+/**
+ * @brief Return the number of bytes a pixel uses on the wire.
+ */
+unsigned int PixelWireBytes(PixelFormat format);
+
+/**
+ * @brief Convert RGB pixels to the wire format.
+ * @param format the format to convert to.
+ * @param rgb the RGB data, 3 bytes for each pixel.
+ * @param pixel_count the number of pixels to convert.
+ * @param output the memory to write to, this must have room for
+ *   pixel_count * PixelWireBytes(format) bytes.
+ *
+ * This uses SIMD instructions where the CPU has them.
+ */
+void ConvertPixels(PixelFormat format, const uint8_t *rgb,
+                   unsigned int pixel_count, uint8_t *output);
+
+/**
+ * @brief Write the same RGB pixel to every pixel of the output.
+ * @param format the format to convert to.
+ * @param rgb the RGB data for a single pixel.
+ * @param pixel_count the number of pixels to write.
+ * @param output the memory to write to, this must have room for
+ *   pixel_count * PixelWireBytes(format) bytes.
+ */
+void FillPixels(PixelFormat format, const uint8_t *rgb,
+                unsigned int pixel_count, uint8_t *output);
+
+/**
+ * @brief Encode pixels for WS2812 & SK6812 style strings.
+ * @param data the pixel data, slots_per_pixel bytes for each pixel in RGB or
+ *   RGBW order.
+ * @param pixel_count the number of pixels to encode.
+ * @param slots_per_pixel 3 for RGB pixels, 4 for RGBW pixels.
+ * @param symbol_bits 3 or 4, the number of SPI bits used to send each data
+ *   bit.
+ * @param output the memory to write to, this must have room for
+ *   pixel_count * slots_per_pixel * symbol_bits bytes.
+ *
+ * These pixels don't have a clock line, so each data bit is sent as a pulse.
+ * A 1 bit is sent as 110 (or 1110), a 0 bit as 100 (or 1000), so the SPI
+ * speed needs to be 2.4MHz for 3 bit symbols or 3.2MHz for 4 bit symbols.
+ * The data is sent in GRB(W) order.
+ */
+void EncodeWS2812Pixels(const uint8_t *data, unsigned int pixel_count,
+                        unsigned int slots_per_pixel,
+                        unsigned int symbol_bits, uint8_t *output);
+
+/**
+ * @brief The portable version of ConvertPixels().
+ *
+ * This is what the SIMD versions are checked against.
+ */
+void ScalarConvertPixels(PixelFormat format, const uint8_t *rgb,
+                         unsigned int pixel_count, uint8_t *output);
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_SPI_PIXELCONVERTER_H_
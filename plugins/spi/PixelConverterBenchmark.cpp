@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverterBenchmark.cpp
+ * Microbenchmarks for the SPI pixel conversions.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/testing/Benchmark.h"
+#include "plugins/spi/PixelConverter.h"
+
+namespace ola {
+namespace plugin {
+namespace spi {
+
+using ola::testing::BenchmarkState;
+using ola::testing::DoNotOptimize;
+using std::vector;
+
+namespace {
+
+// A full universe of RGB pixels.
+const unsigned int PIXEL_COUNT = 170;
+
+typedef void (*ConvertFunction)(PixelFormat format, const uint8_t *rgb,
+                                unsigned int pixel_count, uint8_t *output);
+
+void RunConvert(BenchmarkState *state, ConvertFunction convert,
+                PixelFormat format) {
+  vector<uint8_t> rgb(PIXEL_COUNT * RGB_BYTES_PER_PIXEL);
+  for (unsigned int i = 0; i < rgb.size(); i++) {
+    rgb[i] = static_cast<uint8_t>(i * 7);
+  }
+  vector<uint8_t> output(PIXEL_COUNT * PixelWireBytes(format));
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    convert(format, &rgb[0], PIXEL_COUNT, &output[0]);
+    DoNotOptimize(output[0]);
+  }
+  state->SetBytesProcessed(state->Iterations() * rgb.size());
+}
+
+void BenchmarkConvertWS2801(BenchmarkState *state) {
+  RunConvert(state, ConvertPixels, PIXEL_FORMAT_WS2801);
+}
+OLA_BENCHMARK(BenchmarkConvertWS2801);
+
+void BenchmarkScalarConvertWS2801(BenchmarkState *state) {
+  RunConvert(state, ScalarConvertPixels, PIXEL_FORMAT_WS2801);
+}
+OLA_BENCHMARK(BenchmarkScalarConvertWS2801);
+
+void BenchmarkConvertLPD8806(BenchmarkState *state) {
+  RunConvert(state, ConvertPixels, PIXEL_FORMAT_LPD8806);
+}
+OLA_BENCHMARK(BenchmarkConvertLPD8806);
+
+void BenchmarkScalarConvertLPD8806(BenchmarkState *state) {
+  RunConvert(state, ScalarConvertPixels, PIXEL_FORMAT_LPD8806);
+}
+OLA_BENCHMARK(BenchmarkScalarConvertLPD8806);
+
+void BenchmarkConvertP9813(BenchmarkState *state) {
+  RunConvert(state, ConvertPixels, PIXEL_FORMAT_P9813);
+}
+OLA_BENCHMARK(BenchmarkConvertP9813);
+
+void BenchmarkScalarConvertP9813(BenchmarkState *state) {
+  RunConvert(state, ScalarConvertPixels, PIXEL_FORMAT_P9813);
+}
+OLA_BENCHMARK(BenchmarkScalarConvertP9813);
+
+void BenchmarkConvertAPA102(BenchmarkState *state) {
+  RunConvert(state, ConvertPixels, PIXEL_FORMAT_APA102);
+}
+OLA_BENCHMARK(BenchmarkConvertAPA102);
+
+void BenchmarkScalarConvertAPA102(BenchmarkState *state) {
+  RunConvert(state, ScalarConvertPixels, PIXEL_FORMAT_APA102);
+}
+OLA_BENCHMARK(BenchmarkScalarConvertAPA102);
+
+void BenchmarkEncodeWS2812(BenchmarkState *state) {
+  const unsigned int SYMBOL_BITS = 3;
+  vector<uint8_t> rgb(PIXEL_COUNT * RGB_BYTES_PER_PIXEL);
+  for (unsigned int i = 0; i < rgb.size(); i++) {
+    rgb[i] = static_cast<uint8_t>(i * 7);
+  }
+  vector<uint8_t> output(rgb.size() * SYMBOL_BITS);
+
+  state->StartTiming();
+  for (uint64_t i = 0; i < state->Iterations(); i++) {
+    EncodeWS2812Pixels(&rgb[0], PIXEL_COUNT, RGB_BYTES_PER_PIXEL, SYMBOL_BITS,
+                       &output[0]);
+    DoNotOptimize(output[0]);
+  }
+  state->SetBytesProcessed(state->Iterations() * rgb.size());
+}
+OLA_BENCHMARK(BenchmarkEncodeWS2812);
+}  // namespace
+}  // namespace spi
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,168 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * PixelConverterTest.cpp
+ * Test fixture for the pixel format conversion.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+
+#include "ola/base/Array.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/spi/PixelConverter.h"
+
+using ola::plugin::spi::ConvertPixels;
+using ola::plugin::spi::EncodeWS2812Pixels;
+using ola::plugin::spi::FillPixels;
+using ola::plugin::spi::PIXEL_FORMAT_APA102;
+using ola::plugin::spi::PIXEL_FORMAT_LPD8806;
+using ola::plugin::spi::PIXEL_FORMAT_P9813;
+using ola::plugin::spi::PIXEL_FORMAT_WS2801;
+using ola::plugin::spi::PixelFormat;
+using ola::plugin::spi::PixelWireBytes;
+using ola::plugin::spi::ScalarConvertPixels;
+
+class PixelConverterTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PixelConverterTest);
+  CPPUNIT_TEST(testConvert);
+  CPPUNIT_TEST(testFill);
+  CPPUNIT_TEST(testMatchesScalar);
+  CPPUNIT_TEST(testWS2812);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testConvert();
+  void testFill();
+  void testMatchesScalar();
+  void testWS2812();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelConverterTest);
+
+/**
+ * Check each format against known values.
+ */
+void PixelConverterTest::testConvert() {
+  const uint8_t rgb[] = {1, 10, 100, 255, 128, 0};
+  uint8_t output[8];
+
+  ConvertPixels(PIXEL_FORMAT_WS2801, rgb, 2, output);
+  OLA_ASSERT_DATA_EQUALS(rgb, arraysize(rgb), output, 6);
+
+  ConvertPixels(PIXEL_FORMAT_LPD8806, rgb, 2, output);
+  const uint8_t LPD8806[] = {0x85, 0x80, 0xB2, 0xC0, 0xFF, 0x80};
+  OLA_ASSERT_DATA_EQUALS(LPD8806, arraysize(LPD8806), output, 6);
+
+  ConvertPixels(PIXEL_FORMAT_P9813, rgb, 2, output);
+  const uint8_t P9813[] = {0xEF, 0x64, 0x0A, 0x01, 0xF4, 0, 0x80, 0xFF};
+  OLA_ASSERT_DATA_EQUALS(P9813, arraysize(P9813), output, 8);
+
+  ConvertPixels(PIXEL_FORMAT_APA102, rgb, 2, output);
+  const uint8_t APA102[] = {0xFF, 0x64, 0x0A, 0x01, 0xFF, 0, 0x80, 0xFF};
+  OLA_ASSERT_DATA_EQUALS(APA102, arraysize(APA102), output, 8);
+}
+
+/**
+ * Check FillPixels repeats the pixel & doesn't write past the end.
+ */
+void PixelConverterTest::testFill() {
+  const uint8_t rgb[] = {1, 10, 100};
+  uint8_t output[14];
+  memset(output, 0x55, sizeof(output));
+
+  FillPixels(PIXEL_FORMAT_P9813, rgb, 3, output);
+  const uint8_t EXPECTED[] = {0xEF, 0x64, 0x0A, 0x01, 0xEF, 0x64, 0x0A, 0x01,
+                              0xEF, 0x64, 0x0A, 0x01, 0x55, 0x55};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), output,
+                         sizeof(output));
+
+  FillPixels(PIXEL_FORMAT_P9813, rgb, 0, output + 12);
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), output,
+                         sizeof(output));
+}
+
+/**
+ * Check the SIMD versions match the scalar one, for every number of pixels
+ * up to a couple of full loops.
+ */
+void PixelConverterTest::testMatchesScalar() {
+  const PixelFormat formats[] = {
+    PIXEL_FORMAT_WS2801, PIXEL_FORMAT_LPD8806, PIXEL_FORMAT_P9813,
+    PIXEL_FORMAT_APA102,
+  };
+  const unsigned int MAX_PIXELS = 40;
+  // The guard bytes catch anything written past the end.
+  const unsigned int OUTPUT_SIZE = MAX_PIXELS * 4 + 16;
+
+  uint8_t rgb[MAX_PIXELS * 3];
+  for (unsigned int i = 0; i < sizeof(rgb); i++) {
+    rgb[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+
+  for (unsigned int f = 0; f < arraysize(formats); f++) {
+    for (unsigned int pixels = 0; pixels <= MAX_PIXELS; pixels++) {
+      uint8_t expected[OUTPUT_SIZE];
+      uint8_t output[OUTPUT_SIZE];
+      memset(expected, 0x55, sizeof(expected));
+      memset(output, 0x55, sizeof(output));
+
+      ScalarConvertPixels(formats[f], rgb, pixels, expected);
+      ConvertPixels(formats[f], rgb, pixels, output);
+      OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), output,
+                             sizeof(output));
+      OLA_ASSERT_EQ(static_cast<uint8_t>(0x55),
+                    output[pixels * PixelWireBytes(formats[f])]);
+    }
+  }
+}
+
+/**
+ * Check the WS2812 bit encoding, with 3 & 4 bit symbols.
+ */
+void PixelConverterTest::testWS2812() {
+  const uint8_t rgb[] = {0x0f, 0xff, 0x80};
+  uint8_t output[16];
+
+  EncodeWS2812Pixels(rgb, 1, 3, 3, output);
+  // 0xff is 110 x 8, 0x0f is 100 x 4 then 110 x 4, 0x80 is 110 then 100 x 7
+  const uint8_t THREE_BIT[] = {
+    0xdb, 0x6d, 0xb6,
+    0x92, 0x4d, 0xb6,
+    0xd2, 0x49, 0x24,
+  };
+  OLA_ASSERT_DATA_EQUALS(THREE_BIT, arraysize(THREE_BIT), output, 9);
+
+  EncodeWS2812Pixels(rgb, 1, 3, 4, output);
+  const uint8_t FOUR_BIT[] = {
+    0xee, 0xee, 0xee, 0xee,
+    0x88, 0x88, 0xee, 0xee,
+    0xe8, 0x88, 0x88, 0x88,
+  };
+  OLA_ASSERT_DATA_EQUALS(FOUR_BIT, arraysize(FOUR_BIT), output, 12);
+
+  // RGBW, the white slot is sent last.
+  const uint8_t rgbw[] = {0, 0, 0, 0xff};
+  EncodeWS2812Pixels(rgbw, 1, 4, 4, output);
+  const uint8_t RGBW[] = {
+    0x88, 0x88, 0x88, 0x88,
+    0x88, 0x88, 0x88, 0x88,
+    0x88, 0x88, 0x88, 0x88,
+    0xee, 0xee, 0xee, 0xee,
+  };
+  OLA_ASSERT_DATA_EQUALS(RGBW, arraysize(RGBW), output, 16);
+}
@@ -26,6 +26,7 @@
 #include <string.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -47,51 +48,111 @@ using std::vector;
 
 const char SPIBackendInterface::SPI_DROP_VAR[] = "spi-drops";
 const char SPIBackendInterface::SPI_DROP_VAR_KEY[] = "device";
+const char SPIBackendInterface::SPI_FRAME_TIME_VAR[] = "spi-frame-time-us";
+
+FrameBarrier::FrameBarrier(const TimeInterval &window)
+    : m_window(window),
+      m_buses(0),
+      m_arrived(0),
+      m_generation(0),
+      m_timeouts(0) {
+}
+
+void FrameBarrier::AddBus() {
+  MutexLocker lock(&m_mutex);
+  m_buses++;
+}
 
-uint8_t *HardwareBackend::OutputData::Resize(unsigned int length) {
-  if (length < m_size) {
-    m_size = length;
-    return m_data;
-  } else if (length == m_size) {
-    return m_data;
+void FrameBarrier::RemoveBus() {
+  MutexLocker lock(&m_mutex);
+  m_buses--;
+  // The buses still waiting may have been waiting for this one.
+  if (m_arrived && m_arrived >= m_buses) {
+    Release();
   }
+}
 
-  if (length <= m_actual_size) {
-    m_size = length;
-    return m_data;
+bool FrameBarrier::Wait() {
+  MutexLocker lock(&m_mutex);
+  if (m_buses <= 1) {
+    return true;
   }
 
-  delete[] m_data;
-  m_data = new uint8_t[length];
-  if (m_data) {
-    m_size = m_data ? length : 0;
-    m_actual_size = m_size;
-    memset(m_data, 0, length);
+  if (m_arrived == 0) {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    m_deadline = now + m_window;
   }
-  return m_data;
+  m_arrived++;
+  if (m_arrived >= m_buses) {
+    Release();
+    return true;
+  }
+
+  const unsigned int generation = m_generation;
+  while (generation == m_generation) {
+    if (!m_cond_var.TimedWait(&m_mutex, m_deadline) &&
+        generation == m_generation) {
+      // This is the first writer to notice, let the others go as well.
+      m_timeouts++;
+      Release();
+      return false;
+    }
+  }
+  return true;
 }
 
-void HardwareBackend::OutputData::SetPending() {
-  m_write_pending = true;
+unsigned int FrameBarrier::Timeouts() const {
+  MutexLocker lock(&m_mutex);
+  return m_timeouts;
 }
 
-void HardwareBackend::OutputData::SetLatchBytes(unsigned int latch_bytes) {
-  m_latch_bytes = latch_bytes;
+void FrameBarrier::Release() {
+  m_arrived = 0;
+  m_generation++;
+  m_cond_var.Broadcast();
 }
 
-HardwareBackend::OutputData& HardwareBackend::OutputData::operator=(
-    const HardwareBackend::OutputData &other) {
-  if (this != &other) {
-    uint8_t *data = Resize(other.m_size + other.m_latch_bytes);
-    if (data) {
-      memcpy(data, other.m_data, other.m_size);
-      memset(data + other.m_size, 0, other.m_latch_bytes);
-      m_write_pending = true;
-    } else {
-      m_write_pending = false;
-    }
+uint8_t *HardwareBackend::OutputData::Buffer::Resize(unsigned int length) {
+  if (length <= capacity) {
+    size = length;
+    return data;
   }
-  return *this;
+
+  delete[] data;
+  data = new uint8_t[length];
+  size = length;
+  capacity = length;
+  memset(data, 0, length);
+  return data;
+}
+
+uint8_t *HardwareBackend::OutputData::Checkout(unsigned int length,
+                                               unsigned int latch_bytes) {
+  uint8_t *data = m_back->Resize(length);
+  if (!data) {
+    return NULL;
+  }
+
+  if (m_back_stale) {
+    // Start from the last frame, so any slots the caller doesn't write keep
+    // their values. The writer thread only reads the front buffer, so this
+    // is safe while it's sending.
+    memcpy(data, m_front->data, std::min(length, m_front->size));
+    m_back_stale = false;
+  }
+  m_back->latch_bytes = latch_bytes;
+  return data;
+}
+
+void HardwareBackend::OutputData::SetPending() {
+  m_write_pending = true;
+}
+
+void HardwareBackend::OutputData::TakeFrame() {
+  std::swap(m_back, m_front);
+  m_write_pending = false;
+  m_back_stale = true;
 }
 
 HardwareBackend::HardwareBackend(const Options &options,
@@ -99,14 +160,20 @@ HardwareBackend::HardwareBackend(const Options &options,
                                  ExportMap *export_map)
     : m_spi_writer(writer),
       m_drop_map(NULL),
+      m_frame_time_map(NULL),
+      m_barrier(options.barrier),
       m_output_count(1 << options.gpio_pins.size()),
       m_exit(false),
-      m_gpio_pins(options.gpio_pins) {
+      m_gpio_pins(options.gpio_pins),
+      m_scheduling(options.scheduling) {
   SetupOutputs(&m_output_data);
   if (export_map) {
     m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
                                            SPI_DROP_VAR_KEY);
     (*m_drop_map)[m_spi_writer->DevicePath()] = 0;
+    m_frame_time_map = export_map->GetUIntMapVar(SPI_FRAME_TIME_VAR,
+                                                 SPI_DROP_VAR_KEY);
+    (*m_frame_time_map)[m_spi_writer->DevicePath()] = 0;
   }
 }
 
@@ -129,7 +196,14 @@ bool HardwareBackend::Init() {
     return false;
   }
 
+  // The writer thread removes the bus when it exits.
+  if (m_barrier) {
+    m_barrier->AddBus();
+  }
   if (!Start()) {
+    if (m_barrier) {
+      m_barrier->RemoveBus();
+    }
     CloseGPIOFDs();
     return false;
   }
@@ -144,11 +218,10 @@ uint8_t *HardwareBackend::Checkout(uint8_t output_id,
   }
 
   m_mutex.Lock();
-  uint8_t *output = m_output_data[output_id]->Resize(length);
+  uint8_t *output = m_output_data[output_id]->Checkout(length, latch_bytes);
   if (!output) {
     m_mutex.Unlock();
   }
-  m_output_data[output_id]->SetLatchBytes(latch_bytes);
   // We return with the Mutex locked, the caller must then call Commit()
   // coverity[LOCK]
   return output;
@@ -170,16 +243,17 @@ void HardwareBackend::Commit(uint8_t output) {
 }
 
 void *HardwareBackend::Run() {
-  Outputs outputs;
-  SetupOutputs(&outputs);
+  vector<bool> taken(m_output_count, false);
+  Clock clock;
+  ola::thread::ApplySchedulingOptions(m_scheduling,
+                                      "SPI thread for " + DevicePath());
 
   while (true) {
     m_mutex.Lock();
 
     if (m_exit) {
       m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
+      break;
     }
 
     bool action_pending = false;
@@ -196,26 +270,45 @@ void *HardwareBackend::Run() {
 
     if (m_exit) {
       m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
+      break;
     }
 
+    // Swap the buffers, rather than copying the data.
+    bool frame_taken = false;
     for (unsigned int i = 0; i < m_output_data.size(); i++) {
-      if (m_output_data[i]->IsPending()) {
-        // take a copy
-        *outputs[i] = *m_output_data[i];
-        m_output_data[i]->ResetPending();
+      taken[i] = m_output_data[i]->IsPending();
+      if (taken[i]) {
+        m_output_data[i]->TakeFrame();
+        frame_taken = true;
       }
     }
     m_mutex.Unlock();
 
-    for (unsigned int i = 0; i < outputs.size(); i++) {
-      if (outputs[i]->IsPending()) {
-        WriteOutput(i, outputs[i]);
-        outputs[i]->ResetPending();
+    if (!frame_taken) {
+      continue;
+    }
+
+    if (m_barrier) {
+      m_barrier->Wait();
+    }
+
+    TimeStamp start, end;
+    clock.CurrentTime(&start);
+    for (unsigned int i = 0; i < m_output_data.size(); i++) {
+      if (taken[i]) {
+        WriteOutput(i, m_output_data[i]);
       }
     }
+    clock.CurrentTime(&end);
+    if (m_frame_time_map) {
+      (*m_frame_time_map)[DevicePath()] = (end - start).AsInt();
+    }
+  }
+
+  if (m_barrier) {
+    m_barrier->RemoveBus();
   }
+  return NULL;
 }
 
 void HardwareBackend::SetupOutputs(Outputs *outputs) {
@@ -247,7 +340,21 @@ void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
     }
   }
 
-  m_spi_writer->WriteSPIData(output->GetData(), output->Size());
+  // The latch bytes are chained onto the data, so it's still a single write.
+  SPITransfer transfers[2];
+  transfers[0].data = output->GetData();
+  transfers[0].length = output->Size();
+  unsigned int count = 1;
+  const unsigned int latch_bytes = output->LatchBytes();
+  if (latch_bytes) {
+    if (m_latch_data.size() < latch_bytes) {
+      m_latch_data.resize(latch_bytes, 0);
+    }
+    transfers[1].data = &m_latch_data[0];
+    transfers[1].length = latch_bytes;
+    count++;
+  }
+  m_spi_writer->WriteSPIData(transfers, count);
 }
 
 bool HardwareBackend::SetupGPIO() {
@@ -305,17 +412,23 @@ SoftwareBackend::SoftwareBackend(const Options &options,
                                  ExportMap *export_map)
     : m_spi_writer(writer),
       m_drop_map(NULL),
+      m_frame_time_map(NULL),
+      m_barrier(options.barrier),
       m_write_pending(false),
       m_exit(false),
       m_sync_output(options.sync_output),
       m_output_sizes(options.outputs, 0),
       m_latch_bytes(options.outputs, 0),
       m_output(NULL),
-      m_length(0) {
+      m_length(0),
+      m_scheduling(options.scheduling) {
   if (export_map) {
     m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
                                            SPI_DROP_VAR_KEY);
     (*m_drop_map)[m_spi_writer->DevicePath()] = 0;
+    m_frame_time_map = export_map->GetUIntMapVar(SPI_FRAME_TIME_VAR,
+                                                 SPI_DROP_VAR_KEY);
+    (*m_frame_time_map)[m_spi_writer->DevicePath()] = 0;
   }
 }
 
@@ -336,7 +449,14 @@ bool SoftwareBackend::Init() {
     return false;
   }
 
+  // The writer thread removes the bus when it exits.
+  if (m_barrier) {
+    m_barrier->AddBus();
+  }
   if (!Start()) {
+    if (m_barrier) {
+      m_barrier->RemoveBus();
+    }
     return false;
   }
   return true;
@@ -407,14 +527,16 @@ void SoftwareBackend::Commit(uint8_t output) {
 void *SoftwareBackend::Run() {
   uint8_t *output_data = NULL;
   unsigned int length = 0;
+  Clock clock;
+  ola::thread::ApplySchedulingOptions(m_scheduling,
+                                      "SPI thread for " + DevicePath());
 
   while (true) {
     m_mutex.Lock();
 
     if (m_exit) {
       m_mutex.Unlock();
-      delete output_data;
-      return NULL;
+      break;
     }
 
     if (!m_write_pending) {
@@ -423,8 +545,7 @@ void *SoftwareBackend::Run() {
 
     if (m_exit) {
       m_mutex.Unlock();
-      delete[] output_data;
-      return NULL;
+      break;
     }
 
     bool write_pending = m_write_pending;
@@ -442,9 +563,25 @@ void *SoftwareBackend::Run() {
     m_mutex.Unlock();
 
     if (write_pending) {
+      if (m_barrier) {
+        m_barrier->Wait();
+      }
+
+      TimeStamp start, end;
+      clock.CurrentTime(&start);
       m_spi_writer->WriteSPIData(output_data, length);
+      clock.CurrentTime(&end);
+      if (m_frame_time_map) {
+        (*m_frame_time_map)[DevicePath()] = (end - start).AsInt();
+      }
     }
   }
+
+  if (m_barrier) {
+    m_barrier->RemoveBus();
+  }
+  delete[] output_data;
+  return NULL;
 }
 
 FakeSPIBackend::FakeSPIBackend(unsigned int outputs) {
@@ -23,8 +23,10 @@
 #define PLUGINS_SPI_SPIBACKEND_H_
 
 #include <stdint.h>
+#include <ola/Clock.h>
 #include <ola/thread/Mutex.h>
 #include <ola/thread/Thread.h>
+#include <ola/thread/Utils.h>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,59 @@ namespace ola {
 namespace plugin {
 namespace spi {
 
+/**
+ * Lines up the frames written on different SPI buses.
+ *
+ * Each SPI device has its own writer thread, so the buses are written in
+ * parallel. If the backends share a FrameBarrier, each writer waits before
+ * sending a frame until every bus has a frame ready, so the pixels on all
+ * buses latch together. So that a bus with no new data doesn't hold up the
+ * others, the writers are released once the window has passed since the
+ * first bus arrived.
+ */
+class FrameBarrier {
+ public:
+  explicit FrameBarrier(const TimeInterval &window);
+
+  /**
+   * Called by a backend before its writer thread starts.
+   */
+  void AddBus();
+
+  /**
+   * Called by a writer thread before it exits.
+   */
+  void RemoveBus();
+
+  /**
+   * Called by a writer thread with a frame ready to send.
+   * @returns true if all the buses had a frame ready, false if the window
+   *   expired.
+   */
+  bool Wait();
+
+  /**
+   * The number of times the window expired before all the buses arrived.
+   */
+  unsigned int Timeouts() const;
+
+ private:
+  const TimeInterval m_window;
+  Clock m_clock;
+  mutable ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_cond_var;
+  unsigned int m_buses;  // GUARDED_BY(m_mutex)
+  unsigned int m_arrived;  // GUARDED_BY(m_mutex)
+  unsigned int m_generation;  // GUARDED_BY(m_mutex)
+  unsigned int m_timeouts;  // GUARDED_BY(m_mutex)
+  TimeStamp m_deadline;  // GUARDED_BY(m_mutex)
+
+  void Release();
+
+  DISALLOW_COPY_AND_ASSIGN(FrameBarrier);
+};
+
+
 /**
  * The interface for all SPI Backends.
  */
@@ -54,6 +109,7 @@ class SPIBackendInterface {
  protected:
   static const char SPI_DROP_VAR[];
   static const char SPI_DROP_VAR_KEY[];
+  static const char SPI_FRAME_TIME_VAR[];
 };
 
 
@@ -67,6 +123,12 @@ class HardwareBackend : public ola::thread::Thread,
     // Which GPIO bits to use to select the output. The number of outputs
     // will be 2 ** gpio_pins.size();
     std::vector<uint16_t> gpio_pins;
+    // Applied by the output thread once it starts.
+    ola::thread::SchedulingOptions scheduling;
+    // If set, frames are lined up with the other buses using this barrier.
+    FrameBarrier *barrier;
+
+    Options() : barrier(NULL) {}
   };
 
   HardwareBackend(const Options &options,
@@ -91,36 +153,58 @@ class HardwareBackend : public ola::thread::Thread,
   void* Run();
 
  private:
+  /*
+   * The data for an output is double buffered. The DMX thread writes into the
+   * back buffer, and the writer thread sends from the front buffer. The two
+   * are swapped when the writer thread takes a frame.
+   */
   class OutputData {
    public:
     OutputData()
-        : m_data(NULL),
+        : m_back(&m_buffers[0]),
+          m_front(&m_buffers[1]),
           m_write_pending(false),
-          m_size(0),
-          m_actual_size(0),
-          m_latch_bytes(0) {
+          m_back_stale(false) {
     }
 
-    ~OutputData() { delete[] m_data; }
-
-    uint8_t *Resize(unsigned int length);
-    void SetLatchBytes(unsigned int latch_bytes);
+    // These are called with the lock held.
+    uint8_t *Checkout(unsigned int length, unsigned int latch_bytes);
     void SetPending();
     bool IsPending() const { return m_write_pending; }
-    void ResetPending() { m_write_pending = false; }
-    const uint8_t *GetData() const { return m_data; }
-    unsigned int Size() const { return m_size; }
+    void TakeFrame();
 
-    OutputData& operator=(const OutputData &other);
+    // These are only called from the writer thread.
+    const uint8_t *GetData() const { return m_front->data; }
+    unsigned int Size() const { return m_front->size; }
+    unsigned int LatchBytes() const { return m_front->latch_bytes; }
 
    private:
-    uint8_t *m_data;
+    class Buffer {
+     public:
+      Buffer() : data(NULL), size(0), capacity(0), latch_bytes(0) {}
+      ~Buffer() { delete[] data; }
+
+      uint8_t *Resize(unsigned int length);
+
+      uint8_t *data;
+      unsigned int size;
+      unsigned int capacity;
+      unsigned int latch_bytes;
+
+     private:
+      Buffer(const Buffer&);
+      Buffer& operator=(const Buffer&);
+    };
+
+    Buffer m_buffers[2];
+    Buffer *m_back;
+    Buffer *m_front;
     bool m_write_pending;
-    unsigned int m_size;
-    unsigned int m_actual_size;
-    unsigned int m_latch_bytes;
+    // True if the writer thread has taken a frame since the last Checkout.
+    bool m_back_stale;
 
     OutputData(const OutputData&);
+    OutputData& operator=(const OutputData&);
   };
 
   typedef std::vector<int> GPIOFds;
@@ -128,17 +212,22 @@ class HardwareBackend : public ola::thread::Thread,
 
   SPIWriterInterface *m_spi_writer;
   UIntMap *m_drop_map;
+  UIntMap *m_frame_time_map;
+  FrameBarrier *m_barrier;
   const uint8_t m_output_count;
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_cond_var;
   bool m_exit;
 
   Outputs m_output_data;
+  // The zeros sent for the latch bytes, only used by the writer thread.
+  std::vector<uint8_t> m_latch_data;
 
   // GPIO members
   GPIOFds m_gpio_fds;
   const std::vector<uint16_t> m_gpio_pins;
   std::vector<bool> m_gpio_pin_state;
+  const ola::thread::SchedulingOptions m_scheduling;
 
   void SetupOutputs(Outputs *outputs);
   void WriteOutput(uint8_t output_id, OutputData *output);
@@ -165,8 +254,16 @@ class SoftwareBackend : public SPIBackendInterface,
      * If set to -1, we perform an SPI write on each update.
      */
     int16_t sync_output;
+    /*
+     * Applied by the output thread once it starts.
+     */
+    ola::thread::SchedulingOptions scheduling;
+    /*
+     * If set, frames are lined up with the other buses using this barrier.
+     */
+    FrameBarrier *barrier;
 
-    Options() : outputs(1), sync_output(0) {}
+    Options() : outputs(1), sync_output(0), barrier(NULL) {}
   };
 
   SoftwareBackend(const Options &options,
@@ -193,6 +290,8 @@ class SoftwareBackend : public SPIBackendInterface,
  private:
   SPIWriterInterface *m_spi_writer;
   UIntMap *m_drop_map;
+  UIntMap *m_frame_time_map;
+  FrameBarrier *m_barrier;
   ola::thread::Mutex m_mutex;
   ola::thread::ConditionVariable m_cond_var;
   bool m_write_pending;
@@ -203,6 +302,7 @@ class SoftwareBackend : public SPIBackendInterface,
   std::vector<unsigned int> m_latch_bytes;
   uint8_t *m_output;
   unsigned int m_length;
+  const ola::thread::SchedulingOptions m_scheduling;
 };
 
 
@@ -31,7 +31,9 @@
 
 using ola::DmxBuffer;
 using ola::ExportMap;
+using ola::TimeInterval;
 using ola::plugin::spi::FakeSPIWriter;
+using ola::plugin::spi::FrameBarrier;
 using ola::plugin::spi::HardwareBackend;
 using ola::plugin::spi::SoftwareBackend;
 using ola::plugin::spi::SPIBackendInterface;
@@ -41,9 +43,12 @@ class SPIBackendTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SPIBackendTest);
   CPPUNIT_TEST(testHardwareDrops);
   CPPUNIT_TEST(testHardwareVariousFrameLengths);
+  CPPUNIT_TEST(testHardwareDoubleBuffering);
   CPPUNIT_TEST(testInvalidOutputs);
   CPPUNIT_TEST(testSoftwareDrops);
   CPPUNIT_TEST(testSoftwareVariousFrameLengths);
+  CPPUNIT_TEST(testFrameBarrier);
+  CPPUNIT_TEST(testFrameBarrierTimeout);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -60,9 +65,12 @@ class SPIBackendTest: public CppUnit::TestFixture {
 
   void testHardwareDrops();
   void testHardwareVariousFrameLengths();
+  void testHardwareDoubleBuffering();
   void testInvalidOutputs();
   void testSoftwareDrops();
   void testSoftwareVariousFrameLengths();
+  void testFrameBarrier();
+  void testFrameBarrierTimeout();
 
  private:
   ExportMap m_export_map;
@@ -226,6 +234,46 @@ void SPIBackendTest::testHardwareVariousFrameLengths() {
   m_writer.ResetWrite();
 }
 
+/**
+ * Check that slots which aren't written keep the values from the last frame,
+ * no matter which buffer the frame ends up in.
+ */
+void SPIBackendTest::testHardwareDoubleBuffering() {
+  HardwareBackend backend(HardwareBackend::Options(), &m_writer,
+                          &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA3, arraysize(DATA3), m_total_size));
+  m_writer.WaitForWrite();
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), DATA3, arraysize(DATA3));
+  OLA_ASSERT_EQ(1u, m_writer.LastTransferCount());
+  m_writer.ResetWrite();
+
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA2, arraysize(DATA2), m_total_size));
+  m_writer.WaitForWrite();
+  const uint8_t expected1[] = {
+    0xa, 0xb, 0xc, 0xd, 0xe, 0xf, 7, 8, 9, 0,
+    0xa, 0xb, 0xc, 0xd, 0xe, 0xf
+  };
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), expected1, arraysize(expected1));
+  m_writer.ResetWrite();
+
+  // This goes into the buffer which held the first frame.
+  const uint8_t data[] = {0x10, 0x11};
+  OLA_ASSERT(SendSomeData(&backend, 0, data, arraysize(data), m_total_size,
+                          4));
+  m_writer.WaitForWrite();
+  const uint8_t expected2[] = {
+    0x10, 0x11, 0xc, 0xd, 0xe, 0xf, 7, 8, 9, 0,
+    0xa, 0xb, 0xc, 0xd, 0xe, 0xf, 0, 0, 0, 0
+  };
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), expected2, arraysize(expected2));
+  // The latch bytes are sent as part of the same write.
+  OLA_ASSERT_EQ(2u, m_writer.LastTransferCount());
+  OLA_ASSERT_EQ(3u, m_writer.WriteCount());
+  m_writer.ResetWrite();
+}
+
 /**
  * Check we can't send to invalid outputs.
  */
@@ -324,3 +372,53 @@ void SPIBackendTest::testSoftwareVariousFrameLengths() {
   m_writer.CheckDataMatches(OLA_SOURCELINE(), EXPECTED3, arraysize(EXPECTED3));
   m_writer.ResetWrite();
 }
+
+/**
+ * Check that buses sharing a FrameBarrier send their frames together.
+ */
+void SPIBackendTest::testFrameBarrier() {
+  FrameBarrier barrier(TimeInterval(30, 0));
+  FakeSPIWriter writer2("Fake Device 2");
+  HardwareBackend::Options options;
+  options.barrier = &barrier;
+  HardwareBackend backend1(options, &m_writer, &m_export_map);
+  HardwareBackend backend2(options, &writer2, &m_export_map);
+  OLA_ASSERT(backend1.Init());
+  OLA_ASSERT(backend2.Init());
+
+  // The first bus waits for the second.
+  OLA_ASSERT(SendSomeData(&backend1, 0, DATA1, arraysize(DATA1),
+                          m_total_size));
+  OLA_ASSERT_EQ(0u, m_writer.WriteCount());
+
+  OLA_ASSERT(SendSomeData(&backend2, 0, DATA2, arraysize(DATA2),
+                          m_total_size));
+  m_writer.WaitForWrite();
+  writer2.WaitForWrite();
+  OLA_ASSERT_EQ(1u, m_writer.WriteCount());
+  OLA_ASSERT_EQ(1u, writer2.WriteCount());
+  m_writer.CheckDataMatches(OLA_SOURCELINE(), EXPECTED1, arraysize(EXPECTED1));
+  OLA_ASSERT_EQ(0u, barrier.Timeouts());
+}
+
+/**
+ * Check that a bus without a frame doesn't hold up the others for longer
+ * than the window.
+ */
+void SPIBackendTest::testFrameBarrierTimeout() {
+  FrameBarrier barrier(TimeInterval(0, 10000));
+  FakeSPIWriter writer2("Fake Device 2");
+  SoftwareBackend::Options options;
+  options.barrier = &barrier;
+  SoftwareBackend backend1(options, &m_writer, &m_export_map);
+  SoftwareBackend backend2(options, &writer2, &m_export_map);
+  OLA_ASSERT(backend1.Init());
+  OLA_ASSERT(backend2.Init());
+
+  OLA_ASSERT(SendSomeData(&backend1, 0, DATA1, arraysize(DATA1),
+                          m_total_size));
+  m_writer.WaitForWrite();
+  OLA_ASSERT_EQ(1u, m_writer.WriteCount());
+  OLA_ASSERT_EQ(0u, writer2.WriteCount());
+  OLA_ASSERT_EQ(1u, barrier.Timeouts());
+}
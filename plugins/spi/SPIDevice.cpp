@@ -29,6 +29,7 @@
 #include "ola/network/NetworkUtils.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
 #include "olad/Universe.h"
 #include "plugins/spi/SPIDevice.h"
 #include "plugins/spi/SPIPort.h"
@@ -56,7 +57,8 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
                      Preferences *prefs,
                      PluginAdaptor *plugin_adaptor,
                      const string &spi_device,
-                     ola::rdm::UIDAllocator *uid_allocator)
+                     ola::rdm::UIDAllocator *uid_allocator,
+                     FrameBarrier *barrier)
     : Device(owner, SPI_DEVICE_NAME),
       m_preferences(prefs),
       m_plugin_adaptor(plugin_adaptor),
@@ -80,6 +82,9 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
   if (backend_type == HARDWARE_BACKEND) {
     HardwareBackend::Options options;
     PopulateHardwareBackendOptions(&options);
+    options.scheduling = ThreadPreferences::Load(m_preferences,
+                                                 ThreadPrefix());
+    options.barrier = barrier;
     m_backend.reset(
         new HardwareBackend(options, m_writer.get(),
                             plugin_adaptor->GetExportMap()));
@@ -94,6 +99,9 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
 
     SoftwareBackend::Options options;
     PopulateSoftwareBackendOptions(&options);
+    options.scheduling = ThreadPreferences::Load(m_preferences,
+                                                 ThreadPrefix());
+    options.barrier = barrier;
     m_backend.reset(
         new SoftwareBackend(options, m_writer.get(),
                             plugin_adaptor->GetExportMap()));
@@ -102,8 +110,26 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
              << " ports";
   }
 
+  // The WS2812 reset gap is sent as zeros, so work out how many bytes that
+  // takes at this SPI speed.
+  uint8_t ws2812_symbol_bits = 3;
+  if (!StringToInt(m_preferences->GetValue(WS2812SymbolBitsKey()),
+                   &ws2812_symbol_bits)) {
+    OLA_WARN << "Invalid integer value for " << WS2812SymbolBitsKey();
+  }
+  unsigned int ws2812_reset_time = 300;
+  if (!StringToInt(m_preferences->GetValue(WS2812ResetTimeKey()),
+                   &ws2812_reset_time)) {
+    OLA_WARN << "Invalid integer value for " << WS2812ResetTimeKey();
+  }
+  const unsigned int ws2812_reset_bytes = static_cast<unsigned int>(
+      (static_cast<uint64_t>(writer_options.spi_speed) * ws2812_reset_time +
+       7999999) / 8000000);
+
   for (uint8_t i = 0; i < port_count; i++) {
     SPIOutput::Options spi_output_options(i, m_spi_device_name);
+    spi_output_options.ws2812_symbol_bits = ws2812_symbol_bits;
+    spi_output_options.ws2812_reset_bytes = ws2812_reset_bytes;
 
     if (m_preferences->HasKey(DeviceLabelKey(i))) {
       spi_output_options.device_label =
@@ -204,6 +230,18 @@ string SPIDevice::GPIOPinKey() const {
   return m_spi_device_name + "-gpio-pin";
 }
 
+string SPIDevice::WS2812SymbolBitsKey() const {
+  return m_spi_device_name + "-ws2812-symbol-bits";
+}
+
+string SPIDevice::WS2812ResetTimeKey() const {
+  return m_spi_device_name + "-ws2812-reset-time";
+}
+
+string SPIDevice::ThreadPrefix() const {
+  return m_spi_device_name + "-";
+}
+
 string SPIDevice::DeviceLabelKey(uint8_t port) const {
   return GetPortKey("device-label", port);
 }
@@ -239,6 +277,11 @@ void SPIDevice::SetDefaults() {
   m_preferences->SetDefaultValue(SPICEKey(), BoolValidator(), false);
   m_preferences->SetDefaultValue(PortCountKey(), UIntValidator(1, 8), 1);
   m_preferences->SetDefaultValue(SyncPortKey(), IntValidator(-2, 8), 0);
+  m_preferences->SetDefaultValue(WS2812SymbolBitsKey(), UIntValidator(3, 4),
+                                 3);
+  m_preferences->SetDefaultValue(WS2812ResetTimeKey(), UIntValidator(50, 1000),
+                                 300);
+  ThreadPreferences::SetDefaults(m_preferences, ThreadPrefix());
   m_preferences->Save();
 }
 
@@ -43,7 +43,8 @@ class SPIDevice: public ola::Device {
             class Preferences *preferences,
             class PluginAdaptor *plugin_adaptor,
             const std::string &spi_device,
-            ola::rdm::UIDAllocator *uid_allocator);
+            ola::rdm::UIDAllocator *uid_allocator,
+            FrameBarrier *barrier = NULL);
 
   std::string DeviceId() const;
 
@@ -70,6 +71,10 @@ class SPIDevice: public ola::Device {
   std::string PortCountKey() const;
   std::string SyncPortKey() const;
   std::string GPIOPinKey() const;
+  std::string WS2812SymbolBitsKey() const;
+  std::string WS2812ResetTimeKey() const;
+  // The prefix for the ThreadPreferences keys.
+  std::string ThreadPrefix() const;
 
   // Per port options
   std::string DeviceLabelKey(uint8_t port) const;
@@ -46,6 +46,7 @@
 #include "ola/rdm/UIDSet.h"
 #include "ola/stl/STLUtils.h"
 
+#include "plugins/spi/PixelConverter.h"
 #include "plugins/spi/SPIBackend.h"
 #include "plugins/spi/SPIOutput.h"
 
@@ -87,6 +88,8 @@ const uint16_t SPIOutput::WS2801_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::LPD8806_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::P9813_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::APA102_SLOTS_PER_PIXEL = 3;
+const uint16_t SPIOutput::WS2812_SLOTS_PER_PIXEL = 3;
+const uint16_t SPIOutput::SK6812_RGBW_SLOTS_PER_PIXEL = 4;
 
 // Number of bytes that each pixel uses on the SPI wires
 // (if it differs from 1:1 with colors)
@@ -174,6 +177,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
       m_output_number(options.output_number),
       m_uid(uid),
       m_pixel_count(options.pixel_count),
+      m_ws2812_symbol_bits(options.ws2812_symbol_bits == 4 ? 4 : 3),
+      m_ws2812_reset_bytes(options.ws2812_reset_bytes),
       m_device_label(options.device_label),
       m_start_address(1),
       m_identify_mode(false) {
@@ -196,6 +201,15 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
                                       "APA102 Individual Control"));
   personalities.push_back(Personality(APA102_SLOTS_PER_PIXEL,
                                       "APA102 Combined Control"));
+  personalities.push_back(Personality(m_pixel_count * WS2812_SLOTS_PER_PIXEL,
+                                      "WS2812 Individual Control"));
+  personalities.push_back(Personality(WS2812_SLOTS_PER_PIXEL,
+                                      "WS2812 Combined Control"));
+  personalities.push_back(
+      Personality(m_pixel_count * SK6812_RGBW_SLOTS_PER_PIXEL,
+                  "SK6812 RGBW Individual Control"));
+  personalities.push_back(Personality(SK6812_RGBW_SLOTS_PER_PIXEL,
+                                      "SK6812 RGBW Combined Control"));
   m_personality_collection.reset(new PersonalityCollection(personalities));
   m_personality_manager.reset(new PersonalityManager(
       m_personality_collection.get()));
@@ -316,6 +330,18 @@ bool SPIOutput::InternalWriteDMX(const DmxBuffer &buffer) {
     case 8:
       CombinedAPA102Control(buffer);
       break;
+    case 9:
+      IndividualWS2812Control(buffer, WS2812_SLOTS_PER_PIXEL);
+      break;
+    case 10:
+      CombinedWS2812Control(buffer, WS2812_SLOTS_PER_PIXEL);
+      break;
+    case 11:
+      IndividualWS2812Control(buffer, SK6812_RGBW_SLOTS_PER_PIXEL);
+      break;
+    case 12:
+      CombinedWS2812Control(buffer, SK6812_RGBW_SLOTS_PER_PIXEL);
+      break;
     default:
       break;
   }
@@ -352,17 +378,15 @@ void SPIOutput::CombinedWS2801Control(const DmxBuffer &buffer) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(output + (i * WS2801_SLOTS_PER_PIXEL), pixel_data,
-           pixel_data_length);
-  }
+  FillPixels(PIXEL_FORMAT_WS2801, pixel_data, m_pixel_count, output);
   m_backend->Commit(m_output_number);
 }
 
 void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
   const uint8_t latch_bytes = (m_pixel_count + 31) / 32;
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < LPD8806_SLOTS_PER_PIXEL) {
+  const unsigned int slots = AvailableSlots(buffer);
+  if (slots < LPD8806_SLOTS_PER_PIXEL) {
     // not even 3 bytes of data, don't bother updating
     return;
   }
@@ -375,19 +399,11 @@ void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
   if (!output)
     return;
 
-  const unsigned int length = std::min(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
-                                       buffer.Size() - first_slot);
-
-  for (unsigned int i = 0; i < length / LPD8806_SLOTS_PER_PIXEL; i++) {
-    // Convert RGB to GRB
-    unsigned int offset = first_slot + i * LPD8806_SLOTS_PER_PIXEL;
-    uint8_t r = buffer.Get(offset);
-    uint8_t g = buffer.Get(offset + 1);
-    uint8_t b = buffer.Get(offset + 2);
-    output[i * LPD8806_SLOTS_PER_PIXEL] = 0x80 | (g >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 1] = 0x80 | (r >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 2] = 0x80 | (b >> 1);
-  }
+  const unsigned int pixels = std::min(
+      static_cast<unsigned int>(m_pixel_count),
+      slots / LPD8806_SLOTS_PER_PIXEL);
+  ConvertPixels(PIXEL_FORMAT_LPD8806, buffer.GetRaw() + first_slot, pixels,
+                output);
   m_backend->Commit(m_output_number);
 }
 
@@ -403,21 +419,12 @@ void SPIOutput::CombinedLPD8806Control(const DmxBuffer &buffer) {
     return;
   }
 
-  // The leds are GRB format so convert here
-  uint8_t temp = pixel_data[1];
-  pixel_data[1] = pixel_data[0];
-  pixel_data[0] = temp;
-
   const unsigned int length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
   uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
   if (!output)
     return;
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    for (unsigned int j = 0; j < LPD8806_SLOTS_PER_PIXEL; j++) {
-      output[i * LPD8806_SLOTS_PER_PIXEL + j] = 0x80 | (pixel_data[j] >> 1);
-    }
-  }
+  FillPixels(PIXEL_FORMAT_LPD8806, pixel_data, m_pixel_count, output);
   m_backend->Commit(m_output_number);
 }
 
@@ -426,7 +433,8 @@ void SPIOutput::IndividualP9813Control(const DmxBuffer &buffer) {
   // the end
   const uint8_t latch_bytes = 3 * P9813_SPI_BYTES_PER_PIXEL;
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < P9813_SLOTS_PER_PIXEL) {
+  const unsigned int slots = AvailableSlots(buffer);
+  if (slots < P9813_SLOTS_PER_PIXEL) {
     // not even 3 bytes of data, don't bother updating
     return;
   }
@@ -441,71 +449,44 @@ void SPIOutput::IndividualP9813Control(const DmxBuffer &buffer) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to P9813 Pixel
-    unsigned int offset = first_slot + i * P9813_SLOTS_PER_PIXEL;
-    // We need to avoid the first 4 bytes of the buffer since that acts as a
-    // start of frame delimiter
-    unsigned int spi_offset = (i + 1) * P9813_SPI_BYTES_PER_PIXEL;
-    uint8_t r = 0;
-    uint8_t b = 0;
-    uint8_t g = 0;
-    if (buffer.Size() - offset >= P9813_SLOTS_PER_PIXEL) {
-      r = buffer.Get(offset);
-      g = buffer.Get(offset + 1);
-      b = buffer.Get(offset + 2);
-    }
-    output[spi_offset] = P9813CreateFlag(r, g, b);
-    output[spi_offset + 1] = b;
-    output[spi_offset + 2] = g;
-    output[spi_offset + 3] = r;
-  }
+  // We need to avoid the first 4 bytes of the buffer since that acts as a
+  // start of frame delimiter
+  output += P9813_SPI_BYTES_PER_PIXEL;
+  const unsigned int pixels = std::min(
+      static_cast<unsigned int>(m_pixel_count),
+      slots / P9813_SLOTS_PER_PIXEL);
+  ConvertPixels(PIXEL_FORMAT_P9813, buffer.GetRaw() + first_slot, pixels,
+                output);
+
+  // Pixels we don't have data for are turned off.
+  const uint8_t off[P9813_SLOTS_PER_PIXEL] = {0, 0, 0};
+  FillPixels(PIXEL_FORMAT_P9813, off, m_pixel_count - pixels,
+             output + pixels * P9813_SPI_BYTES_PER_PIXEL);
   m_backend->Commit(m_output_number);
 }
 
 void SPIOutput::CombinedP9813Control(const DmxBuffer &buffer) {
   const uint8_t latch_bytes = 3 * P9813_SPI_BYTES_PER_PIXEL;
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  const unsigned int slots = AvailableSlots(buffer);
 
-  if (buffer.Size() - first_slot < P9813_SLOTS_PER_PIXEL) {
+  if (slots < P9813_SLOTS_PER_PIXEL) {
     OLA_INFO << "Insufficient DMX data, required " << P9813_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
+             << ", got " << slots;
     return;
   }
 
-  uint8_t pixel_data[P9813_SPI_BYTES_PER_PIXEL];
-  pixel_data[3] = buffer.Get(first_slot);  // Get Red
-  pixel_data[2] = buffer.Get(first_slot + 1);  // Get Green
-  pixel_data[1] = buffer.Get(first_slot + 2);  // Get Blue
-  pixel_data[0] = P9813CreateFlag(pixel_data[3], pixel_data[2],
-                                  pixel_data[1]);
-
   const unsigned int length = m_pixel_count * P9813_SPI_BYTES_PER_PIXEL;
   uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
   if (!output) {
     return;
   }
 
-  for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(&output[(i + 1) * P9813_SPI_BYTES_PER_PIXEL], pixel_data,
-           P9813_SPI_BYTES_PER_PIXEL);
-  }
+  FillPixels(PIXEL_FORMAT_P9813, buffer.GetRaw() + first_slot, m_pixel_count,
+             output + P9813_SPI_BYTES_PER_PIXEL);
   m_backend->Commit(m_output_number);
 }
 
-/**
- * For more information please visit:
- * https://github.com/CoolNeon/elinux-tcl/blob/master/README.txt
- */
-uint8_t SPIOutput::P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue) {
-  uint8_t flag = 0;
-  flag =  (red & 0xc0) >> 6;
-  flag |= (green & 0xc0) >> 4;
-  flag |= (blue & 0xc0) >> 2;
-  return ~flag;
-}
-
-
 void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
   // some detailed information on the protocol:
   // https://cpldcpu.wordpress.com/2014/11/30/understanding-the-apa102-superled/
@@ -516,11 +497,12 @@ void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
 
   // calculate DMX-start-address
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  const unsigned int slots = AvailableSlots(buffer);
 
   // only do something if at least 1 pixel can be updated..
-  if (buffer.Size() - first_slot < APA102_SLOTS_PER_PIXEL) {
+  if (slots < APA102_SLOTS_PER_PIXEL) {
     OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
+             << ", got " << slots;
     return;
   }
 
@@ -545,34 +527,19 @@ void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
   if (m_output_number == 0) {
     // set APA102_START_FRAME_BYTES to zero
     memset(output, 0, APA102_START_FRAME_BYTES);
+    output += APA102_START_FRAME_BYTES;
   }
 
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    // Convert RGB to APA102 Pixel
-    uint16_t offset = first_slot + (i * APA102_SLOTS_PER_PIXEL);
+  const unsigned int pixels = std::min(
+      static_cast<unsigned int>(m_pixel_count),
+      slots / APA102_SLOTS_PER_PIXEL);
+  ConvertPixels(PIXEL_FORMAT_APA102, buffer.GetRaw() + first_slot, pixels,
+                output);
 
-
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    // only skip APA102_START_FRAME_BYTES on the first port!!
-    if (m_output_number == 0) {
-      // We need to avoid the first 4 bytes of the buffer since that acts as a
-      // start of frame delimiter
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    // set pixel data
-    // first Byte contains:
-    // 3 bits start mark (111) + 5 bits global brightness
-    // set global brightness fixed to 31 --> that reduces flickering
-    // that can be written as 0xE0 & 0x1F
-    output[spi_offset] = 0xFF;
-    // only write pixel data if buffer has complete data for this pixel:
-    if ((buffer.Size() - offset) >= APA102_SLOTS_PER_PIXEL) {
-      // Convert RGB to APA102 Pixel
-      // skip spi_offset + 0 (is already set)
-      output[spi_offset + 1] = buffer.Get(offset + 2);  // blue
-      output[spi_offset + 2] = buffer.Get(offset + 1);  // green
-      output[spi_offset + 3] = buffer.Get(offset);      // red
-    }
+  // Pixels without complete data keep their colors, but still need the
+  // start mark.
+  for (unsigned int i = pixels; i < m_pixel_count; i++) {
+    output[i * APA102_SPI_BYTES_PER_PIXEL] = 0xFF;
   }
 
   // write output back
@@ -584,11 +551,12 @@ void SPIOutput::CombinedAPA102Control(const DmxBuffer &buffer) {
 
   // calculate DMX-start-address
   const uint16_t first_slot = m_start_address - 1;  // 0 offset
+  const unsigned int slots = AvailableSlots(buffer);
 
   // check if enough data is there.
-  if (buffer.Size() - first_slot < APA102_SLOTS_PER_PIXEL) {
+  if (slots < APA102_SLOTS_PER_PIXEL) {
     OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
-             << ", got " << buffer.Size() - first_slot;
+             << ", got " << slots;
     return;
   }
 
@@ -613,29 +581,90 @@ void SPIOutput::CombinedAPA102Control(const DmxBuffer &buffer) {
   if (m_output_number == 0) {
     // set APA102_START_FRAME_BYTES to zero
     memset(output, 0, APA102_START_FRAME_BYTES);
+    output += APA102_START_FRAME_BYTES;
   }
 
-  // create Pixel Data
-  uint8_t pixel_data[APA102_SPI_BYTES_PER_PIXEL];
-  pixel_data[0] = 0xFF;
-  pixel_data[1] = buffer.Get(first_slot + 2);  // Get Blue
-  pixel_data[2] = buffer.Get(first_slot + 1);  // Get Green
-  pixel_data[3] = buffer.Get(first_slot);      // Get Red
-
   // set all pixel to same value
-  for (uint16_t i = 0; i < m_pixel_count; i++) {
-    uint16_t spi_offset = (i * APA102_SPI_BYTES_PER_PIXEL);
-    if (m_output_number == 0) {
-      spi_offset += APA102_START_FRAME_BYTES;
-    }
-    memcpy(&output[spi_offset], pixel_data,
-           APA102_SPI_BYTES_PER_PIXEL);
-  }
+  FillPixels(PIXEL_FORMAT_APA102, buffer.GetRaw() + first_slot, m_pixel_count,
+             output);
 
   // write output back...
   m_backend->Commit(m_output_number);
 }
 
+/**
+ * WS2812 & SK6812 pixels. The reset gap at the end of each frame is sent as
+ * latch bytes by the backend.
+ */
+void SPIOutput::IndividualWS2812Control(const DmxBuffer &buffer,
+                                        unsigned int slots_per_pixel) {
+  const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  const unsigned int slots = AvailableSlots(buffer);
+  if (slots < slots_per_pixel) {
+    // not even 1 pixel of data, don't bother updating
+    return;
+  }
+
+  const unsigned int pixel_bytes = slots_per_pixel * m_ws2812_symbol_bits;
+  uint8_t *output = m_backend->Checkout(m_output_number,
+                                        m_pixel_count * pixel_bytes,
+                                        m_ws2812_reset_bytes);
+  if (!output) {
+    return;
+  }
+
+  const unsigned int pixels = std::min(m_pixel_count,
+                                       slots / slots_per_pixel);
+  EncodeWS2812Pixels(buffer.GetRaw() + first_slot, pixels, slots_per_pixel,
+                     m_ws2812_symbol_bits, output);
+
+  // An all zero buffer would look like a reset, so pixels we don't have data
+  // for are turned off.
+  const uint8_t off[] = {0, 0, 0, 0};
+  for (unsigned int i = pixels; i < m_pixel_count; i++) {
+    EncodeWS2812Pixels(off, 1, slots_per_pixel, m_ws2812_symbol_bits,
+                       output + i * pixel_bytes);
+  }
+  m_backend->Commit(m_output_number);
+}
+
+void SPIOutput::CombinedWS2812Control(const DmxBuffer &buffer,
+                                      unsigned int slots_per_pixel) {
+  const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  const unsigned int slots = AvailableSlots(buffer);
+  if (slots < slots_per_pixel) {
+    OLA_INFO << "Insufficient DMX data, required " << slots_per_pixel
+             << ", got " << slots;
+    return;
+  }
+
+  const unsigned int pixel_bytes = slots_per_pixel * m_ws2812_symbol_bits;
+  uint8_t *output = m_backend->Checkout(m_output_number,
+                                        m_pixel_count * pixel_bytes,
+                                        m_ws2812_reset_bytes);
+  if (!output) {
+    return;
+  }
+
+  // Encode the first pixel & copy it to the rest.
+  if (m_pixel_count) {
+    EncodeWS2812Pixels(buffer.GetRaw() + first_slot, 1, slots_per_pixel,
+                       m_ws2812_symbol_bits, output);
+  }
+  for (unsigned int i = 1; i < m_pixel_count; i++) {
+    memcpy(output + i * pixel_bytes, output, pixel_bytes);
+  }
+  m_backend->Commit(m_output_number);
+}
+
+/**
+ * The number of slots from the start address onwards.
+ */
+unsigned int SPIOutput::AvailableSlots(const DmxBuffer &buffer) const {
+  const unsigned int first_slot = m_start_address - 1;  // 0 offset
+  return buffer.Size() > first_slot ? buffer.Size() - first_slot : 0;
+}
+
 /**
  * Calculate Latch Bytes for APA102:
  * Use at least half the pixel count bits
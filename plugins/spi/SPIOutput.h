@@ -42,11 +42,17 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
     std::string device_label;
     uint8_t pixel_count;
     uint8_t output_number;
+    // The number of SPI bits used for each WS2812 data bit, 3 or 4.
+    uint8_t ws2812_symbol_bits;
+    // The number of zero bytes sent after WS2812 data, to reset the pixels.
+    unsigned int ws2812_reset_bytes;
 
     explicit Options(uint8_t output_number, const std::string &spi_device_name)
         : device_label("SPI Device - " + spi_device_name),
           pixel_count(25),  // For the https://www.adafruit.com/products/738
-          output_number(output_number) {
+          output_number(output_number),
+          ws2812_symbol_bits(3),
+          ws2812_reset_bytes(90) {  // 300us at 2.4MHz
     }
   };
 
@@ -94,6 +100,8 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   std::string m_spi_device_name;
   const ola::rdm::UID m_uid;
   const unsigned int m_pixel_count;
+  const uint8_t m_ws2812_symbol_bits;
+  const unsigned int m_ws2812_reset_bytes;
   std::string m_device_label;
   uint16_t m_start_address;  // starts from 1
   bool m_identify_mode;
@@ -113,6 +121,10 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   void CombinedP9813Control(const DmxBuffer &buffer);
   void IndividualAPA102Control(const DmxBuffer &buffer);
   void CombinedAPA102Control(const DmxBuffer &buffer);
+  void IndividualWS2812Control(const DmxBuffer &buffer,
+                               unsigned int slots_per_pixel);
+  void CombinedWS2812Control(const DmxBuffer &buffer,
+                             unsigned int slots_per_pixel);
 
   unsigned int LPD8806BufferSize() const;
   void WriteSPIData(const uint8_t *data, unsigned int length);
@@ -172,7 +184,7 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
       const ola::rdm::RDMRequest *request);
 
   // Helpers
-  uint8_t P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue);
+  unsigned int AvailableSlots(const DmxBuffer &buffer) const;
   static uint8_t CalculateAPA102LatchBytes(uint16_t pixel_count);
 
   static const uint8_t SPI_MODE;
@@ -186,6 +198,8 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   static const uint16_t APA102_SLOTS_PER_PIXEL;
   static const uint16_t APA102_SPI_BYTES_PER_PIXEL;
   static const uint16_t APA102_START_FRAME_BYTES;
+  static const uint16_t WS2812_SLOTS_PER_PIXEL;
+  static const uint16_t SK6812_RGBW_SLOTS_PER_PIXEL;
 
   static const ola::rdm::ResponderOps<SPIOutput>::ParamHandler
       PARAM_HANDLERS[];
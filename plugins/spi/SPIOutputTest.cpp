@@ -47,6 +47,8 @@ class SPIOutputTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testCombinedP9813Control);
   CPPUNIT_TEST(testIndividualAPA102Control);
   CPPUNIT_TEST(testCombinedAPA102Control);
+  CPPUNIT_TEST(testIndividualWS2812Control);
+  CPPUNIT_TEST(testCombinedSK6812Control);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +67,8 @@ class SPIOutputTest: public CppUnit::TestFixture {
   void testCombinedP9813Control();
   void testIndividualAPA102Control();
   void testCombinedAPA102Control();
+  void testIndividualWS2812Control();
+  void testCombinedSK6812Control();
 
  private:
   UID m_uid;
@@ -738,3 +742,79 @@ void SPIOutputTest::testCombinedAPA102Control() {
   // check if the output writes are 1
   OLA_ASSERT_EQ(1u, backend.Writes(1));
 }
+
+
+/**
+ * Test DMX writes in the individual WS2812 mode.
+ */
+void SPIOutputTest::testIndividualWS2812Control() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  options.ws2812_symbol_bits = 4;
+  options.ws2812_reset_bytes = 3;
+  SPIOutput output(m_uid, &backend, options);
+  output.SetPersonality(9);
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  // The second pixel doesn't have data, so it's turned off.
+  buffer.SetFromString("255,0,15");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED0[] = {
+    0x88, 0x88, 0x88, 0x88, 0xee, 0xee, 0xee, 0xee, 0x88, 0x88, 0xee, 0xee,
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88,
+    0, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED0, arraysize(EXPECTED0), data, length);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+
+  buffer.SetFromString("0,0");
+  output.WriteDMX(buffer);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+
+  output.SetStartAddress(2);
+  buffer.SetFromString("1,0,0,0,255,255,255");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = {
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88,
+    0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee, 0xee,
+    0, 0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED1, arraysize(EXPECTED1), data, length);
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+  OLA_ASSERT_EQ(0u, backend.Writes(1));
+}
+
+/**
+ * Test DMX writes in the combined SK6812 RGBW mode.
+ */
+void SPIOutputTest::testCombinedSK6812Control() {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0, "Test SPI Device");
+  options.pixel_count = 2;
+  options.ws2812_reset_bytes = 2;
+  SPIOutput output(m_uid, &backend, options);
+  output.SetPersonality(12);
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  buffer.SetFromString("0,0,0");
+  output.WriteDMX(buffer);
+  OLA_ASSERT_EQ(0u, backend.Writes(0));
+
+  // 3 bit symbols, in G, R, B, W order
+  buffer.SetFromString("0,255,0,255");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED[] = {
+    0xdb, 0x6d, 0xb6, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24, 0xdb, 0x6d, 0xb6,
+    0xdb, 0x6d, 0xb6, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24, 0xdb, 0x6d, 0xb6,
+    0, 0};
+  OLA_ASSERT_DATA_EQUALS(EXPECTED, arraysize(EXPECTED), data, length);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+}
@@ -47,6 +47,7 @@ const char SPIPlugin::DEFAULT_SPI_DEVICE_PREFIX[] = "spidev";
 const char SPIPlugin::PLUGIN_NAME[] = "SPI";
 const char SPIPlugin::PLUGIN_PREFIX[] = "spi";
 const char SPIPlugin::SPI_BASE_UID_KEY[] = "base_uid";
+const char SPIPlugin::SPI_BUS_SYNC_WINDOW_KEY[] = "bus_sync_window";
 const char SPIPlugin::SPI_DEVICE_PREFIX_KEY[] = "device_prefix";
 
 /*
@@ -73,11 +74,21 @@ bool SPIPlugin::StartHook() {
     return false;
   }
 
+  unsigned int sync_window = 0;
+  if (!StringToInt(m_preferences->GetValue(SPI_BUS_SYNC_WINDOW_KEY),
+                   &sync_window)) {
+    OLA_WARN << "Invalid integer value for " << SPI_BUS_SYNC_WINDOW_KEY;
+  }
+  if (sync_window) {
+    m_barrier.reset(new FrameBarrier(
+        TimeInterval(static_cast<int64_t>(sync_window))));
+  }
+
   ola::rdm::UIDAllocator uid_allocator(*base_uid);
   vector<string>::const_iterator iter = spi_files.begin();
   for (; iter != spi_files.end(); ++iter) {
     SPIDevice *device = new SPIDevice(this, m_preferences, m_plugin_adaptor,
-                                      *iter, &uid_allocator);
+                                      *iter, &uid_allocator, m_barrier.get());
 
     if (!device) {
       continue;
@@ -106,6 +117,8 @@ bool SPIPlugin::StopHook() {
     ok &= (*iter)->Stop();
     delete *iter;
   }
+  m_devices.clear();
+  m_barrier.reset();
   return ok;
 }
 
@@ -134,6 +147,9 @@ bool SPIPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(SPI_BASE_UID_KEY,
                                          StringValidator(),
                                          DEFAULT_BASE_UID);
+  save |= m_preferences->SetDefaultValue(SPI_BUS_SYNC_WINDOW_KEY,
+                                         UIntValidator(0, 100000),
+                                         0u);
   if (save) {
     m_preferences->Save();
   }
@@ -21,10 +21,12 @@
 #ifndef PLUGINS_SPI_SPIPLUGIN_H_
 #define PLUGINS_SPI_SPIPLUGIN_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "olad/Plugin.h"
 #include "ola/plugin_id.h"
+#include "plugins/spi/SPIBackend.h"
 
 namespace ola {
 namespace plugin {
@@ -42,6 +44,8 @@ class SPIPlugin: public ola::Plugin {
 
  private:
   std::vector<class SPIDevice*> m_devices;
+  // Shared by all the devices if bus_sync_window is set.
+  std::auto_ptr<FrameBarrier> m_barrier;
 
   bool StartHook();
   bool StopHook();
@@ -52,6 +56,7 @@ class SPIPlugin: public ola::Plugin {
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
   static const char SPI_BASE_UID_KEY[];
+  static const char SPI_BUS_SYNC_WINDOW_KEY[];
   static const char SPI_DEVICE_PREFIX_KEY[];
 };
 }  // namespace spi
@@ -46,6 +46,8 @@ const uint8_t SPIWriter::SPI_MODE = 0;
 const char SPIWriter::SPI_DEVICE_KEY[] = "device";
 const char SPIWriter::SPI_ERROR_VAR[] = "spi-write-errors";
 const char SPIWriter::SPI_WRITE_VAR[] = "spi-writes";
+// The kernel limits the size of the transfer array to 16k.
+const unsigned int SPIWriter::MAX_TRANSFERS = 16;
 
 SPIWriter::SPIWriter(const string &spi_device,
                      const Options &options,
@@ -105,16 +107,37 @@ bool SPIWriter::Init() {
 }
 
 bool SPIWriter::WriteSPIData(const uint8_t *data, unsigned int length) {
-  struct spi_ioc_transfer spi;
-  memset(&spi, 0, sizeof(spi));
-  spi.tx_buf = reinterpret_cast<__u64>(data);
-  spi.len = length;
+  SPITransfer transfer = {data, length};
+  return WriteSPIData(&transfer, 1);
+}
+
+/*
+ * The transfers are chained in a single SPI_IOC_MESSAGE, so the kernel sends
+ * them back to back without returning to us in between.
+ */
+bool SPIWriter::WriteSPIData(const SPITransfer *transfers,
+                             unsigned int count) {
+  if (count == 0 || count > MAX_TRANSFERS) {
+    OLA_WARN << "Invalid number of SPI transfers: " << count;
+    return false;
+  }
+
+  struct spi_ioc_transfer spi[MAX_TRANSFERS];
+  memset(spi, 0, count * sizeof(spi[0]));
+  unsigned int length = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    spi[i].tx_buf = reinterpret_cast<__u64>(transfers[i].data);
+    spi[i].len = transfers[i].length;
+    length += transfers[i].length;
+  }
 
   if (m_write_map_var) {
     (*m_write_map_var)[m_device_path]++;
   }
 
-  int bytes_written = ioctl(m_fd, SPI_IOC_MESSAGE(1), &spi);
+  // SPI_IOC_MESSAGE() needs a constant count, so build the request here.
+  int bytes_written = ioctl(
+      m_fd, _IOC(_IOC_WRITE, SPI_IOC_MAGIC, 0, SPI_MSGSIZE(count)), spi);
   if (bytes_written != static_cast<int>(length)) {
     OLA_WARN << "Failed to write all the SPI data: " << strerror(errno);
     if (m_error_map_var) {
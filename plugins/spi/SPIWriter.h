@@ -30,6 +30,14 @@ namespace ola {
 namespace plugin {
 namespace spi {
 
+/**
+ * A block of data to send, as part of a write.
+ */
+struct SPITransfer {
+  const uint8_t *data;
+  unsigned int length;
+};
+
 /**
  * The interface for the SPI Writer
  */
@@ -40,6 +48,14 @@ class SPIWriterInterface {
   virtual std::string DevicePath() const = 0;
   virtual bool Init() = 0;
   virtual bool WriteSPIData(const uint8_t *data, unsigned int length) = 0;
+
+  /**
+   * @brief Write several blocks of data back to back, as a single write.
+   * @param transfers the blocks of data to write.
+   * @param count the number of blocks.
+   */
+  virtual bool WriteSPIData(const SPITransfer *transfers,
+                            unsigned int count) = 0;
 };
 
 /**
@@ -70,6 +86,7 @@ class SPIWriter : public SPIWriterInterface {
   bool Init();
 
   bool WriteSPIData(const uint8_t *data, unsigned int length);
+  bool WriteSPIData(const SPITransfer *transfers, unsigned int count);
 
  private:
   const std::string m_device_path;
@@ -84,6 +101,7 @@ class SPIWriter : public SPIWriterInterface {
   static const char SPI_DEVICE_KEY[];
   static const char SPI_ERROR_VAR[];
   static const char SPI_WRITE_VAR[];
+  static const unsigned int MAX_TRANSFERS;
 };
 }  // namespace spi
 }  // namespace plugin
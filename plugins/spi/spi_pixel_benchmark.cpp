@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * spi_pixel_benchmark.cpp
+ * Time the conversion of DMX data to the SPI pixel formats.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * Each format is converted with the per-pixel code SPIOutput used to have,
+ * the scalar table driven code & the SIMD code, if the CPU has it. The time
+ * per frame is printed for each.
+ */
+
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "plugins/spi/PixelConverter.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeStamp;
+using ola::plugin::spi::ConvertPixels;
+using ola::plugin::spi::PIXEL_FORMAT_APA102;
+using ola::plugin::spi::PIXEL_FORMAT_LPD8806;
+using ola::plugin::spi::PIXEL_FORMAT_P9813;
+using ola::plugin::spi::PIXEL_FORMAT_WS2801;
+using ola::plugin::spi::PixelFormat;
+using ola::plugin::spi::PixelWireBytes;
+using ola::plugin::spi::ScalarConvertPixels;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint16(pixels, p, 170, "The number of pixels per output [1 - 170]");
+DEFINE_s_uint16(outputs, o, 8, "The number of outputs per frame");
+DEFINE_s_uint32(frames, f, 20000, "The number of frames to convert");
+
+namespace {
+
+typedef void (*ConvertFunction)(PixelFormat format, const DmxBuffer &buffer,
+                                unsigned int pixel_count, uint8_t *output);
+
+uint8_t P9813CreateFlag(uint8_t red, uint8_t green, uint8_t blue) {
+  uint8_t flag = 0;
+  flag =  (red & 0xc0) >> 6;
+  flag |= (green & 0xc0) >> 4;
+  flag |= (blue & 0xc0) >> 2;
+  return ~flag;
+}
+
+/*
+ * The per-pixel code from SPIOutput, before PixelConverter.
+ */
+void LegacyConvert(PixelFormat format, const DmxBuffer &buffer,
+                   unsigned int pixel_count, uint8_t *output) {
+  for (unsigned int i = 0; i < pixel_count; i++) {
+    unsigned int offset = i * 3;
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    if (buffer.Size() - offset >= 3) {
+      r = buffer.Get(offset);
+      g = buffer.Get(offset + 1);
+      b = buffer.Get(offset + 2);
+    }
+    switch (format) {
+      case PIXEL_FORMAT_WS2801:
+        output[i * 3] = r;
+        output[i * 3 + 1] = g;
+        output[i * 3 + 2] = b;
+        break;
+      case PIXEL_FORMAT_LPD8806:
+        output[i * 3] = 0x80 | (g >> 1);
+        output[i * 3 + 1] = 0x80 | (r >> 1);
+        output[i * 3 + 2] = 0x80 | (b >> 1);
+        break;
+      case PIXEL_FORMAT_P9813:
+        output[i * 4] = P9813CreateFlag(r, g, b);
+        output[i * 4 + 1] = b;
+        output[i * 4 + 2] = g;
+        output[i * 4 + 3] = r;
+        break;
+      case PIXEL_FORMAT_APA102:
+        output[i * 4] = 0xFF;
+        output[i * 4 + 1] = b;
+        output[i * 4 + 2] = g;
+        output[i * 4 + 3] = r;
+        break;
+    }
+  }
+}
+
+void ScalarConvert(PixelFormat format, const DmxBuffer &buffer,
+                   unsigned int pixel_count, uint8_t *output) {
+  ScalarConvertPixels(format, buffer.GetRaw(), pixel_count, output);
+}
+
+void SIMDConvert(PixelFormat format, const DmxBuffer &buffer,
+                 unsigned int pixel_count, uint8_t *output) {
+  ConvertPixels(format, buffer.GetRaw(), pixel_count, output);
+}
+
+/*
+ * Returns the average time to convert a frame, in microseconds.
+ */
+double TimeConversion(ConvertFunction function, PixelFormat format,
+                      const vector<DmxBuffer> &buffers, uint8_t *output) {
+  Clock clock;
+  TimeStamp start, end;
+  const unsigned int output_size = FLAGS_pixels * PixelWireBytes(format);
+
+  clock.CurrentTime(&start);
+  for (unsigned int frame = 0; frame < FLAGS_frames; frame++) {
+    for (unsigned int i = 0; i < buffers.size(); i++) {
+      function(format, buffers[i], FLAGS_pixels, output + i * output_size);
+    }
+  }
+  clock.CurrentTime(&end);
+  return static_cast<double>((end - start).AsInt()) / FLAGS_frames;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ola::AppInit(&argc, argv, "", "Benchmark the SPI pixel conversion.");
+
+  if (FLAGS_pixels == 0 || FLAGS_pixels > ola::DMX_UNIVERSE_SIZE / 3 ||
+      FLAGS_outputs == 0 || FLAGS_frames == 0) {
+    ola::DisplayUsage();
+    return -1;
+  }
+
+  vector<DmxBuffer> buffers(FLAGS_outputs);
+  for (unsigned int i = 0; i < buffers.size(); i++) {
+    for (unsigned int slot = 0; slot < FLAGS_pixels * 3u; slot++) {
+      buffers[i].SetChannel(slot, static_cast<uint8_t>(slot * 37 + i));
+    }
+  }
+  vector<uint8_t> output(FLAGS_outputs * FLAGS_pixels * 4);
+
+  const PixelFormat formats[] = {
+    PIXEL_FORMAT_WS2801, PIXEL_FORMAT_LPD8806, PIXEL_FORMAT_P9813,
+    PIXEL_FORMAT_APA102,
+  };
+  const char *names[] = {"WS2801", "LPD8806", "P9813", "APA102"};
+
+  cout << FLAGS_pixels << " pixels x " << FLAGS_outputs
+       << " outputs, microseconds per frame" << endl;
+  cout << "format\tlegacy\tscalar\tsimd\tspeedup" << endl;
+  for (unsigned int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    double legacy = TimeConversion(LegacyConvert, formats[i], buffers,
+                                   &output[0]);
+    double scalar = TimeConversion(ScalarConvert, formats[i], buffers,
+                                   &output[0]);
+    double simd = TimeConversion(SIMDConvert, formats[i], buffers,
+                                 &output[0]);
+    cout << names[i] << "\t" << legacy << "\t" << scalar << "\t" << simd
+         << "\t" << (simd > 0 ? legacy / simd : 0) << "x" << endl;
+  }
+  return 0;
+}
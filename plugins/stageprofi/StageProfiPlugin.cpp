@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/PluginAdaptor.h"
 #include "ola/network/IPV4Address.h"
@@ -50,6 +51,8 @@ const char StageProfiPlugin::STAGEPROFI_DEVICE_NAME[] = "StageProfi Device";
 const char StageProfiPlugin::PLUGIN_NAME[] = "StageProfi";
 const char StageProfiPlugin::PLUGIN_PREFIX[] = "stageprofi";
 const char StageProfiPlugin::DEVICE_KEY[] = "device";
+const char StageProfiPlugin::DELTA_UPDATES_KEY[] = "delta_updates";
+const char StageProfiPlugin::FULL_REFRESH_KEY[] = "full_refresh_ms";
 
 namespace {
 
@@ -95,6 +98,13 @@ bool StageProfiPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(DEVICE_KEY, StringValidator(),
                                          STAGEPROFI_DEVICE_PATH);
 
+  save |= m_preferences->SetDefaultValue(DELTA_UPDATES_KEY, BoolValidator(),
+                                         false);
+
+  save |= m_preferences->SetDefaultValue(
+      FULL_REFRESH_KEY, UIntValidator(0, MAX_FULL_REFRESH_MS),
+      DEFAULT_FULL_REFRESH_MS);
+
   if (save) {
     m_preferences->Save();
   }
@@ -115,13 +125,24 @@ void StageProfiPlugin::NewWidget(const std::string &widget_path,
     return;
   }
 
+  StageProfiWidget *widget = new StageProfiWidget(
+      m_plugin_adaptor, descriptor, widget_path,
+      NewSingleCallback(this, &StageProfiPlugin::DeviceRemoved, widget_path));
+
+  bool delta_updates = false;
+  if (!StringToBool(m_preferences->GetValue(DELTA_UPDATES_KEY),
+                    &delta_updates)) {
+    delta_updates = false;
+  }
+  unsigned int full_refresh_ms;
+  if (!StringToInt(m_preferences->GetValue(FULL_REFRESH_KEY),
+                   &full_refresh_ms)) {
+    full_refresh_ms = DEFAULT_FULL_REFRESH_MS;
+  }
+  widget->SetDeltaUpdates(delta_updates, full_refresh_ms);
+
   auto_ptr<StageProfiDevice> device(new StageProfiDevice(
-      this,
-      new StageProfiWidget(
-          m_plugin_adaptor, descriptor, widget_path,
-          NewSingleCallback(this, &StageProfiPlugin::DeviceRemoved,
-                            widget_path)),
-      STAGEPROFI_DEVICE_NAME));
+      this, widget, STAGEPROFI_DEVICE_NAME));
 
   if (!device->Start()) {
     OLA_INFO << "Failed to start StageProfiDevice";
@@ -66,6 +66,10 @@ class StageProfiPlugin: public Plugin {
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
   static const char DEVICE_KEY[];
+  static const char DELTA_UPDATES_KEY[];
+  static const char FULL_REFRESH_KEY[];
+  static const unsigned int DEFAULT_FULL_REFRESH_MS = 1000;
+  static const unsigned int MAX_FULL_REFRESH_MS = 60000;
 };
 }  // namespace stageprofi
 }  // namespace plugin
@@ -26,6 +26,7 @@
 #include <string.h>
 #include <algorithm>
 #include <string>
+#include <vector>
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
@@ -59,7 +60,8 @@ StageProfiWidget::StageProfiWidget(io::SelectServerInterface *ss,
       m_widget_path(widget_path),
       m_disconnect_cb(disconnect_cb),
       m_timeout_id(INVALID_TIMEOUT),
-      m_got_response(false) {
+      m_got_response(false),
+      m_delta_updates(false) {
   m_descriptor->SetOnData(
       NewCallback<StageProfiWidget>(this, &StageProfiWidget::SocketReady));
   m_ss->AddReadDescriptor(m_descriptor.get());
@@ -88,20 +90,39 @@ bool StageProfiWidget::SendDmx(const DmxBuffer &buffer) {
     return false;
   }
 
-  uint16_t index = 0;
-  while (index < buffer.Size()) {
-    unsigned int size = std::min((unsigned int) DMX_MSG_LEN,
-                                 buffer.Size() - index);
-    bool ok = Send255(index, buffer.GetRaw() + index, size);
-    if (!ok) {
-      OLA_INFO << "Failed to send StageProfi message, closing socket";
-      RunDisconnectHandler();
+  bool ok;
+  if (m_delta_updates) {
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    if (m_last_full_refresh.IsSet() && buffer.Size() == m_last_frame.Size() &&
+        (m_full_refresh_interval.IsZero() ||
+         now - m_last_full_refresh < m_full_refresh_interval)) {
+      ok = SendChangedRanges(buffer);
+    } else {
+      m_last_full_refresh = now;
+      ok = SendRange(buffer, 0, buffer.Size());
     }
-    index += size;
+    m_last_frame = buffer;
+  } else {
+    ok = SendRange(buffer, 0, buffer.Size());
+  }
+
+  if (!ok) {
+    OLA_INFO << "Failed to send StageProfi message, closing socket";
+    RunDisconnectHandler();
   }
   return true;
 }
 
+void StageProfiWidget::SetDeltaUpdates(bool enable,
+                                       unsigned int full_refresh_ms) {
+  m_delta_updates = enable;
+  m_full_refresh_interval = TimeInterval(
+      static_cast<int64_t>(full_refresh_ms) * 1000);
+  m_last_frame.Reset();
+  m_last_full_refresh = TimeStamp();
+}
+
 /*
  * Called when there is data to read.
  */
@@ -149,6 +170,41 @@ bool StageProfiWidget::Send255(uint16_t start,
   return m_descriptor->Send(msg, bytes_to_send) == bytes_to_send;
 }
 
+/*
+ * @brief Send the slots from start up to, but not including, end.
+ */
+bool StageProfiWidget::SendRange(const DmxBuffer &buffer, unsigned int start,
+                                 unsigned int end) {
+  unsigned int index = start;
+  while (index < end) {
+    unsigned int size = std::min((unsigned int) DMX_MSG_LEN, end - index);
+    if (!Send255(index, buffer.GetRaw() + index, size)) {
+      return false;
+    }
+    index += size;
+  }
+  return true;
+}
+
+/*
+ * @brief Send the ranges of slots that differ from the last frame.
+ *
+ * Ranges separated by fewer unchanged slots than the size of a message
+ * header are merged, since sending the unchanged slots is cheaper than
+ * starting another message.
+ */
+bool StageProfiWidget::SendChangedRanges(const DmxBuffer &buffer) {
+  buffer.Diff(m_last_frame, &m_changed_ranges, DMX_HEADER_SIZE);
+  std::vector<DmxBuffer::SlotRange>::const_iterator iter =
+      m_changed_ranges.begin();
+  for (; iter != m_changed_ranges.end(); ++iter) {
+    if (!SendRange(buffer, iter->offset, iter->offset + iter->length)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void StageProfiWidget::SendQueryPacket() {
   uint8_t query[] = {'C', '?'};
   ssize_t bytes_sent = m_descriptor->Send(query, arraysize(query));
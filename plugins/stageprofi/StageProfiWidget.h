@@ -23,6 +23,8 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Callback.h"
 #include "ola/io/Descriptor.h"
@@ -63,6 +65,17 @@ class StageProfiWidget {
 
   bool SendDmx(const DmxBuffer &buffer);
 
+  /**
+   * @brief Only send the slots that have changed.
+   * @param enable true to enable delta updates.
+   * @param full_refresh_ms how often to send the full frame anyway, in case
+   *   an update was lost, 0 disables the full refresh.
+   *
+   * The changed slots are grouped into ranges, each of which is sent with
+   * its own SETDMX message.
+   */
+  void SetDeltaUpdates(bool enable, unsigned int full_refresh_ms);
+
  private:
   enum { DMX_MSG_LEN = 255 };
   enum { DMX_HEADER_SIZE = 4};
@@ -74,9 +87,20 @@ class StageProfiWidget {
   ola::thread::timeout_id m_timeout_id;
   bool m_got_response;
 
+  // delta updates
+  bool m_delta_updates;
+  ola::Clock m_clock;
+  TimeInterval m_full_refresh_interval;
+  TimeStamp m_last_full_refresh;
+  DmxBuffer m_last_frame;
+  std::vector<DmxBuffer::SlotRange> m_changed_ranges;
+
   void SocketReady();
   void DiscoveryTimeout();
   bool Send255(uint16_t start, const uint8_t *buf, unsigned int len) const;
+  bool SendRange(const DmxBuffer &buffer, unsigned int start,
+                 unsigned int end);
+  bool SendChangedRanges(const DmxBuffer &buffer);
   void SendQueryPacket();
   void RunDisconnectHandler();
 };
@@ -16,6 +16,8 @@ plugins_uartdmx_libolauartdmx_la_SOURCES = \
     plugins/uartdmx/UartDmxPlugin.cpp \
     plugins/uartdmx/UartDmxPlugin.h \
     plugins/uartdmx/UartDmxPort.h \
+    plugins/uartdmx/UartDmxScheduler.cpp \
+    plugins/uartdmx/UartDmxScheduler.h \
     plugins/uartdmx/UartDmxThread.cpp \
     plugins/uartdmx/UartDmxThread.h \
     plugins/uartdmx/UartWidget.cpp \
@@ -23,6 +25,18 @@ plugins_uartdmx_libolauartdmx_la_SOURCES = \
 plugins_uartdmx_libolauartdmx_la_LIBADD = \
     common/libolacommon.la \
     olad/plugin_api/libolaserverplugininterface.la
+
+# TESTS
+##################################################
+test_programs += plugins/uartdmx/UartDmxSchedulerTester
+
+plugins_uartdmx_UartDmxSchedulerTester_SOURCES = \
+    plugins/uartdmx/UartDmxSchedulerTest.cpp \
+    plugins/uartdmx/UartDmxScheduler.cpp \
+    plugins/uartdmx/UartDmxThread.cpp \
+    plugins/uartdmx/UartWidget.cpp
+plugins_uartdmx_UartDmxSchedulerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+plugins_uartdmx_UartDmxSchedulerTester_LDADD = $(COMMON_TESTING_LIBS)
 endif
 
 EXTRA_DIST += plugins/uartdmx/README.md
@@ -23,6 +23,7 @@
 #include <memory>
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "olad/ThreadPreferences.h"
 #include "plugins/uartdmx/UartDmxDevice.h"
 #include "plugins/uartdmx/UartDmxPort.h"
 
@@ -36,27 +37,46 @@ const char UartDmxDevice::K_MALF[] = "-malf";
 const char UartDmxDevice::K_BREAK[] = "-break";
 const unsigned int UartDmxDevice::DEFAULT_BREAK = 100;
 const unsigned int UartDmxDevice::DEFAULT_MALF = 100;
+const char UartDmxDevice::K_FRAME_RATE[] = "-frame-rate";
+const char UartDmxDevice::K_SPIN_TIME[] = "-spin-time";
 
 
 UartDmxDevice::UartDmxDevice(AbstractPlugin *owner,
                              class Preferences *preferences,
                              const string &name,
-                             const string &path)
+                             const string &path,
+                             ExportMap *export_map,
+                             UartDmxScheduler *scheduler)
     : Device(owner, name),
       m_preferences(preferences),
       m_name(name),
-      m_path(path) {
+      m_path(path),
+      m_export_map(export_map),
+      m_scheduler(scheduler) {
   // set up some per-device default configuration if not already set
   SetDefaults();
   // now read per-device configuration
   // Break time in microseconds
-  if (!StringToInt(m_preferences->GetValue(DeviceBreakKey()), &m_breakt)) {
-    m_breakt = DEFAULT_BREAK;
+  if (!StringToInt(m_preferences->GetValue(DeviceBreakKey()),
+                   &m_options.breakt)) {
+    m_options.breakt = DEFAULT_BREAK;
   }
   // Mark After Last Frame in microseconds
-  if (!StringToInt(m_preferences->GetValue(DeviceMalfKey()), &m_malft)) {
-    m_malft = DEFAULT_MALF;
+  if (!StringToInt(m_preferences->GetValue(DeviceMalfKey()),
+                   &m_options.malft)) {
+    m_options.malft = DEFAULT_MALF;
   }
+  // The options below all default to off.
+  if (!StringToInt(m_preferences->GetValue(DeviceFrameRateKey()),
+                   &m_options.frame_rate)) {
+    m_options.frame_rate = 0;
+  }
+  if (!StringToInt(m_preferences->GetValue(DeviceSpinTimeKey()),
+                   &m_options.spin_time)) {
+    m_options.spin_time = 0;
+  }
+  m_options.scheduling = ThreadPreferences::Load(m_preferences,
+                                                 DeviceThreadPrefix());
   m_widget.reset(new UartWidget(path));
 }
 
@@ -67,7 +87,8 @@ UartDmxDevice::~UartDmxDevice() {
 }
 
 bool UartDmxDevice::StartHook() {
-  AddPort(new UartDmxOutputPort(this, 0, m_widget.get(), m_breakt, m_malft));
+  AddPort(new UartDmxOutputPort(this, 0, m_widget.get(), m_options,
+                                m_export_map, m_scheduler));
   return true;
 }
 
@@ -77,6 +98,15 @@ string UartDmxDevice::DeviceMalfKey() const {
 string UartDmxDevice::DeviceBreakKey() const {
   return m_path + K_BREAK;
 }
+string UartDmxDevice::DeviceFrameRateKey() const {
+  return m_path + K_FRAME_RATE;
+}
+string UartDmxDevice::DeviceSpinTimeKey() const {
+  return m_path + K_SPIN_TIME;
+}
+string UartDmxDevice::DeviceThreadPrefix() const {
+  return m_path + "-";
+}
 
 /**
  * Set the default preferences for this one Device
@@ -94,6 +124,11 @@ void UartDmxDevice::SetDefaults() {
   save |= m_preferences->SetDefaultValue(DeviceMalfKey(),
                                          UIntValidator(8, 1000000),
                                          DEFAULT_MALF);
+  save |= m_preferences->SetDefaultValue(DeviceFrameRateKey(),
+                                         UIntValidator(0, 1000), 0);
+  save |= m_preferences->SetDefaultValue(DeviceSpinTimeKey(),
+                                         UIntValidator(0, 10000), 0);
+  save |= ThreadPreferences::SetDefaults(m_preferences, DeviceThreadPrefix());
   if (save) {
     m_preferences->Save();
   }
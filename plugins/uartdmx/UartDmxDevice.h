@@ -26,8 +26,10 @@
 #include <sstream>
 #include <memory>
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "olad/Device.h"
 #include "olad/Preferences.h"
+#include "plugins/uartdmx/UartDmxThread.h"
 #include "plugins/uartdmx/UartWidget.h"
 
 namespace ola {
@@ -39,7 +41,9 @@ class UartDmxDevice : public Device {
   UartDmxDevice(AbstractPlugin *owner,
                 class Preferences *preferences,
                 const std::string &name,
-                const std::string &path);
+                const std::string &path,
+                ExportMap *export_map,
+                class UartDmxScheduler *scheduler);
   ~UartDmxDevice();
 
   std::string DeviceId() const { return m_path; }
@@ -52,19 +56,26 @@ class UartDmxDevice : public Device {
   // Per device options
   std::string DeviceBreakKey() const;
   std::string DeviceMalfKey() const;
+  std::string DeviceFrameRateKey() const;
+  std::string DeviceSpinTimeKey() const;
+  // The prefix for the ThreadPreferences keys.
+  std::string DeviceThreadPrefix() const;
   void SetDefaults();
 
   std::auto_ptr<UartWidget> m_widget;
   class Preferences *m_preferences;
   const std::string m_name;
   const std::string m_path;
-  unsigned int m_breakt;
-  unsigned int m_malft;
+  ExportMap *m_export_map;
+  class UartDmxScheduler *m_scheduler;
+  UartDmxThread::Options m_options;
 
   static const unsigned int DEFAULT_MALF;
   static const char K_MALF[];
   static const unsigned int DEFAULT_BREAK;
   static const char K_BREAK[];
+  static const char K_FRAME_RATE[];
+  static const char K_SPIN_TIME[];
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxDevice);
 };
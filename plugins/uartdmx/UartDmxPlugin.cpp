@@ -29,6 +29,7 @@
 #include "ola/StringUtils.h"
 #include "ola/io/IOUtils.h"
 #include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
 #include "olad/PluginAdaptor.h"
 #include "plugins/uartdmx/UartDmxPlugin.h"
 #include "plugins/uartdmx/UartDmxPluginDescription.h"
@@ -46,6 +47,9 @@ const char UartDmxPlugin::PLUGIN_NAME[] = "UART native DMX";
 const char UartDmxPlugin::PLUGIN_PREFIX[] = "uartdmx";
 const char UartDmxPlugin::K_DEVICE[] = "device";
 const char UartDmxPlugin::DEFAULT_DEVICE[] = "/dev/ttyACM0";
+const char UartDmxPlugin::K_SHARED_THREAD[] = "shared-thread";
+const char UartDmxPlugin::K_SHARED_THREAD_PREFIX[] = "shared-thread-";
+const char UartDmxPlugin::K_SHARED_SPIN_TIME[] = "shared-thread-spin-time";
 
 /*
  * Start the plug-in, using only the configured device(s) (we cannot sensibly
@@ -55,7 +59,22 @@ bool UartDmxPlugin::StartHook() {
   vector<string> devices = m_preferences->GetMultipleValue(K_DEVICE);
   vector<string>::const_iterator iter;  // iterate over devices
 
-  // start counting device ids from 0
+  if (m_preferences->GetValueAsBool(K_SHARED_THREAD)) {
+    unsigned int spin_time;
+    if (!StringToInt(m_preferences->GetValue(K_SHARED_SPIN_TIME),
+                     &spin_time)) {
+      spin_time = 0;
+    }
+    m_scheduler.reset(new UartDmxScheduler(
+        spin_time,
+        ThreadPreferences::Load(m_preferences, K_SHARED_THREAD_PREFIX),
+        m_plugin_adaptor->GetExportMap()));
+    if (!m_scheduler->Start()) {
+      OLA_WARN << "Failed to start the shared UART thread, using a thread "
+               << "per device";
+      m_scheduler.reset();
+    }
+  }
 
   for (iter = devices.begin(); iter != devices.end(); ++iter) {
     // first check if device configured
@@ -75,7 +94,8 @@ bool UartDmxPlugin::StartHook() {
     // can open device, so shut the temporary file descriptor
     close(fd);
     std::auto_ptr<UartDmxDevice> device(new UartDmxDevice(
-        this, m_preferences, PLUGIN_NAME, *iter));
+        this, m_preferences, PLUGIN_NAME, *iter,
+        m_plugin_adaptor->GetExportMap(), m_scheduler.get()));
 
     // got a device, now lets see if we can configure it before we announce
     // it to the world
@@ -108,6 +128,8 @@ bool UartDmxPlugin::StopHook() {
     delete *iter;
   }
   m_devices.clear();
+  // The ports have all been removed, so this just stops the thread.
+  m_scheduler.reset();
   return true;
 }
 
@@ -131,6 +153,12 @@ bool UartDmxPlugin::SetDefaultPreferences() {
   // only insert default device name, no others at this stage
   bool save = m_preferences->SetDefaultValue(K_DEVICE, StringValidator(),
                                              DEFAULT_DEVICE);
+  save |= m_preferences->SetDefaultValue(K_SHARED_THREAD, BoolValidator(),
+                                         false);
+  save |= m_preferences->SetDefaultValue(K_SHARED_SPIN_TIME,
+                                         UIntValidator(0, 10000), 0);
+  save |= ThreadPreferences::SetDefaults(m_preferences,
+                                         K_SHARED_THREAD_PREFIX);
   if (save) {
     m_preferences->Save();
   }
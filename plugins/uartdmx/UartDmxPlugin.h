@@ -22,6 +22,7 @@
 #ifndef PLUGINS_UARTDMX_UARTDMXPLUGIN_H_
 #define PLUGINS_UARTDMX_UARTDMXPLUGIN_H_
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -30,6 +31,7 @@
 #include "ola/plugin_id.h"
 
 #include "plugins/uartdmx/UartDmxDevice.h"
+#include "plugins/uartdmx/UartDmxScheduler.h"
 
 namespace ola {
 namespace plugin {
@@ -52,6 +54,8 @@ class UartDmxPlugin : public Plugin {
  private:
   typedef std::vector<UartDmxDevice*> UartDeviceVector;
   UartDeviceVector m_devices;
+  // Set if all the devices share one output thread.
+  std::auto_ptr<UartDmxScheduler> m_scheduler;
 
   void AddDevice(UartDmxDevice *device);
   bool StartHook();
@@ -64,6 +68,9 @@ class UartDmxPlugin : public Plugin {
   static const char PLUGIN_PREFIX[];
   static const char K_DEVICE[];
   static const char DEFAULT_DEVICE[];
+  static const char K_SHARED_THREAD[];
+  static const char K_SHARED_THREAD_PREFIX[];
+  static const char K_SHARED_SPIN_TIME[];
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxPlugin);
 };
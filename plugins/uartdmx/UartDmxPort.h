@@ -22,12 +22,14 @@
 #ifndef PLUGINS_UARTDMX_UARTDMXPORT_H_
 #define PLUGINS_UARTDMX_UARTDMXPORT_H_
 
+#include <memory>
 #include <string>
 
 #include "ola/DmxBuffer.h"
 #include "olad/Port.h"
 #include "olad/Preferences.h"
 #include "plugins/uartdmx/UartDmxDevice.h"
+#include "plugins/uartdmx/UartDmxScheduler.h"
 #include "plugins/uartdmx/UartWidget.h"
 #include "plugins/uartdmx/UartDmxThread.h"
 
@@ -35,29 +37,52 @@ namespace ola {
 namespace plugin {
 namespace uartdmx {
 
+/**
+ * An output port, which sends either from its own thread or, if a scheduler
+ * is provided, from the scheduler's shared thread.
+ */
 class UartDmxOutputPort : public ola::BasicOutputPort {
  public:
   UartDmxOutputPort(UartDmxDevice *parent,
                     unsigned int id,
                     UartWidget *widget,
-                    unsigned int breakt,
-                    unsigned int malft)
+                    const UartDmxThread::Options &options,
+                    ExportMap *export_map,
+                    UartDmxScheduler *scheduler)
       : BasicOutputPort(parent, id),
         m_widget(widget),
-        m_thread(widget, breakt, malft) {
-    m_thread.Start();
+        m_scheduler(scheduler),
+        m_output(NULL) {
+    if (m_scheduler) {
+      m_output = m_scheduler->AddOutput(widget, options);
+    } else {
+      m_thread.reset(new UartDmxThread(widget, options, export_map));
+      m_thread->Start();
+    }
+  }
+
+  ~UartDmxOutputPort() {
+    if (m_scheduler) {
+      m_scheduler->RemoveOutput(m_output);
+    } else {
+      m_thread->Stop();
+    }
   }
-  ~UartDmxOutputPort() { m_thread.Stop(); }
 
   bool WriteDMX(const ola::DmxBuffer &buffer, uint8_t) {
-    return m_thread.WriteDMX(buffer);
+    if (m_scheduler) {
+      return m_scheduler->WriteDMX(m_output, buffer);
+    }
+    return m_thread->WriteDMX(buffer);
   }
 
   std::string Description() const { return m_widget->Description(); }
 
  private:
   UartWidget *m_widget;
-  UartDmxThread m_thread;
+  UartDmxScheduler *m_scheduler;
+  UartDmxScheduler::Output *m_output;
+  std::auto_ptr<UartDmxThread> m_thread;
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxOutputPort);
 };
@@ -0,0 +1,307 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UartDmxScheduler.cpp
+ * A single thread that sends DMX on many UARTs.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "plugins/uartdmx/UartDmxScheduler.h"
+
+namespace ola {
+namespace plugin {
+namespace uartdmx {
+
+using ola::thread::FramePacer;
+using ola::thread::MutexLocker;
+using std::string;
+
+/*
+ * The state of one UART.
+ */
+class UartDmxScheduler::Output {
+ public:
+  // The next step of the frame.
+  enum State {
+    SET_BREAK,
+    CLEAR_BREAK,
+    SEND_DATA
+  };
+
+  Output(UartWidget *widget, const UartDmxThread::Options &options)
+      : widget(widget),
+        options(options),
+        frame_time(options.frame_rate ? 1000000 / options.frame_rate : 0),
+        state(SET_BREAK),
+        deadline(0),
+        break_start(0),
+        data_start(0),
+        length(0),
+        sent(0),
+        frame_rate_map(NULL),
+        jitter_map(NULL),
+        max_jitter_map(NULL),
+        overrun_map(NULL) {
+  }
+
+  UartWidget *widget;
+  const UartDmxThread::Options options;
+  const unsigned int frame_time;
+  State state;
+  Nanoseconds deadline;
+  Nanoseconds break_start;
+  Nanoseconds data_start;
+  ola::thread::TripleBuffer<DmxBuffer> frames;
+  FramePacer pacer;
+
+  // The frame being sent, including the start code.
+  uint8_t data[DMX_UNIVERSE_SIZE + 1];
+  unsigned int length;
+  unsigned int sent;
+
+  UIntMap *frame_rate_map;
+  UIntMap *jitter_map;
+  UIntMap *max_jitter_map;
+  UIntMap *overrun_map;
+
+  void UpdateExportedStats();
+};
+
+const UartDmxScheduler::Nanoseconds UartDmxScheduler::IDLE_TIME =
+    100 * 1000 * FramePacer::NANOSECONDS_IN_MICROSECOND;
+const UartDmxScheduler::Nanoseconds UartDmxScheduler::BYTE_TIME =
+    44 * FramePacer::NANOSECONDS_IN_MICROSECOND;
+const UartDmxScheduler::Nanoseconds UartDmxScheduler::RETRY_TIME =
+    16 * UartDmxScheduler::BYTE_TIME;
+
+UartDmxScheduler::UartDmxScheduler(
+    unsigned int spin_time,
+    const ola::thread::SchedulingOptions &scheduling,
+    ExportMap *export_map)
+    : m_scheduling(scheduling),
+      m_export_map(export_map),
+      m_term(false),
+      m_pacer(spin_time) {
+}
+
+UartDmxScheduler::~UartDmxScheduler() {
+  Stop();
+  STLDeleteElements(&m_outputs);
+}
+
+UartDmxScheduler::Output *UartDmxScheduler::AddOutput(
+    UartWidget *widget,
+    const UartDmxThread::Options &options) {
+  if (!widget->IsOpen()) {
+    widget->SetupOutput();
+  }
+  widget->SetNonBlocking();
+
+  Output *output = new Output(widget, options);
+  if (m_export_map) {
+    output->frame_rate_map = m_export_map->GetUIntMapVar(
+        UartDmxThread::FRAME_RATE_VAR, UartDmxThread::DEVICE_KEY);
+    output->jitter_map = m_export_map->GetUIntMapVar(
+        UartDmxThread::JITTER_VAR, UartDmxThread::DEVICE_KEY);
+    output->max_jitter_map = m_export_map->GetUIntMapVar(
+        UartDmxThread::MAX_JITTER_VAR, UartDmxThread::DEVICE_KEY);
+    output->overrun_map = m_export_map->GetUIntMapVar(
+        UartDmxThread::OVERRUN_VAR, UartDmxThread::DEVICE_KEY);
+    output->UpdateExportedStats();
+  }
+
+  MutexLocker locker(&m_mutex);
+  output->deadline = FramePacer::Now();
+  // Line the frames up with an output that runs at the same rate.
+  Outputs::const_iterator iter = m_outputs.begin();
+  for (; iter != m_outputs.end(); ++iter) {
+    if (output->frame_time && (*iter)->frame_time == output->frame_time &&
+        (*iter)->pacer.NextFrame()) {
+      output->deadline = (*iter)->pacer.NextFrame();
+      break;
+    }
+  }
+  m_outputs.push_back(output);
+  return output;
+}
+
+void UartDmxScheduler::RemoveOutput(Output *output) {
+  MutexLocker locker(&m_mutex);
+  Outputs::iterator iter = std::find(m_outputs.begin(), m_outputs.end(),
+                                     output);
+  if (iter == m_outputs.end()) {
+    return;
+  }
+  if (output->state == Output::CLEAR_BREAK) {
+    output->widget->SetBreak(false);
+  }
+  m_outputs.erase(iter);
+  delete output;
+}
+
+bool UartDmxScheduler::WriteDMX(Output *output, const DmxBuffer &buffer) {
+  // Set() copies the data, rather than sharing it with the caller.
+  output->frames.WriteBuffer()->Set(buffer);
+  output->frames.Publish();
+  output->UpdateExportedStats();
+  return true;
+}
+
+bool UartDmxScheduler::Stop() {
+  {
+    MutexLocker locker(&m_mutex);
+    m_term = true;
+  }
+  return Join();
+}
+
+void *UartDmxScheduler::Run() {
+  ola::thread::ApplySchedulingOptions(m_scheduling, "UART output thread");
+
+  while (true) {
+    Nanoseconds next_deadline;
+    {
+      MutexLocker locker(&m_mutex);
+      if (m_term) {
+        break;
+      }
+
+      const Nanoseconds now = FramePacer::Now();
+      next_deadline = now + IDLE_TIME;
+      Outputs::iterator iter = m_outputs.begin();
+      for (; iter != m_outputs.end(); ++iter) {
+        if ((*iter)->deadline <= now) {
+          Service(*iter, now);
+        }
+        next_deadline = std::min(next_deadline, (*iter)->deadline);
+      }
+    }
+    m_pacer.SleepUntilTime(next_deadline);
+  }
+  return NULL;
+}
+
+/*
+ * Run the next step of the frame for an output, and set the deadline for the
+ * step after.
+ */
+void UartDmxScheduler::Service(Output *output, Nanoseconds now) {
+  const Nanoseconds break_time =
+      output->options.breakt * FramePacer::NANOSECONDS_IN_MICROSECOND;
+
+  switch (output->state) {
+    case Output::SET_BREAK:
+      {
+        // Setting the break waits for the UART to drain, so don't set it
+        // until the last frame has gone.
+        int pending = output->widget->OutputQueueSize();
+        if (pending > 0) {
+          output->deadline = now + pending * BYTE_TIME;
+          return;
+        }
+
+        output->frames.Update();
+        output->length = DMX_UNIVERSE_SIZE;
+        output->frames.ReadBuffer().Get(output->data + 1, &output->length);
+        output->data[0] = DMX512_START_CODE;
+        output->length++;
+        output->sent = 0;
+
+        bool break_set = pending == 0 && output->widget->SetBreak(true);
+        output->pacer.StartFrame(output->frame_time);
+        if (!break_set) {
+          EndFrame(output, now);
+          return;
+        }
+        // The frame may have started late, so time the break from when it
+        // was actually set.
+        output->break_start = FramePacer::Now();
+        output->state = Output::CLEAR_BREAK;
+        output->deadline = output->break_start + break_time;
+      }
+      return;
+    case Output::CLEAR_BREAK:
+      if (!output->widget->SetBreak(false)) {
+        EndFrame(output, now);
+        return;
+      }
+      output->state = Output::SEND_DATA;
+      output->deadline = output->break_start + break_time +
+          UartDmxThread::DMX_MAB * FramePacer::NANOSECONDS_IN_MICROSECOND;
+      return;
+    case Output::SEND_DATA:
+      {
+        if (output->sent == 0) {
+          output->data_start = now;
+        }
+        int written = output->widget->WriteSome(
+            output->data + output->sent, output->length - output->sent);
+        if (written < 0) {
+          EndFrame(output, now);
+          return;
+        }
+        output->sent += written;
+        if (output->sent < output->length) {
+          output->deadline = now + RETRY_TIME;
+        } else {
+          EndFrame(output, now);
+        }
+      }
+      return;
+  }
+}
+
+/*
+ * Schedule the break for the next frame, once this frame has been sent and
+ * the frame time has passed.
+ */
+void UartDmxScheduler::EndFrame(Output *output, Nanoseconds now) {
+  Nanoseconds frame_end = now;
+  if (output->sent) {
+    frame_end = std::max(now,
+                         output->data_start + output->sent * BYTE_TIME);
+  }
+  frame_end += output->options.malft * FramePacer::NANOSECONDS_IN_MICROSECOND;
+
+  output->state = Output::SET_BREAK;
+  output->deadline = std::max(frame_end, output->pacer.NextFrame());
+}
+
+/*
+ * Copy the frame statistics to the ExportMap.
+ */
+void UartDmxScheduler::Output::UpdateExportedStats() {
+  if (!frame_rate_map) {
+    return;
+  }
+
+  FramePacer::Stats stats;
+  pacer.GetStats(&stats);
+  const string &device = widget->Name();
+  (*frame_rate_map)[device] = static_cast<unsigned int>(
+      stats.frame_rate + 0.5);
+  (*jitter_map)[device] = stats.mean_jitter;
+  (*max_jitter_map)[device] = stats.max_jitter;
+  (*overrun_map)[device] = static_cast<unsigned int>(stats.overruns);
+}
+}  // namespace uartdmx
+}  // namespace plugin
+}  // namespace ola
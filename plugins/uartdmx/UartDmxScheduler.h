@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UartDmxScheduler.h
+ * A single thread that sends DMX on many UARTs.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_UARTDMX_UARTDMXSCHEDULER_H_
+#define PLUGINS_UARTDMX_UARTDMXSCHEDULER_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/FramePacer.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/thread/Utils.h"
+#include "plugins/uartdmx/UartDmxThread.h"
+#include "plugins/uartdmx/UartWidget.h"
+
+namespace ola {
+namespace plugin {
+namespace uartdmx {
+
+/**
+ * @brief Sends DMX on many UARTs from one thread.
+ *
+ * Each output steps through the break, the mark after break and the data on
+ * absolute deadlines, and the thread sleeps until the earliest deadline of
+ * all the outputs. The data is written without blocking, and the next break
+ * is only set once the previous frame has drained, so one slow UART doesn't
+ * hold up the others.
+ *
+ * Outputs with the same frame rate start their frames together.
+ */
+class UartDmxScheduler : public ola::thread::Thread {
+ public:
+  class Output;
+
+  /**
+   * @brief Create a new UartDmxScheduler.
+   * @param spin_time the time to busy wait for before each deadline, in us.
+   * @param scheduling the scheduling options for the thread.
+   * @param export_map the ExportMap to publish the frame statistics to, may
+   *   be NULL.
+   */
+  UartDmxScheduler(unsigned int spin_time,
+                   const ola::thread::SchedulingOptions &scheduling,
+                   ExportMap *export_map);
+  ~UartDmxScheduler();
+
+  /**
+   * @brief Start sending on a widget.
+   * @param widget the widget, which should already be set up for output.
+   * @param options the timing options. The spin time and scheduling options
+   *   are ignored, the thread's own are used.
+   * @returns the Output, which is valid until it's passed to RemoveOutput().
+   */
+  Output *AddOutput(UartWidget *widget, const UartDmxThread::Options &options);
+
+  /**
+   * @brief Stop sending on a widget.
+   * @param output the Output returned by AddOutput(). This is deleted.
+   */
+  void RemoveOutput(Output *output);
+
+  /**
+   * @brief Copy a DmxBuffer to an output.
+   *
+   * This is called from the main thread and never blocks, a frame the output
+   * hasn't sent yet is replaced.
+   */
+  bool WriteDMX(Output *output, const DmxBuffer &buffer);
+
+  bool Stop();
+  void *Run();
+
+ private:
+  typedef ola::thread::FramePacer::Nanoseconds Nanoseconds;
+  typedef std::vector<Output*> Outputs;
+
+  const ola::thread::SchedulingOptions m_scheduling;
+  ExportMap *m_export_map;
+  bool m_term;
+  Outputs m_outputs;
+  ola::thread::FramePacer m_pacer;
+  // Protects m_term & m_outputs.
+  ola::thread::Mutex m_mutex;
+
+  void Service(Output *output, Nanoseconds now);
+  void EndFrame(Output *output, Nanoseconds now);
+
+  // How long to sleep for when there aren't any outputs.
+  static const Nanoseconds IDLE_TIME;
+  // The time to send a byte at 250kbps, with a start & two stop bits.
+  static const Nanoseconds BYTE_TIME;
+  // How long to wait before retrying a write the UART didn't take.
+  static const Nanoseconds RETRY_TIME;
+
+  DISALLOW_COPY_AND_ASSIGN(UartDmxScheduler);
+};
+}  // namespace uartdmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_UARTDMX_UARTDMXSCHEDULER_H_
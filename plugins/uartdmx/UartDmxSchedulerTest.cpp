@@ -0,0 +1,234 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * UartDmxSchedulerTest.cpp
+ * Test fixture for the UartDmxScheduler.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/thread/FramePacer.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Utils.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/uartdmx/UartDmxScheduler.h"
+#include "plugins/uartdmx/UartDmxThread.h"
+#include "plugins/uartdmx/UartWidget.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::plugin::uartdmx::UartDmxScheduler;
+using ola::plugin::uartdmx::UartDmxThread;
+using ola::plugin::uartdmx::UartWidget;
+using ola::thread::ConditionVariable;
+using ola::thread::FramePacer;
+using ola::thread::MutexLocker;
+using std::string;
+using std::vector;
+
+typedef FramePacer::Nanoseconds Nanoseconds;
+
+/*
+ * A UartWidget that records the frames sent to it, rather than using a
+ * serial port.
+ */
+class MockUartWidget : public UartWidget {
+ public:
+  struct Frame {
+    Nanoseconds break_on;
+    Nanoseconds break_off;
+    Nanoseconds data_start;
+    string data;
+  };
+
+  MockUartWidget() : UartWidget("mock") {}
+
+  bool IsOpen() const { return true; }
+  bool SetNonBlocking() { return true; }
+  int OutputQueueSize() { return 0; }
+
+  bool SetBreak(bool on) {
+    MutexLocker locker(&m_mutex);
+    if (on) {
+      Frame frame = {FramePacer::Now(), 0, 0, ""};
+      m_frames.push_back(frame);
+      m_condition.Signal();
+    } else if (!m_frames.empty()) {
+      m_frames.back().break_off = FramePacer::Now();
+    }
+    return true;
+  }
+
+  int WriteSome(const uint8_t *data, unsigned int length) {
+    MutexLocker locker(&m_mutex);
+    if (m_frames.empty()) {
+      return -1;
+    }
+    Frame &frame = m_frames.back();
+    if (frame.data.empty()) {
+      frame.data_start = FramePacer::Now();
+    }
+    frame.data.append(reinterpret_cast<const char*>(data), length);
+    return static_cast<int>(length);
+  }
+
+  /*
+   * Wait until count frames have been sent, which is when the break for the
+   * frame after them has been set.
+   */
+  bool WaitForFrames(unsigned int count, vector<Frame> *frames) {
+    Clock clock;
+    TimeStamp wake_up;
+    clock.CurrentTime(&wake_up);
+    wake_up += TimeInterval(2, 0);
+
+    MutexLocker locker(&m_mutex);
+    while (m_frames.size() <= count) {
+      if (!m_condition.TimedWait(&m_mutex, wake_up)) {
+        return false;
+      }
+    }
+    frames->assign(m_frames.begin(), m_frames.begin() + count);
+    return true;
+  }
+
+ private:
+  ola::thread::Mutex m_mutex;
+  ConditionVariable m_condition;
+  vector<Frame> m_frames;
+};
+
+
+class UartDmxSchedulerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UartDmxSchedulerTest);
+  CPPUNIT_TEST(testFrames);
+  CPPUNIT_TEST(testAlignedOutputs);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp();
+  void testFrames();
+  void testAlignedOutputs();
+
+ private:
+  UartDmxThread::Options m_options;
+
+  static const unsigned int FRAME_RATE = 40;
+  static const Nanoseconds FRAME_TIME;
+  static const Nanoseconds BREAK_TIME;
+  static const Nanoseconds MAB_TIME;
+  // How far an aligned frame can start from the other output's frame.
+  static const Nanoseconds ALIGNMENT_TOLERANCE;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UartDmxSchedulerTest);
+
+const Nanoseconds UartDmxSchedulerTest::FRAME_TIME =
+    FramePacer::NANOSECONDS_IN_SECOND / FRAME_RATE;
+const Nanoseconds UartDmxSchedulerTest::BREAK_TIME =
+    200 * FramePacer::NANOSECONDS_IN_MICROSECOND;
+const Nanoseconds UartDmxSchedulerTest::MAB_TIME =
+    UartDmxThread::DMX_MAB * FramePacer::NANOSECONDS_IN_MICROSECOND;
+const Nanoseconds UartDmxSchedulerTest::ALIGNMENT_TOLERANCE =
+    5000 * FramePacer::NANOSECONDS_IN_MICROSECOND;
+
+void UartDmxSchedulerTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_options.breakt = 200;
+  m_options.malft = 100;
+  m_options.frame_rate = FRAME_RATE;
+}
+
+/*
+ * Check each frame is a break, a mark after break and then the data, and
+ * that the frames are sent at the frame rate.
+ */
+void UartDmxSchedulerTest::testFrames() {
+  MockUartWidget widget;
+  UartDmxScheduler scheduler(0, ola::thread::SchedulingOptions(), NULL);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  UartDmxScheduler::Output *output = scheduler.AddOutput(&widget, m_options);
+  OLA_ASSERT_TRUE(scheduler.WriteDMX(output, buffer));
+  OLA_ASSERT_TRUE(scheduler.Start());
+
+  vector<MockUartWidget::Frame> frames;
+  OLA_ASSERT_TRUE(widget.WaitForFrames(3, &frames));
+  scheduler.RemoveOutput(output);
+  scheduler.Stop();
+
+  const uint8_t expected_data[] = {0, 1, 2, 3};
+  const string expected(reinterpret_cast<const char*>(expected_data),
+                        sizeof(expected_data));
+  for (unsigned int i = 0; i < frames.size(); i++) {
+    const MockUartWidget::Frame &frame = frames[i];
+    OLA_ASSERT_EQ(expected, frame.data);
+    OLA_ASSERT_TRUE(frame.break_off - frame.break_on >= BREAK_TIME);
+    OLA_ASSERT_TRUE(frame.data_start - frame.break_on >= BREAK_TIME + MAB_TIME);
+    if (i) {
+      OLA_ASSERT_TRUE(frame.break_on - frames[i - 1].break_on >=
+                      FRAME_TIME - ALIGNMENT_TOLERANCE);
+    }
+  }
+}
+
+/*
+ * Check an output added at the same frame rate as a running output starts
+ * its frames at the same time.
+ */
+void UartDmxSchedulerTest::testAlignedOutputs() {
+  MockUartWidget widget1, widget2;
+  UartDmxScheduler scheduler(0, ola::thread::SchedulingOptions(), NULL);
+
+  UartDmxScheduler::Output *output1 = scheduler.AddOutput(&widget1,
+                                                          m_options);
+  OLA_ASSERT_TRUE(scheduler.Start());
+
+  vector<MockUartWidget::Frame> frames1, frames2;
+  OLA_ASSERT_TRUE(widget1.WaitForFrames(1, &frames1));
+  // Add the second output half way through a frame, so it would be well out
+  // of step if it wasn't lined up.
+  usleep(FRAME_TIME / 2 / FramePacer::NANOSECONDS_IN_MICROSECOND);
+  UartDmxScheduler::Output *output2 = scheduler.AddOutput(&widget2,
+                                                          m_options);
+
+  OLA_ASSERT_TRUE(widget2.WaitForFrames(2, &frames2));
+  OLA_ASSERT_TRUE(widget1.WaitForFrames(4, &frames1));
+  scheduler.RemoveOutput(output2);
+  scheduler.RemoveOutput(output1);
+  scheduler.Stop();
+
+  // Find the frame on the first output that the second output lined up with.
+  const Nanoseconds start = frames2[0].break_on;
+  bool aligned = false;
+  for (unsigned int i = 0; i < frames1.size(); i++) {
+    Nanoseconds offset = frames1[i].break_on - start;
+    if (offset < ALIGNMENT_TOLERANCE && -offset < ALIGNMENT_TOLERANCE) {
+      aligned = true;
+    }
+  }
+  OLA_ASSERT_TRUE(aligned);
+}
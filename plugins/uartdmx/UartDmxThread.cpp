@@ -25,6 +25,7 @@
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/thread/Utils.h"
 #include "plugins/uartdmx/UartWidget.h"
 #include "plugins/uartdmx/UartDmxThread.h"
 
@@ -32,13 +33,34 @@ namespace ola {
 namespace plugin {
 namespace uartdmx {
 
-UartDmxThread::UartDmxThread(UartWidget *widget, unsigned int breakt,
-                             unsigned int malft)
+using ola::thread::FramePacer;
+using std::string;
+
+const char UartDmxThread::FRAME_RATE_VAR[] = "uartdmx-frame-rate";
+const char UartDmxThread::JITTER_VAR[] = "uartdmx-frame-jitter-us";
+const char UartDmxThread::MAX_JITTER_VAR[] = "uartdmx-frame-max-jitter-us";
+const char UartDmxThread::OVERRUN_VAR[] = "uartdmx-frame-overruns";
+const char UartDmxThread::DEVICE_KEY[] = "device";
+
+UartDmxThread::UartDmxThread(UartWidget *widget, const Options &options,
+                             ExportMap *export_map)
   : m_granularity(UNKNOWN),
     m_widget(widget),
     m_term(false),
-    m_breakt(breakt),
-    m_malft(malft) {
+    m_options(options),
+    m_frame_time(options.frame_rate ? 1000000 / options.frame_rate : 0),
+    m_pacer(options.spin_time),
+    m_frame_rate_map(NULL),
+    m_jitter_map(NULL),
+    m_max_jitter_map(NULL),
+    m_overrun_map(NULL) {
+  if (export_map) {
+    m_frame_rate_map = export_map->GetUIntMapVar(FRAME_RATE_VAR, DEVICE_KEY);
+    m_jitter_map = export_map->GetUIntMapVar(JITTER_VAR, DEVICE_KEY);
+    m_max_jitter_map = export_map->GetUIntMapVar(MAX_JITTER_VAR, DEVICE_KEY);
+    m_overrun_map = export_map->GetUIntMapVar(OVERRUN_VAR, DEVICE_KEY);
+    UpdateExportedStats();
+  }
 }
 
 UartDmxThread::~UartDmxThread() {
@@ -58,12 +80,11 @@ bool UartDmxThread::Stop() {
 }
 
 
-/**
- * Copy a DMXBuffer to the output thread
- */
 bool UartDmxThread::WriteDMX(const DmxBuffer &buffer) {
-  ola::thread::MutexLocker locker(&m_buffer_mutex);
-  m_buffer.Set(buffer);
+  // Set() copies the data, rather than sharing it with the caller.
+  m_frames.WriteBuffer()->Set(buffer);
+  m_frames.Publish();
+  UpdateExportedStats();
   return true;
 }
 
@@ -72,10 +93,9 @@ bool UartDmxThread::WriteDMX(const DmxBuffer &buffer) {
  * The method called by the thread
  */
 void *UartDmxThread::Run() {
-  TimeStamp ts1, ts2;
-  Clock clock;
+  ola::thread::ApplySchedulingOptions(m_options.scheduling,
+                                      "UART thread for " + m_widget->Name());
   CheckTimeGranularity();
-  DmxBuffer buffer;
 
   // Setup the widget
   if (!m_widget->IsOpen())
@@ -88,29 +108,33 @@ void *UartDmxThread::Run() {
         break;
     }
 
-    {
-      ola::thread::MutexLocker locker(&m_buffer_mutex);
-      buffer.Set(m_buffer);
-    }
+    // The frame stays valid until the next Update().
+    m_frames.Update();
+    const DmxBuffer &buffer = m_frames.ReadBuffer();
 
-    if (!m_widget->SetBreak(true))
+    // Setting the break waits for the previous frame to drain, so the frame
+    // starts once it returns. The deadlines are measured from there.
+    bool break_set = m_widget->SetBreak(true);
+    m_pacer.StartFrame(m_frame_time);
+    if (!break_set)
       goto framesleep;
 
     if (m_granularity == GOOD)
-      usleep(m_breakt);
+      m_pacer.SleepUntil(m_options.breakt);
 
     if (!m_widget->SetBreak(false))
       goto framesleep;
 
     if (m_granularity == GOOD)
-      usleep(DMX_MAB);
+      m_pacer.SleepUntil(m_options.breakt + DMX_MAB);
 
     if (!m_widget->Write(buffer))
       goto framesleep;
 
   framesleep:
     // Sleep for the remainder of the DMX frame time
-    usleep(m_malft);
+    m_pacer.Sleep(m_options.malft);
+    m_pacer.WaitForFrameEnd();
   }
   return NULL;
 }
@@ -123,12 +147,12 @@ void UartDmxThread::CheckTimeGranularity() {
   TimeStamp ts1, ts2;
   Clock clock;
   /** If sleeping for 1ms takes longer than this, don't trust
-   * usleep for this session
+   * the sleeps for this session
    */
   const int threshold = 3;
 
   clock.CurrentTime(&ts1);
-  usleep(1000);
+  m_pacer.Sleep(1000);
   clock.CurrentTime(&ts2);
 
   TimeInterval interval = ts2 - ts1;
@@ -136,6 +160,25 @@ void UartDmxThread::CheckTimeGranularity() {
   OLA_INFO << "Granularity for UART thread is "
            << (m_granularity == GOOD ? "GOOD" : "BAD");
 }
+
+
+/**
+ * Copy the frame statistics to the ExportMap.
+ */
+void UartDmxThread::UpdateExportedStats() {
+  if (!m_frame_rate_map) {
+    return;
+  }
+
+  FramePacer::Stats stats;
+  m_pacer.GetStats(&stats);
+  const string &device = m_widget->Name();
+  (*m_frame_rate_map)[device] = static_cast<unsigned int>(
+      stats.frame_rate + 0.5);
+  (*m_jitter_map)[device] = stats.mean_jitter;
+  (*m_max_jitter_map)[device] = stats.max_jitter;
+  (*m_overrun_map)[device] = static_cast<unsigned int>(stats.overruns);
+}
 }  // namespace uartdmx
 }  // namespace plugin
 }  // namespace ola
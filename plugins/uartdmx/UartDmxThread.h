@@ -23,7 +23,12 @@
 #define PLUGINS_UARTDMX_UARTDMXTHREAD_H_
 
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/thread/FramePacer.h"
 #include "ola/thread/Thread.h"
+#include "ola/thread/TripleBuffer.h"
+#include "ola/thread/Utils.h"
+#include "plugins/uartdmx/UartWidget.h"
 
 namespace ola {
 namespace plugin {
@@ -31,28 +36,73 @@ namespace uartdmx {
 
 class UartDmxThread : public ola::thread::Thread {
  public:
-  UartDmxThread(UartWidget *widget, unsigned int breakt, unsigned int malft);
+  struct Options {
+    unsigned int breakt;  // the break time in us
+    unsigned int malft;  // the mark after last frame time in us
+    unsigned int frame_rate;  // frames per second, 0 sends frames back to back
+    unsigned int spin_time;  // time to busy wait before each deadline, in us
+    ola::thread::SchedulingOptions scheduling;
+
+    Options()
+        : breakt(100),
+          malft(100),
+          frame_rate(0),
+          spin_time(0) {
+    }
+  };
+
+  /**
+   * @brief Create a new UartDmxThread.
+   * @param widget the widget to send on.
+   * @param options the timing options.
+   * @param export_map the ExportMap to publish the frame statistics to, may
+   *   be NULL.
+   */
+  UartDmxThread(UartWidget *widget, const Options &options,
+                ExportMap *export_map);
   ~UartDmxThread();
 
   bool Stop();
   void *Run();
+
+  /**
+   * @brief Copy a DmxBuffer to the output thread.
+   *
+   * This is called from the main thread, so it also updates the exported
+   * frame statistics. It never blocks, a frame the thread hasn't sent yet is
+   * replaced.
+   */
   bool WriteDMX(const DmxBuffer &buffer);
 
+  // The exported frame statistics, keyed by DEVICE_KEY.
+  static const char FRAME_RATE_VAR[];
+  static const char JITTER_VAR[];
+  static const char MAX_JITTER_VAR[];
+  static const char OVERRUN_VAR[];
+  static const char DEVICE_KEY[];
+
+  // The mark after break time in us.
+  static const uint32_t DMX_MAB = 16;
+
  private:
   enum TimerGranularity { UNKNOWN, GOOD, BAD };
 
   TimerGranularity m_granularity;
   UartWidget *m_widget;
   bool m_term;
-  unsigned int m_breakt;
-  unsigned int m_malft;
-  DmxBuffer m_buffer;
+  const Options m_options;
+  const unsigned int m_frame_time;
+  ola::thread::TripleBuffer<DmxBuffer> m_frames;
+  ola::thread::FramePacer m_pacer;
   ola::thread::Mutex m_term_mutex;
-  ola::thread::Mutex m_buffer_mutex;
 
-  void CheckTimeGranularity();
+  UIntMap *m_frame_rate_map;
+  UIntMap *m_jitter_map;
+  UIntMap *m_max_jitter_map;
+  UIntMap *m_overrun_map;
 
-  static const uint32_t DMX_MAB = 16;
+  void CheckTimeGranularity();
+  void UpdateExportedStats();
 
   DISALLOW_COPY_AND_ASSIGN(UartDmxThread);
 };
@@ -33,7 +33,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -42,6 +44,7 @@
 #include <vector>
 
 #include "ola/Constants.h"
+#include "ola/io/Descriptor.h"
 #include "ola/io/ExtendedSerial.h"
 #include "ola/io/IOUtils.h"
 #include "ola/Logging.h"
@@ -133,6 +136,31 @@ bool UartWidget::Write(const ola::DmxBuffer& data) {
   }
 }
 
+bool UartWidget::SetNonBlocking() {
+  return ola::io::ConnectedDescriptor::SetNonBlocking(m_fd);
+}
+
+int UartWidget::WriteSome(const uint8_t *data, unsigned int length) {
+  ssize_t written = write(m_fd, data, length);
+  if (written < 0) {
+    if (errno == EAGAIN || errno == EINTR) {
+      return 0;
+    }
+    OLA_WARN << Name() << " write failed: " << strerror(errno);
+    return -1;
+  }
+  return static_cast<int>(written);
+}
+
+int UartWidget::OutputQueueSize() {
+  int pending = 0;
+  if (ioctl(m_fd, TIOCOUTQ, &pending) < 0) {
+    OLA_WARN << Name() << " ioctl(TIOCOUTQ) failed";
+    return -1;
+  }
+  return pending;
+}
+
 bool UartWidget::Read(unsigned char *buff, int size) {
   int readb = read(m_fd, buff, size);
   if (readb <= 0) {
@@ -31,6 +31,7 @@
 #ifndef PLUGINS_UARTDMX_UARTWIDGET_H_
 #define PLUGINS_UARTDMX_UARTWIDGET_H_
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include "ola/base/Macro.h"
@@ -65,14 +66,29 @@ class UartWidget {
     bool Close();
 
     /** Check if the widget is open */
-    bool IsOpen() const;
+    virtual bool IsOpen() const;
 
     /** Toggle communications line BREAK condition on/off */
-    bool SetBreak(bool on);
+    virtual bool SetBreak(bool on);
 
     /** Write data to a previously-opened line */
     bool Write(const ola::DmxBuffer &data);
 
+    /** Put the line into non-blocking mode, for WriteSome() */
+    virtual bool SetNonBlocking();
+
+    /**
+     * Write as much data as the line will take without blocking.
+     * @returns the number of bytes written, or -1 on error.
+     */
+    virtual int WriteSome(const uint8_t *data, unsigned int length);
+
+    /**
+     * Get the number of bytes waiting to be sent.
+     * @returns the number of bytes, or -1 on error.
+     */
+    virtual int OutputQueueSize();
+
     /** Read data from a previously-opened line */
     bool Read(unsigned char* buff, int size);
 
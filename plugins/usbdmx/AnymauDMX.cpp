@@ -26,9 +26,12 @@
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/Logging.h"
 #include "ola/Constants.h"
+#include "ola/base/Flags.h"
 #include "plugins/usbdmx/AsyncUsbSender.h"
 #include "plugins/usbdmx/ThreadedUsbSender.h"
 
+DECLARE_uint8(libusb_transfers);
+
 namespace ola {
 namespace plugin {
 namespace usbdmx {
@@ -118,14 +121,12 @@ bool SynchronousAnymauDMX::SendDMX(const DmxBuffer &buffer) {
 class AnymaAsyncUsbSender : public AsyncUsbSender {
  public:
   AnymaAsyncUsbSender(LibUsbAdaptor *adaptor, libusb_device *usb_device)
-      : AsyncUsbSender(adaptor, usb_device) {
-    m_control_setup_buffer =
-        new uint8_t[LIBUSB_CONTROL_SETUP_SIZE + DMX_UNIVERSE_SIZE];
+      : AsyncUsbSender(adaptor, usb_device, FLAGS_libusb_transfers,
+                       LIBUSB_CONTROL_SETUP_SIZE + DMX_UNIVERSE_SIZE) {
   }
 
   ~AnymaAsyncUsbSender() {
     CancelTransfer();
-    delete[] m_control_setup_buffer;
   }
 
   libusb_device_handle* SetupHandle() {
@@ -136,8 +137,9 @@ class AnymaAsyncUsbSender : public AsyncUsbSender {
   }
 
   bool PerformTransfer(const DmxBuffer &buffer) {
+    uint8_t *control_setup_buffer = TransferBuffer();
     m_adaptor->FillControlSetup(
-        m_control_setup_buffer,
+        control_setup_buffer,
         LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE |
         LIBUSB_ENDPOINT_OUT,  // bmRequestType
         UDMX_SET_CHANNEL_RANGE,  // bRequest
@@ -146,15 +148,13 @@ class AnymaAsyncUsbSender : public AsyncUsbSender {
         buffer.Size());  // wLength
 
     unsigned int length = DMX_UNIVERSE_SIZE;
-    buffer.Get(m_control_setup_buffer + LIBUSB_CONTROL_SETUP_SIZE, &length);
+    buffer.Get(control_setup_buffer + LIBUSB_CONTROL_SETUP_SIZE, &length);
 
-    FillControlTransfer(m_control_setup_buffer, URB_TIMEOUT_MS);
+    FillControlTransfer(control_setup_buffer, URB_TIMEOUT_MS);
     return (SubmitTransfer() == 0);
   }
 
  private:
-  uint8_t *m_control_setup_buffer;
-
   DISALLOW_COPY_AND_ASSIGN(AnymaAsyncUsbSender);
 };
 
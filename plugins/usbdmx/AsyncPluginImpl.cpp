@@ -31,6 +31,7 @@
 #include "ola/thread/Future.h"
 #include "ola/util/Deleter.h"
 #include "olad/PluginAdaptor.h"
+#include "olad/ThreadPreferences.h"
 
 #include "libs/usb/JaRuleWidget.h"
 #include "libs/usb/LibUsbAdaptor.h"
@@ -51,6 +52,7 @@
 #include "plugins/usbdmx/JaRuleDevice.h"
 #include "plugins/usbdmx/JaRuleFactory.h"
 #include "plugins/usbdmx/ScanlimeFadecandy.h"
+#include "plugins/usbdmx/ScanlimeFadecandyDevice.h"
 #include "plugins/usbdmx/ScanlimeFadecandyFactory.h"
 #include "plugins/usbdmx/ShowJockeyDMXU1Factory.h"
 #include "plugins/usbdmx/SunliteFactory.h"
@@ -95,13 +97,16 @@ class DeviceState {
 AsyncPluginImpl::AsyncPluginImpl(PluginAdaptor *plugin_adaptor,
                                  Plugin *plugin,
                                  unsigned int debug_level,
-                                 Preferences *preferences)
+                                 Preferences *preferences,
+                                 bool use_event_loop)
     : m_plugin_adaptor(plugin_adaptor),
       m_plugin(plugin),
       m_debug_level(debug_level),
       m_preferences(preferences),
+      m_use_event_loop(use_event_loop),
       m_widget_observer(this, plugin_adaptor),
-      m_usb_adaptor(NULL) {
+      m_usb_adaptor(NULL),
+      m_removal_timeout(ola::thread::INVALID_TIMEOUT) {
 }
 
 AsyncPluginImpl::~AsyncPluginImpl() {
@@ -110,12 +115,15 @@ AsyncPluginImpl::~AsyncPluginImpl() {
 
 bool AsyncPluginImpl::Start() {
   auto_ptr<HotplugAgent> agent(new HotplugAgent(
-      NewCallback(this, &AsyncPluginImpl::DeviceEvent), m_debug_level));
+      NewCallback(this, &AsyncPluginImpl::DeviceEvent), m_debug_level,
+      ThreadPreferences::Load(m_preferences),
+      m_use_event_loop ? m_plugin_adaptor : NULL));
 
   if (!agent->Init()) {
     return false;
   }
 
+  m_use_event_loop = agent->UsesEventLoop();
   m_usb_adaptor = agent->GetUSBAdaptor();
 
   // Setup the factories.
@@ -130,12 +138,13 @@ bool AsyncPluginImpl::Start() {
   m_widget_factories.push_back(
       new JaRuleFactory(m_plugin_adaptor, m_usb_adaptor));
   m_widget_factories.push_back(
-      new ScanlimeFadecandyFactory(m_usb_adaptor));
+      new ScanlimeFadecandyFactory(m_usb_adaptor, m_preferences));
   m_widget_factories.push_back(new ShowJockeyDMXU1Factory(m_usb_adaptor));
   m_widget_factories.push_back(new SunliteFactory(m_usb_adaptor));
   m_widget_factories.push_back(new VellemanK8062Factory(m_usb_adaptor));
 
-  // If we're using hotplug, this starts the hotplug thread.
+  // If we're using hotplug, this starts the hotplug thread, unless we're
+  // using the event loop.
   if (!agent->Start()) {
     STLDeleteElements(&m_widget_factories);
     return false;
@@ -152,6 +161,11 @@ bool AsyncPluginImpl::Stop() {
 
   m_agent->HaltNotifications();
 
+  if (m_removal_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_plugin_adaptor->RemoveTimeout(m_removal_timeout);
+  }
+  RemoveDevices();
+
   // Now we're free to use m_device_map.
   USBDeviceMap::iterator iter = m_device_map.begin();
   for (; iter != m_device_map.end(); ++iter) {
@@ -218,7 +232,7 @@ bool AsyncPluginImpl::NewWidget(JaRuleWidget *widget) {
 bool AsyncPluginImpl::NewWidget(ScanlimeFadecandy *widget) {
   return StartAndRegisterDevice(
       widget,
-      new GenericDevice(
+      new ScanlimeFadecandyDevice(
           m_plugin, widget,
           "Fadecandy USB Device (" + widget->SerialNumber() + ")",
           "fadecandy-" + widget->SerialNumber()));
@@ -247,7 +261,8 @@ bool AsyncPluginImpl::NewWidget(VellemanK8062 *widget) {
 
 /**
  * This is run in either the thread calling Start() or a hotplug thread,
- * but not both at once.
+ * but not both at once. When using the event loop, it's always run in the
+ * main thread.
  */
 void AsyncPluginImpl::DeviceEvent(HotplugAgent::EventType event,
                                   struct libusb_device *device) {
@@ -264,6 +279,17 @@ void AsyncPluginImpl::DeviceEvent(HotplugAgent::EventType event,
     // Sunlite plugin, if we make the f/w load async we'll need to let the
     // factory cancel the load.
 
+    if (m_use_event_loop) {
+      // We may be within libusb_handle_events(), which can't be re-entered to
+      // wait for the widget's transfers to be cancelled.
+      m_removed_devices.push_back(state);
+      if (m_removal_timeout == ola::thread::INVALID_TIMEOUT) {
+        m_removal_timeout = m_plugin_adaptor->RegisterSingleTimeout(
+            0, NewSingleCallback(this, &AsyncPluginImpl::RemoveDevices));
+      }
+      return;
+    }
+
     // Unregister & delete the device in the main thread.
     if (state->ola_device) {
       Future<void> f;
@@ -365,6 +391,25 @@ void AsyncPluginImpl::ShutdownDevice(Device *device, Future<void> *f) {
     f->Set();
   }
 }
+
+/*
+ * @brief Remove the devices that were unplugged while handling libusb events.
+ *
+ * This is run within the main thread.
+ */
+void AsyncPluginImpl::RemoveDevices() {
+  m_removal_timeout = ola::thread::INVALID_TIMEOUT;
+  std::vector<DeviceState*>::iterator iter = m_removed_devices.begin();
+  for (; iter != m_removed_devices.end(); ++iter) {
+    DeviceState *state = *iter;
+    if (state->ola_device) {
+      ShutdownDevice(state->ola_device, NULL);
+    }
+    state->DeleteWidget();
+    delete state;
+  }
+  m_removed_devices.clear();
+}
 }  // namespace usbdmx
 }  // namespace plugin
 }  // namespace ola
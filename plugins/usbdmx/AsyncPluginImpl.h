@@ -38,6 +38,7 @@
 
 #include "ola/base/Macro.h"
 #include "ola/thread/Future.h"
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/Preferences.h"
 #include "plugins/usbdmx/PluginImplInterface.h"
 #include "plugins/usbdmx/SyncronizedWidgetObserver.h"
@@ -67,11 +68,14 @@ class AsyncPluginImpl: public PluginImplInterface, public WidgetObserver {
    * devices.
    * @param debug_level the debug level to use for libusb.
    * @param preferences The Preferences container used by the plugin
+   * @param use_event_loop handle libusb events in olad's SelectServer rather
+   * than a dedicated thread, if the platform supports it.
    */
   AsyncPluginImpl(PluginAdaptor *plugin_adaptor,
                   Plugin *plugin,
                   unsigned int debug_level,
-                  Preferences *preferences);
+                  Preferences *preferences,
+                  bool use_event_loop = false);
   ~AsyncPluginImpl();
 
   bool Start();
@@ -98,11 +102,16 @@ class AsyncPluginImpl: public PluginImplInterface, public WidgetObserver {
   const unsigned int m_debug_level;
   std::auto_ptr<ola::usb::HotplugAgent> m_agent;
   Preferences* const m_preferences;
+  bool m_use_event_loop;
 
   SyncronizedWidgetObserver m_widget_observer;
   ola::usb::AsyncronousLibUsbAdaptor *m_usb_adaptor;  // not owned
   WidgetFactories m_widget_factories;
   USBDeviceMap m_device_map;
+  // Devices that were unplugged while handling libusb events, which are
+  // removed once the event handling returns.
+  std::vector<class DeviceState*> m_removed_devices;
+  ola::thread::timeout_id m_removal_timeout;
 
   void DeviceEvent(ola::usb::HotplugAgent::EventType event,
                    struct libusb_device *device);
@@ -112,6 +121,7 @@ class AsyncPluginImpl: public PluginImplInterface, public WidgetObserver {
   bool StartAndRegisterDevice(Widget *widget, Device *device);
 
   void ShutdownDevice(Device *device, ola::thread::Future<void> *f);
+  void RemoveDevices();
 
   DISALLOW_COPY_AND_ASSIGN(AsyncPluginImpl);
 };
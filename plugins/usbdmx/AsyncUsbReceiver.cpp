@@ -28,10 +28,14 @@ namespace usbdmx {
 
 AsyncUsbReceiver::AsyncUsbReceiver(ola::usb::LibUsbAdaptor *adaptor,
                                    libusb_device *usb_device,
-                                   PluginAdaptor *plugin_adaptor)
-    : AsyncUsbTransceiverBase(adaptor, usb_device),
+                                   PluginAdaptor *plugin_adaptor,
+                                   unsigned int transfer_count,
+                                   unsigned int buffer_size)
+    : AsyncUsbTransceiverBase(adaptor, usb_device, transfer_count,
+                              buffer_size),
       m_plugin_adaptor(plugin_adaptor),
-      m_inited_with_handle(false) {
+      m_inited_with_handle(false),
+      m_callback_thread(ola::thread::Thread::Self()) {
 }
 
 AsyncUsbReceiver::~AsyncUsbReceiver() {
@@ -58,40 +62,52 @@ bool AsyncUsbReceiver::Start() {
     return false;
   }
   ola::thread::MutexLocker locker(&m_mutex);
-  return PerformTransfer();
+  bool ok = false;
+  while (SelectFreeTransfer() && PerformTransfer()) {
+    ok = true;
+  }
+  return ok;
 }
 
 void AsyncUsbReceiver::TransferComplete(struct libusb_transfer *transfer) {
-  if (transfer != m_transfer) {
-    OLA_WARN << "Mismatched libusb transfer: " << transfer << " != "
-             << m_transfer;
-    return;
-  }
-
   if (transfer->status != LIBUSB_TRANSFER_COMPLETED &&
       transfer->status != LIBUSB_TRANSFER_TIMED_OUT ) {
     OLA_WARN << "Transfer returned " << transfer->status;
   }
 
-  ola::thread::MutexLocker locker(&m_mutex);
-  m_transfer_state = (transfer->status == LIBUSB_TRANSFER_NO_DEVICE ?
-      DISCONNECTED : IDLE);
+  bool changed = false;
+  {
+    ola::thread::MutexLocker locker(&m_mutex);
+    TimeInterval latency;
+    if (!MarkTransferDone(transfer, &latency)) {
+      OLA_WARN << "Mismatched libusb transfer: " << transfer << " != "
+               << m_transfer;
+      return;
+    }
 
-  if (m_suppress_continuation) {
-    return;
-  }
+    if (m_suppress_continuation) {
+      return;
+    }
 
-  if (transfer->status != LIBUSB_TRANSFER_TIMED_OUT) {
-    if (TransferCompleted(&m_rx_buffer, transfer->actual_length)) {
-      // Input changed
-      if (m_receive_callback.get()) {
-        m_plugin_adaptor->Execute(m_receive_callback.get());
-      }
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+      changed = TransferCompleted(&m_rx_buffer, transfer->actual_length);
     }
+
+    // Resubmit the transfer before handing the data on.
+    PerformTransfer();
   }
 
-  // Start next request
-  PerformTransfer();
+  if (!changed || !m_receive_callback.get()) {
+    return;
+  }
+
+  // The callback reads the input with GetDmx(), so it's run without holding
+  // m_mutex.
+  if (pthread_equal(m_callback_thread, ola::thread::Thread::Self())) {
+    m_receive_callback->Run();
+  } else {
+    m_plugin_adaptor->Execute(m_receive_callback.get());
+  }
 }
 }  // namespace usbdmx
 }  // namespace plugin
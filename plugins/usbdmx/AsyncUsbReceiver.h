@@ -30,6 +30,7 @@
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
 #include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
 #include "olad/PluginAdaptor.h"
 
 namespace ola {
@@ -42,6 +43,13 @@ namespace usbdmx {
  *
  * This encapsulates much of the asynchronous libusb logic. Subclasses should
  * implement the SetupHandle() and PerformTransfer() methods.
+ *
+ * Up to transfer_count transfers are kept submitted, so the device always has
+ * a request to answer while the last one is being processed. The receive
+ * callback only runs when TransferCompleted() reports that the input changed.
+ * If the transfer completes on the thread that set the callback, i.e. libusb
+ * events are handled by olad's SelectServer, it's run straight away rather
+ * than being queued with Execute().
  */
 class AsyncUsbReceiver: public AsyncUsbTransceiverBase {
  public:
@@ -50,10 +58,15 @@ class AsyncUsbReceiver: public AsyncUsbTransceiverBase {
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
    * @param plugin_adaptor the PluginAdaptor to use for the widget.
+   * @param transfer_count the number of transfers to keep submitted.
+   * @param buffer_size the size of the buffer allocated for each transfer,
+   *   see TransferBuffer().
    */
   AsyncUsbReceiver(ola::usb::LibUsbAdaptor* const adaptor,
                    libusb_device *usb_device,
-                   PluginAdaptor *plugin_adaptor);
+                   PluginAdaptor *plugin_adaptor,
+                   unsigned int transfer_count = 1,
+                   unsigned int buffer_size = 0);
 
   /**
    * @brief Destructor
@@ -75,16 +88,19 @@ class AsyncUsbReceiver: public AsyncUsbTransceiverBase {
 
   /**
    * @brief Start receiving DMX
-   * @returns the value of PerformTransfer().
+   * @returns true if at least one transfer was submitted.
    */
   bool Start();
 
   /**
    * @brief Set the callback to be called when the receive buffer is updated.
    * @param callback The callback to call.
+   *
+   * This must be called from the thread the callback should run on.
    */
   void SetReceiveCallback(Callback0<void> *callback) {
     m_receive_callback.reset(callback);
+    m_callback_thread = ola::thread::Thread::Self();
   }
 
   /**
@@ -109,8 +125,9 @@ class AsyncUsbReceiver: public AsyncUsbTransceiverBase {
    * @returns true if the transfer was scheduled, false otherwise.
    *
    * This method is implemented by the subclass. The subclass should call
-   * FillControlTransfer() / FillBulkTransfer() as appropriate and then call
-   * SubmitTransfer().
+   * FillControlTransfer() / FillBulkTransfer() / FillInterruptTransfer() as
+   * appropriate and then call SubmitTransfer(). If more than one transfer is
+   * used, the data should be received into TransferBuffer().
    */
   virtual bool PerformTransfer() = 0;
 
@@ -118,7 +135,7 @@ class AsyncUsbReceiver: public AsyncUsbTransceiverBase {
    * @brief Called when the transfer completes.
    * @param buffer the DmxBuffer to receive into
    * @param transferred_size the number of bytes actually transferred
-   * returns true if the buffer was updated
+   * returns true if the buffer changed
    */
   virtual bool TransferCompleted(DmxBuffer *buffer, int transferred_size) = 0;
 
@@ -128,6 +145,7 @@ class AsyncUsbReceiver: public AsyncUsbTransceiverBase {
 
   DmxBuffer m_rx_buffer;  // GUARDED_BY(m_mutex);
   std::auto_ptr<Callback0<void> > m_receive_callback;
+  ola::thread::ThreadId m_callback_thread;
 
   DISALLOW_COPY_AND_ASSIGN(AsyncUsbReceiver);
 };
@@ -29,13 +29,25 @@ namespace usbdmx {
 
 using ola::usb::LibUsbAdaptor;
 
+const unsigned int AsyncUsbSender::MAX_TRANSFER_COUNT;
+
 AsyncUsbSender::AsyncUsbSender(LibUsbAdaptor *adaptor,
-                               libusb_device *usb_device)
-    : AsyncUsbTransceiverBase(adaptor, usb_device),
+                               libusb_device *usb_device,
+                               unsigned int transfer_count,
+                               unsigned int buffer_size)
+    : AsyncUsbTransceiverBase(adaptor, usb_device,
+                              TransferCount(transfer_count), buffer_size),
       m_pending_tx(false) {
 }
 
 AsyncUsbSender::~AsyncUsbSender() {
+  if (m_stats.transfers_sent) {
+    OLA_INFO << "USB sender completed " << m_stats.transfers_sent
+             << " transfers, " << m_stats.frames_dropped
+             << " frames dropped, latency mean "
+             << m_stats.total_latency.AsInt() / m_stats.transfers_sent
+             << "us, max " << m_stats.max_latency.AsInt() << "us";
+  }
   m_adaptor->Close(m_usb_handle);
 }
 
@@ -45,11 +57,15 @@ bool AsyncUsbSender::SendDMX(const DmxBuffer &buffer) {
     return false;
   }
   ola::thread::MutexLocker locker(&m_mutex);
-  if (m_transfer_state == IDLE) {
+  if (CanStartFrame()) {
+    m_pending_tx = false;
     PerformTransfer(buffer);
   } else {
-    // Buffer incoming data so we can send it when the outstanding transfers
-    // complete.
+    // Buffer incoming data so we can send it when a transfer completes. Only
+    // the latest frame is kept.
+    if (m_pending_tx) {
+      m_stats.frames_dropped++;
+    }
     m_pending_tx = true;
     m_tx_buffer.Set(buffer);
   }
@@ -57,20 +73,23 @@ bool AsyncUsbSender::SendDMX(const DmxBuffer &buffer) {
 }
 
 void AsyncUsbSender::TransferComplete(struct libusb_transfer *transfer) {
-  if (transfer != m_transfer) {
-    OLA_WARN << "Mismatched libusb transfer: " << transfer << " != "
-             << m_transfer;
-    return;
-  }
-
   if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
     OLA_WARN << "Transfer returned "
              << m_adaptor->ErrorCodeToString(transfer->status);
   }
 
   ola::thread::MutexLocker locker(&m_mutex);
-  m_transfer_state = (transfer->status == LIBUSB_TRANSFER_NO_DEVICE ?
-      DISCONNECTED : IDLE);
+  TimeInterval latency;
+  if (!MarkTransferDone(transfer, &latency)) {
+    OLA_WARN << "Mismatched libusb transfer: " << transfer;
+    return;
+  }
+
+  m_stats.transfers_sent++;
+  m_stats.total_latency += latency;
+  if (latency > m_stats.max_latency) {
+    m_stats.max_latency = latency;
+  }
 
   if (m_suppress_continuation) {
     return;
@@ -78,11 +97,24 @@ void AsyncUsbSender::TransferComplete(struct libusb_transfer *transfer) {
 
   PostTransferHook();
 
-  if ((m_transfer_state == IDLE) && m_pending_tx) {
+  if (m_pending_tx && CanStartFrame()) {
     m_pending_tx = false;
     PerformTransfer(m_tx_buffer);
   }
 }
+
+void AsyncUsbSender::GetTransferStats(TransferStats *stats) {
+  ola::thread::MutexLocker locker(&m_mutex);
+  *stats = m_stats;
+}
+
+unsigned int AsyncUsbSender::TransferCount(unsigned int transfer_count) {
+  if (transfer_count < 1) {
+    return 1;
+  }
+  return transfer_count > MAX_TRANSFER_COUNT ? MAX_TRANSFER_COUNT :
+      transfer_count;
+}
 }  // namespace usbdmx
 }  // namespace plugin
 }  // namespace ola
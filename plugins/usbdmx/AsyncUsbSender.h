@@ -23,8 +23,11 @@
 
 #include <libusb.h>
 
+#include <stdint.h>
+
 #include "AsyncUsbTransceiverBase.h"
 #include "libs/usb/LibUsbAdaptor.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
 #include "ola/thread/Mutex.h"
@@ -38,16 +41,40 @@ namespace usbdmx {
  *
  * This encapsulates much of the asynchronous libusb logic. Subclasses should
  * implement the SetupHandle() and PerformTransfer() methods.
+ *
+ * Devices that accept queued transfers can use more than one transfer. A new
+ * frame is sent as soon as a transfer is free, rather than waiting for the
+ * previous one to complete. If all the transfers are in flight, the latest
+ * frame is held until one completes, replacing any frame already waiting.
  */
 class AsyncUsbSender: public AsyncUsbTransceiverBase {
  public:
+  /**
+   * @brief Statistics for the transfers.
+   */
+  struct TransferStats {
+    uint64_t transfers_sent;  /**< The number of transfers completed */
+    uint64_t frames_dropped;  /**< Frames replaced by a newer one */
+    TimeInterval total_latency;  /**< The total completion latency */
+    TimeInterval max_latency;  /**< The max completion latency */
+
+    TransferStats() : transfers_sent(0), frames_dropped(0) {}
+  };
+
   /**
    * @brief Create a new AsyncUsbSender.
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
+   * @param transfer_count the number of transfers that can be in flight at
+   *   once, from 1 to MAX_TRANSFER_COUNT.
+   * @param buffer_size the size of the buffer for each transfer, 0 if the
+   *   subclass provides the buffers. This must be set if transfer_count is
+   *   more than 1.
    */
   AsyncUsbSender(ola::usb::LibUsbAdaptor* const adaptor,
-                 libusb_device *usb_device);
+                 libusb_device *usb_device,
+                 unsigned int transfer_count = 1,
+                 unsigned int buffer_size = 0);
 
   /**
    * @brief Destructor
@@ -68,6 +95,17 @@ class AsyncUsbSender: public AsyncUsbTransceiverBase {
    */
   void TransferComplete(struct libusb_transfer *transfer);
 
+  /**
+   * @brief Get the transfer statistics.
+   * @param[out] stats the statistics.
+   */
+  void GetTransferStats(TransferStats *stats);
+
+  /**
+   * @brief The max number of transfers that can be in flight.
+   */
+  static const unsigned int MAX_TRANSFER_COUNT = 8;
+
  protected:
   /**
    * @brief Perform the DMX transfer.
@@ -76,10 +114,20 @@ class AsyncUsbSender: public AsyncUsbTransceiverBase {
    *
    * This method is implemented by the subclass. The subclass should call
    * FillControlTransfer() / FillBulkTransfer() as appropriate and then call
-   * SubmitTransfer().
+   * SubmitTransfer(). If more than one transfer is used, the data must be
+   * written to TransferBuffer().
    */
   virtual bool PerformTransfer(const DmxBuffer &buffer) = 0;
 
+  /**
+   * @brief Check if a frame is still being sent.
+   * @returns true if a new frame can't be started yet.
+   *
+   * Devices that send each frame as several transfers should return true
+   * until the last transfer of the frame has been submitted.
+   */
+  virtual bool FrameInProgress() const { return false; }
+
   /**
    * @brief Called when the transfer completes.
    *
@@ -97,6 +145,13 @@ class AsyncUsbSender: public AsyncUsbTransceiverBase {
  private:
   DmxBuffer m_tx_buffer;  // GUARDED_BY(m_mutex);
   bool m_pending_tx;  // GUARDED_BY(m_mutex);
+  TransferStats m_stats;  // GUARDED_BY(m_mutex);
+
+  bool CanStartFrame() {
+    return !FrameInProgress() && SelectFreeTransfer();
+  }
+
+  static unsigned int TransferCount(unsigned int transfer_count);
 
   DISALLOW_COPY_AND_ASSIGN(AsyncUsbSender);
 };
@@ -20,6 +20,9 @@
 
 #include "plugins/usbdmx/AsyncUsbTransceiverBase.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/Logging.h"
 
@@ -45,20 +48,35 @@ void AsyncCallback(struct libusb_transfer *transfer) {
 }  // namespace
 
 AsyncUsbTransceiverBase::AsyncUsbTransceiverBase(LibUsbAdaptor *adaptor,
-                                                 libusb_device *usb_device)
+                                                 libusb_device *usb_device,
+                                                 unsigned int transfer_count,
+                                                 unsigned int buffer_size)
     : m_adaptor(adaptor),
       m_usb_device(usb_device),
       m_usb_handle(NULL),
       m_suppress_continuation(false),
-      m_transfer_state(IDLE) {
-  m_transfer = m_adaptor->AllocTransfer(0);
+      m_transfer_state(IDLE),
+      m_slots(std::max(transfer_count, 1u)),
+      m_current_slot(0),
+      m_in_flight(0) {
+  std::vector<TransferSlot>::iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    iter->transfer = m_adaptor->AllocTransfer(0);
+    iter->buffer = buffer_size ? new uint8_t[buffer_size] : NULL;
+    iter->in_flight = false;
+  }
+  m_transfer = m_slots[0].transfer;
   m_adaptor->RefDevice(usb_device);
 }
 
 AsyncUsbTransceiverBase::~AsyncUsbTransceiverBase() {
   CancelTransfer();
   m_adaptor->UnrefDevice(m_usb_device);
-  m_adaptor->FreeTransfer(m_transfer);
+  std::vector<TransferSlot>::iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    m_adaptor->FreeTransfer(iter->transfer);
+    delete[] iter->buffer;
+  }
 }
 
 bool AsyncUsbTransceiverBase::Init() {
@@ -73,23 +91,79 @@ void AsyncUsbTransceiverBase::CancelTransfer() {
 
   bool canceled = false;
   while (1) {
-    ola::thread::MutexLocker locker(&m_mutex);
-    if (m_transfer_state == IDLE || m_transfer_state == DISCONNECTED) {
-      break;
-    }
-    if (!canceled) {
-      m_suppress_continuation = true;
-      if (m_adaptor->CancelTransfer(m_transfer) == 0) {
-        canceled = true;
-      } else {
+    {
+      ola::thread::MutexLocker locker(&m_mutex);
+      if (m_transfer_state == IDLE || m_transfer_state == DISCONNECTED) {
         break;
       }
+      if (!canceled) {
+        m_suppress_continuation = true;
+        std::vector<TransferSlot>::iterator iter = m_slots.begin();
+        for (; iter != m_slots.end(); ++iter) {
+          if (iter->in_flight &&
+              m_adaptor->CancelTransfer(iter->transfer) == 0) {
+            canceled = true;
+          }
+        }
+        if (!canceled) {
+          break;
+        }
+      }
     }
+    // The completions may need to run on this thread, which must not hold
+    // m_mutex while they do.
+    m_adaptor->HandlePendingEvents();
   }
 
   m_suppress_continuation = false;
 }
 
+bool AsyncUsbTransceiverBase::SelectFreeTransfer() {
+  if (m_transfer_state == DISCONNECTED) {
+    return false;
+  }
+
+  // Round robin, so each transfer's buffer is reused as late as possible.
+  for (unsigned int i = 1; i <= m_slots.size(); i++) {
+    unsigned int slot = (m_current_slot + i) % m_slots.size();
+    if (!m_slots[slot].in_flight) {
+      m_current_slot = slot;
+      m_transfer = m_slots[slot].transfer;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AsyncUsbTransceiverBase::MarkTransferDone(
+    struct libusb_transfer *transfer,
+    TimeInterval *latency) {
+  unsigned int slot = 0;
+  while (slot < m_slots.size() && m_slots[slot].transfer != transfer) {
+    slot++;
+  }
+  if (slot == m_slots.size()) {
+    return false;
+  }
+
+  if (m_slots[slot].in_flight) {
+    m_slots[slot].in_flight = false;
+    m_in_flight--;
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    *latency = now - m_slots[slot].submit_time;
+  }
+  m_current_slot = slot;
+  m_transfer = transfer;
+
+  if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
+    m_transfer_state = DISCONNECTED;
+  } else if (m_transfer_state != DISCONNECTED) {
+    m_transfer_state = m_in_flight ? IN_PROGRESS : IDLE;
+  }
+  return true;
+}
+
 void AsyncUsbTransceiverBase::FillControlTransfer(unsigned char *buffer,
                                                   unsigned int timeout) {
   m_adaptor->FillControlTransfer(m_transfer, m_usb_handle, buffer,
@@ -122,6 +196,12 @@ int AsyncUsbTransceiverBase::SubmitTransfer() {
     }
     return false;
   }
+  TransferSlot *slot = &m_slots[m_current_slot];
+  if (!slot->in_flight) {
+    slot->in_flight = true;
+    m_in_flight++;
+  }
+  m_clock.CurrentTime(&slot->submit_time);
   m_transfer_state = IN_PROGRESS;
   return ret;
 }
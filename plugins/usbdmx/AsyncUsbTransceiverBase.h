@@ -22,8 +22,11 @@
 #define PLUGINS_USBDMX_ASYNCUSBTRANSCEIVERBASE_H_
 
 #include <libusb.h>
+#include <stdint.h>
+#include <vector>
 
 #include "libs/usb/LibUsbAdaptor.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
 #include "ola/thread/Mutex.h"
@@ -35,6 +38,11 @@ namespace usbdmx {
 /**
  * @brief A base class that implements common functionality to send or receive
  * DMX asynchronously to a libusb_device.
+ *
+ * The transfers are allocated up front. By default there is a single
+ * transfer, subclasses that can queue transfers to the device can ask for
+ * more, along with a buffer for each one so the data isn't overwritten while
+ * the transfer is in flight.
  */
 class AsyncUsbTransceiverBase {
  public:
@@ -42,9 +50,15 @@ class AsyncUsbTransceiverBase {
    * @brief Create a new AsyncUsbTransceiverBase.
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
+   * @param transfer_count the number of transfers that can be in flight at
+   *   once.
+   * @param buffer_size the size of the buffer allocated for each transfer,
+   *   see TransferBuffer(). 0 means the subclass provides the buffers.
    */
   AsyncUsbTransceiverBase(ola::usb::LibUsbAdaptor* const adaptor,
-                          libusb_device *usb_device);
+                          libusb_device *usb_device,
+                          unsigned int transfer_count = 1,
+                          unsigned int buffer_size = 0);
 
   /**
    * @brief Destructor
@@ -101,6 +115,35 @@ class AsyncUsbTransceiverBase {
    */
   void CancelTransfer();
 
+  /**
+   * @brief Select a transfer that isn't in flight.
+   * @returns true if a transfer was free, false if they are all in flight or
+   *   the device has gone.
+   *
+   * The Fill*Transfer() methods, SubmitTransfer() & TransferBuffer() apply
+   * to the selected transfer. This must be called with m_mutex held.
+   */
+  bool SelectFreeTransfer();
+
+  /**
+   * @brief The buffer for the selected transfer.
+   * @returns the buffer, or NULL if no buffer size was passed to the
+   *   constructor.
+   */
+  uint8_t *TransferBuffer() { return m_slots[m_current_slot].buffer; }
+
+  /**
+   * @brief Mark a transfer as complete.
+   * @param transfer the transfer passed to TransferComplete().
+   * @param[out] latency the time from submission to completion.
+   * @returns false if the transfer isn't one of ours.
+   *
+   * This must be called with m_mutex held. It updates m_transfer_state and
+   * selects the completed transfer.
+   */
+  bool MarkTransferDone(struct libusb_transfer *transfer,
+                        TimeInterval *latency);
+
   /**
    * @brief Fill a control transfer.
    * @param buffer passed to libusb_fill_control_transfer.
@@ -121,25 +164,37 @@ class AsyncUsbTransceiverBase {
                              int length, unsigned int timeout);
 
   /**
-   * @brief Submit the transfer for tx.
+   * @brief Submit the selected transfer.
    * @returns the result of libusb_submit_transfer().
    */
   int SubmitTransfer();
 
   enum TransferState {
-    IDLE,
-    IN_PROGRESS,
+    IDLE,  // no transfers are in flight
+    IN_PROGRESS,  // at least one transfer is in flight
     DISCONNECTED,
   };
 
   libusb_device_handle *m_usb_handle;
   bool m_suppress_continuation;
-  struct libusb_transfer *m_transfer;
+  struct libusb_transfer *m_transfer;  // the selected transfer
 
   TransferState m_transfer_state;  // GUARDED_BY(m_mutex);
   ola::thread::Mutex m_mutex;
 
  private:
+  struct TransferSlot {
+    struct libusb_transfer *transfer;
+    uint8_t *buffer;
+    bool in_flight;
+    TimeStamp submit_time;
+  };
+
+  std::vector<TransferSlot> m_slots;  // GUARDED_BY(m_mutex);
+  unsigned int m_current_slot;  // GUARDED_BY(m_mutex);
+  unsigned int m_in_flight;  // GUARDED_BY(m_mutex);
+  ola::Clock m_clock;
+
   DISALLOW_COPY_AND_ASSIGN(AsyncUsbTransceiverBase);
 };
 }  // namespace usbdmx
@@ -28,11 +28,14 @@
 #include "ola/Logging.h"
 #include "ola/Constants.h"
 #include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
 #include "plugins/usbdmx/AsyncUsbReceiver.h"
 #include "plugins/usbdmx/AsyncUsbSender.h"
 #include "plugins/usbdmx/ThreadedUsbReceiver.h"
 #include "plugins/usbdmx/ThreadedUsbSender.h"
 
+DECLARE_uint8(libusb_transfers);
+
 namespace ola {
 namespace plugin {
 namespace usbdmx {
@@ -330,7 +333,8 @@ class DMXCProjectsNodleU1AsyncUsbReceiver : public AsyncUsbReceiver {
                                       libusb_device *usb_device,
                                       PluginAdaptor *plugin_adaptor,
                                       unsigned int mode)
-      : AsyncUsbReceiver(adaptor, usb_device, plugin_adaptor),
+      : AsyncUsbReceiver(adaptor, usb_device, plugin_adaptor,
+                         FLAGS_libusb_transfers, DATABLOCK_SIZE),
         m_mode(mode) {
   }
 
@@ -353,13 +357,12 @@ class DMXCProjectsNodleU1AsyncUsbReceiver : public AsyncUsbReceiver {
 
  private:
   unsigned int m_mode;
-  uint8_t m_packet[DATABLOCK_SIZE];
 
   DISALLOW_COPY_AND_ASSIGN(DMXCProjectsNodleU1AsyncUsbReceiver);
 };
 
 bool DMXCProjectsNodleU1AsyncUsbReceiver::PerformTransfer() {
-  FillInterruptTransfer(READ_ENDPOINT, m_packet,
+  FillInterruptTransfer(READ_ENDPOINT, TransferBuffer(),
                         DATABLOCK_SIZE, URB_TIMEOUT_MS);
   return (SubmitTransfer() == 0);
 }
@@ -367,13 +370,20 @@ bool DMXCProjectsNodleU1AsyncUsbReceiver::PerformTransfer() {
 bool DMXCProjectsNodleU1AsyncUsbReceiver::TransferCompleted(
     DmxBuffer *buffer,
     int transferred_size) {
-  if (m_packet[0] < 16 &&
-      transferred_size >= static_cast<int>(DATABLOCK_SIZE)) {
-    uint16_t start_offset = m_packet[0] * 32;
-    buffer->SetRange(start_offset, &m_packet[1], 32);
-    return true;
+  const uint8_t *packet = TransferBuffer();
+  if (packet[0] >= 16 ||
+      transferred_size < static_cast<int>(DATABLOCK_SIZE)) {
+    return false;
+  }
+
+  // The widget sends each block repeatedly, only report the ones that change.
+  uint16_t start_offset = packet[0] * 32;
+  if (buffer->Size() >= start_offset + 32u &&
+      memcmp(buffer->GetRaw() + start_offset, &packet[1], 32) == 0) {
+    return false;
   }
-  return false;
+  buffer->SetRange(start_offset, &packet[1], 32);
+  return true;
 }
 
 // DMXCProjectsNodleU1AsyncUsbSender
@@ -383,7 +393,8 @@ class DMXCProjectsNodleU1AsyncUsbSender : public AsyncUsbSender {
   DMXCProjectsNodleU1AsyncUsbSender(ola::usb::LibUsbAdaptor *adaptor,
                                     libusb_device *usb_device,
                                     unsigned int mode)
-      : AsyncUsbSender(adaptor, usb_device),
+      : AsyncUsbSender(adaptor, usb_device, FLAGS_libusb_transfers,
+                       DATABLOCK_SIZE),
         m_mode(mode),
         m_buffer_offset(0) {
     m_tx_buffer.Blackout();
@@ -406,23 +417,20 @@ class DMXCProjectsNodleU1AsyncUsbSender : public AsyncUsbSender {
 
   void PostTransferHook();
 
+  bool FrameInProgress() const { return m_buffer_offset != 0; }
+
  private:
   unsigned int m_mode;
   DmxBuffer m_tx_buffer;
   // This tracks where we are in m_tx_buffer. A value of 0 means we're at the
   // start of a DMX frame.
   unsigned int m_buffer_offset;
-  uint8_t m_packet[DATABLOCK_SIZE];
 
   bool ContinueTransfer();
 
   bool SendInitialChunk(const DmxBuffer &buffer);
 
-  bool SendChunk() {
-    FillInterruptTransfer(WRITE_ENDPOINT, m_packet,
-                          DATABLOCK_SIZE, URB_TIMEOUT_MS);
-    return (SubmitTransfer() == 0);
-  }
+  bool SendChunk(unsigned int offset);
 
   DISALLOW_COPY_AND_ASSIGN(DMXCProjectsNodleU1AsyncUsbSender);
 };
@@ -437,47 +445,60 @@ bool DMXCProjectsNodleU1AsyncUsbSender::PerformTransfer(
 }
 
 void DMXCProjectsNodleU1AsyncUsbSender::PostTransferHook() {
-  if (m_buffer_offset < m_tx_buffer.Size()) {
+  if (m_buffer_offset) {
     ContinueTransfer();
-  } else if (m_buffer_offset >= m_tx_buffer.Size()) {
-    // That was the last chunk.
-    m_buffer_offset = 0;
-
-    if (TransferPending()) {
-      // If we have a pending transfer, the next chunk is going to be sent
-      // once we return.
-      m_tx_buffer.Reset();
-    }
   }
 }
 
+/*
+ * Send the remaining chunks of the frame, for as long as there are free
+ * transfers.
+ */
 bool DMXCProjectsNodleU1AsyncUsbSender::ContinueTransfer() {
-  unsigned int length = 32;
-
-  m_packet[0] = m_buffer_offset / 32;
-
-  m_tx_buffer.GetRange(m_buffer_offset, m_packet + 1, &length);
-  memset(m_packet + 1 + length, 0, 32 - length);
-  m_buffer_offset += length;
-  return (SendChunk() == 0);
+  bool ok = true;
+  while (m_buffer_offset && SelectFreeTransfer()) {
+    ok &= SendChunk(m_buffer_offset);
+    m_buffer_offset += 32;
+    if (m_buffer_offset >= m_tx_buffer.Size()) {
+      // That was the last chunk.
+      m_buffer_offset = 0;
+      if (TransferPending()) {
+        // If we have a pending transfer, it's going to be started once we
+        // return.
+        m_tx_buffer.Reset();
+      }
+    }
+  }
+  return ok;
 }
 
 bool DMXCProjectsNodleU1AsyncUsbSender::SendInitialChunk(
     const DmxBuffer &buffer) {
-  unsigned int length = 32;
-
   m_tx_buffer.SetRange(0, buffer.GetRaw(), buffer.Size());
 
-  m_packet[0] = 0;
-  m_tx_buffer.GetRange(0, m_packet + 1, &length);
-  memset(m_packet + 1 + length, 0, 32 - length);
-
-  unsigned int slots_sent = length;
-  if (slots_sent < m_tx_buffer.Size()) {
-    // There are more frames to send.
-    m_buffer_offset = slots_sent;
+  bool ok = SendChunk(0);
+  if (m_tx_buffer.Size() > 32) {
+    // There are more chunks to send.
+    m_buffer_offset = 32;
+    ok &= ContinueTransfer();
   }
-  return (SendChunk() == 0);
+  return ok;
+}
+
+/*
+ * Send the 32 slots starting at offset, using the selected transfer.
+ */
+bool DMXCProjectsNodleU1AsyncUsbSender::SendChunk(unsigned int offset) {
+  uint8_t *packet = TransferBuffer();
+  unsigned int length = 32;
+
+  packet[0] = offset / 32;
+  m_tx_buffer.GetRange(offset, packet + 1, &length);
+  memset(packet + 1 + length, 0, 32 - length);
+
+  FillInterruptTransfer(WRITE_ENDPOINT, packet, DATABLOCK_SIZE,
+                        URB_TIMEOUT_MS);
+  return (SubmitTransfer() == 0);
 }
 
 // AsynchronousDMXCProjectsNodleU1
@@ -27,10 +27,13 @@
 #include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/base/Flags.h"
 #include "ola/util/Utils.h"
 #include "plugins/usbdmx/AsyncUsbSender.h"
 #include "plugins/usbdmx/ThreadedUsbSender.h"
 
+DECLARE_uint8(libusb_transfers);
+
 namespace ola {
 namespace plugin {
 namespace usbdmx {
@@ -195,7 +198,8 @@ class EuroliteProAsyncUsbSender : public AsyncUsbSender {
  public:
   EuroliteProAsyncUsbSender(LibUsbAdaptor *adaptor,
                             libusb_device *usb_device)
-      : AsyncUsbSender(adaptor, usb_device) {
+      : AsyncUsbSender(adaptor, usb_device, FLAGS_libusb_transfers,
+                       EUROLITE_PRO_FRAME_SIZE) {
   }
 
   ~EuroliteProAsyncUsbSender() {
@@ -215,15 +219,14 @@ class EuroliteProAsyncUsbSender : public AsyncUsbSender {
   }
 
   bool PerformTransfer(const DmxBuffer &buffer) {
-    CreateFrame(buffer, m_tx_frame);
-    FillBulkTransfer(ENDPOINT, m_tx_frame, EUROLITE_PRO_FRAME_SIZE,
+    uint8_t *frame = TransferBuffer();
+    CreateFrame(buffer, frame);
+    FillBulkTransfer(ENDPOINT, frame, EUROLITE_PRO_FRAME_SIZE,
                      URB_TIMEOUT_MS);
     return (SubmitTransfer() == 0);
   }
 
  private:
-  uint8_t m_tx_frame[EUROLITE_PRO_FRAME_SIZE];
-
   DISALLOW_COPY_AND_ASSIGN(EuroliteProAsyncUsbSender);
 };
 
@@ -23,3 +23,7 @@
 DEFINE_default_bool(use_async_libusb, true,
     "Disable the use of the asyncronous libusb calls, revert to syncronous");
 
+DEFINE_uint8(libusb_transfers, 2,
+             "The number of asynchronous transfers that can be in flight for "
+             "devices that accept queued transfers, 1 - 8.");
+
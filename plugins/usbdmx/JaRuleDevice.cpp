@@ -43,6 +43,17 @@ JaRuleDevice::JaRuleDevice(ola::AbstractPlugin *owner,
       m_device_id(widget->GetUID().ToString()) {
 }
 
+/*
+ * The DMX frames for all the ports in a frame are submitted together.
+ */
+void JaRuleDevice::BeginFrame() {
+  m_widget->BeginFrame();
+}
+
+void JaRuleDevice::EndFrame() {
+  m_widget->EndFrame();
+}
+
 bool JaRuleDevice::StartHook() {
   for (uint8_t i = 0; i < m_widget->PortCount(); i++) {
     auto_ptr<JaRuleOutputPort> port(new JaRuleOutputPort(this, i, m_widget));
@@ -53,6 +53,9 @@ class JaRuleDevice: public Device {
     return m_device_id;
   }
 
+  void BeginFrame();
+  void EndFrame();
+
  protected:
   bool StartHook();
 
@@ -43,6 +43,8 @@ plugins_usbdmx_libolausbdmxwidget_la_SOURCES = \
     plugins/usbdmx/JaRuleFactory.h \
     plugins/usbdmx/ScanlimeFadecandy.cpp \
     plugins/usbdmx/ScanlimeFadecandy.h \
+    plugins/usbdmx/ScanlimeFadecandyDevice.cpp \
+    plugins/usbdmx/ScanlimeFadecandyDevice.h \
     plugins/usbdmx/ScanlimeFadecandyFactory.cpp \
     plugins/usbdmx/ScanlimeFadecandyFactory.h \
     plugins/usbdmx/ShowJockeyDMXU1.cpp \
@@ -24,14 +24,17 @@
 #include <unistd.h>
 #include <algorithm>
 #include <limits>
+#include <set>
 #include <string>
 
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/base/Array.h"
+#include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
 #include "ola/strings/Format.h"
+#include "ola/thread/Mutex.h"
 #include "ola/util/Utils.h"
 #include "plugins/usbdmx/AsyncUsbSender.h"
 #include "plugins/usbdmx/ThreadedUsbSender.h"
@@ -41,6 +44,7 @@ namespace plugin {
 namespace usbdmx {
 
 using ola::usb::LibUsbAdaptor;
+using ola::usb::USBDeviceID;
 using std::string;
 
 namespace {
@@ -71,6 +75,16 @@ static const unsigned int LUT_ROWS_PER_CHANNEL = 257;
 // Each 'packet' is 63 bytes, or 21 RGB pixels.
 enum { SLOTS_PER_PACKET = 63 };
 static const uint8_t PACKETS_PER_UPDATE = 25;
+// 8 strips of 64 pixels.
+static const unsigned int FRAME_SIZE = 8 * 64 * NUM_CHANNELS;
+// 170 pixels.
+static const unsigned int SLOTS_PER_UNIVERSE = 510;
+// The device rotates between this many framebuffers, so a changed packet has
+// to be sent in this many frames before all of them are up to date.
+static const uint8_t FRAMEBUFFER_COUNT = 3;
+// The longest the sender thread waits for pixels to change, so it notices
+// when it's asked to stop.
+static const unsigned int UNCHANGED_WAIT_MS = 40;
 // Each LUT 'packet' is 31 LUT rows, 62 bytes, plus a padding byte
 static const uint8_t LUT_ROWS_PER_PACKET = 31;
 // The padding byte offset
@@ -91,13 +105,100 @@ struct fadecandy_packet {
   }
 });
 
+/*
+ * The devices the LUT has been uploaded to since olad started. A device that's
+ * unplugged and plugged back in gets a new address, so it's sent the LUT
+ * again.
+ */
+ola::thread::Mutex lut_mutex;
+std::set<USBDeviceID> lut_devices;  // GUARDED_BY(lut_mutex)
+
+/*
+ * The pixels for all the universes, and the packets that need to be sent.
+ */
+class FadecandyFrame {
+ public:
+  FadecandyFrame() {
+    memset(m_frame, 0, sizeof(m_frame));
+    // Send everything at least once.
+    memset(m_pending, FRAMEBUFFER_COUNT, sizeof(m_pending));
+  }
+
+  void Update(unsigned int universe, const DmxBuffer &buffer);
+
+  /*
+   * Fill packets with the packets that need to be sent.
+   * @returns the number of packets.
+   */
+  unsigned int Pack(fadecandy_packet packets[PACKETS_PER_UPDATE]);
+
+ private:
+  uint8_t m_frame[PACKETS_PER_UPDATE * SLOTS_PER_PACKET];
+  // The number of frames each packet still needs to be sent in.
+  uint8_t m_pending[PACKETS_PER_UPDATE];
+};
+
+void FadecandyFrame::Update(unsigned int universe, const DmxBuffer &buffer) {
+  const unsigned int offset = universe * SLOTS_PER_UNIVERSE;
+  if (offset >= FRAME_SIZE) {
+    return;
+  }
+
+  // Slots past the end of the buffer are set to 0.
+  uint8_t data[SLOTS_PER_UNIVERSE];
+  memset(data, 0, sizeof(data));
+  unsigned int length = std::min(SLOTS_PER_UNIVERSE, FRAME_SIZE - offset);
+  unsigned int size = length;
+  buffer.GetRange(0, data, &size);
+
+  const unsigned int end = offset + length;
+  for (unsigned int start = offset; start < end;) {
+    const unsigned int packet_index = start / SLOTS_PER_PACKET;
+    const unsigned int packet_end = std::min(
+        end, (packet_index + 1) * SLOTS_PER_PACKET);
+    const uint8_t *new_data = data + start - offset;
+    if (memcmp(m_frame + start, new_data, packet_end - start)) {
+      memcpy(m_frame + start, new_data, packet_end - start);
+      m_pending[packet_index] = FRAMEBUFFER_COUNT;
+    }
+    start = packet_end;
+  }
+}
+
+unsigned int FadecandyFrame::Pack(
+    fadecandy_packet packets[PACKETS_PER_UPDATE]) {
+  unsigned int count = 0;
+  for (unsigned int packet_index = 0; packet_index < PACKETS_PER_UPDATE;
+       packet_index++) {
+    if (!m_pending[packet_index]) {
+      continue;
+    }
+    m_pending[packet_index]--;
+
+    fadecandy_packet *packet = &packets[count++];
+    packet->control = TYPE_FRAMEBUFFER | packet_index;
+    memcpy(packet->data, m_frame + packet_index * SLOTS_PER_PACKET,
+           SLOTS_PER_PACKET);
+  }
+
+  // The final packet tells the device to display the frame.
+  if (count) {
+    packets[count - 1].control |= FINAL;
+  }
+  return count;
+}
+
 bool InitializeWidget(LibUsbAdaptor *adaptor,
-                      libusb_device_handle *usb_handle) {
+                      libusb_device_handle *usb_handle,
+                      const USBDeviceID &device_id,
+                      const ScanlimeFadecandy::Options &options) {
   // Set the fadecandy configuration.
   fadecandy_packet packet;
   packet.control = TYPE_CONFIG;
-  packet.data[0] |= OPTION_NO_DITHERING;  // Default to no processing
-  packet.data[0] |= OPTION_NO_INTERPOLATION;
+  if (!options.interpolation) {
+    packet.data[0] |= OPTION_NO_DITHERING;  // Default to no processing
+    packet.data[0] |= OPTION_NO_INTERPOLATION;
+  }
 
   // packet.data[0] = OPTION_NO_ACTIVITY_LED;  // Manual control of LED
   // packet.data[0] |= OPTION_LED_CONTROL;  // Manual LED state
@@ -114,6 +215,14 @@ bool InitializeWidget(LibUsbAdaptor *adaptor,
     return false;
   }
 
+  if (options.lut_once) {
+    ola::thread::MutexLocker locker(&lut_mutex);
+    if (lut_devices.find(device_id) != lut_devices.end()) {
+      OLA_INFO << "LUT already uploaded to " << device_id;
+      return true;
+    }
+  }
+
   // Build the Look Up Table
   uint16_t lut[NUM_CHANNELS * LUT_ROWS_PER_CHANNEL];
   memset(&lut, 0, sizeof(lut));
@@ -177,27 +286,11 @@ bool InitializeWidget(LibUsbAdaptor *adaptor,
     return false;
   }
 
+  ola::thread::MutexLocker locker(&lut_mutex);
+  lut_devices.insert(device_id);
   return true;
 }
 
-void UpdatePacketsWithDMX(fadecandy_packet packets[PACKETS_PER_UPDATE],
-                          const DmxBuffer &buffer) {
-  for (unsigned int packet_index = 0; packet_index < PACKETS_PER_UPDATE;
-       packet_index++) {
-    packets[packet_index].Reset();
-
-    unsigned int dmx_offset = packet_index * SLOTS_PER_PACKET;
-    unsigned int slots_in_packet = SLOTS_PER_PACKET;
-    buffer.GetRange(dmx_offset, packets[packet_index].data,
-                    &slots_in_packet);
-
-    packets[packet_index].control = TYPE_FRAMEBUFFER | packet_index;
-    if (packet_index == (PACKETS_PER_UPDATE - 1)) {
-      packets[packet_index].control |= FINAL;
-    }
-  }
-}
-
 }  // namespace
 
 // FadecandyThreadedSender
@@ -215,25 +308,59 @@ class FadecandyThreadedSender: public ThreadedUsbSender {
         m_adaptor(adaptor) {
   }
 
+  bool SendUniverse(unsigned int universe, const DmxBuffer &buffer);
+
  private:
   LibUsbAdaptor* const m_adaptor;
+  FadecandyFrame m_frame;  // GUARDED_BY(m_frame_mutex)
+  ola::thread::Mutex m_frame_mutex;
+  ola::thread::ConditionVariable m_frame_changed;
+  ola::Clock m_clock;
   fadecandy_packet m_data_packets[PACKETS_PER_UPDATE];
 
   bool TransmitBuffer(libusb_device_handle *handle,
                       const DmxBuffer &buffer);
 };
 
-bool FadecandyThreadedSender::TransmitBuffer(libusb_device_handle *handle,
-                                             const DmxBuffer &buffer) {
-  UpdatePacketsWithDMX(m_data_packets, buffer);
+bool FadecandyThreadedSender::SendUniverse(unsigned int universe,
+                                           const DmxBuffer &buffer) {
+  {
+    ola::thread::MutexLocker locker(&m_frame_mutex);
+    m_frame.Update(universe, buffer);
+    m_frame_changed.Signal();
+  }
+  // This wakes the thread, the data it's passed isn't used.
+  return SendDMX(buffer);
+}
+
+bool FadecandyThreadedSender::TransmitBuffer(
+    libusb_device_handle *handle,
+    OLA_UNUSED const DmxBuffer &buffer) {
+  unsigned int packet_count;
+  {
+    ola::thread::MutexLocker locker(&m_frame_mutex);
+    packet_count = m_frame.Pack(m_data_packets);
+    if (!packet_count) {
+      // Nothing has changed, so wait for SendUniverse().
+      TimeStamp wake_up;
+      m_clock.CurrentTime(&wake_up);
+      wake_up += TimeInterval(0, UNCHANGED_WAIT_MS * ONE_THOUSAND);
+      m_frame_changed.TimedWait(&m_frame_mutex, wake_up);
+      packet_count = m_frame.Pack(m_data_packets);
+    }
+  }
+
+  if (!packet_count) {
+    return true;
+  }
 
   int bytes_sent = 0;
-  // We do a single bulk transfer of the entire data, rather than one transfer
-  // for each 64 bytes.
+  // We do a single bulk transfer of the changed packets, rather than one
+  // transfer for each 64 bytes.
   int r = m_adaptor->BulkTransfer(
       handle, ENDPOINT,
       reinterpret_cast<unsigned char*>(&m_data_packets),
-      sizeof(m_data_packets), &bytes_sent,
+      packet_count * sizeof(fadecandy_packet), &bytes_sent,
       URB_TIMEOUT_MS);
   if (r != 0) {
     OLA_WARN << "Data transfer failed with error "
@@ -248,8 +375,9 @@ bool FadecandyThreadedSender::TransmitBuffer(libusb_device_handle *handle,
 SynchronousScanlimeFadecandy::SynchronousScanlimeFadecandy(
     LibUsbAdaptor *adaptor,
     libusb_device *usb_device,
-    const std::string &serial)
-    : ScanlimeFadecandy(adaptor, usb_device, serial) {
+    const std::string &serial,
+    const Options &options)
+    : ScanlimeFadecandy(adaptor, usb_device, serial, options) {
 }
 
 bool SynchronousScanlimeFadecandy::Init() {
@@ -261,7 +389,7 @@ bool SynchronousScanlimeFadecandy::Init() {
     return false;
   }
 
-  if (!InitializeWidget(m_adaptor, usb_handle)) {
+  if (!InitializeWidget(m_adaptor, usb_handle, GetDeviceId(), m_options)) {
     m_adaptor->Close(usb_handle);
     return false;
   }
@@ -275,8 +403,9 @@ bool SynchronousScanlimeFadecandy::Init() {
   return true;
 }
 
-bool SynchronousScanlimeFadecandy::SendDMX(const DmxBuffer &buffer) {
-  return m_sender.get() ? m_sender->SendDMX(buffer) : false;
+bool SynchronousScanlimeFadecandy::SendUniverse(unsigned int universe,
+                                                const DmxBuffer &buffer) {
+  return m_sender.get() ? m_sender->SendUniverse(universe, buffer) : false;
 }
 
 // FadecandyAsyncUsbSender
@@ -284,15 +413,21 @@ bool SynchronousScanlimeFadecandy::SendDMX(const DmxBuffer &buffer) {
 class FadecandyAsyncUsbSender : public AsyncUsbSender {
  public:
   FadecandyAsyncUsbSender(LibUsbAdaptor *adaptor,
-                          libusb_device *usb_device)
-      : AsyncUsbSender(adaptor, usb_device) {
+                          libusb_device *usb_device,
+                          const ScanlimeFadecandy::Options &options)
+      : AsyncUsbSender(adaptor, usb_device),
+        m_options(options) {
   }
 
   libusb_device_handle* SetupHandle();
 
+  bool SendUniverse(unsigned int universe, const DmxBuffer &buffer);
+
   bool PerformTransfer(const DmxBuffer &buffer);
 
  private:
+  const ScanlimeFadecandy::Options m_options;
+  FadecandyFrame m_frame;  // GUARDED_BY(m_mutex)
   fadecandy_packet m_data_packets[PACKETS_PER_UPDATE];
 
   DISALLOW_COPY_AND_ASSIGN(FadecandyAsyncUsbSender);
@@ -305,20 +440,36 @@ libusb_device_handle* FadecandyAsyncUsbSender::SetupHandle() {
     return NULL;
   }
 
-  if (!InitializeWidget(m_adaptor, usb_handle)) {
+  if (!InitializeWidget(m_adaptor, usb_handle,
+                        m_adaptor->GetDeviceId(m_usb_device), m_options)) {
     m_adaptor->Close(usb_handle);
     return NULL;
   }
   return usb_handle;
 }
 
-bool FadecandyAsyncUsbSender::PerformTransfer(const DmxBuffer &buffer) {
-  UpdatePacketsWithDMX(m_data_packets, buffer);
-  // We do a single bulk transfer of the entire data, rather than one transfer
-  // for each 64 bytes.
+bool FadecandyAsyncUsbSender::SendUniverse(unsigned int universe,
+                                           const DmxBuffer &buffer) {
+  {
+    ola::thread::MutexLocker locker(&m_mutex);
+    m_frame.Update(universe, buffer);
+  }
+  // The frame is sent by PerformTransfer(), so the data isn't used.
+  return SendDMX(buffer);
+}
+
+bool FadecandyAsyncUsbSender::PerformTransfer(
+    OLA_UNUSED const DmxBuffer &buffer) {
+  unsigned int packet_count = m_frame.Pack(m_data_packets);
+  if (!packet_count) {
+    return true;
+  }
+
+  // We do a single bulk transfer of the changed packets, rather than one
+  // transfer for each 64 bytes.
   FillBulkTransfer(ENDPOINT,
                    reinterpret_cast<unsigned char*>(&m_data_packets),
-                   sizeof(m_data_packets),
+                   packet_count * sizeof(fadecandy_packet),
                    URB_TIMEOUT_MS);
   return (SubmitTransfer() == 0);
 }
@@ -329,17 +480,19 @@ bool FadecandyAsyncUsbSender::PerformTransfer(const DmxBuffer &buffer) {
 AsynchronousScanlimeFadecandy::AsynchronousScanlimeFadecandy(
     LibUsbAdaptor *adaptor,
     libusb_device *usb_device,
-    const std::string &serial)
-    : ScanlimeFadecandy(adaptor, usb_device, serial) {
-  m_sender.reset(new FadecandyAsyncUsbSender(m_adaptor, usb_device));
+    const std::string &serial,
+    const Options &options)
+    : ScanlimeFadecandy(adaptor, usb_device, serial, options) {
+  m_sender.reset(new FadecandyAsyncUsbSender(m_adaptor, usb_device, options));
 }
 
 bool AsynchronousScanlimeFadecandy::Init() {
   return m_sender->Init();
 }
 
-bool AsynchronousScanlimeFadecandy::SendDMX(const DmxBuffer &buffer) {
-  return m_sender->SendDMX(buffer);
+bool AsynchronousScanlimeFadecandy::SendUniverse(unsigned int universe,
+                                                 const DmxBuffer &buffer) {
+  return m_sender->SendUniverse(universe, buffer);
 }
 }  // namespace usbdmx
 }  // namespace plugin
@@ -39,19 +39,40 @@ namespace usbdmx {
  * @brief The interface for the Fadecandy Widgets.
  *
  * Fadecandy devices have 8 physical ports. Each port can drive 64 RGB pixels.
- * Ideally this means we'd model each Fadecandy port as an OLA port, but that
- * introduces syncronization issues, since the underlying protocol models all 8
- * ports as a flat pixel array. For now we just expose the first 170 pixels.
+ * The underlying protocol models all 8 ports as a flat array of 512 pixels,
+ * so rather than one OLA port per Fadecandy port, the array is split into
+ * universes of 170 pixels. Universe n starts at pixel n * 170, and 4
+ * universes cover all the pixels.
+ *
+ * Only the 64 byte packets that changed are sent to the device.
  *
  * See https://github.com/scanlime/fadecandy/blob/master/README.md for more
  * information on Fadecandy devices.
  */
 class ScanlimeFadecandy: public SimpleWidget {
  public:
+  struct Options {
+    Options()
+        : universes(1),
+          interpolation(false),
+          lut_once(false) {
+    }
+
+    // The number of universes to use, from 1 to MAX_UNIVERSES.
+    unsigned int universes;
+    // Let the device interpolate and dither between frames.
+    bool interpolation;
+    // Only upload the LUT the first time the device is seen, rather than
+    // each time the plugin starts.
+    bool lut_once;
+  };
+
   ScanlimeFadecandy(ola::usb::LibUsbAdaptor *adaptor,
                     libusb_device *usb_device,
-                    const std::string &serial)
+                    const std::string &serial,
+                    const Options &options)
       : SimpleWidget(adaptor, usb_device),
+        m_options(options),
         m_serial(serial) {
   }
 
@@ -63,6 +84,31 @@ class ScanlimeFadecandy: public SimpleWidget {
     return m_serial;
   }
 
+  /**
+   * @brief The number of universes this widget drives.
+   */
+  unsigned int UniverseCount() const {
+    return m_options.universes;
+  }
+
+  bool SendDMX(const DmxBuffer &buffer) {
+    return SendUniverse(0, buffer);
+  }
+
+  /**
+   * @brief Update the pixels for one universe.
+   * @param universe the index of the universe, from 0 to UniverseCount() - 1.
+   * @param buffer the RGB data for the universe's pixels.
+   * @returns true if the data was sent, false otherwise.
+   */
+  virtual bool SendUniverse(unsigned int universe,
+                            const DmxBuffer &buffer) = 0;
+
+  static const unsigned int MAX_UNIVERSES = 4;
+
+ protected:
+  const Options m_options;
+
  private:
   std::string m_serial;
 };
@@ -79,14 +125,16 @@ class SynchronousScanlimeFadecandy: public ScanlimeFadecandy {
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
    * @param serial the serial number of the widget.
+   * @param options the options for the widget.
    */
   SynchronousScanlimeFadecandy(ola::usb::LibUsbAdaptor *adaptor,
                                libusb_device *usb_device,
-                               const std::string &serial);
+                               const std::string &serial,
+                               const Options &options);
 
   bool Init();
 
-  bool SendDMX(const DmxBuffer &buffer);
+  bool SendUniverse(unsigned int universe, const DmxBuffer &buffer);
 
  private:
   std::auto_ptr<class FadecandyThreadedSender> m_sender;
@@ -104,14 +152,16 @@ class AsynchronousScanlimeFadecandy : public ScanlimeFadecandy {
    * @param adaptor the LibUsbAdaptor to use.
    * @param usb_device the libusb_device to use for the widget.
    * @param serial the serial number of the widget.
+   * @param options the options for the widget.
    */
   AsynchronousScanlimeFadecandy(ola::usb::LibUsbAdaptor *adaptor,
                                 libusb_device *usb_device,
-                                const std::string &serial);
+                                const std::string &serial,
+                                const Options &options);
 
   bool Init();
 
-  bool SendDMX(const DmxBuffer &buffer);
+  bool SendUniverse(unsigned int universe, const DmxBuffer &buffer);
 
  private:
   std::auto_ptr<class FadecandyAsyncUsbSender> m_sender;
@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ScanlimeFadecandyDevice.cpp
+ * A Fadecandy device with an output port for each universe.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "plugins/usbdmx/ScanlimeFadecandyDevice.h"
+
+#include <string>
+#include "ola/strings/Format.h"
+#include "olad/Port.h"
+#include "plugins/usbdmx/ScanlimeFadecandy.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+namespace {
+
+/*
+ * An output port for one of the Fadecandy's universes.
+ */
+class FadecandyOutputPort: public BasicOutputPort {
+ public:
+  FadecandyOutputPort(Device *parent,
+                      unsigned int id,
+                      ScanlimeFadecandy *widget)
+      : BasicOutputPort(parent, id),
+        m_widget(widget) {
+  }
+
+  bool WriteDMX(const DmxBuffer &buffer, OLA_UNUSED uint8_t priority) {
+    m_widget->SendUniverse(PortId(), buffer);
+    return true;
+  }
+
+  std::string Description() const {
+    const unsigned int first_pixel = PortId() * PIXELS_PER_UNIVERSE;
+    return "Pixels " + ola::strings::IntToString(first_pixel) + " - " +
+        ola::strings::IntToString(first_pixel + PIXELS_PER_UNIVERSE - 1);
+  }
+
+ private:
+  ScanlimeFadecandy* const m_widget;
+
+  static const unsigned int PIXELS_PER_UNIVERSE = 170;
+
+  DISALLOW_COPY_AND_ASSIGN(FadecandyOutputPort);
+};
+}  // namespace
+
+ScanlimeFadecandyDevice::ScanlimeFadecandyDevice(
+    ola::AbstractPlugin *owner,
+    ScanlimeFadecandy *widget,
+    const std::string &device_name,
+    const std::string &device_id)
+    : Device(owner, device_name),
+      m_widget(widget),
+      m_device_id(device_id) {
+}
+
+bool ScanlimeFadecandyDevice::StartHook() {
+  for (unsigned int i = 0; i < m_widget->UniverseCount(); i++) {
+    AddPort(new FadecandyOutputPort(this, i, m_widget));
+  }
+  return true;
+}
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * ScanlimeFadecandyDevice.h
+ * A Fadecandy device with an output port for each universe.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef PLUGINS_USBDMX_SCANLIMEFADECANDYDEVICE_H_
+#define PLUGINS_USBDMX_SCANLIMEFADECANDYDEVICE_H_
+
+#include <string>
+#include "ola/base/Macro.h"
+#include "olad/Device.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+/**
+ * @brief A Fadecandy device.
+ *
+ * Each output port drives one of the widget's universes.
+ */
+class ScanlimeFadecandyDevice: public Device {
+ public:
+  /**
+   * @brief Create a new ScanlimeFadecandyDevice.
+   * @param owner The plugin this device belongs to
+   * @param widget The widget to use for this device.
+   * @param device_name The name of the device.
+   * @param device_id The id of the device.
+   */
+  ScanlimeFadecandyDevice(ola::AbstractPlugin *owner,
+                          class ScanlimeFadecandy *widget,
+                          const std::string &device_name,
+                          const std::string &device_id);
+
+  std::string DeviceId() const {
+    return m_device_id;
+  }
+
+ protected:
+  bool StartHook();
+
+ private:
+  class ScanlimeFadecandy* const m_widget;
+  const std::string m_device_id;
+
+  DISALLOW_COPY_AND_ASSIGN(ScanlimeFadecandyDevice);
+};
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_USBDMX_SCANLIMEFADECANDYDEVICE_H_
@@ -21,7 +21,10 @@
 #include "plugins/usbdmx/ScanlimeFadecandyFactory.h"
 
 #include "libs/usb/LibUsbAdaptor.h"
+#include <string>
+
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Flags.h"
 #include "plugins/usbdmx/ScanlimeFadecandy.h"
 
@@ -32,6 +35,7 @@ namespace plugin {
 namespace usbdmx {
 
 using ola::usb::LibUsbAdaptor;
+using std::string;
 
 const char ScanlimeFadecandyFactory::EXPECTED_MANUFACTURER[] = "scanlime";
 const char ScanlimeFadecandyFactory::EXPECTED_PRODUCT[] = "Fadecandy";
@@ -77,13 +81,36 @@ bool ScanlimeFadecandyFactory::DeviceAdded(
     }
   }
 
+  const string prefix = "fadecandy-" + info.serial;
+  bool save = m_preferences->SetDefaultValue(
+      prefix + "-universes",
+      UIntValidator(1, ScanlimeFadecandy::MAX_UNIVERSES), 1);
+  save |= m_preferences->SetDefaultValue(prefix + "-interpolation",
+                                         BoolValidator(), false);
+  save |= m_preferences->SetDefaultValue(prefix + "-lut-once",
+                                         BoolValidator(), false);
+  if (save) {
+    m_preferences->Save();
+  }
+
+  ScanlimeFadecandy::Options options;
+  if (!StringToInt(m_preferences->GetValue(prefix + "-universes"),
+                   &options.universes) ||
+      options.universes < 1 ||
+      options.universes > ScanlimeFadecandy::MAX_UNIVERSES) {
+    options.universes = 1;
+  }
+  options.interpolation = m_preferences->GetValueAsBool(
+      prefix + "-interpolation");
+  options.lut_once = m_preferences->GetValueAsBool(prefix + "-lut-once");
+
   ScanlimeFadecandy *widget = NULL;
   if (FLAGS_use_async_libusb) {
     widget = new AsynchronousScanlimeFadecandy(m_adaptor, usb_device,
-                                               info.serial);
+                                               info.serial, options);
   } else {
     widget = new SynchronousScanlimeFadecandy(m_adaptor, usb_device,
-                                              info.serial);
+                                              info.serial, options);
   }
   return AddWidget(observer, widget);
 }
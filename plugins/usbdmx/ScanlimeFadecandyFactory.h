@@ -23,6 +23,7 @@
 
 #include "libs/usb/LibUsbAdaptor.h"
 #include "ola/base/Macro.h"
+#include "olad/Preferences.h"
 #include "plugins/usbdmx/WidgetFactory.h"
 
 namespace ola {
@@ -35,10 +36,12 @@ namespace usbdmx {
 class ScanlimeFadecandyFactory
     : public BaseWidgetFactory<class ScanlimeFadecandy> {
  public:
-  explicit ScanlimeFadecandyFactory(ola::usb::LibUsbAdaptor *adaptor)
+  ScanlimeFadecandyFactory(ola::usb::LibUsbAdaptor *adaptor,
+                           Preferences *preferences)
       : BaseWidgetFactory<class ScanlimeFadecandy>("ScanlimeFadecandyFactory"),
         m_missing_serial_number(false),
-        m_adaptor(adaptor) {
+        m_adaptor(adaptor),
+        m_preferences(preferences) {
   }
 
   bool DeviceAdded(
@@ -49,6 +52,7 @@ class ScanlimeFadecandyFactory
  private:
   bool m_missing_serial_number;
   ola::usb::LibUsbAdaptor *m_adaptor;
+  Preferences* const m_preferences;
 
   static const char EXPECTED_MANUFACTURER[];
   static const char EXPECTED_PRODUCT[];
@@ -25,6 +25,7 @@
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
 #include "olad/Preferences.h"
+#include "olad/ThreadPreferences.h"
 #include "plugins/usbdmx/AsyncPluginImpl.h"
 #include "plugins/usbdmx/PluginImplInterface.h"
 #include "plugins/usbdmx/SyncPluginImpl.h"
@@ -41,6 +42,7 @@ using std::string;
 const char UsbDmxPlugin::PLUGIN_NAME[] = "USB";
 const char UsbDmxPlugin::PLUGIN_PREFIX[] = "usbdmx";
 const char UsbDmxPlugin::LIBUSB_DEBUG_LEVEL_KEY[] = "libusb_debug_level";
+const char UsbDmxPlugin::LIBUSB_EVENT_LOOP_KEY[] = "libusb_event_loop";
 int UsbDmxPlugin::LIBUSB_DEFAULT_DEBUG_LEVEL = 0;
 int UsbDmxPlugin::LIBUSB_MAX_DEBUG_LEVEL = 4;
 
@@ -65,8 +67,9 @@ bool UsbDmxPlugin::StartHook() {
   std::auto_ptr<PluginImplInterface> impl;
   if (FLAGS_use_async_libusb) {
     impl.reset(
-        new AsyncPluginImpl(m_plugin_adaptor, this, debug_level,
-                            m_preferences));
+        new AsyncPluginImpl(
+            m_plugin_adaptor, this, debug_level, m_preferences,
+            m_preferences->GetValueAsBool(LIBUSB_EVENT_LOOP_KEY)));
   } else {
     impl.reset(
         new SyncPluginImpl(m_plugin_adaptor, this, debug_level, m_preferences));
@@ -100,6 +103,9 @@ bool UsbDmxPlugin::SetDefaultPreferences() {
       LIBUSB_DEBUG_LEVEL_KEY,
       UIntValidator(LIBUSB_DEFAULT_DEBUG_LEVEL, LIBUSB_MAX_DEBUG_LEVEL),
       LIBUSB_DEFAULT_DEBUG_LEVEL);
+  save |= m_preferences->SetDefaultValue(LIBUSB_EVENT_LOOP_KEY,
+                                         BoolValidator(), false);
+  save |= ThreadPreferences::SetDefaults(m_preferences);
 
   if (save) {
     m_preferences->Save();
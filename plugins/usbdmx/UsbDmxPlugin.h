@@ -69,6 +69,7 @@ class UsbDmxPlugin: public ola::Plugin {
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
   static const char LIBUSB_DEBUG_LEVEL_KEY[];
+  static const char LIBUSB_EVENT_LOOP_KEY[];
   static int LIBUSB_DEFAULT_DEBUG_LEVEL;
   static int LIBUSB_MAX_DEBUG_LEVEL;
 
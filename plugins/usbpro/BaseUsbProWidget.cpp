@@ -78,17 +78,14 @@ void BaseUsbProWidget::DescriptorReady() {
  * @returns true if we sent ok, false otherwise
  */
 bool BaseUsbProWidget::SendDMX(const DmxBuffer &buffer) {
-  struct {
-    uint8_t start_code;
-    uint8_t dmx[DMX_UNIVERSE_SIZE];
-  } widget_dmx;
-
-  widget_dmx.start_code = DMX512_START_CODE;
-  unsigned int length = DMX_UNIVERSE_SIZE;
-  buffer.Get(widget_dmx.dmx, &length);
-  return SendMessage(DMX_LABEL,
-                     reinterpret_cast<uint8_t*>(&widget_dmx),
-                     length + 1);
+  uint8_t start_code = DMX512_START_CODE;
+  struct ola::io::IOVec body[2];
+  body[0].iov_base = &start_code;
+  body[0].iov_len = sizeof(start_code);
+  // The slot data is sent straight from the buffer.
+  body[1].iov_base = const_cast<uint8_t*>(buffer.GetRaw());
+  body[1].iov_len = buffer.Size();
+  return SendIOVecMessage(DMX_LABEL, body, 2);
 }
 
 
@@ -102,18 +99,51 @@ bool BaseUsbProWidget::SendMessage(uint8_t label,
   if (length && !data)
     return false;
 
-  ssize_t frame_size = HEADER_SIZE + length + 1;
-  uint8_t frame[frame_size];
-  message_header *header = reinterpret_cast<message_header*>(frame);
-  header->som = SOM;
-  header->label = label;
-  header->len = length & 0xFF;
-  header->len_hi = (length & 0xFF00) >> 8;
+  struct ola::io::IOVec body;
+  body.iov_base = const_cast<uint8_t*>(data);
+  body.iov_len = length;
+  return SendIOVecMessage(label, &body, length ? 1 : 0);
+}
 
-  memcpy(frame + sizeof(message_header), data, length);
-  frame[frame_size - 1] = EOM;
 
-  ssize_t bytes_sent = m_descriptor->Send(frame, frame_size);
+/*
+ * Send a msg with a body made up of IOVecs.
+ * @return true if successful, false otherwise
+ */
+bool BaseUsbProWidget::SendIOVecMessage(uint8_t label,
+                                        const struct ola::io::IOVec *data,
+                                        unsigned int iocnt) const {
+  if (iocnt > MAX_BODY_IOVECS) {
+    return false;
+  }
+
+  unsigned int length = 0;
+  for (unsigned int i = 0; i < iocnt; i++) {
+    length += data[i].iov_len;
+  }
+
+  message_header header;
+  header.som = SOM;
+  header.label = label;
+  header.len = length & 0xFF;
+  header.len_hi = (length & 0xFF00) >> 8;
+  uint8_t eom = EOM;
+
+  struct ola::io::IOVec iov[MAX_BODY_IOVECS + 2];
+  iov[0].iov_base = &header;
+  iov[0].iov_len = HEADER_SIZE;
+  unsigned int iocount = 1;
+  for (unsigned int i = 0; i < iocnt; i++) {
+    if (data[i].iov_len) {
+      iov[iocount++] = data[i];
+    }
+  }
+  iov[iocount].iov_base = &eom;
+  iov[iocount].iov_len = sizeof(eom);
+  iocount++;
+
+  ssize_t frame_size = HEADER_SIZE + length + 1;
+  ssize_t bytes_sent = m_descriptor->Send(iov, iocount);
   if (bytes_sent != frame_size)
     // we've probably screwed framing at this point
     return false;
@@ -27,6 +27,7 @@
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/io/Descriptor.h"
+#include "ola/io/IOVecInterface.h"
 #include "plugins/usbpro/SerialWidgetInterface.h"
 
 namespace ola {
@@ -54,6 +55,19 @@ class BaseUsbProWidget: public SerialWidgetInterface {
                    const uint8_t *data,
                    unsigned int length) const;
 
+  /**
+   * @brief Send a message made up of several pieces of data.
+   * @param label the message label.
+   * @param data the IOVecs that make up the message body.
+   * @param iocnt the number of IOVecs, at most MAX_BODY_IOVECS.
+   *
+   * The header, body & EOM are written with a single call, so the body
+   * doesn't need to be copied into a contiguous frame first.
+   */
+  bool SendIOVecMessage(uint8_t label,
+                        const struct ola::io::IOVec *data,
+                        unsigned int iocnt) const;
+
   static ola::io::ConnectedDescriptor *OpenDevice(const std::string &path);
 
   static const uint8_t DEVICE_LABEL = 78;
@@ -96,6 +110,7 @@ class BaseUsbProWidget: public SerialWidgetInterface {
   static const uint8_t EOM = 0xe7;
   static const uint8_t SOM = 0x7e;
   static const unsigned int HEADER_SIZE;
+  static const unsigned int MAX_BODY_IOVECS = 4;
 };
 
 
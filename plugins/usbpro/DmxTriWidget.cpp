@@ -26,7 +26,6 @@
 #include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/base/Array.h"
-#include "ola/io/ByteString.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMCommandSerializer.h"
@@ -42,7 +41,6 @@ namespace ola {
 namespace plugin {
 namespace usbpro {
 
-using ola::io::ByteString;
 using ola::network::HostToNetwork;
 using ola::network::NetworkToHost;
 using ola::rdm::RDMCommand;
@@ -381,12 +379,13 @@ void DmxTriWidgetImpl::SendRawRDMRequest() {
   m_pending_rdm_request->SetPortId(1);  // port id is always 1
 
   // add two bytes for the command & option field
-  ByteString data;
-  data.push_back(RAW_RDM_COMMAND_ID);
+  uint8_t data[2 + RDMCommandSerializer::MAX_PACKED_SIZE];
+  data[0] = RAW_RDM_COMMAND_ID;
   // a 2 means we don't wait for a break in the response.
-  data.push_back(m_pending_rdm_request->IsDUB() ? 2 : 0);
+  data[1] = m_pending_rdm_request->IsDUB() ? 2 : 0;
 
-  if (!RDMCommandSerializer::Pack(*m_pending_rdm_request, &data)) {
+  unsigned int size = sizeof(data) - 2;
+  if (!RDMCommandSerializer::Pack(*m_pending_rdm_request, data + 2, &size)) {
     OLA_WARN << "Failed to pack RDM request";
     HandleRDMError(ola::rdm::RDM_FAILED_TO_SEND);
     return;
@@ -397,7 +396,7 @@ void DmxTriWidgetImpl::SendRawRDMRequest() {
            << " with command " << ToHex(m_pending_rdm_request->CommandClass())
            << " and param " << ToHex(m_pending_rdm_request->ParamId());
 
-  if (SendCommandToTRI(EXTENDED_COMMAND_LABEL, data.data(), data.size())) {
+  if (SendCommandToTRI(EXTENDED_COMMAND_LABEL, data, size + 2)) {
     m_transaction_number++;
   } else {
     HandleRDMError(ola::rdm::RDM_FAILED_TO_SEND);
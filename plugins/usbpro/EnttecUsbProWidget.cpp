@@ -27,7 +27,6 @@
 #include "ola/Callback.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
-#include "ola/io/ByteString.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMCommandSerializer.h"
 #include "ola/rdm/RDMEnums.h"
@@ -43,7 +42,6 @@ namespace ola {
 namespace plugin {
 namespace usbpro {
 
-using ola::io::ByteString;
 using ola::rdm::RDMCommand;
 using ola::rdm::RDMCommandSerializer;
 using ola::rdm::RDMReply;
@@ -132,6 +130,16 @@ void EnttecPortImpl::Stop() {
  * Send a DMX message
  */
 bool EnttecPortImpl::SendDMX(const DmxBuffer &buffer) {
+  TimeStamp now;
+  if (!m_refresh_interval.IsZero()) {
+    m_clock.CurrentTime(&now);
+    if (now - m_last_send < m_refresh_interval && buffer == m_last_frame) {
+      // The widget keeps sending the last frame, there's no need to send it
+      // again until the refresh is due.
+      return true;
+    }
+  }
+
   struct {
     uint8_t start_code;
     uint8_t dmx[DMX_UNIVERSE_SIZE];
@@ -140,8 +148,31 @@ bool EnttecPortImpl::SendDMX(const DmxBuffer &buffer) {
   widget_dmx.start_code = DMX512_START_CODE;
   unsigned int length = DMX_UNIVERSE_SIZE;
   buffer.Get(widget_dmx.dmx, &length);
-  return m_send_cb->Run(m_ops.send_dmx, reinterpret_cast<uint8_t*>(&widget_dmx),
-                        length + 1);
+  bool ok = m_send_cb->Run(m_ops.send_dmx,
+                           reinterpret_cast<uint8_t*>(&widget_dmx),
+                           length + 1);
+  if (ok && now.IsSet()) {
+    m_last_frame = buffer;
+    m_last_send = now;
+  }
+  return ok;
+}
+
+
+/**
+ * Set the rate at which unchanged frames are sent.
+ * @param refresh_rate the number of times per second an unchanged frame is
+ *   sent to the widget, or 0 to send every frame.
+ */
+void EnttecPortImpl::SetRefreshRate(unsigned int refresh_rate) {
+  if (refresh_rate) {
+    m_refresh_interval = TimeInterval(
+        static_cast<int64_t>(ONE_SECOND_IN_US / refresh_rate));
+  } else {
+    m_refresh_interval = TimeInterval();
+  }
+  m_last_frame.Reset();
+  m_last_send = TimeStamp();
 }
 
 
@@ -166,6 +197,8 @@ bool EnttecPortImpl::ChangeToReceiveMode(bool change_only) {
   if (status && change_only) {
     m_input_buffer.Blackout();
   }
+  // The widget stops sending once it's in receive mode.
+  m_last_frame.Reset();
   return status;
 }
 
@@ -278,6 +311,14 @@ void EnttecPortImpl::RunIncrementalDiscovery(
 }
 
 
+/**
+ * Set the UIDs the next incremental discovery will check.
+ */
+void EnttecPortImpl::SetKnownUIDs(const UIDSet &uids) {
+  m_discovery_agent.SetKnownUIDs(uids);
+}
+
+
 /**
  * Mute a responder
  * @param target the UID to mute
@@ -595,12 +636,13 @@ void EnttecPortImpl::DiscoveryComplete(ola::rdm::RDMDiscoveryCallback *callback,
  */
 bool EnttecPortImpl::PackAndSendRDMRequest(uint8_t label,
                                            const RDMRequest *request) {
-  ByteString data;
-  if (!RDMCommandSerializer::PackWithStartCode(*request, &data)) {
+  uint8_t data[RDMCommandSerializer::MAX_PACKED_SIZE + 1];
+  unsigned int size = sizeof(data);
+  if (!RDMCommandSerializer::PackWithStartCode(*request, data, &size)) {
     return false;
   }
 
-  bool ok = m_send_cb->Run(label, data.data(), data.size());
+  bool ok = m_send_cb->Run(label, data, size);
   if (ok) {
     m_watchdog.Enable();
   }
@@ -656,6 +698,10 @@ bool EnttecPort::SendDMX(const DmxBuffer &buffer) {
   return m_impl->SendDMX(buffer);
 }
 
+void EnttecPort::SetRefreshRate(unsigned int refresh_rate) {
+  m_impl->SetRefreshRate(refresh_rate);
+}
+
 const DmxBuffer &EnttecPort::FetchDMX() const {
   return m_impl->FetchDMX();
 }
@@ -706,6 +752,10 @@ void EnttecPort::RunIncrementalDiscovery(
   }
 }
 
+void EnttecPort::SetKnownUIDs(const UIDSet &uids) {
+  m_impl->SetKnownUIDs(uids);
+}
+
 
 // EnttecUsbProWidgetImpl
 // ----------------------------------------------------------------------------
@@ -53,6 +53,13 @@ class EnttecPort
     EnttecPort(EnttecPortImpl *impl, unsigned int queue_size, bool enable_rdm);
 
     bool SendDMX(const DmxBuffer &buffer);
+
+    /**
+     * @brief Skip frames that haven't changed since the last one was sent.
+     * @param refresh_rate the number of times per second an unchanged frame
+     *   is sent, 0 sends every frame.
+     */
+    void SetRefreshRate(unsigned int refresh_rate);
     const DmxBuffer &FetchDMX() const;
     void SetDMXCallback(ola::Callback0<void> *callback);
     bool ChangeToReceiveMode(bool change_only);
@@ -67,6 +74,11 @@ class EnttecPort
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
     void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
 
+    /**
+     * @brief Set the UIDs the next incremental discovery will check.
+     */
+    void SetKnownUIDs(const ola::rdm::UIDSet &uids);
+
     // the tests access the implementation directly.
     friend class ::EnttecUsbProWidgetTest;
 
@@ -24,7 +24,9 @@
 #include <deque>
 #include <memory>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
@@ -91,6 +93,7 @@ class EnttecPortImpl
     void Stop();
 
     bool SendDMX(const DmxBuffer &buffer);
+    void SetRefreshRate(unsigned int refresh_rate);
     const DmxBuffer &FetchDMX() const { return m_input_buffer; }
     void SetDMXCallback(ola::Callback0<void> *callback);
 
@@ -103,6 +106,7 @@ class EnttecPortImpl
                         ola::rdm::RDMCallback *on_complete);
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
     void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
+    void SetKnownUIDs(const ola::rdm::UIDSet &uids);
 
     // The following are the implementation of DiscoveryTargetInterface
     void MuteDevice(const ola::rdm::UID &target,
@@ -127,6 +131,12 @@ class EnttecPortImpl
   bool m_active;
   Watchdog m_watchdog;
 
+  // TX DMX, used to skip frames that haven't changed.
+  ola::Clock m_clock;
+  TimeInterval m_refresh_interval;  // zero if every frame is sent
+  DmxBuffer m_last_frame;
+  TimeStamp m_last_send;
+
   // RX DMX
   DmxBuffer m_input_buffer;
   std::auto_ptr<ola::Callback0<void> > m_dmx_callback;
@@ -160,6 +170,7 @@ class EnttecPortImpl
   static const unsigned int PORT_ID = 1;
   // This gives a limit between 1 and 2s.
   static const unsigned int WATCHDOG_LIMIT = 2;
+  static const unsigned int ONE_SECOND_IN_US = 1000000;
 };
 }  // namespace usbpro
 }  // namespace plugin
@@ -59,6 +59,7 @@ class EnttecUsbProWidgetTest: public CommonWidgetTest {
   CPPUNIT_TEST(testParams);
   CPPUNIT_TEST(testReceiveDMX);
   CPPUNIT_TEST(testChangeMode);
+  CPPUNIT_TEST(testRefreshRate);
   CPPUNIT_TEST(testSendRDMRequest);
   CPPUNIT_TEST(testSendRDMMute);
   CPPUNIT_TEST(testSendRDMDUB);
@@ -73,6 +74,7 @@ class EnttecUsbProWidgetTest: public CommonWidgetTest {
     void testParams();
     void testReceiveDMX();
     void testChangeMode();
+    void testRefreshRate();
     void testSendRDMRequest();
     void testSendRDMMute();
     void testSendRDMDUB();
@@ -122,6 +124,7 @@ class EnttecUsbProWidgetTest: public CommonWidgetTest {
     static const uint8_t RDM_PACKET = 7;
     static const uint8_t RDM_TIMEOUT_PACKET = 12;
     static const uint8_t RECEIVE_DMX_LABEL = 5;
+  static const uint8_t SEND_DMX_LABEL = 6;
     static const uint8_t SET_PARAM_LABEL = 4;
     static const uint8_t TEST_RDM_DATA[];
     static const unsigned int FOOTER_SIZE = 1;
@@ -471,6 +474,42 @@ void EnttecUsbProWidgetTest::testChangeMode() {
 }
 
 
+/*
+ * Check that unchanged frames are skipped when a refresh rate is set.
+ */
+void EnttecUsbProWidgetTest::testRefreshRate() {
+  EnttecPort *port = m_widget->GetPort(0);
+  OLA_ASSERT_NOT_NULL(port);
+  // Once a second, which is longer than the test takes.
+  port->SetRefreshRate(1);
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  const uint8_t first_frame[] = {0, 1, 2, 3, 4};
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      first_frame,
+      sizeof(first_frame),
+      ola::NewSingleCallback(this, &EnttecUsbProWidgetTest::Terminate));
+  OLA_ASSERT(port->SendDMX(buffer));
+  m_ss.Run();
+  m_endpoint->Verify();
+
+  // The same frame again is skipped, so the next message is the new frame.
+  OLA_ASSERT(port->SendDMX(buffer));
+  buffer.SetChannel(0, 10);
+  const uint8_t second_frame[] = {0, 10, 2, 3, 4};
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      second_frame,
+      sizeof(second_frame),
+      ola::NewSingleCallback(this, &EnttecUsbProWidgetTest::Terminate));
+  OLA_ASSERT(port->SendDMX(buffer));
+  m_ss.Run();
+  m_endpoint->Verify();
+}
+
+
 /**
  * Check that we send RDM messages correctly.
  */
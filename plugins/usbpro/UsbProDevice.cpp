@@ -48,6 +48,8 @@ using std::string;
  * @param owner  the plugin that owns this device
  * @param name  the device name
  * @param dev_path  path to the pro widget
+ * @param refresh_rate  the rate unchanged frames are sent at, 0 sends every
+ *   frame
  */
 UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
                            ola::AbstractPlugin *owner,
@@ -55,7 +57,8 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
                            EnttecUsbProWidget *widget,
                            uint32_t serial,
                            uint16_t firmware_version,
-                           unsigned int fps_limit)
+                           unsigned int fps_limit,
+                           unsigned int refresh_rate)
     : UsbSerialDevice(owner, name, widget),
       m_pro_widget(widget),
       m_serial(SerialToString(serial)) {
@@ -70,6 +73,7 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
       OLA_WARN << "GetPort() returned NULL";
       continue;
     }
+    enttec_port->SetRefreshRate(refresh_rate);
 
     ostringstream port_description;
     if (widget->PortCount() > 1) {
@@ -47,7 +47,8 @@ class UsbProDevice: public UsbSerialDevice {
                EnttecUsbProWidget *widget,
                uint32_t serial,
                uint16_t firmware_version,
-               unsigned int fps_limit);
+               unsigned int fps_limit,
+               unsigned int refresh_rate = 0);
 
   std::string DeviceId() const { return m_serial; }
 
@@ -183,6 +184,11 @@ class UsbProOutputPort: public BasicOutputPort {
     m_port->RunIncrementalDiscovery(callback);
   }
 
+  void RestoreUIDs(const ola::rdm::UIDSet &uids) {
+    m_port->SetKnownUIDs(uids);
+    BasicOutputPort::RestoreUIDs(uids);
+  }
+
   std::string Description() const { return m_description; }
 
  private:
@@ -64,6 +64,7 @@ const char UsbSerialPlugin::ROBE_DEVICE_NAME[] = "Robe Universal Interface";
 const char UsbSerialPlugin::TRI_USE_RAW_RDM_KEY[] = "tri_use_raw_rdm";
 const char UsbSerialPlugin::USBPRO_DEVICE_NAME[] = "Enttec Usb Pro Device";
 const char UsbSerialPlugin::USB_PRO_FPS_LIMIT_KEY[] = "pro_fps_limit";
+const char UsbSerialPlugin::USB_PRO_REFRESH_RATE_KEY[] = "pro_refresh_rate";
 const char UsbSerialPlugin::ULTRA_FPS_LIMIT_KEY[] = "ultra_fps_limit";
 
 UsbSerialPlugin::UsbSerialPlugin(PluginAdaptor *plugin_adaptor)
@@ -132,7 +133,7 @@ void UsbSerialPlugin::NewWidget(
 
   AddDevice(new UsbProDevice(m_plugin_adaptor, this, device_name, widget,
                              information.serial, information.firmware_version,
-                             GetProFrameLimit()));
+                             GetProFrameLimit(), GetProRefreshRate()));
 }
 
 
@@ -282,6 +283,10 @@ bool UsbSerialPlugin::SetDefaultPreferences() {
                                          UIntValidator(0, MAX_PRO_FPS_LIMIT),
                                          DEFAULT_PRO_FPS_LIMIT);
 
+  save |= m_preferences->SetDefaultValue(USB_PRO_REFRESH_RATE_KEY,
+                                         UIntValidator(0, MAX_PRO_FPS_LIMIT),
+                                         DEFAULT_PRO_REFRESH_RATE);
+
   save |= m_preferences->SetDefaultValue(ULTRA_FPS_LIMIT_KEY,
                                          UIntValidator(0, MAX_ULTRA_FPS_LIMIT),
                                          DEFAULT_ULTRA_FPS_LIMIT);
@@ -339,6 +344,20 @@ unsigned int UsbSerialPlugin::GetProFrameLimit() {
 }
 
 
+/*
+ * Get the rate unchanged frames are sent to a pro device, 0 means every frame
+ * is sent.
+ */
+unsigned int UsbSerialPlugin::GetProRefreshRate() {
+  unsigned int refresh_rate;
+  if (!StringToInt(m_preferences->GetValue(USB_PRO_REFRESH_RATE_KEY),
+                   &refresh_rate)) {
+    return DEFAULT_PRO_REFRESH_RATE;
+  }
+  return refresh_rate;
+}
+
+
 /*
  * Get the Frames per second limit for a Ultra DMX Pro Device
  */
@@ -64,6 +64,7 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
     void DeleteDevice(UsbSerialDevice *device);
     std::string GetDeviceName(const UsbProWidgetInformation &information);
     unsigned int GetProFrameLimit();
+    unsigned int GetProRefreshRate();
     unsigned int GetDmxTriFrameLimit();
     unsigned int GetUltraDMXProFrameLimit();
 
@@ -83,10 +84,12 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
     static const char TRI_USE_RAW_RDM_KEY[];
     static const char USBPRO_DEVICE_NAME[];
     static const char USB_PRO_FPS_LIMIT_KEY[];
+    static const char USB_PRO_REFRESH_RATE_KEY[];
     static const char ULTRA_FPS_LIMIT_KEY[];
 
     static const uint8_t DEFAULT_PRO_FPS_LIMIT = 190;
     static const uint8_t DEFAULT_ULTRA_FPS_LIMIT = 40;
+    static const unsigned int DEFAULT_PRO_REFRESH_RATE = 0;
     static const unsigned int MAX_PRO_FPS_LIMIT = 1000;
     static const unsigned int MAX_ULTRA_FPS_LIMIT = 1000;
 };
@@ -226,10 +226,26 @@ bool WidgetDetectorThread::RunScan() {
 
 /**
  * Start the discovery sequence for a widget.
+ *
+ * Each descriptor runs through the detectors independently, so all the
+ * devices found by a scan are probed at the same time. If a widget was found
+ * at this path before, the detector that found it is tried first.
  */
 void WidgetDetectorThread::PerformDiscovery(const string &path,
                                             ConnectedDescriptor *descriptor) {
-  m_active_descriptors[descriptor] = DescriptorInfo(path, -1);
+  DescriptorInfo info;
+  info.path = path;
+  info.stage = -1;
+  info.first_detector = -1;
+
+  DetectorCache::const_iterator iter = m_detector_cache.find(path);
+  if (iter != m_detector_cache.end() &&
+      iter->second < m_widget_detectors.size()) {
+    OLA_DEBUG << "Trying detector " << iter->second << " first for " << path;
+    info.first_detector = iter->second;
+  }
+
+  m_active_descriptors[descriptor] = info;
   m_active_paths.insert(path);
   PerformNextDiscoveryStep(descriptor);
 }
@@ -243,6 +259,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
     const UsbProWidgetInformation *information) {
   // we're no longer interested in events from this widget
   m_ss.RemoveReadDescriptor(descriptor);
+  RecordDetector(descriptor);
 
   if (!m_handler) {
     OLA_WARN << "No callback defined for new Usb Pro Widgets.";
@@ -340,6 +357,7 @@ void WidgetDetectorThread::RobeWidgetReady(
     const RobeWidgetInformation *info) {
   // we're no longer interested in events from this descriptor
   m_ss.RemoveReadDescriptor(descriptor);
+  RecordDetector(descriptor);
   RobeWidget *widget = new RobeWidget(descriptor, info->uid);
 
   if (m_handler) {
@@ -374,17 +392,20 @@ void WidgetDetectorThread::PerformNextDiscoveryStep(
     ConnectedDescriptor *descriptor) {
 
   DescriptorInfo &descriptor_info = m_active_descriptors[descriptor];
-  descriptor_info.second++;
+  descriptor_info.stage++;
 
-  if (static_cast<unsigned int>(descriptor_info.second) ==
+  if (static_cast<unsigned int>(descriptor_info.stage) ==
       m_widget_detectors.size()) {
     OLA_INFO << "no more detectors to try for  " << descriptor;
+    // Whatever was there before has gone.
+    m_detector_cache.erase(descriptor_info.path);
     FreeDescriptor(descriptor);
   } else {
-    OLA_INFO << "trying stage " << descriptor_info.second << " for " <<
-      descriptor;
+    unsigned int detector = DetectorForStage(descriptor_info);
+    OLA_INFO << "trying stage " << descriptor_info.stage << " (detector "
+             << detector << ") for " << descriptor;
     m_ss.AddReadDescriptor(descriptor);
-    bool ok = m_widget_detectors[descriptor_info.second]->Discover(descriptor);
+    bool ok = m_widget_detectors[detector]->Discover(descriptor);
     if (!ok) {
       m_ss.RemoveReadDescriptor(descriptor);
       FreeDescriptor(descriptor);
@@ -393,6 +414,35 @@ void WidgetDetectorThread::PerformNextDiscoveryStep(
 }
 
 
+/**
+ * Map a discovery stage to the detector to use. The cached detector, if any,
+ * is moved to the front and the others keep their order.
+ */
+unsigned int WidgetDetectorThread::DetectorForStage(
+    const DescriptorInfo &info) const {
+  if (info.first_detector < 0) {
+    return info.stage;
+  } else if (info.stage == 0) {
+    return info.first_detector;
+  } else if (info.stage <= info.first_detector) {
+    return info.stage - 1;
+  }
+  return info.stage;
+}
+
+
+/**
+ * Remember which detector found the widget on this descriptor.
+ */
+void WidgetDetectorThread::RecordDetector(ConnectedDescriptor *descriptor) {
+  ActiveDescriptors::const_iterator iter =
+      m_active_descriptors.find(descriptor);
+  if (iter != m_active_descriptors.end()) {
+    m_detector_cache[iter->second.path] = DetectorForStage(iter->second);
+  }
+}
+
+
 /**
  * Free the widget and the associated descriptor.
  */
@@ -414,8 +464,8 @@ void WidgetDetectorThread::InternalFreeWidget(SerialWidgetInterface *widget) {
 void WidgetDetectorThread::FreeDescriptor(ConnectedDescriptor *descriptor) {
   DescriptorInfo &descriptor_info = m_active_descriptors[descriptor];
 
-  m_active_paths.erase(descriptor_info.first);
-  io::ReleaseUUCPLock(descriptor_info.first);
+  m_active_paths.erase(descriptor_info.path);
+  io::ReleaseUUCPLock(descriptor_info.path);
   m_active_descriptors.erase(descriptor);
   delete descriptor;
 }
@@ -26,7 +26,6 @@
 #include <set>
 #include <string>
 #include <vector>
-#include <utility>
 #include "ola/Callback.h"
 #include "ola/io/Descriptor.h"
 #include "ola/io/SelectServer.h"
@@ -121,13 +120,23 @@ class WidgetDetectorThread: public ola::thread::Thread {
 
     // those paths that are either in discovery, or in use
     std::set<std::string> m_active_paths;
-    // holds the path and current widget detector offset
-    typedef std::pair<std::string, int> DescriptorInfo;
+    // holds the path, the current discovery stage and the detector to try
+    // first, or -1 if nothing is known about the path.
+    typedef struct {
+      std::string path;
+      int stage;
+      int first_detector;
+    } DescriptorInfo;
     // map of descriptor to DescriptorInfo
     typedef std::map<ola::io::ConnectedDescriptor*, DescriptorInfo>
       ActiveDescriptors;
     // the descriptors that are in the discovery process
     ActiveDescriptors m_active_descriptors;
+    // The index of the detector that last found a widget at each path. This
+    // outlives Run() so restarting the plugin doesn't probe unchanged
+    // hardware with every detector again.
+    typedef std::map<std::string, unsigned int> DetectorCache;
+    DetectorCache m_detector_cache;
 
     // called when we find new widgets of a particular type
     void UsbProWidgetReady(ola::io::ConnectedDescriptor *descriptor,
@@ -137,6 +146,8 @@ class WidgetDetectorThread: public ola::thread::Thread {
 
     void DescriptorFailed(ola::io::ConnectedDescriptor *descriptor);
     void PerformNextDiscoveryStep(ola::io::ConnectedDescriptor *descriptor);
+    unsigned int DetectorForStage(const DescriptorInfo &info) const;
+    void RecordDetector(ola::io::ConnectedDescriptor *descriptor);
     void InternalFreeWidget(SerialWidgetInterface *widget);
     void FreeDescriptor(ola::io::ConnectedDescriptor *descriptor);
 
@@ -1009,6 +1009,72 @@ class OlaClient(Ola_pb2.OlaClientService):
       raise OLADNotRunningException()
     return True
 
+  def PatchPorts(self, patches, callback=None):
+    """Patch or unpatch many ports at once. Either all of the changes are
+    made, or none of them are.
+
+    Args:
+      patches: a list of (device_alias, port, is_output, action, universe)
+        tuples, with the same meaning as the arguments to PatchPort().
+      callback: The function to call once complete, takes one argument, a
+        RequestStatus object.
+
+    Returns:
+      True if the request was sent, False otherwise.
+    """
+    if self._socket is None:
+      return False
+
+    controller = SimpleRpcController()
+    request = Ola_pb2.PatchPortsRequest()
+    for device_alias, port, is_output, action, universe in patches:
+      patch = request.patches.add()
+      patch.device_alias = device_alias
+      patch.port_id = port
+      patch.action = action
+      patch.is_output = is_output
+      patch.universe = universe
+    try:
+      self._stub.PatchPorts(
+          controller, request,
+          lambda x, y: self._AckMessageComplete(callback, x, y))
+    except socket.error:
+      raise OLADNotRunningException()
+    return True
+
+  def ConfigureUniverses(self, universes, callback=None):
+    """Set the name and merge mode of many universes at once. If any of the
+    universes don't exist, no changes are made.
+
+    Args:
+      universes: a list of (universe, name, merge_mode) tuples. A name or
+        merge_mode of None leaves that setting unchanged.
+      callback: The function to call once complete, takes one argument, a
+        RequestStatus object.
+
+    Returns:
+      True if the request was sent, False otherwise.
+    """
+    if self._socket is None:
+      return False
+
+    controller = SimpleRpcController()
+    request = Ola_pb2.ConfigureUniversesRequest()
+    for universe, name, merge_mode in universes:
+      config = request.universes.add()
+      config.universe = universe
+      if name is not None:
+        config.name = name
+      if merge_mode is not None:
+        config.merge_mode = merge_mode
+    try:
+      self._stub.ConfigureUniverses(
+          controller, request,
+          lambda x, y: self._AckMessageComplete(callback, x, y))
+    except socket.error:
+      raise OLADNotRunningException()
+    return True
+
   def ConfigureDevice(self, device_alias, request_data, callback):
     """Send a device config request.
 
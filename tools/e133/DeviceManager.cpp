@@ -41,8 +41,9 @@ using std::string;
  * @param cid the CID of this controller.
  */
 DeviceManager::DeviceManager(ola::io::SelectServerInterface *ss,
-                             ola::e133::MessageBuilder *message_builder)
-    : m_impl(new DeviceManagerImpl(ss, message_builder)) {
+                             ola::e133::MessageBuilder *message_builder,
+                             bool scalable_mode)
+    : m_impl(new DeviceManagerImpl(ss, message_builder, scalable_mode)) {
 }
 
 
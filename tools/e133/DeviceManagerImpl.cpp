@@ -23,9 +23,12 @@
 #include <ola/acn/ACNPort.h>
 #include <ola/acn/CID.h>
 #include <ola/e133/E133Enums.h>
+#include <ola/io/IOStack.h>
+#include <ola/io/MemoryBlockPool.h>
 #include <ola/io/NonBlockingSender.h>
 #include <ola/io/SelectServer.h>
 #include <ola/network/AdvancedTCPConnector.h>
+#include <ola/network/HealthCheckWheel.h>
 #include <ola/network/IPV4Address.h>
 #include <ola/network/Socket.h>
 #include <ola/network/TCPSocketFactory.h>
@@ -54,6 +57,7 @@ using ola::TimeInterval;
 using ola::acn::CID;
 using ola::io::NonBlockingSender;
 using ola::network::GenericSocketAddress;
+using ola::network::HealthCheckWheel;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::network::TCPSocket;
@@ -63,6 +67,46 @@ using std::auto_ptr;
 using std::string;
 
 
+/**
+ * The connection to a device, as seen by the HealthCheckWheel.
+ */
+class WheelConnection : public HealthCheckWheel::Connection {
+ public:
+    WheelConnection(ola::e133::MessageBuilder *message_builder,
+                    NonBlockingSender *message_queue,
+                    ola::thread::ExecutorInterface *executor,
+                    ola::SingleUseCallback0<void> *on_timeout)
+      : m_message_builder(message_builder),
+        m_message_queue(message_queue),
+        m_executor(executor),
+        m_on_timeout(on_timeout) {
+    }
+
+    void SendHeartbeat() {
+      ola::io::IOStack packet(m_message_builder->pool());
+      m_message_builder->BuildNullTCPPacket(&packet);
+      m_message_queue->SendMessage(&packet);
+    }
+
+    void HeartbeatTimeout() {
+      OLA_INFO << "TCP connection heartbeat timeout";
+      // The timeout closes the connection, which deletes this object, so
+      // defer it until the wheel has finished the tick.
+      if (m_on_timeout.get()) {
+        m_executor->Execute(m_on_timeout.release());
+      }
+    }
+
+ private:
+    ola::e133::MessageBuilder *m_message_builder;
+    NonBlockingSender *m_message_queue;
+    ola::thread::ExecutorInterface *m_executor;
+    auto_ptr<ola::SingleUseCallback0<void> > m_on_timeout;
+
+    DISALLOW_COPY_AND_ASSIGN(WheelConnection);
+};
+
+
 /**
  * Holds everything we need to manage a TCP connection to a E1.33 device.
  */
@@ -72,6 +116,7 @@ class DeviceState {
       : socket(NULL),
         message_queue(NULL),
         health_checked_connection(NULL),
+        wheel_connection(NULL),
         in_transport(NULL),
         am_designated_controller(false) {
     }
@@ -80,8 +125,10 @@ class DeviceState {
     // The socket connected to the E1.33 device
     auto_ptr<TCPSocket> socket;
     auto_ptr<NonBlockingSender> message_queue;
-    // The Health Checked connection
+    // The Health Checked connection, in scalable mode this is the
+    // wheel_connection instead.
     auto_ptr<E133HealthCheckedConnection> health_checked_connection;
+    auto_ptr<WheelConnection> wheel_connection;
     auto_ptr<IncomingTCPTransport> in_transport;
 
     // True if we're the designated controller.
@@ -93,6 +140,8 @@ class DeviceState {
 };
 
 
+// send heartbeats every 5 seconds in scalable mode
+const TimeInterval DeviceManagerImpl::HEARTBEAT_INTERVAL(5, 0);
 // 5 second connect() timeout
 const TimeInterval DeviceManagerImpl::TCP_CONNECT_TIMEOUT(5, 0);
 // retry TCP connects after 5 seconds
@@ -104,10 +153,12 @@ const TimeInterval DeviceManagerImpl::MAX_TCP_RETRY_DELAY(30, 0);
 /**
  * Construct a new DeviceManagerImpl
  * @param ss a pointer to a SelectServerInterface to use
- * @param cid the CID of this controller.
+ * @param message_builder the MessageBuilder to use.
+ * @param scalable_mode use the shared health check wheel and buffer pool.
  */
 DeviceManagerImpl::DeviceManagerImpl(ola::io::SelectServerInterface *ss,
-                             ola::e133::MessageBuilder *message_builder)
+                                     ola::e133::MessageBuilder *message_builder,
+                                     bool scalable_mode)
     : m_ss(ss),
       m_tcp_socket_factory(NewCallback(this, &DeviceManagerImpl::OnTCPConnect)),
       m_connector(m_ss, &m_tcp_socket_factory, TCP_CONNECT_TIMEOUT),
@@ -118,6 +169,11 @@ DeviceManagerImpl::DeviceManagerImpl(ola::io::SelectServerInterface *ss,
   m_e133_inflator.AddInflator(&m_rdm_inflator);
   m_rdm_inflator.SetRDMHandler(
       NewCallback(this, &DeviceManagerImpl::EndpointRequest));
+
+  if (scalable_mode) {
+    m_health_check_wheel.reset(new HealthCheckWheel(m_ss, HEARTBEAT_INTERVAL));
+    m_rx_pool.reset(new ola::io::MemoryBlockPool());
+  }
 }
 
 
@@ -126,6 +182,13 @@ DeviceManagerImpl::DeviceManagerImpl(ola::io::SelectServerInterface *ss,
  */
 DeviceManagerImpl::~DeviceManagerImpl() {
   // close out all tcp sockets and free state
+  DeviceMap::iterator iter = m_device_map.begin();
+  for (; iter != m_device_map.end(); ++iter) {
+    if (m_health_check_wheel.get() && iter->second->wheel_connection.get()) {
+      m_health_check_wheel->RemoveConnection(
+          iter->second->wheel_connection.get());
+    }
+  }
   ola::STLDeleteValues(&m_device_map);
 }
 
@@ -241,8 +304,8 @@ void DeviceManagerImpl::OnTCPConnect(TCPSocket *socket_ptr) {
   // setup the incoming transport, we don't need to setup the outgoing one
   // until we've got confirmation that we're the designated controller.
   device_state->socket.reset(socket.release());
-  device_state->in_transport.reset(new IncomingTCPTransport(&m_root_inflator,
-                                                            socket_ptr));
+  device_state->in_transport.reset(
+      new IncomingTCPTransport(&m_root_inflator, socket_ptr, m_rx_pool.get()));
 
   device_state->socket->SetOnData(
       NewCallback(this, &DeviceManagerImpl::ReceiveTCPData, v4_address.Host(),
@@ -307,6 +370,11 @@ void DeviceManagerImpl::SocketClosed(IPV4Address ip_address) {
         IPV4SocketAddress(ip_address, ola::acn::E133_PORT), true);
   }
 
+  if (device_state->wheel_connection.get()) {
+    m_health_check_wheel->RemoveConnection(
+        device_state->wheel_connection.get());
+    device_state->wheel_connection.reset();
+  }
   device_state->health_checked_connection.reset();
   device_state->message_queue.reset();
   device_state->in_transport.reset();
@@ -335,7 +403,12 @@ void DeviceManagerImpl::RLPDataReceived(
   // If we're already the designated controller, we just need to notify the
   // HealthChecker.
   if (device_state->am_designated_controller) {
-    device_state->health_checked_connection->HeartbeatReceived();
+    if (device_state->wheel_connection.get()) {
+      m_health_check_wheel->HeartbeatReceived(
+          device_state->wheel_connection.get());
+    } else {
+      device_state->health_checked_connection->HeartbeatReceived();
+    }
     return;
   }
 
@@ -351,22 +424,48 @@ void DeviceManagerImpl::RLPDataReceived(
       new NonBlockingSender(device_state->socket.get(), m_ss,
                             m_message_builder->pool()));
 
+  if (!SetupHealthCheck(device_state, src_ip)) {
+    OLA_WARN << "Failed to setup heartbeat controller for " << src_ip;
+    SocketClosed(src_ip);
+  }
+}
+
+
+/**
+ * Start health checking the connection to a device.
+ */
+bool DeviceManagerImpl::SetupHealthCheck(DeviceState *device_state,
+                                         const IPV4Address &ip_address) {
+  if (device_state->health_checked_connection.get() ||
+      device_state->wheel_connection.get()) {
+    OLA_WARN << "pre-existing health_checked_connection for " << ip_address;
+  }
+
+  if (m_health_check_wheel.get()) {
+    device_state->wheel_connection.reset(new WheelConnection(
+        m_message_builder,
+        device_state->message_queue.get(),
+        m_ss,
+        NewSingleCallback(this, &DeviceManagerImpl::SocketUnhealthy,
+                          ip_address)));
+    m_health_check_wheel->AddConnection(device_state->wheel_connection.get());
+    return true;
+  }
+
   E133HealthCheckedConnection *health_checked_connection =
       new E133HealthCheckedConnection(
           m_message_builder,
           device_state->message_queue.get(),
-          NewSingleCallback(this, &DeviceManagerImpl::SocketUnhealthy, src_ip),
+          NewSingleCallback(this, &DeviceManagerImpl::SocketUnhealthy,
+                            ip_address),
           m_ss);
 
   if (!health_checked_connection->Setup()) {
-    OLA_WARN << "Failed to setup heartbeat controller for " << src_ip;
-    SocketClosed(src_ip);
-    return;
+    delete health_checked_connection;
+    return false;
   }
-
-  if (device_state->health_checked_connection.get())
-    OLA_WARN << "pre-existing health_checked_connection for " << src_ip;
   device_state->health_checked_connection.reset(health_checked_connection);
+  return true;
 }
 
 
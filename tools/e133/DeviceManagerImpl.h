@@ -29,8 +29,10 @@
 #include <ola/Clock.h>
 #include <ola/Constants.h>
 #include <ola/e133/MessageBuilder.h>
+#include <ola/io/MemoryBlockPool.h>
 #include <ola/io/SelectServerInterface.h>
 #include <ola/network/AdvancedTCPConnector.h>
+#include <ola/network/HealthCheckWheel.h>
 #include <ola/network/IPV4Address.h>
 #include <ola/network/Socket.h>
 #include <ola/network/TCPSocketFactory.h>
@@ -78,8 +80,15 @@ class DeviceManagerImpl {
     // Run when we give up (or lose) designated controller status.
     typedef ola::Callback1<void, const IPV4Address&> ReleaseDeviceCallback;
 
+    /*
+     * If scalable_mode is true, the heartbeats for all connections are
+     * scheduled from a single HealthCheckWheel and the receive buffers are
+     * taken from a shared pool, rather than each connection having its own
+     * timers and buffer.
+     */
     DeviceManagerImpl(ola::io::SelectServerInterface *ss,
-                  ola::e133::MessageBuilder *message_builder);
+                      ola::e133::MessageBuilder *message_builder,
+                      bool scalable_mode = false);
     ~DeviceManagerImpl();
 
     // Ownership of the callbacks is transferred.
@@ -110,6 +119,10 @@ class DeviceManagerImpl {
 
     ola::e133::MessageBuilder *m_message_builder;
 
+    // Only used in scalable mode.
+    auto_ptr<ola::network::HealthCheckWheel> m_health_check_wheel;
+    auto_ptr<ola::io::MemoryBlockPool> m_rx_pool;
+
     // inflators
     ola::acn::RootInflator m_root_inflator;
     ola::acn::E133Inflator m_e133_inflator;
@@ -127,12 +140,15 @@ class DeviceManagerImpl {
     void SocketUnhealthy(IPV4Address address);
     void SocketClosed(IPV4Address address);
     void RLPDataReceived(const ola::acn::TransportHeader &header);
+    bool SetupHealthCheck(class DeviceState *device_state,
+                          const IPV4Address &ip_address);
 
     void EndpointRequest(
         const ola::acn::TransportHeader *transport_header,
         const ola::acn::E133Header *e133_header,
         const string &raw_request);
 
+    static const TimeInterval HEARTBEAT_INTERVAL;
     static const TimeInterval TCP_CONNECT_TIMEOUT;
     static const TimeInterval INITIAL_TCP_RETRY_DELAY;
     static const TimeInterval MAX_TCP_RETRY_DELAY;
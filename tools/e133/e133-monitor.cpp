@@ -61,6 +61,9 @@ DEFINE_s_string(pid_location, p, "",
                 "The directory to read PID definitiions from");
 DEFINE_s_string(target_addresses, t, "",
                 "List of IPs to connect to");
+DEFINE_default_bool(scalable, false,
+                    "Share the health check timer and receive buffers "
+                    "between connections, use with many devices");
 
 
 /**
@@ -101,7 +104,7 @@ SimpleE133Monitor::SimpleE133Monitor(PidStoreHelper *pid_helper)
       m_stdin_handler(&m_ss,
                       ola::NewCallback(this, &SimpleE133Monitor::Input)),
       m_message_builder(ola::acn::CID::Generate(), "OLA Monitor"),
-      m_device_manager(&m_ss, &m_message_builder) {
+      m_device_manager(&m_ss, &m_message_builder, FLAGS_scalable) {
   m_device_manager.SetRDMMessageCallback(
       NewCallback(this, &SimpleE133Monitor::EndpointRequest));
 }
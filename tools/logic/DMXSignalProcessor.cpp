@@ -39,9 +39,19 @@
  *  36.72 (9 * 4.08) useconds passes and there was no rising edge it's a break.
  *
  * The implementation is based on a state machine, with a couple of tweaks.
+ *
+ * Rather than running every sample through the state machine, Process() finds
+ * runs of samples with the same level, a word at a time. Most of each run
+ * only increments the tick count, so those samples are consumed in one step
+ * and only the samples which may change the state go through the state
+ * machine.
  */
 
+#include <stdint.h>
+#include <string.h>
 #include <ola/Logging.h>
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "tools/logic/DMXSignalProcessor.h"
@@ -65,6 +75,10 @@ DMXSignalProcessor::DMXSignalProcessor(DataCallback *callback,
     : m_callback(callback),
       m_sample_rate(sample_rate),
       m_microseconds_per_tick(1000000.0 / sample_rate),
+      m_max_mab_ticks(TicksFor(MAX_MAB_TIME)),
+      m_max_bit_ticks(TicksFor(MAX_BIT_TIME)),
+      m_stop_bits_ticks(TicksFor(2 * MIN_BIT_TIME)),
+      m_max_mark_ticks(TicksFor(MAX_MARK_BETWEEN_SLOTS)),
       m_state(IDLE),
       m_ticks(0),
       m_may_be_in_break(false),
@@ -83,13 +97,97 @@ DMXSignalProcessor::DMXSignalProcessor(DataCallback *callback,
  * @param mask the value to be AND'ed with each sample to determine if the
  *   signal is high or low.
  */
-void DMXSignalProcessor::Process(uint8_t *ptr, unsigned int size,
+void DMXSignalProcessor::Process(const uint8_t *ptr, unsigned int size,
                                  uint8_t mask) {
-  for (unsigned int i = 0 ; i < size; i++) {
-    ProcessSample(ptr[i] & mask);
+  unsigned int i = 0;
+  while (i < size) {
+    const bool level = ptr[i] & mask;
+    const unsigned int run = RunLength(ptr + i, size - i, mask, level);
+    ProcessRun(level, run);
+    i += run;
+  }
+}
+
+/**
+ * Process a run of samples with the same level. This has the same result as
+ * calling ProcessSample() for each one.
+ */
+void DMXSignalProcessor::ProcessRun(bool bit, unsigned int count) {
+  while (count) {
+    const unsigned int skip = std::min(count, UneventfulSamples(bit));
+    if (skip) {
+      if (m_state != UNDEFINED) {
+        m_ticks += skip;
+      }
+      if (m_may_be_in_break && !bit) {
+        m_ticks_in_break += skip;
+      }
+      count -= skip;
+      continue;
+    }
+    ProcessSample(bit);
+    count--;
+  }
+}
+
+/**
+ * Return the number of samples at this level that would only increment the
+ * tick counts.
+ */
+unsigned int DMXSignalProcessor::UneventfulSamples(bool bit) const {
+  const unsigned int unlimited = std::numeric_limits<unsigned int>::max();
+  switch (m_state) {
+    case UNDEFINED:
+      return bit ? 0 : unlimited;
+    case IDLE:
+      return bit ? unlimited : 0;
+    case BREAK:
+      return bit ? 0 : unlimited;
+    case MAB:
+      return bit ? SamplesBefore(m_max_mab_ticks) : 0;
+    case START_BIT:
+    case BIT_1:
+    case BIT_2:
+    case BIT_3:
+    case BIT_4:
+    case BIT_5:
+    case BIT_6:
+    case BIT_7:
+    case BIT_8:
+      {
+        // The first sample of each bit defines it, and a high clears
+        // m_may_be_in_break. Those go through ProcessSample().
+        if (bit && m_may_be_in_break) {
+          return 0;
+        }
+        bool current_bit = false;
+        if (m_state != START_BIT) {
+          const unsigned int offset = m_state - BIT_1;
+          if (!m_bits_defined[offset]) {
+            return 0;
+          }
+          current_bit = m_current_byte[offset];
+        }
+        return bit == current_bit ? SamplesBefore(m_max_bit_ticks) : 0;
+      }
+    case STOP_BITS:
+      return bit ? SamplesBefore(m_stop_bits_ticks) : 0;
+    case MARK_BETWEEN_SLOTS:
+      return bit ? SamplesBefore(m_max_mark_ticks) : 0;
+    default:
+      return 0;
   }
 }
 
+/**
+ * Return the number of samples that can be added before the tick count
+ * reaches threshold_ticks.
+ */
+unsigned int DMXSignalProcessor::SamplesBefore(
+    unsigned int threshold_ticks) const {
+  return threshold_ticks > m_ticks + 1 ? threshold_ticks - m_ticks - 1 : 0;
+}
+
 /**
  * Process one bit of data through the state machine.
  */
@@ -306,6 +404,54 @@ bool DMXSignalProcessor::DurationExceeds(double micro_seconds) {
   return m_ticks * m_microseconds_per_tick >= micro_seconds;
 }
 
+/*
+ * Return the smallest number of ticks for which DurationExceeds(micro_seconds)
+ * is true.
+ */
+unsigned int DMXSignalProcessor::TicksFor(double micro_seconds) const {
+  unsigned int ticks = static_cast<unsigned int>(
+      micro_seconds / m_microseconds_per_tick);
+  while (ticks * m_microseconds_per_tick < micro_seconds) {
+    ticks++;
+  }
+  while (ticks && (ticks - 1) * m_microseconds_per_tick >= micro_seconds) {
+    ticks--;
+  }
+  return ticks;
+}
+
+/*
+ * Return the number of samples at the start of ptr which have the given
+ * level. This checks 8 samples at a time.
+ */
+unsigned int DMXSignalProcessor::RunLength(const uint8_t *ptr,
+                                           unsigned int size,
+                                           uint8_t mask,
+                                           bool level) {
+  const uint64_t LOW_BITS = 0x0101010101010101ull;
+  const uint64_t HIGH_BITS = 0x8080808080808080ull;
+  const uint64_t mask_word = LOW_BITS * mask;
+
+  unsigned int i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, ptr + i, sizeof(word));
+    word &= mask_word;
+    if (level) {
+      // Stop if any of the samples are zero.
+      if ((word - LOW_BITS) & ~word & HIGH_BITS) {
+        break;
+      }
+    } else if (word) {
+      break;
+    }
+  }
+  while (i < size && static_cast<bool>(ptr[i] & mask) == level) {
+    i++;
+  }
+  return i;
+}
+
 /*
  * Return the current number of ticks in microseconds.
  */
@@ -42,7 +42,7 @@ class DMXSignalProcessor {
     }
 
     // Process more data.
-    void Process(uint8_t *ptr, unsigned int size, uint8_t mask = 0xff);
+    void Process(const uint8_t *ptr, unsigned int size, uint8_t mask = 0xff);
 
  private:
     enum State {
@@ -67,6 +67,11 @@ class DMXSignalProcessor {
     DataCallback* const m_callback;
     const unsigned int m_sample_rate;
     const double m_microseconds_per_tick;
+    // The thresholds in ticks, used to consume runs of samples in one go.
+    const unsigned int m_max_mab_ticks;
+    const unsigned int m_max_bit_ticks;
+    const unsigned int m_stop_bits_ticks;
+    const unsigned int m_max_mark_ticks;
 
     // our current state.
     State m_state;
@@ -84,6 +89,9 @@ class DMXSignalProcessor {
     // The bytes are stored here.
     std::vector<uint8_t> m_dmx_data;
 
+    void ProcessRun(bool bit, unsigned int count);
+    unsigned int UneventfulSamples(bool bit) const;
+    unsigned int SamplesBefore(unsigned int threshold_ticks) const;
     void ProcessSample(bool bit);
     void ProcessBit(bool bit);
     bool SetBitIfNotDefined(bool bit);
@@ -93,6 +101,10 @@ class DMXSignalProcessor {
     void SetState(State state, unsigned int ticks = 1);
     bool DurationExceeds(double micro_seconds);
     double TicksAsMicroSeconds();
+    unsigned int TicksFor(double micro_seconds) const;
+
+    static unsigned int RunLength(const uint8_t *ptr, unsigned int size,
+                                  uint8_t mask, bool level);
 
     static const unsigned int DMX_BITRATE = 250000;
     // These are all in microseconds and are the receiver side limits.
@@ -5,6 +5,8 @@ endif
 tools_logic_logic_rdm_sniffer_SOURCES = \
     tools/logic/DMXSignalProcessor.cpp \
     tools/logic/DMXSignalProcessor.h \
+    tools/logic/MultiLineSignalProcessor.cpp \
+    tools/logic/MultiLineSignalProcessor.h \
     tools/logic/logic-rdm-sniffer.cpp
 tools_logic_logic_rdm_sniffer_LDADD = common/libolacommon.la \
                                       $(libSaleaeDevice_LIBS)
@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * MultiLineSignalProcessor.cpp
+ * Decode DMX frames from several inputs of a logic analyzer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <ola/Callback.h>
+#include <vector>
+
+#include "tools/logic/DMXSignalProcessor.h"
+#include "tools/logic/MultiLineSignalProcessor.h"
+
+using std::vector;
+
+MultiLineSignalProcessor::MultiLineSignalProcessor(DataCallback *callback,
+                                                   unsigned int sample_rate,
+                                                   uint8_t line_mask)
+    : m_callback(callback) {
+  for (unsigned int line = 0; line < MAX_LINES; line++) {
+    if (!(line_mask & (1 << line))) {
+      continue;
+    }
+    Line entry;
+    entry.mask = 1 << line;
+    entry.callback = ola::NewCallback(
+        this, &MultiLineSignalProcessor::FrameReceived, line);
+    entry.processor = new DMXSignalProcessor(entry.callback, sample_rate);
+    m_lines.push_back(entry);
+  }
+}
+
+MultiLineSignalProcessor::~MultiLineSignalProcessor() {
+  vector<Line>::iterator iter = m_lines.begin();
+  for (; iter != m_lines.end(); ++iter) {
+    delete iter->processor;
+    delete iter->callback;
+  }
+}
+
+void MultiLineSignalProcessor::Reset() {
+  vector<Line>::iterator iter = m_lines.begin();
+  for (; iter != m_lines.end(); ++iter) {
+    iter->processor->Reset();
+  }
+}
+
+void MultiLineSignalProcessor::Process(const uint8_t *ptr,
+                                       unsigned int size) {
+  for (unsigned int offset = 0; offset < size; offset += BLOCK_SIZE) {
+    const unsigned int length =
+        size - offset < BLOCK_SIZE ? size - offset : BLOCK_SIZE;
+    vector<Line>::iterator iter = m_lines.begin();
+    for (; iter != m_lines.end(); ++iter) {
+      iter->processor->Process(ptr + offset, length, iter->mask);
+    }
+  }
+}
+
+void MultiLineSignalProcessor::FrameReceived(unsigned int line,
+                                             const uint8_t *data,
+                                             unsigned int length) {
+  if (m_callback) {
+    m_callback->Run(line, data, length);
+  }
+}
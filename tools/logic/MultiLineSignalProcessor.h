@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * MultiLineSignalProcessor.h
+ * Decode DMX frames from several inputs of a logic analyzer.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef TOOLS_LOGIC_MULTILINESIGNALPROCESSOR_H_
+#define TOOLS_LOGIC_MULTILINESIGNALPROCESSOR_H_
+
+#include <stdint.h>
+#include <ola/Callback.h>
+#include <ola/base/Macro.h>
+
+#include <vector>
+
+#include "tools/logic/DMXSignalProcessor.h"
+
+/**
+ * Decode up to 8 DMX lines from one capture. Each bit of the samples is a
+ * separate line.
+ */
+class MultiLineSignalProcessor {
+ public:
+    typedef ola::Callback3<void, unsigned int, const uint8_t*, unsigned int>
+        DataCallback;
+
+    /**
+     * @param callback run with the line number and the data for each frame,
+     *   ownership is not transferred.
+     * @param sample_rate the sample rate of the capture.
+     * @param line_mask the lines to decode, bit n is line n.
+     */
+    MultiLineSignalProcessor(DataCallback *callback,
+                             unsigned int sample_rate,
+                             uint8_t line_mask);
+    ~MultiLineSignalProcessor();
+
+    void Reset();
+
+    // Process more data.
+    void Process(const uint8_t *ptr, unsigned int size);
+
+    static const unsigned int MAX_LINES = 8;
+
+ private:
+    struct Line {
+      uint8_t mask;
+      DMXSignalProcessor::DataCallback *callback;
+      DMXSignalProcessor *processor;
+    };
+
+    DataCallback* const m_callback;
+    std::vector<Line> m_lines;
+
+    void FrameReceived(unsigned int line, const uint8_t *data,
+                       unsigned int length);
+
+    // Each line processes a block in turn, so the samples stay in the cache.
+    static const unsigned int BLOCK_SIZE = 16384;
+
+    DISALLOW_COPY_AND_ASSIGN(MultiLineSignalProcessor);
+};
+#endif  // TOOLS_LOGIC_MULTILINESIGNALPROCESSOR_H_
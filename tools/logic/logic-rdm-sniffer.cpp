@@ -37,6 +37,7 @@
 #include <ola/Constants.h>
 #include <ola/Clock.h>
 #include <ola/DmxBuffer.h>
+#include <ola/dmx/PcapWriter.h>
 #include <ola/io/SelectServer.h>
 #include <ola/Logging.h>
 #include <ola/network/NetworkUtils.h>
@@ -56,7 +57,7 @@
 #include <vector>
 #include <queue>
 
-#include "tools/logic/DMXSignalProcessor.h"
+#include "tools/logic/MultiLineSignalProcessor.h"
 
 using std::auto_ptr;
 using std::cerr;
@@ -64,6 +65,7 @@ using std::cout;
 using std::endl;
 using std::string;
 using std::vector;
+using ola::dmx::PcapWriter;
 using ola::io::SelectServer;
 using ola::messaging::Descriptor;
 using ola::messaging::Message;
@@ -89,8 +91,11 @@ DEFINE_s_default_bool(display_dmx, d, false,
 DEFINE_uint16(dmx_slot_limit, ola::DMX_UNIVERSE_SIZE,
               "Only display the first N slots of DMX data.");
 DEFINE_uint32(sample_rate, 4000000, "Sample rate in HZ.");
+DEFINE_uint8(lines, 1,
+             "The inputs to decode, as a bit mask. Bit 0 is the first input.");
 DEFINE_string(pid_location, "",
               "The directory containing the PID definitions.");
+DEFINE_string(pcap, "", "Also write the frames to a pcapng file.");
 
 void OnReadData(U64 device_id, U8 *data, uint32_t data_length,
                 void *user_data);
@@ -99,23 +104,29 @@ void ProcessData(U8 *data, uint32_t data_length);
 
 class LogicReader {
  public:
-    explicit LogicReader(SelectServer *ss, unsigned int sample_rate)
+    LogicReader(SelectServer *ss, unsigned int sample_rate, uint8_t lines)
       : m_sample_rate(sample_rate),
         m_device_id(0),
         m_logic(NULL),
         m_ss(ss),
-        m_signal_processor(ola::NewCallback(this, &LogicReader::FrameReceived),
-                           sample_rate),
+        m_frame_callback(ola::NewCallback(this, &LogicReader::FrameReceived)),
+        m_signal_processor(m_frame_callback.get(), sample_rate, lines),
+        // Only label the output if there's more than one line.
+        m_show_line(lines & (lines - 1)),
+        m_current_line(0),
         m_pid_helper(FLAGS_pid_location.str(), 4),
         m_command_printer(&cout, &m_pid_helper) {
       m_pid_helper.Init();
     }
     ~LogicReader();
 
+    bool OpenCapture(const string &path, uint8_t lines);
+
     void DeviceConnected(U64 device, GenericInterface *interface);
     void DeviceDisconnected(U64 device);
     void DataReceived(U64 device, U8 *data, uint32_t data_length);
-    void FrameReceived(const uint8_t *data, unsigned int length);
+    void FrameReceived(unsigned int line, const uint8_t *data,
+                       unsigned int length);
 
     void Stop();
 
@@ -130,23 +141,55 @@ class LogicReader {
     LogicInterface *m_logic;  // GUARDED_BY(m_mu);
     mutable Mutex m_mu;
     SelectServer *m_ss;
-    DMXSignalProcessor m_signal_processor;
+    auto_ptr<MultiLineSignalProcessor::DataCallback> m_frame_callback;
+    MultiLineSignalProcessor m_signal_processor;
+    const bool m_show_line;
+    unsigned int m_current_line;
     PidStoreHelper m_pid_helper;
     CommandPrinter m_command_printer;
     Mutex m_data_mu;
     std::queue<U8*> m_free_data;
+    auto_ptr<PcapWriter> m_pcap;
+    // The DMX and RDM capture interfaces for each line.
+    unsigned int m_pcap_dmx_interfaces[MultiLineSignalProcessor::MAX_LINES];
+    unsigned int m_pcap_rdm_interfaces[MultiLineSignalProcessor::MAX_LINES];
+    ola::Clock m_clock;
 
     void ProcessData(U8 *data, uint32_t data_length);
+    void CaptureFrame(unsigned int line, const uint8_t *data,
+                      unsigned int length);
     void DisplayDMXFrame(const uint8_t *data, unsigned int length);
     void DisplayRDMFrame(const uint8_t *data, unsigned int length);
     void DisplayAlternateFrame(const uint8_t *data, unsigned int length);
     void DisplayRawData(const uint8_t *data, unsigned int length);
+    void DisplayLine();
 };
 
 LogicReader::~LogicReader() {
   m_ss->DrainCallbacks();
 }
 
+/**
+ * Open a capture file, with DMX and RDM interfaces for each line.
+ */
+bool LogicReader::OpenCapture(const string &path, uint8_t lines) {
+  m_pcap.reset(PcapWriter::Open(path));
+  if (!m_pcap.get()) {
+    return false;
+  }
+  for (unsigned int line = 0; line < MultiLineSignalProcessor::MAX_LINES;
+       line++) {
+    if (lines & (1 << line)) {
+      const string name = "line " + ola::IntToString(line);
+      m_pcap_dmx_interfaces[line] = m_pcap->AddInterface(
+          PcapWriter::LINKTYPE_DMX, name + " dmx");
+      m_pcap_rdm_interfaces[line] = m_pcap->AddInterface(
+          PcapWriter::LINKTYPE_RDM, name + " rdm");
+    }
+  }
+  return true;
+}
+
 void LogicReader::DeviceConnected(U64 device, GenericInterface *interface) {
   OLA_INFO << "Device " << device << " connected, setting sample rate to "
            << m_sample_rate << "Hz";
@@ -217,10 +260,15 @@ void LogicReader::DataReceived(U64 device, U8 *data, uint32_t data_length) {
 }
 
 
-void LogicReader::FrameReceived(const uint8_t *data, unsigned int length) {
+void LogicReader::FrameReceived(unsigned int line, const uint8_t *data,
+                                unsigned int length) {
   if (!length) {
     return;
   }
+  m_current_line = line;
+  if (m_pcap.get()) {
+    CaptureFrame(line, data, length);
+  }
 
   switch (data[0]) {
     case 0:
@@ -250,7 +298,7 @@ void LogicReader::Stop() {
  * @param data_length the size of the data
  */
 void LogicReader::ProcessData(U8 *data, uint32_t data_length) {
-  m_signal_processor.Process(data, data_length, 0x01);
+  m_signal_processor.Process(data, data_length);
   DevicesManagerInterface::DeleteU8ArrayPtr(data);
 
   /*
@@ -266,11 +314,22 @@ void LogicReader::ProcessData(U8 *data, uint32_t data_length) {
 }
 
 
+void LogicReader::CaptureFrame(unsigned int line, const uint8_t *data,
+                               unsigned int length) {
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  const unsigned int interface_id = data[0] == RDMCommand::START_CODE ?
+      m_pcap_rdm_interfaces[line] : m_pcap_dmx_interfaces[line];
+  m_pcap->WriteFrame(interface_id, now, data[0], data + 1, length - 1);
+}
+
+
 void LogicReader::DisplayDMXFrame(const uint8_t *data, unsigned int length) {
   if (!FLAGS_display_dmx) {
     return;
   }
 
+  DisplayLine();
   cout << "DMX " << std::dec;
   cout << length << ":" << std::hex;
   DisplayRawData(data, length);
@@ -282,8 +341,10 @@ void LogicReader::DisplayRDMFrame(const uint8_t *data, unsigned int length) {
     if (FLAGS_full_rdm) {
       cout << "---------------------------------------" << endl;
     }
+    DisplayLine();
     command->Print(&m_command_printer, !FLAGS_full_rdm, true);
   } else {
+    DisplayLine();
     cout << "RDM " << std::dec;
     cout << length << ":" << std::hex;
     DisplayRawData(data, length);
@@ -298,6 +359,7 @@ void LogicReader::DisplayAlternateFrame(const uint8_t *data,
   }
 
   unsigned int slot_count = length - 1;
+  DisplayLine();
   cout << "SC " << ToHex(static_cast<int>(data[0]))
        << " " << slot_count << ":";
   DisplayRawData(data + 1, slot_count);
@@ -315,6 +377,15 @@ void LogicReader::DisplayRawData(const uint8_t *data, unsigned int length) {
   cout << endl;
 }
 
+/**
+ * Label the output with the line the frame was received on.
+ */
+void LogicReader::DisplayLine() {
+  if (m_show_line) {
+    cout << "Line " << std::dec << m_current_line << ": ";
+  }
+}
+
 // SaleaeDeviceApi callbacks
 void OnConnect(U64 device_id, GenericInterface* device_interface,
                void* user_data) {
@@ -366,8 +437,17 @@ int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "[ options ]",
                "Decode DMX/RDM data from a Saleae Logic device");
 
+  if (!FLAGS_lines) {
+    OLA_FATAL << "--lines must select at least one input";
+    return ola::EXIT_USAGE;
+  }
+
   SelectServer ss;
-  LogicReader reader(&ss, FLAGS_sample_rate);
+  LogicReader reader(&ss, FLAGS_sample_rate, FLAGS_lines);
+  if (!FLAGS_pcap.str().empty() &&
+      !reader.OpenCapture(FLAGS_pcap.str(), FLAGS_lines)) {
+    return ola::EXIT_CANTCREAT;
+  }
 
   DevicesManagerInterface::RegisterOnConnect(&OnConnect, &reader);
   DevicesManagerInterface::RegisterOnDisconnect(&OnDisconnect, &reader);
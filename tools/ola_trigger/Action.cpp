@@ -32,11 +32,16 @@
 
 #include <ola/stl/STLUtils.h>
 #include "tools/ola_trigger/Action.h"
+#include "tools/ola_trigger/CommandRunner.h"
 #include "tools/ola_trigger/VariableInterpolator.h"
 
 using std::string;
 using std::vector;
 
+namespace {
+CommandRunner *command_runner = NULL;
+}  // namespace
+
 
 /**
  * @brief Assign the value to the variable.
@@ -62,6 +67,10 @@ void VariableAssignmentAction::Execute(Context *context, uint8_t) {
  */
 void CommandAction::Execute(Context *context, uint8_t) {
   char **args = BuildArgList(context);
+  if (!args) {
+    OLA_WARN << "Failed to expand the arguments for " << m_command;
+    return;
+  }
 
   if (ola::LogLevel() >= ola::OLA_LOG_INFO) {
     std::ostringstream str;
@@ -122,23 +131,30 @@ void CommandAction::Execute(Context *context, uint8_t) {
 
   free(cmd_line);
 #else
-  pid_t pid;
-  if ((pid = fork()) < 0) {
-    OLA_FATAL << "Could not fork to exec " << m_command;
-    FreeArgList(args);
-    return;
-  } else if (pid) {
-    // parent
-    OLA_DEBUG << "Child for " << m_command << " is " << pid;
-    FreeArgList(args);
-    return;
+  vector<string> command_args;
+  for (char **arg = args; *arg; arg++) {
+    command_args.push_back(*arg);
   }
+  FreeArgList(args);
 
-  execvp(m_command.c_str(), args);
+  if (command_runner) {
+    command_runner->Run(command_args);
+  } else {
+    static SpawnCommandRunner default_runner;
+    default_runner.Run(command_args);
+  }
 #endif  // _WIN32
 }
 
 
+/**
+ * @brief Set the CommandRunner used to start commands.
+ */
+void CommandAction::SetRunner(CommandRunner *runner) {
+  command_runner = runner;
+}
+
+
 /**
  * Interpolate all the arguments, and return a pointer to an array of char*
  * pointers which can be passed to exec()
@@ -248,6 +264,21 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
       rising_action,
       falling_action);
 
+  if (!InsertAction(action_interval)) {
+    delete action_interval.interval;
+    return false;
+  }
+  BuildActionTables();
+  return true;
+}
+
+
+/**
+ * @brief Insert an ActionInterval into the sorted list of intervals.
+ * @returns true if the interval was added, false if it overlaps an existing
+ *   interval.
+ */
+bool Slot::InsertAction(const ActionInterval &action_interval) {
   if (m_actions.empty()) {
     m_actions.push_back(action_interval);
     return true;
@@ -255,7 +286,6 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
 
   ActionVector::iterator lower = m_actions.begin();
   if (IntervalsIntersect(action_interval.interval, lower->interval)) {
-    delete action_interval.interval;
     return false;
   }
 
@@ -267,7 +297,6 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
   ActionVector::iterator upper = m_actions.end();
   upper--;
   if (IntervalsIntersect(action_interval.interval, upper->interval)) {
-    delete action_interval.interval;
     return false;
   }
 
@@ -281,7 +310,6 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
     OLA_WARN << "Inconsistent interval state, adding "
              << *(action_interval.interval) << ", to "
              << IntervalsAsString(m_actions.begin(), m_actions.end());
-    delete action_interval.interval;
     return false;
   }
 
@@ -302,7 +330,6 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
     ActionVector::iterator mid = lower + difference / 2;
 
     if (IntervalsIntersect(action_interval.interval, mid->interval)) {
-      delete action_interval.interval;
       return false;
     }
 
@@ -314,7 +341,6 @@ bool Slot::AddAction(const ValueInterval &interval_arg,
       OLA_WARN << "Inconsistent intervals detected when inserting: "
                << *(action_interval.interval) << ", intervals: "
                << IntervalsAsString(lower, upper);
-      delete action_interval.interval;
       return false;
     }
   }
@@ -370,15 +396,10 @@ void Slot::TakeAction(Context *context,
     rising = value > m_old_value;
   }
 
-  Action *action = LocateMatchingAction(value, rising);
+  Action *action = rising ? m_rising_actions[value] :
+      m_falling_actions[value];
   if (action) {
     action->Execute(context, value);
-  } else {
-    if (rising && m_default_rising_action) {
-      m_default_rising_action->Execute(context, value);
-    } else if (!rising && m_default_falling_action) {
-      m_default_falling_action->Execute(context, value);
-    }
   }
 
   m_old_value_defined = true;
@@ -395,17 +416,6 @@ string Slot::IntervalsAsString() const {
 }
 
 
-/**
- * @brief Given two interval iterators, first and last, return true if the value is
- *   contained within the lower and upper bounds of the intervals.
- */
-bool Slot::ValueWithinIntervals(uint8_t value,
-                                const ValueInterval &lower_interval,
-                                const ValueInterval &upper_interval) {
-  return lower_interval.Lower() <= value && value <= upper_interval.Upper();
-}
-
-
 /**
  * @brief Check if two ValueIntervals intersect.
  */
@@ -420,57 +430,27 @@ bool Slot::IntervalsIntersect(const ValueInterval *a1,
 
 
 /**
- * @brief Given a value, find the matching ValueInterval.
- * @param value the value to search for
- * @param rising, true if the new value is rising, false otherwise.
- * @returns the Action matching the value,  or NULL if there isn't one.
+ * @brief Fill in the action tables from the intervals, if a value doesn't
+ *   have an action the default is used.
  */
-Action *Slot::LocateMatchingAction(uint8_t value, bool rising) {
-  if (m_actions.empty()) {
-    return NULL;
-  }
-
-  ActionVector::iterator lower = m_actions.begin();
-  ActionVector::iterator upper = m_actions.end();
-  upper--;
-  if (!ValueWithinIntervals(value, *(lower->interval), *(upper->interval))) {
-    return NULL;
-  }
-
-  // ok, we know the value lies between the intervals we have, first exclude
-  // the endpoints
-  if (lower->interval->Contains(value)) {
-    return rising ? lower->rising_action : lower->falling_action;
-  }
-
-  if (upper->interval->Contains(value)) {
-    return rising ? upper->rising_action : upper->falling_action;
-  }
-
-  // value isn't at the lower or upper interval, but lies somewhere between
-  // the two.
-  // @pre lower != upper
-  // @pre !lower.Contains(value) && !upper.Contains(value)
-  while (true) {
-    unsigned int difference = upper - lower;
-    ActionVector::iterator mid = lower + difference / 2;
-
-    if (mid == lower) {
-      // lower doesn't contain the value, so we don't have it
-      return NULL;
-    }
-
-    if (mid->interval->Contains(value)) {
-      return rising ? mid->rising_action : mid->falling_action;
-    } else if (value <= mid->interval->Lower()) {
-      upper = mid;
-    } else if (value >= mid->interval->Upper()) {
-      lower = mid;
-    } else {
-      OLA_WARN << "Inconsistent intervals detected when looking for: "
-               << static_cast<int>(value) << ", intervals: "
-               << IntervalsAsString(lower, upper);
-      return NULL;
+void Slot::BuildActionTables() {
+  std::fill(m_rising_actions,
+            m_rising_actions + ola::DMX_MAX_SLOT_VALUE + 1,
+            m_default_rising_action);
+  std::fill(m_falling_actions,
+            m_falling_actions + ola::DMX_MAX_SLOT_VALUE + 1,
+            m_default_falling_action);
+
+  ActionVector::const_iterator iter = m_actions.begin();
+  for (; iter != m_actions.end(); ++iter) {
+    for (unsigned int value = iter->interval->Lower();
+         value <= iter->interval->Upper(); value++) {
+      if (iter->rising_action) {
+        m_rising_actions[value] = iter->rising_action;
+      }
+      if (iter->falling_action) {
+        m_falling_actions[value] = iter->falling_action;
+      }
     }
   }
 }
@@ -509,5 +489,6 @@ bool Slot::SetDefaultAction(Action **action_to_set,
     (*action_to_set)->DeRef();
   }
   *action_to_set = new_action;
+  BuildActionTables();
   return previous_default_set;
 }
@@ -22,6 +22,7 @@
 #define TOOLS_OLA_TRIGGER_ACTION_H_
 
 #include <stdint.h>
+#include <ola/Constants.h>
 #include <ola/Logging.h>
 #include <sstream>
 #include <string>
@@ -81,6 +82,8 @@ class VariableAssignmentAction: public Action {
 /**
  * @brief Command Action. This action executes a command.
  */
+class CommandRunner;
+
 class CommandAction: public Action {
  public:
   CommandAction(const std::string &command,
@@ -92,6 +95,13 @@ class CommandAction: public Action {
 
   virtual void Execute(Context *context, uint8_t slot_value);
 
+  /**
+   * @brief Set the CommandRunner used to start commands.
+   * @param runner the CommandRunner, ownership is not transferred. If NULL,
+   *   commands are started with posix_spawnp().
+   */
+  static void SetRunner(CommandRunner *runner);
+
  protected:
   const std::string m_command;
   std::vector<std::string> m_arguments;
@@ -149,6 +159,7 @@ class Slot {
       m_slot_offset(slot_offset),
       m_old_value(0),
       m_old_value_defined(false) {
+    BuildActionTables();
   }
   ~Slot();
 
@@ -175,6 +186,11 @@ class Slot {
   uint8_t m_old_value;
   bool m_old_value_defined;
 
+  // The Action for each value, with the defaults filled in. These are rebuilt
+  // whenever the actions change, so TakeAction() is a single lookup.
+  Action *m_rising_actions[ola::DMX_MAX_SLOT_VALUE + 1];
+  Action *m_falling_actions[ola::DMX_MAX_SLOT_VALUE + 1];
+
   class ActionInterval {
    public:
     ActionInterval(const ValueInterval *interval,
@@ -243,12 +259,10 @@ class Slot {
   typedef std::vector<ActionInterval> ActionVector;
   ActionVector m_actions;
 
-  bool ValueWithinIntervals(uint8_t value,
-                            const ValueInterval &lower_interval,
-                            const ValueInterval &upper_interval);
+  bool InsertAction(const ActionInterval &action_interval);
   bool IntervalsIntersect(const ValueInterval *a1,
                           const ValueInterval *a2);
-  Action *LocateMatchingAction(uint8_t value, bool rising);
+  void BuildActionTables();
   std::string IntervalsAsString(const ActionVector::const_iterator &start,
                                 const ActionVector::const_iterator &end) const;
   bool SetDefaultAction(Action **action_to_set, Action *new_action);
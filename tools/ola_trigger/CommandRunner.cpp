@@ -0,0 +1,259 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * CommandRunner.cpp
+ * Starts the processes for command actions.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ola/Logging.h>
+#include <string>
+#include <vector>
+
+#include "tools/ola_trigger/CommandRunner.h"
+
+extern char **environ;
+
+using std::string;
+using std::vector;
+
+bool SpawnCommandRunner::Run(const vector<string> &args) {
+  if (args.empty()) {
+    return false;
+  }
+
+  Reap();
+  if (!m_options.max_children ||
+      m_children.size() < m_options.max_children) {
+    return Start(args);
+  }
+
+  if (m_queue.size() >= m_options.max_queued) {
+    OLA_WARN << "Too many commands queued, dropping " << args[0];
+    return false;
+  }
+  m_queue.push_back(args);
+  OLA_DEBUG << "Queued " << args[0] << ", " << m_queue.size()
+            << " commands waiting";
+  return true;
+}
+
+bool SpawnCommandRunner::Reap() {
+  vector<pid_t>::iterator iter = m_children.begin();
+  while (iter != m_children.end()) {
+    if (HasExited(*iter)) {
+      iter = m_children.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  while (!m_queue.empty() && m_children.size() < m_options.max_children) {
+    vector<string> args;
+    args.swap(m_queue.front());
+    m_queue.pop_front();
+    Start(args);
+  }
+  return true;
+}
+
+bool SpawnCommandRunner::Spawn(const vector<string> &args, pid_t *pid) {
+  vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  vector<string>::const_iterator iter = args.begin();
+  for (; iter != args.end(); ++iter) {
+    argv.push_back(const_cast<char*>(iter->c_str()));
+  }
+  argv.push_back(NULL);
+
+  // The helper ignores SIGCHLD, don't pass that on to the command.
+  sigset_t default_signals;
+  sigemptyset(&default_signals);
+  sigaddset(&default_signals, SIGCHLD);
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  posix_spawnattr_setsigdefault(&attributes, &default_signals);
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+  int ret = posix_spawnp(pid, argv[0], NULL, &attributes, &argv[0], environ);
+  posix_spawnattr_destroy(&attributes);
+  if (ret) {
+    OLA_WARN << "Could not run " << args[0] << ": " << strerror(ret);
+    return false;
+  }
+  OLA_DEBUG << "Child for " << args[0] << " is " << *pid;
+  return true;
+}
+
+/*
+ * ola_trigger's SIGCHLD handler may have reaped the child already, in which
+ * case waitpid() fails with ECHILD.
+ */
+bool SpawnCommandRunner::HasExited(pid_t pid) {
+  return waitpid(pid, NULL, WNOHANG) != 0;
+}
+
+bool SpawnCommandRunner::Start(const vector<string> &args) {
+  pid_t pid;
+  if (!Spawn(args, &pid)) {
+    return false;
+  }
+  if (m_options.max_children) {
+    m_children.push_back(pid);
+  }
+  return true;
+}
+
+
+HelperCommandRunner::~HelperCommandRunner() {
+  // The helper exits once it reads EOF.
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+bool HelperCommandRunner::Init() {
+  int fds[2];
+  if (pipe(fds)) {
+    OLA_WARN << "pipe() failed: " << strerror(errno);
+    return false;
+  }
+  // Don't let the commands inherit the pipe.
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    OLA_WARN << "Could not fork the command helper: " << strerror(errno);
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  } else if (pid == 0) {
+    close(fds[1]);
+    HelperLoop(fds[0]);
+    _exit(0);
+  }
+
+  close(fds[0]);
+  m_fd = fds[1];
+  // A busy helper must not block the trigger thread.
+  fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+  m_helper_pid = pid;
+  OLA_INFO << "Command helper is " << m_helper_pid;
+  return true;
+}
+
+/*
+ * Each command is sent as a uint16_t length, followed by the NULL terminated
+ * arguments. Writes of up to PIPE_BUF bytes are atomic, so a command is
+ * either sent whole or not at all.
+ */
+bool HelperCommandRunner::Run(const vector<string> &args) {
+  if (args.empty() || m_fd < 0) {
+    return false;
+  }
+
+  string message(sizeof(uint16_t), '\0');
+  vector<string>::const_iterator iter = args.begin();
+  for (; iter != args.end(); ++iter) {
+    message.append(*iter);
+    message.push_back('\0');
+  }
+
+  if (message.size() > PIPE_BUF) {
+    OLA_WARN << "Command " << args[0] << " is too long for the helper";
+    return false;
+  }
+  uint16_t length = static_cast<uint16_t>(message.size() - sizeof(length));
+  memcpy(&message[0], &length, sizeof(length));
+
+  if (write(m_fd, message.data(), message.size()) < 0) {
+    if (errno == EAGAIN) {
+      OLA_WARN << "Command helper is busy, dropping " << args[0];
+    } else {
+      OLA_WARN << "Failed to send " << args[0] << " to the command helper: "
+               << strerror(errno);
+    }
+    return false;
+  }
+  return true;
+}
+
+void HelperCommandRunner::HelperLoop(int fd) {
+  // Without a limit the children aren't waited for, so let the kernel reap
+  // them.
+  signal(SIGCHLD, m_options.max_children ? SIG_DFL : SIG_IGN);
+
+  SpawnCommandRunner runner(m_options);
+  string buffer;
+  char data[PIPE_BUF];
+
+  while (true) {
+    struct pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    int timeout = runner.Running() ? REAP_INTERVAL_MS : -1;
+    int ret = poll(&poll_fd, 1, timeout);
+    if (ret < 0 && errno != EINTR) {
+      break;
+    }
+
+    runner.Reap();
+    if (ret <= 0) {
+      continue;
+    }
+
+    ssize_t size = read(fd, data, sizeof(data));
+    if (size < 0 && errno == EINTR) {
+      continue;
+    } else if (size <= 0) {
+      // ola_trigger has exited.
+      break;
+    }
+    buffer.append(data, size);
+
+    uint16_t length;
+    while (buffer.size() >= sizeof(length)) {
+      memcpy(&length, buffer.data(), sizeof(length));
+      string::size_type end = sizeof(length) + length;
+      if (buffer.size() < end) {
+        break;
+      }
+
+      vector<string> args;
+      string::size_type start = sizeof(length);
+      while (start < end) {
+        string::size_type null = buffer.find('\0', start);
+        args.push_back(buffer.substr(start, null - start));
+        start = null + 1;
+      }
+      buffer.erase(0, end);
+      runner.Run(args);
+    }
+  }
+  close(fd);
+}
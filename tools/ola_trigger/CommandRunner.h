@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * CommandRunner.h
+ * Starts the processes for command actions.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef TOOLS_OLA_TRIGGER_COMMANDRUNNER_H_
+#define TOOLS_OLA_TRIGGER_COMMANDRUNNER_H_
+
+#include <sys/types.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "ola/base/Macro.h"
+
+/**
+ * @brief Runs the commands for CommandActions.
+ */
+class CommandRunner {
+ public:
+  virtual ~CommandRunner() {}
+
+  /**
+   * @brief Run a command.
+   * @param args the arguments, args[0] is the command to run.
+   * @returns true if the command was started or queued.
+   */
+  virtual bool Run(const std::vector<std::string> &args) = 0;
+};
+
+
+/**
+ * @brief Starts commands with posix_spawnp().
+ *
+ * Unlike fork(), posix_spawnp() doesn't copy the page tables of the calling
+ * process, so the time taken to start a command doesn't depend on the size of
+ * ola_trigger.
+ *
+ * If max_children is set, at most that many commands run at once and the
+ * rest are queued, up to max_queued. Reap() should be called periodically to
+ * start the queued commands once the running ones exit.
+ */
+class SpawnCommandRunner: public CommandRunner {
+ public:
+  struct Options {
+    Options() : max_children(0), max_queued(DEFAULT_MAX_QUEUED) {}
+
+    // The number of commands that can run at once, 0 for no limit.
+    unsigned int max_children;
+    // The number of commands to queue once max_children are running.
+    unsigned int max_queued;
+  };
+
+  explicit SpawnCommandRunner(const Options &options = Options())
+      : m_options(options) {
+  }
+  virtual ~SpawnCommandRunner() {}
+
+  bool Run(const std::vector<std::string> &args);
+
+  /**
+   * @brief Check for commands that have exited, and start queued commands in
+   *   their place.
+   * @returns true, so this can be used as a repeating timeout.
+   */
+  bool Reap();
+
+  unsigned int Running() const { return m_children.size(); }
+  unsigned int Queued() const { return m_queue.size(); }
+
+  static const unsigned int DEFAULT_MAX_QUEUED = 256;
+
+ protected:
+  virtual bool Spawn(const std::vector<std::string> &args, pid_t *pid);
+  virtual bool HasExited(pid_t pid);
+
+ private:
+  typedef std::deque<std::vector<std::string> > CommandQueue;
+
+  const Options m_options;
+  std::vector<pid_t> m_children;
+  CommandQueue m_queue;
+
+  bool Start(const std::vector<std::string> &args);
+
+  DISALLOW_COPY_AND_ASSIGN(SpawnCommandRunner);
+};
+
+
+/**
+ * @brief Hands commands to a helper process over a pipe.
+ *
+ * The helper is forked by Init(), which should be called early while the
+ * process is small. It starts the commands with a SpawnCommandRunner, so the
+ * limits and the queue are applied in the helper and sending a command is a
+ * single non-blocking write.
+ */
+class HelperCommandRunner: public CommandRunner {
+ public:
+  explicit HelperCommandRunner(const SpawnCommandRunner::Options &options)
+      : m_options(options),
+        m_fd(-1),
+        m_helper_pid(-1) {
+  }
+  ~HelperCommandRunner();
+
+  /**
+   * @brief Start the helper process.
+   * @returns true if the helper was started.
+   */
+  bool Init();
+
+  bool Run(const std::vector<std::string> &args);
+
+ private:
+  const SpawnCommandRunner::Options m_options;
+  int m_fd;
+  pid_t m_helper_pid;
+
+  void HelperLoop(int fd);
+
+  static const unsigned int REAP_INTERVAL_MS = 50;
+
+  DISALLOW_COPY_AND_ASSIGN(HelperCommandRunner);
+};
+#endif  // TOOLS_OLA_TRIGGER_COMMANDRUNNER_H_
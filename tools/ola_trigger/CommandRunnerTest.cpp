@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * CommandRunnerTest.cpp
+ * Test fixture for the SpawnCommandRunner class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tools/ola_trigger/CommandRunner.h"
+#include "ola/testing/TestUtils.h"
+
+
+using std::set;
+using std::string;
+using std::vector;
+
+
+class CommandRunnerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(CommandRunnerTest);
+  CPPUNIT_TEST(testUnlimited);
+  CPPUNIT_TEST(testQueueing);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testUnlimited();
+  void testQueueing();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CommandRunnerTest);
+
+
+/**
+ * A SpawnCommandRunner which records the commands rather than running them.
+ */
+class MockSpawnCommandRunner: public SpawnCommandRunner {
+ public:
+  explicit MockSpawnCommandRunner(const Options &options)
+      : SpawnCommandRunner(options),
+        m_next_pid(100) {
+  }
+
+  void Exit(pid_t pid) { m_exited.insert(pid); }
+
+  vector<string> m_commands;
+
+ protected:
+  bool Spawn(const vector<string> &args, pid_t *pid) {
+    m_commands.push_back(args[0]);
+    *pid = m_next_pid++;
+    return true;
+  }
+
+  bool HasExited(pid_t pid) {
+    return m_exited.find(pid) != m_exited.end();
+  }
+
+ private:
+  pid_t m_next_pid;
+  set<pid_t> m_exited;
+};
+
+
+static vector<string> Command(const string &command) {
+  return vector<string>(1, command);
+}
+
+
+/*
+ * Check that without a limit, every command is started straight away.
+ */
+void CommandRunnerTest::testUnlimited() {
+  MockSpawnCommandRunner runner((SpawnCommandRunner::Options()));
+  for (unsigned int i = 0; i < 10; i++) {
+    OLA_ASSERT_TRUE(runner.Run(Command("echo")));
+  }
+  OLA_ASSERT_EQ(static_cast<size_t>(10), runner.m_commands.size());
+  OLA_ASSERT_EQ(0u, runner.Running());
+  OLA_ASSERT_EQ(0u, runner.Queued());
+  OLA_ASSERT_FALSE(runner.Run(vector<string>()));
+}
+
+
+/*
+ * Check commands are queued once max_children are running.
+ */
+void CommandRunnerTest::testQueueing() {
+  SpawnCommandRunner::Options options;
+  options.max_children = 2;
+  options.max_queued = 2;
+  MockSpawnCommandRunner runner(options);
+
+  OLA_ASSERT_TRUE(runner.Run(Command("a")));
+  OLA_ASSERT_TRUE(runner.Run(Command("b")));
+  OLA_ASSERT_TRUE(runner.Run(Command("c")));
+  OLA_ASSERT_TRUE(runner.Run(Command("d")));
+  OLA_ASSERT_FALSE(runner.Run(Command("e")));
+  OLA_ASSERT_EQ(2u, runner.Running());
+  OLA_ASSERT_EQ(2u, runner.Queued());
+  OLA_ASSERT_EQ(static_cast<size_t>(2), runner.m_commands.size());
+
+  // Nothing has exited yet.
+  runner.Reap();
+  OLA_ASSERT_EQ(2u, runner.Queued());
+
+  runner.Exit(100);
+  runner.Reap();
+  OLA_ASSERT_EQ(2u, runner.Running());
+  OLA_ASSERT_EQ(1u, runner.Queued());
+  OLA_ASSERT_EQ(string("c"), runner.m_commands.back());
+
+  runner.Exit(101);
+  runner.Exit(102);
+  runner.Reap();
+  OLA_ASSERT_EQ(1u, runner.Running());
+  OLA_ASSERT_EQ(0u, runner.Queued());
+  OLA_ASSERT_EQ(string("d"), runner.m_commands.back());
+}
@@ -17,6 +17,8 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <string.h>
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
 #include <algorithm>
@@ -27,14 +29,44 @@
 using ola::DmxBuffer;
 
 
+namespace {
+bool SlotOffsetLessThan(const Slot *a, const Slot *b) {
+  return a->SlotOffset() < b->SlotOffset();
+}
+}  // namespace
+
+
 /**
  * @brief Create a new trigger
  */
 DMXTrigger::DMXTrigger(Context *context,
                        const SlotVector &actions)
     : m_context(context),
-      m_slots(actions) {
-  sort(m_slots.begin(), m_slots.end());
+      m_slots(actions),
+      m_last_size(0) {
+  std::stable_sort(m_slots.begin(), m_slots.end(), SlotOffsetLessThan);
+  std::fill(m_slot_table, m_slot_table + ola::DMX_UNIVERSE_SIZE,
+            static_cast<Slot*>(NULL));
+
+  SlotVector::const_iterator iter = m_slots.begin();
+  for (; iter != m_slots.end(); ++iter) {
+    const uint16_t offset = (*iter)->SlotOffset();
+    if (offset >= ola::DMX_UNIVERSE_SIZE) {
+      OLA_WARN << "Slot offset " << offset << " is out of range";
+      continue;
+    }
+    if (m_slot_table[offset]) {
+      OLA_WARN << "Multiple Slots for offset " << offset << ", ignoring all "
+               << "but the first";
+      continue;
+    }
+    m_slot_table[offset] = *iter;
+
+    const unsigned int chunk = offset / CHUNK_SIZE;
+    if (m_watched_chunks.empty() || m_watched_chunks.back() != chunk) {
+      m_watched_chunks.push_back(chunk);
+    }
+  }
 }
 
 
@@ -42,13 +74,42 @@ DMXTrigger::DMXTrigger(Context *context,
  * @brief Called when new DMX arrives.
  */
 void DMXTrigger::NewDMX(const DmxBuffer &data) {
-  SlotVector::iterator iter = m_slots.begin();
-  for (; iter != m_slots.end(); iter++) {
-    uint16_t slot_number = (*iter)->SlotOffset();
-    if (slot_number >= data.Size()) {
+  const uint8_t *raw = data.GetRaw();
+  const unsigned int size = data.Size();
+
+  std::vector<unsigned int>::const_iterator iter = m_watched_chunks.begin();
+  for (; iter != m_watched_chunks.end(); ++iter) {
+    const unsigned int start = *iter * CHUNK_SIZE;
+    if (start >= size) {
       // the DMX frame was too small
       break;
     }
-    (*iter)->TakeAction(m_context, data.Get(slot_number));
+    const unsigned int end = std::min(start + CHUNK_SIZE, size);
+    if (end - start == CHUNK_SIZE && end <= m_last_size &&
+        !ChunkChanged(raw, start)) {
+      continue;
+    }
+
+    for (unsigned int offset = start; offset < end; offset++) {
+      if (m_slot_table[offset]) {
+        m_slot_table[offset]->TakeAction(m_context, raw[offset]);
+      }
+    }
   }
+
+  memcpy(m_last_frame, raw, size);
+  m_last_size = size;
+}
+
+
+/**
+ * @brief Check if a chunk differs from the last frame.
+ */
+bool DMXTrigger::ChunkChanged(const uint8_t *data, unsigned int start) const {
+  // memcpy avoids unaligned loads, the compiler turns these into single
+  // loads.
+  uint64_t current, last;
+  memcpy(&current, data + start, sizeof(current));
+  memcpy(&last, m_last_frame + start, sizeof(last));
+  return current != last;
 }
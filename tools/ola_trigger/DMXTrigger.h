@@ -21,6 +21,8 @@
 #ifndef TOOLS_OLA_TRIGGER_DMXTRIGGER_H_
 #define TOOLS_OLA_TRIGGER_DMXTRIGGER_H_
 
+#include <stdint.h>
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <vector>
 
@@ -28,6 +30,9 @@
 
 /*
  * @brief The class which manages the triggering.
+ *
+ * Each frame is compared to the previous one a word at a time, and only the
+ * slots in the words that changed are visited.
  */
 class DMXTrigger {
  public:
@@ -41,5 +46,16 @@ class DMXTrigger {
  private:
   Context *m_context;
   SlotVector m_slots;  // kept sorted
+  // The Slot for each offset, or NULL if there isn't one.
+  Slot *m_slot_table[ola::DMX_UNIVERSE_SIZE];
+  // The chunks that contain at least one slot, in order.
+  std::vector<unsigned int> m_watched_chunks;
+  uint8_t m_last_frame[ola::DMX_UNIVERSE_SIZE];
+  unsigned int m_last_size;
+
+  bool ChunkChanged(const uint8_t *data, unsigned int start) const;
+
+  // The number of slots compared at once.
+  static const unsigned int CHUNK_SIZE = sizeof(uint64_t);
 };
 #endif  // TOOLS_OLA_TRIGGER_DMXTRIGGER_H_
@@ -37,11 +37,13 @@ class DMXTriggerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(DMXTriggerTest);
   CPPUNIT_TEST(testRisingEdgeTrigger);
   CPPUNIT_TEST(testFallingEdgeTrigger);
+  CPPUNIT_TEST(testMultipleSlots);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   void testRisingEdgeTrigger();
   void testFallingEdgeTrigger();
+  void testMultipleSlots();
 
   void setUp() {
     ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
@@ -159,3 +161,54 @@ void DMXTriggerTest::testFallingEdgeTrigger() {
   rising_action->CheckForValue(OLA_SOURCELINE(), 20);
   OLA_ASSERT(falling_action->NoCalls());
 }
+
+
+/**
+ * Test that slots in different chunks of the frame trigger, regardless of the
+ * order they're passed in.
+ */
+void DMXTriggerTest::testMultipleSlots() {
+  vector<Slot*> slots;
+  Slot high_slot(300);
+  Slot low_slot(1);
+  Slot mid_slot(9);
+  MockAction *high_action = new MockAction();
+  MockAction *low_action = new MockAction();
+  MockAction *mid_action = new MockAction();
+  high_slot.SetDefaultRisingAction(high_action);
+  low_slot.SetDefaultRisingAction(low_action);
+  mid_slot.SetDefaultRisingAction(mid_action);
+  slots.push_back(&high_slot);
+  slots.push_back(&low_slot);
+  slots.push_back(&mid_slot);
+
+  Context context;
+  DMXTrigger trigger(&context, slots);
+  DmxBuffer buffer;
+
+  // the first frame triggers all the slots in the frame
+  buffer.SetFromString("0,10,0,0,0,0,0,0,0,20");
+  trigger.NewDMX(buffer);
+  low_action->CheckForValue(OLA_SOURCELINE(), 10);
+  mid_action->CheckForValue(OLA_SOURCELINE(), 20);
+  OLA_ASSERT(high_action->NoCalls());
+
+  // only the changed slot triggers
+  buffer.SetChannel(9, 30);
+  trigger.NewDMX(buffer);
+  OLA_ASSERT(low_action->NoCalls());
+  mid_action->CheckForValue(OLA_SOURCELINE(), 30);
+
+  // lengthen the frame, so the high slot is included
+  buffer.SetRangeToValue(10, 0, 290);
+  buffer.SetChannel(300, 40);
+  trigger.NewDMX(buffer);
+  OLA_ASSERT(low_action->NoCalls());
+  OLA_ASSERT(mid_action->NoCalls());
+  high_action->CheckForValue(OLA_SOURCELINE(), 40);
+
+  // changes to other slots in the same chunk don't trigger
+  buffer.SetChannel(301, 50);
+  trigger.NewDMX(buffer);
+  OLA_ASSERT(high_action->NoCalls());
+}
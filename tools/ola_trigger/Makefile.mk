@@ -22,6 +22,11 @@ tools_ola_trigger_libolatrigger_la_SOURCES = \
     tools/ola_trigger/DMXTrigger.h \
     tools/ola_trigger/VariableInterpolator.h \
     tools/ola_trigger/VariableInterpolator.cpp
+if !USING_WIN32
+tools_ola_trigger_libolatrigger_la_SOURCES += \
+    tools/ola_trigger/CommandRunner.cpp \
+    tools/ola_trigger/CommandRunner.h
+endif
 tools_ola_trigger_libolatrigger_la_LIBADD = common/libolacommon.la
 
 # PROGRAMS
@@ -67,6 +72,10 @@ tools_ola_trigger_ActionTester_SOURCES = \
     tools/ola_trigger/MockAction.h \
     tools/ola_trigger/SlotTest.cpp \
     tools/ola_trigger/VariableInterpolatorTest.cpp
+if !USING_WIN32
+tools_ola_trigger_ActionTester_SOURCES += \
+    tools/ola_trigger/CommandRunnerTest.cpp
+endif
 tools_ola_trigger_ActionTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 tools_ola_trigger_ActionTester_LDADD = $(COMMON_TESTING_LIBS) \
                                        tools/ola_trigger/libolatrigger.la
@@ -38,10 +38,12 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "tools/ola_trigger/Action.h"
+#include "tools/ola_trigger/CommandRunner.h"
 #include "tools/ola_trigger/Context.h"
 #include "tools/ola_trigger/DMXTrigger.h"
 #include "tools/ola_trigger/ParserGlobals.h"
@@ -59,6 +61,17 @@ DEFINE_s_uint16(offset, o, 0,
 DEFINE_s_uint32(universe, u, 0, "The universe to use, defaults to 0.");
 DEFINE_default_bool(validate, false,
                     "Validate the config file, rather than running it.");
+#ifndef _WIN32
+DEFINE_default_bool(command_helper, false,
+                    "Start commands from a helper process rather than from "
+                    "ola_trigger itself.");
+DEFINE_uint32(max_commands, 0,
+              "The number of commands that can run at once, further commands "
+              "are queued. 0 means no limit.");
+DEFINE_uint32(max_queued_commands, SpawnCommandRunner::DEFAULT_MAX_QUEUED,
+              "The number of commands to queue once max-commands are "
+              "running.");
+#endif  // _WIN32
 
 // prototype of bison-generated parser function
 int yyparse();
@@ -70,6 +83,9 @@ SlotActionMap global_slots;
 // The SelectServer to kill when we catch SIGINT
 ola::io::SelectServer *ss = NULL;
 
+// How often to check for commands that have exited, in ms.
+static const unsigned int REAP_INTERVAL_MS = 50;
+
 typedef vector<Slot*> SlotList;
 
 #ifndef _WIN32
@@ -208,6 +224,25 @@ int main(int argc, char *argv[]) {
     exit(ola::EXIT_OK);
   }
 
+#ifndef _WIN32
+  // Start the helper before we connect, while the process is small.
+  SpawnCommandRunner::Options runner_options;
+  runner_options.max_children = FLAGS_max_commands;
+  runner_options.max_queued = FLAGS_max_queued_commands;
+  std::auto_ptr<HelperCommandRunner> helper_runner;
+  std::auto_ptr<SpawnCommandRunner> spawn_runner;
+  if (FLAGS_command_helper) {
+    helper_runner.reset(new HelperCommandRunner(runner_options));
+    if (!helper_runner->Init()) {
+      exit(ola::EXIT_OSERR);
+    }
+    CommandAction::SetRunner(helper_runner.get());
+  } else {
+    spawn_runner.reset(new SpawnCommandRunner(runner_options));
+    CommandAction::SetRunner(spawn_runner.get());
+  }
+#endif  // _WIN32
+
   // if we got to this stage the config is ok and we want to run it, setup the
   // client
   ola::OlaCallbackClientWrapper wrapper;
@@ -217,6 +252,14 @@ int main(int argc, char *argv[]) {
   }
 
   ss = wrapper.GetSelectServer();
+#ifndef _WIN32
+  if (spawn_runner.get() && FLAGS_max_commands) {
+    // Start queued commands as the running ones exit.
+    ss->RegisterRepeatingTimeout(
+        REAP_INTERVAL_MS,
+        ola::NewCallback(spawn_runner.get(), &SpawnCommandRunner::Reap));
+  }
+#endif  // _WIN32
 
   if (!InstallSignals()) {
     exit(ola::EXIT_OSERR);
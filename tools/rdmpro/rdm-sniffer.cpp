@@ -30,6 +30,7 @@
 #include <ola/base/Init.h>
 #include <ola/base/SysExits.h>
 #include <ola/base/Macro.h>
+#include <ola/dmx/PcapWriter.h>
 #include <ola/io/SelectServer.h>
 #include <ola/network/NetworkUtils.h>
 #include <ola/rdm/CommandPrinter.h>
@@ -56,6 +57,7 @@ using std::endl;
 using std::string;
 using std::vector;
 using ola::strings::ToHex;
+using ola::dmx::PcapWriter;
 using ola::io::SelectServerInterface;
 using ola::plugin::usbpro::DispatchingUsbProWidget;
 using ola::messaging::Descriptor;
@@ -73,6 +75,9 @@ DEFINE_s_string(readfile, p, "",
                 "Display data from a previously captured file.");
 DEFINE_s_string(savefile, w, "",
                 "Also write the captured data to a file.");
+DEFINE_string(pcap, "",
+              "Also write the frames to a pcapng file. When reading a file "
+              "the frames are timestamped as they're read.");
 DEFINE_default_bool(display_asc, false,
                     "Display non-RDM alternate start code frames.");
 DEFINE_int16(dmx_slot_limit, ola::DMX_UNIVERSE_SIZE,
@@ -119,6 +124,7 @@ class RDMSniffer {
       string pid_location;
 
       string write_file;  // write to this file if set
+      string pcap_file;  // write the frames to this capture file if set
 
       // print timestamps as well, these aren't saved
       bool timestamp;
@@ -133,11 +139,14 @@ class RDMSniffer {
       options->display_non_rdm_asc_frames = true;
       options->pid_location = "";
       options->write_file = "";
+      options->pcap_file = "";
       options->timestamp = false;
     }
 
     explicit RDMSniffer(const RDMSnifferOptions &options);
 
+    bool Init();
+
     void HandleMessage(uint8_t label,
                        const uint8_t *data,
                        unsigned int length);
@@ -155,9 +164,14 @@ class RDMSniffer {
     RDMSnifferOptions m_options;
     PidStoreHelper m_pid_helper;
     CommandPrinter m_command_printer;
+    auto_ptr<PcapWriter> m_pcap;
+    unsigned int m_pcap_dmx_interface;
+    unsigned int m_pcap_rdm_interface;
+    ola::Clock m_clock;
 
     void ProcessTuple(uint8_t control_byte, uint8_t data_byte);
     void ProcessFrame();
+    void CaptureFrame();
 
     void DisplayDmxFrame();
     void DisplayAlternateFrame();
@@ -178,13 +192,34 @@ RDMSniffer::RDMSniffer(const RDMSnifferOptions &options)
     : m_state(IDLE),
       m_options(options),
       m_pid_helper(options.pid_location, 4),
-      m_command_printer(&cout, &m_pid_helper) {
+      m_command_printer(&cout, &m_pid_helper),
+      m_pcap_dmx_interface(0),
+      m_pcap_rdm_interface(0) {
   if (!m_pid_helper.Init()) {
     OLA_WARN << "Failed to init PidStore";
   }
 }
 
 
+/*
+ * Open the capture file, if there is one.
+ */
+bool RDMSniffer::Init() {
+  if (m_options.pcap_file.empty()) {
+    return true;
+  }
+  m_pcap.reset(PcapWriter::Open(m_options.pcap_file));
+  if (!m_pcap.get()) {
+    return false;
+  }
+  m_pcap_dmx_interface = m_pcap->AddInterface(PcapWriter::LINKTYPE_DMX,
+                                              "dmx");
+  m_pcap_rdm_interface = m_pcap->AddInterface(PcapWriter::LINKTYPE_RDM,
+                                              "rdm");
+  return true;
+}
+
+
 /*
  * Handle the widget replies
  */
@@ -299,6 +334,10 @@ void RDMSniffer::ProcessTuple(uint8_t control_byte, uint8_t data_byte) {
  * Process a frame based on what start code it has.
  */
 void RDMSniffer::ProcessFrame() {
+  if (m_pcap.get()) {
+    CaptureFrame();
+  }
+
   switch (m_frame[0]) {
     case ola::DMX512_START_CODE:
       if (m_options.display_dmx_frames) {
@@ -316,6 +355,21 @@ void RDMSniffer::ProcessFrame() {
 }
 
 
+/**
+ * Record the frame in the capture file, RDM frames are recorded on their own
+ * interface.
+ */
+void RDMSniffer::CaptureFrame() {
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  const unsigned int interface_id = m_frame[0] == RDMCommand::START_CODE ?
+      m_pcap_rdm_interface : m_pcap_dmx_interface;
+  m_pcap->WriteFrame(interface_id, now, m_frame[0],
+                     m_frame.Size() > 1 ? &m_frame[1] : NULL,
+                     m_frame.Size() - 1);
+}
+
+
 /**
  * Display a DMX Frame
  */
@@ -428,6 +482,9 @@ void ParseFile(RDMSniffer::RDMSnifferOptions *sniffer_options,
   // turn off timestamps
   sniffer_options->timestamp = false;
   RDMSniffer sniffer(*sniffer_options);
+  if (!sniffer.Init()) {
+    return;
+  }
 
   read_file.open(filename.c_str(), std::ios::in | std::ios::binary);
   if (!read_file.is_open()) {
@@ -472,6 +529,7 @@ int main(int argc, char *argv[]) {
   sniffer_options.summarize_rdm_frames = !FLAGS_full_rdm;
   sniffer_options.pid_location = FLAGS_pid_location.str();
   sniffer_options.write_file = FLAGS_savefile.str();
+  sniffer_options.pcap_file = FLAGS_pcap.str();
 
   // if we're writing to a file
   if (!sniffer_options.write_file.empty()) {
@@ -508,6 +566,9 @@ int main(int argc, char *argv[]) {
   ss.AddReadDescriptor(descriptor);
 
   RDMSniffer sniffer(sniffer_options);
+  if (!sniffer.Init()) {
+    exit(ola::EXIT_CANTCREAT);
+  }
   DispatchingUsbProWidget widget(
       descriptor,
       ola::NewCallback(&sniffer, &RDMSniffer::HandleMessage));